@@ -60,6 +60,16 @@ bool FileSysUtilsIsDirectory(const std::string& path) { return FS_PREFIX::is_dir
 
 bool FileSysUtilsPathExists(const std::string& path) { return FS_PREFIX::exists(path); }
 
+bool FileSysUtilsGetLastWriteTime(const std::string& path, uint64_t& write_time) {
+    std::error_code error;
+    const auto time = FS_PREFIX::last_write_time(path, error);
+    if (error) {
+        return false;
+    }
+    write_time = static_cast<uint64_t>(time.time_since_epoch().count());
+    return true;
+}
+
 bool FileSysUtilsIsAbsolutePath(const std::string& path) {
     FS_PREFIX::path file_path(path);
     return file_path.is_absolute();
@@ -139,6 +149,15 @@ bool FileSysUtilsPathExists(const std::string& path) {
     return (GetFileAttributesW(utf8_to_wide(path).c_str()) != INVALID_FILE_ATTRIBUTES);
 }
 
+bool FileSysUtilsGetLastWriteTime(const std::string& path, uint64_t& write_time) {
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExW(utf8_to_wide(path).c_str(), GetFileExInfoStandard, &data)) {
+        return false;
+    }
+    write_time = (static_cast<uint64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+    return true;
+}
+
 bool FileSysUtilsIsAbsolutePath(const std::string& path) {
     bool pathStartsWithDir = (path.size() >= 1) && ((path[0] == DIRECTORY_SYMBOL) || (path[0] == ALTERNATE_DIRECTORY_SYMBOL));
 
@@ -245,6 +264,20 @@ bool FileSysUtilsIsDirectory(const std::string& path) {
 
 bool FileSysUtilsPathExists(const std::string& path) { return (access(path.c_str(), F_OK) != -1); }
 
+bool FileSysUtilsGetLastWriteTime(const std::string& path, uint64_t& write_time) {
+    struct stat path_stat;
+    if (stat(path.c_str(), &path_stat) != 0) {
+        return false;
+    }
+#if defined(XR_OS_APPLE)
+    const struct timespec& time = path_stat.st_mtimespec;
+#else
+    const struct timespec& time = path_stat.st_mtim;
+#endif
+    write_time = static_cast<uint64_t>(time.tv_sec) * 1000000000 + static_cast<uint64_t>(time.tv_nsec);
+    return true;
+}
+
 bool FileSysUtilsIsAbsolutePath(const std::string& path) { return (path[0] == DIRECTORY_SYMBOL); }
 
 bool FileSysUtilsGetCurrentPath(std::string& path) {
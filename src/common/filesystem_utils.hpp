@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include <stdint.h>
 #include <string>
 #include <vector>
 
@@ -21,6 +22,9 @@ bool FileSysUtilsIsDirectory(const std::string& path);
 // Determine if the provided path exists on the filesystem
 bool FileSysUtilsPathExists(const std::string& path);
 
+// Get an opaque value that changes whenever the file or directory at the path is modified
+bool FileSysUtilsGetLastWriteTime(const std::string& path, uint64_t& write_time);
+
 // Get the current directory
 bool FileSysUtilsGetCurrentPath(std::string& path);
 
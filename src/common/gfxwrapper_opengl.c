@@ -327,6 +327,9 @@ PFNGLATTACHSHADERPROC glAttachShader;
 PFNGLLINKPROGRAMPROC glLinkProgram;
 PFNGLGETPROGRAMIVPROC glGetProgramiv;
 PFNGLGETPROGRAMINFOLOGPROC glGetProgramInfoLog;
+PFNGLGETPROGRAMBINARYPROC glGetProgramBinary;
+PFNGLPROGRAMBINARYPROC glProgramBinary;
+PFNGLPROGRAMPARAMETERIPROC glProgramParameteri;
 PFNGLGETATTRIBLOCATIONPROC glGetAttribLocation;
 PFNGLBINDATTRIBLOCATIONPROC glBindAttribLocation;
 PFNGLGETUNIFORMLOCATIONPROC glGetUniformLocation;
@@ -373,6 +376,7 @@ PFNGLGETQUERYOBJECTUI64VPROC glGetQueryObjectui64v;
 
 PFNGLFENCESYNCPROC glFenceSync;
 PFNGLCLIENTWAITSYNCPROC glClientWaitSync;
+PFNGLWAITSYNCPROC glWaitSync;
 PFNGLDELETESYNCPROC glDeleteSync;
 PFNGLISSYNCPROC glIsSync;
 
@@ -497,6 +501,9 @@ void GlInitExtensions() {
     glLinkProgram = (PFNGLLINKPROGRAMPROC)GetExtension("glLinkProgram");
     glGetProgramiv = (PFNGLGETPROGRAMIVPROC)GetExtension("glGetProgramiv");
     glGetProgramInfoLog = (PFNGLGETPROGRAMINFOLOGPROC)GetExtension("glGetProgramInfoLog");
+    glGetProgramBinary = (PFNGLGETPROGRAMBINARYPROC)GetExtension("glGetProgramBinary");
+    glProgramBinary = (PFNGLPROGRAMBINARYPROC)GetExtension("glProgramBinary");
+    glProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC)GetExtension("glProgramParameteri");
     glGetAttribLocation = (PFNGLGETATTRIBLOCATIONPROC)GetExtension("glGetAttribLocation");
     glBindAttribLocation = (PFNGLBINDATTRIBLOCATIONPROC)GetExtension("glBindAttribLocation");
     glGetUniformLocation = (PFNGLGETUNIFORMLOCATIONPROC)GetExtension("glGetUniformLocation");
@@ -543,6 +550,7 @@ void GlInitExtensions() {
 
     glFenceSync = (PFNGLFENCESYNCPROC)GetExtension("glFenceSync");
     glClientWaitSync = (PFNGLCLIENTWAITSYNCPROC)GetExtension("glClientWaitSync");
+    glWaitSync = (PFNGLWAITSYNCPROC)GetExtension("glWaitSync");
     glDeleteSync = (PFNGLDELETESYNCPROC)GetExtension("glDeleteSync");
     glIsSync = (PFNGLISSYNCPROC)GetExtension("glIsSync");
 
@@ -549,6 +549,9 @@ extern PFNGLATTACHSHADERPROC glAttachShader;
 extern PFNGLLINKPROGRAMPROC glLinkProgram;
 extern PFNGLGETPROGRAMIVPROC glGetProgramiv;
 extern PFNGLGETPROGRAMINFOLOGPROC glGetProgramInfoLog;
+extern PFNGLGETPROGRAMBINARYPROC glGetProgramBinary;
+extern PFNGLPROGRAMBINARYPROC glProgramBinary;
+extern PFNGLPROGRAMPARAMETERIPROC glProgramParameteri;
 extern PFNGLGETATTRIBLOCATIONPROC glGetAttribLocation;
 extern PFNGLBINDATTRIBLOCATIONPROC glBindAttribLocation;
 extern PFNGLGETUNIFORMLOCATIONPROC glGetUniformLocation;
@@ -595,6 +598,7 @@ extern PFNGLGETQUERYOBJECTUI64VPROC glGetQueryObjectui64v;
 
 extern PFNGLFENCESYNCPROC glFenceSync;
 extern PFNGLCLIENTWAITSYNCPROC glClientWaitSync;
+extern PFNGLWAITSYNCPROC glWaitSync;
 extern PFNGLDELETESYNCPROC glDeleteSync;
 extern PFNGLISSYNCPROC glIsSync;
 
@@ -12,12 +12,12 @@
 
 #include "object_info.h"
 
-#include "extra_algorithms.h"
 #include "hex_and_handles.h"
 
 #include <openxr/openxr.h>
 
 #include <algorithm>
+#include <functional>
 #include <iterator>
 #include <memory>
 #include <sstream>
@@ -43,39 +43,31 @@ void ObjectInfoCollection::AddObjectName(uint64_t object_handle, XrObjectType ob
     }
 
     // Otherwise, add it or update the name
-    XrSdkLogObjectInfo new_obj = {object_handle, object_type};
-
-    // If it already exists, update the name
-    auto lookup_info = LookUpStoredObjectInfo(new_obj);
-    if (lookup_info != nullptr) {
-        lookup_info->name = object_name;
-        return;
-    }
-
-    // It doesn't exist, so add a new info block
-    new_obj.name = object_name;
-    object_info_.push_back(new_obj);
+    auto emplaced = object_info_.emplace(ObjectKey{object_handle, object_type}, XrSdkLogObjectInfo{object_handle, object_type});
+    emplaced.first->second.name = object_name;
 }
 
 void ObjectInfoCollection::RemoveObject(uint64_t object_handle, XrObjectType object_type) {
-    vector_remove_if_and_erase(
-        object_info_, [=](XrSdkLogObjectInfo const& info) { return info.handle == object_handle && info.type == object_type; });
+    object_info_.erase(ObjectKey{object_handle, object_type});
+}
+
+size_t ObjectInfoCollection::ObjectKeyHash::operator()(ObjectKey const& key) const {
+    // Handles are usually distinct across types, so mixing the type in cheaply is enough.
+    return std::hash<uint64_t>()(key.handle ^ (static_cast<uint64_t>(key.type) << 56));
 }
 
 XrSdkLogObjectInfo const* ObjectInfoCollection::LookUpStoredObjectInfo(XrSdkLogObjectInfo const& info) const {
-    auto e = object_info_.end();
-    auto it = std::find_if(object_info_.begin(), e, [&](XrSdkLogObjectInfo const& stored) { return Equivalent(stored, info); });
-    if (it != e) {
-        return &(*it);
+    auto it = object_info_.find(ObjectKey{info.handle, info.type});
+    if (it != object_info_.end()) {
+        return &it->second;
     }
     return nullptr;
 }
 
 XrSdkLogObjectInfo* ObjectInfoCollection::LookUpStoredObjectInfo(XrSdkLogObjectInfo const& info) {
-    auto e = object_info_.end();
-    auto it = std::find_if(object_info_.begin(), e, [&](XrSdkLogObjectInfo const& stored) { return Equivalent(stored, info); });
-    if (it != e) {
-        return &(*it);
+    auto it = object_info_.find(ObjectKey{info.handle, info.type});
+    if (it != object_info_.end()) {
+        return &it->second;
     }
     return nullptr;
 }
@@ -121,88 +113,94 @@ void NamesAndLabels::PopulateCallbackData(XrDebugUtilsMessengerCallbackDataEXT&
 void DebugUtilsData::LookUpSessionLabels(XrSession session, std::vector<XrDebugUtilsLabelEXT>& labels) const {
     auto session_label_iterator = session_labels_.find(session);
     if (session_label_iterator != session_labels_.end()) {
-        auto& XrSdkSessionLabels = *session_label_iterator->second;
-        // Copy the debug utils labels in reverse order in the the labels vector.
-        std::transform(XrSdkSessionLabels.rbegin(), XrSdkSessionLabels.rend(), std::back_inserter(labels),
-                       [](XrSdkSessionLabelPtr const& label) { return label->debug_utils_label; });
+        session_label_iterator->second.CopyLabelsReversed(labels);
     }
 }
 
-XrSdkSessionLabel::XrSdkSessionLabel(const XrDebugUtilsLabelEXT& label_info, bool individual)
-    : label_name(label_info.labelName), debug_utils_label(label_info), is_individual_label(individual) {
-    // Update the c string pointer to the one we hold.
-    debug_utils_label.labelName = label_name.c_str();
+void XrSdkSessionLabel::Assign(const XrDebugUtilsLabelEXT& label_info, bool individual) {
+    // Reuses the capacity of label_name, if this entry held a label before.
+    label_name = label_info.labelName;
+    debug_utils_label = label_info;
+    debug_utils_label.labelName = nullptr;
     // Zero out the next pointer to avoid a dangling pointer
     debug_utils_label.next = nullptr;
+    is_individual_label = individual;
 }
 
-XrSdkSessionLabelPtr XrSdkSessionLabel::make(const XrDebugUtilsLabelEXT& label_info, bool individual) {
-    XrSdkSessionLabelPtr ret(new XrSdkSessionLabel(label_info, individual));
-    return ret;
+void XrSdkSessionLabelList::Push(const XrDebugUtilsLabelEXT& label_info, bool individual) {
+    if (depth_ == labels_.size()) {
+        labels_.emplace_back();
+    }
+    labels_[depth_].Assign(label_info, individual);
+    ++depth_;
 }
-void DebugUtilsData::AddObjectName(uint64_t object_handle, XrObjectType object_type, const std::string& object_name) {
-    object_info_.AddObjectName(object_handle, object_type, object_name);
+
+void XrSdkSessionLabelList::Pop() {
+    if (depth_ > 0) {
+        --depth_;
+    }
 }
 
 // We always want to remove the old individual label before we do anything else.
-// So, do that in its own method
-void DebugUtilsData::RemoveIndividualLabel(XrSdkSessionLabelList& label_vec) {
-    if (!label_vec.empty() && label_vec.back()->is_individual_label) {
-        label_vec.pop_back();
+void XrSdkSessionLabelList::RemoveIndividualLabel() {
+    if (depth_ > 0 && labels_[depth_ - 1].is_individual_label) {
+        --depth_;
     }
 }
 
+void XrSdkSessionLabelList::CopyLabelsReversed(std::vector<XrDebugUtilsLabelEXT>& labels) const {
+    for (size_t label = depth_; label > 0; --label) {
+        const XrSdkSessionLabel& session_label = labels_[label - 1];
+        labels.push_back(session_label.debug_utils_label);
+        // Point the copy at the name we hold.
+        labels.back().labelName = session_label.label_name.c_str();
+    }
+}
+void DebugUtilsData::AddObjectName(uint64_t object_handle, XrObjectType object_type, const std::string& object_name) {
+    object_info_.AddObjectName(object_handle, object_type, object_name);
+}
+
 XrSdkSessionLabelList* DebugUtilsData::GetSessionLabelList(XrSession session) {
     auto session_label_iterator = session_labels_.find(session);
     if (session_label_iterator == session_labels_.end()) {
         return nullptr;
     }
-    return session_label_iterator->second.get();
+    return &session_label_iterator->second;
 }
 
-XrSdkSessionLabelList& DebugUtilsData::GetOrCreateSessionLabelList(XrSession session) {
-    XrSdkSessionLabelList* vec_ptr = GetSessionLabelList(session);
-    if (vec_ptr == nullptr) {
-        std::unique_ptr<XrSdkSessionLabelList> vec(new XrSdkSessionLabelList);
-        vec_ptr = vec.get();
-        session_labels_[session] = std::move(vec);
-    }
-    return *vec_ptr;
-}
+XrSdkSessionLabelList& DebugUtilsData::GetOrCreateSessionLabelList(XrSession session) { return session_labels_[session]; }
 
 void DebugUtilsData::BeginLabelRegion(XrSession session, const XrDebugUtilsLabelEXT& label_info) {
-    auto& vec = GetOrCreateSessionLabelList(session);
+    auto& label_list = GetOrCreateSessionLabelList(session);
 
     // Individual labels do not stay around in the transition into a new label region
-    RemoveIndividualLabel(vec);
+    label_list.RemoveIndividualLabel();
 
     // Start the new label region
-    vec.emplace_back(XrSdkSessionLabel::make(label_info, false));
+    label_list.Push(label_info, false);
 }
 
 void DebugUtilsData::EndLabelRegion(XrSession session) {
-    XrSdkSessionLabelList* vec_ptr = GetSessionLabelList(session);
-    if (vec_ptr == nullptr) {
+    XrSdkSessionLabelList* label_list = GetSessionLabelList(session);
+    if (label_list == nullptr) {
         return;
     }
 
     // Individual labels do not stay around in the transition out of label region
-    RemoveIndividualLabel(*vec_ptr);
+    label_list->RemoveIndividualLabel();
 
     // Remove the last label region
-    if (!vec_ptr->empty()) {
-        vec_ptr->pop_back();
-    }
+    label_list->Pop();
 }
 
 void DebugUtilsData::InsertLabel(XrSession session, const XrDebugUtilsLabelEXT& label_info) {
-    auto& vec = GetOrCreateSessionLabelList(session);
+    auto& label_list = GetOrCreateSessionLabelList(session);
 
     // Remove any individual layer that might already be there
-    RemoveIndividualLabel(vec);
+    label_list.RemoveIndividualLabel();
 
     // Insert a new individual label
-    vec.emplace_back(XrSdkSessionLabel::make(label_info, true));
+    label_list.Push(label_info, true);
 }
 
 void DebugUtilsData::DeleteObject(uint64_t object_handle, XrObjectType object_type) {
@@ -210,10 +208,7 @@ void DebugUtilsData::DeleteObject(uint64_t object_handle, XrObjectType object_ty
 
     if (object_type == XR_OBJECT_TYPE_SESSION) {
         auto session = TreatIntegerAsHandle<XrSession>(object_handle);
-        XrSdkSessionLabelList* vec_ptr = GetSessionLabelList(session);
-        if (vec_ptr != nullptr) {
-            session_labels_.erase(session);
-        }
+        session_labels_.erase(session);
     }
 }
 
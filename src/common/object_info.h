@@ -19,6 +19,7 @@
 
 #include <openxr/openxr.h>
 
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -136,23 +137,47 @@ class ObjectInfoCollection {
     bool Empty() const { return object_info_.empty(); }
 
    private:
-    // Object names that have been set for given objects
-    std::vector<XrSdkLogObjectInfo> object_info_;
-};
+    struct ObjectKey {
+        uint64_t handle;
+        XrObjectType type;
+
+        bool operator==(ObjectKey const& other) const { return handle == other.handle && type == other.type; }
+    };
 
-struct XrSdkSessionLabel;
-using XrSdkSessionLabelPtr = std::unique_ptr<XrSdkSessionLabel>;
-using XrSdkSessionLabelList = std::vector<XrSdkSessionLabelPtr>;
+    struct ObjectKeyHash {
+        size_t operator()(ObjectKey const& key) const;
+    };
+
+    // Object names that have been set for given objects, indexed by handle and type
+    std::unordered_map<ObjectKey, XrSdkLogObjectInfo, ObjectKeyHash> object_info_;
+};
 
 struct XrSdkSessionLabel {
-    static XrSdkSessionLabelPtr make(const XrDebugUtilsLabelEXT& label_info, bool individual);
+    void Assign(const XrDebugUtilsLabelEXT& label_info, bool individual);
 
     std::string label_name;
+    /// labelName is only pointed at label_name when the label is copied out, since label_name may move.
     XrDebugUtilsLabelEXT debug_utils_label;
     bool is_individual_label;
+};
+
+/// The label regions and individual label of one session.
+///
+/// Storage is append-only: popping a label keeps its entry, and pushing reuses it, so a session labeling every frame stops
+/// allocating once its stack has been as deep as it usually gets.  Only the thread labeling the session writes to it.
+class XrSdkSessionLabelList {
+   public:
+    void Push(const XrDebugUtilsLabelEXT& label_info, bool individual);
+    void Pop();
+    //! Remove the individual label on top of the stack, if there is one.
+    void RemoveIndividualLabel();
+    bool Empty() const { return depth_ == 0; }
+    //! Push the labels on the vector, most recent first.
+    void CopyLabelsReversed(std::vector<XrDebugUtilsLabelEXT>& labels) const;
 
    private:
-    XrSdkSessionLabel(const XrDebugUtilsLabelEXT& label_info, bool individual);
+    std::vector<XrSdkSessionLabel> labels_;
+    size_t depth_{0};
 };
 
 /// The metadata for a collection of objects. Must persist unmodified during the entire debug messenger call!
@@ -217,12 +242,11 @@ class DebugUtilsData {
                           const XrDebugUtilsMessengerCallbackDataEXT* provided_callback_data) const;
 
    private:
-    void RemoveIndividualLabel(XrSdkSessionLabelList& label_vec);
     XrSdkSessionLabelList* GetSessionLabelList(XrSession session);
     XrSdkSessionLabelList& GetOrCreateSessionLabelList(XrSession session);
 
-    // Session labels: one vector of them per session.
-    std::unordered_map<XrSession, std::unique_ptr<XrSdkSessionLabelList>> session_labels_;
+    // Session labels: one stack of them per session.
+    std::unordered_map<XrSession, XrSdkSessionLabelList> session_labels_;
 
     // Names for objects.
     ObjectInfoCollection object_info_;
@@ -102,11 +102,13 @@ inline static void XrMatrix4x4f_GetRotation(XrQuaternionf* result, const XrMatri
 inline static void XrMatrix4x4f_GetScale(XrVector3f* result, const XrMatrix4x4f* src);
 
 inline static void XrMatrix4x4f_Multiply(XrMatrix4x4f* result, const XrMatrix4x4f* a, const XrMatrix4x4f* b);
+inline static void XrMatrix4x4f_MultiplyArray(XrMatrix4x4f* results, const XrMatrix4x4f* a, const XrMatrix4x4f* b, size_t count);
 inline static void XrMatrix4x4f_Transpose(XrMatrix4x4f* result, const XrMatrix4x4f* src);
 inline static void XrMatrix4x4f_Invert(XrMatrix4x4f* result, const XrMatrix4x4f* src);
 inline static void XrMatrix4x4f_InvertRigidBody(XrMatrix4x4f* result, const XrMatrix4x4f* src);
 
 inline static void XrMatrix4x4f_TransformVector3f(XrVector3f* result, const XrMatrix4x4f* m, const XrVector3f* v);
+inline static void XrMatrix4x4f_TransformVector3fArray(XrVector3f* results, const XrMatrix4x4f* m, const XrVector3f* v, size_t count);
 inline static void XrMatrix4x4f_TransformVector4f(XrVector4f* result, const XrMatrix4x4f* m, const XrVector4f* v);
 
 inline static void XrMatrix4x4f_TransformBounds(XrVector3f* resultMins, XrVector3f* resultMaxs, const XrMatrix4x4f* matrix,
@@ -119,6 +121,17 @@ inline static bool XrMatrix4x4f_CullBounds(const XrMatrix4x4f* mvp, const XrVect
 #include <assert.h>
 #include <math.h>
 #include <stdbool.h>
+#include <stddef.h>
+
+// Matrix multiplication, rigid body inversion and vector transformation use SSE or NEON when the target has it.
+// Define XR_LINEAR_NO_SIMD to always use the scalar implementations (which are also available as the *Scalar functions).
+#if !defined(XR_LINEAR_NO_SIMD) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#define XR_LINEAR_SIMD_SSE 1
+#include <xmmintrin.h>
+#elif !defined(XR_LINEAR_NO_SIMD) && (defined(__ARM_NEON) || defined(_M_ARM64))
+#define XR_LINEAR_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
 
 #define MATH_PI 3.14159265358979323846f
 
@@ -307,8 +320,8 @@ inline static void XrPosef_Invert(XrPosef* result, const XrPosef* a) {
     XrQuaternionf_RotateVector3f(&result->position, &result->orientation, &aPosNeg);
 }
 
-// Use left-multiplication to accumulate transformations.
-inline static void XrMatrix4x4f_Multiply(XrMatrix4x4f* result, const XrMatrix4x4f* a, const XrMatrix4x4f* b) {
+// Scalar reference implementation of XrMatrix4x4f_Multiply.
+inline static void XrMatrix4x4f_MultiplyScalar(XrMatrix4x4f* result, const XrMatrix4x4f* a, const XrMatrix4x4f* b) {
     result->m[0] = a->m[0] * b->m[0] + a->m[4] * b->m[1] + a->m[8] * b->m[2] + a->m[12] * b->m[3];
     result->m[1] = a->m[1] * b->m[0] + a->m[5] * b->m[1] + a->m[9] * b->m[2] + a->m[13] * b->m[3];
     result->m[2] = a->m[2] * b->m[0] + a->m[6] * b->m[1] + a->m[10] * b->m[2] + a->m[14] * b->m[3];
@@ -330,6 +343,90 @@ inline static void XrMatrix4x4f_Multiply(XrMatrix4x4f* result, const XrMatrix4x4
     result->m[15] = a->m[3] * b->m[12] + a->m[7] * b->m[13] + a->m[11] * b->m[14] + a->m[15] * b->m[15];
 }
 
+// Use left-multiplication to accumulate transformations.
+// Unlike XrMatrix4x4f_MultiplyScalar, result may alias a or b.
+inline static void XrMatrix4x4f_Multiply(XrMatrix4x4f* result, const XrMatrix4x4f* a, const XrMatrix4x4f* b) {
+#if defined(XR_LINEAR_SIMD_SSE)
+    const __m128 a0 = _mm_loadu_ps(&a->m[0]);
+    const __m128 a1 = _mm_loadu_ps(&a->m[4]);
+    const __m128 a2 = _mm_loadu_ps(&a->m[8]);
+    const __m128 a3 = _mm_loadu_ps(&a->m[12]);
+    __m128 r[4];
+    for (int c = 0; c < 4; c++) {
+        // Same order of operations as the scalar implementation, so the results are identical.
+        r[c] = _mm_mul_ps(a0, _mm_set1_ps(b->m[4 * c + 0]));
+        r[c] = _mm_add_ps(r[c], _mm_mul_ps(a1, _mm_set1_ps(b->m[4 * c + 1])));
+        r[c] = _mm_add_ps(r[c], _mm_mul_ps(a2, _mm_set1_ps(b->m[4 * c + 2])));
+        r[c] = _mm_add_ps(r[c], _mm_mul_ps(a3, _mm_set1_ps(b->m[4 * c + 3])));
+    }
+    for (int c = 0; c < 4; c++) {
+        _mm_storeu_ps(&result->m[4 * c], r[c]);
+    }
+#elif defined(XR_LINEAR_SIMD_NEON)
+    const float32x4_t a0 = vld1q_f32(&a->m[0]);
+    const float32x4_t a1 = vld1q_f32(&a->m[4]);
+    const float32x4_t a2 = vld1q_f32(&a->m[8]);
+    const float32x4_t a3 = vld1q_f32(&a->m[12]);
+    float32x4_t r[4];
+    for (int c = 0; c < 4; c++) {
+        r[c] = vmulq_n_f32(a0, b->m[4 * c + 0]);
+        r[c] = vaddq_f32(r[c], vmulq_n_f32(a1, b->m[4 * c + 1]));
+        r[c] = vaddq_f32(r[c], vmulq_n_f32(a2, b->m[4 * c + 2]));
+        r[c] = vaddq_f32(r[c], vmulq_n_f32(a3, b->m[4 * c + 3]));
+    }
+    for (int c = 0; c < 4; c++) {
+        vst1q_f32(&result->m[4 * c], r[c]);
+    }
+#else
+    XrMatrix4x4f result_;
+    XrMatrix4x4f_MultiplyScalar(&result_, a, b);
+    *result = result_;
+#endif
+}
+
+// Multiplies each of 'count' matrices in 'b' by 'a', such as a view-projection by many model matrices.
+inline static void XrMatrix4x4f_MultiplyArray(XrMatrix4x4f* results, const XrMatrix4x4f* a, const XrMatrix4x4f* b, size_t count) {
+#if defined(XR_LINEAR_SIMD_SSE)
+    const __m128 a0 = _mm_loadu_ps(&a->m[0]);
+    const __m128 a1 = _mm_loadu_ps(&a->m[4]);
+    const __m128 a2 = _mm_loadu_ps(&a->m[8]);
+    const __m128 a3 = _mm_loadu_ps(&a->m[12]);
+    for (size_t i = 0; i < count; i++) {
+        __m128 r[4];
+        for (int c = 0; c < 4; c++) {
+            r[c] = _mm_mul_ps(a0, _mm_set1_ps(b[i].m[4 * c + 0]));
+            r[c] = _mm_add_ps(r[c], _mm_mul_ps(a1, _mm_set1_ps(b[i].m[4 * c + 1])));
+            r[c] = _mm_add_ps(r[c], _mm_mul_ps(a2, _mm_set1_ps(b[i].m[4 * c + 2])));
+            r[c] = _mm_add_ps(r[c], _mm_mul_ps(a3, _mm_set1_ps(b[i].m[4 * c + 3])));
+        }
+        for (int c = 0; c < 4; c++) {
+            _mm_storeu_ps(&results[i].m[4 * c], r[c]);
+        }
+    }
+#elif defined(XR_LINEAR_SIMD_NEON)
+    const float32x4_t a0 = vld1q_f32(&a->m[0]);
+    const float32x4_t a1 = vld1q_f32(&a->m[4]);
+    const float32x4_t a2 = vld1q_f32(&a->m[8]);
+    const float32x4_t a3 = vld1q_f32(&a->m[12]);
+    for (size_t i = 0; i < count; i++) {
+        float32x4_t r[4];
+        for (int c = 0; c < 4; c++) {
+            r[c] = vmulq_n_f32(a0, b[i].m[4 * c + 0]);
+            r[c] = vaddq_f32(r[c], vmulq_n_f32(a1, b[i].m[4 * c + 1]));
+            r[c] = vaddq_f32(r[c], vmulq_n_f32(a2, b[i].m[4 * c + 2]));
+            r[c] = vaddq_f32(r[c], vmulq_n_f32(a3, b[i].m[4 * c + 3]));
+        }
+        for (int c = 0; c < 4; c++) {
+            vst1q_f32(&results[i].m[4 * c], r[c]);
+        }
+    }
+#else
+    for (size_t i = 0; i < count; i++) {
+        XrMatrix4x4f_Multiply(&results[i], a, &b[i]);
+    }
+#endif
+}
+
 // Creates the transpose of the given matrix.
 inline static void XrMatrix4x4f_Transpose(XrMatrix4x4f* result, const XrMatrix4x4f* src) {
     result->m[0] = src->m[0];
@@ -363,8 +460,8 @@ inline static float XrMatrix4x4f_Minor(const XrMatrix4x4f* matrix, int r0, int r
                (matrix->m[4 * r1 + c0] * matrix->m[4 * r2 + c1] - matrix->m[4 * r2 + c0] * matrix->m[4 * r1 + c1]);
 }
 
-// Calculates the inverse of a 4x4 matrix.
-inline static void XrMatrix4x4f_Invert(XrMatrix4x4f* result, const XrMatrix4x4f* src) {
+// Scalar reference implementation of XrMatrix4x4f_Invert, by 3x3 minors.
+inline static void XrMatrix4x4f_InvertScalar(XrMatrix4x4f* result, const XrMatrix4x4f* src) {
     const float rcpDet =
         1.0f / (src->m[0] * XrMatrix4x4f_Minor(src, 1, 2, 3, 1, 2, 3) - src->m[1] * XrMatrix4x4f_Minor(src, 1, 2, 3, 0, 2, 3) +
                 src->m[2] * XrMatrix4x4f_Minor(src, 1, 2, 3, 0, 1, 3) - src->m[3] * XrMatrix4x4f_Minor(src, 1, 2, 3, 0, 1, 2));
@@ -387,8 +484,53 @@ inline static void XrMatrix4x4f_Invert(XrMatrix4x4f* result, const XrMatrix4x4f*
     result->m[15] = XrMatrix4x4f_Minor(src, 0, 1, 2, 0, 1, 2) * rcpDet;
 }
 
-// Calculates the inverse of a rigid body transform.
-inline static void XrMatrix4x4f_InvertRigidBody(XrMatrix4x4f* result, const XrMatrix4x4f* src) {
+// Calculates the inverse of a 4x4 matrix.
+// Shares the 2x2 sub-determinants between the cofactors, which takes about a third of the multiplications of the minors.
+inline static void XrMatrix4x4f_Invert(XrMatrix4x4f* result, const XrMatrix4x4f* src) {
+    const float* m = src->m;
+
+    const float s0 = m[0] * m[5] - m[4] * m[1];
+    const float s1 = m[0] * m[6] - m[4] * m[2];
+    const float s2 = m[0] * m[7] - m[4] * m[3];
+    const float s3 = m[1] * m[6] - m[5] * m[2];
+    const float s4 = m[1] * m[7] - m[5] * m[3];
+    const float s5 = m[2] * m[7] - m[6] * m[3];
+
+    const float c5 = m[10] * m[15] - m[14] * m[11];
+    const float c4 = m[9] * m[15] - m[13] * m[11];
+    const float c3 = m[9] * m[14] - m[13] * m[10];
+    const float c2 = m[8] * m[15] - m[12] * m[11];
+    const float c1 = m[8] * m[14] - m[12] * m[10];
+    const float c0 = m[8] * m[13] - m[12] * m[9];
+
+    const float rcpDet = 1.0f / (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+
+    XrMatrix4x4f r;
+    r.m[0] = (m[5] * c5 - m[6] * c4 + m[7] * c3) * rcpDet;
+    r.m[1] = (-m[1] * c5 + m[2] * c4 - m[3] * c3) * rcpDet;
+    r.m[2] = (m[13] * s5 - m[14] * s4 + m[15] * s3) * rcpDet;
+    r.m[3] = (-m[9] * s5 + m[10] * s4 - m[11] * s3) * rcpDet;
+
+    r.m[4] = (-m[4] * c5 + m[6] * c2 - m[7] * c1) * rcpDet;
+    r.m[5] = (m[0] * c5 - m[2] * c2 + m[3] * c1) * rcpDet;
+    r.m[6] = (-m[12] * s5 + m[14] * s2 - m[15] * s1) * rcpDet;
+    r.m[7] = (m[8] * s5 - m[10] * s2 + m[11] * s1) * rcpDet;
+
+    r.m[8] = (m[4] * c4 - m[5] * c2 + m[7] * c0) * rcpDet;
+    r.m[9] = (-m[0] * c4 + m[1] * c2 - m[3] * c0) * rcpDet;
+    r.m[10] = (m[12] * s4 - m[13] * s2 + m[15] * s0) * rcpDet;
+    r.m[11] = (-m[8] * s4 + m[9] * s2 - m[11] * s0) * rcpDet;
+
+    r.m[12] = (-m[4] * c3 + m[5] * c1 - m[6] * c0) * rcpDet;
+    r.m[13] = (m[0] * c3 - m[1] * c1 + m[2] * c0) * rcpDet;
+    r.m[14] = (-m[12] * s3 + m[13] * s1 - m[14] * s0) * rcpDet;
+    r.m[15] = (m[8] * s3 - m[9] * s1 + m[10] * s0) * rcpDet;
+
+    *result = r;
+}
+
+// Scalar reference implementation of XrMatrix4x4f_InvertRigidBody.
+inline static void XrMatrix4x4f_InvertRigidBodyScalar(XrMatrix4x4f* result, const XrMatrix4x4f* src) {
     result->m[0] = src->m[0];
     result->m[1] = src->m[4];
     result->m[2] = src->m[8];
@@ -407,6 +549,55 @@ inline static void XrMatrix4x4f_InvertRigidBody(XrMatrix4x4f* result, const XrMa
     result->m[15] = 1.0f;
 }
 
+// Calculates the inverse of a rigid body transform.
+inline static void XrMatrix4x4f_InvertRigidBody(XrMatrix4x4f* result, const XrMatrix4x4f* src) {
+#if defined(XR_LINEAR_SIMD_SSE)
+    // The rows of the source are the columns of the inverse rotation.
+    __m128 r0 = _mm_loadu_ps(&src->m[0]);
+    __m128 r1 = _mm_loadu_ps(&src->m[4]);
+    __m128 r2 = _mm_loadu_ps(&src->m[8]);
+    __m128 r3 = _mm_loadu_ps(&src->m[12]);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    const __m128 translation = _mm_loadu_ps(&src->m[12]);
+    __m128 t = _mm_mul_ps(r0, _mm_shuffle_ps(translation, translation, _MM_SHUFFLE(0, 0, 0, 0)));
+    t = _mm_add_ps(t, _mm_mul_ps(r1, _mm_shuffle_ps(translation, translation, _MM_SHUFFLE(1, 1, 1, 1))));
+    t = _mm_add_ps(t, _mm_mul_ps(r2, _mm_shuffle_ps(translation, translation, _MM_SHUFFLE(2, 2, 2, 2))));
+    t = _mm_sub_ps(_mm_setzero_ps(), t);
+    _mm_storeu_ps(&result->m[0], r0);
+    _mm_storeu_ps(&result->m[4], r1);
+    _mm_storeu_ps(&result->m[8], r2);
+    _mm_storeu_ps(&result->m[12], t);
+    // The last row of the source ended up in the last element of each column.
+    result->m[3] = 0.0f;
+    result->m[7] = 0.0f;
+    result->m[11] = 0.0f;
+    result->m[15] = 1.0f;
+#elif defined(XR_LINEAR_SIMD_NEON)
+    // De-interleaving the source loads its rows, which are the columns of the inverse rotation.
+    const float32x4x4_t rows = vld4q_f32(src->m);
+    const float tx = src->m[12];
+    const float ty = src->m[13];
+    const float tz = src->m[14];
+    float32x4_t t = vmulq_n_f32(rows.val[0], tx);
+    t = vaddq_f32(t, vmulq_n_f32(rows.val[1], ty));
+    t = vaddq_f32(t, vmulq_n_f32(rows.val[2], tz));
+    t = vnegq_f32(t);
+    vst1q_f32(&result->m[0], rows.val[0]);
+    vst1q_f32(&result->m[4], rows.val[1]);
+    vst1q_f32(&result->m[8], rows.val[2]);
+    vst1q_f32(&result->m[12], t);
+    // The last row of the source ended up in the last element of each column.
+    result->m[3] = 0.0f;
+    result->m[7] = 0.0f;
+    result->m[11] = 0.0f;
+    result->m[15] = 1.0f;
+#else
+    XrMatrix4x4f result_;
+    XrMatrix4x4f_InvertRigidBodyScalar(&result_, src);
+    *result = result_;
+#endif
+}
+
 // Creates an identity matrix.
 inline static void XrMatrix4x4f_CreateIdentity(XrMatrix4x4f* result) {
     result->m[0] = 1.0f;
@@ -768,8 +959,8 @@ inline static void XrMatrix4x4f_GetScale(XrVector3f* result, const XrMatrix4x4f*
     result->z = sqrtf(src->m[8] * src->m[8] + src->m[9] * src->m[9] + src->m[10] * src->m[10]);
 }
 
-// Transforms a 3D vector.
-inline static void XrMatrix4x4f_TransformVector3f(XrVector3f* result, const XrMatrix4x4f* m, const XrVector3f* v) {
+// Scalar reference implementation of XrMatrix4x4f_TransformVector3f.
+inline static void XrMatrix4x4f_TransformVector3fScalar(XrVector3f* result, const XrMatrix4x4f* m, const XrVector3f* v) {
     const float w = m->m[3] * v->x + m->m[7] * v->y + m->m[11] * v->z + m->m[15];
     const float rcpW = 1.0f / w;
     result->x = (m->m[0] * v->x + m->m[4] * v->y + m->m[8] * v->z + m->m[12]) * rcpW;
@@ -777,6 +968,58 @@ inline static void XrMatrix4x4f_TransformVector3f(XrVector3f* result, const XrMa
     result->z = (m->m[2] * v->x + m->m[6] * v->y + m->m[10] * v->z + m->m[14]) * rcpW;
 }
 
+// Transforms each of 'count' 3D vectors in 'v' by 'm'.
+inline static void XrMatrix4x4f_TransformVector3fArray(XrVector3f* results, const XrMatrix4x4f* m, const XrVector3f* v, size_t count) {
+#if defined(XR_LINEAR_SIMD_SSE)
+    const __m128 c0 = _mm_loadu_ps(&m->m[0]);
+    const __m128 c1 = _mm_loadu_ps(&m->m[4]);
+    const __m128 c2 = _mm_loadu_ps(&m->m[8]);
+    const __m128 c3 = _mm_loadu_ps(&m->m[12]);
+    for (size_t i = 0; i < count; i++) {
+        __m128 r = _mm_mul_ps(c0, _mm_set1_ps(v[i].x));
+        r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(v[i].y)));
+        r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(v[i].z)));
+        r = _mm_add_ps(r, c3);
+        const float rcpW = 1.0f / _mm_cvtss_f32(_mm_shuffle_ps(r, r, _MM_SHUFFLE(3, 3, 3, 3)));
+        float xyzw[4];
+        _mm_storeu_ps(xyzw, _mm_mul_ps(r, _mm_set1_ps(rcpW)));
+        results[i].x = xyzw[0];
+        results[i].y = xyzw[1];
+        results[i].z = xyzw[2];
+    }
+#elif defined(XR_LINEAR_SIMD_NEON)
+    const float32x4_t c0 = vld1q_f32(&m->m[0]);
+    const float32x4_t c1 = vld1q_f32(&m->m[4]);
+    const float32x4_t c2 = vld1q_f32(&m->m[8]);
+    const float32x4_t c3 = vld1q_f32(&m->m[12]);
+    for (size_t i = 0; i < count; i++) {
+        float32x4_t r = vmulq_n_f32(c0, v[i].x);
+        r = vaddq_f32(r, vmulq_n_f32(c1, v[i].y));
+        r = vaddq_f32(r, vmulq_n_f32(c2, v[i].z));
+        r = vaddq_f32(r, c3);
+        const float rcpW = 1.0f / vgetq_lane_f32(r, 3);
+        float xyzw[4];
+        vst1q_f32(xyzw, vmulq_n_f32(r, rcpW));
+        results[i].x = xyzw[0];
+        results[i].y = xyzw[1];
+        results[i].z = xyzw[2];
+    }
+#else
+    for (size_t i = 0; i < count; i++) {
+        XrMatrix4x4f_TransformVector3fScalar(&results[i], m, &v[i]);
+    }
+#endif
+}
+
+// Transforms a 3D vector.
+inline static void XrMatrix4x4f_TransformVector3f(XrVector3f* result, const XrMatrix4x4f* m, const XrVector3f* v) {
+#if defined(XR_LINEAR_SIMD_SSE) || defined(XR_LINEAR_SIMD_NEON)
+    XrMatrix4x4f_TransformVector3fArray(result, m, v, 1);
+#else
+    XrMatrix4x4f_TransformVector3fScalar(result, m, v);
+#endif
+}
+
 // Transforms a 4D vector.
 inline static void XrMatrix4x4f_TransformVector4f(XrVector4f* result, const XrMatrix4x4f* m, const XrVector4f* v) {
     result->x = m->m[0] * v->x + m->m[4] * v->y + m->m[8] * v->z + m->m[12] * v->w;
@@ -0,0 +1,188 @@
+#!/usr/bin/env python3
+# Copyright (c) 2019-2024, The Khronos Group Inc.
+#
+# SPDX-License-Identifier: Apache-2.0
+"""Compare the metrics and benchmark results of two CTS XML reports.
+
+Each cts:metric and cts:benchmark in the candidate report is matched to the one
+of the same test case, name and tags in the baseline report, and its change is
+checked against a tolerance. Exits with status 1 if anything regressed, so that
+runtime builds can be gated on performance as well as on conformance.
+
+Usage:
+    compare_reports.py baseline.xml candidate.xml [--tolerance 5]
+        [--threshold 'frameTime*=2'] [--threshold 'missedFrames=0:1']
+        [--thresholds thresholds.json] [--all] [--fail-on-missing]
+
+A threshold is a relative tolerance in percent, optionally followed by an
+absolute one in the metric's unit: a change only counts if it exceeds both.
+The thresholds file is a JSON object of the same patterns to objects with
+"tolerance", "absolute" and "higherIsBetter" keys. Patterns are fnmatch globs
+on the metric name; the last matching one applies.
+"""
+
+import argparse
+import fnmatch
+import json
+import sys
+import xml.etree.ElementTree as ET
+from dataclasses import dataclass
+from typing import Dict, List, Optional, Tuple
+
+_CTS_NS = "{https://github.com/KhronosGroup/OpenXR-CTS}"
+
+# Units whose values are costs: lower is better. Other units have no known
+# direction, so a change either way beyond the tolerance counts.
+_COST_UNITS = {"ns", "us", "ms", "s", "bytes", "count"}
+
+
+@dataclass
+class Entry:
+    """A metric, or the mean of a benchmark, of one test case."""
+
+    value: float
+    unit: str
+    # Confidence interval of a benchmark mean, to tell a change from noise.
+    lower_bound: Optional[float] = None
+    upper_bound: Optional[float] = None
+
+
+@dataclass
+class Threshold:
+    tolerance_percent: float
+    absolute: float = 0.0
+    # None to use the default for the unit.
+    higher_is_better: Optional[bool] = None
+
+
+# Test case, entry name, and tags, as written to the report.
+Key = Tuple[str, str, Tuple[Tuple[str, str], ...]]
+
+
+def read_report(path: str) -> Dict[Key, Entry]:
+    entries: Dict[Key, Entry] = {}
+    for testcase in ET.parse(path).getroot().iter("testcase"):
+        testcase_name = testcase.get("classname", "") + "/" + testcase.get("name", "")
+        for metric in testcase.iter(_CTS_NS + "metric"):
+            tags = tuple(sorted((tag.get("name", ""), tag.get("value", "")) for tag in metric.iter(_CTS_NS + "tag")))
+            entries[(testcase_name, metric.get("name", ""), tags)] = Entry(float(metric.get("value", "nan")), metric.get("unit", ""))
+        for benchmark in testcase.iter(_CTS_NS + "benchmark"):
+            mean = benchmark.find(_CTS_NS + "mean")
+            if mean is None:
+                continue
+            entries[(testcase_name, "benchmark:" + benchmark.get("name", ""), ())] = Entry(
+                float(mean.get("value", "nan")),
+                benchmark.get("unit", "ns"),
+                float(mean.get("lowerBound", "nan")),
+                float(mean.get("upperBound", "nan")),
+            )
+    return entries
+
+
+def parse_threshold(spec: str) -> Tuple[str, Threshold]:
+    pattern, _, values = spec.rpartition("=")
+    if not pattern:
+        raise argparse.ArgumentTypeError("expected PATTERN=PERCENT[:ABSOLUTE], got " + spec)
+    tolerance, _, absolute = values.partition(":")
+    try:
+        return pattern, Threshold(float(tolerance), float(absolute) if absolute else 0.0)
+    except ValueError:
+        raise argparse.ArgumentTypeError("expected PATTERN=PERCENT[:ABSOLUTE], got " + spec)
+
+
+def read_thresholds_file(path: str) -> List[Tuple[str, Threshold]]:
+    with open(path, "r", encoding="utf-8") as f:
+        config = json.load(f)
+    return [
+        (pattern, Threshold(float(t.get("tolerance", 0.0)), float(t.get("absolute", 0.0)), t.get("higherIsBetter")))
+        for pattern, t in config.items()
+    ]
+
+
+def find_threshold(name: str, default: Threshold, thresholds: List[Tuple[str, Threshold]]) -> Threshold:
+    threshold = default
+    for pattern, candidate in thresholds:
+        if fnmatch.fnmatchcase(name, pattern):
+            threshold = candidate
+    return threshold
+
+
+def classify(baseline: Entry, candidate: Entry, threshold: Threshold) -> str:
+    """Return "ok", "regressed" or "improved"."""
+    delta = candidate.value - baseline.value
+    allowed = max(abs(baseline.value) * threshold.tolerance_percent / 100.0, threshold.absolute)
+    if abs(delta) <= allowed:
+        return "ok"
+    # A benchmark whose confidence intervals overlap has not measurably changed.
+    if None not in (baseline.lower_bound, baseline.upper_bound, candidate.lower_bound, candidate.upper_bound):
+        if candidate.lower_bound <= baseline.upper_bound and baseline.lower_bound <= candidate.upper_bound:
+            return "ok"
+
+    higher_is_better = threshold.higher_is_better
+    if higher_is_better is None:
+        if candidate.unit not in _COST_UNITS:
+            return "regressed"
+        higher_is_better = False
+    return "improved" if (delta > 0) == higher_is_better else "regressed"
+
+
+def format_key(key: Key) -> str:
+    testcase, name, tags = key
+    tag_string = ", ".join("{}={}".format(n, v) for n, v in tags)
+    return "{} {}{}".format(testcase, name, " [" + tag_string + "]" if tag_string else "")
+
+
+def main(argv: List[str]) -> int:
+    parser = argparse.ArgumentParser(description="Compare the metrics and benchmarks of two CTS XML reports.")
+    parser.add_argument("baseline", help="report of the reference run")
+    parser.add_argument("candidate", help="report of the run to check")
+    parser.add_argument("--tolerance", type=float, default=5.0, help="default relative tolerance, in percent (default: 5)")
+    parser.add_argument(
+        "--threshold",
+        type=parse_threshold,
+        action="append",
+        default=[],
+        metavar="PATTERN=PERCENT[:ABSOLUTE]",
+        help="tolerance of the metrics matching PATTERN; may repeat",
+    )
+    parser.add_argument("--thresholds", metavar="FILE", help="JSON file of thresholds, applied before --threshold")
+    parser.add_argument("--all", action="store_true", help="list unchanged entries too")
+    parser.add_argument("--fail-on-missing", action="store_true", help="also fail if an entry of the baseline is missing")
+    args = parser.parse_args(argv)
+
+    thresholds = read_thresholds_file(args.thresholds) if args.thresholds else []
+    thresholds += args.threshold
+    default = Threshold(args.tolerance)
+
+    baseline = read_report(args.baseline)
+    candidate = read_report(args.candidate)
+
+    counts = {"ok": 0, "regressed": 0, "improved": 0, "missing": 0, "new": 0}
+    for key in sorted(set(baseline) | set(candidate)):
+        if key not in candidate:
+            status = "missing"
+            detail = "{:g} {}".format(baseline[key].value, baseline[key].unit)
+        elif key not in baseline:
+            status = "new"
+            detail = "{:g} {}".format(candidate[key].value, candidate[key].unit)
+        else:
+            before = baseline[key]
+            after = candidate[key]
+            status = classify(before, after, find_threshold(key[1], default, thresholds))
+            change = "{:+.1f}%".format(100.0 * (after.value - before.value) / before.value) if before.value else "n/a"
+            detail = "{:g} -> {:g} {} ({})".format(before.value, after.value, after.unit, change)
+        counts[status] += 1
+        if args.all or status != "ok":
+            print("{:<10} {}: {}".format(status.upper(), format_key(key), detail))
+
+    failed = counts["regressed"] > 0 or (args.fail_on_missing and counts["missing"] > 0)
+    print(
+        "{}: {regressed} regressed, {improved} improved, {ok} unchanged, {missing} missing, {new} new".format(
+            "FAIL" if failed else "PASS", **counts
+        )
+    )
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
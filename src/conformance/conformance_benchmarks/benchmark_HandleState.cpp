@@ -0,0 +1,72 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "HandleState.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <openxr/openxr.h>
+
+#include <memory>
+#include <vector>
+
+namespace Conformance
+{
+    TEST_CASE("HandleState", "[benchmark]")
+    {
+        // An instance with a session and the spaces, actions and swapchains of a typical app, with pointer-like handle values.
+        constexpr IntHandle firstHandle = 0x7f0000001000;
+        constexpr IntHandle handleStride = 0x40;
+        constexpr int childCount = 256;
+
+        auto instanceState = std::unique_ptr<HandleState>(new HandleState(firstHandle, XR_OBJECT_TYPE_INSTANCE, nullptr, nullptr));
+        HandleState* const instance = instanceState.get();
+        RegisterHandleState(std::move(instanceState));
+        std::unique_ptr<HandleState> sessionState = instance->CloneForChild(firstHandle + handleStride, XR_OBJECT_TYPE_SESSION);
+        HandleState* const session = sessionState.get();
+        RegisterHandleState(std::move(sessionState));
+        std::vector<HandleStateKey> keys;
+        for (int i = 0; i < childCount; ++i) {
+            const XrObjectType type = (i % 2 == 0) ? XR_OBJECT_TYPE_SPACE : XR_OBJECT_TYPE_SWAPCHAIN;
+            std::unique_ptr<HandleState> child = session->CloneForChild(firstHandle + (i + 2) * handleStride, type);
+            keys.emplace_back(child->handle, child->type);
+            RegisterHandleState(std::move(child));
+        }
+
+        // Repeated calls through the same handle, as an app locating a space every frame makes.
+        BENCHMARK("GetHandleState, same handle x1024")
+        {
+            HandleState* found = nullptr;
+            for (int i = 0; i < 1024; ++i) {
+                found = GetHandleState(keys[0]);
+            }
+            return found;
+        };
+        // Calls through every handle in turn, which a per-thread cache of recent handles cannot serve.
+        BENCHMARK("GetHandleState, 256 handles in turn x1024")
+        {
+            HandleState* found = nullptr;
+            for (int i = 0; i < 1024; ++i) {
+                found = GetHandleState(keys[i % keys.size()]);
+            }
+            return found;
+        };
+
+        // Destroying the instance destroys its children.
+        UnregisterHandleState({instance->handle, instance->type});
+    }
+}  // namespace Conformance
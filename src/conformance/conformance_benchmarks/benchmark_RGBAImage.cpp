@@ -0,0 +1,80 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "RGBAImage.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <openxr/openxr.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Conformance
+{
+    namespace
+    {
+        /// A gradient with some noise, so that no conversion sees runs of identical pixels.
+        RGBAImage MakeSyntheticImage(int width, int height)
+        {
+            RGBAImage image(width, height);
+            uint32_t state = 1;
+            for (int y = 0; y < height; ++y) {
+                for (int x = 0; x < width; ++x) {
+                    state = state * 1664525u + 1013904223u;
+                    RGBA8Color& pixel = image.pixels[y * width + x];
+                    pixel.Channels.R = (uint8_t)(x * 255 / width);
+                    pixel.Channels.G = (uint8_t)(y * 255 / height);
+                    pixel.Channels.B = (uint8_t)(state >> 24);
+                    pixel.Channels.A = 255;
+                }
+            }
+            return image;
+        }
+    }  // namespace
+
+    TEST_CASE("RGBAImage", "[benchmark]")
+    {
+        constexpr int size = 2048;
+        const RGBAImage source = MakeSyntheticImage(size, size);
+
+        BENCHMARK_ADVANCED("RGBAImage::ConvertToSRGB 2048x2048")(Catch::Benchmark::Chronometer meter)
+        {
+            std::vector<RGBAImage> images(meter.runs(), source);
+            meter.measure([&](int run) { images[run].ConvertToSRGB(); });
+        };
+
+        RGBAImage image = source;
+        BENCHMARK("RGBAImage::DrawRect 1024x1024")
+        {
+            image.DrawRect(size / 4, size / 4, size / 2, size / 2, XrColor4f{0.25f, 0.5f, 0.75f, 1.0f});
+            return image.pixels[size * size / 2].Pixel;
+        };
+
+        // Row pitches of a tightly packed image, and of one padded to 256 byte rows as D3D12 uploads require.
+        const uint32_t rowSize = size * sizeof(RGBA8Color);
+        for (uint32_t rowPitch : {rowSize, rowSize + 256}) {
+            std::vector<uint8_t> dest((size_t)rowPitch * size);
+            BENCHMARK("CopyWithStride 2048x2048, row pitch " + std::to_string(rowPitch))
+            {
+                CopyWithStride(reinterpret_cast<const uint8_t*>(source.pixels.data()), dest.data(), rowSize, size, rowPitch);
+                return dest[dest.size() / 2];
+            };
+        }
+    }
+}  // namespace Conformance
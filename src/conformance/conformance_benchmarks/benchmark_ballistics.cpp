@@ -0,0 +1,64 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "utilities/ballistics.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <openxr/openxr.h>
+
+#include <vector>
+
+namespace Conformance
+{
+    TEST_CASE("ballistics", "[benchmark]")
+    {
+        constexpr XrTime second = 1'000'000'000;
+        constexpr XrVector3f gravity{0.f, -9.8f, 0.f};
+        constexpr int bodyCount = 4096;
+
+        std::vector<BodyInMotion> bodies;
+        BodiesInMotion batched;
+        for (int i = 0; i < bodyCount; ++i) {
+            XrSpaceVelocity velocity{XR_TYPE_SPACE_VELOCITY};
+            velocity.velocityFlags = XR_SPACE_VELOCITY_LINEAR_VALID_BIT | XR_SPACE_VELOCITY_ANGULAR_VALID_BIT;
+            velocity.linearVelocity = {0.001f * i, 3.0f, -2.0f};
+            velocity.angularVelocity = {1.0f, 0.5f, -0.001f * i};
+            const XrPosef pose{{0, 0, 0, 1}, {0, 1.0f, 0}};
+            bodies.push_back(BodyInMotion{velocity, pose, 0, 0});
+            batched.Add(velocity, pose, 0);
+        }
+
+        // Each run steps one more 90 Hz frame than the one before it, since the time of a step must be after the last.
+        XrTime displayTime = 0;
+        BENCHMARK("BodyInMotion::doSimulationStep, 4096 bodies")
+        {
+            displayTime += second / 90;
+            for (BodyInMotion& body : bodies) {
+                body.doSimulationStep(gravity, displayTime);
+            }
+            return bodies.back().pose.position.y;
+        };
+        displayTime = 0;
+        BENCHMARK("BodiesInMotion::doSimulationStep, 4096 bodies")
+        {
+            displayTime += second / 90;
+            batched.doSimulationStep(gravity, displayTime);
+            return batched.GetPose(bodyCount - 1).position.y;
+        };
+    }
+}  // namespace Conformance
@@ -0,0 +1,58 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "utilities/bitmask_generator.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <initializer_list>
+
+namespace Conformance
+{
+    namespace
+    {
+        /// Drain @p generator, returning a value that depends on everything it generated.
+        uint64_t Drain(GeneratorWrapper<uint64_t const&> generator)
+        {
+            uint64_t combined = 0;
+            while (generator.next()) {
+                combined = combined * 31 + generator.get();
+            }
+            return combined;
+        }
+    }  // namespace
+
+    TEST_CASE("bitmaskGenerator", "[benchmark]")
+    {
+        // As many flags as XrSwapchainUsageFlags has.
+        const std::initializer_list<uint64_t> bits{0x1, 0x2, 0x4, 0x8, 0x10, 0x20, 0x40, 0x80, 0x100};
+
+        BENCHMARK("bitmaskGenerator, 9 bits, all combinations")
+        {
+            return Drain(bitmaskGenerator(bits));
+        };
+        BENCHMARK("bitmaskGenerator, 9 bits, pairwise")
+        {
+            return Drain(bitmaskGenerator(bits, 2));
+        };
+        BENCHMARK("bitmaskGenerator, 9 bits, 3-wise")
+        {
+            return Drain(bitmaskGenerator(bits, 3));
+        };
+    }
+}  // namespace Conformance
@@ -0,0 +1,133 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gltf_helpers.h"
+
+#include "gltf/GltfHelper.h"
+#include "pbr/PbrModel.h"
+#include "utilities/xr_math_operators.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <tinygltf/tiny_gltf.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Conformance
+{
+    using namespace openxr::math_operators;
+
+    namespace
+    {
+        constexpr const char* kSampleModels[] = {"AnisotropyBarnLamp.glb", "MetalRoughSpheres.glb", "NormalTangentMirrorTest.glb"};
+
+        std::shared_ptr<const tinygltf::Model> LoadBundledModel(const char* fileName)
+        {
+            return LoadGLTFFile((std::string(XRC_BENCHMARK_GLTF_DIR) + "/" + fileName).c_str());
+        }
+
+        /// Exposes the transform resolution of Pbr::ModelInstance, the way the graphics-API-specific instances use it.
+        class BenchmarkModelInstance : public Pbr::ModelInstance
+        {
+        public:
+            explicit BenchmarkModelInstance(std::shared_ptr<const Pbr::Model> model) : Pbr::ModelInstance(std::move(model))
+            {
+            }
+
+            void Resolve(bool all)
+            {
+                if (all) {
+                    MarkAllNodesNeedResolve();
+                }
+                if (ResolvedTransformsNeedUpdate()) {
+                    ResolveTransformsAndVisibilities(false);
+                    MarkResolvedTransformsUpdated();
+                }
+            }
+        };
+
+        /// A controller-like hierarchy: a chain of @p depth nodes, each with @p fanOut leaf children.
+        std::shared_ptr<const Pbr::Model> MakeSyntheticHierarchy(int depth, int fanOut)
+        {
+            auto model = std::make_shared<Pbr::Model>();
+            Pbr::NodeIndex_t parent = Pbr::RootNodeIndex;
+            for (int d = 0; d < depth; ++d) {
+                const XrVector3f translation{0.01f * d, 0.02f, -0.03f};
+                parent = model->AddNode(Matrix::FromTranslationRotationScale(translation, Quat::Identity, {1, 1, 1}), parent,
+                                        "chain" + std::to_string(d));
+                for (int c = 0; c < fanOut; ++c) {
+                    model->AddNode(Matrix::FromTranslationRotationScale({0.001f * c, 0, 0}, Quat::Identity, {1, 1, 1}), parent,
+                                   "leaf" + std::to_string(c));
+                }
+            }
+            return model;
+        }
+    }  // namespace
+
+    TEST_CASE("GltfHelper", "[benchmark]")
+    {
+        for (const char* fileName : kSampleModels) {
+            const std::shared_ptr<const tinygltf::Model> gltfModel = LoadBundledModel(fileName);
+            std::vector<const tinygltf::Primitive*> primitives;
+            for (const tinygltf::Mesh& mesh : gltfModel->meshes) {
+                for (const tinygltf::Primitive& primitive : mesh.primitives) {
+                    primitives.push_back(&primitive);
+                }
+            }
+
+            BENCHMARK(std::string("GltfHelper::ReadPrimitive, all of ") + fileName)
+            {
+                size_t vertexCount = 0;
+                for (const tinygltf::Primitive* primitive : primitives) {
+                    vertexCount += GltfHelper::ReadPrimitive(*gltfModel, *primitive).Vertices.size();
+                }
+                return vertexCount;
+            };
+            BENCHMARK(std::string("GltfHelper::PrimitiveCache optimized, all of ") + fileName)
+            {
+                GltfHelper::PrimitiveCache cache(*gltfModel, true);
+                cache.ReadPrimitives(primitives);
+                return cache.GetVertexCacheStats().Triangles;
+            };
+        }
+    }
+
+    TEST_CASE("PbrModelInstance", "[benchmark]")
+    {
+        const std::shared_ptr<const Pbr::Model> model = MakeSyntheticHierarchy(8, 4);
+        // Animate the last node, like a controller button, which has no children of its own.
+        const Pbr::NodeIndex_t animatedNode = model->GetNodeCount() - 1;
+        BenchmarkModelInstance instance(model);
+        int frame = 0;
+        const auto animate = [&]() {
+            const XrQuaternionf rotation = Quat::FromAxisAngle({0, 1, 0}, 0.01f * ++frame);
+            instance.SetNodeTransform(animatedNode, Matrix::FromTranslationRotationScale({0, 0, 0}, rotation, {1, 1, 1}));
+        };
+
+        BENCHMARK("Pbr::ModelInstance resolve changed node, synthetic hierarchy")
+        {
+            animate();
+            instance.Resolve(false);
+        };
+        BENCHMARK("Pbr::ModelInstance resolve all nodes, synthetic hierarchy")
+        {
+            animate();
+            instance.Resolve(true);
+        };
+    }
+}  // namespace Conformance
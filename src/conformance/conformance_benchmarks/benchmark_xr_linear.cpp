@@ -0,0 +1,109 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/xr_linear.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <openxr/openxr.h>
+
+#include <cmath>
+#include <vector>
+
+namespace Conformance
+{
+    namespace
+    {
+        /// Rigid body transforms, as the framework composes for views and glTF nodes.
+        std::vector<XrMatrix4x4f> MakeTransforms(size_t count)
+        {
+            std::vector<XrMatrix4x4f> transforms(count);
+            for (size_t i = 0; i < count; ++i) {
+                const float angle = 0.01f * i;
+                const XrVector3f translation{0.1f * i, -0.05f * i, 1.5f};
+                const XrQuaternionf rotation{0.0f, std::sin(angle / 2), 0.0f, std::cos(angle / 2)};
+                const XrVector3f scale{1.0f, 1.0f, 1.0f};
+                XrMatrix4x4f_CreateTranslationRotationScale(&transforms[i], &translation, &rotation, &scale);
+            }
+            return transforms;
+        }
+    }  // namespace
+
+    TEST_CASE("xr_linear", "[benchmark]")
+    {
+        constexpr size_t count = 1024;
+        const std::vector<XrMatrix4x4f> a = MakeTransforms(count);
+        const std::vector<XrMatrix4x4f> b = MakeTransforms(count + 1);
+        std::vector<XrMatrix4x4f> results(count);
+        std::vector<XrVector3f> points(count, XrVector3f{0.25f, -0.5f, 2.0f});
+        std::vector<XrVector3f> transformedPoints(count);
+
+        // Each benchmark covers the whole array, so that the time of one call is the mean divided by the count.
+        BENCHMARK("XrMatrix4x4f_Multiply x1024")
+        {
+            for (size_t i = 0; i < count; ++i) {
+                XrMatrix4x4f_Multiply(&results[i], &a[i], &b[i + 1]);
+            }
+            return results[count - 1].m[0];
+        };
+        BENCHMARK("XrMatrix4x4f_MultiplyScalar x1024")
+        {
+            for (size_t i = 0; i < count; ++i) {
+                XrMatrix4x4f_MultiplyScalar(&results[i], &a[i], &b[i + 1]);
+            }
+            return results[count - 1].m[0];
+        };
+        BENCHMARK("XrMatrix4x4f_MultiplyArray x1024")
+        {
+            XrMatrix4x4f_MultiplyArray(results.data(), a.data(), b.data() + 1, count);
+            return results[count - 1].m[0];
+        };
+        BENCHMARK("XrMatrix4x4f_Invert x1024")
+        {
+            for (size_t i = 0; i < count; ++i) {
+                XrMatrix4x4f_Invert(&results[i], &a[i]);
+            }
+            return results[count - 1].m[0];
+        };
+        BENCHMARK("XrMatrix4x4f_InvertScalar x1024")
+        {
+            for (size_t i = 0; i < count; ++i) {
+                XrMatrix4x4f_InvertScalar(&results[i], &a[i]);
+            }
+            return results[count - 1].m[0];
+        };
+        BENCHMARK("XrMatrix4x4f_InvertRigidBody x1024")
+        {
+            for (size_t i = 0; i < count; ++i) {
+                XrMatrix4x4f_InvertRigidBody(&results[i], &a[i]);
+            }
+            return results[count - 1].m[0];
+        };
+        BENCHMARK("XrMatrix4x4f_TransformVector3f x1024")
+        {
+            for (size_t i = 0; i < count; ++i) {
+                XrMatrix4x4f_TransformVector3f(&transformedPoints[i], &a[i], &points[i]);
+            }
+            return transformedPoints[count - 1].x;
+        };
+        BENCHMARK("XrMatrix4x4f_TransformVector3fArray x1024")
+        {
+            XrMatrix4x4f_TransformVector3fArray(transformedPoints.data(), &a[0], points.data(), count);
+            return transformedPoints[count - 1].x;
+        };
+    }
+}  // namespace Conformance
@@ -6,6 +6,10 @@
 #include <algorithm>
 #include <xr_dependencies.h>
 #include <conformance_test.h>
+#include <string>
+#include <vector>
+
+#include "shard_runner.h"
 
 #if defined(_WIN32)
 #ifndef ENABLE_VIRTUAL_TERMINAL_PROCESSING
@@ -57,9 +61,51 @@ int main(int argc, const char** argv)
 {
     SetupConsole();
 
+    std::vector<std::string> args(argv + 1, argv + argc);
+    const int shardCount = Conformance::ExtractShardCount(args);
+    if (shardCount < 0) {
+        std::cerr << Conformance::kShardsOption << " requires a positive number of shards" << std::endl;
+        return 2;
+    }
+    std::string timingsPath;
+    if (!Conformance::ExtractShardTimings(args, &timingsPath)) {
+        std::cerr << Conformance::kShardTimingsOption << " requires a timings file name" << std::endl;
+        return 2;
+    }
+    std::vector<std::string> splitTestCases;
+    if (!Conformance::ExtractSplitTestCases(args, &splitTestCases)) {
+        std::cerr << Conformance::kSplitTestCaseOption << " requires a test case name" << std::endl;
+        return 2;
+    }
+    if (!splitTestCases.empty() && (shardCount <= 1 || timingsPath.empty())) {
+        std::cerr << Conformance::kSplitTestCaseOption << " requires " << Conformance::kShardsOption << " and "
+                  << Conformance::kShardTimingsOption << std::endl;
+        return 2;
+    }
+    std::string checkpointPath;
+    if (!Conformance::ExtractResumeCheckpoint(args, &checkpointPath)) {
+        std::cerr << Conformance::kResumeOption << " requires a checkpoint file name" << std::endl;
+        return 2;
+    }
+    if (!checkpointPath.empty()) {
+        if (shardCount > 1) {
+            std::cerr << Conformance::kResumeOption << " cannot be combined with " << Conformance::kShardsOption << std::endl;
+            return 2;
+        }
+        return Conformance::RunResumable(argv[0], args, checkpointPath);
+    }
+    if (shardCount > 1) {
+        return Conformance::RunSharded(argv[0], args, shardCount, timingsPath, splitTestCases);
+    }
+    // Drop a `--shards 1`, Catch2 would not understand it.
+    std::vector<const char*> catchArgv{argv[0]};
+    for (const std::string& arg : args) {
+        catchArgv.push_back(arg.c_str());
+    }
+
     ConformanceLaunchSettings launchSettings;
-    launchSettings.argc = argc;
-    launchSettings.argv = argv;
+    launchSettings.argc = static_cast<int>(catchArgv.size());
+    launchSettings.argv = catchArgv.data();
     launchSettings.message = OnTestMessage;
 
     XrcTestResult testResult;
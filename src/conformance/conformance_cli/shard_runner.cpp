@@ -0,0 +1,704 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "shard_runner.h"
+
+#include <xr_dependencies.h>
+#include <conformance_test.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <spawn.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+extern char** environ;
+#endif
+
+namespace Conformance
+{
+    namespace
+    {
+        constexpr const char* kOutKey = "out=";
+        constexpr const char* kCtsReporterName = "ctsxml";
+
+        /// Tags of the test cases that need the runtime and graphics to themselves, which run after the shards, on their own.
+        constexpr const char* kExclusiveTags[] = {"[interactive]", "[composition]", "[scenario]"};
+
+        /// Expected duration of test cases without a recorded time, when no test case has one.
+        constexpr double kDefaultTestCaseSeconds = 1.0;
+
+        /// An argument that names an output file, which needs to be made unique per shard.
+        struct OutputArg
+        {
+            /// Index into the argument list
+            size_t index;
+            /// Offset of the file name within that argument
+            size_t offset;
+            /// Length of the file name within that argument
+            size_t length;
+            /// Whether this is the output of the CTS XML reporter, and so should be merged.
+            bool isCtsReport;
+        };
+
+        bool StartsWith(const std::string& s, const char* prefix)
+        {
+            return s.compare(0, strlen(prefix), prefix) == 0;
+        }
+
+        /// Find the `out=` value in a reporter spec like `ctsxml::out=file.xml`, returning true if found.
+        bool FindReporterOutput(const std::string& spec, size_t specOffset, size_t* offset, size_t* length)
+        {
+            size_t pos = spec.find("::", specOffset);
+            while (pos != std::string::npos) {
+                const size_t keyStart = pos + 2;
+                const size_t next = spec.find("::", keyStart);
+                if (spec.compare(keyStart, strlen(kOutKey), kOutKey) == 0) {
+                    *offset = keyStart + strlen(kOutKey);
+                    *length = (next == std::string::npos ? spec.size() : next) - *offset;
+                    return true;
+                }
+                pos = next;
+            }
+            return false;
+        }
+
+        std::string ReporterName(const std::string& spec, size_t specOffset)
+        {
+            return spec.substr(specOffset, spec.find("::", specOffset) - specOffset);
+        }
+
+        /// Locate all output file names in the Catch2 `--reporter` and `--out` options.
+        std::vector<OutputArg> FindOutputArgs(const std::vector<std::string>& args)
+        {
+            std::vector<OutputArg> outputs;
+            std::vector<OutputArg> defaultOutputs;
+            bool haveCtsReporterWithoutOutput = false;
+
+            for (size_t i = 0; i < args.size(); ++i) {
+                const std::string& arg = args[i];
+                size_t specIndex = i;
+                size_t specOffset = 0;
+                if ((arg == "-r" || arg == "--reporter") && i + 1 < args.size()) {
+                    specIndex = ++i;
+                }
+                else if (StartsWith(arg, "--reporter=")) {
+                    specOffset = strlen("--reporter=");
+                }
+                else if ((arg == "-o" || arg == "--out") && i + 1 < args.size()) {
+                    ++i;
+                    defaultOutputs.push_back({i, 0, args[i].size(), false});
+                    continue;
+                }
+                else if (StartsWith(arg, "--out=")) {
+                    defaultOutputs.push_back({i, strlen("--out="), arg.size() - strlen("--out="), false});
+                    continue;
+                }
+                else {
+                    continue;
+                }
+
+                const std::string& spec = args[specIndex];
+                const bool isCts = ReporterName(spec, specOffset) == kCtsReporterName;
+                size_t offset = 0;
+                size_t length = 0;
+                if (FindReporterOutput(spec, specOffset, &offset, &length)) {
+                    outputs.push_back({specIndex, offset, length, isCts});
+                }
+                else if (isCts) {
+                    haveCtsReporterWithoutOutput = true;
+                }
+            }
+
+            // --out applies to any reporter that does not specify its own output.
+            for (OutputArg& output : defaultOutputs) {
+                output.isCtsReport = haveCtsReporterWithoutOutput;
+                outputs.push_back(output);
+            }
+            return outputs;
+        }
+
+        /// ("dir/report.xml", "shard", 2) -> "dir/report.shard2.xml"
+        std::string NumberedFileName(const std::string& path, const char* kind, int index)
+        {
+            const size_t separator = path.find_last_of("/\\");
+            const size_t dot = path.find_last_of('.');
+            const std::string suffix = "." + std::string(kind) + std::to_string(index);
+            if (dot == std::string::npos || (separator != std::string::npos && dot < separator)) {
+                return path + suffix;
+            }
+            return path.substr(0, dot) + suffix + path.substr(dot);
+        }
+
+#if defined(_WIN32)
+        /// Quote an argument so that CommandLineToArgvW / the CRT reproduce it exactly.
+        std::string QuoteArgument(const std::string& arg)
+        {
+            if (!arg.empty() && arg.find_first_of(" \t\n\v\"") == std::string::npos) {
+                return arg;
+            }
+            std::string quoted = "\"";
+            size_t backslashes = 0;
+            for (char c : arg) {
+                if (c == '\\') {
+                    backslashes++;
+                    continue;
+                }
+                if (c == '"') {
+                    quoted.append(backslashes * 2 + 1, '\\');
+                }
+                else {
+                    quoted.append(backslashes, '\\');
+                }
+                backslashes = 0;
+                quoted += c;
+            }
+            quoted.append(backslashes * 2, '\\');
+            quoted += '"';
+            return quoted;
+        }
+
+        using ChildProcess = PROCESS_INFORMATION;
+
+        bool LaunchChild(const std::string& executable, const std::vector<std::string>& args, ChildProcess* child)
+        {
+            std::string commandLine = QuoteArgument(executable);
+            for (const std::string& arg : args) {
+                commandLine += " " + QuoteArgument(arg);
+            }
+            STARTUPINFOA startupInfo{};
+            startupInfo.cb = sizeof(startupInfo);
+            *child = {};
+            // No application name, so argv[0] is resolved the same way the shell resolved it.
+            return CreateProcessA(nullptr, &commandLine[0], nullptr, nullptr, FALSE, 0, nullptr, nullptr, &startupInfo,
+                                  child) != FALSE;
+        }
+
+        /// Returns the child's exit code
+        int WaitForChild(ChildProcess& child)
+        {
+            WaitForSingleObject(child.hProcess, INFINITE);
+            DWORD exitCode = 2;
+            if (!GetExitCodeProcess(child.hProcess, &exitCode)) {
+                exitCode = 2;
+            }
+            CloseHandle(child.hThread);
+            CloseHandle(child.hProcess);
+            return static_cast<int>(exitCode);
+        }
+#else
+        using ChildProcess = pid_t;
+
+        bool LaunchChild(const std::string& executable, const std::vector<std::string>& args, ChildProcess* child)
+        {
+            std::vector<char*> argv;
+            argv.push_back(const_cast<char*>(executable.c_str()));
+            for (const std::string& arg : args) {
+                argv.push_back(const_cast<char*>(arg.c_str()));
+            }
+            argv.push_back(nullptr);
+            // argv[0] may be a bare name found through PATH.
+            return posix_spawnp(child, executable.c_str(), nullptr, nullptr, argv.data(), environ) == 0;
+        }
+
+        /// Returns the child's exit code, or 2 if it did not exit normally.
+        int WaitForChild(ChildProcess& child)
+        {
+            int status = 0;
+            if (waitpid(child, &status, 0) != child || !WIFEXITED(status)) {
+                return 2;
+            }
+            return WEXITSTATUS(status);
+        }
+#endif
+
+        bool ReadFile(const std::string& path, std::string* contents)
+        {
+            std::ifstream file(path, std::ios::binary);
+            if (!file) {
+                return false;
+            }
+            std::ostringstream ss;
+            ss << file.rdbuf();
+            *contents = ss.str();
+            return true;
+        }
+
+        /// Merge CTS XML reports by collecting every shard's `testsuite` elements under a single `testsuites` root.
+        ///
+        /// If @p allowPartial is set, the reports may come from runs that crashed: missing reports are skipped, and an
+        /// unterminated (streamed) report contributes the test cases it got to write.
+        bool MergeCtsReports(const std::string& outputPath, const std::vector<std::string>& shardPaths, bool allowPartial = false)
+        {
+            const std::string rootOpen = "<testsuites";
+            const std::string rootClose = "</testsuites>";
+            std::string merged;
+            for (const std::string& shardPath : shardPaths) {
+                std::string contents;
+                if (!ReadFile(shardPath, &contents)) {
+                    if (allowPartial) {
+                        continue;
+                    }
+                    std::cerr << "Could not read shard report " << shardPath << std::endl;
+                    return false;
+                }
+                const size_t openStart = contents.find(rootOpen);
+                const size_t openEnd = openStart == std::string::npos ? std::string::npos : contents.find('>', openStart);
+                size_t closeStart = contents.rfind(rootClose);
+                std::string unterminated;
+                if (allowPartial && openEnd == std::string::npos) {
+                    continue;  // Crashed before writing anything
+                }
+                if (allowPartial && closeStart == std::string::npos) {
+                    // A streamed report is flushed after each test case, so it stops at the end of one.
+                    closeStart = contents.size();
+                    if (contents.find("<testsuite", openEnd) != std::string::npos) {
+                        unterminated = "</testsuite>\n";
+                    }
+                }
+                if (openEnd == std::string::npos || closeStart == std::string::npos || closeStart < openEnd) {
+                    std::cerr << "Could not parse shard report " << shardPath << std::endl;
+                    return false;
+                }
+                if (merged.empty()) {
+                    // Keep the XML declaration and the root element (with its namespace attributes) from the first shard.
+                    merged = contents.substr(0, openEnd + 1);
+                }
+                merged += contents.substr(openEnd + 1, closeStart - (openEnd + 1));
+                merged += unterminated;
+            }
+            if (merged.empty()) {
+                std::cerr << "No report to merge into " << outputPath << std::endl;
+                return false;
+            }
+            merged += rootClose + "\n";
+
+            std::ofstream output(outputPath, std::ios::binary | std::ios::trunc);
+            output << merged;
+            if (!output) {
+                std::cerr << "Could not write merged report " << outputPath << std::endl;
+                return false;
+            }
+            return true;
+        }
+
+        bool FileExists(const std::string& path)
+        {
+            return std::ifstream(path).good();
+        }
+
+        /// Test case wall time in seconds, by test case name.
+        using TestCaseTimings = std::map<std::string, double>;
+
+        /// Add the `seconds name` lines of @p path to @p timings, replacing earlier times of the same test cases.
+        /// Returns false if the file cannot be read.
+        bool ReadTimings(const std::string& path, TestCaseTimings* timings)
+        {
+            std::ifstream file(path);
+            if (!file) {
+                return false;
+            }
+            std::string line;
+            while (std::getline(file, line)) {
+                if (!line.empty() && line.back() == '\r') {
+                    line.pop_back();
+                }
+                const size_t space = line.find(' ');
+                if (space == std::string::npos) {
+                    continue;  // Torn write
+                }
+                char* end = nullptr;
+                const double seconds = strtod(line.c_str(), &end);
+                if (end != line.c_str() + space || seconds < 0) {
+                    continue;
+                }
+                (*timings)[line.substr(space + 1)] = seconds;
+            }
+            return true;
+        }
+
+        bool WriteTimings(const std::string& path, const TestCaseTimings& timings)
+        {
+            std::ofstream file(path, std::ios::trunc);
+            for (const auto& entry : timings) {
+                file << entry.second << ' ' << entry.first << '\n';
+            }
+            return static_cast<bool>(file);
+        }
+
+        bool WriteLines(const std::string& path, const std::vector<std::string>& lines)
+        {
+            std::ofstream file(path, std::ios::trunc);
+            for (const std::string& line : lines) {
+                file << line << '\n';
+            }
+            return static_cast<bool>(file);
+        }
+
+        /// Split the test cases into @p shardCount lists with about the same expected duration, using the longest processing
+        /// time first rule: each test case, longest first, goes to the shard with the least work so far. Test cases that need
+        /// the runtime to themselves go to @p exclusiveTestCases instead, to be run once the shards are done. The other test
+        /// cases named in @p splitTestCases go to every shard, before the rest.
+        std::vector<std::vector<std::string>> ScheduleShards(const std::vector<ConformanceTestCase>& testCases,
+                                                             const TestCaseTimings& timings, int shardCount,
+                                                             const std::vector<std::string>& splitTestCases,
+                                                             std::vector<std::string>* exclusiveTestCases)
+        {
+            struct Job
+            {
+                double seconds;
+                std::string name;
+                bool exclusive;
+                bool split;
+            };
+            std::vector<Job> jobs;
+            double knownSeconds = 0;
+            size_t knownCount = 0;
+            for (const ConformanceTestCase& testCase : testCases) {
+                // Hidden test cases only run when named explicitly, so leave them out of the balance.
+                if (strstr(testCase.tags, "[.") != nullptr) {
+                    continue;
+                }
+                bool exclusive = false;
+                for (const char* tag : kExclusiveTags) {
+                    exclusive = exclusive || strstr(testCase.tags, tag) != nullptr;
+                }
+                const auto it = timings.find(testCase.testName);
+                if (it != timings.end()) {
+                    knownSeconds += it->second;
+                    knownCount++;
+                }
+                const bool split = !exclusive && std::find(splitTestCases.begin(), splitTestCases.end(), testCase.testName) !=
+                                                     splitTestCases.end();
+                jobs.push_back({it != timings.end() ? it->second : -1.0, testCase.testName, exclusive, split});
+            }
+            const double defaultSeconds = knownCount > 0 ? knownSeconds / knownCount : kDefaultTestCaseSeconds;
+            for (Job& job : jobs) {
+                if (job.seconds < 0) {
+                    job.seconds = defaultSeconds;
+                }
+            }
+            // Break ties by name so that the schedule does not depend on registration order.
+            std::sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) {
+                return a.seconds != b.seconds ? a.seconds > b.seconds : a.name < b.name;
+            });
+
+            std::vector<std::vector<std::string>> shards(shardCount);
+            std::vector<double> loads(shardCount, 0.0);
+            for (const Job& job : jobs) {
+                if (job.exclusive) {
+                    exclusiveTestCases->push_back(job.name);
+                }
+            }
+            for (const Job& job : jobs) {
+                if (job.split) {
+                    for (int shard = 0; shard < shardCount; ++shard) {
+                        shards[shard].push_back(job.name);
+                        loads[shard] += job.seconds;
+                    }
+                }
+            }
+            for (const Job& job : jobs) {
+                if (!job.exclusive && !job.split) {
+                    const size_t shard = std::min_element(loads.begin(), loads.end()) - loads.begin();
+                    shards[shard].push_back(job.name);
+                    loads[shard] += job.seconds;
+                }
+            }
+            return shards;
+        }
+
+        /// Size of the file, or 0 if it does not exist.
+        std::streamoff FileSize(const std::string& path)
+        {
+            std::ifstream file(path, std::ios::binary | std::ios::ate);
+            return file ? static_cast<std::streamoff>(file.tellg()) : 0;
+        }
+    }  // namespace
+
+    int ExtractShardCount(std::vector<std::string>& args)
+    {
+        for (size_t i = 0; i < args.size(); ++i) {
+            if (args[i] != kShardsOption) {
+                continue;
+            }
+            if (i + 1 >= args.size()) {
+                return -1;
+            }
+            char* end = nullptr;
+            const long count = strtol(args[i + 1].c_str(), &end, 10);
+            if (end == args[i + 1].c_str() || *end != '\0' || count < 1) {
+                return -1;
+            }
+            args.erase(args.begin() + i, args.begin() + i + 2);
+            return static_cast<int>(count);
+        }
+        return 0;
+    }
+
+    bool ExtractShardTimings(std::vector<std::string>& args, std::string* timingsPath)
+    {
+        for (size_t i = 0; i < args.size(); ++i) {
+            if (args[i] != kShardTimingsOption) {
+                continue;
+            }
+            if (i + 1 >= args.size() || args[i + 1].empty()) {
+                return false;
+            }
+            *timingsPath = args[i + 1];
+            args.erase(args.begin() + i, args.begin() + i + 2);
+            return true;
+        }
+        return true;
+    }
+
+    bool ExtractSplitTestCases(std::vector<std::string>& args, std::vector<std::string>* testCases)
+    {
+        for (size_t i = 0; i < args.size();) {
+            if (args[i] != kSplitTestCaseOption) {
+                ++i;
+                continue;
+            }
+            if (i + 1 >= args.size() || args[i + 1].empty()) {
+                return false;
+            }
+            testCases->push_back(args[i + 1]);
+            args.erase(args.begin() + i, args.begin() + i + 2);
+        }
+        return true;
+    }
+
+    int RunSharded(const std::string& executable, const std::vector<std::string>& args, int shardCount, const std::string& timingsPath,
+                   const std::vector<std::string>& splitTestCases)
+    {
+        // No point in having more shards than there are test cases at all.
+        uint32_t testCaseCount = 0;
+        std::vector<ConformanceTestCase> testCases;
+        if (xrcEnumerateTestCases(0, &testCaseCount, nullptr) == XRC_SUCCESS && testCaseCount > 0) {
+            shardCount = std::min<int>(shardCount, static_cast<int>(testCaseCount));
+            if (!timingsPath.empty()) {
+                testCases.resize(testCaseCount);
+                if (xrcEnumerateTestCases(testCaseCount, &testCaseCount, testCases.data()) != XRC_SUCCESS) {
+                    testCases.clear();
+                }
+                testCases.resize(std::min<size_t>(testCases.size(), testCaseCount));
+            }
+        }
+        xrcCleanup();
+
+        // Without timings, Catch2 partitions the tests by count.
+        std::vector<std::vector<std::string>> shardTestCases;
+        std::vector<std::string> exclusiveTestCases;
+        TestCaseTimings timings;
+        if (!timingsPath.empty()) {
+            if (testCases.empty()) {
+                std::cerr << "Could not enumerate the test cases to schedule" << std::endl;
+                return 2;
+            }
+            // The first run has no timings yet, and gets balanced by count.
+            ReadTimings(timingsPath, &timings);
+            shardTestCases = ScheduleShards(testCases, timings, shardCount, splitTestCases, &exclusiveTestCases);
+        }
+        // The exclusive test cases run in one more process, numbered after the shards, once they are all done.
+        if (!exclusiveTestCases.empty()) {
+            shardTestCases.push_back(exclusiveTestCases);
+        }
+        const int processCount = static_cast<int>(std::max<size_t>(shardCount, shardTestCases.size()));
+
+        const std::vector<OutputArg> outputArgs = FindOutputArgs(args);
+
+        auto launchShard = [&](int shardIndex, ChildProcess* child) {
+            std::vector<std::string> shardArgs = args;
+            for (const OutputArg& output : outputArgs) {
+                std::string& arg = shardArgs[output.index];
+                arg.replace(output.offset, output.length, NumberedFileName(arg.substr(output.offset, output.length), "shard", shardIndex));
+            }
+            if (shardTestCases.empty()) {
+                shardArgs.insert(shardArgs.end(),
+                                 {"--shard-count", std::to_string(shardCount), "--shard-index", std::to_string(shardIndex)});
+            }
+            else {
+                const std::string testListPath = NumberedFileName(timingsPath, "tests", shardIndex);
+                if (!WriteLines(testListPath, shardTestCases[shardIndex])) {
+                    std::cerr << "Could not write test list " << testListPath << std::endl;
+                    return false;
+                }
+                shardArgs.insert(shardArgs.end(),
+                                 {"--testList", testListPath, "--timingFile", NumberedFileName(timingsPath, "shard", shardIndex)});
+                // The exclusive test cases are never split, so their process needs no share.
+                if (!splitTestCases.empty() && shardIndex < shardCount) {
+                    shardArgs.insert(shardArgs.end(), {"--subtestShard", std::to_string(shardIndex) + "/" + std::to_string(shardCount)});
+                    for (const std::string& testCase : splitTestCases) {
+                        shardArgs.insert(shardArgs.end(), {"--subtestShardTestCase", testCase});
+                    }
+                }
+            }
+            // A shard may legitimately end up with no tests matching the user's spec.
+            shardArgs.push_back("--allow-running-no-tests");
+
+            if (!LaunchChild(executable, shardArgs, child)) {
+                std::cerr << "Failed to launch shard " << shardIndex << std::endl;
+                return false;
+            }
+            return true;
+        };
+
+        int exitCode = 0;
+        auto waitForShard = [&](int shardIndex, bool launched, ChildProcess& child) {
+            const int shardExitCode = launched ? WaitForChild(child) : 2;
+            if (shardExitCode != 0) {
+                std::cerr << "Shard " << shardIndex << " of " << processCount << " exited with code " << shardExitCode << std::endl;
+            }
+            exitCode = std::max(exitCode, std::min(shardExitCode, 2));
+        };
+
+        std::vector<ChildProcess> children(shardCount);
+        std::vector<bool> launched(shardCount, false);
+        for (int shardIndex = 0; shardIndex < shardCount; ++shardIndex) {
+            launched[shardIndex] = launchShard(shardIndex, &children[shardIndex]);
+        }
+        for (int shardIndex = 0; shardIndex < shardCount; ++shardIndex) {
+            waitForShard(shardIndex, launched[shardIndex], children[shardIndex]);
+        }
+        if (processCount > shardCount) {
+            ChildProcess child{};
+            const bool exclusiveLaunched = launchShard(shardCount, &child);
+            waitForShard(shardCount, exclusiveLaunched, child);
+        }
+
+        if (!shardTestCases.empty()) {
+            // Keep the times of test cases this run skipped, and of shards that crashed before writing theirs.
+            for (int shardIndex = 0; shardIndex < processCount; ++shardIndex) {
+                const std::string shardTimingsPath = NumberedFileName(timingsPath, "shard", shardIndex);
+                ReadTimings(shardTimingsPath, &timings);
+                remove(shardTimingsPath.c_str());
+                remove(NumberedFileName(timingsPath, "tests", shardIndex).c_str());
+            }
+            if (!WriteTimings(timingsPath, timings)) {
+                std::cerr << "Could not write shard timings " << timingsPath << std::endl;
+            }
+        }
+
+        for (const OutputArg& output : outputArgs) {
+            if (!output.isCtsReport) {
+                continue;
+            }
+            const std::string outputPath = args[output.index].substr(output.offset, output.length);
+            std::vector<std::string> shardPaths;
+            for (int shardIndex = 0; shardIndex < processCount; ++shardIndex) {
+                shardPaths.push_back(NumberedFileName(outputPath, "shard", shardIndex));
+            }
+            if (!MergeCtsReports(outputPath, shardPaths)) {
+                exitCode = 2;
+                continue;
+            }
+            for (const std::string& shardPath : shardPaths) {
+                remove(shardPath.c_str());
+            }
+        }
+
+        return exitCode;
+    }
+
+    bool ExtractResumeCheckpoint(std::vector<std::string>& args, std::string* checkpointPath)
+    {
+        for (size_t i = 0; i < args.size(); ++i) {
+            if (args[i] != kResumeOption) {
+                continue;
+            }
+            if (i + 1 >= args.size() || args[i + 1].empty()) {
+                return false;
+            }
+            *checkpointPath = args[i + 1];
+            args.erase(args.begin() + i, args.begin() + i + 2);
+            return true;
+        }
+        return true;
+    }
+
+    int RunResumable(const std::string& executable, const std::vector<std::string>& args, const std::string& checkpointPath)
+    {
+        const std::vector<OutputArg> outputArgs = FindOutputArgs(args);
+
+        // Reports of attempts made by an earlier invocation that was itself interrupted are merged too.
+        int firstAttempt = 0;
+        for (const OutputArg& output : outputArgs) {
+            const std::string outputPath = args[output.index].substr(output.offset, output.length);
+            while (FileExists(NumberedFileName(outputPath, "attempt", firstAttempt))) {
+                firstAttempt++;
+            }
+        }
+
+        int exitCode = 0;
+        bool crashed = false;
+        int attempt = firstAttempt;
+        for (;; ++attempt) {
+            std::vector<std::string> attemptArgs = args;
+            for (const OutputArg& output : outputArgs) {
+                std::string& arg = attemptArgs[output.index];
+                arg.replace(output.offset, output.length, NumberedFileName(arg.substr(output.offset, output.length), "attempt", attempt));
+            }
+            // A streamed report keeps the test cases that finished before a crash.
+            attemptArgs.insert(attemptArgs.end(), {"--checkpoint", checkpointPath, "--streamReport"});
+
+            const std::streamoff checkpointSize = FileSize(checkpointPath);
+            ChildProcess child;
+            if (!LaunchChild(executable, attemptArgs, &child)) {
+                std::cerr << "Failed to launch the test process" << std::endl;
+                exitCode = 2;
+                break;
+            }
+            exitCode = WaitForChild(child);
+            if (exitCode == 0 || exitCode == 1) {
+                break;
+            }
+
+            // Relaunch only if the attempt got somewhere: otherwise it would fail the same way again.
+            std::cerr << "Test process exited with code " << exitCode << std::endl;
+            if (FileSize(checkpointPath) == checkpointSize) {
+                exitCode = 2;
+                break;
+            }
+            std::cerr << "Resuming from checkpoint " << checkpointPath << std::endl;
+            crashed = true;
+        }
+        exitCode = std::min(exitCode, 2);
+        if (crashed) {
+            // The crashed test cases were reported as failed by the following attempt, but make sure of it.
+            exitCode = std::max(exitCode, 1);
+        }
+
+        for (const OutputArg& output : outputArgs) {
+            if (!output.isCtsReport) {
+                continue;
+            }
+            const std::string outputPath = args[output.index].substr(output.offset, output.length);
+            std::vector<std::string> attemptPaths;
+            for (int i = 0; i <= attempt; ++i) {
+                attemptPaths.push_back(NumberedFileName(outputPath, "attempt", i));
+            }
+            if (!MergeCtsReports(outputPath, attemptPaths, true)) {
+                exitCode = 2;
+                continue;
+            }
+            for (const std::string& attemptPath : attemptPaths) {
+                remove(attemptPath.c_str());
+            }
+        }
+
+        return exitCode;
+    }
+}  // namespace Conformance
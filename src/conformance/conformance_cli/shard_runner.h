@@ -0,0 +1,70 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace Conformance
+{
+    /// Command line option that turns on sharded mode
+    constexpr const char* kShardsOption = "--shards";
+
+    /// If @p args contains `--shards N`, remove it and return N. Returns 0 if not present, -1 if malformed.
+    int ExtractShardCount(std::vector<std::string>& args);
+
+    /// Command line option that schedules shards by the test case durations of earlier runs
+    constexpr const char* kShardTimingsOption = "--shardTimings";
+
+    /// If @p args contains `--shardTimings <file>`, remove it and set @p timingsPath. Returns false if malformed.
+    bool ExtractShardTimings(std::vector<std::string>& args, std::string* timingsPath);
+
+    /// Command line option that splits the generated subtests of a test case between the shards
+    constexpr const char* kSplitTestCaseOption = "--splitTestCase";
+
+    /// Remove each `--splitTestCase <name>` from @p args, adding the names to @p testCases. Returns false if malformed.
+    bool ExtractSplitTestCases(std::vector<std::string>& args, std::vector<std::string>* testCases);
+
+    /// Run the conformance tests described by @p args across @p shardCount child processes of @p executable.
+    ///
+    /// Without @p timingsPath, each child gets the same arguments plus Catch2's `--shard-count`/`--shard-index`, so the
+    /// user's test spec is honored and partitioned consistently by test case count. Only tests that do not need exclusive
+    /// use of the runtime (no sessions, no graphics) should be run this way.
+    ///
+    /// With @p timingsPath, the file holds the wall time of each test case in earlier runs, one `seconds name` line each.
+    /// Each child gets a list of test cases to run, within the user's test spec, balanced by expected duration: longest
+    /// first, each to the shard with the least work so far. Interactive, composition and scenario tests, which need the
+    /// runtime and graphics to themselves, run in one more child process once all the shards are done, so that they never
+    /// overlap any other test. Test cases without a recorded time are expected to take the average. The file is updated
+    /// with the times of this run.
+    ///
+    /// Test cases named in @p splitTestCases, which needs @p timingsPath, run on every shard instead, each shard producing
+    /// only its share of the values of their generators (see GeneratorShard), so that a test case made of many generated
+    /// subtests does not keep one shard busy after the others are done. Their recorded time is that of one shard's share.
+    /// Test cases that need the runtime to themselves are never split.
+    ///
+    /// Any reporter output files are made per child process, and `ctsxml` reports are merged into the originally requested
+    /// file once all children finish.
+    ///
+    /// @return process exit code: 0 if all shards passed, 1 if any tests failed, 2 if any shard failed to run.
+    int RunSharded(const std::string& executable, const std::vector<std::string>& args, int shardCount,
+                   const std::string& timingsPath = {}, const std::vector<std::string>& splitTestCases = {});
+
+    /// Command line option that turns on resumable mode
+    constexpr const char* kResumeOption = "--resume";
+
+    /// If @p args contains `--resume <file>`, remove it and set @p checkpointPath. Returns false if malformed.
+    bool ExtractResumeCheckpoint(std::vector<std::string>& args, std::string* checkpointPath);
+
+    /// Run the conformance tests described by @p args in a child process of @p executable, recording finished test cases in
+    /// the @p checkpointPath file, and relaunch it after the test case it was running if it crashes.
+    ///
+    /// The checkpoint is kept across invocations: running again with the same checkpoint skips the test cases it records,
+    /// so delete it to start over. Reporter output files are made per-attempt, and `ctsxml` reports are merged into the
+    /// originally requested file once the run completes. A test case that crashed the runtime is reported as an error.
+    ///
+    /// @return process exit code: 0 if all tests passed, 1 if any tests failed or crashed, 2 if the tests failed to run.
+    int RunResumable(const std::string& executable, const std::vector<std::string>& args, const std::string& checkpointPath);
+}  // namespace Conformance
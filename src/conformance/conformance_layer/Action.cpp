@@ -80,6 +80,7 @@ XrResult ConformanceHooks::xrGetActionStateFloat(XrSession session, const XrActi
     if (XR_SUCCEEDED(result)) {
         CustomActionState* const actionData = GetCustomActionState(getInfo->action);
         NONCONFORMANT_IF(actionData->type != XR_ACTION_TYPE_FLOAT_INPUT, "Expected failure due to action type mismatch");
+        SAMPLE_VALIDATION();
         VALIDATE_XRBOOL32(data->isActive);
         VALIDATE_XRBOOL32(data->changedSinceLastSync);
         VALIDATE_FLOAT(data->currentState, -1.0, +1.0);  // TODO: This could be more strict depending on suggested bindings being used (0.0
@@ -106,6 +107,7 @@ XrResult ConformanceHooks::xrGetActionStateVector2f(XrSession session, const XrA
     if (XR_SUCCEEDED(result)) {
         CustomActionState* const actionData = GetCustomActionState(getInfo->action);
         NONCONFORMANT_IF(actionData->type != XR_ACTION_TYPE_VECTOR2F_INPUT, "Expected failure due to action type mismatch");
+        SAMPLE_VALIDATION();
         VALIDATE_XRBOOL32(data->isActive);
         VALIDATE_XRBOOL32(data->changedSinceLastSync);
         VALIDATE_XRTIME(data->lastChangeTime);
@@ -0,0 +1,220 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "CallStats.h"
+
+#include "LayerLog.h"
+
+#include "common/platform_utils.hpp"
+
+#include <algorithm>
+#include <inttypes.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace CallStats
+{
+    constexpr uint32_t DurationHistogram::c_subBucketBits;
+    constexpr uint32_t DurationHistogram::c_bucketCount;
+
+    namespace
+    {
+        constexpr const char* c_enableEnvVar = "KHRONOS_runtime_conformance_call_stats";
+
+        /// Time spent downstream by the innermost ScopedCall on this thread so far.
+        thread_local uint64_t t_downstreamNanoseconds = 0;
+
+        uint64_t NanosecondsSince(Clock::time_point start)
+        {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+        }
+
+        uint32_t MostSignificantBit(uint64_t n)
+        {
+            uint32_t msb = 0;
+            for (uint32_t shift = 32; shift > 0; shift /= 2) {
+                if ((n >> shift) != 0) {
+                    n >>= shift;
+                    msb += shift;
+                }
+            }
+            return msb;
+        }
+
+        struct Registry
+        {
+            std::mutex mutex;
+            std::map<std::string, std::unique_ptr<FunctionStats>> functions;
+        };
+
+        Registry& GetRegistry()
+        {
+            static Registry registry;
+            return registry;
+        }
+
+        double ToMicroseconds(uint64_t nanoseconds)
+        {
+            return static_cast<double>(nanoseconds) / 1000.0;
+        }
+    }  // namespace
+
+    uint32_t DurationHistogram::BucketIndex(uint64_t nanoseconds)
+    {
+        constexpr uint64_t linearLimit = uint64_t(1) << c_subBucketBits;
+        if (nanoseconds < linearLimit) {
+            return static_cast<uint32_t>(nanoseconds);
+        }
+        const uint32_t msb = MostSignificantBit(nanoseconds);
+        const uint32_t subBucket = static_cast<uint32_t>(nanoseconds >> (msb - c_subBucketBits)) & (linearLimit - 1);
+        return ((msb - c_subBucketBits + 1) << c_subBucketBits) | subBucket;
+    }
+
+    uint64_t DurationHistogram::BucketUpperBound(uint32_t index)
+    {
+        constexpr uint32_t linearLimit = 1u << c_subBucketBits;
+        if (index < linearLimit) {
+            return index;
+        }
+        const uint32_t msb = (index >> c_subBucketBits) + c_subBucketBits - 1;
+        const uint64_t subBucket = index & (linearLimit - 1);
+        const uint64_t lower = (linearLimit + subBucket) << (msb - c_subBucketBits);
+        return lower + (uint64_t(1) << (msb - c_subBucketBits)) - 1;
+    }
+
+    uint64_t DurationHistogram::Quantile(double quantile) const
+    {
+        std::array<uint64_t, c_bucketCount> counts;
+        uint64_t total = 0;
+        for (uint32_t i = 0; i < c_bucketCount; ++i) {
+            counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+            total += counts[i];
+        }
+        if (total == 0) {
+            return 0;
+        }
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(quantile * static_cast<double>(total) + 0.5));
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < c_bucketCount; ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return BucketUpperBound(i);
+            }
+        }
+        return BucketUpperBound(c_bucketCount - 1);
+    }
+
+    bool IsEnabled()
+    {
+        static const bool enabled = PlatformUtilsGetEnvSet(c_enableEnvVar);
+        return enabled;
+    }
+
+    FunctionStats* GetFunctionStats(const char* name)
+    {
+        if (!IsEnabled()) {
+            return nullptr;
+        }
+        Registry& registry = GetRegistry();
+        std::unique_lock<std::mutex> lock(registry.mutex);
+        std::unique_ptr<FunctionStats>& stats = registry.functions[name];
+        if (!stats) {
+            stats = std::make_unique<FunctionStats>(name);
+        }
+        return stats.get();
+    }
+
+    void DumpSummary()
+    {
+        if (!IsEnabled()) {
+            return;
+        }
+
+        std::vector<const FunctionStats*> functions;
+        {
+            Registry& registry = GetRegistry();
+            std::unique_lock<std::mutex> lock(registry.mutex);
+            for (const auto& entry : registry.functions) {
+                if (entry.second->callCount.load(std::memory_order_relaxed) > 0) {
+                    functions.push_back(entry.second.get());
+                }
+            }
+        }
+
+        // Most expensive layer overhead first
+        auto layerNanoseconds = [](const FunctionStats* stats) {
+            return stats->totalNanoseconds.load(std::memory_order_relaxed) - stats->downstreamNanoseconds.load(std::memory_order_relaxed);
+        };
+        std::sort(functions.begin(), functions.end(),
+                  [&](const FunctionStats* a, const FunctionStats* b) { return layerNanoseconds(a) > layerNanoseconds(b); });
+
+        LOG_INFO("Conformance Layer: per-call statistics (times in microseconds, percentiles approximate)\n");
+        LOG_INFO("%-48s %10s %14s %14s %10s %10s %10s %10s\n", "function", "calls", "layer total", "runtime total", "layer p50",
+                 "layer p99", "rt p50", "rt p99");
+        for (const FunctionStats* stats : functions) {
+            LOG_INFO("%-48s %10" PRIu64 " %14.1f %14.1f %10.2f %10.2f %10.2f %10.2f\n", stats->name,
+                     stats->callCount.load(std::memory_order_relaxed), ToMicroseconds(layerNanoseconds(stats)),
+                     ToMicroseconds(stats->downstreamNanoseconds.load(std::memory_order_relaxed)),
+                     ToMicroseconds(stats->layerHistogram.Quantile(0.5)), ToMicroseconds(stats->layerHistogram.Quantile(0.99)),
+                     ToMicroseconds(stats->downstreamHistogram.Quantile(0.5)), ToMicroseconds(stats->downstreamHistogram.Quantile(0.99)));
+        }
+    }
+
+    ScopedCall::ScopedCall(FunctionStats* stats) : m_stats(stats)
+    {
+        if (m_stats == nullptr) {
+            return;
+        }
+        // Calls may nest (e.g. xrGetInstanceProcAddr from within a hook), so save the outer call's downstream time.
+        m_outerDownstreamNanoseconds = t_downstreamNanoseconds;
+        t_downstreamNanoseconds = 0;
+        m_start = Clock::now();
+    }
+
+    ScopedCall::~ScopedCall()
+    {
+        if (m_stats == nullptr) {
+            return;
+        }
+        const uint64_t total = NanosecondsSince(m_start);
+        const uint64_t downstream = std::min(t_downstreamNanoseconds, total);
+        t_downstreamNanoseconds = m_outerDownstreamNanoseconds;
+
+        m_stats->callCount.fetch_add(1, std::memory_order_relaxed);
+        m_stats->totalNanoseconds.fetch_add(total, std::memory_order_relaxed);
+        m_stats->downstreamNanoseconds.fetch_add(downstream, std::memory_order_relaxed);
+        m_stats->layerHistogram.Add(total - downstream);
+        m_stats->downstreamHistogram.Add(downstream);
+    }
+
+    ScopedDownstreamCall::ScopedDownstreamCall(FunctionStats* stats) : m_stats(stats)
+    {
+        if (m_stats != nullptr) {
+            m_start = Clock::now();
+        }
+    }
+
+    ScopedDownstreamCall::~ScopedDownstreamCall()
+    {
+        if (m_stats != nullptr) {
+            t_downstreamNanoseconds += NanosecondsSince(m_start);
+        }
+    }
+}  // namespace CallStats
@@ -0,0 +1,118 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Opt-in per-function call overhead statistics, used by the generated dispatch code.
+//
+// Set the environment variable KHRONOS_runtime_conformance_call_stats (to any value) to record, for every intercepted function,
+// the number of calls and the time spent in the layer itself versus in the downstream runtime.
+// A summary is written to the log on xrDestroyInstance.
+//
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+
+namespace CallStats
+{
+    using Clock = std::chrono::steady_clock;
+
+    /// Lock-free log-linear histogram of durations in nanoseconds: 4 sub-buckets per power of two, so percentiles
+    /// are reported to within about 20%.
+    class DurationHistogram
+    {
+    public:
+        static constexpr uint32_t c_subBucketBits = 2;
+        static constexpr uint32_t c_bucketCount = (64 + 1) << c_subBucketBits;
+
+        void Add(uint64_t nanoseconds)
+        {
+            m_buckets[BucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /// Approximate (upper bound of the containing bucket) value at the given quantile in [0, 1], in nanoseconds.
+        uint64_t Quantile(double quantile) const;
+
+    private:
+        static uint32_t BucketIndex(uint64_t nanoseconds);
+        static uint64_t BucketUpperBound(uint32_t index);
+
+        std::array<std::atomic<uint64_t>, c_bucketCount> m_buckets{};
+    };
+
+    /// Statistics for a single OpenXR function.
+    struct FunctionStats
+    {
+        explicit FunctionStats(const char* name) : name(name)
+        {
+        }
+
+        const char* const name;
+
+        std::atomic<uint64_t> callCount{0};
+        /// Time from entering to leaving the layer entry point.
+        std::atomic<uint64_t> totalNanoseconds{0};
+        /// Portion of the total spent in the next layer or runtime.
+        std::atomic<uint64_t> downstreamNanoseconds{0};
+
+        DurationHistogram layerHistogram;
+        DurationHistogram downstreamHistogram;
+    };
+
+    /// True if statistics were requested through the environment. Checked once.
+    bool IsEnabled();
+
+    /// Get the statistics for a function, or nullptr if statistics are not enabled.
+    /// Returns the same object for every call with the same name: cache the result in a function-local static.
+    FunctionStats* GetFunctionStats(const char* name);
+
+    /// Write a summary of all recorded statistics to the log. Does nothing if statistics are not enabled.
+    void DumpSummary();
+
+    /// Times one call of a layer entry point. Does nothing if constructed with nullptr.
+    class ScopedCall
+    {
+    public:
+        explicit ScopedCall(FunctionStats* stats);
+        ~ScopedCall();
+
+        ScopedCall(const ScopedCall&) = delete;
+        ScopedCall& operator=(const ScopedCall&) = delete;
+
+    private:
+        FunctionStats* m_stats;
+        Clock::time_point m_start;
+        uint64_t m_outerDownstreamNanoseconds{0};
+    };
+
+    /// Times the call into the next layer or runtime, attributing it to the innermost @ref ScopedCall on this thread.
+    /// Does nothing if constructed with nullptr.
+    class ScopedDownstreamCall
+    {
+    public:
+        explicit ScopedDownstreamCall(FunctionStats* stats);
+        ~ScopedDownstreamCall();
+
+        ScopedDownstreamCall(const ScopedDownstreamCall&) = delete;
+        ScopedDownstreamCall& operator=(const ScopedDownstreamCall&) = delete;
+
+    private:
+        FunctionStats* m_stats;
+        Clock::time_point m_start;
+    };
+}  // namespace CallStats
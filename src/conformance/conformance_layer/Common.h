@@ -90,31 +90,50 @@ inline bool IsUnitQuaternion(const XrQuaternionf& q, float* length)
     return std::abs(1 - *length) < 0.000001f;
 }
 
+/// Inspects the elements of an array returned by the runtime in place, without copying them.
+/// Meant for the short arrays of enumerations: lookups are linear scans, which beat building a set at these sizes.
 template <typename T>
 class VectorInspection
 {
 public:
     using VectorType = std::vector<T>;
-    VectorInspection(VectorType const& currentVector) : currentVector_(currentVector)
+    VectorInspection(const T* elements, size_t count) : begin_(elements), end_(elements + count)
     {
-        std::copy(currentVector_.begin(), currentVector_.end(), std::inserter(currentElements_, currentElements_.begin()));
+    }
+
+    explicit VectorInspection(VectorType const& currentVector) : VectorInspection(currentVector.data(), currentVector.size())
+    {
+    }
+
+    const T* begin() const
+    {
+        return begin_;
+    }
+
+    const T* end() const
+    {
+        return end_;
     }
 
     bool ContainsDuplicates() const
     {
-        return currentVector_.size() != currentElements_.size();
+        for (const T* it = begin_; it != end_; ++it) {
+            if (std::find(it + 1, end_, *it) != end_) {
+                return true;
+            }
+        }
+        return false;
     }
 
     bool ContainsValue(T const& elt) const
     {
-        auto it = currentElements_.find(elt);
-        return it != currentElements_.end();
+        return std::find(begin_, end_, elt) != end_;
     }
 
     /// Compares the contents of vectors, ignoring order of elements.
     bool SameElementsAs(VectorType const& prevVector) const
     {
-        if (currentVector_.size() != prevVector.size()) {
+        if (static_cast<size_t>(end_ - begin_) != prevVector.size()) {
             return false;
         }
         for (const auto& elt : prevVector) {
@@ -125,13 +144,12 @@ public:
         return true;
     }
 
-    bool ContainsAnyNotIn(std::initializer_list<T> const& known)
+    bool ContainsAnyNotIn(std::initializer_list<T> const& known) const
     {
         auto b = known.begin();
         auto e = known.end();
-        for (const auto& elt : currentElements_) {
-            auto it = std::find(b, e, elt);
-            if (it == e) {
+        for (const T* it = begin_; it != end_; ++it) {
+            if (std::find(b, e, *it) == e) {
                 // current vec contains an element not found in the provided list
                 return true;
             }
@@ -140,7 +158,6 @@ public:
     }
 
 private:
-    using SetType = std::set<T>;
-    VectorType const& currentVector_;
-    SetType currentElements_;
+    const T* begin_;
+    const T* end_;
 };
@@ -31,11 +31,14 @@ struct ConformanceHooks : ConformanceHooksBase
 
     void ConformanceFailure(XrDebugUtilsMessageSeverityFlagsEXT severity, const char* functionName, const char* fmtMessage, ...) override;
 
+    /// Report the repeats of failures counted since the last flush, if failure buffering is enabled. Defined in RuntimeFailure.cpp.
+    void FlushBufferedFailures();
+
     //
     // Defined in Instance.cpp
     //
     // xrCreateInstance is handled by CreateApiLayerInstance()
-    //XrResult xrDestroyInstance(XrInstance instance) override;
+    XrResult xrDestroyInstance(XrInstance instance) override;
     XrResult xrEnumerateViewConfigurations(XrInstance instance, XrSystemId systemId, uint32_t viewConfigurationTypeCapacityInput,
                                            uint32_t* viewConfigurationTypeCountOutput,
                                            XrViewConfigurationType* viewConfigurationTypes) override;
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "FrameTiming.h"
 #include "HandleState.h"
 
 #include <openxr/openxr.h>
@@ -50,18 +51,34 @@ namespace session
 
     struct CustomSessionState : ICustomHandleState
     {
+        ~CustomSessionState() override
+        {
+            frameTiming.Report(handle);
+        }
+
+        XrSession handle{XR_NULL_HANDLE};
+        // Guards the session lifecycle state and the cached enumerations. The frame loop (xrWaitFrame, xrBeginFrame,
+        // xrEndFrame, xrLocateViews and xrSyncActions) only touches the atomics below, so that the layer never serializes
+        // frame-loop calls the runtime would have run concurrently.
         std::mutex lock;
         XrSystemId systemId{XR_NULL_SYSTEM_ID};
-        XrSessionState sessionState{XR_SESSION_STATE_UNKNOWN};
-        bool sessionBegun{false};
+        std::atomic<XrSessionState> sessionState{XR_SESSION_STATE_UNKNOWN};  //< written under lock
+        std::atomic<bool> sessionBegun{false};                               //< written under lock
         bool sessionExitRequested{false};
-        bool frameBegun{false};
+        std::atomic<bool> frameBegun{false};
         bool headless{false};  //< true if a headless extension is enabled *and* in use
         std::atomic<SyncActionsState> syncActionsState{SyncActionsState::NOT_CALLED_SINCE_QUEUE_EXHAUST};
         XrStructureType graphicsBinding{XR_TYPE_UNKNOWN};
-        XrTime lastPredictedDisplayTime{0};
-        XrDuration lastPredictedDisplayPeriod{0};
-        uint32_t frameCount{0};
+        std::atomic<XrTime> lastPredictedDisplayTime{0};
+        std::atomic<XrDuration> lastPredictedDisplayPeriod{0};
+        std::atomic<uint32_t> frameCount{0};
+        //! Number of xrEndFrame calls of begun frames currently in the runtime. A successful call counts its frame before
+        //! leaving this count.
+        std::atomic<uint32_t> endFramesInFlight{0};
+        //! Set when the session became synchronized with no frame counted yet but an xrEndFrame in flight, which then checks
+        //! frameCount once it returns.
+        std::atomic<bool> synchronizedDuringEndFrame{false};
+        FrameTiming::SessionFrameTiming frameTiming;
         std::vector<XrReferenceSpaceType> referenceSpaces;
         std::vector<int64_t> swapchainFormats;
         std::vector<XrStructureType> creationExtensionTypes;
@@ -14,8 +14,6 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include <map>
-
 #include "Common.h"
 #include "RuntimeFailure.h"
 #include "IGraphicsValidator.h"
@@ -24,91 +22,119 @@
 
 namespace Conformance
 {
-    // Map type to typeless.
-    const std::unordered_map<DXGI_FORMAT, DXGI_FORMAT> g_typelessMap{
-        {DXGI_FORMAT_R32G32B32A32_FLOAT, DXGI_FORMAT_R32G32B32A32_TYPELESS},
-        {DXGI_FORMAT_R32G32B32A32_UINT, DXGI_FORMAT_R32G32B32A32_TYPELESS},
-        {DXGI_FORMAT_R32G32B32A32_SINT, DXGI_FORMAT_R32G32B32A32_TYPELESS},
-        {DXGI_FORMAT_R32G32B32_FLOAT, DXGI_FORMAT_R32G32B32_TYPELESS},
-        {DXGI_FORMAT_R32G32B32_UINT, DXGI_FORMAT_R32G32B32_TYPELESS},
-        {DXGI_FORMAT_R32G32B32_SINT, DXGI_FORMAT_R32G32B32_TYPELESS},
-        {DXGI_FORMAT_R16G16B16A16_FLOAT, DXGI_FORMAT_R16G16B16A16_TYPELESS},
-        {DXGI_FORMAT_R16G16B16A16_UNORM, DXGI_FORMAT_R16G16B16A16_TYPELESS},
-        {DXGI_FORMAT_R16G16B16A16_UINT, DXGI_FORMAT_R16G16B16A16_TYPELESS},
-        {DXGI_FORMAT_R16G16B16A16_SNORM, DXGI_FORMAT_R16G16B16A16_TYPELESS},
-        {DXGI_FORMAT_R16G16B16A16_SINT, DXGI_FORMAT_R16G16B16A16_TYPELESS},
-        {DXGI_FORMAT_R32G32_FLOAT, DXGI_FORMAT_R32G32_TYPELESS},
-        {DXGI_FORMAT_R32G32_UINT, DXGI_FORMAT_R32G32_TYPELESS},
-        {DXGI_FORMAT_R32G32_SINT, DXGI_FORMAT_R32G32_TYPELESS},
-        {DXGI_FORMAT_D32_FLOAT_S8X24_UINT, DXGI_FORMAT_R32G8X24_TYPELESS},
-        {DXGI_FORMAT_X32_TYPELESS_G8X24_UINT, DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS},
-        {DXGI_FORMAT_R10G10B10A2_UNORM, DXGI_FORMAT_R10G10B10A2_TYPELESS},
-        {DXGI_FORMAT_R10G10B10A2_UINT, DXGI_FORMAT_R10G10B10A2_TYPELESS},
-        /* 
+    // Map type to typeless. A switch rather than a map so the compiler can build the lookup table at compile time.
+    constexpr DXGI_FORMAT GetTypelessFormat(DXGI_FORMAT format)
+    {
+        switch (format) {
+        case DXGI_FORMAT_R32G32B32A32_FLOAT:
+        case DXGI_FORMAT_R32G32B32A32_UINT:
+        case DXGI_FORMAT_R32G32B32A32_SINT:
+            return DXGI_FORMAT_R32G32B32A32_TYPELESS;
+        case DXGI_FORMAT_R32G32B32_FLOAT:
+        case DXGI_FORMAT_R32G32B32_UINT:
+        case DXGI_FORMAT_R32G32B32_SINT:
+            return DXGI_FORMAT_R32G32B32_TYPELESS;
+        case DXGI_FORMAT_R16G16B16A16_FLOAT:
+        case DXGI_FORMAT_R16G16B16A16_UNORM:
+        case DXGI_FORMAT_R16G16B16A16_UINT:
+        case DXGI_FORMAT_R16G16B16A16_SNORM:
+        case DXGI_FORMAT_R16G16B16A16_SINT:
+            return DXGI_FORMAT_R16G16B16A16_TYPELESS;
+        case DXGI_FORMAT_R32G32_FLOAT:
+        case DXGI_FORMAT_R32G32_UINT:
+        case DXGI_FORMAT_R32G32_SINT:
+            return DXGI_FORMAT_R32G32_TYPELESS;
+        case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+            return DXGI_FORMAT_R32G8X24_TYPELESS;
+        case DXGI_FORMAT_X32_TYPELESS_G8X24_UINT:
+            return DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS;
+        case DXGI_FORMAT_R10G10B10A2_UNORM:
+        case DXGI_FORMAT_R10G10B10A2_UINT:
+            return DXGI_FORMAT_R10G10B10A2_TYPELESS;
+        /*
         DXGI_FORMAT_R11G11B10_FLOAT = 26,
         */
-        {DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_R8G8B8A8_TYPELESS},
-        {DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, DXGI_FORMAT_R8G8B8A8_TYPELESS},
-        {DXGI_FORMAT_R8G8B8A8_UINT, DXGI_FORMAT_R8G8B8A8_TYPELESS},
-        {DXGI_FORMAT_R8G8B8A8_SNORM, DXGI_FORMAT_R8G8B8A8_TYPELESS},
-        {DXGI_FORMAT_R8G8B8A8_SINT, DXGI_FORMAT_R8G8B8A8_TYPELESS},
-        {DXGI_FORMAT_R16G16_FLOAT, DXGI_FORMAT_R16G16_TYPELESS},
-        {DXGI_FORMAT_R16G16_UNORM, DXGI_FORMAT_R16G16_TYPELESS},
-        {DXGI_FORMAT_R16G16_UINT, DXGI_FORMAT_R16G16_TYPELESS},
-        {DXGI_FORMAT_R16G16_SNORM, DXGI_FORMAT_R16G16_TYPELESS},
-        {DXGI_FORMAT_R16G16_SINT, DXGI_FORMAT_R16G16_TYPELESS},
-        {DXGI_FORMAT_D32_FLOAT, DXGI_FORMAT_R32_TYPELESS},
-        {DXGI_FORMAT_R32_FLOAT, DXGI_FORMAT_R32_TYPELESS},
-        {DXGI_FORMAT_R32_UINT, DXGI_FORMAT_R32_TYPELESS},
-        {DXGI_FORMAT_R32_SINT, DXGI_FORMAT_R32_TYPELESS},
-        {DXGI_FORMAT_D24_UNORM_S8_UINT, DXGI_FORMAT_R24G8_TYPELESS},
-        {DXGI_FORMAT_X24_TYPELESS_G8_UINT, DXGI_FORMAT_R24_UNORM_X8_TYPELESS},
-        {DXGI_FORMAT_R8G8_UNORM, DXGI_FORMAT_R8G8_TYPELESS},
-        {DXGI_FORMAT_R8G8_UINT, DXGI_FORMAT_R8G8_TYPELESS},
-        {DXGI_FORMAT_R8G8_SNORM, DXGI_FORMAT_R8G8_TYPELESS},
-        {DXGI_FORMAT_R8G8_SINT, DXGI_FORMAT_R8G8_TYPELESS},
-        {DXGI_FORMAT_R16_FLOAT, DXGI_FORMAT_R16_TYPELESS},
-        {DXGI_FORMAT_D16_UNORM, DXGI_FORMAT_R16_TYPELESS},
-        {DXGI_FORMAT_R16_UNORM, DXGI_FORMAT_R16_TYPELESS},
-        {DXGI_FORMAT_R16_UINT, DXGI_FORMAT_R16_TYPELESS},
-        {DXGI_FORMAT_R16_SNORM, DXGI_FORMAT_R16_TYPELESS},
-        {DXGI_FORMAT_R16_SINT, DXGI_FORMAT_R16_TYPELESS},
-        {DXGI_FORMAT_R8_UNORM, DXGI_FORMAT_R8_TYPELESS},
-        {DXGI_FORMAT_R8_UINT, DXGI_FORMAT_R8_TYPELESS},
-        {DXGI_FORMAT_R8_SNORM, DXGI_FORMAT_R8_TYPELESS},
-        {DXGI_FORMAT_R8_SINT, DXGI_FORMAT_R8_TYPELESS},
-        {DXGI_FORMAT_A8_UNORM, DXGI_FORMAT_R8_TYPELESS},
-        {DXGI_FORMAT_R1_UNORM, DXGI_FORMAT_R8_TYPELESS},
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+        case DXGI_FORMAT_R8G8B8A8_UINT:
+        case DXGI_FORMAT_R8G8B8A8_SNORM:
+        case DXGI_FORMAT_R8G8B8A8_SINT:
+            return DXGI_FORMAT_R8G8B8A8_TYPELESS;
+        case DXGI_FORMAT_R16G16_FLOAT:
+        case DXGI_FORMAT_R16G16_UNORM:
+        case DXGI_FORMAT_R16G16_UINT:
+        case DXGI_FORMAT_R16G16_SNORM:
+        case DXGI_FORMAT_R16G16_SINT:
+            return DXGI_FORMAT_R16G16_TYPELESS;
+        case DXGI_FORMAT_D32_FLOAT:
+        case DXGI_FORMAT_R32_FLOAT:
+        case DXGI_FORMAT_R32_UINT:
+        case DXGI_FORMAT_R32_SINT:
+            return DXGI_FORMAT_R32_TYPELESS;
+        case DXGI_FORMAT_D24_UNORM_S8_UINT:
+            return DXGI_FORMAT_R24G8_TYPELESS;
+        case DXGI_FORMAT_X24_TYPELESS_G8_UINT:
+            return DXGI_FORMAT_R24_UNORM_X8_TYPELESS;
+        case DXGI_FORMAT_R8G8_UNORM:
+        case DXGI_FORMAT_R8G8_UINT:
+        case DXGI_FORMAT_R8G8_SNORM:
+        case DXGI_FORMAT_R8G8_SINT:
+            return DXGI_FORMAT_R8G8_TYPELESS;
+        case DXGI_FORMAT_R16_FLOAT:
+        case DXGI_FORMAT_D16_UNORM:
+        case DXGI_FORMAT_R16_UNORM:
+        case DXGI_FORMAT_R16_UINT:
+        case DXGI_FORMAT_R16_SNORM:
+        case DXGI_FORMAT_R16_SINT:
+            return DXGI_FORMAT_R16_TYPELESS;
+        case DXGI_FORMAT_R8_UNORM:
+        case DXGI_FORMAT_R8_UINT:
+        case DXGI_FORMAT_R8_SNORM:
+        case DXGI_FORMAT_R8_SINT:
+        case DXGI_FORMAT_A8_UNORM:
+        case DXGI_FORMAT_R1_UNORM:
+            return DXGI_FORMAT_R8_TYPELESS;
         /*
         DXGI_FORMAT_R9G9B9E5_SHAREDEXP = 67,
         DXGI_FORMAT_R8G8_B8G8_UNORM = 68,
         DXGI_FORMAT_G8R8_G8B8_UNORM = 69,
         */
-        {DXGI_FORMAT_BC1_UNORM, DXGI_FORMAT_BC1_TYPELESS},
-        {DXGI_FORMAT_BC1_UNORM_SRGB, DXGI_FORMAT_BC1_TYPELESS},
-        {DXGI_FORMAT_BC2_UNORM, DXGI_FORMAT_BC2_TYPELESS},
-        {DXGI_FORMAT_BC2_UNORM_SRGB, DXGI_FORMAT_BC2_TYPELESS},
-        {DXGI_FORMAT_BC3_UNORM, DXGI_FORMAT_BC3_TYPELESS},
-        {DXGI_FORMAT_BC3_UNORM_SRGB, DXGI_FORMAT_BC3_TYPELESS},
-        {DXGI_FORMAT_BC4_UNORM, DXGI_FORMAT_BC4_TYPELESS},
-        {DXGI_FORMAT_BC4_SNORM, DXGI_FORMAT_BC4_TYPELESS},
-        {DXGI_FORMAT_BC5_UNORM, DXGI_FORMAT_BC5_TYPELESS},
-        {DXGI_FORMAT_BC5_SNORM, DXGI_FORMAT_BC5_TYPELESS},
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:
+            return DXGI_FORMAT_BC1_TYPELESS;
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC2_UNORM_SRGB:
+            return DXGI_FORMAT_BC2_TYPELESS;
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:
+            return DXGI_FORMAT_BC3_TYPELESS;
+        case DXGI_FORMAT_BC4_UNORM:
+        case DXGI_FORMAT_BC4_SNORM:
+            return DXGI_FORMAT_BC4_TYPELESS;
+        case DXGI_FORMAT_BC5_UNORM:
+        case DXGI_FORMAT_BC5_SNORM:
+            return DXGI_FORMAT_BC5_TYPELESS;
         /*
         DXGI_FORMAT_B5G6R5_UNORM = 85,
         DXGI_FORMAT_B5G5R5A1_UNORM = 86,
         */
-        {DXGI_FORMAT_B8G8R8A8_UNORM, DXGI_FORMAT_B8G8R8A8_TYPELESS},
-        {DXGI_FORMAT_B8G8R8X8_UNORM, DXGI_FORMAT_B8G8R8X8_TYPELESS},
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+            return DXGI_FORMAT_B8G8R8A8_TYPELESS;
+        case DXGI_FORMAT_B8G8R8X8_UNORM:
+            return DXGI_FORMAT_B8G8R8X8_TYPELESS;
         /*
         DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM = 89,
         */
-        {DXGI_FORMAT_B8G8R8A8_UNORM_SRGB, DXGI_FORMAT_B8G8R8A8_TYPELESS},
-        {DXGI_FORMAT_B8G8R8X8_UNORM_SRGB, DXGI_FORMAT_B8G8R8X8_TYPELESS},
-        {DXGI_FORMAT_BC6H_UF16, DXGI_FORMAT_BC6H_TYPELESS},
-        {DXGI_FORMAT_BC6H_SF16, DXGI_FORMAT_BC6H_TYPELESS},
-        {DXGI_FORMAT_BC7_UNORM, DXGI_FORMAT_BC7_TYPELESS},
-        {DXGI_FORMAT_BC7_UNORM_SRGB, DXGI_FORMAT_BC7_TYPELESS},
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+            return DXGI_FORMAT_B8G8R8A8_TYPELESS;
+        case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+            return DXGI_FORMAT_B8G8R8X8_TYPELESS;
+        case DXGI_FORMAT_BC6H_UF16:
+        case DXGI_FORMAT_BC6H_SF16:
+            return DXGI_FORMAT_BC6H_TYPELESS;
+        case DXGI_FORMAT_BC7_UNORM:
+        case DXGI_FORMAT_BC7_UNORM_SRGB:
+            return DXGI_FORMAT_BC7_TYPELESS;
         /*
         DXGI_FORMAT_AYUV = 100,
         DXGI_FORMAT_Y410 = 101,
@@ -126,12 +152,14 @@ namespace Conformance
         DXGI_FORMAT_P8 = 113,
         DXGI_FORMAT_A8P8 = 114,
         DXGI_FORMAT_B4G4R4A4_UNORM = 115,
-
         DXGI_FORMAT_P208 = 130,
         DXGI_FORMAT_V208 = 131,
         DXGI_FORMAT_V408 = 132,
         */
-    };
+        default:
+            return format;
+        }
+    }
 
     struct D3D11GraphicsValidator : IGraphicsValidator
     {
@@ -146,8 +174,7 @@ namespace Conformance
         void ValidateSwapchainImageStructs(ConformanceHooksBase* conformanceHooks, uint64_t swapchainFormat, uint32_t count,
                                            XrSwapchainImageBaseHeader* images) const override
         {
-            const auto it = g_typelessMap.find((DXGI_FORMAT)swapchainFormat);
-            const DXGI_FORMAT expectedTextureFormat = it == g_typelessMap.end() ? (DXGI_FORMAT)swapchainFormat : it->second;
+            const DXGI_FORMAT expectedTextureFormat = GetTypelessFormat((DXGI_FORMAT)swapchainFormat);
 
             const XrSwapchainImageD3D11KHR* const d3d11Images = reinterpret_cast<const XrSwapchainImageD3D11KHR*>(images);
             for (uint32_t i = 0; i < count; i++) {
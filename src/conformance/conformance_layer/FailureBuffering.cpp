@@ -0,0 +1,154 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "FailureBuffering.h"
+
+#include "common/platform_utils.hpp"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace FailureBuffering
+{
+    namespace
+    {
+        constexpr const char* c_enableEnvVar = "KHRONOS_runtime_conformance_buffer_failures";
+
+        struct SiteKey
+        {
+            const void* owner;
+            const char* fmtMessage;
+            // Not always a literal, since some checks build the function name at runtime.
+            std::string functionName;
+
+            bool operator==(const SiteKey& other) const
+            {
+                return std::tie(owner, fmtMessage, functionName) == std::tie(other.owner, other.fmtMessage, other.functionName);
+            }
+        };
+
+        struct SiteKeyHash
+        {
+            size_t operator()(const SiteKey& key) const
+            {
+                size_t hash = std::hash<std::string>()(key.functionName);
+                hash ^= std::hash<const void*>()(key.owner) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+                hash ^= std::hash<const void*>()(key.fmtMessage) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+                return hash;
+            }
+        };
+
+        struct Site
+        {
+            XrDebugUtilsMessageSeverityFlagsEXT severity;
+            /// Failures after the first one, which was reported when it happened.
+            uint64_t repeatCount{0};
+        };
+
+        /// The failures of one thread. The mutex is only contended while flushing.
+        struct ThreadBuffer
+        {
+            std::mutex mutex;
+            std::unordered_map<SiteKey, Site, SiteKeyHash> sites;
+        };
+
+        /// Every thread's buffer, kept after the thread exits so that its repeats are still flushed.
+        struct Registry
+        {
+            std::mutex mutex;
+            std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        };
+
+        Registry& GetRegistry()
+        {
+            static Registry registry;
+            return registry;
+        }
+
+        ThreadBuffer& GetThreadBuffer()
+        {
+            thread_local std::shared_ptr<ThreadBuffer> t_buffer = [] {
+                auto buffer = std::make_shared<ThreadBuffer>();
+                Registry& registry = GetRegistry();
+                std::unique_lock<std::mutex> lock(registry.mutex);
+                registry.buffers.push_back(buffer);
+                return buffer;
+            }();
+            return *t_buffer;
+        }
+    }  // namespace
+
+    bool IsEnabled()
+    {
+        static const bool enabled = PlatformUtilsGetEnvSet(c_enableEnvVar);
+        return enabled;
+    }
+
+    bool Record(const void* owner, XrDebugUtilsMessageSeverityFlagsEXT severity, const char* functionName, const char* fmtMessage)
+    {
+        if (!IsEnabled()) {
+            return true;
+        }
+
+        ThreadBuffer& buffer = GetThreadBuffer();
+        std::unique_lock<std::mutex> lock(buffer.mutex);
+        auto inserted = buffer.sites.emplace(SiteKey{owner, fmtMessage, functionName}, Site{severity});
+        if (inserted.second) {
+            return true;
+        }
+        inserted.first->second.repeatCount++;
+        return false;
+    }
+
+    void Flush(const void* owner, const RepeatReporter& reportRepeats)
+    {
+        if (!IsEnabled()) {
+            return;
+        }
+
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        {
+            Registry& registry = GetRegistry();
+            std::unique_lock<std::mutex> lock(registry.mutex);
+            buffers = registry.buffers;
+        }
+
+        // Take the sites out of the buffers first, so that reporting, which calls back into the application, is done without
+        // holding any of their locks.
+        std::vector<std::pair<SiteKey, Site>> repeated;
+        for (const std::shared_ptr<ThreadBuffer>& buffer : buffers) {
+            std::unique_lock<std::mutex> lock(buffer->mutex);
+            for (auto it = buffer->sites.begin(); it != buffer->sites.end();) {
+                if (it->first.owner != owner) {
+                    ++it;
+                    continue;
+                }
+                if (it->second.repeatCount > 0) {
+                    repeated.emplace_back(it->first, it->second);
+                }
+                it = buffer->sites.erase(it);
+            }
+        }
+
+        for (const auto& site : repeated) {
+            reportRepeats(site.second.severity, site.first.functionName.c_str(), site.first.fmtMessage, site.second.repeatCount);
+        }
+    }
+}  // namespace FailureBuffering
@@ -0,0 +1,48 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Opt-in deduplication of conformance failures, so that a runtime failing the same check every frame does not stall the
+// application behind formatting and reporting the same message over and over.
+//
+// Set the environment variable KHRONOS_runtime_conformance_buffer_failures (to any value) to report only the first failure of
+// each check (function and message) on each thread in full, and just count the repeats. The repeat counts are reported, and the
+// counting starts over, on xrEndSession and xrDestroyInstance.
+//
+#pragma once
+
+#include <openxr/openxr.h>
+
+#include <functional>
+#include <stdint.h>
+
+namespace FailureBuffering
+{
+    /// True if buffering was requested through the environment. Checked once.
+    bool IsEnabled();
+
+    /// Count a failure of the check identified by @p functionName and @p fmtMessage, made by @p owner.
+    /// Returns true if it must be reported now, which is always the case if buffering is not enabled.
+    /// @p fmtMessage must be a string literal: checks are told apart by its address, not its contents.
+    bool Record(const void* owner, XrDebugUtilsMessageSeverityFlagsEXT severity, const char* functionName, const char* fmtMessage);
+
+    using RepeatReporter = std::function<void(XrDebugUtilsMessageSeverityFlagsEXT severity, const char* functionName,
+                                              const char* fmtMessage, uint64_t repeatCount)>;
+
+    /// Pass the repeats of the failures made by @p owner on all threads since the last flush to @p reportRepeats, and forget
+    /// those failures, so the next one of each is reported in full again.
+    void Flush(const void* owner, const RepeatReporter& reportRepeats);
+}  // namespace FailureBuffering
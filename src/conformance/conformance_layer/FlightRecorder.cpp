@@ -0,0 +1,335 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "FlightRecorder.h"
+
+#include "Common.h"
+#include "LayerLog.h"
+
+#include "common/platform_utils.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <inttypes.h>
+#include <memory>
+#include <mutex>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+namespace FlightRecorder
+{
+    constexpr uint32_t c_maxArguments = 2;
+
+    struct Entry
+    {
+        uint64_t sequence;
+        const char* functionName;
+        uint64_t handle;
+        int64_t timestampNanoseconds;
+        /// XR_RESULT_MAX_ENUM until the call returns
+        XrResult result;
+        uint32_t argumentCount;
+        const char* argumentNames[c_maxArguments];
+        int64_t argumentValues[c_maxArguments];
+    };
+
+    namespace
+    {
+        constexpr const char* c_depthEnvVar = "KHRONOS_runtime_conformance_flight_recorder_depth";
+        constexpr const char* c_dumpOnErrorEnvVar = "KHRONOS_runtime_conformance_flight_recorder_dump_on_error";
+        constexpr uint32_t c_defaultDepth = 64;
+
+        int64_t NowNanoseconds()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        bool IsDumpOnErrorEnabled()
+        {
+            static const bool enabled = PlatformUtilsGetEnvSet(c_dumpOnErrorEnvVar);
+            return enabled;
+        }
+
+        /// The calls of one thread. Kept after the thread exits, so that a crash dump still has them.
+        struct Ring
+        {
+            Ring(uint32_t depth, uint32_t threadIndex) : entries(depth), threadIndex(threadIndex)
+            {
+            }
+
+            std::vector<Entry> entries;
+            /// Order in which the thread first made a call, to tell threads apart in the log.
+            const uint32_t threadIndex;
+            /// Calls recorded so far. Only the owning thread records, but a crash dump may read from any thread.
+            std::atomic<uint64_t> recordedCount{0};
+            /// Calls recorded as of the last dump.
+            std::atomic<uint64_t> dumpedCount{0};
+        };
+
+        struct Registry
+        {
+            std::mutex mutex;
+            std::vector<std::shared_ptr<Ring>> rings;
+        };
+
+        Registry& GetRegistry()
+        {
+            static Registry registry;
+            return registry;
+        }
+
+        /// Keeps the lines of concurrent dumps apart.
+        std::mutex& GetDumpMutex()
+        {
+            static std::mutex dumpMutex;
+            return dumpMutex;
+        }
+
+        Ring& GetThreadRing()
+        {
+            thread_local std::shared_ptr<Ring> t_ring = [] {
+                Registry& registry = GetRegistry();
+                std::unique_lock<std::mutex> lock(registry.mutex);
+                auto ring = std::make_shared<Ring>(GetDepth(), static_cast<uint32_t>(registry.rings.size()));
+                registry.rings.push_back(ring);
+                return ring;
+            }();
+            return *t_ring;
+        }
+
+        /// The innermost ScopedCall on this thread.
+        thread_local ScopedCall* t_currentCall = nullptr;
+
+        const char* ResultName(XrResult result)
+        {
+            return result == XR_RESULT_MAX_ENUM ? "(not returned)" : to_string(result);
+        }
+
+        /// Write the calls recorded in @p ring since its last dump, oldest first, with their times relative to @p nowNanoseconds.
+        void DumpRing(Ring& ring, const char* reason, int64_t nowNanoseconds)
+        {
+            const uint64_t recordedCount = ring.recordedCount.load(std::memory_order_acquire);
+            const uint64_t dumpedCount = ring.dumpedCount.exchange(recordedCount);
+            if (recordedCount <= dumpedCount) {
+                return;
+            }
+
+            const uint64_t depth = ring.entries.size();
+            const uint64_t first = recordedCount - dumpedCount > depth ? recordedCount - depth : dumpedCount;
+            LOG_INFO("Conformance Layer: last %" PRIu64 " call(s) on thread %u before %s, oldest first:\n", recordedCount - first,
+                     ring.threadIndex, reason);
+            if (first > dumpedCount) {
+                LOG_INFO("    (%" PRIu64 " earlier call(s) since the last dump not kept)\n", first - dumpedCount);
+            }
+            for (uint64_t sequence = first; sequence < recordedCount; ++sequence) {
+                const Entry& entry = ring.entries[sequence % depth];
+                char arguments[128] = "";
+                size_t length = 0;
+                for (uint32_t i = 0; i < entry.argumentCount && i < c_maxArguments && length < sizeof(arguments); ++i) {
+                    const int written = snprintf(arguments + length, sizeof(arguments) - length, " %s=%" PRId64, entry.argumentNames[i],
+                                                 entry.argumentValues[i]);
+                    length += written > 0 ? static_cast<size_t>(written) : 0;
+                }
+                const double offsetMilliseconds = static_cast<double>(entry.timestampNanoseconds - nowNanoseconds) / 1e6;
+                LOG_INFO("    %12.3f ms  %s(0x%" PRIx64 ")%s -> %s\n", offsetMilliseconds, entry.functionName, entry.handle, arguments,
+                         ResultName(entry.result));
+            }
+        }
+
+        /// Called on a crash, so it must not wait on a lock the crashing thread might hold.
+        void DumpAllThreads(const char* reason)
+        {
+            const int64_t nowNanoseconds = NowNanoseconds();
+            Registry& registry = GetRegistry();
+            std::unique_lock<std::mutex> lock(registry.mutex, std::try_to_lock);
+            if (!lock.owns_lock()) {
+                LOG_INFO("Conformance Layer: recent calls not available at %s\n", reason);
+                return;
+            }
+            // Dump even if another thread is dumping: its lines may be mixed in, but they may be the last ones written.
+            std::unique_lock<std::mutex> dumpLock(GetDumpMutex(), std::try_to_lock);
+            for (const std::shared_ptr<Ring>& ring : registry.rings) {
+                DumpRing(*ring, reason, nowNanoseconds);
+            }
+        }
+
+        std::mutex g_crashHandlerMutex;
+        uint32_t g_crashHandlerInstallCount = 0;
+
+#if defined(XR_USE_PLATFORM_WIN32)
+        LPTOP_LEVEL_EXCEPTION_FILTER g_previousExceptionFilter = nullptr;
+
+        LONG WINAPI OnUnhandledException(EXCEPTION_POINTERS* exceptionPointers)
+        {
+            DumpAllThreads("an unhandled exception");
+            return g_previousExceptionFilter != nullptr ? g_previousExceptionFilter(exceptionPointers) : EXCEPTION_CONTINUE_SEARCH;
+        }
+
+        void InstallHandlers()
+        {
+            g_previousExceptionFilter = SetUnhandledExceptionFilter(&OnUnhandledException);
+        }
+
+        void UninstallHandlers()
+        {
+            // Leave a filter installed after this one in place.
+            const LPTOP_LEVEL_EXCEPTION_FILTER current = SetUnhandledExceptionFilter(g_previousExceptionFilter);
+            if (current != &OnUnhandledException) {
+                SetUnhandledExceptionFilter(current);
+            }
+        }
+#else
+        constexpr int c_crashSignals[] = {SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT};
+        constexpr size_t c_crashSignalCount = sizeof(c_crashSignals) / sizeof(c_crashSignals[0]);
+        struct sigaction g_previousActions[c_crashSignalCount];
+
+        void OnCrashSignal(int signalNumber)
+        {
+            // Best effort: formatting the log is not async-signal-safe, but the process is going down anyway.
+            DumpAllThreads("a crash");
+
+            // Hand the signal on as if this handler had never been installed.
+            for (size_t i = 0; i < c_crashSignalCount; ++i) {
+                if (c_crashSignals[i] == signalNumber) {
+                    sigaction(signalNumber, &g_previousActions[i], nullptr);
+                }
+            }
+            raise(signalNumber);
+        }
+
+        void InstallHandlers()
+        {
+            struct sigaction action = {};
+            action.sa_handler = &OnCrashSignal;
+            sigemptyset(&action.sa_mask);
+            for (size_t i = 0; i < c_crashSignalCount; ++i) {
+                sigaction(c_crashSignals[i], &action, &g_previousActions[i]);
+            }
+        }
+
+        void UninstallHandlers()
+        {
+            for (size_t i = 0; i < c_crashSignalCount; ++i) {
+                // Leave a handler installed after this one in place.
+                struct sigaction current = {};
+                if (sigaction(c_crashSignals[i], nullptr, &current) == 0 && current.sa_handler == &OnCrashSignal) {
+                    sigaction(c_crashSignals[i], &g_previousActions[i], nullptr);
+                }
+            }
+        }
+#endif
+    }  // namespace
+
+    uint32_t GetDepth()
+    {
+        static const uint32_t depth = [] {
+            const std::string value = PlatformUtilsGetEnv(c_depthEnvVar);
+            return value.empty() ? c_defaultDepth : static_cast<uint32_t>(strtoul(value.c_str(), nullptr, 10));
+        }();
+        return depth;
+    }
+
+    ScopedCall::ScopedCall(const char* functionName, uint64_t handle)
+    {
+        if (GetDepth() == 0) {
+            return;
+        }
+
+        Ring& ring = GetThreadRing();
+        const uint64_t sequence = ring.recordedCount.load(std::memory_order_relaxed);
+        Entry& entry = ring.entries[sequence % ring.entries.size()];
+        entry.sequence = sequence;
+        entry.functionName = functionName;
+        entry.handle = handle;
+        entry.timestampNanoseconds = NowNanoseconds();
+        entry.result = XR_RESULT_MAX_ENUM;
+        entry.argumentCount = 0;
+        ring.recordedCount.store(sequence + 1, std::memory_order_release);
+
+        m_entry = &entry;
+        m_sequence = sequence;
+        m_outer = t_currentCall;
+        t_currentCall = this;
+    }
+
+    ScopedCall::~ScopedCall()
+    {
+        if (m_entry != nullptr) {
+            t_currentCall = m_outer;
+        }
+    }
+
+    XrResult ScopedCall::Returned(XrResult result)
+    {
+        if (m_entry == nullptr) {
+            return result;
+        }
+        // Calls made from within this one, such as from a debug messenger callback, may have wrapped around the ring.
+        if (m_entry->sequence == m_sequence) {
+            m_entry->result = result;
+        }
+        if (XR_FAILED(result) && IsDumpOnErrorEnabled()) {
+            DumpThread("an error result");
+        }
+        return result;
+    }
+
+    void AddArgument(const char* name, int64_t value)
+    {
+        ScopedCall* const call = t_currentCall;
+        if (call == nullptr || call->m_entry->sequence != call->m_sequence || call->m_entry->argumentCount >= c_maxArguments) {
+            return;
+        }
+        Entry& entry = *call->m_entry;
+        entry.argumentNames[entry.argumentCount] = name;
+        entry.argumentValues[entry.argumentCount] = value;
+        entry.argumentCount++;
+    }
+
+    void DumpThread(const char* reason)
+    {
+        if (GetDepth() == 0) {
+            return;
+        }
+        std::unique_lock<std::mutex> dumpLock(GetDumpMutex());
+        DumpRing(GetThreadRing(), reason, NowNanoseconds());
+    }
+
+    void InstallCrashHandler()
+    {
+        if (GetDepth() == 0) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(g_crashHandlerMutex);
+        if (g_crashHandlerInstallCount++ == 0) {
+            InstallHandlers();
+        }
+    }
+
+    void UninstallCrashHandler()
+    {
+        if (GetDepth() == 0) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(g_crashHandlerMutex);
+        if (g_crashHandlerInstallCount > 0 && --g_crashHandlerInstallCount == 0) {
+            UninstallHandlers();
+        }
+    }
+}  // namespace FlightRecorder
@@ -0,0 +1,77 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Always-on record of the most recent calls made through the layer on each thread, used by the generated dispatch code, so that
+// a failure late in a long run comes with the calls that led up to it.
+//
+// Each thread keeps its last KHRONOS_runtime_conformance_flight_recorder_depth calls (64 if not set, 0 turns recording off): the
+// function, its first handle, when it was made, its result, and up to two key arguments such as display times and swapchain
+// image indices. Recording a call only stores integers and pointers to string literals, without locking or formatting.
+//
+// The calls are written to the log when the layer reports a conformance error, on a crash, and, if
+// KHRONOS_runtime_conformance_flight_recorder_dump_on_error is set (to any value), whenever a call returns an XR_ERROR_* result.
+// Each dump of a thread only writes the calls made since the last one.
+//
+#pragma once
+
+#include <openxr/openxr.h>
+
+#include <stdint.h>
+
+namespace FlightRecorder
+{
+    /// Number of calls kept for each thread, 0 if recording is turned off. Read from the environment once.
+    uint32_t GetDepth();
+
+    struct Entry;
+
+    /// Records one call of a layer entry point on the calling thread. Does nothing if recording is turned off.
+    class ScopedCall
+    {
+    public:
+        ScopedCall(const char* functionName, uint64_t handle);
+        ~ScopedCall();
+
+        ScopedCall(const ScopedCall&) = delete;
+        ScopedCall& operator=(const ScopedCall&) = delete;
+
+        /// Record @p result as the result of the call, and return it.
+        XrResult Returned(XrResult result);
+
+    private:
+        friend void AddArgument(const char* name, int64_t value);
+
+        Entry* m_entry{nullptr};
+        uint64_t m_sequence{0};
+        ScopedCall* m_outer{nullptr};
+    };
+
+    /// Attach a key argument to the innermost call being recorded on this thread.
+    /// @p name must be a string literal. Arguments beyond the second of a call are dropped.
+    void AddArgument(const char* name, int64_t value);
+
+    /// Write the calls recorded on this thread since its last dump to the log, with @p reason (a string literal).
+    void DumpThread(const char* reason);
+
+    /// Write the calls of every thread to the log on a crash, before passing it on to the handler installed before.
+    /// Called when an instance is created, and matched by @ref UninstallCrashHandler when it is destroyed: the handler is
+    /// installed while any instance exists, since the loader may unload the layer once none do.
+    void InstallCrashHandler();
+
+    /// Matches @ref InstallCrashHandler.
+    void UninstallCrashHandler();
+}  // namespace FlightRecorder
@@ -0,0 +1,122 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "FrameTiming.h"
+
+#include "LayerLog.h"
+
+#include "common/platform_utils.hpp"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+namespace FrameTiming
+{
+    namespace
+    {
+        constexpr const char* c_reportEnvVar = "KHRONOS_runtime_conformance_frame_timing";
+        constexpr const char* c_beginFrameBudgetEnvVar = "KHRONOS_runtime_conformance_begin_frame_budget_us";
+        constexpr const char* c_swapchainWaitBudgetEnvVar = "KHRONOS_runtime_conformance_swapchain_wait_budget_us";
+
+        XrDuration GetEnvMicrosecondsAsNanoseconds(const char* name)
+        {
+            const std::string value = PlatformUtilsGetEnv(name);
+            return value.empty() ? 0 : static_cast<XrDuration>(strtoull(value.c_str(), nullptr, 10) * 1000);
+        }
+
+        const char* ToString(Call call)
+        {
+            switch (call) {
+            case Call::WaitFrame:
+                return "xrWaitFrame";
+            case Call::BeginFrame:
+                return "xrBeginFrame";
+            case Call::EndFrame:
+                return "xrEndFrame";
+            case Call::WaitSwapchainImage:
+                return "xrWaitSwapchainImage";
+            case Call::Count:
+                break;
+            }
+            return "";
+        }
+
+        double ToMicroseconds(uint64_t nanoseconds)
+        {
+            return static_cast<double>(nanoseconds) / 1000.0;
+        }
+    }  // namespace
+
+    bool IsReportEnabled()
+    {
+        static const bool enabled = PlatformUtilsGetEnvSet(c_reportEnvVar);
+        return enabled;
+    }
+
+    XrDuration GetBeginFrameBudget()
+    {
+        static const XrDuration budget = GetEnvMicrosecondsAsNanoseconds(c_beginFrameBudgetEnvVar);
+        return budget;
+    }
+
+    XrDuration GetSwapchainWaitBudget()
+    {
+        static const XrDuration budget = GetEnvMicrosecondsAsNanoseconds(c_swapchainWaitBudgetEnvVar);
+        return budget;
+    }
+
+    void SessionFrameTiming::Record(Call call, XrDuration nanoseconds)
+    {
+        if (!IsReportEnabled() || nanoseconds < 0) {
+            return;
+        }
+        CallTiming& timing = m_calls[static_cast<size_t>(call)];
+        const uint64_t duration = static_cast<uint64_t>(nanoseconds);
+        timing.count.fetch_add(1, std::memory_order_relaxed);
+        timing.totalNanoseconds.fetch_add(duration, std::memory_order_relaxed);
+        uint64_t max = timing.maxNanoseconds.load(std::memory_order_relaxed);
+        while (duration > max && !timing.maxNanoseconds.compare_exchange_weak(max, duration, std::memory_order_relaxed)) {
+        }
+        timing.histogram.Add(duration);
+    }
+
+    void SessionFrameTiming::RecordViolation(Call call)
+    {
+        m_calls[static_cast<size_t>(call)].violationCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void SessionFrameTiming::Report(XrSession session) const
+    {
+        if (!IsReportEnabled()) {
+            return;
+        }
+
+        LOG_INFO("Conformance Layer: frame timing for session 0x%" PRIx64 " (times in microseconds, percentiles approximate)\n",
+                 (uint64_t)session);
+        LOG_INFO("%-24s %10s %10s %10s %10s %10s %10s\n", "function", "calls", "mean", "p50", "p99", "max", "violations");
+        for (uint32_t i = 0; i < static_cast<uint32_t>(Call::Count); ++i) {
+            const CallTiming& timing = m_calls[i];
+            const uint64_t count = timing.count.load(std::memory_order_relaxed);
+            const uint64_t total = timing.totalNanoseconds.load(std::memory_order_relaxed);
+            LOG_INFO("%-24s %10" PRIu64 " %10.2f %10.2f %10.2f %10.2f %10" PRIu64 "\n", ToString(static_cast<Call>(i)), count,
+                     count == 0 ? 0.0 : ToMicroseconds(total) / static_cast<double>(count), ToMicroseconds(timing.histogram.Quantile(0.5)),
+                     ToMicroseconds(timing.histogram.Quantile(0.99)), ToMicroseconds(timing.maxNanoseconds.load(std::memory_order_relaxed)),
+                     timing.violationCount.load(std::memory_order_relaxed));
+        }
+    }
+}  // namespace FrameTiming
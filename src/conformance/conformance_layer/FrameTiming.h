@@ -0,0 +1,89 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Timing of the frame loop, per session.
+//
+// xrBeginFrame is checked against a budget of one predicted display period, or
+// KHRONOS_runtime_conformance_begin_frame_budget_us if set, since xrWaitFrame is where the runtime should throttle the application.
+// xrWaitSwapchainImage is checked against KHRONOS_runtime_conformance_swapchain_wait_budget_us if set.
+// Set KHRONOS_runtime_conformance_frame_timing (to any value) to write a latency report for each session to the log when it is
+// destroyed.
+//
+#pragma once
+
+#include "CallStats.h"
+
+#include <openxr/openxr.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+
+namespace FrameTiming
+{
+    using Clock = CallStats::Clock;
+
+    inline XrDuration NanosecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    }
+
+    enum class Call : uint32_t
+    {
+        WaitFrame,
+        BeginFrame,
+        EndFrame,
+        WaitSwapchainImage,
+        Count
+    };
+
+    /// True if the per-session report was requested through the environment. Checked once.
+    bool IsReportEnabled();
+
+    /// Longest xrBeginFrame expected, or 0 to use one predicted display period. Checked once.
+    XrDuration GetBeginFrameBudget();
+
+    /// Longest xrWaitSwapchainImage expected, or 0 for no limit. Checked once.
+    XrDuration GetSwapchainWaitBudget();
+
+    /// Frame loop call durations and budget overruns of one session. Safe to use from any thread.
+    class SessionFrameTiming
+    {
+    public:
+        /// Record the duration of a call, if the report is enabled.
+        void Record(Call call, XrDuration nanoseconds);
+
+        /// Count a call that broke the timing contract: over budget, or with inconsistent predicted display times.
+        void RecordViolation(Call call);
+
+        /// Write the report to the log. Does nothing if the report is not enabled.
+        void Report(XrSession session) const;
+
+    private:
+        struct CallTiming
+        {
+            std::atomic<uint64_t> count{0};
+            std::atomic<uint64_t> totalNanoseconds{0};
+            std::atomic<uint64_t> maxNanoseconds{0};
+            std::atomic<uint64_t> violationCount{0};
+            CallStats::DurationHistogram histogram;
+        };
+
+        std::array<CallTiming, static_cast<size_t>(Call::Count)> m_calls;
+    };
+}  // namespace FrameTiming
@@ -19,10 +19,14 @@
 #include "Common.h"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <iosfwd>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <stddef.h>
+#include <stdint.h>
 #include <string>
 #include <type_traits>
 #include <unordered_map>
@@ -31,72 +35,179 @@
 
 namespace
 {
+    /// Handle values are frequently small integers or aligned pointers, and object types are small integers,
+    /// so combine them then run through a 64-bit finalizer (from SplitMix64) to spread all bits over the result.
+    inline uint64_t MixHandleStateKey(const HandleStateKey& k)
+    {
+        uint64_t h = k.first ^ (static_cast<uint64_t>(k.second) * 0x9E3779B97F4A7C15ull);
+        h ^= h >> 30;
+        h *= 0xBF58476D1CE4E5B9ull;
+        h ^= h >> 27;
+        h *= 0x94D049BB133111EBull;
+        h ^= h >> 31;
+        return h;
+    }
+
     struct HandleStateKeyHash
     {
         std::size_t operator()(const HandleStateKey& k) const
         {
-            // Combine hashes of both handle value and object type enum.
-            return std::hash<IntHandle>()(k.first) ^ std::hash<int>()((int)k.second);
+            return static_cast<std::size_t>(MixHandleStateKey(k));
         }
     };
 
-    std::unordered_map<HandleStateKey, std::unique_ptr<HandleState>, HandleStateKeyHash> g_handleStates;
-    std::mutex g_handleStatesMutex;
+    using HandleStateMap = std::unordered_map<HandleStateKey, std::unique_ptr<HandleState>, HandleStateKeyHash>;
+
+    /// One slice of the handle registry. Lookups only take a shared lock on a single shard,
+    /// so concurrent intercepted calls on different threads do not serialize on each other.
+    struct HandleStateShard
+    {
+        std::shared_timed_mutex mutex;
+        HandleStateMap handleStates;
+    };
+
+    constexpr size_t c_handleStateShardCount = 16;
+    std::array<HandleStateShard, c_handleStateShardCount> g_handleStateShards;
+
+    /// Serializes registration and unregistration, which may touch several shards (recursively removing children).
+    /// Lookups never take this.
+    std::mutex g_handleStateWriterMutex;
+
+    HandleStateShard& GetShard(const HandleStateKey& key)
+    {
+        // Use the high bits: the low bits pick the bucket within the shard's map.
+        return g_handleStateShards[(MixHandleStateKey(key) >> 56) % c_handleStateShardCount];
+    }
+
+    /// Bumped after every removal from the registry, before the removed state is destroyed,
+    /// so that per-thread caches never return a state that has left the registry.
+    std::atomic<uint64_t> g_handleStateGeneration{0};
+
+    /// The last few handles looked up on this thread: apps tend to call through the same session and spaces repeatedly.
+    struct HandleStateCache
+    {
+        struct Entry
+        {
+            HandleStateKey key{0, XR_OBJECT_TYPE_UNKNOWN};
+            HandleState* handleState{nullptr};
+            uint64_t generation{0};
+        };
+
+        static constexpr size_t c_entryCount = 4;
+        std::array<Entry, c_entryCount> entries;
+        size_t nextEntry{0};
+    };
+
+    thread_local HandleStateCache t_handleStateCache;
 }  // namespace
 
 void RegisterHandleState(std::unique_ptr<HandleState> handleState)
 {
-    std::unique_lock<std::mutex> lock(g_handleStatesMutex);
+    std::unique_lock<std::mutex> writerLock(g_handleStateWriterMutex);
     HandleStateKey mapKey(handleState->handle, handleState->type);
-    auto it = g_handleStates.insert(std::pair<HandleStateKey, std::unique_ptr<HandleState>>(mapKey, std::move(handleState)));
+    HandleStateShard& shard = GetShard(mapKey);
+    std::unique_lock<std::shared_timed_mutex> lock(shard.mutex);
+    auto it = shard.handleStates.insert(std::pair<HandleStateKey, std::unique_ptr<HandleState>>(mapKey, std::move(handleState)));
     if (!it.second) {
         throw HandleException(std::string("Encountered duplicate ") + to_string(mapKey.second) + " handle with value " +
                               std::to_string(mapKey.first));
     }
 }
 
-void UnregisterHandleStateInternal(std::unique_lock<std::mutex>& lockProof, HandleStateKey key)
+/// Remove a handle and all of its descendants from the registry, returning their states for the caller to destroy.
+std::vector<std::unique_ptr<HandleState>> UnregisterHandleStateInternal(std::unique_lock<std::mutex>& lockProof, HandleStateKey key)
 {
-    auto it = g_handleStates.find(key);
-    if (it == g_handleStates.end()) {
-        throw HandleException(std::string("Encountered unknown ") + to_string(key.second) + " handle with value " +
-                              std::to_string(key.first));
-    }
+    (void)lockProof;
 
-    // Unregister children from map (recursively)
+    HandleState* root = nullptr;
     {
-        std::unique_lock<std::recursive_mutex> lock(it->second->childrenMutex);
-        while (!it->second->children.empty()) {
-            // Unregistering the child will cause it to be removed from the list of children.
-            HandleState* const frontChild = it->second->children.front();
-            UnregisterHandleStateInternal(lockProof, HandleStateKey(frontChild->handle, frontChild->type));
+        HandleStateShard& shard = GetShard(key);
+        std::shared_lock<std::shared_timed_mutex> lock(shard.mutex);
+        auto it = shard.handleStates.find(key);
+        if (it == shard.handleStates.end()) {
+            throw HandleException(std::string("Encountered unknown ") + to_string(key.second) + " handle with value " +
+                                  std::to_string(key.first));
         }
+        // Only writers erase from the map, and we hold the writer lock, so this stays valid after unlocking.
+        root = it->second.get();
+    }
+
+    // Collect the whole subtree, parents before children. The children lists of states being removed are left alone:
+    // only the root's parent, which survives, needs its list updated.
+    std::vector<HandleState*> subtree{root};
+    for (size_t i = 0; i < subtree.size(); ++i) {
+        std::unique_lock<std::recursive_mutex> lock(subtree[i]->childrenMutex);
+        subtree.insert(subtree.end(), subtree[i]->children.begin(), subtree[i]->children.end());
     }
 
-    if (it->second->parent != nullptr) {  // XrInstance has no parent
+    if (root->parent != nullptr) {  // XrInstance has no parent
         // Remove self from parent's list of children
-        std::unique_lock<std::recursive_mutex> lock(it->second->parent->childrenMutex);
-        std::vector<HandleState*>& siblings = it->second->parent->children;
-        siblings.erase(std::remove(siblings.begin(), siblings.end(), it->second.get()), siblings.end());
+        std::unique_lock<std::recursive_mutex> lock(root->parent->childrenMutex);
+        std::vector<HandleState*>& siblings = root->parent->children;
+        siblings.erase(std::remove(siblings.begin(), siblings.end(), root), siblings.end());
     }
 
-    // Finally remove self from map.
-    g_handleStates.erase(it);
+    // Remove the subtree from the map, locking each shard once.
+    std::array<std::vector<size_t>, c_handleStateShardCount> subtreeIndicesByShard;
+    for (size_t i = 0; i < subtree.size(); ++i) {
+        const HandleStateKey subtreeKey(subtree[i]->handle, subtree[i]->type);
+        subtreeIndicesByShard[&GetShard(subtreeKey) - g_handleStateShards.data()].push_back(i);
+    }
+    std::vector<std::unique_ptr<HandleState>> removed(subtree.size());
+    for (size_t shardIndex = 0; shardIndex < c_handleStateShardCount; ++shardIndex) {
+        if (subtreeIndicesByShard[shardIndex].empty()) {
+            continue;
+        }
+        HandleStateShard& shard = g_handleStateShards[shardIndex];
+        std::unique_lock<std::shared_timed_mutex> lock(shard.mutex);
+        for (size_t i : subtreeIndicesByShard[shardIndex]) {
+            auto it = shard.handleStates.find(HandleStateKey(subtree[i]->handle, subtree[i]->type));
+            removed[i] = std::move(it->second);
+            shard.handleStates.erase(it);
+        }
+    }
+    g_handleStateGeneration.fetch_add(1, std::memory_order_acq_rel);
+    return removed;
 }
 
 void UnregisterHandleState(HandleStateKey key)
 {
-    std::unique_lock<std::mutex> lock(g_handleStatesMutex);
-    UnregisterHandleStateInternal(lock, key);
+    std::vector<std::unique_ptr<HandleState>> removed;
+    {
+        std::unique_lock<std::mutex> lock(g_handleStateWriterMutex);
+        removed = UnregisterHandleStateInternal(lock, key);
+    }
+
+    // Destroy the states once no reader can find them, outside the writer lock, children before their parents.
+    while (!removed.empty()) {
+        removed.pop_back();
+    }
 }
 
 HandleState* GetHandleState(HandleStateKey key)
 {
-    std::unique_lock<std::mutex> lock(g_handleStatesMutex);
-    auto it = g_handleStates.find(key);
-    if (it == g_handleStates.end()) {
-        throw HandleNotFoundException(std::string("Encountered unknown ") + to_string(key.second) + " handle with value " +
-                                      std::to_string(key.first));
+    // Read the generation before the registry, so a removal racing with this lookup invalidates what gets cached.
+    const uint64_t generation = g_handleStateGeneration.load(std::memory_order_acquire);
+    HandleStateCache& cache = t_handleStateCache;
+    for (const HandleStateCache::Entry& entry : cache.entries) {
+        if (entry.generation == generation && entry.handleState != nullptr && entry.key == key) {
+            return entry.handleState;
+        }
+    }
+
+    HandleState* handleState;
+    {
+        HandleStateShard& shard = GetShard(key);
+        std::shared_lock<std::shared_timed_mutex> lock(shard.mutex);
+        auto it = shard.handleStates.find(key);
+        if (it == shard.handleStates.end()) {
+            throw HandleNotFoundException(std::string("Encountered unknown ") + to_string(key.second) + " handle with value " +
+                                          std::to_string(key.first));
+        }
+        handleState = it->second.get();
     }
-    return it->second.get();
+
+    cache.entries[cache.nextEntry] = {key, handleState, generation};
+    cache.nextEntry = (cache.nextEntry + 1) % HandleStateCache::c_entryCount;
+    return handleState;
 }
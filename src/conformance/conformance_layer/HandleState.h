@@ -21,10 +21,12 @@
 
 #include <openxr/openxr.h>
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <stdexcept>
+#include <string>
 #include <vector>
 
 struct EnabledVersions
@@ -53,6 +55,21 @@ struct ICustomHandleState
     ICustomHandleState& operator=(ICustomHandleState&) = delete;
 };
 
+/// Handle exception type: Inherit from std::runtime_error so it can be caught in the ABI boundary.
+struct HandleException : public std::runtime_error
+{
+    HandleException(const std::string& message) : std::runtime_error(message)
+    {
+    }
+};
+
+struct HandleNotFoundException : public HandleException
+{
+    HandleNotFoundException(const std::string& message) : HandleException(message)
+    {
+    }
+};
+
 using IntHandle = uint64_t;   // A common type for all handles so a single map can be used.
 struct ConformanceHooksBase;  // forward-declare
 
@@ -78,16 +95,22 @@ struct HandleState
         return childState;
     }
 
+    /// Publish the custom state for this handle. May only be called once per handle, typically right after creation:
+    /// the state is then immutable (as far as this object is concerned) until the handle is destroyed.
     void SetCustomState(std::unique_ptr<ICustomHandleState>&& newCustomState)
     {
-        std::unique_lock<std::mutex> lock(customStateMutex);
-        customState = std::move(newCustomState);
+        ICustomHandleState* expected = nullptr;
+        if (!customState.compare_exchange_strong(expected, newCustomState.get(), std::memory_order_acq_rel)) {
+            throw HandleException("Custom handle state may only be set once");
+        }
+        // Only the single successful caller gets here, and readers only ever go through the atomic.
+        customStateOwner = std::move(newCustomState);
     }
 
+    /// Lock-free: returns nullptr if no custom state has been published yet.
     ICustomHandleState* GetCustomState() const
     {
-        std::unique_lock<std::mutex> lock(customStateMutex);
-        return customState.get();
+        return customState.load(std::memory_order_acquire);
     }
 
     const IntHandle handle;
@@ -104,23 +127,8 @@ struct HandleState
 
 private:
     /// Additional data stored by the hand-coded validations.
-    mutable std::mutex customStateMutex;
-    std::unique_ptr<ICustomHandleState> customState;
-};
-
-/// Handle exception type: Inherit from std::runtime_error so it can be caught in the ABI boundary.
-struct HandleException : public std::runtime_error
-{
-    HandleException(const std::string& message) : std::runtime_error(message)
-    {
-    }
-};
-
-struct HandleNotFoundException : public HandleException
-{
-    HandleNotFoundException(const std::string& message) : HandleException(message)
-    {
-    }
+    std::atomic<ICustomHandleState*> customState{nullptr};
+    std::unique_ptr<ICustomHandleState> customStateOwner;
 };
 
 using HandleStateKey = std::pair<IntHandle, XrObjectType>;
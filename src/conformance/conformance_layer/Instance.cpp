@@ -38,6 +38,17 @@ namespace instance
 // ABI
 /////////////////
 
+XrResult ConformanceHooks::xrDestroyInstance(XrInstance instance)
+{
+    // Report buffered failures while the instance can still deliver them.
+    FlushBufferedFailures();
+    const XrResult result = ConformanceHooksBase::xrDestroyInstance(instance);
+    if (XR_SUCCEEDED(result)) {
+        FlightRecorder::UninstallCrashHandler();
+    }
+    return result;
+}
+
 XrResult ConformanceHooks::xrEnumerateViewConfigurations(XrInstance instance, XrSystemId systemId,
                                                          uint32_t viewConfigurationTypeCapacityInput,
                                                          uint32_t* viewConfigurationTypeCountOutput,
@@ -79,6 +90,9 @@ XrResult ConformanceHooks::xrEnumerateEnvironmentBlendModes(XrInstance instance,
 XrResult ConformanceHooks::xrPollEvent(XrInstance instance, XrEventDataBuffer* eventData)
 {
     const XrResult result = ConformanceHooksBase::xrPollEvent(instance, eventData);
+    if (result == XR_SUCCESS) {
+        FlightRecorder::AddArgument("eventType", eventData->type);
+    }
 
     if (result == XR_EVENT_UNAVAILABLE) {
         const HandleState* const instanceState = instance::GetInstanceState(instance);
@@ -0,0 +1,29 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Logging for the opt-in diagnostics of the layer (call statistics, validation sampling, frame timing, the flight recorder),
+// which write to the log rather than report conformance failures.
+//
+#pragma once
+
+#if defined(ANDROID)
+#include <android/log.h>
+#define LOG_INFO(...) __android_log_print(ANDROID_LOG_INFO, "XrApiLayer_runtime_conformance", __VA_ARGS__)
+#else
+#include <stdio.h>
+#define LOG_INFO(...) fprintf(stderr, __VA_ARGS__)
+#endif
@@ -16,6 +16,7 @@
 
 #include "Common.h"
 #include "ConformanceHooks.h"
+#include "FlightRecorder.h"
 #include "HandleState.h"
 #include "gen_dispatch.h"
 
@@ -54,6 +55,9 @@ namespace
             RegisterHandleState(std::unique_ptr<HandleState>(
                 new HandleState((IntHandle)*instance, XR_OBJECT_TYPE_INSTANCE, nullptr /* no parent */, conformanceHooks)));
 
+            // Uninstalled by xrDestroyInstance.
+            FlightRecorder::InstallCrashHandler();
+
             return XR_SUCCESS;
         }
         catch (...) {
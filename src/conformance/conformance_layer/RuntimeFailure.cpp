@@ -18,34 +18,39 @@
 #include <iostream>
 #include <cmath>
 #include <stdarg.h>
+#include <memory>
+#include <string>
 #include "Common.h"
 #include "ConformanceHooks.h"
+#include "FailureBuffering.h"
 #include "RuntimeFailure.h"
 
 namespace
 {
-    void RuntimeFailure(const XrGeneratedDispatchTable* dispatchTable, XrInstance instance, XrDebugUtilsMessageSeverityFlagsEXT severity,
-                        const char* xrFuncName, const char* detailsFmt, va_list vl)
+    std::string FormatDetails(const char* detailsFmt, va_list vl)
     {
         std::string detailsStr;
-        {
-            va_list vl2;
+        va_list vl2;
+        va_copy(vl2, vl);
+        int size = std::vsnprintf(nullptr, 0, detailsFmt, vl2);
+        va_end(vl2);
+
+        if (size != -1) {
+            std::unique_ptr<char[]> buffer(new char[size + 1]);
+
             va_copy(vl2, vl);
-            int size = std::vsnprintf(nullptr, 0, detailsFmt, vl2);
+            size = std::vsnprintf(buffer.get(), size + 1, detailsFmt, vl2);
             va_end(vl2);
-
             if (size != -1) {
-                std::unique_ptr<char[]> buffer(new char[size + 1]);
-
-                va_copy(vl2, vl);
-                size = std::vsnprintf(buffer.get(), size + 1, detailsFmt, vl2);
-                va_end(vl2);
-                if (size != -1) {
-                    detailsStr = std::string(buffer.get(), size);
-                }
+                detailsStr = std::string(buffer.get(), size);
             }
         }
+        return detailsStr;
+    }
 
+    void RuntimeFailure(const XrGeneratedDispatchTable* dispatchTable, XrInstance instance, XrDebugUtilsMessageSeverityFlagsEXT severity,
+                        const char* xrFuncName, const std::string& detailsStr)
+    {
         std::stringstream ss;
         ss << "[" << xrFuncName << "]:" << detailsStr << std::endl;
         const std::string directMsg = ss.str();
@@ -79,10 +84,30 @@ namespace
 void ConformanceHooks::ConformanceFailure(XrDebugUtilsMessageSeverityFlagsEXT severity, const char* functionName, const char* fmtMessage,
                                           ...)
 {
+    // Repeats of a failure already reported are only counted, without formatting them.
+    if (!FailureBuffering::Record(this, severity, functionName, fmtMessage)) {
+        return;
+    }
+
     va_list vl;
     va_start(vl, fmtMessage);
-    RuntimeFailure(&this->dispatchTable, this->instance, severity, functionName, fmtMessage, vl);
+    const std::string detailsStr = FormatDetails(fmtMessage, vl);
     va_end(vl);
+    RuntimeFailure(&this->dispatchTable, this->instance, severity, functionName, detailsStr);
+
+    if (severity & XR_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT) {
+        FlightRecorder::DumpThread("a conformance error");
+    }
+}
+
+void ConformanceHooks::FlushBufferedFailures()
+{
+    FailureBuffering::Flush(this, [&](XrDebugUtilsMessageSeverityFlagsEXT severity, const char* functionName, const char* fmtMessage,
+                                      uint64_t repeatCount) {
+        std::ostringstream details;
+        details << "Failure repeated " << repeatCount << " more time(s) since first reported: " << fmtMessage;
+        RuntimeFailure(&this->dispatchTable, this->instance, severity, functionName, details.str());
+    });
 }
 
 XrBaseStructChainValidator::XrBaseStructChainValidator(ConformanceHooksBase* conformanceHook, const void* arg, std::string parameterName,
@@ -130,6 +155,10 @@ void ValidateXrBool32(ConformanceHooksBase* conformanceHook, XrBool32 value, con
 void ValidateFloat(ConformanceHooksBase* conformanceHook, float value, float min, float max, const char* valueName,
                    const char* xrFunctionName)
 {
+    if (!ValidationSampling::ShouldCheckValue()) {
+        return;
+    }
+
     if (value < min || value > max) {
         conformanceHook->ConformanceFailure(XR_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT, xrFunctionName,
                                             "%s float value is out of range [%f, %f]: %f", valueName, min, max, value);
@@ -138,6 +167,10 @@ void ValidateFloat(ConformanceHooksBase* conformanceHook, float value, float min
 
 void ValidateXrTime(ConformanceHooksBase* conformanceHook, XrTime time, const char* valueName, const char* xrFunctionName)
 {
+    if (!ValidationSampling::ShouldCheckValue()) {
+        return;
+    }
+
     // TODO: The spec does not disallow this.
     if (time < 0) {
         conformanceHook->ConformanceFailure(XR_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT, xrFunctionName,
@@ -147,6 +180,10 @@ void ValidateXrTime(ConformanceHooksBase* conformanceHook, XrTime time, const ch
 
 void ValidateXrQuaternion(ConformanceHooksBase* conformanceHook, const XrQuaternionf& q, const char* valueName, const char* xrFunctionName)
 {
+    if (!ValidationSampling::ShouldCheckValue()) {
+        return;
+    }
+
     float length;
     if (!IsUnitQuaternion(q, &length)) {
         conformanceHook->ConformanceFailure(XR_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT, xrFunctionName,
@@ -157,6 +194,10 @@ void ValidateXrQuaternion(ConformanceHooksBase* conformanceHook, const XrQuatern
 
 void ValidateXrVector3f(ConformanceHooksBase* conformanceHook, const XrVector3f& v, const char* valueName, const char* xrFunctionName)
 {
+    if (!ValidationSampling::ShouldCheckValue()) {
+        return;
+    }
+
     auto isValidFloat = [](float v) { return std::isfinite(v); };
 
     if (!isValidFloat(v.x) || !isValidFloat(v.y) || !isValidFloat(v.z)) {
@@ -18,6 +18,8 @@
 
 #include "Common.h"
 #include "gen_dispatch.h"
+#include "FlightRecorder.h"
+#include "ValidationSampling.h"
 #include <openxr/openxr_reflection.h>
 
 // Backs up the chain of type and next pointers. On destruction, validates there have been no changes.
@@ -36,6 +38,7 @@ private:
 };
 
 void ValidateXrBool32(ConformanceHooksBase* conformanceHook, XrBool32 value, const char* valueName, const char* xrFunctionName);
+// The checks of float, time, quaternion and vector values are skipped in calls not sampled by SAMPLE_VALIDATION.
 void ValidateFloat(ConformanceHooksBase* conformanceHook, float value, float min, float max, const char* valueName,
                    const char* xrFunctionName);
 void ValidateXrTime(ConformanceHooksBase* conformanceHook, XrTime time, const char* valueName, const char* xrFunctionName);
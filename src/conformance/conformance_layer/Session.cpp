@@ -40,6 +40,38 @@ namespace
 
         return s_validStateTransitions.find(std::make_pair(oldState, newState)) != s_validStateTransitions.end();
     };
+
+    // Counts an xrEndFrame call as in flight for its lifetime, if it may submit a frame.
+    class ScopedEndFrameInFlight
+    {
+    public:
+        ScopedEndFrameInFlight(std::atomic<uint32_t>& endFramesInFlight, bool maySubmitFrame)
+            : m_endFramesInFlight(maySubmitFrame ? &endFramesInFlight : nullptr)
+        {
+            if (m_endFramesInFlight != nullptr) {
+                (*m_endFramesInFlight)++;
+            }
+        }
+        ~ScopedEndFrameInFlight()
+        {
+            if (m_endFramesInFlight != nullptr) {
+                (*m_endFramesInFlight)--;
+            }
+        }
+        ScopedEndFrameInFlight(const ScopedEndFrameInFlight&) = delete;
+        ScopedEndFrameInFlight& operator=(const ScopedEndFrameInFlight&) = delete;
+
+    private:
+        std::atomic<uint32_t>* m_endFramesInFlight;
+    };
+
+    void WarnSynchronizedWithoutFrames(ConformanceHooksBase* conformanceHooks)
+    {
+        conformanceHooks->ConformanceFailure(
+            XR_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT, "XrEventDataSessionStateChanged",
+            "Suspicious session state transition to %s when no frame(s) have been submitted and session has not requested an exit.",
+            to_string(XR_SESSION_STATE_SYNCHRONIZED));
+    }
 }  // namespace
 
 namespace session
@@ -56,14 +88,13 @@ namespace session
 
     void SessionStateChanged(ConformanceHooksBase* conformanceHooks, const XrEventDataSessionStateChanged* sessionStateChanged)
     {
-        // Check under the lock to guarantee xrEndFrame completes if it's being called on another thread.
         CustomSessionState* const customSessionState = GetCustomSessionState(sessionStateChanged->session);
         std::unique_lock<std::mutex> lock(customSessionState->lock);
 
         if (!IsValidStateTransition(customSessionState->sessionState, sessionStateChanged->state)) {
             conformanceHooks->ConformanceFailure(XR_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT, "XrEventDataSessionStateChanged",
                                                  "Invalid session state transition from %s to %s",
-                                                 to_string(customSessionState->sessionState), to_string(sessionStateChanged->state));
+                                                 to_string(customSessionState->sessionState.load()), to_string(sessionStateChanged->state));
         }
 
         if (sessionStateChanged->state == XR_SESSION_STATE_SYNCHRONIZED && !customSessionState->sessionBegun) {
@@ -73,17 +104,24 @@ namespace session
         }
 
         // Transition from READY to SYNCHRONIZED should only happen after frames have been synchronized (1 or more frames submitted).
-        if (sessionStateChanged->state == XR_SESSION_STATE_SYNCHRONIZED && customSessionState->frameCount == 0) {
+        // The runtime may queue the event during an xrEndFrame of a begun frame still running on another thread, which has not
+        // counted its frame yet. Then whether a frame was submitted is only known once that call returns, so xrEndFrame checks
+        // again. Read endFramesInFlight first: xrEndFrame counts the frame before leaving it.
+        const bool endFrameInFlight = customSessionState->endFramesInFlight.load() > 0;
+        const bool frameSubmitted = customSessionState->frameCount.load() > 0;
+        if (sessionStateChanged->state == XR_SESSION_STATE_SYNCHRONIZED && !frameSubmitted) {
             // There are three exceptions:
             // 1. The app has requested the session to exit while in the RUNNING state.
             // 2. The session is headless.
             // 3. Rare cases where the runtime wants to end the session before becoming synchornized.
             //    For this reason it this is a warning rather than an error.
             if (!customSessionState->sessionExitRequested && !customSessionState->headless) {
-                conformanceHooks->ConformanceFailure(
-                    XR_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT, "XrEventDataSessionStateChanged",
-                    "Suspicious session state transition to %s when no frame(s) have been submitted and session has not requested an exit.",
-                    to_string(sessionStateChanged->state));
+                if (endFrameInFlight) {
+                    customSessionState->synchronizedDuringEndFrame = true;
+                }
+                else {
+                    WarnSynchronizedWithoutFrames(conformanceHooks);
+                }
             }
         }
 
@@ -160,6 +198,7 @@ XrResult ConformanceHooks::xrCreateSession(XrInstance instance, const XrSessionC
     const XrResult result = ConformanceHooksBase::xrCreateSession(instance, createInfo, session);
     if (XR_SUCCEEDED(result)) {
         auto customSessionState = std::make_unique<CustomSessionState>();
+        customSessionState->handle = *session;
         customSessionState->systemId = createInfo->systemId;
 
         ForEachExtension(createInfo->next,
@@ -206,16 +245,15 @@ XrResult ConformanceHooks::xrSyncActions(XrSession session, const XrActionsSyncI
 
     const XrResult result = ConformanceHooksBase::xrSyncActions(session, syncInfo);
 
-    // late lock since we only touched atomics until now
-    std::unique_lock<std::mutex> lock(customSessionState->lock);
-
-    if (result == XR_SESSION_NOT_FOCUSED && customSessionState->sessionState == XR_SESSION_STATE_FOCUSED) {
+    // no lock: the session state is atomic, and action sets have their own
+    const XrSessionState sessionState = customSessionState->sessionState.load();
+    if (result == XR_SESSION_NOT_FOCUSED && sessionState == XR_SESSION_STATE_FOCUSED) {
         // Suspicious but possibly legal if there is a queued-but-unobserved state change.
         POSSIBLE_NONCONFORMANT("XR_SESSION_NOT_FOCUSED returned when session state is XR_SESSION_STATE_FOCUSED");
     }
-    else if (result == XR_SUCCESS && customSessionState->sessionState != XR_SESSION_STATE_FOCUSED) {
+    else if (result == XR_SUCCESS && sessionState != XR_SESSION_STATE_FOCUSED) {
         // Suspicious but possibly legal if there is a queued-but-unobserved state change.
-        POSSIBLE_NONCONFORMANT("XR_SUCCESS returned when session state is %s", to_string(customSessionState->sessionState));
+        POSSIBLE_NONCONFORMANT("XR_SUCCESS returned when session state is %s", to_string(sessionState));
     }
 
     // Notify each action set individually.
@@ -236,15 +274,19 @@ XrResult ConformanceHooks::xrLocateViews(XrSession session, const XrViewLocateIn
     for (uint32_t i = 0; i < viewCapacityInput; i++) {
         viewChainValidations.emplace_back(CREATE_STRUCT_CHAIN_VALIDATOR(&views[i]));
     }
+    if (viewLocateInfo != nullptr) {
+        FlightRecorder::AddArgument("displayTime", viewLocateInfo->displayTime);
+    }
 
     const XrResult result =
         ConformanceHooksBase::xrLocateViews(session, viewLocateInfo, viewState, viewCapacityInput, viewCountOutput, views);
 
     if (XR_SUCCEEDED(result)) {
         CustomSessionState* const customSessionState = GetCustomSessionState(session);
-        std::unique_lock<std::mutex> lock(customSessionState->lock);
 
-        NONCONFORMANT_IF(!customSessionState->sessionBegun, "Session must be begun");
+        NONCONFORMANT_IF(!customSessionState->sessionBegun.load(), "Session must be begun");
+
+        SAMPLE_VALIDATION();
 
         // TODO: What is status of viewState if called two-idiom style to look up capacity?
         // For now, only check ViewState if viewCountOutput > 0.
@@ -284,6 +326,7 @@ XrResult ConformanceHooks::xrBeginSession(XrSession session, const XrSessionBegi
         NONCONFORMANT_IF(customSessionState->sessionBegun, "Session cannot be begun when already begun");
         customSessionState->sessionBegun = true;
         customSessionState->frameCount = 0;
+        customSessionState->synchronizedDuringEndFrame = false;
     }
     else if (result == XR_ERROR_SESSION_RUNNING) {
         std::unique_lock<std::mutex> lock(customSessionState->lock);
@@ -303,7 +346,7 @@ XrResult ConformanceHooks::xrEndSession(XrSession session)
         NONCONFORMANT_IF(!customSessionState->sessionBegun, "Expected XR_ERROR_SESSION_NOT_RUNNING but got %s", to_string(result));
         POSSIBLE_NONCONFORMANT_IF(customSessionState->sessionState != XR_SESSION_STATE_STOPPING,
                                   "Expected XR_ERROR_SESSION_NOT_STOPPING when last known session state was %s", to_string(result),
-                                  to_string(customSessionState->sessionState));
+                                  to_string(customSessionState->sessionState.load()));
 
         customSessionState->sessionBegun = false;
         customSessionState->sessionExitRequested = false;
@@ -317,6 +360,9 @@ XrResult ConformanceHooks::xrEndSession(XrSession session)
             "Unexpected XR_ERROR_SESSION_NOT_STOPPING failure when last observed session state was XR_SESSION_STATE_STOPPING");
     }
 
+    lock.unlock();
+    FlushBufferedFailures();
+
     return result;
 }
 
@@ -341,52 +387,94 @@ XrResult ConformanceHooks::xrWaitFrame(XrSession session, const XrFrameWaitInfo*
 {
     VALIDATE_STRUCT_CHAIN(frameState);
 
+    const FrameTiming::Clock::time_point callStart = FrameTiming::Clock::now();
     const XrResult result = ConformanceHooksBase::xrWaitFrame(session, frameWaitInfo, frameState);
+    const XrDuration callDuration = FrameTiming::NanosecondsSince(callStart);
 
     if (XR_SUCCEEDED(result)) {
+        FlightRecorder::AddArgument("predictedDisplayTime", frameState->predictedDisplayTime);
+
         CustomSessionState* const customSessionState = GetCustomSessionState(session);
-        std::unique_lock<std::mutex> lock(customSessionState->lock);
+        FrameTiming::SessionFrameTiming& frameTiming = customSessionState->frameTiming;
+        frameTiming.Record(FrameTiming::Call::WaitFrame, callDuration);
 
         // SPEC: If a frame submitted to xrEndFrame is consumed by the compositor before its target display time, a subsequent call
         // to xrWaitFrame must block the caller until the start of the next rendering interval after the frame's target display time
         // as determined by the runtime.
-        NONCONFORMANT_IF(frameState->predictedDisplayTime <= customSessionState->lastPredictedDisplayTime,
-                         "New predicted display time %lld is less or equal to the previous predicted display time %lld",
-                         frameState->predictedDisplayTime, customSessionState->lastPredictedDisplayTime);
+        const XrTime previousPredictedDisplayTime = customSessionState->lastPredictedDisplayTime.exchange(frameState->predictedDisplayTime);
+        if (frameState->predictedDisplayTime <= previousPredictedDisplayTime) {
+            NONCONFORMANT("New predicted display time %lld is less or equal to the previous predicted display time %lld",
+                          frameState->predictedDisplayTime, previousPredictedDisplayTime);
+            frameTiming.RecordViolation(FrameTiming::Call::WaitFrame);
+        }
 
-        customSessionState->lastPredictedDisplayTime = frameState->predictedDisplayTime;
-        customSessionState->lastPredictedDisplayPeriod = frameState->predictedDisplayPeriod;
+        const XrDuration period = frameState->predictedDisplayPeriod;
+        const XrDuration previousPeriod = customSessionState->lastPredictedDisplayPeriod.exchange(period);
+        if (period <= 0) {
+            POSSIBLE_NONCONFORMANT("Predicted display period %lld is not positive", period);
+            frameTiming.RecordViolation(FrameTiming::Call::WaitFrame);
+        }
+        else if (previousPredictedDisplayTime != 0 && period == previousPeriod &&
+                 frameState->predictedDisplayTime > previousPredictedDisplayTime) {
+            // With a steady display period, display times should advance by a whole number of periods (frames may be skipped).
+            // Allow a quarter period of jitter.
+            const XrDuration offset = (frameState->predictedDisplayTime - previousPredictedDisplayTime) % period;
+            if (std::min(offset, period - offset) > period / 4) {
+                POSSIBLE_NONCONFORMANT(
+                    "Predicted display time %lld advanced by %lld since the previous one, not a whole number of display periods of %lld",
+                    frameState->predictedDisplayTime, frameState->predictedDisplayTime - previousPredictedDisplayTime, period);
+                frameTiming.RecordViolation(FrameTiming::Call::WaitFrame);
+            }
+        }
     }
     return result;
 }
 
 XrResult ConformanceHooks::xrBeginFrame(XrSession session, const XrFrameBeginInfo* frameBeginInfo)
 {
+    const FrameTiming::Clock::time_point callStart = FrameTiming::Clock::now();
     const XrResult result = ConformanceHooksBase::xrBeginFrame(session, frameBeginInfo);
+    const XrDuration callDuration = FrameTiming::NanosecondsSince(callStart);
     if (XR_SUCCEEDED(result)) {
         CustomSessionState* const customSessionState = GetCustomSessionState(session);
-        std::unique_lock<std::mutex> lock(customSessionState->lock);
-        NONCONFORMANT_IF(customSessionState->frameBegun && result == XR_SUCCESS, "XR_FRAME_DISCARDED expected but XR_SUCCESS returned");
-        NONCONFORMANT_IF(!customSessionState->frameBegun && result == XR_FRAME_DISCARDED,
-                         "XR_SUCCESS expected but XR_FRAME_DISCARDED returned");
-        customSessionState->frameBegun = true;
+        customSessionState->frameTiming.Record(FrameTiming::Call::BeginFrame, callDuration);
+
+        // xrWaitFrame is where the runtime throttles the application: xrBeginFrame blocking for a whole frame eats into the
+        // time the application has to render.
+        const XrDuration budget = FrameTiming::GetBeginFrameBudget() > 0 ? FrameTiming::GetBeginFrameBudget()
+                                                                          : customSessionState->lastPredictedDisplayPeriod.load();
+        if (budget > 0 && callDuration > budget) {
+            POSSIBLE_NONCONFORMANT("xrBeginFrame blocked for %lld ns, longer than the budget of %lld ns", callDuration, budget);
+            customSessionState->frameTiming.RecordViolation(FrameTiming::Call::BeginFrame);
+        }
+
+        const bool frameWasBegun = customSessionState->frameBegun.exchange(true);
+        NONCONFORMANT_IF(frameWasBegun && result == XR_SUCCESS, "XR_FRAME_DISCARDED expected but XR_SUCCESS returned");
+        NONCONFORMANT_IF(!frameWasBegun && result == XR_FRAME_DISCARDED, "XR_SUCCESS expected but XR_FRAME_DISCARDED returned");
     }
     return result;
 }
 
 XrResult ConformanceHooks::xrEndFrame(XrSession session, const XrFrameEndInfo* frameEndInfo)
 {
-    // Call xrEndFrame under the lock because it might generate XR_SESSION_STATE_SYNCHRONIZED
-    // at any time during the call and frameCount needs to increment in unison.
+    // xrEndFrame might generate XR_SESSION_STATE_SYNCHRONIZED at any time during the call, before frameCount is incremented.
+    // Rather than holding the session lock across the runtime call, which would stall an xrWaitFrame on another thread,
+    // mark the call as in flight so SessionStateChanged leaves the frame check to it. Only a call ending a begun frame can
+    // submit one.
     CustomSessionState* const customSessionState = GetCustomSessionState(session);
-    std::unique_lock<std::mutex> lock(customSessionState->lock);
+    const ScopedEndFrameInFlight endFrameInFlight(customSessionState->endFramesInFlight, customSessionState->frameBegun.load());
+    if (frameEndInfo != nullptr) {
+        FlightRecorder::AddArgument("displayTime", frameEndInfo->displayTime);
+    }
 
+    const FrameTiming::Clock::time_point callStart = FrameTiming::Clock::now();
     const XrResult result = ConformanceHooksBase::xrEndFrame(session, frameEndInfo);
+    const XrDuration callDuration = FrameTiming::NanosecondsSince(callStart);
 
     if (XR_SUCCEEDED(result)) {
-        NONCONFORMANT_IF(!customSessionState->frameBegun,
-                         "Unexpected success. XR_ERROR_CALL_ORDER_INVALID expected because xrBeginFrame was not called");
-        customSessionState->frameBegun = false;
+        customSessionState->frameTiming.Record(FrameTiming::Call::EndFrame, callDuration);
+        const bool frameWasBegun = customSessionState->frameBegun.exchange(false);
+        NONCONFORMANT_IF(!frameWasBegun, "Unexpected success. XR_ERROR_CALL_ORDER_INVALID expected because xrBeginFrame was not called");
         customSessionState->frameCount++;
     }
     else if (result == XR_ERROR_CALL_ORDER_INVALID) {
@@ -394,6 +482,12 @@ XrResult ConformanceHooks::xrEndFrame(XrSession session, const XrFrameEndInfo* f
         // std::unique_lock<std::mutex> lock(customSessionState->lock);
         // NONCONFORMANT_IF(customSessionState->frameBegun, "XR_ERROR_CALL_ORDER_INVALID returned but frame has been begun");
     }
+    // The session became synchronized while this or another xrEndFrame was in flight: now that it returned, check whether a
+    // frame was submitted after all.
+    if (customSessionState->synchronizedDuringEndFrame.exchange(false) && customSessionState->frameCount.load() == 0) {
+        WarnSynchronizedWithoutFrames(this);
+    }
+    ValidationSampling::OnFrameEnd();
     return result;
 }
 
@@ -403,8 +497,7 @@ XrResult ConformanceHooks::xrEnumerateReferenceSpaces(XrSession session, uint32_
     const XrResult result = ConformanceHooksBase::xrEnumerateReferenceSpaces(session, spaceCapacityInput, spaceCountOutput, spaces);
     if (XR_SUCCEEDED(result)) {
         if (spaceCountOutput != nullptr && spaces != nullptr) {
-            std::vector<XrReferenceSpaceType> referenceSpaceCopy(spaces, spaces + *spaceCountOutput);
-            VectorInspection<XrReferenceSpaceType> referenceSpaceInspect(referenceSpaceCopy);
+            VectorInspection<XrReferenceSpaceType> referenceSpaceInspect(spaces, *spaceCountOutput);
 
             NONCONFORMANT_IF(referenceSpaceInspect.ContainsDuplicates(), "Duplicate reference spaces found");
 
@@ -418,7 +511,7 @@ XrResult ConformanceHooks::xrEnumerateReferenceSpaces(XrSession session, uint32_
                                  "Local floor space must be a supported reference space");
             }
 
-            for (XrReferenceSpaceType refSpace : referenceSpaceCopy) {
+            for (XrReferenceSpaceType refSpace : referenceSpaceInspect) {
                 VALIDATE_XRENUM(refSpace);
             }
 
@@ -432,7 +525,7 @@ XrResult ConformanceHooks::xrEnumerateReferenceSpaces(XrSession session, uint32_
             }
             else {
                 // This is the first time the enumeration has been returned, so cache it.
-                customSessionState->referenceSpaces = std::move(referenceSpaceCopy);
+                customSessionState->referenceSpaces.assign(referenceSpaceInspect.begin(), referenceSpaceInspect.end());
             }
         }
     }
@@ -459,8 +552,7 @@ XrResult ConformanceHooks::xrEnumerateSwapchainFormats(XrSession session, uint32
             NONCONFORMANT("Session must enumerate one or more swapchain formats");
         }
 
-        std::vector<int64_t> formatsCopy(formats, formats + *formatCountOutput);
-        VectorInspection<int64_t> formatsInspect(formatsCopy);
+        VectorInspection<int64_t> formatsInspect(formats, *formatCountOutput);
         // TODO: Technically the spec doesn't disallow this explicitly like it does for reference spaces.
         NONCONFORMANT_IF(formatsInspect.ContainsDuplicates(), "Duplicate swapchain formats found");
 
@@ -474,7 +566,7 @@ XrResult ConformanceHooks::xrEnumerateSwapchainFormats(XrSession session, uint32
         }
         else {
             // This is the first time the enumeration has been returned, so cache it.
-            customSessionState->swapchainFormats = std::move(formatsCopy);
+            customSessionState->swapchainFormats.assign(formatsInspect.begin(), formatsInspect.end());
         }
     }
 
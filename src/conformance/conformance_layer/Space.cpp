@@ -33,10 +33,13 @@ namespace space
 XrResult ConformanceHooks::xrLocateSpace(XrSpace space, XrSpace baseSpace, XrTime time, XrSpaceLocation* location)
 {
     VALIDATE_STRUCT_CHAIN(location);
+    FlightRecorder::AddArgument("time", time);
 
     const XrResult result = ConformanceHooksBase::xrLocateSpace(space, baseSpace, time, location);
 
     if (XR_SUCCEEDED(result)) {
+        SAMPLE_VALIDATION();
+
         if ((location->locationFlags & XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT) != 0 &&
             (location->locationFlags & XR_SPACE_LOCATION_ORIENTATION_VALID_BIT) == 0) {
             NONCONFORMANT("Location orientation cannot be tracked but invalid");
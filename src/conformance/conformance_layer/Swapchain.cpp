@@ -14,6 +14,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <assert.h>
 #include "ConformanceHooks.h"
 #include "CustomHandleState.h"
 #include "IGraphicsValidator.h"
@@ -109,6 +110,8 @@ XrResult ConformanceHooks::xrAcquireSwapchainImage(XrSwapchain swapchain, const
 {
     const XrResult result = ConformanceHooksBase::xrAcquireSwapchainImage(swapchain, acquireInfo, index);
     if (XR_SUCCEEDED(result)) {
+        FlightRecorder::AddArgument("index", *index);
+
         CustomSwapchainState* const swapchainData = GetCustomSwapchainState(swapchain);
         std::unique_lock<std::recursive_mutex> lock(swapchainData->mutex);
 
@@ -137,16 +140,25 @@ XrResult ConformanceHooks::xrAcquireSwapchainImage(XrSwapchain swapchain, const
 
 XrResult ConformanceHooks::xrWaitSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageWaitInfo* waitInfo)
 {
-    auto waitStart = std::chrono::high_resolution_clock::now();
+    const FrameTiming::Clock::time_point waitStart = FrameTiming::Clock::now();
 
     const XrResult result = ConformanceHooksBase::xrWaitSwapchainImage(swapchain, waitInfo);
 
+    const XrDuration waitDuration = FrameTiming::NanosecondsSince(waitStart);
     if (result == XR_TIMEOUT_EXPIRED) {
-        XrDuration waitDuration =
-            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - waitStart).count();
         NONCONFORMANT_IF(waitDuration < waitInfo->timeout, "Wait returned before timeout.");
     }
     else if (result == XR_SUCCESS) {
+        HandleState* const sessionState = GetSwapchainState(swapchain)->parent;
+        assert(sessionState->type == XR_OBJECT_TYPE_SESSION);
+        FrameTiming::SessionFrameTiming& frameTiming = session::GetCustomSessionState((XrSession)sessionState->handle)->frameTiming;
+        frameTiming.Record(FrameTiming::Call::WaitSwapchainImage, waitDuration);
+        const XrDuration budget = FrameTiming::GetSwapchainWaitBudget();
+        if (budget > 0 && waitDuration > budget) {
+            POSSIBLE_NONCONFORMANT("xrWaitSwapchainImage blocked for %lld ns, longer than the budget of %lld ns", waitDuration, budget);
+            frameTiming.RecordViolation(FrameTiming::Call::WaitSwapchainImage);
+        }
+
         CustomSwapchainState* const swapchainData = GetCustomSwapchainState(swapchain);
         std::unique_lock<std::recursive_mutex> lock(swapchainData->mutex);
 
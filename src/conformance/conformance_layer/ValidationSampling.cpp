@@ -0,0 +1,177 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ValidationSampling.h"
+
+#include "LayerLog.h"
+
+#include "common/platform_utils.hpp"
+
+#include <inttypes.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+namespace ValidationSampling
+{
+    namespace
+    {
+        constexpr const char* c_intervalEnvVar = "KHRONOS_runtime_conformance_validation_sample_interval";
+        constexpr const char* c_budgetEnvVar = "KHRONOS_runtime_conformance_validation_budget_us";
+
+        struct Config
+        {
+            /// Check 1 in this many calls of each function; 1 checks every call.
+            uint64_t interval{1};
+            /// Nanoseconds of value checks per frame; 0 is unlimited.
+            uint64_t budgetNanoseconds{0};
+        };
+
+        uint64_t GetEnvUnsigned(const char* name)
+        {
+            const std::string value = PlatformUtilsGetEnv(name);
+            return value.empty() ? 0 : strtoull(value.c_str(), nullptr, 10);
+        }
+
+        const Config& GetConfig()
+        {
+            static const Config config = [] {
+                Config c;
+                const uint64_t interval = GetEnvUnsigned(c_intervalEnvVar);
+                if (interval > 1) {
+                    c.interval = interval;
+                }
+                c.budgetNanoseconds = GetEnvUnsigned(c_budgetEnvVar) * 1000;
+                return c;
+            }();
+            return config;
+        }
+
+        /// Time spent on value checks since the last xrEndFrame, from all threads.
+        std::atomic<uint64_t> g_frameNanoseconds{0};
+
+        /// The innermost ScopedSample on this thread.
+        thread_local ScopedSample* t_currentSample = nullptr;
+
+        struct Registry
+        {
+            std::mutex mutex;
+            std::map<std::string, std::unique_ptr<FunctionSampling>> functions;
+        };
+
+        Registry& GetRegistry()
+        {
+            static Registry registry;
+            return registry;
+        }
+    }  // namespace
+
+    bool IsEnabled()
+    {
+        static const bool enabled = GetConfig().interval > 1 || GetConfig().budgetNanoseconds > 0;
+        return enabled;
+    }
+
+    FunctionSampling* GetFunctionSampling(const char* name)
+    {
+        if (!IsEnabled()) {
+            return nullptr;
+        }
+        Registry& registry = GetRegistry();
+        std::unique_lock<std::mutex> lock(registry.mutex);
+        std::unique_ptr<FunctionSampling>& sampling = registry.functions[name];
+        if (!sampling) {
+            sampling = std::make_unique<FunctionSampling>(name);
+        }
+        return sampling.get();
+    }
+
+    void OnFrameEnd()
+    {
+        if (IsEnabled()) {
+            g_frameNanoseconds.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void DumpSummary()
+    {
+        if (!IsEnabled()) {
+            return;
+        }
+
+        const Config& config = GetConfig();
+        LOG_INFO("Conformance Layer: value validation sampled 1 in %" PRIu64 " calls, budget %" PRIu64 " us per frame\n",
+                 config.interval, config.budgetNanoseconds / 1000);
+        LOG_INFO("%-48s %10s %16s %16s %14s\n", "function", "calls", "skipped interval", "skipped budget", "checks skipped");
+
+        Registry& registry = GetRegistry();
+        std::unique_lock<std::mutex> lock(registry.mutex);
+        for (const auto& entry : registry.functions) {
+            const FunctionSampling& sampling = *entry.second;
+            LOG_INFO("%-48s %10" PRIu64 " %16" PRIu64 " %16" PRIu64 " %14" PRIu64 "\n", sampling.name,
+                     sampling.callCount.load(std::memory_order_relaxed), sampling.intervalSkippedCount.load(std::memory_order_relaxed),
+                     sampling.budgetSkippedCount.load(std::memory_order_relaxed),
+                     sampling.skippedCheckCount.load(std::memory_order_relaxed));
+        }
+    }
+
+    bool ShouldCheckValue()
+    {
+        ScopedSample* const sample = t_currentSample;
+        if (sample == nullptr || !sample->m_skip) {
+            return true;
+        }
+        sample->m_sampling->skippedCheckCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    ScopedSample::ScopedSample(FunctionSampling* sampling) : m_sampling(sampling), m_outer(t_currentSample)
+    {
+        if (m_sampling == nullptr) {
+            return;
+        }
+        t_currentSample = this;
+
+        const Config& config = GetConfig();
+        const uint64_t call = m_sampling->callCount.fetch_add(1, std::memory_order_relaxed);
+        if (call % config.interval != 0) {
+            m_skip = true;
+            m_sampling->intervalSkippedCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        else if (config.budgetNanoseconds > 0 && g_frameNanoseconds.load(std::memory_order_relaxed) >= config.budgetNanoseconds) {
+            m_skip = true;
+            m_sampling->budgetSkippedCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        else if (config.budgetNanoseconds > 0) {
+            m_start = Clock::now();
+        }
+    }
+
+    ScopedSample::~ScopedSample()
+    {
+        if (m_sampling == nullptr) {
+            return;
+        }
+        t_currentSample = m_outer;
+        if (!m_skip && GetConfig().budgetNanoseconds > 0) {
+            const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_start).count();
+            g_frameNanoseconds.fetch_add(static_cast<uint64_t>(elapsed), std::memory_order_relaxed);
+        }
+    }
+}  // namespace ValidationSampling
@@ -0,0 +1,96 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Opt-in sampling of the value checks (ValidateFloat, ValidateXrTime, ValidateXrQuaternion, ValidateXrVector3f) made on data
+// returned by the runtime, so the layer can stay enabled in soak and performance runs without distorting them.
+//
+// Set KHRONOS_runtime_conformance_validation_sample_interval to N to check the returned values of 1 in N calls of each
+// function, and/or KHRONOS_runtime_conformance_validation_budget_us to stop checking values for the rest of a frame (until the
+// next xrEndFrame) once that many microseconds have been spent checking them.
+// Call-order and state checks are never skipped. A summary of what was skipped is written to the log on xrDestroyInstance.
+//
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+
+namespace ValidationSampling
+{
+    using Clock = std::chrono::steady_clock;
+
+    /// Sampling counters for a single OpenXR function.
+    struct FunctionSampling
+    {
+        explicit FunctionSampling(const char* name) : name(name)
+        {
+        }
+
+        const char* const name;
+
+        std::atomic<uint64_t> callCount{0};
+        /// Calls whose values were not checked because they fell between samples.
+        std::atomic<uint64_t> intervalSkippedCount{0};
+        /// Calls whose values were not checked because the frame's budget was spent.
+        std::atomic<uint64_t> budgetSkippedCount{0};
+        /// Individual value checks not made in skipped calls.
+        std::atomic<uint64_t> skippedCheckCount{0};
+    };
+
+    /// True if sampling was requested through the environment. Checked once.
+    bool IsEnabled();
+
+    /// Get the sampling counters for a function, or nullptr if sampling is not enabled.
+    /// Returns the same object for every call with the same name: cache the result in a function-local static.
+    FunctionSampling* GetFunctionSampling(const char* name);
+
+    /// Start a new frame's validation budget. Called from xrEndFrame.
+    void OnFrameEnd();
+
+    /// Write a summary of skipped validation to the log. Does nothing if sampling is not enabled.
+    void DumpSummary();
+
+    /// True if the value checks on this thread should be made, false while a @ref ScopedSample is skipping them.
+    /// A skipped check counts itself against the innermost ScopedSample.
+    bool ShouldCheckValue();
+
+    /// Decides whether the value checks of one call are made, and charges the time they take to the frame's budget.
+    /// Checks are always made if constructed with nullptr.
+    class ScopedSample
+    {
+    public:
+        explicit ScopedSample(FunctionSampling* sampling);
+        ~ScopedSample();
+
+        ScopedSample(const ScopedSample&) = delete;
+        ScopedSample& operator=(const ScopedSample&) = delete;
+
+    private:
+        friend bool ShouldCheckValue();
+
+        FunctionSampling* m_sampling;
+        ScopedSample* m_outer;
+        bool m_skip{false};
+        Clock::time_point m_start;
+    };
+}  // namespace ValidationSampling
+
+/// Put in a hook after the runtime call and before the checks of the values it returned, so those checks follow the sampling
+/// configuration for the rest of the scope.
+#define SAMPLE_VALIDATION()                                                                                                          \
+    static ValidationSampling::FunctionSampling* const s_validationSampling = ValidationSampling::GetFunctionSampling(__func__); \
+    const ValidationSampling::ScopedSample validationSample(s_validationSampling)
@@ -16,6 +16,7 @@
 
 #define CATCH_CONFIG_NOSTDOUT
 
+#include "asset_prefetch.h"
 #include "conformance_framework.h"
 #include "conformance_test.h"
 #include "conformance_utils.h"
@@ -23,7 +24,11 @@
 #include "graphics_plugin.h"
 #include "platform_utils.hpp"  // for OPENXR_API_LAYER_PATH_ENV_VAR
 #include "report.h"
+#include "utilities/generator.h"
 #include "utilities/git_revision.h"
+#include "utilities/process_memory.h"
+#include "utilities/process_time.h"
+#include "utilities/trace.h"
 #include "utilities/utils.h"
 
 #include "catch_reporter_cts.h"
@@ -42,10 +47,17 @@
 #include <openxr/openxr_platform.h>
 
 #include <cstddef>
+#include <cstdio>
 #include <string>
 #include <cstring>
+#include <fstream>
 #include <streambuf>
 #include <algorithm>
+#include <map>
+#include <memory>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 using namespace Conformance;
 
@@ -75,6 +87,8 @@ namespace
         {
             // if our buffer has anything meaningful, flush to the conformance_test host.
             if (m_s.length() > 0) {
+                // After any queued test messages, to keep the order.
+                FlushAsyncReportSink();
                 g_conformanceLaunchSettings->message(m_messageType, m_s.c_str());
                 m_s.clear();
             }
@@ -141,6 +155,7 @@ namespace
             auto graphicsPlugin = globalData.GetGraphicsPlugin();
             if (graphicsPlugin) {
                 // Initialize device so DescribeGraphics can return information about the GPU.
+                globalData.ReleaseKeptGraphicsDevice();
                 if (graphicsPlugin->InitializeDevice(instance, instance.systemId)) {
                     ReportF("graphicsPlugin: %s", graphicsPlugin->DescribeGraphics().c_str());
                     graphicsPlugin->ShutdownDevice();
@@ -441,9 +456,189 @@ namespace
             return ParserResult::ok(ParseResultType::Matched);
         };
 
+        /// Handle frame pacing load arg, "cpu:gpu" in percent of the display period
+        auto const parseFramePacingLoad = [&](std::string const& arg) {
+            GlobalData& globalData = GetGlobalData();
+            const char* str = arg.c_str();
+            char* end = nullptr;
+            const double cpuPercent = std::strtod(str, &end);
+            if (end == str || *end != ':') {
+                ReportConsoleOnlyF("invalid arg: %s", arg.c_str());
+                return ParserResult::runtimeError("invalid frame pacing load '" + arg + "' passed on command line, expected cpu:gpu");
+            }
+            str = end + 1;
+            const double gpuPercent = std::strtod(str, &end);
+            if (end == str || *end != '\0' || cpuPercent < 0 || gpuPercent < 0) {
+                ReportConsoleOnlyF("invalid arg: %s", arg.c_str());
+                return ParserResult::runtimeError("invalid frame pacing load '" + arg + "' passed on command line, expected cpu:gpu");
+            }
+
+            globalData.options.framePacingLoads.push_back(FramePacingLoad{cpuPercent / 100.0, gpuPercent / 100.0});
+            return ParserResult::ok(ParseResultType::Matched);
+        };
+
+        /// Handle frame pacing frame count
+        auto const parseFramePacingFrameCount = [&](std::string const& arg) {
+            GlobalData& globalData = GetGlobalData();
+            errno = 0;
+            unsigned long frameCount = std::strtoul(arg.c_str(), nullptr, 0);
+            if (errno == ERANGE || frameCount < 2 || frameCount > UINT32_MAX) {
+                ReportConsoleOnlyF("invalid arg: %s", arg.c_str());
+                return ParserResult::runtimeError("invalid frame pacing frame count '" + arg + "' passed on command line");
+            }
+
+            globalData.options.framePacingFrameCount = static_cast<uint32_t>(frameCount);
+            return ParserResult::ok(ParseResultType::Matched);
+        };
+
+        /// Handle thermal soak benchmark duration
+        auto const parseSoakDuration = [&](std::string const& arg) {
+            GlobalData& globalData = GetGlobalData();
+            errno = 0;
+            unsigned long seconds = std::strtoul(arg.c_str(), nullptr, 0);
+            if (errno == ERANGE || seconds < 1 || seconds > UINT32_MAX) {
+                ReportConsoleOnlyF("invalid arg: %s", arg.c_str());
+                return ParserResult::runtimeError("invalid soak duration '" + arg + "' passed on command line");
+            }
+
+            globalData.options.soakDuration = static_cast<uint32_t>(seconds);
+            return ParserResult::ok(ParseResultType::Matched);
+        };
+
+        /// Handle thermal soak benchmark GPU load
+        auto const parseSoakGpuLoad = [&](std::string const& arg) {
+            GlobalData& globalData = GetGlobalData();
+            errno = 0;
+            unsigned long percent = std::strtoul(arg.c_str(), nullptr, 0);
+            if (errno == ERANGE || percent < 1 || percent > 200) {
+                ReportConsoleOnlyF("invalid arg: %s", arg.c_str());
+                return ParserResult::runtimeError("invalid soak GPU load '" + arg + "' passed on command line");
+            }
+
+            globalData.options.soakGpuLoad = static_cast<uint32_t>(percent);
+            return ParserResult::ok(ParseResultType::Matched);
+        };
+
+        /// Handle session startup benchmark iteration count
+        auto const parseSessionStartupIterations = [&](std::string const& arg) {
+            GlobalData& globalData = GetGlobalData();
+            errno = 0;
+            unsigned long iterations = std::strtoul(arg.c_str(), nullptr, 0);
+            if (errno == ERANGE || iterations < 2 || iterations > UINT32_MAX) {
+                ReportConsoleOnlyF("invalid arg: %s", arg.c_str());
+                return ParserResult::runtimeError("invalid session startup iteration count '" + arg + "' passed on command line");
+            }
+
+            globalData.options.sessionStartupIterations = static_cast<uint32_t>(iterations);
+            return ParserResult::ok(ParseResultType::Matched);
+        };
+
+        auto const parseCommandBuffersInFlight = [&](std::string const& arg) {
+            GlobalData& globalData = GetGlobalData();
+            errno = 0;
+            unsigned long count = std::strtoul(arg.c_str(), nullptr, 0);
+            if (errno == ERANGE || count < 1 || count > 16) {
+                ReportConsoleOnlyF("invalid arg: %s", arg.c_str());
+                return ParserResult::runtimeError("invalid command buffers in flight count '" + arg + "' passed on command line");
+            }
+
+            globalData.options.commandBuffersInFlight = static_cast<uint32_t>(count);
+            return ParserResult::ok(ParseResultType::Matched);
+        };
+
+        auto const parseSwapchainCreateWorkers = [&](std::string const& arg) {
+            GlobalData& globalData = GetGlobalData();
+            errno = 0;
+            unsigned long count = std::strtoul(arg.c_str(), nullptr, 0);
+            if (errno == ERANGE || count > 64) {
+                ReportConsoleOnlyF("invalid arg: %s", arg.c_str());
+                return ParserResult::runtimeError("invalid swapchain create worker count '" + arg + "' passed on command line");
+            }
+
+            globalData.options.swapchainCreateWorkers = static_cast<uint32_t>(count);
+            return ParserResult::ok(ParseResultType::Matched);
+        };
+
+        /// Handle "index/count" subtest shard
+        auto const parseSubtestShard = [&](std::string const& arg) {
+            GlobalData& globalData = GetGlobalData();
+            errno = 0;
+            char* end = nullptr;
+            unsigned long index = std::strtoul(arg.c_str(), &end, 10);
+            unsigned long count = 0;
+            if (errno != ERANGE && *end == '/') {
+                count = std::strtoul(end + 1, &end, 10);
+            }
+            if (errno == ERANGE || *end != '\0' || count < 1 || count > UINT32_MAX || index >= count) {
+                ReportConsoleOnlyF("invalid arg: %s", arg.c_str());
+                return ParserResult::runtimeError("invalid subtest shard '" + arg + "' passed on command line");
+            }
+
+            globalData.options.subtestShardIndex = static_cast<uint32_t>(index);
+            globalData.options.subtestShardCount = static_cast<uint32_t>(count);
+            return ParserResult::ok(ParseResultType::Matched);
+        };
+
+        auto const parseSubtestShardTestCase = [&](std::string const& arg) {
+            GetGlobalData().options.subtestShardTestCases.push_back(arg);
+            return ParserResult::ok(ParseResultType::Matched);
+        };
+
+        auto const parseBitmaskCoverage = [&](std::string const& arg) {
+            GlobalData& globalData = GetGlobalData();
+            errno = 0;
+            unsigned long strength = std::strtoul(arg.c_str(), nullptr, 0);
+            if (errno == ERANGE || strength > 8) {
+                ReportConsoleOnlyF("invalid arg: %s", arg.c_str());
+                return ParserResult::runtimeError("invalid bitmask coverage strength '" + arg + "' passed on command line");
+            }
+
+            globalData.options.bitmaskCoverage = static_cast<uint32_t>(strength);
+            return ParserResult::ok(ParseResultType::Matched);
+        };
+
         // NOTE: End of line comments are to encourage clang-format to work the way we want it to for this mini embedded DSL.
         // Clara requires that the "short" args be a single letter - we use capital letters here to avoid colliding with Catch2-provided
         // options.
+        auto const parsePerfMetricsSampleRate = [&](std::string const& arg) {
+            GlobalData& globalData = GetGlobalData();
+            errno = 0;
+            unsigned long rate = std::strtoul(arg.c_str(), nullptr, 0);
+            if (errno == ERANGE || rate > 1000) {
+                ReportConsoleOnlyF("invalid arg: %s", arg.c_str());
+                return ParserResult::runtimeError("invalid performance metrics sample rate '" + arg + "' passed on command line");
+            }
+
+            globalData.options.perfMetricsSampleRate = static_cast<uint32_t>(rate);
+            return ParserResult::ok(ParseResultType::Matched);
+        };
+
+        auto const parsePbrTextureCacheBudget = [&](std::string const& arg) {
+            GlobalData& globalData = GetGlobalData();
+            errno = 0;
+            unsigned long megabytes = std::strtoul(arg.c_str(), nullptr, 0);
+            if (errno == ERANGE || megabytes > UINT32_MAX) {
+                ReportConsoleOnlyF("invalid arg: %s", arg.c_str());
+                return ParserResult::runtimeError("invalid PBR texture cache budget '" + arg + "' passed on command line");
+            }
+
+            globalData.options.pbrTextureCacheBudget = static_cast<uint32_t>(megabytes);
+            return ParserResult::ok(ParseResultType::Matched);
+        };
+
+        auto const parseReportSlowest = [&](std::string const& arg) {
+            GlobalData& globalData = GetGlobalData();
+            errno = 0;
+            unsigned long count = std::strtoul(arg.c_str(), nullptr, 0);
+            if (errno == ERANGE || count > UINT32_MAX) {
+                ReportConsoleOnlyF("invalid arg: %s", arg.c_str());
+                return ParserResult::runtimeError("invalid slowest test count '" + arg + "' passed on command line");
+            }
+
+            globalData.options.reportSlowest = static_cast<uint32_t>(count);
+            return ParserResult::ok(ParseResultType::Matched);
+        };
+
         auto cli =
             Opt(options.graphicsPlugin,
                 "Vulkan|Vulkan2|OpenGLES|OpenGL|D3D11|D3D12")  // graphics plugin
@@ -526,6 +721,203 @@ namespace
                   ["--autoSkipTimeout"]("Automatic Skip Timeout (in milliseconds) for tests which support it")
                       .optional()
 
+            | Opt(parseFramePacingLoad, "cpu%:gpu%")  // frame pacing benchmark load
+                  ["--framePacingLoad"]               //
+              ("Simulated load for the [benchmark] frame pacing test, in percent of the display period. May repeat to sweep several loads.")
+                  .optional()
+
+            | Opt(parseFramePacingFrameCount, "frame count")  // frame pacing benchmark frame count
+                  ["--framePacingFrameCount"]                 //
+              ("Number of measured frames per load in the [benchmark] frame pacing test. Default is 600.")
+                  .optional()
+
+            | Opt(parseSoakDuration, "seconds")  // thermal soak benchmark duration
+                  ["--soakDuration"]             //
+              ("Seconds of sustained load in the [benchmark] thermal soak test. Default is 600.")
+                  .optional()
+
+            | Opt(parseSoakGpuLoad, "gpu%")  // thermal soak benchmark load
+                  ["--soakGpuLoad"]          //
+              ("GPU time the [benchmark] thermal soak test aims to fill, in percent of the display period. Default is 80.")
+                  .optional()
+
+            | Opt(parseSessionStartupIterations, "iterations")  // session startup benchmark iteration count
+                  ["--sessionStartupIterations"]                //
+              ("Number of session startups timed by the [benchmark] session startup test, the first being cold. Default is 10.")
+                  .optional()
+
+            | Opt(options.pipelineCacheDirectory, "directory")  // graphics pipeline cache
+                  ["--pipelineCacheDirectory"]                  //
+              ("Keep the graphics pipeline cache in this directory between runs (Vulkan and D3D12), or the program binaries "
+               "(OpenGL and OpenGL ES). Default is none.")
+                  .optional()
+
+            | Opt(options.transcodeCacheDirectory, "directory")  // transcoded KTX2 texture cache
+                  ["--transcodeCacheDirectory"]                  //
+              ("Keep KTX2 textures transcoded for this device in this directory between runs. Default is none.")
+                  .optional()
+
+            | Opt(options.capabilityCacheDirectory, "directory")  // runtime capability snapshot cache
+                  ["--capabilityCacheDirectory"]                  //
+              ("Keep what the runtime reports about the system, such as its view configurations and swapchain formats, in this "
+               "directory, for later runs of the same runtime version and system. Default is none.")
+                  .optional()
+
+            | Opt(options.keepGraphicsDevice)  // keep graphics device between sessions
+                  ["--keepGraphicsDevice"]     //
+              ("Keep the graphics device alive between sessions and reuse it when possible (Vulkan, D3D11 and D3D12).")
+                  .optional()
+
+            | Opt(parseCommandBuffersInFlight, "count")  // graphics submissions in flight
+                  ["--commandBuffersInFlight"]           //
+              ("Number of graphics command buffers that may execute while the next is recorded (Vulkan and D3D12). Default is 1, which "
+               "waits for every submission.")
+                  .optional()
+
+            | Opt(options.gpuTimers)  // GPU timestamp queries
+                  ["--gpuTimers"]     //
+              ("Measure the GPU time of rendering, clearing and copying to swapchain images and report it per section "
+               "(Vulkan, D3D11, D3D12, OpenGL and Metal).")
+                  .optional()
+
+            | Opt(parseSwapchainCreateWorkers, "count")  // concurrent swapchain creation
+                  ["--swapchainCreateWorkers"]           //
+              ("Number of threads the Swapchains test creates the swapchains of all formats on, reporting the create latency of each "
+               "format (Vulkan, D3D11 and D3D12). Default is 0, which creates them one at a time.")
+                  .optional()
+
+            | Opt(options.recycleSwapchains)  // swapchain pool in CompositionHelper
+                  ["--recycleSwapchains"]     //
+              ("Reuse the swapchains that composition tests destroy for later swapchains with the same create info, instead of "
+               "creating new ones. Static image swapchains are never reused.")
+                  .optional()
+
+            | Opt(options.streamReport)  // streaming CTS report
+                  ["--streamReport"]     //
+              ("Write each test case to the CTS report as it ends, keeping memory flat and leaving a partial report if the run "
+               "stops early. Run totals are written at the end in a cts:totals element.")
+                  .optional()
+
+            | Opt(options.checkpointFile, "file")  // resumable runs
+                  ["--checkpoint"]                 //
+              ("Record each finished test case and its result in this file. If it already exists, the test cases it records "
+               "are not run again, and a test case that crashed the previous run is reported as an error.")
+                  .optional()
+
+            | Opt(options.testListFile, "file")  // shard test lists
+                  ["--testList"]                 //
+              ("Only run the test cases named in this file, one per line, that also match the test spec.")
+                  .optional()
+
+            | Opt(parseSubtestShard, "index/count")  // generated subtest sharding
+                  ["--subtestShard"]                 //
+              ("Only run the generated subtests whose index modulo count is index, so that processes running the same test case "
+               "each run their share of them. Default is 0/1, which runs them all.")
+                  .optional()
+
+            | Opt(parseSubtestShardTestCase, "name")  // test cases with sharded subtests
+                  ["--subtestShardTestCase"]          //
+              ("Only shard the generated subtests of this test case. May be given more than once. Default is every test case.")
+                  .optional()
+
+            | Opt(options.inputScript, "file")  // unattended interactive tests
+                  ["--inputScript"]             //
+              ("Replay the input in this file through XR_EXT_conformance_automation, which must be enabled, when interactive "
+               "tests ask for it, without pausing for the prompts to be read. Default is none.")
+                  .optional()
+
+            | Opt(options.traceFile, "file")  // timeline trace
+                  ["--traceFile"]             //
+              ("Write a timeline of test sections, framework hot spots and OpenXR calls to this file, in Chrome trace event "
+               "JSON format. Needs a build with BUILD_CONFORMANCE_TRACING.")
+                  .optional()
+
+            | Opt(options.timingFile, "file")  // test case timings
+                  ["--timingFile"]             //
+              ("At the end of the run, write the wall time of each test case run to this file, one \"seconds name\" line each.")
+                  .optional()
+
+            | Opt(options.asyncReport)  // background console output
+                  ["--asyncReport"]     //
+              ("Write test messages to the console from a background thread, so that tests reporting every frame do not block "
+               "on console output. Messages are flushed at test case and section boundaries.")
+                  .optional()
+
+            | Opt(options.compactPbrVertices)  // compact PBR vertex layout
+                  ["--compactPbrVertices"]     //
+              ("Store PBR model vertices with normalized 16-bit normals and tangents, 8-bit colors and half float texture "
+               "coordinates, where the graphics plugin supports it (OpenGL and OpenGL ES).")
+                  .optional()
+
+            | Opt(parsePbrTextureCacheBudget, "megabytes")  // PBR texture cache size
+                  ["--pbrTextureCacheBudget"]               //
+              ("Keep up to this many megabytes of PBR model textures no model uses cached for reuse, dropping the least "
+               "recently used first. Default is 256.")
+                  .optional()
+
+            | Opt(options.glUploadWorker)  // OpenGL background uploads
+                  ["--glUploadWorker"]     //
+              ("Upload images, PBR model textures and buffers on a thread of its own, with a shared context (OpenGL only).")
+                  .optional()
+
+            | Opt(options.vulkanTransferQueue)  // Vulkan dedicated transfer queue
+                  ["--vulkanTransferQueue"]     //
+              ("Upload images and PBR model textures on a queue of a dedicated transfer family, where the device has one "
+               "(Vulkan only).")
+                  .optional()
+
+            | Opt(options.parallelViewRecording)  // multi-threaded view recording
+                  ["--parallelViewRecording"]     //
+              ("Record each view of a projection layer on its own thread, executing them in order (D3D11 and Vulkan).")
+                  .optional()
+
+            | Opt(parseBitmaskCoverage, "strength")  // covering arrays of flag combinations
+                  ["--bitmaskCoverage"]              //
+              ("Only test enough combinations of flags that every combination of any this many flags is tested, e.g. 2 for "
+               "pairwise. Default is 0, which tests every combination, as conformance submissions require.")
+                  .optional()
+
+            | Opt(options.headless)  // headless sessions
+                  ["--headless"]     //
+              ("Enable XR_MND_headless and run every session without graphics, skipping tests that need to render.")
+                  .optional()
+
+            | Opt(parseReportSlowest, "count")  // slowest test summary
+                  ["--reportSlowest"]           //
+              ("At the end of the run, list this many of the test cases and sections that took the longest, with their wall "
+               "and CPU time. Default is 0, which lists none.")
+                  .optional()
+
+            | Opt(parsePerfMetricsSampleRate, "hz")  // background performance counter sampling
+                  ["--perfMetricsSampleRate"]        //
+              ("Poll XR_META_performance_metrics counters and XR_EXT_thermal_query levels, when available, this many times per "
+               "second while a test's session runs, reporting the samples as metrics. Default is 0, which samples nothing.")
+                  .optional()
+
+            | Opt(options.latencyProbe)  // pose-to-display latency
+                  ["--latencyProbe"]     //
+              ("Map the steady clock to XrTime with XR_KHR_convert_timespec_time or XR_KHR_win32_convert_performance_counter_time, "
+               "when available, and report percentiles of the time from xrLocateViews and xrEndFrame to each frame's predicted "
+               "display time as metrics.")
+                  .optional()
+
+            | Opt(options.swapchainMemoryAudit)  // swapchain memory footprint
+                  ["--swapchainMemoryAudit"]     //
+              ("Query the GPU memory allocated for each swapchain created through the composition helper, on Vulkan, D3D12 and "
+               "Metal, and report each test's totals and peaks, static and dynamic swapchains apart, as metrics.")
+                  .optional()
+
+            | Opt(options.residentMemoryGrowth)  // runtime memory retained by each test
+                  ["--residentMemoryGrowth"]     //
+              ("Report how much the process resident set grew over each run of a test case, as a metric of the test.")
+                  .optional()
+
+            | Opt(options.allocationBudgets)  // CTS allocations per frame
+                  ["--allocationBudgets"]     //
+              ("Fail tests whose frame loops make more heap allocations per frame, after warming up, than they declare. Needs "
+               "a debug build or BUILD_CONFORMANCE_ALLOCATION_COUNTING.")
+                  .optional()
+
             //
             | Opt([&](bool enabled) { options.debugMode = enabled; })  //
                   ["-D"]["--debugMode"]                                //
@@ -550,6 +942,9 @@ namespace
 
         globalData.enabledAPILayerNames = globalData.options.enabledAPILayers;
         globalData.enabledInstanceExtensionNames = globalData.options.enabledInstanceExtensions;
+        if (globalData.options.headless) {
+            globalData.enabledInstanceExtensionNames.push_back_unique(XR_MND_HEADLESS_EXTENSION_NAME);
+        }
         globalData.enabledInteractionProfiles = globalData.options.enabledInteractionProfiles;
         globalData.leftHandUnderTest = globalData.options.leftHandEnabled;
         globalData.rightHandUnderTest = globalData.options.rightHandEnabled;
@@ -576,18 +971,61 @@ namespace
 
         using EventListenerBase::EventListenerBase;  // inherit constructor
 
+        void testCaseStarting(Catch::TestCaseInfo const& testInfo) override
+        {
+            Base::testCaseStarting(testInfo);
+
+            Conformance::FlushAsyncReportSink();
+            Conformance::GetGlobalData().checkpoint.TestCaseStarting(testInfo.name);
+
+            // Only the generators of the test cases being split between processes produce just their share of values.
+            const Conformance::Options& options = Conformance::GetGlobalData().options;
+            const std::vector<std::string>& shardedTestCases = options.subtestShardTestCases;
+            GeneratorShard shard;
+            if (shardedTestCases.empty() ||
+                std::find(shardedTestCases.begin(), shardedTestCases.end(), testInfo.name) != shardedTestCases.end()) {
+                shard = {options.subtestShardIndex, options.subtestShardCount};
+            }
+            CurrentGeneratorShard() = shard;
+        }
+
         void testCaseEnded(Catch::TestCaseStats const& testCaseStats) override
         {
             Base::testCaseEnded(testCaseStats);
 
+            // Shared fixtures only live for one test case, so that they never hold on to the one instance the loader allows.
+            // Leaving them with child handles alive fails the test case.
+            const bool fixturesClean = Conformance::ReleaseSharedAutoBasicFixtures();
+
+            Conformance::FlushAsyncReportSink();
             Conformance::GlobalData& globalData = Conformance::GetGlobalData();
-            globalData.conformanceReport.results[testCaseStats.testInfo->name].testSuccessCount += testCaseStats.totals.testCases.passed;
-            globalData.conformanceReport.results[testCaseStats.testInfo->name].testFailureCount += testCaseStats.totals.testCases.failed;
+            Conformance::ConformanceReport::Score& testResult = globalData.conformanceReport.results[testCaseStats.testInfo->name];
+            if (fixturesClean) {
+                testResult.testSuccessCount += testCaseStats.totals.testCases.passed;
+                testResult.testFailureCount += testCaseStats.totals.testCases.failed;
+            }
+            else {
+                testResult.testFailureCount += std::max<uint64_t>(testCaseStats.totals.testCases.failed, 1);
+            }
+
+            const char* result = testCaseStats.totals.testCases.failed > 0 || !fixturesClean ? "failed"
+                                 : testCaseStats.totals.testCases.skipped > 0 ? "skipped"
+                                                                              : "passed";
+            globalData.checkpoint.TestCaseEnded(testCaseStats.testInfo->name, result);
         }
 
         void sectionStarting(Catch::SectionInfo const& sectionInfo) override
         {
             Base::sectionStarting(sectionInfo);
+            Conformance::FlushAsyncReportSink();
+
+            if (m_sectionPath.empty()) {
+                m_testCaseResidentStart = Conformance::GetProcessResidentMemoryBytes();
+            }
+            m_sectionPath.push_back(m_sectionPath.empty() ? sectionInfo.name : m_sectionPath.back() + "/" + sectionInfo.name);
+            m_sectionCpuStart.push_back(Conformance::GetProcessCpuSeconds());
+            m_sectionTraces.push_back(
+                std::unique_ptr<Conformance::TraceScope>(new Conformance::TraceScope(Conformance::InternTraceName(sectionInfo.name))));
 
             // Track test progress by outputting the current test section.
             std::string indentStr(static_cast<long>(m_sectionIndent) * 2, ' ');
@@ -597,6 +1035,8 @@ namespace
         }
         void sectionEnded(Catch::SectionStats const& sectionStats) override
         {
+            Conformance::FlushAsyncReportSink();
+
             // Show a summary if something failed but leave the details to the (e.g. console or xml) reporter.
             if (sectionStats.assertions.failed > 0) {
                 std::string indentStr(static_cast<long>(m_sectionIndent) * 2, ' ');
@@ -605,6 +1045,59 @@ namespace
                     (indentStr + std::to_string(sectionStats.assertions.failed) + " assertion(s) failed\n").c_str());
             }
 
+            // Record where the time went, and report CPU time next to the wall time the reporters write when asked for durations.
+            // A test case's sections run once per leaf, so the totals add up every run.
+            const double cpuSeconds = Conformance::GetProcessCpuSeconds() - m_sectionCpuStart.back();
+            SectionTime& sectionTime = m_sectionTimes[m_sectionPath.back()];
+            sectionTime.wallSeconds += sectionStats.durationInSeconds;
+            sectionTime.cpuSeconds += cpuSeconds;
+            sectionTime.isTestCase = m_sectionPath.size() == 1;
+            if (m_config->showDurations() == Catch::ShowDurations::Always) {
+                Conformance::ReportMetric("section.cpuTime", cpuSeconds, "s");
+            }
+            m_sectionCpuStart.pop_back();
+            m_sectionPath.pop_back();
+            m_sectionTraces.pop_back();
+
+            // Report GPU time before the reporters attribute this section's metrics.
+            Conformance::GlobalData& globalData = Conformance::GetGlobalData();
+            std::shared_ptr<Conformance::IGraphicsPlugin> graphicsPlugin = globalData.GetGraphicsPlugin();
+            if (globalData.options.gpuTimers && graphicsPlugin) {
+                std::vector<Conformance::GpuTimerSample> samples;
+                graphicsPlugin->CollectGpuTimerSamples(samples);
+                Conformance::ReportGpuTimerSamples(samples);
+            }
+
+            // Report the swapchain memory of the whole test case, not each section: swapchains often outlive sections.
+            if (globalData.options.swapchainMemoryAudit && m_sectionPath.empty()) {
+                globalData.swapchainMemoryAudit.Report();
+            }
+
+            // Signed, as a test may also leave the resident set smaller than it found it.
+            if (globalData.options.residentMemoryGrowth && m_sectionPath.empty()) {
+                const uint64_t residentEnd = Conformance::GetProcessResidentMemoryBytes();
+                if (m_testCaseResidentStart != 0 && residentEnd != 0) {
+                    Conformance::ReportMetric("testCase.residentGrowth", double(residentEnd) - double(m_testCaseResidentStart), "bytes");
+                }
+            }
+
+            // Report how many state changes drawing glTF models took, to track how well sorting the draws works.
+            if (graphicsPlugin) {
+                const Pbr::DrawStats drawStats = graphicsPlugin->TakeGltfDrawStats();
+                if (drawStats.views > 0) {
+                    const double views = (double)drawStats.views;
+                    const std::vector<Conformance::MetricTag> tags{{"views", std::to_string(drawStats.views)}};
+                    Conformance::ReportMetric("gltfDraws.drawsPerView", drawStats.draws / views, "count", tags);
+                    Conformance::ReportMetric("gltfDraws.pipelineBindsPerView", drawStats.pipelineBinds / views, "count", tags);
+                    Conformance::ReportMetric("gltfDraws.materialBindsPerView", drawStats.materialBinds / views, "count", tags);
+                    Conformance::ReportMetric("gltfDraws.culledPerView", drawStats.culled / views, "count", tags);
+                    if (drawStats.stateCalls + drawStats.stateCallsSkipped > 0) {
+                        Conformance::ReportMetric("gltfDraws.stateCallsPerView", drawStats.stateCalls / views, "count", tags);
+                        Conformance::ReportMetric("gltfDraws.stateCallsSkippedPerView", drawStats.stateCallsSkipped / views, "count", tags);
+                    }
+                }
+            }
+
             Base::sectionEnded(sectionStats);
             m_sectionIndent--;
         }
@@ -619,9 +1112,71 @@ namespace
         {
             Conformance::GlobalData& globalData = Conformance::GetGlobalData();
             globalData.conformanceReport.totals = testRunStats.totals;
+
+            if (globalData.options.reportSlowest > 0) {
+                ReportSlowest(true, "test cases");
+                ReportSlowest(false, "sections");
+            }
+            if (!globalData.options.timingFile.empty()) {
+                WriteTimingFile(globalData.options.timingFile);
+            }
+        }
+
+        /// Write the wall time of each test case run to @p path, in the format conformance_cli reads to schedule shards.
+        void WriteTimingFile(const std::string& path) const
+        {
+            FILE* file = fopen(path.c_str(), "w");
+            if (file == nullptr) {
+                ReportConsoleOnlyF("Could not write timing file %s.", path.c_str());
+                return;
+            }
+            for (const auto& entry : m_sectionTimes) {
+                if (entry.second.isTestCase) {
+                    fprintf(file, "%.3f %s\n", entry.second.wallSeconds, entry.first.c_str());
+                }
+            }
+            fclose(file);
+        }
+
+        /// Print the Options::reportSlowest test cases or sections that took the most wall time.
+        void ReportSlowest(bool testCases, const char* what) const
+        {
+            std::vector<std::pair<std::string, SectionTime>> slowest;
+            for (const auto& entry : m_sectionTimes) {
+                if (entry.second.isTestCase == testCases) {
+                    slowest.push_back(entry);
+                }
+            }
+            const size_t count = std::min<size_t>(slowest.size(), Conformance::GetGlobalData().options.reportSlowest);
+            std::partial_sort(slowest.begin(), slowest.begin() + count, slowest.end(),
+                              [](const std::pair<std::string, SectionTime>& a, const std::pair<std::string, SectionTime>& b) {
+                                  return a.second.wallSeconds > b.second.wallSeconds;
+                              });
+            ReportConsoleOnlyF("Slowest %zu %s (wall seconds, CPU seconds):", count, what);
+            for (size_t i = 0; i < count; ++i) {
+                const SectionTime& time = slowest[i].second;
+                ReportConsoleOnlyF("  %9.3f %9.3f  %s", time.wallSeconds, time.cpuSeconds, slowest[i].first.c_str());
+            }
         }
 
+        struct SectionTime
+        {
+            double wallSeconds{0};
+            double cpuSeconds{0};
+            bool isTestCase{false};
+        };
+
         int m_sectionIndent{0};
+        /// Path of each running section, outermost (the test case) first.
+        std::vector<std::string> m_sectionPath;
+        /// Process CPU time when each running section started.
+        std::vector<double> m_sectionCpuStart;
+        /// Time spent in each section path over all runs of it.
+        std::map<std::string, SectionTime> m_sectionTimes;
+        /// Trace event of each running section, outermost first.
+        std::vector<std::unique_ptr<Conformance::TraceScope>> m_sectionTraces;
+        /// Process resident set when the running test case started, or 0 if it could not be queried.
+        uint64_t m_testCaseResidentStart{0};
     };
     CATCH_REGISTER_LISTENER(ConformanceTestListener)
     CATCH_REGISTER_REPORTER("ctsxml", Catch::CTSReporter)
@@ -636,6 +1191,83 @@ namespace
         }
         return *catchSession;
     }
+
+    /// Open the checkpoint file, if one was given, and narrow the test spec down to the test cases it does not record and,
+    /// if a test list was given, to the test cases the list names.
+    bool NarrowTestSpec(Catch::Session& catchSession)
+    {
+        Conformance::GlobalData& globalData = Conformance::GetGlobalData();
+        const std::string& checkpointFile = globalData.options.checkpointFile;
+        if (!checkpointFile.empty()) {
+            if (!globalData.checkpoint.Open(checkpointFile)) {
+                ReportConsoleOnlyF("Could not open checkpoint file %s.", checkpointFile.c_str());
+                return false;
+            }
+            for (const std::string& crashed : globalData.checkpoint.GetNewlyCrashedTestCases()) {
+                ReportConsoleOnlyF("Test case %s did not finish in the previous run, counting it as failed.", crashed.c_str());
+                globalData.conformanceReport.results[crashed].testFailureCount++;
+            }
+        }
+
+        const std::string& testListFile = globalData.options.testListFile;
+        std::unordered_set<std::string> testList;
+        if (!testListFile.empty()) {
+            std::ifstream file(testListFile);
+            if (!file) {
+                ReportConsoleOnlyF("Could not read test list file %s.", testListFile.c_str());
+                return false;
+            }
+            std::string line;
+            while (std::getline(file, line)) {
+                if (!line.empty() && line.back() == '\r') {
+                    line.pop_back();
+                }
+                if (!line.empty()) {
+                    testList.insert(line);
+                }
+            }
+        }
+
+        if (globalData.checkpoint.GetCompletedCount() == 0 && testListFile.empty()) {
+            return true;
+        }
+
+        // Spell out the test cases left to run: an exclusion would only apply to the comma-separated filter it is part of.
+        const Catch::Config& config = catchSession.config();
+        std::string remainingSpec;
+        size_t remainingCount = 0;
+        for (const Catch::TestCaseHandle& testCase : Catch::filterTests(Catch::getAllTestCasesSorted(config), config.testSpec(), config)) {
+            const std::string& name = testCase.getTestCaseInfo().name;
+            if (globalData.checkpoint.IsCompleted(name) || (!testListFile.empty() && testList.count(name) == 0)) {
+                continue;
+            }
+            remainingSpec += remainingSpec.empty() ? "\"" : ",\"";
+            for (char c : name) {
+                if (c == '\\' || c == '"' || c == ',') {
+                    remainingSpec += '\\';
+                }
+                remainingSpec += c;
+            }
+            remainingSpec += '"';
+            remainingCount++;
+        }
+        if (globalData.checkpoint.GetCompletedCount() > 0) {
+            ReportConsoleOnlyF("Resuming from checkpoint %s: %zu test case(s) already done, %zu left.", checkpointFile.c_str(),
+                               globalData.checkpoint.GetCompletedCount(), remainingCount);
+        }
+
+        Catch::ConfigData configData = catchSession.configData();
+        if (remainingCount == 0) {
+            // Nothing left: run no tests, successfully, so that reporters still write their (empty) reports.
+            configData.testsOrTags = {"~*"};
+            configData.allowZeroTests = true;
+        }
+        else {
+            configData.testsOrTags = {remainingSpec};
+        }
+        catchSession.useConfigData(configData);
+        return true;
+    }
 }  // namespace
 
 // We need to redirect catch2 output through the reporting infrastructure.
@@ -664,6 +1296,7 @@ namespace Catch
 
 XrcResult XRAPI_CALL xrcCleanup()
 {
+    Conformance::ReleaseSharedAutoBasicFixtures();
     GetGlobalData().Shutdown();
     Catch::cleanUp();
     catchSession = nullptr;
@@ -743,15 +1376,34 @@ XrcResult XRAPI_CALL xrcRunConformanceTests(const ConformanceLaunchSettings* con
             ReportConsoleOnlyF("Test failure: Command line arguments were invalid or insufficient.");
             return XRC_ERROR_COMMAND_LINE_INVALID;
         }
-        auto& catchConfig = CreateOrGetCatchSession().config();
         auto& catchConfigData = CreateOrGetCatchSession().configData();
         bool skipActuallyTesting =
             catchConfigData.listTests || catchConfigData.listTags || catchConfigData.listListeners || catchConfigData.listReporters;
+        if (!skipActuallyTesting && !catchConfigData.showHelp && !NarrowTestSpec(CreateOrGetCatchSession())) {
+            return XRC_ERROR_COMMAND_LINE_INVALID;
+        }
+        // Narrowing the test spec replaces the config, so only get it now.
+        auto& catchConfig = CreateOrGetCatchSession().config();
+        if (!skipActuallyTesting && GetGlobalData().options.asyncReport) {
+            StartAsyncReportSink();
+        }
+        const std::string& traceFile = GetGlobalData().options.traceFile;
+        if (!skipActuallyTesting && !traceFile.empty() && !StartTracing(traceFile)) {
+            ReportConsoleOnlyF("Tracing is not compiled into this build (BUILD_CONFORMANCE_TRACING), not writing %s.", traceFile.c_str());
+        }
         bool initialized = true;
         if (!skipActuallyTesting) {
             initialized = GetGlobalData().Initialize();
             if (initialized) {
                 ReportTestEnvironment();
+
+                // Decode the assets of the selected test cases in the background while the first ones start.
+                std::vector<std::string> selectedTestCases;
+                for (const Catch::TestCaseHandle& testCase :
+                     Catch::filterTests(Catch::getAllTestCasesSorted(catchConfig), catchConfig.testSpec(), catchConfig)) {
+                    selectedTestCases.push_back(testCase.getTestCaseInfo().name);
+                }
+                StartAssetPrefetch(selectedTestCases);
             }
         }
 
@@ -784,7 +1436,7 @@ XrcResult XRAPI_CALL xrcRunConformanceTests(const ConformanceLaunchSettings* con
                      !catchConfig.zeroTestsCountAsSuccess()) {
                 *testResult = XRC_TEST_RESULT_ALL_TESTS_SKIPPED;
             }
-            else if (exitCode != 0) {
+            else if (exitCode != 0 || !globalData.checkpoint.GetNewlyCrashedTestCases().empty()) {
                 *testResult = XRC_TEST_RESULT_SOME_TESTS_FAILED;
             }
         }
@@ -802,6 +1454,12 @@ XrcResult XRAPI_CALL xrcRunConformanceTests(const ConformanceLaunchSettings* con
         result = XRC_ERROR_INTERNAL_ERROR;
     }
 
+    StopAssetPrefetch();
+    StopAsyncReportSink();
+    if (!StopTracing()) {
+        ReportConsoleOnlyF("Could not write trace file %s.", GetGlobalData().options.traceFile.c_str());
+    }
+
     if (conformanceTestsRun) {
         // Print a conformance report
         const ConformanceReport& cr = GetGlobalData().GetConformanceReport();
@@ -0,0 +1,85 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "utilities/ballistics.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <openxr/openxr.h>
+
+#include <cmath>
+#include <vector>
+
+namespace Conformance
+{
+    TEST_CASE("BodiesInMotion", "[self_test]")
+    {
+        constexpr XrTime second = 1'000'000'000;
+        constexpr XrVector3f gravity{0.f, -9.8f, 0.f};
+
+        // More bodies than fit in a SIMD register, released at different times, some without angular velocity.
+        std::vector<BodyInMotion> reference;
+        BodiesInMotion batched;
+        for (int i = 0; i < 7; ++i) {
+            XrSpaceVelocity velocity{XR_TYPE_SPACE_VELOCITY};
+            velocity.velocityFlags = XR_SPACE_VELOCITY_LINEAR_VALID_BIT;
+            velocity.linearVelocity = {0.5f * i, 3.0f, -1.0f - i};
+            if (i % 3 != 0) {
+                velocity.velocityFlags |= XR_SPACE_VELOCITY_ANGULAR_VALID_BIT;
+                velocity.angularVelocity = {1.0f, 0.1f * i, -2.0f};
+            }
+            const XrPosef pose{{0, 0, 0, 1}, {0.1f * i, 1.0f, -0.2f * i}};
+            const XrTime releaseTime = second + i * second / 100;
+            reference.push_back(BodyInMotion{velocity, pose, releaseTime, releaseTime});
+            batched.Add(velocity, pose, releaseTime);
+        }
+
+        auto requireSamePoses = [&] {
+            REQUIRE(batched.Size() == reference.size());
+            for (size_t i = 0; i < reference.size(); ++i) {
+                INFO("Body " << i);
+                const XrPosef pose = batched.GetPose(i);
+                CHECK(pose.position.x == reference[i].pose.position.x);
+                CHECK(pose.position.y == reference[i].pose.position.y);
+                CHECK(pose.position.z == reference[i].pose.position.z);
+                CHECK(std::abs(pose.orientation.x - reference[i].pose.orientation.x) < 1e-5f);
+                CHECK(std::abs(pose.orientation.y - reference[i].pose.orientation.y) < 1e-5f);
+                CHECK(std::abs(pose.orientation.z - reference[i].pose.orientation.z) < 1e-5f);
+                CHECK(std::abs(pose.orientation.w - reference[i].pose.orientation.w) < 1e-5f);
+            }
+        };
+
+        for (int frame = 1; frame <= 90; ++frame) {
+            const XrTime displayTime = second + second / 10 + frame * second / 90;
+            for (BodyInMotion& body : reference) {
+                body.doSimulationStep(gravity, displayTime);
+            }
+            batched.doSimulationStep(gravity, displayTime);
+            requireSamePoses();
+        }
+
+        CHECK(batched.AnyWithin(reference[4].pose.position, 0.01f));
+        CHECK_FALSE(batched.AnyWithin({100, 100, 100}, 1.0f));
+
+        // Only the bodies released more than 1.1s before this are removed.
+        const XrTime now = 2 * second + second / 10 + second / 200;
+        batched.RemoveOlderThan(now, second + second / 10);
+        reference.erase(reference.begin(), reference.begin() + 1);
+        requireSamePoses();
+
+        CHECK_THROWS(batched.doSimulationStep(gravity, second));
+    }
+}  // namespace Conformance
@@ -0,0 +1,124 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "composition_utils.h"
+#include "conformance_framework.h"
+#include "conformance_utils.h"
+#include "report.h"
+#include "utilities/process_memory.h"
+#include "utilities/throw_helpers.h"
+#include "utilities/types_and_constants.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <openxr/openxr.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace Conformance
+{
+    namespace
+    {
+        constexpr uint32_t kGrowthRounds = 20;
+        /// Less steady growth than this over all the rounds is taken for allocator noise.
+        constexpr uint64_t kMinGrowthBytes = 1024 * 1024;
+
+        /// Run @p cycle @p cyclesPerRound times per round for a warm-up round and kGrowthRounds measured ones, sampling the
+        /// resident set after each, then report the growth and warn if it was steady.
+        template <typename Cycle>
+        void MeasureCycleGrowth(const char* handleType, uint32_t cyclesPerRound, Cycle&& cycle)
+        {
+            CAPTURE(handleType);
+            for (uint32_t i = 0; i < cyclesPerRound; ++i) {
+                cycle();
+            }
+
+            std::vector<uint64_t> samples{GetProcessResidentMemoryBytes()};
+            if (samples[0] == 0) {
+                SKIP("Cannot query the process resident set on this platform");
+            }
+            for (uint32_t round = 0; round < kGrowthRounds; ++round) {
+                for (uint32_t i = 0; i < cyclesPerRound; ++i) {
+                    cycle();
+                }
+                samples.push_back(GetProcessResidentMemoryBytes());
+            }
+
+            const ResidentGrowth growth = AnalyzeResidentGrowth(samples, kMinGrowthBytes);
+            const std::vector<MetricTag> tags{{"handleType", handleType}};
+            ReportMetric("CreateDestroyCycles.residentGrowth", (double)growth.totalBytes, "bytes", tags);
+            ReportMetric("CreateDestroyCycles.residentGrowthPerCycle", (double)growth.totalBytes / (kGrowthRounds * cyclesPerRound),
+                         "bytes/cycle", tags);
+            ReportMetric("CreateDestroyCycles.growingRounds", growth.growingSteps, "count", tags);
+            ReportConsoleOnlyF("%s: %u cycles grew the resident set by %lld bytes, in %u of %u rounds", handleType,
+                               kGrowthRounds * cyclesPerRound, (long long)growth.totalBytes, growth.growingSteps, growth.steps);
+            if (growth.steady) {
+                WARN(handleType << " create/destroy cycles grew the resident set steadily, by " << growth.totalBytes
+                                << " bytes: the runtime may leak");
+            }
+        }
+    }  // namespace
+
+    // Not a conformance requirement: creates and destroys each kind of handle over and over, sampling the process resident
+    // set, which includes an in-process runtime, after each round. Memory that grows round after round is memory the runtime
+    // does not give back, which only shows in long sessions otherwise. See also --residentMemoryGrowth.
+    TEST_CASE("CreateDestroyCycles_ResidentGrowth_Benchmark", "[.][benchmark]")
+    {
+        GlobalData& globalData = GetGlobalData();
+
+        MeasureCycleGrowth("instance", 5, [] { AutoBasicInstance instance; });
+
+        AutoBasicInstance instance(AutoBasicInstance::createSystemId);
+        MeasureCycleGrowth("actionSet", 100, [&] {
+            XrActionSetCreateInfo actionSetInfo{XR_TYPE_ACTION_SET_CREATE_INFO};
+            strcpy(actionSetInfo.actionSetName, "growth_cycle");
+            strcpy(actionSetInfo.localizedActionSetName, "Growth Cycle");
+            XrActionSet actionSet{XR_NULL_HANDLE};
+            XRC_CHECK_THROW_XRCMD(xrCreateActionSet(instance, &actionSetInfo, &actionSet));
+
+            XrActionCreateInfo actionInfo{XR_TYPE_ACTION_CREATE_INFO};
+            actionInfo.actionType = XR_ACTION_TYPE_BOOLEAN_INPUT;
+            strcpy(actionInfo.actionName, "select");
+            strcpy(actionInfo.localizedActionName, "Select");
+            XrAction action{XR_NULL_HANDLE};
+            XRC_CHECK_THROW_XRCMD(xrCreateAction(actionSet, &actionInfo, &action));
+            XRC_CHECK_THROW_XRCMD(xrDestroyActionSet(actionSet));
+        });
+
+        MeasureCycleGrowth("session", 5, [&] { AutoBasicSession session(AutoBasicSession::createSession, instance); });
+
+        AutoBasicSession session(AutoBasicSession::createSession, instance);
+        MeasureCycleGrowth("referenceSpace", 100, [&] {
+            XrReferenceSpaceCreateInfo createInfo{XR_TYPE_REFERENCE_SPACE_CREATE_INFO};
+            createInfo.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_LOCAL;
+            createInfo.poseInReferenceSpace = Pose::Identity;
+            XrSpace space{XR_NULL_HANDLE};
+            XRC_CHECK_THROW_XRCMD(xrCreateReferenceSpace(session, &createInfo, &space));
+            XRC_CHECK_THROW_XRCMD(xrDestroySpace(space));
+        });
+
+        if (globalData.IsUsingGraphicsPlugin()) {
+            CompositionHelper compositionHelper("Create/destroy cycles");
+            MeasureCycleGrowth("swapchain", 10, [&] {
+                compositionHelper.DestroySwapchain(
+                    compositionHelper.CreateSwapchain(compositionHelper.DefaultColorSwapchainCreateInfo(512, 512)));
+            });
+        }
+    }
+
+}  // namespace Conformance
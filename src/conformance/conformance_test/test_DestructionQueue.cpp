@@ -0,0 +1,64 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "utilities/destruction_queue.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <memory>
+
+namespace Conformance
+{
+    TEST_CASE("DestructionQueue", "[self_test]")
+    {
+        SECTION("Release in fence order")
+        {
+            auto shared = std::make_shared<int>(1);
+            const std::weak_ptr<int> probe = shared;
+            DestructionQueue<std::shared_ptr<int>> queue;
+            queue.PushResource(2, std::move(shared));
+            queue.ReleaseForFenceValue(1);
+            CHECK_FALSE(probe.expired());
+            queue.ReleaseForFenceValue(2);
+            CHECK(probe.expired());
+            CHECK(queue.Empty());
+        }
+
+        SECTION("Reuse the oldest completed resource")
+        {
+            DestructionQueue<std::unique_ptr<int>> queue;
+            queue.PushResource(1, std::unique_ptr<int>(new int(1)));
+            queue.PushResource(3, std::unique_ptr<int>(new int(3)));
+            // Out of order: still kept sorted.
+            queue.PushResource(2, std::unique_ptr<int>(new int(2)));
+
+            std::unique_ptr<int> resource;
+            CHECK_FALSE(queue.TryReuse(0, resource));
+            CHECK(resource == nullptr);
+
+            REQUIRE(queue.TryReuse(3, resource));
+            CHECK(*resource == 1);
+            REQUIRE(queue.TryReuse(3, resource));
+            CHECK(*resource == 2);
+
+            queue.ReleaseForFenceValue(2);
+            CHECK_FALSE(queue.Empty());
+            REQUIRE(queue.TryReuse(3, resource));
+            CHECK(*resource == 3);
+            CHECK(queue.Empty());
+        }
+    }
+}  // namespace Conformance
@@ -0,0 +1,83 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dynamic_resolution.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <openxr/openxr.h>
+
+#include <chrono>
+
+namespace Conformance
+{
+    TEST_CASE("DynamicResolutionController", "[self_test]")
+    {
+        using std::chrono::milliseconds;
+        constexpr XrDuration displayPeriod = 10'000'000;  // 10ms
+
+        DynamicResolutionController::Settings settings;
+        settings.targetFrameFraction = 0.8f;
+        settings.minScale = 0.5f;
+        settings.maxScale = 1.0f;
+        settings.gain = 1.0f;
+        settings.granularity = 8;
+        DynamicResolutionController controller(settings);
+        REQUIRE(controller.GetScale() == 1.0f);
+
+        SECTION("Starts at the full extent")
+        {
+            const XrRect2Di rect = controller.GetImageRect({1000, 800});
+            CHECK(rect.offset.x == 0);
+            CHECK(rect.offset.y == 0);
+            CHECK(rect.extent.width == 1000);
+            CHECK(rect.extent.height == 800);
+        }
+
+        SECTION("Shrinks when over budget, by the square root of the time")
+        {
+            // 4x the 8ms target needs a quarter of the pixels.
+            controller.Update(milliseconds(32), displayPeriod);
+            CHECK(controller.GetScale() == 0.5f);
+            const XrRect2Di rect = controller.GetImageRect({1000, 802});
+            CHECK(rect.extent.width == 496);
+            CHECK(rect.extent.height == 400);
+        }
+
+        SECTION("Clamps to the scale limits")
+        {
+            controller.Update(milliseconds(1000), displayPeriod);
+            CHECK(controller.GetScale() == 0.5f);
+            controller.Update(milliseconds(1), displayPeriod);
+            CHECK(controller.GetScale() == 1.0f);
+        }
+
+        SECTION("Ignores missing feedback")
+        {
+            controller.Update(milliseconds(0), displayPeriod);
+            controller.Update(milliseconds(32), 0);
+            CHECK(controller.GetScale() == 1.0f);
+        }
+
+        SECTION("Damps with the gain")
+        {
+            settings.gain = 0.5f;
+            DynamicResolutionController damped(settings);
+            damped.Update(milliseconds(32), displayPeriod);
+            CHECK(damped.GetScale() == 0.75f);
+        }
+    }
+}  // namespace Conformance
@@ -0,0 +1,99 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "frame_allocation_tracker.h"
+#include "report.h"
+#include "utilities/allocation_counter.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Conformance
+{
+    namespace
+    {
+        const Metric* FindMetric(const std::vector<Metric>& metrics, const std::string& name)
+        {
+            for (const Metric& metric : metrics) {
+                if (metric.name == name) {
+                    return &metric;
+                }
+            }
+            FAIL("Metric " << name << " not reported");
+            return nullptr;
+        }
+    }  // namespace
+
+    TEST_CASE("FrameAllocationTracker", "[self_test]")
+    {
+        if (!IsAllocationCountingEnabled()) {
+            SKIP("Allocations are not counted in this build");
+        }
+        (void)TakeReportedMetrics();
+
+        FrameAllocationTracker tracker("test");
+        tracker.SetBudget(1);
+        // Kept so that the allocations escape and cannot be optimized away.
+        std::vector<std::unique_ptr<int>> allocations;
+        allocations.reserve(FrameAllocationTracker::WarmupFrames + 8);
+
+        const auto runFrame = [&](int allocationCount) {
+            FrameAllocationTracker::Scope scope(tracker);
+            for (int i = 0; i < allocationCount; ++i) {
+                allocations.emplace_back(new int(i));
+            }
+        };
+
+        SECTION("Warm-up frames are not counted")
+        {
+            for (uint32_t i = 0; i < FrameAllocationTracker::WarmupFrames; ++i) {
+                runFrame(5);
+            }
+            CHECK(tracker.GetFrameCount() == 0);
+            CHECK(tracker.GetFramesOverBudget() == 0);
+            tracker.Report();
+            CHECK(TakeReportedMetrics().empty());
+        }
+
+        SECTION("Steady-state frames")
+        {
+            for (uint32_t i = 0; i < FrameAllocationTracker::WarmupFrames; ++i) {
+                runFrame(5);
+            }
+            runFrame(1);
+            runFrame(3);
+            runFrame(0);
+            runFrame(0);
+            CHECK(tracker.GetFrameCount() == 4);
+            CHECK(tracker.GetFramesOverBudget() == 1);
+
+            tracker.Report({{"kind", "self_test"}});
+            const std::vector<Metric> metrics = TakeReportedMetrics();
+            CHECK(FindMetric(metrics, "test.allocationsPerFrame")->value == 1.0);
+            CHECK(FindMetric(metrics, "test.maxAllocationsPerFrame")->value == 3.0);
+            CHECK(FindMetric(metrics, "test.maxAllocatedBytesPerFrame")->value == 3.0 * sizeof(int));
+            CHECK(FindMetric(metrics, "test.framesOverBudget")->value == 1.0);
+            CHECK(FindMetric(metrics, "test.allocationsPerFrame")->tags.front().value == "self_test");
+
+            // Reporting starts over, warm-up included.
+            runFrame(1);
+            CHECK(tracker.GetFrameCount() == 0);
+        }
+    }
+}  // namespace Conformance
@@ -14,9 +14,11 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "common/xr_linear.h"
 #include "composition_utils.h"
 #include "conformance_framework.h"
 #include "conformance_utils.h"
+#include "pipelined_render_loop.h"
 #include "report.h"
 #include "utilities/throw_helpers.h"
 
@@ -27,9 +29,12 @@
 #include <openxr/openxr_reflection.h>
 
 #include <algorithm>
-#include <condition_variable>
-#include <queue>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 #define ENUM_LIST(name, val) name,
 constexpr XrEnvironmentBlendMode SupportedBlendModes[] = {XR_LIST_ENUM_XrEnvironmentBlendMode(ENUM_LIST)};
@@ -271,158 +276,173 @@ namespace Conformance
         }
     }
 
-    // Test uses spends 90% of a predictedDisplayPeriod on both the rendering thread and primary thread. Although the total time
-    // spent is over 100% of allowable time, the OpenXR frame API calls should be made concurrently allowing full frame rate.
-    TEST_CASE("Timed_Pipelined_Frame_Submission", "")
+    namespace
     {
         using ns = std::chrono::nanoseconds;
         using ms = std::chrono::duration<float, std::milli>;
 
-        GlobalData& globalData = GetGlobalData();
-        if (!globalData.IsUsingGraphicsPlugin()) {
-            // Nothing to check - no graphics plugin means no frame submission
-            return;
-        }
-
-        CompositionHelper compositionHelper("Timed Pipeline Frame Submission");
-        compositionHelper.GetInteractionManager().AttachActionSets();
-        compositionHelper.BeginSession();
-
-        SimpleProjectionLayerHelper simpleProjectionLayerHelper(compositionHelper);
+        /// Timings recorded by RunPipelinedFrameLoop.
+        struct PipelinedFrameSamples
+        {
+            /// Frame states returned by xrWaitFrame, for the measured frames only.
+            std::vector<XrFrameState> frameStates;
+            /// Time spent blocked in xrWaitFrame, for the measured frames only.
+            std::vector<ns> waitTimes;
+            /// Time at which xrWaitFrame returned, relative to the start of measurement, for the measured frames only.
+            std::vector<ns> waitReturnTimes;
+            /// Time spent blocked in xrBeginFrame, for all frames including the warmup frames.
+            std::vector<ns> beginTimes;
+            /// Total time from the start of measurement until the last frame was ended.
+            ns elapsed{0};
+        };
 
         // Busy-waiting is more accurate than "sleeping" which can have several milliseconds of additional delay.
-        auto YieldSleep = [](const Stopwatch& sw, ns delay) {
+        void YieldSleep(const Stopwatch& sw, ns delay)
+        {
             while (sw.Elapsed() < delay) {
                 std::this_thread::yield();
             }
-        };
-
-        constexpr int warmupFrameCount = 180;           // Prewarm the frame loop for this many frames.
-        constexpr int testFrameCount = 200;             // Average this many frames for analysis.
-        constexpr double waitBlockPercentage = 0.90;    // Block for 90% of the display period on waitframe thread.
-        constexpr double renderBlockPercentage = 0.70;  // Block for 70% of the display period on render thread.
-
-        std::queue<XrFrameState> queuedFramesForRender;
-        std::mutex displayMutex;
-        std::condition_variable displayCv;
-        bool frameSubmissionCompleted = false;
-
-        ns totalFrameDisplayPeriod(0), totalWaitTime(0), totalBeginTime(0);
-        Stopwatch frameLoopTimer;
-
-        XrResult appThreadResult = XR_SUCCESS;
-
-        auto appThread = std::thread([&]() {
-            ATTACH_THREAD;
-            auto queueFrameRender = [&](const XrFrameState& frameState) {
-                std::unique_lock<std::mutex> lock(displayMutex);
-                queuedFramesForRender.push(frameState);
-                displayCv.notify_one();
-            };
-            auto signalNoMoreFrames = [&]() {
-                std::unique_lock<std::mutex> lock(displayMutex);
-                frameSubmissionCompleted = true;
-                displayCv.notify_one();
-            };
+        }
 
-            // Initially prime things by submitting 180 frames without measuring performance.
-            for (int frame = 0; frame < warmupFrameCount; ++frame) {
-                XrFrameState frameState{XR_TYPE_FRAME_STATE};
-                appThreadResult = xrWaitFrame(compositionHelper.GetSession(), nullptr, &frameState);
-                if (appThreadResult != XR_SUCCESS) {
-                    signalNoMoreFrames();
-                    DETACH_THREAD;
-                    return;
+        /// Runs a frame loop split across two threads like a typical pipelined engine, using @ref PipelinedRenderLoop.
+        /// The simulated "simulation" and "render" phases busy-wait for the given fractions of the predicted display period.
+        PipelinedFrameSamples RunPipelinedFrameLoop(CompositionHelper& compositionHelper,
+                                                    SimpleProjectionLayerHelper& simpleProjectionLayerHelper, int warmupFrameCount,
+                                                    int testFrameCount, double waitBlockPercentage, double renderBlockPercentage)
+        {
+            PipelinedFrameSamples samples;
+            samples.frameStates.reserve(testFrameCount);
+            samples.waitTimes.reserve(testFrameCount);
+            samples.waitReturnTimes.reserve(testFrameCount);
+            samples.beginTimes.reserve(warmupFrameCount + testFrameCount);
+
+            Stopwatch frameLoopTimer;
+
+            auto simulate = [&](PipelinedFrame& frame) {
+                // Initially prime things by submitting frames without measuring performance.
+                const bool measured = frame.frameIndex >= static_cast<uint64_t>(warmupFrameCount);
+                if (measured) {
+                    samples.waitTimes.push_back(frame.waitTime);
+                    samples.waitReturnTimes.push_back(frameLoopTimer.Elapsed());
+                    samples.frameStates.push_back(frame.frameState);
                 }
 
                 // Mimic a lot of time spent in game "simulation" phase.
-                int64_t sleepTime = static_cast<int64_t>(frameState.predictedDisplayPeriod * waitBlockPercentage);
+                int64_t sleepTime = static_cast<int64_t>(frame.frameState.predictedDisplayPeriod * waitBlockPercentage);
                 YieldSleep(Stopwatch(true), ns(sleepTime));
 
-                queueFrameRender(frameState);
-            }
-
-            frameLoopTimer.Restart();
-
-            // Now submit <testFrameCount> frames and measure the total time spent.
-            for (int frame = 0; frame < testFrameCount; ++frame) {
-                XrFrameState frameState{XR_TYPE_FRAME_STATE};
-                {
-                    Stopwatch waitTimer(true);
-                    appThreadResult = xrWaitFrame(compositionHelper.GetSession(), nullptr, &frameState);
-                    if (appThreadResult != XR_SUCCESS) {
-                        signalNoMoreFrames();
+                if (frame.frameIndex + 1 == static_cast<uint64_t>(warmupFrameCount)) {
+                    frameLoopTimer.Restart();
+                }
+                return frame.frameIndex + 1 < static_cast<uint64_t>(warmupFrameCount + testFrameCount);
+            };
 
-                        DETACH_THREAD;
-                        return;
-                    }
+            auto render = [&](const PipelinedFrame& frame, std::vector<XrCompositionLayerBaseHeader*>& layers) {
+                samples.beginTimes.push_back(frame.beginTime);
 
-                    totalWaitTime += waitTimer.Elapsed();
+                Stopwatch sw(true);
+                if (XrCompositionLayerBaseHeader* projLayer = simpleProjectionLayerHelper.TryGetUpdatedProjectionLayer(frame.frameState)) {
+                    layers.push_back(projLayer);
                 }
 
-                totalFrameDisplayPeriod += ns(frameState.predictedDisplayPeriod);
-
-                // Mimic a lot of time spent in game "simulation" phase.
-                int64_t sleepTime = static_cast<int64_t>(frameState.predictedDisplayPeriod * waitBlockPercentage);
-                YieldSleep(Stopwatch(true), ns(sleepTime));
+                // Mimic a lot of time spent in game render phase.
+                int64_t sleepTime = static_cast<int64_t>(frame.frameState.predictedDisplayPeriod * renderBlockPercentage);
+                YieldSleep(sw, ns(sleepTime));
+            };
 
-                queueFrameRender(frameState);
-            }
+            PipelinedRenderLoop(compositionHelper, simulate, render).Loop();
 
-            // Signal that no more frames are coming and wait for the render thread to exit.
-            signalNoMoreFrames();
-            DETACH_THREAD;
-        });
+            frameLoopTimer.Stop();
+            samples.elapsed = frameLoopTimer.Elapsed();
+            return samples;
+        }
 
-        while (appThreadResult == XR_SUCCESS) {
-            // Dequeue a frame to render.
-            XrFrameState frameState;
-            {
-                std::unique_lock<std::mutex> lock(displayMutex);
-                displayCv.wait(lock, [&] { return !queuedFramesForRender.empty() || frameSubmissionCompleted; });
-                if (queuedFramesForRender.empty()) {
-                    REQUIRE(frameSubmissionCompleted);
-                    break;
+        FramePacingResults AnalyzeFramePacing(const FramePacingLoad& load, const PipelinedFrameSamples& samples, size_t warmupFrameCount)
+        {
+            FramePacingResults results;
+            results.load = load;
+            results.frameCount = static_cast<uint32_t>(samples.frameStates.size());
+
+            ns totalDisplayPeriod{0};
+            for (const XrFrameState& frameState : samples.frameStates) {
+                totalDisplayPeriod += ns(frameState.predictedDisplayPeriod);
+                if (!frameState.shouldRender) {
+                    results.shouldRenderFalseCount++;
                 }
-                frameState = queuedFramesForRender.front();
-                queuedFramesForRender.pop();
             }
+            results.averageDisplayPeriod = totalDisplayPeriod / std::max<size_t>(samples.frameStates.size(), 1);
+
+            std::vector<ns> frameTimes;
+            for (size_t i = 1; i < samples.waitReturnTimes.size(); ++i) {
+                const ns frameTime = samples.waitReturnTimes[i] - samples.waitReturnTimes[i - 1];
+                frameTimes.push_back(frameTime);
+
+                const double periods = frameTime.count() / (double)samples.frameStates[i].predictedDisplayPeriod;
+                const size_t bucket = static_cast<size_t>(periods / FramePacingResults::HistogramBucketWidth);
+                results.frameTimeHistogram[std::min(bucket, results.frameTimeHistogram.size() - 1)]++;
+
+                // Successive frames should be predicted to display exactly one display period apart.
+                const XrTime displayTimeDelta =
+                    samples.frameStates[i].predictedDisplayTime - samples.frameStates[i - 1].predictedDisplayTime;
+                const double displayPeriods = displayTimeDelta / (double)samples.frameStates[i].predictedDisplayPeriod;
+                if (displayPeriods > 1.5) {
+                    results.missedFrameCount += static_cast<uint32_t>(std::lround(displayPeriods)) - 1;
+                }
+            }
+            results.frameTime = DurationPercentiles::FromSamples(std::move(frameTimes));
+            results.waitTime = DurationPercentiles::FromSamples(samples.waitTimes);
+            results.beginTime = DurationPercentiles::FromSamples(
+                std::vector<ns>(samples.beginTimes.begin() + std::min(warmupFrameCount, samples.beginTimes.size()), samples.beginTimes.end()));
+            return results;
+        }
+    }  // namespace
+
+    // Test uses spends 90% of a predictedDisplayPeriod on both the rendering thread and primary thread. Although the total time
+    // spent is over 100% of allowable time, the OpenXR frame API calls should be made concurrently allowing full frame rate.
+    TEST_CASE("Timed_Pipelined_Frame_Submission", "")
+    {
+        GlobalData& globalData = GetGlobalData();
+        if (!globalData.IsUsingGraphicsPlugin()) {
+            // Nothing to check - no graphics plugin means no frame submission
+            return;
+        }
 
-            Stopwatch sw(true);
-            XRC_CHECK_THROW_XRCMD(xrBeginFrame(compositionHelper.GetSession(), nullptr));
-            totalBeginTime += sw.Elapsed();
+        CompositionHelper compositionHelper("Timed Pipeline Frame Submission");
+        compositionHelper.GetInteractionManager().AttachActionSets();
+        compositionHelper.BeginSession();
 
-            sw.Restart();
+        SimpleProjectionLayerHelper simpleProjectionLayerHelper(compositionHelper);
 
-            std::vector<XrCompositionLayerBaseHeader*> layers;
-            if (XrCompositionLayerBaseHeader* projLayer = simpleProjectionLayerHelper.TryGetUpdatedProjectionLayer(frameState)) {
-                layers.push_back(projLayer);
-            }
+        constexpr int warmupFrameCount = 180;           // Prewarm the frame loop for this many frames.
+        constexpr int testFrameCount = 200;             // Average this many frames for analysis.
+        constexpr double waitBlockPercentage = 0.90;    // Block for 90% of the display period on waitframe thread.
+        constexpr double renderBlockPercentage = 0.70;  // Block for 70% of the display period on render thread.
 
-            // Mimic a lot of time spent in game render phase.
-            int64_t sleepTime = static_cast<int64_t>(frameState.predictedDisplayPeriod * renderBlockPercentage);
-            YieldSleep(sw, ns(sleepTime));
+        const PipelinedFrameSamples samples = RunPipelinedFrameLoop(compositionHelper, simpleProjectionLayerHelper, warmupFrameCount,
+                                                                    testFrameCount, waitBlockPercentage, renderBlockPercentage);
 
-            compositionHelper.EndFrame(frameState.predictedDisplayTime, layers);
+        ns totalFrameDisplayPeriod(0), totalWaitTime(0), totalBeginTime(0);
+        for (const XrFrameState& frameState : samples.frameStates) {
+            totalFrameDisplayPeriod += ns(frameState.predictedDisplayPeriod);
         }
-
-        frameLoopTimer.Stop();
-        if (appThread.joinable()) {
-            appThread.join();
-            REQUIRE_RESULT_SUCCEEDED(appThreadResult);
+        for (const ns& waitTime : samples.waitTimes) {
+            totalWaitTime += waitTime;
+        }
+        for (const ns& beginTime : samples.beginTimes) {
+            totalBeginTime += beginTime;
         }
 
         const ns averageWaitTime = totalWaitTime / testFrameCount;
-        ReportF("Average xrWaitFrame wait time    : %.3fms", std::chrono::duration_cast<ms>(averageWaitTime).count());
+        ReportMetric("averageWaitTime", std::chrono::duration_cast<ms>(averageWaitTime).count(), "ms");
 
-        const ns averageAppFrameTime = frameLoopTimer.Elapsed() / testFrameCount;
-        ReportF("Average time spent per frame     : %.3fms", std::chrono::duration_cast<ms>(averageAppFrameTime).count());
+        const ns averageAppFrameTime = samples.elapsed / testFrameCount;
+        ReportMetric("averageAppFrameTime", std::chrono::duration_cast<ms>(averageAppFrameTime).count(), "ms");
 
         const ns averageDisplayPeriod = totalFrameDisplayPeriod / testFrameCount;
-        ReportF("Average predicted display period : %.3fms", std::chrono::duration_cast<ms>(averageDisplayPeriod).count());
+        ReportMetric("averageDisplayPeriod", std::chrono::duration_cast<ms>(averageDisplayPeriod).count(), "ms");
 
         const ns averageBeginTime = totalBeginTime / testFrameCount;
-        ReportF("Average xrBeginFrame wait time   : %.3fms", std::chrono::duration_cast<ms>(averageBeginTime).count());
+        ReportMetric("averageBeginWaitTime", std::chrono::duration_cast<ms>(averageBeginTime).count(), "ms");
 
         auto timingResults = TimedSubmissionResults{averageWaitTime, averageAppFrameTime, averageDisplayPeriod, averageBeginTime};
         {
@@ -433,7 +453,7 @@ namespace Conformance
         // Higher is worse. An overhead of 50% means a 16.66ms display period ran with an average of 25ms per frame.
         // Since frames should be discrete multiples of the display period 50% implies that half of the frames
         // took two display periods to complete, 100% implies every frame took two periods.
-        ReportF("Overhead score                   : %.1f%%", timingResults.GetOverheadFactor() * 100);
+        ReportMetric("overhead", timingResults.GetOverheadFactor() * 100, "percent");
 
         // Allow up to 50% of frames to miss timing. This is number is arbitrary and open to debate.
         // The point of this test is to fail runtimes that get 1.0 (100% overhead) because they are
@@ -449,4 +469,114 @@ namespace Conformance
         REQUIRE_MSG(averageBeginTime.count() / (double)averageDisplayPeriod.count() < 0.1,
                     "Begin frame overhead in pipelined frame submission is too high");
     }
+
+    // Not a conformance requirement: sweeps simulated load over the pipelined frame loop above and records the frame time
+    // distribution, missed frames and shouldRender statistics in the CTS XML report, to track frame pacing over time.
+    // Loads can be chosen with --framePacingLoad and the length of each step with --framePacingFrameCount.
+    TEST_CASE("Frame_Pacing_Benchmark", "[.][benchmark]")
+    {
+        GlobalData& globalData = GetGlobalData();
+        if (!globalData.IsUsingGraphicsPlugin()) {
+            SKIP("Cannot benchmark frame submission without a graphics plugin");
+        }
+
+        std::vector<FramePacingLoad> loads = globalData.GetOptions().framePacingLoads;
+        if (loads.empty()) {
+            // From lightly loaded to overcommitted, with the same balance as Timed_Pipelined_Frame_Submission in the middle.
+            loads = {{0.25, 0.25}, {0.50, 0.50}, {0.90, 0.70}, {0.95, 0.95}, {1.10, 0.50}, {0.50, 1.10}};
+        }
+        const int testFrameCount = static_cast<int>(globalData.GetOptions().framePacingFrameCount);
+        constexpr int warmupFrameCount = 90;  // Let the frame loop settle at each new load.
+
+        CompositionHelper compositionHelper("Frame Pacing Benchmark");
+        compositionHelper.GetInteractionManager().AttachActionSets();
+        compositionHelper.BeginSession();
+
+        SimpleProjectionLayerHelper simpleProjectionLayerHelper(compositionHelper);
+
+        for (const FramePacingLoad& load : loads) {
+            const PipelinedFrameSamples samples =
+                RunPipelinedFrameLoop(compositionHelper, simpleProjectionLayerHelper, warmupFrameCount, testFrameCount, load.cpu, load.gpu);
+            const FramePacingResults results = AnalyzeFramePacing(load, samples, warmupFrameCount);
+
+            ReportConsoleOnlyF("Load %.0f%% cpu / %.0f%% gpu, %u frames, display period %.3fms", load.cpu * 100, load.gpu * 100,
+                               results.frameCount, std::chrono::duration_cast<ms>(results.averageDisplayPeriod).count());
+            ReportConsoleOnlyF("    frame time p50/p90/p99/max : %.3f / %.3f / %.3f / %.3fms",
+                               std::chrono::duration_cast<ms>(results.frameTime.p50).count(),
+                               std::chrono::duration_cast<ms>(results.frameTime.p90).count(),
+                               std::chrono::duration_cast<ms>(results.frameTime.p99).count(),
+                               std::chrono::duration_cast<ms>(results.frameTime.max).count());
+            ReportConsoleOnlyF("    xrWaitFrame p50/p99        : %.3f / %.3fms", std::chrono::duration_cast<ms>(results.waitTime.p50).count(),
+                               std::chrono::duration_cast<ms>(results.waitTime.p99).count());
+            ReportConsoleOnlyF("    xrBeginFrame p50/p99       : %.3f / %.3fms", std::chrono::duration_cast<ms>(results.beginTime.p50).count(),
+                               std::chrono::duration_cast<ms>(results.beginTime.p99).count());
+            ReportConsoleOnlyF("    missed frames              : %u", results.missedFrameCount);
+            ReportConsoleOnlyF("    shouldRender false         : %u", results.shouldRenderFalseCount);
+
+            {
+                std::unique_lock<std::recursive_mutex> lock(GetGlobalData().dataMutex);
+                GetGlobalData().conformanceReport.framePacing.push_back(results);
+            }
+        }
+
+        compositionHelper.ReportLockWaitMetrics();
+    }
+
+    // Not a conformance requirement: locates the views again just before rendering each frame of the pipelined frame loop above,
+    // and reports how far the views moved since the first call for the same display time, how much later the second call was,
+    // and what it cost. Movement shows how much the runtime's prediction improves as the display time nears.
+    TEST_CASE("Frame_LateLatching_Benchmark", "[.][benchmark]")
+    {
+        using us = std::chrono::duration<double, std::micro>;
+        constexpr double RadiansToDegrees = 180.0 / MATH_PI;
+
+        GlobalData& globalData = GetGlobalData();
+        if (!globalData.IsUsingGraphicsPlugin()) {
+            SKIP("Cannot benchmark frame submission without a graphics plugin");
+        }
+
+        CompositionHelper compositionHelper("Late Latching Benchmark");
+        compositionHelper.GetInteractionManager().AttachActionSets();
+        compositionHelper.BeginSession();
+
+        SimpleProjectionLayerHelper simpleProjectionLayerHelper(compositionHelper);
+        simpleProjectionLayerHelper.EnableLateLatching();
+
+        constexpr int warmupFrameCount = 90;
+        constexpr int testFrameCount = 600;
+        for (const FramePacingLoad& load : {FramePacingLoad{0.25, 0.25}, FramePacingLoad{0.50, 0.50}, FramePacingLoad{0.90, 0.70}}) {
+            RunPipelinedFrameLoop(compositionHelper, simpleProjectionLayerHelper, warmupFrameCount, 0, load.cpu, load.gpu);
+            simpleProjectionLayerHelper.ResetLateLatchStats();
+            RunPipelinedFrameLoop(compositionHelper, simpleProjectionLayerHelper, 0, testFrameCount, load.cpu, load.gpu);
+
+            const LateLatchStats& stats = simpleProjectionLayerHelper.GetLateLatchStats();
+            if (stats.frameCount == 0) {
+                WARN("No frame had valid view poses: nothing to report");
+                continue;
+            }
+            const double frameCount = (double)stats.frameCount;
+            const double positionDeltaMm = stats.positionDeltaSum / frameCount * 1000;
+            const double angleDeltaDeg = stats.angleDeltaSum / frameCount * RadiansToDegrees;
+            const double latchIntervalUs = us(stats.latchIntervalSum).count() / frameCount;
+            const double relocateTimeUs = us(stats.relocateTimeSum).count() / frameCount;
+
+            ReportConsoleOnlyF("Load %.0f%% cpu / %.0f%% gpu, %u late-latched frames", load.cpu * 100, load.gpu * 100,
+                               (uint32_t)stats.frameCount);
+            ReportConsoleOnlyF("    view moved mean/max        : %.3f / %.3fmm, %.4f / %.4f deg", positionDeltaMm,
+                               stats.positionDeltaMax * 1000, angleDeltaDeg, stats.angleDeltaMax * RadiansToDegrees);
+            ReportConsoleOnlyF("    poses fresher by mean      : %.1fus", latchIntervalUs);
+            ReportConsoleOnlyF("    xrLocateViews mean/max     : %.1f / %.1fus", relocateTimeUs, us(stats.relocateTimeMax).count());
+
+            char loadString[32];
+            snprintf(loadString, sizeof(loadString), "%.2f/%.2f", load.cpu, load.gpu);
+            const std::vector<MetricTag> tags{{"load", loadString}};
+            ReportMetric("lateLatch.positionDelta", positionDeltaMm, "mm", tags);
+            ReportMetric("lateLatch.positionDeltaMax", stats.positionDeltaMax * 1000, "mm", tags);
+            ReportMetric("lateLatch.angleDelta", angleDeltaDeg, "deg", tags);
+            ReportMetric("lateLatch.angleDeltaMax", stats.angleDeltaMax * RadiansToDegrees, "deg", tags);
+            ReportMetric("lateLatch.latchInterval", latchIntervalUs, "us", tags);
+            ReportMetric("lateLatch.relocateTime", relocateTimeUs, "us", tags);
+            ReportMetric("lateLatch.relocateTimeMax", us(stats.relocateTimeMax).count(), "us", tags);
+        }
+    }
 }  // namespace Conformance
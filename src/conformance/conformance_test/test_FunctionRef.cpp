@@ -0,0 +1,74 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "utilities/allocation_counter.h"
+#include "utilities/function_ref.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <array>
+
+namespace Conformance
+{
+    namespace
+    {
+        int CallTwice(FunctionRef<int(int)> f)
+        {
+            return f(f(1));
+        }
+    }  // namespace
+
+    TEST_CASE("FunctionRef", "[self_test]")
+    {
+        SECTION("Calls the referenced lambda")
+        {
+            int calls = 0;
+            CHECK(CallTwice([&](int x) {
+                      ++calls;
+                      return x + 10;
+                  }) == 21);
+            CHECK(calls == 2);
+        }
+
+        SECTION("Does not allocate, even for large captures")
+        {
+            std::array<int, 64> big{};
+            big[5] = 7;
+            const uint64_t before = GetThreadAllocationCount();
+            const int result = CallTwice([big](int x) { return x * big[5]; });
+            CHECK(GetThreadAllocationCount() == before);
+            CHECK(result == 49);
+        }
+
+        SECTION("Refers to a mutable callable rather than a copy of it")
+        {
+            int count = 0;
+            auto counter = [count](int x) mutable { return count += x; };
+            CHECK(CallTwice(counter) == 2);
+            CHECK(counter(0) == 2);
+        }
+    }
+
+    TEST_CASE("AllocationCounter", "[self_test]")
+    {
+        if (!IsAllocationCountingEnabled()) {
+            SKIP("Allocations are only counted in debug builds");
+        }
+        const uint64_t before = GetThreadAllocationCount();
+        delete new int(3);
+        CHECK(GetThreadAllocationCount() == before + 1);
+    }
+}  // namespace Conformance
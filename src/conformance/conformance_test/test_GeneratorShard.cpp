@@ -0,0 +1,73 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "utilities/bitmask_generator.h"
+#include "utilities/generator.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+namespace Conformance
+{
+    namespace
+    {
+        std::vector<uint64_t> Generate(GeneratorShard shard)
+        {
+            const GeneratorShard previous = CurrentGeneratorShard();
+            CurrentGeneratorShard() = shard;
+            auto generator = bitmaskGeneratorIncluding0({0x1, 0x2, 0x4});
+            CurrentGeneratorShard() = previous;
+
+            std::vector<uint64_t> values;
+            while (generator.next()) {
+                values.push_back(generator.get());
+            }
+            return values;
+        }
+    }  // namespace
+
+    TEST_CASE("GeneratorShard", "[self_test]")
+    {
+        const std::vector<uint64_t> all = Generate({0, 1});
+        REQUIRE(all.size() == 8);
+
+        SECTION("Shards produce every value exactly once between them")
+        {
+            std::vector<uint64_t> combined;
+            for (uint32_t index = 0; index < 3; ++index) {
+                const std::vector<uint64_t> share = Generate({index, 3});
+                CHECK(share.size() == (index < 2 ? 3u : 2u));
+                combined.insert(combined.end(), share.begin(), share.end());
+            }
+            std::sort(combined.begin(), combined.end());
+            std::vector<uint64_t> expected = all;
+            std::sort(expected.begin(), expected.end());
+            CHECK(combined == expected);
+        }
+
+        SECTION("A shard produces the values at its index")
+        {
+            const std::vector<uint64_t> share = Generate({1, 3});
+            REQUIRE(share.size() == 3);
+            CHECK(share[0] == all[1]);
+            CHECK(share[1] == all[4]);
+            CHECK(share[2] == all[7]);
+        }
+    }
+}  // namespace Conformance
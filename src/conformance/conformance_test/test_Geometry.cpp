@@ -0,0 +1,101 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "utilities/Geometry.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <openxr/openxr.h>
+
+#include <cmath>
+#include <stdexcept>
+
+namespace Conformance
+{
+    namespace
+    {
+        XrVector3f Sub(XrVector3f a, XrVector3f b)
+        {
+            return {a.x - b.x, a.y - b.y, a.z - b.z};
+        }
+
+        /// How many non-degenerate triangles of @p mesh are wound clockwise seen from @p outside, which gives the direction
+        /// out of the surface at a point.
+        template <typename Outside>
+        uint32_t CountClockwiseFromOutside(const Geometry::Mesh& mesh, Outside outside)
+        {
+            uint32_t clockwise = 0;
+            for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+                const XrVector3f a = mesh.vertices[mesh.indices[i]].Position;
+                const XrVector3f b = mesh.vertices[mesh.indices[i + 1]].Position;
+                const XrVector3f c = mesh.vertices[mesh.indices[i + 2]].Position;
+                const XrVector3f ab = Sub(b, a);
+                const XrVector3f ac = Sub(c, a);
+                const XrVector3f normal{ab.y * ac.z - ab.z * ac.y, ab.z * ac.x - ab.x * ac.z, ab.x * ac.y - ab.y * ac.x};
+                const XrVector3f centroid{(a.x + b.x + c.x) / 3, (a.y + b.y + c.y) / 3, (a.z + b.z + c.z) / 3};
+                const XrVector3f out = outside(centroid);
+                // Same convention as the cube: the right-handed normal points into the surface.
+                if (normal.x * out.x + normal.y * out.y + normal.z * out.z < 0) {
+                    ++clockwise;
+                }
+            }
+            return clockwise;
+        }
+    }  // namespace
+
+    TEST_CASE("Geometry_GeneratedMeshes", "[self_test]")
+    {
+        SECTION("Cube convention")
+        {
+            Geometry::Mesh cube;
+            cube.vertices.assign(Geometry::c_cubeVertices.begin(), Geometry::c_cubeVertices.end());
+            cube.indices.assign(Geometry::c_cubeIndices.begin(), Geometry::c_cubeIndices.end());
+            CHECK(CountClockwiseFromOutside(cube, [](XrVector3f p) { return p; }) == 12);
+        }
+        SECTION("Sphere")
+        {
+            const Geometry::Mesh sphere = Geometry::MakeSphere(32, 16);
+            CHECK(sphere.TriangleCount() == 2 * 32 * 16);
+            CHECK(sphere.vertices.size() == 33 * 17);
+            // The triangles touching the poles have one side of zero length.
+            CHECK(CountClockwiseFromOutside(sphere, [](XrVector3f p) { return p; }) == 2 * 32 * 16 - 2 * 32);
+        }
+        SECTION("Grid")
+        {
+            const Geometry::Mesh grid = Geometry::MakeGrid(10, 20);
+            CHECK(grid.TriangleCount() == 2 * 10 * 20);
+            CHECK(CountClockwiseFromOutside(grid, [](XrVector3f) { return XrVector3f{0, 0, 1}; }) == grid.TriangleCount());
+        }
+        SECTION("Torus")
+        {
+            const float ringRadius = 0.35f;
+            const Geometry::Mesh torus = Geometry::MakeTorus(48, 24, ringRadius);
+            CHECK(torus.TriangleCount() == 2 * 48 * 24);
+            // Out of a torus is away from the nearest point of the circle through the middle of the tube.
+            auto outside = [&](XrVector3f p) {
+                const float length = std::sqrt(p.x * p.x + p.z * p.z);
+                return Sub(p, {p.x * ringRadius / length, 0, p.z * ringRadius / length});
+            };
+            CHECK(CountClockwiseFromOutside(torus, outside) == torus.TriangleCount());
+        }
+        SECTION("Largest")
+        {
+            CHECK(Geometry::MakeGrid(255, 255).vertices.size() == Geometry::MaxMeshVertices);
+            CHECK_THROWS_AS(Geometry::MakeGrid(256, 255), std::invalid_argument);
+            CHECK_THROWS_AS(Geometry::MakeTorus(0, 8), std::invalid_argument);
+        }
+    }
+}  // namespace Conformance
@@ -63,8 +63,8 @@ namespace Conformance
         {
 
             return compositionHelper.CreateQuadLayer(
-                compositionHelper.CreateStaticSwapchainImage(
-                    CreateTextImage(labelImageWidth, labelImageHeight, label.c_str(), labelFontSize, WordWrap::Disabled)),
+                compositionHelper.CreateStaticSwapchainText(labelImageWidth, labelImageHeight, label.c_str(), labelFontSize,
+                                                            WordWrap::Disabled),
                 viewSpace, labelWidth, {Quat::Identity, position});
         }
 
@@ -77,6 +77,19 @@ namespace Conformance
         constexpr float margin = 0.02f;  // the gap between quads
         constexpr float yOffset = (gradientHeight + margin) / 2;
 
+        // if any of the other format's color channels aren't present,
+        // they should be sampled as zero, so also zero them here to match
+        inline XrColor4f GradientColor(SwapchainFormat::RawColorComponents referenceComponents, float value)
+        {
+            using Components = SwapchainFormat::RawColorComponents;
+            return XrColor4f{
+                referenceComponents & Components::r ? value : 0.0f,
+                referenceComponents & Components::g ? value : 0.0f,
+                referenceComponents & Components::b ? value : 0.0f,
+                1.0,
+            };
+        }
+
         inline MeshHandle MakeGradientMesh(IGraphicsPlugin& graphicsPlugin, SwapchainFormat::RawColorComponents referenceComponents)
         {
             // 0-2
@@ -87,15 +100,7 @@ namespace Conformance
             for (int col = 0; col < gradientImageWidth; col++) {
                 float value = col / (float)gradientImageWidth;
 
-                // if any of the other format's color channels aren't present,
-                // they should be sampled as zero, so also zero them here to match
-                using Components = SwapchainFormat::RawColorComponents;
-                XrColor4f color{
-                    referenceComponents & Components::r ? value : 0.0f,
-                    referenceComponents & Components::g ? value : 0.0f,
-                    referenceComponents & Components::b ? value : 0.0f,
-                    1.0,
-                };
+                XrColor4f color = GradientColor(referenceComponents, value);
 
                 color = ColorUtils::FromSRGB(color);  // perceptual gradient instead of linear
                 float x = -(gradientWidth / 2) + gradientWidth * value;
@@ -182,6 +187,14 @@ namespace Conformance
                 gradientQuadSwapchain = compositionHelper.CreateSwapchain(createInfo);
             }
 
+            // The quad's content never changes, so draw its gradient once, straight into its format.
+            // Each gradient should only write non-zero to the color components that the **other** format supports, see below.
+            const ProceduralFill quadGradient =
+                ProceduralFill::Gradient(Colors::Black, GradientColor(projTestParameters.colorComponents, 1.0f));
+            compositionHelper.AcquireWaitReleaseImage(gradientQuadSwapchain, [&](const XrSwapchainImageBaseHeader* swapchainImage) {
+                GetGlobalData().graphicsPlugin->FillImageSlice(swapchainImage, 0, gradientImageWidth, gradientImageHeight, quadGradient);
+            });
+
             const float labelYOffset = gradientHeight + (labelHeight / 2) + labelMargin;
 
             XrCompositionLayerQuad* const projFormatLabelQuad = MakeFormatLabel(
@@ -199,7 +212,6 @@ namespace Conformance
             // Each mesh should only write non-zero to the color components that the **other** format supports, which is why the below looks backwards.
             // We could do an intersection of the two format components, but e.g. writing all white to a format with fewer channels
             // may expose errors that writing something more limited would not.
-            MeshHandle quadMesh = MakeGradientMesh(*globalData.graphicsPlugin, projTestParameters.colorComponents);
             MeshHandle projMesh = MakeGradientMesh(*globalData.graphicsPlugin, quadTestParameters.colorComponents);
 
             auto updateLayers = [&](const XrFrameState& frameState) {
@@ -212,22 +224,6 @@ namespace Conformance
                     const auto& views = std::get<std::vector<XrView>>(viewData);
 
                     const uint32_t imageArrayIndex = 0;
-                    // Render the gradient into the quad's swapchain
-                    compositionHelper.AcquireWaitReleaseImage(gradientQuadSwapchain, [&](const XrSwapchainImageBaseHeader* swapchainImage) {
-                        GetGlobalData().graphicsPlugin->ClearImageSlice(swapchainImage, imageArrayIndex, Colors::Black);
-
-                        XrCompositionLayerProjectionView view = {XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW};
-                        const float quadRenderDistance = 1.0;
-                        const float halfAngleX = std::atan2(gradientWidth / 2, quadRenderDistance);
-                        const float halfAngleY = std::atan2(gradientHeight / 2, quadRenderDistance);
-                        view.fov = {-halfAngleX, halfAngleX, halfAngleY, -halfAngleY};
-                        view.pose = Pose::Identity;
-                        view.subImage = compositionHelper.MakeDefaultSubImage(gradientQuadSwapchain, imageArrayIndex);
-
-                        auto quadMeshList = {MeshDrawable{quadMesh, {Quat::Identity, {0, 0, -quadRenderDistance}}}};
-                        GetGlobalData().graphicsPlugin->RenderView(view, swapchainImage, RenderParams().Draw(quadMeshList));
-                    });
-
                     auto projMeshList = {MeshDrawable{projMesh, {Quat::Identity, {0, yOffset, quadZ}}}};
                     // Render into each of the separate swapchains using the projection layer view fov and pose.
                     for (size_t view = 0; view < views.size(); view++) {
@@ -19,6 +19,7 @@
 #include "composition_utils.h"
 #include "conformance_framework.h"
 #include "graphics_plugin.h"
+#include "report.h"
 #include "utilities/throw_helpers.h"
 #include "utilities/types_and_constants.h"
 
@@ -26,10 +27,12 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include <array>
+#include <chrono>
 #include <cstdint>
 #include <cstring>
 #include <functional>
 #include <memory>
+#include <string>
 #include <tuple>
 #include <vector>
 
@@ -136,7 +139,7 @@ namespace Conformance
 
         // Create the instructional quad layer placed to the left.
         XrCompositionLayerQuad* const instructionsQuad =
-            compositionHelper.CreateQuadLayer(compositionHelper.CreateStaticSwapchainImage(CreateTextImage(1024, 512, instructions, 48)),
+            compositionHelper.CreateQuadLayer(compositionHelper.CreateStaticSwapchainText(1024, 512, instructions, 48),
                                               localSpace, 1, {{0, 0, 0, 1}, {-1.5f, 0, -0.3f}});
         instructionsQuad->pose.orientation = Quat::FromAxisAngle(Up, DegToRad(70));
 
@@ -222,15 +225,16 @@ namespace Conformance
                 const auto& views = std::get<std::vector<XrView>>(viewData);
 
                 // Render into each of the separate swapchains using the projection layer view fov and pose.
-                for (size_t view = 0; view < views.size(); view++) {
-                    compositionHelper.AcquireWaitReleaseImage(swapchains[view], [&](const XrSwapchainImageBaseHeader* swapchainImage) {
-                        GetGlobalData().graphicsPlugin->ClearImageSlice(swapchainImage, 0);
-                        const_cast<XrFovf&>(projLayer->views[view].fov) = views[view].fov;
-                        const_cast<XrPosef&>(projLayer->views[view].pose) = views[view].pose;
-                        GetGlobalData().graphicsPlugin->RenderView(projLayer->views[view], swapchainImage,
-                                                                   RenderParams().Draw(renderedCubes));
+                compositionHelper.AcquireWaitReleaseImages(
+                    swapchains, [&](const std::vector<const XrSwapchainImageBaseHeader*>& swapchainImages) {
+                        for (size_t view = 0; view < views.size(); view++) {
+                            GetGlobalData().graphicsPlugin->ClearImageSlice(swapchainImages[view], 0);
+                            const_cast<XrFovf&>(projLayer->views[view].fov) = views[view].fov;
+                            const_cast<XrPosef&>(projLayer->views[view].pose) = views[view].pose;
+                        }
+                        GetGlobalData().graphicsPlugin->RenderViews({projLayer->views, projLayer->viewCount}, swapchainImages,
+                                                                    RenderParams().Draw(renderedCubes));
                     });
-                }
 
                 layers.push_back({reinterpret_cast<XrCompositionLayerBaseHeader*>(projLayer)});
             }
@@ -245,4 +249,185 @@ namespace Conformance
 
         RenderLoop(compositionHelper.GetSession(), update).Loop();
     }
+
+    // Not a conformance requirement: calls xrApplyHapticFeedback and xrStopHapticFeedback from the frame loop at increasing
+    // rates, over increasing numbers of haptic actions and every subaction path, as engines do for rumble effects. Reports
+    // the cost of each call and how much of the frame the calls take, to show whether the runtime blocks the frame thread.
+    TEST_CASE("Haptic_Call_Benchmark", "[.][benchmark]")
+    {
+        using clock = std::chrono::steady_clock;
+        using us = std::chrono::duration<double, std::micro>;
+        using ms = std::chrono::duration<double, std::milli>;
+
+        constexpr uint32_t kMaxHapticActionCount = 32;
+        constexpr uint32_t kWarmupFrameCount = 30;
+        constexpr uint32_t kMeasuredFrameCount = 240;
+
+        CompositionHelper compositionHelper("Haptic call benchmark");
+        const XrInstance instance = compositionHelper.GetInstance();
+        const XrSession session = compositionHelper.GetSession();
+
+        const std::vector<XrPath> subactionPaths{StringToPath(instance, "/user/hand/left"), StringToPath(instance, "/user/hand/right")};
+        // Calls cycle through each hand and both at once.
+        const std::array<XrPath, 3> callSubactionPaths{{subactionPaths[0], subactionPaths[1], XR_NULL_PATH}};
+
+        XrActionSet actionSet{XR_NULL_HANDLE};
+        std::vector<XrAction> hapticActions;
+        std::vector<XrActionSuggestedBinding> bindings;
+        {
+            XrActionSetCreateInfo actionSetInfo{XR_TYPE_ACTION_SET_CREATE_INFO};
+            strcpy(actionSetInfo.actionSetName, "haptic_benchmark");
+            strcpy(actionSetInfo.localizedActionSetName, "Haptic Benchmark");
+            XRC_CHECK_THROW_XRCMD(xrCreateActionSet(instance, &actionSetInfo, &actionSet));
+
+            const XrPath leftHaptic = StringToPath(instance, "/user/hand/left/output/haptic");
+            const XrPath rightHaptic = StringToPath(instance, "/user/hand/right/output/haptic");
+            for (uint32_t i = 0; i < kMaxHapticActionCount; ++i) {
+                XrActionCreateInfo actionInfo{XR_TYPE_ACTION_CREATE_INFO};
+                actionInfo.actionType = XR_ACTION_TYPE_VIBRATION_OUTPUT;
+                snprintf(actionInfo.actionName, sizeof(actionInfo.actionName), "haptic_%u", i);
+                snprintf(actionInfo.localizedActionName, sizeof(actionInfo.localizedActionName), "Haptic %u", i);
+                actionInfo.subactionPaths = subactionPaths.data();
+                actionInfo.countSubactionPaths = (uint32_t)subactionPaths.size();
+                XrAction action{XR_NULL_HANDLE};
+                XRC_CHECK_THROW_XRCMD(xrCreateAction(actionSet, &actionInfo, &action));
+                hapticActions.push_back(action);
+                bindings.push_back({action, leftHaptic});
+                bindings.push_back({action, rightHaptic});
+            }
+        }
+
+        XrInteractionProfileSuggestedBinding suggestedBindings{XR_TYPE_INTERACTION_PROFILE_SUGGESTED_BINDING};
+        suggestedBindings.interactionProfile = StringToPath(instance, "/interaction_profiles/khr/simple_controller");
+        suggestedBindings.suggestedBindings = bindings.data();
+        suggestedBindings.countSuggestedBindings = (uint32_t)bindings.size();
+        XRC_CHECK_THROW_XRCMD(xrSuggestInteractionProfileBindings(instance, &suggestedBindings));
+
+        XrSessionActionSetsAttachInfo attachInfo{XR_TYPE_SESSION_ACTION_SETS_ATTACH_INFO};
+        attachInfo.actionSets = &actionSet;
+        attachInfo.countActionSets = 1;
+        XRC_CHECK_THROW_XRCMD(xrAttachSessionActionSets(session, &attachInfo));
+
+        SimpleProjectionLayerHelper simpleProjectionLayerHelper(compositionHelper);
+        compositionHelper.BeginSession();
+
+        const std::array<XrActiveActionSet, 1> activeActionSets = {{{actionSet, XR_NULL_PATH}}};
+        XrActionsSyncInfo syncInfo{XR_TYPE_ACTIONS_SYNC_INFO};
+        syncInfo.activeActionSets = activeActionSets.data();
+        syncInfo.countActiveActionSets = (uint32_t)activeActionSets.size();
+
+        XrHapticVibration vibration{XR_TYPE_HAPTIC_VIBRATION};
+        vibration.amplitude = 0.5f;
+        vibration.duration = XR_MIN_HAPTIC_DURATION;
+        vibration.frequency = XR_FREQUENCY_UNSPECIFIED;
+
+        struct Load
+        {
+            uint32_t actionCount;
+            /// Applies per action per frame, every other one followed by a stop
+            uint32_t callsPerAction;
+        };
+        // The first load makes no calls, as the baseline for the frame timing.
+        const Load loads[] = {{1, 0}, {1, 1}, {1, 4}, {1, 16}, {8, 1}, {8, 4}, {8, 16}, {32, 1}, {32, 4}, {32, 16}};
+
+        uint32_t notFocusedCount = 0;
+        for (const Load& load : loads) {
+            CAPTURE(load.actionCount, load.callsPerAction);
+            std::vector<std::chrono::nanoseconds> applyLatencies;
+            std::vector<std::chrono::nanoseconds> stopLatencies;
+            std::vector<std::chrono::nanoseconds> frameHapticsTimes;
+            std::vector<std::chrono::nanoseconds> frameIntervals;
+            uint32_t missedFrameCount = 0;
+            XrDuration displayPeriod = 0;
+            clock::time_point lastWaitEnd{};
+            XrTime lastDisplayTime = 0;
+
+            for (uint32_t frame = 0; frame < kWarmupFrameCount + kMeasuredFrameCount; ++frame) {
+                compositionHelper.PollEvents();
+
+                XrFrameState frameState{XR_TYPE_FRAME_STATE};
+                XRC_CHECK_THROW_XRCMD(xrWaitFrame(session, nullptr, &frameState));
+                const clock::time_point waitEnd = clock::now();
+                XRC_CHECK_THROW_XRCMD(xrBeginFrame(session, nullptr));
+                XRC_CHECK_THROW_XRCMD(xrSyncActions(session, &syncInfo));
+
+                const bool measured = frame >= kWarmupFrameCount;
+                const clock::time_point hapticsStart = clock::now();
+                for (uint32_t call = 0; call < load.callsPerAction; ++call) {
+                    for (uint32_t a = 0; a < load.actionCount; ++a) {
+                        XrHapticActionInfo hapticInfo{XR_TYPE_HAPTIC_ACTION_INFO};
+                        hapticInfo.action = hapticActions[a];
+                        hapticInfo.subactionPath = callSubactionPaths[(call + a) % callSubactionPaths.size()];
+
+                        clock::time_point start = clock::now();
+                        const XrResult applyResult =
+                            xrApplyHapticFeedback(session, &hapticInfo, reinterpret_cast<const XrHapticBaseHeader*>(&vibration));
+                        if (measured) {
+                            applyLatencies.push_back(clock::now() - start);
+                        }
+                        XRC_CHECK_THROW_XRRESULT(applyResult, "xrApplyHapticFeedback");
+                        if (applyResult == XR_SESSION_NOT_FOCUSED) {
+                            notFocusedCount++;
+                        }
+
+                        if (call % 2 == 1) {
+                            start = clock::now();
+                            const XrResult stopResult = xrStopHapticFeedback(session, &hapticInfo);
+                            if (measured) {
+                                stopLatencies.push_back(clock::now() - start);
+                            }
+                            XRC_CHECK_THROW_XRRESULT(stopResult, "xrStopHapticFeedback");
+                        }
+                    }
+                }
+                const clock::time_point hapticsEnd = clock::now();
+
+                std::vector<XrCompositionLayerBaseHeader*> layers;
+                if (frameState.shouldRender) {
+                    if (XrCompositionLayerBaseHeader* projLayer = simpleProjectionLayerHelper.TryGetUpdatedProjectionLayer(frameState)) {
+                        layers.push_back(projLayer);
+                    }
+                }
+                compositionHelper.EndFrame(frameState.predictedDisplayTime, layers);
+
+                if (measured) {
+                    frameHapticsTimes.push_back(hapticsEnd - hapticsStart);
+                    frameIntervals.push_back(waitEnd - lastWaitEnd);
+                    if (frameState.predictedDisplayTime - lastDisplayTime > frameState.predictedDisplayPeriod * 3 / 2) {
+                        missedFrameCount++;
+                    }
+                }
+                lastWaitEnd = waitEnd;
+                lastDisplayTime = frameState.predictedDisplayTime;
+                displayPeriod = frameState.predictedDisplayPeriod;
+            }
+
+            const std::vector<MetricTag> tags{{"actions", std::to_string(load.actionCount)},
+                                              {"callsPerAction", std::to_string(load.callsPerAction)}};
+            if (!applyLatencies.empty()) {
+                const DurationPercentiles applyLatency = DurationPercentiles::FromSamples(std::move(applyLatencies));
+                ReportMetric("Haptics.applyLatency.p50", us(applyLatency.p50).count(), "us", tags);
+                ReportMetric("Haptics.applyLatency.p99", us(applyLatency.p99).count(), "us", tags);
+            }
+            if (!stopLatencies.empty()) {
+                const DurationPercentiles stopLatency = DurationPercentiles::FromSamples(std::move(stopLatencies));
+                ReportMetric("Haptics.stopLatency.p50", us(stopLatency.p50).count(), "us", tags);
+                ReportMetric("Haptics.stopLatency.p99", us(stopLatency.p99).count(), "us", tags);
+            }
+            const DurationPercentiles frameHapticsTime = DurationPercentiles::FromSamples(std::move(frameHapticsTimes));
+            const DurationPercentiles frameInterval = DurationPercentiles::FromSamples(std::move(frameIntervals));
+            ReportMetric("Haptics.frameHapticsTime.p50", ms(frameHapticsTime.p50).count(), "ms", tags);
+            ReportMetric("Haptics.frameHapticsTime.p99", ms(frameHapticsTime.p99).count(), "ms", tags);
+            if (displayPeriod > 0) {
+                // Above a few percent, the calls eat into the frame budget rather than being queued for another thread.
+                ReportMetric("Haptics.frameBudgetUsed", 100.0 * frameHapticsTime.p99.count() / displayPeriod, "%", tags);
+            }
+            ReportMetric("Haptics.frameInterval.p99", ms(frameInterval.p99).count(), "ms", tags);
+            ReportMetric("Haptics.missedFrames", missedFrameCount, "count", tags);
+        }
+
+        if (notFocusedCount != 0) {
+            WARN(notFocusedCount << " haptic calls returned XR_SESSION_NOT_FOCUSED, so measured the unfocused path");
+        }
+    }
 }  // namespace Conformance
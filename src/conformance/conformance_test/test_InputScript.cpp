@@ -0,0 +1,92 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "input_script.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace Conformance
+{
+    namespace
+    {
+        InputScriptStep Request(InputScriptStep::Kind kind, const char* topLevelPath, const char* inputPath = "")
+        {
+            InputScriptStep request;
+            request.kind = kind;
+            request.topLevelPath = topLevelPath;
+            request.inputPath = inputPath;
+            return request;
+        }
+    }  // namespace
+
+    TEST_CASE("InputScript", "[self_test]")
+    {
+        InputScript script;
+        std::string error;
+
+        SECTION("Steps are taken up to the one performing the request")
+        {
+            std::istringstream in("# operator turns on both hands\n"
+                                  "active /user/hand/left 1\n"
+                                  "\n"
+                                  "delay 100\n"
+                                  "active /user/hand/right 1\n"
+                                  "boolean /user/hand/left /user/hand/left/input/select/click 1\n"
+                                  "vector2 /user/hand/right /user/hand/right/input/thumbstick 0.5 -1\n");
+            REQUIRE(script.Parse(in, &error));
+            REQUIRE(script.GetRemainingCount() == 5);
+
+            std::vector<InputScriptStep> steps = script.TakeStepsUntil(Request(InputScriptStep::Kind::Active, "/user/hand/left"));
+            REQUIRE(steps.size() == 1);
+            CHECK(steps[0].line == 2);
+            CHECK(steps[0].value.x == 1.0f);
+
+            steps = script.TakeStepsUntil(Request(InputScriptStep::Kind::Active, "/user/hand/right"));
+            REQUIRE(steps.size() == 2);
+            CHECK(steps[0].kind == InputScriptStep::Kind::Delay);
+            CHECK(steps[0].delay.count() == 100);
+            CHECK(steps[1].topLevelPath == "/user/hand/right");
+
+            // Nothing performs this, so nothing is taken.
+            CHECK(script.TakeStepsUntil(Request(InputScriptStep::Kind::Float, "/user/hand/left", "/user/hand/left/input/trigger/value"))
+                      .empty());
+            CHECK(script.GetRemainingCount() == 2);
+
+            steps = script.TakeStepsUntil(
+                Request(InputScriptStep::Kind::Vector2, "/user/hand/right", "/user/hand/right/input/thumbstick"));
+            REQUIRE(steps.size() == 2);
+            CHECK(steps[0].kind == InputScriptStep::Kind::Boolean);
+            CHECK(steps[0].inputPath == "/user/hand/left/input/select/click");
+            CHECK(steps[1].value.x == 0.5f);
+            CHECK(steps[1].value.y == -1.0f);
+            CHECK(script.GetRemainingCount() == 0);
+        }
+
+        SECTION("Malformed lines are rejected")
+        {
+            for (const char* line : {"boolean /user/hand/left 1", "delay -5", "float /user/hand/left /user/hand/left/input/x 1 2", "press"}) {
+                std::istringstream in(line);
+                CHECK_FALSE(script.Parse(in, &error));
+                CHECK(error.find("line 1") != std::string::npos);
+                CHECK_FALSE(script.IsLoaded());
+            }
+        }
+    }
+}  // namespace Conformance
@@ -24,7 +24,9 @@
 #include <catch2/catch_test_macros.hpp>
 #include <openxr/openxr.h>
 
+#include <algorithm>
 #include <array>
+#include <vector>
 
 using namespace Conformance;
 
@@ -125,7 +127,7 @@ namespace Conformance
 
         // Create the instructional quad layer placed to the left.
         XrCompositionLayerQuad* const instructionsQuad =
-            compositionHelper.CreateQuadLayer(compositionHelper.CreateStaticSwapchainImage(CreateTextImage(1024, 768, instructions, 48)),
+            compositionHelper.CreateQuadLayer(compositionHelper.CreateStaticSwapchainText(1024, 768, instructions, 48),
                                               localSpace, 1, {{0, 0, 0, 1}, {-1.5f, 0, -0.3f}});
         instructionsQuad->pose.orientation = Quat::FromAxisAngle(Up, DegToRad(70));
 
@@ -153,7 +155,7 @@ namespace Conformance
             throwSpaces.push_back(std::move(handThrowSpaces));
         }
 
-        std::vector<BodyInMotion> thrownCubes;
+        BodiesInMotion thrownCubes;
 
         // Three fixed cubes which must be reached by the thrown cubes to pass the test.
         std::vector<XrVector3f> targetCubes{{-1, -1, -3.0f}, {1, -1, -4.0f}, {0, 1.0f, -5.0f}};
@@ -189,31 +191,18 @@ namespace Conformance
             }
 
             // Remove thrown cubes older than 3s.
-            for (auto it = thrownCubes.begin(); it != thrownCubes.end();) {
-                const XrDuration age = frameState.predictedDisplayTime - it->createTime;
-                if (age > XrDuration(3.0e9)) {
-                    it = thrownCubes.erase(it);
-                }
-                else
-                    ++it;
-            }
-
-            for (BodyInMotion& thrownCube : thrownCubes) {
-                thrownCube.doSimulationStep({0.f, -9.8f, 0.f}, frameState.predictedDisplayTime);
-                cubes.push_back({thrownCube.pose, activateCubeScale});
+            thrownCubes.RemoveOlderThan(frameState.predictedDisplayTime, XrDuration(3.0e9));
 
-                // Remove any target cubes which are hit by the thrown cube.
-                for (auto it = targetCubes.begin(); it != targetCubes.end();) {
-                    XrVector3f delta = *it - thrownCube.pose.position;
-                    if (Vector::Length(delta) < targetCubeHitThreshold) {
-                        it = targetCubes.erase(it);
-                    }
-                    else {
-                        it++;
-                    }
-                }
+            thrownCubes.doSimulationStep({0.f, -9.8f, 0.f}, frameState.predictedDisplayTime);
+            cubes.reserve(thrownCubes.Size() + targetCubes.size());
+            for (size_t i = 0; i < thrownCubes.Size(); ++i) {
+                cubes.push_back({thrownCubes.GetPose(i), activateCubeScale});
             }
 
+            // Remove any target cubes which are hit by a thrown cube.
+            auto isHit = [&](const XrVector3f& target) { return thrownCubes.AnyWithin(target, targetCubeHitThreshold); };
+            targetCubes.erase(std::remove_if(targetCubes.begin(), targetCubes.end(), isHit), targetCubes.end());
+
             // Once all the targets have been hit and removed, the test is a pass.
             if (targetCubes.empty()) {
                 return false;
@@ -263,8 +252,7 @@ namespace Conformance
                                     releaseSpaceLocation.locationFlags & XR_SPACE_LOCATION_ORIENTATION_VALID_BIT &&
                                     releaseSpaceVelocity.velocityFlags & XR_SPACE_VELOCITY_ANGULAR_VALID_BIT &&
                                     releaseSpaceVelocity.velocityFlags & XR_SPACE_VELOCITY_LINEAR_VALID_BIT) {
-                                    thrownCubes.emplace_back(BodyInMotion{releaseSpaceVelocity, releaseSpaceLocation.pose,
-                                                                          boolState.lastChangeTime, boolState.lastChangeTime});
+                                    thrownCubes.Add(releaseSpaceVelocity, releaseSpaceLocation.pose, boolState.lastChangeTime);
                                 }
                             }
                         }
@@ -281,15 +269,16 @@ namespace Conformance
                 const auto& views = std::get<std::vector<XrView>>(viewData);
 
                 // Render into each of the separate swapchains using the projection layer view fov and pose.
-                for (size_t view = 0; view < views.size(); view++) {
-                    compositionHelper.AcquireWaitReleaseImage(swapchains[view], [&](const XrSwapchainImageBaseHeader* swapchainImage) {
-                        GetGlobalData().graphicsPlugin->ClearImageSlice(swapchainImage);
-                        const_cast<XrFovf&>(projLayer->views[view].fov) = views[view].fov;
-                        const_cast<XrPosef&>(projLayer->views[view].pose) = views[view].pose;
-                        GetGlobalData().graphicsPlugin->RenderView(projLayer->views[view], swapchainImage,
-                                                                   RenderParams().Draw(cubes).Draw(meshes));
+                compositionHelper.AcquireWaitReleaseImages(
+                    swapchains, [&](const std::vector<const XrSwapchainImageBaseHeader*>& swapchainImages) {
+                        for (size_t view = 0; view < views.size(); view++) {
+                            GetGlobalData().graphicsPlugin->ClearImageSlice(swapchainImages[view]);
+                            const_cast<XrFovf&>(projLayer->views[view].fov) = views[view].fov;
+                            const_cast<XrPosef&>(projLayer->views[view].pose) = views[view].pose;
+                        }
+                        GetGlobalData().graphicsPlugin->RenderViews({projLayer->views, projLayer->viewCount}, swapchainImages,
+                                                                    RenderParams().Draw(cubes).Draw(meshes));
                     });
-                }
 
                 layers.push_back({reinterpret_cast<XrCompositionLayerBaseHeader*>(projLayer)});
             }
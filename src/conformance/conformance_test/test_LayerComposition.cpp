@@ -14,9 +14,17 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "asset_prefetch.h"
 #include "common/xr_linear.h"
 #include "composition_utils.h"
 #include "conformance_framework.h"
+#include "conformance_utils.h"
+#include "frame_allocation_tracker.h"
+#include "gltf_helpers.h"
+#include "report.h"
+#include "two_call.h"
+#include "utilities/Geometry.h"
+#include "utilities/swapchain_parameters.h"
 #include "utilities/throw_helpers.h"
 #include "utilities/types_and_constants.h"
 #include "utilities/xrduration_literals.h"
@@ -26,7 +34,14 @@
 
 #include <algorithm>
 #include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
 #include <numeric>
+#include <string>
+#include <vector>
 
 using namespace Conformance;
 
@@ -433,8 +448,10 @@ namespace Conformance
                     for (size_t view = 0; view < views.size(); view++) {
                         const_cast<XrFovf&>(projLayer->views[view].fov) = views[view].fov;
                         const_cast<XrPosef&>(projLayer->views[view].pose) = views[view].pose;
-                        GetGlobalData().graphicsPlugin->RenderView(projLayer->views[view], swapchainImage, RenderParams().Draw(cubes));
                     }
+                    const std::vector<const XrSwapchainImageBaseHeader*> swapchainImages(projLayer->viewCount, swapchainImage);
+                    GetGlobalData().graphicsPlugin->RenderViews({projLayer->views, projLayer->viewCount}, swapchainImages,
+                                                                RenderParams().Draw(cubes));
                 });
 
                 layers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader*>(projLayer));
@@ -542,11 +559,11 @@ namespace Conformance
 
         // Create 10x10cm L and R quads
         XrCompositionLayerQuad* const leftQuadLayer =
-            compositionHelper.CreateQuadLayer(compositionHelper.CreateStaticSwapchainImage(CreateTextImage(64, 64, "L", 48)), gripSpaces[0],
+            compositionHelper.CreateQuadLayer(compositionHelper.CreateStaticSwapchainText(64, 64, "L", 48), gripSpaces[0],
                                               0.1f, {Quat::Identity, {0, 0, 0.1f}});
 
         XrCompositionLayerQuad* const rightQuadLayer =
-            compositionHelper.CreateQuadLayer(compositionHelper.CreateStaticSwapchainImage(CreateTextImage(64, 64, "R", 48)), gripSpaces[1],
+            compositionHelper.CreateQuadLayer(compositionHelper.CreateStaticSwapchainText(64, 64, "R", 48), gripSpaces[1],
                                               0.1f, {Quat::Identity, {0, 0, 0.1f}});
 
         interactiveLayerManager.AddLayer(leftQuadLayer);
@@ -849,4 +866,933 @@ namespace Conformance
         RenderLoop(session, updateLayers).Loop();
     }
 
+    // Not a conformance requirement: submits from 1 up to XrSystemGraphicsProperties::maxLayerCount layers of each layer type
+    // the runtime supports through CompositionHelper::EndFrame, doubling the count at each step. Records the xrEndFrame CPU
+    // time and xrWaitFrame pacing of each step in the CTS XML report, along with any XR_META_performance_metrics counters, to
+    // give a cost curve per layer type.
+    TEST_CASE("LayerComposition_Scaling_Benchmark", "[.][benchmark]")
+    {
+        using ms = std::chrono::duration<double, std::milli>;
+        using Clock = std::chrono::steady_clock;
+
+        GlobalData& globalData = GetGlobalData();
+        if (!globalData.IsUsingGraphicsPlugin()) {
+            SKIP("Cannot benchmark layer composition without a graphics plugin");
+        }
+
+        struct LayerType
+        {
+            const char* name;
+            XrStructureType type;
+            /// Extension the layer type needs, or nullptr for core layer types.
+            const char* extension;
+        };
+        const LayerType allLayerTypes[] = {
+            {"quad", XR_TYPE_COMPOSITION_LAYER_QUAD, nullptr},
+            {"cylinder", XR_TYPE_COMPOSITION_LAYER_CYLINDER_KHR, XR_KHR_COMPOSITION_LAYER_CYLINDER_EXTENSION_NAME},
+            {"equirect", XR_TYPE_COMPOSITION_LAYER_EQUIRECT_KHR, XR_KHR_COMPOSITION_LAYER_EQUIRECT_EXTENSION_NAME},
+            {"equirect2", XR_TYPE_COMPOSITION_LAYER_EQUIRECT2_KHR, XR_KHR_COMPOSITION_LAYER_EQUIRECT2_EXTENSION_NAME},
+            {"cube", XR_TYPE_COMPOSITION_LAYER_CUBE_KHR, XR_KHR_COMPOSITION_LAYER_CUBE_EXTENSION_NAME},
+        };
+        std::vector<LayerType> layerTypes;
+        std::vector<const char*> extensions;
+        bool haveCubeLayers = false;
+        for (const LayerType& layerType : allLayerTypes) {
+            if (layerType.extension != nullptr) {
+                if (!globalData.IsInstanceExtensionSupported(layerType.extension)) {
+                    continue;
+                }
+                extensions.push_back(layerType.extension);
+            }
+            layerTypes.push_back(layerType);
+            haveCubeLayers = haveCubeLayers || layerType.type == XR_TYPE_COMPOSITION_LAYER_CUBE_KHR;
+        }
+        const bool usePerformanceMetrics = globalData.IsInstanceExtensionSupported(XR_META_PERFORMANCE_METRICS_EXTENSION_NAME);
+        if (usePerformanceMetrics) {
+            extensions.push_back(XR_META_PERFORMANCE_METRICS_EXTENSION_NAME);
+        }
+
+        CompositionHelper compositionHelper("Layer Scaling Benchmark", extensions);
+        const XrInstance instance = compositionHelper.GetInstance();
+        const XrSession session = compositionHelper.GetSession();
+
+        XrSystemProperties systemProperties{XR_TYPE_SYSTEM_PROPERTIES};
+        XRC_CHECK_THROW_XRCMD(xrGetSystemProperties(instance, compositionHelper.GetSystemId(), &systemProperties));
+        // EndFrame adds the title quad to every frame.
+        const uint32_t maxLayerCount = systemProperties.graphicsProperties.maxLayerCount - 1;
+        REQUIRE(systemProperties.graphicsProperties.maxLayerCount >= XR_MIN_COMPOSITION_LAYERS_SUPPORTED);
+
+        std::vector<XrPath> counterPaths;
+        PFN_xrQueryPerformanceMetricsCounterMETA xrQueryPerformanceMetricsCounterMETA_ = nullptr;
+        if (usePerformanceMetrics) {
+            auto xrEnumeratePerformanceMetricsCounterPathsMETA_ =
+                GetInstanceExtensionFunction<PFN_xrEnumeratePerformanceMetricsCounterPathsMETA>(
+                    instance, "xrEnumeratePerformanceMetricsCounterPathsMETA");
+            auto xrSetPerformanceMetricsStateMETA_ =
+                GetInstanceExtensionFunction<PFN_xrSetPerformanceMetricsStateMETA>(instance, "xrSetPerformanceMetricsStateMETA");
+            xrQueryPerformanceMetricsCounterMETA_ =
+                GetInstanceExtensionFunction<PFN_xrQueryPerformanceMetricsCounterMETA>(instance, "xrQueryPerformanceMetricsCounterMETA");
+
+            counterPaths = CHECK_TWO_CALL(XrPath, {}, xrEnumeratePerformanceMetricsCounterPathsMETA_, instance);
+            XrPerformanceMetricsStateMETA perfMetricsState{XR_TYPE_PERFORMANCE_METRICS_STATE_META};
+            perfMetricsState.enabled = XR_TRUE;
+            XRC_CHECK_THROW_XRCMD(xrSetPerformanceMetricsStateMETA_(session, &perfMetricsState));
+        }
+
+        compositionHelper.GetInteractionManager().AttachActionSets();
+        compositionHelper.BeginSession();
+
+        const XrSpace localSpace = compositionHelper.CreateReferenceSpace(XR_REFERENCE_SPACE_TYPE_LOCAL);
+        const XrSwapchainSubImage subImage =
+            compositionHelper.MakeDefaultSubImage(compositionHelper.CreateStaticSwapchainSolidColor(Colors::Blue));
+        XrSwapchain cubeSwapchain = XR_NULL_HANDLE;
+        if (haveCubeLayers) {
+            XrSwapchainCreateInfo cubeCreateInfo = compositionHelper.DefaultColorSwapchainCreateInfo(
+                256, 256, XR_SWAPCHAIN_CREATE_STATIC_IMAGE_BIT, globalData.graphicsPlugin->GetSRGBA8Format());
+            cubeCreateInfo.faceCount = 6;
+            cubeSwapchain = compositionHelper.CreateSwapchain(cubeCreateInfo);
+            // What the faces hold does not change the cost of compositing them, so leave them as they are.
+            compositionHelper.AcquireWaitReleaseImage(cubeSwapchain, [](const XrSwapchainImageBaseHeader*) {});
+        }
+
+        // Spread the layers over a grid in front of the user, so that each of them has to be composited.
+        const auto layerPose = [](uint32_t index) {
+            constexpr uint32_t columns = 8;
+            const float x = (static_cast<float>(index % columns) - (columns - 1) / 2.0f) * 0.2f;
+            const float y = (static_cast<float>((index / columns) % columns) - (columns - 1) / 2.0f) * 0.2f;
+            const float z = -2.0f - 0.1f * static_cast<float>(index / (columns * columns));
+            return XrPosef{Quat::Identity, {x, y, z}};
+        };
+
+        std::vector<XrCompositionLayerQuad> quads(maxLayerCount, {XR_TYPE_COMPOSITION_LAYER_QUAD});
+        std::vector<XrCompositionLayerCylinderKHR> cylinders(maxLayerCount, {XR_TYPE_COMPOSITION_LAYER_CYLINDER_KHR});
+        std::vector<XrCompositionLayerEquirectKHR> equirects(maxLayerCount, {XR_TYPE_COMPOSITION_LAYER_EQUIRECT_KHR});
+        std::vector<XrCompositionLayerEquirect2KHR> equirect2s(maxLayerCount, {XR_TYPE_COMPOSITION_LAYER_EQUIRECT2_KHR});
+        std::vector<XrCompositionLayerCubeKHR> cubes(maxLayerCount, {XR_TYPE_COMPOSITION_LAYER_CUBE_KHR});
+        const auto makeLayers = [&](XrStructureType type) {
+            std::vector<XrCompositionLayerBaseHeader*> layers;
+            for (uint32_t i = 0; i < maxLayerCount; ++i) {
+                switch (type) {
+                case XR_TYPE_COMPOSITION_LAYER_QUAD:
+                    quads[i].space = localSpace;
+                    quads[i].eyeVisibility = XR_EYE_VISIBILITY_BOTH;
+                    quads[i].subImage = subImage;
+                    quads[i].pose = layerPose(i);
+                    quads[i].size = {0.15f, 0.15f};
+                    layers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader*>(&quads[i]));
+                    break;
+                case XR_TYPE_COMPOSITION_LAYER_CYLINDER_KHR:
+                    cylinders[i].space = localSpace;
+                    cylinders[i].eyeVisibility = XR_EYE_VISIBILITY_BOTH;
+                    cylinders[i].subImage = subImage;
+                    cylinders[i].pose = layerPose(i);
+                    cylinders[i].radius = 1.0f;
+                    cylinders[i].centralAngle = 0.15f;
+                    cylinders[i].aspectRatio = 1.0f;
+                    layers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader*>(&cylinders[i]));
+                    break;
+                case XR_TYPE_COMPOSITION_LAYER_EQUIRECT_KHR:
+                    equirects[i].space = localSpace;
+                    equirects[i].eyeVisibility = XR_EYE_VISIBILITY_BOTH;
+                    equirects[i].subImage = subImage;
+                    equirects[i].pose = layerPose(i);
+                    equirects[i].radius = 1.0f;
+                    // Map the image to a twentieth of the sphere each way, like the other layer types.
+                    equirects[i].scale = {20.0f, 20.0f};
+                    equirects[i].bias = {0.0f, 0.0f};
+                    layers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader*>(&equirects[i]));
+                    break;
+                case XR_TYPE_COMPOSITION_LAYER_EQUIRECT2_KHR:
+                    equirect2s[i].space = localSpace;
+                    equirect2s[i].eyeVisibility = XR_EYE_VISIBILITY_BOTH;
+                    equirect2s[i].subImage = subImage;
+                    equirect2s[i].pose = layerPose(i);
+                    equirect2s[i].radius = 1.0f;
+                    equirect2s[i].centralHorizontalAngle = 0.15f;
+                    equirect2s[i].upperVerticalAngle = 0.075f;
+                    equirect2s[i].lowerVerticalAngle = -0.075f;
+                    layers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader*>(&equirect2s[i]));
+                    break;
+                case XR_TYPE_COMPOSITION_LAYER_CUBE_KHR:
+                    cubes[i].space = localSpace;
+                    cubes[i].eyeVisibility = XR_EYE_VISIBILITY_BOTH;
+                    cubes[i].swapchain = cubeSwapchain;
+                    cubes[i].imageArrayIndex = 0;
+                    cubes[i].orientation = Quat::Identity;
+                    // Each cube layer covers the whole view: blend them so that the ones below are not simply hidden.
+                    cubes[i].layerFlags = XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT;
+                    layers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader*>(&cubes[i]));
+                    break;
+                default:
+                    break;
+                }
+            }
+            return layers;
+        };
+
+        constexpr int warmupFrameCount = 30;  // Let the compositor settle at each new layer count.
+        constexpr int testFrameCount = 120;
+        const std::vector<XrCompositionLayerBaseHeader*> noLayers;
+
+        for (const LayerType& layerType : layerTypes) {
+            const std::vector<XrCompositionLayerBaseHeader*> allLayers = makeLayers(layerType.type);
+            for (uint32_t layerCount = 1;; layerCount = std::min(layerCount * 2, maxLayerCount)) {
+                const std::vector<XrCompositionLayerBaseHeader*> layers(allLayers.begin(), allLayers.begin() + layerCount);
+
+                std::vector<std::chrono::nanoseconds> endFrameTimes;
+                std::vector<std::chrono::nanoseconds> waitFrameTimes;
+                std::vector<std::chrono::nanoseconds> frameTimes;
+                uint32_t missedFrameCount = 0;
+                Clock::time_point lastWaitEnd;
+                XrTime lastDisplayTime = 0;
+                for (int frame = 0; frame < warmupFrameCount + testFrameCount; ++frame) {
+                    compositionHelper.PollEvents();
+
+                    XrFrameState frameState{XR_TYPE_FRAME_STATE};
+                    const Clock::time_point waitStart = Clock::now();
+                    XRC_CHECK_THROW_XRCMD(xrWaitFrame(session, nullptr, &frameState));
+                    const Clock::time_point waitEnd = Clock::now();
+                    XRC_CHECK_THROW_XRCMD(xrBeginFrame(session, nullptr));
+
+                    const Clock::time_point endStart = Clock::now();
+                    compositionHelper.EndFrame(frameState.predictedDisplayTime, frameState.shouldRender ? layers : noLayers);
+                    const Clock::time_point endEnd = Clock::now();
+
+                    if (frame >= warmupFrameCount) {
+                        waitFrameTimes.push_back(waitEnd - waitStart);
+                        frameTimes.push_back(waitEnd - lastWaitEnd);
+                        if (frameState.shouldRender) {
+                            endFrameTimes.push_back(endEnd - endStart);
+                        }
+                        if (frameState.predictedDisplayTime - lastDisplayTime > frameState.predictedDisplayPeriod * 3 / 2) {
+                            missedFrameCount++;
+                        }
+                    }
+                    lastWaitEnd = waitEnd;
+                    lastDisplayTime = frameState.predictedDisplayTime;
+                }
+
+                const DurationPercentiles endFrame = DurationPercentiles::FromSamples(std::move(endFrameTimes));
+                const DurationPercentiles waitFrame = DurationPercentiles::FromSamples(std::move(waitFrameTimes));
+                const DurationPercentiles frameTime = DurationPercentiles::FromSamples(std::move(frameTimes));
+                ReportConsoleOnlyF("%u %s layer(s): xrEndFrame p50/p99 %.3f / %.3fms, xrWaitFrame p50 %.3fms, frame time p50/p99 "
+                                   "%.3f / %.3fms, %u missed frame(s)",
+                                   layerCount, layerType.name, ms(endFrame.p50).count(), ms(endFrame.p99).count(),
+                                   ms(waitFrame.p50).count(), ms(frameTime.p50).count(), ms(frameTime.p99).count(), missedFrameCount);
+
+                const std::vector<MetricTag> tags{{"layerType", layerType.name}, {"layerCount", std::to_string(layerCount)}};
+                ReportMetric("layerScaling.endFrameTime", ms(endFrame.mean).count(), "ms", tags);
+                ReportMetric("layerScaling.endFrameTimeP99", ms(endFrame.p99).count(), "ms", tags);
+                ReportMetric("layerScaling.waitFrameTime", ms(waitFrame.mean).count(), "ms", tags);
+                ReportMetric("layerScaling.frameTime", ms(frameTime.mean).count(), "ms", tags);
+                ReportMetric("layerScaling.frameTimeP99", ms(frameTime.p99).count(), "ms", tags);
+                ReportMetric("layerScaling.missedFrames", missedFrameCount, "count", tags);
+
+                // The counters describe the latest frames, which all had this many layers.
+                for (XrPath path : counterPaths) {
+                    XrPerformanceMetricsCounterMETA counter{XR_TYPE_PERFORMANCE_METRICS_COUNTER_META};
+                    if (XR_FAILED(xrQueryPerformanceMetricsCounterMETA_(session, path, &counter)) ||
+                        (counter.counterFlags & XR_PERFORMANCE_METRICS_COUNTER_ANY_VALUE_VALID_BIT_META) == 0) {
+                        continue;
+                    }
+                    const double value = (counter.counterFlags & XR_PERFORMANCE_METRICS_COUNTER_FLOAT_VALUE_VALID_BIT_META) != 0
+                                             ? static_cast<double>(counter.floatValue)
+                                             : static_cast<double>(counter.uintValue);
+                    std::vector<MetricTag> counterTags = tags;
+                    counterTags.push_back({"source", XR_META_PERFORMANCE_METRICS_EXTENSION_NAME});
+                    ReportMetric(PathToString(instance, path), value, PerformanceMetricsCounterUnitName(counter.counterUnit), counterTags);
+                }
+
+                if (layerCount == maxLayerCount) {
+                    break;
+                }
+            }
+        }
+
+        compositionHelper.ReportLockWaitMetrics();
+    }
+
+    static const AssetPrefetchRegistration g_stereoArrangementAssets("Projection_StereoArrangement_Benchmark", {},
+                                                                     {"MetalRoughSpheres.glb"});
+
+    namespace
+    {
+        /// The glTF scene the projection layer benchmarks render: a block of models in front of the viewer, seen by every view.
+        std::vector<GLTFDrawable> MakeProjectionBenchmarkScene(IGraphicsPlugin& graphicsPlugin)
+        {
+            const GLTFModelHandle model = graphicsPlugin.LoadGLTF(LoadGLTFFile("MetalRoughSpheres.glb"));
+            std::vector<GLTFDrawable> drawables;
+            for (int i = 0; i < 16; ++i) {
+                const float x = static_cast<float>(i % 4) * 0.2f - 0.3f;
+                const float y = static_cast<float>(i / 4) * 0.2f - 0.3f;
+                drawables.emplace_back(graphicsPlugin.CreateGLTFModelInstance(model), XrPosef{Quat::Identity, {x, y, -1.5f}},
+                                       XrVector3f{0.1f, 0.1f, 0.1f});
+            }
+            return drawables;
+        }
+
+        /// Timings of the frames measured by MeasureProjectionFrames.
+        struct ProjectionFrameTimes
+        {
+            /// CPU time of the render callback
+            DurationPercentiles renderCpu;
+            /// GPU time of the render callback, if the graphics plugin supports GPU timers
+            DurationPercentiles gpu;
+            DurationPercentiles endFrame;
+            /// Time between the ends of consecutive xrWaitFrame calls
+            DurationPercentiles frame;
+            uint32_t missedFrameCount{0};
+        };
+
+        /// Submit @p projLayer, whose views are located in @p space, for some warm-up frames and then the measured ones. Each
+        /// frame sets the views' fov and pose, and calls @p render in a GPU timer scope to render them.
+        ProjectionFrameTimes MeasureProjectionFrames(CompositionHelper& compositionHelper, XrSpace space,
+                                                     XrCompositionLayerProjection* projLayer, FunctionRef<void()> render)
+        {
+            using Clock = std::chrono::steady_clock;
+            constexpr const char* ProjectionGpuTimerScope = "ProjectionBenchmark";
+            constexpr int warmupFrameCount = 30;
+            constexpr int testFrameCount = 300;
+
+            IGraphicsPlugin& graphicsPlugin = *GetGlobalData().graphicsPlugin;
+            const XrSession session = compositionHelper.GetSession();
+            auto* const projViews = const_cast<XrCompositionLayerProjectionView*>(projLayer->views);
+
+            std::vector<std::chrono::nanoseconds> renderTimes;
+            std::vector<std::chrono::nanoseconds> gpuTimes;
+            std::vector<std::chrono::nanoseconds> endFrameTimes;
+            std::vector<std::chrono::nanoseconds> frameTimes;
+            std::vector<GpuTimerSample> gpuTimerSamples;
+            uint32_t missedFrameCount = 0;
+            LocatedViews locatedViews;
+            std::vector<XrCompositionLayerBaseHeader*> layers;
+            Clock::time_point lastWaitEnd;
+            XrTime lastDisplayTime = 0;
+            for (int frame = 0; frame < warmupFrameCount + testFrameCount; ++frame) {
+                compositionHelper.PollEvents();
+
+                XrFrameState frameState{XR_TYPE_FRAME_STATE};
+                XRC_CHECK_THROW_XRCMD(xrWaitFrame(session, nullptr, &frameState));
+                const Clock::time_point waitEnd = Clock::now();
+                XRC_CHECK_THROW_XRCMD(xrBeginFrame(session, nullptr));
+
+                const bool measured = frame >= warmupFrameCount;
+                layers.clear();
+                if (frameState.shouldRender) {
+                    compositionHelper.LocateViews(space, frameState.predictedDisplayTime, locatedViews);
+                    const XrViewStateFlags viewStateFlags = locatedViews.viewState.viewStateFlags;
+                    if ((viewStateFlags & XR_VIEW_STATE_POSITION_VALID_BIT) != 0 &&
+                        (viewStateFlags & XR_VIEW_STATE_ORIENTATION_VALID_BIT) != 0) {
+                        for (uint32_t i = 0; i < projLayer->viewCount; ++i) {
+                            projViews[i].fov = locatedViews.views[i].fov;
+                            projViews[i].pose = locatedViews.views[i].pose;
+                        }
+
+                        const Clock::time_point renderStart = Clock::now();
+                        graphicsPlugin.BeginGpuTimerScope(ProjectionGpuTimerScope);
+                        render();
+                        graphicsPlugin.EndGpuTimerScope();
+                        if (measured) {
+                            renderTimes.push_back(Clock::now() - renderStart);
+                        }
+                        layers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader*>(projLayer));
+                    }
+                }
+
+                const Clock::time_point endStart = Clock::now();
+                compositionHelper.EndFrame(frameState.predictedDisplayTime, layers);
+                const Clock::time_point endEnd = Clock::now();
+
+                gpuTimerSamples.clear();
+                graphicsPlugin.CollectGpuTimerSamples(gpuTimerSamples);
+                if (measured) {
+                    for (const GpuTimerSample& sample : gpuTimerSamples) {
+                        if (std::strcmp(sample.name, ProjectionGpuTimerScope) == 0) {
+                            gpuTimes.push_back(sample.duration);
+                        }
+                    }
+                    if (!layers.empty()) {
+                        endFrameTimes.push_back(endEnd - endStart);
+                    }
+                    frameTimes.push_back(waitEnd - lastWaitEnd);
+                    if (frameState.predictedDisplayTime - lastDisplayTime > frameState.predictedDisplayPeriod * 3 / 2) {
+                        missedFrameCount++;
+                    }
+                }
+                lastWaitEnd = waitEnd;
+                lastDisplayTime = frameState.predictedDisplayTime;
+            }
+
+            ProjectionFrameTimes times;
+            times.renderCpu = DurationPercentiles::FromSamples(std::move(renderTimes));
+            times.gpu = DurationPercentiles::FromSamples(std::move(gpuTimes));
+            times.endFrame = DurationPercentiles::FromSamples(std::move(endFrameTimes));
+            times.frame = DurationPercentiles::FromSamples(std::move(frameTimes));
+            times.missedFrameCount = missedFrameCount;
+            return times;
+        }
+
+        /// Report @p times as `<prefix>.renderCpuTime` and similar metrics tagged with @p tags, and summarize them on the console.
+        void ReportProjectionFrameTimes(const char* prefix, const std::vector<MetricTag>& tags, const ProjectionFrameTimes& times)
+        {
+            using ms = std::chrono::duration<double, std::milli>;
+
+            std::string tagString;
+            for (const MetricTag& tag : tags) {
+                tagString += (tagString.empty() ? "" : ", ") + tag.name + "=" + tag.value;
+            }
+            ReportConsoleOnlyF("%s: render CPU p50/p99 %.3f / %.3fms, GPU p50/p99 %.3f / %.3fms, xrEndFrame p50 %.3fms, "
+                               "frame time p50/p99 %.3f / %.3fms, %u missed frame(s)",
+                               tagString.c_str(), ms(times.renderCpu.p50).count(), ms(times.renderCpu.p99).count(),
+                               ms(times.gpu.p50).count(), ms(times.gpu.p99).count(), ms(times.endFrame.p50).count(),
+                               ms(times.frame.p50).count(), ms(times.frame.p99).count(), times.missedFrameCount);
+
+            const std::string name(prefix);
+            ReportMetric(name + ".renderCpuTime", ms(times.renderCpu.p50).count(), "ms", tags);
+            ReportMetric(name + ".renderCpuTimeP99", ms(times.renderCpu.p99).count(), "ms", tags);
+            if (GetGlobalData().graphicsPlugin->SupportsGpuTimers()) {
+                ReportMetric(name + ".gpuTime", ms(times.gpu.p50).count(), "ms", tags);
+                ReportMetric(name + ".gpuTimeP99", ms(times.gpu.p99).count(), "ms", tags);
+            }
+            ReportMetric(name + ".endFrameTime", ms(times.endFrame.p50).count(), "ms", tags);
+            ReportMetric(name + ".frameTime", ms(times.frame.p50).count(), "ms", tags);
+            ReportMetric(name + ".frameTimeP99", ms(times.frame.p99).count(), "ms", tags);
+            ReportMetric(name + ".missedFrames", times.missedFrameCount, "count", tags);
+        }
+
+        /// How a stereo (or other multi-view) projection layer is laid out in swapchains.
+        enum class StereoArrangement
+        {
+            /// One swapchain with a slice per view
+            TextureArray,
+            /// One swapchain with the views side by side
+            DoubleWide,
+            /// One swapchain per view
+            PerView,
+        };
+
+        const char* StereoArrangementName(StereoArrangement arrangement)
+        {
+            switch (arrangement) {
+            case StereoArrangement::TextureArray:
+                return "textureArray";
+            case StereoArrangement::DoubleWide:
+                return "doubleWide";
+            case StereoArrangement::PerView:
+                return "perView";
+            }
+            return "unknown";
+        }
+
+        void RunStereoArrangementBenchmark(StereoArrangement arrangement)
+        {
+            IGraphicsPlugin& graphicsPlugin = *GetGlobalData().graphicsPlugin;
+            const char* const arrangementName = StereoArrangementName(arrangement);
+
+            CompositionHelper compositionHelper(("Stereo Arrangement: " + std::string(arrangementName)).c_str());
+            compositionHelper.GetInteractionManager().AttachActionSets();
+            compositionHelper.BeginSession();
+
+            const XrSpace localSpace = compositionHelper.CreateReferenceSpace(XR_REFERENCE_SPACE_TYPE_LOCAL);
+            const std::vector<XrViewConfigurationView> viewProperties = compositionHelper.EnumerateConfigurationViews();
+            uint32_t totalWidth = 0;
+            uint32_t maxWidth = 0;
+            uint32_t maxHeight = 0;
+            for (const XrViewConfigurationView& view : viewProperties) {
+                totalWidth += view.recommendedImageRectWidth;
+                maxWidth = std::max(maxWidth, view.recommendedImageRectWidth);
+                maxHeight = std::max(maxHeight, view.recommendedImageRectHeight);
+            }
+
+            XrCompositionLayerProjection* const projLayer = compositionHelper.CreateProjectionLayer(localSpace);
+            auto* const projViews = const_cast<XrCompositionLayerProjectionView*>(projLayer->views);
+            std::vector<XrSwapchain> swapchains;
+            switch (arrangement) {
+            case StereoArrangement::TextureArray: {
+                XrSwapchainCreateInfo createInfo = compositionHelper.DefaultColorSwapchainCreateInfo(maxWidth, maxHeight);
+                createInfo.arraySize = projLayer->viewCount;
+                swapchains.push_back(compositionHelper.CreateSwapchain(createInfo));
+                for (uint32_t i = 0; i < projLayer->viewCount; ++i) {
+                    projViews[i].subImage = compositionHelper.MakeDefaultSubImage(swapchains[0], i);
+                    projViews[i].subImage.imageRect.extent = {(int32_t)viewProperties[i].recommendedImageRectWidth,
+                                                              (int32_t)viewProperties[i].recommendedImageRectHeight};
+                }
+                break;
+            }
+            case StereoArrangement::DoubleWide: {
+                swapchains.push_back(
+                    compositionHelper.CreateSwapchain(compositionHelper.DefaultColorSwapchainCreateInfo(totalWidth, maxHeight)));
+                int32_t x = 0;
+                for (uint32_t i = 0; i < projLayer->viewCount; ++i) {
+                    projViews[i].subImage = compositionHelper.MakeDefaultSubImage(swapchains[0]);
+                    projViews[i].subImage.imageRect = {{x, 0},
+                                                       {(int32_t)viewProperties[i].recommendedImageRectWidth,
+                                                        (int32_t)viewProperties[i].recommendedImageRectHeight}};
+                    x += projViews[i].subImage.imageRect.extent.width;
+                }
+                break;
+            }
+            case StereoArrangement::PerView:
+                for (uint32_t i = 0; i < projLayer->viewCount; ++i) {
+                    swapchains.push_back(compositionHelper.CreateSwapchain(compositionHelper.DefaultColorSwapchainCreateInfo(
+                        viewProperties[i].recommendedImageRectWidth, viewProperties[i].recommendedImageRectHeight)));
+                    projViews[i].subImage = compositionHelper.MakeDefaultSubImage(swapchains[i]);
+                }
+                break;
+            }
+
+            const std::vector<GLTFDrawable> drawables = MakeProjectionBenchmarkScene(graphicsPlugin);
+            const RenderParams renderParams = RenderParams{}.Draw(drawables);
+
+            // Heap allocations here are the CTS's own, made every frame: worth knowing when comparing arrangements.
+            FrameAllocationTracker renderAllocations("stereoArrangement.renderViews");
+            const auto renderViews = [&](const std::vector<const XrSwapchainImageBaseHeader*>& swapchainImages) {
+                FrameAllocationTracker::Scope allocationScope(renderAllocations);
+                graphicsPlugin.RenderViews({projViews, projLayer->viewCount}, swapchainImages, renderParams);
+            };
+            std::vector<const XrSwapchainImageBaseHeader*> viewImages(projLayer->viewCount);
+            const auto render = [&]() {
+                switch (arrangement) {
+                case StereoArrangement::TextureArray:
+                    compositionHelper.AcquireWaitReleaseImage(swapchains[0], [&](const XrSwapchainImageBaseHeader* swapchainImage) {
+                        for (uint32_t i = 0; i < projLayer->viewCount; ++i) {
+                            graphicsPlugin.ClearImageSlice(swapchainImage, i);
+                        }
+                        std::fill(viewImages.begin(), viewImages.end(), swapchainImage);
+                        renderViews(viewImages);
+                    });
+                    break;
+                case StereoArrangement::DoubleWide:
+                    compositionHelper.AcquireWaitReleaseImage(swapchains[0], [&](const XrSwapchainImageBaseHeader* swapchainImage) {
+                        graphicsPlugin.ClearImageSlice(swapchainImage);
+                        std::fill(viewImages.begin(), viewImages.end(), swapchainImage);
+                        renderViews(viewImages);
+                    });
+                    break;
+                case StereoArrangement::PerView:
+                    compositionHelper.AcquireWaitReleaseImages(
+                        swapchains, [&](const std::vector<const XrSwapchainImageBaseHeader*>& images) {
+                            for (const XrSwapchainImageBaseHeader* swapchainImage : images) {
+                                graphicsPlugin.ClearImageSlice(swapchainImage);
+                            }
+                            renderViews(images);
+                        });
+                    break;
+                }
+            };
+
+            const ProjectionFrameTimes times = MeasureProjectionFrames(compositionHelper, localSpace, projLayer, render);
+            const std::vector<MetricTag> tags{{"arrangement", arrangementName}, {"graphicsPlugin", GetGlobalData().options.graphicsPlugin}};
+            ReportProjectionFrameTimes("stereoArrangement", tags, times);
+            renderAllocations.Report(tags);
+        }
+    }  // namespace
+
+    // Not a conformance requirement: renders the same glTF scene into a projection layer laid out as one texture array
+    // swapchain, one double-wide swapchain, and one swapchain per view, with the graphics plugin the run uses. Records the
+    // CPU time spent acquiring, rendering and releasing, the GPU time of the rendering, and the xrEndFrame time and frame
+    // pacing of each arrangement in the CTS XML report. Run with --perfMetricsSampleRate to also record the compositor's own
+    // counters for each arrangement.
+    TEST_CASE("Projection_StereoArrangement_Benchmark", "[.][benchmark]")
+    {
+        GlobalData& globalData = GetGlobalData();
+        if (!globalData.IsUsingGraphicsPlugin()) {
+            SKIP("Cannot benchmark projection layers without a graphics plugin");
+        }
+        if (!globalData.graphicsPlugin->SupportsGpuTimers()) {
+            WARN("Graphics plugin cannot time the GPU: reporting CPU and compositor times only");
+        }
+
+        // A session per arrangement, so that each one's metrics, and the sampled compositor counters, are its own section's.
+        SECTION("Texture array")
+        {
+            RunStereoArrangementBenchmark(StereoArrangement::TextureArray);
+        }
+        SECTION("Double wide")
+        {
+            RunStereoArrangementBenchmark(StereoArrangement::DoubleWide);
+        }
+        SECTION("Per view")
+        {
+            RunStereoArrangementBenchmark(StereoArrangement::PerView);
+        }
+    }
+
+    static const AssetPrefetchRegistration g_resolutionMsaaAssets("Projection_ResolutionMsaa_Benchmark", {}, {"MetalRoughSpheres.glb"});
+
+    // Not a conformance requirement: how GPU time and frame pacing scale with the projection layer's resolution and sample
+    // count, which is what an app trades off when picking its render scale and MSAA level.
+    TEST_CASE("Projection_ResolutionMsaa_Benchmark", "[.][benchmark]")
+    {
+        GlobalData& globalData = GetGlobalData();
+        if (!globalData.IsUsingGraphicsPlugin()) {
+            SKIP("Cannot benchmark projection layers without a graphics plugin");
+        }
+        if (!globalData.graphicsPlugin->SupportsGpuTimers()) {
+            WARN("Graphics plugin cannot time the GPU: reporting CPU and compositor times only");
+        }
+        IGraphicsPlugin& graphicsPlugin = *globalData.graphicsPlugin;
+
+        CompositionHelper compositionHelper("Resolution and MSAA Scaling");
+        compositionHelper.GetInteractionManager().AttachActionSets();
+        compositionHelper.BeginSession();
+
+        const XrSpace localSpace = compositionHelper.CreateReferenceSpace(XR_REFERENCE_SPACE_TYPE_LOCAL);
+        const std::vector<XrViewConfigurationView> viewProperties = compositionHelper.EnumerateConfigurationViews();
+
+        // Scales of the recommended size, ending with the largest one every view's maximum size allows.
+        float maxScale = std::numeric_limits<float>::max();
+        uint32_t maxSampleCount = std::numeric_limits<uint32_t>::max();
+        for (const XrViewConfigurationView& view : viewProperties) {
+            maxScale = std::min({maxScale, (float)view.maxImageRectWidth / view.recommendedImageRectWidth,
+                                 (float)view.maxImageRectHeight / view.recommendedImageRectHeight});
+            maxSampleCount = std::min(maxSampleCount, view.maxSwapchainSampleCount);
+        }
+        std::vector<float> scales;
+        for (float scale : {0.5f, 0.75f, 1.0f, 1.25f, 1.5f, 2.0f}) {
+            if (scale < maxScale) {
+                scales.push_back(scale);
+            }
+        }
+        scales.push_back(maxScale);
+
+        const std::vector<GLTFDrawable> drawables = MakeProjectionBenchmarkScene(graphicsPlugin);
+        const RenderParams renderParams = RenderParams{}.Draw(drawables);
+
+        XrCompositionLayerProjection* const projLayer = compositionHelper.CreateProjectionLayer(localSpace);
+        auto* const projViews = const_cast<XrCompositionLayerProjectionView*>(projLayer->views);
+        for (float scale : scales) {
+            for (uint32_t sampleCount = 1; sampleCount <= maxSampleCount; sampleCount *= 2) {
+                std::vector<XrSwapchain> swapchains;
+                for (uint32_t i = 0; i < projLayer->viewCount; ++i) {
+                    const XrViewConfigurationView& view = viewProperties[i];
+                    const uint32_t width = std::min(view.maxImageRectWidth, (uint32_t)std::lround(view.recommendedImageRectWidth * scale));
+                    const uint32_t height =
+                        std::min(view.maxImageRectHeight, (uint32_t)std::lround(view.recommendedImageRectHeight * scale));
+                    XrSwapchainCreateInfo createInfo = compositionHelper.DefaultColorSwapchainCreateInfo(width, height);
+                    createInfo.sampleCount = sampleCount;
+                    swapchains.push_back(compositionHelper.CreateSwapchain(createInfo));
+                    projViews[i].subImage = compositionHelper.MakeDefaultSubImage(swapchains[i]);
+                }
+
+                const auto render = [&]() {
+                    compositionHelper.AcquireWaitReleaseImages(
+                        swapchains, [&](const std::vector<const XrSwapchainImageBaseHeader*>& images) {
+                            for (const XrSwapchainImageBaseHeader* swapchainImage : images) {
+                                graphicsPlugin.ClearImageSlice(swapchainImage);
+                            }
+                            graphicsPlugin.RenderViews({projViews, projLayer->viewCount}, images, renderParams);
+                        });
+                };
+                const ProjectionFrameTimes times = MeasureProjectionFrames(compositionHelper, localSpace, projLayer, render);
+
+                char scaleString[16];
+                snprintf(scaleString, sizeof(scaleString), "%.2f", scale);
+                ReportProjectionFrameTimes("renderScaling",
+                                           {{"scale", scaleString},
+                                            {"sampleCount", std::to_string(sampleCount)},
+                                            {"width", std::to_string(projViews[0].subImage.imageRect.extent.width)},
+                                            {"graphicsPlugin", globalData.options.graphicsPlugin}},
+                                           times);
+
+                for (XrSwapchain swapchain : swapchains) {
+                    compositionHelper.DestroySwapchain(swapchain);
+                }
+            }
+        }
+    }
+
+    // Not a conformance requirement: how GPU time scales with the triangles submitted, to tell vertex-bound from fill-bound
+    // rendering. The meshes are generated rather than loaded, so no assets are needed.
+    TEST_CASE("Projection_TriangleThroughput_Benchmark", "[.][benchmark]")
+    {
+        GlobalData& globalData = GetGlobalData();
+        if (!globalData.IsUsingGraphicsPlugin()) {
+            SKIP("Cannot benchmark projection layers without a graphics plugin");
+        }
+        if (!globalData.graphicsPlugin->SupportsGpuTimers()) {
+            WARN("Graphics plugin cannot time the GPU: reporting CPU and compositor times only");
+        }
+        IGraphicsPlugin& graphicsPlugin = *globalData.graphicsPlugin;
+
+        CompositionHelper compositionHelper("Triangle Throughput");
+        compositionHelper.GetInteractionManager().AttachActionSets();
+        compositionHelper.BeginSession();
+
+        const XrSpace localSpace = compositionHelper.CreateReferenceSpace(XR_REFERENCE_SPACE_TYPE_LOCAL);
+        const std::vector<XrViewConfigurationView> viewProperties = compositionHelper.EnumerateConfigurationViews();
+
+        XrCompositionLayerProjection* const projLayer = compositionHelper.CreateProjectionLayer(localSpace);
+        auto* const projViews = const_cast<XrCompositionLayerProjectionView*>(projLayer->views);
+        std::vector<XrSwapchain> swapchains;
+        for (uint32_t i = 0; i < projLayer->viewCount; ++i) {
+            swapchains.push_back(compositionHelper.CreateSwapchain(compositionHelper.DefaultColorSwapchainCreateInfo(
+                viewProperties[i].recommendedImageRectWidth, viewProperties[i].recommendedImageRectHeight)));
+            projViews[i].subImage = compositionHelper.MakeDefaultSubImage(swapchains[i]);
+        }
+
+        // More triangles than one mesh with 16-bit indices can hold come from drawing it more times, each small enough on screen
+        // that the added fill stays well below the added vertex work.
+        const Geometry::Mesh torus = Geometry::MakeTorus(128, 128);
+        const MeshHandle mesh = graphicsPlugin.MakeSimpleMesh(torus.indices, torus.vertices);
+
+        for (uint32_t instanceCount = 1; instanceCount <= 256; instanceCount *= 2) {
+            const uint32_t columns = (uint32_t)std::ceil(std::sqrt((float)instanceCount));
+            const float spacing = 0.8f / columns;
+            std::vector<MeshDrawable> meshes;
+            for (uint32_t i = 0; i < instanceCount; ++i) {
+                const float x = ((float)(i % columns) - (columns - 1) * 0.5f) * spacing;
+                const float y = ((float)(i / columns) - (columns - 1) * 0.5f) * spacing;
+                meshes.emplace_back(mesh, XrPosef{Quat::Identity, {x, y, -1.5f}}, XrVector3f{spacing, spacing, spacing});
+            }
+            const RenderParams renderParams = RenderParams{}.Draw(meshes);
+
+            const auto render = [&]() {
+                compositionHelper.AcquireWaitReleaseImages(swapchains, [&](const std::vector<const XrSwapchainImageBaseHeader*>& images) {
+                    for (const XrSwapchainImageBaseHeader* swapchainImage : images) {
+                        graphicsPlugin.ClearImageSlice(swapchainImage);
+                    }
+                    graphicsPlugin.RenderViews({projViews, projLayer->viewCount}, images, renderParams);
+                });
+            };
+            const ProjectionFrameTimes times = MeasureProjectionFrames(compositionHelper, localSpace, projLayer, render);
+
+            ReportProjectionFrameTimes("triangleThroughput",
+                                       {{"triangles", std::to_string((uint64_t)torus.TriangleCount() * instanceCount)},
+                                        {"instances", std::to_string(instanceCount)},
+                                        {"graphicsPlugin", globalData.options.graphicsPlugin}},
+                                       times);
+        }
+    }
+
+    static const AssetPrefetchRegistration g_dynamicResolutionAssets("Projection_DynamicResolution_Benchmark", {},
+                                                                     {"MetalRoughSpheres.glb"});
+
+    // Not a conformance requirement: how the runtime copes with projection views whose imageRect changes from frame to frame,
+    // as an app doing dynamic resolution submits them, and how well GPU time feedback holds the frame rate.
+    TEST_CASE("Projection_DynamicResolution_Benchmark", "[.][benchmark]")
+    {
+        using ms = std::chrono::duration<double, std::milli>;
+        constexpr const char* DynamicResolutionGpuTimerScope = "DynamicResolution";
+        constexpr int warmupFrameCount = 30;
+        constexpr int testFrameCount = 600;
+
+        GlobalData& globalData = GetGlobalData();
+        if (!globalData.IsUsingGraphicsPlugin()) {
+            SKIP("Cannot benchmark projection layers without a graphics plugin");
+        }
+        IGraphicsPlugin& graphicsPlugin = *globalData.graphicsPlugin;
+        if (!graphicsPlugin.SupportsGpuTimers()) {
+            SKIP("Dynamic resolution needs GPU timers for its feedback");
+        }
+
+        CompositionHelper compositionHelper("Dynamic Resolution");
+        compositionHelper.GetInteractionManager().AttachActionSets();
+        compositionHelper.BeginSession();
+
+        SimpleProjectionLayerHelper simpleProjectionLayerHelper(compositionHelper);
+        simpleProjectionLayerHelper.EnableDynamicResolution();
+        const std::vector<GLTFDrawable> drawables = MakeProjectionBenchmarkScene(graphicsPlugin);
+        const RenderParams renderParams = RenderParams{}.Draw(drawables);
+
+        std::vector<std::chrono::nanoseconds> gpuTimes;
+        std::vector<GpuTimerSample> gpuTimerSamples;
+        std::vector<float> scales;
+        uint32_t rectChangeCount = 0;
+        uint32_t missedFrameCount = 0;
+        float lastScale = simpleProjectionLayerHelper.GetDynamicResolution()->GetScale();
+        XrTime lastDisplayTime = 0;
+        int frameCount = 0;
+        auto updateLayers = [&](const XrFrameState& frameState) {
+            std::vector<XrCompositionLayerBaseHeader*> layers;
+            if (frameState.shouldRender) {
+                graphicsPlugin.BeginGpuTimerScope(DynamicResolutionGpuTimerScope);
+                XrCompositionLayerBaseHeader* projLayer =
+                    simpleProjectionLayerHelper.TryGetUpdatedProjectionLayer(frameState, renderParams);
+                if (projLayer != nullptr) {
+                    layers.push_back(projLayer);
+                }
+                graphicsPlugin.EndGpuTimerScope();
+            }
+            compositionHelper.EndFrame(frameState.predictedDisplayTime, layers);
+
+            // Samples arrive a frame or two late, as they would for an app, which the controller's damping allows for.
+            gpuTimerSamples.clear();
+            graphicsPlugin.CollectGpuTimerSamples(gpuTimerSamples);
+            for (const GpuTimerSample& sample : gpuTimerSamples) {
+                if (std::strcmp(sample.name, DynamicResolutionGpuTimerScope) == 0) {
+                    simpleProjectionLayerHelper.UpdateDynamicResolution(sample.duration);
+                    if (frameCount >= warmupFrameCount) {
+                        gpuTimes.push_back(sample.duration);
+                    }
+                }
+            }
+
+            const float scale = simpleProjectionLayerHelper.GetDynamicResolution()->GetScale();
+            if (frameCount >= warmupFrameCount) {
+                scales.push_back(scale);
+                if (scale != lastScale) {
+                    rectChangeCount++;
+                }
+                if (frameState.predictedDisplayTime - lastDisplayTime > frameState.predictedDisplayPeriod * 3 / 2) {
+                    missedFrameCount++;
+                }
+            }
+            lastScale = scale;
+            lastDisplayTime = frameState.predictedDisplayTime;
+            return ++frameCount < warmupFrameCount + testFrameCount;
+        };
+        RenderLoop(compositionHelper.GetSession(), updateLayers).Loop();
+
+        REQUIRE_FALSE(gpuTimes.empty());
+        const DurationPercentiles gpuTime = DurationPercentiles::FromSamples(std::move(gpuTimes));
+        std::sort(scales.begin(), scales.end());
+        const float medianScale = scales[scales.size() / 2];
+        ReportConsoleOnlyF("Dynamic resolution: scale p50 %.2f (min %.2f), %u rect change(s), GPU p50/p99 %.3f / %.3fms, "
+                           "%u missed frame(s)",
+                           medianScale, scales.front(), rectChangeCount, ms(gpuTime.p50).count(), ms(gpuTime.p99).count(),
+                           missedFrameCount);
+        const std::vector<MetricTag> tags{{"graphicsPlugin", globalData.options.graphicsPlugin}};
+        ReportMetric("dynamicResolution.scale", medianScale, "ratio", tags);
+        ReportMetric("dynamicResolution.minScale", scales.front(), "ratio", tags);
+        ReportMetric("dynamicResolution.rectChanges", rectChangeCount, "count", tags);
+        ReportMetric("dynamicResolution.gpuTime", ms(gpuTime.p50).count(), "ms", tags);
+        ReportMetric("dynamicResolution.gpuTimeP99", ms(gpuTime.p99).count(), "ms", tags);
+        ReportMetric("dynamicResolution.missedFrames", missedFrameCount, "count", tags);
+    }
+
+    static const AssetPrefetchRegistration g_depthFormatAssets("Projection_DepthFormat_Benchmark", {}, {"MetalRoughSpheres.glb"});
+
+    // Not a conformance requirement: the GPU and compositor cost of each depth format the runtime offers, written with forward
+    // and with reversed depth, and either submitted to the compositor in an XrCompositionLayerDepthInfoKHR or not. The scene
+    // stacks slabs of glTF models one behind the other, so that most pixels are depth tested several times.
+    TEST_CASE("Projection_DepthFormat_Benchmark", "[XR_KHR_composition_layer_depth][.][benchmark]")
+    {
+        GlobalData& globalData = GetGlobalData();
+        if (!globalData.IsInstanceExtensionSupported(XR_KHR_COMPOSITION_LAYER_DEPTH_EXTENSION_NAME)) {
+            SKIP(XR_KHR_COMPOSITION_LAYER_DEPTH_EXTENSION_NAME " not supported");
+        }
+        if (!globalData.IsUsingGraphicsPlugin()) {
+            SKIP("Cannot benchmark projection layers without a graphics plugin");
+        }
+        IGraphicsPlugin& graphicsPlugin = *globalData.graphicsPlugin;
+        if (!graphicsPlugin.SupportsGpuTimers()) {
+            WARN("Graphics plugin cannot time the GPU: reporting CPU and compositor times only");
+        }
+        if (!graphicsPlugin.SupportsReversedDepth()) {
+            WARN("Graphics plugin cannot write reversed depth: measuring forward depth only");
+        }
+
+        CompositionHelper compositionHelper("Depth Formats", {XR_KHR_COMPOSITION_LAYER_DEPTH_EXTENSION_NAME});
+        compositionHelper.GetInteractionManager().AttachActionSets();
+        compositionHelper.BeginSession();
+
+        const std::vector<int64_t> formats = CHECK_TWO_CALL(int64_t, {}, xrEnumerateSwapchainFormats, compositionHelper.GetSession());
+        std::vector<std::pair<int64_t, std::string>> depthFormats;
+        for (int64_t format : formats) {
+            SwapchainCreateTestParameters params;
+            if (graphicsPlugin.IsImageFormatKnown(format) && graphicsPlugin.GetSwapchainCreateTestParameters(format, &params) &&
+                params.useAsDepth && params.supportsRendering == SwapchainFormat::Flags::RENDERING_SUPPORT) {
+                depthFormats.emplace_back(format, params.imageFormatName);
+            }
+        }
+        if (depthFormats.empty()) {
+            SKIP("Runtime offers no depth format the graphics plugin can render to");
+        }
+
+        // Slabs of models from 1 to 3.5 meters away, each scaled to cover the same part of the view and shifted by half a
+        // model from the one in front, so that every slab is partly hidden by the ones before it.
+        const GLTFModelHandle model = graphicsPlugin.LoadGLTF(LoadGLTFFile("MetalRoughSpheres.glb"));
+        std::vector<GLTFDrawable> drawables;
+        for (int slab = 0; slab < 6; ++slab) {
+            const float distance = 1.0f + slab * 0.5f;
+            const float spacing = 0.2f * distance / 1.5f;
+            const float shift = (slab % 2) * 0.5f;
+            for (int i = 0; i < 16; ++i) {
+                const float x = (static_cast<float>(i % 4) - 1.5f + shift) * spacing;
+                const float y = (static_cast<float>(i / 4) - 1.5f + shift) * spacing;
+                drawables.emplace_back(graphicsPlugin.CreateGLTFModelInstance(model), XrPosef{Quat::Identity, {x, y, -distance}},
+                                       XrVector3f{spacing / 2, spacing / 2, spacing / 2});
+            }
+        }
+        const RenderParams renderParams = RenderParams{}.Draw(drawables);
+
+        const XrSpace localSpace = compositionHelper.CreateReferenceSpace(XR_REFERENCE_SPACE_TYPE_LOCAL);
+        const std::vector<XrViewConfigurationView> viewProperties = compositionHelper.EnumerateConfigurationViews();
+        XrCompositionLayerProjection* const projLayer = compositionHelper.CreateProjectionLayer(localSpace);
+        auto* const projViews = const_cast<XrCompositionLayerProjectionView*>(projLayer->views);
+        std::vector<XrCompositionLayerDepthInfoKHR> depthInfos(projLayer->viewCount, {XR_TYPE_COMPOSITION_LAYER_DEPTH_INFO_KHR});
+
+        std::vector<bool> reversedDepths{false};
+        if (graphicsPlugin.SupportsReversedDepth()) {
+            reversedDepths.push_back(true);
+        }
+
+        // Leave the plugin writing forward depth for the tests that follow, however this one ends.
+        struct ForwardDepthOnExit
+        {
+            IGraphicsPlugin& graphicsPlugin;
+            ~ForwardDepthOnExit()
+            {
+                graphicsPlugin.SetReversedDepth(false);
+            }
+        } forwardDepthOnExit{graphicsPlugin};
+
+        for (const auto& depthFormat : depthFormats) {
+            std::vector<XrSwapchain> colorSwapchains;
+            std::vector<XrSwapchain> depthSwapchains;
+            for (uint32_t i = 0; i < projLayer->viewCount; ++i) {
+                const XrViewConfigurationView& view = viewProperties[i];
+                const std::pair<XrSwapchain, XrSwapchain> swapchains = compositionHelper.CreateSwapchainWithDepth(
+                    compositionHelper.DefaultColorSwapchainCreateInfo(view.recommendedImageRectWidth, view.recommendedImageRectHeight),
+                    compositionHelper.DefaultDepthSwapchainCreateInfo(view.recommendedImageRectWidth, view.recommendedImageRectHeight, 0,
+                                                                      depthFormat.first));
+                colorSwapchains.push_back(swapchains.first);
+                depthSwapchains.push_back(swapchains.second);
+                projViews[i].subImage = compositionHelper.MakeDefaultSubImage(swapchains.first);
+                depthInfos[i].subImage = compositionHelper.MakeDefaultSubImage(swapchains.second);
+            }
+
+            const auto render = [&]() {
+                compositionHelper.AcquireWaitReleaseImages(
+                    colorSwapchains, [&](const std::vector<const XrSwapchainImageBaseHeader*>& images) {
+                        for (const XrSwapchainImageBaseHeader* swapchainImage : images) {
+                            graphicsPlugin.ClearImageSlice(swapchainImage);
+                        }
+                        graphicsPlugin.RenderViews({projViews, projLayer->viewCount}, images, renderParams);
+                    });
+            };
+
+            for (bool reversedDepth : reversedDepths) {
+                graphicsPlugin.SetReversedDepth(reversedDepth);
+                for (XrCompositionLayerDepthInfoKHR& depthInfo : depthInfos) {
+                    // The planes the graphics plugins render with, see IGraphicsPlugin::SetReversedDepth.
+                    depthInfo.minDepth = 0.0f;
+                    depthInfo.maxDepth = 1.0f;
+                    depthInfo.nearZ = reversedDepth ? 100.0f : 0.05f;
+                    depthInfo.farZ = reversedDepth ? 0.05f : 100.0f;
+                }
+
+                for (bool submitDepth : {false, true}) {
+                    for (uint32_t i = 0; i < projLayer->viewCount; ++i) {
+                        projViews[i].next = submitDepth ? &depthInfos[i] : nullptr;
+                    }
+                    const ProjectionFrameTimes times = MeasureProjectionFrames(compositionHelper, localSpace, projLayer, render);
+
+                    ReportProjectionFrameTimes("depthFormat",
+                                               {{"format", depthFormat.second},
+                                                {"depth", reversedDepth ? "reversed" : "forward"},
+                                                {"submitted", submitDepth ? "true" : "false"},
+                                                {"graphicsPlugin", globalData.options.graphicsPlugin}},
+                                               times);
+                }
+            }
+
+            for (uint32_t i = 0; i < projLayer->viewCount; ++i) {
+                projViews[i].next = nullptr;
+                compositionHelper.DestroySwapchain(colorSwapchains[i]);
+                compositionHelper.DestroySwapchain(depthSwapchains[i]);
+            }
+        }
+    }
 }  // namespace Conformance
@@ -0,0 +1,278 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "conformance_utils.h"
+#include "gltf_helpers.h"
+#include "report.h"
+
+#include "common/xr_linear.h"
+#include "gltf/GltfHelper.h"
+#include "pbr/PbrCommon.h"
+#include "pbr/PbrModel.h"
+#include "pbr/PbrTexture.h"
+#include "utilities/utils.h"
+#include "utilities/xr_math_operators.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <tinygltf/tiny_gltf.h>
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace Conformance
+{
+    using namespace openxr::math_operators;
+
+    namespace
+    {
+        constexpr const char* kSampleModels[] = {
+            "AlphaBlendModeTest.glb",     "AnisotropyBarnLamp.glb",  "MetalRoughSpheres.glb",   "MetalRoughSpheresNoTextures.glb",
+            "NormalTangentMirrorTest.glb", "NormalTangentTest.glb", "TextureSettingsTest.glb", "VertexColorTest.glb",
+        };
+
+        /// Exposes the transform resolution of Pbr::ModelInstance, the way the graphics-API-specific instances use it.
+        class TestModelInstance : public Pbr::ModelInstance
+        {
+        public:
+            explicit TestModelInstance(std::shared_ptr<const Pbr::Model> model) : Pbr::ModelInstance(std::move(model))
+            {
+            }
+
+            void Resolve(bool transpose)
+            {
+                if (ResolvedTransformsNeedUpdate()) {
+                    ResolveTransformsAndVisibilities(transpose);
+                    MarkResolvedTransformsUpdated();
+                }
+            }
+
+            /// Resolve every node, as was done before changes were tracked per node.
+            void ResolveAll(bool transpose)
+            {
+                MarkAllNodesNeedResolve();
+                Resolve(transpose);
+            }
+
+            using Pbr::ModelInstance::GetResolvedTransforms;
+        };
+
+        void AddNodeHierarchy(Pbr::NodeIndex_t parentNodeIndex, const tinygltf::Model& gltfModel, int nodeId, Pbr::Model& model)
+        {
+            const tinygltf::Node& gltfNode = gltfModel.nodes.at(nodeId);
+            const Pbr::NodeIndex_t nodeIndex = model.AddNode(GltfHelper::ReadNodeLocalTransform(gltfNode), parentNodeIndex, gltfNode.name);
+            for (const int childNodeId : gltfNode.children) {
+                AddNodeHierarchy(nodeIndex, gltfModel, childNodeId, model);
+            }
+        }
+
+        /// Load only the node hierarchy of a glTF file, the same way Gltf::ModelBuilder does, without any graphics resources.
+        std::shared_ptr<const Pbr::Model> LoadNodeHierarchy(const char* fileName)
+        {
+            std::shared_ptr<const tinygltf::Model> gltfModel = LoadGLTFFile(fileName);
+            auto model = std::make_shared<Pbr::Model>();
+            const int defaultSceneId = (gltfModel->defaultScene == -1) ? 0 : gltfModel->defaultScene;
+            for (const int rootNodeId : gltfModel->scenes.at(defaultSceneId).nodes) {
+                AddNodeHierarchy(Pbr::RootNodeIndex, *gltfModel, rootNodeId, *model);
+            }
+            return model;
+        }
+
+        /// A controller-like hierarchy: a chain of @p depth nodes, each with @p fanOut leaf children.
+        std::shared_ptr<const Pbr::Model> MakeSyntheticHierarchy(int depth, int fanOut)
+        {
+            auto model = std::make_shared<Pbr::Model>();
+            Pbr::NodeIndex_t parent = Pbr::RootNodeIndex;
+            for (int d = 0; d < depth; ++d) {
+                const XrVector3f translation{0.01f * d, 0.02f, -0.03f};
+                parent = model->AddNode(Matrix::FromTranslationRotationScale(translation, Quat::Identity, {1, 1, 1}), parent,
+                                        "chain" + std::to_string(d));
+                for (int c = 0; c < fanOut; ++c) {
+                    model->AddNode(Matrix::FromTranslationRotationScale({0.001f * c, 0, 0}, Quat::Identity, {1, 1, 1}), parent,
+                                   "leaf" + std::to_string(c));
+                }
+            }
+            return model;
+        }
+
+        XrMatrix4x4f AnimatedTransform(int frame)
+        {
+            const XrQuaternionf rotation = Quat::FromAxisAngle({0, 1, 0}, 0.01f * frame);
+            return Matrix::FromTranslationRotationScale({0, -0.001f * (frame % 7), 0}, rotation, {1, 1, 1});
+        }
+
+        void RequireSameTransforms(const TestModelInstance& actual, const TestModelInstance& expected)
+        {
+            const std::vector<XrMatrix4x4f>& actualTransforms = actual.GetResolvedTransforms();
+            const std::vector<XrMatrix4x4f>& expectedTransforms = expected.GetResolvedTransforms();
+            REQUIRE(actualTransforms.size() == expectedTransforms.size());
+            for (size_t i = 0; i < actualTransforms.size(); ++i) {
+                INFO("Node " << i);
+                REQUIRE(memcmp(&actualTransforms[i], &expectedTransforms[i], sizeof(XrMatrix4x4f)) == 0);
+            }
+        }
+    }  // namespace
+
+    TEST_CASE("PbrModel_FindFirstNode", "[self_test]")
+    {
+        Pbr::Model model;
+        const XrMatrix4x4f identity = Matrix::Identity;
+        const Pbr::NodeIndex_t left = model.AddNode(identity, Pbr::RootNodeIndex, "left");
+        const Pbr::NodeIndex_t right = model.AddNode(identity, Pbr::RootNodeIndex, "right");
+        const Pbr::NodeIndex_t leftButton = model.AddNode(identity, left, "button");
+        const Pbr::NodeIndex_t rightButton = model.AddNode(identity, right, "button");
+        model.AddNode(identity, right, "button");
+
+        Pbr::NodeIndex_t found = Pbr::NodeIndex_npos;
+        REQUIRE(model.FindFirstNode(&found, "root"));
+        CHECK(found == Pbr::RootNodeIndex);
+        REQUIRE(model.FindFirstNode(&found, "button"));
+        CHECK(found == leftButton);
+        REQUIRE(model.FindFirstNode(&found, "button", &right));
+        CHECK(found == rightButton);
+        REQUIRE(model.FindFirstNode(&found, "right", &Pbr::RootNodeIndex));
+        CHECK(found == right);
+
+        CHECK_FALSE(model.FindFirstNode(&found, "missing"));
+        CHECK_FALSE(model.FindFirstNode(&found, "button", &Pbr::RootNodeIndex));
+        CHECK_FALSE(model.FindFirstNode(&found, "left", &left));
+    }
+
+    TEST_CASE("PbrModelInstance_IncrementalResolve", "[self_test]")
+    {
+        std::vector<std::pair<std::string, std::shared_ptr<const Pbr::Model>>> models;
+        for (const char* fileName : kSampleModels) {
+            models.emplace_back(fileName, LoadNodeHierarchy(fileName));
+        }
+        models.emplace_back("synthetic", MakeSyntheticHierarchy(8, 4));
+
+        for (const auto& namedModel : models) {
+            const std::shared_ptr<const Pbr::Model>& model = namedModel.second;
+            const Pbr::NodeIndex_t nodeCount = model->GetNodeCount();
+            for (bool transpose : {false, true}) {
+                INFO(namedModel.first << (transpose ? " transposed" : ""));
+                TestModelInstance incremental(model);
+                TestModelInstance reference(model);
+
+                // Change one node at a time, cycling through all of them, and hide and show some subtrees along the way.
+                for (int frame = 0; frame < 3 * (int)nodeCount; ++frame) {
+                    const Pbr::NodeIndex_t node = (Pbr::NodeIndex_t)(frame % nodeCount);
+                    for (TestModelInstance* instance : {&incremental, &reference}) {
+                        instance->SetNodeTransform(node, AnimatedTransform(frame));
+                        if (frame % 5 == 0) {
+                            instance->SetNodeVisibility(node, Pbr::NodeVisibility::Invisible);
+                        }
+                        else if (frame % 5 == 2) {
+                            instance->SetNodeVisibility(node, Pbr::NodeVisibility::Visible);
+                        }
+                    }
+                    incremental.Resolve(transpose);
+                    reference.ResolveAll(transpose);
+                    RequireSameTransforms(incremental, reference);
+                }
+            }
+        }
+    }
+
+    TEST_CASE("PbrModelInstance_IncrementalResolve_Benchmark", "[.][benchmark][self_test]")
+    {
+        using us = std::chrono::duration<double, std::micro>;
+        constexpr int frames = 10000;
+
+        std::vector<std::pair<std::string, std::shared_ptr<const Pbr::Model>>> models;
+        for (const char* fileName : kSampleModels) {
+            models.emplace_back(fileName, LoadNodeHierarchy(fileName));
+        }
+        models.emplace_back("synthetic", MakeSyntheticHierarchy(8, 4));
+
+        for (const auto& namedModel : models) {
+            const std::shared_ptr<const Pbr::Model>& model = namedModel.second;
+            // Animate the last node, like a controller button, which has no children of its own.
+            const Pbr::NodeIndex_t animatedNode = model->GetNodeCount() - 1;
+
+            auto timeFrames = [&](bool full) {
+                TestModelInstance instance(model);
+                Stopwatch sw(true);
+                for (int frame = 0; frame < frames; ++frame) {
+                    instance.SetNodeTransform(animatedNode, AnimatedTransform(frame));
+                    if (full) {
+                        instance.ResolveAll(false);
+                    }
+                    else {
+                        instance.Resolve(false);
+                    }
+                }
+                return std::chrono::duration_cast<us>(sw.Elapsed() / frames).count();
+            };
+
+            const std::vector<MetricTag> tags{{"model", namedModel.first}, {"nodes", std::to_string(model->GetNodeCount())}};
+            ReportMetric("PbrModelInstance.Resolve.full", timeFrames(true), "us", tags);
+            ReportMetric("PbrModelInstance.Resolve.incremental", timeFrames(false), "us", tags);
+        }
+    }
+
+    TEST_CASE("PbrCompactVertex_Pack", "[self_test]")
+    {
+        Pbr::Vertex vertex{};
+        vertex.Position = {1.5f, -2.25f, 1000.0f};
+        vertex.Normal = {0.0f, -1.0f, 0.5f};
+        vertex.Tangent = {1.0f, 0.0f, -2.0f, -1.0f};
+        vertex.Color0 = {1.0f, 0.5f, 0.0f, 1.5f};
+        vertex.TexCoord0 = {0.5f, -65520.0f};
+        vertex.ModelTransformIndex = 7;
+
+        const std::vector<Pbr::CompactVertex> compactVertices = Pbr::PackCompactVertices({vertex});
+        REQUIRE(compactVertices.size() == 1);
+        const Pbr::CompactVertex& compactVertex = compactVertices[0];
+
+        CHECK(memcmp(&compactVertex.Position, &vertex.Position, sizeof(vertex.Position)) == 0);
+        CHECK(compactVertex.Normal[0] == 0);
+        CHECK(compactVertex.Normal[1] == -32767);
+        CHECK(compactVertex.Normal[2] == 16384);
+        // Out of range values are clamped
+        CHECK(compactVertex.Tangent[2] == -32767);
+        CHECK(compactVertex.Tangent[3] == -32767);
+        CHECK(compactVertex.Color0[1] == 128);
+        CHECK(compactVertex.Color0[3] == 255);
+        // 0.5 and negative infinity, since -65520 rounds away from the largest half
+        CHECK(compactVertex.TexCoord0[0] == 0x3800);
+        CHECK(compactVertex.TexCoord0[1] == 0xfc00);
+        CHECK(compactVertex.ModelTransformIndex == 7);
+    }
+
+    TEST_CASE("PbrTexture_GeneratedMipLevels", "[self_test]")
+    {
+        CHECK(Pbr::GetFullMipChainLevelCount(1, 1) == 1);
+        CHECK(Pbr::GetFullMipChainLevelCount(2, 1) == 2);
+        CHECK(Pbr::GetFullMipChainLevelCount(256, 256) == 9);
+        CHECK(Pbr::GetFullMipChainLevelCount(300, 17) == 9);
+
+        const std::array<uint8_t, 2 * 2 * 4> pixels{};
+        const Image::FormatParams rgba = Image::FormatParams::R8G8B8A8(true);
+        const Image::Image image{rgba, {{Image::ImageLevelMetadata::MakeUncompressed(2, 2), pixels}}};
+        CHECK(Pbr::CanGenerateMips(image));
+
+        const Image::Image onePixel{rgba, {{Image::ImageLevelMetadata::MakeUncompressed(1, 1), {pixels.data(), 4}}}};
+        CHECK_FALSE(Pbr::CanGenerateMips(onePixel));
+
+        const Image::FormatParams bc7{Image::Codec::BC7, Image::Channels::RGBA, Image::ColorSpaceType::sRGB};
+        const Image::Image compressed{bc7, {{{{4, 4}, {4, 4}}, pixels}}};
+        CHECK_FALSE(Pbr::CanGenerateMips(compressed));
+    }
+}  // namespace Conformance
@@ -0,0 +1,101 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pbr/PbrTextureCache.h"
+#include "utilities/image.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace Conformance
+{
+    namespace
+    {
+        /// An uncompressed RGBA image of one level, @p size pixels square, every byte @p value.
+        struct TestImage
+        {
+            TestImage(int32_t size, uint8_t value, bool sRGB = false) : data(size * size * 4, value)
+            {
+                image.format = Image::FormatParams::R8G8B8A8(sRGB);
+                image.levels.push_back({Image::ImageLevelMetadata::MakeUncompressed(size, size), data});
+            }
+
+            std::vector<uint8_t> data;
+            Image::Image image;
+        };
+
+        using Texture = std::shared_ptr<int>;
+    }  // namespace
+
+    TEST_CASE("PbrTextureCache", "[self_test]")
+    {
+        Pbr::TextureCache<Texture> cache;
+        int createCount = 0;
+        auto create = [&] { return std::make_shared<int>(++createCount); };
+
+        SECTION("Same content shares a texture")
+        {
+            TestImage first(1, 0x80);
+            TestImage second(1, 0x80);
+            Texture a = cache.FindOrCreate(first.image, create);
+            Texture b = cache.FindOrCreate(second.image, create);
+            CHECK(a == b);
+            CHECK(createCount == 1);
+            CHECK(cache.GetCount() == 1);
+        }
+
+        SECTION("Different data, size or color space do not")
+        {
+            TestImage base(2, 0x80);
+            TestImage otherData(2, 0x81);
+            TestImage otherSize(1, 0x80);
+            TestImage otherColorSpace(2, 0x80, true);
+            Texture a = cache.FindOrCreate(base.image, create);
+            CHECK(cache.FindOrCreate(otherData.image, create) != a);
+            CHECK(cache.FindOrCreate(otherSize.image, create) != a);
+            CHECK(cache.FindOrCreate(otherColorSpace.image, create) != a);
+            CHECK(createCount == 4);
+        }
+
+        SECTION("Unused textures are dropped least recently used first once over budget")
+        {
+            // Each 4x4 RGBA image is 64 bytes, plus a third for the mips generated for it.
+            TestImage images[] = {{4, 1}, {4, 2}, {4, 3}};
+            const uint64_t textureBytes = Pbr::EstimateTextureBytes(images[0].image);
+            REQUIRE(textureBytes == 85);
+            cache.SetBudget(textureBytes * 2);
+
+            Texture held = cache.FindOrCreate(images[0].image, create);
+            cache.FindOrCreate(images[1].image, create);
+            cache.FindOrCreate(images[2].image, create);
+            // Over budget: the least recently used unused texture, the second, is dropped; the first is still held.
+            CHECK(cache.GetCount() == 2);
+            CHECK(cache.GetCachedBytes() == textureBytes * 2);
+            CHECK(cache.FindOrCreate(images[0].image, create) == held);
+            CHECK(*cache.FindOrCreate(images[2].image, create) == 3);
+            CHECK(*cache.FindOrCreate(images[1].image, create) == 4);
+
+            // Nothing held: lowering the budget drops what no longer fits.
+            held.reset();
+            cache.SetBudget(0);
+            CHECK(cache.GetCount() == 0);
+            CHECK(cache.GetCachedBytes() == 0);
+        }
+    }
+}  // namespace Conformance
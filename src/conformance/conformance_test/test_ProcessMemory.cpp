@@ -0,0 +1,68 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "utilities/process_memory.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <vector>
+
+namespace Conformance
+{
+    TEST_CASE("ProcessMemory_AnalyzeResidentGrowth", "[self_test]")
+    {
+        constexpr uint64_t MB = 1024 * 1024;
+
+        SECTION("Too few samples")
+        {
+            const ResidentGrowth growth = AnalyzeResidentGrowth({100 * MB}, MB);
+            CHECK(growth.steps == 0);
+            CHECK_FALSE(growth.steady);
+        }
+
+        SECTION("Steady growth")
+        {
+            const ResidentGrowth growth = AnalyzeResidentGrowth({100 * MB, 101 * MB, 102 * MB, 102 * MB, 103 * MB, 104 * MB}, MB);
+            CHECK(growth.totalBytes == int64_t(4 * MB));
+            CHECK(growth.steps == 5);
+            CHECK(growth.growingSteps == 4);
+            CHECK(growth.steady);
+        }
+
+        SECTION("Growth below the threshold")
+        {
+            const ResidentGrowth growth = AnalyzeResidentGrowth({100 * MB, 100 * MB + 4096, 100 * MB + 8192}, MB);
+            CHECK(growth.growingSteps == 2);
+            CHECK_FALSE(growth.steady);
+        }
+
+        SECTION("Growth that levels off")
+        {
+            const ResidentGrowth growth = AnalyzeResidentGrowth({100 * MB, 108 * MB, 108 * MB, 107 * MB, 108 * MB, 108 * MB}, MB);
+            CHECK(growth.totalBytes == int64_t(8 * MB));
+            CHECK(growth.growingSteps == 2);
+            CHECK_FALSE(growth.steady);
+        }
+
+        SECTION("Shrinking")
+        {
+            const ResidentGrowth growth = AnalyzeResidentGrowth({100 * MB, 99 * MB, 98 * MB}, MB);
+            CHECK(growth.totalBytes == -int64_t(2 * MB));
+            CHECK_FALSE(growth.steady);
+        }
+    }
+}  // namespace Conformance
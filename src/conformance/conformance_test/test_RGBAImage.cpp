@@ -0,0 +1,226 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "RGBAImage.h"
+#include "conformance_utils.h"
+#include "report.h"
+#include "utilities/colors.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Conformance
+{
+    namespace
+    {
+        /// The per-channel double precision conversion RGBAImage::ConvertToSRGB used before it had a lookup table.
+        void ConvertToSRGBReference(RGBAImage& image)
+        {
+            for (RGBA8Color& pixel : image.pixels) {
+                pixel.Channels.R = (uint8_t)(ColorUtils::ToSRGB((double)pixel.Channels.R / 255.0) * 255.0);
+                pixel.Channels.G = (uint8_t)(ColorUtils::ToSRGB((double)pixel.Channels.G / 255.0) * 255.0);
+                pixel.Channels.B = (uint8_t)(ColorUtils::ToSRGB((double)pixel.Channels.B / 255.0) * 255.0);
+            }
+        }
+
+        /// An image using every channel value, with R, G and B out of phase and A left alone.
+        RGBAImage MakeTestImage(int width, int height)
+        {
+            RGBAImage image(width, height);
+            for (size_t i = 0; i < image.pixels.size(); ++i) {
+                image.pixels[i].Channels.R = (uint8_t)i;
+                image.pixels[i].Channels.G = (uint8_t)(i + 85);
+                image.pixels[i].Channels.B = (uint8_t)(i + 170);
+                image.pixels[i].Channels.A = (uint8_t)(i * 7);
+            }
+            return image;
+        }
+
+        /// The per-pixel fill RGBAImage::DrawRect used before it had a vectorized kernel.
+        void DrawRectReference(RGBAImage& image, int x, int y, int w, int h, XrColor4f color)
+        {
+            const RGBA8Color color32{
+                {(uint8_t)(255 * color.r), (uint8_t)(255 * color.g), (uint8_t)(255 * color.b), (uint8_t)(255 * color.a)}};
+            for (int row = 0; row < h; row++) {
+                for (int col = 0; col < w; col++) {
+                    image.pixels[(row + y) * image.width + x + col] = color32;
+                }
+            }
+        }
+
+        /// The row-by-row copy CopyWithStride used before it had the contiguous and multi-threaded paths.
+        void CopyWithStrideReference(const uint8_t* source, uint8_t* dest, uint32_t rowSize, uint32_t rows, uint32_t rowPitch)
+        {
+            for (size_t row = 0; row < rows; ++row) {
+                memcpy(&dest[row * rowPitch], &source[row * rowSize], rowSize);
+            }
+        }
+
+        void RequireSamePixels(const RGBAImage& image, const RGBAImage& reference)
+        {
+            for (size_t i = 0; i < image.pixels.size(); ++i) {
+                INFO("Pixel " << i);
+                REQUIRE(image.pixels[i].Pixel == reference.pixels[i].Pixel);
+            }
+        }
+    }  // namespace
+
+    TEST_CASE("RGBAImage_ConvertToSRGB", "[self_test]")
+    {
+        RGBAImage image = MakeTestImage(256, 4);
+        RGBAImage reference = image;
+
+        image.ConvertToSRGB();
+        ConvertToSRGBReference(reference);
+
+        for (size_t i = 0; i < image.pixels.size(); ++i) {
+            INFO("Pixel " << i);
+            REQUIRE(image.pixels[i].Pixel == reference.pixels[i].Pixel);
+        }
+    }
+
+    TEST_CASE("RGBAImage_ConvertToSRGB_Benchmark", "[.][benchmark][self_test]")
+    {
+        using ms = std::chrono::duration<double, std::milli>;
+        constexpr int size = 2048;
+        constexpr int iterations = 10;
+
+        RGBAImage source = MakeTestImage(size, size);
+
+        auto timeConversion = [&](void (*convert)(RGBAImage&)) {
+            std::chrono::nanoseconds total{0};
+            for (int i = 0; i < iterations; ++i) {
+                RGBAImage image = source;
+                Stopwatch sw(true);
+                convert(image);
+                total += sw.Elapsed();
+            }
+            return std::chrono::duration_cast<ms>(total / iterations).count();
+        };
+
+        const double referenceMs = timeConversion(ConvertToSRGBReference);
+        const double tableMs = timeConversion([](RGBAImage& image) { image.ConvertToSRGB(); });
+
+        ReportMetric("ConvertToSRGB.reference", referenceMs, "ms", {{"pixels", std::to_string(size * size)}});
+        ReportMetric("ConvertToSRGB.table", tableMs, "ms", {{"pixels", std::to_string(size * size)}});
+    }
+
+    TEST_CASE("RGBAImage_DrawRect", "[self_test]")
+    {
+        constexpr XrColor4f color{0.25f, 0.5f, 0.75f, 1.0f};
+        RGBAImage image = MakeTestImage(67, 13);
+        RGBAImage reference = image;
+
+        SECTION("Full width")
+        {
+            image.DrawRect(0, 2, image.width, 9, color);
+            DrawRectReference(reference, 0, 2, reference.width, 9, color);
+        }
+        SECTION("Unaligned widths")
+        {
+            // Cover every remainder of the four pixel wide kernel.
+            for (int w = 0; w < 8; ++w) {
+                image.DrawRect(w * 3 + 1, w, w, 4, color);
+                DrawRectReference(reference, w * 3 + 1, w, w, 4, color);
+            }
+        }
+        SECTION("Border")
+        {
+            image.DrawRectBorder(3, 1, 61, 11, 2, color);
+            DrawRectReference(reference, 3, 1, 61, 2, color);
+            DrawRectReference(reference, 3, 10, 61, 2, color);
+            DrawRectReference(reference, 3, 3, 2, 7, color);
+            DrawRectReference(reference, 62, 3, 2, 7, color);
+        }
+
+        RequireSamePixels(image, reference);
+    }
+
+    TEST_CASE("RGBAImage_CopyWithStride", "[self_test]")
+    {
+        auto requireSameCopy = [](int width, int height, uint32_t rowPitch) {
+            INFO("Width " << width << ", height " << height << ", row pitch " << rowPitch);
+            const RGBAImage image = MakeTestImage(width, height);
+            const uint32_t rowSize = width * sizeof(RGBA8Color);
+            std::vector<uint8_t> copy(rowPitch * height, 0xcd);
+            std::vector<uint8_t> reference = copy;
+
+            image.CopyWithStride(copy.data(), rowPitch);
+            CopyWithStrideReference(reinterpret_cast<const uint8_t*>(image.pixels.data()), reference.data(), rowSize, height, rowPitch);
+            REQUIRE(copy == reference);
+        };
+
+        SECTION("Padded rows")
+        {
+            requireSameCopy(61, 7, 61 * sizeof(RGBA8Color) + 12);
+        }
+        SECTION("Contiguous rows")
+        {
+            requireSameCopy(61, 7, 61 * sizeof(RGBA8Color));
+        }
+        SECTION("Large enough to copy on several threads")
+        {
+            requireSameCopy(2048, 2049, 2048 * sizeof(RGBA8Color) + 256);
+            requireSameCopy(2048, 2049, 2048 * sizeof(RGBA8Color));
+        }
+    }
+
+    // Not a conformance requirement: compares the rect fill and strided copy with their previous per-pixel and per-row
+    // versions, to confirm the SIMD and multi-threaded paths pay off on the device's architecture.
+    TEST_CASE("RGBAImage_RowOperations_Benchmark", "[.][benchmark][self_test]")
+    {
+        using ms = std::chrono::duration<double, std::milli>;
+        constexpr int size = 4096;
+        constexpr int iterations = 10;
+        constexpr XrColor4f color{0.25f, 0.5f, 0.75f, 1.0f};
+
+        auto timeMs = [&](const std::function<void()>& operation) {
+            std::chrono::nanoseconds total{0};
+            for (int i = 0; i < iterations; ++i) {
+                Stopwatch sw(true);
+                operation();
+                total += sw.Elapsed();
+            }
+            return std::chrono::duration_cast<ms>(total / iterations).count();
+        };
+
+        const std::vector<MetricTag> tags{{"pixels", std::to_string(size * size)}};
+
+        RGBAImage image(size, size);
+        // Inset by a pixel so that every row is filled separately.
+        ReportMetric("DrawRect.reference", timeMs([&] { DrawRectReference(image, 1, 0, size - 2, size, color); }), "ms", tags);
+        ReportMetric("DrawRect.simd", timeMs([&] { image.DrawRect(1, 0, size - 2, size, color); }), "ms", tags);
+        ReportMetric("DrawRect.fullWidth", timeMs([&] { image.DrawRect(0, 0, size, size, color); }), "ms", tags);
+
+        const uint8_t* source = reinterpret_cast<const uint8_t*>(image.pixels.data());
+        const uint32_t rowSize = size * sizeof(RGBA8Color);
+        for (uint32_t rowPitch : {rowSize, rowSize + 256}) {
+            std::vector<uint8_t> dest(rowPitch * size);
+            std::vector<MetricTag> copyTags = tags;
+            copyTags.push_back({"contiguous", rowPitch == rowSize ? "true" : "false"});
+            ReportMetric("CopyWithStride.reference",
+                         timeMs([&] { CopyWithStrideReference(source, dest.data(), rowSize, size, rowPitch); }), "ms", copyTags);
+            ReportMetric("CopyWithStride.optimized", timeMs([&] { CopyWithStride(source, dest.data(), rowSize, size, rowPitch); }),
+                         "ms", copyTags);
+        }
+    }
+}  // namespace Conformance
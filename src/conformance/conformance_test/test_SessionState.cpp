@@ -16,6 +16,7 @@
 
 #include "conformance_utils.h"
 #include "conformance_framework.h"
+#include "report.h"
 #include "utilities/types_and_constants.h"
 #include "utilities/throw_helpers.h"
 
@@ -26,41 +27,32 @@
 #include <openxr/openxr_reflection.h>
 
 #include <chrono>
-#include <thread>
+#include <initializer_list>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace Conformance
 {
-    static bool tryReadEvent(XrInstance instance, XrEventDataBuffer* evt)
-    {
-        *evt = {XR_TYPE_EVENT_DATA_BUFFER};
-        XrResult res;
-        XRC_CHECK_THROW_XRCMD(res = xrPollEvent(instance, evt));
-        return res == XR_SUCCESS;
-    }
-
-    static bool tryGetNextSessionState(XrInstance instance, XrEventDataSessionStateChanged* evt)
+    static bool tryGetNextSessionState(EventReader& eventReader, XrEventDataSessionStateChanged* evt)
     {
         XrEventDataBuffer buffer;
-        while (tryReadEvent(instance, &buffer)) {
-            if (buffer.type == XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED) {
-                *evt = *reinterpret_cast<XrEventDataSessionStateChanged*>(&buffer);
-                return true;
-            }
+        if (eventReader.TryReadUntilEvent(buffer, XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED)) {
+            *evt = *reinterpret_cast<XrEventDataSessionStateChanged*>(&buffer);
+            return true;
         }
         return false;
     }
 
-    static bool waitForNextSessionState(XrInstance instance, XrEventDataSessionStateChanged* evt, std::chrono::nanoseconds duration = 1s)
+    static bool waitForNextSessionState(EventReader& eventReader, XrEventDataSessionStateChanged* evt,
+                                        std::chrono::nanoseconds duration = 1s)
     {
-        CountdownTimer countdown(duration);
-        while (!countdown.IsTimeUp()) {
-            if (tryGetNextSessionState(instance, evt)) {
-                return true;
-            }
-
-            std::this_thread::sleep_for(5ms);
+        XrEventDataBuffer buffer;
+        if (eventReader.WaitForEvent(buffer, XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED, duration)) {
+            *evt = *reinterpret_cast<XrEventDataSessionStateChanged*>(&buffer);
+            return true;
         }
-
         return false;
     }
 
@@ -76,7 +68,7 @@ namespace Conformance
         XRC_CHECK_THROW_XRCMD(xrEndFrame(session, &frameEndInfo));
     }
 
-    static void submitFramesUntilSessionState(XrInstance instance, XrSession session, XrSessionState expectedSessionState,
+    static void submitFramesUntilSessionState(EventReader& eventReader, XrSession session, XrSessionState expectedSessionState,
                                               std::chrono::nanoseconds duration = 30s)
     {
         CAPTURE(expectedSessionState);
@@ -84,7 +76,7 @@ namespace Conformance
         CountdownTimer countdown(duration);
         while (!countdown.IsTimeUp()) {
             XrEventDataSessionStateChanged evt;
-            if (tryGetNextSessionState(instance, &evt)) {
+            if (tryGetNextSessionState(eventReader, &evt)) {
                 REQUIRE(evt.state == expectedSessionState);
                 return;
             }
@@ -97,6 +89,8 @@ namespace Conformance
     TEST_CASE("SessionState", "")
     {
         AutoBasicInstance instance;
+        EventQueue eventQueue(instance);
+        EventReader eventReader(eventQueue);
 
         SECTION("Cycle through all states")
         {
@@ -112,45 +106,45 @@ namespace Conformance
             {
                 {
                     INFO("Advancing to IDLE");
-                    REQUIRE(waitForNextSessionState(instance, &evt) == true);
+                    REQUIRE(waitForNextSessionState(eventReader, &evt) == true);
                     REQUIRE(evt.state == XR_SESSION_STATE_IDLE);
                 }
 
                 {
                     INFO("Advancing to READY");
-                    REQUIRE(waitForNextSessionState(instance, &evt) == true);
+                    REQUIRE(waitForNextSessionState(eventReader, &evt) == true);
                     REQUIRE(evt.state == XR_SESSION_STATE_READY);
                 }
 
                 REQUIRE(XR_SUCCESS == xrBeginSession(session, &beginInfo));
 
-                submitFramesUntilSessionState(instance, session, XR_SESSION_STATE_SYNCHRONIZED);
-                submitFramesUntilSessionState(instance, session, XR_SESSION_STATE_VISIBLE);
-                submitFramesUntilSessionState(instance, session, XR_SESSION_STATE_FOCUSED);
+                submitFramesUntilSessionState(eventReader, session, XR_SESSION_STATE_SYNCHRONIZED);
+                submitFramesUntilSessionState(eventReader, session, XR_SESSION_STATE_VISIBLE);
+                submitFramesUntilSessionState(eventReader, session, XR_SESSION_STATE_FOCUSED);
 
                 // Runtime should only allow ending a session in the STOPPING state.
                 REQUIRE(XR_ERROR_SESSION_NOT_STOPPING == xrEndSession(session));
 
                 REQUIRE(XR_SUCCESS == xrRequestExitSession(session));
 
-                submitFramesUntilSessionState(instance, session, XR_SESSION_STATE_VISIBLE);
-                submitFramesUntilSessionState(instance, session, XR_SESSION_STATE_SYNCHRONIZED);
-                submitFramesUntilSessionState(instance, session, XR_SESSION_STATE_STOPPING);
+                submitFramesUntilSessionState(eventReader, session, XR_SESSION_STATE_VISIBLE);
+                submitFramesUntilSessionState(eventReader, session, XR_SESSION_STATE_SYNCHRONIZED);
+                submitFramesUntilSessionState(eventReader, session, XR_SESSION_STATE_STOPPING);
 
                 // Runtime should not transition from STOPPING to IDLE until the session has been ended.
                 // This will wait 1 second before assuming no such incorrect event will come.
-                REQUIRE_MSG(waitForNextSessionState(instance, &evt) == false, "Premature progression from STOPPING to IDLE state");
+                REQUIRE_MSG(waitForNextSessionState(eventReader, &evt) == false, "Premature progression from STOPPING to IDLE state");
 
                 REQUIRE(XR_SUCCESS == xrEndSession(session));
 
-                submitFramesUntilSessionState(instance, session, XR_SESSION_STATE_IDLE);
+                submitFramesUntilSessionState(eventReader, session, XR_SESSION_STATE_IDLE);
 
                 // https://registry.khronos.org/OpenXR/specs/1.1/html/xrspec.html#session-lifecycle
                 // If the runtime determines that its use of this XR session has
                 // concluded, it will transition the session state from
                 // XR_SESSION_STATE_IDLE to XR_SESSION_STATE_EXITING.
 
-                submitFramesUntilSessionState(instance, session, XR_SESSION_STATE_EXITING);
+                submitFramesUntilSessionState(eventReader, session, XR_SESSION_STATE_EXITING);
             }
 
             SECTION("Try calls out of turn")
@@ -169,7 +163,7 @@ namespace Conformance
                 // session might be in mystery unknown state before IDLE, IDLE, or READY.
 
                 INFO("Polling events until receiving IDLE");
-                REQUIRE(waitForNextSessionState(instance, &evt) == true);
+                REQUIRE(waitForNextSessionState(eventReader, &evt) == true);
                 REQUIRE(evt.state == XR_SESSION_STATE_IDLE);
 
                 SECTION("xrWaitFrame after polling session state IDLE")
@@ -183,7 +177,7 @@ namespace Conformance
                 // IDLE or READY.
 
                 INFO("Polling events until receiving READY");
-                REQUIRE(waitForNextSessionState(instance, &evt) == true);
+                REQUIRE(waitForNextSessionState(eventReader, &evt) == true);
                 REQUIRE(evt.state == XR_SESSION_STATE_READY);
 
                 SECTION("xrWaitFrame in READY")
@@ -201,7 +195,7 @@ namespace Conformance
                     // Runtime should not transition from READY to SYNCHRONIZED until one or more frames have been submitted.
                     // The exception is if the runtime is transitioning to STOPPING, which should not happen
                     // during conformance testing. This will wait 1 second before assuming no such incorrect event will come.
-                    REQUIRE_MSG(waitForNextSessionState(instance, &evt) == false, "Premature progression from READY to SYNCHRONIZED state");
+                    REQUIRE_MSG(waitForNextSessionState(eventReader, &evt) == false, "Premature progression from READY to SYNCHRONIZED state");
                 }
                 SECTION("Second call to xrBeginSession in READY")
                 {
@@ -209,21 +203,21 @@ namespace Conformance
                 }
 
                 // READY -> SYNCHRONIZED
-                submitFramesUntilSessionState(instance, session, XR_SESSION_STATE_SYNCHRONIZED);
+                submitFramesUntilSessionState(eventReader, session, XR_SESSION_STATE_SYNCHRONIZED);
                 SECTION("xrBeginSession in SYNCHRONIZED")
                 {
                     REQUIRE(XR_ERROR_SESSION_RUNNING == xrBeginSession(session, &beginInfo));
                 }
 
                 // SYNCHRONIZED -> VISIBLE
-                submitFramesUntilSessionState(instance, session, XR_SESSION_STATE_VISIBLE);
+                submitFramesUntilSessionState(eventReader, session, XR_SESSION_STATE_VISIBLE);
                 SECTION("xrBeginSession in VISIBLE")
                 {
                     REQUIRE(XR_ERROR_SESSION_RUNNING == xrBeginSession(session, &beginInfo));
                 }
 
                 // VISIBLE -> FOCUSED
-                submitFramesUntilSessionState(instance, session, XR_SESSION_STATE_FOCUSED);
+                submitFramesUntilSessionState(eventReader, session, XR_SESSION_STATE_FOCUSED);
                 SECTION("xrBeginSession in FOCUSED")
                 {
                     REQUIRE(XR_ERROR_SESSION_RUNNING == xrBeginSession(session, &beginInfo));
@@ -243,21 +237,21 @@ namespace Conformance
                 }
 
                 // FOCUSED -> VISIBLE
-                submitFramesUntilSessionState(instance, session, XR_SESSION_STATE_VISIBLE);
+                submitFramesUntilSessionState(eventReader, session, XR_SESSION_STATE_VISIBLE);
                 SECTION("xrBeginSession in VISIBLE due to xrRequestExitSession")
                 {
                     REQUIRE(XR_ERROR_SESSION_RUNNING == xrBeginSession(session, &beginInfo));
                 }
 
                 // VISIBLE -> SYNCHRONIZED
-                submitFramesUntilSessionState(instance, session, XR_SESSION_STATE_SYNCHRONIZED);
+                submitFramesUntilSessionState(eventReader, session, XR_SESSION_STATE_SYNCHRONIZED);
                 SECTION("xrBeginSession in SYNCHRONIZED due to xrRequestExitSession")
                 {
                     REQUIRE(XR_ERROR_SESSION_RUNNING == xrBeginSession(session, &beginInfo));
                 }
 
                 // SYNCHRONIZED -> STOPPING
-                submitFramesUntilSessionState(instance, session, XR_SESSION_STATE_STOPPING);
+                submitFramesUntilSessionState(eventReader, session, XR_SESSION_STATE_STOPPING);
                 SECTION("xrBeginSession in STOPPING due to xrRequestExitSession")
                 {
                     REQUIRE(XR_ERROR_SESSION_RUNNING == xrBeginSession(session, &beginInfo));
@@ -268,7 +262,7 @@ namespace Conformance
                         "Runtime should not transition from STOPPING to IDLE until the session has been ended. Wait 1s for incorrect event.");
                     // Runtime should not transition from STOPPING to IDLE until the session has been ended.
                     // This will wait 1 second before assuming no such incorrect event will come.
-                    REQUIRE(waitForNextSessionState(instance, &evt) == false);
+                    REQUIRE(waitForNextSessionState(eventReader, &evt) == false);
                 }
 
                 INFO("xrEndSession");
@@ -279,14 +273,14 @@ namespace Conformance
                     CHECK(XR_ERROR_SESSION_NOT_RUNNING == xrWaitFrame(session, nullptr, &frameState));
                 }
 
-                submitFramesUntilSessionState(instance, session, XR_SESSION_STATE_IDLE);
+                submitFramesUntilSessionState(eventReader, session, XR_SESSION_STATE_IDLE);
 
                 SECTION("xrWaitFrame in IDLE while shutting down")
                 {
                     CHECK(XR_ERROR_SESSION_NOT_RUNNING == xrWaitFrame(session, nullptr, &frameState));
                 }
 
-                submitFramesUntilSessionState(instance, session, XR_SESSION_STATE_EXITING);
+                submitFramesUntilSessionState(eventReader, session, XR_SESSION_STATE_EXITING);
 
                 SECTION("xrWaitFrame in EXITING while shutting down")
                 {
@@ -347,9 +341,97 @@ namespace Conformance
                 // This will wait 1 second before assuming no such incorrect event will come.
                 INFO("When using graphics, must not move from READY to SYNCHRONIZED without submittting frames.");
                 XrEventDataSessionStateChanged evt;
-                REQUIRE(waitForNextSessionState(instance, &evt) == false);
+                REQUIRE(waitForNextSessionState(eventReader, &evt) == false);
             }
         }
     }
 
+    // Cycles a session through xrBeginSession to FOCUSED, xrRequestExitSession to STOPPING and xrEndSession to IDLE, timing
+    // each state change from the call that leads to it until the application reads its XrEventDataSessionStateChanged.
+    // Events are read between frames while the session is running, as an application would, so the latency includes
+    // up to a frame of xrWaitFrame. A runtime that goes on from IDLE to EXITING, as it should when the application
+    // requested the exit, gets a new session for the next cycle, timed from xrCreateSession to READY.
+    TEST_CASE("SessionState_Transition_Benchmark", "[.][benchmark]")
+    {
+        using clock = std::chrono::steady_clock;
+        using ms = std::chrono::duration<double, std::milli>;
+
+        constexpr uint32_t cycleCount = 16;
+
+        AutoBasicInstance instance;
+        EventQueue eventQueue(instance);
+        EventReader eventReader(eventQueue);
+
+        XrSessionBeginInfo beginInfo{XR_TYPE_SESSION_BEGIN_INFO};
+        beginInfo.primaryViewConfigurationType = GetGlobalData().GetOptions().viewConfigurationValue;
+
+        // Latency samples keyed by the call and the state it led to
+        std::map<std::pair<std::string, XrSessionState>, std::vector<std::chrono::nanoseconds>> latencies;
+
+        // Read the next state change of @p session, submitting frames while it is running, and time it from @p callTime.
+        auto nextState = [&](XrSession session, bool running, const char* call, clock::time_point callTime) {
+            CountdownTimer countdown(30s);
+            while (!countdown.IsTimeUp()) {
+                XrEventDataSessionStateChanged evt;
+                const bool received =
+                    running ? tryGetNextSessionState(eventReader, &evt) : waitForNextSessionState(eventReader, &evt, 100ms);
+                if (received && evt.session == session) {
+                    latencies[{call, evt.state}].push_back(clock::now() - callTime);
+                    return evt.state;
+                }
+                if (running) {
+                    submitFrame(session);
+                }
+            }
+            FAIL("Timed out waiting for a session state change after " << call);
+            return XR_SESSION_STATE_UNKNOWN;
+        };
+        auto requireStates = [&](XrSession session, bool running, const char* call, clock::time_point callTime,
+                                 std::initializer_list<XrSessionState> expectedStates) {
+            for (XrSessionState expectedState : expectedStates) {
+                CAPTURE(call, expectedState);
+                REQUIRE(nextState(session, running, call, callTime) == expectedState);
+            }
+        };
+
+        AutoBasicSession session;
+        bool sessionReady = false;
+        for (uint32_t cycle = 0; cycle < cycleCount; ++cycle) {
+            CAPTURE(cycle);
+            if (!sessionReady) {
+                session.Shutdown();
+                const clock::time_point createTime = clock::now();
+                session.Init(AutoBasicSession::createSession, instance);
+                requireStates(session, false, "xrCreateSession", createTime, {XR_SESSION_STATE_IDLE, XR_SESSION_STATE_READY});
+            }
+
+            const clock::time_point beginTime = clock::now();
+            REQUIRE(XR_SUCCESS == xrBeginSession(session, &beginInfo));
+            requireStates(session, true, "xrBeginSession", beginTime,
+                          {XR_SESSION_STATE_SYNCHRONIZED, XR_SESSION_STATE_VISIBLE, XR_SESSION_STATE_FOCUSED});
+
+            const clock::time_point requestExitTime = clock::now();
+            REQUIRE(XR_SUCCESS == xrRequestExitSession(session));
+            requireStates(session, true, "xrRequestExitSession", requestExitTime,
+                          {XR_SESSION_STATE_VISIBLE, XR_SESSION_STATE_SYNCHRONIZED, XR_SESSION_STATE_STOPPING});
+
+            const clock::time_point endTime = clock::now();
+            REQUIRE(XR_SUCCESS == xrEndSession(session));
+            requireStates(session, false, "xrEndSession", endTime, {XR_SESSION_STATE_IDLE});
+
+            const XrSessionState afterIdle = nextState(session, false, "xrEndSession", endTime);
+            REQUIRE((afterIdle == XR_SESSION_STATE_READY || afterIdle == XR_SESSION_STATE_EXITING));
+            sessionReady = afterIdle == XR_SESSION_STATE_READY;
+        }
+        session.Shutdown();
+
+        for (auto& entry : latencies) {
+            const std::vector<MetricTag> tags{{"call", entry.first.first}, {"state", enum_to_string(entry.first.second)}};
+            const DurationPercentiles latency = DurationPercentiles::FromSamples(std::move(entry.second));
+            ReportMetric("SessionState.transitionLatency.p50", ms(latency.p50).count(), "ms", tags);
+            ReportMetric("SessionState.transitionLatency.p90", ms(latency.p90).count(), "ms", tags);
+            ReportMetric("SessionState.transitionLatency.max", ms(latency.max).count(), "ms", tags);
+        }
+    }
+
 }  // namespace Conformance
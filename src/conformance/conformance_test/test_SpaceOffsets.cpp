@@ -201,7 +201,7 @@ namespace Conformance
                 }
             }
             instructionsQuad = compositionHelper.CreateQuadLayer(
-                compositionHelper.CreateStaticSwapchainImage(CreateTextImage(1024, 780, oss.str().c_str(), 48)), localSpace, 1,
+                compositionHelper.CreateStaticSwapchainText(1024, 780, oss.str().c_str(), 48), localSpace, 1,
                 {Quat::Identity, {-1.5f, 0, -0.3f}});
             instructionsQuad->pose.orientation = Quat::FromAxisAngle(Up, DegToRad(70));
         };
@@ -565,15 +565,16 @@ namespace Conformance
                 const auto& views = std::get<std::vector<XrView>>(viewData);
 
                 // Render into each of the separate swapchains using the projection layer view fov and pose.
-                for (size_t view = 0; view < views.size(); view++) {
-                    compositionHelper.AcquireWaitReleaseImage(swapchains[view], [&](const XrSwapchainImageBaseHeader* swapchainImage) {
-                        GetGlobalData().graphicsPlugin->ClearImageSlice(swapchainImage);
-                        const_cast<XrFovf&>(projLayer->views[view].fov) = views[view].fov;
-                        const_cast<XrPosef&>(projLayer->views[view].pose) = views[view].pose;
-                        GetGlobalData().graphicsPlugin->RenderView(projLayer->views[view], swapchainImage,
-                                                                   RenderParams().Draw(cubes).Draw(meshes));
+                compositionHelper.AcquireWaitReleaseImages(
+                    swapchains, [&](const std::vector<const XrSwapchainImageBaseHeader*>& swapchainImages) {
+                        for (size_t view = 0; view < views.size(); view++) {
+                            GetGlobalData().graphicsPlugin->ClearImageSlice(swapchainImages[view]);
+                            const_cast<XrFovf&>(projLayer->views[view].fov) = views[view].fov;
+                            const_cast<XrPosef&>(projLayer->views[view].pose) = views[view].pose;
+                        }
+                        GetGlobalData().graphicsPlugin->RenderViews({projLayer->views, projLayer->viewCount}, swapchainImages,
+                                                                    RenderParams().Draw(cubes).Draw(meshes));
                     });
-                }
 
                 layers.push_back({reinterpret_cast<XrCompositionLayerBaseHeader*>(projLayer)});
             }
@@ -0,0 +1,152 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "conformance_utils.h"
+#include "report.h"
+#include "swapchain_image_data.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <openxr/openxr.h>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Conformance
+{
+    namespace
+    {
+        /// Stands in for a graphics-API-specific swapchain image struct.
+        struct FakeSwapchainImage
+        {
+            XrStructureType type;
+            void* XR_MAY_ALIAS next;
+            uint64_t image;
+        };
+
+        class FakeSwapchainImageData : public SwapchainImageDataBase<FakeSwapchainImage>
+        {
+        public:
+            FakeSwapchainImageData(uint32_t capacity)
+                : SwapchainImageDataBase(XR_TYPE_UNKNOWN, capacity, XrSwapchainCreateInfo{XR_TYPE_SWAPCHAIN_CREATE_INFO})
+            {
+            }
+
+        protected:
+            const FakeSwapchainImage& GetFallbackDepthSwapchainImage(uint32_t) override
+            {
+                return m_depthImage;
+            }
+
+        private:
+            FakeSwapchainImage m_depthImage{XR_TYPE_UNKNOWN};
+        };
+
+        /// Adopt one image data per entry of @p capacities, returning them in the same order.
+        std::vector<FakeSwapchainImageData*> AdoptAll(SwapchainImageDataMap<FakeSwapchainImageData>& map,
+                                                      const std::vector<uint32_t>& capacities)
+        {
+            std::vector<FakeSwapchainImageData*> datas;
+            for (uint32_t capacity : capacities) {
+                auto data = std::make_unique<FakeSwapchainImageData>(capacity);
+                datas.push_back(data.get());
+                map.Adopt(std::move(data));
+            }
+            return datas;
+        }
+    }  // namespace
+
+    TEST_CASE("SwapchainImageDataMap_Lookup", "[self_test]")
+    {
+        SwapchainImageDataMap<FakeSwapchainImageData> map;
+        const std::vector<uint32_t> capacities{3, 1, 4, 2};
+        const std::vector<FakeSwapchainImageData*> datas = AdoptAll(map, capacities);
+
+        for (size_t d = 0; d < datas.size(); ++d) {
+            for (uint32_t i = 0; i < capacities[d]; ++i) {
+                INFO("Image data " << d << ", image " << i);
+                const auto found = map.GetDataAndIndexFromBasePointer(datas[d]->GetGenericColorImage(i));
+                REQUIRE(found.first == datas[d]);
+                REQUIRE(found.second == i);
+            }
+        }
+
+        // Pointers that are not the start of an adopted color image are not found.
+        const auto* firstImage = reinterpret_cast<const char*>(datas[0]->GetGenericColorImage(0));
+        REQUIRE(map.GetDataAndIndexFromBasePointer(reinterpret_cast<const XrSwapchainImageBaseHeader*>(firstImage + 4)).first == nullptr);
+        REQUIRE(map.GetDataAndIndexFromBasePointer(datas[2]->GetDepthImageArray()).first == nullptr);
+        FakeSwapchainImage unrelated{XR_TYPE_UNKNOWN};
+        REQUIRE(map.GetDataAndIndexFromBasePointer(reinterpret_cast<const XrSwapchainImageBaseHeader*>(&unrelated)).first == nullptr);
+        REQUIRE(map.GetDataAndIndexFromBasePointer(nullptr).first == nullptr);
+
+        map.Clear();
+        REQUIRE(map.GetDataAndIndexFromBasePointer(reinterpret_cast<const XrSwapchainImageBaseHeader*>(firstImage)).first == nullptr);
+    }
+
+    TEST_CASE("SwapchainImageDataMap_Lookup_Benchmark", "[.][benchmark][self_test]")
+    {
+        using ns = std::chrono::duration<double, std::nano>;
+        constexpr int iterations = 1000000;
+
+        // A few swapchains of typical lengths, as a test with a projection layer and a couple of quads would have.
+        SwapchainImageDataMap<FakeSwapchainImageData> map;
+        const std::vector<FakeSwapchainImageData*> datas = AdoptAll(map, {3, 3, 3, 3});
+
+        std::vector<const XrSwapchainImageBaseHeader*> basePointers;
+        // The std::map of every base pointer that the lookup used before it was made range based.
+        std::map<const XrSwapchainImageBaseHeader*, std::pair<FakeSwapchainImageData*, uint32_t>> reference;
+        for (FakeSwapchainImageData* data : datas) {
+            for (uint32_t i = 0; i < data->GetCapacity(); ++i) {
+                basePointers.push_back(data->GetGenericColorImage(i));
+                reference[data->GetGenericColorImage(i)] = std::make_pair(data, i);
+            }
+        }
+
+        auto timeLookups = [&](auto&& lookup) {
+            uint32_t checksum = 0;
+            Stopwatch sw(true);
+            for (int i = 0; i < iterations; ++i) {
+                checksum += lookup(basePointers[i % basePointers.size()]).second;
+            }
+            const double perLookup = std::chrono::duration_cast<ns>(sw.Elapsed()).count() / iterations;
+            REQUIRE(checksum > 0);
+            return perLookup;
+        };
+
+        const double mapNs = timeLookups([&](const XrSwapchainImageBaseHeader* p) { return reference.find(p)->second; });
+        const double rangeNs = timeLookups([&](const XrSwapchainImageBaseHeader* p) { return map.GetDataAndIndexFromBasePointer(p); });
+
+        const std::vector<MetricTag> tags{{"images", std::to_string(basePointers.size())}};
+        ReportMetric("SwapchainImageDataMap.Lookup.map", mapNs, "ns", tags);
+        ReportMetric("SwapchainImageDataMap.Lookup.range", rangeNs, "ns", tags);
+
+        // The same lookups again under Catch2's harness, which also estimates the spread and classifies outliers.
+        size_t next = 0;
+        BENCHMARK("SwapchainImageDataMap.Lookup.map")
+        {
+            return reference.find(basePointers[next++ % basePointers.size()])->second;
+        };
+        BENCHMARK("SwapchainImageDataMap.Lookup.range")
+        {
+            return map.GetDataAndIndexFromBasePointer(basePointers[next++ % basePointers.size()]);
+        };
+    }
+}  // namespace Conformance
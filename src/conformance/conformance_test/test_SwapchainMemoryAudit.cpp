@@ -0,0 +1,87 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "report.h"
+#include "swapchain_memory_audit.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <openxr/openxr.h>
+
+#include <string>
+#include <vector>
+
+namespace Conformance
+{
+    namespace
+    {
+        XrSwapchain FakeSwapchain(uint64_t value)
+        {
+            return reinterpret_cast<XrSwapchain>(static_cast<uintptr_t>(value));
+        }
+
+        /// Take the metrics reported so far, and find the value of @p name tagged with @p kind.
+        double FindMetric(const std::vector<Metric>& metrics, const std::string& name, const std::string& kind)
+        {
+            for (const Metric& metric : metrics) {
+                if (metric.name == name && !metric.tags.empty() && metric.tags[0].value == kind) {
+                    return metric.value;
+                }
+            }
+            FAIL("Metric " << name << " [kind=" << kind << "] not reported");
+            return 0;
+        }
+    }  // namespace
+
+    TEST_CASE("SwapchainMemoryAudit", "[self_test]")
+    {
+        (void)TakeReportedMetrics();
+
+        SwapchainMemoryAudit audit;
+
+        SECTION("Nothing created reports nothing")
+        {
+            audit.Report();
+            REQUIRE(TakeReportedMetrics().empty());
+        }
+
+        SECTION("Totals and peaks")
+        {
+            audit.SwapchainCreated(FakeSwapchain(1), false, 100);
+            audit.SwapchainCreated(FakeSwapchain(2), true, 40);
+            audit.SwapchainDestroyed(FakeSwapchain(1));
+            audit.SwapchainCreated(FakeSwapchain(3), false, 30);
+            // Not recorded as created, so ignored.
+            audit.SwapchainDestroyed(FakeSwapchain(4));
+            audit.Report();
+
+            std::vector<Metric> metrics = TakeReportedMetrics();
+            CHECK(FindMetric(metrics, "swapchainMemory.peakBytes", "dynamic") == 100);
+            CHECK(FindMetric(metrics, "swapchainMemory.peakBytes", "static") == 40);
+            // 140 at once before the first dynamic swapchain was destroyed, not the sum of the two peaks.
+            CHECK(FindMetric(metrics, "swapchainMemory.peakBytes", "all") == 140);
+            CHECK(FindMetric(metrics, "swapchainMemory.createdBytes", "dynamic") == 130);
+            CHECK(FindMetric(metrics, "swapchainMemory.createdCount", "all") == 3);
+
+            // The next report starts from the swapchains still alive.
+            audit.SwapchainDestroyed(FakeSwapchain(2));
+            audit.Report();
+            metrics = TakeReportedMetrics();
+            CHECK(FindMetric(metrics, "swapchainMemory.peakBytes", "all") == 70);
+            CHECK(FindMetric(metrics, "swapchainMemory.createdCount", "all") == 0);
+        }
+    }
+}  // namespace Conformance
@@ -14,24 +14,35 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "RGBAImage.h"
+#include "composition_utils.h"
 #include "conformance_framework.h"
 #include "conformance_utils.h"
 #include "graphics_plugin.h"
 #include "matchers.h"
 #include "report.h"
 #include "swapchain_image_data.h"
+#include "utilities/array_size.h"
 #include "utilities/bitmask_to_string.h"
+#include "utilities/colors.h"
 #include "utilities/swapchain_parameters.h"
 #include "utilities/throw_helpers.h"
 #include "utilities/types_and_constants.h"
 #include "utilities/utils.h"
+#include "utilities/xr_math_operators.h"
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_vector.hpp>
 
 #include <openxr/openxr.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <string>
+#include <thread>
 #include <vector>
 
 XRC_DISABLE_MSVC_WARNING(4505)  // unreferenced local function has been removed
@@ -387,6 +398,48 @@ namespace Conformance
         return ret;
     }
 
+    /// One create info permutation of a format, and what happened when a worker thread created it.
+    struct ConcurrentSwapchainCase
+    {
+        size_t formatIndex;
+        std::string name;
+        XrSwapchainCreateInfo createInfo;
+        XrResult createResult{XR_RESULT_MAX_ENUM};
+        XrResult enumerateResult{XR_RESULT_MAX_ENUM};
+        XrResult destroyResult{XR_RESULT_MAX_ENUM};
+        uint32_t imageCount{0};
+        double createMilliseconds{0};
+    };
+
+    /// Create, enumerate the images of and destroy the swapchain of each of @p cases, spread over @p workerCount threads.
+    /// Makes no assertions, as Catch2 assertions are not thread-safe: the caller checks the recorded results.
+    static void RunConcurrentSwapchainCases(XrSession session, std::vector<ConcurrentSwapchainCase>& cases, uint32_t workerCount)
+    {
+        std::atomic<size_t> nextCase{0};
+        auto worker = [&] {
+            for (size_t i = nextCase++; i < cases.size(); i = nextCase++) {
+                ConcurrentSwapchainCase& c = cases[i];
+                XrSwapchain swapchain{XR_NULL_HANDLE_CPP};
+                Stopwatch sw(true);
+                c.createResult = xrCreateSwapchain(session, &c.createInfo, &swapchain);
+                c.createMilliseconds = std::chrono::duration<double, std::milli>(sw.Elapsed()).count();
+                if (XR_SUCCEEDED(c.createResult)) {
+                    c.enumerateResult = xrEnumerateSwapchainImages(swapchain, 0, &c.imageCount, nullptr);
+                    c.destroyResult = xrDestroySwapchain(swapchain);
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (uint32_t i = 1; i < workerCount; ++i) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+
     TEST_CASE("Swapchains", "")
     {
         const GlobalData& globalData = GetGlobalData();
@@ -454,6 +507,78 @@ namespace Conformance
                     // At this point, session.viewConfigurationViewVector has the system's set of view configurations,
                     // and imageFormatArray has the supported set of image formats.
 
+                    // With --swapchainCreateWorkers, every create info permutation of every format is created, enumerated and
+                    // destroyed from a pool of threads here, and the test of each format below only exercises the images of the
+                    // permutations with non-default create flags, which change what acquiring may do.
+                    const bool concurrentCreation =
+                        globalData.options.swapchainCreateWorkers > 1 && globalData.graphicsPlugin->CanCreateSwapchainsConcurrently();
+                    if (concurrentCreation) {
+                        SECTION("Concurrent swapchain creation")
+                        {
+                            std::vector<std::string> formatNames;
+                            std::vector<ConcurrentSwapchainCase> cases;
+                            for (int64_t imageFormat : imageFormatArray) {
+                                SwapchainCreateTestParameters tp;
+                                REQUIRE(globalData.graphicsPlugin->GetSwapchainCreateTestParameters(imageFormat, &tp));
+                                if (!tp.colorFormat && !tp.useAsDepth) {
+                                    continue;
+                                }
+                                for (const auto& nameAndCreateInfo : MakeSwapchainCreateInfoCases(session, imageFormat, tp)) {
+                                    cases.push_back({formatNames.size(), nameAndCreateInfo.first, nameAndCreateInfo.second});
+                                }
+                                formatNames.push_back(tp.imageFormatName);
+                            }
+
+                            Stopwatch sweepTime(true);
+                            RunConcurrentSwapchainCases(session, cases, globalData.options.swapchainCreateWorkers);
+                            const double sweepMilliseconds = std::chrono::duration<double, std::milli>(sweepTime.Elapsed()).count();
+                            globalData.graphicsPlugin->ClearSwapchainCache();
+                            globalData.graphicsPlugin->Flush();
+
+                            for (const ConcurrentSwapchainCase& c : cases) {
+                                INFO("Format " << formatNames[c.formatIndex] << ", XrSwapchainCreateInfo case: " << c.name);
+                                // A runtime is allowed to fail swapchain creation due to a unsupported creation flag.
+                                REQUIRE_THAT(c.createResult, In<XrResult>({XR_SUCCESS, XR_ERROR_FEATURE_UNSUPPORTED}));
+                                if (XR_SUCCEEDED(c.createResult)) {
+                                    CHECK(c.enumerateResult == XR_SUCCESS);
+                                    CHECK(c.imageCount > 0);
+                                    CHECK_RESULT_SUCCEEDED(c.destroyResult);
+                                }
+                            }
+
+                            ReportF("    %-40s %6s %12s %10s %10s %10s", "format", "cases", "unsupported", "min ms", "mean ms", "max ms");
+                            for (size_t formatIndex = 0; formatIndex < formatNames.size(); ++formatIndex) {
+                                int caseCount = 0;
+                                int unsupportedCount = 0;
+                                double minMilliseconds = 0;
+                                double maxMilliseconds = 0;
+                                double sumMilliseconds = 0;
+                                for (const ConcurrentSwapchainCase& c : cases) {
+                                    if (c.formatIndex != formatIndex) {
+                                        continue;
+                                    }
+                                    if (c.createResult == XR_ERROR_FEATURE_UNSUPPORTED) {
+                                        unsupportedCount++;
+                                    }
+                                    minMilliseconds = (caseCount == 0) ? c.createMilliseconds : std::min(minMilliseconds, c.createMilliseconds);
+                                    maxMilliseconds = std::max(maxMilliseconds, c.createMilliseconds);
+                                    sumMilliseconds += c.createMilliseconds;
+                                    caseCount++;
+                                }
+                                if (caseCount == 0) {
+                                    continue;
+                                }
+                                const double meanMilliseconds = sumMilliseconds / caseCount;
+                                ReportF("    %-40s %6d %12d %10.3f %10.3f %10.3f", formatNames[formatIndex].c_str(), caseCount, unsupportedCount,
+                                        minMilliseconds, meanMilliseconds, maxMilliseconds);
+                                ReportMetric("Swapchains.createLatency", meanMilliseconds, "ms", {{"format", formatNames[formatIndex]}});
+                            }
+                            ReportMetric("Swapchains.concurrentCreationTime", sweepMilliseconds, "ms",
+                                         {{"workers", std::to_string(globalData.options.swapchainCreateWorkers)},
+                                          {"cases", std::to_string(cases.size())}});
+                        }
+                    }
+
                     // xrCreateSwapchain / xrDestroySwapchain
                     // session.viewConfigurationViewVector may have more than one entry, and each entry has different
                     // values for recommended and max sizes/counts. There's currently no association with a
@@ -477,6 +602,10 @@ namespace Conformance
                             for (const auto& nameAndCreateInfo : MakeSwapchainCreateInfoCases(session, imageFormat, tp)) {
                                 INFO("XrSwapchainCreateInfo case: " << nameAndCreateInfo.first);
                                 auto createInfo = nameAndCreateInfo.second;
+                                if (concurrentCreation && createInfo.createFlags == tp.createFlagsVector[0]) {
+                                    // Already created concurrently above.
+                                    continue;
+                                }
                                 testSwapchainCreation(session, data, createInfo, tp);
                             }
                             ReportF("    %d cases tested (%d unsupported)", data.swapchainCreateCount, data.unsupportedCount);
@@ -686,4 +815,156 @@ namespace Conformance
 
         REQUIRE_RESULT_UNQUALIFIED_SUCCESS(xrDestroySwapchain(swapchain));
     }
+
+    /// Report percentiles of @p samples, and how many fall into each power-of-two microsecond bucket.
+    /// Only non-empty buckets are reported, each tagged with its upper bound.
+    static void ReportLatencyHistogram(const std::string& name, std::vector<std::chrono::nanoseconds> samples,
+                                       const std::vector<MetricTag>& tags)
+    {
+        using us = std::chrono::duration<double, std::micro>;
+        // The last bucket holds everything from 2^(kBucketCount - 2) us up.
+        constexpr size_t kBucketCount = 16;
+
+        std::array<uint32_t, kBucketCount> buckets{};
+        for (const std::chrono::nanoseconds& sample : samples) {
+            size_t bucket = 0;
+            for (double bound = 1.0; bucket + 1 < kBucketCount && us(sample).count() >= bound; bound *= 2) {
+                ++bucket;
+            }
+            buckets[bucket]++;
+        }
+        for (size_t bucket = 0; bucket < kBucketCount; ++bucket) {
+            if (buckets[bucket] == 0) {
+                continue;
+            }
+            std::vector<MetricTag> bucketTags = tags;
+            bucketTags.push_back({"upperBoundUs", bucket + 1 < kBucketCount ? std::to_string(1u << bucket) : "inf"});
+            ReportMetric(name + ".histogram", buckets[bucket], "count", bucketTags);
+        }
+
+        const DurationPercentiles percentiles = DurationPercentiles::FromSamples(std::move(samples));
+        ReportMetric(name + ".p50", us(percentiles.p50).count(), "us", tags);
+        ReportMetric(name + ".p90", us(percentiles.p90).count(), "us", tags);
+        ReportMetric(name + ".p99", us(percentiles.p99).count(), "us", tags);
+        ReportMetric(name + ".max", us(percentiles.max).count(), "us", tags);
+    }
+
+    // Latency of the swapchain image calls under steady frame submission, with several swapchains per frame.
+    // Every swapchain is cleared on the GPU each frame and submitted as a quad layer, as an application would.
+    TEST_CASE("SwapchainsAcquire_Latency_Benchmark", "[.][benchmark]")
+    {
+        GlobalData& globalData = GetGlobalData();
+        if (!globalData.IsUsingGraphicsPlugin()) {
+            SKIP("Cannot benchmark swapchains without a graphics plugin");
+        }
+        auto graphicsPlugin = globalData.GetGraphicsPlugin();
+
+        // Frames to let the pipeline fill before measuring, and frames measured.
+        constexpr uint32_t warmupFrameCount = 30;
+        constexpr uint32_t measuredFrameCount = 300;
+        const uint32_t swapchainCounts[] = {1, 2, 4, 8};
+        const XrColor4f colors[] = {Colors::Red, Colors::Green, Colors::Blue, Colors::Yellow};
+
+        for (uint32_t swapchainCount : swapchainCounts) {
+            CAPTURE(swapchainCount);
+            const std::vector<MetricTag> tags{{"graphicsPlugin", globalData.GetOptions().graphicsPlugin},
+                                              {"swapchains", std::to_string(swapchainCount)}};
+
+            CompositionHelper compositionHelper("Swapchain acquire latency");
+            const XrSpace viewSpace = compositionHelper.CreateReferenceSpace(XR_REFERENCE_SPACE_TYPE_VIEW);
+
+            std::vector<XrSwapchain> swapchains;
+            std::vector<XrCompositionLayerBaseHeader*> layers;
+            for (uint32_t i = 0; i < swapchainCount; ++i) {
+                const XrSwapchain swapchain = compositionHelper.CreateSwapchain(compositionHelper.DefaultColorSwapchainCreateInfo(256, 256));
+                swapchains.push_back(swapchain);
+                const XrPosef pose{openxr::math_operators::Quat::Identity, {-0.35f + 0.1f * i, 0, -1}};
+                layers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader*>(
+                    compositionHelper.CreateQuadLayer(swapchain, viewSpace, 0.08f, pose)));
+            }
+
+            compositionHelper.BeginSession();
+
+            uint32_t frameIndex = 0;
+            auto updateLayers = [&](const XrFrameState& frameState) {
+                if (frameIndex == warmupFrameCount) {
+                    compositionHelper.SetSwapchainCallTiming(true);
+                }
+                compositionHelper.AcquireWaitReleaseImages(swapchains, [&](const std::vector<const XrSwapchainImageBaseHeader*>& images) {
+                    for (size_t i = 0; i < images.size(); ++i) {
+                        graphicsPlugin->ClearImageSlice(images[i], 0, colors[(frameIndex + i) % ArraySize(colors)]);
+                    }
+                });
+                compositionHelper.EndFrame(frameState.predictedDisplayTime, layers);
+                return ++frameIndex < warmupFrameCount + measuredFrameCount;
+            };
+            RenderLoop(compositionHelper.GetSession(), updateLayers).Loop();
+
+            compositionHelper.SetSwapchainCallTiming(false);
+            CompositionHelper::SwapchainCallLatencies latencies = compositionHelper.TakeSwapchainCallLatencies();
+            REQUIRE(latencies.acquire.size() == size_t(measuredFrameCount) * swapchainCount);
+
+            ReportLatencyHistogram("xrAcquireSwapchainImage.latency", std::move(latencies.acquire), tags);
+            ReportLatencyHistogram("xrWaitSwapchainImage.latency", std::move(latencies.wait), tags);
+            ReportLatencyHistogram("xrReleaseSwapchainImage.latency", std::move(latencies.release), tags);
+        }
+    }
+
+    // Latency of filling a static image swapchain from an RGBAImage, as the composition tests do for every quad they show.
+    // Static image swapchains can only be acquired once, so each sample creates a new one.
+    TEST_CASE("SwapchainsStaticImageUpload_Benchmark", "[.][benchmark]")
+    {
+        GlobalData& globalData = GetGlobalData();
+        if (!globalData.IsUsingGraphicsPlugin()) {
+            SKIP("Cannot benchmark swapchain uploads without a graphics plugin");
+        }
+        auto graphicsPlugin = globalData.GetGraphicsPlugin();
+
+        constexpr uint32_t warmupSampleCount = 3;
+        constexpr uint32_t measuredSampleCount = 30;
+        const int imageSizes[] = {256, 1024, 2048};
+
+        CompositionHelper compositionHelper("Static image upload latency");
+        const int64_t format = graphicsPlugin->GetSRGBA8Format();
+
+        for (int imageSize : imageSizes) {
+            CAPTURE(imageSize);
+            const std::vector<MetricTag> tags{{"graphicsPlugin", globalData.GetOptions().graphicsPlugin},
+                                              {"size", std::to_string(imageSize)}};
+
+            RGBAImage image(imageSize, imageSize);
+            image.DrawRect(0, 0, imageSize, imageSize, Colors::Blue);
+            image.DrawRect(imageSize / 4, imageSize / 4, imageSize / 2, imageSize / 2, Colors::Yellow);
+            image.ConvertToSRGB();
+
+            XrSwapchainCreateInfo createInfo =
+                compositionHelper.DefaultColorSwapchainCreateInfo(imageSize, imageSize, XR_SWAPCHAIN_CREATE_STATIC_IMAGE_BIT, format);
+            createInfo.usageFlags |= XR_SWAPCHAIN_USAGE_TRANSFER_DST_BIT;
+
+            // The copy alone, and the copy with the acquire, wait and release around it.
+            std::vector<std::chrono::nanoseconds> copySamples;
+            std::vector<std::chrono::nanoseconds> uploadSamples;
+            for (uint32_t sample = 0; sample < warmupSampleCount + measuredSampleCount; ++sample) {
+                const XrSwapchain swapchain = compositionHelper.CreateSwapchain(createInfo);
+
+                std::chrono::nanoseconds copyDuration{0};
+                const auto uploadStart = std::chrono::steady_clock::now();
+                compositionHelper.AcquireWaitReleaseImage(swapchain, [&](const XrSwapchainImageBaseHeader* swapchainImage) {
+                    const auto copyStart = std::chrono::steady_clock::now();
+                    graphicsPlugin->CopyRGBAImage(swapchainImage, 0, image);
+                    copyDuration = std::chrono::steady_clock::now() - copyStart;
+                });
+                const std::chrono::nanoseconds uploadDuration = std::chrono::steady_clock::now() - uploadStart;
+
+                compositionHelper.DestroySwapchain(swapchain);
+                if (sample >= warmupSampleCount) {
+                    copySamples.push_back(copyDuration);
+                    uploadSamples.push_back(uploadDuration);
+                }
+            }
+
+            ReportLatencyHistogram("staticImageUpload.copyLatency", std::move(copySamples), tags);
+            ReportLatencyHistogram("staticImageUpload.latency", std::move(uploadSamples), tags);
+        }
+    }
 }  // namespace Conformance
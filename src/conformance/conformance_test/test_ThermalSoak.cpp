@@ -0,0 +1,352 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "asset_prefetch.h"
+#include "composition_utils.h"
+#include "conformance_framework.h"
+#include "conformance_utils.h"
+#include "gltf_helpers.h"
+#include "graphics_plugin.h"
+#include "report.h"
+#include "utilities/event_reader.h"
+#include "utilities/throw_helpers.h"
+#include "utilities/xr_math_operators.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <openxr/openxr.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace Conformance
+{
+    using namespace openxr::math_operators;
+
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+        using ms = std::chrono::duration<double, std::milli>;
+        using seconds = std::chrono::duration<double>;
+
+        constexpr const char* SoakGpuTimerScope = "ThermalSoak";
+
+        /// Frame timing and thermal state over one reporting window of the soak.
+        struct SoakWindow
+        {
+            seconds start{0};
+            std::vector<std::chrono::nanoseconds> frameTimes;
+            std::vector<std::chrono::nanoseconds> gpuTimes;
+            uint32_t frameCount{0};
+            uint32_t missedFrameCount{0};
+            uint32_t perfSettingsEventCount{0};
+            XrPerfSettingsNotificationLevelEXT cpuThermalLevel{XR_PERF_SETTINGS_NOTIF_LEVEL_NORMAL_EXT};
+            XrPerfSettingsNotificationLevelEXT gpuThermalLevel{XR_PERF_SETTINGS_NOTIF_LEVEL_NORMAL_EXT};
+            float cpuHeadroom{NAN};
+            float gpuHeadroom{NAN};
+        };
+
+        const char* PerfSettingsDomainName(XrPerfSettingsDomainEXT domain)
+        {
+            return domain == XR_PERF_SETTINGS_DOMAIN_CPU_EXT ? "cpu" : domain == XR_PERF_SETTINGS_DOMAIN_GPU_EXT ? "gpu" : "unknown";
+        }
+
+        const char* PerfSettingsSubDomainName(XrPerfSettingsSubDomainEXT subDomain)
+        {
+            switch (subDomain) {
+            case XR_PERF_SETTINGS_SUB_DOMAIN_COMPOSITING_EXT:
+                return "compositing";
+            case XR_PERF_SETTINGS_SUB_DOMAIN_RENDERING_EXT:
+                return "rendering";
+            case XR_PERF_SETTINGS_SUB_DOMAIN_THERMAL_EXT:
+                return "thermal";
+            default:
+                return "unknown";
+            }
+        }
+
+        const char* PerfSettingsLevelName(XrPerfSettingsNotificationLevelEXT level)
+        {
+            switch (level) {
+            case XR_PERF_SETTINGS_NOTIF_LEVEL_NORMAL_EXT:
+                return "normal";
+            case XR_PERF_SETTINGS_NOTIF_LEVEL_WARNING_EXT:
+                return "warning";
+            case XR_PERF_SETTINGS_NOTIF_LEVEL_IMPAIRED_EXT:
+                return "impaired";
+            default:
+                return "unknown";
+            }
+        }
+
+        void ReportSoakWindow(const char* phase, const SoakWindow& window)
+        {
+            const DurationPercentiles frameTime = DurationPercentiles::FromSamples(window.frameTimes);
+            const DurationPercentiles gpuTime = DurationPercentiles::FromSamples(window.gpuTimes);
+            const std::vector<MetricTag> tags{{"phase", phase}, {"elapsed", std::to_string(std::lround(window.start.count()))}};
+            ReportMetric("soak.frameTime", ms(frameTime.p50).count(), "ms", tags);
+            ReportMetric("soak.frameTimeP99", ms(frameTime.p99).count(), "ms", tags);
+            ReportMetric("soak.missedFrames", window.missedFrameCount, "count", tags);
+            ReportMetric("soak.frames", window.frameCount, "count", tags);
+            if (!window.gpuTimes.empty()) {
+                ReportMetric("soak.gpuTime", ms(gpuTime.p50).count(), "ms", tags);
+            }
+            if (!std::isnan(window.cpuHeadroom)) {
+                ReportMetric("soak.cpuThermalLevel", window.cpuThermalLevel, "level", tags);
+                ReportMetric("soak.gpuThermalLevel", window.gpuThermalLevel, "level", tags);
+                ReportMetric("soak.cpuThermalHeadroom", window.cpuHeadroom, "C", tags);
+                ReportMetric("soak.gpuThermalHeadroom", window.gpuHeadroom, "C", tags);
+            }
+        }
+    }  // namespace
+
+    static const AssetPrefetchRegistration g_thermalSoakAssets("Thermal_Soak_Benchmark", {}, {"MetalRoughSpheres.glb"});
+
+    // Not a conformance requirement: holds a steady glTF rendering load for --soakDuration seconds and records how frame
+    // timing, thermal state and XR_EXT_performance_settings notifications change as the device heats up. Standalone devices
+    // throttle after minutes of load, which is when frame pacing problems tend to appear.
+    //
+    // The load is calibrated first: the number of glTF models drawn is adjusted until the GPU is busy for --soakGpuLoad
+    // percent of the display period, and then held for the rest of the run, so that throttling shows up as longer GPU and
+    // frame times rather than being absorbed by the calibration.
+    TEST_CASE("Thermal_Soak_Benchmark", "[.][benchmark][soak]")
+    {
+        GlobalData& globalData = GetGlobalData();
+        if (!globalData.IsUsingGraphicsPlugin()) {
+            SKIP("Cannot soak the GPU without a graphics plugin");
+        }
+        IGraphicsPlugin& graphicsPlugin = *globalData.graphicsPlugin;
+
+        std::vector<const char*> extensions;
+        const bool thermalQuery = globalData.IsInstanceExtensionSupported(XR_EXT_THERMAL_QUERY_EXTENSION_NAME);
+        if (thermalQuery) {
+            extensions.push_back(XR_EXT_THERMAL_QUERY_EXTENSION_NAME);
+        }
+        if (globalData.IsInstanceExtensionSupported(XR_EXT_PERFORMANCE_SETTINGS_EXTENSION_NAME)) {
+            extensions.push_back(XR_EXT_PERFORMANCE_SETTINGS_EXTENSION_NAME);
+        }
+
+        CompositionHelper compositionHelper("Thermal Soak Benchmark", extensions);
+        const XrSession session = compositionHelper.GetSession();
+        EventReader eventReader(compositionHelper.GetEventQueue());
+        compositionHelper.GetInteractionManager().AttachActionSets();
+        compositionHelper.BeginSession();
+
+        PFN_xrThermalGetTemperatureTrendEXT xrThermalGetTemperatureTrendEXT_ = nullptr;
+        if (thermalQuery) {
+            xrThermalGetTemperatureTrendEXT_ = GetInstanceExtensionFunction<PFN_xrThermalGetTemperatureTrendEXT>(
+                compositionHelper.GetInstance(), "xrThermalGetTemperatureTrendEXT");
+        }
+
+        SimpleProjectionLayerHelper simpleProjectionLayerHelper(compositionHelper);
+
+        const GLTFModelHandle model = graphicsPlugin.LoadGLTF(LoadGLTFFile("MetalRoughSpheres.glb"));
+        std::vector<GLTFModelInstanceHandle> modelInstances;
+        std::vector<GLTFDrawable> drawables;
+        // Models overlap in a block in front of the viewer, so that each one adds shading work to the same pixels.
+        auto setModelCount = [&](size_t count) {
+            while (modelInstances.size() < count) {
+                modelInstances.push_back(graphicsPlugin.CreateGLTFModelInstance(model));
+            }
+            drawables.clear();
+            for (size_t i = 0; i < count; ++i) {
+                const float x = static_cast<float>(i % 4) * 0.2f - 0.3f;
+                const float y = static_cast<float>((i / 4) % 4) * 0.2f - 0.3f;
+                const float z = -1.5f - static_cast<float>(i / 16) * 0.05f;
+                drawables.emplace_back(modelInstances[i], XrPosef{Quat::Identity, {x, y, z}}, XrVector3f{0.1f, 0.1f, 0.1f});
+            }
+        };
+
+        const bool gpuTimers = graphicsPlugin.SupportsGpuTimers();
+        if (!gpuTimers) {
+            WARN("Graphics plugin cannot time the GPU: calibrating the load on missed frames instead of GPU time");
+        }
+        const double targetLoad = globalData.GetOptions().soakGpuLoad / 100.0;
+        const seconds soakDuration{globalData.GetOptions().soakDuration};
+        constexpr seconds calibrationDuration{10};
+        constexpr seconds calibrationStep{0.5};
+        constexpr seconds windowDuration{10};
+        constexpr size_t maxModelCount = 1024;
+
+        size_t modelCount = 1;
+        setModelCount(modelCount);
+
+        std::vector<GpuTimerSample> gpuTimerSamples;
+        std::vector<SoakWindow> windows;
+        SoakWindow window;
+        SoakWindow calibrationWindow;
+        const std::vector<XrCompositionLayerBaseHeader*> noLayers;
+        std::vector<XrCompositionLayerBaseHeader*> layers;
+
+        const Clock::time_point calibrationStart = Clock::now();
+        Clock::time_point soakStart{};
+        Clock::time_point nextStep = calibrationStart + std::chrono::duration_cast<Clock::duration>(calibrationStep);
+        Clock::time_point windowEnd{};
+        Clock::time_point lastWaitEnd{};
+        XrTime lastDisplayTime = 0;
+        XrDuration displayPeriod = 0;
+        bool calibrating = true;
+
+        for (;;) {
+            const Clock::time_point now = Clock::now();
+            if (!calibrating && now - soakStart >= soakDuration) {
+                break;
+            }
+
+            compositionHelper.PollEvents();
+            XrEventDataBuffer eventBuffer;
+            while (eventReader.TryReadNext(eventBuffer)) {
+                if (eventBuffer.type != XR_TYPE_EVENT_DATA_PERF_SETTINGS_EXT) {
+                    continue;
+                }
+                const auto& perfSettings = *reinterpret_cast<const XrEventDataPerfSettingsEXT*>(&eventBuffer);
+                const double elapsed = calibrating ? 0.0 : seconds(now - soakStart).count();
+                ReportConsoleOnlyF("%.1fs: %s %s performance %s -> %s", elapsed, PerfSettingsDomainName(perfSettings.domain),
+                                   PerfSettingsSubDomainName(perfSettings.subDomain), PerfSettingsLevelName(perfSettings.fromLevel),
+                                   PerfSettingsLevelName(perfSettings.toLevel));
+                ReportMetric("soak.perfSettingsLevel", perfSettings.toLevel, "level",
+                             {{"domain", PerfSettingsDomainName(perfSettings.domain)},
+                              {"subDomain", PerfSettingsSubDomainName(perfSettings.subDomain)},
+                              {"elapsed", std::to_string(std::lround(elapsed))}});
+                (calibrating ? calibrationWindow : window).perfSettingsEventCount++;
+            }
+
+            XrFrameState frameState{XR_TYPE_FRAME_STATE};
+            XRC_CHECK_THROW_XRCMD(xrWaitFrame(session, nullptr, &frameState));
+            const Clock::time_point waitEnd = Clock::now();
+            XRC_CHECK_THROW_XRCMD(xrBeginFrame(session, nullptr));
+
+            layers.clear();
+            if (frameState.shouldRender) {
+                graphicsPlugin.BeginGpuTimerScope(SoakGpuTimerScope);
+                if (XrCompositionLayerBaseHeader* projLayer =
+                        simpleProjectionLayerHelper.TryGetUpdatedProjectionLayer(frameState, RenderParams{}.Draw(drawables))) {
+                    layers.push_back(projLayer);
+                }
+                graphicsPlugin.EndGpuTimerScope();
+            }
+            compositionHelper.EndFrame(frameState.predictedDisplayTime, frameState.shouldRender ? layers : noLayers);
+
+            SoakWindow& current = calibrating ? calibrationWindow : window;
+            if (lastDisplayTime != 0) {
+                current.frameTimes.push_back(waitEnd - lastWaitEnd);
+                current.frameCount++;
+                if (frameState.predictedDisplayTime - lastDisplayTime > frameState.predictedDisplayPeriod * 3 / 2) {
+                    current.missedFrameCount++;
+                }
+            }
+            lastWaitEnd = waitEnd;
+            lastDisplayTime = frameState.predictedDisplayTime;
+            displayPeriod = frameState.predictedDisplayPeriod;
+
+            gpuTimerSamples.clear();
+            graphicsPlugin.CollectGpuTimerSamples(gpuTimerSamples);
+            for (const GpuTimerSample& sample : gpuTimerSamples) {
+                if (std::strcmp(sample.name, SoakGpuTimerScope) == 0) {
+                    current.gpuTimes.push_back(sample.duration);
+                }
+            }
+
+            if (calibrating && waitEnd >= nextStep) {
+                // Scale the model count towards the target GPU time, or without GPU timers, grow it until frames are missed.
+                size_t nextModelCount = modelCount;
+                if (gpuTimers && !calibrationWindow.gpuTimes.empty()) {
+                    const DurationPercentiles gpuTime = DurationPercentiles::FromSamples(calibrationWindow.gpuTimes);
+                    const double ratio = targetLoad * displayPeriod / std::max<double>(gpuTime.p50.count(), 1.0);
+                    nextModelCount = static_cast<size_t>(std::lround(modelCount * std::min(std::max(ratio, 0.5), 2.0)));
+                }
+                else if (!gpuTimers) {
+                    nextModelCount = calibrationWindow.missedFrameCount == 0 ? modelCount + modelCount / 4 + 1
+                                                                             : modelCount - modelCount / 4;
+                }
+                modelCount = std::min(std::max<size_t>(nextModelCount, 1), maxModelCount);
+                setModelCount(modelCount);
+                calibrationWindow = SoakWindow{};
+                nextStep = waitEnd + std::chrono::duration_cast<Clock::duration>(calibrationStep);
+
+                if (waitEnd - calibrationStart >= calibrationDuration) {
+                    if (!gpuTimers) {
+                        // The count that just misses frames is roughly a full display period of work.
+                        modelCount = std::max<size_t>(static_cast<size_t>(std::lround(modelCount * targetLoad)), 1);
+                        setModelCount(modelCount);
+                    }
+                    ReportConsoleOnlyF("Soaking with %zu glTF model(s) for %.0fs", modelCount, soakDuration.count());
+                    ReportMetric("soak.modelCount", static_cast<double>(modelCount), "count");
+                    calibrating = false;
+                    soakStart = waitEnd;
+                    windowEnd = soakStart + std::chrono::duration_cast<Clock::duration>(windowDuration);
+                    window = SoakWindow{};
+                }
+            }
+            else if (!calibrating && waitEnd >= windowEnd) {
+                if (xrThermalGetTemperatureTrendEXT_ != nullptr) {
+                    float slope = 0.0f;
+                    XRC_CHECK_THROW_XRCMD(xrThermalGetTemperatureTrendEXT_(session, XR_PERF_SETTINGS_DOMAIN_CPU_EXT,
+                                                                           &window.cpuThermalLevel, &window.cpuHeadroom, &slope));
+                    XRC_CHECK_THROW_XRCMD(xrThermalGetTemperatureTrendEXT_(session, XR_PERF_SETTINGS_DOMAIN_GPU_EXT,
+                                                                           &window.gpuThermalLevel, &window.gpuHeadroom, &slope));
+                }
+
+                const DurationPercentiles frameTime = DurationPercentiles::FromSamples(window.frameTimes);
+                const DurationPercentiles gpuTime = DurationPercentiles::FromSamples(window.gpuTimes);
+                ReportConsoleOnlyF("%5.0fs: frame time p50/p99 %.3f / %.3fms, gpu p50 %.3fms, %u missed frame(s), thermal cpu %s gpu %s",
+                                   window.start.count(), ms(frameTime.p50).count(), ms(frameTime.p99).count(), ms(gpuTime.p50).count(),
+                                   window.missedFrameCount, PerfSettingsLevelName(window.cpuThermalLevel),
+                                   PerfSettingsLevelName(window.gpuThermalLevel));
+                ReportSoakWindow("window", window);
+
+                windows.push_back(std::move(window));
+                window = SoakWindow{};
+                window.start = waitEnd - soakStart;
+                windowEnd = waitEnd + std::chrono::duration_cast<Clock::duration>(windowDuration);
+            }
+        }
+
+        if (window.frameCount != 0) {
+            windows.push_back(std::move(window));
+        }
+        REQUIRE_FALSE(windows.empty());
+
+        // Sustained performance relative to the first window, after the same amount of work has been running for a while.
+        const SoakWindow& initial = windows.front();
+        const SoakWindow& sustained = windows.back();
+        ReportSoakWindow("initial", initial);
+        ReportSoakWindow("sustained", sustained);
+
+        const DurationPercentiles initialFrameTime = DurationPercentiles::FromSamples(initial.frameTimes);
+        const DurationPercentiles sustainedFrameTime = DurationPercentiles::FromSamples(sustained.frameTimes);
+        const double frameTimeRatio = ms(sustainedFrameTime.p50).count() / std::max(ms(initialFrameTime.p50).count(), 1e-3);
+        ReportMetric("soak.sustainedFrameTimeRatio", frameTimeRatio, "ratio");
+        if (!initial.gpuTimes.empty() && !sustained.gpuTimes.empty()) {
+            const double gpuTimeRatio = ms(DurationPercentiles::FromSamples(sustained.gpuTimes).p50).count() /
+                                        std::max(ms(DurationPercentiles::FromSamples(initial.gpuTimes).p50).count(), 1e-3);
+            ReportMetric("soak.sustainedGpuTimeRatio", gpuTimeRatio, "ratio");
+        }
+
+        uint32_t perfSettingsEventCount = 0;
+        for (const SoakWindow& w : windows) {
+            perfSettingsEventCount += w.perfSettingsEventCount;
+        }
+        ReportMetric("soak.perfSettingsEvents", perfSettingsEventCount, "count");
+        ReportConsoleOnlyF("Sustained vs. initial: frame time p50 %.3f -> %.3fms (x%.2f), missed frames %u -> %u per window, %u "
+                           "performance settings notification(s)",
+                           ms(initialFrameTime.p50).count(), ms(sustainedFrameTime.p50).count(), frameTimeRatio, initial.missedFrameCount,
+                           sustained.missedFrameCount, perfSettingsEventCount);
+    }
+}  // namespace Conformance
@@ -21,6 +21,8 @@
 #include "conformance_framework.h"
 #include "utilities/throw_helpers.h"
 #include "common/hex_and_handles.h"
+#include "report.h"
+#include "utilities/xr_math_operators.h"
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers.hpp>
@@ -29,6 +31,8 @@
 
 #include <algorithm>
 #include <array>
+#include <chrono>
+#include <initializer_list>
 #include <utility>
 #include <vector>
 #include <string>
@@ -1286,4 +1290,206 @@ namespace Conformance
 #undef CHK_XR
     }
 
+    TEST_CASE("XR_EXT_debug_utils-label-benchmark", "[.][benchmark][XR_EXT_debug_utils]")
+    {
+        using clock = std::chrono::steady_clock;
+        using us = std::chrono::duration<double, std::micro>;
+
+        GlobalData& globalData = GetGlobalData();
+        if (!globalData.IsInstanceExtensionSupported(XR_EXT_DEBUG_UTILS_EXTENSION_NAME)) {
+            SKIP(XR_EXT_DEBUG_UTILS_EXTENSION_NAME " not supported");
+        }
+
+        AutoBasicInstance instance({XR_EXT_DEBUG_UTILS_EXTENSION_NAME});
+        AutoBasicSession session(AutoBasicSession::createSession, instance);
+
+        auto pfnSessionBeginDebugUtilsLabelRegionEXT =
+            GetInstanceExtensionFunction<PFN_xrSessionBeginDebugUtilsLabelRegionEXT>(instance, "xrSessionBeginDebugUtilsLabelRegionEXT");
+        auto pfnSessionEndDebugUtilsLabelRegionEXT =
+            GetInstanceExtensionFunction<PFN_xrSessionEndDebugUtilsLabelRegionEXT>(instance, "xrSessionEndDebugUtilsLabelRegionEXT");
+        auto pfnSessionInsertDebugUtilsLabelEXT =
+            GetInstanceExtensionFunction<PFN_xrSessionInsertDebugUtilsLabelEXT>(instance, "xrSessionInsertDebugUtilsLabelEXT");
+
+        // Label the way an engine labels every frame: a frame region holding a region per pass, each with an individual label.
+        constexpr uint32_t frameCount = 2000;
+        constexpr uint32_t passCount = 4;
+        const char* const passNames[passCount] = {"Shadow pass", "Opaque pass", "Transparent pass", "Composition layer submission"};
+
+        std::vector<std::chrono::nanoseconds> beginSamples;
+        std::vector<std::chrono::nanoseconds> insertSamples;
+        std::vector<std::chrono::nanoseconds> endSamples;
+        beginSamples.reserve(frameCount * (passCount + 1));
+        insertSamples.reserve(frameCount * passCount);
+        endSamples.reserve(frameCount * (passCount + 1));
+
+        auto timeCall = [](std::vector<std::chrono::nanoseconds>& samples, auto&& call) {
+            const clock::time_point start = clock::now();
+            const XrResult result = call();
+            samples.push_back(clock::now() - start);
+            REQUIRE(result == XR_SUCCESS);
+        };
+
+        XrDebugUtilsLabelEXT label{XR_TYPE_DEBUG_UTILS_LABEL_EXT};
+        std::string frameName;
+        for (uint32_t frame = 0; frame < frameCount; ++frame) {
+            frameName = "Frame " + std::to_string(frame);
+            label.labelName = frameName.c_str();
+            timeCall(beginSamples, [&] { return pfnSessionBeginDebugUtilsLabelRegionEXT(session, &label); });
+            for (const char* passName : passNames) {
+                label.labelName = passName;
+                timeCall(beginSamples, [&] { return pfnSessionBeginDebugUtilsLabelRegionEXT(session, &label); });
+                label.labelName = "Draw";
+                timeCall(insertSamples, [&] { return pfnSessionInsertDebugUtilsLabelEXT(session, &label); });
+                timeCall(endSamples, [&] { return pfnSessionEndDebugUtilsLabelRegionEXT(session); });
+            }
+            timeCall(endSamples, [&] { return pfnSessionEndDebugUtilsLabelRegionEXT(session); });
+        }
+
+        auto reportCost = [](const char* command, std::vector<std::chrono::nanoseconds> samples) {
+            const DurationPercentiles cost = DurationPercentiles::FromSamples(std::move(samples));
+            const std::string prefix = std::string(command) + ".cost";
+            ReportMetric(prefix + ".p50", us(cost.p50).count(), "us");
+            ReportMetric(prefix + ".p99", us(cost.p99).count(), "us");
+            ReportMetric(prefix + ".max", us(cost.max).count(), "us");
+        };
+        reportCost("xrSessionBeginDebugUtilsLabelRegionEXT", std::move(beginSamples));
+        reportCost("xrSessionInsertDebugUtilsLabelEXT", std::move(insertSamples));
+        reportCost("xrSessionEndDebugUtilsLabelRegionEXT", std::move(endSamples));
+    }
+
+    static XRAPI_ATTR XrBool32 XRAPI_CALL countDebugUtilsMessages(XrDebugUtilsMessageSeverityFlagsEXT, XrDebugUtilsMessageTypeFlagsEXT,
+                                                                  const XrDebugUtilsMessengerCallbackDataEXT*, void* userData)
+    {
+        ++*reinterpret_cast<uint64_t*>(userData);
+        return XR_FALSE;
+    }
+
+    TEST_CASE("XR_EXT_debug_utils-message-benchmark", "[.][benchmark][XR_EXT_debug_utils]")
+    {
+        using clock = std::chrono::steady_clock;
+        using us = std::chrono::duration<double, std::micro>;
+
+        GlobalData& globalData = GetGlobalData();
+        if (!globalData.IsInstanceExtensionSupported(XR_EXT_DEBUG_UTILS_EXTENSION_NAME)) {
+            SKIP(XR_EXT_DEBUG_UTILS_EXTENSION_NAME " not supported");
+        }
+
+        AutoBasicInstance instance({XR_EXT_DEBUG_UTILS_EXTENSION_NAME});
+        AutoBasicSession session(AutoBasicSession::createSession, instance);
+
+        auto pfnCreateDebugUtilsMessengerEXT =
+            GetInstanceExtensionFunction<PFN_xrCreateDebugUtilsMessengerEXT>(instance, "xrCreateDebugUtilsMessengerEXT");
+        auto pfnDestroyDebugUtilsMessengerEXT =
+            GetInstanceExtensionFunction<PFN_xrDestroyDebugUtilsMessengerEXT>(instance, "xrDestroyDebugUtilsMessengerEXT");
+        auto pfnSubmitDebugUtilsMessageEXT =
+            GetInstanceExtensionFunction<PFN_xrSubmitDebugUtilsMessageEXT>(instance, "xrSubmitDebugUtilsMessageEXT");
+        auto pfnSetDebugUtilsObjectNameEXT =
+            GetInstanceExtensionFunction<PFN_xrSetDebugUtilsObjectNameEXT>(instance, "xrSetDebugUtilsObjectNameEXT");
+        auto pfnSessionBeginDebugUtilsLabelRegionEXT =
+            GetInstanceExtensionFunction<PFN_xrSessionBeginDebugUtilsLabelRegionEXT>(instance, "xrSessionBeginDebugUtilsLabelRegionEXT");
+        auto pfnSessionEndDebugUtilsLabelRegionEXT =
+            GetInstanceExtensionFunction<PFN_xrSessionEndDebugUtilsLabelRegionEXT>(instance, "xrSessionEndDebugUtilsLabelRegionEXT");
+
+        // Each message is delivered to every messenger, and augmented with the names of its objects and the open session labels,
+        // so its cost is expected to grow with all three.
+        const std::initializer_list<uint32_t> messengerCounts = {1, 4, 16};
+        const std::initializer_list<uint32_t> namedObjectCounts = {0, 16, 256};
+        const std::initializer_list<uint32_t> labelDepths = {0, 4, 16};
+        constexpr uint32_t messageCount = 500;
+
+        // Spaces serve as the named objects, destroyed along with the session.
+        // Names are only ever added, so sweep the named object count outermost.
+        std::vector<XrSpace> namedSpaces;
+        std::vector<std::string> spaceNames;
+
+        for (uint32_t namedObjectCount : namedObjectCounts) {
+            while (namedSpaces.size() < namedObjectCount) {
+                XrReferenceSpaceCreateInfo spaceCreateInfo{XR_TYPE_REFERENCE_SPACE_CREATE_INFO};
+                spaceCreateInfo.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_VIEW;  // view has to be supported
+                spaceCreateInfo.poseInReferenceSpace = openxr::math_operators::Pose::Identity;
+                XrSpace space = XR_NULL_HANDLE;
+                REQUIRE_RESULT(XR_SUCCESS, xrCreateReferenceSpace(session, &spaceCreateInfo, &space));
+                namedSpaces.push_back(space);
+
+                spaceNames.push_back("Named space " + std::to_string(namedSpaces.size()));
+                XrDebugUtilsObjectNameInfoEXT nameInfo{XR_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT};
+                nameInfo.objectType = XR_OBJECT_TYPE_SPACE;
+                nameInfo.objectHandle = MakeHandleGeneric(space);
+                nameInfo.objectName = spaceNames.back().c_str();
+                REQUIRE_RESULT(XR_SUCCESS, pfnSetDebugUtilsObjectNameEXT(instance, &nameInfo));
+            }
+
+            // Refer to the session and the most recently named space, so that the names are looked up.
+            std::vector<XrDebugUtilsObjectNameInfoEXT> objects{{XR_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT}};
+            objects[0].objectType = XR_OBJECT_TYPE_SESSION;
+            objects[0].objectHandle = MakeHandleGeneric(session.GetSession());
+            if (!namedSpaces.empty()) {
+                objects.push_back({XR_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT});
+                objects[1].objectType = XR_OBJECT_TYPE_SPACE;
+                objects[1].objectHandle = MakeHandleGeneric(namedSpaces.back());
+            }
+
+            XrDebugUtilsMessengerCallbackDataEXT callbackData{XR_TYPE_DEBUG_UTILS_MESSENGER_CALLBACK_DATA_EXT};
+            callbackData.messageId = "Benchmark Message";
+            callbackData.functionName = "MyTestFunctionName";
+            callbackData.message = "Benchmark Message";
+            callbackData.objectCount = static_cast<uint32_t>(objects.size());
+            callbackData.objects = objects.data();
+
+            for (uint32_t labelDepth : labelDepths) {
+                XrDebugUtilsLabelEXT label{XR_TYPE_DEBUG_UTILS_LABEL_EXT};
+                label.labelName = "Benchmark region";
+                for (uint32_t depth = 0; depth < labelDepth; ++depth) {
+                    REQUIRE_RESULT(XR_SUCCESS, pfnSessionBeginDebugUtilsLabelRegionEXT(session, &label));
+                }
+
+                for (uint32_t messengerCount : messengerCounts) {
+                    CAPTURE(namedObjectCount, labelDepth, messengerCount);
+
+                    uint64_t deliveredCount = 0;
+                    XrDebugUtilsMessengerCreateInfoEXT messengerCreateInfo{XR_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT};
+                    messengerCreateInfo.messageSeverities = XR_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT;
+                    messengerCreateInfo.messageTypes = XR_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT;
+                    messengerCreateInfo.userCallback = countDebugUtilsMessages;
+                    messengerCreateInfo.userData = &deliveredCount;
+
+                    // Destroyed along with the instance if the benchmark fails part way.
+                    std::vector<XrDebugUtilsMessengerEXT> messengers;
+                    for (uint32_t i = 0; i < messengerCount; ++i) {
+                        XrDebugUtilsMessengerEXT messenger = XR_NULL_HANDLE;
+                        REQUIRE_RESULT(XR_SUCCESS, pfnCreateDebugUtilsMessengerEXT(instance, &messengerCreateInfo, &messenger));
+                        messengers.push_back(messenger);
+                    }
+
+                    std::vector<std::chrono::nanoseconds> samples;
+                    samples.reserve(messageCount);
+                    for (uint32_t message = 0; message < messageCount; ++message) {
+                        const clock::time_point start = clock::now();
+                        const XrResult result = pfnSubmitDebugUtilsMessageEXT(instance, XR_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT,
+                                                                              XR_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT, &callbackData);
+                        samples.push_back(clock::now() - start);
+                        REQUIRE(result == XR_SUCCESS);
+                    }
+                    // Other components may log through the messengers as well, so only check that none of ours were lost.
+                    REQUIRE(deliveredCount >= uint64_t{messageCount} * messengerCount);
+                    for (XrDebugUtilsMessengerEXT messenger : messengers) {
+                        REQUIRE_RESULT(XR_SUCCESS, pfnDestroyDebugUtilsMessengerEXT(messenger));
+                    }
+
+                    const std::vector<MetricTag> tags{{"messengers", std::to_string(messengerCount)},
+                                                      {"namedObjects", std::to_string(namedObjectCount)},
+                                                      {"labelDepth", std::to_string(labelDepth)}};
+                    const DurationPercentiles cost = DurationPercentiles::FromSamples(std::move(samples));
+                    ReportMetric("xrSubmitDebugUtilsMessageEXT.cost.p50", us(cost.p50).count(), "us", tags);
+                    ReportMetric("xrSubmitDebugUtilsMessageEXT.cost.p99", us(cost.p99).count(), "us", tags);
+                    ReportMetric("xrSubmitDebugUtilsMessageEXT.cost.max", us(cost.max).count(), "us", tags);
+                }
+
+                for (uint32_t depth = 0; depth < labelDepth; ++depth) {
+                    REQUIRE_RESULT(XR_SUCCESS, pfnSessionEndDebugUtilsLabelRegionEXT(session));
+                }
+            }
+        }
+    }
+
 }  // namespace Conformance
@@ -18,12 +18,19 @@
 #include "conformance_utils.h"
 #include "conformance_framework.h"
 #include "composition_utils.h"
+#include "latency_probe.h"
+#include "report.h"
 #include "two_call.h"
 #include "utilities/utils.h"
 #include "utilities/system_properties_helper.h"
 #include "common/xr_linear.h"
 #include <catch2/catch_test_macros.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
 using namespace Conformance;
 
 namespace Conformance
@@ -450,7 +457,7 @@ namespace Conformance
 
             // Create the instructional quad layer placed to the left.
             XrCompositionLayerQuad* const instructionsQuad = compositionHelper.CreateQuadLayer(
-                compositionHelper.CreateStaticSwapchainImage(CreateTextImage(1024, 512, instructions, 48)), localSpace, 1.0f,
+                compositionHelper.CreateStaticSwapchainText(1024, 512, instructions, 48), localSpace, 1.0f,
                 {{0, 0, 0, 1}, {-1.5f, 0, -0.3f}});
             instructionsQuad->pose.orientation = Quat::FromAxisAngle(kVectorUp, DegToRad(70));
 
@@ -585,4 +592,176 @@ namespace Conformance
         }
     }
 
+    // Not a conformance requirement: foveated rendering depends on how fresh the gaze is. Locates the gaze action space at
+    // about 1kHz, on a thread of its own while frames are submitted, at the current time, and reports how old the
+    // XrEyeGazeSampleTimeEXT of each location was and how often a new sample arrived.
+    TEST_CASE("XR_EXT_eye_gaze_interaction-sample_freshness_Benchmark", "[XR_EXT_eye_gaze_interaction][.][benchmark]")
+    {
+        using Clock = std::chrono::steady_clock;
+        using ms = std::chrono::duration<double, std::milli>;
+        constexpr std::chrono::seconds measureDuration{10};
+
+        GlobalData& globalData = GetGlobalData();
+        if (!globalData.IsInstanceExtensionSupported(XR_EXT_EYE_GAZE_INTERACTION_EXTENSION_NAME)) {
+            SKIP(XR_EXT_EYE_GAZE_INTERACTION_EXTENSION_NAME " not supported");
+        }
+        const char* const timeConversionExtension = LatencyProbe::GetTimeConversionExtensionName();
+        if (timeConversionExtension == nullptr || !globalData.IsInstanceExtensionSupported(timeConversionExtension)) {
+            SKIP("No time conversion extension to read the XrTime clock with");
+        }
+
+        CompositionHelper compositionHelper("Eye gaze sample freshness",
+                                            {XR_EXT_EYE_GAZE_INTERACTION_EXTENSION_NAME, timeConversionExtension});
+        if (!SystemSupportsEyeGazeInteraction(compositionHelper.GetInstance(), compositionHelper.GetSystemId())) {
+            SKIP("System does not support eye gaze interaction");
+        }
+        const std::unique_ptr<LatencyProbe> clock = LatencyProbe::TryCreate(compositionHelper.GetInstance());
+        REQUIRE(clock != nullptr);
+
+        XrActionSet actionSet{XR_NULL_HANDLE};
+        XrAction gazeAction{XR_NULL_HANDLE};
+        {
+            XrActionSetCreateInfo actionSetInfo{XR_TYPE_ACTION_SET_CREATE_INFO};
+            strcpy(actionSetInfo.actionSetName, "eye_gaze_benchmark");
+            strcpy(actionSetInfo.localizedActionSetName, "Eye Gaze Benchmark");
+            REQUIRE_RESULT(XR_SUCCESS, xrCreateActionSet(compositionHelper.GetInstance(), &actionSetInfo, &actionSet));
+
+            XrActionCreateInfo actionInfo{XR_TYPE_ACTION_CREATE_INFO};
+            actionInfo.actionType = XR_ACTION_TYPE_POSE_INPUT;
+            strcpy(actionInfo.actionName, "eye_gaze_pose");
+            strcpy(actionInfo.localizedActionName, "Eye Gaze Pose");
+            REQUIRE_RESULT(XR_SUCCESS, xrCreateAction(actionSet, &actionInfo, &gazeAction));
+
+            const XrPath gazePath = StringToPath(compositionHelper.GetInstance(), kEyeGazeInteractionPoseInputPath);
+            const XrActionSuggestedBinding binding{gazeAction, gazePath};
+            XrInteractionProfileSuggestedBinding suggestedBindings{XR_TYPE_INTERACTION_PROFILE_SUGGESTED_BINDING};
+            suggestedBindings.interactionProfile = StringToPath(compositionHelper.GetInstance(), kEyeGazeInteractionProfilePath);
+            suggestedBindings.suggestedBindings = &binding;
+            suggestedBindings.countSuggestedBindings = 1;
+            REQUIRE_RESULT(XR_SUCCESS, xrSuggestInteractionProfileBindings(compositionHelper.GetInstance(), &suggestedBindings));
+
+            XrSessionActionSetsAttachInfo attachInfo{XR_TYPE_SESSION_ACTION_SETS_ATTACH_INFO};
+            attachInfo.actionSets = &actionSet;
+            attachInfo.countActionSets = 1;
+            REQUIRE_RESULT(XR_SUCCESS, xrAttachSessionActionSets(compositionHelper.GetSession(), &attachInfo));
+        }
+
+        const XrSpace localSpace = compositionHelper.CreateReferenceSpace(XR_REFERENCE_SPACE_TYPE_LOCAL, Pose::Identity);
+        XrActionSpaceCreateInfo createActionSpaceInfo{XR_TYPE_ACTION_SPACE_CREATE_INFO};
+        createActionSpaceInfo.action = gazeAction;
+        createActionSpaceInfo.poseInActionSpace = kPoseIdentity;
+        XrSpace gazeActionSpace{XR_NULL_HANDLE};
+        REQUIRE_RESULT(XR_SUCCESS, xrCreateActionSpace(compositionHelper.GetSession(), &createActionSpaceInfo, &gazeActionSpace));
+
+        compositionHelper.BeginSession();
+        SimpleProjectionLayerHelper simpleProjectionLayerHelper(compositionHelper);
+        XrCompositionLayerQuad* const instructionsQuad = compositionHelper.CreateQuadLayer(
+            compositionHelper.CreateStaticSwapchainText(1024, 512, "Look around the cubes for ten seconds.", 48), localSpace, 1.0f,
+            {{0, 0, 0, 1}, {0, 0.6f, -2.0f}});
+
+        struct GazeQuery
+        {
+            XrTime queryTime;
+            XrTime sampleTime;
+        };
+        std::vector<GazeQuery> queries;
+        queries.reserve(20000);
+        std::atomic<bool> sampling{false};
+        std::atomic<bool> stop{false};
+        std::atomic<int32_t> firstFailure{XR_SUCCESS};
+
+        // Catch2 assertions are not thread-safe, so the sampling thread only records the first failure.
+        std::thread sampler([&] {
+            ATTACH_THREAD;
+            while (!stop) {
+                if (sampling) {
+                    const XrTime now = clock->Now();
+                    XrEyeGazeSampleTimeEXT eyeGazeSampleTime{XR_TYPE_EYE_GAZE_SAMPLE_TIME_EXT};
+                    XrSpaceLocation gazeLocation{XR_TYPE_SPACE_LOCATION, &eyeGazeSampleTime};
+                    const XrResult result = xrLocateSpace(gazeActionSpace, localSpace, now, &gazeLocation);
+                    if (XR_FAILED(result)) {
+                        int32_t expected = XR_SUCCESS;
+                        firstFailure.compare_exchange_strong(expected, result);
+                        break;
+                    }
+                    if ((gazeLocation.locationFlags & XR_SPACE_LOCATION_ORIENTATION_VALID_BIT) != 0 && eyeGazeSampleTime.time > 0) {
+                        queries.push_back({now, eyeGazeSampleTime.time});
+                    }
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            DETACH_THREAD;
+        });
+
+        Clock::time_point start{};
+        auto update = [&](const XrFrameState& frameState) {
+            const XrActiveActionSet activeActionSet{actionSet, XR_NULL_PATH};
+            XrActionsSyncInfo syncInfo{XR_TYPE_ACTIONS_SYNC_INFO};
+            syncInfo.activeActionSets = &activeActionSet;
+            syncInfo.countActiveActionSets = 1;
+            // xrSyncActions may return XR_SUCCESS or XR_SESSION_NOT_FOCUSED
+            REQUIRE(XR_SUCCEEDED(xrSyncActions(compositionHelper.GetSession(), &syncInfo)));
+
+            // Start measuring once the session is focused and the gaze action is active.
+            if (!sampling) {
+                XrActionStatePose actionStatePose{XR_TYPE_ACTION_STATE_POSE};
+                XrActionStateGetInfo getActionStateInfo{XR_TYPE_ACTION_STATE_GET_INFO};
+                getActionStateInfo.action = gazeAction;
+                REQUIRE_RESULT(XR_SUCCESS, xrGetActionStatePose(compositionHelper.GetSession(), &getActionStateInfo, &actionStatePose));
+                if (actionStatePose.isActive) {
+                    start = Clock::now();
+                    sampling = true;
+                }
+            }
+
+            std::vector<XrCompositionLayerBaseHeader*> layers;
+            if (XrCompositionLayerBaseHeader* projLayer = simpleProjectionLayerHelper.TryGetUpdatedProjectionLayer(frameState)) {
+                layers.push_back(projLayer);
+            }
+            layers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader*>(instructionsQuad));
+            compositionHelper.EndFrame(frameState.predictedDisplayTime, layers);
+            compositionHelper.PollEvents();
+            return !sampling || Clock::now() - start < measureDuration;
+        };
+        try {
+            RenderLoop(compositionHelper.GetSession(), update).Loop();
+        }
+        catch (...) {
+            stop = true;
+            sampler.join();
+            throw;
+        }
+        stop = true;
+        sampler.join();
+        REQUIRE(static_cast<XrResult>(firstFailure.load()) == XR_SUCCESS);
+        if (queries.size() < 2) {
+            SKIP("The gaze was never tracked while measuring");
+        }
+
+        std::vector<std::chrono::nanoseconds> ages;
+        ages.reserve(queries.size());
+        uint32_t distinctSampleCount = 1;
+        for (size_t i = 0; i < queries.size(); ++i) {
+            ages.emplace_back(queries[i].queryTime - queries[i].sampleTime);
+            if (i > 0 && queries[i].sampleTime != queries[i - 1].sampleTime) {
+                distinctSampleCount++;
+            }
+        }
+        const double sampleSpan = (queries.back().sampleTime - queries.front().sampleTime) / 1e9;
+        const double querySpan = (queries.back().queryTime - queries.front().queryTime) / 1e9;
+        const double sampleRate = sampleSpan > 0 ? (distinctSampleCount - 1) / sampleSpan : 0;
+        const double queryRate = querySpan > 0 ? (queries.size() - 1) / querySpan : 0;
+        const DurationPercentiles age = DurationPercentiles::FromSamples(std::move(ages));
+
+        ReportConsoleOnlyF("Eye gaze: %zu queries at %.0fHz saw %u samples, %.1fHz; sample age p50/p90/p99/max %.2f / %.2f / %.2f / %.2fms",
+                           queries.size(), queryRate, distinctSampleCount, sampleRate, ms(age.p50).count(), ms(age.p90).count(),
+                           ms(age.p99).count(), ms(age.max).count());
+        ReportMetric("eyeGaze.sampleRate", sampleRate, "Hz");
+        ReportMetric("eyeGaze.queryRate", queryRate, "Hz");
+        ReportMetric("eyeGaze.sampleAge.p50", ms(age.p50).count(), "ms");
+        ReportMetric("eyeGaze.sampleAge.p90", ms(age.p90).count(), "ms");
+        ReportMetric("eyeGaze.sampleAge.p99", ms(age.p99).count(), "ms");
+        ReportMetric("eyeGaze.sampleAge.max", ms(age.max).count(), "ms");
+    }
+
 }  // namespace Conformance
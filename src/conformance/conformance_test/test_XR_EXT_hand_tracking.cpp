@@ -17,13 +17,20 @@
 #include "conformance_framework.h"
 #include "composition_utils.h"
 #include "conformance_utils.h"
+#include "report.h"
 #include "utilities/system_properties_helper.h"
 #include "utilities/utils.h"
+#include "utilities/xrduration_literals.h"
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
 #include <openxr/openxr.h>
 #include "common/xr_linear.h"
 
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+
 using namespace Conformance;
 
 namespace Conformance
@@ -351,7 +358,7 @@ namespace Conformance
 
         // Create the instructional quad layer placed to the left.
         XrCompositionLayerQuad* const instructionsQuad =
-            compositionHelper.CreateQuadLayer(compositionHelper.CreateStaticSwapchainImage(CreateTextImage(1024, 512, instructions, 48)),
+            compositionHelper.CreateQuadLayer(compositionHelper.CreateStaticSwapchainText(1024, 512, instructions, 48),
                                               localSpace, 1.0f, {{0, 0, 0, 1}, {-1.5f, 0, -0.3f}});
         instructionsQuad->pose.orientation = Quat::FromAxisAngle(Up, DegToRad(70));
 
@@ -505,4 +512,139 @@ namespace Conformance
             REQUIRE(XR_SUCCESS == xrDestroyHandTrackerEXT(handTracker[hand]));
         }
     }
+
+    // Cost of xrLocateHandJointsEXT as applications call it: once per hand per frame at the predicted display time,
+    // with and without joint velocities chained. Also measured in a tight loop, where any per-frame caching in the
+    // runtime is hit repeatedly.
+    //
+    // XrHandJointLocationsEXT carries no timestamp, so the age of the returned data cannot be observed directly.
+    // Instead, the joints are also requested at times before and after the predicted display time, reporting how
+    // often the hand is still reported active: how much history the runtime keeps and how far ahead it predicts.
+    TEST_CASE("XR_EXT_hand_tracking-benchmark", "[.][benchmark][XR_EXT_hand_tracking]")
+    {
+        using clock = std::chrono::steady_clock;
+        using us = std::chrono::duration<double, std::micro>;
+
+        GlobalData& globalData = GetGlobalData();
+        if (!globalData.IsInstanceExtensionSupported(XR_EXT_HAND_TRACKING_EXTENSION_NAME)) {
+            SKIP(XR_EXT_HAND_TRACKING_EXTENSION_NAME " not supported");
+        }
+
+        AutoBasicInstance instance({XR_EXT_HAND_TRACKING_EXTENSION_NAME}, AutoBasicInstance::createSystemId);
+
+        auto xrCreateHandTrackerEXT = GetInstanceExtensionFunction<PFN_xrCreateHandTrackerEXT>(instance, "xrCreateHandTrackerEXT");
+        auto xrDestroyHandTrackerEXT = GetInstanceExtensionFunction<PFN_xrDestroyHandTrackerEXT>(instance, "xrDestroyHandTrackerEXT");
+        auto xrLocateHandJointsEXT = GetInstanceExtensionFunction<PFN_xrLocateHandJointsEXT>(instance, "xrLocateHandJointsEXT");
+
+        if (!SystemSupportsHandTracking(instance, instance.systemId)) {
+            SKIP("System does not support hand tracking");
+        }
+
+        AutoBasicSession session(AutoBasicSession::beginSession | AutoBasicSession::createSwapchains, instance);
+
+        std::array<XrHandTrackerEXT, HAND_COUNT> handTracker;
+        for (size_t i = 0; i < HAND_COUNT; ++i) {
+            XrHandTrackerCreateInfoEXT createInfo{XR_TYPE_HAND_TRACKER_CREATE_INFO_EXT};
+            createInfo.handJointSet = XR_HAND_JOINT_SET_DEFAULT_EXT;
+            createInfo.hand = (i == 0 ? XR_HAND_LEFT_EXT : XR_HAND_RIGHT_EXT);
+            REQUIRE(XR_SUCCESS == xrCreateHandTrackerEXT(session, &createInfo, &handTracker[i]));
+        }
+
+        XrSpace localSpace = XR_NULL_HANDLE;
+        XrReferenceSpaceCreateInfo localSpaceCreateInfo{XR_TYPE_REFERENCE_SPACE_CREATE_INFO};
+        localSpaceCreateInfo.poseInReferenceSpace = Pose::Identity;
+        localSpaceCreateInfo.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_LOCAL;
+        REQUIRE_RESULT(xrCreateReferenceSpace(session, &localSpaceCreateInfo, &localSpace), XR_SUCCESS);
+
+        FrameIterator frameIterator(&session);
+        frameIterator.RunToSessionState(XR_SESSION_STATE_FOCUSED);
+
+        std::array<XrHandJointLocationEXT, XR_HAND_JOINT_COUNT_EXT> jointLocations;
+        std::array<XrHandJointVelocityEXT, XR_HAND_JOINT_COUNT_EXT> jointVelocities;
+        XrHandJointVelocitiesEXT velocities{XR_TYPE_HAND_JOINT_VELOCITIES_EXT};
+        velocities.jointCount = XR_HAND_JOINT_COUNT_EXT;
+        velocities.jointVelocities = jointVelocities.data();
+        XrHandJointLocationsEXT locations{XR_TYPE_HAND_JOINT_LOCATIONS_EXT};
+        locations.jointCount = XR_HAND_JOINT_COUNT_EXT;
+        locations.jointLocations = jointLocations.data();
+
+        // Locate one hand, returning the time the call took.
+        auto locateHand = [&](int hand, XrTime time, bool withVelocities) {
+            locations.next = withVelocities ? &velocities : nullptr;
+            XrHandJointsLocateInfoEXT locateInfo{XR_TYPE_HAND_JOINTS_LOCATE_INFO_EXT};
+            locateInfo.baseSpace = localSpace;
+            locateInfo.time = time;
+            const clock::time_point start = clock::now();
+            const XrResult result = xrLocateHandJointsEXT(handTracker[hand], &locateInfo, &locations);
+            const std::chrono::nanoseconds elapsed = clock::now() - start;
+            REQUIRE(result == XR_SUCCESS);
+            return elapsed;
+        };
+
+        auto reportCost = [](const char* mode, bool withVelocities, std::vector<std::chrono::nanoseconds> samples) {
+            const std::vector<MetricTag> tags{{"mode", mode}, {"velocities", withVelocities ? "yes" : "no"}};
+            const DurationPercentiles cost = DurationPercentiles::FromSamples(std::move(samples));
+            ReportMetric("xrLocateHandJointsEXT.cost.p50", us(cost.p50).count(), "us", tags);
+            ReportMetric("xrLocateHandJointsEXT.cost.p99", us(cost.p99).count(), "us", tags);
+            ReportMetric("xrLocateHandJointsEXT.cost.max", us(cost.max).count(), "us", tags);
+        };
+
+        constexpr uint32_t frameCount = 300;
+        constexpr uint32_t tightLoopCallCount = 5000;
+
+        for (bool withVelocities : {false, true}) {
+            CAPTURE(withVelocities);
+
+            // Both hands once per frame, at the frame's predicted display time.
+            std::vector<std::chrono::nanoseconds> frameSamples;
+            frameSamples.reserve(frameCount * HAND_COUNT);
+            uint32_t activeCount = 0;
+            for (uint32_t frame = 0; frame < frameCount; ++frame) {
+                REQUIRE(frameIterator.SubmitFrame() == FrameIterator::RunResult::Success);
+                for (auto hand : {LEFT_HAND, RIGHT_HAND}) {
+                    frameSamples.push_back(locateHand(hand, frameIterator.frameState.predictedDisplayTime, withVelocities));
+                    activeCount += locations.isActive ? 1 : 0;
+                }
+            }
+            reportCost("frameRate", withVelocities, std::move(frameSamples));
+            ReportMetric("xrLocateHandJointsEXT.activeFraction", double(activeCount) / (frameCount * HAND_COUNT), "ratio",
+                         {{"velocities", withVelocities ? "yes" : "no"}});
+
+            // Back to back, at the last predicted display time.
+            const XrTime time = frameIterator.frameState.predictedDisplayTime;
+            std::vector<std::chrono::nanoseconds> tightSamples;
+            tightSamples.reserve(tightLoopCallCount);
+            for (uint32_t i = 0; i < tightLoopCallCount; ++i) {
+                tightSamples.push_back(locateHand(i % HAND_COUNT, time, withVelocities));
+            }
+            reportCost("tightLoop", withVelocities, std::move(tightSamples));
+        }
+
+        // How often the hands are active when asked about times around the predicted display time.
+        const XrDuration timeOffsets[] = {-100_xrMilliseconds, -50_xrMilliseconds, -20_xrMilliseconds, 0, 20_xrMilliseconds,
+                                          50_xrMilliseconds};
+        std::array<uint32_t, sizeof(timeOffsets) / sizeof(timeOffsets[0])> activeAtOffset{};
+        for (uint32_t frame = 0; frame < frameCount; ++frame) {
+            REQUIRE(frameIterator.SubmitFrame() == FrameIterator::RunResult::Success);
+            const XrTime predictedDisplayTime = frameIterator.frameState.predictedDisplayTime;
+            for (size_t i = 0; i < activeAtOffset.size(); ++i) {
+                const XrTime time = predictedDisplayTime + timeOffsets[i];
+                if (time <= 0) {
+                    continue;
+                }
+                for (auto hand : {LEFT_HAND, RIGHT_HAND}) {
+                    locateHand(hand, time, false);
+                    activeAtOffset[i] += locations.isActive ? 1 : 0;
+                }
+            }
+        }
+        for (size_t i = 0; i < activeAtOffset.size(); ++i) {
+            ReportMetric("xrLocateHandJointsEXT.activeFractionAtOffset", double(activeAtOffset[i]) / (frameCount * HAND_COUNT),
+                         "ratio", {{"offsetMs", std::to_string(timeOffsets[i] / 1000000)}});
+        }
+
+        for (auto hand : {LEFT_HAND, RIGHT_HAND}) {
+            REQUIRE(XR_SUCCESS == xrDestroyHandTrackerEXT(handTracker[hand]));
+        }
+    }
 }  // namespace Conformance
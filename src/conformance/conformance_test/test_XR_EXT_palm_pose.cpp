@@ -175,7 +175,7 @@ namespace Conformance
 
             // Create the instructional quad layer placed to the left.
             XrCompositionLayerQuad* const instructionsQuad = compositionHelper.CreateQuadLayer(
-                compositionHelper.CreateStaticSwapchainImage(CreateTextImage(1024, 512, instructions.str().c_str(), 48)), localSpace, 1.0f,
+                compositionHelper.CreateStaticSwapchainText(1024, 512, instructions.str().c_str(), 48), localSpace, 1.0f,
                 {{0, 0, 0, 1}, {-1.5f, 0, -0.3f}});
             instructionsQuad->pose.orientation = Quat::FromAxisAngle(Up, DegToRad(70));
 
@@ -18,13 +18,16 @@
 #include "conformance_utils.h"
 #include "composition_utils.h"
 #include "mesh_projection_layer.h"
+#include "report.h"
 
 #include <catch2/catch_test_macros.hpp>
 #include <earcut.hpp>
 #include <openxr/openxr.h>
 #include "common/xr_linear.h"
 
+#include <chrono>
 #include <future>
+#include <string>
 
 using namespace Conformance;
 
@@ -248,7 +251,7 @@ namespace Conformance
 
         // Create the instructional quad layer placed to the left.
         XrCompositionLayerQuad* const instructionsQuad =
-            compositionHelper.CreateQuadLayer(compositionHelper.CreateStaticSwapchainImage(CreateTextImage(1024, 512, instructions, 48)),
+            compositionHelper.CreateQuadLayer(compositionHelper.CreateStaticSwapchainText(1024, 512, instructions, 48),
                                               localSpace, 1.0f, {{0, 0, 0, 1}, {-0.2f, 0, -1.0f}});
         instructionsQuad->pose.orientation = Quat::FromAxisAngle(Up, DegToRad(10));
 
@@ -523,7 +526,7 @@ namespace Conformance
         // Lambda to create the instructional quad layer placed to the left.
         auto makeInstructionsQuad = [&](const char* instructions) {
             XrCompositionLayerQuad* const instructionsQuad = compositionHelper.CreateQuadLayer(
-                compositionHelper.CreateStaticSwapchainImage(CreateTextImage(1024, 512, instructions, 48)), localSpace, 1.0f,
+                compositionHelper.CreateStaticSwapchainText(1024, 512, instructions, 48), localSpace, 1.0f,
                 {{0, 0, 0, 1}, {-0.2f, 0, -1.0f}});
             instructionsQuad->pose.orientation = Quat::FromAxisAngle(Up, DegToRad(10));
         };
@@ -856,4 +859,200 @@ namespace Conformance
                             "This should show the plane contours of all non vertical / horizontal (arbitrary) planes.");
     }
 
+    // Not a conformance requirement: re-issues xrBeginPlaneDetectionEXT at a fixed cadence, as an app tracking a changing
+    // room does, and measures how long each detection takes to reach XR_PLANE_DETECTION_STATE_DONE_EXT and how much the
+    // plane and polygon retrieval costs for the plane and vertex counts returned. The location and vertex buffers are kept
+    // across detections and only grown when a call reports XR_ERROR_SIZE_INSUFFICIENT, so in steady state each retrieval
+    // is a single call per buffer and any remaining cost is the runtime's own.
+    TEST_CASE("XR_EXT_plane_detection_Benchmark", "[.][benchmark]")
+    {
+        using clock = std::chrono::steady_clock;
+        using us = std::chrono::duration<double, std::micro>;
+        using ms = std::chrono::duration<double, std::milli>;
+
+        // Frames between the starts of successive detections.
+        constexpr uint32_t kCadenceFrames = 15;
+        constexpr uint32_t kDetectionCount = 40;
+
+        GlobalData& globalData = GetGlobalData();
+        if (!globalData.IsInstanceExtensionSupported(XR_EXT_PLANE_DETECTION_EXTENSION_NAME)) {
+            SKIP(XR_EXT_PLANE_DETECTION_EXTENSION_NAME " not supported");
+        }
+
+        CompositionHelper compositionHelper("XR_EXT_plane_detection benchmark", {XR_EXT_PLANE_DETECTION_EXTENSION_NAME});
+        XrPlaneDetectionCapabilityFlagsEXT flags =
+            SystemPlaneDetectionCapabilities(compositionHelper.GetInstance(), compositionHelper.GetSystemId());
+        if ((flags & XR_PLANE_DETECTION_CAPABILITY_PLANE_DETECTION_BIT_EXT) == 0) {
+            SKIP("System does not support plane detection");
+        }
+
+        XrInstance instance = compositionHelper.GetInstance();
+        XrSession session = compositionHelper.GetSession();
+
+        auto xrCreatePlaneDetectorEXT = GetInstanceExtensionFunction<PFN_xrCreatePlaneDetectorEXT>(instance, "xrCreatePlaneDetectorEXT");
+        auto xrDestroyPlaneDetectorEXT = GetInstanceExtensionFunction<PFN_xrDestroyPlaneDetectorEXT>(instance, "xrDestroyPlaneDetectorEXT");
+        auto xrBeginPlaneDetectionEXT = GetInstanceExtensionFunction<PFN_xrBeginPlaneDetectionEXT>(instance, "xrBeginPlaneDetectionEXT");
+        auto xrGetPlaneDetectionStateEXT =
+            GetInstanceExtensionFunction<PFN_xrGetPlaneDetectionStateEXT>(instance, "xrGetPlaneDetectionStateEXT");
+        auto xrGetPlaneDetectionsEXT = GetInstanceExtensionFunction<PFN_xrGetPlaneDetectionsEXT>(instance, "xrGetPlaneDetectionsEXT");
+        auto xrGetPlanePolygonBufferEXT =
+            GetInstanceExtensionFunction<PFN_xrGetPlanePolygonBufferEXT>(instance, "xrGetPlanePolygonBufferEXT");
+
+        const XrSpace localSpace = compositionHelper.CreateReferenceSpace(XR_REFERENCE_SPACE_TYPE_LOCAL, Pose::Identity);
+        const XrSpace viewSpace = compositionHelper.CreateReferenceSpace(XR_REFERENCE_SPACE_TYPE_VIEW, Pose::Identity);
+
+        compositionHelper.BeginSession();
+
+        XrPlaneDetectorCreateInfoEXT createInfo{XR_TYPE_PLANE_DETECTOR_CREATE_INFO_EXT};
+        createInfo.flags = XR_PLANE_DETECTOR_ENABLE_CONTOUR_BIT_EXT;
+        XrPlaneDetectorEXT detection = XR_NULL_HANDLE;
+        REQUIRE(XR_SUCCESS == xrCreatePlaneDetectorEXT(session, &createInfo, &detection));
+
+        // Kept for the whole run, only ever grown.
+        std::vector<XrPlaneDetectorLocationEXT> locationBuffer;
+        std::vector<XrVector2f> vertexBuffer;
+        uint32_t bufferGrowCount = 0;
+
+        std::vector<std::chrono::nanoseconds> timesToDone;
+        std::vector<std::chrono::nanoseconds> locationsLatencies;
+        std::vector<std::chrono::nanoseconds> polygonLatencies;
+        uint64_t totalPlanes = 0;
+        uint64_t totalVertices = 0;
+        uint32_t supersededCount = 0;
+        uint32_t errorCount = 0;
+
+        bool pending = false;
+        clock::time_point beginTime{};
+        uint32_t detectionsStarted = 0;
+        uint32_t frame = 0;
+        const clock::time_point deadline = clock::now() + std::chrono::seconds(60);
+
+        while (detectionsStarted < kDetectionCount || pending) {
+            if (clock::now() > deadline) {
+                WARN("Plane detection did not keep up with the cadence, stopping after " << detectionsStarted << " detections");
+                break;
+            }
+
+            compositionHelper.PollEvents();
+            XrFrameState frameState{XR_TYPE_FRAME_STATE};
+            XRC_CHECK_THROW_XRCMD(xrWaitFrame(session, nullptr, &frameState));
+            XRC_CHECK_THROW_XRCMD(xrBeginFrame(session, nullptr));
+
+            if (pending) {
+                XrPlaneDetectionStateEXT state{};
+                REQUIRE(XR_SUCCESS == xrGetPlaneDetectionStateEXT(detection, &state));
+                if (state == XR_PLANE_DETECTION_STATE_DONE_EXT) {
+                    timesToDone.push_back(clock::now() - beginTime);
+                    pending = false;
+
+                    XrPlaneDetectorGetInfoEXT getInfo{XR_TYPE_PLANE_DETECTOR_GET_INFO_EXT};
+                    getInfo.baseSpace = localSpace;
+                    getInfo.time = frameState.predictedDisplayTime;
+                    XrPlaneDetectorLocationsEXT locations{XR_TYPE_PLANE_DETECTOR_LOCATIONS_EXT};
+
+                    clock::time_point start = clock::now();
+                    locations.planeLocationCapacityInput = (uint32_t)locationBuffer.size();
+                    locations.planeLocations = locationBuffer.empty() ? nullptr : locationBuffer.data();
+                    XrResult result = xrGetPlaneDetectionsEXT(detection, &getInfo, &locations);
+                    if (result == XR_ERROR_SIZE_INSUFFICIENT ||
+                        (locationBuffer.empty() && result == XR_SUCCESS && locations.planeLocationCountOutput != 0)) {
+                        locationBuffer.resize(locations.planeLocationCountOutput, {XR_TYPE_PLANE_DETECTOR_LOCATION_EXT});
+                        bufferGrowCount++;
+                        locations.planeLocationCapacityInput = (uint32_t)locationBuffer.size();
+                        locations.planeLocations = locationBuffer.data();
+                        result = xrGetPlaneDetectionsEXT(detection, &getInfo, &locations);
+                    }
+                    locationsLatencies.push_back(clock::now() - start);
+                    REQUIRE(XR_SUCCESS == result);
+
+                    const uint32_t planeCount = locations.planeLocationCountOutput;
+                    uint64_t vertexCount = 0;
+                    start = clock::now();
+                    for (uint32_t planeIndex = 0; planeIndex < planeCount; ++planeIndex) {
+                        const XrPlaneDetectorLocationEXT& location = locationBuffer[planeIndex];
+                        for (uint32_t polygonBufferIndex = 0; polygonBufferIndex < location.polygonBufferCount; polygonBufferIndex++) {
+                            XrPlaneDetectorPolygonBufferEXT polygonBuffer{XR_TYPE_PLANE_DETECTOR_POLYGON_BUFFER_EXT};
+                            polygonBuffer.vertexCapacityInput = (uint32_t)vertexBuffer.size();
+                            polygonBuffer.vertices = vertexBuffer.empty() ? nullptr : vertexBuffer.data();
+                            result = xrGetPlanePolygonBufferEXT(detection, location.planeId, polygonBufferIndex, &polygonBuffer);
+                            if (result == XR_ERROR_SIZE_INSUFFICIENT || (vertexBuffer.empty() && result == XR_SUCCESS)) {
+                                vertexBuffer.resize(polygonBuffer.vertexCountOutput);
+                                bufferGrowCount++;
+                                polygonBuffer.vertexCapacityInput = (uint32_t)vertexBuffer.size();
+                                polygonBuffer.vertices = vertexBuffer.data();
+                                result = xrGetPlanePolygonBufferEXT(detection, location.planeId, polygonBufferIndex, &polygonBuffer);
+                            }
+                            REQUIRE(XR_SUCCESS == result);
+                            vertexCount += polygonBuffer.vertexCountOutput;
+                        }
+                    }
+                    const std::chrono::nanoseconds polygonLatency = clock::now() - start;
+                    polygonLatencies.push_back(polygonLatency);
+                    totalPlanes += planeCount;
+                    totalVertices += vertexCount;
+
+                    // One sample per detection, to plot the retrieval cost against what was retrieved.
+                    ReportMetric("PlaneDetection.retrievalSample", us(locationsLatencies.back() + polygonLatency).count(), "us",
+                                 {{"planes", std::to_string(planeCount)}, {"vertices", std::to_string(vertexCount)}});
+                }
+                else if (state == XR_PLANE_DETECTION_STATE_ERROR_EXT) {
+                    errorCount++;
+                    pending = false;
+                }
+            }
+
+            if (frame % kCadenceFrames == 0 && detectionsStarted < kDetectionCount) {
+                // Beginning again discards a detection still pending, as an app on a fixed cadence would.
+                if (pending) {
+                    supersededCount++;
+                }
+
+                XrPlaneDetectorBeginInfoEXT beginInfo{XR_TYPE_PLANE_DETECTOR_BEGIN_INFO_EXT};
+                beginInfo.minArea = 0.1f;
+                beginInfo.maxPlanes = 100;
+                beginInfo.boundingBoxPose = Pose::Identity;
+                beginInfo.boundingBoxExtent = XrExtent3DfEXT{10.0f, 10.0f, 10.0f};
+                beginInfo.time = frameState.predictedDisplayTime;
+                beginInfo.baseSpace = viewSpace;
+                beginTime = clock::now();
+                REQUIRE(XR_SUCCESS == xrBeginPlaneDetectionEXT(detection, &beginInfo));
+                pending = true;
+                detectionsStarted++;
+            }
+
+            compositionHelper.EndFrame(frameState.predictedDisplayTime, {});
+            frame++;
+        }
+
+        REQUIRE(XR_SUCCESS == xrDestroyPlaneDetectorEXT(detection));
+
+        ReportMetric("PlaneDetection.detections", detectionsStarted, "count");
+        ReportMetric("PlaneDetection.superseded", supersededCount, "count");
+        ReportMetric("PlaneDetection.errors", errorCount, "count");
+        ReportMetric("PlaneDetection.bufferGrows", bufferGrowCount, "count");
+        if (timesToDone.empty()) {
+            WARN("No plane detection completed");
+            return;
+        }
+
+        const DurationPercentiles timeToDone = DurationPercentiles::FromSamples(timesToDone);
+        ReportMetric("PlaneDetection.timeToDone.p50", ms(timeToDone.p50).count(), "ms");
+        ReportMetric("PlaneDetection.timeToDone.p99", ms(timeToDone.p99).count(), "ms");
+
+        const DurationPercentiles locationsLatency = DurationPercentiles::FromSamples(locationsLatencies);
+        ReportMetric("PlaneDetection.locationsLatency.p50", us(locationsLatency.p50).count(), "us");
+        ReportMetric("PlaneDetection.locationsLatency.p99", us(locationsLatency.p99).count(), "us");
+
+        const DurationPercentiles polygonLatency = DurationPercentiles::FromSamples(polygonLatencies);
+        ReportMetric("PlaneDetection.polygonLatency.p50", us(polygonLatency.p50).count(), "us");
+        ReportMetric("PlaneDetection.polygonLatency.p99", us(polygonLatency.p99).count(), "us");
+
+        const double completed = (double)timesToDone.size();
+        ReportMetric("PlaneDetection.planesPerDetection", totalPlanes / completed, "count");
+        ReportMetric("PlaneDetection.verticesPerDetection", totalVertices / completed, "count");
+        if (totalVertices != 0) {
+            ReportMetric("PlaneDetection.polygonCostPerVertex", polygonLatency.mean.count() * completed / totalVertices, "ns");
+        }
+    }
+
 }  // namespace Conformance
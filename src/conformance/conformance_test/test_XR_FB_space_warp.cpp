@@ -14,16 +14,26 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "composition_utils.h"
 #include "conformance_framework.h"
 #include "conformance_utils.h"
+#include "graphics_plugin.h"
+#include "report.h"
 #include "utilities/bitmask_generator.h"
+#include "utilities/throw_helpers.h"
+#include "utilities/xr_math_operators.h"
 #include "utilities/xrduration_literals.h"
 
 #include <catch2/catch_test_macros.hpp>
 #include <openxr/openxr.h>
 
+#include <chrono>
+#include <cmath>
 #include <cstring>
 #include <limits>
+#include <string>
+#include <thread>
+#include <tuple>
 #include <vector>
 
 namespace Conformance
@@ -77,7 +87,8 @@ namespace Conformance
 
         auto&& layerFlagsGenerator = bitmaskGeneratorIncluding0({XR_COMPOSITION_LAYER_CORRECT_CHROMATIC_ABERRATION_BIT,
                                                                  XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT,
-                                                                 XR_COMPOSITION_LAYER_UNPREMULTIPLIED_ALPHA_BIT});
+                                                                 XR_COMPOSITION_LAYER_UNPREMULTIPLIED_ALPHA_BIT},
+                                                                GetGlobalData().options.bitmaskCoverage);
         while (layerFlagsGenerator.next()) {
             // minDepth and maxDepth are the range of depth values the depthSwapchain could have,
             //   in the range of [0.0,1.0]. This is akin to min and max values of OpenGL's glDepthRange,
@@ -184,4 +195,235 @@ namespace Conformance
             frameIterator.projectionViewVector[i].next = nullptr;
         }
     }
+
+    // Not a conformance requirement: renders moving cubes with real motion vectors and depth, first at full rate without
+    // space warp and then at half rate with it, and reports the frame timing of each along with the cost of generating the
+    // motion vectors, to track the runtime's frame extrapolation overhead. Run with --perfMetricsSampleRate to also record
+    // the runtime's own performance counters. Only plugins that implement IGraphicsPlugin::RenderMotionVectorView can run it.
+    TEST_CASE("XR_FB_space_warp_Benchmark", "[XR_FB_space_warp][.][benchmark]")
+    {
+        using namespace openxr::math_operators;
+        using ms = std::chrono::duration<double, std::milli>;
+        using Clock = std::chrono::steady_clock;
+
+        GlobalData& globalData = GetGlobalData();
+        if (!globalData.IsInstanceExtensionSupported(XR_FB_SPACE_WARP_EXTENSION_NAME)) {
+            SKIP(XR_FB_SPACE_WARP_EXTENSION_NAME " not supported");
+        }
+        if (!globalData.IsUsingGraphicsPlugin()) {
+            SKIP("Test run not using graphics plugin");
+        }
+        IGraphicsPlugin& graphicsPlugin = *globalData.graphicsPlugin;
+        if (!graphicsPlugin.SupportsMotionVectors()) {
+            SKIP("Graphics plugin cannot render motion vectors");
+        }
+
+        CompositionHelper compositionHelper("XR_FB_space_warp benchmark", {XR_FB_SPACE_WARP_EXTENSION_NAME});
+        const XrSession session = compositionHelper.GetSession();
+
+        XrSystemSpaceWarpPropertiesFB spaceWarpProperties{XR_TYPE_SYSTEM_SPACE_WARP_PROPERTIES_FB};
+        XrSystemProperties systemProperties{XR_TYPE_SYSTEM_PROPERTIES};
+        systemProperties.next = &spaceWarpProperties;
+        XRC_CHECK_THROW_XRCMD(xrGetSystemProperties(compositionHelper.GetInstance(), compositionHelper.GetSystemId(), &systemProperties));
+
+        compositionHelper.GetInteractionManager().AttachActionSets();
+        compositionHelper.BeginSession();
+
+        const XrSpace localSpace = compositionHelper.CreateReferenceSpace(XR_REFERENCE_SPACE_TYPE_LOCAL, Pose::Identity);
+        XrCompositionLayerProjection* const projLayer = compositionHelper.CreateProjectionLayer(localSpace);
+        const uint32_t viewCount = projLayer->viewCount;
+
+        uint32_t formatCount = 0;
+        XRC_CHECK_THROW_XRCMD(xrEnumerateSwapchainFormats(session, 0, &formatCount, nullptr));
+        std::vector<int64_t> formats(formatCount);
+        XRC_CHECK_THROW_XRCMD(xrEnumerateSwapchainFormats(session, formatCount, &formatCount, formats.data()));
+        const int64_t motionVectorFormat = graphicsPlugin.SelectMotionVectorSwapchainFormat(formats.data(), formats.size());
+
+        const XrExtent2Di motionVectorExtent{(int32_t)std::max(spaceWarpProperties.recommendedMotionVectorImageRectWidth, 1u),
+                                             (int32_t)std::max(spaceWarpProperties.recommendedMotionVectorImageRectHeight, 1u)};
+        const std::vector<XrViewConfigurationView> viewProperties = compositionHelper.EnumerateConfigurationViews();
+        std::vector<XrSwapchain> colorSwapchains;
+        std::vector<XrSwapchain> motionVectorSwapchains;
+        std::vector<XrSwapchain> depthSwapchains;
+        std::vector<XrCompositionLayerSpaceWarpInfoFB> spaceWarpInfos(viewCount, {XR_TYPE_COMPOSITION_LAYER_SPACE_WARP_INFO_FB});
+        for (uint32_t i = 0; i < viewCount; ++i) {
+            colorSwapchains.push_back(compositionHelper.CreateSwapchain(compositionHelper.DefaultColorSwapchainCreateInfo(
+                viewProperties[i].recommendedImageRectWidth, viewProperties[i].recommendedImageRectHeight)));
+            const_cast<XrSwapchainSubImage&>(projLayer->views[i].subImage) = compositionHelper.MakeDefaultSubImage(colorSwapchains[i], 0);
+
+            motionVectorSwapchains.push_back(compositionHelper.CreateSwapchain(compositionHelper.DefaultColorSwapchainCreateInfo(
+                motionVectorExtent.width, motionVectorExtent.height, 0, motionVectorFormat)));
+            depthSwapchains.push_back(compositionHelper.CreateSwapchain(
+                compositionHelper.DefaultDepthSwapchainCreateInfo(motionVectorExtent.width, motionVectorExtent.height)));
+
+            XrCompositionLayerSpaceWarpInfoFB& spaceWarpInfo = spaceWarpInfos[i];
+            spaceWarpInfo.motionVectorSubImage = compositionHelper.MakeDefaultSubImage(motionVectorSwapchains[i], 0);
+            spaceWarpInfo.depthSubImage = compositionHelper.MakeDefaultSubImage(depthSwapchains[i], 0);
+            spaceWarpInfo.appSpaceDeltaPose = Pose::Identity;  // The local space does not move.
+            // The depth range and planes the graphics plugins render with.
+            spaceWarpInfo.minDepth = 0.0f;
+            spaceWarpInfo.maxDepth = 1.0f;
+            spaceWarpInfo.nearZ = 0.05f;
+            spaceWarpInfo.farZ = 100.0f;
+        }
+
+        // A ring of cubes orbiting in front of the viewer, so that every frame has motion to extrapolate.
+        auto makeCubes = [](XrTime displayTime, std::vector<Cube>& cubes) {
+            constexpr int cubeCount = 8;
+            const float angle = static_cast<float>(std::fmod(displayTime / 1e9, 2 * MATH_PI));
+            cubes.clear();
+            for (int i = 0; i < cubeCount; ++i) {
+                const float cubeAngle = angle + i * 2 * MATH_PI / cubeCount;
+                cubes.push_back(Cube::Make({0.5f * std::cos(cubeAngle), 0.5f * std::sin(cubeAngle), -2.0f}, 0.2f));
+            }
+        };
+
+        struct Mode
+        {
+            const char* name;
+            bool spaceWarp;
+            // Display periods per app frame.
+            int periodsPerFrame;
+        };
+        const Mode modes[] = {{"fullRate", false, 1}, {"halfRateSpaceWarp", true, 2}};
+        constexpr int warmupFrameCount = 30;
+        constexpr int testFrameCount = 300;
+        constexpr const char* MotionVectorGpuTimerScope = "SpaceWarpMotionVectors";
+
+        std::vector<Cube> cubes;
+        std::vector<Cube> previousCubes;
+        std::vector<XrCompositionLayerProjectionView> previousViews(viewCount);
+        std::vector<GpuTimerSample> gpuTimerSamples;
+        const std::vector<XrCompositionLayerBaseHeader*> noLayers;
+        const std::vector<XrCompositionLayerBaseHeader*> layers{reinterpret_cast<XrCompositionLayerBaseHeader*>(projLayer)};
+
+        for (const Mode& mode : modes) {
+            std::vector<std::chrono::nanoseconds> frameTimes;
+            std::vector<std::chrono::nanoseconds> endFrameTimes;
+            std::vector<std::chrono::nanoseconds> motionVectorTimes;
+            std::vector<std::chrono::nanoseconds> motionVectorGpuTimes;
+            uint32_t missedFrameCount = 0;
+            Clock::time_point lastWaitEnd;
+            XrTime lastDisplayTime = 0;
+            XrDuration displayPeriod = 0;
+            bool havePrevious = false;
+
+            for (int frame = 0; frame < warmupFrameCount + testFrameCount; ++frame) {
+                compositionHelper.PollEvents();
+
+                // An app that takes longer than a display period per frame, so that xrWaitFrame runs it at a fraction of the
+                // display rate and the runtime synthesizes the frames in between.
+                if (mode.periodsPerFrame > 1 && displayPeriod != 0) {
+                    std::this_thread::sleep_for(std::chrono::nanoseconds(displayPeriod * (mode.periodsPerFrame - 1) + displayPeriod / 10));
+                }
+
+                XrFrameState frameState{XR_TYPE_FRAME_STATE};
+                XRC_CHECK_THROW_XRCMD(xrWaitFrame(session, nullptr, &frameState));
+                const Clock::time_point waitEnd = Clock::now();
+                XRC_CHECK_THROW_XRCMD(xrBeginFrame(session, nullptr));
+                displayPeriod = frameState.predictedDisplayPeriod;
+
+                std::chrono::nanoseconds motionVectorTime{0};
+                bool rendered = false;
+                if (frameState.shouldRender) {
+                    XrViewState viewState;
+                    std::vector<XrView> views;
+                    std::tie(viewState, views) = compositionHelper.LocateViews(localSpace, frameState.predictedDisplayTime);
+                    rendered = (viewState.viewStateFlags & XR_VIEW_STATE_POSITION_VALID_BIT) != 0 &&
+                               (viewState.viewStateFlags & XR_VIEW_STATE_ORIENTATION_VALID_BIT) != 0;
+                    if (rendered) {
+                        makeCubes(frameState.predictedDisplayTime, cubes);
+                        if (!havePrevious) {
+                            previousCubes = cubes;
+                        }
+
+                        for (uint32_t i = 0; i < viewCount; ++i) {
+                            auto& projectionView = const_cast<XrCompositionLayerProjectionView&>(projLayer->views[i]);
+                            projectionView.pose = views[i].pose;
+                            projectionView.fov = views[i].fov;
+                            projectionView.next = mode.spaceWarp ? &spaceWarpInfos[i] : nullptr;
+                            if (!havePrevious) {
+                                previousViews[i] = projectionView;
+                            }
+
+                            compositionHelper.AcquireWaitReleaseImage(colorSwapchains[i], [&](const XrSwapchainImageBaseHeader* image) {
+                                graphicsPlugin.ClearImageSlice(image);
+                                graphicsPlugin.RenderView(projectionView, image, RenderParams{}.Draw(cubes));
+                            });
+
+                            if (mode.spaceWarp) {
+                                XrCompositionLayerProjectionView motionVectorView = projectionView;
+                                motionVectorView.subImage = spaceWarpInfos[i].motionVectorSubImage;
+                                compositionHelper.AcquireWaitReleaseImages(
+                                    {motionVectorSwapchains[i], depthSwapchains[i]},
+                                    [&](const std::vector<const XrSwapchainImageBaseHeader*>& images) {
+                                        const Clock::time_point start = Clock::now();
+                                        graphicsPlugin.BeginGpuTimerScope(MotionVectorGpuTimerScope);
+                                        graphicsPlugin.RenderMotionVectorView(motionVectorView, previousViews[i], images[0],
+                                                                              images[1], RenderParams{}.Draw(cubes),
+                                                                              RenderParams{}.Draw(previousCubes));
+                                        graphicsPlugin.EndGpuTimerScope();
+                                        motionVectorTime += Clock::now() - start;
+                                    });
+                            }
+                            previousViews[i] = projectionView;
+                        }
+                        previousCubes = cubes;
+                        havePrevious = true;
+                    }
+                }
+
+                const Clock::time_point endStart = Clock::now();
+                compositionHelper.EndFrame(frameState.predictedDisplayTime, rendered ? layers : noLayers);
+                const Clock::time_point endEnd = Clock::now();
+
+                gpuTimerSamples.clear();
+                graphicsPlugin.CollectGpuTimerSamples(gpuTimerSamples);
+                if (frame >= warmupFrameCount) {
+                    for (const GpuTimerSample& sample : gpuTimerSamples) {
+                        if (std::strcmp(sample.name, MotionVectorGpuTimerScope) == 0) {
+                            motionVectorGpuTimes.push_back(sample.duration);
+                        }
+                    }
+                    frameTimes.push_back(waitEnd - lastWaitEnd);
+                    endFrameTimes.push_back(endEnd - endStart);
+                    if (mode.spaceWarp && rendered) {
+                        motionVectorTimes.push_back(motionVectorTime);
+                    }
+                    if (frameState.predictedDisplayTime - lastDisplayTime >
+                        frameState.predictedDisplayPeriod * mode.periodsPerFrame + frameState.predictedDisplayPeriod / 2) {
+                        missedFrameCount++;
+                    }
+                }
+                lastWaitEnd = waitEnd;
+                lastDisplayTime = frameState.predictedDisplayTime;
+            }
+
+            const DurationPercentiles frameTime = DurationPercentiles::FromSamples(std::move(frameTimes));
+            const DurationPercentiles endFrame = DurationPercentiles::FromSamples(std::move(endFrameTimes));
+            ReportConsoleOnlyF("%s: app frame time p50/p99 %.3f / %.3fms, xrEndFrame p50/p99 %.3f / %.3fms, %u missed frame(s)", mode.name,
+                               ms(frameTime.p50).count(), ms(frameTime.p99).count(), ms(endFrame.p50).count(), ms(endFrame.p99).count(),
+                               missedFrameCount);
+
+            const std::vector<MetricTag> tags{{"mode", mode.name}};
+            ReportMetric("spaceWarp.frameTime", ms(frameTime.p50).count(), "ms", tags);
+            ReportMetric("spaceWarp.frameTimeP99", ms(frameTime.p99).count(), "ms", tags);
+            ReportMetric("spaceWarp.endFrameTime", ms(endFrame.p50).count(), "ms", tags);
+            ReportMetric("spaceWarp.endFrameTimeP99", ms(endFrame.p99).count(), "ms", tags);
+            ReportMetric("spaceWarp.missedFrames", missedFrameCount, "count", tags);
+            if (!motionVectorTimes.empty()) {
+                ReportMetric("spaceWarp.motionVectorCpuTime",
+                             ms(DurationPercentiles::FromSamples(std::move(motionVectorTimes)).p50).count(), "ms", tags);
+            }
+            if (!motionVectorGpuTimes.empty()) {
+                ReportMetric("spaceWarp.motionVectorGpuTime",
+                             ms(DurationPercentiles::FromSamples(std::move(motionVectorGpuTimes)).p50).count(), "ms", tags);
+            }
+        }
+
+        // The space warp infos go away with this scope, but the projection layer is owned by the composition helper.
+        for (uint32_t i = 0; i < viewCount; ++i) {
+            const_cast<XrCompositionLayerProjectionView&>(projLayer->views[i]).next = nullptr;
+        }
+    }
 }  // namespace Conformance
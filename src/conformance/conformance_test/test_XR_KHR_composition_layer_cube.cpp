@@ -17,15 +17,18 @@
 #include "composition_utils.h"
 #include "conformance_framework.h"
 #include "conformance_utils.h"
+#include "report.h"
 #include "utilities/generator.h"
 #include "utilities/bitmask_generator.h"
 #include "utilities/bitmask_to_string.h"
+#include "utilities/colors.h"
 #include "utilities/xrduration_literals.h"
 
 #include <catch2/catch_test_macros.hpp>
 #include <openxr/openxr.h>
 
 #include <array>
+#include <chrono>
 #include <memory>
 #include <vector>
 
@@ -74,7 +77,8 @@ namespace Conformance
 
         auto&& layerFlagsGenerator = bitmaskGeneratorIncluding0({XR_COMPOSITION_LAYER_CORRECT_CHROMATIC_ABERRATION_BIT,
                                                                  XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT,
-                                                                 XR_COMPOSITION_LAYER_UNPREMULTIPLIED_ALPHA_BIT});
+                                                                 XR_COMPOSITION_LAYER_UNPREMULTIPLIED_ALPHA_BIT},
+                                                                GetGlobalData().options.bitmaskCoverage);
         std::array<XrEyeVisibility, 3> eyeVisibilityArray{XR_EYE_VISIBILITY_BOTH, XR_EYE_VISIBILITY_LEFT /* just these two */};
 
         while (layerFlagsGenerator.next()) {
@@ -148,4 +152,150 @@ namespace Conformance
 
         frameIterator.RunToSessionState(XR_SESSION_STATE_STOPPING);
     }
+
+    // Not a conformance requirement: renders new content into all six faces of a large cube map swapchain on every frame, and
+    // into a large equirect swapchain when XR_KHR_composition_layer_equirect is supported, with
+    // IGraphicsPlugin::FillImageSlice, and submits them as layers. Records the CPU time spent filling them and the frame time
+    // in the CTS XML report, to show the cost of dynamic cube and equirect content next to the static images the
+    // conformance tests use.
+    TEST_CASE("XR_KHR_composition_layer_cube_DynamicContent_Benchmark", "[.][benchmark]")
+    {
+        using ms = std::chrono::duration<double, std::milli>;
+        using Clock = std::chrono::steady_clock;
+
+        GlobalData& globalData = GetGlobalData();
+        if (!globalData.IsInstanceExtensionSupported(XR_KHR_COMPOSITION_LAYER_CUBE_EXTENSION_NAME)) {
+            SKIP(XR_KHR_COMPOSITION_LAYER_CUBE_EXTENSION_NAME " not supported");
+        }
+        if (!globalData.IsUsingGraphicsPlugin()) {
+            SKIP("Test run not using graphics plugin");
+        }
+
+        std::vector<const char*> extensions{XR_KHR_COMPOSITION_LAYER_CUBE_EXTENSION_NAME};
+        const bool haveEquirect = globalData.IsInstanceExtensionSupported(XR_KHR_COMPOSITION_LAYER_EQUIRECT_EXTENSION_NAME);
+        if (haveEquirect) {
+            extensions.push_back(XR_KHR_COMPOSITION_LAYER_EQUIRECT_EXTENSION_NAME);
+        }
+
+        CompositionHelper compositionHelper("Cube Dynamic Content Benchmark", extensions);
+        const XrSession session = compositionHelper.GetSession();
+        auto graphicsPlugin = globalData.GetGraphicsPlugin();
+
+        compositionHelper.GetInteractionManager().AttachActionSets();
+        compositionHelper.BeginSession();
+
+        const XrSpace localSpace = compositionHelper.CreateReferenceSpace(XR_REFERENCE_SPACE_TYPE_LOCAL);
+
+        constexpr uint32_t faceSize = 1024;
+        constexpr uint32_t faceCount = 6;
+        XrSwapchainCreateInfo cubeCreateInfo =
+            compositionHelper.DefaultColorSwapchainCreateInfo(faceSize, faceSize, 0, graphicsPlugin->GetSRGBA8Format());
+        cubeCreateInfo.faceCount = faceCount;
+        const XrSwapchain cubeSwapchain = compositionHelper.CreateSwapchain(cubeCreateInfo);
+
+        constexpr uint32_t equirectWidth = 4096;
+        constexpr uint32_t equirectHeight = 2048;
+        XrSwapchain equirectSwapchain = XR_NULL_HANDLE;
+        if (haveEquirect) {
+            equirectSwapchain = compositionHelper.CreateSwapchain(compositionHelper.DefaultColorSwapchainCreateInfo(
+                equirectWidth, equirectHeight, 0, graphicsPlugin->GetSRGBA8Format()));
+        }
+
+        XrCompositionLayerCubeKHR cubeLayer{XR_TYPE_COMPOSITION_LAYER_CUBE_KHR};
+        cubeLayer.space = localSpace;
+        cubeLayer.eyeVisibility = XR_EYE_VISIBILITY_BOTH;
+        cubeLayer.swapchain = cubeSwapchain;
+        cubeLayer.imageArrayIndex = 0;
+        cubeLayer.orientation = Quat::Identity;
+
+        // The equirect covers the half of the sphere in front of the user, over the cube.
+        XrCompositionLayerEquirectKHR equirectLayer{XR_TYPE_COMPOSITION_LAYER_EQUIRECT_KHR};
+        equirectLayer.space = localSpace;
+        equirectLayer.eyeVisibility = XR_EYE_VISIBILITY_BOTH;
+        equirectLayer.pose = Pose::Identity;
+        equirectLayer.radius = 0.0f;  // Infinite
+        equirectLayer.scale = {2.0f, 1.0f};
+        equirectLayer.bias = {-0.5f, 0.0f};
+
+        std::vector<XrCompositionLayerBaseHeader*> layers{reinterpret_cast<XrCompositionLayerBaseHeader*>(&cubeLayer)};
+        if (haveEquirect) {
+            equirectLayer.subImage = compositionHelper.MakeDefaultSubImage(equirectSwapchain);
+            layers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader*>(&equirectLayer));
+        }
+        const std::vector<XrCompositionLayerBaseHeader*> noLayers;
+
+        // A different color on each face, so that the faces can be told apart, with a checkerboard that changes size every
+        // frame so that the content has to be rendered anew.
+        const XrColor4f faceColors[faceCount] = {Colors::Red,    Colors::Green,   Colors::Blue,
+                                                 Colors::Yellow, Colors::Magenta, Colors::Orange};
+        const auto cellSize = [](int frame) { return 8u + static_cast<uint32_t>(frame % 56); };
+
+        constexpr int warmupFrameCount = 30;
+        constexpr int testFrameCount = 300;
+        std::vector<std::chrono::nanoseconds> cubeFillTimes;
+        std::vector<std::chrono::nanoseconds> equirectFillTimes;
+        std::vector<std::chrono::nanoseconds> frameTimes;
+        Clock::time_point lastWaitEnd;
+        for (int frame = 0; frame < warmupFrameCount + testFrameCount; ++frame) {
+            compositionHelper.PollEvents();
+
+            XrFrameState frameState{XR_TYPE_FRAME_STATE};
+            XRC_CHECK_THROW_XRCMD(xrWaitFrame(session, nullptr, &frameState));
+            const Clock::time_point waitEnd = Clock::now();
+            XRC_CHECK_THROW_XRCMD(xrBeginFrame(session, nullptr));
+
+            const bool measured = frame >= warmupFrameCount;
+            if (frameState.shouldRender) {
+                const Clock::time_point cubeStart = Clock::now();
+                compositionHelper.AcquireWaitReleaseImage(cubeSwapchain, [&](const XrSwapchainImageBaseHeader* swapchainImage) {
+                    for (uint32_t face = 0; face < faceCount; ++face) {
+                        graphicsPlugin->FillImageSlice(
+                            swapchainImage, face, faceSize, faceSize,
+                            ProceduralFill::Checkerboard(faceColors[face], Colors::Black, cellSize(frame)).WithBorder(Colors::Black, 4));
+                    }
+                });
+                const Clock::time_point cubeEnd = Clock::now();
+                if (measured) {
+                    cubeFillTimes.push_back(cubeEnd - cubeStart);
+                }
+
+                if (haveEquirect) {
+                    // Sweep the gradient direction and colors with the frame, so every frame is different.
+                    const XrColor4f from = faceColors[frame % faceCount];
+                    const XrColor4f to = faceColors[(frame + 1) % faceCount];
+                    compositionHelper.AcquireWaitReleaseImage(equirectSwapchain, [&](const XrSwapchainImageBaseHeader* swapchainImage) {
+                        graphicsPlugin->FillImageSlice(swapchainImage, 0, equirectWidth, equirectHeight,
+                                                       ProceduralFill::Gradient(from, to, frame % 2 == 0));
+                    });
+                    if (measured) {
+                        equirectFillTimes.push_back(Clock::now() - cubeEnd);
+                    }
+                }
+            }
+
+            compositionHelper.EndFrame(frameState.predictedDisplayTime, frameState.shouldRender ? layers : noLayers);
+
+            if (measured) {
+                frameTimes.push_back(waitEnd - lastWaitEnd);
+            }
+            lastWaitEnd = waitEnd;
+        }
+
+        const DurationPercentiles cubeFill = DurationPercentiles::FromSamples(std::move(cubeFillTimes));
+        const DurationPercentiles equirectFill = DurationPercentiles::FromSamples(std::move(equirectFillTimes));
+        const DurationPercentiles frameTime = DurationPercentiles::FromSamples(std::move(frameTimes));
+        ReportConsoleOnlyF("Cube fill p50/p99 %.3f / %.3fms, equirect fill p50/p99 %.3f / %.3fms, frame time p50/p99 %.3f / %.3fms",
+                           ms(cubeFill.p50).count(), ms(cubeFill.p99).count(), ms(equirectFill.p50).count(),
+                           ms(equirectFill.p99).count(), ms(frameTime.p50).count(), ms(frameTime.p99).count());
+
+        const std::vector<MetricTag> tags{{"faceSize", std::to_string(faceSize)}, {"equirect", haveEquirect ? "true" : "false"}};
+        ReportMetric("dynamicCube.cubeFillTime", ms(cubeFill.p50).count(), "ms", tags);
+        ReportMetric("dynamicCube.cubeFillTimeP99", ms(cubeFill.p99).count(), "ms", tags);
+        if (haveEquirect) {
+            ReportMetric("dynamicCube.equirectFillTime", ms(equirectFill.p50).count(), "ms", tags);
+            ReportMetric("dynamicCube.equirectFillTimeP99", ms(equirectFill.p99).count(), "ms", tags);
+        }
+        ReportMetric("dynamicCube.frameTime", ms(frameTime.p50).count(), "ms", tags);
+        ReportMetric("dynamicCube.frameTimeP99", ms(frameTime.p99).count(), "ms", tags);
+    }
 }  // namespace Conformance
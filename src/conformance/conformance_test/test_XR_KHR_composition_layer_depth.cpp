@@ -66,7 +66,8 @@ namespace Conformance
 
         auto&& layerFlagsGenerator = bitmaskGeneratorIncluding0({XR_COMPOSITION_LAYER_CORRECT_CHROMATIC_ABERRATION_BIT,
                                                                  XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT,
-                                                                 XR_COMPOSITION_LAYER_UNPREMULTIPLIED_ALPHA_BIT});
+                                                                 XR_COMPOSITION_LAYER_UNPREMULTIPLIED_ALPHA_BIT},
+                                                                GetGlobalData().options.bitmaskCoverage);
         while (layerFlagsGenerator.next()) {
             // minDepth and maxDepth are the range of depth values the depthSwapchain could have,
             //   in the range of [0.0,1.0]. This is akin to min and max values of OpenGL's glDepthRange,
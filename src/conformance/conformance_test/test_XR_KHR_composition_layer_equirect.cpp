@@ -92,7 +92,8 @@ namespace Conformance
 
         auto&& layerFlagsGenerator = bitmaskGeneratorIncluding0({XR_COMPOSITION_LAYER_CORRECT_CHROMATIC_ABERRATION_BIT,
                                                                  XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT,
-                                                                 XR_COMPOSITION_LAYER_UNPREMULTIPLIED_ALPHA_BIT});
+                                                                 XR_COMPOSITION_LAYER_UNPREMULTIPLIED_ALPHA_BIT},
+                                                                GetGlobalData().options.bitmaskCoverage);
         std::array<XrEyeVisibility, 3> eyeVisibilityArray{XR_EYE_VISIBILITY_BOTH, XR_EYE_VISIBILITY_LEFT /* just these two */};
 
         while (layerFlagsGenerator.next()) {
@@ -268,12 +269,6 @@ namespace Conformance
         },
     };
 
-    static RGBAImageCache& EquirectImageCache()
-    {
-        static RGBAImageCache imageCache{};
-        imageCache.Init();
-        return imageCache;
-    }
     TEST_CASE("XR_KHR_composition_layer_equirect-interactive", "[composition][interactive]")
     {
         GlobalData& globalData = GetGlobalData();
@@ -305,9 +300,10 @@ namespace Conformance
 
             const XrSpace space = compositionHelper.CreateReferenceSpace(testCase.spaceType);
 
-            std::shared_ptr<RGBAImage> image = EquirectImageCache().Load(testCase.imagePath);
-            int32_t imageWidth = image->width;
-            int32_t imageHeight = image->height;
+            // The panoramas are large, so stream them to the swapchain rather than caching a decoded copy.
+            auto image = std::make_unique<RGBAImageFile>(testCase.imagePath);
+            int32_t imageWidth = image->Width();
+            int32_t imageHeight = image->Height();
 
             XrSwapchainCreateInfo createInfo = compositionHelper.DefaultColorSwapchainCreateInfo(
                 imageWidth, imageHeight, XR_SWAPCHAIN_CREATE_STATIC_IMAGE_BIT, GetGlobalData().graphicsPlugin->GetSRGBA8Format());
@@ -317,9 +313,14 @@ namespace Conformance
 
             XrSwapchain swapchain = compositionHelper.CreateSwapchain(createInfo);
 
+            auto writeRows = [&](uint32_t firstRow, uint32_t rowCount, uint8_t* dest, uint32_t rowPitch) {
+                image->CopyRows(firstRow, rowCount, dest, rowPitch);
+            };
             compositionHelper.AcquireWaitReleaseImage(swapchain, [&](const XrSwapchainImageBaseHeader* swapchainImage) {
-                GetGlobalData().graphicsPlugin->CopyRGBAImage(swapchainImage, 0, *image);
+                GetGlobalData().graphicsPlugin->CopyRGBAImageRows(swapchainImage, 0, imageWidth, imageHeight, writeRows);
             });
+            // The decoded pixels are not needed for the rest of the test.
+            image.reset();
 
             XrCompositionLayerEquirectKHR equirectLayer{XR_TYPE_COMPOSITION_LAYER_EQUIRECT_KHR};
             equirectLayer.space = space;
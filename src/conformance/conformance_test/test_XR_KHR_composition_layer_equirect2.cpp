@@ -134,12 +134,6 @@ namespace Conformance
         },
     };
 
-    static RGBAImageCache& Equirect2ImageCache()
-    {
-        static RGBAImageCache imageCache{};
-        imageCache.Init();
-        return imageCache;
-    }
     TEST_CASE("XR_KHR_composition_layer_equirect2-interactive", "[composition][interactive]")
     {
         GlobalData& globalData = GetGlobalData();
@@ -172,9 +166,10 @@ namespace Conformance
 
             const XrSpace space = compositionHelper.CreateReferenceSpace(testCase.spaceType);
 
-            std::shared_ptr<RGBAImage> image = Equirect2ImageCache().Load(testCase.imagePath);
-            int32_t imageWidth = image->width;
-            int32_t imageHeight = image->height;
+            // The panoramas are large, so stream them to the swapchain rather than caching a decoded copy.
+            auto image = std::make_unique<RGBAImageFile>(testCase.imagePath);
+            int32_t imageWidth = image->Width();
+            int32_t imageHeight = image->Height();
 
             XrSwapchainCreateInfo createInfo = compositionHelper.DefaultColorSwapchainCreateInfo(
                 imageWidth, imageHeight, XR_SWAPCHAIN_CREATE_STATIC_IMAGE_BIT, GetGlobalData().graphicsPlugin->GetSRGBA8Format());
@@ -184,9 +179,14 @@ namespace Conformance
 
             XrSwapchain swapchain = compositionHelper.CreateSwapchain(createInfo);
 
+            auto writeRows = [&](uint32_t firstRow, uint32_t rowCount, uint8_t* dest, uint32_t rowPitch) {
+                image->CopyRows(firstRow, rowCount, dest, rowPitch);
+            };
             compositionHelper.AcquireWaitReleaseImage(swapchain, [&](const XrSwapchainImageBaseHeader* swapchainImage) {
-                GetGlobalData().graphicsPlugin->CopyRGBAImage(swapchainImage, 0, *image);
+                GetGlobalData().graphicsPlugin->CopyRGBAImageRows(swapchainImage, 0, imageWidth, imageHeight, writeRows);
             });
+            // The decoded pixels are not needed for the rest of the test.
+            image.reset();
 
             XrCompositionLayerEquirect2KHR equirect2Layer{XR_TYPE_COMPOSITION_LAYER_EQUIRECT2_KHR};
             equirect2Layer.space = space;
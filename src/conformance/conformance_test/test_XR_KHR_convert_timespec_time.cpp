@@ -17,6 +17,7 @@
 #include "utilities/utils.h"
 #include "conformance_utils.h"
 #include "conformance_framework.h"
+#include "time_conversion_benchmark.h"
 #include <catch2/catch_test_macros.hpp>
 #include <openxr/openxr.h>
 
@@ -152,6 +153,43 @@ namespace Conformance
 
             REQUIRE(timespecAfter > timespecBefore);
         }
+#endif  // XR_USE_TIMESPEC
+    }
+
+    // Not a conformance requirement: see RunTimeConversionBenchmark.
+    TEST_CASE("XR_KHR_convert_timespec_time-Benchmark", "[XR_KHR_convert_timespec_time][.][benchmark]")
+    {
+#ifndef XR_USE_TIMESPEC
+        SKIP("XR_KHR_convert_timespec_time test not enabled in CTS");
+#else
+        GlobalData& globalData = GetGlobalData();
+        if (!globalData.IsInstanceExtensionSupported(XR_KHR_CONVERT_TIMESPEC_TIME_EXTENSION_NAME)) {
+            SKIP(XR_KHR_CONVERT_TIMESPEC_TIME_EXTENSION_NAME " not supported");
+        }
+
+        AutoBasicInstance instance({XR_KHR_CONVERT_TIMESPEC_TIME_EXTENSION_NAME});
+        auto xrConvertTimespecTimeToTimeKHR =
+            GetInstanceExtensionFunction<PFN_xrConvertTimespecTimeToTimeKHR>(instance, "xrConvertTimespecTimeToTimeKHR");
+        auto xrConvertTimeToTimespecTimeKHR =
+            GetInstanceExtensionFunction<PFN_xrConvertTimeToTimespecTimeKHR>(instance, "xrConvertTimeToTimespecTimeKHR");
+        REQUIRE(xrConvertTimespecTimeToTimeKHR != nullptr);
+        REQUIRE(xrConvertTimeToTimespecTimeKHR != nullptr);
+        const XrInstance xrInstance = instance;
+
+        RunTimeConversionBenchmark<timespec>(
+            "timespec",
+            [] {
+                timespec ts;
+#ifdef XR_USE_PLATFORM_WIN32
+                timespec_get(&ts, TIME_UTC);
+#else
+                clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+                return ts;
+            },
+            [&](const timespec* ts, XrTime* time) { return xrConvertTimespecTimeToTimeKHR(xrInstance, ts, time); },
+            [&](XrTime time, timespec* ts) { return xrConvertTimeToTimespecTimeKHR(xrInstance, time, ts); },
+            [](const timespec& ts) { return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec; });
 #endif  // XR_USE_TIMESPEC
     }
 }  // namespace Conformance
@@ -18,6 +18,7 @@
 #include "composition_utils.h"
 #include "conformance_framework.h"
 #include "conformance_utils.h"
+#include "report.h"
 #include "utilities/array_size.h"
 #include "utilities/bitmask_to_string.h"
 #include "utilities/types_and_constants.h"
@@ -29,7 +30,13 @@
 #include <openxr/openxr.h>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
 
 namespace Conformance
 {
@@ -39,6 +46,89 @@ namespace Conformance
     {
         const auto kExtensionRequirements = FeatureSet{FeatureBitIndex::BIT_XR_VERSION_1_0, FeatureBitIndex::BIT_XR_KHR_locate_spaces};
         const auto kPromotedCoreRequirements = FeatureSet{FeatureBitIndex::BIT_XR_VERSION_1_1};
+
+        /// Number of spaces created by the throughput benchmark, half reference spaces and half action spaces.
+        /// A multiple of every batch size, so each batch is a contiguous range of the space list.
+        constexpr uint32_t kBenchmarkSpaceCount = 64;
+        constexpr uint32_t kBenchmarkBatchSizes[] = {1, 4, 16, 64};
+        /// Batches located by each thread for one measurement.
+        constexpr uint32_t kBenchmarkIterations = 2000;
+
+        struct LocateThroughputResult
+        {
+            /// Spaces located per second, summed over all threads.
+            double spacesPerSecond{0};
+            /// Time taken to locate one batch of spaces.
+            DurationPercentiles batchLatency;
+            /// First failing result returned by any thread, or XR_SUCCESS.
+            XrResult result{XR_SUCCESS};
+        };
+
+        /// Call @p locateBatch kBenchmarkIterations times from each of @p threadCount threads, walking the space list
+        /// @p batchSize spaces at a time. @p locateBatch must be thread-safe and is passed the first space index.
+        /// Makes no assertions, as Catch2 assertions are not thread-safe: the caller checks the recorded result.
+        template <typename LocateBatch>
+        LocateThroughputResult MeasureLocateThroughput(uint32_t threadCount, uint32_t batchSize, LocateBatch&& locateBatch)
+        {
+            using clock = std::chrono::steady_clock;
+
+            std::vector<std::vector<std::chrono::nanoseconds>> threadSamples(threadCount);
+            std::atomic<uint32_t> readyCount{0};
+            std::atomic<bool> go{false};
+            std::atomic<int32_t> firstFailure{XR_SUCCESS};
+
+            auto worker = [&](uint32_t threadIndex) {
+                ATTACH_THREAD;
+                std::vector<std::chrono::nanoseconds>& samples = threadSamples[threadIndex];
+                samples.reserve(kBenchmarkIterations);
+
+                ++readyCount;
+                while (!go) {
+                    std::this_thread::yield();
+                }
+
+                // Stagger the threads through the space list so they do not all locate the same batch.
+                uint32_t first = (threadIndex * batchSize) % kBenchmarkSpaceCount;
+                for (uint32_t i = 0; i < kBenchmarkIterations; ++i) {
+                    const clock::time_point start = clock::now();
+                    const XrResult result = locateBatch(first, batchSize);
+                    samples.push_back(clock::now() - start);
+                    if (XR_FAILED(result)) {
+                        int32_t expected = XR_SUCCESS;
+                        firstFailure.compare_exchange_strong(expected, result);
+                        break;
+                    }
+                    first = (first + batchSize) % kBenchmarkSpaceCount;
+                }
+                DETACH_THREAD;
+            };
+
+            std::vector<std::thread> threads;
+            for (uint32_t i = 0; i < threadCount; ++i) {
+                threads.emplace_back(worker, i);
+            }
+            while (readyCount != threadCount) {
+                std::this_thread::yield();
+            }
+            const clock::time_point start = clock::now();
+            go = true;
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+            const std::chrono::duration<double> wallTime = clock::now() - start;
+
+            std::vector<std::chrono::nanoseconds> allSamples;
+            allSamples.reserve(size_t(threadCount) * kBenchmarkIterations);
+            for (const auto& samples : threadSamples) {
+                allSamples.insert(allSamples.end(), samples.begin(), samples.end());
+            }
+
+            LocateThroughputResult result;
+            result.spacesPerSecond = double(allSamples.size()) * batchSize / wallTime.count();
+            result.batchLatency = DurationPercentiles::FromSamples(std::move(allSamples));
+            result.result = static_cast<XrResult>(firstFailure.load());
+            return result;
+        }
     };  // namespace
 
     static inline void SharedLocateSpaces(const FeatureSet& featureSet)
@@ -555,4 +645,163 @@ namespace Conformance
     {
         SharedLocateSpaces(kExtensionRequirements);
     }
+
+    TEST_CASE("LocateSpaces_Throughput_Benchmark", "[.][benchmark]")
+    {
+        GlobalData& globalData = GetGlobalData();
+
+        // Prefer the extension when both are available, as SharedLocateSpaces does.
+        FeatureSet available;
+        globalData.PopulateVersionAndAvailableExtensions(available);
+        const FeatureSet& featureSet =
+            kExtensionRequirements.IsSatisfiedBy(available) ? kExtensionRequirements : kPromotedCoreRequirements;
+        const std::vector<const char*> extensions = SkipOrGetExtensions("Locate spaces", globalData, featureSet);
+
+        AutoBasicInstance instance(extensions, AutoBasicInstance::createSystemId);
+
+        PFN_xrLocateSpacesKHR xrLocateSpacesPFN = nullptr;
+        if (featureSet.Get(FeatureBitIndex::BIT_XR_KHR_locate_spaces)) {
+            xrLocateSpacesPFN = GetInstanceExtensionFunction<PFN_xrLocateSpacesKHR>(instance, "xrLocateSpacesKHR");
+        }
+        else {
+            xrLocateSpacesPFN = &xrLocateSpaces;
+        }
+
+        AutoBasicSession session(AutoBasicSession::createSession | AutoBasicSession::beginSession | AutoBasicSession::createSwapchains |
+                                     AutoBasicSession::createSpaces,
+                                 instance);
+
+        // A pose action on both hands, so half of the located spaces go through the input system.
+        XrActionSet actionSet{XR_NULL_HANDLE};
+        XrAction poseAction{XR_NULL_HANDLE};
+        const std::vector<XrPath> subactionPaths{StringToPath(instance, "/user/hand/left"), StringToPath(instance, "/user/hand/right")};
+        {
+            XrActionSetCreateInfo actionSetInfo{XR_TYPE_ACTION_SET_CREATE_INFO};
+            strcpy(actionSetInfo.actionSetName, "locate_benchmark");
+            strcpy(actionSetInfo.localizedActionSetName, "Locate Benchmark");
+            XRC_CHECK_THROW_XRCMD(xrCreateActionSet(instance, &actionSetInfo, &actionSet));
+
+            XrActionCreateInfo actionInfo{XR_TYPE_ACTION_CREATE_INFO};
+            actionInfo.actionType = XR_ACTION_TYPE_POSE_INPUT;
+            strcpy(actionInfo.actionName, "pose");
+            strcpy(actionInfo.localizedActionName, "Pose");
+            actionInfo.subactionPaths = subactionPaths.data();
+            actionInfo.countSubactionPaths = (uint32_t)subactionPaths.size();
+            XRC_CHECK_THROW_XRCMD(xrCreateAction(actionSet, &actionInfo, &poseAction));
+
+            const std::vector<XrActionSuggestedBinding> bindings = {
+                {poseAction, StringToPath(instance, "/user/hand/left/input/grip/pose")},
+                {poseAction, StringToPath(instance, "/user/hand/right/input/grip/pose")},
+            };
+            XrInteractionProfileSuggestedBinding suggestedBindings{XR_TYPE_INTERACTION_PROFILE_SUGGESTED_BINDING};
+            suggestedBindings.interactionProfile = StringToPath(instance, "/interaction_profiles/khr/simple_controller");
+            suggestedBindings.suggestedBindings = bindings.data();
+            suggestedBindings.countSuggestedBindings = (uint32_t)bindings.size();
+            XRC_CHECK_THROW_XRCMD(xrSuggestInteractionProfileBindings(instance, &suggestedBindings));
+
+            XrSessionActionSetsAttachInfo attachInfo{XR_TYPE_SESSION_ACTION_SETS_ATTACH_INFO};
+            attachInfo.actionSets = &actionSet;
+            attachInfo.countActionSets = 1;
+            XRC_CHECK_THROW_XRCMD(xrAttachSessionActionSets(session, &attachInfo));
+        }
+
+        // Spaces are destroyed along with the session.
+        XrSpace baseSpace{XR_NULL_HANDLE};
+        {
+            XrReferenceSpaceCreateInfo spaceCreateInfo{XR_TYPE_REFERENCE_SPACE_CREATE_INFO};
+            spaceCreateInfo.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_LOCAL;
+            spaceCreateInfo.poseInReferenceSpace = Pose::Identity;
+            XRC_CHECK_THROW_XRCMD(xrCreateReferenceSpace(session, &spaceCreateInfo, &baseSpace));
+        }
+        std::vector<XrSpace> spaces(kBenchmarkSpaceCount, XR_NULL_HANDLE);
+        for (uint32_t i = 0; i < kBenchmarkSpaceCount; ++i) {
+            const XrPosef offset{Quat::Identity, {0.01f * i, 0, -0.5f}};
+            if (i % 2 == 0) {
+                XrReferenceSpaceCreateInfo spaceCreateInfo{XR_TYPE_REFERENCE_SPACE_CREATE_INFO};
+                spaceCreateInfo.referenceSpaceType = (i % 4 == 0) ? XR_REFERENCE_SPACE_TYPE_VIEW : XR_REFERENCE_SPACE_TYPE_LOCAL;
+                spaceCreateInfo.poseInReferenceSpace = offset;
+                XRC_CHECK_THROW_XRCMD(xrCreateReferenceSpace(session, &spaceCreateInfo, &spaces[i]));
+            }
+            else {
+                XrActionSpaceCreateInfo spaceCreateInfo{XR_TYPE_ACTION_SPACE_CREATE_INFO};
+                spaceCreateInfo.action = poseAction;
+                spaceCreateInfo.subactionPath = subactionPaths[(i / 2) % 2];
+                spaceCreateInfo.poseInActionSpace = offset;
+                XRC_CHECK_THROW_XRCMD(xrCreateActionSpace(session, &spaceCreateInfo, &spaces[i]));
+            }
+        }
+
+        // Get frames iterating to the point of app focused state, and sync the actions once so the action spaces
+        // are located the way an application would locate them.
+        FrameIterator frameIterator(&session);
+        frameIterator.RunToSessionState(XR_SESSION_STATE_FOCUSED);
+        FrameIterator::RunResult runResult = frameIterator.SubmitFrame();
+        REQUIRE(runResult == FrameIterator::RunResult::Success);
+        const XrTime time = frameIterator.frameState.predictedDisplayTime;
+        REQUIRE(time != 0);
+        {
+            const XrActiveActionSet activeActionSet{actionSet, XR_NULL_PATH};
+            XrActionsSyncInfo syncInfo{XR_TYPE_ACTIONS_SYNC_INFO};
+            syncInfo.countActiveActionSets = 1;
+            syncInfo.activeActionSets = &activeActionSet;
+            XRC_CHECK_THROW_XRCMD(xrSyncActions(session, &syncInfo));
+        }
+
+        auto locateEach = [&](uint32_t first, uint32_t count) {
+            XrSpaceLocation location{XR_TYPE_SPACE_LOCATION};
+            for (uint32_t i = first; i < first + count; ++i) {
+                const XrResult result = xrLocateSpace(spaces[i], baseSpace, time, &location);
+                if (XR_FAILED(result)) {
+                    return result;
+                }
+            }
+            return XR_SUCCESS;
+        };
+        auto locateBatched = [&](uint32_t first, uint32_t count) {
+            // Each thread keeps its own output array, sized for the largest batch.
+            thread_local std::vector<XrSpaceLocationDataKHR> locationData;
+            locationData.resize(kBenchmarkSpaceCount);
+
+            XrSpacesLocateInfoKHR locateInfo{XR_TYPE_SPACES_LOCATE_INFO_KHR};
+            locateInfo.baseSpace = baseSpace;
+            locateInfo.time = time;
+            locateInfo.spaceCount = count;
+            locateInfo.spaces = spaces.data() + first;
+            XrSpaceLocationsKHR locations{XR_TYPE_SPACE_LOCATIONS_KHR};
+            locations.locationCount = count;
+            locations.locations = locationData.data();
+            return xrLocateSpacesPFN(session, &locateInfo, &locations);
+        };
+
+        std::vector<uint32_t> threadCounts{1};
+        const uint32_t maxThreadCount = std::min(std::max(std::thread::hardware_concurrency(), 1u), 8u);
+        while (threadCounts.back() * 2 <= maxThreadCount) {
+            threadCounts.push_back(threadCounts.back() * 2);
+        }
+
+        using us = std::chrono::duration<double, std::micro>;
+        auto report = [](const char* mode, const LocateThroughputResult& measured, const std::vector<MetricTag>& commonTags) {
+            std::vector<MetricTag> tags = commonTags;
+            tags.push_back({"mode", mode});
+            ReportMetric("LocateSpaces.throughput", measured.spacesPerSecond, "spaces/s", tags);
+            ReportMetric("LocateSpaces.batchLatency.p50", us(measured.batchLatency.p50).count(), "us", tags);
+            ReportMetric("LocateSpaces.batchLatency.p99", us(measured.batchLatency.p99).count(), "us", tags);
+        };
+
+        for (uint32_t batchSize : kBenchmarkBatchSizes) {
+            for (uint32_t threadCount : threadCounts) {
+                CAPTURE(batchSize, threadCount);
+                const std::vector<MetricTag> tags{{"batch", std::to_string(batchSize)}, {"threads", std::to_string(threadCount)}};
+
+                const LocateThroughputResult each = MeasureLocateThroughput(threadCount, batchSize, locateEach);
+                REQUIRE(each.result == XR_SUCCESS);
+                const LocateThroughputResult batched = MeasureLocateThroughput(threadCount, batchSize, locateBatched);
+                REQUIRE(batched.result == XR_SUCCESS);
+
+                report("xrLocateSpace", each, tags);
+                report("xrLocateSpaces", batched, tags);
+                ReportMetric("LocateSpaces.batchingSpeedup", batched.spacesPerSecond / each.spacesPerSecond, "ratio", tags);
+            }
+        }
+    }
 }  // namespace Conformance
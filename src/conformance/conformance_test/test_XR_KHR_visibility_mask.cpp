@@ -23,6 +23,7 @@
 #include "two_call_struct_tests.h"
 #include "type_utils.h"
 #include "matchers.h"
+#include "report.h"
 #include "utilities/Geometry.h"
 #include "utilities/types_and_constants.h"
 
@@ -35,7 +36,9 @@
 #include <openxr/openxr.h>
 
 #include <array>
+#include <chrono>
 #include <cstdint>
+#include <cstring>
 #include <functional>
 #include <memory>
 #include <string>
@@ -425,4 +428,91 @@ namespace Conformance
             }
         }
     }
+
+    // Not a conformance requirement: renders the same overdraw-heavy scene with and without the visibility mask depth
+    // pre-pass and reports the GPU time of each, to measure the fill rate the hidden area saves on this device's optics.
+    // The mask is drawn in bright red, so it also shows on the mirror view whether the masks line up with the optics.
+    TEST_CASE("XR_KHR_visibility_mask_Benchmark", "[XR_KHR_visibility_mask][.][benchmark]")
+    {
+        using ms = std::chrono::duration<double, std::milli>;
+
+        GlobalData& globalData = GetGlobalData();
+        if (!globalData.IsUsingGraphicsPlugin()) {
+            SKIP("Test run not using graphics plugin");
+        }
+        if (!globalData.IsInstanceExtensionSupported(XR_KHR_VISIBILITY_MASK_EXTENSION_NAME)) {
+            SKIP(XR_KHR_VISIBILITY_MASK_EXTENSION_NAME " not supported");
+        }
+        IGraphicsPlugin& graphicsPlugin = *globalData.graphicsPlugin;
+        if (!graphicsPlugin.SupportsGpuTimers()) {
+            SKIP("Graphics plugin cannot time the GPU");
+        }
+
+        CompositionHelper compositionHelper("Visibility Mask benchmark", {XR_KHR_VISIBILITY_MASK_EXTENSION_NAME});
+        compositionHelper.GetInteractionManager().AttachActionSets();
+        SimpleProjectionLayerHelper simpleProjectionLayerHelper(compositionHelper);
+        compositionHelper.BeginSession();
+
+        // Layers of large cubes covering the whole field of view, drawn back to front so that every layer is shaded.
+        std::vector<Cube> cubes;
+        for (int layer = 3; layer >= 0; --layer) {
+            for (int x = -3; x <= 3; ++x) {
+                for (int y = -3; y <= 3; ++y) {
+                    cubes.push_back(Cube::Make({x * 0.5f, y * 0.5f, -1.0f - layer * 0.25f}, 0.5f));
+                }
+            }
+        }
+
+        constexpr const char* VisibilityMaskGpuTimerScope = "VisibilityMask";
+        constexpr int warmupFrameCount = 30;
+        constexpr int testFrameCount = 300;
+        double gpuTimeWithoutMask = 0.0;
+
+        for (bool prePass : {false, true}) {
+            if (prePass && !simpleProjectionLayerHelper.EnableVisibilityMaskPrePass(BrightRed)) {
+                SKIP("No hidden area mesh available in this system.");
+            }
+
+            std::vector<std::chrono::nanoseconds> gpuTimes;
+            std::vector<GpuTimerSample> gpuTimerSamples;
+            int frameCount = 0;
+            auto updateLayers = [&](const XrFrameState& frameState) {
+                std::vector<XrCompositionLayerBaseHeader*> layers;
+                if (frameState.shouldRender) {
+                    graphicsPlugin.BeginGpuTimerScope(VisibilityMaskGpuTimerScope);
+                    XrCompositionLayerBaseHeader* projLayer = simpleProjectionLayerHelper.TryGetUpdatedProjectionLayer(frameState, cubes);
+                    if (projLayer != nullptr) {
+                        layers.push_back(projLayer);
+                    }
+                    graphicsPlugin.EndGpuTimerScope();
+                }
+                compositionHelper.EndFrame(frameState.predictedDisplayTime, layers);
+
+                gpuTimerSamples.clear();
+                graphicsPlugin.CollectGpuTimerSamples(gpuTimerSamples);
+                for (const GpuTimerSample& sample : gpuTimerSamples) {
+                    if (frameCount >= warmupFrameCount && std::strcmp(sample.name, VisibilityMaskGpuTimerScope) == 0) {
+                        gpuTimes.push_back(sample.duration);
+                    }
+                }
+                return ++frameCount < warmupFrameCount + testFrameCount;
+            };
+            RenderLoop(compositionHelper.GetSession(), updateLayers).Loop();
+
+            REQUIRE_FALSE(gpuTimes.empty());
+            const DurationPercentiles gpuTime = DurationPercentiles::FromSamples(std::move(gpuTimes));
+            const std::vector<MetricTag> tags{{"prePass", prePass ? "true" : "false"}};
+            ReportMetric("visibilityMask.gpuTime", ms(gpuTime.p50).count(), "ms", tags);
+            ReportMetric("visibilityMask.gpuTimeP99", ms(gpuTime.p99).count(), "ms", tags);
+            if (!prePass) {
+                gpuTimeWithoutMask = ms(gpuTime.p50).count();
+            }
+            else if (gpuTimeWithoutMask > 0.0) {
+                const double savings = 100.0 * (1.0 - ms(gpuTime.p50).count() / gpuTimeWithoutMask);
+                ReportConsoleOnlyF("Visibility mask pre-pass: GPU time %.3fms -> %.3fms (%.1f%% saved)", gpuTimeWithoutMask,
+                                   ms(gpuTime.p50).count(), savings);
+                ReportMetric("visibilityMask.gpuTimeSaved", savings, "%");
+            }
+        }
+    }
 }  // namespace Conformance
@@ -19,6 +19,7 @@
 #include "utilities/xrduration_literals.h"
 #include "conformance_utils.h"
 #include "conformance_framework.h"
+#include "time_conversion_benchmark.h"
 #include <catch2/catch_test_macros.hpp>
 #include <openxr/openxr.h>
 
@@ -139,6 +140,45 @@ namespace Conformance
             REQUIRE(qpcAfter > qpcBefore);
         }
     }
+
+    // Not a conformance requirement: see RunTimeConversionBenchmark.
+    TEST_CASE("XR_KHR_win32_convert_performance_counter_time-Benchmark", "[XR_KHR_win32_convert_performance_counter_time][.][benchmark]")
+    {
+        GlobalData& globalData = GetGlobalData();
+        if (!globalData.IsInstanceExtensionSupported(XR_KHR_WIN32_CONVERT_PERFORMANCE_COUNTER_TIME_EXTENSION_NAME)) {
+            SKIP(XR_KHR_WIN32_CONVERT_PERFORMANCE_COUNTER_TIME_EXTENSION_NAME " not supported");
+        }
+
+        AutoBasicInstance instance({XR_KHR_WIN32_CONVERT_PERFORMANCE_COUNTER_TIME_EXTENSION_NAME});
+        auto xrConvertWin32PerformanceCounterToTimeKHR = GetInstanceExtensionFunction<PFN_xrConvertWin32PerformanceCounterToTimeKHR>(
+            instance, "xrConvertWin32PerformanceCounterToTimeKHR");
+        auto xrConvertTimeToWin32PerformanceCounterKHR = GetInstanceExtensionFunction<PFN_xrConvertTimeToWin32PerformanceCounterKHR>(
+            instance, "xrConvertTimeToWin32PerformanceCounterKHR");
+        REQUIRE(xrConvertWin32PerformanceCounterToTimeKHR != nullptr);
+        REQUIRE(xrConvertTimeToWin32PerformanceCounterKHR != nullptr);
+        const XrInstance xrInstance = instance;
+
+        LARGE_INTEGER qpcFreq;
+        QueryPerformanceFrequency(&qpcFreq);
+
+        RunTimeConversionBenchmark<LARGE_INTEGER>(
+            "win32PerformanceCounter",
+            [] {
+                LARGE_INTEGER counter;
+                QueryPerformanceCounter(&counter);
+                return counter;
+            },
+            [&](const LARGE_INTEGER* counter, XrTime* time) {
+                return xrConvertWin32PerformanceCounterToTimeKHR(xrInstance, counter, time);
+            },
+            [&](XrTime time, LARGE_INTEGER* counter) { return xrConvertTimeToWin32PerformanceCounterKHR(xrInstance, time, counter); },
+            [&](const LARGE_INTEGER& counter) {
+                // Split the division so that the multiplication cannot overflow.
+                const int64_t seconds = counter.QuadPart / qpcFreq.QuadPart;
+                const int64_t remainder = counter.QuadPart % qpcFreq.QuadPart;
+                return seconds * 1000000000 + remainder * 1000000000 / qpcFreq.QuadPart;
+            });
+    }
 }  // namespace Conformance
    //
 #endif  // XR_USE_PLATFORM_WIN32
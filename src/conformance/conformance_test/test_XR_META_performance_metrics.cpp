@@ -17,6 +17,7 @@
 
 #include "conformance_framework.h"
 #include "conformance_utils.h"
+#include "report.h"
 #include "two_call.h"
 
 #include <catch2/catch_test_macros.hpp>
@@ -123,6 +124,14 @@ namespace Conformance
                     // Querying the results for the same metric again should give type of result
                     REQUIRE(counter.counterFlags == counterAgain.counterFlags);
                 }
+
+                if ((counter.counterFlags & XR_PERFORMANCE_METRICS_COUNTER_ANY_VALUE_VALID_BIT_META) != 0) {
+                    const double value = (counter.counterFlags & XR_PERFORMANCE_METRICS_COUNTER_FLOAT_VALUE_VALID_BIT_META) != 0
+                                             ? static_cast<double>(counter.floatValue)
+                                             : static_cast<double>(counter.uintValue);
+                    ReportMetric(PathToString(instance, path), value, PerformanceMetricsCounterUnitName(counter.counterUnit),
+                                 {{"source", XR_META_PERFORMANCE_METRICS_EXTENSION_NAME}});
+                }
             }
         }
     }
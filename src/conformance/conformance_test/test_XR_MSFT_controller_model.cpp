@@ -7,6 +7,7 @@
 #include "conformance_framework.h"
 #include "conformance_utils.h"
 #include "controller_animation_handler.h"
+#include "controller_model_loader.h"
 #include "cts_tinygltf.h"
 #include "graphics_plugin.h"
 #include "input_testinputdevice.h"
@@ -87,16 +88,19 @@ namespace Conformance
             // plus regular two-call for the model itself
             auto modelPropertiesTwoCallData = getTwoCallStructData<XrControllerModelPropertiesMSFT>();
             auto modelStateTwoCallData = getTwoCallStructData<XrControllerModelStateMSFT>();
+            // Shared by all the model keys, so the arrays are only grown, not allocated again for each key
+            auto modelPropertiesStorage = MakeTwoCallStructStorage(modelPropertiesTwoCallData);
+            auto modelStateStorage = MakeTwoCallStructStorage(modelStateTwoCallData);
             for (auto modelKey : modelKeys) {
                 INFO("Model key: " << Uint64ToHexString(modelKey));
-                CheckTwoCallStructConformance(modelPropertiesTwoCallData, {XR_TYPE_CONTROLLER_MODEL_PROPERTIES_MSFT},
+                CheckTwoCallStructConformance(modelPropertiesStorage, {XR_TYPE_CONTROLLER_MODEL_PROPERTIES_MSFT},
                                               "xrGetControllerModelPropertiesMSFT", false,
                                               [&](XrControllerModelPropertiesMSFT* properties) {
                                                   return xrGetControllerModelPropertiesMSFT_(session, modelKey, properties);
                                               });
 
                 CheckTwoCallStructConformance(
-                    modelStateTwoCallData, {XR_TYPE_CONTROLLER_MODEL_STATE_MSFT}, "xrGetControllerModelStateMSFT", false,
+                    modelStateStorage, {XR_TYPE_CONTROLLER_MODEL_STATE_MSFT}, "xrGetControllerModelStateMSFT", false,
                     [&](XrControllerModelStateMSFT* state) { return xrGetControllerModelStateMSFT_(session, modelKey, state); });
                 CHECK_TWO_CALL(uint8_t, {}, xrLoadControllerModelMSFT_, session, modelKey);
             }
@@ -352,9 +356,12 @@ namespace Conformance
             XrPath subactionPath;
             XrSpace space;
             XrControllerModelKeyMSFT modelKey;
+            bool modelLoaded;
             GLTFModelHandle controllerModel;
             GLTFModelInstanceHandle controllerModelInstance;
             ControllerAnimationHandler animationHandler;
+            // Reused every frame, so that querying and applying the node states does not allocate.
+            std::vector<XrControllerModelNodeStateMSFT> nodeStates;
         };
 
         Hand hands[2] = {};
@@ -411,9 +418,12 @@ namespace Conformance
         XrSession session = compositionHelper.GetSession();
         auto& graphicsPlugin = GetGlobalData().graphicsPlugin;
 
+        // Fetches, parses and decodes the models on worker threads, so that the first frames do not stall on them.
+        ControllerModelLoader modelLoader(session, ext.xrLoadControllerModelMSFT_, *graphicsPlugin);
+
         // Create the instructional quad layer placed to the left.
         XrCompositionLayerQuad* const instructionsQuad =
-            compositionHelper.CreateQuadLayer(compositionHelper.CreateStaticSwapchainImage(CreateTextImage(1024, 768, instructions, 48)),
+            compositionHelper.CreateQuadLayer(compositionHelper.CreateStaticSwapchainText(1024, 768, instructions, 48),
                                               localSpace, 1, {{0, 0, 0, 1}, {-1.5f, 0, -0.3f}});
         instructionsQuad->pose.orientation = Quat::FromAxisAngle(Up, DegToRad(70));
 
@@ -449,23 +459,20 @@ namespace Conformance
             }
 
             for (Hand& hand : hands) {
-                if (hand.modelKey != XR_NULL_CONTROLLER_MODEL_KEY_MSFT) {
+                if (hand.modelLoaded) {
                     continue;
                 }
-                XrControllerModelKeyStateMSFT modelKeyState{XR_TYPE_CONTROLLER_MODEL_KEY_STATE_MSFT};
-                CHECK_RESULT_UNQUALIFIED_SUCCESS(ext.xrGetControllerModelKeyMSFT_(session, hand.subactionPath, &modelKeyState));
-                if (modelKeyState.modelKey != XR_NULL_CONTROLLER_MODEL_KEY_MSFT) {
-                    ReportF("Loaded model key");
-                    hand.modelKey = modelKeyState.modelKey;
-
-                    uint32_t modelBufferSize;
-                    REQUIRE_RESULT_UNQUALIFIED_SUCCESS(
-                        ext.xrLoadControllerModelMSFT_(session, hand.modelKey, 0, &modelBufferSize, nullptr));
-                    std::vector<uint8_t> modelBuffer(modelBufferSize);
-                    REQUIRE_RESULT_UNQUALIFIED_SUCCESS(
-                        ext.xrLoadControllerModelMSFT_(session, hand.modelKey, modelBufferSize, &modelBufferSize, modelBuffer.data()));
-
-                    hand.controllerModel = GetGlobalData().graphicsPlugin->LoadGLTF(modelBuffer);
+                if (hand.modelKey == XR_NULL_CONTROLLER_MODEL_KEY_MSFT) {
+                    XrControllerModelKeyStateMSFT modelKeyState{XR_TYPE_CONTROLLER_MODEL_KEY_STATE_MSFT};
+                    CHECK_RESULT_UNQUALIFIED_SUCCESS(ext.xrGetControllerModelKeyMSFT_(session, hand.subactionPath, &modelKeyState));
+                    if (modelKeyState.modelKey != XR_NULL_CONTROLLER_MODEL_KEY_MSFT) {
+                        ReportF("Loaded model key");
+                        hand.modelKey = modelKeyState.modelKey;
+                        modelLoader.Request(hand.modelKey);
+                    }
+                }
+                if (hand.modelKey != XR_NULL_CONTROLLER_MODEL_KEY_MSFT && modelLoader.TryGetModel(hand.modelKey, &hand.controllerModel)) {
+                    hand.modelLoaded = true;
                     hand.controllerModelInstance = GetGlobalData().graphicsPlugin->CreateGLTFModelInstance(hand.controllerModel);
 
                     XrControllerModelPropertiesMSFT modelProperties{XR_TYPE_CONTROLLER_MODEL_PROPERTIES_MSFT};
@@ -487,18 +494,18 @@ namespace Conformance
                 XrSpaceLocation spaceLocation{XR_TYPE_SPACE_LOCATION, &spaceVelocity};
                 XRC_CHECK_THROW_XRCMD(xrLocateSpace(hand.space, localSpace, frameState.predictedDisplayTime, &spaceLocation));
                 if (spaceLocation.locationFlags & XR_SPACE_LOCATION_POSITION_VALID_BIT) {
-                    if (hand.modelKey == XR_NULL_CONTROLLER_MODEL_KEY_MSFT) {
+                    if (!hand.modelLoaded) {
                         renderedCubes.push_back(Cube{spaceLocation.pose, {0.1f, 0.1f, 0.1f}});
                     }
                     else {
                         XrControllerModelStateMSFT modelState{XR_TYPE_CONTROLLER_MODEL_STATE_MSFT};
                         REQUIRE_RESULT_UNQUALIFIED_SUCCESS(ext.xrGetControllerModelStateMSFT_(session, hand.modelKey, &modelState));
-                        std::vector<XrControllerModelNodeStateMSFT> nodeStateBuffer(modelState.nodeCountOutput);
-                        modelState.nodeCapacityInput = (uint32_t)nodeStateBuffer.size();
-                        modelState.nodeStates = nodeStateBuffer.data();
+                        hand.nodeStates.resize(modelState.nodeCountOutput, {XR_TYPE_CONTROLLER_MODEL_NODE_STATE_MSFT});
+                        modelState.nodeCapacityInput = (uint32_t)hand.nodeStates.size();
+                        modelState.nodeStates = hand.nodeStates.data();
                         REQUIRE_RESULT_UNQUALIFIED_SUCCESS(ext.xrGetControllerModelStateMSFT_(session, hand.modelKey, &modelState));
 
-                        hand.animationHandler.UpdateControllerParts(nodeStateBuffer,
+                        hand.animationHandler.UpdateControllerParts(hand.nodeStates,
                                                                     graphicsPlugin->GetModelInstance(hand.controllerModelInstance));
 
                         renderedGLTFs.push_back(GLTFDrawable{hand.controllerModelInstance, spaceLocation.pose});
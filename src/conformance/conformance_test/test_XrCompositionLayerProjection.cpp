@@ -168,7 +168,8 @@ namespace Conformance
                 INFO("Layer flags");
                 auto&& layerFlagsGenerator = bitmaskGeneratorIncluding0({XR_COMPOSITION_LAYER_CORRECT_CHROMATIC_ABERRATION_BIT,
                                                                          XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT,
-                                                                         XR_COMPOSITION_LAYER_UNPREMULTIPLIED_ALPHA_BIT});
+                                                                         XR_COMPOSITION_LAYER_UNPREMULTIPLIED_ALPHA_BIT},
+                                                                        GetGlobalData().options.bitmaskCoverage);
                 while (layerFlagsGenerator.next()) {
                     CAPTURE(XrCompositionLayerFlagsCPP(layerFlagsGenerator.get()));
                     XrFrameState frameState = waitAndBeginFrame();
@@ -23,6 +23,7 @@
 #include "matchers.h"
 #include "report.h"
 #include "two_call.h"
+#include "utilities/array_size.h"
 #include "utilities/feature_availability.h"
 #include "utilities/bitmask_to_string.h"
 #include "utilities/event_reader.h"
@@ -517,6 +518,7 @@ namespace Conformance
             }
             SECTION("Supports all specified interaction profiles")
             {
+                InteractionPathCache pathCache(instance);
                 for (const auto& ipMetadata : GetAllInteractionProfiles()) {
                     XrAction boolAction;
                     XrAction floatAction;
@@ -557,7 +559,7 @@ namespace Conformance
                     REQUIRE_RESULT(xrCreateAction(actionSet, &allIPActionCreateInfo, &hapticAction), XR_SUCCESS);
 
                     CAPTURE(ipMetadata.InteractionProfilePathString);
-                    bindings.interactionProfile = StringToPath(instance, ipMetadata.InteractionProfilePathString);
+                    bindings.interactionProfile = pathCache.GetInteractionProfilePath(ipMetadata);
                     bindings.countSuggestedBindings = 1;
                     for (const auto& inputSourcePathData : ipMetadata.InputSourcePaths) {
                         CAPTURE(inputSourcePathData.Path);
@@ -585,7 +587,7 @@ namespace Conformance
                             selectedAction = hapticAction;
                         }
 
-                        XrActionSuggestedBinding suggestedBindings{selectedAction, StringToPath(instance, inputSourcePathData.Path)};
+                        XrActionSuggestedBinding suggestedBindings{selectedAction, pathCache.GetInputSourcePath(inputSourcePathData)};
                         bindings.suggestedBindings = &suggestedBindings;
                         REQUIRE_RESULT(xrSuggestInteractionProfileBindings(instance, &bindings), XR_SUCCESS);
                     }
@@ -651,6 +653,7 @@ namespace Conformance
         XrInteractionProfileSuggestedBinding bindings{XR_TYPE_INTERACTION_PROFILE_SUGGESTED_BINDING};
         bindings.countSuggestedBindings = 1;
         XrActionSuggestedBinding suggestedBindings{};
+        InteractionPathCache pathCache(instance);
         XrAction boolAction;
         XrAction floatAction;
         XrAction vectorAction;
@@ -705,7 +708,7 @@ namespace Conformance
                 selectedAction = hapticAction;
             }
 
-            suggestedBindings = XrActionSuggestedBinding{selectedAction, StringToPath(instance, pathData.Path)};
+            suggestedBindings = XrActionSuggestedBinding{selectedAction, pathCache.GetInputSourcePath(pathData)};
             bindings.suggestedBindings = &suggestedBindings;
             CAPTURE(kInteractionAvailabilities[(size_t)pathData.Availability]);
             if (SatisfiedByDefault(pathData.Availability)) {
@@ -720,7 +723,7 @@ namespace Conformance
         CAPTURE(features);
         for (const InteractionProfileAvailMetadata& ipMetadata : GetAllInteractionProfiles()) {
             CAPTURE(ipMetadata.InteractionProfilePathString);
-            bindings.interactionProfile = StringToPath(instance, ipMetadata.InteractionProfilePathString);
+            bindings.interactionProfile = pathCache.GetInteractionProfilePath(ipMetadata);
             bindings.countSuggestedBindings = 1;
             if (SatisfiedByDefault(ipMetadata.Availability)) {
                 DYNAMIC_SECTION(ipMetadata.InteractionProfileShortname << " Expect Available")
@@ -3952,6 +3955,8 @@ namespace Conformance
 
                 SECTION("xrGetInputSourceLocalizedName-on-each")
                 {
+                    // Reused for every source and set of components, rather than allocating for each call.
+                    std::vector<char> localizedStringResult;
                     for (size_t i = 0; i < enumerateResult.size(); ++i) {
                         getInfo.sourcePath = enumerateResult[i];
                         CAPTURE(i);
@@ -3959,26 +3964,25 @@ namespace Conformance
                         auto s = PathToString(instance, getInfo.sourcePath);
                         CHECK(!s.empty());
                         CAPTURE(s);
-                        std::vector<char> localizedStringResult;
 
                         {
                             CAPTURE(XrInputSourceLocalizedNameFlagsRefCPP(getInfo.whichComponents) =
                                         XR_INPUT_SOURCE_LOCALIZED_NAME_USER_PATH_BIT);
-                            localizedStringResult = REQUIRE_TWO_CALL(char, {}, xrGetInputSourceLocalizedName, session, &getInfo);
+                            REQUIRE_TWO_CALL_INTO(localizedStringResult, char, {}, xrGetInputSourceLocalizedName, session, &getInfo);
                             CHECK(localizedStringResult.size() > 1);  // more than null terminator
                             CHECK_THAT(localizedStringResult, NullTerminatedVec());
                         }
                         {
                             CAPTURE(XrInputSourceLocalizedNameFlagsRefCPP(getInfo.whichComponents) =
                                         XR_INPUT_SOURCE_LOCALIZED_NAME_INTERACTION_PROFILE_BIT);
-                            localizedStringResult = REQUIRE_TWO_CALL(char, {}, xrGetInputSourceLocalizedName, session, &getInfo);
+                            REQUIRE_TWO_CALL_INTO(localizedStringResult, char, {}, xrGetInputSourceLocalizedName, session, &getInfo);
                             CHECK(localizedStringResult.size() > 1);  // more than null terminator
                             CHECK_THAT(localizedStringResult, NullTerminatedVec());
                         }
                         {
                             CAPTURE(XrInputSourceLocalizedNameFlagsRefCPP(getInfo.whichComponents) =
                                         XR_INPUT_SOURCE_LOCALIZED_NAME_COMPONENT_BIT);
-                            localizedStringResult = REQUIRE_TWO_CALL(char, {}, xrGetInputSourceLocalizedName, session, &getInfo);
+                            REQUIRE_TWO_CALL_INTO(localizedStringResult, char, {}, xrGetInputSourceLocalizedName, session, &getInfo);
                             CHECK(localizedStringResult.size() > 1);  // more than null terminator
                             CHECK_THAT(localizedStringResult, NullTerminatedVec());
                         }
@@ -3986,14 +3990,14 @@ namespace Conformance
                             CAPTURE(XrInputSourceLocalizedNameFlagsRefCPP(getInfo.whichComponents) =
                                         XR_INPUT_SOURCE_LOCALIZED_NAME_USER_PATH_BIT |
                                         XR_INPUT_SOURCE_LOCALIZED_NAME_INTERACTION_PROFILE_BIT);
-                            localizedStringResult = REQUIRE_TWO_CALL(char, {}, xrGetInputSourceLocalizedName, session, &getInfo);
+                            REQUIRE_TWO_CALL_INTO(localizedStringResult, char, {}, xrGetInputSourceLocalizedName, session, &getInfo);
                             CHECK(localizedStringResult.size() > 1);  // more than null terminator
                             CHECK_THAT(localizedStringResult, NullTerminatedVec());
                         }
                         {
                             CAPTURE(XrInputSourceLocalizedNameFlagsRefCPP(getInfo.whichComponents) =
                                         XR_INPUT_SOURCE_LOCALIZED_NAME_USER_PATH_BIT | XR_INPUT_SOURCE_LOCALIZED_NAME_COMPONENT_BIT);
-                            localizedStringResult = REQUIRE_TWO_CALL(char, {}, xrGetInputSourceLocalizedName, session, &getInfo);
+                            REQUIRE_TWO_CALL_INTO(localizedStringResult, char, {}, xrGetInputSourceLocalizedName, session, &getInfo);
                             CHECK(localizedStringResult.size() > 1);  // more than null terminator
                             CHECK_THAT(localizedStringResult, NullTerminatedVec());
                         }
@@ -4001,7 +4005,7 @@ namespace Conformance
                             CAPTURE(XrInputSourceLocalizedNameFlagsRefCPP(getInfo.whichComponents) =
                                         XR_INPUT_SOURCE_LOCALIZED_NAME_INTERACTION_PROFILE_BIT |
                                         XR_INPUT_SOURCE_LOCALIZED_NAME_COMPONENT_BIT);
-                            localizedStringResult = REQUIRE_TWO_CALL(char, {}, xrGetInputSourceLocalizedName, session, &getInfo);
+                            REQUIRE_TWO_CALL_INTO(localizedStringResult, char, {}, xrGetInputSourceLocalizedName, session, &getInfo);
                             CHECK(localizedStringResult.size() > 1);  // more than null terminator
                             CHECK_THAT(localizedStringResult, NullTerminatedVec());
                         }
@@ -4010,7 +4014,7 @@ namespace Conformance
                                         XR_INPUT_SOURCE_LOCALIZED_NAME_USER_PATH_BIT |
                                         XR_INPUT_SOURCE_LOCALIZED_NAME_INTERACTION_PROFILE_BIT |
                                         XR_INPUT_SOURCE_LOCALIZED_NAME_COMPONENT_BIT);
-                            localizedStringResult = REQUIRE_TWO_CALL(char, {}, xrGetInputSourceLocalizedName, session, &getInfo);
+                            REQUIRE_TWO_CALL_INTO(localizedStringResult, char, {}, xrGetInputSourceLocalizedName, session, &getInfo);
                             CHECK(localizedStringResult.size() > 1);  // more than null terminator
                             CHECK_THAT(localizedStringResult, NullTerminatedVec());
                         }
@@ -4038,4 +4042,172 @@ namespace Conformance
             }
         }
     }
+
+    TEST_CASE("xrSyncActions_Benchmark", "[.][benchmark][actions]")
+    {
+        using clock = std::chrono::steady_clock;
+        using us = std::chrono::duration<double, std::micro>;
+
+        // Frames measured for each action set count and action count.
+        constexpr uint32_t frameCount = 120;
+        const uint32_t actionSetCounts[] = {1, 4, 16};
+        const uint32_t actionsPerSetCounts[] = {8, 32, 128};
+        // Actions cycle through these types, so each binds to an input of its own type.
+        const XrActionType actionTypes[] = {XR_ACTION_TYPE_BOOLEAN_INPUT, XR_ACTION_TYPE_FLOAT_INPUT, XR_ACTION_TYPE_VECTOR2F_INPUT,
+                                            XR_ACTION_TYPE_POSE_INPUT};
+
+        for (uint32_t actionSetCount : actionSetCounts) {
+            for (uint32_t actionsPerSet : actionsPerSetCounts) {
+                CAPTURE(actionSetCount, actionsPerSet);
+                const std::vector<MetricTag> tags{{"actionSets", std::to_string(actionSetCount)},
+                                                  {"actionsPerSet", std::to_string(actionsPerSet)}};
+
+                CompositionHelper compositionHelper("xrSyncActions benchmark");
+                XrInstance instance = compositionHelper.GetInstance();
+                XrSession session = compositionHelper.GetSession();
+
+                std::vector<XrActionSet> actionSets;
+                std::vector<XrAction> actions;
+                std::vector<XrActionType> actionTypeOfAction;
+                for (uint32_t setIndex = 0; setIndex < actionSetCount; ++setIndex) {
+                    XrActionSet actionSet{XR_NULL_HANDLE};
+                    XrActionSetCreateInfo actionSetCreateInfo{XR_TYPE_ACTION_SET_CREATE_INFO};
+                    strcpy(actionSetCreateInfo.actionSetName, ("benchmark_set_" + std::to_string(setIndex)).c_str());
+                    strcpy(actionSetCreateInfo.localizedActionSetName, ("Benchmark set " + std::to_string(setIndex)).c_str());
+                    REQUIRE_RESULT(xrCreateActionSet(instance, &actionSetCreateInfo, &actionSet), XR_SUCCESS);
+                    actionSets.push_back(actionSet);
+
+                    for (uint32_t i = 0; i < actionsPerSet; ++i) {
+                        const XrActionType actionType = actionTypes[actions.size() % ArraySize(actionTypes)];
+                        XrAction action{XR_NULL_HANDLE};
+                        XrActionCreateInfo actionCreateInfo{XR_TYPE_ACTION_CREATE_INFO};
+                        actionCreateInfo.actionType = actionType;
+                        strcpy(actionCreateInfo.actionName, ("action_" + std::to_string(i)).c_str());
+                        strcpy(actionCreateInfo.localizedActionName, ("Action " + std::to_string(i)).c_str());
+                        REQUIRE_RESULT(xrCreateAction(actionSet, &actionCreateInfo, &action), XR_SUCCESS);
+                        actions.push_back(action);
+                        actionTypeOfAction.push_back(actionType);
+                    }
+                }
+
+                // Bind every action in every available interaction profile, spreading the actions of each type
+                // round-robin over the profile's input sources of that type.
+                uint32_t suggestedProfileCount = 0;
+                for (const InteractionProfileAvailMetadata& ipMetadata : GetAllInteractionProfiles()) {
+                    if (!SatisfiedByDefault(ipMetadata.Availability)) {
+                        continue;
+                    }
+                    std::map<XrActionType, std::vector<XrPath>> inputPathsByType;
+                    for (const InputSourcePathAvailData& inputSourcePathData : ipMetadata.InputSourcePaths) {
+                        if (inputSourcePathData.systemOnly || !SatisfiedByDefault(inputSourcePathData.Availability)) {
+                            continue;
+                        }
+                        inputPathsByType[inputSourcePathData.Type].push_back(StringToPath(instance, inputSourcePathData.Path));
+                    }
+
+                    std::vector<XrActionSuggestedBinding> suggestedBindings;
+                    for (size_t i = 0; i < actions.size(); ++i) {
+                        const auto it = inputPathsByType.find(actionTypeOfAction[i]);
+                        if (it != inputPathsByType.end()) {
+                            suggestedBindings.push_back({actions[i], it->second[i % it->second.size()]});
+                        }
+                    }
+                    if (suggestedBindings.empty()) {
+                        continue;
+                    }
+
+                    CAPTURE(ipMetadata.InteractionProfilePathString);
+                    XrInteractionProfileSuggestedBinding bindings{XR_TYPE_INTERACTION_PROFILE_SUGGESTED_BINDING};
+                    bindings.interactionProfile = StringToPath(instance, ipMetadata.InteractionProfilePathString);
+                    bindings.countSuggestedBindings = (uint32_t)suggestedBindings.size();
+                    bindings.suggestedBindings = suggestedBindings.data();
+                    REQUIRE_RESULT(xrSuggestInteractionProfileBindings(instance, &bindings), XR_SUCCESS);
+                    ++suggestedProfileCount;
+                }
+                REQUIRE(suggestedProfileCount > 0);
+
+                XrSessionActionSetsAttachInfo attachInfo{XR_TYPE_SESSION_ACTION_SETS_ATTACH_INFO};
+                attachInfo.countActionSets = (uint32_t)actionSets.size();
+                attachInfo.actionSets = actionSets.data();
+                REQUIRE_RESULT(xrAttachSessionActionSets(session, &attachInfo), XR_SUCCESS);
+
+                compositionHelper.BeginSession();
+                ActionLayerManager actionLayerManager(compositionHelper);
+                actionLayerManager.WaitForSessionFocusWithMessage();
+
+                std::vector<XrActiveActionSet> activeActionSets;
+                for (XrActionSet actionSet : actionSets) {
+                    activeActionSets.push_back({actionSet, XR_NULL_PATH});
+                }
+                XrActionsSyncInfo syncInfo{XR_TYPE_ACTIONS_SYNC_INFO};
+                syncInfo.countActiveActionSets = (uint32_t)activeActionSets.size();
+                syncInfo.activeActionSets = activeActionSets.data();
+
+                std::vector<std::chrono::nanoseconds> syncSamples;
+                std::vector<std::chrono::nanoseconds> getStateSamples;
+                std::vector<std::chrono::nanoseconds> frameGetStateSamples;
+                syncSamples.reserve(frameCount);
+                getStateSamples.reserve(size_t(frameCount) * actions.size());
+                frameGetStateSamples.reserve(frameCount);
+                uint32_t notFocusedCount = 0;
+
+                XrActionStateBoolean booleanState{XR_TYPE_ACTION_STATE_BOOLEAN};
+                XrActionStateFloat floatState{XR_TYPE_ACTION_STATE_FLOAT};
+                XrActionStateVector2f vectorState{XR_TYPE_ACTION_STATE_VECTOR2F};
+                XrActionStatePose poseState{XR_TYPE_ACTION_STATE_POSE};
+
+                actionLayerManager.WaitWithMessage("Measuring xrSyncActions", [&] {
+                    clock::time_point start = clock::now();
+                    const XrResult syncResult = xrSyncActions(session, &syncInfo);
+                    syncSamples.push_back(clock::now() - start);
+                    XRC_CHECK_THROW_XRCMD(syncResult);
+                    if (syncResult == XR_SESSION_NOT_FOCUSED) {
+                        ++notFocusedCount;
+                    }
+
+                    const clock::time_point frameStart = clock::now();
+                    for (size_t i = 0; i < actions.size(); ++i) {
+                        XrActionStateGetInfo getInfo{XR_TYPE_ACTION_STATE_GET_INFO};
+                        getInfo.action = actions[i];
+                        XrResult result = XR_SUCCESS;
+                        start = clock::now();
+                        switch (actionTypeOfAction[i]) {
+                        case XR_ACTION_TYPE_BOOLEAN_INPUT:
+                            result = xrGetActionStateBoolean(session, &getInfo, &booleanState);
+                            break;
+                        case XR_ACTION_TYPE_FLOAT_INPUT:
+                            result = xrGetActionStateFloat(session, &getInfo, &floatState);
+                            break;
+                        case XR_ACTION_TYPE_VECTOR2F_INPUT:
+                            result = xrGetActionStateVector2f(session, &getInfo, &vectorState);
+                            break;
+                        default:
+                            result = xrGetActionStatePose(session, &getInfo, &poseState);
+                            break;
+                        }
+                        getStateSamples.push_back(clock::now() - start);
+                        XRC_CHECK_THROW_XRCMD(result);
+                    }
+                    frameGetStateSamples.push_back(clock::now() - frameStart);
+
+                    return syncSamples.size() >= frameCount;
+                });
+
+                // Losing focus part way makes xrSyncActions cheaper, so flag it rather than report misleading numbers.
+                if (notFocusedCount > 0) {
+                    WARN("Session was not focused for " << notFocusedCount << " of " << frameCount << " measured frames");
+                }
+
+                const DurationPercentiles syncLatency = DurationPercentiles::FromSamples(std::move(syncSamples));
+                const DurationPercentiles getStateLatency = DurationPercentiles::FromSamples(std::move(getStateSamples));
+                const DurationPercentiles frameGetStateTime = DurationPercentiles::FromSamples(std::move(frameGetStateSamples));
+                ReportMetric("xrSyncActions.latency.p50", us(syncLatency.p50).count(), "us", tags);
+                ReportMetric("xrSyncActions.latency.p99", us(syncLatency.p99).count(), "us", tags);
+                ReportMetric("xrSyncActions.latency.max", us(syncLatency.max).count(), "us", tags);
+                ReportMetric("xrGetActionState.latency.p50", us(getStateLatency.p50).count(), "us", tags);
+                ReportMetric("xrGetActionState.latency.p99", us(getStateLatency.p99).count(), "us", tags);
+                ReportMetric("xrGetActionState.allActionsPerFrame.p50", us(frameGetStateTime.p50).count(), "us", tags);
+            }
+        }
+    }
 }  // namespace Conformance
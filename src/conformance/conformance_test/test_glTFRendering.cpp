@@ -2,6 +2,7 @@
 //
 // SPDX-License-Identifier: Apache-2.0
 
+#include "asset_prefetch.h"
 #include "composition_utils.h"
 #include "conformance_framework.h"
 #include "graphics_plugin.h"
@@ -30,6 +31,11 @@ namespace Conformance
 {
     using namespace openxr::math_operators;
 
+    static const AssetPrefetchRegistration g_glTFRenderingAssets(
+        "glTFRendering", {},
+        {"VertexColorTest.glb", "MetalRoughSpheres.glb", "MetalRoughSpheresNoTextures.glb", "NormalTangentTest.glb",
+         "NormalTangentMirrorTest.glb", "TextureSettingsTest.glb", "AlphaBlendModeTest.glb", "AnisotropyBarnLamp.glb"});
+
     TEST_CASE("glTFRendering", "[self_test][composition][interactive]")
     {
         GlobalData& globalData = GetGlobalData();
@@ -189,18 +195,21 @@ namespace Conformance
         GLTFModelHandle gltfModel;
         std::vector<GLTFModelInstanceHandle> gltfModelInstances(gripSpaces.size(), GLTFModelInstanceHandle{});
 
-        auto makeModelBuilder = [](const glTFTestCase& tCase) -> Gltf::ModelBuilder {
-            // Load the model file into memory
-            auto modelData = ReadFileBytes(tCase.filePath, "glTF binary");
+        auto makeModelBuilder = [](const glTFTestCase& tCase,
+                                   const std::vector<Conformance::Image::FormatParams>& supportedFormats) -> Gltf::ModelBuilder {
+            // Map the model file and load it into an intermediate form
+            // This does parsing and tangent generation, which can take a while, unless the model was loaded before
+            Gltf::ModelBuilder modelBuilder = MakeModelBuilder(LoadGLTFFile(tCase.filePath));
 
-            // Load the model into an intermediate form
-            // This does parsing and tangent generation, which can take a while
-            return Gltf::ModelBuilder(LoadGLTF(modelData));
+            // Decoding the images, especially transcoding KTX2 ones, can also take a while
+            modelBuilder.DecodeImages(supportedFormats);
+            return modelBuilder;
         };
         auto setupTest = [&]() {
             std::fill(gltfModelInstances.begin(), gltfModelInstances.end(), GLTFModelInstanceHandle{});
 
-            makeModelBuilderTask = std::async(std::launch::async, makeModelBuilder, testCase);
+            makeModelBuilderTask = std::async(std::launch::async, makeModelBuilder, testCase,
+                                              GetGlobalData().graphicsPlugin->GetSupportedTextureFormats());
 
             // Configure the interactive layer manager with the corresponding description and image
             std::ostringstream oss;
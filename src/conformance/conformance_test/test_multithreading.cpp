@@ -17,7 +17,9 @@
 #include "conformance_framework.h"
 #include "conformance_utils.h"
 #include "graphics_plugin.h"
+#include "report.h"
 #include "swapchain_image_data.h"
+#include "utilities/array_size.h"
 #include "utilities/throw_helpers.h"
 #include "utilities/utils.h"
 
@@ -30,6 +32,7 @@
 #include <chrono>
 #include <condition_variable>
 #include <cstdint>
+#include <functional>
 #include <initializer_list>
 #include <mutex>
 #include <random>
@@ -284,6 +287,51 @@ namespace Conformance
         }
     }
 
+    // Creates the haptics and grip pose actions, which AutoBasicSession does not add, and attaches the action set.
+    static void CreateAndAttachThreadTestActions(ThreadTestEnvironment& env)
+    {
+        XrActionCreateInfo actionInfo = {XR_TYPE_ACTION_CREATE_INFO};
+        actionInfo.subactionPaths = env.GetAutoBasicSession().handSubactionArray.data();
+        actionInfo.countSubactionPaths = (uint32_t)env.GetAutoBasicSession().handSubactionArray.size();
+
+        actionInfo.actionType = XR_ACTION_TYPE_VIBRATION_OUTPUT;
+        strcpy(actionInfo.actionName, "haptics");
+        strcpy(actionInfo.localizedActionName, "haptics");
+        XRC_CHECK_THROW_XRCMD(xrCreateAction(env.GetAutoBasicSession().actionSet, &actionInfo, &env.hapticsAction));
+
+        actionInfo.actionType = XR_ACTION_TYPE_POSE_INPUT;
+        strcpy(actionInfo.actionName, "grip_pose");
+        strcpy(actionInfo.localizedActionName, "Grip pose");
+        XRC_CHECK_THROW_XRCMD(xrCreateAction(env.GetAutoBasicSession().actionSet, &actionInfo, &env.gripPoseAction));
+
+        // Ensure the actions are bound
+        XrPath interactionProfilePath = XR_NULL_PATH;
+        XRC_CHECK_THROW_XRCMD(xrStringToPath(env.GetAutoBasicSession().GetInstance(), "/interaction_profiles/khr/simple_controller",
+                                             &interactionProfilePath));
+        XrPath gripPathL = XR_NULL_PATH;
+        XRC_CHECK_THROW_XRCMD(xrStringToPath(env.GetAutoBasicSession().GetInstance(), "/user/hand/left/input/grip/pose", &gripPathL));
+        XrPath gripPathR = XR_NULL_PATH;
+        XRC_CHECK_THROW_XRCMD(xrStringToPath(env.GetAutoBasicSession().GetInstance(), "/user/hand/right/input/grip/pose", &gripPathR));
+        XrPath hapticPathL = XR_NULL_PATH;
+        XRC_CHECK_THROW_XRCMD(xrStringToPath(env.GetAutoBasicSession().GetInstance(), "/user/hand/left/output/haptic", &hapticPathL));
+        XrPath hapticPathR = XR_NULL_PATH;
+        XRC_CHECK_THROW_XRCMD(xrStringToPath(env.GetAutoBasicSession().GetInstance(), "/user/hand/right/output/haptic", &hapticPathR));
+        std::vector<XrActionSuggestedBinding> bindings{{env.gripPoseAction, gripPathL},
+                                                       {env.gripPoseAction, gripPathR},
+                                                       {env.hapticsAction, hapticPathL},
+                                                       {env.hapticsAction, hapticPathR}};
+        XrInteractionProfileSuggestedBinding suggestedBindings = {XR_TYPE_INTERACTION_PROFILE_SUGGESTED_BINDING};
+        suggestedBindings.interactionProfile = interactionProfilePath;
+        suggestedBindings.suggestedBindings = (const XrActionSuggestedBinding*)bindings.data();
+        suggestedBindings.countSuggestedBindings = (uint32_t)bindings.size();
+        XRC_CHECK_THROW_XRCMD(xrSuggestInteractionProfileBindings(env.GetAutoBasicSession().GetInstance(), &suggestedBindings));
+
+        XrSessionActionSetsAttachInfo attachInfo{XR_TYPE_SESSION_ACTION_SETS_ATTACH_INFO};
+        attachInfo.countActionSets = 1;
+        attachInfo.actionSets = &env.GetAutoBasicSession().actionSet;
+        XRC_CHECK_THROW_XRCMD(xrAttachSessionActionSets(env.GetAutoBasicSession(), &attachInfo));
+    }
+
     TEST_CASE("multithreading", "")
     {
         // As of May 2019, Catch2 documents that multithreaded tests must not access test primitives (e.g. REQUIRE)
@@ -335,53 +383,7 @@ namespace Conformance
             env.GetAutoBasicSession().Init(AutoBasicSession::beginSession | AutoBasicSession::createActions |
                                            AutoBasicSession::createSpaces | AutoBasicSession::createSwapchains);
 
-            // AutoBasicSession does not add vibrations or attach action sets
-            {
-                XrActionCreateInfo actionInfo = {XR_TYPE_ACTION_CREATE_INFO};
-                actionInfo.subactionPaths = env.GetAutoBasicSession().handSubactionArray.data();
-                actionInfo.countSubactionPaths = (uint32_t)env.GetAutoBasicSession().handSubactionArray.size();
-
-                actionInfo.actionType = XR_ACTION_TYPE_VIBRATION_OUTPUT;
-                strcpy(actionInfo.actionName, "haptics");
-                strcpy(actionInfo.localizedActionName, "haptics");
-                XRC_CHECK_THROW_XRCMD(xrCreateAction(env.GetAutoBasicSession().actionSet, &actionInfo, &env.hapticsAction));
-
-                actionInfo.actionType = XR_ACTION_TYPE_POSE_INPUT;
-                strcpy(actionInfo.actionName, "grip_pose");
-                strcpy(actionInfo.localizedActionName, "Grip pose");
-                XRC_CHECK_THROW_XRCMD(xrCreateAction(env.GetAutoBasicSession().actionSet, &actionInfo, &env.gripPoseAction));
-
-                // Ensure the actions are bound
-                XrPath interactionProfilePath = XR_NULL_PATH;
-                XRC_CHECK_THROW_XRCMD(xrStringToPath(env.GetAutoBasicSession().GetInstance(), "/interaction_profiles/khr/simple_controller",
-                                                     &interactionProfilePath));
-                XrPath gripPathL = XR_NULL_PATH;
-                XRC_CHECK_THROW_XRCMD(
-                    xrStringToPath(env.GetAutoBasicSession().GetInstance(), "/user/hand/left/input/grip/pose", &gripPathL));
-                XrPath gripPathR = XR_NULL_PATH;
-                XRC_CHECK_THROW_XRCMD(
-                    xrStringToPath(env.GetAutoBasicSession().GetInstance(), "/user/hand/right/input/grip/pose", &gripPathR));
-                XrPath hapticPathL = XR_NULL_PATH;
-                XRC_CHECK_THROW_XRCMD(
-                    xrStringToPath(env.GetAutoBasicSession().GetInstance(), "/user/hand/left/output/haptic", &hapticPathL));
-                XrPath hapticPathR = XR_NULL_PATH;
-                XRC_CHECK_THROW_XRCMD(
-                    xrStringToPath(env.GetAutoBasicSession().GetInstance(), "/user/hand/right/output/haptic", &hapticPathR));
-                std::vector<XrActionSuggestedBinding> bindings{{env.gripPoseAction, gripPathL},
-                                                               {env.gripPoseAction, gripPathR},
-                                                               {env.hapticsAction, hapticPathL},
-                                                               {env.hapticsAction, hapticPathR}};
-                XrInteractionProfileSuggestedBinding suggestedBindings = {XR_TYPE_INTERACTION_PROFILE_SUGGESTED_BINDING};
-                suggestedBindings.interactionProfile = interactionProfilePath;
-                suggestedBindings.suggestedBindings = (const XrActionSuggestedBinding*)bindings.data();
-                suggestedBindings.countSuggestedBindings = (uint32_t)bindings.size();
-                XRC_CHECK_THROW_XRCMD(xrSuggestInteractionProfileBindings(env.GetAutoBasicSession().GetInstance(), &suggestedBindings));
-
-                XrSessionActionSetsAttachInfo attachInfo{XR_TYPE_SESSION_ACTION_SETS_ATTACH_INFO};
-                attachInfo.countActionSets = 1;
-                attachInfo.actionSets = &env.GetAutoBasicSession().actionSet;
-                XRC_CHECK_THROW_XRCMD(xrAttachSessionActionSets(env.GetAutoBasicSession(), &attachInfo));
-            }
+            CreateAndAttachThreadTestActions(env);
 
             // Get frames iterating to the point of app focused state. This will draw frames along the way.
             FrameIterator frameIterator(&env.GetAutoBasicSession());
@@ -403,6 +405,183 @@ namespace Conformance
         }
     }
 
+    // Runs @p op on @p threadCount threads at once for @p duration and returns the calls completed per second by all of them.
+    // Exceptions thrown by @p op are recorded on @p env, and stop that thread.
+    static double MeasureThreadThroughput(ThreadTestEnvironment& env, size_t threadCount, std::chrono::milliseconds duration,
+                                          const std::function<void(size_t threadIndex)>& op)
+    {
+        std::atomic<bool> start{false};
+        std::atomic<bool> stop{false};
+        std::vector<uint64_t> callCounts(threadCount, 0);
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < threadCount; ++i) {
+            threads.emplace_back([&, i] {
+                while (!start.load()) {
+                    std::this_thread::yield();
+                }
+                uint64_t count = 0;
+                try {
+                    while (!stop.load(std::memory_order_relaxed)) {
+                        op(i);
+                        ++count;
+                    }
+                }
+                catch (const std::exception& ex) {
+                    env.AppendError(ex.what());
+                }
+                callCounts[i] = count;
+            });
+        }
+
+        const auto begin = std::chrono::steady_clock::now();
+        start = true;
+        std::this_thread::sleep_for(duration);
+        stop = true;
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+        uint64_t total = 0;
+        for (uint64_t count : callCounts) {
+            total += count;
+        }
+        return total / elapsed.count();
+    }
+
+    // Not a conformance requirement: runs each group of functions below in a tight loop on 1 to hardware_concurrency threads
+    // at once, and reports the calls per second and the scaling efficiency (the throughput relative to the single thread
+    // throughput times the thread count). Efficiency well below 100% while threads are still idle points at a lock shared
+    // by all callers in the runtime. Unlike "multithreading", the exercise functions are not reused, since they sleep
+    // between create and destroy.
+    TEST_CASE("multithreading_Benchmark", "[.][benchmark]")
+    {
+        constexpr std::chrono::milliseconds kDurationPerStep{500};
+
+        ThreadTestEnvironment env(0);
+        env.GetAutoBasicSession().Init(AutoBasicSession::beginSession | AutoBasicSession::createActions | AutoBasicSession::createSpaces);
+        CreateAndAttachThreadTestActions(env);
+
+        FrameIterator frameIterator(&env.GetAutoBasicSession());
+        frameIterator.RunToSessionState(XR_SESSION_STATE_FOCUSED);
+        const XrTime time = frameIterator.frameState.predictedDisplayTime;
+
+        GlobalData& globalData = GetGlobalData();
+        const XrInstance instance = env.GetAutoBasicSession().GetInstance();
+        const XrSession session = env.GetAutoBasicSession().GetSession();
+        const std::vector<XrSpace>& spaces = env.GetAutoBasicSession().spaceVector;
+        const std::array<XrPath, 2>& handSubactionArray = env.GetAutoBasicSession().handSubactionArray;
+
+        std::vector<size_t> threadCounts;
+        const size_t maxThreadCount = std::max(std::thread::hardware_concurrency(), 1u);
+        for (size_t threadCount = 1; threadCount < maxThreadCount; threadCount *= 2) {
+            threadCounts.push_back(threadCount);
+        }
+        threadCounts.push_back(maxThreadCount);
+
+        // Each thread gets its own swapchain, so that only the runtime's internal locking is shared.
+        std::vector<XrSwapchain> swapchains;
+        if (globalData.IsUsingGraphicsPlugin()) {
+            for (size_t i = 0; i < maxThreadCount; ++i) {
+                XrSwapchain swapchain{XR_NULL_HANDLE};
+                XrExtent2Di widthHeight{64, 64};
+                XRC_CHECK_THROW_XRCMD(CreateColorSwapchain(session, globalData.GetGraphicsPlugin().get(), &swapchain, &widthHeight));
+                swapchains.push_back(swapchain);
+            }
+        }
+
+        static const char* const pathStrings[] = {"/user/hand/left/input/select/click", "/user/hand/right/input/select/click",
+                                                  "/user/hand/left/input/grip/pose", "/user/hand/right/output/haptic",
+                                                  "/interaction_profiles/khr/simple_controller"};
+
+        struct FunctionGroup
+        {
+            const char* name;
+            std::function<void(size_t threadIndex)> op;
+        };
+        std::vector<FunctionGroup> groups;
+
+        groups.push_back({"locate", [&](size_t threadIndex) {
+                              XrSpaceLocation location{XR_TYPE_SPACE_LOCATION};
+                              const XrSpace space = spaces[threadIndex % spaces.size()];
+                              const XrSpace baseSpace = spaces[(threadIndex + 1) % spaces.size()];
+                              XRC_CHECK_THROW_XRCMD(xrLocateSpace(space, baseSpace, time, &location));
+                          }});
+
+        groups.push_back({"actions", [&](size_t threadIndex) {
+                              const XrActiveActionSet activeActionSet{env.GetAutoBasicSession().actionSet, XR_NULL_PATH};
+                              XrActionsSyncInfo syncInfo{XR_TYPE_ACTIONS_SYNC_INFO};
+                              syncInfo.activeActionSets = &activeActionSet;
+                              syncInfo.countActiveActionSets = 1;
+                              XRC_CHECK_THROW_XRCMD(xrSyncActions(session, &syncInfo));
+
+                              XrActionStateGetInfo getInfo{XR_TYPE_ACTION_STATE_GET_INFO};
+                              getInfo.action = env.gripPoseAction;
+                              getInfo.subactionPath = handSubactionArray[threadIndex % handSubactionArray.size()];
+                              XrActionStatePose state{XR_TYPE_ACTION_STATE_POSE};
+                              XRC_CHECK_THROW_XRCMD(xrGetActionStatePose(session, &getInfo, &state));
+                          }});
+
+        groups.push_back({"paths", [&](size_t threadIndex) {
+                              XrPath path = XR_NULL_PATH;
+                              XRC_CHECK_THROW_XRCMD(xrStringToPath(instance, pathStrings[threadIndex % ArraySize(pathStrings)], &path));
+                              char buffer[XR_MAX_PATH_LENGTH];
+                              uint32_t countOutput = 0;
+                              XRC_CHECK_THROW_XRCMD(xrPathToString(instance, path, XR_MAX_PATH_LENGTH, &countOutput, buffer));
+                          }});
+
+        if (!swapchains.empty()) {
+            groups.push_back({"swapchain", [&](size_t threadIndex) {
+                                  // The graphics API may require the app to serialize these calls, in which case this group
+                                  // measures that lock as well as the runtime.
+#if defined(XR_USE_GRAPHICS_API_VULKAN)
+                                  std::unique_lock<std::mutex> vulkanLock = env.LockQueueIfVulkan(globalData);
+#endif  // defined(XR_USE_GRAPHICS_API_VULKAN)
+#if defined(XR_USE_GRAPHICS_API_OPENGL)
+                                  std::unique_lock<std::mutex> glLock = env.LockContextIfOpenGL(globalData);
+#endif  // defined(XR_USE_GRAPHICS_API_OPENGL)
+                                  const XrSwapchain swapchain = swapchains[threadIndex];
+                                  uint32_t imageIndex = 0;
+                                  XRC_CHECK_THROW_XRCMD(xrAcquireSwapchainImage(swapchain, nullptr, &imageIndex));
+                                  XrSwapchainImageWaitInfo waitInfo{XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO};
+                                  waitInfo.timeout = XR_INFINITE_DURATION;
+                                  XRC_CHECK_THROW_XRCMD(xrWaitSwapchainImage(swapchain, &waitInfo));
+                                  XRC_CHECK_THROW_XRCMD(xrReleaseSwapchainImage(swapchain, nullptr));
+                              }});
+        }
+
+        if (globalData.GetGraphicsPlugin()) {
+            globalData.GetGraphicsPlugin()->MakeCurrent(false);
+        }
+
+        for (const FunctionGroup& group : groups) {
+            double singleThreadThroughput = 0.0;
+            for (size_t threadCount : threadCounts) {
+                const double throughput = MeasureThreadThroughput(env, threadCount, kDurationPerStep, group.op);
+                if (threadCount == 1) {
+                    singleThreadThroughput = throughput;
+                }
+
+                const std::vector<MetricTag> tags{{"group", group.name}, {"threads", std::to_string(threadCount)}};
+                ReportMetric("Multithreading.throughput", throughput, "calls/s", tags);
+                if (singleThreadThroughput > 0.0) {
+                    ReportMetric("Multithreading.scalingEfficiency", 100.0 * throughput / (singleThreadThroughput * threadCount), "%",
+                                 tags);
+                }
+            }
+        }
+
+        if (globalData.GetGraphicsPlugin()) {
+            globalData.GetGraphicsPlugin()->MakeCurrent(true);
+        }
+
+        for (XrSwapchain swapchain : swapchains) {
+            XRC_CHECK_THROW_XRCMD(xrDestroySwapchain(swapchain));
+        }
+
+        REQUIRE_MSG(env.ErrorCount() == 0, env.OutputText())
+    }
+
     // To consider: We could have exercise functions below auto-add themselves to a vector on startup.
     // A challenge with that is that code linkers will often elide such auto-add functions unless you
     // annotate them specially [e.g. GCC's __attribute__((constructor)) ] See XRC_BEGIN_ON_STARTUP.
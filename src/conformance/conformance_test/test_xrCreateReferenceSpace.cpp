@@ -14,15 +14,24 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "composition_utils.h"
 #include "conformance_framework.h"
 #include "conformance_utils.h"
+#include "report.h"
 #include "two_call.h"
+#include "utilities/array_size.h"
+#include "utilities/process_memory.h"
+#include "utilities/throw_helpers.h"
 
 #include <catch2/catch_test_macros.hpp>
 #include <openxr/openxr.h>
 
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 #include <initializer_list>
+#include <random>
 #include <string>
 #include <vector>
 
@@ -34,7 +43,7 @@ namespace Conformance
 
     TEST_CASE("xrCreateReferenceSpace", "")
     {
-        AutoBasicSession session(AutoBasicSession::createSession);
+        AutoBasicSession& session = GetSharedAutoBasicSession();
 
         // Get all supported reference space types and exercise them.
         auto refSpaceTypes = CHECK_TWO_CALL(XrReferenceSpaceType, {}, xrEnumerateReferenceSpaces, session);
@@ -98,4 +107,202 @@ namespace Conformance
         }
     }
 
+    // Not a conformance requirement: creates up to 10^5 reference and action spaces, measuring creation, location and
+    // destruction latency and process memory at each step, to reveal runtimes whose cost per space grows with the count.
+    TEST_CASE("Space_Scaling_Benchmark", "[.][benchmark]")
+    {
+        using clock = std::chrono::steady_clock;
+        using us = std::chrono::duration<double, std::micro>;
+
+        // Space counts at which to measure, as apps with many anchors and action spaces reach them.
+        constexpr uint32_t kSpaceCounts[] = {100, 1000, 10000, 100000};
+        constexpr uint32_t kLocateRepeatCount = 1000;
+
+        AutoBasicInstance instance(AutoBasicInstance::createSystemId);
+        AutoBasicSession session(AutoBasicSession::createSession | AutoBasicSession::beginSession | AutoBasicSession::createSwapchains |
+                                     AutoBasicSession::createSpaces,
+                                 instance);
+
+        // A pose action with both hands as subaction paths, so action spaces are spread over every subaction path,
+        // including none.
+        XrActionSet actionSet{XR_NULL_HANDLE};
+        XrAction poseAction{XR_NULL_HANDLE};
+        const std::vector<XrPath> subactionPaths{StringToPath(instance, "/user/hand/left"), StringToPath(instance, "/user/hand/right")};
+        {
+            XrActionSetCreateInfo actionSetInfo{XR_TYPE_ACTION_SET_CREATE_INFO};
+            strcpy(actionSetInfo.actionSetName, "space_scaling_benchmark");
+            strcpy(actionSetInfo.localizedActionSetName, "Space Scaling Benchmark");
+            XRC_CHECK_THROW_XRCMD(xrCreateActionSet(instance, &actionSetInfo, &actionSet));
+
+            XrActionCreateInfo actionInfo{XR_TYPE_ACTION_CREATE_INFO};
+            actionInfo.actionType = XR_ACTION_TYPE_POSE_INPUT;
+            strcpy(actionInfo.actionName, "pose");
+            strcpy(actionInfo.localizedActionName, "Pose");
+            actionInfo.subactionPaths = subactionPaths.data();
+            actionInfo.countSubactionPaths = (uint32_t)subactionPaths.size();
+            XRC_CHECK_THROW_XRCMD(xrCreateAction(actionSet, &actionInfo, &poseAction));
+
+            const std::vector<XrActionSuggestedBinding> bindings = {
+                {poseAction, StringToPath(instance, "/user/hand/left/input/grip/pose")},
+                {poseAction, StringToPath(instance, "/user/hand/right/input/grip/pose")},
+            };
+            XrInteractionProfileSuggestedBinding suggestedBindings{XR_TYPE_INTERACTION_PROFILE_SUGGESTED_BINDING};
+            suggestedBindings.interactionProfile = StringToPath(instance, "/interaction_profiles/khr/simple_controller");
+            suggestedBindings.suggestedBindings = bindings.data();
+            suggestedBindings.countSuggestedBindings = (uint32_t)bindings.size();
+            XRC_CHECK_THROW_XRCMD(xrSuggestInteractionProfileBindings(instance, &suggestedBindings));
+
+            XrSessionActionSetsAttachInfo attachInfo{XR_TYPE_SESSION_ACTION_SETS_ATTACH_INFO};
+            attachInfo.actionSets = &actionSet;
+            attachInfo.countActionSets = 1;
+            XRC_CHECK_THROW_XRCMD(xrAttachSessionActionSets(session, &attachInfo));
+        }
+
+        XrSpace baseSpace{XR_NULL_HANDLE};
+        {
+            XrReferenceSpaceCreateInfo spaceCreateInfo{XR_TYPE_REFERENCE_SPACE_CREATE_INFO};
+            spaceCreateInfo.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_LOCAL;
+            spaceCreateInfo.poseInReferenceSpace = Pose::Identity;
+            XRC_CHECK_THROW_XRCMD(xrCreateReferenceSpace(session, &spaceCreateInfo, &baseSpace));
+        }
+
+        // Locate at a real display time, after syncing the actions once as an application would.
+        FrameIterator frameIterator(&session);
+        frameIterator.RunToSessionState(XR_SESSION_STATE_FOCUSED);
+        FrameIterator::RunResult runResult = frameIterator.SubmitFrame();
+        REQUIRE(runResult == FrameIterator::RunResult::Success);
+        const XrTime time = frameIterator.frameState.predictedDisplayTime;
+        REQUIRE(time != 0);
+        {
+            const XrActiveActionSet activeActionSet{actionSet, XR_NULL_PATH};
+            XrActionsSyncInfo syncInfo{XR_TYPE_ACTIONS_SYNC_INFO};
+            syncInfo.countActiveActionSets = 1;
+            syncInfo.activeActionSets = &activeActionSet;
+            XRC_CHECK_THROW_XRCMD(xrSyncActions(session, &syncInfo));
+        }
+
+        // Random but repeatable offsets, so the runtime cannot share anything between spaces.
+        std::mt19937 random(1234);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        auto randomPose = [&] {
+            XrQuaternionf orientation{unit(random), unit(random), unit(random), unit(random)};
+            const float length = std::sqrt(orientation.x * orientation.x + orientation.y * orientation.y +
+                                           orientation.z * orientation.z + orientation.w * orientation.w);
+            if (length < 1e-3f) {
+                orientation = Quat::Identity;
+            }
+            else {
+                orientation = {orientation.x / length, orientation.y / length, orientation.z / length, orientation.w / length};
+            }
+            return XrPosef{orientation, {unit(random) * 10.0f, unit(random) * 10.0f, unit(random) * 10.0f}};
+        };
+
+        // Alternate reference spaces and action spaces, cycling through the subaction paths of the latter.
+        auto createSpace = [&](uint32_t i, XrSpace* space) {
+            if (i % 2 == 0) {
+                XrReferenceSpaceCreateInfo spaceCreateInfo{XR_TYPE_REFERENCE_SPACE_CREATE_INFO};
+                spaceCreateInfo.referenceSpaceType = (i % 4 == 0) ? XR_REFERENCE_SPACE_TYPE_LOCAL : XR_REFERENCE_SPACE_TYPE_VIEW;
+                spaceCreateInfo.poseInReferenceSpace = randomPose();
+                return xrCreateReferenceSpace(session, &spaceCreateInfo, space);
+            }
+            XrActionSpaceCreateInfo spaceCreateInfo{XR_TYPE_ACTION_SPACE_CREATE_INFO};
+            spaceCreateInfo.action = poseAction;
+            const uint32_t subaction = (i / 2) % (subactionPaths.size() + 1);
+            spaceCreateInfo.subactionPath = subaction < subactionPaths.size() ? subactionPaths[subaction] : XR_NULL_PATH;
+            spaceCreateInfo.poseInActionSpace = randomPose();
+            return xrCreateActionSpace(session, &spaceCreateInfo, space);
+        };
+
+        auto measureLocate = [&](XrSpace space) {
+            std::vector<std::chrono::nanoseconds> samples;
+            samples.reserve(kLocateRepeatCount);
+            XrSpaceLocation location{XR_TYPE_SPACE_LOCATION};
+            for (uint32_t i = 0; i < kLocateRepeatCount; ++i) {
+                const clock::time_point start = clock::now();
+                const XrResult result = xrLocateSpace(space, baseSpace, time, &location);
+                samples.push_back(clock::now() - start);
+                REQUIRE(result == XR_SUCCESS);
+            }
+            return DurationPercentiles::FromSamples(std::move(samples));
+        };
+
+        std::vector<XrSpace> spaces;
+        spaces.reserve(kSpaceCounts[ArraySize(kSpaceCounts) - 1]);
+        std::vector<uint32_t> reachedCounts;
+        const uint64_t residentBefore = GetProcessResidentMemoryBytes();
+        bool limitReached = false;
+
+        for (uint32_t spaceCount : kSpaceCounts) {
+            // Grow to this count, timing only the spaces added since the last one.
+            std::vector<std::chrono::nanoseconds> createSamples;
+            createSamples.reserve(spaceCount - spaces.size());
+            while (spaces.size() < spaceCount) {
+                XrSpace space{XR_NULL_HANDLE};
+                const clock::time_point start = clock::now();
+                const XrResult result = createSpace((uint32_t)spaces.size(), &space);
+                createSamples.push_back(clock::now() - start);
+                if (result == XR_ERROR_LIMIT_REACHED) {
+                    WARN("Runtime reached its space limit at " << spaces.size() << " spaces");
+                    limitReached = true;
+                    break;
+                }
+                REQUIRE(result == XR_SUCCESS);
+                spaces.push_back(space);
+            }
+            if (spaces.empty()) {
+                break;
+            }
+
+            const std::vector<MetricTag> tags{{"spaces", std::to_string(spaces.size())}};
+            const DurationPercentiles createLatency = DurationPercentiles::FromSamples(std::move(createSamples));
+            ReportMetric("SpaceScaling.createLatency.p50", us(createLatency.p50).count(), "us", tags);
+            ReportMetric("SpaceScaling.createLatency.p99", us(createLatency.p99).count(), "us", tags);
+
+            // A runtime that keeps its spaces in a list shows it in the cost of finding the oldest or the newest.
+            const DurationPercentiles locateFirst = measureLocate(spaces.front());
+            const DurationPercentiles locateLast = measureLocate(spaces.back());
+            ReportMetric("SpaceScaling.locateFirstLatency.p50", us(locateFirst.p50).count(), "us", tags);
+            ReportMetric("SpaceScaling.locateFirstLatency.p99", us(locateFirst.p99).count(), "us", tags);
+            ReportMetric("SpaceScaling.locateLastLatency.p50", us(locateLast.p50).count(), "us", tags);
+            ReportMetric("SpaceScaling.locateLastLatency.p99", us(locateLast.p99).count(), "us", tags);
+
+            const uint64_t residentAfter = GetProcessResidentMemoryBytes();
+            if (residentBefore != 0 && residentAfter != 0) {
+                // Signed, as the resident set may also shrink while the spaces are created.
+                const double growth = double(residentAfter) - double(residentBefore);
+                ReportMetric("SpaceScaling.residentGrowth", growth, "bytes", tags);
+                ReportMetric("SpaceScaling.residentGrowthPerSpace", growth / spaces.size(), "bytes/space", tags);
+            }
+            reachedCounts.push_back((uint32_t)spaces.size());
+            if (limitReached) {
+                break;
+            }
+        }
+
+        // Destroy newest first, timing each range between the measured counts at the count it started from.
+        while (!reachedCounts.empty()) {
+            const uint32_t rangeStart = reachedCounts.size() > 1 ? reachedCounts[reachedCounts.size() - 2] : 0;
+            std::vector<std::chrono::nanoseconds> destroySamples;
+            destroySamples.reserve(spaces.size() - rangeStart);
+            const std::vector<MetricTag> tags{{"spaces", std::to_string(spaces.size())}};
+            while (spaces.size() > rangeStart) {
+                const clock::time_point start = clock::now();
+                const XrResult result = xrDestroySpace(spaces.back());
+                destroySamples.push_back(clock::now() - start);
+                REQUIRE(result == XR_SUCCESS);
+                spaces.pop_back();
+            }
+            const DurationPercentiles destroyLatency = DurationPercentiles::FromSamples(std::move(destroySamples));
+            ReportMetric("SpaceScaling.destroyLatency.p50", us(destroyLatency.p50).count(), "us", tags);
+            ReportMetric("SpaceScaling.destroyLatency.p99", us(destroyLatency.p99).count(), "us", tags);
+            reachedCounts.pop_back();
+        }
+
+        const uint64_t residentAfterDestroy = GetProcessResidentMemoryBytes();
+        if (residentBefore != 0 && residentAfterDestroy != 0) {
+            // What is left after destroying every space is memory the runtime keeps, or leaks.
+            ReportMetric("SpaceScaling.residentRetained", double(residentAfterDestroy) - double(residentBefore), "bytes");
+        }
+    }
+
 }  // namespace Conformance
@@ -18,16 +18,21 @@
 #include "conformance_utils.h"
 #include "graphics_plugin.h"
 #include "matchers.h"
+#include "report.h"
+#include "startup_timing.h"
 #include "utilities/types_and_constants.h"
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers.hpp>
 #include <openxr/openxr.h>
 
+#include <chrono>
 #include <initializer_list>
 #include <memory>
 #include <string>
 #include <thread>
+#include <utility>
+#include <vector>
 
 namespace Conformance
 {
@@ -211,4 +216,63 @@ namespace Conformance
             }
         }
     }
+
+    // Brings up a session and submits its first frame --sessionStartupIterations times, timing each phase.
+    // The first iteration is reported as the cold startup, the median and maximum of the others as the warm startup.
+    TEST_CASE("Session_Startup_Benchmark", "[.][benchmark]")
+    {
+        using clock = std::chrono::steady_clock;
+        using ms = std::chrono::duration<double, std::milli>;
+
+        const uint32_t iterationCount = GetGlobalData().GetOptions().sessionStartupIterations;
+
+        std::vector<StartupTimings> timings;
+        std::vector<std::chrono::nanoseconds> timesToFirstFrame;
+        std::vector<std::chrono::nanoseconds> shutdownTimes;
+        for (uint32_t iteration = 0; iteration < iterationCount; ++iteration) {
+            CAPTURE(iteration);
+            StartupTimingCollector collector;
+
+            const clock::time_point start = clock::now();
+            AutoBasicSession session(AutoBasicSession::beginSession | AutoBasicSession::createSwapchains);
+            FrameIterator frameIterator(&session);
+            FrameIterator::RunResult runResult;
+            {
+                ScopedStartupPhase timing(StartupPhase::FirstFrame);
+                runResult = frameIterator.SubmitFrame();
+            }
+            timesToFirstFrame.push_back(clock::now() - start);
+            REQUIRE(runResult == FrameIterator::RunResult::Success);
+
+            const clock::time_point shutdownStart = clock::now();
+            session.Shutdown();
+            shutdownTimes.push_back(clock::now() - shutdownStart);
+
+            timings.push_back(collector.GetTimings());
+        }
+
+        // InitializeDevice includes the graphics requirements call, report the device part on its own.
+        for (StartupTimings& iterationTimings : timings) {
+            iterationTimings[StartupPhase::InitializeDevice] -= iterationTimings[StartupPhase::GraphicsRequirements];
+        }
+
+        auto report = [&](const std::string& name, const std::vector<std::chrono::nanoseconds>& samples) {
+            ReportMetric(name, ms(samples.front()).count(), "ms", {{"run", "cold"}});
+            std::vector<std::chrono::nanoseconds> warmSamples(samples.begin() + 1, samples.end());
+            const DurationPercentiles warm = DurationPercentiles::FromSamples(std::move(warmSamples));
+            ReportMetric(name, ms(warm.p50).count(), "ms", {{"run", "warm"}, {"statistic", "p50"}});
+            ReportMetric(name, ms(warm.max).count(), "ms", {{"run", "warm"}, {"statistic", "max"}});
+        };
+
+        for (size_t phaseIndex = 0; phaseIndex < kStartupPhaseCount; ++phaseIndex) {
+            const StartupPhase phase = static_cast<StartupPhase>(phaseIndex);
+            std::vector<std::chrono::nanoseconds> samples;
+            for (const StartupTimings& iterationTimings : timings) {
+                samples.push_back(iterationTimings[phase]);
+            }
+            report(std::string("SessionStartup.") + StartupPhaseName(phase), samples);
+        }
+        report("SessionStartup.timeToFirstFrame", timesToFirstFrame);
+        report("SessionStartup.shutdown", shutdownTimes);
+    }
 }  // namespace Conformance
@@ -31,7 +31,7 @@ namespace Conformance
     {
         // XrResult xrGetInstanceProperties(XrInstance instance, XrInstanceProperties* instanceProperties);
 
-        AutoBasicInstance instance;
+        AutoBasicInstance& instance = GetSharedAutoBasicInstance();
 
         XrInstanceProperties instanceProperties{XR_TYPE_INSTANCE_PROPERTIES};
         XrResult result;
@@ -31,7 +31,7 @@ namespace Conformance
         // XrResult xrGetSystem(XrInstance instance, const XrSystemGetInfo* getInfo, XrSystemId* systemId);
         auto &globalData = GetGlobalData();
 
-        AutoBasicInstance instance;
+        AutoBasicInstance& instance = GetSharedAutoBasicInstance();
 
         XrResult result;
         XrSystemGetInfo systemGetInfo{XR_TYPE_SYSTEM_GET_INFO};
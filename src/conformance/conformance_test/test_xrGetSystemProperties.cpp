@@ -33,14 +33,14 @@ namespace Conformance
 
         SECTION("InvalidSystemId")
         {
-            AutoBasicInstance instance;
+            AutoBasicInstance& instance = GetSharedAutoBasicInstance();
 
             REQUIRE(XR_ERROR_SYSTEM_INVALID == xrGetSystemProperties(instance, XR_NULL_SYSTEM_ID, &systemProperties));
         }
         SECTION("ValidSystemId")
         {
 
-            AutoBasicInstance instance{AutoBasicInstance::createSystemId};
+            AutoBasicInstance& instance = GetSharedAutoBasicInstance(AutoBasicInstance::createSystemId);
             XrSystemId systemId = instance.systemId;
 
             REQUIRE(XR_SUCCESS == xrGetSystemProperties(instance, systemId, &systemProperties));
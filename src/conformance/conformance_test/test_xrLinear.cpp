@@ -21,6 +21,8 @@
 
 #include <openxr/openxr.h>
 
+#include <vector>
+
 namespace Conformance
 {
     static bool Vector3fEqual(const XrVector3f& a, const XrVector3f& b)
@@ -41,6 +43,46 @@ namespace Conformance
         return Vector3fEqual(a.position, b.position) && QuatfEqual(a.orientation, b.orientation);
     };
 
+    static bool Matrix4x4fEqual(const XrMatrix4x4f& a, const XrMatrix4x4f& b)
+    {
+        constexpr float e = 0.001f;
+        for (int i = 0; i < 16; i++) {
+            if (a.m[i] != Catch::Approx(b.m[i]).epsilon(e).margin(1e-5)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// A handful of rigid body, scaled, projection and general matrices to compare implementations with.
+    static std::vector<XrMatrix4x4f> TestMatrices()
+    {
+        std::vector<XrMatrix4x4f> matrices;
+        const XrVector3f axes[] = {{0, 1, 0}, {1, 0, 0}, {0.267f, 0.535f, 0.802f}};
+        for (int i = 0; i < 3; i++) {
+            XrQuaternionf q;
+            XrQuaternionf_CreateFromAxisAngle(&q, &axes[i], (20.0f + 50.0f * i) * (MATH_PI / 180));
+            const XrPosef pose{q, {0.5f * i, -1.0f, 2.0f - i}};
+            XrMatrix4x4f rigid;
+            XrMatrix4x4f_CreateFromRigidTransform(&rigid, &pose);
+            matrices.push_back(rigid);
+
+            const XrVector3f scale{1.0f + i, 0.5f, 2.0f};
+            XrMatrix4x4f scaled;
+            XrMatrix4x4f_CreateTranslationRotationScale(&scaled, &pose.position, &pose.orientation, &scale);
+            matrices.push_back(scaled);
+        }
+        XrMatrix4x4f projection;
+        XrMatrix4x4f_CreateProjectionFov(&projection, GRAPHICS_OPENGL, XrFovf{-0.8f, 0.7f, 0.6f, -0.75f}, 0.05f, 100.0f);
+        matrices.push_back(projection);
+        XrMatrix4x4f general;
+        for (int i = 0; i < 16; i++) {
+            general.m[i] = (float)((i * 7) % 11) - 4.5f + (i % 5 == 0 ? 10.0f : 0.0f);
+        }
+        matrices.push_back(general);
+        return matrices;
+    }
+
     TEST_CASE("xrLinear", "")
     {
         SECTION("XrPosef")
@@ -107,6 +149,88 @@ namespace Conformance
                 }
             }
         }
+
+        // The SIMD implementations, where enabled, and the batched variants must match the scalar references.
+        SECTION("XrMatrix4x4f")
+        {
+            const std::vector<XrMatrix4x4f> matrices = TestMatrices();
+            const std::vector<XrVector3f> vectors{{0, 0, 0}, {1, 0, 0}, {0, -2, 0}, {0.3f, 0.4f, -5.0f}, {-7.0f, 3.0f, 1.5f}};
+
+            SECTION("Multiply")
+            {
+                for (const XrMatrix4x4f& a : matrices) {
+                    std::vector<XrMatrix4x4f> results(matrices.size());
+                    XrMatrix4x4f_MultiplyArray(results.data(), &a, matrices.data(), matrices.size());
+                    for (size_t i = 0; i < matrices.size(); i++) {
+                        XrMatrix4x4f expected;
+                        XrMatrix4x4f_MultiplyScalar(&expected, &a, &matrices[i]);
+                        XrMatrix4x4f result;
+                        XrMatrix4x4f_Multiply(&result, &a, &matrices[i]);
+                        REQUIRE(Matrix4x4fEqual(result, expected));
+                        REQUIRE(Matrix4x4fEqual(results[i], expected));
+
+                        XrMatrix4x4f inPlace = a;
+                        XrMatrix4x4f_Multiply(&inPlace, &inPlace, &matrices[i]);
+                        REQUIRE(Matrix4x4fEqual(inPlace, expected));
+                    }
+                }
+            }
+
+            SECTION("Invert")
+            {
+                XrMatrix4x4f identity;
+                XrMatrix4x4f_CreateIdentity(&identity);
+                for (const XrMatrix4x4f& m : matrices) {
+                    XrMatrix4x4f expected;
+                    XrMatrix4x4f_InvertScalar(&expected, &m);
+                    XrMatrix4x4f result;
+                    XrMatrix4x4f_Invert(&result, &m);
+                    REQUIRE(Matrix4x4fEqual(result, expected));
+
+                    XrMatrix4x4f product;
+                    XrMatrix4x4f_Multiply(&product, &m, &result);
+                    REQUIRE(Matrix4x4fEqual(product, identity));
+                }
+            }
+
+            SECTION("InvertRigidBody")
+            {
+                for (const XrMatrix4x4f& m : matrices) {
+                    if (!XrMatrix4x4f_IsRigidBody(&m, 1e-4f)) {
+                        continue;
+                    }
+                    XrMatrix4x4f expected;
+                    XrMatrix4x4f_InvertRigidBodyScalar(&expected, &m);
+                    XrMatrix4x4f result;
+                    XrMatrix4x4f_InvertRigidBody(&result, &m);
+                    REQUIRE(Matrix4x4fEqual(result, expected));
+
+                    XrMatrix4x4f general;
+                    XrMatrix4x4f_InvertScalar(&general, &m);
+                    REQUIRE(Matrix4x4fEqual(result, general));
+                }
+            }
+
+            SECTION("TransformVector3f")
+            {
+                for (const XrMatrix4x4f& m : matrices) {
+                    if (!XrMatrix4x4f_IsAffine(&m, 1e-4f)) {
+                        // Some of the vectors would end up at w = 0.
+                        continue;
+                    }
+                    std::vector<XrVector3f> results(vectors.size());
+                    XrMatrix4x4f_TransformVector3fArray(results.data(), &m, vectors.data(), vectors.size());
+                    for (size_t i = 0; i < vectors.size(); i++) {
+                        XrVector3f expected;
+                        XrMatrix4x4f_TransformVector3fScalar(&expected, &m, &vectors[i]);
+                        XrVector3f result;
+                        XrMatrix4x4f_TransformVector3f(&result, &m, &vectors[i]);
+                        REQUIRE(Vector3fEqual(result, expected));
+                        REQUIRE(Vector3fEqual(results[i], expected));
+                    }
+                }
+            }
+        }
     }
 
 }  // namespace Conformance
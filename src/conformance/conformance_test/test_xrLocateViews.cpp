@@ -17,18 +17,106 @@
 #include "conformance_utils.h"
 #include "conformance_framework.h"
 #include "matchers.h"
+#include "report.h"
+#include "utilities/xrduration_literals.h"
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_vector.hpp>
 
 #include <openxr/openxr.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
 #define AS_LIST(name, val) {name, #name},
 static constexpr std::pair<XrViewConfigurationType, const char*> KnownViewTypes[] = {XR_LIST_ENUM_XrViewConfigurationType(AS_LIST)};
 #undef AS_LIST
 
 namespace Conformance
 {
+    namespace
+    {
+        /// Calls made by each thread for one measurement.
+        constexpr uint32_t kLocateViewsIterations = 2000;
+
+        struct LocateViewsResult
+        {
+            /// Time taken by one xrLocateViews call.
+            DurationPercentiles latency;
+            /// Calls per second, summed over all threads.
+            double callsPerSecond{0};
+            /// First failing result returned by any thread, or XR_SUCCESS.
+            XrResult result{XR_SUCCESS};
+        };
+
+        /// Call @p locate kLocateViewsIterations times from each of @p threadCount threads, passing it the call index.
+        /// @p locate must be thread-safe. Makes no assertions, as Catch2 assertions are not thread-safe: the caller checks
+        /// the recorded result.
+        template <typename Locate>
+        LocateViewsResult MeasureLocateViews(uint32_t threadCount, Locate&& locate)
+        {
+            using clock = std::chrono::steady_clock;
+
+            std::vector<std::vector<std::chrono::nanoseconds>> threadSamples(threadCount);
+            std::atomic<uint32_t> readyCount{0};
+            std::atomic<bool> go{false};
+            std::atomic<int32_t> firstFailure{XR_SUCCESS};
+
+            auto worker = [&](uint32_t threadIndex) {
+                ATTACH_THREAD;
+                std::vector<std::chrono::nanoseconds>& samples = threadSamples[threadIndex];
+                samples.reserve(kLocateViewsIterations);
+
+                ++readyCount;
+                while (!go) {
+                    std::this_thread::yield();
+                }
+
+                for (uint32_t i = 0; i < kLocateViewsIterations; ++i) {
+                    const clock::time_point start = clock::now();
+                    const XrResult result = locate(i);
+                    samples.push_back(clock::now() - start);
+                    if (XR_FAILED(result)) {
+                        int32_t expected = XR_SUCCESS;
+                        firstFailure.compare_exchange_strong(expected, result);
+                        break;
+                    }
+                }
+                DETACH_THREAD;
+            };
+
+            std::vector<std::thread> threads;
+            for (uint32_t i = 0; i < threadCount; ++i) {
+                threads.emplace_back(worker, i);
+            }
+            while (readyCount != threadCount) {
+                std::this_thread::yield();
+            }
+            const clock::time_point start = clock::now();
+            go = true;
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+            const std::chrono::duration<double> wallTime = clock::now() - start;
+
+            std::vector<std::chrono::nanoseconds> allSamples;
+            allSamples.reserve(size_t(threadCount) * kLocateViewsIterations);
+            for (const auto& samples : threadSamples) {
+                allSamples.insert(allSamples.end(), samples.begin(), samples.end());
+            }
+
+            LocateViewsResult result;
+            result.callsPerSecond = double(allSamples.size()) / wallTime.count();
+            result.latency = DurationPercentiles::FromSamples(std::move(allSamples));
+            result.result = static_cast<XrResult>(firstFailure.load());
+            return result;
+        }
+    }  // namespace
+
     TEST_CASE("xrLocateViews", "")
     {
         GlobalData& globalData = GetGlobalData();
@@ -198,4 +286,101 @@ namespace Conformance
         }
     }
 
+    // Not a conformance requirement: engines locate the views several times a frame, for culling, rendering and submission,
+    // so a slow xrLocateViews is an easy cost to miss. Measures it for each supported view configuration type: at the
+    // predicted display time, at distinct times around it and far in the future, and from several threads at once. Calls
+    // repeated with the same time being much faster than calls with distinct times suggests the runtime caches the result.
+    TEST_CASE("LocateViews_Latency_Benchmark", "[.][benchmark]")
+    {
+        using us = std::chrono::duration<double, std::micro>;
+
+        std::vector<XrViewConfigurationType> runtimeViewTypes;
+        {
+            AutoBasicInstance instance(AutoBasicInstance::createSystemId);
+            uint32_t viewConfigCount = 0;
+            REQUIRE(XR_SUCCESS == xrEnumerateViewConfigurations(instance, instance.systemId, 0, &viewConfigCount, nullptr));
+            runtimeViewTypes.resize(viewConfigCount);
+            REQUIRE(XR_SUCCESS == xrEnumerateViewConfigurations(instance, instance.systemId, viewConfigCount, &viewConfigCount,
+                                                                runtimeViewTypes.data()));
+        }
+
+        std::vector<uint32_t> threadCounts{1};
+        const uint32_t maxThreadCount = std::min(std::max(std::thread::hardware_concurrency(), 1u), 8u);
+        while (threadCounts.back() * 2 <= maxThreadCount) {
+            threadCounts.push_back(threadCounts.back() * 2);
+        }
+
+        for (const auto& viewTypeAndName : KnownViewTypes) {
+            const XrViewConfigurationType viewType = viewTypeAndName.first;
+            if (std::find(runtimeViewTypes.begin(), runtimeViewTypes.end(), viewType) == runtimeViewTypes.end()) {
+                continue;
+            }
+            CAPTURE(viewTypeAndName.second);
+
+            AutoBasicSession session(AutoBasicSession::createInstance | AutoBasicSession::createSession |
+                                     AutoBasicSession::createSwapchains | AutoBasicSession::createSpaces);
+            session.viewConfigurationType = viewType;
+            session.BeginSession();
+            FrameIterator frameIterator(&session);
+            frameIterator.RunToSessionState(XR_SESSION_STATE_FOCUSED);
+            const XrTime displayTime = frameIterator.frameState.predictedDisplayTime;
+            REQUIRE(displayTime != 0);
+
+            uint32_t viewCount = 0;
+            REQUIRE(XR_SUCCESS ==
+                    xrEnumerateViewConfigurationViews(session.GetInstance(), session.GetSystemId(), viewType, 0, &viewCount, nullptr));
+            const XrSpace space = session.spaceVector.front();
+
+            // Each call locates at the time returned by @p timeOf for the call index, into views of its own thread.
+            auto locateAt = [&](XrTime (*timeOf)(XrTime displayTime, uint32_t i)) {
+                return [&, timeOf](uint32_t i) {
+                    thread_local std::vector<XrView> views;
+                    views.assign(viewCount, {XR_TYPE_VIEW});
+                    XrViewLocateInfo locateInfo{XR_TYPE_VIEW_LOCATE_INFO};
+                    locateInfo.viewConfigurationType = viewType;
+                    locateInfo.displayTime = timeOf(displayTime, i);
+                    locateInfo.space = space;
+                    XrViewState viewState{XR_TYPE_VIEW_STATE};
+                    uint32_t viewCountOut = 0;
+                    return xrLocateViews(session, &locateInfo, &viewState, viewCount, &viewCountOut, views.data());
+                };
+            };
+            // Distinct times step by a microsecond, staying within a frame of the display time.
+            const auto sameTime = locateAt([](XrTime t, uint32_t) { return t; });
+            const auto distinctTimes = locateAt([](XrTime t, uint32_t i) { return t + (XrTime)(i % 1000) * 1_xrMicroseconds; });
+            const auto farFuture = locateAt([](XrTime t, uint32_t i) { return t + 1_xrSeconds + (XrTime)(i % 1000) * 1_xrMicroseconds; });
+
+            auto report = [&](const char* mode, uint32_t threadCount, const LocateViewsResult& measured) {
+                REQUIRE(measured.result == XR_SUCCESS);
+                const std::vector<MetricTag> tags{
+                    {"viewConfiguration", viewTypeAndName.second}, {"mode", mode}, {"threads", std::to_string(threadCount)}};
+                ReportMetric("LocateViews.latency.p50", us(measured.latency.p50).count(), "us", tags);
+                ReportMetric("LocateViews.latency.p99", us(measured.latency.p99).count(), "us", tags);
+                ReportMetric("LocateViews.throughput", measured.callsPerSecond, "calls/s", tags);
+                ReportConsoleOnlyF("%s, %s, %u thread(s): p50/p99 %.2f / %.2fus, %.0f calls/s", viewTypeAndName.second, mode, threadCount,
+                                   us(measured.latency.p50).count(), us(measured.latency.p99).count(), measured.callsPerSecond);
+            };
+
+            const LocateViewsResult same = MeasureLocateViews(1, sameTime);
+            const LocateViewsResult distinct = MeasureLocateViews(1, distinctTimes);
+            report("sameTime", 1, same);
+            report("distinctTimes", 1, distinct);
+            report("farFuture", 1, MeasureLocateViews(1, farFuture));
+
+            const double cacheSpeedup = (double)distinct.latency.p50.count() / std::max<int64_t>(same.latency.p50.count(), 1);
+            ReportMetric("LocateViews.sameTimeSpeedup", cacheSpeedup, "ratio", {{"viewConfiguration", viewTypeAndName.second}});
+            if (cacheSpeedup > 2.0) {
+                ReportConsoleOnlyF("%s: calls repeating a time are %.1fx faster, so are likely served from a cache",
+                                   viewTypeAndName.second, cacheSpeedup);
+            }
+
+            for (uint32_t threadCount : threadCounts) {
+                if (threadCount > 1) {
+                    report("sameTime", threadCount, MeasureLocateViews(threadCount, sameTime));
+                    report("distinctTimes", threadCount, MeasureLocateViews(threadCount, distinctTimes));
+                }
+            }
+        }
+    }
+
 }  // namespace Conformance
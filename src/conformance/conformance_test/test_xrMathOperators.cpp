@@ -0,0 +1,141 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "utilities/xr_math_operators.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <openxr/openxr.h>
+
+#include <vector>
+
+namespace Conformance
+{
+    using namespace openxr::math_operators;
+
+    namespace
+    {
+        /// As many poses as there are joints in two hands, in assorted orientations.
+        std::vector<XrPosef> MakeTestPoses()
+        {
+            std::vector<XrPosef> poses;
+            for (int i = 0; i < 2 * XR_HAND_JOINT_COUNT_EXT; ++i) {
+                XrVector3f axis{0.3f * (i % 3), 1.0f, -0.2f * (i % 5)};
+                Vector::Normalize(axis);
+                poses.push_back({Quat::FromAxisAngle(axis, 0.13f * i), {0.01f * i, -0.5f + 0.02f * i, 0.3f - 0.01f * (i % 7)}});
+            }
+            return poses;
+        }
+    }  // namespace
+
+    TEST_CASE("xrMathOperators_Batch", "[self_test]")
+    {
+        const std::vector<XrPosef> poses = MakeTestPoses();
+        const Pose::Batch batch(poses);
+        REQUIRE(batch.Size() == poses.size());
+
+        const XrPosef basePose{Quat::FromAxisAngle({0, 0, 1}, DegToRad(35)), {1.0f, 2.0f, -3.0f}};
+
+        SECTION("Assign and CopyTo")
+        {
+            std::vector<XrPosef> copied(poses.size());
+            batch.CopyTo(copied);
+            for (size_t i = 0; i < poses.size(); ++i) {
+                REQUIRE(copied[i].position == poses[i].position);
+                REQUIRE(copied[i].orientation.x == poses[i].orientation.x);
+                REQUIRE(copied[i].orientation.y == poses[i].orientation.y);
+                REQUIRE(copied[i].orientation.z == poses[i].orientation.z);
+                REQUIRE(copied[i].orientation.w == poses[i].orientation.w);
+            }
+
+            Vector::Batch positions;
+            positions.Assign(nonstd::span<const XrPosef>(poses), [](const XrPosef& pose) { return pose.position; });
+            REQUIRE(Vector::FindFirstNotApproxEqual(positions, batch.position, 0.0001f) == poses.size());
+        }
+
+        SECTION("Multiply by one pose")
+        {
+            Pose::Batch result;
+            Pose::Multiply(result, basePose, batch);
+            for (size_t i = 0; i < poses.size(); ++i) {
+                REQUIRE(Pose::ApproxEqual(result.Get(i), basePose * poses[i], 0.0001f, DegToRad(0.1f)));
+            }
+        }
+
+        SECTION("Multiply element-wise, in place")
+        {
+            Pose::Batch result = batch;
+            Pose::Multiply(result, result, batch);
+            for (size_t i = 0; i < poses.size(); ++i) {
+                REQUIRE(Pose::ApproxEqual(result.Get(i), poses[i] * poses[i], 0.0001f, DegToRad(0.1f)));
+            }
+        }
+
+        SECTION("Invert")
+        {
+            Pose::Batch inverse;
+            Pose::Invert(inverse, batch);
+            Pose::Batch identities;
+            Pose::Multiply(identities, batch, inverse);
+            for (size_t i = 0; i < poses.size(); ++i) {
+                XrPosef expected;
+                XrPosef_Invert(&expected, &poses[i]);
+                REQUIRE(Pose::ApproxEqual(inverse.Get(i), expected, 0.0001f, DegToRad(0.1f)));
+                REQUIRE(Pose::ApproxEqual(identities.Get(i), Pose::Identity, 0.0001f, DegToRad(0.1f)));
+            }
+        }
+
+        SECTION("TransformPoints")
+        {
+            Vector::Batch points;
+            points.Assign(nonstd::span<const XrPosef>(poses), [](const XrPosef& pose) { return pose.position; });
+            Vector::Batch result;
+            Pose::TransformPoints(result, basePose, points);
+            for (size_t i = 0; i < poses.size(); ++i) {
+                XrVector3f expected;
+                XrPosef_TransformVector3f(&expected, &basePose, &poses[i].position);
+                REQUIRE(Vector::ApproxEqual(result.Get(i), expected, 0.0001f));
+            }
+        }
+
+        SECTION("FindFirstNotApproxEqual")
+        {
+            Pose::Batch other = batch;
+            REQUIRE(Pose::FindFirstNotApproxEqual(batch, other) == poses.size());
+
+            // Inside the tolerances, and the same rotation with the opposite sign.
+            XrPosef nearby = poses[3];
+            nearby.position.x += 0.0005f;
+            nearby.orientation = {-nearby.orientation.x, -nearby.orientation.y, -nearby.orientation.z, -nearby.orientation.w};
+            other.Set(3, nearby);
+            REQUIRE(Pose::FindFirstNotApproxEqual(batch, other) == poses.size());
+
+            // Outside them, in a later block than the first.
+            XrPosef moved = poses[40];
+            moved.position.y += 0.01f;
+            other.Set(40, moved);
+            XrPosef turned = poses[45];
+            turned.orientation = turned.orientation * Quat::FromAxisAngle({1, 0, 0}, DegToRad(2));
+            other.Set(45, turned);
+            REQUIRE(Pose::FindFirstNotApproxEqual(batch, other) == 40);
+            REQUIRE(Vector::FindFirstNotApproxEqual(batch.position, other.position) == 40);
+
+            other.Set(40, poses[40]);
+            REQUIRE(Pose::FindFirstNotApproxEqual(batch, other) == 45);
+            REQUIRE(Vector::FindFirstNotApproxEqual(batch.position, other.position) == poses.size());
+        }
+    }
+}  // namespace Conformance
@@ -16,14 +16,20 @@
 
 #include "conformance_framework.h"
 #include "conformance_utils.h"
+#include "report.h"
+#include "utilities/event_reader.h"
 #include "utilities/types_and_constants.h"
 #include "utilities/utils.h"
 
 #include <catch2/catch_test_macros.hpp>
 #include <openxr/openxr.h>
 
+#include <atomic>
+#include <chrono>
+#include <mutex>
 #include <string>
 #include <cstring>
+#include <vector>
 
 namespace Conformance
 {
@@ -200,4 +206,216 @@ namespace Conformance
             }
         }
     }
+
+    namespace
+    {
+        /// What the debug message flood's messenger has received.
+        struct DebugMessageFloodState
+        {
+            std::mutex mutex;
+            std::chrono::steady_clock::time_point submitTime;
+            std::vector<std::chrono::nanoseconds> latencies;
+        };
+
+        XRAPI_ATTR XrBool32 XRAPI_CALL RecordDebugMessageLatency(XrDebugUtilsMessageSeverityFlagsEXT /* messageSeverity */,
+                                                                 XrDebugUtilsMessageTypeFlagsEXT /* messageTypes */,
+                                                                 const XrDebugUtilsMessengerCallbackDataEXT* /* callbackData */,
+                                                                 void* userData)
+        {
+            const auto now = std::chrono::steady_clock::now();
+            auto& state = *static_cast<DebugMessageFloodState*>(userData);
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.latencies.push_back(now - state.submitTime);
+            return XR_FALSE;
+        }
+    }  // namespace
+
+    // Not a conformance requirement: floods the runtime with events and debug messages, to measure how fast xrPollEvent
+    // drains them, whether the runtime's event queue overflows (XrEventDataEventsLost), and how long each session state
+    // change takes to become visible through EventQueue after the call that triggers it.
+    TEST_CASE("PollEvent_Flood_Benchmark", "[.][benchmark]")
+    {
+        using clock = std::chrono::steady_clock;
+        using us = std::chrono::duration<double, std::micro>;
+        using ms = std::chrono::duration<double, std::milli>;
+
+        GlobalData& globalData = GetGlobalData();
+        AutoBasicInstance instance(AutoBasicInstance::createSystemId);
+
+        struct DrainResult
+        {
+            uint32_t eventCount{0};
+            uint64_t lostEventCount{0};
+            std::chrono::duration<double> drainTime{0};
+            std::vector<std::chrono::nanoseconds> pollLatencies;
+        };
+        // Poll until the runtime has nothing left, timing each call.
+        auto drain = [&] {
+            DrainResult drained;
+            const clock::time_point drainStart = clock::now();
+            for (;;) {
+                XrEventDataBuffer eventData{XR_TYPE_EVENT_DATA_BUFFER};
+                const clock::time_point start = clock::now();
+                const XrResult result = xrPollEvent(instance, &eventData);
+                drained.pollLatencies.push_back(clock::now() - start);
+                if (result == XR_EVENT_UNAVAILABLE) {
+                    break;
+                }
+                REQUIRE(result == XR_SUCCESS);
+                drained.eventCount++;
+                if (eventData.type == XR_TYPE_EVENT_DATA_EVENTS_LOST) {
+                    drained.lostEventCount += reinterpret_cast<const XrEventDataEventsLost*>(&eventData)->lostEventCount;
+                }
+            }
+            drained.drainTime = clock::now() - drainStart;
+            return drained;
+        };
+
+        // Wait for delivery of any possible events, and discard them.
+        SleepMs(500);
+        drain();
+
+        // The cost of asking when there is nothing to return, which apps pay every frame.
+        {
+            std::vector<std::chrono::nanoseconds> samples;
+            for (int i = 0; i < 10000; ++i) {
+                XrEventDataBuffer eventData{XR_TYPE_EVENT_DATA_BUFFER};
+                const clock::time_point start = clock::now();
+                const XrResult result = xrPollEvent(instance, &eventData);
+                samples.push_back(clock::now() - start);
+                REQUIRE((result == XR_EVENT_UNAVAILABLE || result == XR_SUCCESS));
+            }
+            const DurationPercentiles emptyPoll = DurationPercentiles::FromSamples(std::move(samples));
+            ReportMetric("PollEvent.emptyPollLatency.p50", us(emptyPoll.p50).count(), "us");
+            ReportMetric("PollEvent.emptyPollLatency.p99", us(emptyPoll.p99).count(), "us");
+        }
+
+        // Flood: create and destroy sessions without polling, each of which queues session state changes, then drain.
+        for (uint32_t cycleCount : {8u, 32u, 128u}) {
+            CAPTURE(cycleCount);
+            for (uint32_t i = 0; i < cycleCount; ++i) {
+                XrSystemId systemId{XR_NULL_SYSTEM_ID};
+                XrSession session{XR_NULL_HANDLE};
+                REQUIRE(CreateBasicSession(instance, &systemId, &session) == XR_SUCCESS);
+                REQUIRE(xrDestroySession(session) == XR_SUCCESS);
+            }
+            DrainResult drained = drain();
+            if (drained.eventCount == 0) {
+                WARN("Runtime queued no events for " << cycleCount << " destroyed sessions");
+            }
+
+            const std::vector<MetricTag> tags{{"sessions", std::to_string(cycleCount)}};
+            const DurationPercentiles pollLatency = DurationPercentiles::FromSamples(std::move(drained.pollLatencies));
+            ReportMetric("PollEvent.floodEventCount", drained.eventCount, "count", tags);
+            ReportMetric("PollEvent.floodLostEventCount", static_cast<double>(drained.lostEventCount), "count", tags);
+            ReportMetric("PollEvent.drainRate", drained.eventCount / drained.drainTime.count(), "events/s", tags);
+            ReportMetric("PollEvent.drainPollLatency.p50", us(pollLatency.p50).count(), "us", tags);
+            ReportMetric("PollEvent.drainPollLatency.p99", us(pollLatency.p99).count(), "us", tags);
+        }
+
+        // Trigger to visibility: run sessions through their lifecycle, waiting on each state change through an EventQueue
+        // polled by the waiting reader, then by a background thread.
+        constexpr uint32_t lifecycleCount = 16;
+        const XrSessionBeginInfo beginInfo{XR_TYPE_SESSION_BEGIN_INFO, nullptr, globalData.options.viewConfigurationValue};
+        for (bool backgroundPolling : {false, true}) {
+            CAPTURE(backgroundPolling);
+            EventQueue eventQueue(instance);
+            EventReader eventReader(eventQueue);
+            if (backgroundPolling) {
+                eventQueue.StartBackgroundPolling();
+            }
+
+            auto waitForState = [&](XrSession session, XrSessionState state) {
+                const clock::time_point deadline = clock::now() + std::chrono::seconds(10);
+                XrEventDataBuffer eventData;
+                while (eventReader.WaitForEvent(eventData, XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED,
+                                                std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - clock::now()))) {
+                    const auto& stateChanged = *reinterpret_cast<const XrEventDataSessionStateChanged*>(&eventData);
+                    if (stateChanged.session == session && stateChanged.state == state) {
+                        return clock::now();
+                    }
+                }
+                FAIL("Timed out waiting for session state " << state);
+                return clock::now();
+            };
+
+            std::vector<std::chrono::nanoseconds> createToReady;
+            std::vector<std::chrono::nanoseconds> requestExitToStopping;
+            std::vector<std::chrono::nanoseconds> endToExiting;
+            for (uint32_t i = 0; i < lifecycleCount; ++i) {
+                XrSystemId systemId{XR_NULL_SYSTEM_ID};
+                XrSession session{XR_NULL_HANDLE};
+                clock::time_point start = clock::now();
+                REQUIRE(CreateBasicSession(instance, &systemId, &session) == XR_SUCCESS);
+                createToReady.push_back(waitForState(session, XR_SESSION_STATE_READY) - start);
+
+                REQUIRE(xrBeginSession(session, &beginInfo) == XR_SUCCESS);
+                start = clock::now();
+                REQUIRE(xrRequestExitSession(session) == XR_SUCCESS);
+                requestExitToStopping.push_back(waitForState(session, XR_SESSION_STATE_STOPPING) - start);
+
+                start = clock::now();
+                REQUIRE(xrEndSession(session) == XR_SUCCESS);
+                endToExiting.push_back(waitForState(session, XR_SESSION_STATE_EXITING) - start);
+                REQUIRE(xrDestroySession(session) == XR_SUCCESS);
+            }
+            eventQueue.StopBackgroundPolling();
+
+            const std::vector<MetricTag> tags{{"polling", backgroundPolling ? "background" : "reader"}};
+            auto report = [&](const std::string& name, std::vector<std::chrono::nanoseconds>&& samples) {
+                const DurationPercentiles latency = DurationPercentiles::FromSamples(std::move(samples));
+                ReportMetric(name + ".p50", ms(latency.p50).count(), "ms", tags);
+                ReportMetric(name + ".p99", ms(latency.p99).count(), "ms", tags);
+            };
+            report("PollEvent.createToReadyLatency", std::move(createToReady));
+            report("PollEvent.requestExitToStoppingLatency", std::move(requestExitToStopping));
+            report("PollEvent.endToExitingLatency", std::move(endToExiting));
+        }
+
+        // Debug message flood: how fast messages reach a messenger, without the CTS's own messenger printing them.
+        if (globalData.IsInstanceExtensionSupported(XR_EXT_DEBUG_UTILS_EXTENSION_NAME)) {
+            AutoBasicInstance debugInstance({XR_EXT_DEBUG_UTILS_EXTENSION_NAME}, AutoBasicInstance::skipDebugMessenger);
+            auto xrCreateDebugUtilsMessengerEXT_ =
+                GetInstanceExtensionFunction<PFN_xrCreateDebugUtilsMessengerEXT>(debugInstance, "xrCreateDebugUtilsMessengerEXT");
+            auto xrDestroyDebugUtilsMessengerEXT_ =
+                GetInstanceExtensionFunction<PFN_xrDestroyDebugUtilsMessengerEXT>(debugInstance, "xrDestroyDebugUtilsMessengerEXT");
+            auto xrSubmitDebugUtilsMessageEXT_ =
+                GetInstanceExtensionFunction<PFN_xrSubmitDebugUtilsMessageEXT>(debugInstance, "xrSubmitDebugUtilsMessageEXT");
+
+            DebugMessageFloodState state;
+            XrDebugUtilsMessengerCreateInfoEXT messengerInfo{XR_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT};
+            messengerInfo.messageSeverities = XR_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT;
+            messengerInfo.messageTypes = XR_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT;
+            messengerInfo.userCallback = RecordDebugMessageLatency;
+            messengerInfo.userData = &state;
+            XrDebugUtilsMessengerEXT messenger{XR_NULL_HANDLE};
+            REQUIRE(xrCreateDebugUtilsMessengerEXT_(debugInstance, &messengerInfo, &messenger) == XR_SUCCESS);
+
+            constexpr uint32_t messageCount = 10000;
+            XrDebugUtilsMessengerCallbackDataEXT callbackData{XR_TYPE_DEBUG_UTILS_MESSENGER_CALLBACK_DATA_EXT};
+            callbackData.messageId = "PollEvent_Flood_Benchmark";
+            callbackData.functionName = "PollEvent_Flood_Benchmark";
+            callbackData.message = "Debug message flood";
+            const clock::time_point floodStart = clock::now();
+            for (uint32_t i = 0; i < messageCount; ++i) {
+                {
+                    std::lock_guard<std::mutex> lock(state.mutex);
+                    state.submitTime = clock::now();
+                }
+                REQUIRE(xrSubmitDebugUtilsMessageEXT_(debugInstance, XR_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT,
+                                                      XR_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT, &callbackData) == XR_SUCCESS);
+            }
+            const std::chrono::duration<double> floodTime = clock::now() - floodStart;
+            REQUIRE(xrDestroyDebugUtilsMessengerEXT_(messenger) == XR_SUCCESS);
+
+            std::lock_guard<std::mutex> lock(state.mutex);
+            ReportMetric("PollEvent.debugMessageRate", messageCount / floodTime.count(), "messages/s");
+            ReportMetric("PollEvent.debugMessagesDelivered", static_cast<double>(state.latencies.size()), "count");
+            if (!state.latencies.empty()) {
+                const DurationPercentiles latency = DurationPercentiles::FromSamples(std::move(state.latencies));
+                ReportMetric("PollEvent.debugMessageLatency.p50", us(latency.p50).count(), "us");
+                ReportMetric("PollEvent.debugMessageLatency.p99", us(latency.p99).count(), "us");
+            }
+        }
+    }
 }  // namespace Conformance
@@ -38,7 +38,7 @@ namespace Conformance
     {
         // XrResult xrResultToString(XrInstance instance, XrResult value, char buffer[XR_MAX_RESULT_STRING_SIZE]);
 
-        AutoBasicInstance instance;
+        AutoBasicInstance& instance = GetSharedAutoBasicInstance();
 
         XrResult result;
         char buffer[XR_MAX_RESULT_STRING_SIZE];
@@ -16,16 +16,22 @@
 
 #include "conformance_framework.h"
 #include "conformance_utils.h"
+#include "report.h"
+#include "utilities/process_memory.h"
 #include "utilities/types_and_constants.h"
 #include "utilities/utils.h"
 
 #include <catch2/catch_test_macros.hpp>
 #include <openxr/openxr.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <vector>
 #include <string>
 #include <sstream>
 #include <cstring>
+#include <thread>
 
 namespace Conformance
 {
@@ -184,4 +190,156 @@ namespace Conformance
         }
     }
 
+
+    /// Run @p work(threadIndex) on each of @p threadCount threads, released together once all are started.
+    /// Returns the wall time from release until the last thread finished.
+    template <typename Work>
+    static std::chrono::duration<double> RunPathBenchmarkThreads(uint32_t threadCount, Work&& work)
+    {
+        using clock = std::chrono::steady_clock;
+        std::atomic<uint32_t> readyCount{0};
+        std::atomic<bool> go{false};
+
+        std::vector<std::thread> threads;
+        for (uint32_t i = 0; i < threadCount; ++i) {
+            threads.emplace_back([&, i] {
+                ATTACH_THREAD;
+                ++readyCount;
+                while (!go) {
+                    std::this_thread::yield();
+                }
+                work(i);
+                DETACH_THREAD;
+            });
+        }
+        while (readyCount != threadCount) {
+            std::this_thread::yield();
+        }
+        const clock::time_point start = clock::now();
+        go = true;
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        return clock::now() - start;
+    }
+
+    TEST_CASE("Path_Interning_Benchmark", "[.][benchmark]")
+    {
+        using clock = std::chrono::steady_clock;
+        using us = std::chrono::duration<double, std::micro>;
+
+        // Distinct paths interned per measurement, split evenly over the threads.
+        constexpr uint32_t pathCount = 32768;
+
+        std::vector<uint32_t> threadCounts{1};
+        const uint32_t maxThreadCount = std::min(std::max(std::thread::hardware_concurrency(), 1u), 8u);
+        while (threadCounts.back() * 2 <= maxThreadCount) {
+            threadCounts.push_back(threadCounts.back() * 2);
+        }
+
+        for (uint32_t threadCount : threadCounts) {
+            CAPTURE(threadCount);
+            const std::vector<MetricTag> tags{{"threads", std::to_string(threadCount)}};
+            const uint32_t pathsPerThread = pathCount / threadCount;
+
+            // A fresh instance per thread count, so each run starts from an empty path table.
+            AutoBasicInstance instance;
+
+            // Build the strings up front, so neither the timing nor the memory growth includes them.
+            // Nested components give the runtime a realistic mix of shared prefixes.
+            std::vector<std::string> pathStrings;
+            pathStrings.reserve(pathCount);
+            for (uint32_t i = 0; i < pathCount; ++i) {
+                pathStrings.push_back("/benchmark/group_" + std::to_string(i % 64) + "/path_" + std::to_string(i));
+            }
+            std::vector<XrPath> paths(pathCount, XR_NULL_PATH);
+            std::vector<std::vector<std::chrono::nanoseconds>> threadSamples(threadCount);
+            for (auto& samples : threadSamples) {
+                samples.reserve(pathsPerThread);
+            }
+            std::atomic<int32_t> firstFailure{XR_SUCCESS};
+            auto recordResult = [&](XrResult result) {
+                if (XR_FAILED(result)) {
+                    int32_t expected = XR_SUCCESS;
+                    firstFailure.compare_exchange_strong(expected, result);
+                    return false;
+                }
+                return true;
+            };
+            auto collectSamples = [&] {
+                std::vector<std::chrono::nanoseconds> all;
+                for (auto& samples : threadSamples) {
+                    all.insert(all.end(), samples.begin(), samples.end());
+                    samples.clear();
+                }
+                return DurationPercentiles::FromSamples(std::move(all));
+            };
+
+            // Populate: every thread interns its own slice of new paths.
+            const uint64_t residentBefore = GetProcessResidentMemoryBytes();
+            const std::chrono::duration<double> populateTime = RunPathBenchmarkThreads(threadCount, [&](uint32_t threadIndex) {
+                for (uint32_t i = threadIndex * pathsPerThread; i < (threadIndex + 1) * pathsPerThread; ++i) {
+                    const clock::time_point start = clock::now();
+                    const XrResult result = xrStringToPath(instance, pathStrings[i].c_str(), &paths[i]);
+                    threadSamples[threadIndex].push_back(clock::now() - start);
+                    if (!recordResult(result)) {
+                        return;
+                    }
+                }
+            });
+            const uint64_t residentAfter = GetProcessResidentMemoryBytes();
+            REQUIRE(static_cast<XrResult>(firstFailure.load()) == XR_SUCCESS);
+            const DurationPercentiles internLatency = collectSamples();
+
+            // Look up: every thread re-queries paths interned by another thread, both ways.
+            std::vector<std::vector<std::chrono::nanoseconds>> toStringSamples(threadCount);
+            std::atomic<uint32_t> mismatchCount{0};
+            const std::chrono::duration<double> lookupTime = RunPathBenchmarkThreads(threadCount, [&](uint32_t threadIndex) {
+                toStringSamples[threadIndex].reserve(pathsPerThread);
+                const uint32_t otherThread = (threadIndex + 1) % threadCount;
+                char buffer[XR_MAX_PATH_LENGTH];
+                for (uint32_t i = otherThread * pathsPerThread; i < (otherThread + 1) * pathsPerThread; ++i) {
+                    XrPath path{XR_NULL_PATH};
+                    clock::time_point start = clock::now();
+                    XrResult result = xrStringToPath(instance, pathStrings[i].c_str(), &path);
+                    threadSamples[threadIndex].push_back(clock::now() - start);
+                    if (!recordResult(result)) {
+                        return;
+                    }
+
+                    uint32_t length = 0;
+                    start = clock::now();
+                    result = xrPathToString(instance, paths[i], sizeof(buffer), &length, buffer);
+                    toStringSamples[threadIndex].push_back(clock::now() - start);
+                    if (!recordResult(result)) {
+                        return;
+                    }
+                    if (path != paths[i] || pathStrings[i] != buffer) {
+                        ++mismatchCount;
+                    }
+                }
+            });
+            REQUIRE(static_cast<XrResult>(firstFailure.load()) == XR_SUCCESS);
+            CHECK(mismatchCount == 0);
+            const DurationPercentiles stringToPathLatency = collectSamples();
+            std::swap(threadSamples, toStringSamples);
+            const DurationPercentiles pathToStringLatency = collectSamples();
+
+            ReportMetric("Paths.internThroughput", double(pathCount) / populateTime.count(), "paths/s", tags);
+            ReportMetric("Paths.internLatency.p50", us(internLatency.p50).count(), "us", tags);
+            ReportMetric("Paths.internLatency.p99", us(internLatency.p99).count(), "us", tags);
+            // Each looked up path is queried both ways.
+            ReportMetric("Paths.lookupThroughput", 2.0 * pathCount / lookupTime.count(), "lookups/s", tags);
+            ReportMetric("Paths.stringToPathLatency.p50", us(stringToPathLatency.p50).count(), "us", tags);
+            ReportMetric("Paths.stringToPathLatency.p99", us(stringToPathLatency.p99).count(), "us", tags);
+            ReportMetric("Paths.pathToStringLatency.p50", us(pathToStringLatency.p50).count(), "us", tags);
+            ReportMetric("Paths.pathToStringLatency.p99", us(pathToStringLatency.p99).count(), "us", tags);
+            if (residentBefore != 0 && residentAfter != 0) {
+                // Signed, as the resident set may also shrink while the paths are interned.
+                const double growth = double(residentAfter) - double(residentBefore);
+                ReportMetric("Paths.residentMemoryGrowth", growth / 1024.0, "KiB", tags);
+                ReportMetric("Paths.residentMemoryPerPath", growth / pathCount, "bytes", tags);
+            }
+        }
+    }
 }  // namespace Conformance
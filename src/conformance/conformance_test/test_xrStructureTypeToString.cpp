@@ -38,7 +38,7 @@ namespace Conformance
     {
         // XrResult xrStructureTypeToString(XrInstance instance, XrStructureType value, char buffer[XR_MAX_STRUCTURE_NAME_SIZE]);
 
-        AutoBasicInstance instance;
+        AutoBasicInstance& instance = GetSharedAutoBasicInstance();
 
         XrResult result;
         char buffer[XR_MAX_RESULT_STRING_SIZE];
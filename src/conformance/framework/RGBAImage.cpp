@@ -20,17 +20,30 @@
 #include "stb/stb_image.h"
 #include "stb/stb_truetype.h"
 
+// The rect fill kernel uses SSE2 or NEON when the target has it.
+#if !defined(XR_RGBA_IMAGE_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define XR_RGBA_IMAGE_SIMD_SSE2 1
+#include <emmintrin.h>
+#elif !defined(XR_RGBA_IMAGE_NO_SIMD) && (defined(__ARM_NEON) || defined(_M_ARM64))
+#define XR_RGBA_IMAGE_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
 #include <algorithm>
 #include <array>
 #include <cmath>
 #include <cstdint>
 #include <cstring>
 #include <fstream>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace
 {
@@ -40,11 +53,46 @@ namespace
         return {{(uint8_t)(255 * r), (uint8_t)(255 * g), (uint8_t)(255 * b), (uint8_t)(255 * a)}};
     };
 
-    // Cached TrueType font baked as glyphs.
-    struct BakedFont
+    // Set @p count pixels starting at @p dest to @p color, four at a time where possible.
+    void FillPixels(Conformance::RGBA8Color* dest, size_t count, Conformance::RGBA8Color color)
     {
-        BakedFont(int pixelHeight)
-        {
+        size_t i = 0;
+#if defined(XR_RGBA_IMAGE_SIMD_SSE2)
+        const __m128i color4 = _mm_set1_epi32((int)color.Pixel);
+        for (; i + 4 <= count; i += 4) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), color4);
+        }
+#elif defined(XR_RGBA_IMAGE_SIMD_NEON)
+        const uint32x4_t color4 = vdupq_n_u32(color.Pixel);
+        for (; i + 4 <= count; i += 4) {
+            vst1q_u32(reinterpret_cast<uint32_t*>(dest + i), color4);
+        }
+#endif
+        for (; i < count; ++i) {
+            dest[i] = color;
+        }
+    }
+
+    // Copies of at least this many bytes are split across threads: a single core cannot saturate memory bandwidth on most
+    // devices, and the largest test images are 8k equirects.
+    constexpr size_t ParallelCopyMinBytes = 16 * 1024 * 1024;
+    constexpr uint32_t MaxCopyThreads = 4;
+
+    void CopyRowsWithStride(const uint8_t* source, uint8_t* dest, uint32_t rowSize, uint32_t rows, uint32_t rowPitch)
+    {
+        if (rowPitch == rowSize) {
+            memcpy(dest, source, (size_t)rowSize * rows);
+            return;
+        }
+        for (size_t row = 0; row < rows; ++row) {
+            memcpy(&dest[row * rowPitch], &source[row * rowSize], rowSize);
+        }
+    }
+
+    // The font file contents, read once per process.
+    const std::vector<uint8_t>& GetFontData()
+    {
+        static const std::vector<uint8_t> s_fontData = [] {
             const char* FontFileName = "SourceCodePro-Regular.otf";
 
 #ifdef XR_USE_PLATFORM_ANDROID
@@ -60,7 +108,7 @@ namespace
             if (!buf) {
                 throw std::runtime_error((std::string("Unable to open font ") + FontFileName).c_str());
             }
-            std::vector<uint8_t> fontData(buf, buf + length);
+            return std::vector<uint8_t>(buf, buf + length);
 #else
             std::ifstream file;
             file.open(FontFileName, std::ios::in | std::ios::binary);
@@ -73,7 +121,17 @@ namespace
             file.seekg(0, std::ios::beg);
 
             file.read(reinterpret_cast<char*>(fontData.data()), fontData.size());
+            return fontData;
 #endif
+        }();
+        return s_fontData;
+    }
+
+    // Cached TrueType font baked as glyphs.
+    struct BakedFont
+    {
+        BakedFont(const std::vector<uint8_t>& fontData, int pixelHeight)
+        {
             // This is just a starting size.
             m_bitmapWidth = 1024;
             m_bitmapHeight = 64;
@@ -84,7 +142,7 @@ namespace
             int res = stbtt_BakeFontBitmap(fontData.data(), 0, (float)pixelHeight, glyphBitmap.data(), m_bitmapWidth, m_bitmapHeight,
                                            StartChar, (int)m_bakedChars.size(), m_bakedChars.data());
             if (res == 0) {
-                throw std::runtime_error((std::string("Unable to parse font") + FontFileName).c_str());
+                throw std::runtime_error("Unable to parse font");
             }
             else if (res < 0) {
                 // Bitmap was not big enough to fit so double size and try again.
@@ -93,12 +151,16 @@ namespace
             }
         }
 
+        // Glyph atlases are shared by every image for the rest of the process, one per pixel height.
         static std::shared_ptr<const BakedFont> GetOrCreate(int pixelHeight)
         {
-            std::unordered_map<int, std::shared_ptr<BakedFont>> s_bakedFonts;
+            static std::mutex s_bakedFontsMutex;
+            static std::unordered_map<int, std::shared_ptr<const BakedFont>> s_bakedFonts;
+
+            std::lock_guard<std::mutex> lock(s_bakedFontsMutex);
             auto it = s_bakedFonts.find(pixelHeight);
             if (it == s_bakedFonts.end()) {
-                std::shared_ptr<BakedFont> font = std::make_shared<BakedFont>(pixelHeight);
+                std::shared_ptr<const BakedFont> font = std::make_shared<BakedFont>(GetFontData(), pixelHeight);
                 s_bakedFonts.insert({pixelHeight, font});
                 return font;
             }
@@ -126,6 +188,17 @@ namespace
         int m_bitmapWidth;
         int m_bitmapHeight;
     };
+
+    // A glyph positioned in the destination image by the layout pass of PutText.
+    struct PlacedGlyph
+    {
+        const stbtt_bakedchar* bakedChar;
+        int x;  // Destination of the left column of the glyph
+        int y;  // Destination of the top row of the glyph
+        int width;
+        int height;
+        int line;
+    };
 }  // namespace
 
 namespace Conformance
@@ -135,7 +208,7 @@ namespace Conformance
         pixels.resize(width * height);
     }
 
-    /* static */ RGBAImage RGBAImage::Load(const char* path)
+    RGBAImageFile::RGBAImageFile(const char* path)
     {
         constexpr int RequiredComponents = 4;  // RGBA
 
@@ -169,10 +242,31 @@ namespace Conformance
             throw std::runtime_error((std::string("Unable to load file ") + path).c_str());
         }
 
-        RGBAImage image(width, height);
-        memcpy(image.pixels.data(), uc, width * height * RequiredComponents);
+        m_pixels.reset(uc);
+        m_width = width;
+        m_height = height;
+    }
 
-        stbi_image_free(uc);
+    void RGBAImageFile::CopyRows(uint32_t firstRow, uint32_t rowCount, uint8_t* dest, uint32_t rowPitch) const
+    {
+        if (firstRow + rowCount > (uint32_t)m_height) {
+            throw std::out_of_range("Rows out of bounds");
+        }
+        const uint32_t rowSize = m_width * sizeof(RGBA8Color);
+        CopyWithStride(m_pixels.get() + (size_t)firstRow * rowSize, dest, rowSize, rowCount, rowPitch);
+    }
+
+    void RGBAImageFile::DecodedPixelsDeleter::operator()(uint8_t* pixels) const
+    {
+        stbi_image_free(pixels);
+    }
+
+    /* static */ RGBAImage RGBAImage::Load(const char* path)
+    {
+        const RGBAImageFile file(path);
+
+        RGBAImage image(file.Width(), file.Height());
+        file.CopyRows(0, file.Height(), reinterpret_cast<uint8_t*>(image.pixels.data()), file.Width() * sizeof(RGBA8Color));
 
         // Images loaded from files are assumed to be SRGB
         image.isSrgb = true;
@@ -180,23 +274,28 @@ namespace Conformance
         return image;
     }
 
-    void RGBAImage::PutText(const XrRect2Di& rect, const char* text, int pixelHeight, XrColor4f color, WordWrap wordWrap)
+    XrRect2Di RGBAImage::PutText(const XrRect2Di& rect, const char* text, int pixelHeight, XrColor4f color, WordWrap wordWrap)
     {
         const std::shared_ptr<const BakedFont> font = BakedFont::GetOrCreate(pixelHeight);
         if (!font)
-            return;
+            return {};
 
         float xadvance = (float)rect.offset.x;
         int yadvance =
             rect.offset.y + (int)(pixelHeight * 0.8f);  // Adjust down because glyphs are relative to the font baseline. This is hacky.
+        int line = 0;
 
         const char* const fullText = text;
 
-        // Loop through each character and copy over the chracters' glyphs.
+        // First lay out the whole string, then copy the glyphs over a row of the image at a time.
+        std::vector<PlacedGlyph> glyphs;
+        glyphs.reserve(strlen(text));
+
         for (; *text; text++) {
             if (*text == '\n') {
                 xadvance = (float)rect.offset.x;
                 yadvance += pixelHeight;
+                line++;
                 continue;
             }
 
@@ -204,7 +303,7 @@ namespace Conformance
             {
                 float remainingWordWidth = 0;
                 for (const char* w = text; *w > ' '; w++) {
-                    const stbtt_bakedchar& bakedChar = font->GetBakedChar(*text);
+                    const stbtt_bakedchar& bakedChar = font->GetBakedChar(*w);
                     remainingWordWidth += bakedChar.xadvance;
                 }
 
@@ -215,6 +314,7 @@ namespace Conformance
                         if (wordWrap == WordWrap::Enabled) {
                             xadvance = (float)rect.offset.x;
                             yadvance += pixelHeight;
+                            line++;
                         }
                         else {
                             ReportConsoleOnlyF("CTS dev warning: Would have wrapped this text but told to disable word wrap! Text: %s",
@@ -234,45 +334,85 @@ namespace Conformance
                     // Wrap to new line if there isn't enough room for this char.
                     xadvance = (float)rect.offset.x;
                     yadvance += pixelHeight;
+                    line++;
                 }
                 else {
                     ReportConsoleOnlyF("CTS dev warning: Would have wrapped this text but told to disable word wrap! Text: %s", fullText);
                 }
             }
 
-            // For each row of the glyph bitmap
-            for (int cy = 0; cy < characterHeight; cy++) {
-                // Compute the destination row in the image.
-                const int destY = yadvance + cy + (int)bakedChar.yoff;
-                if (destY < 0 || destY >= height || destY < rect.offset.y || destY >= rect.offset.y + rect.extent.height) {
-                    continue;  // Don't bother copying if out of bounds.
-                }
+            if (characterWidth > 0 && characterHeight > 0) {
+                glyphs.push_back(PlacedGlyph{&bakedChar, (int)std::lround(bakedChar.xoff + xadvance), yadvance + (int)bakedChar.yoff,
+                                             characterWidth, characterHeight, line});
+            }
+
+            xadvance += bakedChar.xadvance;
+        }
+
+        // Don't bother copying anything out of bounds.
+        const int clipLeft = std::max(0, rect.offset.x);
+        const int clipRight = std::min(width, rect.offset.x + rect.extent.width);
+        const int clipTop = std::max(0, rect.offset.y);
+        const int clipBottom = std::min(height, rect.offset.y + rect.extent.height);
+
+        int drawnLeft = clipRight;
+        int drawnRight = clipLeft;
+        int drawnTop = clipBottom;
+        int drawnBottom = clipTop;
+        for (const PlacedGlyph& glyph : glyphs) {
+            drawnLeft = std::min(drawnLeft, std::max(glyph.x, clipLeft));
+            drawnRight = std::max(drawnRight, std::min(glyph.x + glyph.width, clipRight));
+            drawnTop = std::min(drawnTop, std::max(glyph.y, clipTop));
+            drawnBottom = std::max(drawnBottom, std::min(glyph.y + glyph.height, clipBottom));
+        }
 
-                // Get a pointer to the src and dest row.
-                const uint8_t* const srcGlyphRow = font->GetBakedCharRow(bakedChar, cy);
+        for (size_t lineBegin = 0; lineBegin < glyphs.size();) {
+            size_t lineEnd = lineBegin;
+            int lineTop = glyphs[lineBegin].y;
+            int lineBottom = glyphs[lineBegin].y;
+            for (; lineEnd < glyphs.size() && glyphs[lineEnd].line == glyphs[lineBegin].line; lineEnd++) {
+                lineTop = std::min(lineTop, glyphs[lineEnd].y);
+                lineBottom = std::max(lineBottom, glyphs[lineEnd].y + glyphs[lineEnd].height);
+            }
+
+            for (int destY = std::max(lineTop, clipTop); destY < std::min(lineBottom, clipBottom); destY++) {
                 RGBA8Color* const destImageRow = pixels.data() + (destY * width);
 
-                for (int cx = 0; cx < characterWidth; cx++) {
-                    const int destX = (int)std::lround(bakedChar.xoff + xadvance) + cx;
-                    if (destX < 0 || destX >= width || destX < rect.offset.x || destX >= rect.offset.x + rect.extent.width) {
-                        continue;  // Don't bother copying if out of bounds.
+                for (size_t g = lineBegin; g < lineEnd; g++) {
+                    const PlacedGlyph& glyph = glyphs[g];
+                    const int cy = destY - glyph.y;
+                    if (cy < 0 || cy >= glyph.height) {
+                        continue;
                     }
 
-                    // Glyphs are 0-255 intensity.
-                    const uint8_t srcGlyphPixel = srcGlyphRow[cx + bakedChar.x0];
+                    const uint8_t* const srcGlyphRow = font->GetBakedCharRow(*glyph.bakedChar, cy) + glyph.bakedChar->x0;
+                    const int destBegin = std::max(glyph.x, clipLeft);
+                    const int destEnd = std::min(glyph.x + glyph.width, clipRight);
+                    for (int destX = destBegin; destX < destEnd; destX++) {
+                        // Glyphs are 0-255 intensity.
+                        const uint8_t srcGlyphPixel = srcGlyphRow[destX - glyph.x];
+                        if (srcGlyphPixel == 0) {
+                            continue;  // Blending would leave the destination unchanged.
+                        }
 
-                    // Do blending (assuming premultiplication).
-                    RGBA8Color pixel = destImageRow[destX];
-                    pixel.Channels.R = (uint8_t)(srcGlyphPixel * color.r) + (pixel.Channels.R * (255 - srcGlyphPixel) / 255);
-                    pixel.Channels.G = (uint8_t)(srcGlyphPixel * color.g) + (pixel.Channels.G * (255 - srcGlyphPixel) / 255);
-                    pixel.Channels.B = (uint8_t)(srcGlyphPixel * color.b) + (pixel.Channels.B * (255 - srcGlyphPixel) / 255);
-                    pixel.Channels.A = (uint8_t)(srcGlyphPixel * color.a) + (pixel.Channels.A * (255 - srcGlyphPixel) / 255);
-                    destImageRow[destX] = pixel;
+                        // Do blending (assuming premultiplication).
+                        RGBA8Color pixel = destImageRow[destX];
+                        pixel.Channels.R = (uint8_t)(srcGlyphPixel * color.r) + (pixel.Channels.R * (255 - srcGlyphPixel) / 255);
+                        pixel.Channels.G = (uint8_t)(srcGlyphPixel * color.g) + (pixel.Channels.G * (255 - srcGlyphPixel) / 255);
+                        pixel.Channels.B = (uint8_t)(srcGlyphPixel * color.b) + (pixel.Channels.B * (255 - srcGlyphPixel) / 255);
+                        pixel.Channels.A = (uint8_t)(srcGlyphPixel * color.a) + (pixel.Channels.A * (255 - srcGlyphPixel) / 255);
+                        destImageRow[destX] = pixel;
+                    }
                 }
             }
 
-            xadvance += bakedChar.xadvance;
+            lineBegin = lineEnd;
+        }
+
+        if (drawnLeft >= drawnRight || drawnTop >= drawnBottom) {
+            return {};
         }
+        return {{drawnLeft, drawnTop}, {drawnRight - drawnLeft, drawnBottom - drawnTop}};
     }
 
     void RGBAImage::DrawRect(int x, int y, int w, int h, XrColor4f color)
@@ -281,12 +421,18 @@ namespace Conformance
             throw std::out_of_range("Rectangle out of bounds");
         }
 
+        if (w <= 0 || h <= 0) {
+            return;
+        }
+
         const RGBA8Color color32 = AsRGBA(color.r, color.g, color.b, color.a);
+        if (x == 0 && w == width) {
+            // Full width rows are contiguous.
+            FillPixels(pixels.data() + (y * width), (size_t)w * h, color32);
+            return;
+        }
         for (int row = 0; row < h; row++) {
-            RGBA8Color* start = pixels.data() + ((row + y) * width) + x;
-            for (int col = 0; col < w; col++) {
-                *(start + col) = color32;
-            }
+            FillPixels(pixels.data() + ((row + y) * width) + x, w, color32);
         }
     }
 
@@ -300,30 +446,31 @@ namespace Conformance
         for (int row = 0; row < h; row++) {
             RGBA8Color* start = pixels.data() + ((row + y) * width) + x;
             if (row < thickness || row >= h - thickness) {
-                for (int col = 0; col < w; col++) {
-                    *(start + col) = color32;
-                }
+                FillPixels(start, w, color32);
             }
             else {
-                int leftBorderEnd = std::min(thickness, w);
-                for (int col = 0; col < leftBorderEnd; col++) {
-                    *(start + col) = color32;
-                }
-
-                int rightBorderBegin = std::max(w - thickness, 0);
-                for (int col = rightBorderBegin; col < w; col++) {
-                    *(start + col) = color32;
-                }
+                const int border = std::max(std::min(thickness, w), 0);
+                FillPixels(start, border, color32);
+                FillPixels(start + (w - border), border, color32);
             }
         }
     }
 
     void RGBAImage::ConvertToSRGB()
     {
+        // Every input is 8-bit, so precompute the conversion of each possible value once.
+        static const std::array<uint8_t, 256> linearToSRGB = [] {
+            std::array<uint8_t, 256> table{};
+            for (size_t i = 0; i < table.size(); ++i) {
+                table[i] = (uint8_t)(ColorUtils::ToSRGB((double)i / 255.0) * 255.0);
+            }
+            return table;
+        }();
+
         for (RGBA8Color& pixel : pixels) {
-            pixel.Channels.R = (uint8_t)(ColorUtils::ToSRGB((double)pixel.Channels.R / 255.0) * 255.0);
-            pixel.Channels.G = (uint8_t)(ColorUtils::ToSRGB((double)pixel.Channels.G / 255.0) * 255.0);
-            pixel.Channels.B = (uint8_t)(ColorUtils::ToSRGB((double)pixel.Channels.B / 255.0) * 255.0);
+            pixel.Channels.R = linearToSRGB[pixel.Channels.R];
+            pixel.Channels.G = linearToSRGB[pixel.Channels.G];
+            pixel.Channels.B = linearToSRGB[pixel.Channels.B];
         }
     }
 
@@ -333,11 +480,14 @@ namespace Conformance
                                     rowPitch);
     }
 
-    void RGBAImageCache::Init()
+    void RGBAImageCache::Init(size_t memoryBudgetBytes)
     {
-        if (!m_cacheMutex) {
-            m_cacheMutex = std::make_unique<std::mutex>();
+        if (!m_state) {
+            m_state = std::make_unique<State>();
         }
+        std::unique_lock<std::shared_timed_mutex> lock(m_state->mutex);
+        m_state->memoryBudgetBytes = memoryBudgetBytes;
+        EvictToBudget({});
     }
 
     std::shared_ptr<RGBAImage> RGBAImageCache::Load(const char* path)
@@ -346,29 +496,118 @@ namespace Conformance
             throw std::logic_error("RGBAImageCache accessed before initialization");
         }
 
-        // Check cache to see if this image already exists.
+        // Check cache to see if this image already exists, or is being loaded by another thread.
+        {
+            std::shared_lock<std::shared_timed_mutex> lock(m_state->mutex);
+            auto entryIt = m_state->entries.find(path);
+            if (entryIt != m_state->entries.end()) {
+                entryIt->second.lastUse = ++m_state->useCounter;
+                std::shared_future<std::shared_ptr<RGBAImage>> image = entryIt->second.image;
+                lock.unlock();
+                return image.get();
+            }
+        }
+
+        std::promise<std::shared_ptr<RGBAImage>> promise;
         {
-            std::lock_guard<std::mutex> guard(*m_cacheMutex);
-            auto imageIt = m_imageCache.find(path);
-            if (imageIt != m_imageCache.end()) {
-                return imageIt->second;
+            std::unique_lock<std::shared_timed_mutex> lock(m_state->mutex);
+            Entry& entry = m_state->entries[path];
+            entry.lastUse = ++m_state->useCounter;
+            if (entry.image.valid()) {
+                // Another thread got here between the two locks.
+                std::shared_future<std::shared_ptr<RGBAImage>> image = entry.image;
+                lock.unlock();
+                return image.get();
             }
+            entry.image = promise.get_future().share();
         }
 
         ReportConsoleOnlyF("Loading and caching image: %s", path);
 
-        auto image = std::make_shared<RGBAImage>(RGBAImage::Load(path));
+        std::shared_ptr<RGBAImage> image;
+        try {
+            image = std::make_shared<RGBAImage>(RGBAImage::Load(path));
+        }
+        catch (...) {
+            // Waiting threads get the same error, later calls try again.
+            promise.set_exception(std::current_exception());
+            std::unique_lock<std::shared_timed_mutex> lock(m_state->mutex);
+            m_state->entries.erase(path);
+            throw;
+        }
+        promise.set_value(image);
+
+        std::unique_lock<std::shared_timed_mutex> lock(m_state->mutex);
+        auto entryIt = m_state->entries.find(path);
+        if (entryIt != m_state->entries.end()) {
+            entryIt->second.sizeBytes = image->pixels.size() * sizeof(RGBA8Color);
+            m_state->totalBytes += entryIt->second.sizeBytes;
+            EvictToBudget(path);
+        }
+        return image;
+    }
+
+    void RGBAImageCache::EvictToBudget(const std::string& keep)
+    {
+        if (m_state->memoryBudgetBytes == 0) {
+            return;
+        }
+        while (m_state->totalBytes > m_state->memoryBudgetBytes) {
+            auto oldest = m_state->entries.end();
+            for (auto it = m_state->entries.begin(); it != m_state->entries.end(); ++it) {
+                if (it->second.sizeBytes == 0 || it->first == keep) {
+                    continue;
+                }
+                if (oldest == m_state->entries.end() || it->second.lastUse < oldest->second.lastUse) {
+                    oldest = it;
+                }
+            }
+            if (oldest == m_state->entries.end()) {
+                return;
+            }
+            m_state->totalBytes -= oldest->second.sizeBytes;
+            m_state->entries.erase(oldest);
+        }
+    }
+
+    RGBAImageCache& GetSharedRGBAImageCache()
+    {
+        static RGBAImageCache imageCache = [] {
+            RGBAImageCache cache;
+            cache.Init();
+            return cache;
+        }();
+        return imageCache;
+    }
 
-        std::lock_guard<std::mutex> guard(*m_cacheMutex);
-        // If the key already exists then the existing image will be returned.
-        return m_imageCache.emplace(path, image).first->second;
+    void PrefetchFont(int pixelHeight)
+    {
+        BakedFont::GetOrCreate(pixelHeight);
     }
 
     void CopyWithStride(const uint8_t* source, uint8_t* dest, uint32_t rowSize, uint32_t rows, uint32_t rowPitch)
     {
-        for (size_t row = 0; row < rows; ++row) {
-            uint8_t* rowPtr = &dest[row * rowPitch];
-            memcpy(rowPtr, &source[row * rowSize], rowSize);
+        if ((size_t)rowSize * rows < ParallelCopyMinBytes) {
+            CopyRowsWithStride(source, dest, rowSize, rows, rowPitch);
+            return;
+        }
+        const uint32_t threadCount = std::min({MaxCopyThreads, std::max(std::thread::hardware_concurrency(), 1u), rows});
+        if (threadCount < 2) {
+            CopyRowsWithStride(source, dest, rowSize, rows, rowPitch);
+            return;
+        }
+
+        // Each thread copies a band of whole rows; this thread copies the last one.
+        const uint32_t rowsPerThread = (rows + threadCount - 1) / threadCount;
+        std::vector<std::thread> threads;
+        uint32_t firstRow = 0;
+        for (; firstRow + rowsPerThread < rows; firstRow += rowsPerThread) {
+            threads.emplace_back(CopyRowsWithStride, source + (size_t)firstRow * rowSize, dest + (size_t)firstRow * rowPitch, rowSize,
+                                 rowsPerThread, rowPitch);
+        }
+        CopyRowsWithStride(source + (size_t)firstRow * rowSize, dest + (size_t)firstRow * rowPitch, rowSize, rows - firstRow, rowPitch);
+        for (std::thread& thread : threads) {
+            thread.join();
         }
     }
 
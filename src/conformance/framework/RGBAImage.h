@@ -6,9 +6,14 @@
 
 #include <openxr/openxr.h>
 
+#include <atomic>
+#include <cstddef>
+#include <future>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
+#include <string>
 #include <vector>
 
 namespace Conformance
@@ -46,7 +51,9 @@ namespace Conformance
 
         static RGBAImage Load(const char* path);
 
-        void PutText(const XrRect2Di& rect, const char* text, int pixelHeight, XrColor4f color, WordWrap wordWrap = WordWrap::Enabled);
+        /// Draw @p text within @p rect, and return the part of the image the glyphs drawn cover (empty if none were drawn).
+        XrRect2Di PutText(const XrRect2Di& rect, const char* text, int pixelHeight, XrColor4f color,
+                          WordWrap wordWrap = WordWrap::Enabled);
         void DrawRect(int x, int y, int w, int h, XrColor4f color);
         void DrawRectBorder(int x, int y, int w, int h, int thickness, XrColor4f color);
         void ConvertToSRGB();
@@ -61,7 +68,44 @@ namespace Conformance
         int32_t height;
     };
 
-    /// A 2D, 32 bit-per-pixel RGBA image
+    /// An image file decoded to 32 bit-per-pixel RGBA, for streaming straight to a swapchain with
+    /// IGraphicsPlugin::CopyRGBAImageRows rather than copying it into an RGBAImage first. Like RGBAImage::Load, the pixels
+    /// are assumed to be SRGB.
+    ///
+    /// The decoder only decodes whole images, so the decoded pixels are held until this is destroyed; what streaming saves
+    /// is the RGBAImage copy, and on APIs uploading in bands, the full size staging copy.
+    class RGBAImageFile
+    {
+    public:
+        /// Throws if @p path cannot be read or decoded.
+        explicit RGBAImageFile(const char* path);
+
+        int32_t Width() const
+        {
+            return m_width;
+        }
+        int32_t Height() const
+        {
+            return m_height;
+        }
+
+        /// Copy @p rowCount rows from @p firstRow on to @p dest, @p rowPitch bytes apart; an IGraphicsPlugin::RGBARowWriter.
+        void CopyRows(uint32_t firstRow, uint32_t rowCount, uint8_t* dest, uint32_t rowPitch) const;
+
+    private:
+        struct DecodedPixelsDeleter
+        {
+            void operator()(uint8_t* pixels) const;
+        };
+
+        std::unique_ptr<uint8_t, DecodedPixelsDeleter> m_pixels;
+        int32_t m_width{0};
+        int32_t m_height{0};
+    };
+
+
+    ///
+    /// Concurrent requests for the same path share a single decode. Cache hits only take a shared lock.
     class RGBAImageCache
     {
     public:
@@ -70,21 +114,49 @@ namespace Conformance
         RGBAImageCache(RGBAImageCache&&) = default;
         RGBAImageCache& operator=(RGBAImageCache&&) = default;
 
-        void Init();
+        /// @param memoryBudgetBytes If non-zero, the least recently loaded images are dropped from the cache once the
+        /// decoded images take more than this many bytes. Images still held by a caller stay alive until released.
+        void Init(size_t memoryBudgetBytes = 0);
 
         bool IsValid() const noexcept
         {
-            return m_cacheMutex != nullptr;
+            return m_state != nullptr;
         }
 
         std::shared_ptr<RGBAImage> Load(const char* path);
 
     private:
+        struct Entry
+        {
+            std::shared_future<std::shared_ptr<RGBAImage>> image;
+            /// Zero until the decode has finished, so in-flight entries are never evicted.
+            size_t sizeBytes{0};
+            /// Value of State::useCounter at the most recent Load of this path.
+            std::atomic<uint64_t> lastUse{0};
+        };
+
+        struct State
+        {
+            std::shared_timed_mutex mutex;
+            std::map<std::string, Entry> entries;
+            std::atomic<uint64_t> useCounter{0};
+            size_t totalBytes{0};
+            size_t memoryBudgetBytes{0};
+        };
+
+        /// Drop least recently used decoded images, other than @p keep, until within budget. Called with the lock held.
+        void EvictToBudget(const std::string& keep);
+
         // in unique_ptr to make it moveable
-        std::unique_ptr<std::mutex> m_cacheMutex;
-        std::map<std::string, std::shared_ptr<RGBAImage>> m_imageCache;
+        std::unique_ptr<State> m_state;
     };
 
+    /// The image cache shared by all test cases for the whole process, which the asset prefetcher fills ahead of them.
+    RGBAImageCache& GetSharedRGBAImageCache();
+
+    /// Load the font and bake its glyphs at @p pixelHeight, so that the first RGBAImage::PutText at that height does not.
+    void PrefetchFont(int pixelHeight);
+
     /// Copy a contiguous image into a buffer for GPU usage - with stride/pitch.
     ///
     /// @param source Source buffer, with all pixels contiguous
@@ -61,11 +61,21 @@ namespace Conformance
     const std::chrono::nanoseconds kActionWaitDelay = 5ms;
 #endif  // XR_USE_PLATFORM_ANDROID
 
+    namespace
+    {
+        constexpr int32_t MessageFontHeightPixels = 40;
+        constexpr int32_t MessageWidthPixels = 768;
+        // Five lines of text, with room for the padding and border.
+        constexpr int32_t MessageHeightPixels = (MessageFontHeightPixels + 4 * 2) * 5;
+    }  // namespace
+
     ActionLayerManager::ActionLayerManager(CompositionHelper& compositionHelper)
         : m_compositionHelper(compositionHelper)
         , m_viewSpace(compositionHelper.CreateReferenceSpace(XR_REFERENCE_SPACE_TYPE_VIEW))
         , m_eventReader(m_compositionHelper.GetEventQueue())
         , m_renderLoop(m_compositionHelper.GetSession(), [&](const XrFrameState& frameState) { return EndFrame(frameState); })
+        , m_messageQuad(compositionHelper, MessageWidthPixels, MessageHeightPixels, MessageFontHeightPixels, m_viewSpace, 1,
+                        XrPosef{{0, 0, 0, 1}, {0, 0, -1.5f}})
     {
     }
 
@@ -82,7 +92,7 @@ namespace Conformance
                 }
                 return completed;
             },
-            20s, kActionWaitDelay);
+            20s, m_compositionHelper.GetEventQueue());
 
         REQUIRE_MSG(waitCompleted, std::string("Time out: ") + waitMessage);
         DisplayMessage("");
@@ -137,13 +147,9 @@ namespace Conformance
     {
         std::lock_guard<std::mutex> lock(m_mutex);
 
-        if (m_displayMessageImage) {
-            m_messageQuad = std::make_unique<MessageQuad>(m_compositionHelper, std::move(m_displayMessageImage), m_viewSpace);
-        }
-
         std::vector<XrCompositionLayerBaseHeader*> layers;
-        if (m_messageQuad != nullptr) {
-            layers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader*>(m_messageQuad.get()));
+        if (XrCompositionLayerQuad* const messageLayer = m_messageQuad.GetLayer()) {
+            layers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader*>(messageLayer));
         }
         m_compositionHelper.EndFrame(frameState.predictedDisplayTime, std::move(layers));
         m_compositionHelper.PollEvents();
@@ -157,31 +163,17 @@ namespace Conformance
 
     void ActionLayerManager::DisplayMessage(const std::string& message)
     {
-        if (message == m_lastMessage) {
-            return;  // No need to regenerate the swapchain.
-        }
+        std::lock_guard<std::mutex> lock(m_mutex);
 
-        if (!message.empty()) {
-            ReportF("Interaction message: %s", message.c_str());
+        if (message == m_messageQuad.GetText()) {
+            return;  // No need to redraw the message.
         }
 
-        constexpr int TitleFontHeightPixels = 40;
-        constexpr int TitleFontPaddingPixels = 2;
-        constexpr int TitleBorderPixels = 2;
-        constexpr int InsetPixels = TitleBorderPixels + TitleFontPaddingPixels;
-
-        std::lock_guard<std::mutex> lock(m_mutex);
-
-        auto image = std::make_unique<RGBAImage>(768, (TitleFontHeightPixels + InsetPixels * 2) * 5);
         if (!message.empty()) {
-            image->DrawRect(0, 0, image->width, image->height, {0.25f, 0.25f, 0.25f, 0.25f});
-            image->DrawRectBorder(0, 0, image->width, image->height, TitleBorderPixels, {0.5f, 0.5f, 0.5f, 1});
-            image->PutText(XrRect2Di{{InsetPixels, InsetPixels}, {image->width - InsetPixels * 2, image->height - InsetPixels * 2}},
-                           message.c_str(), TitleFontHeightPixels, {1, 1, 1, 1});
+            ReportF("Interaction message: %s", message.c_str());
         }
 
-        m_displayMessageImage = std::move(image);
-        m_lastMessage = message;
+        m_messageQuad.SetText(message);
     }
 
     std::string ActionLayerManager::ListActionsLocalized(XrActionsSyncInfo syncInfo, nonstd::span<XrAction> actions,
@@ -246,25 +238,4 @@ namespace Conformance
         return oss.str();
     }  // namespace Conformance
 
-    ActionLayerManager::MessageQuad::MessageQuad(CompositionHelper& compositionHelper, std::unique_ptr<RGBAImage> image,
-                                                 XrSpace compositionSpace)
-        : m_compositionHelper(compositionHelper)
-    {
-        const XrSwapchain messageSwapchain = m_compositionHelper.CreateStaticSwapchainImage(*image);
-
-        *static_cast<XrCompositionLayerQuad*>(this) = {XR_TYPE_COMPOSITION_LAYER_QUAD};
-        size.width = 1;
-        size.height = size.width * static_cast<float>(image->height) / static_cast<float>(image->width);
-        pose = XrPosef{{0, 0, 0, 1}, {0, 0, -1.5f}};
-        subImage = m_compositionHelper.MakeDefaultSubImage(messageSwapchain);
-        space = compositionSpace;
-    }
-
-    ActionLayerManager::MessageQuad::~MessageQuad()
-    {
-        if (subImage.swapchain) {
-            m_compositionHelper.DestroySwapchain(subImage.swapchain);
-        }
-    }
-
 }  // namespace Conformance
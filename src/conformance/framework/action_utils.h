@@ -122,8 +122,8 @@ namespace Conformance
 
         /// Display a message on the console and in the immersive environment.
         ///
-        /// Prepares a static swapchain with the message for use the next time @ref EndFrame is called,
-        /// directly or indirectly, through this helper object.
+        /// Draws the message into the image of the message layer, which is shown the next time @ref EndFrame is called,
+        /// directly or indirectly, through this helper object. Displaying the same message again does nothing.
         /// (Does not directly submit frames!)
         void DisplayMessage(const std::string& message) override;
         std::string ListActionsLocalized(XrActionsSyncInfo syncInfo, nonstd::span<XrAction> actions, const char* actionDelimiter,
@@ -137,18 +137,6 @@ namespace Conformance
         EventReader m_eventReader;
         RenderLoop m_renderLoop;
 
-        std::string m_lastMessage;
-        std::unique_ptr<RGBAImage> m_displayMessageImage;
-
-        struct MessageQuad : public XrCompositionLayerQuad
-        {
-            MessageQuad(CompositionHelper& compositionHelper, std::unique_ptr<RGBAImage> image, XrSpace compositionSpace);
-            ~MessageQuad();
-
-        private:
-            CompositionHelper& m_compositionHelper;
-        };
-
-        std::unique_ptr<MessageQuad> m_messageQuad;
+        DynamicTextQuad m_messageQuad;
     };
 }  // namespace Conformance
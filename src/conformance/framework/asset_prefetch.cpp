@@ -0,0 +1,148 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "asset_prefetch.h"
+
+#include "RGBAImage.h"
+#include "gltf_helpers.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <set>
+#include <thread>
+
+namespace Conformance
+{
+    namespace
+    {
+        struct RegisteredAssets
+        {
+            std::vector<std::string> imagePaths;
+            std::vector<std::string> gltfPaths;
+        };
+
+        // Filled during static initialization, read-only afterwards.
+        std::map<std::string, RegisteredAssets>& Registry()
+        {
+            static std::map<std::string, RegisteredAssets> registry;
+            return registry;
+        }
+
+        // Pixel heights of the text drawn by the interactive layers and titles of most test cases.
+        constexpr int kPrefetchFontPixelHeights[] = {32, 40, 48};
+
+        class AssetPrefetcher
+        {
+        public:
+            void Start(std::vector<std::function<void()>> jobs)
+            {
+                Stop();
+                m_jobs = std::move(jobs);
+                m_nextJob = 0;
+                m_stopping = false;
+
+                // Leave a core for the test cases themselves.
+                const size_t threadCount = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 2u) - 1, 4);
+                for (size_t i = 0; i < threadCount; ++i) {
+                    m_threads.emplace_back([this] { Run(); });
+                }
+            }
+
+            void Stop()
+            {
+                m_stopping = true;
+                for (std::thread& thread : m_threads) {
+                    thread.join();
+                }
+                m_threads.clear();
+                m_jobs.clear();
+            }
+
+        private:
+            void Run()
+            {
+                for (;;) {
+                    const size_t job = m_nextJob++;
+                    if (m_stopping || job >= m_jobs.size()) {
+                        break;
+                    }
+                    try {
+                        m_jobs[job]();
+                    }
+                    catch (const std::exception&) {
+                        // The test case reports the error when it loads the asset itself.
+                    }
+                }
+            }
+
+            std::vector<std::function<void()>> m_jobs;
+            std::atomic<size_t> m_nextJob{0};
+            std::atomic<bool> m_stopping{false};
+            std::vector<std::thread> m_threads;
+        };
+
+        AssetPrefetcher& GetAssetPrefetcher()
+        {
+            static AssetPrefetcher prefetcher;
+            return prefetcher;
+        }
+    }  // namespace
+
+    AssetPrefetchRegistration::AssetPrefetchRegistration(const char* testCaseName, std::initializer_list<const char*> imagePaths,
+                                                         std::initializer_list<const char*> gltfPaths)
+    {
+        RegisteredAssets& assets = Registry()[testCaseName];
+        assets.imagePaths.insert(assets.imagePaths.end(), imagePaths.begin(), imagePaths.end());
+        assets.gltfPaths.insert(assets.gltfPaths.end(), gltfPaths.begin(), gltfPaths.end());
+    }
+
+    void StartAssetPrefetch(const std::vector<std::string>& testCaseNames)
+    {
+        std::vector<std::function<void()>> jobs;
+        for (int pixelHeight : kPrefetchFontPixelHeights) {
+            jobs.push_back([pixelHeight] { PrefetchFont(pixelHeight); });
+        }
+
+        // Each asset once, in the order the test cases will need them.
+        std::set<std::string> queued;
+        for (const std::string& testCaseName : testCaseNames) {
+            auto it = Registry().find(testCaseName);
+            if (it == Registry().end()) {
+                continue;
+            }
+            for (const std::string& path : it->second.imagePaths) {
+                if (queued.insert(path).second) {
+                    jobs.push_back([path] { GetSharedRGBAImageCache().Load(path.c_str()); });
+                }
+            }
+            for (const std::string& path : it->second.gltfPaths) {
+                if (queued.insert(path).second) {
+                    // Only parsed: decoding the scene reports metrics, which would land on whichever test case is running.
+                    jobs.push_back([path] { LoadGLTFFile(path.c_str()); });
+                }
+            }
+        }
+
+        GetAssetPrefetcher().Start(std::move(jobs));
+    }
+
+    void StopAssetPrefetch()
+    {
+        GetAssetPrefetcher().Stop();
+    }
+}  // namespace Conformance
@@ -0,0 +1,45 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+namespace Conformance
+{
+    /// Declares the assets a test case loads, so that @ref StartAssetPrefetch can decode them before the test case runs.
+    ///
+    /// Define one at namespace scope next to the test case. Images must be loaded through GetSharedRGBAImageCache, and
+    /// glTF files through LoadGLTFFile, for the test case to find the prefetched copies.
+    class AssetPrefetchRegistration
+    {
+    public:
+        AssetPrefetchRegistration(const char* testCaseName, std::initializer_list<const char*> imagePaths,
+                                  std::initializer_list<const char*> gltfPaths = {});
+    };
+
+    /// Start decoding, on background threads, the font and the assets registered for any of @p testCaseNames.
+    ///
+    /// Decoding happens in the order the test cases are given, so the first test cases to run are ready first. A test
+    /// case that needs an asset still being decoded waits for it rather than decoding it again. Errors are ignored here,
+    /// the test case gets them when it loads the asset itself.
+    void StartAssetPrefetch(const std::vector<std::string>& testCaseNames);
+
+    /// Stop starting new decodes and wait for the running ones. Assets not decoded yet load on first use as before.
+    void StopAssetPrefetch();
+}  // namespace Conformance
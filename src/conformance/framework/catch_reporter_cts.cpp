@@ -21,11 +21,13 @@
 #include <catch2/catch_test_case_info.hpp>
 #include <catch2/catch_test_spec.hpp>
 #include <catch2/internal/catch_move_and_forward.hpp>
+#include <catch2/internal/catch_test_case_registry_impl.hpp>
 
 #include <cassert>
 #include <ctime>
 #include <algorithm>
 #include <iomanip>
+#include <iterator>
 
 namespace Catch
 {
@@ -107,6 +109,7 @@ namespace Catch
     void CTSReporter::testRunStarting(TestRunInfo const& runInfo)
     {
         CumulativeReporterBase::testRunStarting(runInfo);
+        m_streaming = Conformance::GetGlobalData().GetOptions().streamReport;
         xml.startElement("testsuites");
 
         // Add CTS-specific namespace
@@ -116,6 +119,12 @@ namespace Catch
         stdOutForSuite.clear();
         stdErrForSuite.clear();
         unexpectedExceptions = 0;
+
+        if (m_streaming) {
+            // The totals are not known yet: they are written in a cts:totals element at the end of the run instead.
+            writeSuiteStart(static_cast<std::string>(runInfo.name), nullptr, 0.0);
+            m_stream.flush();
+        }
     }
 
     void CTSReporter::testCaseStarting(TestCaseInfo const& testCaseInfo)
@@ -123,42 +132,141 @@ namespace Catch
         m_okToFail = testCaseInfo.okToFail();
     }
 
+    void CTSReporter::sectionStarting(SectionInfo const& sectionInfo)
+    {
+        m_sectionNames.push_back(trim(sectionInfo.name));
+
+        // Same as CumulativeReporterBase::sectionStarting, which is not called so the tree can be dropped once written.
+        SectionStats incompleteStats(SectionInfo(sectionInfo), Counts(), 0, false);
+        SectionNode* node;
+        if (m_sectionStack.empty()) {
+            if (!m_rootSection) {
+                m_rootSection = Detail::make_unique<SectionNode>(incompleteStats);
+            }
+            node = m_rootSection.get();
+        }
+        else {
+            SectionNode& parentNode = *m_sectionStack.back();
+            auto it = std::find_if(parentNode.childSections.begin(), parentNode.childSections.end(),
+                                   [&](Detail::unique_ptr<SectionNode> const& child) {
+                                       return child->stats.sectionInfo.name == sectionInfo.name &&
+                                              child->stats.sectionInfo.lineInfo == sectionInfo.lineInfo;
+                                   });
+            if (it == parentNode.childSections.end()) {
+                auto newNode = Detail::make_unique<SectionNode>(incompleteStats);
+                node = newNode.get();
+                parentNode.childSections.push_back(CATCH_MOVE(newNode));
+            }
+            else {
+                node = it->get();
+            }
+        }
+
+        m_deepestSection = node;
+        m_sectionStack.push_back(node);
+    }
+
+    void CTSReporter::sectionEnded(SectionStats const& sectionStats)
+    {
+        // Attribute everything reported since the last section ended to this one.
+        std::vector<Conformance::Metric> metrics = Conformance::TakeReportedMetrics();
+        if (!metrics.empty()) {
+            std::string sectionPath;
+            for (auto const& sectionName : m_sectionNames) {
+                sectionPath += (sectionPath.empty() ? "" : "/") + sectionName;
+            }
+            auto& sectionMetrics = m_sectionMetrics[sectionPath];
+            sectionMetrics.insert(sectionMetrics.end(), std::make_move_iterator(metrics.begin()), std::make_move_iterator(metrics.end()));
+        }
+        if (!m_sectionNames.empty()) {
+            m_sectionNames.pop_back();
+        }
+
+        assert(!m_sectionStack.empty());
+        m_sectionStack.back()->stats = sectionStats;
+        m_sectionStack.pop_back();
+    }
+
     void CTSReporter::assertionEnded(AssertionStats const& assertionStats)
     {
-        if (assertionStats.assertionResult.getResultType() == ResultWas::ThrewException && !m_okToFail)
+        AssertionResult const& result = assertionStats.assertionResult;
+        if (result.getResultType() == ResultWas::ThrewException && !m_okToFail)
             unexpectedExceptions++;
-        CumulativeReporterBase::assertionEnded(assertionStats);
+
+        // Only keep what writeAssertion writes: a long test makes a great many passing assertions.
+        if (!result.isOk() || result.getResultType() == ResultWas::ExplicitSkip || result.getResultType() == ResultWas::Warning) {
+            // AssertionResult points to a temporary expression: expand it now, while it still exists.
+            static_cast<void>(result.getExpandedExpression());
+            assert(!m_sectionStack.empty());
+            m_sectionStack.back()->assertionsAndBenchmarks.emplace_back(assertionStats);
+        }
+    }
+
+    void CTSReporter::benchmarkEnded(BenchmarkStats<> const& benchmarkStats)
+    {
+        assert(!m_sectionStack.empty());
+        m_sectionStack.back()->assertionsAndBenchmarks.emplace_back(benchmarkStats);
     }
 
     void CTSReporter::testCaseEnded(TestCaseStats const& testCaseStats)
     {
-        stdOutForSuite += testCaseStats.stdOut;
-        stdErrForSuite += testCaseStats.stdErr;
-        CumulativeReporterBase::testCaseEnded(testCaseStats);
+        auto node = Detail::make_unique<TestCaseNode>(testCaseStats);
+        assert(m_sectionStack.empty());
+        node->children.push_back(CATCH_MOVE(m_rootSection));
+        assert(m_deepestSection);
+        m_deepestSection->stdOut = testCaseStats.stdOut;
+        m_deepestSection->stdErr = testCaseStats.stdErr;
+        m_deepestSection = nullptr;
+
+        if (m_streaming) {
+            // The output is in the test case already: the suite-level copy is only kept for the end-of-run report.
+            writeTestCase(*node);
+            m_stream.flush();
+            m_sectionMetrics.clear();
+        }
+        else {
+            stdOutForSuite += testCaseStats.stdOut;
+            stdErrForSuite += testCaseStats.stdErr;
+            m_testCases.push_back(CATCH_MOVE(node));
+        }
     }
 
     void CTSReporter::testRunEndedCumulative()
     {
         const auto suiteTime = suiteTimer.getElapsedSeconds();
-        writeRun(*m_testRun, suiteTime);
-        xml.endElement();
+        TestRunStats const& stats = m_testRun->value;
+        if (m_streaming) {
+            Conformance::WriteConformanceReportSummary(xml, Conformance::GetGlobalData().GetConformanceReport());
+            {
+                XmlWriter::ScopedElement e = xml.scopedElement("cts:totals");
+                writeTotalsAttributes(stats, suiteTime);
+            }
+            xml.endElement();  // testsuite
+        }
+        else {
+            writeSuiteStart(static_cast<std::string>(stats.runInfo.name), &stats, suiteTime);
+            Conformance::WriteConformanceReportSummary(xml, Conformance::GetGlobalData().GetConformanceReport());
+
+            // Write test cases
+            for (auto const& testCase : m_testCases)
+                writeTestCase(*testCase);
+
+            xml.scopedElement("system-out").writeText(trim(stdOutForSuite), XmlFormatting::Newline);
+            xml.scopedElement("system-err").writeText(trim(stdErrForSuite), XmlFormatting::Newline);
+            xml.endElement();  // testsuite
+        }
+        xml.endElement();  // testsuites
     }
 
-    void CTSReporter::writeRun(TestRunNode const& testRunNode, double suiteTime)
+    void CTSReporter::writeSuiteStart(std::string const& runName, TestRunStats const* totals, double suiteTime)
     {
-        XmlWriter::ScopedElement e = xml.scopedElement("testsuite");
+        xml.startElement("testsuite");
 
-        TestRunStats const& stats = testRunNode.value;
-        xml.writeAttribute("name"_sr, stats.runInfo.name);
-        xml.writeAttribute("errors"_sr, unexpectedExceptions);
-        xml.writeAttribute("failures"_sr, stats.totals.assertions.failed - unexpectedExceptions);
-        xml.writeAttribute("skipped"_sr, stats.totals.assertions.skipped);
-        xml.writeAttribute("tests"_sr, stats.totals.assertions.total());
+        xml.writeAttribute("name"_sr, runName);
+        if (totals != nullptr) {
+            writeTotalsAttributes(*totals, suiteTime);
+        }
         xml.writeAttribute("hostname"_sr, "tbd"_sr);  // !TBD
-        if (m_config->showDurations() == ShowDurations::Never)
-            xml.writeAttribute("time"_sr, ""_sr);
-        else
-            xml.writeAttribute("time"_sr, formatDuration(suiteTime));
         xml.writeAttribute("timestamp"_sr, getCurrentTimestamp());
 
         // Write properties
@@ -173,14 +281,23 @@ namespace Catch
         // Output CTS-specific info
         Conformance::WriteTestEnvironment(xml, Conformance::GetGlobalData());
         Conformance::WriteActiveApiLayersAndExtensions(xml, Conformance::GetGlobalData());
-        Conformance::WriteConformanceReportSummary(xml, Conformance::GetGlobalData().GetConformanceReport());
 
-        // Write test cases
-        for (auto const& child : testRunNode.children)
-            writeTestCase(*child);
+        // Test cases that crashed the run this one resumes from: see Options::checkpointFile.
+        for (auto const& testCaseName : Conformance::GetGlobalData().checkpoint.GetNewlyCrashedTestCases())
+            writeCrashedTestCase(testCaseName);
+    }
 
-        xml.scopedElement("system-out").writeText(trim(stdOutForSuite), XmlFormatting::Newline);
-        xml.scopedElement("system-err").writeText(trim(stdErrForSuite), XmlFormatting::Newline);
+    void CTSReporter::writeTotalsAttributes(TestRunStats const& stats, double suiteTime)
+    {
+        const auto crashedTestCases = Conformance::GetGlobalData().checkpoint.GetNewlyCrashedTestCases().size();
+        xml.writeAttribute("errors"_sr, unexpectedExceptions + crashedTestCases);
+        xml.writeAttribute("failures"_sr, stats.totals.assertions.failed - unexpectedExceptions);
+        xml.writeAttribute("skipped"_sr, stats.totals.assertions.skipped);
+        xml.writeAttribute("tests"_sr, stats.totals.assertions.total() + crashedTestCases);
+        if (m_config->showDurations() == ShowDurations::Never)
+            xml.writeAttribute("time"_sr, ""_sr);
+        else
+            xml.writeAttribute("time"_sr, formatDuration(suiteTime));
     }
 
     void CTSReporter::writeTestCase(TestCaseNode const& testCaseNode)
@@ -192,10 +309,31 @@ namespace Catch
         assert(testCaseNode.children.size() == 1);
         SectionNode const& rootSection = *testCaseNode.children.front();
 
-        std::string className = static_cast<std::string>(stats.testInfo->className);
+        writeSection(getClassName(stats.testInfo), "", rootSection, stats.testInfo->okToFail());
+    }
+
+    void CTSReporter::writeCrashedTestCase(std::string const& testCaseName)
+    {
+        auto const& testCases = getAllTestCasesSorted(*m_config);
+        auto it = std::find_if(testCases.begin(), testCases.end(),
+                               [&](TestCaseHandle const& testCase) { return testCase.getTestCaseInfo().name == testCaseName; });
+
+        XmlWriter::ScopedElement e = xml.scopedElement("testcase");
+        xml.writeAttribute("classname"_sr, getClassName(it == testCases.end() ? nullptr : &it->getTestCaseInfo()));
+        xml.writeAttribute("name"_sr, testCaseName);
+        xml.writeAttribute("time"_sr, ""_sr);
+        xml.writeAttribute("status"_sr, "run"_sr);
+        xml.scopedElement("error")
+            .writeAttribute("message"_sr, "Test case did not finish: the test process crashed or was killed."_sr)
+            .writeAttribute("type"_sr, "crash"_sr);
+    }
+
+    std::string CTSReporter::getClassName(TestCaseInfo const* testInfo) const
+    {
+        std::string className = testInfo == nullptr ? std::string() : static_cast<std::string>(testInfo->className);
 
         if (className.empty()) {
-            className = fileNameTag(stats.testInfo->tags);
+            className = testInfo == nullptr ? std::string() : fileNameTag(testInfo->tags);
             if (className.empty()) {
                 className = "global";
             }
@@ -205,8 +343,7 @@ namespace Catch
             className = static_cast<std::string>(m_config->name()) + '.' + className;
 
         normalizeNamespaceMarkers(className);
-
-        writeSection(className, "", rootSection, stats.testInfo->okToFail());
+        return className;
     }
 
     void CTSReporter::writeSection(std::string const& className, std::string const& rootName, SectionNode const& sectionNode,
@@ -216,7 +353,8 @@ namespace Catch
         if (!rootName.empty())
             name = rootName + '/' + name;
 
-        if (sectionNode.stats.assertions.total() > 0 || !sectionNode.stdOut.empty() || !sectionNode.stdErr.empty()) {
+        if (sectionNode.stats.assertions.total() > 0 || !sectionNode.assertionsAndBenchmarks.empty() || !sectionNode.stdOut.empty() ||
+            !sectionNode.stdErr.empty() || m_sectionMetrics.count(name) != 0) {
             XmlWriter::ScopedElement e = xml.scopedElement("testcase");
             if (className.empty()) {
                 xml.writeAttribute("classname"_sr, name);
@@ -238,6 +376,7 @@ namespace Catch
             }
 
             writeAssertions(sectionNode);
+            writeMetrics(name);
 
             if (!sectionNode.stdOut.empty())
                 xml.scopedElement("system-out").writeText(trim(sectionNode.stdOut), XmlFormatting::Newline);
@@ -257,6 +396,53 @@ namespace Catch
             if (assertionOrBenchmark.isAssertion()) {
                 writeAssertion(assertionOrBenchmark.asAssertion());
             }
+            else if (assertionOrBenchmark.isBenchmark()) {
+                writeBenchmark(assertionOrBenchmark.asBenchmark());
+            }
+        }
+    }
+
+    void CTSReporter::writeBenchmark(BenchmarkStats<> const& stats)
+    {
+        // Same statistics as the upstream XmlReporter writes, with the durations in nanoseconds.
+        XmlWriter::ScopedElement e = xml.scopedElement("cts:benchmark");
+        xml.writeAttribute("name"_sr, stats.info.name);
+        xml.writeAttribute("samples"_sr, stats.info.samples);
+        xml.writeAttribute("resamples"_sr, stats.info.resamples);
+        xml.writeAttribute("iterations"_sr, stats.info.iterations);
+        xml.writeAttribute("unit"_sr, "ns"_sr);
+        xml.scopedElement("cts:mean")
+            .writeAttribute("value"_sr, stats.mean.point.count())
+            .writeAttribute("lowerBound"_sr, stats.mean.lower_bound.count())
+            .writeAttribute("upperBound"_sr, stats.mean.upper_bound.count())
+            .writeAttribute("ci"_sr, stats.mean.confidence_interval);
+        xml.scopedElement("cts:standardDeviation")
+            .writeAttribute("value"_sr, stats.standardDeviation.point.count())
+            .writeAttribute("lowerBound"_sr, stats.standardDeviation.lower_bound.count())
+            .writeAttribute("upperBound"_sr, stats.standardDeviation.upper_bound.count())
+            .writeAttribute("ci"_sr, stats.standardDeviation.confidence_interval);
+        xml.scopedElement("cts:outliers")
+            .writeAttribute("variance"_sr, stats.outlierVariance)
+            .writeAttribute("lowMild"_sr, stats.outliers.low_mild)
+            .writeAttribute("lowSevere"_sr, stats.outliers.low_severe)
+            .writeAttribute("highMild"_sr, stats.outliers.high_mild)
+            .writeAttribute("highSevere"_sr, stats.outliers.high_severe);
+    }
+
+    void CTSReporter::writeMetrics(std::string const& sectionPath)
+    {
+        auto it = m_sectionMetrics.find(sectionPath);
+        if (it == m_sectionMetrics.end()) {
+            return;
+        }
+        for (auto const& metric : it->second) {
+            XmlWriter::ScopedElement e = xml.scopedElement("cts:metric");
+            xml.writeAttribute("name"_sr, metric.name);
+            xml.writeAttribute("value"_sr, metric.value);
+            xml.writeAttribute("unit"_sr, metric.unit);
+            for (auto const& tag : metric.tags) {
+                xml.scopedElement("cts:tag").writeAttribute("name"_sr, tag.name).writeAttribute("value"_sr, tag.value);
+            }
         }
     }
 
@@ -19,6 +19,12 @@ XRC_DISABLE_MSVC_WARNING(4324)
 #include <catch2/catch_timer.hpp>
 #include <catch2/interfaces/catch_interfaces_reporter_factory.hpp>
 
+#include "report.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
 namespace Catch
 {
 
@@ -37,21 +43,31 @@ namespace Catch
         void testRunStarting(TestRunInfo const& runInfo) override;
 
         void testCaseStarting(TestCaseInfo const& testCaseInfo) override;
+        void sectionStarting(SectionInfo const& sectionInfo) override;
+        void sectionEnded(SectionStats const& sectionStats) override;
         void assertionEnded(AssertionStats const& assertionStats) override;
+        void benchmarkEnded(BenchmarkStats<> const& benchmarkStats) override;
 
         void testCaseEnded(TestCaseStats const& testCaseStats) override;
 
         void testRunEndedCumulative() override;
 
     private:
-        void writeRun(TestRunNode const& testRunNode, double suiteTime);
+        /// Open the testsuite element and write everything known at the start of the run. Totals are only written if given.
+        void writeSuiteStart(std::string const& runName, TestRunStats const* totals, double suiteTime);
+        void writeTotalsAttributes(TestRunStats const& stats, double suiteTime);
 
         void writeTestCase(TestCaseNode const& testCaseNode);
+        void writeCrashedTestCase(std::string const& testCaseName);
+        std::string getClassName(TestCaseInfo const* testInfo) const;
 
         void writeSection(std::string const& className, std::string const& rootName, SectionNode const& sectionNode, bool testOkToFail);
 
         void writeAssertions(SectionNode const& sectionNode);
         void writeAssertion(AssertionStats const& stats);
+        /// Write the results of a Catch2 BENCHMARK, as a cts:benchmark element.
+        void writeBenchmark(BenchmarkStats<> const& stats);
+        void writeMetrics(std::string const& sectionPath);
 
         XmlWriter xml;
         Timer suiteTimer;
@@ -59,6 +75,21 @@ namespace Catch
         std::string stdErrForSuite;
         unsigned int unexpectedExceptions = 0;
         bool m_okToFail = false;
+        /// Write each test case as it ends instead of the whole report at the end of the run. See Options::streamReport.
+        bool m_streaming = false;
+
+        // The section tree of the running test case, built here rather than by CumulativeReporterBase so that it can be
+        // dropped once written, and so that only the assertions that get written are kept.
+        Detail::unique_ptr<SectionNode> m_rootSection;
+        SectionNode* m_deepestSection = nullptr;
+        std::vector<SectionNode*> m_sectionStack;
+        /// Completed test cases waiting to be written at the end of the run. Always empty when streaming.
+        std::vector<Detail::unique_ptr<TestCaseNode>> m_testCases;
+
+        /// Names of the currently running sections, outermost (the test case) first.
+        std::vector<std::string> m_sectionNames;
+        /// Metrics reported by tests, keyed by section path as written in the "name" of each testcase element.
+        std::map<std::string, std::vector<Conformance::Metric>> m_sectionMetrics;
     };
 
 }  // end namespace Catch
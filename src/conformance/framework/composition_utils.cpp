@@ -19,12 +19,17 @@
 #include "RGBAImage.h"
 #include "conformance_framework.h"
 #include "conformance_utils.h"
+#include "latency_probe.h"
+#include "perf_metrics_sampler.h"
+#include "report.h"
 #include "swapchain_image_data.h"
+#include "two_call_util.h"
 
 #include "common/xr_dependencies.h"
 #include "common/xr_linear.h"
 #include "utilities/event_reader.h"
 #include "utilities/throw_helpers.h"
+#include "utilities/trace.h"
 
 #include <catch2/catch_test_macros.hpp>
 #include <openxr/openxr.h>
@@ -33,8 +38,13 @@
 #include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cmath>
 #include <cstdint>
+#include <limits>
+#include <list>
+#include <mutex>
 #include <ratio>
+#include <string>
 #include <utility>
 
 using namespace std::chrono_literals;
@@ -55,6 +65,49 @@ namespace Conformance
         return image;
     }
 
+    std::shared_ptr<const RGBAImage> GetCachedTextImage(int32_t width, int32_t height, const char* text, int32_t fontHeight,
+                                                        WordWrap wordWrap)
+    {
+        struct CachedTextImage
+        {
+            std::string text;
+            int32_t width;
+            int32_t height;
+            int32_t fontHeight;
+            WordWrap wordWrap;
+            std::shared_ptr<const RGBAImage> image;
+        };
+        // Enough for the prompts of a few test cases; a description image alone is over 2 MB.
+        constexpr size_t MaxCachedTextImages = 32;
+        static std::mutex s_mutex;
+        // Most recently used first.
+        static std::list<CachedTextImage> s_cache;
+
+        std::lock_guard<std::mutex> lock(s_mutex);
+        for (auto it = s_cache.begin(); it != s_cache.end(); ++it) {
+            if (it->width == width && it->height == height && it->fontHeight == fontHeight && it->wordWrap == wordWrap &&
+                it->text == text) {
+                s_cache.splice(s_cache.begin(), s_cache, it);
+                return it->image;
+            }
+        }
+
+        auto image = std::make_shared<const RGBAImage>(CreateTextImage(width, height, text, fontHeight, wordWrap));
+        s_cache.push_front({text, width, height, fontHeight, wordWrap, image});
+        if (s_cache.size() > MaxCachedTextImages) {
+            s_cache.pop_back();
+        }
+        return image;
+    }
+
+    /// Whether a pooled swapchain created with @p a can be handed out for @p b. The `next` chains are not compared.
+    static bool IsSameSwapchainCreateInfo(const XrSwapchainCreateInfo& a, const XrSwapchainCreateInfo& b)
+    {
+        return a.createFlags == b.createFlags && a.usageFlags == b.usageFlags && a.format == b.format && a.sampleCount == b.sampleCount &&
+               a.width == b.width && a.height == b.height && a.faceCount == b.faceCount && a.arraySize == b.arraySize &&
+               a.mipCount == b.mipCount;
+    }
+
     XrPath StringToPath(XrInstance instance, const std::string& pathStr)
     {
         XrPath path;
@@ -67,6 +120,8 @@ namespace Conformance
 
     bool RenderLoop::IterateFrame()
     {
+        FrameAllocationTracker::Scope allocationScope(m_frameAllocations);
+
         XrFrameState frameState{XR_TYPE_FRAME_STATE};
         XrFrameWaitInfo waitInfo{XR_TYPE_FRAME_WAIT_INFO};
         XRC_CHECK_THROW_XRCMD(xrWaitFrame(m_session, &waitInfo, &frameState));
@@ -84,6 +139,9 @@ namespace Conformance
             while (IterateFrame()) {
             }
         }());
+
+        // Includes what the runtime allocates on this thread during the frame calls.
+        m_frameAllocations.Report();
     }
 
     XrTime RenderLoop::GetLastPredictedDisplayTime() const
@@ -180,6 +238,7 @@ namespace Conformance
 
     void CompositionHelper::SharedInit(const char* testName, bool skipOnUnsupportedViewType /* = false */)
     {
+        m_recycleSwapchains = GetGlobalData().GetOptions().recycleSwapchains;
 
         m_eventQueue = std::unique_ptr<EventQueue>(new EventQueue(m_instance));
         m_privateEventReader = std::unique_ptr<EventReader>(new EventReader(*m_eventQueue));
@@ -187,10 +246,7 @@ namespace Conformance
         XRC_CHECK_THROW_XRCMD(CreateBasicSession(m_instance, &m_systemId, &m_session));
 
         if (skipOnUnsupportedViewType) {
-            uint32_t viewCount = 0;
-            REQUIRE(XR_SUCCESS == xrEnumerateViewConfigurations(m_instance, m_systemId, 0, &viewCount, nullptr));
-            std::vector<XrViewConfigurationType> runtimeViewTypes(viewCount);
-            REQUIRE(XR_SUCCESS == xrEnumerateViewConfigurations(m_instance, m_systemId, viewCount, &viewCount, runtimeViewTypes.data()));
+            const std::vector<XrViewConfigurationType>& runtimeViewTypes = GetGlobalData().GetRuntimeCapabilities().viewConfigurationTypes;
             if (std::find(runtimeViewTypes.begin(), runtimeViewTypes.end(), m_primaryViewType) == runtimeViewTypes.end()) {
                 SKIP("View type not supported by runtime");
             }
@@ -202,14 +258,11 @@ namespace Conformance
         m_interactionManager = std::make_unique<InteractionManager>(m_instance, m_session);
 
         std::vector<int64_t> swapchainFormats;
-        {
-            uint32_t countOutput;
-            XRC_CHECK_THROW_XRCMD(xrEnumerateSwapchainFormats(m_session, 0, &countOutput, nullptr));
-            if (countOutput != 0) {
-                swapchainFormats.resize(countOutput);
-                XRC_CHECK_THROW_XRCMD(
-                    xrEnumerateSwapchainFormats(m_session, (uint32_t)swapchainFormats.size(), &countOutput, swapchainFormats.data()));
-            }
+        if (GetGlobalData().IsUsingGraphicsPlugin()) {
+            swapchainFormats = GetGlobalData().GetSwapchainFormats(m_session);
+        }
+        else {
+            XRC_CHECK_THROW_XRCMD(doTwoCallInPlace(swapchainFormats, xrEnumerateSwapchainFormats, m_session));
         }
 
         if (GetGlobalData().IsUsingGraphicsPlugin()) {
@@ -227,25 +280,43 @@ namespace Conformance
 
         {
             constexpr int TitleFontHeightPixels = 32;
-            RGBAImage image = CreateTextImage(512, 44, testName, TitleFontHeightPixels, WordWrap::Disabled);
+            constexpr int32_t TitleWidth = 512;
+            constexpr int32_t TitleHeight = 44;
 
             m_testNameQuad.layerFlags |= XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT;
             m_testNameQuad.size.width = 0.75f;
-            m_testNameQuad.size.height = m_testNameQuad.size.width * image.height / image.width;
+            m_testNameQuad.size.height = m_testNameQuad.size.width * TitleHeight / TitleWidth;
             m_testNameQuad.pose = XrPosef{{0, 0, 0, 1}, {0, 0.4f, -1}};
             m_testNameQuad.space = m_viewSpace;
-            m_testNameQuad.subImage = MakeDefaultSubImage(CreateStaticSwapchainImage(image));
+            m_testNameQuad.subImage = MakeDefaultSubImage(
+                CreateStaticSwapchainText(TitleWidth, TitleHeight, testName, TitleFontHeightPixels, WordWrap::Disabled));
         }
     }
 
     CompositionHelper::~CompositionHelper()
     {
+        if (m_perfMetricsSampler) {
+            m_perfMetricsSampler->Stop();
+        }
+        if (m_latencyProbe) {
+            m_latencyProbe->Report();
+        }
+        m_endFrameAllocations.Report();
+
         for (XrSpace space : m_spaces) {
             XRC_CHECK_THROW_XRCMD(xrDestroySpace(space));
         }
 
+        // Rendering to the swapchains may still be in flight on the GPU.
+        if (!m_createdSwapchains.empty() && GetGlobalData().IsUsingGraphicsPlugin()) {
+            GetGlobalData().graphicsPlugin->Flush();
+        }
+
         for (auto swapchain : m_createdSwapchains) {
             XRC_CHECK_THROW_XRCMD(xrDestroySwapchain(swapchain.first));
+            if (GetGlobalData().options.swapchainMemoryAudit) {
+                GetGlobalData().swapchainMemoryAudit.SwapchainDestroyed(swapchain.first);
+            }
         }
 
         xrDestroySession(m_session);
@@ -254,7 +325,7 @@ namespace Conformance
         if (globalData.IsUsingGraphicsPlugin()) {
             auto graphicsPlugin = globalData.GetGraphicsPlugin();
             if (graphicsPlugin->IsInitialized()) {
-                graphicsPlugin->ShutdownDevice();
+                globalData.ShutdownSessionGraphicsDevice();
             }
         }
     }
@@ -315,12 +386,20 @@ namespace Conformance
 
                 return false;
             },
-            15s, 10ms);
+            15s, *m_eventQueue);
         XRC_CHECK_THROW_MSG(result, "Failed to reach session ready state");
 
         XrSessionBeginInfo beginInfo{XR_TYPE_SESSION_BEGIN_INFO};
         beginInfo.primaryViewConfigurationType = m_primaryViewType;
         XRC_CHECK_THROW_XRCMD(xrBeginSession(m_session, &beginInfo));
+
+        const uint32_t perfMetricsSampleRate = GetGlobalData().GetOptions().perfMetricsSampleRate;
+        if (perfMetricsSampleRate != 0) {
+            m_perfMetricsSampler = std::make_unique<PerformanceMetricsSampler>(m_instance, m_session, perfMetricsSampleRate);
+        }
+        if (GetGlobalData().GetOptions().latencyProbe) {
+            m_latencyProbe = LatencyProbe::TryCreate(m_instance);
+        }
     }
 
     std::tuple<XrViewState, std::vector<XrView>> CompositionHelper::LocateViews(XrSpace space, XrTime displayTime)
@@ -332,21 +411,55 @@ namespace Conformance
         XrViewState viewState{XR_TYPE_VIEW_STATE};
         std::vector<XrView> views(m_projectionViewCount, {XR_TYPE_VIEW});
         uint32_t viewCount = m_projectionViewCount;
+        if (m_latencyProbe) {
+            m_latencyProbe->OnViewsLocated(displayTime);
+        }
         XRC_CHECK_THROW_XRCMD(xrLocateViews(m_session, &viewLocateInfo, &viewState, viewCount, &viewCount, views.data()));
 
         return std::make_tuple(viewState, std::move(views));
     }
 
-    void CompositionHelper::EndFrame(XrTime predictedDisplayTime, std::vector<XrCompositionLayerBaseHeader*> layers)
+    void CompositionHelper::LocateViews(XrSpace space, XrTime displayTime, LocatedViews& located)
     {
-        layers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader*>(&m_testNameQuad));
+        XRC_CHECK_THROW_MSG(m_projectionViewCount <= LocatedViews::MaxViewCount, "Too many views for LocatedViews");
+
+        XrViewLocateInfo viewLocateInfo{XR_TYPE_VIEW_LOCATE_INFO};
+        viewLocateInfo.displayTime = displayTime;
+        viewLocateInfo.space = space;
+        viewLocateInfo.viewConfigurationType = m_primaryViewType;
+        located.viewState = {XR_TYPE_VIEW_STATE};
+        located.views.fill({XR_TYPE_VIEW});
+        located.viewCount = m_projectionViewCount;
+        if (m_latencyProbe) {
+            m_latencyProbe->OnViewsLocated(displayTime);
+        }
+        XRC_CHECK_THROW_XRCMD(
+            xrLocateViews(m_session, &viewLocateInfo, &located.viewState, located.viewCount, &located.viewCount, located.views.data()));
+    }
+
+    void CompositionHelper::EndFrame(XrTime predictedDisplayTime, const std::vector<XrCompositionLayerBaseHeader*>& layers)
+    {
+        XRC_TRACE_SCOPE("CompositionHelper::EndFrame");
+        FrameAllocationTracker::Scope allocationScope(m_endFrameAllocations);
+        m_frameLayers.assign(layers.begin(), layers.end());
+        m_frameLayers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader*>(&m_testNameQuad));
 
         XrFrameEndInfo frameEndInfo{XR_TYPE_FRAME_END_INFO};
         frameEndInfo.environmentBlendMode = GetGlobalData().GetOptions().environmentBlendModeValue;
         frameEndInfo.displayTime = predictedDisplayTime;
-        frameEndInfo.layerCount = (uint32_t)layers.size();
-        frameEndInfo.layers = layers.data();
+        frameEndInfo.layerCount = (uint32_t)m_frameLayers.size();
+        frameEndInfo.layers = m_frameLayers.data();
+        if (m_latencyProbe) {
+            m_latencyProbe->OnFrameSubmitted(predictedDisplayTime);
+        }
         XRC_CHECK_THROW_XRCMD(xrEndFrame(m_session, &frameEndInfo));
+        m_frameArena.Reset();
+        if (m_perfMetricsSampler) {
+            m_perfMetricsSampler->OnFrameEnded(predictedDisplayTime);
+        }
+
+        // Wake anyone waiting on the event queue for something that depends on frames being submitted.
+        m_eventQueue->Notify();
     }
 
     EventQueue& CompositionHelper::GetEventQueue() const
@@ -372,31 +485,122 @@ namespace Conformance
         }
     }
 
-    void CompositionHelper::AcquireWaitReleaseImage(XrSwapchain swapchain,
-                                                    const std::function<void(const XrSwapchainImageBaseHeader*)>& doUpdate)
+    template <typename Call>
+    XrResult CompositionHelper::TimeSwapchainCall(std::vector<std::chrono::nanoseconds> SwapchainCallLatencies::*samples, Call&& call)
+    {
+        if (!m_swapchainCallTiming.load(std::memory_order_relaxed)) {
+            return call();
+        }
+        const auto start = std::chrono::steady_clock::now();
+        const XrResult result = call();
+        const std::chrono::nanoseconds latency = std::chrono::steady_clock::now() - start;
+
+        std::lock_guard<std::mutex> lock(m_swapchainCallLatencyMutex);
+        (m_swapchainCallLatencies.*samples).push_back(latency);
+        return result;
+    }
+
+    void CompositionHelper::SetSwapchainCallTiming(bool enabled)
+    {
+        m_swapchainCallTiming = enabled;
+    }
+
+    CompositionHelper::SwapchainCallLatencies CompositionHelper::TakeSwapchainCallLatencies()
+    {
+        std::lock_guard<std::mutex> lock(m_swapchainCallLatencyMutex);
+        SwapchainCallLatencies latencies = std::move(m_swapchainCallLatencies);
+        m_swapchainCallLatencies = {};
+        return latencies;
+    }
+
+    const XrSwapchainImageBaseHeader* CompositionHelper::AcquireAndWaitImage(XrSwapchain swapchain)
     {
         uint32_t colorImageIndex;
         XrSwapchainImageAcquireInfo acquireInfo{XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO};
-        XRC_CHECK_THROW_XRCMD(xrAcquireSwapchainImage(swapchain, &acquireInfo, &colorImageIndex));
+        XrResult result = TimeSwapchainCall(&SwapchainCallLatencies::acquire,
+                                            [&] { return xrAcquireSwapchainImage(swapchain, &acquireInfo, &colorImageIndex); });
+        XRC_CHECK_THROW_XRRESULT(result, "xrAcquireSwapchainImage");
 
         XrSwapchainImageWaitInfo waitInfo{XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO};
         waitInfo.timeout = XR_INFINITE_DURATION;  // Call can block waiting for image to become available for writing.
-        XRC_CHECK_THROW_XRCMD(xrWaitSwapchainImage(swapchain, &waitInfo));
+        result = TimeSwapchainCall(&SwapchainCallLatencies::wait, [&] { return xrWaitSwapchainImage(swapchain, &waitInfo); });
+        XRC_CHECK_THROW_XRRESULT(result, "xrWaitSwapchainImage");
 
-        m_swapchainImages[swapchain]->AcquireAndWaitDepthSwapchainImage(colorImageIndex);
+        ISwapchainImageData* swapchainImages = GetSwapchainImageData(swapchain);
+        swapchainImages->AcquireAndWaitDepthSwapchainImage(colorImageIndex);
+        return swapchainImages->GetGenericColorImage(colorImageIndex);
+    }
 
-        const XrSwapchainImageBaseHeader* image = nullptr;
+    void CompositionHelper::ReleaseImage(XrSwapchain swapchain)
+    {
+        XrSwapchainImageReleaseInfo releaseInfo{XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO};
+        const XrResult result =
+            TimeSwapchainCall(&SwapchainCallLatencies::release, [&] { return xrReleaseSwapchainImage(swapchain, &releaseInfo); });
+        XRC_CHECK_THROW_XRRESULT(result, "xrReleaseSwapchainImage");
+        GetSwapchainImageData(swapchain)->ReleaseDepthSwapchainImage();
+    }
 
-        {
-            std::unique_lock<std::mutex> lock(m_mutex);
-            image = m_swapchainImages[swapchain]->GetGenericColorImage(colorImageIndex);
-        }
+    ISwapchainImageData* CompositionHelper::GetSwapchainImageData(XrSwapchain swapchain)
+    {
+        // The image data itself is owned by the graphics plugin, so the pointer stays valid once the lock is dropped.
+        auto lock = ReadLockSwapchains();
+        auto it = m_swapchainImages.find(swapchain);
+        XRC_CHECK_THROW_MSG(it != m_swapchainImages.end(), "Not a tracked swapchain");
+        return it->second;
+    }
+
+    std::shared_lock<std::shared_timed_mutex> CompositionHelper::ReadLockSwapchains()
+    {
+        return LockAndCountWait<std::shared_lock<std::shared_timed_mutex>>(m_swapchainMutex, m_swapchainLockWaits);
+    }
+
+    std::unique_lock<std::shared_timed_mutex> CompositionHelper::WriteLockSwapchains()
+    {
+        return LockAndCountWait<std::unique_lock<std::shared_timed_mutex>>(m_swapchainMutex, m_swapchainLockWaits);
+    }
+
+    std::unique_lock<std::mutex> CompositionHelper::LockLayers()
+    {
+        return LockAndCountWait<std::unique_lock<std::mutex>>(m_layerMutex, m_layerLockWaits);
+    }
+
+    void CompositionHelper::ReportLockWaitMetrics() const
+    {
+        auto report = [](const char* lockName, const LockWaitStats& stats) {
+            const std::vector<MetricTag> tags{{"lock", lockName}};
+            ReportMetric("CompositionHelper.lockCount", double(stats.lockCount.load()), "count", tags);
+            ReportMetric("CompositionHelper.contendedLockCount", double(stats.contendedCount.load()), "count", tags);
+            ReportMetric("CompositionHelper.lockWaitTime", stats.waitNanoseconds.load() / 1e6, "ms", tags);
+        };
+        report("swapchains", m_swapchainLockWaits);
+        report("layers", m_layerLockWaits);
+    }
+
+    void CompositionHelper::AcquireWaitReleaseImage(XrSwapchain swapchain,
+                                                    FunctionRef<void(const XrSwapchainImageBaseHeader*)> doUpdate)
+    {
+        XRC_TRACE_SCOPE("CompositionHelper::AcquireWaitReleaseImage");
+        const XrSwapchainImageBaseHeader* image = AcquireAndWaitImage(swapchain);
 
         doUpdate(image);
 
-        XrSwapchainImageReleaseInfo releaseInfo{XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO};
-        XRC_CHECK_THROW_XRCMD(xrReleaseSwapchainImage(swapchain, &releaseInfo));
-        m_swapchainImages[swapchain]->ReleaseDepthSwapchainImage();
+        ReleaseImage(swapchain);
+    }
+
+    void CompositionHelper::AcquireWaitReleaseImages(
+        const std::vector<XrSwapchain>& swapchains,
+        FunctionRef<void(const std::vector<const XrSwapchainImageBaseHeader*>&)> doUpdate)
+    {
+        m_acquiredImages.clear();
+        for (XrSwapchain swapchain : swapchains) {
+            m_acquiredImages.push_back(AcquireAndWaitImage(swapchain));
+        }
+
+        doUpdate(m_acquiredImages);
+
+        for (XrSwapchain swapchain : swapchains) {
+            ReleaseImage(swapchain);
+        }
     }
 
     XrSpace CompositionHelper::CreateReferenceSpace(XrReferenceSpaceType type, XrPosef pose /*= Pose::Identity */)
@@ -407,7 +611,7 @@ namespace Conformance
         createInfo.referenceSpaceType = type;
         XRC_CHECK_THROW_XRCMD(xrCreateReferenceSpace(m_session, &createInfo, &space));
 
-        std::lock_guard<std::mutex> lock(m_mutex);
+        auto lock = LockLayers();
         m_spaces.push_back(space);
         return space;
     }
@@ -454,28 +658,73 @@ namespace Conformance
         return createInfo;
     }
 
+    namespace
+    {
+        /// Record the GPU memory of the @p imageCount images enumerated from @p swapchain, if Options::swapchainMemoryAudit is set.
+        void AuditSwapchainMemory(XrSwapchain swapchain, const XrSwapchainCreateInfo& createInfo, uint32_t imageCount,
+                                  FunctionRef<const XrSwapchainImageBaseHeader*(uint32_t)> getImage)
+        {
+            GlobalData& globalData = GetGlobalData();
+            if (!globalData.options.swapchainMemoryAudit) {
+                return;
+            }
+            uint64_t bytes = 0;
+            for (uint32_t i = 0; i < imageCount; ++i) {
+                bytes += globalData.graphicsPlugin->GetSwapchainImageMemorySize(getImage(i));
+            }
+            if (bytes != 0) {
+                const bool isStatic = (createInfo.createFlags & XR_SWAPCHAIN_CREATE_STATIC_IMAGE_BIT) != 0;
+                globalData.swapchainMemoryAudit.SwapchainCreated(swapchain, isStatic, bytes);
+            }
+        }
+    }  // namespace
+
     XrSwapchain CompositionHelper::CreateSwapchain(const XrSwapchainCreateInfo& createInfo)
     {
         if (!GetGlobalData().IsUsingGraphicsPlugin()) {
             return XR_NULL_HANDLE;
         }
 
-        XrSwapchain swapchain;
-        XRC_CHECK_THROW_XRCMD(xrCreateSwapchain(m_session, &createInfo, &swapchain));
+        const bool recyclable = createInfo.next == nullptr && (createInfo.createFlags & XR_SWAPCHAIN_CREATE_STATIC_IMAGE_BIT) == 0;
+        if (m_recycleSwapchains && recyclable) {
+            auto lock = WriteLockSwapchains();
+            auto pooled = std::find_if(m_recycledSwapchains.begin(), m_recycledSwapchains.end(), [&](XrSwapchain candidate) {
+                return IsSameSwapchainCreateInfo(m_createdSwapchains.at(candidate), createInfo);
+            });
+            if (pooled != m_recycledSwapchains.end()) {
+                // The enumerated images and their resources are still cached from the first time around.
+                const XrSwapchain swapchain = *pooled;
+                m_recycledSwapchains.erase(pooled);
+                m_swapchainRecyclingStats.recycledCount++;
+                return swapchain;
+            }
+        }
 
-        std::lock_guard<std::mutex> lock(m_mutex);
+        Stopwatch createTime(true);
 
-        // Cache the swapchain create info and image structs.
-        m_createdSwapchains.insert({swapchain, createInfo});
+        XrSwapchain swapchain;
+        XRC_CHECK_THROW_XRCMD(xrCreateSwapchain(m_session, &createInfo, &swapchain));
 
-        // Cache the swapchain image structs.
+        // Enumerate the swapchain image structs before locking: nobody else knows of this swapchain yet.
         uint32_t imageCount;
         XRC_CHECK_THROW_XRCMD(xrEnumerateSwapchainImages(swapchain, 0, &imageCount, nullptr));
 
         ISwapchainImageData* swapchainImages = GetGlobalData().graphicsPlugin->AllocateSwapchainImageData(imageCount, createInfo);
         XRC_CHECK_THROW_XRCMD(xrEnumerateSwapchainImages(swapchain, imageCount, &imageCount, swapchainImages->GetColorImageArray()));
+        AuditSwapchainMemory(swapchain, createInfo, imageCount, [&](uint32_t i) { return swapchainImages->GetGenericColorImage(i); });
+
+        auto lock = WriteLockSwapchains();
+
+        // Cache the swapchain create info and image structs.
+        m_createdSwapchains.insert({swapchain, createInfo});
+        if (recyclable) {
+            m_recyclableSwapchains.insert(swapchain);
+        }
         m_swapchainImages[swapchain] = swapchainImages;
 
+        m_swapchainRecyclingStats.createdCount++;
+        m_swapchainRecyclingStats.createDuration += createTime.Elapsed();
+
         return swapchain;
     }
 
@@ -492,13 +741,7 @@ namespace Conformance
         XrSwapchain depthSwapchain;
         XRC_CHECK_THROW_XRCMD(xrCreateSwapchain(m_session, &depthCreateInfo, &depthSwapchain));
 
-        std::lock_guard<std::mutex> lock(m_mutex);
-
-        // Cache the swapchain create info and image structs.
-        m_createdSwapchains.insert({swapchain, createInfo});
-        m_createdSwapchains.insert({depthSwapchain, depthCreateInfo});
-
-        // Cache the swapchain image structs.
+        // Enumerate the swapchain image structs before locking: nobody else knows of these swapchains yet.
         uint32_t imageCount;
         XRC_CHECK_THROW_XRCMD(xrEnumerateSwapchainImages(swapchain, 0, &imageCount, nullptr));
 
@@ -506,6 +749,15 @@ namespace Conformance
             imageCount, createInfo, depthSwapchain, depthCreateInfo);
         XRC_CHECK_THROW_XRCMD(xrEnumerateSwapchainImages(swapchain, imageCount, &imageCount, swapchainImages->GetColorImageArray()));
         XRC_CHECK_THROW_XRCMD(xrEnumerateSwapchainImages(depthSwapchain, imageCount, &imageCount, swapchainImages->GetDepthImageArray()));
+        AuditSwapchainMemory(swapchain, createInfo, imageCount, [&](uint32_t i) { return swapchainImages->GetGenericColorImage(i); });
+        AuditSwapchainMemory(depthSwapchain, depthCreateInfo, imageCount,
+                             [&](uint32_t i) { return swapchainImages->GetGenericDepthImage(i); });
+
+        auto lock = WriteLockSwapchains();
+
+        // Cache the swapchain create info and image structs.
+        m_createdSwapchains.insert({swapchain, createInfo});
+        m_createdSwapchains.insert({depthSwapchain, depthCreateInfo});
         m_swapchainImages[swapchain] = swapchainImages;
 
         return std::make_pair(swapchain, depthSwapchain);
@@ -513,26 +765,131 @@ namespace Conformance
 
     void CompositionHelper::DestroySwapchain(XrSwapchain swapchain)
     {
+        {
+            auto lock = WriteLockSwapchains();
+            auto solidColor = std::find_if(m_solidColorSwapchains.begin(), m_solidColorSwapchains.end(),
+                                           [&](const SolidColorSwapchain& cached) { return cached.swapchain == swapchain; });
+            if (solidColor != m_solidColorSwapchains.end()) {
+                if (--solidColor->useCount != 0) {
+                    // Still shown by another layer.
+                    return;
+                }
+                m_solidColorSwapchains.erase(solidColor);
+            }
+            auto text = std::find_if(m_textSwapchains.begin(), m_textSwapchains.end(),
+                                     [&](const TextSwapchain& cached) { return cached.swapchain == swapchain; });
+            if (text != m_textSwapchains.end()) {
+                if (--text->useCount != 0) {
+                    // Still shown by another layer.
+                    return;
+                }
+                m_textSwapchains.erase(text);
+            }
+        }
+
+        if (m_recycleSwapchains) {
+            auto lock = WriteLockSwapchains();
+            if (m_recyclableSwapchains.count(swapchain) != 0) {
+                // Rendering to it may still be in flight, but the runtime orders that before the next acquire.
+                XRC_CHECK_THROW_MSG(std::find(m_recycledSwapchains.begin(), m_recycledSwapchains.end(), swapchain) ==
+                                        m_recycledSwapchains.end(),
+                                    "Swapchain destroyed twice");
+                m_recycledSwapchains.push_back(swapchain);
+                return;
+            }
+        }
+
+        // Rendering to the swapchain may still be in flight on the GPU.
+        if (GetGlobalData().IsUsingGraphicsPlugin()) {
+            GetGlobalData().graphicsPlugin->Flush();
+        }
+
         // Drop all associated resources.
-        auto it = m_swapchainImages.find(swapchain);
-        if (it != m_swapchainImages.end())
-            it->second->Reset();
+        ISwapchainImageData* swapchainImages = nullptr;
+        {
+            auto lock = ReadLockSwapchains();
+            auto it = m_swapchainImages.find(swapchain);
+            if (it != m_swapchainImages.end())
+                swapchainImages = it->second;
+        }
+        if (swapchainImages != nullptr)
+            swapchainImages->Reset();
 
         XRC_CHECK_THROW_XRCMD(xrDestroySwapchain(swapchain));
+        if (GetGlobalData().options.swapchainMemoryAudit) {
+            GetGlobalData().swapchainMemoryAudit.SwapchainDestroyed(swapchain);
+        }
 
-        std::lock_guard<std::mutex> lock(m_mutex);
+        auto lock = WriteLockSwapchains();
         XRC_CHECK_THROW(1 == m_createdSwapchains.erase(swapchain));
-        if (it != m_swapchainImages.end())
+        m_recyclableSwapchains.erase(swapchain);
+        if (swapchainImages != nullptr)
             XRC_CHECK_THROW(1 == m_swapchainImages.erase(swapchain));
     }
 
-    XrSwapchain CompositionHelper::CreateStaticSwapchainSolidColor(const XrColor4f& color)
+    void CompositionHelper::SetSwapchainRecycling(bool enabled)
+    {
+        m_recycleSwapchains = enabled;
+        if (!enabled) {
+            std::vector<XrSwapchain> pooled;
+            {
+                auto lock = WriteLockSwapchains();
+                pooled.swap(m_recycledSwapchains);
+            }
+            for (XrSwapchain swapchain : pooled) {
+                DestroySwapchain(swapchain);
+            }
+        }
+    }
+
+    XrSwapchain CompositionHelper::CreateStaticSwapchainSolidColor(const XrColor4f& color, uint32_t width /*= 256*/,
+                                                                   uint32_t height /*= 256*/)
+    {
+        if (!GetGlobalData().IsUsingGraphicsPlugin()) {
+            return XR_NULL_HANDLE;
+        }
+
+        {
+            auto lock = WriteLockSwapchains();
+            for (SolidColorSwapchain& cached : m_solidColorSwapchains) {
+                if (cached.width == width && cached.height == height && cached.color.r == color.r && cached.color.g == color.g &&
+                    cached.color.b == color.b && cached.color.a == color.a) {
+                    cached.useCount++;
+                    return cached.swapchain;
+                }
+            }
+        }
+
+        // Avoid using a 1x1 image by default since runtimes may do special processing near texture edges.
+        // Clearing an SRGB image converts the linear color just as RGBAImage::ConvertToSRGB would have before a copy.
+        const int64_t format = GetGlobalData().graphicsPlugin->GetSRGBA8Format();
+        const XrSwapchain swapchain =
+            CreateSwapchain(DefaultColorSwapchainCreateInfo(width, height, XR_SWAPCHAIN_CREATE_STATIC_IMAGE_BIT, format));
+
+        AcquireWaitReleaseImage(swapchain, [&](const XrSwapchainImageBaseHeader* swapchainImage) {
+            GetGlobalData().graphicsPlugin->ClearImageSlice(swapchainImage, 0, color);
+        });
+
+        auto lock = WriteLockSwapchains();
+        m_solidColorSwapchains.push_back({color, width, height, swapchain, 1});
+        return swapchain;
+    }
+
+    XrSwapchain CompositionHelper::CreateStaticSwapchainProcedural(const ProceduralFill& fill, uint32_t width, uint32_t height,
+                                                                   int64_t format)
     {
-        // Avoid using a 1x1 image here since runtimes may do special processing near texture edges.
-        RGBAImage image(256, 256);
-        image.DrawRect(0, 0, 256, 256, color);
+        if (!GetGlobalData().IsUsingGraphicsPlugin()) {
+            return XR_NULL_HANDLE;
+        }
+
+        const XrSwapchain swapchain =
+            CreateSwapchain(DefaultColorSwapchainCreateInfo(width, height, XR_SWAPCHAIN_CREATE_STATIC_IMAGE_BIT, format));
+
+        AcquireWaitReleaseImage(swapchain, [&](const XrSwapchainImageBaseHeader* swapchainImage) {
+            GetGlobalData().graphicsPlugin->FillImageSlice(swapchainImage, 0, width, height, fill);
+        });
 
-        return CreateStaticSwapchainImage(image);
+        return swapchain;
     }
 
     XrSwapchain CompositionHelper::CreateStaticSwapchainImage(const RGBAImage& rgbaImage)
@@ -558,9 +915,34 @@ namespace Conformance
         return swapchain;
     }
 
+    XrSwapchain CompositionHelper::CreateStaticSwapchainText(int32_t width, int32_t height, const char* text, int32_t fontHeight,
+                                                             WordWrap wordWrap)
+    {
+        if (!GetGlobalData().IsUsingGraphicsPlugin()) {
+            return XR_NULL_HANDLE;
+        }
+
+        {
+            auto lock = WriteLockSwapchains();
+            for (TextSwapchain& cached : m_textSwapchains) {
+                if (cached.width == width && cached.height == height && cached.fontHeight == fontHeight && cached.wordWrap == wordWrap &&
+                    cached.text == text) {
+                    cached.useCount++;
+                    return cached.swapchain;
+                }
+            }
+        }
+
+        const XrSwapchain swapchain = CreateStaticSwapchainImage(*GetCachedTextImage(width, height, text, fontHeight, wordWrap));
+
+        auto lock = WriteLockSwapchains();
+        m_textSwapchains.push_back({text, width, height, fontHeight, wordWrap, swapchain, 1});
+        return swapchain;
+    }
+
     XrSwapchainSubImage CompositionHelper::MakeDefaultSubImage(XrSwapchain swapchain, uint32_t imageArrayIndex /*= 0*/)
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
+        auto lock = ReadLockSwapchains();
 
         XrSwapchainSubImage subImage;
         subImage.swapchain = swapchain;
@@ -584,14 +966,14 @@ namespace Conformance
         quad.subImage = MakeDefaultSubImage(swapchain);
         quad.size = {width, width * quad.subImage.imageRect.extent.height / quad.subImage.imageRect.extent.width};
 
-        std::lock_guard<std::mutex> lock(m_mutex);
+        auto lock = LockLayers();
         m_quads.push_back(quad);
         return &m_quads.back();
     }
 
     XrCompositionLayerProjection* CompositionHelper::CreateProjectionLayer(XrSpace space)
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
+        auto lock = LockLayers();
 
         // Allocate projection views and store.
         XRC_CHECK_THROW_MSG(m_projectionViewCount > 0, "m_projectionViewCount empty");
@@ -611,6 +993,110 @@ namespace Conformance
         return &m_projections.back();
     }
 
+    XrCompositionLayerQuad* CompositionHelper::CreateFrameQuadLayer(XrSwapchain swapchain, XrSpace space, float width,
+                                                                    XrPosef pose /*= Pose::Identity */)
+    {
+        XrCompositionLayerQuad quad{XR_TYPE_COMPOSITION_LAYER_QUAD};
+        quad.eyeVisibility = XR_EYE_VISIBILITY_BOTH;
+        quad.pose = pose;
+        quad.space = space;
+        quad.subImage = MakeDefaultSubImage(swapchain);
+        quad.size = {width, width * quad.subImage.imageRect.extent.height / quad.subImage.imageRect.extent.width};
+
+        return m_frameArena.New(quad);
+    }
+
+    XrCompositionLayerProjection* CompositionHelper::CreateFrameProjectionLayer(XrSpace space)
+    {
+        XRC_CHECK_THROW_MSG(m_projectionViewCount > 0, "m_projectionViewCount empty");
+        XrCompositionLayerProjectionView init{XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW};
+        // Make sure the pose is valid
+        init.pose.orientation.w = 1.0f;
+
+        XrCompositionLayerProjection projection{XR_TYPE_COMPOSITION_LAYER_PROJECTION};
+        projection.space = space;
+        projection.viewCount = m_projectionViewCount;
+        projection.views = m_frameArena.NewArray(m_projectionViewCount, init);
+
+        return m_frameArena.New(projection);
+    }
+
+    namespace
+    {
+        constexpr int32_t DynamicTextBorderPixels = 2;
+        constexpr int32_t DynamicTextInsetPixels = DynamicTextBorderPixels + 2;
+        constexpr XrColor4f DynamicTextBackgroundColor{0.25f, 0.25f, 0.25f, 0.25f};
+    }  // namespace
+
+    DynamicTextQuad::DynamicTextQuad(CompositionHelper& compositionHelper, int32_t width, int32_t height, int32_t fontHeight,
+                                     XrSpace space, float quadWidth, XrPosef pose)
+        : m_compositionHelper(compositionHelper), m_fontHeight(fontHeight), m_image(width, height)
+    {
+        m_image.DrawRect(0, 0, width, height, DynamicTextBackgroundColor);
+        m_image.DrawRectBorder(0, 0, width, height, DynamicTextBorderPixels, {0.5f, 0.5f, 0.5f, 1});
+
+        m_layer.eyeVisibility = XR_EYE_VISIBILITY_BOTH;
+        m_layer.space = space;
+        m_layer.pose = pose;
+        m_layer.size = {quadWidth, quadWidth * static_cast<float>(height) / static_cast<float>(width)};
+    }
+
+    DynamicTextQuad::~DynamicTextQuad()
+    {
+        if (m_layer.subImage.swapchain != XR_NULL_HANDLE) {
+            m_compositionHelper.DestroySwapchain(m_layer.subImage.swapchain);
+        }
+    }
+
+    void DynamicTextQuad::SetText(const std::string& text)
+    {
+        if (text == m_text) {
+            return;
+        }
+
+        // Only the old glyphs need clearing: the rest of the text area still holds the panel background.
+        m_image.DrawRect(m_textBounds.offset.x, m_textBounds.offset.y, m_textBounds.extent.width, m_textBounds.extent.height,
+                         DynamicTextBackgroundColor);
+        m_textBounds = {};
+        if (!text.empty()) {
+            const XrRect2Di textRect{{DynamicTextInsetPixels, DynamicTextInsetPixels},
+                                     {m_image.width - DynamicTextInsetPixels * 2, m_image.height - DynamicTextInsetPixels * 2}};
+            m_textBounds = m_image.PutText(textRect, text.c_str(), m_fontHeight, {1, 1, 1, 1});
+        }
+
+        m_text = text;
+        m_imageChanged = true;
+    }
+
+    XrCompositionLayerQuad* DynamicTextQuad::GetLayer()
+    {
+        GlobalData& globalData = GetGlobalData();
+        if (m_text.empty() || !globalData.IsUsingGraphicsPlugin()) {
+            return nullptr;
+        }
+
+        if (m_layer.subImage.swapchain == XR_NULL_HANDLE) {
+            // The swapchain format must be R8G8B8A8 UNORM to match the RGBAImage format.
+            const int64_t format = globalData.graphicsPlugin->GetSRGBA8Format();
+            auto swapchainCreateInfo = m_compositionHelper.DefaultColorSwapchainCreateInfo(m_image.width, m_image.height, 0, format);
+            swapchainCreateInfo.usageFlags |= XR_SWAPCHAIN_USAGE_TRANSFER_DST_BIT;
+            m_layer.subImage = m_compositionHelper.MakeDefaultSubImage(m_compositionHelper.CreateSwapchain(swapchainCreateInfo));
+            m_imageChanged = true;
+        }
+
+        if (m_imageChanged) {
+            // The other images of the swapchain hold older text, so the next one gets the whole image.
+            RGBAImage srgbImage = m_image;
+            srgbImage.ConvertToSRGB();
+            m_compositionHelper.AcquireWaitReleaseImage(m_layer.subImage.swapchain, [&](const XrSwapchainImageBaseHeader* swapchainImage) {
+                globalData.graphicsPlugin->CopyRGBAImage(swapchainImage, 0, srgbImage);
+            });
+            m_imageChanged = false;
+        }
+
+        return &m_layer;
+    }
+
     BaseProjectionLayerHelper::BaseProjectionLayerHelper(CompositionHelper& compositionHelper, XrReferenceSpaceType spaceType)
         : m_compositionHelper(compositionHelper), m_localSpace(compositionHelper.CreateReferenceSpace(spaceType, Pose::Identity))
     {
@@ -622,30 +1108,140 @@ namespace Conformance
                 viewProperties[j].recommendedImageRectWidth, viewProperties[j].recommendedImageRectHeight));
             const_cast<XrSwapchainSubImage&>(m_projLayer->views[j].subImage) = compositionHelper.MakeDefaultSubImage(swapchain, 0);
             m_swapchains.push_back(swapchain);
+            m_swapchainExtents.push_back(m_projLayer->views[j].subImage.imageRect.extent);
         }
     }
 
     // out of line to provide key function
     BaseProjectionLayerHelper::ViewRenderer::~ViewRenderer() = default;
 
+    bool SimpleProjectionLayerHelper::EnableVisibilityMaskPrePass(XrColor4f color)
+    {
+        auto xrGetVisibilityMaskKHR_ =
+            GetInstanceExtensionFunction<PFN_xrGetVisibilityMaskKHR>(m_compositionHelper.GetInstance(), "xrGetVisibilityMaskKHR");
+        const XrSession session = m_compositionHelper.GetSession();
+        const XrViewConfigurationType viewConfigurationType = GetGlobalData().options.viewConfigurationValue;
+
+        std::vector<MeshHandle> masks;
+        for (uint32_t viewIndex = 0; viewIndex < m_baseHelper.GetViewCount(); ++viewIndex) {
+            XrVisibilityMaskKHR visibilityMask{XR_TYPE_VISIBILITY_MASK_KHR};
+            XRC_CHECK_THROW_XRCMD(xrGetVisibilityMaskKHR_(session, viewConfigurationType, viewIndex,
+                                                          XR_VISIBILITY_MASK_TYPE_HIDDEN_TRIANGLE_MESH_KHR, &visibilityMask));
+            if (visibilityMask.indexCountOutput == 0) {
+                m_visibilityMasks.clear();
+                return false;
+            }
+            XRC_CHECK_THROW_MSG(visibilityMask.vertexCountOutput <= std::numeric_limits<uint16_t>::max() + 1u,
+                                "Visibility mask has too many vertices for a simple mesh");
+
+            std::vector<XrVector2f> vertices(visibilityMask.vertexCountOutput);
+            std::vector<uint32_t> indices(visibilityMask.indexCountOutput);
+            visibilityMask.vertexCapacityInput = (uint32_t)vertices.size();
+            visibilityMask.vertices = vertices.data();
+            visibilityMask.indexCapacityInput = (uint32_t)indices.size();
+            visibilityMask.indices = indices.data();
+            XRC_CHECK_THROW_XRCMD(xrGetVisibilityMaskKHR_(session, viewConfigurationType, viewIndex,
+                                                          XR_VISIBILITY_MASK_TYPE_HIDDEN_TRIANGLE_MESH_KHR, &visibilityMask));
+
+            // The mask triangles are counter-clockwise, so reverse them to face the viewer like the other meshes.
+            std::vector<uint16_t> meshIndices;
+            meshIndices.reserve(visibilityMask.indexCountOutput);
+            for (uint32_t i = 0; i + 2 < visibilityMask.indexCountOutput; i += 3) {
+                meshIndices.push_back(static_cast<uint16_t>(indices[i]));
+                meshIndices.push_back(static_cast<uint16_t>(indices[i + 2]));
+                meshIndices.push_back(static_cast<uint16_t>(indices[i + 1]));
+            }
+            std::vector<Geometry::Vertex> meshVertices;
+            meshVertices.reserve(visibilityMask.vertexCountOutput);
+            for (uint32_t i = 0; i < visibilityMask.vertexCountOutput; ++i) {
+                meshVertices.push_back({{vertices[i].x, vertices[i].y, -1.0f}, {1.0f, 1.0f, 1.0f}});
+            }
+            masks.push_back(GetGlobalData().graphicsPlugin->MakeSimpleMesh(meshIndices, meshVertices));
+        }
+
+        m_visibilityMasks = std::move(masks);
+        m_visibilityMaskColor = color;
+        return true;
+    }
+
+    void BaseProjectionLayerHelper::RenderView(const LocatedViews& locatedViews, uint32_t viewIndex,
+                                               const XrSwapchainImageBaseHeader* swapchainImage, ViewRenderer& renderer)
+    {
+        auto& projectionView = const_cast<XrCompositionLayerProjectionView&>(m_projLayer->views[viewIndex]);
+        const XrView& view = locatedViews.views[viewIndex];
+        projectionView.fov = view.fov;
+        projectionView.pose = view.pose;
+        projectionView.subImage.imageRect = m_dynamicResolution ? m_dynamicResolution->GetImageRect(m_swapchainExtents[viewIndex])
+                                                                : XrRect2Di{{0, 0}, m_swapchainExtents[viewIndex]};
+        renderer.RenderView(*this, viewIndex, locatedViews.viewState, view, projectionView, swapchainImage);
+    }
+
+    bool BaseProjectionLayerHelper::RelocateViews(XrTime displayTime, std::chrono::steady_clock::time_point earlyLocateEnd)
+    {
+        using Clock = std::chrono::steady_clock;
+        const Clock::time_point start = Clock::now();
+        m_compositionHelper.LocateViews(m_localSpace, displayTime, m_lateLocatedViews);
+        const Clock::time_point end = Clock::now();
+
+        const XrViewStateFlags flags = m_lateLocatedViews.viewState.viewStateFlags;
+        if ((flags & XR_VIEW_STATE_POSITION_VALID_BIT) == 0 || (flags & XR_VIEW_STATE_ORIENTATION_VALID_BIT) == 0) {
+            return false;
+        }
+
+        double positionDelta = 0;
+        double angleDelta = 0;
+        for (uint32_t viewIndex = 0; viewIndex < GetViewCount(); viewIndex++) {
+            const XrPosef& early = m_locatedViews.views[viewIndex].pose;
+            const XrPosef& late = m_lateLocatedViews.views[viewIndex].pose;
+            XrVector3f offset;
+            XrVector3f_Sub(&offset, &late.position, &early.position);
+            positionDelta = std::max(positionDelta, (double)XrVector3f_Length(&offset));
+
+            const XrQuaternionf& a = early.orientation;
+            const XrQuaternionf& b = late.orientation;
+            const double dot = std::min(1.0, std::abs((double)a.x * b.x + (double)a.y * b.y + (double)a.z * b.z + (double)a.w * b.w));
+            angleDelta = std::max(angleDelta, 2 * std::acos(dot));
+        }
+
+        LateLatchStats& stats = m_lateLatchStats;
+        stats.frameCount++;
+        stats.positionDeltaSum += positionDelta;
+        stats.positionDeltaMax = std::max(stats.positionDeltaMax, positionDelta);
+        stats.angleDeltaSum += angleDelta;
+        stats.angleDeltaMax = std::max(stats.angleDeltaMax, angleDelta);
+        stats.latchIntervalSum += end - earlyLocateEnd;
+        stats.relocateTimeSum += end - start;
+        stats.relocateTimeMax = std::max<std::chrono::nanoseconds>(stats.relocateTimeMax, end - start);
+        return true;
+    }
+
     XrCompositionLayerBaseHeader* BaseProjectionLayerHelper::TryGetUpdatedProjectionLayer(const XrFrameState& frameState,
                                                                                           ViewRenderer& renderer)
     {
-        auto viewData = m_compositionHelper.LocateViews(m_localSpace, frameState.predictedDisplayTime);
-        const auto& viewState = std::get<XrViewState>(viewData);
+        m_displayPeriod = frameState.predictedDisplayPeriod;
+        m_compositionHelper.LocateViews(m_localSpace, frameState.predictedDisplayTime, m_locatedViews);
+        const std::chrono::steady_clock::time_point earlyLocateEnd = std::chrono::steady_clock::now();
+        const auto& viewState = m_locatedViews.viewState;
 
         if (viewState.viewStateFlags & XR_VIEW_STATE_POSITION_VALID_BIT && viewState.viewStateFlags & XR_VIEW_STATE_ORIENTATION_VALID_BIT) {
-            const auto& views = std::get<std::vector<XrView>>(viewData);
-
-            // Render into each view swapchain using the recommended view fov and pose.
-            for (uint32_t viewIndex = 0; viewIndex < GetViewCount(); viewIndex++) {
-                m_compositionHelper.AcquireWaitReleaseImage(m_swapchains[viewIndex], [&](const XrSwapchainImageBaseHeader* swapchainImage) {
-                    auto& projectionView = const_cast<XrCompositionLayerProjectionView&>(m_projLayer->views[viewIndex]);
-                    auto& view = views[viewIndex];
-                    projectionView.fov = view.fov;
-                    projectionView.pose = view.pose;
-                    renderer.RenderView(*this, viewIndex, viewState, view, projectionView, swapchainImage);
-                });
+            if (m_lateLatching) {
+                // Wait for every image first, so that the late call is made after whatever the compositor held us up for.
+                m_compositionHelper.AcquireWaitReleaseImages(
+                    m_swapchains, [&](const std::vector<const XrSwapchainImageBaseHeader*>& images) {
+                        const bool lateValid = RelocateViews(frameState.predictedDisplayTime, earlyLocateEnd);
+                        const LocatedViews& locatedViews = lateValid ? m_lateLocatedViews : m_locatedViews;
+                        for (uint32_t viewIndex = 0; viewIndex < GetViewCount(); viewIndex++) {
+                            RenderView(locatedViews, viewIndex, images[viewIndex], renderer);
+                        }
+                    });
+            }
+            else {
+                // Render into each view swapchain using the recommended view fov and pose.
+                for (uint32_t viewIndex = 0; viewIndex < GetViewCount(); viewIndex++) {
+                    m_compositionHelper.AcquireWaitReleaseImage(m_swapchains[viewIndex], [&](const XrSwapchainImageBaseHeader* swapchainImage) {
+                        RenderView(m_locatedViews, viewIndex, swapchainImage, renderer);
+                    });
+                }
             }
 
             return reinterpret_cast<XrCompositionLayerBaseHeader*>(m_projLayer);
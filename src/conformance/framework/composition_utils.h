@@ -18,11 +18,17 @@
 
 #include "RGBAImage.h"
 #include "utilities/colors.h"
+#include "utilities/frame_arena.h"
+#include "utilities/lock_wait_stats.h"
+#include "utilities/function_ref.h"
 #include "common/xr_linear.h"
 #include "utilities/xr_math_operators.h"
 #include "conformance_framework.h"
 #include "conformance_utils.h"
+#include "dynamic_resolution.h"
+#include "frame_allocation_tracker.h"
 #include "graphics_plugin.h"
+#include "procedural_fill.h"
 #include "utilities/throw_helpers.h"
 #include "utilities/types_and_constants.h"
 
@@ -31,6 +37,7 @@
 
 #include <array>
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <cstring>
 #include <functional>
@@ -39,6 +46,8 @@
 #include <map>
 #include <memory>
 #include <mutex>
+#include <set>
+#include <shared_mutex>
 #include <tuple>
 #include <type_traits>
 #include <vector>
@@ -48,9 +57,16 @@ namespace Conformance
     class EventQueue;
     class EventReader;
     class ISwapchainImageData;
+    class LatencyProbe;
+    class PerformanceMetricsSampler;
 
     RGBAImage CreateTextImage(int32_t width, int32_t height, const char* text, int32_t fontHeight, WordWrap wordWrap = WordWrap::Enabled);
 
+    /// Like @ref CreateTextImage, but shared through a process-wide cache keyed by all of the arguments, so that a prompt
+    /// shown again by a later subtest or test case is not rasterized again. Only the most recently used images are kept.
+    std::shared_ptr<const RGBAImage> GetCachedTextImage(int32_t width, int32_t height, const char* text, int32_t fontHeight,
+                                                        WordWrap wordWrap = WordWrap::Enabled);
+
     XrPath StringToPath(XrInstance instance, const std::string& pathStr);
 
     using UpdateLayers = std::function<void(const XrFrameState&)>;
@@ -71,14 +87,24 @@ namespace Conformance
 
         /// Call @ref IterateFrame repeatedly until your @ref EndFrame returns false,
         /// checking that no exceptions are thrown
+        ///
+        /// In builds that count allocations, also reports the heap allocations per frame as metrics.
         void Loop();
 
         XrTime GetLastPredictedDisplayTime() const;
 
+        /// Counts the heap allocations of each @ref IterateFrame, reported by @ref Loop. Declare a budget with
+        /// FrameAllocationTracker::SetBudget.
+        FrameAllocationTracker& GetFrameAllocationTracker()
+        {
+            return m_frameAllocations;
+        }
+
     private:
         XrSession m_session;
         EndFrame m_endFrame;
         std::atomic<XrTime> m_lastPredictedDisplayTime;
+        FrameAllocationTracker m_frameAllocations{"RenderLoop"};
     };
 
     /// Helper to simplify action-related code in tests that are not specifically testing action code.
@@ -102,6 +128,17 @@ namespace Conformance
         std::vector<XrActionSet> m_actionSets;
     };
 
+    /// Storage for the result of @ref CompositionHelper::LocateViews that does not allocate, for use every frame.
+    struct LocatedViews
+    {
+        /// Enough for every primary view configuration, including the four views of `XR_VARJO_quad_views`.
+        static constexpr uint32_t MaxViewCount = 4;
+
+        XrViewState viewState{XR_TYPE_VIEW_STATE};
+        std::array<XrView, MaxViewCount> views;
+        uint32_t viewCount{0};
+    };
+
     /// A helper for basic frame loop and rendering operations, wrapping an instance, session, and @ref InteractionManager.
     ///
     /// Displays the usual title box.
@@ -147,6 +184,11 @@ namespace Conformance
         /// @param displayTime the predicted display time of the next frame
         std::tuple<XrViewState, std::vector<XrView>> LocateViews(XrSpace space, XrTime displayTime);
 
+        /// Locate views relative to @p space at time @p displayTime into @p located, without allocating.
+        ///
+        /// @throws if the primary view configuration has more than LocatedViews::MaxViewCount views.
+        void LocateViews(XrSpace space, XrTime displayTime, LocatedViews& located);
+
         /// Check for OpenXR events and handle them.
         ///
         /// FAILs if an unexpected session state transition means the test should exit early
@@ -154,8 +196,24 @@ namespace Conformance
 
         EventQueue& GetEventQueue() const;
 
-        /// Call xrEndFrame submitting the given layers.
-        void EndFrame(XrTime predictedDisplayTime, std::vector<XrCompositionLayerBaseHeader*> layers);
+        /// Call xrEndFrame submitting the given layers, then reset the frame arena.
+        void EndFrame(XrTime predictedDisplayTime, const std::vector<XrCompositionLayerBaseHeader*>& layers);
+
+        /// Storage for layers and chained structures (depth info, alpha blend, space warp, ...) built anew every frame.
+        /// Everything allocated from it is released by the next @ref EndFrame, once xrEndFrame has returned.
+        ///
+        /// @note Only use from the thread that calls @ref EndFrame.
+        FrameArena& GetFrameArena()
+        {
+            return m_frameArena;
+        }
+
+        /// Counts the heap allocations of each @ref EndFrame, reported when this object is destroyed. Declare a budget with
+        /// FrameAllocationTracker::SetBudget.
+        FrameAllocationTracker& GetEndFrameAllocationTracker()
+        {
+            return m_endFrameAllocations;
+        }
 
         /// Create a handle for a reference space of type @p type owned by this class.
         ///
@@ -188,6 +246,7 @@ namespace Conformance
         /// Specializations of this function:
         ///
         /// - @ref CreateStaticSwapchainSolidColor
+        /// - @ref CreateStaticSwapchainProcedural
         /// - @ref CreateStaticSwapchainImage
         XrSwapchain CreateSwapchain(const XrSwapchainCreateInfo& createInfo);
 
@@ -200,9 +259,37 @@ namespace Conformance
 
         /// Destroy a swapchain image created using @ref CreateSwapchain()
         ///
+        /// If swapchain recycling is enabled, a swapchain created by @ref CreateSwapchain itself is kept for reuse instead.
+        ///
         /// @param swapchain A swapchain created with @ref CreateSwapchain or a specialization of it.
         void DestroySwapchain(XrSwapchain swapchain);
 
+        /// Counts of the swapchains handed out by @ref CreateSwapchain, to tell allocation cost apart from composition cost.
+        struct SwapchainRecyclingStats
+        {
+            /// Swapchains created through xrCreateSwapchain.
+            uint32_t createdCount{0};
+            /// Swapchains handed out again from the pool instead.
+            uint32_t recycledCount{0};
+            /// Time spent creating swapchains and enumerating their images.
+            std::chrono::nanoseconds createDuration{0};
+        };
+
+        /// Enable or disable swapchain recycling for the session of this object.
+        ///
+        /// While enabled, @ref DestroySwapchain keeps swapchains created by @ref CreateSwapchain in a pool, along with their
+        /// enumerated images, and @ref CreateSwapchain hands one out again for an identical create info.
+        /// Static image swapchains can only be acquired once, and swapchains with a `next` chain or depth swapchain are
+        /// never pooled. Disabling recycling destroys the pooled swapchains.
+        ///
+        /// Default is Options::recycleSwapchains.
+        void SetSwapchainRecycling(bool enabled);
+
+        SwapchainRecyclingStats GetSwapchainRecyclingStats() const
+        {
+            return m_swapchainRecyclingStats;
+        }
+
         /// Perform an xrAcquireSwapchainImage, xrWaitSwapchainImage, xrReleaseSwapchainImage sequence,
         /// calling your update functor between Wait and Release.
         ///
@@ -212,20 +299,70 @@ namespace Conformance
         ///
         /// @param swapchain A swapchain created with @ref CreateSwapchain or a specialization of it.
         /// @param doUpdate A functor to call between Wait and Release that will be passed the swapchain image as a base header pointer.
-        void AcquireWaitReleaseImage(XrSwapchain swapchain, const std::function<void(const XrSwapchainImageBaseHeader*)>& doUpdate);
+        void AcquireWaitReleaseImage(XrSwapchain swapchain, FunctionRef<void(const XrSwapchainImageBaseHeader*)> doUpdate);
+
+        /// Like @ref AcquireWaitReleaseImage, but for several swapchains at once, such as one per view of a projection layer.
+        /// All images are acquired and waited on before @p doUpdate is called, so the views can be rendered together with
+        /// @ref IGraphicsPlugin::RenderViews, and released afterwards.
+        ///
+        /// @throws on timeout or other error
+        ///
+        /// @param swapchains Swapchains created with @ref CreateSwapchain or a specialization of it.
+        /// @param doUpdate A functor to call between Wait and Release that will be passed the swapchain images, in the same order.
+        void AcquireWaitReleaseImages(const std::vector<XrSwapchain>& swapchains,
+                                      FunctionRef<void(const std::vector<const XrSwapchainImageBaseHeader*>&)> doUpdate);
+
+        /// Latencies of the swapchain image calls made through this object while swapchain call timing is enabled.
+        struct SwapchainCallLatencies
+        {
+            std::vector<std::chrono::nanoseconds> acquire;
+            std::vector<std::chrono::nanoseconds> wait;
+            std::vector<std::chrono::nanoseconds> release;
+        };
+
+        /// Enable or disable recording the latency of every xrAcquireSwapchainImage, xrWaitSwapchainImage and
+        /// xrReleaseSwapchainImage call made by @ref AcquireWaitReleaseImage and @ref AcquireWaitReleaseImages.
+        /// Default is disabled.
+        void SetSwapchainCallTiming(bool enabled);
 
-        /// Create and return a static swapchain that has had a solid color texture copied to it: specialization of @ref CreateSwapchain
+        /// Return the latencies recorded since the previous call, and clear them.
+        SwapchainCallLatencies TakeSwapchainCallLatencies();
+
+        /// Create and return a static swapchain that has been cleared to a solid color: specialization of @ref CreateSwapchain
+        ///
+        /// Color is interpreted in a *linear* color space (and thus converted when written), not SRGB/gamma.
         ///
-        /// Color is interpreted in a *linear* color space (and thus converted before upload), not SRGB/gamma.
+        /// Swapchains are shared: asking again for the same color and size returns the same swapchain, until it has been
+        /// passed to @ref DestroySwapchain once for every time it was returned.
         ///
         /// @note Do not destroy this directly using OpenXR functions: use @ref DestroySwapchain instead.
-        XrSwapchain CreateStaticSwapchainSolidColor(const XrColor4f& color);
+        XrSwapchain CreateStaticSwapchainSolidColor(const XrColor4f& color, uint32_t width = 256, uint32_t height = 256);
+
+        /// Create and return a static swapchain that has had @p fill drawn to it by @ref IGraphicsPlugin::FillImageSlice:
+        /// specialization of @ref CreateSwapchain
+        ///
+        /// Unlike @ref CreateStaticSwapchainImage, @p format may be any format the graphics plugin can render to; the default
+        /// is the default color format.
+        ///
+        /// @note Do not destroy this directly using OpenXR functions: use @ref DestroySwapchain instead.
+        XrSwapchain CreateStaticSwapchainProcedural(const ProceduralFill& fill, uint32_t width = 256, uint32_t height = 256,
+                                                    int64_t format = -1);
 
         /// Create and return a static swapchain that has had an RGBAImage copied to it: specialization of @ref CreateSwapchain
         ///
         /// @note Do not destroy this directly using OpenXR functions: use @ref DestroySwapchain instead.
         XrSwapchain CreateStaticSwapchainImage(const RGBAImage& rgbaImage);
 
+        /// Create and return a static swapchain showing @p text as drawn by @ref CreateTextImage: specialization of
+        /// @ref CreateSwapchain
+        ///
+        /// Swapchains are shared the same way as by @ref CreateStaticSwapchainSolidColor, and the image comes from
+        /// @ref GetCachedTextImage, so showing the same prompt again costs neither a rasterization nor an upload.
+        ///
+        /// @note Do not destroy this directly using OpenXR functions: use @ref DestroySwapchain instead.
+        XrSwapchain CreateStaticSwapchainText(int32_t width, int32_t height, const char* text, int32_t fontHeight,
+                                              WordWrap wordWrap = WordWrap::Enabled);
+
         /// For a swapchain created using @ref CreateSwapchain or one of its specialized versions, return a `XrSwapchainSubImage` structure
         /// populated with the full sub-image as default (start at 0, 0, full width and height) and the provided
         /// optional @p imageArrayIndex
@@ -248,6 +385,17 @@ namespace Conformance
         /// Typically used with @ref MakeDefaultSubImage to finish populating the structure.
         XrCompositionLayerProjection* CreateProjectionLayer(XrSpace space);
 
+        /// Like @ref CreateQuadLayer, but allocated from the frame arena: only valid until the next @ref EndFrame.
+        XrCompositionLayerQuad* CreateFrameQuadLayer(XrSwapchain swapchain, XrSpace space, float width, XrPosef pose = Pose::Identity);
+
+        /// Like @ref CreateProjectionLayer, but the layer and its views are allocated from the frame arena: only valid until
+        /// the next @ref EndFrame.
+        XrCompositionLayerProjection* CreateFrameProjectionLayer(XrSpace space);
+
+        /// Report how often, and for how long, threads had to wait for the internal locks of this object, as metrics.
+        /// Useful after multi-threaded frame loops such as @ref PipelinedRenderLoop.
+        void ReportLockWaitMetrics() const;
+
         /// Return the session state from the most recent session state changed event
         XrSessionState GetSessionState() const
         {
@@ -256,7 +404,23 @@ namespace Conformance
 
     private:
         void SharedInit(const char* testName, bool skipOnUnsupportedViewType = false);
-        std::mutex m_mutex;
+        const XrSwapchainImageBaseHeader* AcquireAndWaitImage(XrSwapchain swapchain);
+        void ReleaseImage(XrSwapchain swapchain);
+        ISwapchainImageData* GetSwapchainImageData(XrSwapchain swapchain);
+        template <typename Call>
+        XrResult TimeSwapchainCall(std::vector<std::chrono::nanoseconds> SwapchainCallLatencies::*samples, Call&& call);
+
+        std::shared_lock<std::shared_timed_mutex> ReadLockSwapchains();
+        std::unique_lock<std::shared_timed_mutex> WriteLockSwapchains();
+        std::unique_lock<std::mutex> LockLayers();
+
+        // Guards the swapchain bookkeeping below, which every acquire and release reads, but which only changes when a
+        // swapchain is created or destroyed.
+        std::shared_timed_mutex m_swapchainMutex;
+        LockWaitStats m_swapchainLockWaits;
+        // Guards the layers and spaces owned by this object.
+        std::mutex m_layerMutex;
+        LockWaitStats m_layerLockWaits;
 
         XrInstance m_instance;
         InstanceREQUIRE m_instanceOwned;
@@ -265,6 +429,10 @@ namespace Conformance
 
         std::unique_ptr<EventQueue> m_eventQueue;
         std::unique_ptr<EventReader> m_privateEventReader;
+        // Set while the session is running if Options::perfMetricsSampleRate is nonzero.
+        std::unique_ptr<PerformanceMetricsSampler> m_perfMetricsSampler;
+        // Set while the session is running if Options::latencyProbe is set and the time conversion extension is enabled.
+        std::unique_ptr<LatencyProbe> m_latencyProbe;
 
         std::unique_ptr<InteractionManager> m_interactionManager;
 
@@ -278,16 +446,122 @@ namespace Conformance
         std::list<std::vector<XrCompositionLayerProjectionView>> m_projectionViews;
         std::list<XrCompositionLayerQuad> m_quads;
 
+        // Reused from frame to frame, so that the frame loop does not allocate.
+        std::vector<XrCompositionLayerBaseHeader*> m_frameLayers;
+        std::vector<const XrSwapchainImageBaseHeader*> m_acquiredImages;
+        FrameArena m_frameArena;
+        FrameAllocationTracker m_endFrameAllocations{"CompositionHelper.EndFrame"};
+
         std::map<XrSwapchain, XrSwapchainCreateInfo> m_createdSwapchains;
         std::map<XrSwapchain, ISwapchainImageData*> m_swapchainImages;
         std::vector<XrSpace> m_spaces;
 
+        struct SolidColorSwapchain
+        {
+            XrColor4f color;
+            uint32_t width;
+            uint32_t height;
+            XrSwapchain swapchain;
+            uint32_t useCount;
+        };
+        std::vector<SolidColorSwapchain> m_solidColorSwapchains;
+
+        struct TextSwapchain
+        {
+            std::string text;
+            int32_t width;
+            int32_t height;
+            int32_t fontHeight;
+            WordWrap wordWrap;
+            XrSwapchain swapchain;
+            uint32_t useCount;
+        };
+        std::vector<TextSwapchain> m_textSwapchains;
+
+        bool m_recycleSwapchains{false};
+        std::set<XrSwapchain> m_recyclableSwapchains;
+        std::vector<XrSwapchain> m_recycledSwapchains;
+        SwapchainRecyclingStats m_swapchainRecyclingStats;
+
+        std::atomic<bool> m_swapchainCallTiming{false};
+        std::mutex m_swapchainCallLatencyMutex;
+        SwapchainCallLatencies m_swapchainCallLatencies;
+
         // For the menu overlays:
         XrSpace m_viewSpace{XR_NULL_HANDLE};
 
         XrCompositionLayerQuad m_testNameQuad{XR_TYPE_COMPOSITION_LAYER_QUAD};
     };
 
+    /// A quad layer showing text that changes from time to time, such as instructions to the operator, from a single
+    /// swapchain kept for the lifetime of this object: changing the text neither creates nor destroys a swapchain.
+    ///
+    /// The text is drawn on a translucent panel with a border. @ref SetText only draws again the part of the image covered
+    /// by the old or the new text, and does nothing if the text is unchanged. The image is copied to the next swapchain
+    /// image by @ref GetLayer, only after the text changed.
+    ///
+    /// Not thread-safe.
+    class DynamicTextQuad
+    {
+    public:
+        /// @param width The width of the image, in pixels
+        /// @param height The height of the image, in pixels
+        /// @param fontHeight The height of the text, in pixels
+        /// @param space The space to attach the quad layer to.
+        /// @param quadWidth The width of the quad layer, its height follows from the image size
+        /// @param pose The pose of the quad in @p space
+        DynamicTextQuad(CompositionHelper& compositionHelper, int32_t width, int32_t height, int32_t fontHeight, XrSpace space,
+                        float quadWidth, XrPosef pose);
+        ~DynamicTextQuad();
+
+        DynamicTextQuad(const DynamicTextQuad&) = delete;
+        DynamicTextQuad& operator=(const DynamicTextQuad&) = delete;
+
+        /// Change the text shown, empty to show no layer at all.
+        void SetText(const std::string& text);
+
+        const std::string& GetText() const
+        {
+            return m_text;
+        }
+
+        /// Copy the image to the swapchain if the text changed since the last call, and return the layer to submit this frame,
+        /// or null if there is nothing to show. The swapchain is created by the first call with text to show.
+        ///
+        /// Must be called between xrBeginFrame and xrEndFrame, and the layer is only valid until the next call.
+        XrCompositionLayerQuad* GetLayer();
+
+    private:
+        CompositionHelper& m_compositionHelper;
+        const int32_t m_fontHeight;
+        XrCompositionLayerQuad m_layer{XR_TYPE_COMPOSITION_LAYER_QUAD};
+
+        std::string m_text;
+        RGBAImage m_image;
+        // The part of m_image covered by the glyphs of m_text.
+        XrRect2Di m_textBounds{};
+        bool m_imageChanged{false};
+    };
+
+    /// How far the views moved between the early and late xrLocateViews calls of late-latched frames, and what the late
+    /// calls cost. See BaseProjectionLayerHelper::EnableLateLatching.
+    struct LateLatchStats
+    {
+        /// Frames whose views were located twice, both times with valid poses
+        uint64_t frameCount{0};
+        /// Sum and maximum over frames of the largest distance, in meters, any view moved
+        double positionDeltaSum{0};
+        double positionDeltaMax{0};
+        /// Sum and maximum over frames of the largest angle, in radians, any view turned
+        double angleDeltaSum{0};
+        double angleDeltaMax{0};
+        /// Sum of the times from the end of the early call to the end of the late one: how much fresher the submitted poses are
+        std::chrono::nanoseconds latchIntervalSum{0};
+        /// Sum and maximum of the durations of the late calls
+        std::chrono::nanoseconds relocateTimeSum{0};
+        std::chrono::nanoseconds relocateTimeMax{0};
+    };
+
     /// Helper class to provide projection layer rendering. Each view of the projection is a separate swapchain.
     /// Typically wrapped by another utility providing an implementation of @ref BaseProjectionLayerHelper::ViewRenderer
     class BaseProjectionLayerHelper
@@ -314,6 +588,58 @@ namespace Conformance
         /// CompositionHelper::AcquireWaitReleaseImage after clearing the image slice for you.
         XrCompositionLayerBaseHeader* TryGetUpdatedProjectionLayer(const XrFrameState& frameState, ViewRenderer& renderer);
 
+        /// Render each view to a part of its swapchain that DynamicResolutionController picks from the GPU times passed to
+        /// UpdateDynamicResolution, rather than to the whole swapchain. The swapchains are not reallocated.
+        void EnableDynamicResolution(const DynamicResolutionController::Settings& settings = {})
+        {
+            m_dynamicResolution.reset(new DynamicResolutionController(settings));
+        }
+
+        void DisableDynamicResolution()
+        {
+            m_dynamicResolution.reset();
+        }
+
+        /// Locate the views a second time once every swapchain image has been acquired and waited for, just before rendering
+        /// them, and render and submit the views from that call rather than the one at the start of TryGetUpdatedProjectionLayer.
+        /// Both calls predict the same display time, so the difference between them is what the runtime learned meanwhile.
+        /// The poses submitted must be those rendered with, so this is as late as a frame rendered on the CPU timeline can latch.
+        void EnableLateLatching()
+        {
+            m_lateLatching = true;
+        }
+
+        void DisableLateLatching()
+        {
+            m_lateLatching = false;
+        }
+
+        /// Statistics of the late-latched frames since late latching was enabled or the statistics were last reset.
+        const LateLatchStats& GetLateLatchStats() const
+        {
+            return m_lateLatchStats;
+        }
+
+        void ResetLateLatchStats()
+        {
+            m_lateLatchStats = {};
+        }
+
+        /// Feed back the GPU time of the last frame rendered by TryGetUpdatedProjectionLayer, e.g. from a GPU timer scope
+        /// around it, to pick the image rects of the next ones. Does nothing unless dynamic resolution is enabled.
+        void UpdateDynamicResolution(std::chrono::nanoseconds gpuTime)
+        {
+            if (m_dynamicResolution) {
+                m_dynamicResolution->Update(gpuTime, m_displayPeriod);
+            }
+        }
+
+        /// The dynamic resolution controller, or null if dynamic resolution is disabled.
+        const DynamicResolutionController* GetDynamicResolution() const
+        {
+            return m_dynamicResolution.get();
+        }
+
         XrSpace GetLocalSpace() const
         {
             return m_localSpace;
@@ -329,50 +655,151 @@ namespace Conformance
         XrSpace m_localSpace;
         XrCompositionLayerProjection* m_projLayer;
         std::vector<XrSwapchain> m_swapchains;
+        /// Size of each view's swapchain
+        std::vector<XrExtent2Di> m_swapchainExtents;
+        LocatedViews m_locatedViews;
+        std::unique_ptr<DynamicResolutionController> m_dynamicResolution;
+        XrDuration m_displayPeriod{0};
+        bool m_lateLatching{false};
+        LocatedViews m_lateLocatedViews;
+        LateLatchStats m_lateLatchStats;
+
+        void RenderView(const LocatedViews& locatedViews, uint32_t viewIndex, const XrSwapchainImageBaseHeader* swapchainImage,
+                        ViewRenderer& renderer);
+        /// Locate the views again into m_lateLocatedViews and accumulate m_lateLatchStats. Returns false if the late poses are invalid.
+        bool RelocateViews(XrTime displayTime, std::chrono::steady_clock::time_point earlyLocateEnd);
     };
 
     /// Helper class to provide simple world-locked projection layer of some cubes. Each view of the projection is a separate swapchain.
     class SimpleProjectionLayerHelper
     {
     public:
-        SimpleProjectionLayerHelper(CompositionHelper& compositionHelper) : m_baseHelper(compositionHelper, XR_REFERENCE_SPACE_TYPE_LOCAL)
+        SimpleProjectionLayerHelper(CompositionHelper& compositionHelper)
+            : m_compositionHelper(compositionHelper), m_baseHelper(compositionHelper, XR_REFERENCE_SPACE_TYPE_LOCAL)
+        {
+        }
+
+        /// Draw the XR_KHR_visibility_mask hidden area of each view, filled with @p color, before the scene, so that the
+        /// graphics plugin does not shade the pixels the optics hide. A bright color makes the masks easy to check visually.
+        /// Requires XR_KHR_visibility_mask to be enabled on the instance. Returns false, and draws without the pre-pass, if the
+        /// runtime has no mask for the view configuration. The masks are fetched once, so call again after an
+        /// XrEventDataVisibilityMaskChangedKHR event.
+        bool EnableVisibilityMaskPrePass(XrColor4f color = Colors::Black);
+
+        void DisableVisibilityMaskPrePass()
         {
+            m_visibilityMasks.clear();
         }
 
-        XrCompositionLayerBaseHeader* TryGetUpdatedProjectionLayer(const XrFrameState& frameState,
-                                                                   const std::vector<Cube>& cubes = {
-                                                                       Cube::Make({-1, 0, -2}), Cube::Make({1, 0, -2}),
-                                                                       Cube::Make({0, -1, -2}), Cube::Make({0, 1, -2})})
+        XrCompositionLayerBaseHeader* TryGetUpdatedProjectionLayer(const XrFrameState& frameState, const std::vector<Cube>& cubes)
         {
-            ViewRenderer renderer(cubes);
+            return TryGetUpdatedProjectionLayer(frameState, RenderParams{}.Draw(cubes));
+        }
+
+        /// Renders whatever @p params draws, e.g. glTF models, in each view.
+        XrCompositionLayerBaseHeader* TryGetUpdatedProjectionLayer(const XrFrameState& frameState, const RenderParams& params)
+        {
+            ViewRenderer renderer(params, m_visibilityMasks, m_visibilityMaskColor);
             return m_baseHelper.TryGetUpdatedProjectionLayer(frameState, renderer);
         }
 
+        /// Renders the default cubes, arranged around a point in front of the origin.
+        XrCompositionLayerBaseHeader* TryGetUpdatedProjectionLayer(const XrFrameState& frameState)
+        {
+            // Built once rather than as a default argument, which would allocate every frame.
+            static const std::vector<Cube> defaultCubes{Cube::Make({-1, 0, -2}), Cube::Make({1, 0, -2}), Cube::Make({0, -1, -2}),
+                                                        Cube::Make({0, 1, -2})};
+            return TryGetUpdatedProjectionLayer(frameState, defaultCubes);
+        }
+
+        /// See BaseProjectionLayerHelper::EnableDynamicResolution.
+        void EnableDynamicResolution(const DynamicResolutionController::Settings& settings = {})
+        {
+            m_baseHelper.EnableDynamicResolution(settings);
+        }
+
+        void DisableDynamicResolution()
+        {
+            m_baseHelper.DisableDynamicResolution();
+        }
+
+        /// See BaseProjectionLayerHelper::EnableLateLatching.
+        void EnableLateLatching()
+        {
+            m_baseHelper.EnableLateLatching();
+        }
+
+        void DisableLateLatching()
+        {
+            m_baseHelper.DisableLateLatching();
+        }
+
+        const LateLatchStats& GetLateLatchStats() const
+        {
+            return m_baseHelper.GetLateLatchStats();
+        }
+
+        void ResetLateLatchStats()
+        {
+            m_baseHelper.ResetLateLatchStats();
+        }
+
+        void UpdateDynamicResolution(std::chrono::nanoseconds gpuTime)
+        {
+            m_baseHelper.UpdateDynamicResolution(gpuTime);
+        }
+
+        const DynamicResolutionController* GetDynamicResolution() const
+        {
+            return m_baseHelper.GetDynamicResolution();
+        }
+
         XrSpace GetLocalSpace() const
         {
             return m_baseHelper.GetLocalSpace();
         }
 
     private:
+        /// View space distance of the visibility masks, just beyond the 0.05 near plane the graphics plugins render with.
+        static constexpr float VisibilityMaskDistance = 0.051f;
+
+        CompositionHelper& m_compositionHelper;
         BaseProjectionLayerHelper m_baseHelper;
+        /// Hidden area mesh of each view, or empty when the pre-pass is disabled
+        std::vector<MeshHandle> m_visibilityMasks;
+        XrColor4f m_visibilityMaskColor{Colors::Black};
+
         class ViewRenderer : public BaseProjectionLayerHelper::ViewRenderer
         {
         public:
-            ViewRenderer(const std::vector<Cube>& cubes) : m_cubes(cubes)
+            ViewRenderer(const RenderParams& params, span<const MeshHandle> visibilityMasks, XrColor4f visibilityMaskColor)
+                : m_params(params), m_visibilityMasks(visibilityMasks), m_visibilityMaskColor(visibilityMaskColor)
             {
             }
 
             ~ViewRenderer() override = default;
-            void RenderView(const BaseProjectionLayerHelper& /* projectionLayerHelper */, uint32_t /* viewIndex */,
-                            const XrViewState& /* viewState */, const XrView& /* view */, XrCompositionLayerProjectionView& projectionView,
+            void RenderView(const BaseProjectionLayerHelper& /* projectionLayerHelper */, uint32_t viewIndex,
+                            const XrViewState& /* viewState */, const XrView& view, XrCompositionLayerProjectionView& projectionView,
                             const XrSwapchainImageBaseHeader* swapchainImage) override
             {
                 GetGlobalData().graphicsPlugin->ClearImageSlice(swapchainImage);
-                GetGlobalData().graphicsPlugin->RenderView(projectionView, swapchainImage, RenderParams{}.Draw(m_cubes));
+                if (viewIndex >= m_visibilityMasks.size()) {
+                    GetGlobalData().graphicsPlugin->RenderView(projectionView, swapchainImage, m_params);
+                    return;
+                }
+
+                // The mask vertices lie on the z = -1 plane of the view, so scaling places them at that distance.
+                const float d = VisibilityMaskDistance;
+                const MeshDrawable occluder(m_visibilityMasks[viewIndex], view.pose, {d, d, d}, m_visibilityMaskColor);
+                RenderParams params = m_params;
+                GetGlobalData().graphicsPlugin->RenderView(projectionView, swapchainImage,
+                                                           params.DepthPrePass(span<const MeshDrawable>(&occluder, 1)));
             }
 
         private:
-            const std::vector<Cube>& m_cubes;
+            const RenderParams& m_params;
+            span<const MeshHandle> m_visibilityMasks;
+            XrColor4f m_visibilityMaskColor;
         };
     };
 
@@ -481,17 +908,17 @@ namespace Conformance
 
             // Set up the quad layer for showing the help text to the left of the example image.
             m_descriptionQuad = m_compositionHelper.CreateQuadLayer(
-                m_compositionHelper.CreateStaticSwapchainImage(CreateTextImage(width, descriptionHeight, descriptionText, fontHeight)),
+                m_compositionHelper.CreateStaticSwapchainText(width, descriptionHeight, descriptionText, fontHeight),
                 m_descriptionQuadSpace, 0.75f);
             m_descriptionQuad->layerFlags |= XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT;
 
             if (m_sceneActionsSwapchain == XR_NULL_HANDLE) {
-                m_sceneActionsSwapchain = m_compositionHelper.CreateStaticSwapchainImage(
-                    CreateTextImage(width, actionsHeight, "Press Select to PASS. Press Menu for description", fontHeight));
+                m_sceneActionsSwapchain = m_compositionHelper.CreateStaticSwapchainText(
+                    width, actionsHeight, "Press Select to PASS. Press Menu for description", fontHeight);
             }
             if (m_helpActionsSwapchain == XR_NULL_HANDLE) {
-                m_helpActionsSwapchain = m_compositionHelper.CreateStaticSwapchainImage(
-                    CreateTextImage(width, actionsHeight, "Press Select to FAIL", fontHeight));
+                m_helpActionsSwapchain =
+                    m_compositionHelper.CreateStaticSwapchainText(width, actionsHeight, "Press Select to FAIL", fontHeight);
             }
 
             // Set up the quad layer and swapchain for showing what actions the user can take in the Scene/Help mode.
@@ -512,11 +939,12 @@ namespace Conformance
             m_backgroundLayers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader*>(layer));
         }
 
-        bool EndFrame(const XrFrameState& frameState, std::vector<XrCompositionLayerBaseHeader*> layers = {})
+        bool EndFrame(const XrFrameState& frameState, const std::vector<XrCompositionLayerBaseHeader*>& layers = {})
         {
-            bool keepRunning = AppendLayers(layers, frameState.predictedDisplayTime);
+            m_frameLayers.assign(layers.begin(), layers.end());
+            bool keepRunning = AppendLayers(m_frameLayers, frameState.predictedDisplayTime);
             m_compositionHelper.PollEvents();
-            m_compositionHelper.EndFrame(frameState.predictedDisplayTime, std::move(layers));
+            m_compositionHelper.EndFrame(frameState.predictedDisplayTime, m_frameLayers);
             return keepRunning;
         }
 
@@ -616,6 +1044,9 @@ namespace Conformance
 
         CompositionHelper& m_compositionHelper;
 
+        // Reused from frame to frame, so that the frame loop does not allocate.
+        std::vector<XrCompositionLayerBaseHeader*> m_frameLayers;
+
         XrActionSet m_actionSet{XR_NULL_HANDLE};
         XrAction m_select{XR_NULL_HANDLE};
         XrAction m_menu{XR_NULL_HANDLE};
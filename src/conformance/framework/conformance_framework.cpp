@@ -19,10 +19,12 @@
 #include "composition_utils.h"  // for Colors
 #include "graphics_plugin.h"
 #include "interaction_info.h"
+#include "latency_probe.h"
 #include "platform_plugin.h"
 #include "report.h"
 #include "two_call_util.h"
 #include "utilities/feature_availability.h"
+#include "utilities/image.h"
 #include "utilities/throw_helpers.h"
 #include "utilities/utils.h"
 #include "utilities/uuid_utils.h"
@@ -30,6 +32,7 @@
 #include <openxr/openxr.h>
 
 #include <algorithm>
+#include <cmath>
 #include <exception>
 #include <mutex>
 #include <sstream>
@@ -98,6 +101,76 @@ namespace Conformance
 
         AppendSprintf(result, "   pollGetSystem: %s\n", pollGetSystem ? "yes" : "no");
 
+        if (!framePacingLoads.empty()) {
+            AppendSprintf(result, "   framePacingLoads:\n");
+            for (const FramePacingLoad& load : framePacingLoads) {
+                AppendSprintf(result, "      %.0f%%:%.0f%%\n", load.cpu * 100, load.gpu * 100);
+            }
+        }
+
+        AppendSprintf(result, "   framePacingFrameCount: %u\n", framePacingFrameCount);
+        AppendSprintf(result, "   soakDuration: %u\n", soakDuration);
+        AppendSprintf(result, "   soakGpuLoad: %u\n", soakGpuLoad);
+        AppendSprintf(result, "   sessionStartupIterations: %u\n", sessionStartupIterations);
+
+        if (!pipelineCacheDirectory.empty()) {
+            AppendSprintf(result, "   pipelineCacheDirectory: %s\n", pipelineCacheDirectory.c_str());
+        }
+
+        if (!transcodeCacheDirectory.empty()) {
+            AppendSprintf(result, "   transcodeCacheDirectory: %s\n", transcodeCacheDirectory.c_str());
+        }
+
+        if (!capabilityCacheDirectory.empty()) {
+            AppendSprintf(result, "   capabilityCacheDirectory: %s\n", capabilityCacheDirectory.c_str());
+        }
+
+        AppendSprintf(result, "   keepGraphicsDevice: %s\n", keepGraphicsDevice ? "yes" : "no");
+
+        AppendSprintf(result, "   commandBuffersInFlight: %u\n", commandBuffersInFlight);
+
+        AppendSprintf(result, "   gpuTimers: %s\n", gpuTimers ? "yes" : "no");
+
+        AppendSprintf(result, "   swapchainCreateWorkers: %u\n", swapchainCreateWorkers);
+
+        AppendSprintf(result, "   recycleSwapchains: %s\n", recycleSwapchains ? "yes" : "no");
+        AppendSprintf(result, "   streamReport: %s\n", streamReport ? "yes" : "no");
+        AppendSprintf(result, "   asyncReport: %s\n", asyncReport ? "yes" : "no");
+        AppendSprintf(result, "   compactPbrVertices: %s\n", compactPbrVertices ? "yes" : "no");
+        AppendSprintf(result, "   pbrTextureCacheBudget: %u MB\n", pbrTextureCacheBudget);
+        AppendSprintf(result, "   glUploadWorker: %s\n", glUploadWorker ? "yes" : "no");
+        AppendSprintf(result, "   vulkanTransferQueue: %s\n", vulkanTransferQueue ? "yes" : "no");
+        AppendSprintf(result, "   parallelViewRecording: %s\n", parallelViewRecording ? "yes" : "no");
+        AppendSprintf(result, "   bitmaskCoverage: %u\n", bitmaskCoverage);
+        AppendSprintf(result, "   headless: %s\n", headless ? "yes" : "no");
+        AppendSprintf(result, "   reportSlowest: %u\n", reportSlowest);
+        AppendSprintf(result, "   perfMetricsSampleRate: %u\n", perfMetricsSampleRate);
+        AppendSprintf(result, "   latencyProbe: %s\n", latencyProbe ? "yes" : "no");
+        AppendSprintf(result, "   swapchainMemoryAudit: %s\n", swapchainMemoryAudit ? "yes" : "no");
+        AppendSprintf(result, "   residentMemoryGrowth: %s\n", residentMemoryGrowth ? "yes" : "no");
+        AppendSprintf(result, "   allocationBudgets: %s\n", allocationBudgets ? "yes" : "no");
+        if (!checkpointFile.empty()) {
+            AppendSprintf(result, "   checkpointFile: %s\n", checkpointFile.c_str());
+        }
+        if (!testListFile.empty()) {
+            AppendSprintf(result, "   testListFile: %s\n", testListFile.c_str());
+        }
+        if (subtestShardCount > 1) {
+            AppendSprintf(result, "   subtestShard: %u/%u\n", subtestShardIndex, subtestShardCount);
+            for (const std::string& testCase : subtestShardTestCases) {
+                AppendSprintf(result, "      %s\n", testCase.c_str());
+            }
+        }
+        if (!inputScript.empty()) {
+            AppendSprintf(result, "   inputScript: %s\n", inputScript.c_str());
+        }
+        if (!traceFile.empty()) {
+            AppendSprintf(result, "   traceFile: %s\n", traceFile.c_str());
+        }
+        if (!timingFile.empty()) {
+            AppendSprintf(result, "   timingFile: %s\n", timingFile.c_str());
+        }
+
         AppendSprintf(result, "   debugMode: %s", debugMode ? "yes" : "no");
 
         return result;
@@ -173,6 +246,35 @@ namespace Conformance
         return failure;
     }
 
+    DurationPercentiles DurationPercentiles::FromSamples(std::vector<std::chrono::nanoseconds> samples)
+    {
+        DurationPercentiles result;
+        if (samples.empty()) {
+            return result;
+        }
+        std::sort(samples.begin(), samples.end());
+
+        std::chrono::nanoseconds total{0};
+        for (const auto& sample : samples) {
+            total += sample;
+        }
+        result.mean = total / samples.size();
+
+        // Nearest-rank percentile.
+        auto percentile = [&](double p) {
+            size_t rank = static_cast<size_t>(std::ceil(p * samples.size()));
+            return samples[std::min(std::max<size_t>(rank, 1), samples.size()) - 1];
+        };
+        result.p50 = percentile(0.50);
+        result.p90 = percentile(0.90);
+        result.p99 = percentile(0.99);
+        result.max = samples.back();
+        return result;
+    }
+
+    constexpr double FramePacingResults::HistogramBucketWidth;
+    constexpr size_t FramePacingResults::HistogramBucketCount;
+
     bool GlobalData::Initialize()
     {
         // NOTE: Runs *after* population of command-line options.
@@ -184,6 +286,8 @@ namespace Conformance
             return false;
         }
 
+        Image::SetTranscodeCacheDirectory(options.transcodeCacheDirectory);
+
         // Setup the platform-specific plugin first. This is required before creating any instances.
         platformPlugin = Conformance::CreatePlatformPlugin();
         if (!platformPlugin->Initialize()) {
@@ -285,6 +389,23 @@ namespace Conformance
             }
         }
 
+        if (options.perfMetricsSampleRate != 0) {
+            for (const char* value : {XR_META_PERFORMANCE_METRICS_EXTENSION_NAME, XR_EXT_THERMAL_QUERY_EXTENSION_NAME}) {
+                const auto& avail = availableInstanceExtensionNames;
+                if (std::find(avail.begin(), avail.end(), value) != avail.end()) {
+                    enabledInstanceExtensionNames.push_back_unique(value);
+                }
+            }
+        }
+
+        if (options.latencyProbe && LatencyProbe::GetTimeConversionExtensionName() != nullptr) {
+            const auto& avail = availableInstanceExtensionNames;
+            const char* value = LatencyProbe::GetTimeConversionExtensionName();
+            if (std::find(avail.begin(), avail.end(), value) != avail.end()) {
+                enabledInstanceExtensionNames.push_back_unique(value);
+            }
+        }
+
         if (useDebugMessenger) {
             enabledInstanceExtensionNames.push_back_unique(XR_EXT_DEBUG_UTILS_EXTENSION_NAME);
         }
@@ -381,13 +502,17 @@ namespace Conformance
             }
         }
 
-        // Find available blend modes
-        result = doTwoCallInPlace(availableBlendModes, xrEnumerateEnvironmentBlendModes, autoInstance.GetInstance(), systemId,
-                                  options.viewConfigurationValue);
+        // Snapshot what the system supports, including the available blend modes
+        result = runtimeCapabilities.Gather(autoInstance.GetInstance(), systemId, options.formFactorValue, options.viewConfigurationValue,
+                                            options.graphicsPlugin, options.capabilityCacheDirectory);
         if (XR_FAILED(result)) {
-            ReportF("GlobalData::Initialize: xrEnumerateEnvironmentBlendModes failed with result: %s", ResultToString(result));
+            ReportF("GlobalData::Initialize: probing the runtime capabilities failed with result: %s", ResultToString(result));
             return false;
         }
+        if (runtimeCapabilities.fromCache) {
+            ReportF("GlobalData::Initialize: using the runtime capabilities cached in %s", options.capabilityCacheDirectory.c_str());
+        }
+        availableBlendModes = runtimeCapabilities.environmentBlendModes;
         if (options.environmentBlendMode.empty()) {
             // Default to the first enumerated blend mode
             options.environmentBlendModeValue = availableBlendModes.front();
@@ -408,6 +533,23 @@ namespace Conformance
             }
         }
 
+        PopulateVersionAndEnabledExtensions(enabledInstanceExtensionFeatures);
+
+        if (!options.inputScript.empty()) {
+            if (!IsUsingConformanceAutomation()) {
+                ReportF("GlobalData::Initialize: an input script needs " XR_EXT_CONFORMANCE_AUTOMATION_EXTENSION_NAME
+                        " to be enabled, not proceeding with tests.");
+                return false;
+            }
+            std::string error;
+            if (!inputScript.Load(options.inputScript, &error)) {
+                ReportF("GlobalData::Initialize: cannot load the input script: %s", error.c_str());
+                return false;
+            }
+            ReportF("GlobalData::Initialize: replaying %zu input script steps from %s", inputScript.GetRemainingCount(),
+                    options.inputScript.c_str());
+        }
+
         isInitialized = true;
         return true;
     }
@@ -429,6 +571,7 @@ namespace Conformance
                 graphicsPlugin->Shutdown();
             }
         }
+        graphicsDeviceKept = false;
 
         if (platformPlugin && platformPlugin->IsInitialized()) {
             platformPlugin->Shutdown();
@@ -444,14 +587,10 @@ namespace Conformance
 
     const FunctionInfo& GlobalData::GetFunctionInfo(const char* functionName) const
     {
-        std::lock_guard<std::recursive_mutex> lock(dataMutex);
-
-        const FunctionInfoMap& functionInfoMap = GetFunctionInfoMap();
+        const FunctionInfo* functionInfo = FindFunctionInfo(functionName);
 
-        auto it = functionInfoMap.find(functionName);
-
-        if (it != functionInfoMap.end()) {
-            return it->second;
+        if (functionInfo != nullptr) {
+            return *functionInfo;
         }
 
         return nullFunctionInfo;
@@ -467,6 +606,22 @@ namespace Conformance
         return instanceProperties;
     }
 
+    const RuntimeCapabilities& GlobalData::GetRuntimeCapabilities() const
+    {
+        return runtimeCapabilities;
+    }
+
+    std::vector<int64_t> GlobalData::GetSwapchainFormats(XrSession session)
+    {
+        std::lock_guard<std::recursive_mutex> lock(dataMutex);
+
+        if (runtimeCapabilities.swapchainFormats.empty()) {
+            XRC_CHECK_THROW_XRCMD(doTwoCallInPlace(runtimeCapabilities.swapchainFormats, xrEnumerateSwapchainFormats, session));
+            runtimeCapabilities.Save(options.capabilityCacheDirectory);
+        }
+        return runtimeCapabilities.swapchainFormats;
+    }
+
     const ConformanceReport& GlobalData::GetConformanceReport() const
     {
         return conformanceReport;
@@ -489,6 +644,13 @@ namespace Conformance
     {
         std::lock_guard<std::recursive_mutex> lock(dataMutex);
 
+        if (isInitialized) {
+            FeatureBitIndex bit = FeatureNameToBitIndex(extensionName);
+            if (bit != FeatureBitIndex::FEATURE_COUNT) {
+                return enabledInstanceExtensionFeatures.Get(bit);
+            }
+        }
+
         for (const char* name : enabledInstanceExtensionNames) {
             if (strequal(name, extensionName)) {
                 return true;
@@ -498,6 +660,13 @@ namespace Conformance
         return false;
     }
 
+    bool GlobalData::IsInstanceExtensionEnabled(FeatureBitIndex extension) const
+    {
+        std::lock_guard<std::recursive_mutex> lock(dataMutex);
+
+        return enabledInstanceExtensionFeatures.Get(extension);
+    }
+
     bool GlobalData::IsInstanceExtensionSupported(const char* extensionName) const
     {
         std::lock_guard<std::recursive_mutex> lock(dataMutex);
@@ -532,9 +701,57 @@ namespace Conformance
 
     bool GlobalData::IsUsingGraphicsPlugin() const
     {
+        if (options.headless) {
+            return false;
+        }
         return IsGraphicsPluginRequired() || !options.graphicsPlugin.empty();
     }
 
+    void GlobalData::PrepareSessionGraphicsDevice()
+    {
+        std::lock_guard<std::recursive_mutex> lock(dataMutex);
+
+        if (graphicsDeviceKept || !IsUsingGraphicsPlugin() || !graphicsPlugin || !graphicsPlugin->IsInitialized()) {
+            return;
+        }
+        graphicsPlugin->PrepareDevice();
+    }
+
+    bool GlobalData::InitializeSessionGraphicsDevice(XrInstance instance, XrSystemId systemId)
+    {
+        std::lock_guard<std::recursive_mutex> lock(dataMutex);
+
+        if (graphicsDeviceKept) {
+            graphicsDeviceKept = false;
+            if (options.keepGraphicsDevice && graphicsPlugin->ReuseDevice(instance, systemId)) {
+                return true;
+            }
+            graphicsPlugin->ShutdownDevice();
+        }
+        return graphicsPlugin->InitializeDevice(instance, systemId);
+    }
+
+    void GlobalData::ShutdownSessionGraphicsDevice()
+    {
+        std::lock_guard<std::recursive_mutex> lock(dataMutex);
+
+        if (options.keepGraphicsDevice) {
+            graphicsDeviceKept = true;
+            return;
+        }
+        graphicsPlugin->ShutdownDevice();
+    }
+
+    void GlobalData::ReleaseKeptGraphicsDevice()
+    {
+        std::lock_guard<std::recursive_mutex> lock(dataMutex);
+
+        if (graphicsDeviceKept) {
+            graphicsDeviceKept = false;
+            graphicsPlugin->ShutdownDevice();
+        }
+    }
+
     bool GlobalData::IsUsingConformanceAutomation() const
     {
         return IsInstanceExtensionEnabled(XR_EXT_CONFORMANCE_AUTOMATION_EXTENSION_NAME);
@@ -570,6 +787,10 @@ namespace Conformance
 
     void GlobalData::PopulateVersionAndEnabledExtensions(FeatureSet& out) const
     {
+        if (isInitialized) {
+            out = enabledInstanceExtensionFeatures;
+            return;
+        }
         out = FeatureSet(options.desiredApiVersionValue);
         for (const auto& ext : enabledInstanceExtensionNames) {
             out.SetByExtensionNameString(ext);
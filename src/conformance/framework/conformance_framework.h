@@ -17,6 +17,10 @@
 #pragma once
 
 #include "conformance_utils.h"
+#include "input_script.h"
+#include "runtime_capabilities.h"
+#include "swapchain_memory_audit.h"
+#include "test_checkpoint.h"
 #include "utilities/feature_availability.h"
 #include "utilities/stringification.h"
 #include "utilities/types_and_constants.h"
@@ -30,6 +34,7 @@
 #include <catch2/catch_message.hpp>
 #include <catch2/catch_tostring.hpp>
 
+#include <array>
 #include <memory>
 #include <mutex>
 #include <stdexcept>
@@ -127,6 +132,15 @@ namespace Conformance
     class FeatureSet;
     struct IGraphicsPlugin;
     struct IPlatformPlugin;
+    /// Simulated load for one step of the frame pacing benchmark, see Options::framePacingLoads.
+    struct FramePacingLoad
+    {
+        /// Fraction of the predicted display period spent blocking on the xrWaitFrame thread.
+        double cpu;
+        /// Fraction of the predicted display period spent blocking between xrBeginFrame and xrEndFrame.
+        double gpu;
+    };
+
     /// Specifies runtime options for the application.
     /// String options are case-insensitive.
     /// Each of these can be specified from the command line via a command of the same name as
@@ -221,6 +235,185 @@ namespace Conformance
         /// before beginning a test case.
         bool pollGetSystem{false};
 
+        /// Simulated loads for the frame pacing benchmark, as fractions of the predicted display period to block on the
+        /// xrWaitFrame ("simulation", CPU) thread and the xrBeginFrame/xrEndFrame ("render", GPU) thread respectively.
+        /// Specified on the command line as percentages, e.g. "90:70". May repeat to sweep several loads.
+        /// Default is empty, which means the benchmark uses its own sweep.
+        std::vector<FramePacingLoad> framePacingLoads;
+
+        /// Number of measured frames per load in the frame pacing benchmark.
+        /// Default is 600.
+        uint32_t framePacingFrameCount{600};
+
+        /// Length of the thermal soak benchmark, in seconds of sustained load.
+        /// Default is 600.
+        uint32_t soakDuration{600};
+
+        /// GPU time the thermal soak benchmark aims to fill, as a percentage of the predicted display period.
+        /// Default is 80.
+        uint32_t soakGpuLoad{80};
+
+        /// Number of times the session startup benchmark brings up and tears down a session. The first is reported
+        /// as the cold startup and the rest as warm startups.
+        /// Default is 10.
+        uint32_t sessionStartupIterations{10};
+
+        /// Directory in which graphics plugins that support it keep their pipeline cache (Vulkan and D3D12) or program binaries
+        /// (OpenGL and OpenGL ES) between runs.
+        /// Default is empty, which means the cache is only shared between the sessions of a single run.
+        std::string pipelineCacheDirectory;
+
+        /// Directory in which KTX2 textures transcoded for the formats the graphics plugin supports are kept between runs.
+        /// Default is empty, which means textures are transcoded every time they are loaded.
+        std::string transcodeCacheDirectory;
+
+        /// Directory in which the RuntimeCapabilities snapshot is kept, and read back by later runs of the same runtime version
+        /// on the same system. Default is empty, which means it is probed every run.
+        std::string capabilityCacheDirectory;
+
+        /// If true then the graphics device of a session is kept when the session ends, and reused for the next session
+        /// if the graphics plugin supports it (Vulkan, D3D11 and D3D12) and the runtime still uses the same adapter.
+        /// Tests which create the graphics device themselves still get a fresh one.
+        /// Default is false.
+        bool keepGraphicsDevice{false};
+
+        /// Number of command buffers the graphics plugin (Vulkan and D3D12) uses in turn, so that recording the next submission
+        /// overlaps with the GPU executing earlier ones, as a real application's frames in flight do.
+        /// Default is 1, which waits for each submission to complete before returning.
+        uint32_t commandBuffersInFlight{1};
+
+        /// If true then the graphics plugin (if it supports GPU timers) measures the GPU time of each view it renders, each
+        /// image slice it clears and each image it copies, and the averages are reported as metrics of the test section.
+        /// Default is false.
+        bool gpuTimers{false};
+
+        /// Number of threads across which the Swapchains test creates, enumerates and destroys the swapchains of all
+        /// formats and create info permutations, if the graphics plugin allows concurrent swapchain creation (Vulkan, D3D11
+        /// and D3D12). The create latency of each format is reported as a table.
+        /// Default is 0, which creates them one at a time within the test of each format, as always.
+        uint32_t swapchainCreateWorkers{0};
+
+        /// If true then each CompositionHelper keeps the swapchains a test destroys in a pool and reuses them for later
+        /// swapchains with an identical create info, so that steady-state composition cost is not mixed with allocation cost.
+        /// Default is false.
+        bool recycleSwapchains{false};
+
+        /// If true then the CTS report writes each test case as soon as it ends, instead of keeping the whole run in memory
+        /// until the end. Run totals are then written at the end in a cts:totals element rather than as testsuite attributes.
+        /// Default is false.
+        bool streamReport{false};
+
+        /// File in which each finished test case and its result is recorded as the run goes. If it already exists, the test
+        /// cases it records as finished, or as having crashed the run, are not run again. See TestCheckpoint.
+        /// Default is empty, which disables checkpointing.
+        std::string checkpointFile;
+
+        /// File listing the names of the test cases to run, one per line. Test cases it does not name are not run, even if
+        /// they match the test spec. Used by conformance_cli to give each shard its share of the tests.
+        /// Default is empty, which runs every test case matching the test spec.
+        std::string testListFile;
+
+        /// Which share of the values of generators this process produces, out of how many: see GeneratorShard. Used by
+        /// conformance_cli to split the generated subtests of a long test case between shards that each run it.
+        /// Default is 0 of 1, which produces them all.
+        uint32_t subtestShardIndex{0};
+        uint32_t subtestShardCount{1};
+
+        /// Names of the test cases whose generators are sharded by subtestShardIndex and subtestShardCount.
+        /// Default is empty, which shards the generators of every test case.
+        std::vector<std::string> subtestShardTestCases;
+
+        /// File with a timeline of input that the interactive tests replay through XR_EXT_conformance_automation, which must
+        /// be enabled, instead of prompting for it and pausing for a person to read the prompts. See InputScript.
+        /// Default is empty, which leaves the input to a person, or to the runtime's handling of XR_EXT_conformance_automation.
+        std::string inputScript;
+
+        /// File to write a timeline of test sections, framework hot spots and OpenXR calls to, as Chrome trace event JSON.
+        /// Only available in builds with XRC_ENABLE_TRACING defined (the BUILD_CONFORMANCE_TRACING CMake option). See StartTracing.
+        /// Default is empty, which disables tracing.
+        std::string traceFile;
+
+        /// File in which the wall time of each test case run is written at the end of the run, one `seconds name` line
+        /// each, for conformance_cli to schedule later sharded runs by.
+        /// Default is empty, which writes no timings.
+        std::string timingFile;
+
+        /// If true then console messages from ReportF and ReportConsoleOnlyF are written by a background thread, so that
+        /// tests reporting as they render do not block on console output. Queued messages are flushed at test case and
+        /// section boundaries and before any other console output, so they stay in order.
+        /// Default is false.
+        bool asyncReport{false};
+
+        /// If true then graphics plugins that support it store glTF and other PBR model vertices in a compact layout, with
+        /// normalized 16-bit normals and tangents, 8-bit colors and half float texture coordinates, to reduce vertex bandwidth.
+        /// Currently OpenGL and OpenGL ES. Default is false.
+        bool compactPbrVertices{false};
+
+        /// Megabytes of PBR model textures each graphics plugin keeps cached once no model uses them, so that models
+        /// loaded again, or sharing images with models loaded before, reuse them. Least recently used textures are dropped
+        /// first. Default is 256.
+        uint32_t pbrTextureCacheBudget{256};
+
+        /// If true then the OpenGL graphics plugin uploads swapchain images and PBR model textures and buffers on a thread
+        /// of its own, with a context sharing objects with the rendering context, overlapping them with rendering.
+        /// Default is false.
+        bool glUploadWorker{false};
+
+        /// If true then the Vulkan graphics plugin copies images into swapchain images, and uploads PBR model textures, on a
+        /// queue of a dedicated transfer family where the device has one, transferring their ownership to and from the
+        /// graphics queue family, so that large uploads run alongside rendering. Default is false.
+        bool vulkanTransferQueue{false};
+
+        /// If true then the graphics plugin records each view passed to RenderViews on its own thread, and executes the
+        /// results in view order: D3D11 into deferred contexts, Vulkan into secondary command buffers.
+        /// Default is false, which records every view on the submitting thread.
+        bool parallelViewRecording{false};
+
+        /// If nonzero then tests that generate combinations of flags with bitmaskGenerator only generate enough of them that
+        /// every combination of any this many flags appears at least once (2 is pairwise), instead of every combination.
+        /// Default is 0, which generates every combination, as conformance submissions require.
+        uint32_t bitmaskCoverage{0};
+
+        /// If true then XR_MND_headless is enabled and sessions are created without a graphics binding, even if a
+        /// graphics plugin was specified: the graphics plugin is never initialized, no swapchains are created, and tests
+        /// that need to render skip themselves. Useful for running the API-surface tests on machines without a GPU.
+        /// Default is false.
+        bool headless{false};
+
+        /// If nonzero then XR_META_performance_metrics and XR_EXT_thermal_query are enabled when available, and each
+        /// CompositionHelper session polls their counters and thermal levels this many times per second, reporting the
+        /// samples, timestamped with the display time of the latest frame, as metrics of the running test.
+        /// Default is 0, which samples nothing.
+        uint32_t perfMetricsSampleRate{0};
+
+        /// If true then XR_KHR_convert_timespec_time, or XR_KHR_win32_convert_performance_counter_time on Windows, is
+        /// enabled when available, and each CompositionHelper session records when each frame's views were located and
+        /// when it was submitted on the XrTime clock, reporting percentiles of the time from each to the predicted display
+        /// time as metrics of the running test.
+        /// Default is false.
+        bool latencyProbe{false};
+
+        /// If true then the GPU memory allocated for the images of each swapchain created through CompositionHelper is
+        /// queried with IGraphicsPlugin::GetSwapchainImageMemorySize, and the totals and peaks of each test case, with
+        /// static and dynamic swapchains apart, are reported as metrics of the test. See SwapchainMemoryAudit.
+        /// Default is false.
+        bool swapchainMemoryAudit{false};
+
+        /// If true then the growth of the process resident set over each run of a test case is reported as a metric of the
+        /// test, to find the tests after which the runtime keeps memory it should have released.
+        /// Default is false.
+        bool residentMemoryGrowth{false};
+
+        /// If true then a steady-state frame that makes more heap allocations than the budget its FrameAllocationTracker
+        /// declares fails the test. The allocations per frame are reported as metrics either way, in builds that count them.
+        /// Default is false.
+        bool allocationBudgets{false};
+
+        /// If nonzero then the end of the run lists this many of the test cases, and of the sections, that took the most
+        /// wall time, with the CPU time the process spent in them.
+        /// Default is 0, which lists none.
+        uint32_t reportSlowest{0};
+
         /// Defines if executing in debug mode. By default this follows the build type.
         bool debugMode
         {
@@ -299,6 +492,48 @@ namespace Conformance
         std::chrono::nanoseconds averageBeginWaitTime;
     };
 
+    /// Distribution of a set of durations.
+    struct DurationPercentiles
+    {
+        std::chrono::nanoseconds mean{0};
+        std::chrono::nanoseconds p50{0};
+        std::chrono::nanoseconds p90{0};
+        std::chrono::nanoseconds p99{0};
+        std::chrono::nanoseconds max{0};
+
+        /// Compute from unsorted samples.
+        static DurationPercentiles FromSamples(std::vector<std::chrono::nanoseconds> samples);
+    };
+
+    /// Results of one load step of the "Frame_Pacing_Benchmark" test.
+    struct FramePacingResults
+    {
+        /// Width of each frame time histogram bucket, in predicted display periods.
+        static constexpr double HistogramBucketWidth = 0.5;
+        /// The last bucket counts every frame longer than (HistogramBucketCount - 1) * HistogramBucketWidth periods.
+        static constexpr size_t HistogramBucketCount = 9;
+
+        FramePacingLoad load{};
+        uint32_t frameCount{0};
+
+        /// Average predicted display period
+        std::chrono::nanoseconds averageDisplayPeriod{0};
+        /// Time between successive xrWaitFrame returns
+        DurationPercentiles frameTime;
+        /// Time blocked in xrWaitFrame
+        DurationPercentiles waitTime;
+        /// Time blocked in xrBeginFrame
+        DurationPercentiles beginTime;
+
+        /// Frame times, in buckets of HistogramBucketWidth predicted display periods.
+        std::array<uint32_t, HistogramBucketCount> frameTimeHistogram{};
+
+        /// Display periods skipped, judging by the predicted display times of successive frames.
+        uint32_t missedFrameCount{0};
+        /// Frames for which xrWaitFrame returned shouldRender = XR_FALSE.
+        uint32_t shouldRenderFalseCount{0};
+    };
+
     /// Records and produces a conformance report.
     /// Conformance isn't a black-and-white result. Conformance is against a given specification version,
     /// against a selected set of extensions, with a subset of graphics systems and image formats.
@@ -327,6 +562,7 @@ namespace Conformance
         std::vector<std::string> unmatchedTestSpecs;
         Catch::Totals totals{};
         TimedSubmissionResults timedSubmission;
+        std::vector<FramePacingResults> framePacing;
         std::vector<std::pair<int64_t, std::string>> swapchainFormats;
     };
 
@@ -360,12 +596,23 @@ namespace Conformance
 
         const XrInstanceProperties& GetInstanceProperties() const;
 
+        /// The snapshot of the runtime and system under test. Only valid once Initialize has succeeded.
+        const RuntimeCapabilities& GetRuntimeCapabilities() const;
+
+        /// Returns the swapchain formats of the runtime, enumerating them with @p session the first time only. @p session
+        /// must have been created with the graphics plugin, since a session without one may have no formats at all.
+        /// Throws on failure.
+        std::vector<int64_t> GetSwapchainFormats(XrSession session);
+
         /// case sensitive check.
         bool IsAPILayerEnabled(const char* layerName) const;
 
         /// case sensitive check.
         bool IsInstanceExtensionEnabled(const char* extensionName) const;
 
+        /// Bit test against enabledInstanceExtensionFeatures. Only valid once Initialize has succeeded.
+        bool IsInstanceExtensionEnabled(FeatureBitIndex extension) const;
+
         /// case sensitive check.
         bool IsInstanceExtensionSupported(const char* extensionName) const;
 
@@ -382,6 +629,22 @@ namespace Conformance
         /// Returns true if a graphics plugin was supplied, or if IsGraphicsPluginRequired() is true.
         bool IsUsingGraphicsPlugin() const;
 
+        /// Starts the device-independent work of the next InitializeSessionGraphicsDevice, if using a graphics plugin and no
+        /// device is kept for reuse. See IGraphicsPlugin::PrepareDevice.
+        void PrepareSessionGraphicsDevice();
+
+        /// Initializes the graphics plugin device for a session on @p instance. If a device was kept by
+        /// ShutdownSessionGraphicsDevice, the graphics plugin is asked to reuse it first.
+        bool InitializeSessionGraphicsDevice(XrInstance instance, XrSystemId systemId);
+
+        /// Matches InitializeSessionGraphicsDevice. If Options::keepGraphicsDevice is set, the device is kept for the next
+        /// session instead of being shut down.
+        void ShutdownSessionGraphicsDevice();
+
+        /// Shuts down the graphics device kept between sessions, if any.
+        /// Must be called before calling IGraphicsPlugin::InitializeDevice directly on the plugin from GetGraphicsPlugin().
+        void ReleaseKeptGraphicsDevice();
+
         /// Returns true if using XR_EXT_conformance_automation
         bool IsUsingConformanceAutomation() const;
 
@@ -412,14 +675,29 @@ namespace Conformance
 
         ConformanceReport conformanceReport;
 
+        /// Open if Options::checkpointFile is set and tests are being run.
+        TestCheckpoint checkpoint;
+
+        /// Fed by CompositionHelper if Options::swapchainMemoryAudit is set.
+        SwapchainMemoryAudit swapchainMemoryAudit;
+
         XrInstanceProperties instanceProperties{XR_TYPE_INSTANCE_PROPERTIES};
 
+        /// Probed, or read from Options::capabilityCacheDirectory, by Initialize.
+        RuntimeCapabilities runtimeCapabilities;
+
+        /// Loaded from Options::inputScript by Initialize, and taken from by the IInputTestDevice of each interactive test.
+        InputScript inputScript;
+
         FunctionInfo nullFunctionInfo;
 
         std::shared_ptr<IPlatformPlugin> platformPlugin;
 
         std::shared_ptr<IGraphicsPlugin> graphicsPlugin;
 
+        /// Indicates if the graphics plugin device was kept by ShutdownSessionGraphicsDevice.
+        bool graphicsDeviceKept{false};
+
         /// Specifies invalid values, which aren't XR_NULL_HANDLE. Used to exercise invalid handles.
         XrInstance invalidInstance{XRC_INVALID_INSTANCE_VALUE};
         XrSession invalidSession{XRC_INVALID_SESSION_VALUE};
@@ -450,6 +728,10 @@ namespace Conformance
         /// The instance extensions that have been requested to be enabled. Suitable for passing to OpenXR.
         StringVec enabledInstanceExtensionNames;
 
+        /// The core version and enabledInstanceExtensionNames as feature bits, computed once at the end of Initialize,
+        /// after which enabledInstanceExtensionNames no longer changes.
+        FeatureSet enabledInstanceExtensionFeatures;
+
         /// The interaction profiles that have been requested to be tested.
         StringVec enabledInteractionProfiles;
 
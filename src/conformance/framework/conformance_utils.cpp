@@ -18,10 +18,13 @@
 #include "conformance_utils.h"
 #include "graphics_plugin.h"
 #include "platform_plugin.h"
+#include "report.h"
+#include "startup_timing.h"
 #include "two_call_util.h"
 #include "utilities/throw_helpers.h"
 #include "utilities/utils.h"
 #include "utilities/xrduration_literals.h"
+#include "common/hex_and_handles.h"
 
 #include <openxr/openxr.h>
 #include <openxr/openxr_reflection.h>
@@ -37,6 +40,8 @@
 #include <memory>
 #include <ratio>
 #include <sstream>
+#include <stdexcept>
+#include <string>
 #include <thread>
 #include <utility>
 
@@ -63,8 +68,14 @@ namespace Conformance
 
     std::string PathToString(XrInstance instance, XrPath path)
     {
+        // Paths are at most XR_MAX_PATH_LENGTH long, so one call normally suffices; fall back to two calls if the runtime disagrees.
+        char buffer[XR_MAX_PATH_LENGTH];
         uint32_t count = 0;
-        if (XR_SUCCEEDED(xrPathToString(instance, path, 0, &count, nullptr))) {
+        XrResult result = xrPathToString(instance, path, XR_MAX_PATH_LENGTH, &count, buffer);
+        if (XR_SUCCEEDED(result)) {
+            return std::string(buffer);
+        }
+        if (result == XR_ERROR_SIZE_INSUFFICIENT && XR_SUCCEEDED(xrPathToString(instance, path, 0, &count, nullptr))) {
             std::vector<char> buff(count);
             xrPathToString(instance, path, count, &count, buff.data());
             return std::string(buff.data());
@@ -72,11 +83,31 @@ namespace Conformance
         return "<unknown XrPath " + std::to_string(uint64_t(path)) + ">";
     }
 
+    const char* PerformanceMetricsCounterUnitName(XrPerformanceMetricsCounterUnitMETA unit)
+    {
+        switch (unit) {
+        case XR_PERFORMANCE_METRICS_COUNTER_UNIT_PERCENTAGE_META:
+            return "percent";
+        case XR_PERFORMANCE_METRICS_COUNTER_UNIT_MILLISECONDS_META:
+            return "ms";
+        case XR_PERFORMANCE_METRICS_COUNTER_UNIT_BYTES_META:
+            return "bytes";
+        case XR_PERFORMANCE_METRICS_COUNTER_UNIT_HERTZ_META:
+            return "Hz";
+        default:
+            return "generic";
+        }
+    }
+
     bool ValidateResultAllowed(const char* functionName, XrResult result)
     {
         GlobalData& globalData = GetGlobalData();
 
-        const FunctionInfo& functionInfo = globalData.GetFunctionInfo(functionName);
+        return ValidateResultAllowed(globalData.GetFunctionInfo(functionName), result);
+    }
+
+    bool ValidateResultAllowed(const FunctionInfo& functionInfo, XrResult result)
+    {
         const bool found =
             std::find(functionInfo.validResults.begin(), functionInfo.validResults.end(), result) != functionInfo.validResults.end();
         return found;
@@ -305,7 +336,14 @@ namespace Conformance
             debugInfo.next = createInfo.next;
             createInfo.next = &debugInfo;
         }
-        XrResult result = xrCreateInstance(&createInfo, instance);
+        // Most instances go on to create a session, so start on the part of its graphics device that needs no instance.
+        globalData.PrepareSessionGraphicsDevice();
+
+        XrResult result;
+        {
+            ScopedStartupPhase timing(StartupPhase::CreateInstance);
+            result = xrCreateInstance(&createInfo, instance);
+        }
         if (XR_FAILED(result)) {
             *instance = XR_NULL_HANDLE;
         }
@@ -379,6 +417,204 @@ namespace Conformance
         }
     }
 
+    namespace
+    {
+        /// The fixtures handed out by GetSharedAutoBasicInstance and GetSharedAutoBasicSession. The loader allows one
+        /// XrInstance at a time, so there is at most one shared instance, and the shared session is created on it.
+        struct SharedAutoBasicFixtures
+        {
+            int instanceFlags{0};
+            std::unique_ptr<AutoBasicInstance> instance;
+            /// Child handles of the instance when it was last handed out, if the conformance layer can count them.
+            uint32_t instanceChildCount{0};
+
+            int sessionFlags{0};
+            std::unique_ptr<AutoBasicSession> session;
+            uint32_t sessionChildCount{0};
+            /// Set when a drained event shows the shared session left the state it was handed out in.
+            bool sessionStateChanged{false};
+        };
+
+        SharedAutoBasicFixtures& GetSharedAutoBasicFixtures()
+        {
+            static SharedAutoBasicFixtures fixtures;
+            return fixtures;
+        }
+
+        /// Implemented by the conformance layer, see ConformanceLayer_GetChildHandleCount. Not an OpenXR command.
+        typedef XrResult(XRAPI_PTR* PFN_ConformanceLayerGetChildHandleCount)(uint64_t handle, XrObjectType objectType,
+                                                                               uint32_t* childCount);
+
+        /// Counts the child handles the conformance layer tracks for @p handle. Returns false if the layer is not enabled.
+        bool GetChildHandleCount(XrInstance instance, uint64_t handle, XrObjectType objectType, uint32_t* childCount)
+        {
+            PFN_ConformanceLayerGetChildHandleCount getChildHandleCount = nullptr;
+            if (XR_FAILED(xrGetInstanceProcAddr(instance, "xrConformanceLayerGetChildHandleCount",
+                                                reinterpret_cast<PFN_xrVoidFunction*>(&getChildHandleCount))) ||
+                getChildHandleCount == nullptr) {
+                return false;
+            }
+            XRC_CHECK_THROW_XRCMD(getChildHandleCount(handle, objectType, childCount));
+            return true;
+        }
+
+        /// Returns an empty string if @p handle has as many child handles as when it was handed out, or else why not.
+        std::string CheckChildHandleCount(XrInstance instance, uint64_t handle, XrObjectType objectType, const char* what,
+                                          uint32_t expectedChildCount)
+        {
+            uint32_t childCount = 0;
+            if (!GetChildHandleCount(instance, handle, objectType, &childCount) || childCount == expectedChildCount) {
+                return {};
+            }
+            std::ostringstream oss;
+            oss << "The shared " << what << " has " << childCount << " child handle(s), but had " << expectedChildCount
+                << " when it was handed out.";
+            return oss.str();
+        }
+
+        /// Records the child handles of the shared fixtures, as the baseline for the next check.
+        void RecordSharedChildHandleCounts(SharedAutoBasicFixtures& fixtures)
+        {
+            XrInstance instance = fixtures.instance->GetInstance();
+            (void)GetChildHandleCount(instance, MakeHandleGeneric(instance), XR_OBJECT_TYPE_INSTANCE, &fixtures.instanceChildCount);
+            if (fixtures.session) {
+                (void)GetChildHandleCount(instance, MakeHandleGeneric(fixtures.session->GetSession()), XR_OBJECT_TYPE_SESSION,
+                                          &fixtures.sessionChildCount);
+            }
+        }
+
+        /// Drains the events the previous user left queued. Returns false if the instance was lost and must be recreated.
+        bool PrepareSharedInstanceForReuse(SharedAutoBasicFixtures& fixtures)
+        {
+            for (;;) {
+                XrEventDataBuffer eventData{XR_TYPE_EVENT_DATA_BUFFER};
+                XrResult result = xrPollEvent(fixtures.instance->GetInstance(), &eventData);
+                if (result == XR_EVENT_UNAVAILABLE) {
+                    return true;
+                }
+                if (result == XR_ERROR_INSTANCE_LOST) {
+                    return false;
+                }
+                XRC_CHECK_THROW_XRCMD(result);
+                if (eventData.type == XR_TYPE_EVENT_DATA_INSTANCE_LOSS_PENDING) {
+                    return false;
+                }
+                if (eventData.type == XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED && fixtures.session) {
+                    // A shared session is never begun, so it only ever becomes idle and then ready.
+                    auto stateChanged = reinterpret_cast<const XrEventDataSessionStateChanged*>(&eventData);
+                    if (stateChanged->session == fixtures.session->GetSession() && stateChanged->state != XR_SESSION_STATE_IDLE &&
+                        stateChanged->state != XR_SESSION_STATE_READY) {
+                        fixtures.sessionStateChanged = true;
+                    }
+                }
+            }
+        }
+
+        /// Checks that the previous user left the shared fixtures as it found them.
+        /// Returns an empty string if so, or else why not.
+        std::string CheckSharedAutoBasicFixtures(SharedAutoBasicFixtures& fixtures)
+        {
+            if (!fixtures.instance) {
+                return {};
+            }
+            // Only the wrapper says whether the handle is still ours: polling a destroyed handle is undefined.
+            if (!fixtures.instance->IsValidHandle() || !PrepareSharedInstanceForReuse(fixtures)) {
+                return "The shared instance was destroyed or lost.";
+            }
+            XrInstance instance = fixtures.instance->GetInstance();
+            if (fixtures.session) {
+                if (fixtures.sessionStateChanged) {
+                    return "The shared session was begun, or its state changed for another reason.";
+                }
+                std::string problem = CheckChildHandleCount(instance, MakeHandleGeneric(fixtures.session->GetSession()),
+                                                            XR_OBJECT_TYPE_SESSION, "session", fixtures.sessionChildCount);
+                if (!problem.empty()) {
+                    return problem;
+                }
+            }
+            return CheckChildHandleCount(instance, MakeHandleGeneric(instance), XR_OBJECT_TYPE_INSTANCE, "instance",
+                                         fixtures.instanceChildCount);
+        }
+
+        void ReleaseSharedAutoBasicSession(SharedAutoBasicFixtures& fixtures)
+        {
+            fixtures.session.reset();
+            fixtures.sessionFlags = 0;
+            fixtures.sessionChildCount = 0;
+            fixtures.sessionStateChanged = false;
+        }
+
+        void ReleaseSharedAutoBasicFixtures(SharedAutoBasicFixtures& fixtures)
+        {
+            // The session is a child of the instance, so it goes first.
+            ReleaseSharedAutoBasicSession(fixtures);
+            fixtures.instance.reset();
+            fixtures.instanceFlags = 0;
+            fixtures.instanceChildCount = 0;
+        }
+
+        /// Recreates the shared fixtures if the previous user did not leave them as it found them.
+        void PrepareSharedAutoBasicFixturesForReuse(SharedAutoBasicFixtures& fixtures)
+        {
+            std::string problem = CheckSharedAutoBasicFixtures(fixtures);
+            if (!problem.empty()) {
+                WARN(problem << " Recreating the shared instance and session.");
+                ReleaseSharedAutoBasicFixtures(fixtures);
+            }
+        }
+
+        AutoBasicInstance& GetSharedAutoBasicInstance(SharedAutoBasicFixtures& fixtures, int optionFlags)
+        {
+            PrepareSharedAutoBasicFixturesForReuse(fixtures);
+            if (fixtures.instance && fixtures.instanceFlags != optionFlags) {
+                // Make room for the instance asked for.
+                ReleaseSharedAutoBasicFixtures(fixtures);
+            }
+            if (!fixtures.instance) {
+                fixtures.instance = std::make_unique<AutoBasicInstance>(optionFlags);
+                fixtures.instanceFlags = optionFlags;
+                RecordSharedChildHandleCounts(fixtures);
+            }
+            return *fixtures.instance;
+        }
+    }  // namespace
+
+    AutoBasicInstance& GetSharedAutoBasicInstance(int optionFlags)
+    {
+        return GetSharedAutoBasicInstance(GetSharedAutoBasicFixtures(), optionFlags);
+    }
+
+    AutoBasicSession& GetSharedAutoBasicSession(int optionFlags)
+    {
+        if ((optionFlags & AutoBasicSession::beginSession) != 0) {
+            throw std::logic_error("A shared session cannot be begun: its state would not be the same for the next user");
+        }
+        optionFlags |= AutoBasicSession::createSession;
+
+        SharedAutoBasicFixtures& fixtures = GetSharedAutoBasicFixtures();
+        AutoBasicInstance& instance = GetSharedAutoBasicInstance(fixtures, 0);
+        if (fixtures.session && fixtures.sessionFlags != optionFlags) {
+            ReleaseSharedAutoBasicSession(fixtures);
+        }
+        if (!fixtures.session) {
+            fixtures.session = std::make_unique<AutoBasicSession>(optionFlags, instance.GetInstance());
+            fixtures.sessionFlags = optionFlags;
+            RecordSharedChildHandleCounts(fixtures);
+        }
+        return *fixtures.session;
+    }
+
+    bool ReleaseSharedAutoBasicFixtures()
+    {
+        SharedAutoBasicFixtures& fixtures = GetSharedAutoBasicFixtures();
+        std::string problem = CheckSharedAutoBasicFixtures(fixtures);
+        if (!problem.empty()) {
+            ReportF("%s", problem.c_str());
+        }
+        ReleaseSharedAutoBasicFixtures(fixtures);
+        return problem.empty();
+    }
+
     bool AutoBasicInstance::operator==(NullHandleType const& /*unused*/) const
     {
         return !IsValidHandle();
@@ -393,6 +629,7 @@ namespace Conformance
     {
         XrSystemGetInfo systemGetInfo{XR_TYPE_SYSTEM_GET_INFO};
         systemGetInfo.formFactor = GetGlobalData().options.formFactorValue;
+        ScopedStartupPhase timing(StartupPhase::GetSystem);
         return xrGetSystem(instance, &systemGetInfo, systemId);
     }
 
@@ -413,7 +650,12 @@ namespace Conformance
                 // If the following fails then this app has a bug, not the runtime.
                 assert(graphicsPlugin->IsInitialized());
 
-                if (!graphicsPlugin->InitializeDevice(instance, *systemId)) {
+                bool deviceInitialized;
+                {
+                    ScopedStartupPhase timing(StartupPhase::InitializeDevice);
+                    deviceInitialized = globalData.InitializeSessionGraphicsDevice(instance, *systemId);
+                }
+                if (!deviceInitialized) {
                     // This isn't real. It may mislead this test if encountered. We have to decide our policy in this.
                     return XR_ERROR_RUNTIME_FAILURE;
                 }
@@ -431,6 +673,7 @@ namespace Conformance
             sessionCreateInfo.next = graphicsBinding;
             sessionCreateInfo.createFlags = 0;
             sessionCreateInfo.systemId = *systemId;
+            ScopedStartupPhase timing(StartupPhase::CreateSession);
             result = xrCreateSession(instance, &sessionCreateInfo, session);
         }
 
@@ -500,19 +743,31 @@ namespace Conformance
                 BeginSession();
             }
 
-            // Set up the enumerated types
-            XRC_CHECK_THROW_XRCMD(doTwoCallInPlace(swapchainFormatVector, xrEnumerateSwapchainFormats, session));
+            // Set up the enumerated types, from the runtime capabilities snapshot where it has them.
+            if (enableGraphics && globalData.IsUsingGraphicsPlugin()) {
+                swapchainFormatVector = globalData.GetSwapchainFormats(session);
+            }
+            else {
+                XRC_CHECK_THROW_XRCMD(doTwoCallInPlace(swapchainFormatVector, xrEnumerateSwapchainFormats, session));
+            }
             XRC_CHECK_THROW_XRCMD(doTwoCallInPlace(spaceTypeVector, xrEnumerateReferenceSpaces, session));
             XRC_CHECK_THROW_XRCMD(xrStringToPath(instance, "/user/hand/left", &handSubactionArray[0]));
             XRC_CHECK_THROW_XRCMD(xrStringToPath(instance, "/user/hand/right", &handSubactionArray[1]));
 
             // We use viewConfigurationType as the type we enumerate with, despite that the runtime may support others.
-            XRC_CHECK_THROW_XRCMD(doTwoCallInPlaceWithEmptyElement(viewConfigurationViewVector, {XR_TYPE_VIEW_CONFIGURATION_VIEW},
-                                                                   xrEnumerateViewConfigurationViews, instance, systemId,
-                                                                   viewConfigurationType));
+            const RuntimeCapabilities& capabilities = globalData.GetRuntimeCapabilities();
+            if (viewConfigurationType == capabilities.viewConfigurationType) {
+                viewConfigurationViewVector = capabilities.viewConfigurationViews;
+                environmentBlendModeVector = capabilities.environmentBlendModes;
+            }
+            else {
+                XRC_CHECK_THROW_XRCMD(doTwoCallInPlaceWithEmptyElement(viewConfigurationViewVector, {XR_TYPE_VIEW_CONFIGURATION_VIEW},
+                                                                       xrEnumerateViewConfigurationViews, instance, systemId,
+                                                                       viewConfigurationType));
 
-            XRC_CHECK_THROW_XRCMD(
-                doTwoCallInPlace(environmentBlendModeVector, xrEnumerateEnvironmentBlendModes, instance, systemId, viewConfigurationType));
+                XRC_CHECK_THROW_XRCMD(doTwoCallInPlace(environmentBlendModeVector, xrEnumerateEnvironmentBlendModes, instance, systemId,
+                                                       viewConfigurationType));
+            }
 
             if ((optionFlags & createSwapchains) && globalData.IsUsingGraphicsPlugin()) {
                 auto graphicsPlugin = globalData.GetGraphicsPlugin();
@@ -566,10 +821,12 @@ namespace Conformance
         auto timeoutToTransitionToSessionState = (GetGlobalData().options.debugMode ? 60s : 10s);
         CountdownTimer countdownTimer(timeoutToTransitionToSessionState);
 
-        while ((sessionState != XR_SESSION_STATE_READY) && (!countdownTimer.IsTimeUp())) {
-            XrEventDataBuffer eventBuffer;
-            while (m_privateEventReader->TryReadNext(eventBuffer)) {
-                if (eventBuffer.type == XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED) {
+        {
+            ScopedStartupPhase timing(StartupPhase::WaitSessionReady);
+            while ((sessionState != XR_SESSION_STATE_READY) && (!countdownTimer.IsTimeUp())) {
+                XrEventDataBuffer eventBuffer;
+                if (m_privateEventReader->WaitForEvent(eventBuffer, XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED,
+                                                       countdownTimer.Remaining())) {
                     XrEventDataSessionStateChanged sessionStateChanged;
                     memcpy(&sessionStateChanged, &eventBuffer, sizeof(sessionStateChanged));
                     sessionState = sessionStateChanged.state;
@@ -605,7 +862,10 @@ namespace Conformance
         XrSessionBeginInfo sessionBeginInfo{XR_TYPE_SESSION_BEGIN_INFO,
                                             globalData.GetPlatformPlugin()->PopulateNextFieldForStruct(XR_TYPE_SESSION_BEGIN_INFO),
                                             viewConfigurationType};
-        XRC_CHECK_THROW_XRCMD(xrBeginSession(session, &sessionBeginInfo));
+        {
+            ScopedStartupPhase timing(StartupPhase::BeginSession);
+            XRC_CHECK_THROW_XRCMD(xrBeginSession(session, &sessionBeginInfo));
+        }
 
         // We potentially changed the view configuration so we need to update the viewConfigurationViewVector
         XRC_CHECK_THROW_XRCMD(doTwoCallInPlaceWithEmptyElement(viewConfigurationViewVector, {XR_TYPE_VIEW_CONFIGURATION_VIEW},
@@ -649,7 +909,7 @@ namespace Conformance
             if (globalData.IsUsingGraphicsPlugin()) {
                 auto graphicsPlugin = globalData.GetGraphicsPlugin();
                 if (graphicsPlugin->IsInitialized()) {
-                    graphicsPlugin->ShutdownDevice();
+                    globalData.ShutdownSessionGraphicsDevice();
                 }
             }
         }
@@ -968,6 +1228,25 @@ namespace Conformance
         return true;
     }
 
+    bool WaitUntilPredicateWithTimeout(const std::function<bool()>& predicate, const std::chrono::nanoseconds timeout,
+                                       const EventQueue& eventQueue)
+    {
+        const auto timeoutTime = std::chrono::steady_clock::now() + timeout;
+
+        for (;;) {
+            // Sample the change count first, so that anything arriving while the predicate runs wakes us straight away.
+            const uint64_t changeCount = eventQueue.GetChangeCount();
+            if (predicate()) {
+                return true;
+            }
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= timeoutTime) {
+                return false;
+            }
+            eventQueue.WaitForChange(changeCount, timeoutTime - now);
+        }
+    }
+
     XrResult GetAvailableAPILayers(std::vector<XrApiLayerProperties>& availableAPILayers)
     {
         availableAPILayers.clear();
@@ -1004,6 +1283,15 @@ namespace Conformance
     {
         GlobalData& globalData = GetGlobalData();
 
+        // Extension names are case sensitive when the instance is created, so once Initialize has succeeded the enabled
+        // names match the registry spelling and a known name can be answered from the feature bits.
+        if (globalData.IsInitialized()) {
+            FeatureBitIndex bit = FeatureNameToBitIndex(extensionName);
+            if (bit != FeatureBitIndex::FEATURE_COUNT) {
+                return globalData.IsInstanceExtensionEnabled(bit);
+            }
+        }
+
         auto caseInsensitivePredicate = [&extensionName](const std::string& str) -> bool { return striequal(extensionName, str.c_str()); };
 
         auto it = std::find_if(globalData.enabledInstanceExtensionNames.begin(), globalData.enabledInstanceExtensionNames.end(),
@@ -1014,7 +1302,13 @@ namespace Conformance
 
     bool IsInstanceExtensionEnabled(uint64_t extensionNumber)
     {
-        auto& map = GetNumberExtensionMap();
+        GlobalData& globalData = GetGlobalData();
+        if (globalData.IsInitialized()) {
+            FeatureBitIndex bit = ExtensionNumberToBitIndex(extensionNumber);
+            return bit != FeatureBitIndex::FEATURE_COUNT && globalData.IsInstanceExtensionEnabled(bit);
+        }
+
+        const auto& map = GetNumberExtensionMap();
         auto it = map.find(extensionNumber);
         if (it == map.end()) {
             return false;
@@ -1034,18 +1328,37 @@ namespace Conformance
         return (it != globalData.enabledInteractionProfiles.end());
     }
 
-    bool IsExtensionFunctionEnabled(const char* functionName)
+    const FunctionInfo* FindFunctionInfo(const char* functionName)
     {
-        const FunctionInfoMap& functionInfoMap = GetFunctionInfoMap();
+        using NameAndInfo = std::pair<const char*, const FunctionInfo*>;
 
-        auto it = functionInfoMap.find(functionName);
+        // The map is immutable, so its keys can be indexed once, by pointer, and searched with strcmp.
+        static const std::vector<NameAndInfo> sortedFunctionInfo = [] {
+            std::vector<NameAndInfo> ret;
+            for (const auto& entry : GetFunctionInfoMap()) {
+                ret.emplace_back(entry.first.c_str(), &entry.second);
+            }
+            std::sort(ret.begin(), ret.end(), [](const NameAndInfo& a, const NameAndInfo& b) { return strcmp(a.first, b.first) < 0; });
+            return ret;
+        }();
+
+        auto it = std::lower_bound(sortedFunctionInfo.begin(), sortedFunctionInfo.end(), functionName,
+                                   [](const NameAndInfo& entry, const char* name) { return strcmp(entry.first, name) < 0; });
+        if (it == sortedFunctionInfo.end() || strcmp(it->first, functionName) != 0) {
+            return nullptr;
+        }
+        return it->second;
+    }
+
+    bool IsExtensionFunctionEnabled(const char* functionName)
+    {
+        const FunctionInfo* functionInfo = FindFunctionInfo(functionName);
 
-        if (it != functionInfoMap.end()) {
-            const FunctionInfo& functionInfo = it->second;
-            return IsInstanceExtensionEnabled(functionInfo.requiredExtension);
+        if (functionInfo != nullptr && functionInfo->requiredExtension != nullptr) {
+            return IsInstanceExtensionEnabled(functionInfo->requiredExtension);
         }
 
-        return false;  // Function is unknown. Was it case-mismatched?
+        return false;  // Function is unknown (was it case-mismatched?) or part of the core API.
     }
 
     bool IsViewConfigurationTypeEnumValid(XrViewConfigurationType viewType)
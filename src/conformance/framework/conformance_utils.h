@@ -22,6 +22,7 @@
 
 #include <openxr/openxr.h>
 
+#include <algorithm>
 #include <array>
 #include <chrono>
 #include <cstdint>
@@ -50,6 +51,9 @@ namespace Conformance
     ///
     std::string PathToString(XrInstance instance, XrPath path);
 
+    /// Unit to report an XR_META_performance_metrics counter value in, with ReportMetric.
+    const char* PerformanceMetricsCounterUnitName(XrPerformanceMetricsCounterUnitMETA unit);
+
     /// ValidateResultAllowed
     ///
     /// Returns true if the given function (e.g. "xrPollEvent") may return the given result (e.g. XR_ERROR_PATH_INVALID).
@@ -441,6 +445,12 @@ namespace Conformance
             return (stopwatch.Elapsed() >= timeoutDuration);
         }
 
+        /// Time left before @ref IsTimeUp returns true, or zero if it already does.
+        std::chrono::nanoseconds Remaining() const
+        {
+            return std::max(timeoutDuration - stopwatch.Elapsed(), std::chrono::nanoseconds::zero());
+        }
+
     private:
         Stopwatch stopwatch;
         std::chrono::nanoseconds timeoutDuration;
@@ -529,6 +539,22 @@ namespace Conformance
     /// @relates AutoBasicInstance
     std::ostream& operator<<(std::ostream& os, AutoBasicInstance const& inst);
 
+    /// Returns an AutoBasicInstance that is kept for the rest of the test case, so that each section run of the
+    /// test case reuses it instead of creating and destroying an instance of its own.
+    ///
+    /// Only for tests that do not depend on a fresh instance: they must destroy every child handle they create,
+    /// must not destroy the instance, must not create another instance, and must not rely on which events are queued.
+    /// The loader allows one instance at a time, so asking for other @p optionFlags replaces the shared instance.
+    /// Before handing the instance out again, pending events are drained, and the conformance layer (if enabled) is asked
+    /// whether the instance has child handles left alive. If it does, or the runtime reported the instance lost or
+    /// pending loss, the instance is recreated.
+    ///
+    /// Example usage:
+    /// ```
+    /// AutoBasicInstance& instance = GetSharedAutoBasicInstance(AutoBasicInstance::createSystemId);
+    /// ```
+    AutoBasicInstance& GetSharedAutoBasicInstance(int optionFlags = 0);
+
     /// Finds an XrSystemId suitable for testing of additional functionality.
     XrResult FindBasicSystem(XrInstance instance, XrSystemId* systemId);
 
@@ -677,6 +703,19 @@ namespace Conformance
     /// @relates AutoBasicSession
     std::ostream& operator<<(std::ostream& os, AutoBasicSession const& sess);
 
+    /// Returns an AutoBasicSession, created on the instance from GetSharedAutoBasicInstance, that is kept for the rest
+    /// of the test case in the same way. AutoBasicSession::createSession is implied, and AutoBasicSession::beginSession is
+    /// not allowed.
+    ///
+    /// Only for tests that do not depend on a fresh session: they must destroy every child handle they create, and must
+    /// not begin or destroy the session. Before handing the session out again, it is recreated if it changed state past
+    /// XR_SESSION_STATE_READY or if the conformance layer (if enabled) reports child handles left alive.
+    AutoBasicSession& GetSharedAutoBasicSession(int optionFlags = AutoBasicSession::createSession);
+
+    /// Destroys the shared session and instance, if any. Called at the end of each test case and of the test run.
+    /// Returns false, and reports why, if they were not left as they were handed out.
+    bool ReleaseSharedAutoBasicFixtures();
+
     /// Calls your @p predicate repeatedly, pausing @p delay in between, until either it returns `true` or @p timeout has elapsed.
     ///
     /// @note This does not inherently submit frames and is thus likely to cause problems if a session is running unless your predicate submits a frame!
@@ -684,6 +723,14 @@ namespace Conformance
     bool WaitUntilPredicateWithTimeout(const std::function<bool()>& predicate, const std::chrono::nanoseconds timeout,
                                        const std::chrono::nanoseconds delay);
 
+    /// Calls your @p predicate, then again each time an event arrives in @p eventQueue or @ref EventQueue::Notify is called,
+    /// until either it returns `true` or @p timeout has elapsed.
+    ///
+    /// Unlike the fixed-delay overload this wakes as soon as there is something new for the predicate to look at,
+    /// so prefer it whenever the predicate depends only on events (or on frames whose submission notifies the queue).
+    bool WaitUntilPredicateWithTimeout(const std::function<bool()>& predicate, const std::chrono::nanoseconds timeout,
+                                       const EventQueue& eventQueue);
+
     /// Identifies conformance-related information about individual OpenXR functions.
     struct FunctionInfo
     {
@@ -703,6 +750,15 @@ namespace Conformance
     /// Accessor for the FunctionInfoMap singleton.
     const FunctionInfoMap& GetFunctionInfoMap();
 
+    /// Returns the FunctionInfo for @p functionName (case-sensitive), or nullptr if the function is unknown.
+    /// Unlike looking the name up in GetFunctionInfoMap(), this does not allocate: it binary searches a name-sorted
+    /// index built on first use.
+    const FunctionInfo* FindFunctionInfo(const char* functionName);
+
+    /// Same as ValidateResultAllowed(const char*, XrResult), for callers that looked up @p functionInfo once
+    /// (for example with FindFunctionInfo) and check many results against it.
+    bool ValidateResultAllowed(const FunctionInfo& functionInfo, XrResult result);
+
     /// Returns true if the extension name is in the list (case-insensitive) of extensions that are
     /// enabled by default for instance creation (GlobalData::Options::enabledInstanceExtensionNames).
     bool IsInstanceExtensionEnabled(const char* extensionName);
@@ -61,19 +61,17 @@ namespace Conformance
     }
 
     // Update transforms of nodes for the animatable parts in the controller model
-    void ControllerAnimationHandler::UpdateControllerParts(const std::vector<XrControllerModelNodeStateMSFT>& nodeStates,
+    void ControllerAnimationHandler::UpdateControllerParts(nonstd::span<const XrControllerModelNodeStateMSFT> nodeStates,
                                                            Pbr::ModelInstance& pbrModelInstance)
     {
-        m_nodeStates = nodeStates;
-
-        assert(m_nodeStates.size() == m_nodeIndices.size());
-        const size_t end = std::min(m_nodeStates.size(), m_nodeIndices.size());
+        assert(nodeStates.size() == m_nodeIndices.size());
+        const size_t end = std::min((size_t)nodeStates.size(), m_nodeIndices.size());
         for (size_t i = 0; i < end; i++) {
             const Pbr::NodeIndex_t nodeIndex = m_nodeIndices[i];
             if (nodeIndex != Pbr::NodeIndex_npos) {
                 XrVector3f unitScale = {1, 1, 1};
-                XrMatrix4x4f nodeTransform = Matrix::FromTranslationRotationScale(m_nodeStates[i].nodePose.position,
-                                                                                  m_nodeStates[i].nodePose.orientation, unitScale);
+                XrMatrix4x4f nodeTransform = Matrix::FromTranslationRotationScale(nodeStates[i].nodePose.position,
+                                                                                  nodeStates[i].nodePose.orientation, unitScale);
                 pbrModelInstance.SetNodeTransform(nodeIndex, nodeTransform);
             }
         }
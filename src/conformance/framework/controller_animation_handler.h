@@ -13,6 +13,7 @@
 #include "pbr/PbrCommon.h"
 #include "pbr/PbrModel.h"
 
+#include <nonstd/span.hpp>
 #include <openxr/openxr.h>
 
 #include <memory>
@@ -32,12 +33,15 @@ namespace Conformance
         ControllerAnimationHandler(const Pbr::Model& model, std::vector<XrControllerModelNodePropertiesMSFT>&& properties);
 
         void Init(const Pbr::Model& model, std::vector<XrControllerModelNodePropertiesMSFT>&& properties);
-        void UpdateControllerParts(const std::vector<XrControllerModelNodeStateMSFT>& nodeStates, Pbr::ModelInstance& pbrModelInstance);
+
+        /// Apply the node poses reported by xrGetControllerModelStateMSFT, in the order of the node properties, to the model instance.
+        /// Reads @p nodeStates in place, so a query buffer reused every frame keeps updates free of allocations, and nodes whose
+        /// pose did not change are not re-resolved.
+        void UpdateControllerParts(nonstd::span<const XrControllerModelNodeStateMSFT> nodeStates, Pbr::ModelInstance& pbrModelInstance);
 
     private:
         static Pbr::NodeIndex_t FindPbrNodeIndex(const Pbr::Model& model, const char* parentNodeName, const char* nodeName);
         std::vector<Pbr::NodeIndex_t> m_nodeIndices;
         std::vector<XrControllerModelNodePropertiesMSFT> m_nodeProperties;
-        std::vector<XrControllerModelNodeStateMSFT> m_nodeStates;
     };
 }  // namespace Conformance
@@ -0,0 +1,81 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "controller_model_loader.h"
+
+#include "gltf_helpers.h"
+#include "utilities/throw_helpers.h"
+
+#include <chrono>
+#include <utility>
+
+namespace Conformance
+{
+    ControllerModelLoader::ControllerModelLoader(XrSession session, PFN_xrLoadControllerModelMSFT xrLoadControllerModelMSFT,
+                                                 IGraphicsPlugin& graphicsPlugin)
+        : m_session(session)
+        , m_xrLoadControllerModelMSFT(xrLoadControllerModelMSFT)
+        , m_graphicsPlugin(graphicsPlugin)
+        , m_supportedTextureFormats(graphicsPlugin.GetSupportedTextureFormats())
+    {
+    }
+
+    ControllerModelLoader::~ControllerModelLoader()
+    {
+        // Futures from std::async block on destruction, but be explicit that the workers must not outlive the session.
+        for (auto& load : m_loads) {
+            if (load.second.modelBuilder.valid()) {
+                load.second.modelBuilder.wait();
+            }
+        }
+    }
+
+    void ControllerModelLoader::Request(XrControllerModelKeyMSFT modelKey)
+    {
+        if (m_loads.count(modelKey) != 0) {
+            return;
+        }
+
+        auto loadModel = [session = m_session, xrLoadControllerModelMSFT = m_xrLoadControllerModelMSFT, modelKey,
+                          supportedFormats = m_supportedTextureFormats]() -> Gltf::ModelBuilder {
+            uint32_t modelBufferSize = 0;
+            XRC_CHECK_THROW_XRCMD(xrLoadControllerModelMSFT(session, modelKey, 0, &modelBufferSize, nullptr));
+            std::vector<uint8_t> modelBuffer(modelBufferSize);
+            XRC_CHECK_THROW_XRCMD(xrLoadControllerModelMSFT(session, modelKey, modelBufferSize, &modelBufferSize, modelBuffer.data()));
+
+            // Parsing, tangent generation and image decoding are what take a while, and none of them need the device.
+            Gltf::ModelBuilder modelBuilder = MakeModelBuilder(LoadGLTF(modelBuffer));
+            modelBuilder.DecodeImages(supportedFormats);
+            return modelBuilder;
+        };
+        m_loads[modelKey].modelBuilder = std::async(std::launch::async, std::move(loadModel));
+    }
+
+    bool ControllerModelLoader::TryGetModel(XrControllerModelKeyMSFT modelKey, GLTFModelHandle* model)
+    {
+        Request(modelKey);
+        Load& load = m_loads[modelKey];
+        if (load.modelBuilder.valid()) {
+            if (load.modelBuilder.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                return false;
+            }
+            load.model = m_graphicsPlugin.LoadGLTF(load.modelBuilder.get());
+        }
+        *model = load.model;
+        return true;
+    }
+}  // namespace Conformance
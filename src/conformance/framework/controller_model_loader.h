@@ -0,0 +1,70 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include "graphics_plugin.h"
+
+#include <openxr/openxr.h>
+
+#include <future>
+#include <map>
+#include <vector>
+
+namespace Conformance
+{
+    /// Loads the models of XR_MSFT_controller_model controllers without stalling the frame loop.
+    ///
+    /// Fetching the GLB with xrLoadControllerModelMSFT, parsing it and decoding its images happen on a worker thread
+    /// per model key. Only creating the GPU resources, which the graphics plugins do not support off the thread using
+    /// the device, is left to @ref TryGetModel, called from the frame loop. Model keys are only valid within their
+    /// session, so the loads are per session too: what carries over to later sessions is the process-wide cache of
+    /// LoadGLTF, keyed by the content of the GLB, and the reuse of a device's resources for a model loaded before.
+    class ControllerModelLoader
+    {
+    public:
+        ControllerModelLoader(XrSession session, PFN_xrLoadControllerModelMSFT xrLoadControllerModelMSFT,
+                              IGraphicsPlugin& graphicsPlugin);
+
+        /// Waits for any loads still running.
+        ~ControllerModelLoader();
+
+        ControllerModelLoader(const ControllerModelLoader&) = delete;
+        ControllerModelLoader& operator=(const ControllerModelLoader&) = delete;
+
+        /// Start loading the model of @p modelKey on a worker thread, unless it has been requested before.
+        void Request(XrControllerModelKeyMSFT modelKey);
+
+        /// Once the model of @p modelKey has been loaded, create its GPU resources the first time this is called for it,
+        /// set @p model and return true. Returns false while it is still loading.
+        /// Requests the model if it has not been requested yet, and rethrows anything thrown while loading it.
+        bool TryGetModel(XrControllerModelKeyMSFT modelKey, GLTFModelHandle* model);
+
+    private:
+        struct Load
+        {
+            std::future<Gltf::ModelBuilder> modelBuilder;
+            GLTFModelHandle model;
+        };
+
+        XrSession m_session;
+        PFN_xrLoadControllerModelMSFT m_xrLoadControllerModelMSFT;
+        IGraphicsPlugin& m_graphicsPlugin;
+        std::vector<Conformance::Image::FormatParams> m_supportedTextureFormats;
+        std::map<XrControllerModelKeyMSFT, Load> m_loads;
+    };
+}  // namespace Conformance
@@ -0,0 +1,51 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dynamic_resolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Conformance
+{
+    DynamicResolutionController::DynamicResolutionController(const Settings& settings)
+        : m_settings(settings), m_scale(settings.maxScale)
+    {
+    }
+
+    void DynamicResolutionController::Update(std::chrono::nanoseconds gpuTime, XrDuration displayPeriod)
+    {
+        if (gpuTime.count() <= 0 || displayPeriod <= 0) {
+            return;
+        }
+
+        // GPU time goes roughly with the pixel count, so with the square of the scale of each dimension.
+        const double target = m_settings.targetFrameFraction * (double)displayPeriod;
+        const double idealScale = m_scale * std::sqrt(target / (double)gpuTime.count());
+        const double scale = m_scale + m_settings.gain * (idealScale - m_scale);
+        m_scale = std::min(std::max((float)scale, m_settings.minScale), m_settings.maxScale);
+    }
+
+    XrRect2Di DynamicResolutionController::GetImageRect(XrExtent2Di fullExtent) const
+    {
+        const auto scaleExtent = [&](int32_t extent) {
+            const int32_t granularity = std::max(m_settings.granularity, 1);
+            const int32_t scaled = (int32_t)(extent * m_scale) / granularity * granularity;
+            return std::min(std::max(scaled, std::min(granularity, extent)), extent);
+        };
+        return {{0, 0}, {scaleExtent(fullExtent.width), scaleExtent(fullExtent.height)}};
+    }
+}  // namespace Conformance
@@ -0,0 +1,60 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <openxr/openxr.h>
+
+#include <chrono>
+
+namespace Conformance
+{
+    /// Picks the fraction of its swapchain each view renders to, from the GPU time of the frames rendered so far, the way an
+    /// app doing dynamic resolution would: rendering to a shrinking or growing `imageRect` of a swapchain of fixed size.
+    class DynamicResolutionController
+    {
+    public:
+        struct Settings
+        {
+            /// Fraction of the display period the GPU time is steered towards
+            float targetFrameFraction{0.8f};
+            /// Smallest and largest scale of each dimension of the swapchain
+            float minScale{0.5f};
+            float maxScale{1.0f};
+            /// Fraction of the way to the scale that would meet the target taken each frame, to damp oscillation
+            float gain{0.25f};
+            /// Extents are rounded down to a multiple of this many pixels, so that small corrections do not change them
+            int32_t granularity{8};
+        };
+
+        explicit DynamicResolutionController(const Settings& settings);
+
+        /// Adjust the scale from the GPU time of a frame rendered at the current scale, given the display period.
+        void Update(std::chrono::nanoseconds gpuTime, XrDuration displayPeriod);
+
+        float GetScale() const
+        {
+            return m_scale;
+        }
+
+        /// The rect to render to at the current scale, anchored at the origin of a swapchain of @p fullExtent.
+        XrRect2Di GetImageRect(XrExtent2Di fullExtent) const;
+
+    private:
+        Settings m_settings;
+        float m_scale;
+    };
+}  // namespace Conformance
@@ -0,0 +1,98 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "frame_allocation_tracker.h"
+
+#include "conformance_framework.h"
+#include "utilities/allocation_counter.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace Conformance
+{
+    FrameAllocationTracker::FrameAllocationTracker(std::string name) : m_name(std::move(name))
+    {
+    }
+
+    void FrameAllocationTracker::SetBudget(int64_t allocations)
+    {
+        m_budget = allocations;
+    }
+
+    void FrameAllocationTracker::BeginFrame()
+    {
+        m_frameStartCount = GetThreadAllocationCount();
+        m_frameStartBytes = GetThreadAllocatedBytes();
+    }
+
+    void FrameAllocationTracker::EndFrame()
+    {
+        if (!IsAllocationCountingEnabled()) {
+            return;
+        }
+        if (m_warmupFramesLeft > 0) {
+            m_warmupFramesLeft--;
+            return;
+        }
+
+        const uint64_t count = GetThreadAllocationCount() - m_frameStartCount;
+        const uint64_t bytes = GetThreadAllocatedBytes() - m_frameStartBytes;
+        m_frameCount++;
+        m_allocationCount += count;
+        m_allocatedBytes += bytes;
+        m_maxFrameAllocationCount = std::max(m_maxFrameAllocationCount, count);
+        m_maxFrameAllocatedBytes = std::max(m_maxFrameAllocatedBytes, bytes);
+
+        if (m_budget >= 0 && count > uint64_t(m_budget)) {
+            // Fail once, not every frame of a loop that keeps allocating.
+            if (m_framesOverBudget++ == 0 && GetGlobalData().options.allocationBudgets) {
+                FAIL_CHECK(m_name << ": steady-state frame " << m_frameCount << " made " << count << " allocations ("
+                                  << bytes << " bytes), more than its budget of " << m_budget);
+            }
+        }
+    }
+
+    void FrameAllocationTracker::Report(const std::vector<MetricTag>& extraTags)
+    {
+        if (m_frameCount > 0) {
+            std::vector<MetricTag> tags{extraTags};
+            tags.push_back({"frames", std::to_string(m_frameCount)});
+            if (m_budget >= 0) {
+                tags.push_back({"budget", std::to_string(m_budget)});
+            }
+            const double frames = double(m_frameCount);
+            ReportMetric(m_name + ".allocationsPerFrame", double(m_allocationCount) / frames, "count", tags);
+            ReportMetric(m_name + ".maxAllocationsPerFrame", double(m_maxFrameAllocationCount), "count", tags);
+            ReportMetric(m_name + ".allocatedBytesPerFrame", double(m_allocatedBytes) / frames, "bytes", tags);
+            ReportMetric(m_name + ".maxAllocatedBytesPerFrame", double(m_maxFrameAllocatedBytes), "bytes", tags);
+            if (m_budget >= 0) {
+                ReportMetric(m_name + ".framesOverBudget", double(m_framesOverBudget), "count", tags);
+            }
+        }
+
+        m_warmupFramesLeft = WarmupFrames;
+        m_frameCount = 0;
+        m_allocationCount = 0;
+        m_allocatedBytes = 0;
+        m_maxFrameAllocationCount = 0;
+        m_maxFrameAllocatedBytes = 0;
+        m_framesOverBudget = 0;
+    }
+}  // namespace Conformance
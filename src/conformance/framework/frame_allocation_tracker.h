@@ -0,0 +1,101 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "report.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Conformance
+{
+    /// Tallies the heap allocations a frame loop makes on its thread, one frame at a time, to find CTS code that allocates
+    /// every frame and may cause hitches of its own.
+    ///
+    /// The first few frames are warm-up, in which caches fill and containers grow, and are not counted. A budget can be
+    /// declared for the rest, the steady-state frames: exceeding it fails the running test if Options::allocationBudgets is
+    /// set. Counts nothing in builds that do not count allocations, see IsAllocationCountingEnabled.
+    class FrameAllocationTracker
+    {
+    public:
+        /// Frames not counted after construction and after each Report.
+        static constexpr uint32_t WarmupFrames = 10;
+
+        /// @p name prefixes the metrics reported.
+        explicit FrameAllocationTracker(std::string name);
+
+        /// Allow at most @p allocations per steady-state frame. Negative to allow any number, the default.
+        void SetBudget(int64_t allocations);
+
+        /// Start counting a frame on the calling thread.
+        void BeginFrame();
+
+        /// Stop counting the frame started by BeginFrame, on the same thread.
+        void EndFrame();
+
+        /// Counts one frame from construction to destruction.
+        class Scope
+        {
+        public:
+            explicit Scope(FrameAllocationTracker& tracker) : m_tracker(tracker)
+            {
+                m_tracker.BeginFrame();
+            }
+            ~Scope()
+            {
+                m_tracker.EndFrame();
+            }
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            FrameAllocationTracker& m_tracker;
+        };
+
+        /// Number of steady-state frames counted since the last Report.
+        uint64_t GetFrameCount() const
+        {
+            return m_frameCount;
+        }
+
+        /// Number of steady-state frames since the last Report that allocated more than the budget.
+        uint64_t GetFramesOverBudget() const
+        {
+            return m_framesOverBudget;
+        }
+
+        /// Report the mean and most allocations and bytes of the steady-state frames since the last call as metrics of the
+        /// running test, with @p tags, then start over with warm-up frames. Reports nothing if there were none.
+        void Report(const std::vector<MetricTag>& tags = {});
+
+    private:
+        std::string m_name;
+        int64_t m_budget{-1};
+
+        uint32_t m_warmupFramesLeft{WarmupFrames};
+        uint64_t m_frameStartCount{0};
+        uint64_t m_frameStartBytes{0};
+
+        uint64_t m_frameCount{0};
+        uint64_t m_allocationCount{0};
+        uint64_t m_allocatedBytes{0};
+        uint64_t m_maxFrameAllocationCount{0};
+        uint64_t m_maxFrameAllocatedBytes{0};
+        uint64_t m_framesOverBudget{0};
+    };
+}  // namespace Conformance
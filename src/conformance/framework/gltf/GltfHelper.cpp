@@ -17,10 +17,14 @@
 #include <tinygltf/tiny_gltf.h>
 #include <mikktspace.h>
 
+#include <algorithm>
 #include <assert.h>
+#include <atomic>
 #include <cctype>
 #include <cstdint>
+#include <exception>
 #include <functional>
+#include <future>
 #include <iterator>
 #include <limits>
 #include <map>
@@ -28,6 +32,8 @@
 #include <stdexcept>
 #include <string.h>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 #define TRIANGLE_VERTEX_COUNT 3  // #define so it can be used in lambdas without capture
@@ -475,6 +481,158 @@ namespace
             throw std::runtime_error("Accessor for indices specifies invalid 'componentType'.");
         }
     }
+
+    // Size of the post-transform vertex cache that triangles are reordered for and that ACMR is measured with.
+    constexpr uint32_t VertexCacheSize = 16;
+
+    // Counts the vertices transformed drawing @p indices with a first-in first-out post-transform vertex cache.
+    uint64_t CountVertexTransforms(const std::vector<uint32_t>& indices, size_t vertexCount)
+    {
+        // Each vertex stays in the cache until VertexCacheSize more vertices have been transformed after it.
+        std::vector<uint64_t> transformedAt(vertexCount, 0);
+        uint64_t transforms = 0;
+        for (const uint32_t index : indices) {
+            if (transformedAt[index] == 0 || transforms - transformedAt[index] >= VertexCacheSize) {
+                transformedAt[index] = ++transforms;
+            }
+        }
+        return transforms;
+    }
+
+    // Points the indices of identical vertices at the first of them.
+    void MergeIdenticalVertices(GltfHelper::Primitive& primitive)
+    {
+        static_assert(sizeof(GltfHelper::Vertex) == 16 * sizeof(float), "Vertices are compared bytewise, so must have no padding");
+        const std::vector<GltfHelper::Vertex>& vertices = primitive.Vertices;
+        auto hashVertex = [&](uint32_t vertex) {
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&vertices[vertex]);
+            uint64_t hash = 14695981039346656037ull;
+            for (size_t i = 0; i < sizeof(GltfHelper::Vertex); i++) {
+                hash = (hash ^ bytes[i]) * 1099511628211ull;
+            }
+            return (size_t)hash;
+        };
+        auto equalVertices = [&](uint32_t a, uint32_t b) { return memcmp(&vertices[a], &vertices[b], sizeof(GltfHelper::Vertex)) == 0; };
+
+        std::unordered_map<uint32_t, uint32_t, decltype(hashVertex), decltype(equalVertices)> firstIdentical(vertices.size(), hashVertex,
+                                                                                                              equalVertices);
+        std::vector<uint32_t> remap(vertices.size());
+        for (uint32_t vertex = 0; vertex < (uint32_t)vertices.size(); vertex++) {
+            remap[vertex] = firstIdentical.emplace(vertex, vertex).first->second;
+        }
+        for (uint32_t& index : primitive.Indices) {
+            index = remap[index];
+        }
+    }
+
+    // Reorders triangles for a post-transform vertex cache of VertexCacheSize vertices with Tipsify (Sander, Nehab and Barczak, "Fast
+    // Triangle Reordering for Vertex Locality and Reduced Overdraw", 2007), which emits triangles in fans around vertices still in the
+    // cache. Scanned meshes often have triangles in an order with little locality.
+    std::vector<uint32_t> TipsifyIndices(const std::vector<uint32_t>& indices, size_t vertexCount)
+    {
+        // Triangles using each vertex, and how many of them are not emitted yet.
+        std::vector<uint32_t> liveTriangles(vertexCount, 0);
+        for (const uint32_t index : indices) {
+            liveTriangles[index]++;
+        }
+        std::vector<size_t> adjacencyOffsets(vertexCount + 1, 0);
+        for (size_t vertex = 0; vertex < vertexCount; vertex++) {
+            adjacencyOffsets[vertex + 1] = adjacencyOffsets[vertex] + liveTriangles[vertex];
+        }
+        std::vector<uint32_t> adjacency(indices.size());
+        {
+            std::vector<size_t> nextAdjacency(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (size_t i = 0; i < indices.size(); i++) {
+                adjacency[nextAdjacency[indices[i]]++] = uint32_t(i / 3);
+            }
+        }
+
+        std::vector<uint32_t> result;
+        result.reserve(indices.size());
+        std::vector<bool> emitted(indices.size() / 3, false);
+        // When each vertex was last transformed, counting transforms from VertexCacheSize + 1 so that 0 is never in the cache.
+        std::vector<uint64_t> cacheTime(vertexCount, 0);
+        uint64_t time = VertexCacheSize + 1;
+        // Vertices of emitted triangles, most recent last, to fan around next if there are no better candidates.
+        std::vector<uint32_t> deadEndStack;
+        std::vector<uint32_t> candidates;
+        size_t cursor = 0;
+        int64_t fanVertex = vertexCount > 0 ? 0 : -1;
+        while (fanVertex >= 0) {
+            // Emit the remaining triangles around the fan vertex.
+            candidates.clear();
+            for (size_t a = adjacencyOffsets[fanVertex]; a < adjacencyOffsets[fanVertex + 1]; a++) {
+                const uint32_t triangle = adjacency[a];
+                if (emitted[triangle]) {
+                    continue;
+                }
+                for (size_t corner = 0; corner < 3; corner++) {
+                    const uint32_t vertex = indices[triangle * 3 + corner];
+                    result.push_back(vertex);
+                    deadEndStack.push_back(vertex);
+                    candidates.push_back(vertex);
+                    liveTriangles[vertex]--;
+                    if (time - cacheTime[vertex] > VertexCacheSize) {
+                        cacheTime[vertex] = time++;
+                    }
+                }
+                emitted[triangle] = true;
+            }
+
+            // Fan around the candidate that will still be in the cache after its fan, and was transformed longest ago.
+            int64_t nextVertex = -1;
+            int64_t bestPriority = -1;
+            for (const uint32_t vertex : candidates) {
+                if (liveTriangles[vertex] == 0) {
+                    continue;
+                }
+                int64_t priority = 0;
+                if (time - cacheTime[vertex] + 2 * liveTriangles[vertex] <= VertexCacheSize) {
+                    priority = int64_t(time - cacheTime[vertex]);
+                }
+                if (priority > bestPriority) {
+                    bestPriority = priority;
+                    nextVertex = vertex;
+                }
+            }
+
+            // At a dead end, go back to a recently used vertex with triangles left, or else the next one in the input order.
+            while (nextVertex == -1 && !deadEndStack.empty()) {
+                const uint32_t vertex = deadEndStack.back();
+                deadEndStack.pop_back();
+                if (liveTriangles[vertex] > 0) {
+                    nextVertex = vertex;
+                }
+            }
+            while (nextVertex == -1 && cursor < vertexCount) {
+                if (liveTriangles[cursor] > 0) {
+                    nextVertex = int64_t(cursor);
+                }
+                else {
+                    cursor++;
+                }
+            }
+            fanVertex = nextVertex;
+        }
+        return result;
+    }
+
+    // Renumbers the vertices in the order the triangles first use them, dropping vertices no triangle uses.
+    void ReorderVerticesForFetch(GltfHelper::Primitive& primitive)
+    {
+        constexpr uint32_t Unused = std::numeric_limits<uint32_t>::max();
+        std::vector<uint32_t> remap(primitive.Vertices.size(), Unused);
+        std::vector<GltfHelper::Vertex> vertices;
+        vertices.reserve(primitive.Vertices.size());
+        for (uint32_t& index : primitive.Indices) {
+            if (remap[index] == Unused) {
+                remap[index] = (uint32_t)vertices.size();
+                vertices.push_back(primitive.Vertices[index]);
+            }
+            index = remap[index];
+        }
+        primitive.Vertices = std::move(vertices);
+    }
 }  // namespace
 
 namespace GltfHelper
@@ -546,22 +704,119 @@ namespace GltfHelper
         return primitive;
     }
 
-    const Primitive& PrimitiveCache::ReadPrimitive(const tinygltf::Primitive& gltfPrimitive)
+    size_t PrimitiveCache::PrimitiveKeyHash::operator()(const PrimitiveKey& key) const noexcept
+    {
+        size_t hash = 0;
+        for (int accessor : key) {
+            hash = hash * 31 + std::hash<int>()(accessor);
+        }
+        return hash;
+    }
+
+    PrimitiveCache::PrimitiveKey PrimitiveCache::MakeKey(const tinygltf::Primitive& gltfPrimitive)
+    {
+        auto accessorOf = [&](const char* attributeName) {
+            auto attribute = gltfPrimitive.attributes.find(attributeName);
+            return attribute == gltfPrimitive.attributes.end() ? -1 : attribute->second;
+        };
+        return {accessorOf("POSITION"),   accessorOf("NORMAL"),  accessorOf("TANGENT"),
+                accessorOf("TEXCOORD_0"), accessorOf("COLOR_0"), gltfPrimitive.indices};
+    }
+
+    void PrimitiveCache::ReadPrimitives(const std::vector<const tinygltf::Primitive*>& gltfPrimitives)
     {
-        PrimitiveAttributesVec attributesVec{};
-        for (auto const& attr : gltfPrimitive.attributes) {
-            attributesVec.push_back(std::make_pair(attr.first, attr.second));
+        std::vector<std::pair<PrimitiveKey, const tinygltf::Primitive*>> toRead;
+        for (const tinygltf::Primitive* gltfPrimitive : gltfPrimitives) {
+            const PrimitiveKey key = MakeKey(*gltfPrimitive);
+            if (m_primitiveCache.count(key) == 0 &&
+                std::none_of(toRead.begin(), toRead.end(), [&](const auto& keyAndPrimitive) { return keyAndPrimitive.first == key; })) {
+                toRead.emplace_back(key, gltfPrimitive);
+            }
+        }
+
+        // Each worker, including this thread, takes the next primitive not taken yet until there are none left.
+        std::vector<Primitive> primitives(toRead.size());
+        std::vector<VertexCacheStats> vertexCacheStats(toRead.size());
+        std::atomic<size_t> nextPrimitive{0};
+        auto readPrimitives = [&] {
+            try {
+                for (size_t i = nextPrimitive++; i < toRead.size(); i = nextPrimitive++) {
+                    primitives[i] = GltfHelper::ReadPrimitive(m_model, *toRead[i].second);
+                    if (m_optimize) {
+                        vertexCacheStats[i] = OptimizePrimitive(primitives[i]);
+                    }
+                }
+            }
+            catch (...) {
+                // Stop the other workers early, the load has failed anyway.
+                nextPrimitive = toRead.size();
+                throw;
+            }
+        };
+        const size_t workerCount = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), toRead.size());
+        std::vector<std::future<void>> workers;
+        for (size_t i = 1; i < workerCount; i++) {
+            workers.push_back(std::async(std::launch::async, readPrimitives));
+        }
+        std::exception_ptr error;
+        try {
+            readPrimitives();
         }
-        PrimitiveKey key = std::make_pair(attributesVec, gltfPrimitive.indices);
+        catch (...) {
+            error = std::current_exception();
+        }
+        for (std::future<void>& worker : workers) {
+            try {
+                worker.get();
+            }
+            catch (...) {
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+
+        for (size_t i = 0; i < toRead.size(); i++) {
+            m_primitiveCache.emplace(toRead[i].first, std::move(primitives[i]));
+            m_vertexCacheStats += vertexCacheStats[i];
+        }
+    }
+
+    const Primitive& PrimitiveCache::ReadPrimitive(const tinygltf::Primitive& gltfPrimitive)
+    {
+        const PrimitiveKey key = MakeKey(gltfPrimitive);
         auto primitiveIt = m_primitiveCache.find(key);
         if (primitiveIt != m_primitiveCache.end()) {
             return primitiveIt->second;
         }
 
         Primitive primitive = GltfHelper::ReadPrimitive(m_model, gltfPrimitive);
+        if (m_optimize) {
+            m_vertexCacheStats += OptimizePrimitive(primitive);
+        }
         return m_primitiveCache.emplace(key, std::move(primitive)).first->second;
     }
 
+    VertexCacheStats OptimizePrimitive(Primitive& primitive)
+    {
+        VertexCacheStats stats;
+        stats.Triangles = primitive.Indices.size() / 3;
+        stats.TransformsBefore = CountVertexTransforms(primitive.Indices, primitive.Vertices.size());
+
+        MergeIdenticalVertices(primitive);
+        std::vector<uint32_t> indices = TipsifyIndices(primitive.Indices, primitive.Vertices.size());
+        if (CountVertexTransforms(indices, primitive.Vertices.size()) < CountVertexTransforms(primitive.Indices, primitive.Vertices.size())) {
+            primitive.Indices = std::move(indices);
+        }
+        ReorderVerticesForFetch(primitive);
+
+        stats.TransformsAfter = CountVertexTransforms(primitive.Indices, primitive.Vertices.size());
+        return stats;
+    }
+
     Material ReadMaterial(const tinygltf::Model& gltfModel, const tinygltf::Material& gltfMaterial)
     {
         // Read an optional VEC4 parameter if available, otherwise use the default.
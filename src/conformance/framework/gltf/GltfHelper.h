@@ -19,6 +19,7 @@
 #include <nonstd/span.hpp>
 #include <openxr/openxr.h>
 
+#include <array>
 #include <chrono>
 #include <functional>
 #include <map>
@@ -27,6 +28,7 @@
 #include <numeric>
 #include <stdint.h>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -97,19 +99,68 @@ namespace GltfHelper
         bool DoubleSided;
     };
 
+    // Post-transform vertex cache efficiency of primitives, as the average number of vertices transformed per triangle (ACMR).
+    struct VertexCacheStats
+    {
+        uint64_t Triangles{0};
+        uint64_t TransformsBefore{0};
+        uint64_t TransformsAfter{0};
+
+        float AcmrBefore() const
+        {
+            return Triangles == 0 ? 0.0f : float(TransformsBefore) / float(Triangles);
+        }
+
+        float AcmrAfter() const
+        {
+            return Triangles == 0 ? 0.0f : float(TransformsAfter) / float(Triangles);
+        }
+
+        VertexCacheStats& operator+=(const VertexCacheStats& other)
+        {
+            Triangles += other.Triangles;
+            TransformsBefore += other.TransformsBefore;
+            TransformsAfter += other.TransformsAfter;
+            return *this;
+        }
+    };
+
     class PrimitiveCache
     {
     public:
-        explicit PrimitiveCache(const tinygltf::Model& gltfModel) : m_model(gltfModel)
+        /// With @p optimize, every primitive read is passed through OptimizePrimitive.
+        explicit PrimitiveCache(const tinygltf::Model& gltfModel, bool optimize = false) : m_model(gltfModel), m_optimize(optimize)
         {
         }
+
+        /// Read the distinct primitives of @p gltfPrimitives not read yet, in parallel, so that ReadPrimitive then only has to
+        /// look them up. Rethrows the first error a primitive fails to read with.
+        void ReadPrimitives(const std::vector<const tinygltf::Primitive*>& gltfPrimitives);
+
         const Primitive& ReadPrimitive(const tinygltf::Primitive& gltfPrimitive);
 
+        /// The vertex cache efficiency of the primitives read, before and after optimization.
+        const VertexCacheStats& GetVertexCacheStats() const
+        {
+            return m_vertexCacheStats;
+        }
+
     private:
-        using PrimitiveAttributesVec = std::vector<std::pair<std::string, int>>;  // first is name, second is accessor
-        using PrimitiveKey = std::pair<PrimitiveAttributesVec, int>;              // first is attributes, second is indices
+        /// Accessors of the vertex attributes ReadPrimitive reads, then of the indices; -1 where there is none.
+        /// Other attributes are ignored, so primitives with the same key read the same.
+        using PrimitiveKey = std::array<int, 6>;
+
+        struct PrimitiveKeyHash
+        {
+            size_t operator()(const PrimitiveKey& key) const noexcept;
+        };
+
+        static PrimitiveKey MakeKey(const tinygltf::Primitive& gltfPrimitive);
+
         std::reference_wrapper<const tinygltf::Model> m_model;
-        std::map<PrimitiveKey, Primitive> m_primitiveCache{};
+        bool m_optimize;
+        std::unordered_map<PrimitiveKey, Primitive, PrimitiveKeyHash> m_primitiveCache{};
+        VertexCacheStats m_vertexCacheStats{};
     };
 
     // Reads the "transform" or "TRS" data for a Node as an XrMatrix4x4f.
@@ -118,6 +169,11 @@ namespace GltfHelper
     // Parses the primitive attributes and indices from the glTF accessors/bufferviews/buffers into a common simplified data structure, the Primitive.
     Primitive ReadPrimitive(const tinygltf::Model& gltfModel, const tinygltf::Primitive& gltfPrimitive);
 
+    // Merges identical vertices, reorders triangles for post-transform vertex cache locality, then reorders vertices in the order
+    // the triangles first use them for fetch locality. Vertices no triangle uses are dropped. The triangle order is only kept if it
+    // transforms fewer vertices than the original order does.
+    VertexCacheStats OptimizePrimitive(Primitive& primitive);
+
     // Parses the material values into a simplified data structure, the Material.
     Material ReadMaterial(const tinygltf::Model& gltfModel, const tinygltf::Material& gltfMaterial);
 
@@ -142,4 +198,22 @@ namespace GltfHelper
     Conformance::Image::Image DecodeImageKTX2(const tinygltf::Image& image, bool sRGB,
                                               span<const Conformance::Image::FormatParams> supportedFormats,
                                               std::vector<uint8_t>& tempBuffer);
+
+    /// The result of DecodeImage, along with the temporary buffer it may refer to.
+    /// The decoded image may also refer to the source image's data, so it must not outlive the tinygltf model.
+    struct DecodedImage
+    {
+        DecodedImage(const tinygltf::Image& sourceImage, bool sRGB, span<const Conformance::Image::FormatParams> supportedFormats)
+            : source(&sourceImage), image(DecodeImage(sourceImage, sRGB, supportedFormats, tempBuffer))
+        {
+        }
+
+        // Not copyable or movable, since image may refer to tempBuffer.
+        DecodedImage(const DecodedImage&) = delete;
+        DecodedImage& operator=(const DecodedImage&) = delete;
+
+        const tinygltf::Image* source;
+        std::vector<uint8_t> tempBuffer;
+        Conformance::Image::Image image;
+    };
 }  // namespace GltfHelper
@@ -5,18 +5,178 @@
 #include "gltf_helpers.h"
 #include "report.h"
 #include "gltf/GltfHelper.h"
+#include "pbr/GltfLoader.h"
 
 #include "utilities/throw_helpers.h"
+#include "utilities/utils.h"
 #include "cts_tinygltf.h"
 
+#include <map>
+#include <mutex>
+#include <stdint.h>
+#include <utility>
+
 namespace Conformance
 {
+    namespace
+    {
+        void ReportVertexCacheStats(const Gltf::DecodedScene& scene)
+        {
+            const GltfHelper::VertexCacheStats& stats = scene.VertexCacheStats;
+            if (stats.Triangles != 0) {
+                // Average vertices transformed per triangle: 3 with no reuse at all, around 0.6 at best for regular meshes.
+                ReportMetric("gltf.vertexCacheAcmr.before", stats.AcmrBefore(), "count");
+                ReportMetric("gltf.vertexCacheAcmr.after", stats.AcmrAfter(), "count");
+            }
+        }
+
+        /// Parsed glTF models, and the scenes decoded from them, kept for the whole process so that tests loading the same
+        /// assets in every session only parse and decode them once. Least recently used models are dropped once the files
+        /// they were parsed from add up to more than a budget.
+        class GltfModelCache
+        {
+        public:
+            static GltfModelCache& Get()
+            {
+                static GltfModelCache cache;
+                return cache;
+            }
+
+            std::shared_ptr<const tinygltf::Model> Find(span<const uint8_t> data)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto it = m_entries.find(MakeKey(data));
+                if (it == m_entries.end()) {
+                    return nullptr;
+                }
+                it->second.lastUse = ++m_useCount;
+                return it->second.model;
+            }
+
+            /// Returns the cached model, which is an earlier one if another thread parsed the same content meanwhile.
+            std::shared_ptr<const tinygltf::Model> Insert(span<const uint8_t> data, std::shared_ptr<const tinygltf::Model> model)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                Entry& entry = m_entries[MakeKey(data)];
+                if (entry.model == nullptr) {
+                    entry.model = std::move(model);
+                    m_totalBytes += data.size();
+                }
+                entry.lastUse = ++m_useCount;
+                std::shared_ptr<const tinygltf::Model> cachedModel = entry.model;
+                EvictLeastRecentlyUsed();
+                return cachedModel;
+            }
+
+            /// Get the scene decoded from @p model, if it is cached, decoding it on first use.
+            /// Returns false if the model is not in the cache.
+            bool GetDecodedScene(const std::shared_ptr<const tinygltf::Model>& model, std::shared_ptr<const Gltf::DecodedScene>& scene)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    Entry* entry = FindEntry(model);
+                    if (entry == nullptr) {
+                        return false;
+                    }
+                    scene = entry->scene;
+                }
+                if (scene != nullptr) {
+                    return true;
+                }
+
+                // Decode without holding the lock: another thread may decode the same scene meanwhile, which is only wasted work.
+                scene = Gltf::DecodeScene(*model);
+                ReportVertexCacheStats(*scene);
+                std::lock_guard<std::mutex> lock(m_mutex);
+                Entry* entry = FindEntry(model);
+                if (entry != nullptr && entry->scene == nullptr) {
+                    entry->scene = scene;
+                }
+                return true;
+            }
+
+        private:
+            /// Size and FNV-1a hash of the file content
+            using Key = std::pair<size_t, uint64_t>;
+
+            struct Entry
+            {
+                std::shared_ptr<const tinygltf::Model> model;
+                std::shared_ptr<const Gltf::DecodedScene> scene;
+                uint64_t lastUse{0};
+            };
+
+            static constexpr size_t MaxTotalBytes = 256 * 1024 * 1024;
+
+            static Key MakeKey(span<const uint8_t> data)
+            {
+                uint64_t hash = 14695981039346656037ull;
+                for (uint8_t byte : data) {
+                    hash = (hash ^ byte) * 1099511628211ull;
+                }
+                return {data.size(), hash};
+            }
+
+            Entry* FindEntry(const std::shared_ptr<const tinygltf::Model>& model)
+            {
+                for (auto& keyAndEntry : m_entries) {
+                    if (keyAndEntry.second.model == model) {
+                        return &keyAndEntry.second;
+                    }
+                }
+                return nullptr;
+            }
+
+            void EvictLeastRecentlyUsed()
+            {
+                // Always keep the most recently used model, however large.
+                while (m_totalBytes > MaxTotalBytes && m_entries.size() > 1) {
+                    auto oldest = m_entries.begin();
+                    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+                        if (it->second.lastUse < oldest->second.lastUse) {
+                            oldest = it;
+                        }
+                    }
+                    m_totalBytes -= oldest->first.first;
+                    m_entries.erase(oldest);
+                }
+            }
+
+            std::mutex m_mutex;
+            std::map<Key, Entry> m_entries;
+            size_t m_totalBytes{0};
+            uint64_t m_useCount{0};
+        };
+    }  // namespace
 
     std::shared_ptr<const tinygltf::Model> LoadGLTF(span<const uint8_t> data)
     {
+        GltfModelCache& cache = GltfModelCache::Get();
+        std::shared_ptr<const tinygltf::Model> model = cache.Find(data);
+        if (model != nullptr) {
+            return model;
+        }
+
         tinygltf::TinyGLTF loader;
+        return cache.Insert(data, LoadGLTF(data, loader));
+    }
 
-        return LoadGLTF(data, loader);
+    std::shared_ptr<const tinygltf::Model> LoadGLTFFile(const char* path)
+    {
+        // tinygltf still copies the binary chunk into the model's buffer, but reading the file is left to the pager.
+        const MappedFile file(path, "glTF binary");
+        return LoadGLTF(span<const uint8_t>(file.data(), file.size()));
+    }
+
+    Gltf::ModelBuilder MakeModelBuilder(std::shared_ptr<const tinygltf::Model> gltfModel)
+    {
+        std::shared_ptr<const Gltf::DecodedScene> scene;
+        if (GltfModelCache::Get().GetDecodedScene(gltfModel, scene)) {
+            return Gltf::ModelBuilder(std::move(gltfModel), std::move(scene));
+        }
+        Gltf::ModelBuilder modelBuilder(std::move(gltfModel));
+        ReportVertexCacheStats(*modelBuilder.GetDecodedScene());
+        return modelBuilder;
     }
 
     std::shared_ptr<const tinygltf::Model> LoadGLTF(span<const uint8_t> data, tinygltf::TinyGLTF& loader)
@@ -18,6 +18,11 @@ namespace tinygltf
     class TinyGLTF;
 }  // namespace tinygltf
 
+namespace Gltf
+{
+    class ModelBuilder;
+}  // namespace Gltf
+
 namespace Conformance
 {
     // Import a backported implementation of std::span, or std::span itself if available.
@@ -25,9 +30,23 @@ namespace Conformance
     using nonstd::span;
 
     /// Load a glTF file from memory into a shared pointer, throwing on errors.
+    ///
+    /// Parsed models are cached for the whole process by a hash of their content, so loading the same file again,
+    /// even in a later session, returns the model parsed the first time.
     std::shared_ptr<const tinygltf::Model> LoadGLTF(span<const uint8_t> data);
 
+    /// Load a glTF binary file from a path (an asset on Android) into a shared pointer, throwing on errors.
+    ///
+    /// The file is memory-mapped rather than read into memory first, and cached the same way as by LoadGLTF above, so
+    /// loading a file that was loaded before only hashes its mapped pages.
+    std::shared_ptr<const tinygltf::Model> LoadGLTFFile(const char* path);
+
     /// Load a glTF file from memory into a shared pointer, throwing on errors, using the provided loader.
+    /// Not cached, since the loader may be configured differently.
     std::shared_ptr<const tinygltf::Model> LoadGLTF(span<const uint8_t> data, tinygltf::TinyGLTF& loader);
 
+    /// Make a builder for a glTF model. For a model from the LoadGLTF cache, the scene decoded for the first builder of
+    /// the model is reused rather than read from its buffers again.
+    Gltf::ModelBuilder MakeModelBuilder(std::shared_ptr<const tinygltf::Model> gltfModel);
+
 }  // namespace Conformance
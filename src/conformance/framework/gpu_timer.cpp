@@ -0,0 +1,130 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gpu_timer.h"
+
+#include "report.h"
+#include "utilities/throw_helpers.h"
+
+#include <algorithm>
+#include <map>
+#include <string.h>
+
+namespace Conformance
+{
+    void GpuTimerScopes::BeginScope(const char* name)
+    {
+        XRC_CHECK_THROW_MSG(m_scopes.empty() || !m_scopes.back().open, "GPU timer scopes do not nest");
+        m_scopes.push_back(Scope{m_nextScopeId++, name, 0, std::chrono::nanoseconds{0}, true, true});
+    }
+
+    void GpuTimerScopes::EndScope()
+    {
+        XRC_CHECK_THROW_MSG(!m_scopes.empty() && m_scopes.back().open, "No GPU timer scope is open");
+        m_scopes.back().open = false;
+    }
+
+    uint64_t GpuTimerScopes::BeginInterval(const char* operationName)
+    {
+        if (m_scopes.empty() || !m_scopes.back().open) {
+            if (!m_timeOperations) {
+                return 0;
+            }
+            m_scopes.push_back(Scope{m_nextScopeId++, operationName, 0, std::chrono::nanoseconds{0}, false, true});
+        }
+        m_scopes.back().unresolvedIntervals++;
+        return m_scopes.back().id;
+    }
+
+    void GpuTimerScopes::ResolveInterval(uint64_t id, std::chrono::nanoseconds duration, bool valid)
+    {
+        Scope* scope = FindScope(id);
+        if (scope == nullptr) {
+            // Discarded
+            return;
+        }
+        XRC_CHECK_THROW(scope->unresolvedIntervals > 0);
+        scope->unresolvedIntervals--;
+        scope->duration += duration;
+        scope->valid = scope->valid && valid;
+    }
+
+    void GpuTimerScopes::TakeSamples(std::vector<GpuTimerSample>& samples)
+    {
+        while (!m_scopes.empty() && !m_scopes.front().open && m_scopes.front().unresolvedIntervals == 0) {
+            if (m_scopes.front().valid) {
+                samples.push_back(GpuTimerSample{m_scopes.front().name, m_scopes.front().duration});
+            }
+            m_scopes.pop_front();
+        }
+    }
+
+    void GpuTimerScopes::DiscardPending()
+    {
+        for (Scope& scope : m_scopes) {
+            if (scope.unresolvedIntervals > 0) {
+                scope.unresolvedIntervals = 0;
+                scope.valid = false;
+            }
+        }
+    }
+
+    GpuTimerScopes::Scope* GpuTimerScopes::FindScope(uint64_t id)
+    {
+        if (m_scopes.empty() || id < m_scopes.front().id) {
+            return nullptr;
+        }
+        // Ids are handed out consecutively, so the offset from the front is the index.
+        const uint64_t index = id - m_scopes.front().id;
+        if (index >= m_scopes.size()) {
+            return nullptr;
+        }
+        return &m_scopes[(size_t)index];
+    }
+
+    void ReportGpuTimerSamples(const std::vector<GpuTimerSample>& samples)
+    {
+        struct Totals
+        {
+            size_t count = 0;
+            std::chrono::nanoseconds total{0};
+            std::chrono::nanoseconds max{0};
+        };
+        struct NameLess
+        {
+            bool operator()(const char* lhs, const char* rhs) const
+            {
+                return strcmp(lhs, rhs) < 0;
+            }
+        };
+        std::map<const char*, Totals, NameLess> totalsByName;
+        for (const GpuTimerSample& sample : samples) {
+            Totals& totals = totalsByName[sample.name];
+            totals.count++;
+            totals.total += sample.duration;
+            totals.max = std::max(totals.max, sample.duration);
+        }
+
+        using ms = std::chrono::duration<double, std::milli>;
+        for (const auto& entry : totalsByName) {
+            const std::string prefix = std::string("gpuTime.") + entry.first;
+            const std::vector<MetricTag> tags{{"count", std::to_string(entry.second.count)}};
+            ReportMetric(prefix + ".average", std::chrono::duration_cast<ms>(entry.second.total).count() / entry.second.count, "ms",
+                         tags);
+            ReportMetric(prefix + ".max", std::chrono::duration_cast<ms>(entry.second.max).count(), "ms", tags);
+        }
+    }
+}  // namespace Conformance
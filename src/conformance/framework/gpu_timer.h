@@ -0,0 +1,92 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace Conformance
+{
+    /// GPU time spent executing one timed scope, see IGraphicsPlugin::BeginGpuTimerScope.
+    struct GpuTimerSample
+    {
+        /// The scope name, e.g. "RenderView"
+        const char* name;
+        /// Sum of the GPU time of the work timed in the scope, not counting any gaps between submissions
+        std::chrono::nanoseconds duration;
+    };
+
+    /// CPU-side bookkeeping shared by the graphics plugins' GPU timers.
+    ///
+    /// A plugin brackets each operation it times with a pair of timestamp queries, an "interval", and reports the
+    /// interval's duration here once the GPU has written both. Intervals begun while a scope from @ref BeginScope is open
+    /// count towards that scope. Otherwise, if the plugin times its operations, each interval is a scope of its own.
+    class GpuTimerScopes
+    {
+    public:
+        /// Whether intervals outside of an explicitly opened scope are timed, see Options::gpuTimers.
+        void SetTimeOperations(bool timeOperations)
+        {
+            m_timeOperations = timeOperations;
+        }
+
+        /// Open the scope @p name, which must outlive the sample, e.g. a string literal. Scopes do not nest.
+        void BeginScope(const char* name);
+
+        /// Close the scope opened by @ref BeginScope. Its sample is available once all its intervals resolve.
+        void EndScope();
+
+        /// Start an interval for the operation @p operationName.
+        /// @return an id to pass to @ref ResolveInterval, or 0 if the operation is not to be timed.
+        uint64_t BeginInterval(const char* operationName);
+
+        /// Record the GPU duration of an interval from @ref BeginInterval.
+        /// Pass @p valid false if the interval could not be measured, which drops the sample for its whole scope.
+        void ResolveInterval(uint64_t id, std::chrono::nanoseconds duration, bool valid = true);
+
+        /// Move the samples of the closed scopes whose intervals have all resolved into @p samples, in the order the scopes began.
+        void TakeSamples(std::vector<GpuTimerSample>& samples);
+
+        /// Drop all intervals that have not resolved, e.g. because their queries are being destroyed with the device.
+        void DiscardPending();
+
+    private:
+        struct Scope
+        {
+            uint64_t id;
+            const char* name;
+            uint32_t unresolvedIntervals;
+            std::chrono::nanoseconds duration;
+            bool open;
+            bool valid;
+        };
+
+        Scope* FindScope(uint64_t id);
+
+        bool m_timeOperations{false};
+        uint64_t m_nextScopeId{1};
+        /// Scopes in increasing id order
+        std::deque<Scope> m_scopes;
+    };
+
+    /// Report the average and maximum duration of the samples for each scope name with ReportMetric,
+    /// as "gpuTime.<name>.average" and "gpuTime.<name>.max".
+    void ReportGpuTimerSamples(const std::vector<GpuTimerSample>& samples);
+}  // namespace Conformance
@@ -17,7 +17,9 @@
 #pragma once
 
 #include "gltf_helpers.h"
+#include "gpu_timer.h"
 #include "platform_plugin.h"
+#include "procedural_fill.h"
 #include "conformance_utils.h"
 #include "conformance_framework.h"
 #include "utilities/Geometry.h"
@@ -29,8 +31,12 @@
 #include <openxr/openxr.h>
 #include <nonstd/span.hpp>
 #include <nonstd/type.hpp>
+#include <atomic>
+#include <cassert>
 #include <cstdint>
+#include <functional>
 #include <memory>
+#include <stdexcept>
 #include <vector>
 #include <string>
 
@@ -217,9 +223,82 @@ namespace Conformance
             return *this;
         }
 
+        /// Draw @p occluders before everything else, so that the depth test rejects whatever they cover early,
+        /// e.g. the XR_KHR_visibility_mask hidden area placed just beyond the near plane.
+        RenderParams& DepthPrePass(span<const MeshDrawable> occluders)
+        {
+            depthPrePass = occluders;
+            return *this;
+        }
+
         span<const Cube> cubes{};
         span<const MeshDrawable> meshes{};
         span<const GLTFDrawable> glTFs{};
+        span<const MeshDrawable> depthPrePass{};
+    };
+
+    /// A retained list of cubes and meshes, for content that is drawn the same way every frame, such as a view-locked mesh.
+    /// Passed to IGraphicsPlugin::RenderDrawList, which lets a plugin record the draws once, into a secondary command
+    /// buffer or similar, and replay them each frame until the list or the view it is drawn to changes.
+    ///
+    /// Drawables are posed in the view space of the view they are drawn to. glTF models are not supported.
+    class DrawList
+    {
+    public:
+        DrawList() : m_id(NextId())
+        {
+        }
+        explicit DrawList(const RenderParams& params) : DrawList()
+        {
+            Set(params);
+        }
+        DrawList(const DrawList&) = delete;
+        DrawList& operator=(const DrawList&) = delete;
+
+        /// Replace the drawables, copying them out of @p params. Throws if @p params has glTF models.
+        void Set(const RenderParams& params)
+        {
+            if (!params.glTFs.empty()) {
+                throw std::logic_error("DrawList does not support glTF models");
+            }
+            m_cubes.assign(params.cubes.begin(), params.cubes.end());
+            m_meshes.assign(params.meshes.begin(), params.meshes.end());
+            m_depthPrePass.assign(params.depthPrePass.begin(), params.depthPrePass.end());
+            m_params = RenderParams{}.Draw(span<const Cube>(m_cubes)).Draw(span<const MeshDrawable>(m_meshes));
+            m_params.DepthPrePass(m_depthPrePass);
+            m_version++;
+        }
+
+        const RenderParams& GetParams() const
+        {
+            return m_params;
+        }
+
+        /// Unique for the life of the process, so that plugins may key what they record by it.
+        uint64_t GetId() const
+        {
+            return m_id;
+        }
+
+        /// Changes with every call to Set, so that plugins know to record the list again.
+        uint64_t GetVersion() const
+        {
+            return m_version;
+        }
+
+    private:
+        static uint64_t NextId()
+        {
+            static std::atomic<uint64_t> nextId{1};
+            return nextId++;
+        }
+
+        uint64_t m_id;
+        uint64_t m_version{0};
+        std::vector<Cube> m_cubes;
+        std::vector<MeshDrawable> m_meshes;
+        std::vector<MeshDrawable> m_depthPrePass;
+        RenderParams m_params;
     };
 
 #define IGRAPHICSPLUGIN_UNIMPLEMENTED_METHOD() \
@@ -255,6 +334,15 @@ namespace Conformance
         virtual bool InitializeDevice(XrInstance instance, XrSystemId systemId, bool checkGraphicsRequirements = true,
                                       uint32_t deviceCreationFlags = 0) = 0;
 
+        /// Start the parts of InitializeDevice that do not depend on the XrInstance or XrSystemId (reading assets,
+        /// compiling shaders) on a background thread, so that they overlap creating the instance. InitializeDevice waits for
+        /// that work, or does it itself if it was not started. Calling this again once started does nothing.
+        /// May be called only if successfully initialized, and not concurrently with InitializeDevice.
+        virtual void PrepareDevice()
+        {
+            // Default no-op implementation for APIs which do all of their setup in InitializeDevice.
+        }
+
         /// Clear any memory associated with swapchains, particularly auto-created accompanying depth buffers.
         virtual void ClearSwapchainCache() = 0;
 
@@ -281,6 +369,18 @@ namespace Conformance
         /// the call to InitializeDevice.
         virtual void ShutdownDevice() = 0;
 
+        /// Prepares the device from an earlier InitializeDevice, which has not been shut down, for a session on
+        /// @p instance, which need not be the XrInstance the device was initialized for. Implementations must repeat the
+        /// graphics requirements calls that are required before xrCreateSession, and check that the system still uses
+        /// the adapter the device was created on.
+        /// Returns false if the device cannot be reused, in which case the caller should shut it down and initialize
+        /// a new one.
+        virtual bool ReuseDevice(XrInstance /*instance*/, XrSystemId /*systemId*/)
+        {
+            // Default implementation for APIs which do not support keeping the device between sessions.
+            return false;
+        }
+
         /// Get the graphics binding header for session creation.
         /// Must have successfully called InitializeDevice before calling this or else this returns nullptr.
         virtual const XrBaseInStructure* GetGraphicsBinding() const = 0;
@@ -288,6 +388,30 @@ namespace Conformance
         virtual void CopyRGBAImage(const XrSwapchainImageBaseHeader* /*swapchainImage*/, uint32_t /*arraySlice*/,
                                    const RGBAImage& /*image*/) = 0;
 
+        /// Writes @p rowCount top-down rows of SRGB RGBA8 pixels, from row @p firstRow on, to @p dest, @p rowPitch bytes apart.
+        using RGBARowWriter = std::function<void(uint32_t firstRow, uint32_t rowCount, uint8_t* dest, uint32_t rowPitch)>;
+
+        /// Like CopyRGBAImage for a @p width by @p height image whose pixels @p writeRows writes straight into the upload
+        /// memory, possibly in several bands, so that large images need not be held in an RGBAImage too. See RGBAImageFile.
+        virtual void CopyRGBAImageRows(const XrSwapchainImageBaseHeader* swapchainImage, uint32_t arraySlice, uint32_t width,
+                                       uint32_t height, const RGBARowWriter& writeRows)
+        {
+            // Default implementation for APIs which only upload whole images.
+            RGBAImage image((int)width, (int)height);
+            writeRows(0, height, reinterpret_cast<uint8_t*>(image.pixels.data()), width * sizeof(RGBA8Color));
+            image.isSrgb = true;
+            CopyRGBAImage(swapchainImage, arraySlice, image);
+        }
+
+        /// Size in bytes of the GPU memory allocated for @p swapchainImage, a color or depth image enumerated from a runtime
+        /// swapchain, as the graphics API reports it. Used by Options::swapchainMemoryAudit.
+        /// Returns 0 if the API cannot tell.
+        virtual uint64_t GetSwapchainImageMemorySize(const XrSwapchainImageBaseHeader* /*swapchainImage*/) const
+        {
+            // Default implementation for APIs which cannot query the allocation behind an image they did not create.
+            return 0;
+        }
+
         /// Returns a name for an image format. Returns "unknown" for unknown formats.
         virtual std::string GetImageFormatName(int64_t /*imageFormat*/) const = 0;
 
@@ -302,10 +426,20 @@ namespace Conformance
 
         /// Given an imageFormat and its test parameters and the XrSwapchain resulting from xrCreateSwapchain,
         /// validate the images in any platform-specific way.
+        /// This checks the enumerated image structs and their API-level description (format, handle validity) only:
+        /// image contents are never read back, rendered results are judged by the interactive tests instead.
         /// Executes testing CHECK/REQUIRE directives, and may throw a Catch2 failure exception.
         virtual bool ValidateSwapchainImages(int64_t /*imageFormat*/, const SwapchainCreateTestParameters* /*tp*/,
                                              XrSwapchain /*swapchain*/, uint32_t* /*imageCount*/) const noexcept(false) = 0;
 
+        /// Returns true if swapchains may be created, enumerated and destroyed from several threads at once while the
+        /// application makes no other graphics calls, as the device of this graphics API is free-threaded.
+        virtual bool CanCreateSwapchainsConcurrently() const
+        {
+            // Default implementation for APIs whose context is bound to the thread that made it current.
+            return false;
+        }
+
         /// Given an swapchain and an image index, validate the resource state in any platform-specific way.
         /// Executes testing CHECK/REQUIRE directives, and may throw a Catch2 failure exception.
         virtual bool ValidateSwapchainImageState(XrSwapchain /*swapchain*/, uint32_t /*index*/, int64_t /*imageFormat*/) const
@@ -356,13 +490,21 @@ namespace Conformance
             ClearImageSlice(colorSwapchainImage, imageArrayIndex, globalData.GetClearColorForBackground());
         }
 
+        /// Draw @p fill over the whole @p width by @p height slice, replacing its contents. Works for every format that supports
+        /// rendering, including those CopyRGBAImage cannot copy to, and may be called instead of ClearImageSlice.
+        /// The default clears to the background color and draws the rest as a mesh with RenderView.
+        virtual void FillImageSlice(const XrSwapchainImageBaseHeader* colorSwapchainImage, uint32_t imageArrayIndex, uint32_t width,
+                                    uint32_t height, const ProceduralFill& fill);
+
         /// Create internal data for a mesh, returning a handle to refer to it.
         /// `idx` and `vtx` are copied out of and do not need to outlive this function.
         /// This handle expires when the internal data is cleared in Shutdown() and ShutdownDevice().
+        /// Making a mesh with the same content again returns the same handle, sharing its buffers.
         virtual MeshHandle MakeSimpleMesh(span<const uint16_t> idx, span<const Geometry::Vertex> vtx) = 0;
 
         /// Create internal data for a glTF model, returning a handle to refer to it.
         /// This handle expires when the internal data is cleared in Shutdown() and ShutdownDevice().
+        /// The parsed model is cached for the process by Conformance::LoadGLTF.
         GLTFModelHandle LoadGLTF(span<const uint8_t> data)
         {
             return LoadGLTF(Conformance::LoadGLTF(data));
@@ -373,10 +515,16 @@ namespace Conformance
         /// It retains a reference to the tinygltf model passed here.
         GLTFModelHandle LoadGLTF(std::shared_ptr<const tinygltf::Model> tinygltfModel)
         {
-            return LoadGLTF(Gltf::ModelBuilder(tinygltfModel));
+            return LoadGLTF(MakeModelBuilder(std::move(tinygltfModel)));
         }
+        /// Loading a builder of a scene already loaded on this device returns the handle of the model built then, sharing its
+        /// GPU resources.
         virtual GLTFModelHandle LoadGLTF(Gltf::ModelBuilder&& modelBuilder) = 0;
 
+        /// Get the texture formats to pass to Gltf::ModelBuilder::DecodeImages, so that a model's images can be decoded
+        /// on a worker thread before it is passed to LoadGLTF. Empty if the device has not been initialized.
+        virtual std::vector<Conformance::Image::FormatParams> GetSupportedTextureFormats() const = 0;
+
         /// Get the underlying Pbr::Model associated with the supplied handle.
         virtual std::shared_ptr<Pbr::Model> GetPbrModel(GLTFModelHandle handle) const = 0;
 
@@ -401,6 +549,103 @@ namespace Conformance
         /// Render a list of drawables to a swapchain image. ClearImageSlice must be called first to clear internal state.
         virtual void RenderView(const XrCompositionLayerProjectionView& layerView, const XrSwapchainImageBaseHeader* colorSwapchainImage,
                                 const RenderParams& params) = 0;
+
+        /// Render the same list of drawables to every view of a projection layer, such as both views of a stereo layer or
+        /// all four of XR_VARJO_quad_views. @p colorSwapchainImages holds the image for each entry of @p layerViews, and
+        /// may repeat an image whose sub-images hold several views. ClearImageSlice must be called on each image first.
+        /// Plugins that can do so record all views into a single submission; the default renders them one at a time.
+        virtual void RenderViews(span<const XrCompositionLayerProjectionView> layerViews,
+                                 span<const XrSwapchainImageBaseHeader* const> colorSwapchainImages, const RenderParams& params)
+        {
+            assert(layerViews.size() == colorSwapchainImages.size());
+            for (size_t i = 0; i < layerViews.size(); ++i) {
+                RenderView(layerViews[i], colorSwapchainImages[i], params);
+            }
+        }
+
+        /// Render a DrawList, whose drawables are posed relative to @p layerView, to a swapchain image. ClearImageSlice must
+        /// be called first. Plugins that can do so record the draws once per list, view and image, and replay the recording
+        /// until the list changes; the default renders the list with RenderView every time.
+        virtual void RenderDrawList(const XrCompositionLayerProjectionView& layerView,
+                                    const XrSwapchainImageBaseHeader* colorSwapchainImage, const DrawList& drawList)
+        {
+            XrCompositionLayerProjectionView viewSpaceLayerView = layerView;
+            viewSpaceLayerView.pose = Pose::Identity;
+            RenderView(viewSpaceLayerView, colorSwapchainImage, drawList.GetParams());
+        }
+
+        /// Whether this plugin implements RenderMotionVectorView.
+        virtual bool SupportsMotionVectors() const
+        {
+            return false;
+        }
+
+        /// Render the XR_FB_space_warp motion vectors and depth of the cubes and meshes in @p params, for the same view as
+        /// a RenderView call with @p layerView. Each pixel of @p motionVectorSwapchainImage, from a swapchain with the format
+        /// chosen by SelectMotionVectorSwapchainFormat, gets the motion of the surface there since the previous frame, in
+        /// normalized device coordinates. @p previousLayerView and @p previousParams give the view and the drawables as they
+        /// were on the previous frame, and must list the same drawables in the same order. Both images are cleared first,
+        /// and @p layerView's image rect applies to both. Depth uses the same near and far planes as RenderView.
+        virtual void RenderMotionVectorView(const XrCompositionLayerProjectionView& /*layerView*/,
+                                            const XrCompositionLayerProjectionView& /*previousLayerView*/,
+                                            const XrSwapchainImageBaseHeader* /*motionVectorSwapchainImage*/,
+                                            const XrSwapchainImageBaseHeader* /*depthSwapchainImage*/, const RenderParams& /*params*/,
+                                            const RenderParams& /*previousParams*/)
+        {
+            IGRAPHICSPLUGIN_UNIMPLEMENTED_METHOD();
+        }
+
+        /// Whether this plugin implements SetReversedDepth.
+        virtual bool SupportsReversedDepth() const
+        {
+            return false;
+        }
+
+        /// Make later ClearImageSlice and RenderView calls write reversed depth if @p reversed is set: the far plane at depth 0
+        /// and the near plane at depth 1, cleared to 0 and tested with "greater". The planes stay 0.05 and 100 meters away, so
+        /// an XrCompositionLayerDepthInfoKHR for reversed depth has a nearZ of 100 and a farZ of 0.05. Lasts until called again
+        /// with @p reversed unset, which every plugin accepts.
+        virtual void SetReversedDepth(bool reversed)
+        {
+            if (reversed) {
+                IGRAPHICSPLUGIN_UNIMPLEMENTED_METHOD();
+            }
+        }
+
+        /// Whether this plugin measures GPU time with timestamp queries, see BeginGpuTimerScope.
+        virtual bool SupportsGpuTimers() const
+        {
+            return false;
+        }
+
+        /// Attribute the GPU time of the RenderView, RenderViews, ClearImageSlice and CopyRGBAImage calls made until
+        /// EndGpuTimerScope to a single sample called @p name, which must outlive the sample, e.g. a string literal.
+        /// Outside of such a scope, each of those calls is timed as a scope of its own if Options::gpuTimers is set.
+        /// Scopes do not nest.
+        virtual void BeginGpuTimerScope(const char* /*name*/)
+        {
+            // Default no-op implementation for APIs without GPU timers.
+        }
+
+        /// Close the scope opened by BeginGpuTimerScope.
+        virtual void EndGpuTimerScope()
+        {
+            // Default no-op implementation for APIs without GPU timers.
+        }
+
+        /// Append the samples of the scopes the GPU has finished executing to @p samples, without waiting for the GPU.
+        /// Samples are delivered in the order their scopes began, and survive ShutdownDevice until collected.
+        virtual void CollectGpuTimerSamples(std::vector<GpuTimerSample>& /*samples*/)
+        {
+            // Default no-op implementation for APIs without GPU timers.
+        }
+
+        /// Return the numbers of glTF primitives drawn and of pipeline and material binds made since the last call, and reset them.
+        virtual Pbr::DrawStats TakeGltfDrawStats()
+        {
+            // Default implementation for APIs that do not count them.
+            return {};
+        }
     };
 
     /// Create a graphics plugin for the graphics API specified in the options.
@@ -20,6 +20,8 @@
 #include "graphics_plugin.h"
 #include "graphics_plugin_d3d11_gltf.h"
 #include "graphics_plugin_impl_helpers.h"
+#include "mesh_instance_batches.h"
+#include "startup_timing.h"
 #include "swapchain_image_data.h"
 
 #include "common/xr_linear.h"
@@ -30,6 +32,7 @@
 #include "utilities/d3d_common.h"
 #include "utilities/swapchain_parameters.h"
 #include "utilities/throw_helpers.h"
+#include "utilities/trace.h"
 
 #include <D3Dcompiler.h>
 #include <DirectXColors.h>
@@ -40,6 +43,11 @@
 
 #include <algorithm>
 #include <array>
+#include <deque>
+#include <future>
+#include <string.h>
+#include <thread>
+#include <utility>
 #include <windows.h>
 
 using namespace Microsoft::WRL;
@@ -70,6 +78,22 @@ namespace Conformance
         }
     };
 
+    /// State for recording the mesh instances of views on one device context
+    struct D3D11MeshRecorder
+    {
+        /// Dynamic vertex buffer of MeshInstance, rewritten by every view
+        ComPtr<ID3D11Buffer> instanceBuffer;
+        uint32_t instanceBufferCapacity{0};
+        MeshInstanceBatches meshBatches;
+    };
+
+    /// A deferred context and its mesh recording state, used by one thread at a time
+    struct D3D11DeferredViewRecorder
+    {
+        ComPtr<ID3D11DeviceContext> context;
+        D3D11MeshRecorder meshes;
+    };
+
     struct D3D11FallbackDepthTexture
     {
     public:
@@ -137,7 +161,7 @@ namespace Conformance
         const XrSwapchainImageD3D11KHR& GetFallbackDepthSwapchainImage(uint32_t i) override
         {
             if (!m_internalDepthTextures[i].Allocated()) {
-                m_internalDepthTextures[i].Allocate(m_device.Get(), this->Width(), this->Height(), this->ArraySize());
+                m_internalDepthTextures[i].Allocate(m_device.Get(), this->Width(), this->Height(), this->LayerCount());
             }
 
             return m_internalDepthTextures[i].GetTexture();
@@ -148,6 +172,123 @@ namespace Conformance
         std::vector<D3D11FallbackDepthTexture> m_internalDepthTextures;
     };
 
+    /// Pairs of timestamp queries, each inside a disjoint query, bracketing the operations timed for a GpuTimerScopes
+    class D3D11GpuTimers
+    {
+    public:
+        GpuTimerScopes& Scopes()
+        {
+            return m_scopes;
+        }
+
+        /// Issue the start timestamp of an interval for @p operationName, if it is to be timed.
+        void BeginInterval(ID3D11Device* device, ID3D11DeviceContext* context, const char* operationName)
+        {
+            AbandonCurrentInterval();
+            const uint64_t id = m_scopes.BeginInterval(operationName);
+            if (id == 0) {
+                return;
+            }
+            Queries queries;
+            if (m_freeQueries.empty()) {
+                const CD3D11_QUERY_DESC disjointDesc(D3D11_QUERY_TIMESTAMP_DISJOINT);
+                const CD3D11_QUERY_DESC timestampDesc(D3D11_QUERY_TIMESTAMP);
+                XRC_CHECK_THROW_HRCMD(device->CreateQuery(&disjointDesc, queries.disjoint.ReleaseAndGetAddressOf()));
+                XRC_CHECK_THROW_HRCMD(device->CreateQuery(&timestampDesc, queries.begin.ReleaseAndGetAddressOf()));
+                XRC_CHECK_THROW_HRCMD(device->CreateQuery(&timestampDesc, queries.end.ReleaseAndGetAddressOf()));
+            }
+            else {
+                queries = std::move(m_freeQueries.back());
+                m_freeQueries.pop_back();
+            }
+            context->Begin(queries.disjoint.Get());
+            context->End(queries.begin.Get());
+            m_current = Interval{id, std::move(queries)};
+        }
+
+        /// Issue the end timestamp of the interval started by the last @ref BeginInterval.
+        void EndInterval(ID3D11DeviceContext* context)
+        {
+            if (m_current.id == 0) {
+                return;
+            }
+            context->End(m_current.queries.end.Get());
+            context->End(m_current.queries.disjoint.Get());
+            m_pending.push_back(std::move(m_current));
+            m_current = {};
+        }
+
+        /// Resolve the intervals whose queries have completed, or all of them if @p wait.
+        void ResolveIntervals(ID3D11DeviceContext* context, bool wait)
+        {
+            while (!m_pending.empty()) {
+                Interval& interval = m_pending.front();
+                D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint{};
+                if (!GetQueryData(context, interval.queries.disjoint.Get(), &disjoint, sizeof(disjoint), wait)) {
+                    break;
+                }
+                // The timestamps are complete once the disjoint query enclosing them is.
+                UINT64 begin = 0;
+                UINT64 end = 0;
+                GetQueryData(context, interval.queries.begin.Get(), &begin, sizeof(begin), true);
+                GetQueryData(context, interval.queries.end.Get(), &end, sizeof(end), true);
+                const bool valid = !disjoint.Disjoint && disjoint.Frequency != 0 && end >= begin;
+                const double nanoseconds = valid ? (double)(end - begin) * 1e9 / (double)disjoint.Frequency : 0.0;
+                m_scopes.ResolveInterval(interval.id, std::chrono::nanoseconds((int64_t)nanoseconds), valid);
+                m_freeQueries.push_back(std::move(interval.queries));
+                m_pending.pop_front();
+            }
+        }
+
+        /// Release the queries, once the intervals using them have resolved.
+        void Reset(ID3D11DeviceContext* context)
+        {
+            AbandonCurrentInterval();
+            ResolveIntervals(context, true);
+            m_freeQueries.clear();
+        }
+
+    private:
+        struct Queries
+        {
+            ComPtr<ID3D11Query> disjoint;
+            ComPtr<ID3D11Query> begin;
+            ComPtr<ID3D11Query> end;
+        };
+        struct Interval
+        {
+            uint64_t id;
+            Queries queries;
+        };
+
+        /// @return true if the data was available
+        static bool GetQueryData(ID3D11DeviceContext* context, ID3D11Query* query, void* data, UINT size, bool wait)
+        {
+            HRESULT hr;
+            // Do not flush when polling, so that checking for results does not change when work is submitted.
+            while ((hr = context->GetData(query, data, size, wait ? 0 : D3D11_ASYNC_GETDATA_DONOTFLUSH)) == S_FALSE && wait) {
+                std::this_thread::yield();
+            }
+            XRC_CHECK_THROW_HRCMD(hr);
+            return hr == S_OK;
+        }
+
+        /// An interval was begun but not ended, e.g. because an exception was thrown while recording it.
+        void AbandonCurrentInterval()
+        {
+            if (m_current.id != 0) {
+                // The disjoint query was begun, so the queries cannot be reused without ending it.
+                m_scopes.ResolveInterval(m_current.id, std::chrono::nanoseconds{0}, false);
+                m_current = {};
+            }
+        }
+
+        GpuTimerScopes m_scopes;
+        Interval m_current{};
+        std::deque<Interval> m_pending;
+        std::vector<Queries> m_freeQueries;
+    };
+
     struct D3D11GraphicsPlugin : public IGraphicsPlugin
     {
     public:
@@ -168,12 +309,35 @@ namespace Conformance
         bool InitializeDevice(XrInstance instance, XrSystemId systemId, bool checkGraphicsRequirements,
                               uint32_t deviceCreationFlags) override;
 
+        void PrepareDevice() override
+        {
+            m_deviceIndependentResources.Start();
+        }
+
+        /// What InitializeDevice needs that does not depend on the device
+        struct DeviceIndependentResources
+        {
+            ComPtr<ID3DBlob> vertexShaderBytes;
+            ComPtr<ID3DBlob> pixelShaderBytes;
+            std::vector<uint8_t> brdfLutFileData;
+        };
+        static DeviceIndependentResources LoadDeviceIndependentResources()
+        {
+            DeviceIndependentResources resources;
+            resources.vertexShaderBytes = CompileShader(ShaderHlsl, "MainVS", "vs_5_0");
+            resources.pixelShaderBytes = CompileShader(ShaderHlsl, "MainPS", "ps_5_0");
+            resources.brdfLutFileData = ReadFileBytes("brdf_lut.png");
+            return resources;
+        }
+
         void Flush() override;
 
         void ClearSwapchainCache() override;
 
         void ShutdownDevice() override;
 
+        bool ReuseDevice(XrInstance instance, XrSystemId systemId) override;
+
         const XrBaseInStructure* GetGraphicsBinding() const override;
 
         void CopyRGBAImage(const XrSwapchainImageBaseHeader* swapchainImage, uint32_t arraySlice, const RGBAImage& image) override;
@@ -188,6 +352,12 @@ namespace Conformance
                                      uint32_t* imageCount) const override;
         bool ValidateSwapchainImageState(XrSwapchain swapchain, uint32_t index, int64_t imageFormat) const override;
 
+        bool CanCreateSwapchainsConcurrently() const override
+        {
+            // ID3D11Device is free-threaded, only the immediate context is not, and it is not used meanwhile.
+            return true;
+        }
+
         int64_t SelectColorSwapchainFormat(const int64_t* imageFormatArray, size_t count) const override;
 
         int64_t SelectDepthSwapchainFormat(const int64_t* imageFormatArray, size_t count) const override;
@@ -209,6 +379,14 @@ namespace Conformance
         MeshHandle MakeSimpleMesh(span<const uint16_t> idx, span<const Geometry::Vertex> vtx) override;
 
         GLTFModelHandle LoadGLTF(Gltf::ModelBuilder&& modelBuilder) override;
+        std::vector<Conformance::Image::FormatParams> GetSupportedTextureFormats() const override
+        {
+            if (!m_pbrResources) {
+                return {};
+            }
+            const auto formats = m_pbrResources->GetSupportedFormats();
+            return {formats.begin(), formats.end()};
+        }
         std::shared_ptr<Pbr::Model> GetPbrModel(GLTFModelHandle handle) const override;
         GLTFModelInstanceHandle CreateGLTFModelInstance(GLTFModelHandle handle) override;
         Pbr::ModelInstance& GetModelInstance(GLTFModelInstanceHandle handle) override;
@@ -216,12 +394,48 @@ namespace Conformance
         void RenderView(const XrCompositionLayerProjectionView& layerView, const XrSwapchainImageBaseHeader* colorSwapchainImage,
                         const RenderParams& params) override;
 
+        void RenderViews(span<const XrCompositionLayerProjectionView> layerViews,
+                         span<const XrSwapchainImageBaseHeader* const> colorSwapchainImages, const RenderParams& params) override;
+
+        bool SupportsGpuTimers() const override
+        {
+            return true;
+        }
+
+        void BeginGpuTimerScope(const char* name) override
+        {
+            m_gpuTimers.Scopes().BeginScope(name);
+        }
+
+        void EndGpuTimerScope() override
+        {
+            m_gpuTimers.Scopes().EndScope();
+        }
+
+        void CollectGpuTimerSamples(std::vector<GpuTimerSample>& samples) override;
+
+        Pbr::DrawStats TakeGltfDrawStats() override
+        {
+            return std::exchange(m_gltfDrawStats, {});
+        }
+
     private:
         ComPtr<ID3D11RenderTargetView> CreateRenderTargetView(D3D11SwapchainImageData& swapchainData, uint32_t imageIndex,
                                                               uint32_t imageArrayIndex) const;
         ComPtr<ID3D11DepthStencilView> CreateDepthStencilView(D3D11SwapchainImageData& swapchainData, uint32_t imageIndex,
                                                               uint32_t imageArrayIndex) const;
 
+        /// Record setting the render targets, viewport and view projection of a view, and drawing the meshes of @p params, to
+        /// @p context, which may be a deferred context. Only touches @p meshRecorder and device objects, so that several
+        /// views may be recorded at once on different contexts.
+        void RecordMeshes(ID3D11DeviceContext* context, D3D11MeshRecorder& meshRecorder, const XrCompositionLayerProjectionView& layerView,
+                          ID3D11RenderTargetView* renderTargetView, ID3D11DepthStencilView* depthStencilView,
+                          const RenderParams& params);
+        /// Record drawing the glTFs of @p params to @p context, after @ref RecordMeshes for the same view. The glTF instances
+        /// and PBR resources are shared, so views must be recorded one at a time and in the order they are executed.
+        void RecordGltfs(const ComPtr<ID3D11DeviceContext>& context, const XrCompositionLayerProjectionView& layerView,
+                         const RenderParams& params);
+
         bool initialized{false};
         XrGraphicsBindingD3D11KHR graphicsBinding;
         ComPtr<ID3D11Device> d3d11Device;
@@ -231,18 +445,28 @@ namespace Conformance
         ComPtr<ID3D11VertexShader> vertexShader;
         ComPtr<ID3D11PixelShader> pixelShader;
         ComPtr<ID3D11InputLayout> inputLayout;
-        ComPtr<ID3D11Buffer> modelCBuffer;
         ComPtr<ID3D11Buffer> viewProjectionCBuffer;
+        /// Mesh recording state of the immediate context
+        D3D11MeshRecorder m_meshRecorder;
+        /// Deferred contexts for the views of RenderViews, per Options::parallelViewRecording
+        std::vector<D3D11DeferredViewRecorder> m_deferredRecorders;
 
         MeshHandle m_cubeMesh;
         VectorWithGenerationCountedHandles<D3D11Mesh, MeshHandle> m_meshes;
+        MeshHandleCache<uint16_t, Geometry::Vertex, MeshHandle> m_meshesByContent;
         // This is fine to be a shared_ptr because Model doesn't directly hold any graphics state.
         VectorWithGenerationCountedHandles<std::shared_ptr<Pbr::Model>, GLTFModelHandle> m_gltfModels;
+        SceneHandleCache<Gltf::DecodedScene, GLTFModelHandle> m_gltfModelsByScene;
         VectorWithGenerationCountedHandles<D3D11GLTF, GLTFModelInstanceHandle> m_gltfInstances;
 
         std::unique_ptr<Pbr::D3D11Resources> m_pbrResources;
+        DeviceIndependentLoad<DeviceIndependentResources> m_deviceIndependentResources{&LoadDeviceIndependentResources};
+        Pbr::DrawQueue m_gltfDrawQueue;
+        Pbr::DrawStats m_gltfDrawStats;
 
         SwapchainImageDataMap<D3D11SwapchainImageData> m_swapchainImageDataMap;
+
+        D3D11GpuTimers m_gpuTimers;
     };
 
     D3D11GraphicsPlugin::D3D11GraphicsPlugin(std::shared_ptr<IPlatformPlugin>)
@@ -302,7 +526,11 @@ namespace Conformance
                 auto xrGetD3D11GraphicsRequirementsKHR =
                     GetInstanceExtensionFunction<PFN_xrGetD3D11GraphicsRequirementsKHR>(instance, "xrGetD3D11GraphicsRequirementsKHR");
 
-                XrResult result = xrGetD3D11GraphicsRequirementsKHR(instance, systemId, &graphicsRequirements);
+                XrResult result;
+                {
+                    ScopedStartupPhase timing(StartupPhase::GraphicsRequirements);
+                    result = xrGetD3D11GraphicsRequirementsKHR(instance, systemId, &graphicsRequirements);
+                }
                 XRC_CHECK_THROW(ValidateResultAllowed("xrGetD3D11GraphicsRequirementsKHR", result));
                 if (XR_FAILED(result)) {
                     // Log result?
@@ -360,28 +588,32 @@ namespace Conformance
 
             // Initialize resources needed to render cubes
             {
-                const ComPtr<ID3DBlob> vertexShaderBytes = CompileShader(ShaderHlsl, "MainVS", "vs_5_0");
+                const DeviceIndependentResources& deviceIndependent = m_deviceIndependentResources.Get();
+
+                const ComPtr<ID3DBlob>& vertexShaderBytes = deviceIndependent.vertexShaderBytes;
                 XRC_CHECK_THROW_HRCMD(d3d11Device->CreateVertexShader(vertexShaderBytes->GetBufferPointer(),
                                                                       vertexShaderBytes->GetBufferSize(), nullptr,
                                                                       vertexShader.ReleaseAndGetAddressOf()));
 
-                const ComPtr<ID3DBlob> pixelShaderBytes = CompileShader(ShaderHlsl, "MainPS", "ps_5_0");
+                const ComPtr<ID3DBlob>& pixelShaderBytes = deviceIndependent.pixelShaderBytes;
                 XRC_CHECK_THROW_HRCMD(d3d11Device->CreatePixelShader(pixelShaderBytes->GetBufferPointer(),
                                                                      pixelShaderBytes->GetBufferSize(), nullptr,
                                                                      pixelShader.ReleaseAndGetAddressOf()));
 
-                const std::array<D3D11_INPUT_ELEMENT_DESC, 2> vertexDesc{{
+                const std::array<D3D11_INPUT_ELEMENT_DESC, 7> vertexDesc{{
                     {"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
                     {"COLOR", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
+                    {"MODEL", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+                    {"MODEL", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+                    {"MODEL", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+                    {"MODEL", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+                    {"TINTCOLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1},
                 }};
 
                 XRC_CHECK_THROW_HRCMD(d3d11Device->CreateInputLayout(vertexDesc.data(), (UINT)vertexDesc.size(),
                                                                      vertexShaderBytes->GetBufferPointer(),
                                                                      vertexShaderBytes->GetBufferSize(), &inputLayout));
 
-                const CD3D11_BUFFER_DESC modelConstantBufferDesc(sizeof(ModelConstantBuffer), D3D11_BIND_CONSTANT_BUFFER);
-                XRC_CHECK_THROW_HRCMD(d3d11Device->CreateBuffer(&modelConstantBufferDesc, nullptr, modelCBuffer.ReleaseAndGetAddressOf()));
-
                 const CD3D11_BUFFER_DESC viewProjectionConstantBufferDesc(sizeof(ViewProjectionConstantBuffer), D3D11_BIND_CONSTANT_BUFFER);
                 XRC_CHECK_THROW_HRCMD(
                     d3d11Device->CreateBuffer(&viewProjectionConstantBufferDesc, nullptr, viewProjectionCBuffer.ReleaseAndGetAddressOf()));
@@ -390,14 +622,17 @@ namespace Conformance
 
                 m_pbrResources = std::make_unique<Pbr::D3D11Resources>(d3d11Device.Get());
                 m_pbrResources->SetLight({0.0f, 0.7071067811865475f, 0.7071067811865475f}, Pbr::RGB::White);
+                m_pbrResources->SetTextureCacheBudget(uint64_t{GetGlobalData().options.pbrTextureCacheBudget} << 20);
 
-                // Read the BRDF Lookup Table used by the PBR system into a DirectX texture.
-                std::vector<byte> brdfLutFileData = ReadFileBytes("brdf_lut.png");
+                // Load the BRDF Lookup Table used by the PBR system into a DirectX texture.
+                const std::vector<uint8_t>& brdfLutFileData = deviceIndependent.brdfLutFileData;
                 Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> brdfLutResourceView =
                     Pbr::D3D11Texture::LoadTextureImage(*m_pbrResources, false, brdfLutFileData.data(), (uint32_t)brdfLutFileData.size());
                 m_pbrResources->SetBrdfLut(brdfLutResourceView.Get());
             }
 
+            m_gpuTimers.Scopes().SetTimeOperations(GetGlobalData().options.gpuTimers);
+
             return true;
         }
         catch (...) {
@@ -423,23 +658,66 @@ namespace Conformance
     {
         graphicsBinding = XrGraphicsBindingD3D11KHR{XR_TYPE_GRAPHICS_BINDING_D3D11_KHR};
 
+        if (d3d11DeviceContext) {
+            m_gpuTimers.Reset(d3d11DeviceContext.Get());
+        }
+
         vertexShader.Reset();
         pixelShader.Reset();
         inputLayout.Reset();
-        modelCBuffer.Reset();
         viewProjectionCBuffer.Reset();
+        m_meshRecorder = {};
+        m_deferredRecorders.clear();
         m_swapchainImageDataMap.Reset();
 
         m_cubeMesh = {};
         m_meshes.clear();
+        m_meshesByContent.clear();
         m_gltfInstances.clear();
         m_gltfModels.clear();
+        m_gltfModelsByScene.clear();
         m_pbrResources.reset();
 
         d3d11DeviceContext.Reset();
         d3d11Device.Reset();
     }
 
+    bool D3D11GraphicsPlugin::ReuseDevice(XrInstance instance, XrSystemId systemId)
+    {
+        if (!d3d11Device) {
+            return false;
+        }
+
+        XrGraphicsRequirementsD3D11KHR graphicsRequirements{XR_TYPE_GRAPHICS_REQUIREMENTS_D3D11_KHR};
+        auto xrGetD3D11GraphicsRequirementsKHR =
+            GetInstanceExtensionFunction<PFN_xrGetD3D11GraphicsRequirementsKHR>(instance, "xrGetD3D11GraphicsRequirementsKHR");
+        XrResult result;
+        {
+            ScopedStartupPhase timing(StartupPhase::GraphicsRequirements);
+            result = xrGetD3D11GraphicsRequirementsKHR(instance, systemId, &graphicsRequirements);
+        }
+        XRC_CHECK_THROW(ValidateResultAllowed("xrGetD3D11GraphicsRequirementsKHR", result));
+        if (XR_FAILED(result)) {
+            return false;
+        }
+
+        // The runtime must still want the adapter the existing device was created on.
+        ComPtr<IDXGIDevice> dxgiDevice;
+        ComPtr<IDXGIAdapter> dxgiAdapter;
+        DXGI_ADAPTER_DESC adapterDesc{};
+        XRC_CHECK_THROW_HRCMD(d3d11Device.As(&dxgiDevice));
+        XRC_CHECK_THROW_HRCMD(dxgiDevice->GetAdapter(&dxgiAdapter));
+        XRC_CHECK_THROW_HRCMD(dxgiAdapter->GetDesc(&adapterDesc));
+        if (memcmp(&adapterDesc.AdapterLuid, &graphicsRequirements.adapterLuid, sizeof(LUID)) != 0 ||
+            d3d11Device->GetFeatureLevel() < graphicsRequirements.minFeatureLevel) {
+            return false;
+        }
+
+        Flush();
+        m_swapchainImageDataMap.Reset();
+        return true;
+    }
+
     const XrBaseInStructure* D3D11GraphicsPlugin::GetGraphicsBinding() const
     {
         if (graphicsBinding.device) {
@@ -450,6 +728,7 @@ namespace Conformance
 
     void D3D11GraphicsPlugin::CopyRGBAImage(const XrSwapchainImageBaseHeader* swapchainImage, uint32_t arraySlice, const RGBAImage& image)
     {
+        XRC_TRACE_SCOPE("D3D11GraphicsPlugin::CopyRGBAImage");
         D3D11_TEXTURE2D_DESC rgbaImageDesc{};
         rgbaImageDesc.Width = image.width;
         rgbaImageDesc.Height = image.height;
@@ -484,8 +763,10 @@ namespace Conformance
 
         const UINT destSubResource = D3D11CalcSubresource(0, arraySlice, destDesc.MipLevels);
         const D3D11_BOX sourceRegion{0, 0, 0, rgbaImageDesc.Width, rgbaImageDesc.Height, 1};
+        m_gpuTimers.BeginInterval(d3d11Device.Get(), d3d11DeviceContext.Get(), "CopyRGBAImage");
         d3d11DeviceContext->CopySubresourceRegion(destTexture, destSubResource, 0 /* X */, 0 /* Y */, 0 /* Z */, texture2D.Get(), 0,
                                                   &sourceRegion);
+        m_gpuTimers.EndInterval(d3d11DeviceContext.Get());
     }
 
     std::string D3D11GraphicsPlugin::GetImageFormatName(int64_t imageFormat) const
@@ -692,6 +973,8 @@ namespace Conformance
 
         std::tie(swapchainData, imageIndex) = m_swapchainImageDataMap.GetDataAndIndexFromBasePointer(colorSwapchainImage);
 
+        m_gpuTimers.BeginInterval(d3d11Device.Get(), d3d11DeviceContext.Get(), "ClearImageSlice");
+
         // Clear color buffer.
         // Create RenderTargetView with original swapchain format (swapchain is typeless).
         ComPtr<ID3D11RenderTargetView> renderTargetView = CreateRenderTargetView(*swapchainData, imageIndex, imageArrayIndex);
@@ -701,17 +984,35 @@ namespace Conformance
         // Clear depth buffer.
         ComPtr<ID3D11DepthStencilView> depthStencilView = CreateDepthStencilView(*swapchainData, imageIndex, imageArrayIndex);
         d3d11DeviceContext->ClearDepthStencilView(depthStencilView.Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+
+        m_gpuTimers.EndInterval(d3d11DeviceContext.Get());
     }
 
     inline MeshHandle D3D11GraphicsPlugin::MakeSimpleMesh(span<const uint16_t> idx, span<const Geometry::Vertex> vtx)
     {
+        // A mesh with the same content shares the buffers created then.
+        MeshHandle cachedHandle = m_meshesByContent.Find(idx, vtx);
+        if (cachedHandle != MeshHandle{}) {
+            return cachedHandle;
+        }
+
         auto handle = m_meshes.emplace_back(d3d11Device, idx, vtx);
+        m_meshesByContent.Insert(idx, vtx, handle);
         return handle;
     }
 
     GLTFModelHandle D3D11GraphicsPlugin::LoadGLTF(Gltf::ModelBuilder&& modelBuilder)
     {
+        XRC_TRACE_SCOPE("D3D11GraphicsPlugin::LoadGLTF");
+        // A scene already loaded on this device shares the model built then.
+        std::shared_ptr<const Gltf::DecodedScene> scene = modelBuilder.GetDecodedScene();
+        GLTFModelHandle cachedHandle = m_gltfModelsByScene.Find(scene);
+        if (cachedHandle != GLTFModelHandle{}) {
+            return cachedHandle;
+        }
+
         auto handle = m_gltfModels.emplace_back(modelBuilder.Build(*m_pbrResources));
+        m_gltfModelsByScene.Insert(std::move(scene), handle);
         return handle;
     }
 
@@ -735,14 +1036,13 @@ namespace Conformance
     void D3D11GraphicsPlugin::RenderView(const XrCompositionLayerProjectionView& layerView,
                                          const XrSwapchainImageBaseHeader* colorSwapchainImage, const RenderParams& params)
     {
+        XRC_TRACE_SCOPE("D3D11GraphicsPlugin::RenderView");
         D3D11SwapchainImageData* swapchainData;
         uint32_t imageIndex;
 
         std::tie(swapchainData, imageIndex) = m_swapchainImageDataMap.GetDataAndIndexFromBasePointer(colorSwapchainImage);
 
-        CD3D11_VIEWPORT viewport((float)layerView.subImage.imageRect.offset.x, (float)layerView.subImage.imageRect.offset.y,
-                                 (float)layerView.subImage.imageRect.extent.width, (float)layerView.subImage.imageRect.extent.height);
-        d3d11DeviceContext->RSSetViewports(1, &viewport);
+        m_gpuTimers.BeginInterval(d3d11Device.Get(), d3d11DeviceContext.Get(), "RenderView");
 
         // Create RenderTargetView with original swapchain format (swapchain is typeless).
         ComPtr<ID3D11RenderTargetView> renderTargetView =
@@ -750,8 +1050,84 @@ namespace Conformance
 
         ComPtr<ID3D11DepthStencilView> depthStencilView =
             CreateDepthStencilView(*swapchainData, imageIndex, layerView.subImage.imageArrayIndex);
-        std::array<ID3D11RenderTargetView*, 1> renderTargets{{renderTargetView.Get()}};
-        d3d11DeviceContext->OMSetRenderTargets((UINT)renderTargets.size(), renderTargets.data(), depthStencilView.Get());
+
+        RecordMeshes(d3d11DeviceContext.Get(), m_meshRecorder, layerView, renderTargetView.Get(), depthStencilView.Get(), params);
+        RecordGltfs(d3d11DeviceContext, layerView, params);
+
+        m_gpuTimers.EndInterval(d3d11DeviceContext.Get());
+    }
+
+    void D3D11GraphicsPlugin::RenderViews(span<const XrCompositionLayerProjectionView> layerViews,
+                                          span<const XrSwapchainImageBaseHeader* const> colorSwapchainImages, const RenderParams& params)
+    {
+        // Deferred contexts cannot be created on a single-threaded device.
+        if (!GetGlobalData().options.parallelViewRecording || layerViews.size() < 2 ||
+            (d3d11Device->GetCreationFlags() & D3D11_CREATE_DEVICE_SINGLETHREADED) != 0) {
+            IGraphicsPlugin::RenderViews(layerViews, colorSwapchainImages, params);
+            return;
+        }
+
+        const size_t viewCount = layerViews.size();
+        while (m_deferredRecorders.size() < viewCount) {
+            D3D11DeferredViewRecorder recorder;
+            XRC_CHECK_THROW_HRCMD(d3d11Device->CreateDeferredContext(0, recorder.context.ReleaseAndGetAddressOf()));
+            m_deferredRecorders.push_back(std::move(recorder));
+        }
+
+        // Views are created here rather than on the workers, since the first use of an image may allocate its fallback depth.
+        std::vector<ComPtr<ID3D11RenderTargetView>> renderTargetViews(viewCount);
+        std::vector<ComPtr<ID3D11DepthStencilView>> depthStencilViews(viewCount);
+        for (size_t i = 0; i < viewCount; ++i) {
+            D3D11SwapchainImageData* swapchainData;
+            uint32_t imageIndex;
+            std::tie(swapchainData, imageIndex) = m_swapchainImageDataMap.GetDataAndIndexFromBasePointer(colorSwapchainImages[i]);
+            renderTargetViews[i] = CreateRenderTargetView(*swapchainData, imageIndex, layerViews[i].subImage.imageArrayIndex);
+            depthStencilViews[i] = CreateDepthStencilView(*swapchainData, imageIndex, layerViews[i].subImage.imageArrayIndex);
+        }
+
+        // Record the meshes of each view on its own thread.
+        std::vector<std::future<void>> workers;
+        workers.reserve(viewCount);
+        for (size_t i = 0; i < viewCount; ++i) {
+            workers.push_back(std::async(std::launch::async, [&, i] {
+                D3D11DeferredViewRecorder& recorder = m_deferredRecorders[i];
+                RecordMeshes(recorder.context.Get(), recorder.meshes, layerViews[i], renderTargetViews[i].Get(),
+                             depthStencilViews[i].Get(), params);
+            }));
+        }
+        for (auto& worker : workers) {
+            worker.wait();
+        }
+        for (auto& worker : workers) {
+            worker.get();  // rethrows
+        }
+
+        // The deferred contexts keep their state, so glTFs follow the meshes of each view, recorded in view order here.
+        std::vector<ComPtr<ID3D11CommandList>> commandLists(viewCount);
+        for (size_t i = 0; i < viewCount; ++i) {
+            const ComPtr<ID3D11DeviceContext>& context = m_deferredRecorders[i].context;
+            RecordGltfs(context, layerViews[i], params);
+            XRC_CHECK_THROW_HRCMD(context->FinishCommandList(FALSE, commandLists[i].ReleaseAndGetAddressOf()));
+        }
+
+        // Timestamp queries can only be read back on the immediate context, so the views are timed as they execute.
+        m_gpuTimers.BeginInterval(d3d11Device.Get(), d3d11DeviceContext.Get(), "RenderViews");
+        for (const ComPtr<ID3D11CommandList>& commandList : commandLists) {
+            d3d11DeviceContext->ExecuteCommandList(commandList.Get(), FALSE);
+        }
+        m_gpuTimers.EndInterval(d3d11DeviceContext.Get());
+    }
+
+    void D3D11GraphicsPlugin::RecordMeshes(ID3D11DeviceContext* context, D3D11MeshRecorder& meshRecorder,
+                                           const XrCompositionLayerProjectionView& layerView, ID3D11RenderTargetView* renderTargetView,
+                                           ID3D11DepthStencilView* depthStencilView, const RenderParams& params)
+    {
+        CD3D11_VIEWPORT viewport((float)layerView.subImage.imageRect.offset.x, (float)layerView.subImage.imageRect.offset.y,
+                                 (float)layerView.subImage.imageRect.extent.width, (float)layerView.subImage.imageRect.extent.height);
+        context->RSSetViewports(1, &viewport);
+
+        std::array<ID3D11RenderTargetView*, 1> renderTargets{{renderTargetView}};
+        context->OMSetRenderTargets((UINT)renderTargets.size(), renderTargets.data(), depthStencilView);
 
         const XMMATRIX spaceToView = XMMatrixInverse(nullptr, LoadXrPose(layerView.pose));
         XrMatrix4x4f projectionMatrix;
@@ -760,68 +1136,100 @@ namespace Conformance
         // Set shaders and constant buffers.
         ViewProjectionConstantBuffer viewProjection;
         XMStoreFloat4x4(&viewProjection.ViewProjection, XMMatrixTranspose(spaceToView * LoadXrMatrix(projectionMatrix)));
-        d3d11DeviceContext->UpdateSubresource(viewProjectionCBuffer.Get(), 0, nullptr, &viewProjection, 0, 0);
+        context->UpdateSubresource(viewProjectionCBuffer.Get(), 0, nullptr, &viewProjection, 0, 0);
 
-        std::array<ID3D11Buffer*, 2> constantBuffers{{modelCBuffer.Get(), viewProjectionCBuffer.Get()}};
-        d3d11DeviceContext->VSSetConstantBuffers(0, (UINT)constantBuffers.size(), constantBuffers.data());
-        d3d11DeviceContext->VSSetShader(vertexShader.Get(), nullptr, 0);
-        d3d11DeviceContext->PSSetShader(pixelShader.Get(), nullptr, 0);
+        std::array<ID3D11Buffer*, 1> constantBuffers{{viewProjectionCBuffer.Get()}};
+        context->VSSetConstantBuffers(1, (UINT)constantBuffers.size(), constantBuffers.data());
+        context->VSSetShader(vertexShader.Get(), nullptr, 0);
+        context->PSSetShader(pixelShader.Get(), nullptr, 0);
 
         // Set cube primitive data.
-        d3d11DeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-        d3d11DeviceContext->IASetInputLayout(inputLayout.Get());
-        MeshHandle lastMeshHandle;
-
-        const auto drawMesh = [&, this](const MeshDrawable mesh) {
-            D3D11Mesh& d3dMesh = m_meshes[mesh.handle];
-            if (mesh.handle != lastMeshHandle) {
-                // We are now rendering a new mesh
-                // Set primitive data.
-
-                const UINT strides[] = {sizeof(Geometry::Vertex)};
-                const UINT offsets[] = {0};
-                std::array<ID3D11Buffer*, 1> vertexBuffers{{d3dMesh.vertexBuffer.Get()}};
-                d3d11DeviceContext->IASetVertexBuffers(0, (UINT)vertexBuffers.size(), vertexBuffers.data(), strides, offsets);
-                d3d11DeviceContext->IASetIndexBuffer(d3dMesh.indexBuffer.Get(), DXGI_FORMAT_R16_UINT, 0);
-
-                lastMeshHandle = mesh.handle;
+        context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        context->IASetInputLayout(inputLayout.Get());
+
+        // Compute the per-instance data for all cubes and meshes and upload it at once.
+        meshRecorder.meshBatches.Build(params, m_cubeMesh);
+        const std::vector<MeshDrawable>& instances = meshRecorder.meshBatches.Instances();
+        if (!instances.empty()) {
+            if (meshRecorder.instanceBufferCapacity < instances.size()) {
+                meshRecorder.instanceBufferCapacity = std::max((uint32_t)instances.size(), 2 * meshRecorder.instanceBufferCapacity);
+                const CD3D11_BUFFER_DESC instanceBufferDesc(meshRecorder.instanceBufferCapacity * sizeof(MeshInstance),
+                                                            D3D11_BIND_VERTEX_BUFFER, D3D11_USAGE_DYNAMIC, D3D11_CPU_ACCESS_WRITE);
+                XRC_CHECK_THROW_HRCMD(
+                    d3d11Device->CreateBuffer(&instanceBufferDesc, nullptr, meshRecorder.instanceBuffer.ReleaseAndGetAddressOf()));
             }
 
-            // Compute and update the model transform.
-            ModelConstantBuffer model;
-            XMStoreFloat4x4(&model.Model, XMMatrixTranspose(XMMatrixScaling(mesh.params.scale.x, mesh.params.scale.y, mesh.params.scale.z) *
-                                                            LoadXrPose(mesh.params.pose)));
-            model.TintColor = {mesh.tintColor.r, mesh.tintColor.g, mesh.tintColor.b, mesh.tintColor.a};
-            d3d11DeviceContext->UpdateSubresource(modelCBuffer.Get(), 0, nullptr, &model, 0, 0);
-
-            // Draw the mesh.
-            d3d11DeviceContext->DrawIndexed(d3dMesh.numIndices, 0, 0);
-        };
+            D3D11_MAPPED_SUBRESOURCE mapped;
+            XRC_CHECK_THROW_HRCMD(context->Map(meshRecorder.instanceBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped));
+            MeshInstance* instanceData = reinterpret_cast<MeshInstance*>(mapped.pData);
+            for (size_t i = 0; i < instances.size(); ++i) {
+                const MeshDrawable& mesh = instances[i];
+                XMStoreFloat4x4(&instanceData[i].Model, XMMatrixScaling(mesh.params.scale.x, mesh.params.scale.y, mesh.params.scale.z) *
+                                                            LoadXrPose(mesh.params.pose));
+                instanceData[i].TintColor = {mesh.tintColor.r, mesh.tintColor.g, mesh.tintColor.b, mesh.tintColor.a};
+            }
+            context->Unmap(meshRecorder.instanceBuffer.Get(), 0);
+        }
+
+        // Draw all instances of each mesh with a single call.
+        for (const MeshInstanceBatches::Batch& batch : meshRecorder.meshBatches.Batches()) {
+            D3D11Mesh& d3dMesh = m_meshes[batch.handle];
+
+            // Set primitive data.
+            const UINT strides[] = {sizeof(Geometry::Vertex), sizeof(MeshInstance)};
+            const UINT offsets[] = {0, 0};
+            std::array<ID3D11Buffer*, 2> vertexBuffers{{d3dMesh.vertexBuffer.Get(), meshRecorder.instanceBuffer.Get()}};
+            context->IASetVertexBuffers(0, (UINT)vertexBuffers.size(), vertexBuffers.data(), strides, offsets);
+            context->IASetIndexBuffer(d3dMesh.indexBuffer.Get(), DXGI_FORMAT_R16_UINT, 0);
 
-        // Render each cube
-        for (const Cube& cube : params.cubes) {
-            drawMesh(MeshDrawable{m_cubeMesh, cube.params.pose, cube.params.scale, cube.tintColor});
+            context->DrawIndexedInstanced(d3dMesh.numIndices, batch.instanceCount, 0, 0, batch.firstInstance);
         }
+    }
 
-        // Render each mesh
-        for (const auto& mesh : params.meshes) {
-            drawMesh(mesh);
+    void D3D11GraphicsPlugin::RecordGltfs(const ComPtr<ID3D11DeviceContext>& context, const XrCompositionLayerProjectionView& layerView,
+                                          const RenderParams& params)
+    {
+        if (params.glTFs.empty()) {
+            return;
         }
 
-        // Render each gltf
-        for (const auto& gltfDrawable : params.glTFs) {
+        // Render the gltfs, with the primitives of all of them sorted to minimize state changes
+        XrMatrix4x4f projectionMatrix;
+        XrMatrix4x4f_CreateProjectionFov(&projectionMatrix, GRAPHICS_D3D, layerView.fov, 0.05f, 100.0f);
+        XrMatrix4x4f viewMatrix = Matrix::FromPose(layerView.pose);
+        XrMatrix4x4f viewMatrixInverse = Matrix::InvertRigidBody(viewMatrix);
+        m_pbrResources->SetViewProjection(LoadXrMatrix(viewMatrixInverse), LoadXrMatrix(projectionMatrix));
+        m_pbrResources->Bind(context.Get());
+        const XrMatrix4x4f viewProjectionMatrix = projectionMatrix * viewMatrixInverse;
+
+        m_gltfDrawQueue.Clear();
+        for (uint32_t i = 0; i < (uint32_t)params.glTFs.size(); i++) {
+            const auto& gltfDrawable = params.glTFs[i];
             D3D11GLTF& gltf = m_gltfInstances[gltfDrawable.handle];
             // Compute and update the model transform.
 
             XrMatrix4x4f modelToWorld = Matrix::FromTranslationRotationScale(
                 gltfDrawable.params.pose.position, gltfDrawable.params.pose.orientation, gltfDrawable.params.scale);
 
-            XrMatrix4x4f viewMatrix = Matrix::FromPose(layerView.pose);
-            XrMatrix4x4f viewMatrixInverse = Matrix::InvertRigidBody(viewMatrix);
-            m_pbrResources->SetViewProjection(LoadXrMatrix(viewMatrixInverse), LoadXrMatrix(projectionMatrix));
+            gltf.Prepare(context, *m_pbrResources, modelToWorld, viewProjectionMatrix, i, m_gltfDrawQueue);
+        }
+        m_gltfDrawQueue.Sort();
 
-            gltf.Render(d3d11DeviceContext, *m_pbrResources, modelToWorld);
+        Pbr::DrawBindState bindState;
+        for (const Pbr::DrawItem& item : m_gltfDrawQueue.Items()) {
+            m_gltfInstances[params.glTFs[item.drawable].handle].Draw(context, *m_pbrResources, item, bindState);
+        }
+        bindState.stats.views++;
+        bindState.stats.culled += m_gltfDrawQueue.GetCulledCount();
+        m_gltfDrawStats += bindState.stats;
+    }
+
+    void D3D11GraphicsPlugin::CollectGpuTimerSamples(std::vector<GpuTimerSample>& samples)
+    {
+        if (d3d11DeviceContext) {
+            m_gpuTimers.ResolveIntervals(d3d11DeviceContext.Get(), false);
         }
+        m_gpuTimers.Scopes().TakeSamples(samples);
     }
 
     std::shared_ptr<IGraphicsPlugin> CreateGraphicsPlugin_D3D11(std::shared_ptr<IPlatformPlugin> platformPlugin)
@@ -28,5 +28,23 @@ namespace Conformance
         GetModelInstance().Render(resources, deviceContext.Get(), LoadXrMatrix(modelToWorld));
     }
 
+    void D3D11GLTF::Prepare(ComPtr<ID3D11DeviceContext> deviceContext, Pbr::D3D11Resources& resources, XrMatrix4x4f& modelToWorld,
+                            const XrMatrix4x4f& viewProjection, uint32_t drawable, Pbr::DrawQueue& queue)
+    {
+        GetModelInstance().Prepare(resources, deviceContext.Get(), LoadXrMatrix(modelToWorld));
+
+        XrMatrix4x4f modelToClip;
+        XrMatrix4x4f_Multiply(&modelToClip, &viewProjection, &modelToWorld);
+        const Pbr::Frustum frustum(modelToClip);
+        GetModelInstance().AppendDraws(resources, GetFillMode(), drawable, queue, &frustum);
+    }
+
+    void D3D11GLTF::Draw(ComPtr<ID3D11DeviceContext> deviceContext, Pbr::D3D11Resources& resources, const Pbr::DrawItem& item,
+                         Pbr::DrawBindState& bindState)
+    {
+        resources.SetFillMode(item.fillMode);
+        GetModelInstance().DrawPrimitive(resources, deviceContext.Get(), item, bindState);
+    }
+
 }  // namespace Conformance
 #endif
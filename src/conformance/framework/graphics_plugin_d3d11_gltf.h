@@ -34,6 +34,15 @@ namespace Conformance
         using RenderableGltfModelInstanceBase::RenderableGltfModelInstanceBase;
 
         void Render(ComPtr<ID3D11DeviceContext> deviceContext, Pbr::D3D11Resources& resources, XrMatrix4x4f& modelToWorld);
+
+        /// Upload the transforms of the model and add its primitives in view of @p viewProjection to @p queue as model
+        /// @p drawable, to draw them sorted together with the primitives of other models.
+        void Prepare(ComPtr<ID3D11DeviceContext> deviceContext, Pbr::D3D11Resources& resources, XrMatrix4x4f& modelToWorld,
+                     const XrMatrix4x4f& viewProjection, uint32_t drawable, Pbr::DrawQueue& queue);
+
+        /// Draw a primitive added to a queue by Prepare.
+        void Draw(ComPtr<ID3D11DeviceContext> deviceContext, Pbr::D3D11Resources& resources, const Pbr::DrawItem& item,
+                  Pbr::DrawBindState& bindState);
     };
 }  // namespace Conformance
 #endif
@@ -21,7 +21,9 @@
 #include "graphics_plugin.h"
 #include "graphics_plugin_d3d12_gltf.h"
 #include "graphics_plugin_impl_helpers.h"
+#include "mesh_instance_batches.h"
 #include "report.h"
+#include "startup_timing.h"
 #include "swapchain_image_data.h"
 
 #include "common/xr_dependencies.h"
@@ -36,6 +38,7 @@
 #include "utilities/destruction_queue.h"
 #include "utilities/swapchain_parameters.h"
 #include "utilities/throw_helpers.h"
+#include "utilities/trace.h"
 
 #include <D3Dcompiler.h>
 #include <DirectXColors.h>
@@ -45,8 +48,12 @@
 
 #include <algorithm>
 #include <array>
+#include <deque>
 #include <dxgiformat.h>
 #include <functional>
+#include <map>
+#include <stdint.h>
+#include <string.h>
 #include <windows.h>
 
 using namespace Microsoft::WRL;
@@ -92,7 +99,6 @@ namespace Conformance
 
     struct D3D12Mesh
     {
-        ComPtr<ID3D12Device> device;
         uint32_t vertexBufferSizeBytes;
         ComPtr<ID3D12Resource> vertexBuffer;
         uint32_t indexBufferSizeBytes;
@@ -100,60 +106,28 @@ namespace Conformance
         ComPtr<ID3D12Resource> indexBuffer;
         UINT numIndices;
 
-        D3D12Mesh(ComPtr<ID3D12Device> d3d12Device, span<const uint16_t> indices, span<const Geometry::Vertex> vertices,
-                  const std::shared_ptr<D3D12QueueWrapper>& queueWrapper)
-            : device(d3d12Device), numIndices((UINT)indices.size())
+        /// Place the buffers with @p bufferAllocator, and record copies of their contents from @p uploadRing into @p cmdList.
+        D3D12Mesh(span<const uint16_t> indices, span<const Geometry::Vertex> vertices, D3D12PlacedBufferAllocator& bufferAllocator,
+                  D3D12UploadRing& uploadRing, ID3D12GraphicsCommandList* cmdList)
+            : numIndices((UINT)indices.size())
         {
-
-            ComPtr<ID3D12CommandAllocator> commandAllocator;
-
-            XRC_CHECK_THROW_HRCMD(d3d12Device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, __uuidof(ID3D12CommandAllocator),
-                                                                      reinterpret_cast<void**>(commandAllocator.ReleaseAndGetAddressOf())));
-            XRC_CHECK_THROW_HRCMD(commandAllocator->SetName(L"CTS mesh upload command allocator"));
-
-            ComPtr<ID3D12GraphicsCommandList> cmdList;
-            XRC_CHECK_THROW_HRCMD(d3d12Device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, commandAllocator.Get(), nullptr,
-                                                                 __uuidof(ID3D12GraphicsCommandList),
-                                                                 reinterpret_cast<void**>(cmdList.ReleaseAndGetAddressOf())));
-            XRC_CHECK_THROW_HRCMD(cmdList->SetName(L"CTS mesh upload command list"));
-
             vertexBufferSizeBytes = (uint32_t)vertices.size_bytes();
-            ComPtr<ID3D12Resource> vertexBufferUpload;
-            vertexBuffer = D3D12CreateBuffer(d3d12Device.Get(), vertexBufferSizeBytes, D3D12_HEAP_TYPE_DEFAULT);
+            vertexBuffer = bufferAllocator.CreateBuffer(vertexBufferSizeBytes);
             XRC_CHECK_THROW_HRCMD(vertexBuffer->SetName(L"CTS mesh vertex buffer"));
             {
-                vertexBufferUpload = D3D12CreateBuffer(d3d12Device.Get(), vertexBufferSizeBytes, D3D12_HEAP_TYPE_UPLOAD);
-                XRC_CHECK_THROW_HRCMD(vertexBufferUpload->SetName(L"CTS mesh vertex buffer upload"));
-
-                void* data;
-                const D3D12_RANGE readRange{0, 0};
-                XRC_CHECK_THROW_HRCMD(vertexBufferUpload->Map(0, &readRange, &data));
-                memcpy(data, vertices.data(), vertexBufferSizeBytes);
-                vertexBufferUpload->Unmap(0, nullptr);
-
-                cmdList->CopyBufferRegion(vertexBuffer.Get(), 0, vertexBufferUpload.Get(), 0, vertexBufferSizeBytes);
+                const D3D12UploadRing::Allocation upload = uploadRing.Allocate(vertexBufferSizeBytes);
+                memcpy(upload.cpuAddress, vertices.data(), vertexBufferSizeBytes);
+                cmdList->CopyBufferRegion(vertexBuffer.Get(), 0, upload.resource, upload.offset, vertexBufferSizeBytes);
             }
 
             indexBufferSizeBytes = (uint32_t)indices.size_bytes();
-            ComPtr<ID3D12Resource> indexBufferUpload;
-            indexBuffer = D3D12CreateBuffer(d3d12Device.Get(), indexBufferSizeBytes, D3D12_HEAP_TYPE_DEFAULT);
+            indexBuffer = bufferAllocator.CreateBuffer(indexBufferSizeBytes);
             XRC_CHECK_THROW_HRCMD(indexBuffer->SetName(L"CTS mesh index buffer"));
             {
-                indexBufferUpload = D3D12CreateBuffer(d3d12Device.Get(), indexBufferSizeBytes, D3D12_HEAP_TYPE_UPLOAD);
-                XRC_CHECK_THROW_HRCMD(indexBufferUpload->SetName(L"CTS mesh index buffer upload"));
-
-                void* data;
-                const D3D12_RANGE readRange{0, 0};
-                XRC_CHECK_THROW_HRCMD(indexBufferUpload->Map(0, &readRange, &data));
-                memcpy(data, indices.data(), indexBufferSizeBytes);
-                indexBufferUpload->Unmap(0, nullptr);
-
-                cmdList->CopyBufferRegion(indexBuffer.Get(), 0, indexBufferUpload.Get(), 0, indexBufferSizeBytes);
+                const D3D12UploadRing::Allocation upload = uploadRing.Allocate(indexBufferSizeBytes);
+                memcpy(upload.cpuAddress, indices.data(), indexBufferSizeBytes);
+                cmdList->CopyBufferRegion(indexBuffer.Get(), 0, upload.resource, upload.offset, indexBufferSizeBytes);
             }
-
-            XRC_CHECK_THROW_HRCMD(cmdList->Close());
-            XRC_CHECK_THROW(queueWrapper->ExecuteCommandList(cmdList.Get()));
-            queueWrapper->CPUWaitOnFence();
         }
     };
 
@@ -215,6 +189,63 @@ namespace Conformance
         XrSwapchainImageD3D12KHR m_xrImage{XR_TYPE_SWAPCHAIN_IMAGE_D3D11_KHR};
     };
 
+    /// CPU-only descriptors of one heap type for views of single array slices of textures, created the first time each slice
+    /// is used and kept until @ref Reset.
+    class D3D12SliceViewCache
+    {
+    public:
+        D3D12SliceViewCache(D3D12_DESCRIPTOR_HEAP_TYPE type) : m_type(type)
+        {
+        }
+
+        /// Get the view of slice @p imageArrayIndex of @p texture, first calling @p createView with a new descriptor to write it
+        /// to if there is none yet.
+        D3D12_CPU_DESCRIPTOR_HANDLE GetOrCreate(ID3D12Device* device, ID3D12Resource* texture, uint32_t imageArrayIndex,
+                                                const std::function<void(D3D12_CPU_DESCRIPTOR_HANDLE)>& createView)
+        {
+            const auto key = std::make_pair(texture, imageArrayIndex);
+            auto it = m_views.find(key);
+            if (it != m_views.end()) {
+                return it->second;
+            }
+
+            if (m_heaps.empty() || m_usedInLastHeap == kDescriptorsPerHeap) {
+                D3D12_DESCRIPTOR_HEAP_DESC heapDesc{};
+                heapDesc.NumDescriptors = kDescriptorsPerHeap;
+                heapDesc.Type = m_type;
+                heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+                ComPtr<ID3D12DescriptorHeap> heap;
+                XRC_CHECK_THROW_HRCMD(device->CreateDescriptorHeap(&heapDesc, __uuidof(ID3D12DescriptorHeap),
+                                                                   reinterpret_cast<void**>(heap.ReleaseAndGetAddressOf())));
+                XRC_CHECK_THROW_HRCMD(heap->SetName(m_type == D3D12_DESCRIPTOR_HEAP_TYPE_RTV ? L"CTS RTV heap" : L"CTS DSV heap"));
+                m_heaps.push_back(std::move(heap));
+                m_usedInLastHeap = 0;
+            }
+
+            D3D12_CPU_DESCRIPTOR_HANDLE view = m_heaps.back()->GetCPUDescriptorHandleForHeapStart();
+            view.ptr += (SIZE_T)m_usedInLastHeap * device->GetDescriptorHandleIncrementSize(m_type);
+            m_usedInLastHeap++;
+            createView(view);
+            m_views.emplace(key, view);
+            return view;
+        }
+
+        void Reset()
+        {
+            m_views.clear();
+            m_heaps.clear();
+            m_usedInLastHeap = 0;
+        }
+
+    private:
+        static constexpr UINT kDescriptorsPerHeap = 16;
+
+        D3D12_DESCRIPTOR_HEAP_TYPE m_type;
+        std::vector<ComPtr<ID3D12DescriptorHeap>> m_heaps;
+        UINT m_usedInLastHeap{0};
+        std::map<std::pair<ID3D12Resource*, uint32_t>, D3D12_CPU_DESCRIPTOR_HANDLE> m_views;
+    };
+
     class D3D12SwapchainImageData : public SwapchainImageDataBase<XrSwapchainImageD3D12KHR>
     {
         void init()
@@ -223,9 +254,6 @@ namespace Conformance
                 m_d3d12Device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, __uuidof(ID3D12CommandAllocator),
                                                       reinterpret_cast<void**>(commandAllocator.ReleaseAndGetAddressOf())));
             XRC_CHECK_THROW_HRCMD(commandAllocator->SetName(L"CTS swapchain command allocator"));
-
-            viewProjectionCBuffer = D3D12CreateBuffer(m_d3d12Device.Get(), sizeof(ViewProjectionConstantBuffer), D3D12_HEAP_TYPE_UPLOAD);
-            XRC_CHECK_THROW_HRCMD(viewProjectionCBuffer->SetName(L"CTS view proj cbuffer"));
         }
 
     public:
@@ -248,6 +276,8 @@ namespace Conformance
 
         void Reset() override
         {
+            m_renderTargetViews.Reset();
+            m_depthStencilViews.Reset();
             m_internalDepthTextures.clear();
             m_d3d12Device = nullptr;
             SwapchainImageDataBase::Reset();
@@ -276,30 +306,165 @@ namespace Conformance
             XRC_CHECK_THROW_HRCMD(commandAllocator->Reset());
         }
 
-        void RequestModelCBuffer(uint32_t requiredSize)
+        /// Render target views of the slices of the color images
+        D3D12SliceViewCache& RenderTargetViews()
+        {
+            return m_renderTargetViews;
+        }
+
+        /// Depth stencil views of the slices of the depth images, whether from the depth swapchain or the fallback
+        D3D12SliceViewCache& DepthStencilViews()
+        {
+            return m_depthStencilViews;
+        }
+
+    private:
+        ComPtr<ID3D12Device> m_d3d12Device;
+        ComPtr<ID3D12CommandAllocator> commandAllocator;
+        std::vector<D3D12FallbackDepthTexture> m_internalDepthTextures;
+        D3D12SliceViewCache m_renderTargetViews{D3D12_DESCRIPTOR_HEAP_TYPE_RTV};
+        D3D12SliceViewCache m_depthStencilViews{D3D12_DESCRIPTOR_HEAP_TYPE_DSV};
+    };
+
+    /// A timestamp query heap with a readback buffer, bracketing the operations timed for a GpuTimerScopes
+    class D3D12GpuTimers
+    {
+    public:
+        GpuTimerScopes& Scopes()
+        {
+            return m_scopes;
+        }
+
+        void Init(ID3D12Device* device, ID3D12CommandQueue* queue)
+        {
+            D3D12_QUERY_HEAP_DESC heapDesc{};
+            heapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+            heapDesc.Count = 2 * kMaxIntervals;
+            XRC_CHECK_THROW_HRCMD(device->CreateQueryHeap(&heapDesc, __uuidof(ID3D12QueryHeap),
+                                                          reinterpret_cast<void**>(m_queryHeap.ReleaseAndGetAddressOf())));
+            XRC_CHECK_THROW_HRCMD(m_queryHeap->SetName(L"CTS GPU timer query heap"));
+            m_readbackBuffer = D3D12CreateBuffer(device, 2 * kMaxIntervals * sizeof(uint64_t), D3D12_HEAP_TYPE_READBACK);
+            XRC_CHECK_THROW_HRCMD(m_readbackBuffer->SetName(L"CTS GPU timer readback buffer"));
+            XRC_CHECK_THROW_HRCMD(queue->GetTimestampFrequency(&m_frequency));
+
+            m_freeSlots.clear();
+            for (uint32_t slot = 0; slot < kMaxIntervals; ++slot) {
+                m_freeSlots.push_back(slot);
+            }
+        }
+
+        /// Record the start timestamp of an interval for @p operationName into @p cmdList, if it is to be timed.
+        void BeginInterval(ID3D12GraphicsCommandList* cmdList, const char* operationName)
+        {
+            AbandonCurrentInterval();
+            const uint64_t id = m_scopes.BeginInterval(operationName);
+            if (id == 0) {
+                return;
+            }
+            if (!m_queryHeap || m_freeSlots.empty()) {
+                // Every slot is waiting for the GPU, so this interval cannot be measured.
+                m_scopes.ResolveInterval(id, std::chrono::nanoseconds{0}, false);
+                return;
+            }
+            const uint32_t slot = m_freeSlots.back();
+            m_freeSlots.pop_back();
+            cmdList->EndQuery(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, 2 * slot);
+            m_current = Interval{id, slot, 0};
+            m_currentCmdList = cmdList;
+        }
+
+        /// Record the end timestamp of the interval begun in @p cmdList, if any, and copy both to the readback buffer.
+        void EndInterval(ID3D12GraphicsCommandList* cmdList)
+        {
+            if (m_current.id == 0 || m_currentCmdList != cmdList) {
+                return;
+            }
+            const uint32_t slot = m_current.slot;
+            cmdList->EndQuery(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, 2 * slot + 1);
+            cmdList->ResolveQueryData(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, 2 * slot, 2, m_readbackBuffer.Get(),
+                                      2 * slot * sizeof(uint64_t));
+            m_ended.push_back(m_current);
+            m_current = {};
+            m_currentCmdList = nullptr;
+        }
+
+        /// The command lists of the intervals ended since the last call were executed before signaling @p fenceValue.
+        void Submitted(uint64_t fenceValue)
         {
-            if (!modelCBuffer || (requiredSize > modelCBuffer->GetDesc().Width)) {
-                modelCBuffer = D3D12CreateBuffer(m_d3d12Device.Get(), requiredSize, D3D12_HEAP_TYPE_UPLOAD);
-                XRC_CHECK_THROW_HRCMD(modelCBuffer->SetName(L"CTS model cbuffer"));
+            for (Interval& interval : m_ended) {
+                interval.fenceValue = fenceValue;
+                m_pending.push_back(interval);
             }
+            m_ended.clear();
         }
 
-        ID3D12Resource* GetModelCBuffer() const
+        /// Resolve the intervals whose submissions have reached @p completedFenceValue.
+        void ResolveIntervals(uint64_t completedFenceValue)
         {
-            return modelCBuffer.Get();
+            while (!m_pending.empty() && m_pending.front().fenceValue <= completedFenceValue) {
+                const Interval& interval = m_pending.front();
+                const D3D12_RANGE readRange{2 * interval.slot * sizeof(uint64_t), (2 * interval.slot + 2) * sizeof(uint64_t)};
+                uint64_t* data = nullptr;
+                XRC_CHECK_THROW_HRCMD(m_readbackBuffer->Map(0, &readRange, reinterpret_cast<void**>(&data)));
+                const uint64_t begin = data[2 * interval.slot];
+                const uint64_t end = data[2 * interval.slot + 1];
+                const D3D12_RANGE writeRange{0, 0};
+                m_readbackBuffer->Unmap(0, &writeRange);
+
+                const bool valid = m_frequency != 0 && end >= begin;
+                const double nanoseconds = valid ? (double)(end - begin) * 1e9 / (double)m_frequency : 0.0;
+                m_scopes.ResolveInterval(interval.id, std::chrono::nanoseconds((int64_t)nanoseconds), valid);
+                m_freeSlots.push_back(interval.slot);
+                m_pending.pop_front();
+            }
         }
 
-        ID3D12Resource* GetViewProjectionCBuffer() const
+        /// Release the query heap. Call after waiting for the queue, so that the pending intervals can resolve.
+        void Reset(uint64_t completedFenceValue)
         {
-            return viewProjectionCBuffer.Get();
+            AbandonCurrentInterval();
+            Submitted(UINT64_MAX);
+            ResolveIntervals(completedFenceValue);
+            // Anything left was never executed.
+            m_pending.clear();
+            m_scopes.DiscardPending();
+            m_freeSlots.clear();
+            m_readbackBuffer.Reset();
+            m_queryHeap.Reset();
         }
 
     private:
-        ComPtr<ID3D12Device> m_d3d12Device;
-        ComPtr<ID3D12CommandAllocator> commandAllocator;
-        ComPtr<ID3D12Resource> modelCBuffer;
-        ComPtr<ID3D12Resource> viewProjectionCBuffer;
-        std::vector<D3D12FallbackDepthTexture> m_internalDepthTextures;
+        static constexpr uint32_t kMaxIntervals = 64;
+
+        struct Interval
+        {
+            uint64_t id;
+            uint32_t slot;
+            uint64_t fenceValue;
+        };
+
+        /// An interval was begun but not ended, e.g. because an exception was thrown while recording it.
+        void AbandonCurrentInterval()
+        {
+            if (m_current.id != 0) {
+                m_scopes.ResolveInterval(m_current.id, std::chrono::nanoseconds{0}, false);
+                m_freeSlots.push_back(m_current.slot);
+                m_current = {};
+                m_currentCmdList = nullptr;
+            }
+        }
+
+        GpuTimerScopes m_scopes;
+        ComPtr<ID3D12QueryHeap> m_queryHeap;
+        ComPtr<ID3D12Resource> m_readbackBuffer;
+        uint64_t m_frequency{0};
+        std::vector<uint32_t> m_freeSlots;
+        Interval m_current{};
+        ID3D12GraphicsCommandList* m_currentCmdList{nullptr};
+        /// Ended, but not yet executed
+        std::vector<Interval> m_ended;
+        /// Executed, in increasing fence value order
+        std::deque<Interval> m_pending;
     };
 
     struct D3D12GraphicsPlugin : public IGraphicsPlugin
@@ -325,10 +490,14 @@ namespace Conformance
 
         void ShutdownDevice() override;
 
+        bool ReuseDevice(XrInstance instance, XrSystemId systemId) override;
+
         const XrBaseInStructure* GetGraphicsBinding() const override;
 
         void CopyRGBAImage(const XrSwapchainImageBaseHeader* swapchainImage, uint32_t arraySlice, const RGBAImage& image) override;
 
+        uint64_t GetSwapchainImageMemorySize(const XrSwapchainImageBaseHeader* swapchainImage) const override;
+
         std::string GetImageFormatName(int64_t imageFormat) const override;
 
         bool IsImageFormatKnown(int64_t imageFormat) const override;
@@ -339,6 +508,12 @@ namespace Conformance
                                      uint32_t* imageCount) const override;
         bool ValidateSwapchainImageState(XrSwapchain swapchain, uint32_t index, int64_t imageFormat) const override;
 
+        bool CanCreateSwapchainsConcurrently() const override
+        {
+            // ID3D12Device is free-threaded, and the queue is not used meanwhile.
+            return true;
+        }
+
         int64_t SelectColorSwapchainFormat(const int64_t* imageFormatArray, size_t count) const override;
 
         int64_t SelectDepthSwapchainFormat(const int64_t* imageFormatArray, size_t count) const override;
@@ -360,6 +535,14 @@ namespace Conformance
         MeshHandle MakeSimpleMesh(span<const uint16_t> idx, span<const Geometry::Vertex> vtx) override;
 
         GLTFModelHandle LoadGLTF(Gltf::ModelBuilder&& modelBuilder) override;
+        std::vector<Conformance::Image::FormatParams> GetSupportedTextureFormats() const override
+        {
+            if (!m_pbrResources) {
+                return {};
+            }
+            const auto formats = m_pbrResources->GetSupportedFormats();
+            return {formats.begin(), formats.end()};
+        }
         std::shared_ptr<Pbr::Model> GetPbrModel(GLTFModelHandle handle) const override;
         GLTFModelInstanceHandle CreateGLTFModelInstance(GLTFModelHandle handle) override;
         Pbr::ModelInstance& GetModelInstance(GLTFModelInstanceHandle handle) override;
@@ -369,11 +552,30 @@ namespace Conformance
 
         void Flush() override;
 
+        bool SupportsGpuTimers() const override
+        {
+            return true;
+        }
+
+        void BeginGpuTimerScope(const char* name) override
+        {
+            m_gpuTimers.Scopes().BeginScope(name);
+        }
+
+        void EndGpuTimerScope() override
+        {
+            m_gpuTimers.Scopes().EndScope();
+        }
+
+        void CollectGpuTimerSamples(std::vector<GpuTimerSample>& samples) override;
+
     protected:
-        D3D12_CPU_DESCRIPTOR_HANDLE CreateRenderTargetView(ID3D12Resource* colorTexture, uint32_t imageArrayIndex,
-                                                           int64_t colorSwapchainFormat);
-        D3D12_CPU_DESCRIPTOR_HANDLE CreateDepthStencilView(ID3D12Resource* depthStencilTexture, uint32_t imageArrayIndex,
-                                                           DXGI_FORMAT depthSwapchainFormat);
+        /// Get the render target view of a slice of a color image of @p swapchainData, creating it on first use.
+        D3D12_CPU_DESCRIPTOR_HANDLE GetRenderTargetView(D3D12SwapchainImageData* swapchainData, ID3D12Resource* colorTexture,
+                                                        uint32_t imageArrayIndex, int64_t colorSwapchainFormat);
+        /// Get the depth stencil view of a slice of a depth image of @p swapchainData, creating it on first use.
+        D3D12_CPU_DESCRIPTOR_HANDLE GetDepthStencilView(D3D12SwapchainImageData* swapchainData, ID3D12Resource* depthStencilTexture,
+                                                        uint32_t imageArrayIndex, DXGI_FORMAT depthSwapchainFormat);
 
         D3D12ResourceWithSRVDesc WaitLoadPBRTextureFromFile(const char* fileName, bool sRGB);
 
@@ -381,6 +583,19 @@ namespace Conformance
         ID3D12PipelineState* GetOrCreatePipelineState(DXGI_FORMAT colorSwapchainFormat, DXGI_FORMAT dsvSwapchainFormat);
         void WaitForGpu() const;
 
+        /// Whether submissions are left executing rather than CPU waited for, per Options::commandBuffersInFlight
+        bool SubmissionsStayInFlight() const
+        {
+            return m_queueWrapper->GetMaxSubmissionsInFlight() > 1;
+        }
+        /// The allocator to record a command list with: the swapchain's own when every submission is waited for,
+        /// otherwise one from the queue's pool, so that earlier submissions using the swapchain can still be executing.
+        ComPtr<ID3D12CommandAllocator> GetCommandAllocator(D3D12SwapchainImageData* swapchainData, bool resetSwapchainAllocator);
+        /// Close and execute a command list recorded with an allocator from @ref GetCommandAllocator, release whatever completed
+        /// submissions were keeping alive, and CPU wait if @p wait or if too many submissions are in flight.
+        /// @return the fence value signaled after the command list
+        uint64_t SubmitCommandList(ID3D12GraphicsCommandList* cmdList, ComPtr<ID3D12CommandAllocator> commandAllocator, bool wait);
+
     protected:
         bool initialized = false;
         XrGraphicsBindingD3D12KHR graphicsBinding{XR_TYPE_GRAPHICS_BINDING_D3D12_KHR};
@@ -394,17 +609,24 @@ namespace Conformance
         const ComPtr<ID3DBlob> pixelShaderBytes;
         ComPtr<ID3D12RootSignature> rootSignature;
         std::map<std::pair<DXGI_FORMAT, DXGI_FORMAT>, ComPtr<ID3D12PipelineState>> pipelineStates;
-        ComPtr<ID3D12DescriptorHeap> rtvHeap;
-        ComPtr<ID3D12DescriptorHeap> dsvHeap;
+        /// Outlives d3d12Device, so that later sessions do not recreate the same pipeline states.
+        D3D12PipelineLibrary m_pipelineLibrary;
 
         MeshHandle m_cubeMesh;
         VectorWithGenerationCountedHandles<D3D12Mesh, MeshHandle> m_meshes;
+        MeshHandleCache<uint16_t, Geometry::Vertex, MeshHandle> m_meshesByContent;
         // This is fine to be a shared_ptr because Model doesn't directly hold any graphics state.
         VectorWithGenerationCountedHandles<std::shared_ptr<Pbr::Model>, GLTFModelHandle> m_gltfModels;
+        SceneHandleCache<Gltf::DecodedScene, GLTFModelHandle> m_gltfModelsByScene;
         VectorWithGenerationCountedHandles<D3D12GLTF, GLTFModelInstanceHandle> m_gltfInstances;
         std::unique_ptr<Pbr::D3D12Resources> m_pbrResources;
-        DestructionQueue<ComPtr<ID3D12CommandAllocator>> m_commandAllocatorDestructionQueue;
+        /// Holds the vertex and index buffers of meshes
+        D3D12PlacedBufferAllocator m_bufferAllocator;
+        /// Holds mesh, constant, instance, and image data on its way to the GPU
+        D3D12UploadRing m_uploadRing;
         DestructionQueue<ComPtr<ID3D12Resource>> m_resourceDestructionQueue;
+        D3D12GpuTimers m_gpuTimers;
+        MeshInstanceBatches m_meshBatches;
     };
 
     D3D12GraphicsPlugin::D3D12GraphicsPlugin(std::shared_ptr<IPlatformPlugin>)
@@ -451,6 +673,36 @@ namespace Conformance
         return {XR_KHR_D3D12_ENABLE_EXTENSION_NAME};
     }
 
+    bool D3D12GraphicsPlugin::ReuseDevice(XrInstance instance, XrSystemId systemId)
+    {
+        if (!d3d12Device) {
+            return false;
+        }
+
+        XrGraphicsRequirementsD3D12KHR graphicsRequirements{XR_TYPE_GRAPHICS_REQUIREMENTS_D3D12_KHR};
+        auto xrGetD3D12GraphicsRequirementsKHR =
+            GetInstanceExtensionFunction<PFN_xrGetD3D12GraphicsRequirementsKHR>(instance, "xrGetD3D12GraphicsRequirementsKHR");
+        XrResult result;
+        {
+            ScopedStartupPhase timing(StartupPhase::GraphicsRequirements);
+            result = xrGetD3D12GraphicsRequirementsKHR(instance, systemId, &graphicsRequirements);
+        }
+        XRC_CHECK_THROW(ValidateResultAllowed("xrGetD3D12GraphicsRequirementsKHR", result));
+        if (XR_FAILED(result)) {
+            return false;
+        }
+
+        // The runtime must still want the adapter the existing device was created on.
+        const LUID adapterLuid = d3d12Device->GetAdapterLuid();
+        if (memcmp(&adapterLuid, &graphicsRequirements.adapterLuid, sizeof(LUID)) != 0) {
+            return false;
+        }
+
+        Flush();
+        m_swapchainImageDataMap.Reset();
+        return true;
+    }
+
     const XrBaseInStructure* D3D12GraphicsPlugin::GetGraphicsBinding() const
     {
         if (graphicsBinding.device && graphicsBinding.queue) {
@@ -472,7 +724,11 @@ namespace Conformance
                 auto xrGetD3D12GraphicsRequirementsKHR =
                     GetInstanceExtensionFunction<PFN_xrGetD3D12GraphicsRequirementsKHR>(instance, "xrGetD3D12GraphicsRequirementsKHR");
 
-                XrResult result = xrGetD3D12GraphicsRequirementsKHR(instance, systemId, &graphicsRequirements);
+                XrResult result;
+                {
+                    ScopedStartupPhase timing(StartupPhase::GraphicsRequirements);
+                    result = xrGetD3D12GraphicsRequirementsKHR(instance, systemId, &graphicsRequirements);
+                }
                 XRC_CHECK_THROW(ValidateResultAllowed("xrGetD3D12GraphicsRequirementsKHR", result));
                 if (FAILED(result)) {
                     // Log result?
@@ -505,38 +761,23 @@ namespace Conformance
                                                     reinterpret_cast<void**>(d3d12Device.ReleaseAndGetAddressOf())));
             XRC_CHECK_THROW_HRCMD(d3d12Device->SetName(L"CTS device"));
 
+            m_pipelineLibrary.Init(d3d12Device.Get(), adapter.Get(), GetGlobalData().options.pipelineCacheDirectory);
+
             m_queueWrapper = std::make_shared<D3D12QueueWrapper>(d3d12Device, D3D12_COMMAND_LIST_TYPE_DIRECT);
             XRC_CHECK_THROW_HRCMD(m_queueWrapper->GetCommandQueue()->SetName(L"CTS direct cmd queue"));
             XRC_CHECK_THROW_HRCMD(m_queueWrapper->GetFence()->SetName(L"CTS fence"));
-
-            {
-                D3D12_DESCRIPTOR_HEAP_DESC heapDesc{};
-                heapDesc.NumDescriptors = 1;
-                heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
-                heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
-                XRC_CHECK_THROW_HRCMD(d3d12Device->CreateDescriptorHeap(&heapDesc, __uuidof(ID3D12DescriptorHeap),
-                                                                        reinterpret_cast<void**>(rtvHeap.ReleaseAndGetAddressOf())));
-                XRC_CHECK_THROW_HRCMD(rtvHeap->SetName(L"CTS RTV heap"));
-            }
-            {
-                D3D12_DESCRIPTOR_HEAP_DESC heapDesc{};
-                heapDesc.NumDescriptors = 1;
-                heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_DSV;
-                heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
-                XRC_CHECK_THROW_HRCMD(d3d12Device->CreateDescriptorHeap(&heapDesc, __uuidof(ID3D12DescriptorHeap),
-                                                                        reinterpret_cast<void**>(dsvHeap.ReleaseAndGetAddressOf())));
-                XRC_CHECK_THROW_HRCMD(dsvHeap->SetName(L"CTS DSV heap"));
-            }
-
-            D3D12_ROOT_PARAMETER rootParams[2];
+            m_queueWrapper->SetMaxSubmissionsInFlight(GetGlobalData().options.commandBuffersInFlight);
+            m_gpuTimers.Init(d3d12Device.Get(), m_queueWrapper->GetCommandQueue().Get());
+            m_gpuTimers.Scopes().SetTimeOperations(GetGlobalData().options.gpuTimers);
+            m_bufferAllocator = D3D12PlacedBufferAllocator(d3d12Device.Get());
+            m_uploadRing = D3D12UploadRing(d3d12Device.Get(), m_queueWrapper);
+
+            // The model transforms and tint colors are per-instance vertex data, so only the view projection is a root parameter.
+            D3D12_ROOT_PARAMETER rootParams[1];
             rootParams[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
-            rootParams[0].Descriptor.ShaderRegister = 0;
+            rootParams[0].Descriptor.ShaderRegister = 1;
             rootParams[0].Descriptor.RegisterSpace = 0;
             rootParams[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
-            rootParams[1].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
-            rootParams[1].Descriptor.ShaderRegister = 1;
-            rootParams[1].Descriptor.RegisterSpace = 0;
-            rootParams[1].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
 
             D3D12_ROOT_SIGNATURE_DESC rootSignatureDesc{};
             rootSignatureDesc.NumParameters = (UINT)ArraySize(rootParams);
@@ -561,8 +802,10 @@ namespace Conformance
 
             D3D12_GRAPHICS_PIPELINE_STATE_DESC pipelineStateDesc{};
             SetupBasePipelineStateDesc(pipelineStateDesc);
-            m_pbrResources = std::make_unique<Pbr::D3D12Resources>(d3d12Device.Get(), pipelineStateDesc);
+            m_pbrResources =
+                std::make_unique<Pbr::D3D12Resources>(d3d12Device.Get(), pipelineStateDesc, m_queueWrapper, &m_pipelineLibrary);
             m_pbrResources->SetLight({0.0f, 0.7071067811865475f, 0.7071067811865475f}, Pbr::RGB::White);
+            m_pbrResources->SetTextureCacheBudget(uint64_t{GetGlobalData().options.pbrTextureCacheBudget} << 20);
 
             // Read the BRDF Lookup Table used by the PBR system into a DirectX texture.
             m_pbrResources->SetBrdfLut(WaitLoadPBRTextureFromFile("brdf_lut.png", false));
@@ -581,35 +824,47 @@ namespace Conformance
 
     void D3D12GraphicsPlugin::ClearSwapchainCache()
     {
+        Flush();
         m_swapchainImageDataMap.Reset();
     }
 
     void D3D12GraphicsPlugin::ShutdownDevice()
     {
         graphicsBinding = XrGraphicsBindingD3D12KHR{XR_TYPE_GRAPHICS_BINDING_D3D12_KHR};
+        if (m_queueWrapper) {
+            m_queueWrapper->CPUWaitOnFence();
+            m_gpuTimers.Reset(m_queueWrapper->GetCompletedFenceValue());
+        }
+        m_uploadRing = {};
         m_queueWrapper.reset();
 
         rootSignature.Reset();
         pipelineStates.clear();
         m_cubeMesh = {};
         m_meshes.clear();
+        m_meshesByContent.clear();
         m_gltfInstances.clear();
         m_gltfModels.clear();
-        rtvHeap.Reset();
-        dsvHeap.Reset();
+        m_gltfModelsByScene.clear();
         m_swapchainImageDataMap.Reset();
+        m_bufferAllocator = {};
 
         m_pbrResources.reset();
+        m_pipelineLibrary.Reset();
         d3d12Device.Reset();
     }
 
-    void D3D12GraphicsPlugin::CopyRGBAImage(const XrSwapchainImageBaseHeader* swapchainImage, uint32_t arraySlice, const RGBAImage& image)
+    uint64_t D3D12GraphicsPlugin::GetSwapchainImageMemorySize(const XrSwapchainImageBaseHeader* swapchainImage) const
     {
-        D3D12_HEAP_PROPERTIES heapProp{};
-        heapProp.Type = D3D12_HEAP_TYPE_DEFAULT;
-        heapProp.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-        heapProp.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+        const D3D12_RESOURCE_DESC desc = reinterpret_cast<const XrSwapchainImageD3D12KHR*>(swapchainImage)->texture->GetDesc();
+        const D3D12_RESOURCE_ALLOCATION_INFO allocationInfo = d3d12Device->GetResourceAllocationInfo(0, 1, &desc);
+        // UINT64_MAX if the description is not valid for this device.
+        return allocationInfo.SizeInBytes != UINT64_MAX ? allocationInfo.SizeInBytes : 0;
+    }
 
+    void D3D12GraphicsPlugin::CopyRGBAImage(const XrSwapchainImageBaseHeader* swapchainImage, uint32_t arraySlice, const RGBAImage& image)
+    {
+        XRC_TRACE_SCOPE("D3D12GraphicsPlugin::CopyRGBAImage");
         ID3D12Resource* const destTexture = reinterpret_cast<const XrSwapchainImageD3D12KHR*>(swapchainImage)->texture;
         const D3D12_RESOURCE_DESC rgbaImageDesc = destTexture->GetDesc();
 
@@ -618,34 +873,32 @@ namespace Conformance
         uint64_t rowSizeInBytes = 0;
         d3d12Device->GetCopyableFootprints(&rgbaImageDesc, 0, 1, 0, &layout, nullptr, &rowSizeInBytes, &requiredSize);
 
-        ComPtr<ID3D12Resource> uploadBuffer = D3D12CreateBuffer(d3d12Device.Get(), (uint32_t)(requiredSize), D3D12_HEAP_TYPE_UPLOAD);
-        XRC_CHECK_THROW_HRCMD(uploadBuffer->SetName(L"CTS RGBA upload buffer"));
+        const D3D12UploadRing::Allocation upload = m_uploadRing.Allocate(requiredSize, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+        layout.Offset = upload.offset;
         {
             const uint8_t* src = reinterpret_cast<const uint8_t*>(image.pixels.data());
             const uint32_t imageRowPitch = image.width * sizeof(uint32_t);
-            uint8_t* dst;
-            const D3D12_RANGE readRange{0, 0};
-            XRC_CHECK_THROW_HRCMD(uploadBuffer->Map(0, &readRange, reinterpret_cast<void**>(&dst)));
+            uint8_t* dst = upload.cpuAddress;
             for (int y = 0; y < image.height; ++y) {
                 memcpy(dst, src, imageRowPitch);
 
                 src += imageRowPitch;
                 dst += layout.Footprint.RowPitch;
             }
-            const D3D12_RANGE writeRange{0, (SIZE_T)requiredSize};
-            uploadBuffer->Unmap(0, &writeRange);
         }
 
         D3D12SwapchainImageData* swapchainData = m_swapchainImageDataMap.GetDataAndIndexFromBasePointer(swapchainImage).first;
+        ComPtr<ID3D12CommandAllocator> commandAllocator = GetCommandAllocator(swapchainData, false);
 
         ComPtr<ID3D12GraphicsCommandList> cmdList;
-        XRC_CHECK_THROW_HRCMD(d3d12Device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, swapchainData->GetCommandAllocator(),
-                                                             nullptr, __uuidof(ID3D12GraphicsCommandList),
+        XRC_CHECK_THROW_HRCMD(d3d12Device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, commandAllocator.Get(), nullptr,
+                                                             __uuidof(ID3D12GraphicsCommandList),
                                                              reinterpret_cast<void**>(cmdList.ReleaseAndGetAddressOf())));
         XRC_CHECK_THROW_HRCMD(cmdList->SetName(L"CTS copy rgba command list"));
+        m_gpuTimers.BeginInterval(cmdList.Get(), "CopyRGBAImage");
 
         D3D12_TEXTURE_COPY_LOCATION srcLocation;
-        srcLocation.pResource = uploadBuffer.Get();
+        srcLocation.pResource = upload.resource;
         srcLocation.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
         srcLocation.PlacedFootprint = layout;
 
@@ -657,10 +910,7 @@ namespace Conformance
 
         cmdList->CopyTextureRegion(&dstLocation, 0 /* X */, 0 /* Y */, 0 /* Z */, &srcLocation, nullptr);
 
-        XRC_CHECK_THROW_HRCMD(cmdList->Close());
-        XRC_CHECK_THROW(m_queueWrapper->ExecuteCommandList(cmdList.Get()));
-
-        WaitForGpu();
+        SubmitCommandList(cmdList.Get(), std::move(commandAllocator), !SubmissionsStayInFlight());
     }
 
     std::string D3D12GraphicsPlugin::GetImageFormatName(int64_t imageFormat) const
@@ -870,13 +1120,13 @@ namespace Conformance
         return ret;
     }
 
-    D3D12_CPU_DESCRIPTOR_HANDLE D3D12GraphicsPlugin::CreateRenderTargetView(ID3D12Resource* colorTexture, uint32_t imageArrayIndex,
-                                                                            int64_t colorSwapchainFormat)
+    D3D12_CPU_DESCRIPTOR_HANDLE D3D12GraphicsPlugin::GetRenderTargetView(D3D12SwapchainImageData* swapchainData,
+                                                                         ID3D12Resource* colorTexture, uint32_t imageArrayIndex,
+                                                                         int64_t colorSwapchainFormat)
     {
         const D3D12_RESOURCE_DESC colorTextureDesc = colorTexture->GetDesc();
 
         // Create RenderTargetView with original swapchain format (swapchain is typeless).
-        D3D12_CPU_DESCRIPTOR_HANDLE renderTargetView = rtvHeap->GetCPUDescriptorHandleForHeapStart();
         D3D12_RENDER_TARGET_VIEW_DESC renderTargetViewDesc{};
         renderTargetViewDesc.Format = (DXGI_FORMAT)colorSwapchainFormat;
         if (colorTextureDesc.DepthOrArraySize > 1) {
@@ -899,17 +1149,18 @@ namespace Conformance
                 renderTargetViewDesc.ViewDimension = D3D12_RTV_DIMENSION_TEXTURE2D;
             }
         }
-        d3d12Device->CreateRenderTargetView(colorTexture, &renderTargetViewDesc, renderTargetView);
-
-        return renderTargetView;
+        return swapchainData->RenderTargetViews().GetOrCreate(
+            d3d12Device.Get(), colorTexture, imageArrayIndex, [&](D3D12_CPU_DESCRIPTOR_HANDLE renderTargetView) {
+                d3d12Device->CreateRenderTargetView(colorTexture, &renderTargetViewDesc, renderTargetView);
+            });
     }
 
-    D3D12_CPU_DESCRIPTOR_HANDLE D3D12GraphicsPlugin::CreateDepthStencilView(ID3D12Resource* depthStencilTexture, uint32_t imageArrayIndex,
-                                                                            DXGI_FORMAT depthSwapchainFormat)
+    D3D12_CPU_DESCRIPTOR_HANDLE D3D12GraphicsPlugin::GetDepthStencilView(D3D12SwapchainImageData* swapchainData,
+                                                                         ID3D12Resource* depthStencilTexture, uint32_t imageArrayIndex,
+                                                                         DXGI_FORMAT depthSwapchainFormat)
     {
         const D3D12_RESOURCE_DESC depthStencilTextureDesc = depthStencilTexture->GetDesc();
 
-        D3D12_CPU_DESCRIPTOR_HANDLE depthStencilView = dsvHeap->GetCPUDescriptorHandleForHeapStart();
         D3D12_DEPTH_STENCIL_VIEW_DESC depthStencilViewDesc{};
         depthStencilViewDesc.Format = depthSwapchainFormat;
         if (depthStencilTextureDesc.DepthOrArraySize > 1) {
@@ -932,9 +1183,10 @@ namespace Conformance
                 depthStencilViewDesc.ViewDimension = D3D12_DSV_DIMENSION_TEXTURE2D;
             }
         }
-        d3d12Device->CreateDepthStencilView(depthStencilTexture, &depthStencilViewDesc, depthStencilView);
-
-        return depthStencilView;
+        return swapchainData->DepthStencilViews().GetOrCreate(
+            d3d12Device.Get(), depthStencilTexture, imageArrayIndex, [&](D3D12_CPU_DESCRIPTOR_HANDLE depthStencilView) {
+                d3d12Device->CreateDepthStencilView(depthStencilTexture, &depthStencilViewDesc, depthStencilView);
+            });
     }
 
     void D3D12GraphicsPlugin::ClearImageSlice(const XrSwapchainImageBaseHeader* colorSwapchainImage, uint32_t imageArrayIndex,
@@ -945,19 +1197,20 @@ namespace Conformance
         uint32_t imageIndex;
 
         std::tie(swapchainData, imageIndex) = m_swapchainImageDataMap.GetDataAndIndexFromBasePointer(colorSwapchainImage);
-        swapchainData->ResetCommandAllocator();
+        ComPtr<ID3D12CommandAllocator> commandAllocator = GetCommandAllocator(swapchainData, true);
 
         ID3D12Resource* const colorTexture = swapchainData->GetTypedImage(imageIndex).texture;
 
         ComPtr<ID3D12GraphicsCommandList> cmdList;
-        XRC_CHECK_THROW_HRCMD(d3d12Device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, swapchainData->GetCommandAllocator(),
-                                                             nullptr, __uuidof(ID3D12GraphicsCommandList),
+        XRC_CHECK_THROW_HRCMD(d3d12Device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, commandAllocator.Get(), nullptr,
+                                                             __uuidof(ID3D12GraphicsCommandList),
                                                              reinterpret_cast<void**>(cmdList.ReleaseAndGetAddressOf())));
         XRC_CHECK_THROW_HRCMD(cmdList->SetName(L"CTS ClearImageSlice cmd list"));
+        m_gpuTimers.BeginInterval(cmdList.Get(), "ClearImageSlice");
 
         // Clear color buffer.
         D3D12_CPU_DESCRIPTOR_HANDLE renderTargetView =
-            CreateRenderTargetView(colorTexture, imageArrayIndex, swapchainData->GetCreateInfo().format);
+            GetRenderTargetView(swapchainData, colorTexture, imageArrayIndex, swapchainData->GetCreateInfo().format);
         FLOAT bg[] = {color.r, color.g, color.b, color.a};
         cmdList->ClearRenderTargetView(renderTargetView, bg, 0, nullptr);
 
@@ -967,28 +1220,52 @@ namespace Conformance
         const XrSwapchainCreateInfo* depthCreateInfo = swapchainData->GetDepthCreateInfo();
         DXGI_FORMAT depthSwapchainFormat = GetDepthStencilFormatOrDefault(depthCreateInfo);
 
-        D3D12_CPU_DESCRIPTOR_HANDLE depthStencilView = CreateDepthStencilView(depthStencilTexture, imageArrayIndex, depthSwapchainFormat);
+        D3D12_CPU_DESCRIPTOR_HANDLE depthStencilView =
+            GetDepthStencilView(swapchainData, depthStencilTexture, imageArrayIndex, depthSwapchainFormat);
         cmdList->ClearDepthStencilView(depthStencilView, D3D12_CLEAR_FLAG_DEPTH, 1.0f, 0, 0, nullptr);
 
-        XRC_CHECK_THROW_HRCMD(cmdList->Close());
-        XRC_CHECK_THROW(m_queueWrapper->ExecuteCommandList(cmdList.Get()));
+        SubmitCommandList(cmdList.Get(), std::move(commandAllocator), false);
     }
 
     inline MeshHandle D3D12GraphicsPlugin::MakeSimpleMesh(span<const uint16_t> idx, span<const Geometry::Vertex> vtx)
-
     {
-        auto handle = m_meshes.emplace_back(d3d12Device, idx, vtx, m_queueWrapper);
+        // A mesh with the same content shares the buffers created then.
+        MeshHandle cachedHandle = m_meshesByContent.Find(idx, vtx);
+        if (cachedHandle != MeshHandle{}) {
+            return cachedHandle;
+        }
+
+        ComPtr<ID3D12CommandAllocator> commandAllocator = m_queueWrapper->AcquireCommandAllocator();
+
+        ComPtr<ID3D12GraphicsCommandList> cmdList;
+        XRC_CHECK_THROW_HRCMD(d3d12Device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, commandAllocator.Get(), nullptr,
+                                                             __uuidof(ID3D12GraphicsCommandList),
+                                                             reinterpret_cast<void**>(cmdList.ReleaseAndGetAddressOf())));
+        XRC_CHECK_THROW_HRCMD(cmdList->SetName(L"CTS mesh upload command list"));
+
+        auto handle = m_meshes.emplace_back(idx, vtx, m_bufferAllocator, m_uploadRing, cmdList.Get());
+
+        // Rendering is submitted to the same queue, so the copies are done before the mesh is drawn without waiting here.
+        XRC_CHECK_THROW_HRCMD(cmdList->Close());
+        XRC_CHECK_THROW(m_queueWrapper->ExecuteCommandList(cmdList.Get()));
+        m_uploadRing.Submitted(m_queueWrapper->GetSignaledFenceValue());
+        m_queueWrapper->RecycleCommandAllocator(std::move(commandAllocator));
 
+        m_meshesByContent.Insert(idx, vtx, handle);
         return handle;
     }
 
     GLTFModelHandle D3D12GraphicsPlugin::LoadGLTF(Gltf::ModelBuilder&& modelBuilder)
     {
-        ComPtr<ID3D12CommandAllocator> commandAllocator;
+        XRC_TRACE_SCOPE("D3D12GraphicsPlugin::LoadGLTF");
+        // A scene already loaded on this device shares the model built then.
+        std::shared_ptr<const Gltf::DecodedScene> scene = modelBuilder.GetDecodedScene();
+        GLTFModelHandle cachedHandle = m_gltfModelsByScene.Find(scene);
+        if (cachedHandle != GLTFModelHandle{}) {
+            return cachedHandle;
+        }
 
-        XRC_CHECK_THROW_HRCMD(d3d12Device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, __uuidof(ID3D12CommandAllocator),
-                                                                  reinterpret_cast<void**>(commandAllocator.ReleaseAndGetAddressOf())));
-        XRC_CHECK_THROW_HRCMD(commandAllocator->SetName(L"LoadGLTF command allocator"));
+        ComPtr<ID3D12CommandAllocator> commandAllocator = m_queueWrapper->AcquireCommandAllocator();
 
         ComPtr<ID3D12GraphicsCommandList> cmdList;
         XRC_CHECK_THROW_HRCMD(d3d12Device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, commandAllocator.Get(), nullptr,
@@ -998,8 +1275,6 @@ namespace Conformance
 
         auto builder = m_pbrResources->MakeGltfBuilder(cmdList.Get());
         auto handle = m_gltfModels.emplace_back(modelBuilder.Build(builder));
-        m_commandAllocatorDestructionQueue.PushResource(m_queueWrapper->GetSignaledFenceValue(), std::move(commandAllocator));
-        m_resourceDestructionQueue.PushResources(m_queueWrapper->GetSignaledFenceValue(), builder.TakeStagingResources());
 
         // this is intended to be written so that it /should/ be possible to swap out with
         // a copy command queue (and CPU wait on that queue on another thread) in the future.
@@ -1007,6 +1282,11 @@ namespace Conformance
         XRC_CHECK_THROW_HRCMD(cmdList->Close());
         XRC_CHECK_THROW(m_queueWrapper->ExecuteCommandList(cmdList.Get()));
 
+        // Keyed on the fence value of this submission, now signaled, not the one before it.
+        m_queueWrapper->RecycleCommandAllocator(std::move(commandAllocator));
+        m_resourceDestructionQueue.PushResources(m_queueWrapper->GetSignaledFenceValue(), builder.TakeStagingResources());
+
+        m_gltfModelsByScene.Insert(std::move(scene), handle);
         return handle;
     }
 
@@ -1030,21 +1310,27 @@ namespace Conformance
     void D3D12GraphicsPlugin::RenderView(const XrCompositionLayerProjectionView& layerView,
                                          const XrSwapchainImageBaseHeader* colorSwapchainImage, const RenderParams& params)
     {
-        if (params.cubes.empty() && params.meshes.empty() && params.glTFs.empty()) {
+        XRC_TRACE_SCOPE("D3D12GraphicsPlugin::RenderView");
+        const bool stayInFlight = SubmissionsStayInFlight();
+        if (params.cubes.empty() && params.meshes.empty() && params.glTFs.empty() && params.depthPrePass.empty()) {
             // Early exit, but need to wait as being done at end of method
-            WaitForGpu();
+            if (!stayInFlight) {
+                WaitForGpu();
+            }
             return;
         }
         D3D12SwapchainImageData* swapchainData;
         uint32_t imageIndex;
 
         std::tie(swapchainData, imageIndex) = m_swapchainImageDataMap.GetDataAndIndexFromBasePointer(colorSwapchainImage);
+        ComPtr<ID3D12CommandAllocator> commandAllocator = GetCommandAllocator(swapchainData, false);
 
         ComPtr<ID3D12GraphicsCommandList> cmdList;
-        XRC_CHECK_THROW_HRCMD(d3d12Device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, swapchainData->GetCommandAllocator(),
-                                                             nullptr, __uuidof(ID3D12GraphicsCommandList),
+        XRC_CHECK_THROW_HRCMD(d3d12Device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, commandAllocator.Get(), nullptr,
+                                                             __uuidof(ID3D12GraphicsCommandList),
                                                              reinterpret_cast<void**>(cmdList.ReleaseAndGetAddressOf())));
         XRC_CHECK_THROW_HRCMD(cmdList->SetName(L"CTS RenderView command list"));
+        m_gpuTimers.BeginInterval(cmdList.Get(), "RenderView");
 
         const XrSwapchainCreateInfo* depthCreateInfo = swapchainData->GetDepthCreateInfo();
         DXGI_FORMAT depthSwapchainFormat = GetDepthStencilFormatOrDefault(depthCreateInfo);
@@ -1069,14 +1355,14 @@ namespace Conformance
                                         layerView.subImage.imageRect.offset.y + layerView.subImage.imageRect.extent.height};
         cmdList->RSSetScissorRects(1, &scissorRect);
 
-        // Create RenderTargetView with original swapchain format (swapchain is typeless).
+        // The views of each swapchain image slice are created the first time it is rendered to.
         D3D12_CPU_DESCRIPTOR_HANDLE renderTargetView =
-            CreateRenderTargetView(colorTexture, layerView.subImage.imageArrayIndex, swapchainData->GetCreateInfo().format);
+            GetRenderTargetView(swapchainData, colorTexture, layerView.subImage.imageArrayIndex, swapchainData->GetCreateInfo().format);
 
         ID3D12Resource* depthStencilTexture = swapchainData->GetDepthImageForColorIndex(imageIndex).texture;
 
         D3D12_CPU_DESCRIPTOR_HANDLE depthStencilView =
-            CreateDepthStencilView(depthStencilTexture, layerView.subImage.imageArrayIndex, depthSwapchainFormat);
+            GetDepthStencilView(swapchainData, depthStencilTexture, layerView.subImage.imageArrayIndex, depthSwapchainFormat);
 
         D3D12_CPU_DESCRIPTOR_HANDLE renderTargets[] = {renderTargetView};
         cmdList->OMSetRenderTargets((UINT)ArraySize(renderTargets), renderTargets, true, &depthStencilView);
@@ -1086,80 +1372,49 @@ namespace Conformance
         XrMatrix4x4f_CreateProjectionFov(&projectionMatrix, GRAPHICS_D3D, layerView.fov, 0.05f, 100.0f);
 
         // Set shaders and constant buffers.
-        ID3D12Resource* viewProjectionCBuffer = swapchainData->GetViewProjectionCBuffer();
+        // Each view writes its constants to a new part of the upload ring, so submissions left in flight keep theirs.
         ViewProjectionConstantBuffer viewProjection;
         XMStoreFloat4x4(&viewProjection.ViewProjection, XMMatrixTranspose(spaceToView * LoadXrMatrix(projectionMatrix)));
-        {
-            void* data;
-            const D3D12_RANGE readRange{0, 0};
-            XRC_CHECK_THROW_HRCMD(viewProjectionCBuffer->Map(0, &readRange, &data));
-            memcpy(data, &viewProjection, sizeof(viewProjection));
-            viewProjectionCBuffer->Unmap(0, nullptr);
-        }
+        const D3D12UploadRing::Allocation viewProjectionCBuffer = m_uploadRing.Allocate(sizeof(viewProjection));
+        memcpy(viewProjectionCBuffer.cpuAddress, &viewProjection, sizeof(viewProjection));
 
-        cmdList->SetGraphicsRootConstantBufferView(1, viewProjectionCBuffer->GetGPUVirtualAddress());
+        cmdList->SetGraphicsRootConstantBufferView(0, viewProjectionCBuffer.gpuAddress);
 
         cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
-        constexpr uint32_t modelCBufferSize = AlignTo<D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT>(sizeof(ModelConstantBuffer));
-        swapchainData->RequestModelCBuffer(
-            static_cast<uint32_t>(modelCBufferSize * (params.cubes.size() + params.meshes.size() + params.glTFs.size())));
-        ID3D12Resource* modelCBuffer = swapchainData->GetModelCBuffer();
-
-        // Render each cube
-        uint32_t offset = 0;
-        MeshHandle lastMeshHandle;
-
-        const auto calculateModelMat = [&](const DrawableParams params, DirectX::XMFLOAT4X4& mat) {
-            XMStoreFloat4x4(&mat,
-                            XMMatrixTranspose(XMMatrixScaling(params.scale.x, params.scale.y, params.scale.z) * LoadXrPose(params.pose)));
-        };
-
-        const auto drawMesh = [&, this](const MeshDrawable mesh) {
-            D3D12Mesh& d3dMesh = m_meshes[mesh.handle];
-            if (mesh.handle != lastMeshHandle) {
-                // We are now rendering a new mesh
-                // Set primitive data.
-                const D3D12_VERTEX_BUFFER_VIEW vertexBufferView[] = {
-                    {d3dMesh.vertexBuffer->GetGPUVirtualAddress(), d3dMesh.vertexBufferSizeBytes, sizeof(Geometry::Vertex)}};
-                cmdList->IASetVertexBuffers(0, (UINT)ArraySize(vertexBufferView), vertexBufferView);
-
-                D3D12_INDEX_BUFFER_VIEW indexBufferView{d3dMesh.indexBuffer->GetGPUVirtualAddress(), d3dMesh.indexBufferSizeBytes,
-                                                        DXGI_FORMAT_R16_UINT};
-                cmdList->IASetIndexBuffer(&indexBufferView);
-
-                lastMeshHandle = mesh.handle;
-            }
-            // Compute and update the model transform.
-            ModelConstantBuffer model;
-
-            calculateModelMat(mesh.params, model.Model);
-            model.TintColor = {mesh.tintColor.r, mesh.tintColor.g, mesh.tintColor.b, mesh.tintColor.a};
-            {
-                uint8_t* data;
-                const D3D12_RANGE readRange{0, 0};
-                XRC_CHECK_THROW_HRCMD(modelCBuffer->Map(0, &readRange, reinterpret_cast<void**>(&data)));
-                memcpy(data + offset, &model, sizeof(model));
-                const D3D12_RANGE writeRange{offset, offset + modelCBufferSize};
-                modelCBuffer->Unmap(0, &writeRange);
+        // Compute the per-instance data for all cubes and meshes and upload it at once.
+        m_meshBatches.Build(params, m_cubeMesh);
+        const std::vector<MeshDrawable>& instances = m_meshBatches.Instances();
+        D3D12_GPU_VIRTUAL_ADDRESS instanceBufferAddress = 0;
+        if (!instances.empty()) {
+            const uint32_t instanceBufferSize = static_cast<uint32_t>(instances.size() * sizeof(MeshInstance));
+            const D3D12UploadRing::Allocation instanceBuffer = m_uploadRing.Allocate(instanceBufferSize);
+            instanceBufferAddress = instanceBuffer.gpuAddress;
+
+            MeshInstance* instanceData = reinterpret_cast<MeshInstance*>(instanceBuffer.cpuAddress);
+            for (size_t i = 0; i < instances.size(); ++i) {
+                const MeshDrawable& mesh = instances[i];
+                XMStoreFloat4x4(&instanceData[i].Model, XMMatrixScaling(mesh.params.scale.x, mesh.params.scale.y, mesh.params.scale.z) *
+                                                            LoadXrPose(mesh.params.pose));
+                instanceData[i].TintColor = {mesh.tintColor.r, mesh.tintColor.g, mesh.tintColor.b, mesh.tintColor.a};
             }
+        }
 
-            cmdList->SetGraphicsRootConstantBufferView(0, modelCBuffer->GetGPUVirtualAddress() + offset);
-
-            // Draw the mesh.
-            cmdList->DrawIndexedInstanced(d3dMesh.numIndices, 1, 0, 0, 0);
+        // Draw all instances of each mesh with a single call.
+        for (const MeshInstanceBatches::Batch& batch : m_meshBatches.Batches()) {
+            D3D12Mesh& d3dMesh = m_meshes[batch.handle];
 
-            offset += modelCBufferSize;
-        };
+            // Set primitive data.
+            const D3D12_VERTEX_BUFFER_VIEW vertexBufferView[] = {
+                {d3dMesh.vertexBuffer->GetGPUVirtualAddress(), d3dMesh.vertexBufferSizeBytes, sizeof(Geometry::Vertex)},
+                {instanceBufferAddress, static_cast<UINT>(instances.size() * sizeof(MeshInstance)), sizeof(MeshInstance)}};
+            cmdList->IASetVertexBuffers(0, (UINT)ArraySize(vertexBufferView), vertexBufferView);
 
-        // Render each cube
-        for (const Cube& cube : params.cubes) {
-            drawMesh(MeshDrawable{m_cubeMesh, cube.params.pose, cube.params.scale, cube.tintColor});
-        }
+            D3D12_INDEX_BUFFER_VIEW indexBufferView{d3dMesh.indexBuffer->GetGPUVirtualAddress(), d3dMesh.indexBufferSizeBytes,
+                                                    DXGI_FORMAT_R16_UINT};
+            cmdList->IASetIndexBuffer(&indexBufferView);
 
-        // Render each mesh
-        for (const auto& mesh : params.meshes) {
-            drawMesh(mesh);
+            cmdList->DrawIndexedInstanced(d3dMesh.numIndices, batch.instanceCount, 0, 0, batch.firstInstance);
         }
 
         // Render each gltf
@@ -1178,23 +1433,20 @@ namespace Conformance
             gltf.Render(cmdList, *m_pbrResources, modelToWorld, (DXGI_FORMAT)swapchainData->GetCreateInfo().format, depthSwapchainFormatDX);
         }
 
-        XRC_CHECK_THROW_HRCMD(cmdList->Close());
-        XRC_CHECK_THROW(m_queueWrapper->ExecuteCommandList(cmdList.Get()));
-
-        m_commandAllocatorDestructionQueue.ReleaseForFenceValue(m_queueWrapper->GetCompletedFenceValue());
-        m_resourceDestructionQueue.ReleaseForFenceValue(m_queueWrapper->GetCompletedFenceValue());
-
         // TODO: Track down exactly why this wait is needed.
         // On some drivers and/or hardware the test is generating the same image for the left and right eye,
         // and generating images that fail the interactive tests. This did not seem to be the case several
         // months ago, so it likely a driver change that flipped a race condition the other direction.
-        WaitForGpu();
+        // glTF rendering shares the view projection buffer in m_pbrResources across views, so that keeps waiting too.
+        const bool wait = !stayInFlight || !params.glTFs.empty();
+        SubmitCommandList(cmdList.Get(), std::move(commandAllocator), wait);
     }
 
     void D3D12GraphicsPlugin::Flush()
     {
         if (m_queueWrapper) {
             m_queueWrapper->CPUWaitOnFence();
+            m_resourceDestructionQueue.ReleaseForFenceValue(m_queueWrapper->GetCompletedFenceValue());
         }
     }
 
@@ -1299,13 +1551,18 @@ namespace Conformance
         const D3D12_INPUT_ELEMENT_DESC inputElementDescs[] = {
             {"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
             {"COLOR", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+            {"MODEL", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1},
+            {"MODEL", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1},
+            {"MODEL", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1},
+            {"MODEL", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1},
+            {"TINTCOLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA,
+             1},
         };
         pipelineStateDesc.InputLayout.pInputElementDescs = inputElementDescs;
         pipelineStateDesc.InputLayout.NumElements = (UINT)ArraySize(inputElementDescs);
 
-        ComPtr<ID3D12PipelineState> pipelineState;
-        XRC_CHECK_THROW_HRCMD(d3d12Device->CreateGraphicsPipelineState(&pipelineStateDesc, __uuidof(ID3D12PipelineState),
-                                                                       reinterpret_cast<void**>(pipelineState.ReleaseAndGetAddressOf())));
+        const std::wstring name = L"cts_" + std::to_wstring(colorSwapchainFormat) + L"_" + std::to_wstring(dsvSwapchainFormat);
+        ComPtr<ID3D12PipelineState> pipelineState = m_pipelineLibrary.GetOrCreateGraphicsPipelineState(name, pipelineStateDesc);
         XRC_CHECK_THROW_HRCMD(pipelineState->SetName(L"CTS pipeline state"));
         ID3D12PipelineState* pipelineStateRaw = pipelineState.Get();
 
@@ -1319,6 +1576,52 @@ namespace Conformance
         m_queueWrapper->CPUWaitOnFence();
     }
 
+    ComPtr<ID3D12CommandAllocator> D3D12GraphicsPlugin::GetCommandAllocator(D3D12SwapchainImageData* swapchainData,
+                                                                            bool resetSwapchainAllocator)
+    {
+        if (SubmissionsStayInFlight()) {
+            return m_queueWrapper->AcquireCommandAllocator();
+        }
+        if (resetSwapchainAllocator) {
+            swapchainData->ResetCommandAllocator();
+        }
+        return swapchainData->GetCommandAllocator();
+    }
+
+    uint64_t D3D12GraphicsPlugin::SubmitCommandList(ID3D12GraphicsCommandList* cmdList, ComPtr<ID3D12CommandAllocator> commandAllocator,
+                                                    bool wait)
+    {
+        m_gpuTimers.EndInterval(cmdList);
+        XRC_CHECK_THROW_HRCMD(cmdList->Close());
+        XRC_CHECK_THROW(m_queueWrapper->ExecuteCommandList(cmdList));
+        const uint64_t fenceValue = m_queueWrapper->GetSignaledFenceValue();
+        m_gpuTimers.Submitted(fenceValue);
+        m_uploadRing.Submitted(fenceValue);
+        m_pbrResources->Submitted(fenceValue);
+        if (SubmissionsStayInFlight()) {
+            m_queueWrapper->RecycleCommandAllocator(std::move(commandAllocator));
+        }
+
+        if (wait) {
+            WaitForGpu();
+        }
+        else if (SubmissionsStayInFlight()) {
+            m_queueWrapper->CPUWaitForSubmissionsInFlight();
+        }
+
+        m_resourceDestructionQueue.ReleaseForFenceValue(m_queueWrapper->GetCompletedFenceValue());
+        m_gpuTimers.ResolveIntervals(m_queueWrapper->GetCompletedFenceValue());
+        return fenceValue;
+    }
+
+    void D3D12GraphicsPlugin::CollectGpuTimerSamples(std::vector<GpuTimerSample>& samples)
+    {
+        if (m_queueWrapper) {
+            m_gpuTimers.ResolveIntervals(m_queueWrapper->GetCompletedFenceValue());
+        }
+        m_gpuTimers.Scopes().TakeSamples(samples);
+    }
+
     std::shared_ptr<IGraphicsPlugin> CreateGraphicsPlugin_D3D12(std::shared_ptr<IPlatformPlugin> platformPlugin)
     {
         return std::make_shared<D3D12GraphicsPlugin>(platformPlugin);
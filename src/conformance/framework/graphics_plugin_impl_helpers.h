@@ -16,6 +16,15 @@
 
 #pragma once
 
+#include "report.h"
+
+#include <nonstd/span.hpp>
+
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include <stdexcept>
 #include <stdint.h>
@@ -92,4 +101,124 @@ namespace Conformance
         GenerationType m_generationNumber{1};
     };
 
+    /// Remembers the handle of the model built from each decoded scene, so that loading a scene again returns that model
+    /// instead of uploading another copy.
+    ///
+    /// Used with @ref GLTFModelHandle and Gltf::DecodedScene, and cleared along with the models the handles refer to.
+    template <typename SceneType, typename HandleType>
+    class SceneHandleCache
+    {
+    public:
+        /// Returns a null handle if no model was built from @p scene.
+        HandleType Find(const std::shared_ptr<const SceneType>& scene) const
+        {
+            auto it = m_handles.find(scene);
+            return it != m_handles.end() ? it->second : HandleType{};
+        }
+
+        void Insert(std::shared_ptr<const SceneType> scene, HandleType handle)
+        {
+            m_handles[std::move(scene)] = handle;
+        }
+
+        void clear()
+        {
+            m_handles.clear();
+        }
+
+    private:
+        // Holding the scenes keeps their addresses from being reused by other scenes.
+        std::map<std::shared_ptr<const SceneType>, HandleType> m_handles;
+    };
+
+    /// Remembers the handle of the mesh created from each distinct index and vertex content, so that creating the same mesh
+    /// again, as the cube and gnomon helpers do, returns that mesh instead of uploading another copy of its buffers.
+    ///
+    /// Used with @ref MeshHandle, and cleared along with the meshes the handles refer to.
+    template <typename IndexType, typename VertexType, typename HandleType>
+    class MeshHandleCache
+    {
+    public:
+        /// Returns a null handle if no mesh was created from this content, otherwise counts its buffers as saved.
+        HandleType Find(nonstd::span<const IndexType> indices, nonstd::span<const VertexType> vertices)
+        {
+            auto it = m_handles.find(MakeKey(indices, vertices));
+            if (it == m_handles.end()) {
+                return HandleType{};
+            }
+            m_bytesSaved += indices.size_bytes() + vertices.size_bytes();
+            return it->second;
+        }
+
+        void Insert(nonstd::span<const IndexType> indices, nonstd::span<const VertexType> vertices, HandleType handle)
+        {
+            m_handles[MakeKey(indices, vertices)] = handle;
+        }
+
+        /// Reports the buffer bytes that sharing meshes saved since the last clear, if any, as a metric.
+        void clear()
+        {
+            if (m_bytesSaved > 0) {
+                ReportMetric("graphicsPlugin.sharedMeshBytes", (double)m_bytesSaved, "bytes");
+            }
+            m_handles.clear();
+            m_bytesSaved = 0;
+        }
+
+    private:
+        static std::string MakeKey(nonstd::span<const IndexType> indices, nonstd::span<const VertexType> vertices)
+        {
+            // Leading with the index count keeps the same bytes split differently between indices and vertices apart.
+            const uint64_t indexCount = indices.size();
+            std::string key(reinterpret_cast<const char*>(&indexCount), sizeof(indexCount));
+            key.append(reinterpret_cast<const char*>(indices.data()), indices.size_bytes());
+            key.append(reinterpret_cast<const char*>(vertices.data()), vertices.size_bytes());
+            return key;
+        }
+
+        std::unordered_map<std::string, HandleType> m_handles;
+        uint64_t m_bytesSaved{0};
+    };
+
+    /// Loads something a graphics plugin needs for each device but which does not depend on it, such as shader bytecode or
+    /// asset files. IGraphicsPlugin::PrepareDevice starts the load on a background thread, and the result is kept for
+    /// every device after.
+    ///
+    /// Used only from the thread that initializes devices.
+    template <typename T>
+    class DeviceIndependentLoad
+    {
+    public:
+        explicit DeviceIndependentLoad(T (*load)()) : m_load(load)
+        {
+        }
+
+        /// Start loading on a background thread, unless already started.
+        void Start()
+        {
+            if (!m_result.valid()) {
+                m_result = std::async(std::launch::async, m_load);
+            }
+        }
+
+        /// Wait for the result, loading on this thread if not started. A load that throws is started again by the next call.
+        const T& Get()
+        {
+            if (!m_result.valid()) {
+                m_result = std::async(std::launch::deferred, m_load);
+            }
+            try {
+                return m_result.get();
+            }
+            catch (...) {
+                m_result = {};
+                throw;
+            }
+        }
+
+    private:
+        T (*m_load)();
+        std::shared_future<T> m_result;
+    };
+
 }  // namespace Conformance
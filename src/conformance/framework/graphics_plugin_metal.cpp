@@ -20,6 +20,8 @@
 #include "graphics_plugin.h"
 #include "graphics_plugin_impl_helpers.h"
 #include "graphics_plugin_metal_gltf.h"
+#include "mesh_instance_batches.h"
+#include "startup_timing.h"
 #include "swapchain_image_data.h"
 
 #include "common/xr_dependencies.h"
@@ -31,6 +33,7 @@
 #include "utilities/swapchain_format_data.h"
 #include "utilities/swapchain_parameters.h"
 #include "utilities/throw_helpers.h"
+#include "utilities/trace.h"
 #include "utilities/utils.h"
 
 #include <catch2/catch_test_macros.hpp>
@@ -39,10 +42,21 @@
 
 #include <algorithm>
 #include <array>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
 
 namespace Conformance
 {
 
+    /// Per-instance data for drawing meshes, matching MeshInstance in the vertex shader.
+    struct MetalMeshInstance
+    {
+        simd::float4x4 modelViewProjection;
+        simd::float4 tintColor;
+    };
+
     struct MetalMesh
     {
         NS::SharedPtr<MTL::Device> device;
@@ -50,7 +64,8 @@ namespace Conformance
         NS::SharedPtr<MTL::Buffer> indexBuffer;
         uint32_t numIndices;
 
-        MetalMesh(NS::SharedPtr<MTL::Device> metalDevice, span<const uint16_t> indices, span<const Geometry::Vertex> vertices)
+        MetalMesh(NS::SharedPtr<MTL::Device> metalDevice, Conformance::MetalStaticResourceHeaps& heaps, span<const uint16_t> indices,
+                  span<const Geometry::Vertex> vertices)
             : device(metalDevice), numIndices((uint32_t)indices.size())
         {
             struct VertexData
@@ -68,13 +83,8 @@ namespace Conformance
                 newVertices.push_back(v);
             }
 
-            vertexBuffer = NS::TransferPtr(device->newBuffer(sizeof(VertexData) * vertices.size(), MTL::ResourceStorageModeManaged));
-            indexBuffer = NS::TransferPtr(device->newBuffer(sizeof(uint16_t) * indices.size(), MTL::ResourceStorageModeManaged));
-
-            memcpy(vertexBuffer->contents(), newVertices.data(), vertexBuffer->length());
-            memcpy(indexBuffer->contents(), indices.data(), indexBuffer->length());
-            vertexBuffer->didModifyRange(NS::Range::Make(0, vertexBuffer->length()));
-            indexBuffer->didModifyRange(NS::Range::Make(0, indexBuffer->length()));
+            vertexBuffer = heaps.NewBuffer(newVertices.data(), sizeof(VertexData) * newVertices.size());
+            indexBuffer = heaps.NewBuffer(indices.data(), sizeof(uint16_t) * indices.size());
         }
     };
 
@@ -159,14 +169,52 @@ namespace Conformance
         {
             m_pipelineStateObject.reset();
             m_internalDepthTextures.clear();
+            m_colorSliceTextures.clear();
+            m_depthSliceTextures.clear();
             m_device.reset();
             SwapchainImageDataBase::Reset();
         }
 
+        /// Get a 2D view of one array slice of a color image, created the first time it is asked for.
+        const NS::SharedPtr<MTL::Texture>& GetColorSliceTexture(uint32_t imageIndex, uint32_t imageArrayIndex)
+        {
+            NS::SharedPtr<MTL::Texture>& textureView = GetSliceTextureEntry(m_colorSliceTextures, imageIndex, imageArrayIndex);
+            if (!textureView) {
+                MTL::Texture* texture = (MTL::Texture*)GetTypedImage(imageIndex).texture;
+                MTL::PixelFormat textureViewFormat = (MTL::PixelFormat)GetCreateInfo().format;
+                MTL::TextureType textureViewType = (SampleCount() > 1) ? MTL::TextureType2DMultisample : MTL::TextureType2D;
+                NS::Range textureViewMipRange = NS::Range::Make(0, 1);
+                NS::Range textureViewArrayRange = NS::Range::Make(imageArrayIndex, 1);
+                textureView = NS::TransferPtr(
+                    texture->newTextureView(textureViewFormat, textureViewType, textureViewMipRange, textureViewArrayRange));
+                textureView->setLabel(MTLSTR("ColorSliceTexture"));
+            }
+            return textureView;
+        }
+
+        /// Get a 2D view of one array slice of the depth image used with a color image, created the first time it is asked for.
+        const NS::SharedPtr<MTL::Texture>& GetDepthSliceTexture(uint32_t imageIndex, uint32_t imageArrayIndex)
+        {
+            NS::SharedPtr<MTL::Texture>& textureView = GetSliceTextureEntry(m_depthSliceTextures, imageIndex, imageArrayIndex);
+            if (!textureView) {
+                MTL::Texture* texture = (MTL::Texture*)GetDepthImageForColorIndex(imageIndex).texture;
+                const XrSwapchainCreateInfo* depthCreateInfo = GetDepthCreateInfo();
+                MTL::PixelFormat depthSwapchainFormat = depthCreateInfo != nullptr ? (MTL::PixelFormat)depthCreateInfo->format
+                                                                                   : MetalFallbackDepthTexture::GetDefaultDepthFormat();
+                MTL::TextureType textureViewType = (DepthSampleCount() > 1) ? MTL::TextureType2DMultisample : MTL::TextureType2D;
+                NS::Range textureViewMipRange = NS::Range::Make(0, 1);
+                NS::Range textureViewArrayRange = NS::Range::Make(imageArrayIndex, 1);
+                textureView = NS::TransferPtr(
+                    texture->newTextureView(depthSwapchainFormat, textureViewType, textureViewMipRange, textureViewArrayRange));
+                textureView->setLabel(MTLSTR("DepthSliceTexture"));
+            }
+            return textureView;
+        }
+
         const XrSwapchainImageMetalKHR& GetFallbackDepthSwapchainImage(uint32_t i) override
         {
             if (!m_internalDepthTextures[i].Allocated()) {
-                m_internalDepthTextures[i].Allocate(m_device.get(), this->Width(), this->Height(), this->ArraySize(),
+                m_internalDepthTextures[i].Allocate(m_device.get(), this->Width(), this->Height(), this->LayerCount(),
                                                     this->DepthSampleCount());
             }
 
@@ -194,13 +242,121 @@ namespace Conformance
         }
 
     private:
+        NS::SharedPtr<MTL::Texture>& GetSliceTextureEntry(std::vector<NS::SharedPtr<MTL::Texture>>& textureViews, uint32_t imageIndex,
+                                                          uint32_t imageArrayIndex)
+        {
+            const size_t index = (size_t)imageIndex * LayerCount() + imageArrayIndex;
+            if (textureViews.size() <= index) {
+                textureViews.resize(index + 1);
+            }
+            return textureViews[index];
+        }
+
         NS::SharedPtr<MTL::Device> m_device;
         std::vector<MetalFallbackDepthTexture> m_internalDepthTextures;
+        /// Views of each slice of each image, indexed by image index * layer count + slice
+        std::vector<NS::SharedPtr<MTL::Texture>> m_colorSliceTextures;
+        std::vector<NS::SharedPtr<MTL::Texture>> m_depthSliceTextures;
         NS::SharedPtr<MTL::Function> m_cachedVertexFunction;
         NS::SharedPtr<MTL::Function> m_cachedFragmentFunction;
         NS::SharedPtr<MTL::RenderPipelineState> m_pipelineStateObject;
     };
 
+    /// Tracks the command buffers of the operations timed for a GpuTimerScopes, which report their own GPU start and end times
+    class MetalGpuTimers
+    {
+    public:
+        GpuTimerScopes& Scopes()
+        {
+            return m_scopes;
+        }
+
+        /// Time @p pCmd, which has just been committed, as an interval of @p operationName, if it is to be timed.
+        void Committed(MTL::CommandBuffer* pCmd, const char* operationName)
+        {
+            const uint64_t id = m_scopes.BeginInterval(operationName);
+            if (id != 0) {
+                m_pending.push_back(Interval{id, NS::RetainPtr(pCmd)});
+            }
+        }
+
+        /// Resolve the intervals whose command buffers have finished, waiting for them all if @p wait is set.
+        void ResolveIntervals(bool wait)
+        {
+            while (!m_pending.empty()) {
+                Interval& interval = m_pending.front();
+                if (wait) {
+                    interval.commandBuffer->waitUntilCompleted();
+                }
+                const MTL::CommandBufferStatus status = interval.commandBuffer->status();
+                if (status != MTL::CommandBufferStatusCompleted && status != MTL::CommandBufferStatusError) {
+                    // Command buffers on the one queue complete in order, so the rest are not done either.
+                    break;
+                }
+                const double start = interval.commandBuffer->GPUStartTime();
+                const double end = interval.commandBuffer->GPUEndTime();
+                const bool valid = status == MTL::CommandBufferStatusCompleted && end >= start;
+                const double nanoseconds = valid ? (end - start) * 1e9 : 0.0;
+                m_scopes.ResolveInterval(interval.id, std::chrono::nanoseconds((int64_t)nanoseconds), valid);
+                m_pending.pop_front();
+            }
+        }
+
+        /// Wait for and resolve the pending intervals, releasing their command buffers.
+        void Reset()
+        {
+            ResolveIntervals(true);
+            m_scopes.DiscardPending();
+        }
+
+    private:
+        struct Interval
+        {
+            uint64_t id;
+            NS::SharedPtr<MTL::CommandBuffer> commandBuffer;
+        };
+
+        GpuTimerScopes m_scopes;
+        /// Committed, in commit order
+        std::deque<Interval> m_pending;
+    };
+
+    /// Limits the command buffers committed but not yet completed, so that the CPU only waits on the GPU when it gets that far
+    /// ahead, rather than after each command buffer.
+    class MetalFramesInFlight
+    {
+    public:
+        static constexpr uint32_t MaxCommandBuffersInFlight = 3;
+
+        /// Commit @p pCmd, first waiting until fewer than MaxCommandBuffersInFlight are in flight.
+        void Commit(MTL::CommandBuffer* pCmd)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condition.wait(lock, [this] { return m_inFlight < MaxCommandBuffersInFlight; });
+                m_inFlight++;
+            }
+            pCmd->addCompletedHandler([this](MTL::CommandBuffer*) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_inFlight--;
+                m_condition.notify_all();
+            });
+            pCmd->commit();
+        }
+
+        /// Wait for all the command buffers committed to complete.
+        void WaitIdle()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_inFlight == 0; });
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        uint32_t m_inFlight{0};
+    };
+
     struct MetalGraphicsPlugin : public IGraphicsPlugin
     {
         MetalGraphicsPlugin(std::shared_ptr<IPlatformPlugin>);
@@ -220,6 +376,11 @@ namespace Conformance
         bool InitializeDevice(XrInstance instance, XrSystemId systemId, bool checkGraphicsRequirements,
                               uint32_t deviceCreationFlags) override;
 
+        void PrepareDevice() override
+        {
+            m_brdfLutFileData.Start();
+        }
+
         void ClearSwapchainCache() override;
 
         void ShutdownDevice() override;
@@ -228,6 +389,8 @@ namespace Conformance
 
         void CopyRGBAImage(const XrSwapchainImageBaseHeader* swapchainImage, uint32_t arraySlice, const RGBAImage& image) override;
 
+        uint64_t GetSwapchainImageMemorySize(const XrSwapchainImageBaseHeader* swapchainImage) const override;
+
         std::string GetImageFormatName(int64_t imageFormat) const override;
 
         bool IsImageFormatKnown(int64_t imageFormat) const override;
@@ -260,6 +423,14 @@ namespace Conformance
         MeshHandle MakeSimpleMesh(span<const uint16_t> idx, span<const Geometry::Vertex> vtx) override;
 
         GLTFModelHandle LoadGLTF(Gltf::ModelBuilder&& modelBuilder) override;
+        std::vector<Conformance::Image::FormatParams> GetSupportedTextureFormats() const override
+        {
+            if (!pbrResources) {
+                return {};
+            }
+            const auto formats = pbrResources->GetSupportedFormats();
+            return {formats.begin(), formats.end()};
+        }
         std::shared_ptr<Pbr::Model> GetPbrModel(GLTFModelHandle handle) const override;
         GLTFModelInstanceHandle CreateGLTFModelInstance(GLTFModelHandle handle) override;
         Pbr::ModelInstance& GetModelInstance(GLTFModelInstanceHandle handle) override;
@@ -267,11 +438,34 @@ namespace Conformance
         void RenderView(const XrCompositionLayerProjectionView& layerView, const XrSwapchainImageBaseHeader* colorSwapchainImage,
                         const RenderParams& params) override;
 
+        bool SupportsGpuTimers() const override
+        {
+            return true;
+        }
+
+        void BeginGpuTimerScope(const char* name) override
+        {
+            m_gpuTimers.Scopes().BeginScope(name);
+        }
+
+        void EndGpuTimerScope() override
+        {
+            m_gpuTimers.Scopes().EndScope();
+        }
+
+        void CollectGpuTimerSamples(std::vector<GpuTimerSample>& samples) override
+        {
+            m_gpuTimers.ResolveIntervals(false);
+            m_gpuTimers.Scopes().TakeSamples(samples);
+        }
+
     private:
         bool m_initialized{false};
         XrGraphicsBindingMetalKHR m_graphicsBinding{XR_TYPE_GRAPHICS_BINDING_METAL_KHR};
         NS::SharedPtr<MTL::Device> m_device;
         NS::SharedPtr<MTL::CommandQueue> m_commandQueue;
+        MetalFramesInFlight m_framesInFlight;
+        MetalGpuTimers m_gpuTimers;
 
         NS::SharedPtr<MTL::Library> m_library;
         NS::SharedPtr<MTL::Function> m_vertexFunction;
@@ -288,16 +482,16 @@ namespace Conformance
 
         MeshHandle m_cubeMesh;
         VectorWithGenerationCountedHandles<MetalMesh, MeshHandle> m_meshes;
+        MeshHandleCache<uint16_t, Geometry::Vertex, MeshHandle> m_meshesByContent;
+        MeshInstanceBatches m_meshBatches;
         // This is fine to be a shared_ptr because Model doesn't directly hold any graphics state.
         VectorWithGenerationCountedHandles<std::shared_ptr<Pbr::Model>, GLTFModelHandle> m_gltfModels;
+        SceneHandleCache<Gltf::DecodedScene, GLTFModelHandle> m_gltfModelsByScene;
         VectorWithGenerationCountedHandles<MetalGLTF, GLTFModelInstanceHandle> m_gltfInstances;
 
         std::unique_ptr<Pbr::MetalResources> pbrResources;
-
-        NS::SharedPtr<MTL::Texture> GetColorSliceTexture(MetalSwapchainImageData& swapchainData, uint32_t imageIndex,
-                                                         uint32_t imageArrayIndex) const;
-        NS::SharedPtr<MTL::Texture> GetDepthSliceTexture(MetalSwapchainImageData& swapchainData, uint32_t imageIndex,
-                                                         uint32_t imageArrayIndex) const;
+        /// Read ahead by PrepareDevice, see DeviceIndependentLoad.
+        DeviceIndependentLoad<std::vector<uint8_t>> m_brdfLutFileData{[] { return ReadFileBytes("brdf_lut.png"); }};
     };
 
     MetalGraphicsPlugin::MetalGraphicsPlugin(std::shared_ptr<IPlatformPlugin>)
@@ -352,7 +546,11 @@ namespace Conformance
                 auto xrGetMetalGraphicsRequirementsKHR =
                     GetInstanceExtensionFunction<PFN_xrGetMetalGraphicsRequirementsKHR>(instance, "xrGetMetalGraphicsRequirementsKHR");
 
-                XrResult result = xrGetMetalGraphicsRequirementsKHR(instance, systemId, &graphicsRequirements);
+                XrResult result;
+                {
+                    ScopedStartupPhase timing(StartupPhase::GraphicsRequirements);
+                    result = xrGetMetalGraphicsRequirementsKHR(instance, systemId, &graphicsRequirements);
+                }
                 CHECK(ValidateResultAllowed("xrGetMetalGraphicsRequirementsKHR", result));
                 if (XR_FAILED(result)) {
                     return false;
@@ -374,6 +572,7 @@ namespace Conformance
             }
 
             m_graphicsBinding.commandQueue = m_commandQueue.get();
+            m_gpuTimers.Scopes().SetTimeOperations(GetGlobalData().options.gpuTimers);
 
             InitializeResources();
         }
@@ -396,6 +595,9 @@ namespace Conformance
 
         m_swapchainImageDataMap.Reset();
 
+        // The completion handlers of command buffers still in flight refer to m_framesInFlight.
+        m_framesInFlight.WaitIdle();
+        m_gpuTimers.Reset();
         m_commandQueue.reset();
         m_device.reset();
     }
@@ -408,8 +610,15 @@ namespace Conformance
         return nullptr;
     }
 
+    uint64_t MetalGraphicsPlugin::GetSwapchainImageMemorySize(const XrSwapchainImageBaseHeader* swapchainImage) const
+    {
+        MTL::Texture* texture = (MTL::Texture*)(reinterpret_cast<const XrSwapchainImageMetalKHR*>(swapchainImage)->texture);
+        return texture->allocatedSize();
+    }
+
     void MetalGraphicsPlugin::CopyRGBAImage(const XrSwapchainImageBaseHeader* swapchainImage, uint32_t arraySlice, const RGBAImage& image)
     {
+        XRC_TRACE_SCOPE("MetalGraphicsPlugin::CopyRGBAImage");
         MTL::Texture* texture = (MTL::Texture*)(reinterpret_cast<const XrSwapchainImageMetalKHR*>(swapchainImage)->texture);
         MTL::Region region(0, 0, image.width, image.height);
         NS::SharedPtr<MTL::Buffer> buffer = NS::TransferPtr(m_device->newBuffer(
@@ -420,8 +629,10 @@ namespace Conformance
         pBlitEncoder->copyFromBuffer(buffer.get(), 0, image.width * sizeof(uint32_t), 0, region.size, texture, arraySlice, 0,
                                      region.origin);
         pBlitEncoder->endEncoding();
-        pCmd->commit();
-        pCmd->waitUntilCompleted();
+        // The command buffer retains the staging buffer until it completes, so there is no need to wait for it here.
+        m_framesInFlight.Commit(pCmd);
+        m_gpuTimers.Committed(pCmd, "CopyRGBAImage");
+        m_gpuTimers.ResolveIntervals(false);
     }
 
     static const SwapchainFormatDataMap& GetSwapchainFormatData()
@@ -730,36 +941,6 @@ namespace Conformance
         return ret;
     }
 
-    NS::SharedPtr<MTL::Texture> MetalGraphicsPlugin::GetColorSliceTexture(MetalSwapchainImageData& swapchainData, uint32_t imageIndex,
-                                                                          uint32_t imageArrayIndex) const
-    {
-        MTL::Texture* texture = (MTL::Texture*)swapchainData.GetTypedImage(imageIndex).texture;
-        MTL::PixelFormat textureViewFormat = (MTL::PixelFormat)swapchainData.GetCreateInfo().format;
-        MTL::TextureType textureViewType = (swapchainData.SampleCount() > 1) ? MTL::TextureType2DMultisample : MTL::TextureType2D;
-        NS::Range textureViewMipRange = NS::Range::Make(0, 1);
-        NS::Range textureViewArrayRange = NS::Range::Make(imageArrayIndex, 1);
-        MTL::Texture* textureView = texture->newTextureView(textureViewFormat, textureViewType, textureViewMipRange, textureViewArrayRange);
-        textureView->setLabel(MTLSTR("ColorSliceTexture"));
-        return NS::TransferPtr(textureView);
-    }
-
-    NS::SharedPtr<MTL::Texture> MetalGraphicsPlugin::GetDepthSliceTexture(MetalSwapchainImageData& swapchainData, uint32_t imageIndex,
-                                                                          uint32_t imageArrayIndex) const
-    {
-        // Clear depth buffer.
-        MTL::Texture* texture = (MTL::Texture*)swapchainData.GetDepthImageForColorIndex(imageIndex).texture;
-        const XrSwapchainCreateInfo* depthCreateInfo = swapchainData.GetDepthCreateInfo();
-        MTL::PixelFormat depthSwapchainFormat =
-            depthCreateInfo != nullptr ? (MTL::PixelFormat)depthCreateInfo->format : MetalFallbackDepthTexture::GetDefaultDepthFormat();
-        MTL::TextureType textureViewType = (swapchainData.DepthSampleCount() > 1) ? MTL::TextureType2DMultisample : MTL::TextureType2D;
-        NS::Range textureViewMipRange = NS::Range::Make(0, 1);
-        NS::Range textureViewArrayRange = NS::Range::Make(imageArrayIndex, 1);
-        MTL::Texture* textureView =
-            texture->newTextureView(depthSwapchainFormat, textureViewType, textureViewMipRange, textureViewArrayRange);
-        textureView->setLabel(MTLSTR("DepthSliceTexture"));
-        return NS::TransferPtr(textureView);
-    }
-
     void MetalGraphicsPlugin::ClearImageSlice(const XrSwapchainImageBaseHeader* colorSwapchainImage, uint32_t imageArrayIndex,
                                               XrColor4f color)
     {
@@ -770,8 +951,8 @@ namespace Conformance
 
         std::tie(swapchainData, imageIndex) = m_swapchainImageDataMap.GetDataAndIndexFromBasePointer(colorSwapchainImage);
 
-        NS::SharedPtr<MTL::Texture> colorTexture = GetColorSliceTexture(*swapchainData, imageIndex, imageArrayIndex);
-        NS::SharedPtr<MTL::Texture> depthTexture = GetDepthSliceTexture(*swapchainData, imageIndex, imageArrayIndex);
+        const NS::SharedPtr<MTL::Texture>& colorTexture = swapchainData->GetColorSliceTexture(imageIndex, imageArrayIndex);
+        const NS::SharedPtr<MTL::Texture>& depthTexture = swapchainData->GetDepthSliceTexture(imageIndex, imageArrayIndex);
 
         MTL::CommandBuffer* pCmd = m_commandQueue->commandBuffer();
 
@@ -789,18 +970,36 @@ namespace Conformance
         MTL::RenderCommandEncoder* pEnc = pCmd->renderCommandEncoder(renderPassDesc.get());
         pEnc->setLabel(MTLSTR("ClearImageSlice"));
         pEnc->endEncoding();
-        pCmd->commit();
+        m_framesInFlight.Commit(pCmd);
+        m_gpuTimers.Committed(pCmd, "ClearImageSlice");
+        m_gpuTimers.ResolveIntervals(false);
     }
 
     MeshHandle MetalGraphicsPlugin::MakeSimpleMesh(span<const uint16_t> idx, span<const Geometry::Vertex> vtx)
     {
-        auto handle = m_meshes.emplace_back(m_device, idx, vtx);
+        // A mesh with the same content shares the buffers created then.
+        MeshHandle cachedHandle = m_meshesByContent.Find(idx, vtx);
+        if (cachedHandle != MeshHandle{}) {
+            return cachedHandle;
+        }
+
+        auto handle = m_meshes.emplace_back(m_device, pbrResources->GetStaticResourceHeaps(), idx, vtx);
+        m_meshesByContent.Insert(idx, vtx, handle);
         return handle;
     }
 
     GLTFModelHandle MetalGraphicsPlugin::LoadGLTF(Gltf::ModelBuilder&& modelBuilder)
     {
+        XRC_TRACE_SCOPE("MetalGraphicsPlugin::LoadGLTF");
+        // A scene already loaded on this device shares the model built then.
+        std::shared_ptr<const Gltf::DecodedScene> scene = modelBuilder.GetDecodedScene();
+        GLTFModelHandle cachedHandle = m_gltfModelsByScene.Find(scene);
+        if (cachedHandle != GLTFModelHandle{}) {
+            return cachedHandle;
+        }
+
         auto handle = m_gltfModels.emplace_back(modelBuilder.Build(*pbrResources));
+        m_gltfModelsByScene.Insert(std::move(scene), handle);
         return handle;
     }
 
@@ -824,6 +1023,7 @@ namespace Conformance
     void MetalGraphicsPlugin::RenderView(const XrCompositionLayerProjectionView& layerView,
                                          const XrSwapchainImageBaseHeader* colorSwapchainImage, const RenderParams& params)
     {
+        XRC_TRACE_SCOPE("MetalGraphicsPlugin::RenderView");
         auto pAutoReleasePool = NS::TransferPtr(NS::AutoreleasePool::alloc()->init());
 
         MetalSwapchainImageData* swapchainData;
@@ -831,8 +1031,12 @@ namespace Conformance
 
         std::tie(swapchainData, imageIndex) = m_swapchainImageDataMap.GetDataAndIndexFromBasePointer(colorSwapchainImage);
 
-        NS::SharedPtr<MTL::Texture> colorTexture = GetColorSliceTexture(*swapchainData, imageIndex, layerView.subImage.imageArrayIndex);
-        NS::SharedPtr<MTL::Texture> depthTexture = GetDepthSliceTexture(*swapchainData, imageIndex, layerView.subImage.imageArrayIndex);
+        const uint32_t imageArrayIndex = layerView.subImage.imageArrayIndex;
+        const NS::SharedPtr<MTL::Texture>& colorTexture = swapchainData->GetColorSliceTexture(imageIndex, imageArrayIndex);
+        const NS::SharedPtr<MTL::Texture>& depthTexture = swapchainData->GetDepthSliceTexture(imageIndex, imageArrayIndex);
+
+        // Meshes, models and textures created since the last view have their uploads recorded but not yet submitted.
+        pbrResources->GetStaticResourceHeaps().Flush();
 
         MTL::CommandBuffer* pCmd = m_commandQueue->commandBuffer();
 
@@ -874,38 +1078,35 @@ namespace Conformance
 
         static_assert(sizeof(XrMatrix4x4f) == sizeof(simd::float4x4), "Unexpected matrix size");
 
-        if (params.cubes.size() > 0 || params.meshes.size() > 0) {
+        if (params.cubes.size() > 0 || params.meshes.size() > 0 || params.depthPrePass.size() > 0) {
             pEnc->pushDebugGroup(MTLSTR("CubesAndMeshes"));
 
-            MeshHandle lastMeshHandle;
-
-            const auto drawMesh = [this, &pEnc, &vp, &lastMeshHandle](const MeshDrawable mesh) {
-                MetalMesh& metalMesh = m_meshes[mesh.handle];
-
-                if (mesh.handle != lastMeshHandle) {
-                    pEnc->setVertexBuffer(metalMesh.vertexBuffer.get(), 0, 0);
-                    lastMeshHandle = mesh.handle;
-                }
-
+            // Compute the per-instance data for all cubes and meshes. A new buffer is used for each view, since earlier
+            // command buffers may still be reading theirs; the command buffer retains it until it completes.
+            m_meshBatches.Build(params, m_cubeMesh);
+            const std::vector<MeshDrawable>& instances = m_meshBatches.Instances();
+            NS::SharedPtr<MTL::Buffer> instanceBuffer =
+                NS::TransferPtr(m_device->newBuffer(instances.size() * sizeof(MetalMeshInstance), MTL::ResourceStorageModeShared));
+            MetalMeshInstance* instanceData = static_cast<MetalMeshInstance*>(instanceBuffer->contents());
+            for (size_t i = 0; i < instances.size(); ++i) {
+                const MeshDrawable& mesh = instances[i];
                 XrMatrix4x4f model;
                 XrMatrix4x4f_CreateTranslationRotationScale(&model, &mesh.params.pose.position, &mesh.params.pose.orientation,
                                                             &mesh.params.scale);
                 XrMatrix4x4f mvp;
                 XrMatrix4x4f_Multiply(&mvp, &vp, &model);
-
-                pEnc->setVertexBytes(&mvp, sizeof(simd::float4x4), 1);
-                pEnc->drawIndexedPrimitives(MTL::PrimitiveType::PrimitiveTypeTriangle, metalMesh.numIndices, MTL::IndexTypeUInt16,
-                                            metalMesh.indexBuffer.get(), 0);
-            };
-
-            // Render each cube
-            for (const Cube& cube : params.cubes) {
-                drawMesh(MeshDrawable{m_cubeMesh, cube.params.pose, cube.params.scale});
+                memcpy(&instanceData[i].modelViewProjection, &mvp, sizeof(mvp));
+                instanceData[i].tintColor = simd::float4{mesh.tintColor.r, mesh.tintColor.g, mesh.tintColor.b, mesh.tintColor.a};
             }
 
-            // Render each mesh
-            for (const auto& mesh : params.meshes) {
-                drawMesh(mesh);
+            // Draw all instances of each mesh with a single call.
+            pEnc->setVertexBuffer(instanceBuffer.get(), 0, 1);
+            for (const MeshInstanceBatches::Batch& batch : m_meshBatches.Batches()) {
+                MetalMesh& metalMesh = m_meshes[batch.handle];
+                pEnc->setVertexBuffer(metalMesh.vertexBuffer.get(), 0, 0);
+                pEnc->setVertexBufferOffset(batch.firstInstance * sizeof(MetalMeshInstance), 1);
+                pEnc->drawIndexedPrimitives(MTL::PrimitiveType::PrimitiveTypeTriangle, metalMesh.numIndices, MTL::IndexTypeUInt16,
+                                            metalMesh.indexBuffer.get(), 0, batch.instanceCount);
             }
 
             pEnc->popDebugGroup();
@@ -933,7 +1134,9 @@ namespace Conformance
         pEnc->popDebugGroup();
 
         pEnc->endEncoding();
-        pCmd->commit();
+        m_framesInFlight.Commit(pCmd);
+        m_gpuTimers.Committed(pCmd, "RenderView");
+        m_gpuTimers.ResolveIntervals(false);
     }
 
     // Private methods
@@ -952,6 +1155,12 @@ namespace Conformance
             float4 color;
         };
 
+        struct MeshInstance
+        {
+            float4x4 modelViewProjection;
+            float4 tintColor;
+        };
+
         struct v2f
         {
             float4 position [[position]];
@@ -959,12 +1168,13 @@ namespace Conformance
         };
 
         v2f vertex vertexMain(uint vertexId [[vertex_id]], uint instanceId [[instance_id]],
-                              device const VertexBuffer* vertexBuffer [[buffer(0)]], device const float4x4* matricesBuffer [[buffer(1)]])
+                              device const VertexBuffer* vertexBuffer [[buffer(0)]], device const MeshInstance* instances [[buffer(1)]])
         {
             v2f o;
             float4 pos = vertexBuffer[vertexId].position;
-            o.position = matricesBuffer[instanceId] * pos;
-            o.color = half4(vertexBuffer[vertexId].color);
+            o.position = instances[instanceId].modelViewProjection * pos;
+            float4 tint = instances[instanceId].tintColor;
+            o.color = half4(float4(mix(vertexBuffer[vertexId].color.rgb, tint.rgb, tint.a), 1));
             return o;
         }
 
@@ -988,16 +1198,18 @@ namespace Conformance
         depthDescriptor->setDepthWriteEnabled(true);
         m_depthStencilState = NS::TransferPtr(m_device->newDepthStencilState(depthDescriptor.get()));
 
-        m_cubeMesh = MakeCubeMesh();
-
+        // The cube mesh is placed in the static resource heaps of the PBR resources.
         pbrResources = std::make_unique<Pbr::MetalResources>(m_device.get());
         pbrResources->SetLight({0.0f, 0.7071067811865475f, 0.7071067811865475f}, Pbr::RGB::White);
+        pbrResources->SetTextureCacheBudget(uint64_t{GetGlobalData().options.pbrTextureCacheBudget} << 20);
+
+        m_cubeMesh = MakeCubeMesh();
 
         auto blackCubeMap =
             Pbr::MetalTexture::CreateFlatCubeTexture(*pbrResources, Pbr::RGBA::Black, MTL::PixelFormatRGBA8Unorm, MTLSTR("blackCubeMap"));
         pbrResources->SetEnvironmentMap(blackCubeMap.get(), blackCubeMap.get());
 
-        std::vector<uint8_t> brdfLutFileData = ReadFileBytes("brdf_lut.png");
+        const std::vector<uint8_t>& brdfLutFileData = m_brdfLutFileData.Get();
         NS::SharedPtr<MTL::Texture> brdfLutTexture = Pbr::MetalTexture::LoadTextureImage(
             *pbrResources, false, brdfLutFileData.data(), (uint32_t)brdfLutFileData.size(), MTLSTR("brdf_lut.png"));
         pbrResources->SetBrdfLut(brdfLutTexture.get());
@@ -1009,8 +1221,10 @@ namespace Conformance
     {
         m_cubeMesh = {};
         m_meshes.clear();
+        m_meshesByContent.clear();
         m_gltfInstances.clear();
         m_gltfModels.clear();
+        m_gltfModelsByScene.clear();
         pbrResources.reset();
 
         m_depthStencilState.reset();
@@ -23,7 +23,9 @@
 #include "graphics_plugin.h"
 #include "graphics_plugin_impl_helpers.h"
 #include "graphics_plugin_opengl_gltf.h"
+#include "mesh_instance_batches.h"
 #include "report.h"
+#include "startup_timing.h"
 #include "swapchain_image_data.h"
 
 #include "common/gfxwrapper_opengl.h"
@@ -38,6 +40,7 @@
 #include "utilities/swapchain_format_data.h"
 #include "utilities/swapchain_parameters.h"
 #include "utilities/throw_helpers.h"
+#include "utilities/trace.h"
 #include "utilities/utils.h"
 
 #include <catch2/catch_message.hpp>
@@ -51,6 +54,7 @@
 #include <array>
 #include <assert.h>
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <stddef.h>
 #include <string>
@@ -181,14 +185,14 @@ namespace Conformance
         in vec3 VertexPos;
         in vec3 VertexColor;
 
-        out vec3 PSVertexColor;
+        in mat4 InstanceModelViewProjection;
+        in vec4 InstanceTintColor;
 
-        uniform mat4 ModelViewProjection;
-        uniform vec4 tintColor;
+        out vec3 PSVertexColor;
 
         void main() {
-           gl_Position = ModelViewProjection * vec4(VertexPos, 1.0);
-           PSVertexColor = mix(VertexColor, tintColor.rgb, tintColor.a);
+           gl_Position = InstanceModelViewProjection * vec4(VertexPos, 1.0);
+           PSVertexColor = mix(VertexColor, InstanceTintColor.rgb, InstanceTintColor.a);
         }
         )_";
 
@@ -203,6 +207,51 @@ namespace Conformance
         }
         )_";
 
+    // Outputs the motion of each pixel since the previous frame, in NDC, for XR_FB_space_warp.
+    static const char* MotionVectorVertexShaderGlsl = R"_(
+        #version 410
+
+        in vec3 VertexPos;
+
+        in mat4 InstanceModelViewProjection;
+        in mat4 InstancePreviousModelViewProjection;
+
+        out vec4 PSCurrentPosition;
+        out vec4 PSPreviousPosition;
+
+        void main() {
+           gl_Position = InstanceModelViewProjection * vec4(VertexPos, 1.0);
+           PSCurrentPosition = gl_Position;
+           PSPreviousPosition = InstancePreviousModelViewProjection * vec4(VertexPos, 1.0);
+        }
+        )_";
+
+    static const char* MotionVectorFragmentShaderGlsl = R"_(
+        #version 410
+
+        in vec4 PSCurrentPosition;
+        in vec4 PSPreviousPosition;
+        out vec4 FragColor;
+
+        void main() {
+           FragColor = vec4(PSCurrentPosition.xyz / PSCurrentPosition.w - PSPreviousPosition.xyz / PSPreviousPosition.w, 0);
+        }
+        )_";
+
+    /// Per-instance vertex attributes for drawing meshes, matching the vertex shader inputs.
+    struct OpenGLMeshInstance
+    {
+        XrMatrix4x4f modelViewProjection;
+        XrColor4f tintColor;
+    };
+
+    /// Per-instance vertex attributes for drawing motion vectors, matching the motion vector vertex shader inputs.
+    struct OpenGLMotionVectorInstance
+    {
+        XrMatrix4x4f modelViewProjection;
+        XrMatrix4x4f previousModelViewProjection;
+    };
+
     struct OpenGLMesh
     {
         bool valid{false};
@@ -365,6 +414,104 @@ namespace Conformance
     private:
         std::vector<OpenGLFallbackDepthTexture> m_internalDepthTextures;
     };
+
+    /// Pairs of GL_TIMESTAMP queries bracketing the operations timed for a GpuTimerScopes
+    class OpenGLGpuTimers
+    {
+    public:
+        GpuTimerScopes& Scopes()
+        {
+            return m_scopes;
+        }
+
+        /// Write the start timestamp of an interval for @p operationName, if it is to be timed.
+        void BeginInterval(const char* operationName)
+        {
+            AbandonCurrentInterval();
+            const uint64_t id = m_scopes.BeginInterval(operationName);
+            if (id == 0) {
+                return;
+            }
+            QueryPair queries;
+            if (m_freeQueries.empty()) {
+                XRC_CHECK_THROW_GLCMD(glGenQueries((GLsizei)queries.size(), queries.data()));
+            }
+            else {
+                queries = m_freeQueries.back();
+                m_freeQueries.pop_back();
+            }
+            XRC_CHECK_THROW_GLCMD(glQueryCounter(queries[0], GL_TIMESTAMP));
+            m_current = Interval{id, queries};
+        }
+
+        /// Write the end timestamp of the interval started by the last @ref BeginInterval.
+        void EndInterval()
+        {
+            if (m_current.id == 0) {
+                return;
+            }
+            XRC_CHECK_THROW_GLCMD(glQueryCounter(m_current.queries[1], GL_TIMESTAMP));
+            m_pending.push_back(m_current);
+            m_current = {};
+        }
+
+        /// Resolve the intervals whose timestamps are available, or all of them if @p wait.
+        void ResolveIntervals(bool wait)
+        {
+            while (!m_pending.empty()) {
+                const Interval& interval = m_pending.front();
+                if (!wait) {
+                    GLint available = GL_FALSE;
+                    XRC_CHECK_THROW_GLCMD(glGetQueryObjectiv(interval.queries[1], GL_QUERY_RESULT_AVAILABLE, &available));
+                    if (available == GL_FALSE) {
+                        break;
+                    }
+                }
+                GLuint64 begin = 0;
+                GLuint64 end = 0;
+                XRC_CHECK_THROW_GLCMD(glGetQueryObjectui64v(interval.queries[0], GL_QUERY_RESULT, &begin));
+                XRC_CHECK_THROW_GLCMD(glGetQueryObjectui64v(interval.queries[1], GL_QUERY_RESULT, &end));
+                // GL_TIMESTAMP is in nanoseconds.
+                m_scopes.ResolveInterval(interval.id, std::chrono::nanoseconds(end - begin), end >= begin);
+                m_freeQueries.push_back(interval.queries);
+                m_pending.pop_front();
+            }
+        }
+
+        /// Delete the queries, while the context is still current, once the intervals using them have resolved.
+        void Reset()
+        {
+            AbandonCurrentInterval();
+            ResolveIntervals(true);
+            for (QueryPair& queries : m_freeQueries) {
+                glDeleteQueries((GLsizei)queries.size(), queries.data());
+            }
+            m_freeQueries.clear();
+        }
+
+    private:
+        using QueryPair = std::array<GLuint, 2>;
+        struct Interval
+        {
+            uint64_t id;
+            QueryPair queries;
+        };
+
+        /// An interval was begun but not ended, e.g. because an exception was thrown while recording it.
+        void AbandonCurrentInterval()
+        {
+            if (m_current.id != 0) {
+                m_scopes.ResolveInterval(m_current.id, std::chrono::nanoseconds{0}, false);
+                m_freeQueries.push_back(m_current.queries);
+                m_current = {};
+            }
+        }
+
+        GpuTimerScopes m_scopes;
+        Interval m_current{};
+        std::deque<Interval> m_pending;
+        std::vector<QueryPair> m_freeQueries;
+    };
     struct OpenGLGraphicsPlugin : public IGraphicsPlugin
     {
         OpenGLGraphicsPlugin(const std::shared_ptr<IPlatformPlugin>& /*unused*/);
@@ -388,6 +535,11 @@ namespace Conformance
 
         bool InitializeDevice(XrInstance instance, XrSystemId systemId, bool checkGraphicsRequirements,
                               uint32_t deviceCreationFlags) override;
+
+        void PrepareDevice() override
+        {
+            m_brdfLutFileData.Start();
+        }
         void DebugMessageCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message) const;
         void InitializeResources();
         void CheckFramebuffer(GLuint fb) const;
@@ -398,6 +550,8 @@ namespace Conformance
         const XrBaseInStructure* GetGraphicsBinding() const override;
 
         void CopyRGBAImage(const XrSwapchainImageBaseHeader* swapchainImage, uint32_t arraySlice, const RGBAImage& image) override;
+        void CopyRGBAImageRows(const XrSwapchainImageBaseHeader* swapchainImage, uint32_t arraySlice, uint32_t width, uint32_t height,
+                               const RGBARowWriter& writeRows) override;
 
         std::string GetImageFormatName(int64_t imageFormat) const override;
 
@@ -430,6 +584,14 @@ namespace Conformance
         MeshHandle MakeSimpleMesh(span<const uint16_t> idx, span<const Geometry::Vertex> vtx) override;
 
         GLTFModelHandle LoadGLTF(Gltf::ModelBuilder&& modelBuilder) override;
+        std::vector<Conformance::Image::FormatParams> GetSupportedTextureFormats() const override
+        {
+            if (!m_pbrResources) {
+                return {};
+            }
+            const auto formats = m_pbrResources->GetSupportedFormats();
+            return {formats.begin(), formats.end()};
+        }
         std::shared_ptr<Pbr::Model> GetPbrModel(GLTFModelHandle handle) const override;
         GLTFModelInstanceHandle CreateGLTFModelInstance(GLTFModelHandle handle) override;
         Pbr::ModelInstance& GetModelInstance(GLTFModelInstanceHandle handle) override;
@@ -437,6 +599,46 @@ namespace Conformance
         void RenderView(const XrCompositionLayerProjectionView& layerView, const XrSwapchainImageBaseHeader* colorSwapchainImage,
                         const RenderParams& params) override;
 
+        bool SupportsGpuTimers() const override
+        {
+            return true;
+        }
+
+        void BeginGpuTimerScope(const char* name) override
+        {
+            m_gpuTimers.Scopes().BeginScope(name);
+        }
+
+        void EndGpuTimerScope() override
+        {
+            m_gpuTimers.Scopes().EndScope();
+        }
+
+        void CollectGpuTimerSamples(std::vector<GpuTimerSample>& samples) override;
+
+        bool SupportsMotionVectors() const override
+        {
+            return true;
+        }
+
+        void RenderMotionVectorView(const XrCompositionLayerProjectionView& layerView,
+                                    const XrCompositionLayerProjectionView& previousLayerView,
+                                    const XrSwapchainImageBaseHeader* motionVectorSwapchainImage,
+                                    const XrSwapchainImageBaseHeader* depthSwapchainImage, const RenderParams& params,
+                                    const RenderParams& previousParams) override;
+
+        bool SupportsReversedDepth() const override
+        {
+            return true;
+        }
+
+        void SetReversedDepth(bool reversed) override;
+
+        Pbr::DrawStats TakeGltfDrawStats() override
+        {
+            return std::exchange(m_gltfDrawStats, {});
+        }
+
     private:
         bool initialized = false;
         bool deviceInitialized = false;
@@ -462,16 +664,34 @@ namespace Conformance
         SwapchainImageDataMap<OpenGLSwapchainImageData> m_swapchainImageDataMap;
         GLuint m_swapchainFramebuffer{0};
         GLuint m_program{0};
-        GLint m_modelViewProjectionUniformLocation{0};
-        GLint m_tintColorUniformLocation{0};
         GLint m_vertexAttribCoords{0};
         GLint m_vertexAttribColor{0};
+        GLint m_instanceAttribModelViewProjection{0};
+        GLint m_instanceAttribTintColor{0};
+        GLuint m_instanceBuffer{0};
+        MeshInstanceBatches m_meshBatches;
+        std::vector<OpenGLMeshInstance> m_instanceData;
+        GLuint m_motionVectorProgram{0};
+        GLint m_motionVectorAttribPreviousModelViewProjection{0};
+        GLuint m_motionVectorInstanceBuffer{0};
+        MeshInstanceBatches m_previousMeshBatches;
+        std::vector<OpenGLMotionVectorInstance> m_motionVectorInstanceData;
         MeshHandle m_cubeMesh{};
         VectorWithGenerationCountedHandles<OpenGLMesh, MeshHandle> m_meshes;
+        MeshHandleCache<uint16_t, Geometry::Vertex, MeshHandle> m_meshesByContent;
         // This is fine to be a shared_ptr because Model doesn't directly hold any graphics state.
         VectorWithGenerationCountedHandles<std::shared_ptr<Pbr::Model>, GLTFModelHandle> m_gltfModels;
+        SceneHandleCache<Gltf::DecodedScene, GLTFModelHandle> m_gltfModelsByScene;
         VectorWithGenerationCountedHandles<GLGLTF, GLTFModelInstanceHandle> m_gltfInstances;
         std::unique_ptr<Pbr::GLResources> m_pbrResources;
+        /// Read ahead by PrepareDevice, see DeviceIndependentLoad.
+        DeviceIndependentLoad<std::vector<uint8_t>> m_brdfLutFileData{[] { return ReadFileBytes("brdf_lut.png"); }};
+        bool m_reversedDepth{false};
+        Pbr::DrawQueue m_gltfDrawQueue;
+        Pbr::DrawStats m_gltfDrawStats;
+        OpenGLGpuTimers m_gpuTimers;
+        std::unique_ptr<GLImageUploader> m_imageUploader;
+        std::unique_ptr<GLUploadWorker> m_uploadWorker;
     };
 
     OpenGLGraphicsPlugin::OpenGLGraphicsPlugin(const std::shared_ptr<IPlatformPlugin>& /*unused*/)
@@ -490,6 +710,15 @@ namespace Conformance
             return false;
         }
 
+#if defined(OS_LINUX_XLIB) || defined(OS_LINUX_XCB_GLX)
+        // The upload worker makes its context current on another thread, through the window's Display. Xlib only allows
+        // that for displays opened after XInitThreads, so call it before the runtime or the window open any.
+        if (GetGlobalData().options.glUploadWorker && XInitThreads() == 0) {
+            ReportF("OpenGLGraphicsPlugin::Initialize: XInitThreads failed, which --glUploadWorker needs.");
+            return false;
+        }
+#endif
+
         initialized = true;
         return initialized;
     }
@@ -545,7 +774,11 @@ namespace Conformance
             auto xrGetOpenGLGraphicsRequirementsKHR =
                 GetInstanceExtensionFunction<PFN_xrGetOpenGLGraphicsRequirementsKHR>(instance, "xrGetOpenGLGraphicsRequirementsKHR");
 
-            XrResult result = xrGetOpenGLGraphicsRequirementsKHR(instance, systemId, &graphicsRequirements);
+            XrResult result;
+            {
+                ScopedStartupPhase timing(StartupPhase::GraphicsRequirements);
+                result = xrGetOpenGLGraphicsRequirementsKHR(instance, systemId, &graphicsRequirements);
+            }
             XRC_CHECK_THROW(ValidateResultAllowed("xrGetOpenGLGraphicsRequirementsKHR", result));
             if (XR_FAILED(result)) {
                 // Log result?
@@ -717,44 +950,64 @@ namespace Conformance
         XRC_CHECK_THROW_GLCMD(glGenFramebuffers(1, &m_swapchainFramebuffer));
         //ReportF("Got fb %d", m_swapchainFramebuffer);
 
-        GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertexShader, 1, &VertexShaderGlsl, nullptr);
-        glCompileShader(vertexShader);
-        CheckGLShader(vertexShader);
+        SetGLProgramCacheDirectory(GetGlobalData().options.pipelineCacheDirectory);
+        m_program = LinkGLProgram(VertexShaderGlsl, FragmentShaderGlsl);
 
-        GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragmentShader, 1, &FragmentShaderGlsl, nullptr);
-        glCompileShader(fragmentShader);
-        CheckGLShader(fragmentShader);
+        m_vertexAttribCoords = glGetAttribLocation(m_program, "VertexPos");
+        m_vertexAttribColor = glGetAttribLocation(m_program, "VertexColor");
+        m_instanceAttribModelViewProjection = glGetAttribLocation(m_program, "InstanceModelViewProjection");
+        m_instanceAttribTintColor = glGetAttribLocation(m_program, "InstanceTintColor");
 
-        m_program = glCreateProgram();
-        glAttachShader(m_program, vertexShader);
-        glAttachShader(m_program, fragmentShader);
-        glLinkProgram(m_program);
-        CheckGLProgram(m_program);
+        XRC_CHECK_THROW_GLCMD(glGenBuffers(1, &m_instanceBuffer));
 
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
+        {
+            // Share the vertex array objects of the meshes: the attributes both programs read are at the same locations,
+            // and the previous transform goes in the first four locations the mesh program does not use.
+            GLint previousLocation = 0;
+            auto overlapsMeshAttribs = [&](GLint location) {
+                auto overlaps = [&](GLint first, GLint count) { return location + 4 > first && location < first + count; };
+                return overlaps(m_vertexAttribCoords, 1) || overlaps(m_vertexAttribColor, 1) ||
+                       overlaps(m_instanceAttribModelViewProjection, 4) || overlaps(m_instanceAttribTintColor, 1);
+            };
+            while (overlapsMeshAttribs(previousLocation)) {
+                previousLocation++;
+            }
+            m_motionVectorAttribPreviousModelViewProjection = previousLocation;
 
-        m_modelViewProjectionUniformLocation = glGetUniformLocation(m_program, "ModelViewProjection");
-        m_tintColorUniformLocation = glGetUniformLocation(m_program, "tintColor");
+            m_motionVectorProgram =
+                LinkGLProgram(MotionVectorVertexShaderGlsl, MotionVectorFragmentShaderGlsl,
+                              {{GLuint(m_vertexAttribCoords), "VertexPos"},
+                               {GLuint(m_instanceAttribModelViewProjection), "InstanceModelViewProjection"},
+                               {GLuint(previousLocation), "InstancePreviousModelViewProjection"}});
 
-        m_vertexAttribCoords = glGetAttribLocation(m_program, "VertexPos");
-        m_vertexAttribColor = glGetAttribLocation(m_program, "VertexColor");
+            XRC_CHECK_THROW_GLCMD(glGenBuffers(1, &m_motionVectorInstanceBuffer));
+        }
 
         m_cubeMesh = MakeCubeMesh();
 
-        m_pbrResources = std::make_unique<Pbr::GLResources>();
+        m_pbrResources = std::make_unique<Pbr::GLResources>(GetGlobalData().options.compactPbrVertices);
         m_pbrResources->SetLight({0.0f, 0.7071067811865475f, 0.7071067811865475f}, Pbr::RGB::White);
+        m_pbrResources->SetTextureCacheBudget(uint64_t{GetGlobalData().options.pbrTextureCacheBudget} << 20);
+        m_pbrResources->SetDepthDirection(m_reversedDepth ? Pbr::DepthDirection::Reversed : Pbr::DepthDirection::Forward);
 
         auto blackCubeMap = std::make_shared<Pbr::ScopedGLTexture>(Pbr::GLTexture::CreateFlatCubeTexture(Pbr::RGBA::Black, false));
         m_pbrResources->SetEnvironmentMap(blackCubeMap, blackCubeMap);
 
-        // Read the BRDF Lookup Table used by the PBR system into a GL texture.
-        std::vector<unsigned char> brdfLutFileData = ReadFileBytes("brdf_lut.png");
+        // Load the BRDF Lookup Table used by the PBR system into a GL texture.
+        const std::vector<uint8_t>& brdfLutFileData = m_brdfLutFileData.Get();
         auto brdLutResourceView = std::make_shared<Pbr::ScopedGLTexture>(
             Pbr::GLTexture::LoadTextureImage(*m_pbrResources, false, brdfLutFileData.data(), (uint32_t)brdfLutFileData.size()));
         m_pbrResources->SetBrdfLut(brdLutResourceView);
+
+        m_gpuTimers.Scopes().SetTimeOperations(GetGlobalData().options.gpuTimers);
+
+        // Buffer storage, for persistently mapped upload buffers, is core in 4.4.
+        m_imageUploader = std::make_unique<GLImageUploader>(OpenGLVersionOfContext >= XR_MAKE_VERSION(4, 4, 0));
+
+        if (GetGlobalData().options.glUploadWorker) {
+            m_uploadWorker = std::make_unique<GLUploadWorker>(window.context);
+            m_pbrResources->SetUploadWorker(m_uploadWorker.get());
+        }
     }
 
     void OpenGLGraphicsPlugin::CheckFramebuffer(GLuint fb) const
@@ -809,21 +1062,44 @@ namespace Conformance
 
     void OpenGLGraphicsPlugin::ShutdownDevice()
     {
+        if (deviceInitialized) {
+            m_gpuTimers.Reset();
+        }
+        if (m_imageUploader) {
+            m_imageUploader->Reset();
+            m_imageUploader.reset();
+        }
         if (m_swapchainFramebuffer != 0) {
             glDeleteFramebuffers(1, &m_swapchainFramebuffer);
         }
         if (m_program != 0) {
             glDeleteProgram(m_program);
         }
+        if (m_instanceBuffer != 0) {
+            glDeleteBuffers(1, &m_instanceBuffer);
+            m_instanceBuffer = 0;
+        }
+        if (m_motionVectorProgram != 0) {
+            glDeleteProgram(m_motionVectorProgram);
+            m_motionVectorProgram = 0;
+        }
+        if (m_motionVectorInstanceBuffer != 0) {
+            glDeleteBuffers(1, &m_motionVectorInstanceBuffer);
+            m_motionVectorInstanceBuffer = 0;
+        }
 
         // Reset the swapchains to avoid calling Vulkan functions in the dtors after
         // we've shut down the device.
         m_swapchainImageDataMap.Reset();
         m_cubeMesh = {};
         m_meshes.clear();
+        m_meshesByContent.clear();
         m_gltfInstances.clear();
         m_gltfModels.clear();
+        m_gltfModelsByScene.clear();
         m_pbrResources.reset();
+        // Its thread destroys its context, so it must go before the context it shares objects with.
+        m_uploadWorker.reset();
 
         deleteGLContext();
     }
@@ -998,30 +1274,49 @@ namespace Conformance
 
     void OpenGLGraphicsPlugin::CopyRGBAImage(const XrSwapchainImageBaseHeader* swapchainImage, uint32_t arraySlice, const RGBAImage& image)
     {
+        XRC_TRACE_SCOPE("OpenGLGraphicsPlugin::CopyRGBAImage");
         OpenGLSwapchainImageData* swapchainData;
         uint32_t imageIndex;
         std::tie(swapchainData, imageIndex) = m_swapchainImageDataMap.GetDataAndIndexFromBasePointer(swapchainImage);
 
+        m_gpuTimers.BeginInterval("CopyRGBAImage");
+
         const uint32_t colorTexture = reinterpret_cast<const XrSwapchainImageOpenGLKHR*>(swapchainImage)->image;
-        const GLint mip = 0;
-        const GLint x = 0;
-        const GLint z = arraySlice;
         const GLsizei w = swapchainData->Width();
         const GLsizei h = swapchainData->Height();
-        if (swapchainData->HasMultipleSlices()) {
-            XRC_CHECK_THROW_GLCMD(glBindTexture(GL_TEXTURE_2D_ARRAY, colorTexture));
-            for (GLint y = 0; y < h; ++y) {
-                const void* pixels = &image.pixels[(h - 1 - y) * w];
-                XRC_CHECK_THROW_GLCMD(glTexSubImage3D(GL_TEXTURE_2D_ARRAY, mip, x, y, z, w, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
-            }
+        const GLenum target = swapchainData->HasMultipleSlices() ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+        if (m_uploadWorker) {
+            m_uploadWorker->Upload(target, colorTexture, (GLint)arraySlice, w, h, image.pixels.data());
         }
         else {
-            XRC_CHECK_THROW_GLCMD(glBindTexture(GL_TEXTURE_2D, colorTexture));
-            for (GLint y = 0; y < h; ++y) {
-                const void* pixels = &image.pixels[(h - 1 - y) * w];
-                XRC_CHECK_THROW_GLCMD(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y, w, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
-            }
+            XRC_CHECK_THROW_GLCMD(glBindTexture(target, colorTexture));
+            m_imageUploader->Upload(target, (GLint)arraySlice, w, h, image.pixels.data());
         }
+
+        m_gpuTimers.EndInterval();
+    }
+
+    void OpenGLGraphicsPlugin::CopyRGBAImageRows(const XrSwapchainImageBaseHeader* swapchainImage, uint32_t arraySlice, uint32_t width,
+                                                 uint32_t height, const RGBARowWriter& writeRows)
+    {
+        XRC_TRACE_SCOPE("OpenGLGraphicsPlugin::CopyRGBAImageRows");
+        OpenGLSwapchainImageData* swapchainData;
+        uint32_t imageIndex;
+        std::tie(swapchainData, imageIndex) = m_swapchainImageDataMap.GetDataAndIndexFromBasePointer(swapchainImage);
+
+        m_gpuTimers.BeginInterval("CopyRGBAImage");
+
+        const uint32_t colorTexture = reinterpret_cast<const XrSwapchainImageOpenGLKHR*>(swapchainImage)->image;
+        const GLenum target = swapchainData->HasMultipleSlices() ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+        if (m_uploadWorker) {
+            m_uploadWorker->UploadRows(target, colorTexture, (GLint)arraySlice, (GLsizei)width, (GLsizei)height, writeRows);
+        }
+        else {
+            XRC_CHECK_THROW_GLCMD(glBindTexture(target, colorTexture));
+            m_imageUploader->UploadRows(target, (GLint)arraySlice, (GLsizei)width, (GLsizei)height, writeRows);
+        }
+
+        m_gpuTimers.EndInterval();
     }
 
     void OpenGLGraphicsPlugin::ClearImageSlice(const XrSwapchainImageBaseHeader* colorSwapchainImage, uint32_t imageArrayIndex,
@@ -1031,6 +1326,8 @@ namespace Conformance
         uint32_t imageIndex;
         std::tie(swapchainData, imageIndex) = m_swapchainImageDataMap.GetDataAndIndexFromBasePointer(colorSwapchainImage);
 
+        m_gpuTimers.BeginInterval("ClearImageSlice");
+
         XRC_CHECK_THROW_GLCMD(glBindFramebuffer(GL_FRAMEBUFFER, m_swapchainFramebuffer));
 
         const uint32_t colorTexture = reinterpret_cast<const XrSwapchainImageOpenGLKHR*>(colorSwapchainImage)->image;
@@ -1038,7 +1335,13 @@ namespace Conformance
 
         bool imageArray = swapchainData->HasMultipleSlices();
         GLenum texTarget = TexTarget(imageArray, swapchainData->IsMultisample());
-        if (imageArray) {
+        if (swapchainData->IsCube() && !imageArray) {
+            // One face of a cube map, with the 2D depth buffer shared by all faces.
+            const GLenum faceTarget = GL_TEXTURE_CUBE_MAP_POSITIVE_X + imageArrayIndex;
+            XRC_CHECK_THROW_GLCMD(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, faceTarget, colorTexture, 0));
+            XRC_CHECK_THROW_GLCMD(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, texTarget, depthTexture, 0));
+        }
+        else if (imageArray) {
             XRC_CHECK_THROW_GLCMD(glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, colorTexture, 0, imageArrayIndex));
             XRC_CHECK_THROW_GLCMD(glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthTexture, 0, imageArrayIndex));
         }
@@ -1060,23 +1363,52 @@ namespace Conformance
 
         // Clear swapchain and depth buffer.
         XRC_CHECK_THROW_GLCMD(glClearColor(color.r, color.g, color.b, color.a));
-        XRC_CHECK_THROW_GLCMD(glClearDepth(1.0f));
+        XRC_CHECK_THROW_GLCMD(glClearDepth(m_reversedDepth ? 0.0f : 1.0f));
         XRC_CHECK_THROW_GLCMD(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT));
 
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        m_gpuTimers.EndInterval();
     }
 
     MeshHandle OpenGLGraphicsPlugin::MakeSimpleMesh(span<const uint16_t> idx, span<const Geometry::Vertex> vtx)
     {
+        // A mesh with the same content shares the buffers created then.
+        MeshHandle cachedHandle = m_meshesByContent.Find(idx, vtx);
+        if (cachedHandle != MeshHandle{}) {
+            return cachedHandle;
+        }
+
         auto handle = m_meshes.emplace_back(m_vertexAttribCoords, m_vertexAttribColor, idx.data(), (uint32_t)idx.size(), vtx.data(),
                                             (uint32_t)vtx.size());
 
+        m_meshesByContent.Insert(idx, vtx, handle);
         return handle;
     }
 
     GLTFModelHandle OpenGLGraphicsPlugin::LoadGLTF(Gltf::ModelBuilder&& modelBuilder)
     {
-        auto handle = m_gltfModels.emplace_back(modelBuilder.Build(*m_pbrResources));
+        XRC_TRACE_SCOPE("OpenGLGraphicsPlugin::LoadGLTF");
+        // A scene already loaded on this device shares the model built then.
+        std::shared_ptr<const Gltf::DecodedScene> scene = modelBuilder.GetDecodedScene();
+        GLTFModelHandle cachedHandle = m_gltfModelsByScene.Find(scene);
+        if (cachedHandle != GLTFModelHandle{}) {
+            return cachedHandle;
+        }
+
+        std::shared_ptr<Pbr::Model> model;
+        try {
+            model = modelBuilder.Build(*m_pbrResources);
+        }
+        catch (...) {
+            // Uploads still queued read the model builder's data, which goes away with it.
+            if (m_uploadWorker) {
+                m_uploadWorker->Drain();
+            }
+            throw;
+        }
+        auto handle = m_gltfModels.emplace_back(std::move(model));
+        m_gltfModelsByScene.Insert(std::move(scene), handle);
         return handle;
     }
 
@@ -1100,11 +1432,19 @@ namespace Conformance
     void OpenGLGraphicsPlugin::RenderView(const XrCompositionLayerProjectionView& layerView,
                                           const XrSwapchainImageBaseHeader* colorSwapchainImage, const RenderParams& params)
     {
+        XRC_TRACE_SCOPE("OpenGLGraphicsPlugin::RenderView");
         OpenGLSwapchainImageData* swapchainData;
         uint32_t imageIndex;
         std::tie(swapchainData, imageIndex) = m_swapchainImageDataMap.GetDataAndIndexFromBasePointer(colorSwapchainImage);
 
-        XRC_CHECK_THROW_GLCMD(glBindFramebuffer(GL_FRAMEBUFFER, m_swapchainFramebuffer));
+        m_gpuTimers.BeginInterval("RenderView");
+
+        // Other calls into the plugin bind objects outside the cache, so only skip what this view already set.
+        GLStateCache& state = m_pbrResources->GetStateCache();
+        state.Invalidate();
+        state.TakeCounts();
+
+        state.BindFramebuffer(m_swapchainFramebuffer);
 
         GLint layer = layerView.subImage.imageArrayIndex;
 
@@ -1113,7 +1453,13 @@ namespace Conformance
 
         bool imageArray = swapchainData->HasMultipleSlices();
         GLenum texTarget = TexTarget(imageArray, swapchainData->IsMultisample());
-        if (imageArray) {
+        if (swapchainData->IsCube() && !imageArray) {
+            // One face of a cube map, with the 2D depth buffer shared by all faces.
+            const GLenum faceTarget = GL_TEXTURE_CUBE_MAP_POSITIVE_X + layer;
+            XRC_CHECK_THROW_GLCMD(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, faceTarget, colorTexture, 0));
+            XRC_CHECK_THROW_GLCMD(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, texTarget, depthTexture, 0));
+        }
+        else if (imageArray) {
             XRC_CHECK_THROW_GLCMD(glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, colorTexture, 0, layer));
             XRC_CHECK_THROW_GLCMD(glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthTexture, 0, layer));
         }
@@ -1131,71 +1477,231 @@ namespace Conformance
         XRC_CHECK_THROW_GLCMD(glViewport(x, y, w, h));
         XRC_CHECK_THROW_GLCMD(glScissor(x, y, w, h));
 
-        XRC_CHECK_THROW_GLCMD(glEnable(GL_SCISSOR_TEST));
-        XRC_CHECK_THROW_GLCMD(glEnable(GL_DEPTH_TEST));
-        XRC_CHECK_THROW_GLCMD(glEnable(GL_CULL_FACE));
+        state.SetEnabled(GL_SCISSOR_TEST, true);
+        state.SetEnabled(GL_DEPTH_TEST, true);
+        state.DepthFunc(m_reversedDepth ? GL_GREATER : GL_LESS);
+        state.SetEnabled(GL_CULL_FACE, true);
         XRC_CHECK_THROW_GLCMD(glFrontFace(GL_CW));
         XRC_CHECK_THROW_GLCMD(glCullFace(GL_BACK));
 
         // Set shaders and uniform variables.
-        XRC_CHECK_THROW_GLCMD(glUseProgram(m_program));
+        state.UseProgram(m_program);
 
         const auto& pose = layerView.pose;
         XrMatrix4x4f proj;
         XrMatrix4x4f_CreateProjectionFov(&proj, GRAPHICS_OPENGL, layerView.fov, 0.05f, 100.0f);
+        if (m_reversedDepth) {
+            // Negating clip space z swaps the near plane at -w with the far plane at w.
+            for (int column = 0; column < 4; ++column) {
+                proj.m[column * 4 + 2] = -proj.m[column * 4 + 2];
+            }
+        }
         XrMatrix4x4f toView = Matrix::FromPose(pose);
         XrMatrix4x4f view = Matrix::InvertRigidBody(toView);
         XrMatrix4x4f vp = proj * view;
-        MeshHandle lastMeshHandle;
 
-        const auto drawMesh = [this, &vp, &lastMeshHandle](const MeshDrawable mesh) {
-            OpenGLMesh& glMesh = m_meshes[mesh.handle];
-            if (mesh.handle != lastMeshHandle) {
-                // We are now rendering a new mesh
-                XRC_CHECK_THROW_GLCMD(glBindVertexArray(glMesh.m_vao));
-                XRC_CHECK_THROW_GLCMD(glBindBuffer(GL_ARRAY_BUFFER, glMesh.m_vertexBuffer));
-                XRC_CHECK_THROW_GLCMD(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, glMesh.m_indexBuffer));
+        // Compute the per-instance data for all cubes and meshes and upload it at once.
+        m_meshBatches.Build(params, m_cubeMesh);
+        m_instanceData.clear();
+        for (const MeshDrawable& mesh : m_meshBatches.Instances()) {
+            XrMatrix4x4f model =
+                Matrix::FromTranslationRotationScale(mesh.params.pose.position, mesh.params.pose.orientation, mesh.params.scale);
+            m_instanceData.push_back(OpenGLMeshInstance{vp * model, mesh.tintColor});
+        }
+        if (!m_instanceData.empty()) {
+            XRC_CHECK_THROW_GLCMD(glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer));
+            XRC_CHECK_THROW_GLCMD(glBufferData(GL_ARRAY_BUFFER, m_instanceData.size() * sizeof(OpenGLMeshInstance), m_instanceData.data(),
+                                               GL_STREAM_DRAW));
+        }
+
+        // Draw all instances of each mesh with a single call.
+        for (const MeshInstanceBatches::Batch& batch : m_meshBatches.Batches()) {
+            OpenGLMesh& glMesh = m_meshes[batch.handle];
+            state.BindVertexArray(glMesh.m_vao);
+            XRC_CHECK_THROW_GLCMD(glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer));
+
+            // Point the per-instance attributes at this batch's range of the instance buffer.
+            const size_t batchOffset = batch.firstInstance * sizeof(OpenGLMeshInstance);
+            for (GLint column = 0; column < 4; ++column) {
+                // A mat4 attribute takes four consecutive locations, one per column.
+                const GLuint location = GLuint(m_instanceAttribModelViewProjection + column);
+                const size_t columnOffset = batchOffset + offsetof(OpenGLMeshInstance, modelViewProjection) + column * 4 * sizeof(float);
+                XRC_CHECK_THROW_GLCMD(glEnableVertexAttribArray(location));
+                XRC_CHECK_THROW_GLCMD(glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(OpenGLMeshInstance),
+                                                            reinterpret_cast<const void*>(columnOffset)));
+                XRC_CHECK_THROW_GLCMD(glVertexAttribDivisor(location, 1));
+            }
+            XRC_CHECK_THROW_GLCMD(glEnableVertexAttribArray(m_instanceAttribTintColor));
+            const size_t tintColorOffset = batchOffset + offsetof(OpenGLMeshInstance, tintColor);
+            XRC_CHECK_THROW_GLCMD(glVertexAttribPointer(m_instanceAttribTintColor, 4, GL_FLOAT, GL_FALSE, sizeof(OpenGLMeshInstance),
+                                                        reinterpret_cast<const void*>(tintColorOffset)));
+            XRC_CHECK_THROW_GLCMD(glVertexAttribDivisor(m_instanceAttribTintColor, 1));
+
+            XRC_CHECK_THROW_GLCMD(glDrawElementsInstanced(GL_TRIANGLES, GLsizei(glMesh.m_numIndices), GL_UNSIGNED_SHORT, nullptr,
+                                                          GLsizei(batch.instanceCount)));
+        }
+
+        // Render the gltfs, with the primitives of all of them sorted to minimize state changes
+        if (!params.glTFs.empty()) {
+            m_pbrResources->SetViewProjection(view, proj);
+            m_pbrResources->Bind();
+
+            m_gltfDrawQueue.Clear();
+            for (uint32_t i = 0; i < (uint32_t)params.glTFs.size(); i++) {
+                const auto& gltfDrawable = params.glTFs[i];
+                GLGLTF& gltf = m_gltfInstances[gltfDrawable.handle];
+                // Compute and update the model transform.
 
-                lastMeshHandle = mesh.handle;
+                XrMatrix4x4f modelToWorld = Matrix::FromTranslationRotationScale(
+                    gltfDrawable.params.pose.position, gltfDrawable.params.pose.orientation, gltfDrawable.params.scale);
+
+                gltf.Prepare(*m_pbrResources, modelToWorld, vp, i, m_gltfDrawQueue);
             }
+            m_gltfDrawQueue.Sort();
 
-            // Compute the model-view-projection transform and set it..
-            XrMatrix4x4f model =
-                Matrix::FromTranslationRotationScale(mesh.params.pose.position, mesh.params.pose.orientation, mesh.params.scale);
-            XrMatrix4x4f mvp = vp * model;
-            glUniformMatrix4fv(m_modelViewProjectionUniformLocation, 1, GL_FALSE, reinterpret_cast<const GLfloat*>(&mvp));
-            glUniform4fv(m_tintColorUniformLocation, 1, reinterpret_cast<const GLfloat*>(&mesh.tintColor));
+            Pbr::DrawBindState bindState;
+            for (const Pbr::DrawItem& item : m_gltfDrawQueue.Items()) {
+                m_gltfInstances[params.glTFs[item.drawable].handle].Draw(*m_pbrResources, item, bindState);
+            }
+            bindState.stats.views++;
+            bindState.stats.culled += m_gltfDrawQueue.GetCulledCount();
+            m_gltfDrawStats += bindState.stats;
+        }
 
-            // Draw the mesh.
-            glDrawElements(GL_TRIANGLES, GLsizei(glMesh.m_numIndices), GL_UNSIGNED_SHORT, nullptr);
-        };
+        // Leave no vertex array bound, so that buffers bound while creating meshes do not change it.
+        state.BindVertexArray(0);
+        state.BindFramebuffer(0);
 
-        // Render each cube
-        for (const Cube& cube : params.cubes) {
-            drawMesh(MeshDrawable{m_cubeMesh, cube.params.pose, cube.params.scale, cube.tintColor});
+        if (!params.glTFs.empty()) {
+            const GLStateCache::Counts counts = state.TakeCounts();
+            m_gltfDrawStats.stateCalls += counts.calls;
+            m_gltfDrawStats.stateCallsSkipped += counts.skipped;
         }
 
-        // Render each mesh
-        for (const auto& mesh : params.meshes) {
-            drawMesh(mesh);
+        m_gpuTimers.EndInterval();
+    }
+
+    void OpenGLGraphicsPlugin::SetReversedDepth(bool reversed)
+    {
+        m_reversedDepth = reversed;
+        if (m_pbrResources) {
+            m_pbrResources->SetDepthDirection(reversed ? Pbr::DepthDirection::Reversed : Pbr::DepthDirection::Forward);
         }
+    }
 
-        // Render each gltf
-        for (const auto& gltfDrawable : params.glTFs) {
-            GLGLTF& gltf = m_gltfInstances[gltfDrawable.handle];
-            // Compute and update the model transform.
+    void OpenGLGraphicsPlugin::RenderMotionVectorView(const XrCompositionLayerProjectionView& layerView,
+                                                      const XrCompositionLayerProjectionView& previousLayerView,
+                                                      const XrSwapchainImageBaseHeader* motionVectorSwapchainImage,
+                                                      const XrSwapchainImageBaseHeader* depthSwapchainImage, const RenderParams& params,
+                                                      const RenderParams& previousParams)
+    {
+        XRC_TRACE_SCOPE("OpenGLGraphicsPlugin::RenderMotionVectorView");
+        m_meshBatches.Build(params, m_cubeMesh);
+        m_previousMeshBatches.Build(previousParams, m_cubeMesh);
+        if (m_meshBatches.Instances().size() != m_previousMeshBatches.Instances().size()) {
+            XRC_THROW("RenderMotionVectorView: the previous frame must draw the same cubes and meshes");
+        }
 
-            XrMatrix4x4f modelToWorld = Matrix::FromTranslationRotationScale(
-                gltfDrawable.params.pose.position, gltfDrawable.params.pose.orientation, gltfDrawable.params.scale);
+        m_gpuTimers.BeginInterval("RenderMotionVectorView");
 
-            m_pbrResources->SetViewProjection(view, proj);
+        GLStateCache& state = m_pbrResources->GetStateCache();
+        state.Invalidate();
+        state.BindFramebuffer(m_swapchainFramebuffer);
 
-            gltf.Render(*m_pbrResources, modelToWorld);
+        const GLuint motionVectorTexture = reinterpret_cast<const XrSwapchainImageOpenGLKHR*>(motionVectorSwapchainImage)->image;
+        const GLuint depthTexture = reinterpret_cast<const XrSwapchainImageOpenGLKHR*>(depthSwapchainImage)->image;
+        XRC_CHECK_THROW_GLCMD(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, motionVectorTexture, 0));
+        XRC_CHECK_THROW_GLCMD(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0));
+        CheckFramebuffer(m_swapchainFramebuffer);
+
+        GLint x = layerView.subImage.imageRect.offset.x;
+        GLint y = layerView.subImage.imageRect.offset.y;
+        GLsizei w = layerView.subImage.imageRect.extent.width;
+        GLsizei h = layerView.subImage.imageRect.extent.height;
+        XRC_CHECK_THROW_GLCMD(glViewport(x, y, w, h));
+        XRC_CHECK_THROW_GLCMD(glScissor(x, y, w, h));
+
+        state.SetEnabled(GL_SCISSOR_TEST, true);
+        state.SetEnabled(GL_DEPTH_TEST, true);
+        // Motion vector depth is always forward, whatever SetReversedDepth chose for RenderView.
+        state.DepthFunc(GL_LESS);
+        state.SetEnabled(GL_CULL_FACE, true);
+        XRC_CHECK_THROW_GLCMD(glFrontFace(GL_CW));
+        XRC_CHECK_THROW_GLCMD(glCullFace(GL_BACK));
+
+        // No motion where nothing is drawn.
+        XRC_CHECK_THROW_GLCMD(glClearColor(0.0f, 0.0f, 0.0f, 0.0f));
+        XRC_CHECK_THROW_GLCMD(glClearDepth(1.0f));
+        XRC_CHECK_THROW_GLCMD(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+
+        state.UseProgram(m_motionVectorProgram);
+
+        auto viewProjection = [](const XrCompositionLayerProjectionView& view) {
+            XrMatrix4x4f proj;
+            XrMatrix4x4f_CreateProjectionFov(&proj, GRAPHICS_OPENGL, view.fov, 0.05f, 100.0f);
+            return proj * Matrix::InvertRigidBody(Matrix::FromPose(view.pose));
+        };
+        const XrMatrix4x4f vp = viewProjection(layerView);
+        const XrMatrix4x4f previousVp = viewProjection(previousLayerView);
+
+        m_motionVectorInstanceData.clear();
+        for (size_t i = 0; i < m_meshBatches.Instances().size(); ++i) {
+            const MeshDrawable& mesh = m_meshBatches.Instances()[i];
+            const MeshDrawable& previousMesh = m_previousMeshBatches.Instances()[i];
+            XrMatrix4x4f model =
+                Matrix::FromTranslationRotationScale(mesh.params.pose.position, mesh.params.pose.orientation, mesh.params.scale);
+            XrMatrix4x4f previousModel = Matrix::FromTranslationRotationScale(
+                previousMesh.params.pose.position, previousMesh.params.pose.orientation, previousMesh.params.scale);
+            m_motionVectorInstanceData.push_back(OpenGLMotionVectorInstance{vp * model, previousVp * previousModel});
+        }
+        if (!m_motionVectorInstanceData.empty()) {
+            XRC_CHECK_THROW_GLCMD(glBindBuffer(GL_ARRAY_BUFFER, m_motionVectorInstanceBuffer));
+            XRC_CHECK_THROW_GLCMD(glBufferData(GL_ARRAY_BUFFER, m_motionVectorInstanceData.size() * sizeof(OpenGLMotionVectorInstance),
+                                               m_motionVectorInstanceData.data(), GL_STREAM_DRAW));
         }
 
-        glBindVertexArray(0);
-        glUseProgram(0);
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        for (const MeshInstanceBatches::Batch& batch : m_meshBatches.Batches()) {
+            OpenGLMesh& glMesh = m_meshes[batch.handle];
+            state.BindVertexArray(glMesh.m_vao);
+            XRC_CHECK_THROW_GLCMD(glBindBuffer(GL_ARRAY_BUFFER, m_motionVectorInstanceBuffer));
+
+            const size_t batchOffset = batch.firstInstance * sizeof(OpenGLMotionVectorInstance);
+            auto pointMatrixAttrib = [&](GLint firstLocation, size_t memberOffset) {
+                for (GLint column = 0; column < 4; ++column) {
+                    const GLuint location = GLuint(firstLocation + column);
+                    const size_t columnOffset = batchOffset + memberOffset + column * 4 * sizeof(float);
+                    XRC_CHECK_THROW_GLCMD(glEnableVertexAttribArray(location));
+                    XRC_CHECK_THROW_GLCMD(glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(OpenGLMotionVectorInstance),
+                                                                reinterpret_cast<const void*>(columnOffset)));
+                    XRC_CHECK_THROW_GLCMD(glVertexAttribDivisor(location, 1));
+                }
+            };
+            pointMatrixAttrib(m_instanceAttribModelViewProjection, offsetof(OpenGLMotionVectorInstance, modelViewProjection));
+            pointMatrixAttrib(m_motionVectorAttribPreviousModelViewProjection,
+                              offsetof(OpenGLMotionVectorInstance, previousModelViewProjection));
+
+            XRC_CHECK_THROW_GLCMD(glDrawElementsInstanced(GL_TRIANGLES, GLsizei(glMesh.m_numIndices), GL_UNSIGNED_SHORT, nullptr,
+                                                          GLsizei(batch.instanceCount)));
+
+            // The mesh program does not read the previous transform: leave nothing pointing at this buffer in the mesh's
+            // vertex array object.
+            for (GLint column = 0; column < 4; ++column) {
+                XRC_CHECK_THROW_GLCMD(glDisableVertexAttribArray(GLuint(m_motionVectorAttribPreviousModelViewProjection + column)));
+            }
+        }
+
+        state.BindVertexArray(0);
+        state.BindFramebuffer(0);
+
+        m_gpuTimers.EndInterval();
+    }
+
+    void OpenGLGraphicsPlugin::CollectGpuTimerSamples(std::vector<GpuTimerSample>& samples)
+    {
+        if (deviceInitialized) {
+            m_gpuTimers.ResolveIntervals(false);
+        }
+        m_gpuTimers.Scopes().TakeSamples(samples);
     }
 
     std::shared_ptr<IGraphicsPlugin> CreateGraphicsPlugin_OpenGL(std::shared_ptr<IPlatformPlugin> platformPlugin)
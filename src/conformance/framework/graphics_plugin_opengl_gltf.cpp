@@ -7,16 +7,36 @@
 #include "graphics_plugin_opengl_gltf.h"
 
 #include "pbr/OpenGL/GLModel.h"
+#include "pbr/OpenGL/GLPrimitive.h"
 #include "pbr/OpenGL/GLResources.h"
+#include "utilities/opengl_utils.h"
 
 namespace Conformance
 {
     void GLGLTF::Render(Pbr::GLResources& resources, XrMatrix4x4f& modelToWorld)
     {
         resources.SetFillMode(GetFillMode());
+        resources.GetStateCache().Invalidate();
         resources.Bind();
         GetModelInstance().Render(resources, modelToWorld);
     }
 
+    void GLGLTF::Prepare(Pbr::GLResources& resources, XrMatrix4x4f& modelToWorld, const XrMatrix4x4f& viewProjection, uint32_t drawable,
+                         Pbr::DrawQueue& queue)
+    {
+        GetModelInstance().Prepare(resources, modelToWorld);
+
+        XrMatrix4x4f modelToClip;
+        XrMatrix4x4f_Multiply(&modelToClip, &viewProjection, &modelToWorld);
+        const Pbr::Frustum frustum(modelToClip);
+        GetModelInstance().AppendDraws(resources, GetFillMode(), drawable, queue, &frustum);
+    }
+
+    void GLGLTF::Draw(Pbr::GLResources& resources, const Pbr::DrawItem& item, Pbr::DrawBindState& bindState)
+    {
+        resources.SetFillMode(item.fillMode);
+        GetModelInstance().DrawPrimitive(resources, item, bindState);
+    }
+
 }  // namespace Conformance
 #endif
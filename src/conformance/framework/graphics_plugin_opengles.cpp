@@ -20,7 +20,9 @@
 #include "graphics_plugin.h"
 #include "graphics_plugin_impl_helpers.h"
 #include "graphics_plugin_opengl_gltf.h"
+#include "mesh_instance_batches.h"
 #include "report.h"
+#include "startup_timing.h"
 #include "swapchain_image_data.h"
 
 #include "common/gfxwrapper_opengl.h"
@@ -30,9 +32,11 @@
 #include "pbr/OpenGL/GLResources.h"
 #include "pbr/OpenGL/GLTexture.h"
 #include "utilities/Geometry.h"
+#include "utilities/opengl_utils.h"
 #include "utilities/swapchain_format_data.h"
 #include "utilities/swapchain_parameters.h"
 #include "utilities/throw_helpers.h"
+#include "utilities/trace.h"
 
 #include <catch2/catch_test_macros.hpp>
 #include <openxr/openxr.h>
@@ -43,6 +47,7 @@
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <stddef.h>
 #include <stdexcept>
 #include <string>
 #include <tuple>
@@ -72,14 +77,14 @@ namespace Conformance
     in vec3 VertexPos;
     in vec3 VertexColor;
 
-    out vec3 PSVertexColor;
+    in mat4 InstanceModelViewProjection;
+    in vec4 InstanceTintColor;
 
-    uniform mat4 ModelViewProjection;
-    uniform vec4 tintColor;
+    out vec3 PSVertexColor;
 
     void main() {
-       gl_Position = ModelViewProjection * vec4(VertexPos, 1.0);
-       PSVertexColor = mix(VertexColor, tintColor.rgb, tintColor.a);
+       gl_Position = InstanceModelViewProjection * vec4(VertexPos, 1.0);
+       PSVertexColor = mix(VertexColor, InstanceTintColor.rgb, InstanceTintColor.a);
     }
     )_";
 
@@ -94,6 +99,13 @@ namespace Conformance
     }
     )_";
 
+    /// Per-instance vertex attributes for drawing meshes, matching the vertex shader inputs.
+    struct OpenGLESMeshInstance
+    {
+        XrMatrix4x4f modelViewProjection;
+        XrColor4f tintColor;
+    };
+
     struct OpenGLESMesh
     {
         bool valid{false};
@@ -262,6 +274,11 @@ namespace Conformance
         bool InitializeDevice(XrInstance instance, XrSystemId systemId, bool checkGraphicsRequirements,
                               uint32_t deviceCreationFlags) override;
 
+        void PrepareDevice() override
+        {
+            m_brdfLutFileData.Start();
+        }
+
         void Flush() override;
 
         void ClearSwapchainCache() override;
@@ -271,6 +288,8 @@ namespace Conformance
         const XrBaseInStructure* GetGraphicsBinding() const override;
 
         void CopyRGBAImage(const XrSwapchainImageBaseHeader* swapchainImage, uint32_t arraySlice, const RGBAImage& image) override;
+        void CopyRGBAImageRows(const XrSwapchainImageBaseHeader* swapchainImage, uint32_t arraySlice, uint32_t width, uint32_t height,
+                               const RGBARowWriter& writeRows) override;
 
         std::string GetImageFormatName(int64_t imageFormat) const override;
 
@@ -302,6 +321,14 @@ namespace Conformance
         MeshHandle MakeSimpleMesh(span<const uint16_t> idx, span<const Geometry::Vertex> vtx) override;
 
         GLTFModelHandle LoadGLTF(Gltf::ModelBuilder&& modelBuilder) override;
+        std::vector<Conformance::Image::FormatParams> GetSupportedTextureFormats() const override
+        {
+            if (!m_pbrResources) {
+                return {};
+            }
+            const auto formats = m_pbrResources->GetSupportedFormats();
+            return {formats.begin(), formats.end()};
+        }
         std::shared_ptr<Pbr::Model> GetPbrModel(GLTFModelHandle handle) const override;
         GLTFModelInstanceHandle CreateGLTFModelInstance(GLTFModelHandle handle) override;
         Pbr::ModelInstance& GetModelInstance(GLTFModelInstanceHandle handle) override;
@@ -309,6 +336,11 @@ namespace Conformance
         void RenderView(const XrCompositionLayerProjectionView& layerView, const XrSwapchainImageBaseHeader* colorSwapchainImage,
                         const RenderParams& params) override;
 
+        Pbr::DrawStats TakeGltfDrawStats() override
+        {
+            return std::exchange(m_gltfDrawStats, {});
+        }
+
     private:
         bool initialized{false};
 
@@ -324,16 +356,26 @@ namespace Conformance
 
         GLuint m_swapchainFramebuffer{0};
         GLuint m_program{0};
-        GLint m_modelViewProjectionUniformLocation{0};
-        GLint m_tintColorUniformLocation{0};
         GLint m_vertexAttribCoords{0};
         GLint m_vertexAttribColor{0};
+        GLint m_instanceAttribModelViewProjection{0};
+        GLint m_instanceAttribTintColor{0};
+        GLStreamingBuffer m_instanceBuffer{GL_ARRAY_BUFFER};
+        MeshInstanceBatches m_meshBatches;
+        std::vector<OpenGLESMeshInstance> m_instanceData;
         MeshHandle m_cubeMesh{};
         VectorWithGenerationCountedHandles<OpenGLESMesh, MeshHandle> m_meshes;
+        MeshHandleCache<uint16_t, Geometry::Vertex, MeshHandle> m_meshesByContent;
         // This is fine to be a shared_ptr because Model doesn't directly hold any graphics state.
         VectorWithGenerationCountedHandles<std::shared_ptr<Pbr::Model>, GLTFModelHandle> m_gltfModels;
+        SceneHandleCache<Gltf::DecodedScene, GLTFModelHandle> m_gltfModelsByScene;
         VectorWithGenerationCountedHandles<GLGLTF, GLTFModelInstanceHandle> m_gltfInstances;
         std::unique_ptr<Pbr::GLResources> m_pbrResources;
+        /// Read ahead by PrepareDevice, see DeviceIndependentLoad.
+        DeviceIndependentLoad<std::vector<uint8_t>> m_brdfLutFileData{[] { return ReadFileBytes("brdf_lut.png"); }};
+        Pbr::DrawQueue m_gltfDrawQueue;
+        Pbr::DrawStats m_gltfDrawStats;
+        GLImageUploader m_imageUploader;
 
         SwapchainImageDataMap<OpenGLESSwapchainImageData> m_swapchainImageDataMap;
     };
@@ -391,6 +433,7 @@ namespace Conformance
     void OpenGLESGraphicsPlugin::CopyRGBAImage(const XrSwapchainImageBaseHeader* swapchainImage, uint32_t arraySlice,
                                                const RGBAImage& image)
     {
+        XRC_TRACE_SCOPE("OpenGLESGraphicsPlugin::CopyRGBAImage");
         OpenGLESSwapchainImageData* swapchainData;
         uint32_t imageIndex;
 
@@ -408,18 +451,24 @@ namespace Conformance
 
         const uint32_t img = swapchainData->GetTypedImage(imageIndex).image;
         GL(glBindTexture(target, img));
-        if (isArray) {
-            for (GLuint y = 0; y < height; ++y) {
-                const void* pixels = &image.pixels[(height - 1 - y) * width];
-                GL(glTexSubImage3D(target, 0, 0, y, arraySlice, width, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
-            }
-        }
-        else {
-            for (GLuint y = 0; y < height; ++y) {
-                const void* pixels = &image.pixels[(height - 1 - y) * width];
-                GL(glTexSubImage2D(target, 0, 0, y, width, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
-            }
-        }
+        m_imageUploader.Upload(target, (GLint)arraySlice, (GLsizei)width, (GLsizei)height, image.pixels.data());
+        GL(glBindTexture(target, 0));
+    }
+
+    void OpenGLESGraphicsPlugin::CopyRGBAImageRows(const XrSwapchainImageBaseHeader* swapchainImage, uint32_t arraySlice, uint32_t width,
+                                                   uint32_t height, const RGBARowWriter& writeRows)
+    {
+        XRC_TRACE_SCOPE("OpenGLESGraphicsPlugin::CopyRGBAImageRows");
+        OpenGLESSwapchainImageData* swapchainData;
+        uint32_t imageIndex;
+
+        std::tie(swapchainData, imageIndex) = m_swapchainImageDataMap.GetDataAndIndexFromBasePointer(swapchainImage);
+
+        const GLenum target = swapchainData->HasMultipleSlices() ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+
+        const uint32_t img = swapchainData->GetTypedImage(imageIndex).image;
+        GL(glBindTexture(target, img));
+        m_imageUploader.UploadRows(target, (GLint)arraySlice, (GLsizei)width, (GLsizei)height, writeRows);
         GL(glBindTexture(target, 0));
     }
 
@@ -440,7 +489,11 @@ namespace Conformance
             auto xrGetOpenGLESGraphicsRequirementsKHR =
                 GetInstanceExtensionFunction<PFN_xrGetOpenGLESGraphicsRequirementsKHR>(instance, "xrGetOpenGLESGraphicsRequirementsKHR");
 
-            XrResult result = xrGetOpenGLESGraphicsRequirementsKHR(instance, systemId, &graphicsRequirements);
+            XrResult result;
+            {
+                ScopedStartupPhase timing(StartupPhase::GraphicsRequirements);
+                result = xrGetOpenGLESGraphicsRequirementsKHR(instance, systemId, &graphicsRequirements);
+            }
             XRC_CHECK_THROW(ValidateResultAllowed("xrGetOpenGLESGraphicsRequirementsKHR", result));
             if (XR_FAILED(result)) {
                 // Log result?
@@ -515,71 +568,30 @@ namespace Conformance
         ShutdownResources();
     }
 
-    static void CheckShader(GLuint shader)
-    {
-        GLint r = 0;
-        GL(glGetShaderiv(shader, GL_COMPILE_STATUS, &r));
-        if (r == GL_FALSE) {
-            GLchar msg[4096] = {};
-            GLsizei length;
-            GL(glGetShaderInfoLog(shader, sizeof(msg), &length, msg));
-
-            throw std::runtime_error((std::string("Compile shader failed: ") + msg).c_str());
-        }
-    }
-
-    static void CheckProgram(GLuint prog)
-    {
-        GLint r = 0;
-        GL(glGetProgramiv(prog, GL_LINK_STATUS, &r));
-        if (r == GL_FALSE) {
-            GLchar msg[4096] = {};
-            GLsizei length;
-            GL(glGetProgramInfoLog(prog, sizeof(msg), &length, msg));
-            throw std::runtime_error((std::string("Link program failed: ") + msg).c_str());
-        }
-    }
-
     void OpenGLESGraphicsPlugin::InitializeResources()
     {
         //ReportF("OpenGLESGraphicsPlugin::InitializeResources");
         GL(glGenFramebuffers(1, &m_swapchainFramebuffer));
 
-        GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-        GL(glShaderSource(vertexShader, 1, &VertexShaderGlsl, nullptr));
-        GL(glCompileShader(vertexShader));
-        CheckShader(vertexShader);
-
-        GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-        GL(glShaderSource(fragmentShader, 1, &FragmentShaderGlsl, nullptr));
-        GL(glCompileShader(fragmentShader));
-        CheckShader(fragmentShader);
-
-        m_program = glCreateProgram();
-        GL(glAttachShader(m_program, vertexShader));
-        GL(glAttachShader(m_program, fragmentShader));
-        GL(glLinkProgram(m_program));
-        CheckProgram(m_program);
-
-        GL(glDeleteShader(vertexShader));
-        GL(glDeleteShader(fragmentShader));
-
-        m_modelViewProjectionUniformLocation = glGetUniformLocation(m_program, "ModelViewProjection");
-        m_tintColorUniformLocation = glGetUniformLocation(m_program, "tintColor");
+        SetGLProgramCacheDirectory(GetGlobalData().options.pipelineCacheDirectory);
+        m_program = LinkGLProgram(VertexShaderGlsl, FragmentShaderGlsl);
 
         m_vertexAttribCoords = glGetAttribLocation(m_program, "VertexPos");
         m_vertexAttribColor = glGetAttribLocation(m_program, "VertexColor");
+        m_instanceAttribModelViewProjection = glGetAttribLocation(m_program, "InstanceModelViewProjection");
+        m_instanceAttribTintColor = glGetAttribLocation(m_program, "InstanceTintColor");
 
         m_cubeMesh = MakeCubeMesh();
 
-        m_pbrResources = std::make_unique<Pbr::GLResources>();
+        m_pbrResources = std::make_unique<Pbr::GLResources>(GetGlobalData().options.compactPbrVertices);
         m_pbrResources->SetLight({0.0f, 0.7071067811865475f, 0.7071067811865475f}, Pbr::RGB::White);
+        m_pbrResources->SetTextureCacheBudget(uint64_t{GetGlobalData().options.pbrTextureCacheBudget} << 20);
 
         auto blackCubeMap = std::make_shared<Pbr::ScopedGLTexture>(Pbr::GLTexture::CreateFlatCubeTexture(Pbr::RGBA::Black, false));
         m_pbrResources->SetEnvironmentMap(blackCubeMap, blackCubeMap);
 
-        // Read the BRDF Lookup Table used by the PBR system into a GL texture.
-        std::vector<unsigned char> brdfLutFileData = ReadFileBytes("brdf_lut.png");
+        // Load the BRDF Lookup Table used by the PBR system into a GL texture.
+        const std::vector<uint8_t>& brdfLutFileData = m_brdfLutFileData.Get();
         auto brdLutResourceView = std::make_shared<Pbr::ScopedGLTexture>(
             Pbr::GLTexture::LoadTextureImage(*m_pbrResources, false, brdfLutFileData.data(), (uint32_t)brdfLutFileData.size()));
         m_pbrResources->SetBrdfLut(brdLutResourceView);
@@ -596,11 +608,15 @@ namespace Conformance
             }
 
             m_swapchainImageDataMap.Reset();
+            m_instanceBuffer.Reset();
+            m_imageUploader.Reset();
 
             m_cubeMesh = {};
             m_meshes.clear();
+            m_meshesByContent.clear();
             m_gltfInstances.clear();
             m_gltfModels.clear();
+            m_gltfModelsByScene.clear();
             m_pbrResources.reset();
 
             ksGpuWindow_Destroy(&window);
@@ -1217,7 +1233,13 @@ namespace Conformance
 
         const uint32_t colorTexture = swapchainData->GetTypedImage(imageIndex).image;
         const uint32_t depthTexture = swapchainData->GetDepthImageForColorIndex(imageIndex).image;
-        if (isArray) {
+        if (swapchainData->IsCube() && !isArray) {
+            // One face of a cube map, with the 2D depth buffer shared by all faces.
+            const GLenum faceTarget = GL_TEXTURE_CUBE_MAP_POSITIVE_X + imageArrayIndex;
+            GL(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, faceTarget, colorTexture, 0));
+            GL(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, target, depthTexture, 0));
+        }
+        else if (isArray) {
             GL(glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, colorTexture, 0, imageArrayIndex));
             GL(glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthTexture, 0, imageArrayIndex));
         }
@@ -1245,15 +1267,31 @@ namespace Conformance
 
     MeshHandle OpenGLESGraphicsPlugin::MakeSimpleMesh(span<const uint16_t> idx, span<const Geometry::Vertex> vtx)
     {
+        // A mesh with the same content shares the buffers created then.
+        MeshHandle cachedHandle = m_meshesByContent.Find(idx, vtx);
+        if (cachedHandle != MeshHandle{}) {
+            return cachedHandle;
+        }
+
         auto handle = m_meshes.emplace_back(m_vertexAttribCoords, m_vertexAttribColor, idx.data(), (uint32_t)idx.size(), vtx.data(),
                                             (uint32_t)vtx.size());
 
+        m_meshesByContent.Insert(idx, vtx, handle);
         return handle;
     }
 
     GLTFModelHandle OpenGLESGraphicsPlugin::LoadGLTF(Gltf::ModelBuilder&& modelBuilder)
     {
+        XRC_TRACE_SCOPE("OpenGLESGraphicsPlugin::LoadGLTF");
+        // A scene already loaded on this device shares the model built then.
+        std::shared_ptr<const Gltf::DecodedScene> scene = modelBuilder.GetDecodedScene();
+        GLTFModelHandle cachedHandle = m_gltfModelsByScene.Find(scene);
+        if (cachedHandle != GLTFModelHandle{}) {
+            return cachedHandle;
+        }
+
         auto handle = m_gltfModels.emplace_back(modelBuilder.Build(*m_pbrResources));
+        m_gltfModelsByScene.Insert(std::move(scene), handle);
         return handle;
     }
 
@@ -1277,6 +1315,7 @@ namespace Conformance
     void OpenGLESGraphicsPlugin::RenderView(const XrCompositionLayerProjectionView& layerView,
                                             const XrSwapchainImageBaseHeader* colorSwapchainImage, const RenderParams& params)
     {
+        XRC_TRACE_SCOPE("OpenGLESGraphicsPlugin::RenderView");
         OpenGLESSwapchainImageData* swapchainData;
         uint32_t imageIndex;
 
@@ -1286,7 +1325,12 @@ namespace Conformance
         bool isArray = arraySize > 1;
         GLenum target = isArray ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
 
-        GL(glBindFramebuffer(GL_FRAMEBUFFER, m_swapchainFramebuffer));
+        // Other calls into the plugin bind objects outside the cache, so only skip what this view already set.
+        GLStateCache& state = m_pbrResources->GetStateCache();
+        state.Invalidate();
+        state.TakeCounts();
+
+        state.BindFramebuffer(m_swapchainFramebuffer);
 
         const uint32_t colorTexture = swapchainData->GetTypedImage(imageIndex).image;
         const uint32_t depthTexture = swapchainData->GetDepthImageForColorIndex(imageIndex).image;
@@ -1299,13 +1343,19 @@ namespace Conformance
         GL(glViewport(x, y, w, h));
         GL(glScissor(x, y, w, h));
 
-        GL(glEnable(GL_SCISSOR_TEST));
-        GL(glEnable(GL_DEPTH_TEST));
-        GL(glEnable(GL_CULL_FACE));
+        state.SetEnabled(GL_SCISSOR_TEST, true);
+        state.SetEnabled(GL_DEPTH_TEST, true);
+        state.SetEnabled(GL_CULL_FACE, true);
         GL(glFrontFace(GL_CW));
         GL(glCullFace(GL_BACK));
 
-        if (isArray) {
+        if (swapchainData->IsCube() && !isArray) {
+            // One face of a cube map, with the 2D depth buffer shared by all faces.
+            const GLenum faceTarget = GL_TEXTURE_CUBE_MAP_POSITIVE_X + layerView.subImage.imageArrayIndex;
+            GL(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, faceTarget, colorTexture, 0));
+            GL(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, target, depthTexture, 0));
+        }
+        else if (isArray) {
             GL(glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, colorTexture, 0, layerView.subImage.imageArrayIndex));
             GL(glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthTexture, 0, layerView.subImage.imageArrayIndex));
         }
@@ -1315,7 +1365,7 @@ namespace Conformance
         }
 
         // Set shaders and uniform variables.
-        GL(glUseProgram(m_program));
+        state.UseProgram(m_program);
 
         const auto& pose = layerView.pose;
         XrMatrix4x4f proj;
@@ -1324,57 +1374,83 @@ namespace Conformance
         XrMatrix4x4f view = Matrix::InvertRigidBody(toView);
         XrMatrix4x4f vp = proj * view;
 
-        MeshHandle lastMeshHandle;
-
-        const auto drawMesh = [this, &vp, &lastMeshHandle](const MeshDrawable mesh) {
-            OpenGLESMesh& glMesh = m_meshes[mesh.handle];
-            if (mesh.handle != lastMeshHandle) {
-                // We are now rendering a new mesh
-                GL(glBindVertexArray(glMesh.m_vao));
-                glBindBuffer(GL_ARRAY_BUFFER, glMesh.m_vertexBuffer);
-                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, glMesh.m_indexBuffer);
-
-                lastMeshHandle = mesh.handle;
-            }
-
-            // Compute the model-view-projection transform and set it..
+        // Compute the per-instance data for all cubes and meshes and upload it at once.
+        m_meshBatches.Build(params, m_cubeMesh);
+        m_instanceData.clear();
+        for (const MeshDrawable& mesh : m_meshBatches.Instances()) {
             XrMatrix4x4f model =
                 Matrix::FromTranslationRotationScale(mesh.params.pose.position, mesh.params.pose.orientation, mesh.params.scale);
-            XrMatrix4x4f mvp = vp * model;
-            GL(glUniformMatrix4fv(m_modelViewProjectionUniformLocation, 1, GL_FALSE, reinterpret_cast<const GLfloat*>(&mvp)));
-            GL(glUniform4fv(m_tintColorUniformLocation, 1, reinterpret_cast<const GLfloat*>(&mesh.tintColor)));
+            m_instanceData.push_back(OpenGLESMeshInstance{vp * model, mesh.tintColor});
+        }
+        size_t instanceDataOffset = 0;
+        if (!m_instanceData.empty()) {
+            instanceDataOffset = m_instanceBuffer.Write(m_instanceData.data(), m_instanceData.size() * sizeof(OpenGLESMeshInstance),
+                                                        sizeof(float));
+        }
 
-            // Draw the mesh.
-            GL(glDrawElements(GL_TRIANGLES, glMesh.m_numIndices, GL_UNSIGNED_SHORT, nullptr));
-        };
+        // Draw all instances of each mesh with a single call.
+        for (const MeshInstanceBatches::Batch& batch : m_meshBatches.Batches()) {
+            OpenGLESMesh& glMesh = m_meshes[batch.handle];
+            state.BindVertexArray(glMesh.m_vao);
+            GL(glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer.GetBuffer()));
+
+            // Point the per-instance attributes at this batch's range of this view's instance data.
+            const size_t batchOffset = instanceDataOffset + batch.firstInstance * sizeof(OpenGLESMeshInstance);
+            for (GLint column = 0; column < 4; ++column) {
+                // A mat4 attribute takes four consecutive locations, one per column.
+                const GLuint location = GLuint(m_instanceAttribModelViewProjection + column);
+                const size_t columnOffset = batchOffset + offsetof(OpenGLESMeshInstance, modelViewProjection) + column * 4 * sizeof(float);
+                GL(glEnableVertexAttribArray(location));
+                GL(glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(OpenGLESMeshInstance),
+                                         reinterpret_cast<const void*>(columnOffset)));
+                GL(glVertexAttribDivisor(location, 1));
+            }
+            const size_t tintColorOffset = batchOffset + offsetof(OpenGLESMeshInstance, tintColor);
+            GL(glEnableVertexAttribArray(m_instanceAttribTintColor));
+            GL(glVertexAttribPointer(m_instanceAttribTintColor, 4, GL_FLOAT, GL_FALSE, sizeof(OpenGLESMeshInstance),
+                                     reinterpret_cast<const void*>(tintColorOffset)));
+            GL(glVertexAttribDivisor(m_instanceAttribTintColor, 1));
 
-        // Render each cube
-        for (const Cube& cube : params.cubes) {
-            drawMesh(MeshDrawable{m_cubeMesh, cube.params.pose, cube.params.scale, cube.tintColor});
+            GL(glDrawElementsInstanced(GL_TRIANGLES, glMesh.m_numIndices, GL_UNSIGNED_SHORT, nullptr, GLsizei(batch.instanceCount)));
         }
 
-        // Render each mesh
-        for (const auto& mesh : params.meshes) {
-            drawMesh(mesh);
-        }
+        // Render the gltfs, with the primitives of all of them sorted to minimize state changes
+        if (!params.glTFs.empty()) {
+            m_pbrResources->SetViewProjection(view, proj);
+            m_pbrResources->Bind();
 
-        // Render each gltf
-        for (const auto& gltfDrawable : params.glTFs) {
-            GLGLTF& gltf = m_gltfInstances[gltfDrawable.handle];
-            // Compute and update the model transform.
+            m_gltfDrawQueue.Clear();
+            for (uint32_t i = 0; i < (uint32_t)params.glTFs.size(); i++) {
+                const auto& gltfDrawable = params.glTFs[i];
+                GLGLTF& gltf = m_gltfInstances[gltfDrawable.handle];
+                // Compute and update the model transform.
 
-            XrMatrix4x4f modelToWorld = Matrix::FromTranslationRotationScale(
-                gltfDrawable.params.pose.position, gltfDrawable.params.pose.orientation, gltfDrawable.params.scale);
+                XrMatrix4x4f modelToWorld = Matrix::FromTranslationRotationScale(
+                    gltfDrawable.params.pose.position, gltfDrawable.params.pose.orientation, gltfDrawable.params.scale);
 
-            m_pbrResources->SetViewProjection(view, proj);
+                gltf.Prepare(*m_pbrResources, modelToWorld, vp, i, m_gltfDrawQueue);
+            }
+            m_gltfDrawQueue.Sort();
 
-            gltf.Render(*m_pbrResources, modelToWorld);
+            Pbr::DrawBindState bindState;
+            for (const Pbr::DrawItem& item : m_gltfDrawQueue.Items()) {
+                m_gltfInstances[params.glTFs[item.drawable].handle].Draw(*m_pbrResources, item, bindState);
+            }
+            bindState.stats.views++;
+            bindState.stats.culled += m_gltfDrawQueue.GetCulledCount();
+            m_gltfDrawStats += bindState.stats;
         }
 
-        GL(glBindVertexArray(0));
-        GL(glUseProgram(0));
-        GL(glDisable(GL_SCISSOR_TEST));
-        GL(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+        // Leave no vertex array bound, so that buffers bound while creating meshes do not change it.
+        state.BindVertexArray(0);
+        state.SetEnabled(GL_SCISSOR_TEST, false);
+        state.BindFramebuffer(0);
+
+        if (!params.glTFs.empty()) {
+            const GLStateCache::Counts counts = state.TakeCounts();
+            m_gltfDrawStats.stateCalls += counts.calls;
+            m_gltfDrawStats.stateCallsSkipped += counts.skipped;
+        }
     }
 
 }  // namespace Conformance
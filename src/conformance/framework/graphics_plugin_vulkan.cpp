@@ -21,7 +21,9 @@
 #include "graphics_plugin.h"
 #include "graphics_plugin_impl_helpers.h"
 #include "graphics_plugin_vulkan_gltf.h"
+#include "mesh_instance_batches.h"
 #include "report.h"
+#include "startup_timing.h"
 #include "swapchain_image_data.h"
 
 #include "common/hex_and_handles.h"
@@ -34,9 +36,11 @@
 #include "pbr/Vulkan/VkTexture.h"
 #include "pbr/Vulkan/VkModel.h"
 #include "utilities/Geometry.h"
+#include "utilities/destruction_queue.h"
 #include "utilities/swapchain_format_data.h"
 #include "utilities/swapchain_parameters.h"
 #include "utilities/throw_helpers.h"
+#include "utilities/trace.h"
 #include "utilities/utils.h"
 #include "utilities/vulkan_utils.h"
 
@@ -53,6 +57,8 @@
 #include <array>
 #include <assert.h>
 #include <cstdint>
+#include <deque>
+#include <future>
 #include <iterator>
 #include <map>
 #include <memory>
@@ -83,15 +89,13 @@ namespace Conformance
     #version 430
     #extension GL_ARB_separate_shader_objects : enable
 
-    layout (std140, push_constant) uniform buf
-    {
-        mat4 mvp;
-        vec4 tintColor;
-    } ubuf;
-
     layout (location = 0) in vec3 Position;
     layout (location = 1) in vec3 Color;
 
+    // Per instance
+    layout (location = 2) in mat4 InstanceMvp;
+    layout (location = 6) in vec4 InstanceTintColor;
+
     layout (location = 0) out vec4 oColor;
     out gl_PerVertex
     {
@@ -100,9 +104,9 @@ namespace Conformance
 
     void main()
     {
-        oColor.rgb = mix(Color.rgb, ubuf.tintColor.rgb, ubuf.tintColor.a);
+        oColor.rgb = mix(Color.rgb, InstanceTintColor.rgb, InstanceTintColor.a);
         oColor.a  = 1.0;
-        gl_Position = ubuf.mvp * vec4(Position, 1);
+        gl_Position = InstanceMvp * vec4(Position, 1);
     }
 )_";
 
@@ -132,12 +136,13 @@ namespace Conformance
 
         void init(const VulkanDebugObjectNamer& namer, VkDevice device, uint32_t capacity, const VkExtent2D size, VkFormat colorFormat,
                   VkFormat depthFormat, VkSampleCountFlagBits sampleCount, const PipelineLayout& layout, const ShaderProgram& sp,
-                  const VkVertexInputBindingDescription& bindDesc, span<const VkVertexInputAttributeDescription> attrDesc)
+                  span<const VkVertexInputBindingDescription> bindDesc, span<const VkVertexInputAttributeDescription> attrDesc,
+                  VkPipelineCache pipelineCache)
         {
             m_renderTarget.resize(capacity);
             m_rp.Create(namer, device, colorFormat, depthFormat, sampleCount);
             VkDynamicState dynamicStates[] = {VK_DYNAMIC_STATE_SCISSOR, VK_DYNAMIC_STATE_VIEWPORT};
-            m_pipe.Create(device, size, layout, m_rp, sp, bindDesc, attrDesc, dynamicStates);
+            m_pipe.Create(device, size, layout, m_rp, sp, bindDesc, attrDesc, dynamicStates, pipelineCache);
         }
 
         void Reset()
@@ -152,34 +157,37 @@ namespace Conformance
     class VulkanSwapchainImageData : public SwapchainImageDataBase<XrSwapchainImageVulkanKHR>
     {
         void init(uint32_t capacity, VkFormat colorFormat, const PipelineLayout& layout, const ShaderProgram& sp,
-                  const VkVertexInputBindingDescription& bindDesc, span<const VkVertexInputAttributeDescription> attrDesc)
+                  span<const VkVertexInputBindingDescription> bindDesc, span<const VkVertexInputAttributeDescription> attrDesc,
+                  VkPipelineCache pipelineCache)
         {
             m_depthBuffer.resize(capacity);
             for (auto& slice : m_slices) {
                 slice.init(m_namer, m_vkDevice, capacity, m_size, colorFormat, m_depthFormat, m_sampleCount, layout, sp, bindDesc,
-                           attrDesc);
+                           attrDesc, pipelineCache);
             }
         }
 
     public:
         VulkanSwapchainImageData(const VulkanDebugObjectNamer& namer, uint32_t capacity, const XrSwapchainCreateInfo& swapchainCreateInfo,
                                  VkDevice device, MemoryAllocator* memAllocator, const PipelineLayout& layout, const ShaderProgram& sp,
-                                 const VkVertexInputBindingDescription& bindDesc, span<const VkVertexInputAttributeDescription> attrDesc)
+                                 span<const VkVertexInputBindingDescription> bindDesc,
+                                 span<const VkVertexInputAttributeDescription> attrDesc, VkPipelineCache pipelineCache)
             : SwapchainImageDataBase(XR_TYPE_SWAPCHAIN_IMAGE_VULKAN_KHR, capacity, swapchainCreateInfo)
             , m_namer(namer)
             , m_vkDevice(device)
             , m_memAllocator(memAllocator)
             , m_size{swapchainCreateInfo.width, swapchainCreateInfo.height}
             , m_sampleCount{(VkSampleCountFlagBits)swapchainCreateInfo.sampleCount}
-            , m_slices(swapchainCreateInfo.arraySize)
+            , m_slices(swapchainCreateInfo.arraySize * swapchainCreateInfo.faceCount)
         {
-            init(capacity, (VkFormat)swapchainCreateInfo.format, layout, sp, bindDesc, attrDesc);
+            init(capacity, (VkFormat)swapchainCreateInfo.format, layout, sp, bindDesc, attrDesc, pipelineCache);
         }
 
         VulkanSwapchainImageData(const VulkanDebugObjectNamer& namer, uint32_t capacity, const XrSwapchainCreateInfo& swapchainCreateInfo,
                                  XrSwapchain depthSwapchain, const XrSwapchainCreateInfo& depthSwapchainCreateInfo, VkDevice device,
                                  MemoryAllocator* memAllocator, const PipelineLayout& layout, const ShaderProgram& sp,
-                                 const VkVertexInputBindingDescription& bindDesc, span<const VkVertexInputAttributeDescription> attrDesc)
+                                 span<const VkVertexInputBindingDescription> bindDesc,
+                                 span<const VkVertexInputAttributeDescription> attrDesc, VkPipelineCache pipelineCache)
             : SwapchainImageDataBase(XR_TYPE_SWAPCHAIN_IMAGE_VULKAN_KHR, capacity, swapchainCreateInfo, depthSwapchain,
                                      depthSwapchainCreateInfo)
             , m_namer(namer)
@@ -188,9 +196,9 @@ namespace Conformance
             , m_size{swapchainCreateInfo.width, swapchainCreateInfo.height}
             , m_sampleCount{(VkSampleCountFlagBits)swapchainCreateInfo.sampleCount}
             , m_depthFormat((VkFormat)depthSwapchainCreateInfo.format)
-            , m_slices(swapchainCreateInfo.arraySize)
+            , m_slices(swapchainCreateInfo.arraySize * swapchainCreateInfo.faceCount)
         {
-            init(capacity, (VkFormat)swapchainCreateInfo.format, layout, sp, bindDesc, attrDesc);
+            init(capacity, (VkFormat)swapchainCreateInfo.format, layout, sp, bindDesc, attrDesc, pipelineCache);
         }
 
         ~VulkanSwapchainImageData() override
@@ -237,12 +245,24 @@ namespace Conformance
             return m_depthFormat;
         }
 
+        /// The render pass of each slice, none once reset.
+        std::vector<VkRenderPass> GetRenderPasses() const
+        {
+            std::vector<VkRenderPass> renderPasses;
+            for (const auto& slice : m_slices) {
+                if (slice.m_rp.pass != VK_NULL_HANDLE) {
+                    renderPasses.push_back(slice.m_rp.pass);
+                }
+            }
+            return renderPasses;
+        }
+
     protected:
         const XrSwapchainImageVulkanKHR& GetFallbackDepthSwapchainImage(uint32_t i) override
         {
             if (!m_depthBuffer[i].Allocated()) {
                 m_depthBuffer[i].Allocate(m_namer, m_vkDevice, m_memAllocator, m_depthFormat, this->Width(), this->Height(),
-                                          this->ArraySize(), this->SampleCount());
+                                          this->LayerCount(), this->SampleCount());
             }
 
             return m_depthBuffer[i].GetTexture();
@@ -522,10 +542,24 @@ namespace Conformance
             {1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Geometry::Vertex, Color)}};
         static constexpr VkVertexInputBindingDescription c_bindingDesc = VertexBuffer<Geometry::Vertex>::c_bindingDesc;
 
+        /// Vertex input of the pipeline drawing meshes:
+        /// the mesh vertices in binding 0, and a VulkanMeshInstance per instance in binding 1.
+        static constexpr VkVertexInputBindingDescription c_instancedBindingDesc[2] = {
+            c_bindingDesc, {1, sizeof(VulkanMeshInstance), VK_VERTEX_INPUT_RATE_INSTANCE}};
+        static constexpr VkVertexInputAttributeDescription c_instancedAttrDesc[7] = {
+            c_attrDesc[0],
+            c_attrDesc[1],
+            // A mat4 takes one location per column.
+            {2, 1, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(VulkanMeshInstance, mvp)},
+            {3, 1, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(VulkanMeshInstance, mvp) + 4 * sizeof(float)},
+            {4, 1, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(VulkanMeshInstance, mvp) + 8 * sizeof(float)},
+            {5, 1, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(VulkanMeshInstance, mvp) + 12 * sizeof(float)},
+            {6, 1, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(VulkanMeshInstance, tintColor)}};
+
         VertexBuffer<Geometry::Vertex> m_DrawBuffer;
 
         VulkanMesh(VkDevice device, const VulkanDebugObjectNamer& namer,  //
-                   const MemoryAllocator* memAllocator,                   //
+                   MemoryAllocator* memAllocator,                         //
                    const uint16_t* idx_data, uint32_t idx_count,          //
                    const Geometry::Vertex* vtx_data, uint32_t vtx_count)
         {
@@ -549,6 +583,190 @@ namespace Conformance
     };
     constexpr VkVertexInputAttributeDescription VulkanMesh::c_attrDesc[];
     constexpr VkVertexInputBindingDescription VulkanMesh::c_bindingDesc;
+    constexpr VkVertexInputBindingDescription VulkanMesh::c_instancedBindingDesc[];
+    constexpr VkVertexInputAttributeDescription VulkanMesh::c_instancedAttrDesc[];
+
+    /// A timestamp query pool bracketing the operations timed for a GpuTimerScopes
+    class VulkanGpuTimers
+    {
+    public:
+        GpuTimerScopes& Scopes()
+        {
+            return m_scopes;
+        }
+
+        void Init(const VulkanDebugObjectNamer& namer, VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamilyIndex)
+        {
+            uint32_t queueFamilyCount = 0;
+            vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+            std::vector<VkQueueFamilyProperties> queueFamilyProps(queueFamilyCount);
+            vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilyProps.data());
+            m_timestampValidBits = queueFamilyIndex < queueFamilyCount ? queueFamilyProps[queueFamilyIndex].timestampValidBits : 0;
+            if (m_timestampValidBits == 0) {
+                // The queue does not support timestamps, so every interval resolves as invalid.
+                return;
+            }
+
+            VkPhysicalDeviceProperties properties{};
+            vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+            m_timestampPeriod = properties.limits.timestampPeriod;
+
+            m_vkDevice = device;
+            VkQueryPoolCreateInfo poolInfo{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+            poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+            poolInfo.queryCount = 2 * kMaxIntervals;
+            XRC_CHECK_THROW_VKCMD(vkCreateQueryPool(m_vkDevice, &poolInfo, nullptr, &m_queryPool));
+            XRC_CHECK_THROW_VKCMD(namer.SetName(VK_OBJECT_TYPE_QUERY_POOL, (uint64_t)m_queryPool, "CTS GPU timer query pool"));
+
+            m_freeSlots.clear();
+            for (uint32_t slot = 0; slot < kMaxIntervals; ++slot) {
+                m_freeSlots.push_back(slot);
+            }
+        }
+
+        /// Record the start timestamp of an interval for @p operationName into @p buf, if it is to be timed.
+        /// Must be called outside of a render pass.
+        void BeginInterval(VkCommandBuffer buf, const char* operationName)
+        {
+            AbandonCurrentInterval();
+            const uint64_t id = m_scopes.BeginInterval(operationName);
+            if (id == 0) {
+                return;
+            }
+            if (m_queryPool == VK_NULL_HANDLE || m_freeSlots.empty()) {
+                // Timestamps are unsupported, or every slot is waiting for the GPU, so this interval cannot be measured.
+                m_scopes.ResolveInterval(id, std::chrono::nanoseconds{0}, false);
+                return;
+            }
+            const uint32_t slot = m_freeSlots.back();
+            m_freeSlots.pop_back();
+            vkCmdResetQueryPool(buf, m_queryPool, 2 * slot, 2);
+            vkCmdWriteTimestamp(buf, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_queryPool, 2 * slot);
+            m_current = Interval{id, slot, 0};
+            m_currentBuf = buf;
+        }
+
+        /// Record the end timestamp of the interval begun in @p buf, if any.
+        void EndInterval(VkCommandBuffer buf)
+        {
+            if (m_current.id == 0 || m_currentBuf != buf) {
+                return;
+            }
+            vkCmdWriteTimestamp(buf, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_queryPool, 2 * m_current.slot + 1);
+            m_ended.push_back(m_current);
+            m_current = {};
+            m_currentBuf = VK_NULL_HANDLE;
+        }
+
+        /// The command buffer of the intervals ended since the last call was submitted as submission number @p submitCount.
+        void Submitted(uint64_t submitCount)
+        {
+            for (Interval& interval : m_ended) {
+                interval.submitCount = submitCount;
+                m_pending.push_back(interval);
+            }
+            m_ended.clear();
+        }
+
+        /// Resolve the intervals whose submissions are among the first @p completedSubmitCount to complete.
+        /// Results are only read once the submission is known to have completed: until then, the reset recorded for a reused
+        /// slot may not have executed, and the pool would still report the previous interval's timestamps.
+        void ResolveIntervals(uint64_t completedSubmitCount)
+        {
+            while (!m_pending.empty() && m_pending.front().submitCount <= completedSubmitCount) {
+                const Interval& interval = m_pending.front();
+                uint64_t timestamps[2]{};
+                const VkResult result = vkGetQueryPoolResults(m_vkDevice, m_queryPool, 2 * interval.slot, 2, sizeof(timestamps),
+                                                              timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+                XRC_CHECK_THROW_VKRESULT(result, "vkGetQueryPoolResults");
+
+                const bool valid = result == VK_SUCCESS;
+                const uint64_t mask = m_timestampValidBits >= 64 ? ~uint64_t(0) : ((uint64_t(1) << m_timestampValidBits) - 1);
+                // Masking the difference also copes with the counter wrapping between the two timestamps.
+                const uint64_t ticks = (timestamps[1] - timestamps[0]) & mask;
+                const double nanoseconds = valid ? (double)ticks * (double)m_timestampPeriod : 0.0;
+                m_scopes.ResolveInterval(interval.id, std::chrono::nanoseconds((int64_t)nanoseconds), valid);
+                m_freeSlots.push_back(interval.slot);
+                m_pending.pop_front();
+            }
+        }
+
+        /// Destroy the query pool. Call after the device is idle, with the count of submissions that completed.
+        void Reset(uint64_t completedSubmitCount)
+        {
+            AbandonCurrentInterval();
+            Submitted(UINT64_MAX);
+            ResolveIntervals(completedSubmitCount);
+            // Anything left was never submitted.
+            m_pending.clear();
+            m_scopes.DiscardPending();
+            m_freeSlots.clear();
+            if (m_queryPool != VK_NULL_HANDLE) {
+                vkDestroyQueryPool(m_vkDevice, m_queryPool, nullptr);
+                m_queryPool = VK_NULL_HANDLE;
+            }
+            m_vkDevice = VK_NULL_HANDLE;
+        }
+
+    private:
+        static constexpr uint32_t kMaxIntervals = 64;
+
+        struct Interval
+        {
+            uint64_t id;
+            uint32_t slot;
+            uint64_t submitCount;
+        };
+
+        /// An interval was begun but not ended, e.g. because an exception was thrown while recording it.
+        void AbandonCurrentInterval()
+        {
+            if (m_current.id != 0) {
+                m_scopes.ResolveInterval(m_current.id, std::chrono::nanoseconds{0}, false);
+                m_freeSlots.push_back(m_current.slot);
+                m_current = {};
+                m_currentBuf = VK_NULL_HANDLE;
+            }
+        }
+
+        GpuTimerScopes m_scopes;
+        VkDevice m_vkDevice{VK_NULL_HANDLE};
+        VkQueryPool m_queryPool{VK_NULL_HANDLE};
+        uint32_t m_timestampValidBits{0};
+        float m_timestampPeriod{1.0f};
+        std::vector<uint32_t> m_freeSlots;
+        Interval m_current{};
+        VkCommandBuffer m_currentBuf{VK_NULL_HANDLE};
+        /// Ended, but not yet submitted
+        std::vector<Interval> m_ended;
+        /// Submitted, in increasing submission order
+        std::deque<Interval> m_pending;
+    };
+
+    /// A DrawList recorded into a secondary command buffer for one slice of one swapchain, replayed until the list, the view's
+    /// field of view or image rect, or the render pass changes.
+    struct RecordedDrawList
+    {
+        uint64_t version{0};
+        XrFovf fov{};
+        VkRect2D renderArea{};
+        VkRenderPass renderPass{VK_NULL_HANDLE};
+        /// Per-instance data read by the recorded draws, written once when recording.
+        BufferAndMemory instances{};
+        size_t instanceCapacity{0};
+        VkCommandBuffer buf{VK_NULL_HANDLE};
+        /// The number of the last submission that executed buf
+        uint64_t lastSubmit{0};
+
+        bool Matches(uint64_t version_, const XrFovf& fov_, const VkRect2D& renderArea_, VkRenderPass renderPass_) const
+        {
+            return buf != VK_NULL_HANDLE && version == version_ && fov.angleLeft == fov_.angleLeft &&
+                   fov.angleRight == fov_.angleRight && fov.angleUp == fov_.angleUp && fov.angleDown == fov_.angleDown &&
+                   renderArea.offset.x == renderArea_.offset.x && renderArea.offset.y == renderArea_.offset.y &&
+                   renderArea.extent.width == renderArea_.extent.width && renderArea.extent.height == renderArea_.extent.height &&
+                   renderPass == renderPass_;
+        }
+    };
 
     struct VulkanGraphicsPlugin : public IGraphicsPlugin
     {
@@ -560,6 +778,8 @@ namespace Conformance
         {
             if (m_vkDevice != VK_NULL_HANDLE) {
                 vkDeviceWaitIdle(m_vkDevice);
+                m_stagingDestructionQueue.ReleaseForFenceValue(m_cmdBuffers.CompletedSubmitCount());
+                m_gpuTimers.ResolveIntervals(m_cmdBuffers.CompletedSubmitCount());
             }
         }
 
@@ -612,16 +832,29 @@ namespace Conformance
         bool InitializeDevice(XrInstance instance, XrSystemId systemId, bool checkGraphicsRequirements,
                               uint32_t deviceCreationFlags) override;
 
+        void PrepareDevice() override;
+
 #ifdef USE_ONLINE_VULKAN_SHADERC
-        std::vector<uint32_t> CompileGlslShader(const std::string& name, shaderc_shader_kind kind, const std::string& source);
+        static std::vector<uint32_t> CompileGlslShader(const std::string& name, shaderc_shader_kind kind, const std::string& source);
 #endif
 
+        /// What InitializeResources needs that does not depend on the device
+        struct DeviceIndependentResources
+        {
+            std::vector<uint32_t> vertexSPIRV;
+            std::vector<uint32_t> fragmentSPIRV;
+            std::vector<uint8_t> brdfLutFileData;
+        };
+        static DeviceIndependentResources LoadDeviceIndependentResources();
+
         void InitializeResources();
 
         void ClearSwapchainCache() override;
 
         void ShutdownDevice() override;
 
+        bool ReuseDevice(XrInstance instance, XrSystemId systemId) override;
+
         const XrBaseInStructure* GetGraphicsBinding() const override;
 
         std::string GetImageFormatName(int64_t imageFormat) const override;
@@ -634,6 +867,12 @@ namespace Conformance
                                      uint32_t* imageCount) const override;
         bool ValidateSwapchainImageState(XrSwapchain swapchain, uint32_t index, int64_t imageFormat) const override;
 
+        bool CanCreateSwapchainsConcurrently() const override
+        {
+            // Object creation on a VkDevice is thread-safe, and the queue is not used meanwhile.
+            return true;
+        }
+
         int64_t SelectColorSwapchainFormat(const int64_t* imageFormatArray, size_t count) const override;
 
         int64_t SelectDepthSwapchainFormat(const int64_t* imageFormatArray, size_t count) const override;
@@ -654,14 +893,27 @@ namespace Conformance
         //                                                                  const XrSwapchainCreateInfo& swapchainCreateInfo) override;
 
         void CopyRGBAImage(const XrSwapchainImageBaseHeader* swapchainImageBase, uint32_t arraySlice, const RGBAImage& image) override;
+        void CopyRGBAImageRows(const XrSwapchainImageBaseHeader* swapchainImageBase, uint32_t arraySlice, uint32_t width,
+                               uint32_t height, const RGBARowWriter& writeRows) override;
+
+        uint64_t GetSwapchainImageMemorySize(const XrSwapchainImageBaseHeader* swapchainImage) const override;
 
         void SetViewportAndScissor(const VkRect2D& rect);
+        static void SetViewportAndScissor(VkCommandBuffer buf, const VkRect2D& rect);
 
         void ClearImageSlice(const XrSwapchainImageBaseHeader* colorSwapchainImage, uint32_t imageArrayIndex, XrColor4f color) override;
 
         MeshHandle MakeSimpleMesh(span<const uint16_t> idx, span<const Geometry::Vertex> vtx) override;
 
         GLTFModelHandle LoadGLTF(Gltf::ModelBuilder&& modelBuilder) override;
+        std::vector<Conformance::Image::FormatParams> GetSupportedTextureFormats() const override
+        {
+            if (!m_pbrResources) {
+                return {};
+            }
+            const auto formats = m_pbrResources->GetSupportedFormats();
+            return {formats.begin(), formats.end()};
+        }
         std::shared_ptr<Pbr::Model> GetPbrModel(GLTFModelHandle handle) const override;
         GLTFModelInstanceHandle CreateGLTFModelInstance(GLTFModelHandle handle) override;
         Pbr::ModelInstance& GetModelInstance(GLTFModelInstanceHandle handle) override;
@@ -669,6 +921,73 @@ namespace Conformance
         void RenderView(const XrCompositionLayerProjectionView& layerView, const XrSwapchainImageBaseHeader* colorSwapchainImage,
                         const RenderParams& params) override;
 
+        void RenderViews(span<const XrCompositionLayerProjectionView> layerViews,
+                         span<const XrSwapchainImageBaseHeader* const> colorSwapchainImages, const RenderParams& params) override;
+
+        void RenderDrawList(const XrCompositionLayerProjectionView& layerView, const XrSwapchainImageBaseHeader* colorSwapchainImage,
+                            const DrawList& drawList) override;
+
+        bool SupportsGpuTimers() const override
+        {
+            return true;
+        }
+
+        void BeginGpuTimerScope(const char* name) override
+        {
+            m_gpuTimers.Scopes().BeginScope(name);
+        }
+
+        void EndGpuTimerScope() override
+        {
+            m_gpuTimers.Scopes().EndScope();
+        }
+
+        void CollectGpuTimerSamples(std::vector<GpuTimerSample>& samples) override
+        {
+            if (m_vkDevice != VK_NULL_HANDLE) {
+                m_gpuTimers.ResolveIntervals(m_cmdBuffers.CompletedSubmitCount());
+            }
+            m_gpuTimers.Scopes().TakeSamples(samples);
+        }
+
+        /// Record the render pass for one view into the current command buffer, which must have been begun.
+        /// Returns the swapchain data the view was rendered to.
+        VulkanSwapchainImageData* RecordView(const XrCompositionLayerProjectionView& layerView,
+                                             const XrSwapchainImageBaseHeader* colorSwapchainImage, const RenderParams& params);
+
+        /// Record each view into a secondary command buffer on its own thread, then execute them in view order from the current
+        /// command buffer, which must have been begun. Only for views without glTFs. Returns the swapchain data of the last view.
+        const VulkanSwapchainImageData* RecordViewsInParallel(span<const XrCompositionLayerProjectionView> layerViews,
+                                                              span<const XrSwapchainImageBaseHeader* const> colorSwapchainImages,
+                                                              const RenderParams& params);
+
+        /// Write the per-instance data of m_meshBatches into @p instanceData, transformed by @p viewProjection, and record the
+        /// draws of its batches into @p buf. Does not touch any other shared state, so may be called from several threads.
+        void RecordMeshes(VkCommandBuffer buf, const XrMatrix4x4f& viewProjection, const StagingAllocation& instanceData) const
+        {
+            RecordMeshes(buf, viewProjection, instanceData.GetData(), instanceData.GetBuffer(), instanceData.GetOffset());
+        }
+
+        /// As above, with the per-instance data written to @p instanceMap, the mapping of @p instanceBuffer at @p instanceOffset.
+        void RecordMeshes(VkCommandBuffer buf, const XrMatrix4x4f& viewProjection, void* instanceMap, VkBuffer instanceBuffer,
+                          VkDeviceSize instanceOffset) const;
+
+        /// Record @p drawList, for a view with @p fov and @p renderArea in slice @p imageArrayIndex of @p swapchainData,
+        /// into @p recorded, waiting for any submission still executing it.
+        void RecordDrawList(RecordedDrawList& recorded, const DrawList& drawList, const XrFovf& fov, const VkRect2D& renderArea,
+                            VulkanSwapchainImageData* swapchainData, uint32_t imageArrayIndex, VkRenderPass renderPass);
+
+        /// Free the recorded draw lists, which must not be pending execution, and their command pool.
+        void ResetRecordedDrawLists();
+
+        /// Submit the current command buffer with the views recorded by RecordView, and return the number of the submission.
+        /// Waits for it to complete if @p drewGLTFs, as the PBR constant buffers are only single-buffered.
+        uint64_t SubmitViews(const VulkanSwapchainImageData* lastSwapchainData, bool drewGLTFs);
+
+        /// Copy @p staging into @p arraySlice of @p image on m_transferQueue, handing the slice to the transfer family and
+        /// back to the graphics family, which the runtime expects to own it, with three submissions.
+        void CopyOnTransferQueue(VkImage image, uint32_t arraySlice, uint32_t w, uint32_t h, StagingAllocation&& staging);
+
         /// Get data on a known swapchain format
         const SwapchainFormatData& FindFormatData(int64_t format) const;
 
@@ -676,7 +995,7 @@ namespace Conformance
         void Checkpoint(std::string msg)
         {
             auto check = checkpoints.emplace(std::move(msg));
-            vkCmdSetCheckpointNV(m_cmdBuffer.buf, check.first->c_str());
+            vkCmdSetCheckpointNV(m_cmdBuffers.Current().buf, check.first->c_str());
         }
 
         void ShowCheckpoints()
@@ -712,15 +1031,40 @@ namespace Conformance
         uint32_t m_queueFamilyIndex = 0;
         VkQueue m_vkQueue{VK_NULL_HANDLE};
         VkSemaphore m_vkDrawDone{VK_NULL_HANDLE};
+        /// Queue of a dedicated transfer family for CopyRGBAImageRows, with Options::vulkanTransferQueue, else not valid
+        TransferQueue m_transferQueue;
+        /// Semaphores handing swapchain images to and from m_transferQueue, following the submissions of m_cmdBuffers
+        SemaphorePool m_transferSemaphores;
 
         MemoryAllocator m_memAllocator{};
+        StagingBufferPool m_stagingBufferPool{};
+        /// Staging regions used by submissions of m_cmdBuffers, keyed on the number of the submission that used them
+        DestructionQueue<StagingAllocation> m_stagingDestructionQueue;
+        /// Per-instance data of the views recorded into the current command buffer, queued for release once it is submitted
+        std::vector<StagingAllocation> m_recordedInstanceData;
+        MeshInstanceBatches m_meshBatches;
         ShaderProgram m_shaderProgram{};
-        CmdBuffer m_cmdBuffer{};
+        /// Options::commandBuffersInFlight command buffers, so recording can overlap with earlier submissions executing
+        CmdBufferRing m_cmdBuffers{};
+        /// Per-thread pools of secondary command buffers for RecordViewsInParallel, per position in m_cmdBuffers
+        std::vector<std::vector<std::unique_ptr<SecondaryCmdBufferPool>>> m_secondaryCmdPools;
+        /// Draw lists recorded by RenderDrawList, keyed on the draw list ID, the swapchain and the array slice
+        std::map<std::tuple<uint64_t, const VulkanSwapchainImageData*, uint32_t>, RecordedDrawList> m_recordedDrawLists;
+        /// Command pool of the recorded draw lists, whose buffers are reset one at a time when recorded again
+        VkCommandPool m_drawListCmdPool{VK_NULL_HANDLE};
+        VulkanGpuTimers m_gpuTimers;
         PipelineLayout m_pipelineLayout{};
+        /// Outlives m_vkDevice, so that later sessions do not recompile the same pipelines.
+        PipelineCache m_pipelineCache{};
+        DeviceIndependentLoad<DeviceIndependentResources> m_deviceIndependentResources{&LoadDeviceIndependentResources};
         MeshHandle m_cubeMesh{};
         VectorWithGenerationCountedHandles<VulkanMesh, MeshHandle> m_meshes;
+        MeshHandleCache<uint16_t, Geometry::Vertex, MeshHandle> m_meshesByContent;
         // This is fine to be a shared_ptr because Model doesn't directly hold any graphics state.
         VectorWithGenerationCountedHandles<std::shared_ptr<Pbr::Model>, GLTFModelHandle> m_gltfModels;
+        /// Set once a glTF model is loaded on this device, from when swapchains get their PBR pipelines compiled up front.
+        bool m_gltfLoaded{false};
+        SceneHandleCache<Gltf::DecodedScene, GLTFModelHandle> m_gltfModelsByScene;
         VectorWithGenerationCountedHandles<VulkanGLTF, GLTFModelInstanceHandle> m_gltfInstances;
         std::unique_ptr<Pbr::VulkanResources> m_pbrResources;
 
@@ -1109,7 +1453,10 @@ namespace Conformance
 
         if (checkGraphicsRequirements) {
             XrGraphicsRequirementsVulkanKHR graphicsRequirements{XR_TYPE_GRAPHICS_REQUIREMENTS_VULKAN_KHR};
-            XRC_CHECK_THROW_XRCMD(GetVulkanGraphicsRequirements2KHR(instance, systemId, &graphicsRequirements));
+            {
+                ScopedStartupPhase timing(StartupPhase::GraphicsRequirements);
+                XRC_CHECK_THROW_XRCMD(GetVulkanGraphicsRequirements2KHR(instance, systemId, &graphicsRequirements));
+            }
             const XrVersion vulkanVersion = XR_MAKE_VERSION(VK_VERSION_MAJOR(VK_API_VERSION_1_0), VK_VERSION_MINOR(VK_API_VERSION_1_0), 0);
             if ((vulkanVersion < graphicsRequirements.minApiVersionSupported) ||
                 (vulkanVersion > graphicsRequirements.maxApiVersionSupported)) {
@@ -1241,6 +1588,18 @@ namespace Conformance
             }
         }
 
+        std::vector<VkDeviceQueueCreateInfo> queueInfos{queueInfo};
+        uint32_t transferFamilyIndex = 0;
+        const bool useTransferQueue =
+            GetGlobalData().options.vulkanTransferQueue && TransferQueue::FindFamily(m_vkPhysicalDevice, &transferFamilyIndex);
+        if (useTransferQueue) {
+            VkDeviceQueueCreateInfo transferQueueInfo{VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO};
+            transferQueueInfo.queueFamilyIndex = transferFamilyIndex;
+            transferQueueInfo.queueCount = 1;
+            transferQueueInfo.pQueuePriorities = &queuePriorities;
+            queueInfos.push_back(transferQueueInfo);
+        }
+
         std::vector<const char*> deviceExtensions;
 
         VkPhysicalDeviceFeatures features{};
@@ -1250,8 +1609,8 @@ namespace Conformance
 
         VkDeviceCreateInfo deviceInfo{VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO};
         deviceInfo.flags = VkDeviceCreateFlags(deviceCreationFlags);
-        deviceInfo.queueCreateInfoCount = 1;
-        deviceInfo.pQueueCreateInfos = &queueInfo;
+        deviceInfo.queueCreateInfoCount = (uint32_t)queueInfos.size();
+        deviceInfo.pQueueCreateInfos = queueInfos.data();
         deviceInfo.enabledLayerCount = 0;
         deviceInfo.ppEnabledLayerNames = nullptr;
         deviceInfo.enabledExtensionCount = (uint32_t)deviceExtensions.size();
@@ -1270,8 +1629,15 @@ namespace Conformance
         m_namer.Init(m_vkInstance, m_vkDevice);
 
         vkGetDeviceQueue(m_vkDevice, queueInfo.queueFamilyIndex, 0, &m_vkQueue);
+        if (useTransferQueue) {
+            if (!m_transferQueue.Init(m_namer, m_vkDevice, transferFamilyIndex, GetGlobalData().options.commandBuffersInFlight))
+                XRC_THROW("Failed to create transfer command buffer");
+            m_transferSemaphores.Init(m_namer, m_vkDevice);
+        }
 
         m_memAllocator.Init(m_vkPhysicalDevice, m_vkDevice);
+        m_stagingBufferPool.Init(m_namer, m_vkDevice, m_memAllocator);
+        m_pipelineCache.Init(m_namer, m_vkPhysicalDevice, m_vkDevice, GetGlobalData().options.pipelineCacheDirectory);
 
         InitializeResources();
 
@@ -1304,35 +1670,52 @@ namespace Conformance
     }
 #endif
 
-    void VulkanGraphicsPlugin::InitializeResources()
+    VulkanGraphicsPlugin::DeviceIndependentResources VulkanGraphicsPlugin::LoadDeviceIndependentResources()
     {
+        DeviceIndependentResources resources;
 #ifdef USE_ONLINE_VULKAN_SHADERC
-        auto vertexSPIRV = CompileGlslShader("vertex", shaderc_glsl_default_vertex_shader, VertexShaderGlsl);
-        auto fragmentSPIRV = CompileGlslShader("fragment", shaderc_glsl_default_fragment_shader, FragmentShaderGlsl);
+        resources.vertexSPIRV = CompileGlslShader("vertex", shaderc_glsl_default_vertex_shader, VertexShaderGlsl);
+        resources.fragmentSPIRV = CompileGlslShader("fragment", shaderc_glsl_default_fragment_shader, FragmentShaderGlsl);
 #else
-        std::vector<uint32_t> vertexSPIRV = SPV_PREFIX
+        resources.vertexSPIRV = SPV_PREFIX
 #include "vert.spv"  // IWYU pragma: keep
             SPV_SUFFIX;
-        std::vector<uint32_t> fragmentSPIRV = SPV_PREFIX
+        resources.fragmentSPIRV = SPV_PREFIX
 #include "frag.spv"  // IWYU pragma: keep
             SPV_SUFFIX;
 #endif
-        if (vertexSPIRV.empty())
+        if (resources.vertexSPIRV.empty())
             XRC_THROW("Failed to compile vertex shader");
-        if (fragmentSPIRV.empty())
+        if (resources.fragmentSPIRV.empty())
             XRC_THROW("Failed to compile fragment shader");
 
+        resources.brdfLutFileData = ReadFileBytes("brdf_lut.png");
+        return resources;
+    }
+
+    void VulkanGraphicsPlugin::PrepareDevice()
+    {
+        m_deviceIndependentResources.Start();
+    }
+
+    void VulkanGraphicsPlugin::InitializeResources()
+    {
+        const DeviceIndependentResources& deviceIndependent = m_deviceIndependentResources.Get();
+
         m_shaderProgram.Init(m_vkDevice);
-        m_shaderProgram.LoadVertexShader(vertexSPIRV);
-        m_shaderProgram.LoadFragmentShader(fragmentSPIRV);
+        m_shaderProgram.LoadVertexShader(deviceIndependent.vertexSPIRV);
+        m_shaderProgram.LoadFragmentShader(deviceIndependent.fragmentSPIRV);
 
         // Semaphore to block on draw complete
         VkSemaphoreCreateInfo semInfo{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
         XRC_CHECK_THROW_VKCMD(vkCreateSemaphore(m_vkDevice, &semInfo, nullptr, &m_vkDrawDone));
         XRC_CHECK_THROW_VKCMD(m_namer.SetName(VK_OBJECT_TYPE_SEMAPHORE, (uint64_t)m_vkDrawDone, "CTS draw done semaphore"));
 
-        if (!m_cmdBuffer.Init(m_namer, m_vkDevice, m_queueFamilyIndex))
+        if (!m_cmdBuffers.Init(m_namer, m_vkDevice, m_queueFamilyIndex, GetGlobalData().options.commandBuffersInFlight))
             XRC_THROW("Failed to create command buffer");
+        m_secondaryCmdPools.resize(m_cmdBuffers.Size());
+        m_gpuTimers.Init(m_namer, m_vkPhysicalDevice, m_vkDevice, m_queueFamilyIndex);
+        m_gpuTimers.Scopes().SetTimeOperations(GetGlobalData().options.gpuTimers);
 
         m_pipelineLayout.Create(m_vkDevice);
         XRC_CHECK_THROW_VKCMD(
@@ -1342,15 +1725,21 @@ namespace Conformance
 
         m_cubeMesh = MakeCubeMesh();
 
-        m_pbrResources = std::make_unique<Pbr::VulkanResources>(m_namer, m_vkPhysicalDevice, m_vkDevice, m_queueFamilyIndex);
+        m_pbrResources =
+            std::make_unique<Pbr::VulkanResources>(m_namer, m_vkPhysicalDevice, m_vkDevice, m_queueFamilyIndex, m_stagingBufferPool,
+                                                   m_pipelineCache.cache);
         m_pbrResources->SetLight({0.0f, 0.7071067811865475f, 0.7071067811865475f}, Pbr::RGB::White);
+        m_pbrResources->SetTextureCacheBudget(uint64_t{GetGlobalData().options.pbrTextureCacheBudget} << 20);
+        if (m_transferQueue.IsValid()) {
+            m_pbrResources->UseTransferQueue(m_transferQueue.FamilyIndex());
+        }
 
         auto blackCubeMap =
             std::make_shared<Pbr::VulkanTextureBundle>(Pbr::VulkanTexture::CreateFlatCubeTexture(*m_pbrResources, Pbr::RGBA::Black, false));
         m_pbrResources->SetEnvironmentMap(blackCubeMap, blackCubeMap);
 
-        // Read the BRDF Lookup Table used by the PBR system into a Vulkan texture.
-        std::vector<unsigned char> brdfLutFileData = ReadFileBytes("brdf_lut.png");
+        // Load the BRDF Lookup Table used by the PBR system into a Vulkan texture.
+        const std::vector<uint8_t>& brdfLutFileData = deviceIndependent.brdfLutFileData;
         auto brdLutResourceView = std::make_shared<Pbr::VulkanTextureBundle>(
             Pbr::VulkanTexture::LoadTextureImage(*m_pbrResources, false, brdfLutFileData.data(), (uint32_t)brdfLutFileData.size()));
         m_pbrResources->SetBrdfLut(brdLutResourceView);
@@ -1358,17 +1747,16 @@ namespace Conformance
 #if defined(USE_MIRROR_WINDOW)
         m_swapchain.Create(m_vkInstance, m_vkPhysicalDevice, m_vkDevice, m_graphicsBinding.queueFamilyIndex);
 
-        m_cmdBuffer.Clear();
-        m_cmdBuffer.Begin();
-        m_swapchain.Prepare(m_cmdBuffer.buf);
-        m_cmdBuffer.End();
-        m_cmdBuffer.Exec(m_vkQueue);
-        m_cmdBuffer.Wait();
+        m_swapchain.Prepare(m_cmdBuffers.Begin().buf);
+        m_cmdBuffers.Submit(m_vkQueue, true);
 #endif
     }
 
     void VulkanGraphicsPlugin::ClearSwapchainCache()
     {
+        // The swapchain image data may still be used by command buffers in flight.
+        m_cmdBuffers.WaitAll();
+        ResetRecordedDrawLists();
         m_swapchainImageDataMap.Reset();
     }
 
@@ -1386,8 +1774,11 @@ namespace Conformance
             m_swapchainImageDataMap.Reset();
             m_cubeMesh = {};
             m_meshes.clear();
+            m_meshesByContent.clear();
             m_gltfInstances.clear();
             m_gltfModels.clear();
+            m_gltfModelsByScene.clear();
+            m_gltfLoaded = false;
             m_pbrResources.reset();
 
             m_queueFamilyIndex = 0;
@@ -1397,7 +1788,17 @@ namespace Conformance
                 m_vkDrawDone = VK_NULL_HANDLE;
             }
 
-            m_cmdBuffer.Reset();
+            m_recordedInstanceData.clear();
+            m_stagingDestructionQueue.ReleaseForFenceValue(m_cmdBuffers.CompletedSubmitCount());
+            m_stagingBufferPool.Reset();
+            m_gpuTimers.Reset(m_cmdBuffers.CompletedSubmitCount());
+
+            m_secondaryCmdPools.clear();
+            ResetRecordedDrawLists();
+            m_cmdBuffers.Reset();
+            m_transferSemaphores.Reset();
+            m_transferQueue.Reset();
+            m_pipelineCache.Reset();
             m_pipelineLayout.Reset();
             m_shaderProgram.Reset();
             m_memAllocator.Reset();
@@ -1419,6 +1820,38 @@ namespace Conformance
         }
     }
 
+    bool VulkanGraphicsPlugin::ReuseDevice(XrInstance instance, XrSystemId systemId)
+    {
+        if (m_vkDevice == VK_NULL_HANDLE) {
+            return false;
+        }
+
+        XrGraphicsRequirementsVulkanKHR graphicsRequirements{XR_TYPE_GRAPHICS_REQUIREMENTS_VULKAN_KHR};
+        {
+            ScopedStartupPhase timing(StartupPhase::GraphicsRequirements);
+            XRC_CHECK_THROW_XRCMD(GetVulkanGraphicsRequirements2KHR(instance, systemId, &graphicsRequirements));
+        }
+        const XrVersion vulkanVersion = XR_MAKE_VERSION(VK_VERSION_MAJOR(VK_API_VERSION_1_0), VK_VERSION_MINOR(VK_API_VERSION_1_0), 0);
+        if ((vulkanVersion < graphicsRequirements.minApiVersionSupported) ||
+            (vulkanVersion > graphicsRequirements.maxApiVersionSupported)) {
+            return false;
+        }
+
+        // The runtime must still want the physical device the existing device was created on.
+        XrVulkanGraphicsDeviceGetInfoKHR deviceGetInfo{XR_TYPE_VULKAN_GRAPHICS_DEVICE_GET_INFO_KHR};
+        deviceGetInfo.systemId = systemId;
+        deviceGetInfo.vulkanInstance = m_vkInstance;
+        VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+        XRC_CHECK_THROW_XRCMD(GetVulkanGraphicsDevice2KHR(instance, &deviceGetInfo, &physicalDevice));
+        if (physicalDevice != m_vkPhysicalDevice) {
+            return false;
+        }
+
+        XRC_CHECK_THROW_VKCMD(vkDeviceWaitIdle(m_vkDevice));
+        m_swapchainImageDataMap.Reset();
+        return true;
+    }
+
     const XrBaseInStructure* VulkanGraphicsPlugin::GetGraphicsBinding() const
     {
         if (m_graphicsBinding.device) {
@@ -1719,13 +2152,16 @@ namespace Conformance
 
     ISwapchainImageData* VulkanGraphicsPlugin::AllocateSwapchainImageData(size_t size, const XrSwapchainCreateInfo& swapchainCreateInfo)
     {
-        auto typedResult = std::make_unique<VulkanSwapchainImageData>(m_namer, uint32_t(size), swapchainCreateInfo, m_vkDevice,
-                                                                      &m_memAllocator, m_pipelineLayout, m_shaderProgram,
-                                                                      VulkanMesh::c_bindingDesc, VulkanMesh::c_attrDesc);
+        auto typedResult = std::make_unique<VulkanSwapchainImageData>(
+            m_namer, uint32_t(size), swapchainCreateInfo, m_vkDevice, &m_memAllocator, m_pipelineLayout, m_shaderProgram,
+            VulkanMesh::c_instancedBindingDesc, VulkanMesh::c_instancedAttrDesc, m_pipelineCache.cache);
 
         // Cast our derived type to the caller-expected type.
         auto ret = static_cast<ISwapchainImageData*>(typedResult.get());
 
+        if (m_gltfLoaded) {
+            m_pbrResources->PrecompilePipelines(typedResult->GetRenderPasses(), (VkSampleCountFlagBits)typedResult->SampleCount());
+        }
         m_swapchainImageDataMap.Adopt(std::move(typedResult));
 
         return ret;
@@ -1738,19 +2174,42 @@ namespace Conformance
 
         auto typedResult = std::make_unique<VulkanSwapchainImageData>(
             m_namer, uint32_t(size), colorSwapchainCreateInfo, depthSwapchain, depthSwapchainCreateInfo, m_vkDevice, &m_memAllocator,
-            m_pipelineLayout, m_shaderProgram, VulkanMesh::c_bindingDesc, VulkanMesh::c_attrDesc);
+            m_pipelineLayout, m_shaderProgram, VulkanMesh::c_instancedBindingDesc, VulkanMesh::c_instancedAttrDesc, m_pipelineCache.cache);
 
         // Cast our derived type to the caller-expected type.
         auto ret = static_cast<ISwapchainImageData*>(typedResult.get());
 
+        if (m_gltfLoaded) {
+            m_pbrResources->PrecompilePipelines(typedResult->GetRenderPasses(), (VkSampleCountFlagBits)typedResult->SampleCount());
+        }
         m_swapchainImageDataMap.Adopt(std::move(typedResult));
 
         return ret;
     }
 
+    uint64_t VulkanGraphicsPlugin::GetSwapchainImageMemorySize(const XrSwapchainImageBaseHeader* swapchainImage) const
+    {
+        VkMemoryRequirements memReqs{};
+        vkGetImageMemoryRequirements(m_vkDevice, reinterpret_cast<const XrSwapchainImageVulkanKHR*>(swapchainImage)->image, &memReqs);
+        return memReqs.size;
+    }
+
     void VulkanGraphicsPlugin::CopyRGBAImage(const XrSwapchainImageBaseHeader* swapchainImageBase, uint32_t arraySlice,
                                              const RGBAImage& image)
     {
+        XRC_TRACE_SCOPE("VulkanGraphicsPlugin::CopyRGBAImage");
+        const uint32_t rowSize = image.width * sizeof(RGBA8Color);
+        CopyRGBAImageRows(swapchainImageBase, arraySlice, image.width, image.height,
+                          [&](uint32_t firstRow, uint32_t rowCount, uint8_t* dest, uint32_t rowPitch) {
+                              CopyWithStride(reinterpret_cast<const uint8_t*>(image.pixels.data()) + (size_t)firstRow * rowSize, dest,
+                                             rowSize, rowCount, rowPitch);
+                          });
+    }
+
+    void VulkanGraphicsPlugin::CopyRGBAImageRows(const XrSwapchainImageBaseHeader* swapchainImageBase, uint32_t arraySlice, uint32_t w,
+                                                 uint32_t h, const RGBARowWriter& writeRows)
+    {
+        XRC_TRACE_SCOPE("VulkanGraphicsPlugin::CopyRGBAImageRows");
         const XrSwapchainImageVulkanKHR* swapchainImageVk = reinterpret_cast<const XrSwapchainImageVulkanKHR*>(swapchainImageBase);
 
         VulkanSwapchainImageData* swapchainData;
@@ -1758,61 +2217,26 @@ namespace Conformance
 
         std::tie(swapchainData, imageIndex) = m_swapchainImageDataMap.GetDataAndIndexFromBasePointer(swapchainImageBase);
 
-        uint32_t w = image.width;
-        uint32_t h = image.height;
-
-        // Create a linear staging buffer
-        VkImageCreateInfo imgInfo{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
-        imgInfo.imageType = VK_IMAGE_TYPE_2D;
-
         int64_t imageFormat = swapchainData->GetCreateInfo().format;
         XRC_CHECK_THROW(imageFormat == GetSRGBA8Format());
 
-        imgInfo.format = static_cast<VkFormat>(imageFormat);
-        imgInfo.extent = {w, h, 1};
-        imgInfo.mipLevels = 1;
-        imgInfo.arrayLayers = 1;
-        imgInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-        imgInfo.tiling = VK_IMAGE_TILING_LINEAR;
-        imgInfo.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
-        imgInfo.initialLayout = VK_IMAGE_LAYOUT_PREINITIALIZED;
-        VkImage stagingImage{VK_NULL_HANDLE};
-        XRC_CHECK_THROW_VKCMD(vkCreateImage(m_vkDevice, &imgInfo, nullptr, &stagingImage));
-
-        VkMemoryRequirements memReq{};
-        vkGetImageMemoryRequirements(m_vkDevice, stagingImage, &memReq);
-        VkDeviceMemory stagingMemory{VK_NULL_HANDLE};
-        m_memAllocator.Allocate(memReq, &stagingMemory, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-        XRC_CHECK_THROW_VKCMD(vkBindImageMemory(m_vkDevice, stagingImage, stagingMemory, 0));
-
-        VkImageSubresource imgSubRes{};
-        imgSubRes.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        imgSubRes.mipLevel = 0;
-        imgSubRes.arrayLayer = 0;
-        VkSubresourceLayout layout{};
-        vkGetImageSubresourceLayout(m_vkDevice, stagingImage, &imgSubRes, &layout);
-
-        uint8_t* data{nullptr};
-        XRC_CHECK_THROW_VKCMD(vkMapMemory(m_vkDevice, stagingMemory, layout.offset, layout.size, 0, (void**)&data));
-        image.CopyWithStride(data, static_cast<uint32_t>(layout.rowPitch), static_cast<uint32_t>(layout.offset));
-        vkUnmapMemory(m_vkDevice, stagingMemory);
-
-        m_cmdBuffer.Clear();
-        m_cmdBuffer.Begin();
-
-        // Switch the staging buffer from PREINITIALIZED -> TRANSFER_SRC_OPTIMAL
+        // Stage the pixels in the pooled, persistently-mapped upload buffer. The staging memory is only reclaimed once the copy
+        // has executed, so the whole image is written in one band.
+        // VK_EXT_host_image_copy could skip the staging and submission, but only for images created with
+        // VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT, which no XrSwapchainUsageFlags bit asks the runtime for.
+        const uint32_t rowPitch = w * sizeof(RGBA8Color);
+        StagingAllocation staging = m_stagingBufferPool.Allocate(VkDeviceSize(rowPitch) * h);
+        writeRows(0, h, staging.GetData(), rowPitch);
+
+        if (m_transferQueue.IsValid()) {
+            CopyOnTransferQueue(swapchainImageVk->image, arraySlice, w, h, std::move(staging));
+            return;
+        }
+
+        CmdBuffer& cmdBuffer = m_cmdBuffers.Begin();
+        m_gpuTimers.BeginInterval(cmdBuffer.buf, "CopyRGBAImage");
+
         VkImageMemoryBarrier imgBarrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
-        imgBarrier.srcAccessMask = 0;
-        imgBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-        imgBarrier.oldLayout = VK_IMAGE_LAYOUT_PREINITIALIZED;
-        imgBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-        imgBarrier.srcQueueFamilyIndex = m_queueFamilyIndex;
-        imgBarrier.dstQueueFamilyIndex = m_queueFamilyIndex;
-        imgBarrier.image = stagingImage;
-        imgBarrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
-        vkCmdPipelineBarrier(m_cmdBuffer.buf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1,
-                             &imgBarrier);
 
         // Switch the destination image from COLOR_ATTACHMENT_OPTIMAL -> TRANSFER_DST_OPTIMAL
         //
@@ -1831,16 +2255,19 @@ namespace Conformance
         imgBarrier.dstQueueFamilyIndex = m_queueFamilyIndex;
         imgBarrier.image = swapchainImageVk->image;
         imgBarrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, arraySlice, 1};
-        vkCmdPipelineBarrier(m_cmdBuffer.buf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1,
+        vkCmdPipelineBarrier(cmdBuffer.buf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1,
                              &imgBarrier);
 
-        // Blit staging -> swapchain
-        VkImageBlit blit = {{VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
-                            {{0, 0, 0}, {(int32_t)w, (int32_t)h, 1}},
-                            {VK_IMAGE_ASPECT_COLOR_BIT, 0, arraySlice, 1},
-                            {{0, 0, 0}, {(int32_t)w, (int32_t)h, 1}}};
-        vkCmdBlitImage(m_cmdBuffer.buf, stagingImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, swapchainImageVk->image,
-                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_NEAREST);
+        // Copy staging -> swapchain
+        VkBufferImageCopy region{};
+        region.bufferOffset = staging.GetOffset();
+        region.bufferRowLength = 0;
+        region.bufferImageHeight = 0;
+        region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, arraySlice, 1};
+        region.imageOffset = {0, 0, 0};
+        region.imageExtent = {w, h, 1};
+        vkCmdCopyBufferToImage(cmdBuffer.buf, staging.GetBuffer(), swapchainImageVk->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1,
+                               &region);
 
         // Switch the destination image from TRANSFER_DST_OPTIMAL -> COLOR_ATTACHMENT_OPTIMAL
         //
@@ -1860,22 +2287,101 @@ namespace Conformance
         imgBarrier.dstQueueFamilyIndex = m_queueFamilyIndex;
         imgBarrier.image = swapchainImageVk->image;
         imgBarrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, arraySlice, 1};
-        vkCmdPipelineBarrier(m_cmdBuffer.buf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, 0, nullptr,
+        vkCmdPipelineBarrier(cmdBuffer.buf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, 0, nullptr,
                              0, nullptr, 1, &imgBarrier);
 
-        m_cmdBuffer.End();
-        m_cmdBuffer.Exec(m_vkQueue);
-        m_cmdBuffer.Wait();
+        m_gpuTimers.EndInterval(cmdBuffer.buf);
+        const uint64_t submitCount = m_cmdBuffers.Submit(m_vkQueue);
+        m_gpuTimers.Submitted(submitCount);
+        m_stagingDestructionQueue.PushResource(submitCount, std::move(staging));
+        m_stagingDestructionQueue.ReleaseForFenceValue(m_cmdBuffers.CompletedSubmitCount());
+        m_gpuTimers.ResolveIntervals(m_cmdBuffers.CompletedSubmitCount());
+    }
 
-        vkDestroyImage(m_vkDevice, stagingImage, nullptr);
-        vkFreeMemory(m_vkDevice, stagingMemory, nullptr);
+    void VulkanGraphicsPlugin::CopyOnTransferQueue(VkImage image, uint32_t arraySlice, uint32_t w, uint32_t h,
+                                                   StagingAllocation&& staging)
+    {
+        const uint32_t graphicsFamily = m_queueFamilyIndex;
+        const uint32_t transferFamily = m_transferQueue.FamilyIndex();
+        const uint64_t completed = m_cmdBuffers.CompletedSubmitCount();
+        const VkSemaphore toTransfer = m_transferSemaphores.Get(completed);
+        const VkSemaphore toGraphics = m_transferSemaphores.Get(completed);
+
+        // Each ownership transfer is a release barrier on the queue giving the slice up and an acquire barrier on the one
+        // taking it, with the same families and layouts; the release's destination and the acquire's source access are ignored.
+        VkImageMemoryBarrier imgBarrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+        imgBarrier.image = image;
+        imgBarrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, arraySlice, 1};
+
+        // Release the slice to the transfer family, from COLOR_ATTACHMENT_OPTIMAL, as acquired from the runtime, to
+        // TRANSFER_DST_OPTIMAL.
+        CmdBuffer& release = m_cmdBuffers.Begin();
+        imgBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        imgBarrier.dstAccessMask = 0;
+        imgBarrier.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        imgBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        imgBarrier.srcQueueFamilyIndex = graphicsFamily;
+        imgBarrier.dstQueueFamilyIndex = transferFamily;
+        vkCmdPipelineBarrier(release.buf, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0,
+                             nullptr, 0, nullptr, 1, &imgBarrier);
+        SubmitSemaphores releaseSemaphores;
+        releaseSemaphores.signal = {toTransfer};
+        m_cmdBuffers.Submit(m_vkQueue, false, &releaseSemaphores);
+
+        // Acquire it on the transfer queue, copy, and release it back to the graphics family as COLOR_ATTACHMENT_OPTIMAL.
+        CmdBuffer& copy = m_transferQueue.Begin();
+        imgBarrier.srcAccessMask = 0;
+        imgBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(copy.buf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1,
+                             &imgBarrier);
+
+        VkBufferImageCopy region{};
+        region.bufferOffset = staging.GetOffset();
+        region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, arraySlice, 1};
+        region.imageExtent = {w, h, 1};
+        vkCmdCopyBufferToImage(copy.buf, staging.GetBuffer(), image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+        imgBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        imgBarrier.dstAccessMask = 0;
+        imgBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        imgBarrier.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        imgBarrier.srcQueueFamilyIndex = transferFamily;
+        imgBarrier.dstQueueFamilyIndex = graphicsFamily;
+        vkCmdPipelineBarrier(copy.buf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1,
+                             &imgBarrier);
+        SubmitSemaphores copySemaphores;
+        copySemaphores.wait = {toTransfer};
+        copySemaphores.waitStages = {VK_PIPELINE_STAGE_TRANSFER_BIT};
+        copySemaphores.signal = {toGraphics};
+        m_transferQueue.Submit(copySemaphores);
+
+        // Acquire it back on the graphics queue, which the runtime expects to own it once released.
+        CmdBuffer& acquire = m_cmdBuffers.Begin();
+        imgBarrier.srcAccessMask = 0;
+        imgBarrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT;
+        vkCmdPipelineBarrier(acquire.buf, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0,
+                             0, nullptr, 0, nullptr, 1, &imgBarrier);
+        SubmitSemaphores acquireSemaphores;
+        acquireSemaphores.wait = {toGraphics};
+        acquireSemaphores.waitStages = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+        const uint64_t submitCount = m_cmdBuffers.Submit(m_vkQueue, false, &acquireSemaphores);
+
+        // The last submission only completes after the copy, so it keeps the staging region and both semaphores in use.
+        m_transferSemaphores.Submitted(submitCount);
+        m_stagingDestructionQueue.PushResource(submitCount, std::move(staging));
+        m_stagingDestructionQueue.ReleaseForFenceValue(m_cmdBuffers.CompletedSubmitCount());
     }
 
     void VulkanGraphicsPlugin::SetViewportAndScissor(const VkRect2D& rect)
+    {
+        SetViewportAndScissor(m_cmdBuffers.Current().buf, rect);
+    }
+
+    void VulkanGraphicsPlugin::SetViewportAndScissor(VkCommandBuffer buf, const VkRect2D& rect)
     {
         VkViewport viewport{float(rect.offset.x), float(rect.offset.y), float(rect.extent.width), float(rect.extent.height), 0.0f, 1.0f};
-        vkCmdSetViewport(m_cmdBuffer.buf, 0, 1, &viewport);
-        vkCmdSetScissor(m_cmdBuffer.buf, 0, 1, &rect);
+        vkCmdSetViewport(buf, 0, 1, &viewport);
+        vkCmdSetScissor(buf, 0, 1, &rect);
     }
 
     /// Compute image layout for the "second image" format (depth and/or stencil)
@@ -1925,8 +2431,8 @@ namespace Conformance
 
         std::tie(swapchainData, imageIndex) = m_swapchainImageDataMap.GetDataAndIndexFromBasePointer(colorSwapchainImage);
 
-        m_cmdBuffer.Clear();
-        m_cmdBuffer.Begin();
+        CmdBuffer& cmdBuffer = m_cmdBuffers.Begin();
+        m_gpuTimers.BeginInterval(cmdBuffer.buf, "ClearImageSlice");
 
         VkRect2D renderArea = {{0, 0}, {swapchainData->Width(), swapchainData->Height()}};
         SetViewportAndScissor(renderArea);
@@ -1944,12 +2450,12 @@ namespace Conformance
         if (!swapchainData->DepthSwapchainEnabled()) {
             // Ensure self-made fallback depth is in the right layout
             VkImageLayout layout = ComputeLayout(secondFormatData);
-            swapchainData->TransitionLayout(imageIndex, &m_cmdBuffer, layout);
+            swapchainData->TransitionLayout(imageIndex, &cmdBuffer, layout);
         }
 
-        vkCmdBeginRenderPass(m_cmdBuffer.buf, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+        vkCmdBeginRenderPass(cmdBuffer.buf, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
-        swapchainData->BindPipeline(m_cmdBuffer.buf, imageArrayIndex);
+        swapchainData->BindPipeline(cmdBuffer.buf, imageArrayIndex);
 
         // Clear the buffers
         static std::array<VkClearValue, 2> clearValues;
@@ -1965,27 +2471,57 @@ namespace Conformance
         }};
         // imageArrayIndex already included in the VkImageView
         VkClearRect clearRect{renderArea, 0, 1};
-        vkCmdClearAttachments(m_cmdBuffer.buf, 2, &clearAttachments[0], 1, &clearRect);
+        vkCmdClearAttachments(cmdBuffer.buf, 2, &clearAttachments[0], 1, &clearRect);
 
-        vkCmdEndRenderPass(m_cmdBuffer.buf);
+        vkCmdEndRenderPass(cmdBuffer.buf);
 
-        m_cmdBuffer.End();
-        m_cmdBuffer.Exec(m_vkQueue);
-        // XXX Should double-buffer the command buffers, for now just flush
-        m_cmdBuffer.Wait();
+        m_gpuTimers.EndInterval(cmdBuffer.buf);
+        m_gpuTimers.Submitted(m_cmdBuffers.Submit(m_vkQueue));
+        m_gpuTimers.ResolveIntervals(m_cmdBuffers.CompletedSubmitCount());
     }
 
     MeshHandle VulkanGraphicsPlugin::MakeSimpleMesh(span<const uint16_t> idx, span<const Geometry::Vertex> vtx)
     {
+        // A mesh with the same content shares the buffers created then.
+        MeshHandle cachedHandle = m_meshesByContent.Find(idx, vtx);
+        if (cachedHandle != MeshHandle{}) {
+            return cachedHandle;
+        }
+
         auto handle =
             m_meshes.emplace_back(m_vkDevice, m_namer, &m_memAllocator, idx.data(), (uint32_t)idx.size(), vtx.data(), (uint32_t)vtx.size());
 
+        m_meshesByContent.Insert(idx, vtx, handle);
         return handle;
     }
 
     GLTFModelHandle VulkanGraphicsPlugin::LoadGLTF(Gltf::ModelBuilder&& modelBuilder)
     {
+        XRC_TRACE_SCOPE("VulkanGraphicsPlugin::LoadGLTF");
+        // A scene already loaded on this device shares the model built then.
+        std::shared_ptr<const Gltf::DecodedScene> scene = modelBuilder.GetDecodedScene();
+        GLTFModelHandle cachedHandle = m_gltfModelsByScene.Find(scene);
+        if (cachedHandle != GLTFModelHandle{}) {
+            return cachedHandle;
+        }
+
         auto handle = m_gltfModels.emplace_back(modelBuilder.Build(*m_pbrResources));
+        m_gltfModelsByScene.Insert(std::move(scene), handle);
+
+        if (!m_gltfLoaded) {
+            // Swapchains may be drawn to with glTF models from now on, so compile the PBR pipelines for those that exist now,
+            // and for later ones as they are created, before any frame loop needs them.
+            m_gltfLoaded = true;
+            std::map<VkSampleCountFlagBits, std::vector<VkRenderPass>> renderPassesBySampleCount;
+            m_swapchainImageDataMap.ForEach([&](const VulkanSwapchainImageData& swapchainData) {
+                const std::vector<VkRenderPass> renderPasses = swapchainData.GetRenderPasses();
+                std::vector<VkRenderPass>& sameSampleCount = renderPassesBySampleCount[(VkSampleCountFlagBits)swapchainData.SampleCount()];
+                sameSampleCount.insert(sameSampleCount.end(), renderPasses.begin(), renderPasses.end());
+            });
+            for (const auto& renderPasses : renderPassesBySampleCount) {
+                m_pbrResources->PrecompilePipelines(renderPasses.second, renderPasses.first);
+            }
+        }
         return handle;
     }
 
@@ -2008,14 +2544,312 @@ namespace Conformance
 
     void VulkanGraphicsPlugin::RenderView(const XrCompositionLayerProjectionView& layerView,
                                           const XrSwapchainImageBaseHeader* colorSwapchainImage, const RenderParams& params)
+    {
+        XRC_TRACE_SCOPE("VulkanGraphicsPlugin::RenderView");
+        m_gpuTimers.BeginInterval(m_cmdBuffers.Begin().buf, "RenderView");
+
+        const VulkanSwapchainImageData* swapchainData = RecordView(layerView, colorSwapchainImage, params);
+
+        SubmitViews(swapchainData, !params.glTFs.empty());
+    }
+
+    void VulkanGraphicsPlugin::RenderViews(span<const XrCompositionLayerProjectionView> layerViews,
+                                           span<const XrSwapchainImageBaseHeader* const> colorSwapchainImages, const RenderParams& params)
+    {
+        assert(layerViews.size() == colorSwapchainImages.size());
+        if (!params.glTFs.empty() || layerViews.empty()) {
+            // The PBR scene constants hold a single view-projection, so glTF views must each be submitted on their own.
+            IGraphicsPlugin::RenderViews(layerViews, colorSwapchainImages, params);
+            return;
+        }
+
+        m_gpuTimers.BeginInterval(m_cmdBuffers.Begin().buf, "RenderViews");
+
+        const VulkanSwapchainImageData* swapchainData = nullptr;
+        if (GetGlobalData().options.parallelViewRecording && layerViews.size() > 1) {
+            swapchainData = RecordViewsInParallel(layerViews, colorSwapchainImages, params);
+        }
+        else {
+            for (size_t i = 0; i < layerViews.size(); ++i) {
+                swapchainData = RecordView(layerViews[i], colorSwapchainImages[i], params);
+            }
+        }
+
+        SubmitViews(swapchainData, false);
+    }
+
+    const VulkanSwapchainImageData* VulkanGraphicsPlugin::RecordViewsInParallel(
+        span<const XrCompositionLayerProjectionView> layerViews, span<const XrSwapchainImageBaseHeader* const> colorSwapchainImages,
+        const RenderParams& params)
+    {
+        const size_t viewCount = layerViews.size();
+
+        // Begin() has waited for the last submission from this ring position, so nothing recorded from its pools is pending.
+        auto& pools = m_secondaryCmdPools[m_cmdBuffers.CurrentIndex()];
+        while (pools.size() < viewCount) {
+            pools.push_back(std::make_unique<SecondaryCmdBufferPool>());
+            pools.back()->Init(m_namer, m_vkDevice, m_queueFamilyIndex);
+        }
+        for (auto& pool : pools) {
+            pool->Recycle();
+        }
+
+        // The instances are the same for every view, only their transforms differ.
+        m_meshBatches.Build(params, m_cubeMesh);
+        const size_t instanceCount = m_meshBatches.Instances().size();
+
+        struct ViewRecording
+        {
+            VulkanSwapchainImageData* swapchainData;
+            uint32_t imageArrayIndex;
+            VkRect2D renderArea;
+            VkRenderPassBeginInfo renderPassBeginInfo{VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
+            XrMatrix4x4f viewProjection;
+            StagingAllocation instanceData;
+            VkCommandBuffer secondary{VK_NULL_HANDLE};
+        };
+
+        // Anything touching shared state happens here: framebuffers are created lazily, and neither the staging pool nor the memory
+        // allocator is thread-safe.
+        std::vector<ViewRecording> views(viewCount);
+        for (size_t i = 0; i < viewCount; ++i) {
+            const XrCompositionLayerProjectionView& layerView = layerViews[i];
+            ViewRecording& view = views[i];
+
+            uint32_t imageIndex;
+            std::tie(view.swapchainData, imageIndex) = m_swapchainImageDataMap.GetDataAndIndexFromBasePointer(colorSwapchainImages[i]);
+
+            const XrRect2Di& r = layerView.subImage.imageRect;
+            view.renderArea = {{r.offset.x, r.offset.y}, {uint32_t(r.extent.width), uint32_t(r.extent.height)}};
+            view.imageArrayIndex = layerView.subImage.imageArrayIndex;
+
+            const SwapchainFormatData& secondFormatData = FindFormatData(view.swapchainData->GetDepthFormat());
+            view.swapchainData->BindRenderTarget(imageIndex, view.imageArrayIndex, view.renderArea, ComputeAspectFlags(secondFormatData),
+                                                 &view.renderPassBeginInfo);
+
+            XrMatrix4x4f proj;
+            XrMatrix4x4f_CreateProjectionFov(&proj, GRAPHICS_VULKAN, layerView.fov, 0.05f, 100.0f);
+            view.viewProjection = proj * Matrix::InvertRigidBody(Matrix::FromPose(layerView.pose));
+
+            if (instanceCount > 0) {
+                view.instanceData = m_stagingBufferPool.Allocate(instanceCount * sizeof(VulkanMeshInstance));
+            }
+        }
+
+        // Each view records from its own pool, so the threads share no command pool.
+        std::vector<std::future<void>> recordings;
+        recordings.reserve(viewCount);
+        for (size_t i = 0; i < viewCount; ++i) {
+            recordings.push_back(std::async(std::launch::async, [this, &views, &pools, i] {
+                ViewRecording& view = views[i];
+                VkCommandBufferInheritanceInfo inheritance{VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO};
+                inheritance.renderPass = view.renderPassBeginInfo.renderPass;
+                inheritance.subpass = 0;
+                inheritance.framebuffer = view.renderPassBeginInfo.framebuffer;
+                VkCommandBuffer buf = pools[i]->BeginRenderPassContinue(inheritance);
+
+                // Dynamic state is not inherited from the primary command buffer.
+                SetViewportAndScissor(buf, view.renderArea);
+                view.swapchainData->BindPipeline(buf, view.imageArrayIndex);
+                RecordMeshes(buf, view.viewProjection, view.instanceData);
+
+                XRC_CHECK_THROW_VKCMD(vkEndCommandBuffer(buf));
+                view.secondary = buf;
+            }));
+        }
+        // Every recording must finish before views goes out of scope, even if one of them throws.
+        for (auto& recording : recordings) {
+            recording.wait();
+        }
+        for (auto& recording : recordings) {
+            recording.get();
+        }
+
+        VkCommandBuffer primary = m_cmdBuffers.Current().buf;
+        for (ViewRecording& view : views) {
+            vkCmdBeginRenderPass(primary, &view.renderPassBeginInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+            vkCmdExecuteCommands(primary, 1, &view.secondary);
+            vkCmdEndRenderPass(primary);
+            if (instanceCount > 0) {
+                m_recordedInstanceData.push_back(std::move(view.instanceData));
+            }
+        }
+
+        return views.back().swapchainData;
+    }
+
+    void VulkanGraphicsPlugin::RenderDrawList(const XrCompositionLayerProjectionView& layerView,
+                                              const XrSwapchainImageBaseHeader* colorSwapchainImage, const DrawList& drawList)
+    {
+        XRC_TRACE_SCOPE("VulkanGraphicsPlugin::RenderDrawList");
+        CmdBuffer& cmdBuffer = m_cmdBuffers.Begin();
+        m_gpuTimers.BeginInterval(cmdBuffer.buf, "RenderDrawList");
+
+        VulkanSwapchainImageData* swapchainData;
+        uint32_t imageIndex;
+        std::tie(swapchainData, imageIndex) = m_swapchainImageDataMap.GetDataAndIndexFromBasePointer(colorSwapchainImage);
+
+        const XrRect2Di& r = layerView.subImage.imageRect;
+        const VkRect2D renderArea = {{r.offset.x, r.offset.y}, {uint32_t(r.extent.width), uint32_t(r.extent.height)}};
+        const uint32_t imageArrayIndex = layerView.subImage.imageArrayIndex;
+
+        const SwapchainFormatData& secondFormatData = FindFormatData(swapchainData->GetDepthFormat());
+        VkRenderPassBeginInfo renderPassBeginInfo{VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
+        swapchainData->BindRenderTarget(imageIndex, imageArrayIndex, renderArea, ComputeAspectFlags(secondFormatData),
+                                        &renderPassBeginInfo);
+
+        // The recording does not depend on the framebuffer, so is shared by all the images of the swapchain.
+        RecordedDrawList& recorded = m_recordedDrawLists[std::make_tuple(drawList.GetId(), swapchainData, imageArrayIndex)];
+        if (!recorded.Matches(drawList.GetVersion(), layerView.fov, renderArea, renderPassBeginInfo.renderPass)) {
+            RecordDrawList(recorded, drawList, layerView.fov, renderArea, swapchainData, imageArrayIndex, renderPassBeginInfo.renderPass);
+        }
+
+        vkCmdBeginRenderPass(cmdBuffer.buf, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+        vkCmdExecuteCommands(cmdBuffer.buf, 1, &recorded.buf);
+        vkCmdEndRenderPass(cmdBuffer.buf);
+
+        const uint64_t submitCount = SubmitViews(swapchainData, false);
+        recorded.lastSubmit = submitCount;
+
+        // Free the recordings of draw lists that have not been drawn for a while, such as those of helpers that are gone.
+        constexpr uint64_t kUnusedSubmitLimit = 1000;
+        const uint64_t completed = m_cmdBuffers.CompletedSubmitCount();
+        for (auto it = m_recordedDrawLists.begin(); it != m_recordedDrawLists.end();) {
+            RecordedDrawList& entry = it->second;
+            if (entry.lastSubmit + kUnusedSubmitLimit < submitCount && entry.lastSubmit <= completed) {
+                if (entry.buf != VK_NULL_HANDLE) {
+                    vkFreeCommandBuffers(m_vkDevice, m_drawListCmdPool, 1, &entry.buf);
+                }
+                entry.instances.Reset(m_vkDevice);
+                it = m_recordedDrawLists.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    void VulkanGraphicsPlugin::RecordDrawList(RecordedDrawList& recorded, const DrawList& drawList, const XrFovf& fov,
+                                              const VkRect2D& renderArea, VulkanSwapchainImageData* swapchainData, uint32_t imageArrayIndex,
+                                              VkRenderPass renderPass)
+    {
+        XRC_TRACE_SCOPE("VulkanGraphicsPlugin::RecordDrawList");
+        if (recorded.buf != VK_NULL_HANDLE && recorded.lastSubmit > m_cmdBuffers.CompletedSubmitCount()) {
+            // Only when the list or the view changes while a frame replaying it is still in flight.
+            m_cmdBuffers.WaitAll();
+        }
+
+        m_meshBatches.Build(drawList.GetParams(), m_cubeMesh);
+        const size_t instanceCount = m_meshBatches.Instances().size();
+        if (instanceCount > recorded.instanceCapacity) {
+            recorded.instances.Reset(m_vkDevice);
+            recorded.instances.Create<VulkanMeshInstance>(m_vkDevice, m_memAllocator, (uint32_t)instanceCount,
+                                                          VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+            XRC_CHECK_THROW(recorded.instances.memory.mapped != nullptr);
+            recorded.instanceCapacity = instanceCount;
+        }
+
+        if (m_drawListCmdPool == VK_NULL_HANDLE) {
+            VkCommandPoolCreateInfo cmdPoolInfo{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+            cmdPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+            cmdPoolInfo.queueFamilyIndex = m_queueFamilyIndex;
+            XRC_CHECK_THROW_VKCMD(vkCreateCommandPool(m_vkDevice, &cmdPoolInfo, nullptr, &m_drawListCmdPool));
+            XRC_CHECK_THROW_VKCMD(m_namer.SetName(VK_OBJECT_TYPE_COMMAND_POOL, (uint64_t)m_drawListCmdPool, "CTS draw list command pool"));
+        }
+        if (recorded.buf == VK_NULL_HANDLE) {
+            VkCommandBufferAllocateInfo cmd{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+            cmd.commandPool = m_drawListCmdPool;
+            cmd.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+            cmd.commandBufferCount = 1;
+            XRC_CHECK_THROW_VKCMD(vkAllocateCommandBuffers(m_vkDevice, &cmd, &recorded.buf));
+            XRC_CHECK_THROW_VKCMD(m_namer.SetName(VK_OBJECT_TYPE_COMMAND_BUFFER, (uint64_t)recorded.buf, "CTS draw list command buffer"));
+        }
+        else {
+            XRC_CHECK_THROW_VKCMD(vkResetCommandBuffer(recorded.buf, 0));
+        }
+        // Mark it unrecorded until it is recorded in full, in case recording throws.
+        recorded.version = 0;
+
+        // Any framebuffer of the render pass may be used, and several submissions in flight may execute the same recording.
+        VkCommandBufferInheritanceInfo inheritance{VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO};
+        inheritance.renderPass = renderPass;
+        inheritance.subpass = 0;
+        inheritance.framebuffer = VK_NULL_HANDLE;
+        VkCommandBufferBeginInfo cmdBeginInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+        cmdBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+        cmdBeginInfo.pInheritanceInfo = &inheritance;
+        XRC_CHECK_THROW_VKCMD(vkBeginCommandBuffer(recorded.buf, &cmdBeginInfo));
+
+        // Dynamic state is not inherited from the primary command buffer.
+        SetViewportAndScissor(recorded.buf, renderArea);
+        swapchainData->BindPipeline(recorded.buf, imageArrayIndex);
+
+        // The drawables are posed in view space, so only the projection depends on the view.
+        XrMatrix4x4f proj;
+        XrMatrix4x4f_CreateProjectionFov(&proj, GRAPHICS_VULKAN, fov, 0.05f, 100.0f);
+        RecordMeshes(recorded.buf, proj, recorded.instances.memory.mapped, recorded.instances.buf, 0);
+
+        XRC_CHECK_THROW_VKCMD(vkEndCommandBuffer(recorded.buf));
+
+        recorded.version = drawList.GetVersion();
+        recorded.fov = fov;
+        recorded.renderArea = renderArea;
+        recorded.renderPass = renderPass;
+    }
+
+    void VulkanGraphicsPlugin::ResetRecordedDrawLists()
+    {
+        for (auto& entry : m_recordedDrawLists) {
+            entry.second.instances.Reset(m_vkDevice);
+        }
+        m_recordedDrawLists.clear();
+        // Destroying the pool frees its command buffers.
+        if (m_drawListCmdPool != VK_NULL_HANDLE) {
+            vkDestroyCommandPool(m_vkDevice, m_drawListCmdPool, nullptr);
+            m_drawListCmdPool = VK_NULL_HANDLE;
+        }
+    }
+
+    void VulkanGraphicsPlugin::RecordMeshes(VkCommandBuffer buf, const XrMatrix4x4f& viewProjection, void* instanceMap,
+                                            VkBuffer instanceBuffer, VkDeviceSize instanceOffset) const
+    {
+        const std::vector<MeshDrawable>& instances = m_meshBatches.Instances();
+        if (instances.empty()) {
+            return;
+        }
+
+        // The draws read the per-instance data directly from host-visible memory.
+        VulkanMeshInstance* instanceData = reinterpret_cast<VulkanMeshInstance*>(instanceMap);
+        for (size_t i = 0; i < instances.size(); ++i) {
+            const MeshDrawable& mesh = instances[i];
+            XrMatrix4x4f model =
+                Matrix::FromTranslationRotationScale(mesh.params.pose.position, mesh.params.pose.orientation, mesh.params.scale);
+            instanceData[i] = VulkanMeshInstance{viewProjection * model, mesh.tintColor};
+        }
+
+        vkCmdBindVertexBuffers(buf, 1, 1, &instanceBuffer, &instanceOffset);
+
+        // Draw all instances of each mesh with a single call.
+        for (const MeshInstanceBatches::Batch& batch : m_meshBatches.Batches()) {
+            const VulkanMesh& vkMesh = m_meshes[batch.handle];
+
+            vkCmdBindIndexBuffer(buf, vkMesh.m_DrawBuffer.idx.buf, 0, VK_INDEX_TYPE_UINT16);
+            VkDeviceSize offset = 0;
+            vkCmdBindVertexBuffers(buf, 0, 1, &vkMesh.m_DrawBuffer.vtx.buf, &offset);
+            vkCmdDrawIndexed(buf, vkMesh.m_DrawBuffer.count.idx, batch.instanceCount, 0, 0, batch.firstInstance);
+        }
+    }
+
+    VulkanSwapchainImageData* VulkanGraphicsPlugin::RecordView(const XrCompositionLayerProjectionView& layerView,
+                                                               const XrSwapchainImageBaseHeader* colorSwapchainImage,
+                                                               const RenderParams& params)
     {
         VulkanSwapchainImageData* swapchainData;
         uint32_t imageIndex;
 
         std::tie(swapchainData, imageIndex) = m_swapchainImageDataMap.GetDataAndIndexFromBasePointer(colorSwapchainImage);
 
-        m_cmdBuffer.Clear();
-        m_cmdBuffer.Begin();
+        CmdBuffer& cmdBuffer = m_cmdBuffers.Current();
 
         CHECKPOINT();
 
@@ -2036,11 +2870,11 @@ namespace Conformance
 
         swapchainData->BindRenderTarget(imageIndex, imageArrayIndex, renderArea, secondAttachmentAspect, &renderPassBeginInfo);
 
-        vkCmdBeginRenderPass(m_cmdBuffer.buf, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+        vkCmdBeginRenderPass(cmdBuffer.buf, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
         CHECKPOINT();
 
-        swapchainData->BindPipeline(m_cmdBuffer.buf, imageArrayIndex);
+        swapchainData->BindPipeline(cmdBuffer.buf, imageArrayIndex);
 
         CHECKPOINT();
 
@@ -2052,49 +2886,15 @@ namespace Conformance
         XrMatrix4x4f toView = Matrix::FromPose(pose);
         XrMatrix4x4f view = Matrix::InvertRigidBody(toView);
         XrMatrix4x4f vp = proj * view;
-        MeshHandle lastMeshHandle;
-
-        const auto drawMesh = [this, &vp, &lastMeshHandle](const MeshDrawable mesh) {
-            VulkanMesh& vkMesh = m_meshes[mesh.handle];
-            if (mesh.handle != lastMeshHandle) {
-                // We are now rendering a new mesh
-
-                // Bind index and vertex buffers
-                vkCmdBindIndexBuffer(m_cmdBuffer.buf, vkMesh.m_DrawBuffer.idx.buf, 0, VK_INDEX_TYPE_UINT16);
-
-                CHECKPOINT();
 
-                VkDeviceSize offset = 0;
-                vkCmdBindVertexBuffers(m_cmdBuffer.buf, 0, 1, &vkMesh.m_DrawBuffer.vtx.buf, &offset);
-
-                CHECKPOINT();
-                lastMeshHandle = mesh.handle;
-            }
-
-            // Compute the model-view-projection transform and push it.
-            XrMatrix4x4f model =
-                Matrix::FromTranslationRotationScale(mesh.params.pose.position, mesh.params.pose.orientation, mesh.params.scale);
-            VulkanUniformBuffer ubuf;
-            ubuf.tintColor = mesh.tintColor;
-            ubuf.mvp = vp * model;
-            vkCmdPushConstants(m_cmdBuffer.buf, m_pipelineLayout.layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(VulkanUniformBuffer), &ubuf);
+        // Draw all cubes and meshes, instanced per mesh.
+        m_meshBatches.Build(params, m_cubeMesh);
+        if (!m_meshBatches.Instances().empty()) {
+            StagingAllocation instanceData = m_stagingBufferPool.Allocate(m_meshBatches.Instances().size() * sizeof(VulkanMeshInstance));
+            RecordMeshes(cmdBuffer.buf, vp, instanceData);
+            m_recordedInstanceData.push_back(std::move(instanceData));
 
             CHECKPOINT();
-
-            // Draw the mesh.
-            vkCmdDrawIndexed(m_cmdBuffer.buf, vkMesh.m_DrawBuffer.count.idx, 1, 0, 0, 0);
-
-            CHECKPOINT();
-        };
-
-        // Render each cube
-        for (const Cube& cube : params.cubes) {
-            drawMesh(MeshDrawable{m_cubeMesh, cube.params.pose, cube.params.scale, cube.tintColor});
-        }
-
-        // Render each mesh
-        for (const auto& mesh : params.meshes) {
-            drawMesh(mesh);
         }
 
         // Render each gltf
@@ -2108,30 +2908,43 @@ namespace Conformance
             // XrMatrix4x4f viewMatrixInverse = Matrix::InvertRigidBody(viewMatrix);
             m_pbrResources->SetViewProjection(view, proj);
 
-            gltf.Render(m_cmdBuffer, *m_pbrResources, modelToWorld, renderPassBeginInfo.renderPass,
+            gltf.Render(cmdBuffer, *m_pbrResources, modelToWorld, renderPassBeginInfo.renderPass,
                         (VkSampleCountFlagBits)swapchainData->GetCreateInfo().sampleCount);
         }
 
-        vkCmdEndRenderPass(m_cmdBuffer.buf);
+        vkCmdEndRenderPass(cmdBuffer.buf);
 
         CHECKPOINT();
 
+        return swapchainData;
+    }
+
+    uint64_t VulkanGraphicsPlugin::SubmitViews(const VulkanSwapchainImageData* lastSwapchainData, bool drewGLTFs)
+    {
         m_pbrResources->SubmitFrameResources(m_vkQueue);
 
-        m_cmdBuffer.End();
-        m_cmdBuffer.Exec(m_vkQueue);
-        // XXX Should double-buffer the command buffers, for now just flush
-        m_cmdBuffer.Wait();
+        m_gpuTimers.EndInterval(m_cmdBuffers.Current().buf);
+        const uint64_t submitCount = m_cmdBuffers.Submit(m_vkQueue, drewGLTFs);
+        m_gpuTimers.Submitted(submitCount);
+        for (StagingAllocation& instanceData : m_recordedInstanceData) {
+            m_stagingDestructionQueue.PushResource(submitCount, std::move(instanceData));
+        }
+        m_recordedInstanceData.clear();
+        m_stagingDestructionQueue.ReleaseForFenceValue(m_cmdBuffers.CompletedSubmitCount());
+        m_gpuTimers.ResolveIntervals(m_cmdBuffers.CompletedSubmitCount());
 
         m_pbrResources->Wait();
 
 #if defined(USE_MIRROR_WINDOW)
         // Cycle the window's swapchain on the last view rendered
-        if (swapchainData == &m_swapchainImageData.back()) {
+        if (lastSwapchainData == &m_swapchainImageData.back()) {
             m_swapchain.Acquire();
             m_swapchain.Present(m_vkQueue);
         }
+#else
+        (void)lastSwapchainData;
 #endif
+        return submitCount;
     }
 
 #if defined(USE_CHECKPOINTS)
@@ -0,0 +1,114 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "input_script.h"
+
+#include <fstream>
+#include <sstream>
+
+namespace Conformance
+{
+    namespace
+    {
+        bool ParseStep(const std::string& line, InputScriptStep* step)
+        {
+            std::istringstream in(line);
+            std::string kind;
+            in >> kind;
+            if (kind == "delay") {
+                long long milliseconds = -1;
+                in >> milliseconds;
+                step->kind = InputScriptStep::Kind::Delay;
+                step->delay = std::chrono::milliseconds(milliseconds);
+                if (milliseconds < 0) {
+                    return false;
+                }
+            }
+            else if (kind == "active") {
+                step->kind = InputScriptStep::Kind::Active;
+                in >> step->topLevelPath >> step->value.x;
+            }
+            else if (kind == "boolean") {
+                step->kind = InputScriptStep::Kind::Boolean;
+                in >> step->topLevelPath >> step->inputPath >> step->value.x;
+            }
+            else if (kind == "float") {
+                step->kind = InputScriptStep::Kind::Float;
+                in >> step->topLevelPath >> step->inputPath >> step->value.x;
+            }
+            else if (kind == "vector2") {
+                step->kind = InputScriptStep::Kind::Vector2;
+                in >> step->topLevelPath >> step->inputPath >> step->value.x >> step->value.y;
+            }
+            else {
+                return false;
+            }
+
+            // Nothing may be missing, and nothing may follow.
+            std::string rest;
+            return !in.fail() && !(in >> rest);
+        }
+    }  // namespace
+
+    bool InputScript::Load(const std::string& path, std::string* error)
+    {
+        std::ifstream file(path);
+        if (!file) {
+            *error = "cannot open " + path;
+            return false;
+        }
+        return Parse(file, error);
+    }
+
+    bool InputScript::Parse(std::istream& in, std::string* error)
+    {
+        m_steps.clear();
+        m_next = 0;
+        m_loaded = false;
+
+        std::string line;
+        for (size_t lineNumber = 1; std::getline(in, line); ++lineNumber) {
+            const size_t start = line.find_first_not_of(" \t\r");
+            if (start == std::string::npos || line[start] == '#') {
+                continue;
+            }
+
+            InputScriptStep step;
+            step.line = lineNumber;
+            if (!ParseStep(line, &step)) {
+                *error = "cannot parse line " + std::to_string(lineNumber) + ": " + line;
+                m_steps.clear();
+                return false;
+            }
+            m_steps.push_back(std::move(step));
+        }
+
+        m_loaded = true;
+        return true;
+    }
+
+    std::vector<InputScriptStep> InputScript::TakeStepsUntil(const InputScriptStep& request)
+    {
+        for (size_t i = m_next; i < m_steps.size(); ++i) {
+            if (m_steps[i].Performs(request)) {
+                std::vector<InputScriptStep> taken(m_steps.begin() + m_next, m_steps.begin() + i + 1);
+                m_next = i + 1;
+                return taken;
+            }
+        }
+        return {};
+    }
+}  // namespace Conformance
@@ -0,0 +1,105 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <openxr/openxr.h>
+
+#include <chrono>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace Conformance
+{
+    /// One step of an InputScript, or a request from an interactive test to be matched against one.
+    struct InputScriptStep
+    {
+        enum class Kind
+        {
+            Delay,
+            Active,
+            Boolean,
+            Float,
+            Vector2,
+        };
+
+        Kind kind{Kind::Delay};
+        std::chrono::milliseconds delay{0};
+        std::string topLevelPath;
+        /// Empty for Delay and Active steps
+        std::string inputPath;
+        /// The state set: 0 or 1 for Active and Boolean steps, x and y for Vector2 steps
+        XrVector2f value{0, 0};
+        /// Line of the script the step was read from, 0 for requests
+        size_t line{0};
+
+        /// True if this step performs @p request: the same kind of step on the same input, whatever the state.
+        bool Performs(const InputScriptStep& request) const
+        {
+            return kind == request.kind && topLevelPath == request.topLevelPath && inputPath == request.inputPath;
+        }
+    };
+
+    /// A timeline of input for the interactive tests to replay through XR_EXT_conformance_automation instead of waiting
+    /// for a person, so that they can run unattended. See Options::inputScript.
+    ///
+    /// The script is a text file with one step per line, performed in order:
+    ///
+    ///     delay <milliseconds>
+    ///     active <top level path> 0|1
+    ///     boolean <top level path> <input path> 0|1
+    ///     float <top level path> <input path> <value>
+    ///     vector2 <top level path> <input path> <x> <y>
+    ///
+    /// Blank lines and lines starting with `#` are ignored. When a test asks a device for some input, the steps up to and
+    /// including the next one that performs it are taken, so a script lists what an operator would do in answer to each
+    /// prompt, along with anything they would do in between. Requests no step performs are performed as asked.
+    class InputScript
+    {
+    public:
+        InputScript() = default;
+
+        InputScript(const InputScript&) = delete;
+        InputScript& operator=(const InputScript&) = delete;
+
+        /// Read the steps from @p path. Returns false, with the reason in @p error, if it cannot be read or parsed.
+        bool Load(const std::string& path, std::string* error);
+
+        /// Read the steps from @p in. Returns false, with the reason in @p error, if a line cannot be parsed.
+        bool Parse(std::istream& in, std::string* error);
+
+        bool IsLoaded() const
+        {
+            return m_loaded;
+        }
+
+        /// Return the steps from the current one up to and including the next that performs @p request, and move past them.
+        /// Returns nothing, and stays put, if no later step performs it.
+        std::vector<InputScriptStep> TakeStepsUntil(const InputScriptStep& request);
+
+        /// Number of steps not yet taken.
+        size_t GetRemainingCount() const
+        {
+            return m_steps.size() - m_next;
+        }
+
+    private:
+        std::vector<InputScriptStep> m_steps;
+        size_t m_next{0};
+        bool m_loaded{false};
+    };
+}  // namespace Conformance
@@ -19,6 +19,7 @@
 #include "composition_utils.h"
 #include "conformance_framework.h"
 #include "conformance_utils.h"
+#include "input_script.h"
 #include "two_call.h"
 #include "utilities/throw_helpers.h"
 #include "utilities/types_and_constants.h"
@@ -35,6 +36,7 @@
 #include <cstring>
 #include <functional>
 #include <ratio>
+#include <string>
 #include <tuple>
 #include <utility>
 
@@ -58,6 +60,9 @@ static constexpr std::chrono::nanoseconds waitDelay = 5ms;
 
 static constexpr std::chrono::nanoseconds instructionDelay = 250ms;
 
+// How long a device must stay in the state waited for, so that a person's unsteady input is not taken for it.
+static constexpr std::chrono::nanoseconds humanStableDuration = 250ms;
+
 namespace Conformance
 {
     class HumanDrivenInputdevice : public IInputTestDevice
@@ -72,6 +77,7 @@ namespace Conformance
             , m_interactionProfile(interactionProfile)
             , m_topLevelPath(topLevelPath)
             , m_conformanceAutomationExtensionEnabled(GetGlobalData().IsUsingConformanceAutomation())
+            , m_inputScript(GetGlobalData().inputScript.IsLoaded() ? &GetGlobalData().inputScript : nullptr)
         {
             m_actionSet = actionSet;
             m_actionMap = actionMap;
@@ -89,6 +95,7 @@ namespace Conformance
             , m_interactionProfile(interactionProfile)
             , m_topLevelPath(topLevelPath)
             , m_conformanceAutomationExtensionEnabled(GetGlobalData().IsUsingConformanceAutomation())
+            , m_inputScript(GetGlobalData().inputScript.IsLoaded() ? &GetGlobalData().inputScript : nullptr)
         {
             std::string actionSetName = "test_device_action_set_" + std::to_string(m_topLevelPath);
             std::string localizedActionSetName = "Test Device Action Set " + std::to_string(m_topLevelPath);
@@ -240,8 +247,8 @@ namespace Conformance
                                 if (findController() != desiredControllerState) {
                                     timeSinceStateChanged = std::chrono::high_resolution_clock::now();
                                 }
-                                else if (std::chrono::high_resolution_clock::now() - timeSinceStateChanged > 250ms) {
-                                    return true;  // Only return true when the controller has been stably active for 250ms.
+                                else if (std::chrono::high_resolution_clock::now() - timeSinceStateChanged > StableDuration()) {
+                                    return true;  // Only return true when the controller has been stably active for a while.
                                 }
                                 m_messageDisplay->IterateFrame();
 
@@ -283,8 +290,8 @@ namespace Conformance
                                 if ((checkTracking() & XR_SPACE_LOCATION_ORIENTATION_VALID_BIT) != desiredFlags) {
                                     timeSinceStateChanged = std::chrono::high_resolution_clock::now();
                                 }
-                                else if (std::chrono::high_resolution_clock::now() - timeSinceStateChanged > 250ms) {
-                                    return true;  // Only return true when the controller has been stably locatable for 250ms.
+                                else if (std::chrono::high_resolution_clock::now() - timeSinceStateChanged > StableDuration()) {
+                                    return true;  // Only return true when the controller has been stably locatable for a while.
                                 }
                                 m_messageDisplay->IterateFrame();
 
@@ -300,7 +307,8 @@ namespace Conformance
         void SetDeviceActiveViaConformanceAutomationIfPossible(bool state) const
         {
 
-            if (m_conformanceAutomationExtensionEnabled) {
+            if (m_conformanceAutomationExtensionEnabled &&
+                !PlayInputScript({InputScriptStep::Kind::Active, {}, PathString(m_topLevelPath), {}, {state ? 1.0f : 0.0f, 0}})) {
                 PFN_xrSetInputDeviceActiveEXT xrSetInputDeviceActiveEXT{nullptr};
                 XRC_CHECK_THROW_XRCMD_UNQUALIFIED_SUCCESS(
                     xrGetInstanceProcAddr(m_instance, "xrSetInputDeviceActiveEXT", (PFN_xrVoidFunction*)&xrSetInputDeviceActiveEXT));
@@ -340,7 +348,9 @@ namespace Conformance
 
         void SetButtonStateBool(XrPath button, bool state, bool skipInteraction, XrActionSet extraActionSet = XR_NULL_HANDLE) override
         {
-            if (m_conformanceAutomationExtensionEnabled) {
+            const XrVector2f scriptValue{state ? 1.0f : 0.0f, 0};
+            if (m_conformanceAutomationExtensionEnabled &&
+                !PlayInputScript({InputScriptStep::Kind::Boolean, {}, PathString(m_topLevelPath), PathString(button), scriptValue})) {
                 PFN_xrSetInputDeviceStateBoolEXT xrSetInputDeviceStateBoolEXT{nullptr};
                 REQUIRE_RESULT(
                     xrGetInstanceProcAddr(m_instance, "xrSetInputDeviceStateBoolEXT", (PFN_xrVoidFunction*)&xrSetInputDeviceStateBoolEXT),
@@ -353,14 +363,16 @@ namespace Conformance
                 return;
             }
 
-            // Blank the instructions briefly before showing the new instructions.
+            // Blank the instructions briefly before showing the new instructions, unless nobody is reading them.
             m_messageDisplay->DisplayMessage("");
-            WaitUntilPredicateWithTimeout(
-                [&] {
-                    m_messageDisplay->IterateFrame();
-                    return false;
-                },
-                instructionDelay, waitDelay);
+            if (m_inputScript == nullptr) {
+                WaitUntilPredicateWithTimeout(
+                    [&] {
+                        m_messageDisplay->IterateFrame();
+                        return false;
+                    },
+                    instructionDelay, waitDelay);
+            }
 
             std::vector<char> humanReadableName = CHECK_TWO_CALL(char, {}, xrPathToString, m_instance, button);
 
@@ -406,7 +418,8 @@ namespace Conformance
         void SetButtonStateFloat(XrPath button, float state, float epsilon, bool skipInteraction = false,
                                  XrActionSet extraActionSet = XR_NULL_HANDLE) override
         {
-            if (m_conformanceAutomationExtensionEnabled) {
+            if (m_conformanceAutomationExtensionEnabled &&
+                !PlayInputScript({InputScriptStep::Kind::Float, {}, PathString(m_topLevelPath), PathString(button), {state, 0}})) {
                 PFN_xrSetInputDeviceStateFloatEXT xrSetInputDeviceStateFloatEXT{nullptr};
                 REQUIRE_RESULT(
                     xrGetInstanceProcAddr(m_instance, "xrSetInputDeviceStateFloatEXT", (PFN_xrVoidFunction*)&xrSetInputDeviceStateFloatEXT),
@@ -419,14 +432,16 @@ namespace Conformance
                 return;
             }
 
-            // Blank the instructions briefly before showing the new instructions.
+            // Blank the instructions briefly before showing the new instructions, unless nobody is reading them.
             m_messageDisplay->DisplayMessage("");
-            WaitUntilPredicateWithTimeout(
-                [&] {
-                    m_messageDisplay->IterateFrame();
-                    return false;
-                },
-                instructionDelay, waitDelay);
+            if (m_inputScript == nullptr) {
+                WaitUntilPredicateWithTimeout(
+                    [&] {
+                        m_messageDisplay->IterateFrame();
+                        return false;
+                    },
+                    instructionDelay, waitDelay);
+            }
 
             std::vector<char> humanReadableName = CHECK_TWO_CALL(char, {}, xrPathToString, m_instance, button);
 
@@ -474,7 +489,8 @@ namespace Conformance
         void SetButtonStateVector2(XrPath button, XrVector2f state, float epsilon, bool skipInteraction = false,
                                    XrActionSet extraActionSet = XR_NULL_HANDLE) override
         {
-            if (m_conformanceAutomationExtensionEnabled) {
+            if (m_conformanceAutomationExtensionEnabled &&
+                !PlayInputScript({InputScriptStep::Kind::Vector2, {}, PathString(m_topLevelPath), PathString(button), state})) {
                 PFN_xrSetInputDeviceStateVector2fEXT xrSetInputDeviceStateVector2fEXT{nullptr};
                 REQUIRE_RESULT(xrGetInstanceProcAddr(m_instance, "xrSetInputDeviceStateVector2fEXT",
                                                      (PFN_xrVoidFunction*)&xrSetInputDeviceStateVector2fEXT),
@@ -487,14 +503,16 @@ namespace Conformance
                 return;
             }
 
-            // Blank the instructions briefly before showing the new instructions.
+            // Blank the instructions briefly before showing the new instructions, unless nobody is reading them.
             m_messageDisplay->DisplayMessage("");
-            WaitUntilPredicateWithTimeout(
-                [&] {
-                    m_messageDisplay->IterateFrame();
-                    return false;
-                },
-                instructionDelay, waitDelay);
+            if (m_inputScript == nullptr) {
+                WaitUntilPredicateWithTimeout(
+                    [&] {
+                        m_messageDisplay->IterateFrame();
+                        return false;
+                    },
+                    instructionDelay, waitDelay);
+            }
 
             std::vector<char> humanReadableName = CHECK_TWO_CALL(char, {}, xrPathToString, m_instance, button);
 
@@ -543,12 +561,85 @@ namespace Conformance
         }
 
     private:
+        std::chrono::nanoseconds StableDuration() const
+        {
+            // Scripted input does not waver.
+            return m_inputScript != nullptr ? 0ns : humanStableDuration;
+        }
+
+        std::string PathString(XrPath path) const
+        {
+            return std::string(CHECK_TWO_CALL(char, {}, xrPathToString, m_instance, path).data());
+        }
+
+        /// Perform the steps of the input script up to and including the one that performs @p request.
+        /// Returns false, having done nothing, if there is no script or none of its remaining steps performs @p request.
+        bool PlayInputScript(const InputScriptStep& request) const
+        {
+            if (m_inputScript == nullptr) {
+                return false;
+            }
+            const std::vector<InputScriptStep> steps = m_inputScript->TakeStepsUntil(request);
+            for (const InputScriptStep& step : steps) {
+                const XrPath topLevelPath = step.topLevelPath.empty() ? XR_NULL_PATH : StringToPath(m_instance, step.topLevelPath);
+                const XrPath inputPath = step.inputPath.empty() ? XR_NULL_PATH : StringToPath(m_instance, step.inputPath);
+                INFO("Input script line " << step.line);
+                switch (step.kind) {
+                case InputScriptStep::Kind::Delay:
+                    // Keep submitting frames, as a person taking their time would see them.
+                    WaitUntilPredicateWithTimeout(
+                        [&] {
+                            m_messageDisplay->IterateFrame();
+                            return false;
+                        },
+                        step.delay, waitDelay);
+                    break;
+                case InputScriptStep::Kind::Active: {
+                    PFN_xrSetInputDeviceActiveEXT xrSetInputDeviceActiveEXT{nullptr};
+                    XRC_CHECK_THROW_XRCMD_UNQUALIFIED_SUCCESS(
+                        xrGetInstanceProcAddr(m_instance, "xrSetInputDeviceActiveEXT", (PFN_xrVoidFunction*)&xrSetInputDeviceActiveEXT));
+                    XRC_CHECK_THROW_XRCMD_UNQUALIFIED_SUCCESS(
+                        xrSetInputDeviceActiveEXT(m_session, m_interactionProfile, topLevelPath, (XrBool32)(step.value.x != 0)));
+                    break;
+                }
+                case InputScriptStep::Kind::Boolean: {
+                    PFN_xrSetInputDeviceStateBoolEXT xrSetInputDeviceStateBoolEXT{nullptr};
+                    REQUIRE_RESULT(xrGetInstanceProcAddr(m_instance, "xrSetInputDeviceStateBoolEXT",
+                                                         (PFN_xrVoidFunction*)&xrSetInputDeviceStateBoolEXT),
+                                   XR_SUCCESS);
+                    REQUIRE_RESULT(xrSetInputDeviceStateBoolEXT(m_session, topLevelPath, inputPath, (XrBool32)(step.value.x != 0)),
+                                   XR_SUCCESS);
+                    break;
+                }
+                case InputScriptStep::Kind::Float: {
+                    PFN_xrSetInputDeviceStateFloatEXT xrSetInputDeviceStateFloatEXT{nullptr};
+                    REQUIRE_RESULT(xrGetInstanceProcAddr(m_instance, "xrSetInputDeviceStateFloatEXT",
+                                                         (PFN_xrVoidFunction*)&xrSetInputDeviceStateFloatEXT),
+                                   XR_SUCCESS);
+                    REQUIRE_RESULT(xrSetInputDeviceStateFloatEXT(m_session, topLevelPath, inputPath, step.value.x), XR_SUCCESS);
+                    break;
+                }
+                case InputScriptStep::Kind::Vector2: {
+                    PFN_xrSetInputDeviceStateVector2fEXT xrSetInputDeviceStateVector2fEXT{nullptr};
+                    REQUIRE_RESULT(xrGetInstanceProcAddr(m_instance, "xrSetInputDeviceStateVector2fEXT",
+                                                         (PFN_xrVoidFunction*)&xrSetInputDeviceStateVector2fEXT),
+                                   XR_SUCCESS);
+                    REQUIRE_RESULT(xrSetInputDeviceStateVector2fEXT(m_session, topLevelPath, inputPath, step.value), XR_SUCCESS);
+                    break;
+                }
+                }
+            }
+            return !steps.empty();
+        }
+
         ITestMessageDisplay* const m_messageDisplay;
         const XrInstance m_instance;
         const XrSession m_session;
         const XrPath m_interactionProfile;
         const XrPath m_topLevelPath;
         const bool m_conformanceAutomationExtensionEnabled{false};
+        /// The loaded Options::inputScript, if any
+        InputScript* const m_inputScript{nullptr};
         XrActionSet m_actionSet;
         std::map<XrPath, XrAction> m_actionMap;
 
@@ -0,0 +1,47 @@
+// Copyright (c) 2017-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "interaction_info.h"
+
+#include "utilities/throw_helpers.h"
+
+#include <openxr/openxr.h>
+
+#include <string>
+#include <unordered_map>
+
+namespace Conformance
+{
+    const InteractionProfileAvailMetadata* FindInteractionProfile(const std::string& pathOrShortname)
+    {
+        // Built once from the generated table, which never changes.
+        static const std::unordered_map<std::string, const InteractionProfileAvailMetadata*> profilesByName = [] {
+            std::unordered_map<std::string, const InteractionProfileAvailMetadata*> ret;
+            for (const InteractionProfileAvailMetadata& profile : GetAllInteractionProfiles()) {
+                ret.emplace(profile.InteractionProfilePathString, &profile);
+                ret.emplace(profile.InteractionProfileShortname, &profile);
+            }
+            return ret;
+        }();
+
+        auto it = profilesByName.find(pathOrShortname);
+        if (it == profilesByName.end()) {
+            return nullptr;
+        }
+        return it->second;
+    }
+
+    XrPath InteractionPathCache::GetPath(const char* pathString)
+    {
+        auto it = m_paths.find(pathString);
+        if (it != m_paths.end()) {
+            return it->second;
+        }
+
+        XrPath path = XR_NULL_PATH;
+        XRC_CHECK_THROW_XRCMD(xrStringToPath(m_instance, pathString, &path));
+        m_paths.emplace(pathString, path);
+        return path;
+    }
+}  // namespace Conformance
@@ -6,6 +6,12 @@
 
 #include "interaction_info_generated.h"
 
+#include <openxr/openxr.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 namespace Conformance
 {
     struct InputSourcePathAvailData
@@ -42,4 +48,36 @@ namespace Conformance
     {
         return GetInteractionProfile(InteractionProfileIndex::Profile_khr_simple_controller);
     }
+
+    /// Look up an interaction profile by its full path string or its shortname (case sensitive).
+    /// Returns nullptr if the profile is not known.
+    const InteractionProfileAvailMetadata* FindInteractionProfile(const std::string& pathOrShortname);
+
+    /// Converts the path strings of the interaction profile tables to XrPath for one instance, calling
+    /// xrStringToPath only the first time each string is requested.
+    /// Must not outlive the instance.
+    class InteractionPathCache
+    {
+    public:
+        explicit InteractionPathCache(XrInstance instance) : m_instance(instance)
+        {
+        }
+
+        /// Returns the XrPath for @p pathString. Throws if xrStringToPath fails.
+        XrPath GetPath(const char* pathString);
+
+        XrPath GetInteractionProfilePath(const InteractionProfileAvailMetadata& profile)
+        {
+            return GetPath(profile.InteractionProfilePathString);
+        }
+
+        XrPath GetInputSourcePath(const InputSourcePathAvailData& inputSource)
+        {
+            return GetPath(inputSource.Path);
+        }
+
+    private:
+        XrInstance m_instance;
+        std::unordered_map<std::string, XrPath> m_paths;
+    };
 }  // namespace Conformance
@@ -0,0 +1,150 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "latency_probe.h"
+
+#include "conformance_framework.h"
+#include "report.h"
+#include "utilities/throw_helpers.h"
+
+// Include all dependencies of openxr_platform as configured
+#include "common/xr_dependencies.h"
+#include <openxr/openxr_platform.h>
+
+#ifdef XR_USE_PLATFORM_WIN32
+#include <windows.h>
+#endif
+
+#include <string>
+#include <time.h>
+
+namespace Conformance
+{
+    namespace
+    {
+        /// Read the platform clock that XrTime converts from right next to the steady clock, which is the same clock with
+        /// another epoch, and convert it to XrTime.
+        bool TryConvertNow(XrInstance instance, XrTime& xrNow, std::chrono::steady_clock::time_point& steadyNow)
+        {
+            PFN_xrVoidFunction function = nullptr;
+#if defined(XR_USE_PLATFORM_WIN32)
+            if (XR_FAILED(xrGetInstanceProcAddr(instance, "xrConvertWin32PerformanceCounterToTimeKHR", &function))) {
+                return false;
+            }
+            LARGE_INTEGER counter;
+            QueryPerformanceCounter(&counter);
+            steadyNow = std::chrono::steady_clock::now();
+            XRC_CHECK_THROW_XRCMD(reinterpret_cast<PFN_xrConvertWin32PerformanceCounterToTimeKHR>(function)(instance, &counter, &xrNow));
+            return true;
+#elif defined(XR_USE_TIMESPEC)
+            if (XR_FAILED(xrGetInstanceProcAddr(instance, "xrConvertTimespecTimeToTimeKHR", &function))) {
+                return false;
+            }
+            timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            steadyNow = std::chrono::steady_clock::now();
+            XRC_CHECK_THROW_XRCMD(reinterpret_cast<PFN_xrConvertTimespecTimeToTimeKHR>(function)(instance, &ts, &xrNow));
+            return true;
+#else
+            (void)instance;
+            (void)function;
+            (void)xrNow;
+            (void)steadyNow;
+            return false;
+#endif
+        }
+    }  // namespace
+
+    const char* LatencyProbe::GetTimeConversionExtensionName()
+    {
+#if defined(XR_USE_PLATFORM_WIN32)
+        return XR_KHR_WIN32_CONVERT_PERFORMANCE_COUNTER_TIME_EXTENSION_NAME;
+#elif defined(XR_USE_TIMESPEC)
+        return XR_KHR_CONVERT_TIMESPEC_TIME_EXTENSION_NAME;
+#else
+        return nullptr;
+#endif
+    }
+
+    std::unique_ptr<LatencyProbe> LatencyProbe::TryCreate(XrInstance instance)
+    {
+        XrTime xrNow = 0;
+        std::chrono::steady_clock::time_point steadyNow;
+        if (!TryConvertNow(instance, xrNow, steadyNow)) {
+            return nullptr;
+        }
+        const XrDuration steadyNs = std::chrono::duration_cast<std::chrono::nanoseconds>(steadyNow.time_since_epoch()).count();
+        return std::unique_ptr<LatencyProbe>(new LatencyProbe(xrNow - steadyNs));
+    }
+
+    XrTime LatencyProbe::Now() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count() +
+               m_steadyClockToXrTime;
+    }
+
+    void LatencyProbe::OnViewsLocated(XrTime displayTime)
+    {
+        // Keep the first location of a frame: rendering may locate again, but the oldest pose bounds the latency.
+        if (displayTime != m_locateDisplayTime) {
+            m_locateDisplayTime = displayTime;
+            m_locateTime = Now();
+        }
+    }
+
+    void LatencyProbe::OnFrameSubmitted(XrTime displayTime)
+    {
+        const XrTime locateTime = displayTime == m_locateDisplayTime ? m_locateTime : 0;
+        m_frames.push_back(Frame{displayTime, locateTime, Now()});
+    }
+
+    void LatencyProbe::Report()
+    {
+        if (m_frames.empty()) {
+            return;
+        }
+
+        std::vector<std::chrono::nanoseconds> locateToDisplay;
+        std::vector<std::chrono::nanoseconds> locateToSubmit;
+        std::vector<std::chrono::nanoseconds> submitToDisplay;
+        for (const Frame& frame : m_frames) {
+            submitToDisplay.emplace_back(frame.displayTime - frame.submitTime);
+            if (frame.locateTime != 0) {
+                locateToDisplay.emplace_back(frame.displayTime - frame.locateTime);
+                locateToSubmit.emplace_back(frame.submitTime - frame.locateTime);
+            }
+        }
+
+        using ms = std::chrono::duration<double, std::milli>;
+        const std::vector<MetricTag> tags{{"frameCount", std::to_string(m_frames.size())}};
+        auto report = [&](const std::string& name, std::vector<std::chrono::nanoseconds>&& samples) {
+            if (samples.empty()) {
+                return;
+            }
+            const DurationPercentiles percentiles = DurationPercentiles::FromSamples(std::move(samples));
+            ReportMetric(name + ".p50", ms(percentiles.p50).count(), "ms", tags);
+            ReportMetric(name + ".p90", ms(percentiles.p90).count(), "ms", tags);
+            ReportMetric(name + ".p99", ms(percentiles.p99).count(), "ms", tags);
+            ReportMetric(name + ".max", ms(percentiles.max).count(), "ms", tags);
+        };
+        // Pose sample to predicted display is the app's share of motion-to-photon latency.
+        report("latency.locateToDisplay", std::move(locateToDisplay));
+        report("latency.locateToSubmit", std::move(locateToSubmit));
+        report("latency.submitToDisplay", std::move(submitToDisplay));
+
+        m_frames.clear();
+    }
+}  // namespace Conformance
@@ -0,0 +1,73 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <openxr/openxr.h>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace Conformance
+{
+    /// Records, per frame, when the views were located and when the frame was submitted, on the runtime's XrTime clock,
+    /// see Options::latencyProbe.
+    ///
+    /// The steady clock is mapped to XrTime once, with XR_KHR_convert_timespec_time or
+    /// XR_KHR_win32_convert_performance_counter_time, so recording a frame costs no runtime calls. Both clocks are the
+    /// platform's monotonic clock, so the offset between them holds for the life of the probe.
+    class LatencyProbe
+    {
+    public:
+        /// The time conversion extension for this platform, or null if there is none.
+        static const char* GetTimeConversionExtensionName();
+
+        /// Returns null if the time conversion extension is not enabled on @p instance.
+        static std::unique_ptr<LatencyProbe> TryCreate(XrInstance instance);
+
+        /// Call as xrLocateViews samples the views for the frame to be displayed at @p displayTime.
+        void OnViewsLocated(XrTime displayTime);
+
+        /// Call just before the frame to be displayed at @p displayTime is passed to xrEndFrame.
+        void OnFrameSubmitted(XrTime displayTime);
+
+        /// Report percentiles of the latencies recorded since the last call as metrics, and start over.
+        void Report();
+
+        /// The current time on the runtime's XrTime clock, for comparing with times the runtime returns.
+        XrTime Now() const;
+
+    private:
+        explicit LatencyProbe(XrDuration steadyClockToXrTime) : m_steadyClockToXrTime(steadyClockToXrTime)
+        {
+        }
+
+        struct Frame
+        {
+            XrTime displayTime;
+            /// When the views were first located for this frame, or 0 if they were not
+            XrTime locateTime;
+            XrTime submitTime;
+        };
+
+        /// Add to a steady clock time since its epoch, in nanoseconds, to get the XrTime
+        XrDuration m_steadyClockToXrTime;
+        XrTime m_locateDisplayTime{0};
+        XrTime m_locateTime{0};
+        std::vector<Frame> m_frames;
+    };
+}  // namespace Conformance
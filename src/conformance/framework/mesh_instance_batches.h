@@ -0,0 +1,115 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "graphics_plugin.h"
+
+#include <stdint.h>
+#include <vector>
+
+namespace Conformance
+{
+    /// The cubes and meshes of a RenderParams, grouped by mesh so that each mesh can be drawn with a single instanced draw.
+    ///
+    /// Batches are in order of first use, and the instances of a batch keep their relative order. The depth pre-pass meshes
+    /// come first, so that their batches are drawn before any other.
+    /// Kept by the graphics plugins across calls to reuse the storage.
+    class MeshInstanceBatches
+    {
+    public:
+        struct Batch
+        {
+            MeshHandle handle;
+            /// Index of the first instance of this batch in Instances()
+            uint32_t firstInstance;
+            uint32_t instanceCount;
+        };
+
+        /// Group the depth pre-pass meshes, cubes and meshes of @p params, with cubes drawn as instances of @p cubeMesh.
+        void Build(const RenderParams& params, MeshHandle cubeMesh)
+        {
+            m_batches.clear();
+            m_batchIndices.clear();
+
+            // First count the instances of each mesh...
+            for (const MeshDrawable& mesh : params.depthPrePass) {
+                m_batchIndices.push_back(BatchIndexFor(mesh.handle));
+            }
+            for (size_t c = 0; c < params.cubes.size(); ++c) {
+                m_batchIndices.push_back(BatchIndexFor(cubeMesh));
+            }
+            for (const MeshDrawable& mesh : params.meshes) {
+                m_batchIndices.push_back(BatchIndexFor(mesh.handle));
+            }
+            uint32_t firstInstance = 0;
+            for (Batch& batch : m_batches) {
+                batch.firstInstance = firstInstance;
+                firstInstance += batch.instanceCount;
+            }
+
+            // ...then place each instance after the ones before it in its batch.
+            m_instances.assign(m_batchIndices.size(), MeshDrawable{MeshHandle{}});
+            m_nextInstance.clear();
+            for (const Batch& batch : m_batches) {
+                m_nextInstance.push_back(batch.firstInstance);
+            }
+            size_t i = 0;
+            for (const MeshDrawable& mesh : params.depthPrePass) {
+                m_instances[m_nextInstance[m_batchIndices[i++]]++] = mesh;
+            }
+            for (const Cube& cube : params.cubes) {
+                m_instances[m_nextInstance[m_batchIndices[i++]]++] = MeshDrawable{cubeMesh, cube.params.pose, cube.params.scale,
+                                                                                  cube.tintColor};
+            }
+            for (const MeshDrawable& mesh : params.meshes) {
+                m_instances[m_nextInstance[m_batchIndices[i++]]++] = mesh;
+            }
+        }
+
+        const std::vector<Batch>& Batches() const
+        {
+            return m_batches;
+        }
+
+        /// All instances, ordered by batch
+        const std::vector<MeshDrawable>& Instances() const
+        {
+            return m_instances;
+        }
+
+    private:
+        uint32_t BatchIndexFor(MeshHandle handle)
+        {
+            // Scenes use a handful of meshes, usually in runs, so a linear search starting from the last batch is quick.
+            for (size_t j = m_batches.size(); j > 0; --j) {
+                if (m_batches[j - 1].handle == handle) {
+                    m_batches[j - 1].instanceCount++;
+                    return uint32_t(j - 1);
+                }
+            }
+            m_batches.push_back(Batch{handle, 0, 1});
+            return uint32_t(m_batches.size() - 1);
+        }
+
+        std::vector<Batch> m_batches;
+        std::vector<MeshDrawable> m_instances;
+        /// The batch of each drawable, in the order of the RenderParams
+        std::vector<uint32_t> m_batchIndices;
+        /// Where in m_instances the next instance of each batch goes
+        std::vector<uint32_t> m_nextInstance;
+    };
+}  // namespace Conformance
@@ -37,25 +37,25 @@ namespace
     class MeshViewRenderer : public BaseProjectionLayerHelper::ViewRenderer
     {
     public:
-        MeshViewRenderer(std::vector<MeshHandle>& meshes, span<const XrColor4f> bgColors) : m_meshes(meshes), m_bgColors(bgColors)
+        MeshViewRenderer(span<const std::unique_ptr<DrawList>> drawLists, span<const XrColor4f> bgColors)
+            : m_drawLists(drawLists), m_bgColors(bgColors)
         {
         }
 
         ~MeshViewRenderer() override = default;
         void RenderView(const BaseProjectionLayerHelper& /* projectionLayerHelper */, uint32_t viewIndex,
-                        const XrViewState& /* viewState */, const XrView& view, XrCompositionLayerProjectionView& projectionView,
+                        const XrViewState& /* viewState */, const XrView& /* view */, XrCompositionLayerProjectionView& projectionView,
                         const XrSwapchainImageBaseHeader* swapchainImage) override
         {
             // Clear to customized background color
             GetGlobalData().graphicsPlugin->ClearImageSlice(swapchainImage, 0, m_bgColors[viewIndex]);
 
-            // Draw the mesh
-            auto meshHandles = {MeshDrawable(m_meshes[viewIndex], view.pose, {1.0, 1.0, 1.0})};
-            GetGlobalData().graphicsPlugin->RenderView(projectionView, swapchainImage, RenderParams{}.Draw(meshHandles));
+            // Draw the mesh, which is locked to the view, so may be replayed from what the plugin recorded for an earlier frame
+            GetGlobalData().graphicsPlugin->RenderDrawList(projectionView, swapchainImage, *m_drawLists[viewIndex]);
         }
 
     private:
-        span<const MeshHandle> m_meshes;
+        span<const std::unique_ptr<DrawList>> m_drawLists;
         span<const XrColor4f> m_bgColors;
     };
 }  // namespace
@@ -74,6 +74,11 @@ namespace Conformance
             throw std::logic_error("Mismatch between mesh count and view count");
         }
         m_meshes = std::move(meshes);
+        m_drawLists.clear();
+        for (const MeshHandle& mesh : m_meshes) {
+            const MeshDrawable meshDrawable[] = {MeshDrawable(mesh)};
+            m_drawLists.push_back(std::make_unique<DrawList>(RenderParams{}.Draw(meshDrawable)));
+        }
     }
 
     void MeshProjectionLayerHelper::SetBgColors(std::vector<XrColor4f>&& bgColors)
@@ -87,7 +92,7 @@ namespace Conformance
     XrCompositionLayerBaseHeader* MeshProjectionLayerHelper::TryGetUpdatedProjectionLayer(const XrFrameState& frameState)
     {
         if (HasMeshes()) {
-            MeshViewRenderer renderer{m_meshes, m_bgColors};
+            MeshViewRenderer renderer{m_drawLists, m_bgColors};
             return m_baseHelper.TryGetUpdatedProjectionLayer(frameState, renderer);
         }
         // no meshes to render
@@ -17,10 +17,13 @@
 #pragma once
 
 #include "composition_utils.h"
+#include "dynamic_resolution.h"
 #include "graphics_plugin.h"
 
 #include <openxr/openxr.h>
 
+#include <chrono>
+#include <memory>
 #include <vector>
 
 namespace Conformance
@@ -40,6 +43,27 @@ namespace Conformance
 
         XrCompositionLayerBaseHeader* TryGetUpdatedProjectionLayer(const XrFrameState& frameState);
 
+        /// See BaseProjectionLayerHelper::EnableDynamicResolution.
+        void EnableDynamicResolution(const DynamicResolutionController::Settings& settings = {})
+        {
+            m_baseHelper.EnableDynamicResolution(settings);
+        }
+
+        void DisableDynamicResolution()
+        {
+            m_baseHelper.DisableDynamicResolution();
+        }
+
+        void UpdateDynamicResolution(std::chrono::nanoseconds gpuTime)
+        {
+            m_baseHelper.UpdateDynamicResolution(gpuTime);
+        }
+
+        const DynamicResolutionController* GetDynamicResolution() const
+        {
+            return m_baseHelper.GetDynamicResolution();
+        }
+
         uint32_t GetViewCount() const
         {
             return m_baseHelper.GetViewCount();
@@ -57,6 +81,8 @@ namespace Conformance
     private:
         BaseProjectionLayerHelper m_baseHelper;
         std::vector<MeshHandle> m_meshes;
+        /// One per view, holding its mesh
+        std::vector<std::unique_ptr<DrawList>> m_drawLists;
         std::vector<XrColor4f> m_bgColors;
     };
 }  // namespace Conformance
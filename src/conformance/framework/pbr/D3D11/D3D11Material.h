@@ -40,7 +40,10 @@ namespace Pbr
         void SetTexture(ShaderSlots::PSMaterial slot, _In_ ID3D11ShaderResourceView* textureView,
                         _In_opt_ ID3D11SamplerState* sampler = nullptr);
 
-        /// Bind this material to current context.
+        /// Set the blend, depth and rasterizer state this material needs on the current context.
+        void BindPipelineState(_In_ ID3D11DeviceContext* context, const D3D11Resources& pbrResources) const;
+
+        /// Bind the constants, textures and samplers of this material to current context.
         void Bind(_In_ ID3D11DeviceContext* context, const D3D11Resources& pbrResources) const;
 
         std::string Name;
@@ -14,6 +14,7 @@
 #include "D3D11Primitive.h"
 #include "D3D11Resources.h"
 
+#include "../PbrDrawQueue.h"
 #include "../PbrHandles.h"
 #include "../PbrModel.h"
 
@@ -26,26 +27,48 @@ namespace Pbr
     void D3D11ModelInstance::Render(Pbr::D3D11Resources const& pbrResources, _In_ ID3D11DeviceContext* context,
                                     DirectX::FXMMATRIX modelToWorld)
     {
-        XMStoreFloat4x4(&m_modelBuffer.ModelToWorld, XMMatrixTranspose(modelToWorld));
-        context->UpdateSubresource(m_modelConstantBuffer.Get(), 0, nullptr, &m_modelBuffer, 0, 0);
-        pbrResources.BindConstantBuffers(context, m_modelConstantBuffer.Get());
+        Prepare(pbrResources, context, modelToWorld);
+
+        // Draw in model order, skipping only the state that repeats from one primitive to the next.
+        m_drawQueue.Clear();
+        AppendDraws(pbrResources, pbrResources.GetFillMode(), 0, m_drawQueue);
+        DrawBindState bindState;
+        for (const DrawItem& item : m_drawQueue.Items()) {
+            DrawPrimitive(pbrResources, context, item, bindState);
+        }
+    }
 
-        UpdateTransforms(pbrResources, context);
+    void D3D11ModelInstance::Prepare(Pbr::D3D11Resources const& pbrResources, _In_ ID3D11DeviceContext* context,
+                                     DirectX::FXMMATRIX modelToWorld)
+    {
+        ModelConstantBuffer modelBuffer;
+        XMStoreFloat4x4(&modelBuffer.ModelToWorld, XMMatrixTranspose(modelToWorld));
+        if (UpdateModelConstants(m_modelBuffer, modelBuffer)) {
+            context->UpdateSubresource(m_modelConstantBuffer.Get(), 0, nullptr, &m_modelBuffer, 0, 0);
+        }
 
-        ID3D11ShaderResourceView* vsShaderResources[] = {m_modelTransformsResourceView.Get()};
-        context->VSSetShaderResources(Pbr::ShaderSlots::Transforms, _countof(vsShaderResources), vsShaderResources);
+        UpdateTransforms(pbrResources, context);
+    }
 
-        for (PrimitiveHandle primitiveHandle : GetModel().GetPrimitiveHandles()) {
-            const Pbr::D3D11Primitive& primitive = pbrResources.GetPrimitive(primitiveHandle);
-            if (primitive.GetMaterial()->Hidden)
-                continue;
+    void D3D11ModelInstance::DrawPrimitive(Pbr::D3D11Resources const& pbrResources, _In_ ID3D11DeviceContext* context,
+                                           const DrawItem& item, DrawBindState& bindState) const
+    {
+        if (bindState.BindModelInstance(this)) {
+            pbrResources.BindConstantBuffers(context, m_modelConstantBuffer.Get());
 
-            if (!IsAnyNodeVisible(primitive.GetNodes()))
-                continue;
+            ID3D11ShaderResourceView* vsShaderResources[] = {m_modelTransformsResourceView.Get()};
+            context->VSSetShaderResources(Pbr::ShaderSlots::Transforms, _countof(vsShaderResources), vsShaderResources);
+        }
 
+        const Pbr::D3D11Primitive& primitive = pbrResources.GetPrimitive(GetModel().GetPrimitiveHandles()[item.primitive]);
+        if (bindState.BindPipeline(item.pipelineKey)) {
+            primitive.GetMaterial()->BindPipelineState(context, pbrResources);
+        }
+        if (bindState.BindMaterial(item.material)) {
             primitive.GetMaterial()->Bind(context, pbrResources);
-            primitive.Render(context);
         }
+        primitive.Render(context);
+        bindState.stats.draws++;
     }
 
     D3D11ModelInstance::D3D11ModelInstance(Pbr::D3D11Resources& pbrResources, std::shared_ptr<const Model> model)
@@ -32,6 +32,13 @@ namespace Pbr
         /// Render the model.
         void Render(Pbr::D3D11Resources const& pbrResources, _In_ ID3D11DeviceContext* context, DirectX::FXMMATRIX modelToWorld);
 
+        /// Upload the model constants and node transforms, before drawing the primitives added to a DrawQueue by AppendDraws.
+        void Prepare(Pbr::D3D11Resources const& pbrResources, _In_ ID3D11DeviceContext* context, DirectX::FXMMATRIX modelToWorld);
+
+        /// Draw one primitive of this model, binding only the state that differs from what @p bindState last bound.
+        void DrawPrimitive(Pbr::D3D11Resources const& pbrResources, _In_ ID3D11DeviceContext* context, const DrawItem& item,
+                           DrawBindState& bindState) const;
+
     private:
         void AllocateDescriptorSets(Pbr::D3D11Resources& pbrResources, uint32_t numSets);
         /// Update the transforms used to render the model. This needs to be called any time a node transform is changed.
@@ -42,5 +49,7 @@ namespace Pbr
 
         Microsoft::WRL::ComPtr<ID3D11Buffer> m_modelTransformsStructuredBuffer;
         Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_modelTransformsResourceView;
+
+        DrawQueue m_drawQueue;
     };
 }  // namespace Pbr
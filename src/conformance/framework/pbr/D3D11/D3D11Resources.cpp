@@ -82,7 +82,7 @@ namespace
 
 namespace Pbr
 {
-    using ImageKey = std::tuple<const tinygltf::Image*, bool>;  // Item1 is a pointer to the image, Item2 is sRGB.
+    using ImageKey = std::tuple<const GltfHelper::DecodedImage*, bool>;  // Item1 is a pointer to the image, Item2 is sRGB.
 
     struct D3D11Resources::Impl
     {
@@ -168,7 +168,7 @@ namespace Pbr
                 RasterizerStates[2][2][2];  // Three dimensions for [DoubleSide][Wireframe][FrontCounterClockWise]
             Microsoft::WRL::ComPtr<ID3D11DepthStencilState> DepthStencilStates[2][2];  // Two dimensions for [ReverseZ][NoWrite]
             std::vector<Conformance::Image::FormatParams> SupportedTextureFormats;
-            mutable D3D11TextureCache SolidColorTextureCache;
+            mutable D3D11TextureCache TextureCache;
         };
         PrimitiveCollection<D3D11Primitive> Primitives;
 
@@ -193,15 +193,11 @@ namespace Pbr
 
     D3D11Resources::~D3D11Resources() = default;
 
-    // Create a DirectX texture view from a tinygltf Image.
+    // Create a DirectX texture view from a decoded tinygltf Image.
     static Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> LoadGLTFImage(const Pbr::D3D11Resources& pbrResources,
-                                                                          const tinygltf::Image& image, bool sRGB)
+                                                                          const GltfHelper::DecodedImage& image)
     {
-        // First convert the image to RGBA if it isn't already.
-        std::vector<uint8_t> tempBuffer;
-        Conformance::Image::Image decodedImage = GltfHelper::DecodeImage(image, sRGB, pbrResources.GetSupportedFormats(), tempBuffer);
-
-        return Pbr::D3D11Texture::CreateTexture(pbrResources, decodedImage);
+        return Pbr::D3D11Texture::CreateTexture(pbrResources, image.image, true);
     }
 
     static D3D11_FILTER D3D11ConvertFilter(int glMinFilter, int glMagFilter)
@@ -262,7 +258,8 @@ namespace Pbr
         return std::make_shared<D3D11Material>(*this);
     }
     void D3D11Resources::LoadTexture(const std::shared_ptr<Material>& material, Pbr::ShaderSlots::PSMaterial slot,
-                                     const tinygltf::Image* image, const tinygltf::Sampler* sampler, bool sRGB, Pbr::RGBAColor defaultRGBA)
+                                     const GltfHelper::DecodedImage* image, const tinygltf::Sampler* sampler, bool sRGB,
+                                     Pbr::RGBAColor defaultRGBA)
     {
         auto pbrMaterial = std::dynamic_pointer_cast<D3D11Material>(material);
         if (!pbrMaterial) {
@@ -272,12 +269,13 @@ namespace Pbr
         const ImageKey imageKey = std::make_tuple(image, sRGB);
         Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> textureView =
             image != nullptr ? m_impl->loaderResources.imageMap[imageKey] : CreateTypedSolidColorTexture(defaultRGBA, sRGB);
-        if (!textureView)  // If not cached, load the image and store it in the texture cache.
+        if (!textureView)  // If not cached, load the image, or find one with the same content, and store it in the texture cache.
         {
-            // TODO: Generate mipmaps if sampler's minification filter (minFilter) uses mipmapping.
+            // Mipmaps are generated whether or not this sampler's minification filter (minFilter) uses them, since the
+            // image may be shared with another sampler that does.
             // TODO: If texture is not power-of-two and (sampler has wrapping=repeat/mirrored_repeat OR minFilter uses
             // mipmapping), resize to power-of-two.
-            textureView = LoadGLTFImage(*this, *image, sRGB);
+            textureView = m_impl->Resources.TextureCache.FindOrCreate(image->image, [&] { return LoadGLTFImage(*this, *image); });
             m_impl->loaderResources.imageMap[imageKey] = textureView;
         }
 
@@ -362,7 +360,12 @@ namespace Pbr
 
     Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> D3D11Resources::CreateTypedSolidColorTexture(RGBAColor color, bool sRGB) const
     {
-        return m_impl->Resources.SolidColorTextureCache.CreateTypedSolidColorTexture(*this, color, sRGB);
+        return m_impl->Resources.TextureCache.CreateTypedSolidColorTexture(*this, color, sRGB);
+    }
+
+    void D3D11Resources::SetTextureCacheBudget(uint64_t budgetBytes)
+    {
+        m_impl->Resources.TextureCache.SetBudget(budgetBytes);
     }
 
     void D3D11Resources::Bind(_In_ ID3D11DeviceContext* context) const
@@ -56,8 +56,9 @@ namespace Pbr
         std::shared_ptr<Material> CreateFlatMaterial(RGBAColor baseColorFactor, float roughnessFactor = 1.0f, float metallicFactor = 0.0f,
                                                      RGBColor emissiveFactor = RGB::Black) override;
         std::shared_ptr<Material> CreateMaterial() override;
-        void LoadTexture(const std::shared_ptr<Material>& pbrMaterial, Pbr::ShaderSlots::PSMaterial slot, const tinygltf::Image* image,
-                         const tinygltf::Sampler* sampler, bool sRGB, Pbr::RGBAColor defaultRGBA) override;
+        void LoadTexture(const std::shared_ptr<Material>& pbrMaterial, Pbr::ShaderSlots::PSMaterial slot,
+                         const GltfHelper::DecodedImage* image, const tinygltf::Sampler* sampler, bool sRGB,
+                         Pbr::RGBAColor defaultRGBA) override;
         PrimitiveHandle MakePrimitive(const Pbr::PrimitiveBuilder& primitiveBuilder,
                                       const std::shared_ptr<Pbr::Material>& material) override;
         void DropLoaderCaches() override;
@@ -88,8 +89,11 @@ namespace Pbr
         /// number of textures created.
         Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> CreateTypedSolidColorTexture(RGBAColor color, bool sRGB) const;
 
+        /// Set the bytes of textures kept cached once no model uses them. See Pbr::TextureCache.
+        void SetTextureCacheBudget(uint64_t budgetBytes);
+
         /// Get the cached list of texture formats supported by the device
-        span<const Conformance::Image::FormatParams> GetSupportedFormats() const;
+        span<const Conformance::Image::FormatParams> GetSupportedFormats() const override;
 
         /// Bind the the PBR resources to the current context.
         void Bind(_In_ ID3D11DeviceContext* context) const;
@@ -76,19 +76,30 @@ namespace Pbr
         }
 
         Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> CreateTexture(const D3D11Resources& pbrResources,
-                                                                       const Conformance::Image::Image& image)
+                                                                       const Conformance::Image::Image& image, bool generateMips)
         {
+            Microsoft::WRL::ComPtr<ID3D11Device> device = pbrResources.GetDevice();
             auto dxgiFormat = ToDXGIFormat(image.format);
+
+            // Only the base level is uploaded, the rest of the chain is generated from it.
+            UINT formatSupport = 0;
+            generateMips = generateMips && CanGenerateMips(image) && SUCCEEDED(device->CheckFormatSupport(dxgiFormat, &formatSupport)) &&
+                           (formatSupport & D3D11_FORMAT_SUPPORT_MIP_AUTOGEN) != 0;
+
             D3D11_TEXTURE2D_DESC desc{};
             desc.Width = image.levels[0].metadata.physicalDimensions.width;
             desc.Height = image.levels[0].metadata.physicalDimensions.height;
-            desc.MipLevels = image.levels.size();
+            desc.MipLevels = generateMips ? GetFullMipChainLevelCount(desc.Width, desc.Height) : (UINT)image.levels.size();
             desc.ArraySize = 1;
             desc.Format = dxgiFormat;
             desc.SampleDesc.Count = 1;
             desc.SampleDesc.Quality = 0;
             desc.Usage = D3D11_USAGE_DEFAULT;
             desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+            if (generateMips) {
+                desc.BindFlags |= D3D11_BIND_RENDER_TARGET;
+                desc.MiscFlags = D3D11_RESOURCE_MISC_GENERATE_MIPS;
+            }
 
             auto subData = std::vector<D3D11_SUBRESOURCE_DATA>{};
             subData.reserve(image.levels.size());
@@ -101,8 +112,10 @@ namespace Pbr
                 subData.push_back(levelData);
             }
 
+            // Initial data would have to cover every level, including the ones to be generated.
             Microsoft::WRL::ComPtr<ID3D11Texture2D> texture2D;
-            XRC_CHECK_THROW_HRCMD(pbrResources.GetDevice()->CreateTexture2D(&desc, subData.data(), texture2D.ReleaseAndGetAddressOf()));
+            XRC_CHECK_THROW_HRCMD(
+                device->CreateTexture2D(&desc, generateMips ? nullptr : subData.data(), texture2D.ReleaseAndGetAddressOf()));
 
             D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc{};
             srvDesc.Format = desc.Format;
@@ -111,8 +124,15 @@ namespace Pbr
             srvDesc.Texture2D.MipLevels = desc.MipLevels;
 
             Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> textureView;
-            XRC_CHECK_THROW_HRCMD(
-                pbrResources.GetDevice()->CreateShaderResourceView(texture2D.Get(), &srvDesc, textureView.ReleaseAndGetAddressOf()));
+            XRC_CHECK_THROW_HRCMD(device->CreateShaderResourceView(texture2D.Get(), &srvDesc, textureView.ReleaseAndGetAddressOf()));
+
+            if (generateMips) {
+                Microsoft::WRL::ComPtr<ID3D11DeviceContext> context;
+                device->GetImmediateContext(context.ReleaseAndGetAddressOf());
+                context->UpdateSubresource(texture2D.Get(), 0, nullptr, subData[0].pSysMem, subData[0].SysMemPitch,
+                                           subData[0].SysMemSlicePitch);
+                context->GenerateMips(textureView.Get());
+            }
 
             return textureView;
         }
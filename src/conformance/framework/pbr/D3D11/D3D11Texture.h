@@ -31,8 +31,10 @@ namespace Pbr
                                                                           uint32_t fileSize);
         Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> CreateFlatCubeTexture(const D3D11Resources& pbrResources, RGBAColor color,
                                                                                DXGI_FORMAT format = DXGI_FORMAT_R8G8B8A8_UNORM);
+        /// @param generateMips Generate the rest of the mip chain on the GPU if @p image only has its base level and is uncompressed,
+        /// and the device supports it for its format.
         Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> CreateTexture(const D3D11Resources& pbrResources,
-                                                                       const Conformance::Image::Image& image);
+                                                                       const Conformance::Image::Image& image, bool generateMips = false);
         Microsoft::WRL::ComPtr<ID3D11SamplerState> CreateSampler(_In_ ID3D11Device* device,
                                                                  D3D11_TEXTURE_ADDRESS_MODE addressMode = D3D11_TEXTURE_ADDRESS_CLAMP);
     }  // namespace D3D11Texture
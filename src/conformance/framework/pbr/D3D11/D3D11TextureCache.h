@@ -8,14 +8,15 @@
 // SPDX-License-Identifier: MIT AND Apache-2.0
 
 #ifdef _WIN32
+#include "../PbrTextureCache.h"
+
 #include <d3d11.h>
 #include <d3d11_2.h>
 #include <openxr/openxr.h>
 #include <wrl/client.h>  // For Microsoft::WRL::ComPtr
 
-#include <map>
 #include <memory>
-#include <mutex>
+#include <utility>
 
 namespace Pbr
 {
@@ -23,13 +24,23 @@ namespace Pbr
     using ComPtr = Microsoft::WRL::ComPtr<T>;
     struct D3D11Resources;
 
-    /// Cache of single-color textures.
+    template <typename T>
+    struct TextureReferences<ComPtr<T>>
+    {
+        static bool HeldOnlyByCache(const ComPtr<T>& texture)
+        {
+            texture->AddRef();
+            return texture->Release() == 1;
+        }
+    };
+
+    /// Cache of textures by content, including single-color textures. See Pbr::TextureCache.
     ///
     /// Device-dependent, drop when device is lost or destroyed.
     class D3D11TextureCache
     {
     public:
-        D3D11TextureCache();
+        D3D11TextureCache() = default;
 
         D3D11TextureCache(D3D11TextureCache&&) = default;
         D3D11TextureCache& operator=(D3D11TextureCache&&) = default;
@@ -39,11 +50,21 @@ namespace Pbr
         /// Find or create a single pixel texture of the given color
         ComPtr<ID3D11ShaderResourceView> CreateTypedSolidColorTexture(const Pbr::D3D11Resources& pbrResources, XrColor4f color, bool sRGB);
 
+        /// Find the texture with the content of @p image, or create it by calling @p create.
+        template <typename Create>
+        ComPtr<ID3D11ShaderResourceView> FindOrCreate(const Conformance::Image::Image& image, Create&& create)
+        {
+            return m_textures.FindOrCreate(image, std::forward<Create>(create));
+        }
+
+        void SetBudget(uint64_t budgetBytes)
+        {
+            m_textures.SetBudget(budgetBytes);
+        }
+
     private:
         ComPtr<ID3D11Device> m_device;
-        // in unique_ptr to make it moveable
-        std::unique_ptr<std::mutex> m_cacheMutex;
-        std::map<uint32_t, ComPtr<ID3D11ShaderResourceView>> m_solidColorTextureCache;
+        TextureCache<ComPtr<ID3D11ShaderResourceView>> m_textures;
     };
 
 }  // namespace Pbr
@@ -36,12 +36,7 @@ namespace Pbr
         textureHeapDesc.NodeMask = 1;
         XRC_CHECK_THROW_HRCMD(pbrResources.GetDevice()->CreateDescriptorHeap(&textureHeapDesc, IID_PPV_ARGS(&m_textureHeap)));
 
-        D3D12_DESCRIPTOR_HEAP_DESC samplerHeapDesc;
-        samplerHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER;
-        samplerHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
-        samplerHeapDesc.NumDescriptors = ShaderSlots::NumMaterialSlots;
-        samplerHeapDesc.NodeMask = 1;
-        XRC_CHECK_THROW_HRCMD(pbrResources.GetDevice()->CreateDescriptorHeap(&samplerHeapDesc, IID_PPV_ARGS(&m_samplerHeap)));
+        m_samplerDescs.fill(D3D12Texture::DefaultSamplerDesc());
     }
 
     std::shared_ptr<D3D12Material> D3D12Material::Clone(Pbr::D3D12Resources const& pbrResources) const
@@ -49,7 +44,7 @@ namespace Pbr
         auto clone = std::make_shared<D3D12Material>(pbrResources);
         clone->CopyFrom(*this);
         clone->m_textureHeap = m_textureHeap;
-        clone->m_samplerHeap = m_samplerHeap;
+        clone->m_samplerDescs = m_samplerDescs;
         return clone;
     }
 
@@ -99,20 +94,13 @@ namespace Pbr
         device->CreateShaderResourceView(texture.resource.Get(), &texture.srvDesc, textureHandle);
 
         if (sampler) {
-            CD3DX12_CPU_DESCRIPTOR_HANDLE samplerHandle(m_samplerHeap->GetCPUDescriptorHandleForHeapStart());
-            auto samplerDescriptorSize = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER);
-            samplerHandle.Offset(slot, samplerDescriptorSize);
-            device->CreateSampler(sampler, samplerHandle);
+            m_samplerDescs[slot] = *sampler;
         }
     }
 
-    void D3D12Material::GetDescriptors(_In_ ID3D12Device* device, D3D12_CPU_DESCRIPTOR_HANDLE destTextureDescriptors,
-                                       D3D12_CPU_DESCRIPTOR_HANDLE destSamplerDescriptors)
+    D3D12_CPU_DESCRIPTOR_HANDLE D3D12Material::GetTextureDescriptors() const
     {
-        device->CopyDescriptorsSimple(ShaderSlots::NumMaterialSlots, destTextureDescriptors,
-                                      m_textureHeap->GetCPUDescriptorHandleForHeapStart(), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-        device->CopyDescriptorsSimple(ShaderSlots::NumMaterialSlots, destSamplerDescriptors,
-                                      m_samplerHeap->GetCPUDescriptorHandleForHeapStart(), D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER);
+        return m_textureHeap->GetCPUDescriptorHandleForHeapStart();
     }
 
     void D3D12Material::Bind(_In_ ID3D12GraphicsCommandList* directCommandList, D3D12Resources& /* pbrResources */)
@@ -28,7 +28,7 @@ namespace Pbr
         /// Create a uninitialized material. Textures and shader coefficients must be set.
         D3D12Material(Pbr::D3D12Resources const& pbrResources);
 
-        /// Create a clone of this material. Shares the texture and sampler heap with this material.
+        /// Create a clone of this material. Shares the texture heap with this material.
         std::shared_ptr<D3D12Material> Clone(Pbr::D3D12Resources const& pbrResources) const;
 
         /// Create a flat (no texture) material.
@@ -41,9 +41,14 @@ namespace Pbr
         void SetTexture(_In_ ID3D12Device* device, ShaderSlots::PSMaterial slot, Conformance::D3D12ResourceWithSRVDesc& texture,
                         _In_opt_ D3D12_SAMPLER_DESC* sampler);
 
-        /// Write the descriptors of this material to a texture and sampler heap
-        void GetDescriptors(_In_ ID3D12Device* device, D3D12_CPU_DESCRIPTOR_HANDLE destTextureDescriptors,
-                            D3D12_CPU_DESCRIPTOR_HANDLE destSamplerDescriptors);
+        /// Get the CPU-only descriptors of the textures of this material, in slot order.
+        D3D12_CPU_DESCRIPTOR_HANDLE GetTextureDescriptors() const;
+
+        /// Get the samplers of this material, in slot order.
+        const std::array<D3D12_SAMPLER_DESC, ShaderSlots::NumMaterialSlots>& GetSamplerDescs() const
+        {
+            return m_samplerDescs;
+        }
 
         /// Bind this material to current context.
         void Bind(_In_ ID3D12GraphicsCommandList* directCommandList, D3D12Resources& pbrResources);
@@ -55,7 +60,7 @@ namespace Pbr
         static constexpr size_t TextureCount = ShaderSlots::NumMaterialSlots;
         std::array<Microsoft::WRL::ComPtr<ID3D12Resource>, TextureCount> m_textures;
         Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_textureHeap;
-        Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_samplerHeap;
+        std::array<D3D12_SAMPLER_DESC, TextureCount> m_samplerDescs;
         Conformance::D3D12BufferWithUpload<ConstantBufferData> m_constantBuffer;
     };
 }  // namespace Pbr
@@ -30,12 +30,14 @@ namespace Pbr
                                     DXGI_FORMAT colorRenderTargetFormat, DXGI_FORMAT depthRenderTargetFormat,
                                     DirectX::FXMMATRIX modelToWorld)
     {
-        XMStoreFloat4x4(&m_modelBuffer.ModelToWorld, XMMatrixTranspose(modelToWorld));
-        m_modelConstantBuffer.AsyncUpload(directCommandList, &m_modelBuffer);
-        auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(m_modelConstantBuffer.GetResource(), D3D12_RESOURCE_STATE_COPY_DEST,
-                                                            D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
-        directCommandList->ResourceBarrier(1, &barrier);
-        // xxx: why do we copy the transform descriptor to a separate heap, again? is that relevant here?
+        ModelConstantBuffer modelBuffer;
+        XMStoreFloat4x4(&modelBuffer.ModelToWorld, XMMatrixTranspose(modelToWorld));
+        if (UpdateModelConstants(m_modelBuffer, modelBuffer)) {
+            m_modelConstantBuffer.AsyncUpload(directCommandList, &m_modelBuffer);
+            auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(m_modelConstantBuffer.GetResource(), D3D12_RESOURCE_STATE_COPY_DEST,
+                                                                D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+            directCommandList->ResourceBarrier(1, &barrier);
+        }
         pbrResources.BindConstantBufferViews(directCommandList, m_modelConstantBuffer.GetResource()->GetGPUVirtualAddress());
 
         UpdateTransforms(pbrResources, directCommandList);
@@ -15,6 +15,7 @@
 
 #include "utilities/throw_helpers.h"
 
+#include <string>
 #include <type_traits>
 
 namespace Pbr
@@ -84,8 +85,18 @@ namespace Pbr
         pipelineStateDesc.IBStripCutValue = D3D12_INDEX_BUFFER_STRIP_CUT_VALUE_DISABLED;
 
         Microsoft::WRL::ComPtr<ID3D12PipelineState> pipelineState;
-        XRC_CHECK_THROW_HRCMD(device->CreateGraphicsPipelineState(&pipelineStateDesc, __uuidof(ID3D12PipelineState),
-                                                                  reinterpret_cast<void**>(pipelineState.ReleaseAndGetAddressOf())));
+        if (m_pipelineLibrary != nullptr) {
+            // The name must identify the whole permutation, i.e. every field of the key.
+            const std::wstring name = L"pbr_" + std::to_wstring(colorRenderTargetFormat) + L"_" + std::to_wstring(depthRenderTargetFormat) +
+                                      L"_" + std::to_wstring((int)fillMode) + L"_" + std::to_wstring((int)frontFaceWindingOrder) + L"_" +
+                                      std::to_wstring((int)blendState) + L"_" + std::to_wstring((int)doubleSided) + L"_" +
+                                      std::to_wstring((int)depthDirection);
+            pipelineState = m_pipelineLibrary->GetOrCreateGraphicsPipelineState(name, pipelineStateDesc);
+        }
+        else {
+            XRC_CHECK_THROW_HRCMD(device->CreateGraphicsPipelineState(&pipelineStateDesc, __uuidof(ID3D12PipelineState),
+                                                                      reinterpret_cast<void**>(pipelineState.ReleaseAndGetAddressOf())));
+        }
 
         m_pipelineStates.emplace(state, pipelineState);
 
@@ -11,6 +11,8 @@
 
 #include "../PbrSharedState.h"
 
+#include "utilities/d3d12_utils.h"
+
 #include <d3d12.h>
 #include <nonstd/span.hpp>
 #include <wrl/client.h>  // For Microsoft::WRL::ComPtr
@@ -28,15 +30,17 @@ namespace Pbr
     {
     public:
         /// Note: Make sure your shaders are global/static!
+        /// @param pipelineLibrary Library to load and store pipeline states in, may be null: must outlive this object.
         D3D12PipelineStates(Microsoft::WRL::ComPtr<ID3D12RootSignature> rootSignature,
                             const D3D12_GRAPHICS_PIPELINE_STATE_DESC& basePipelineStateDesc,
                             span<const D3D12_INPUT_ELEMENT_DESC> inputLayout, span<const unsigned char> pbrVS,
-                            span<const unsigned char> pbrPS)
+                            span<const unsigned char> pbrPS, Conformance::D3D12PipelineLibrary* pipelineLibrary = nullptr)
             : m_rootSignature(std::move(rootSignature))
             , m_basePipelineStateDesc(basePipelineStateDesc)
             , m_inputLayout(inputLayout)
             , m_pbrVS(pbrVS)
             , m_pbrPS(pbrPS)
+            , m_pipelineLibrary(pipelineLibrary)
         {
             m_basePipelineStateDesc.pRootSignature = m_rootSignature.Get();
 
@@ -58,6 +62,7 @@ namespace Pbr
         span<const D3D12_INPUT_ELEMENT_DESC> m_inputLayout;
         span<const unsigned char> m_pbrVS;
         span<const unsigned char> m_pbrPS;
+        Conformance::D3D12PipelineLibrary* m_pipelineLibrary;
 
         std::map<PipelineStateKey, Microsoft::WRL::ComPtr<ID3D12PipelineState>> m_pipelineStates;
     };
@@ -43,20 +43,6 @@ namespace Pbr
         m_indexBuffer.Allocate(pbrResources.GetDevice().Get(), primitiveBuilder.Indices.size());
         m_vertexBuffer.Allocate(pbrResources.GetDevice().Get(), primitiveBuilder.Vertices.size());
         UpdateBuffers(pbrResources, copyCommandList, primitiveBuilder);
-
-        D3D12_DESCRIPTOR_HEAP_DESC srvHeapDesc;
-        srvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-        srvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-        srvHeapDesc.NumDescriptors = ShaderSlots::NumVSResourceViews + ShaderSlots::NumTextures;
-        srvHeapDesc.NodeMask = 1;
-        XRC_CHECK_THROW_HRCMD(pbrResources.GetDevice()->CreateDescriptorHeap(&srvHeapDesc, IID_PPV_ARGS(&m_srvHeap)));
-
-        D3D12_DESCRIPTOR_HEAP_DESC samplerHeapDesc;
-        samplerHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER;
-        samplerHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-        samplerHeapDesc.NumDescriptors = ShaderSlots::NumSamplers;
-        samplerHeapDesc.NodeMask = 1;
-        XRC_CHECK_THROW_HRCMD(pbrResources.GetDevice()->CreateDescriptorHeap(&samplerHeapDesc, IID_PPV_ARGS(&m_samplerHeap)));
     }
 
     D3D12Primitive D3D12Primitive::Clone(Pbr::D3D12Resources const& pbrResources) const
@@ -96,23 +82,7 @@ namespace Pbr
                                 DXGI_FORMAT colorRenderTargetFormat, DXGI_FORMAT depthRenderTargetFormat) const
     {
         GetMaterial()->Bind(directCommandList, pbrResources);
-        pbrResources.BindDescriptorHeaps(directCommandList, m_srvHeap.Get(), m_samplerHeap.Get());
-
-        UINT srvDescriptorSize = pbrResources.GetDevice()->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-        UINT samplerDescriptorSize = pbrResources.GetDevice()->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER);
-
-        CD3DX12_CPU_DESCRIPTOR_HANDLE srvHandle(m_srvHeap->GetCPUDescriptorHandleForHeapStart());
-        CD3DX12_CPU_DESCRIPTOR_HANDLE samplerHandle(m_samplerHeap->GetCPUDescriptorHandleForHeapStart());
-
-        // vertex shader resource views
-        pbrResources.GetTransforms(srvHandle);
-        srvHandle.Offset(ShaderSlots::NumVSResourceViews, srvDescriptorSize);
-
-        GetMaterial()->GetDescriptors(pbrResources.GetDevice().Get(), srvHandle, samplerHandle);
-        srvHandle.Offset(ShaderSlots::NumMaterialSlots, srvDescriptorSize);
-        samplerHandle.Offset(ShaderSlots::NumMaterialSlots, samplerDescriptorSize);
-
-        pbrResources.GetGlobalTexturesAndSamplers(srvHandle, samplerHandle);
+        pbrResources.BindDescriptorTables(directCommandList, *GetMaterial());
 
         BlendState blendState = GetMaterial()->GetAlphaBlended();
         DoubleSided doubleSided = GetMaterial()->GetDoubleSided();
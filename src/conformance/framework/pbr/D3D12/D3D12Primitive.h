@@ -65,8 +65,6 @@ namespace Pbr
         UINT m_vertexCount;
         Conformance::D3D12BufferWithUpload<Pbr::Vertex> m_vertexBuffer;
         std::shared_ptr<D3D12Material> m_material;
-        Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_srvHeap;
-        Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_samplerHeap;
         std::vector<NodeIndex_t> m_nodeIndices;
     };
 }  // namespace Pbr
@@ -31,6 +31,8 @@
 #include <PbrPixelShader_hlsl.h>
 #include <PbrVertexShader_hlsl.h>
 
+#include <cstring>
+#include <string>
 #include <type_traits>
 
 using namespace DirectX;
@@ -91,7 +93,7 @@ namespace
 
 namespace Pbr
 {
-    using ImageKey = std::tuple<const tinygltf::Image*, bool>;  // Item1 is a pointer to the image, Item2 is sRGB.
+    using ImageKey = std::tuple<const GltfHelper::DecodedImage*, bool>;  // Item1 is a pointer to the image, Item2 is sRGB.
 
     namespace RootSig
     {
@@ -154,26 +156,31 @@ namespace Pbr
 
     struct D3D12Resources::Impl
     {
+        /// Descriptors in the ring that the shader resource view tables of draws are written to.
+        static constexpr uint32_t DescriptorRingCapacity = 65536;
+        /// Shader-visible sampler heaps are limited in size, so sampler tables are kept for as long as the resources live.
+        static constexpr uint32_t MaxSamplerTables = D3D12_MAX_SHADER_VISIBLE_SAMPLER_HEAP_SIZE / ShaderSlots::NumSamplers;
+
         // TODO: make this a constructor
-        void Initialize(_In_ ID3D12Device* device, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& basePipelineStateDesc)
+        void Initialize(_In_ ID3D12Device* device, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& basePipelineStateDesc,
+                        std::shared_ptr<Conformance::D3D12QueueWrapper> queueWrapper, Conformance::D3D12PipelineLibrary* pipelineLibrary)
         {
+            BasePipelineStateDesc = basePipelineStateDesc;
+            QueueWrapper = std::move(queueWrapper);
+            PipelineLibrary = pipelineLibrary;
+
             Resources.Device = device;
 
             Resources.RootSignature = RootSig::CreateRootSig(device);
             Resources.PipelineStates = std::make_unique<D3D12PipelineStates>(Resources.RootSignature, basePipelineStateDesc, s_vertexDesc,
-                                                                             g_PbrVertexShader, g_PbrPixelShader);
+                                                                             g_PbrVertexShader, g_PbrPixelShader, pipelineLibrary);
 
             // Set up the scene constant buffer.
             static_assert((sizeof(SceneConstantBuffer) % 16) == 0, "Constant Buffer must be divisible by 16 bytes");
             Resources.SceneConstantBuffer.Allocate(device);
 
-            D3D12_DESCRIPTOR_HEAP_DESC transformHeapDesc;
-            transformHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-            transformHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
-            transformHeapDesc.NumDescriptors = ShaderSlots::NumVSResourceViews;
-            transformHeapDesc.NodeMask = 1;
-
-            XRC_CHECK_THROW_HRCMD(device->CreateDescriptorHeap(&transformHeapDesc, IID_PPV_ARGS(&Resources.TransformHeap)));
+            Resources.DescriptorRing =
+                Conformance::D3D12DescriptorRing(device, QueueWrapper, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, DescriptorRingCapacity);
 
             D3D12_DESCRIPTOR_HEAP_DESC textureHeapDesc;
             textureHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
@@ -208,6 +215,14 @@ namespace Pbr
             D3D12Texture::CreateSampler(device, Resources.BrdfSamplerDescriptor);
             D3D12Texture::CreateSampler(device, Resources.EnvironmentMapSamplerDescriptor);
 
+            D3D12_DESCRIPTOR_HEAP_DESC samplerTableHeapDesc;
+            samplerTableHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER;
+            samplerTableHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+            samplerTableHeapDesc.NumDescriptors = MaxSamplerTables * ShaderSlots::NumSamplers;
+            samplerTableHeapDesc.NodeMask = 1;
+
+            XRC_CHECK_THROW_HRCMD(device->CreateDescriptorHeap(&samplerTableHeapDesc, IID_PPV_ARGS(&Resources.SamplerTableHeap)));
+
             Resources.SupportedTextureFormats = MakeSupportedFormatsList(device);
         }
 
@@ -227,9 +242,12 @@ namespace Pbr
         {
             Microsoft::WRL::ComPtr<ID3D12Device> Device;
 
-            Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> TransformHeap;
             Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> TextureHeap;
             Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> SamplerHeap;
+            Conformance::D3D12DescriptorRing DescriptorRing;
+            Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> SamplerTableHeap;
+            /// Sampler tables in SamplerTableHeap, keyed by the bytes of the material sampler descs they were created from.
+            std::map<std::string, D3D12_GPU_DESCRIPTOR_HANDLE> SamplerTables;
             Microsoft::WRL::ComPtr<ID3D12Resource> BrdfLutTexture;
             Microsoft::WRL::ComPtr<ID3D12Resource> SpecularEnvMapTexture;
             Microsoft::WRL::ComPtr<ID3D12Resource> DiffuseEnvMapTexture;
@@ -242,14 +260,21 @@ namespace Pbr
             Conformance::D3D12BufferWithUpload<SceneConstantBuffer> SceneConstantBuffer;
             std::unique_ptr<D3D12PipelineStates> PipelineStates{};
             std::vector<Conformance::Image::FormatParams> SupportedTextureFormats;
-            mutable D3D12TextureCache SolidColorTextureCache;
+            mutable D3D12TextureCache TextureCache;
         };
         PrimitiveCollection<D3D12Primitive> Primitives;
 
         D3D12_GRAPHICS_PIPELINE_STATE_DESC BasePipelineStateDesc;
+        std::shared_ptr<Conformance::D3D12QueueWrapper> QueueWrapper;
+        Conformance::D3D12PipelineLibrary* PipelineLibrary{nullptr};
         DeviceResources Resources;
         SceneConstantBuffer SceneBuffer;
 
+        /// Transform descriptor of the model instance being rendered.
+        D3D12_CPU_DESCRIPTOR_HANDLE TransformDescriptor{};
+        /// Material whose descriptor tables are bound, reset whenever the bound tables are invalidated.
+        const D3D12Material* BoundMaterial{nullptr};
+
         struct LoaderResources
         {
             // Create D3D cache for reuse of texture views and samplers when possible.
@@ -259,10 +284,12 @@ namespace Pbr
         LoaderResources loaderResources;
     };
 
-    D3D12Resources::D3D12Resources(_In_ ID3D12Device* device, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& basePipelineStateDesc)
+    D3D12Resources::D3D12Resources(_In_ ID3D12Device* device, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& basePipelineStateDesc,
+                                   std::shared_ptr<Conformance::D3D12QueueWrapper> queueWrapper,
+                                   Conformance::D3D12PipelineLibrary* pipelineLibrary)
         : m_impl(std::make_unique<Impl>())
     {
-        m_impl->Initialize(device, basePipelineStateDesc);
+        m_impl->Initialize(device, basePipelineStateDesc, std::move(queueWrapper), pipelineLibrary);
     }
 
     D3D12Resources::D3D12Resources(D3D12Resources&& resources) = default;
@@ -282,15 +309,11 @@ namespace Pbr
         return std::make_shared<D3D12Material>(*this);
     }
 
-    // Create a DirectX texture view from a tinygltf Image.
+    // Create a DirectX texture view from a decoded tinygltf Image.
     static Conformance::D3D12ResourceWithSRVDesc LoadGLTFImage(D3D12Resources& pbrResources, ID3D12GraphicsCommandList* copyCommandList,
-                                                               StagingResources stagingResources, const tinygltf::Image& image, bool sRGB)
+                                                               StagingResources stagingResources, const GltfHelper::DecodedImage& image)
     {
-        // First convert the image to RGBA if it isn't already.
-        std::vector<uint8_t> tempBuffer;
-        Conformance::Image::Image decodedImage = GltfHelper::DecodeImage(image, sRGB, pbrResources.GetSupportedFormats(), tempBuffer);
-
-        return Pbr::D3D12Texture::CreateTexture(pbrResources, copyCommandList, stagingResources, decodedImage);
+        return Pbr::D3D12Texture::CreateTexture(pbrResources, copyCommandList, stagingResources, image.image);
     }
 
     static D3D12_FILTER ConvertFilter(int glMinFilter, int glMagFilter)
@@ -339,7 +362,8 @@ namespace Pbr
     }
     void D3D12Resources::LoadTexture(ID3D12GraphicsCommandList* copyCommandList, StagingResources stagingResources,
                                      const std::shared_ptr<Material>& material, Pbr::ShaderSlots::PSMaterial slot,
-                                     const tinygltf::Image* image, const tinygltf::Sampler* sampler, bool sRGB, Pbr::RGBAColor defaultRGBA)
+                                     const GltfHelper::DecodedImage* image, const tinygltf::Sampler* sampler, bool sRGB,
+                                     Pbr::RGBAColor defaultRGBA)
     {
         auto pbrMaterial = std::dynamic_pointer_cast<D3D12Material>(material);
         if (!pbrMaterial) {
@@ -351,13 +375,13 @@ namespace Pbr
             image != nullptr ? m_impl->loaderResources.imageMap[imageKey]
                              : std::make_shared<Conformance::D3D12ResourceWithSRVDesc>(
                                    CreateTypedSolidColorTexture(copyCommandList, stagingResources, defaultRGBA, sRGB));
-        if (!textureView)  // If not cached, load the image and store it in the texture cache.
+        if (!textureView)  // If not cached, load the image, or find one with the same content, and store it in the texture cache.
         {
             // TODO: Generate mipmaps if sampler's minification filter (minFilter) uses mipmapping.
             // TODO: If texture is not power-of-two and (sampler has wrapping=repeat/mirrored_repeat OR minFilter uses
             // mipmapping), resize to power-of-two.
-            textureView = std::make_shared<Conformance::D3D12ResourceWithSRVDesc>(
-                LoadGLTFImage(*this, copyCommandList, stagingResources, *image, sRGB));
+            textureView = std::make_shared<Conformance::D3D12ResourceWithSRVDesc>(m_impl->Resources.TextureCache.FindOrCreate(
+                image->image, [&] { return LoadGLTFImage(*this, copyCommandList, stagingResources, *image); }));
             m_impl->loaderResources.imageMap[imageKey] = textureView;
         }
 
@@ -388,7 +412,7 @@ namespace Pbr
 
     void D3D12Resources::CreateDeviceDependentResources(_In_ ID3D12Device* device)
     {
-        m_impl->Initialize(device, m_impl->BasePipelineStateDesc);
+        m_impl->Initialize(device, m_impl->BasePipelineStateDesc, m_impl->QueueWrapper, m_impl->PipelineLibrary);
     }
 
     void D3D12Resources::ReleaseDeviceDependentResources()
@@ -403,29 +427,48 @@ namespace Pbr
         return m_impl->Resources.Device;
     }
 
-    void D3D12Resources::SetTransforms(D3D12_CPU_DESCRIPTOR_HANDLE transformDescriptor)
+    void D3D12Resources::Submitted(uint64_t fenceValue)
     {
-        GetDevice()->CopyDescriptorsSimple(ShaderSlots::NumVSResourceViews,
-                                           m_impl->Resources.TransformHeap->GetCPUDescriptorHandleForHeapStart(), transformDescriptor,
-                                           D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+        m_impl->Resources.DescriptorRing.Submitted(fenceValue);
     }
 
-    void D3D12Resources::GetTransforms(D3D12_CPU_DESCRIPTOR_HANDLE destTransformDescriptor)
+    void D3D12Resources::SetTransforms(D3D12_CPU_DESCRIPTOR_HANDLE transformDescriptor)
     {
-        GetDevice()->CopyDescriptorsSimple(ShaderSlots::NumVSResourceViews, destTransformDescriptor,
-                                           m_impl->Resources.TransformHeap->GetCPUDescriptorHandleForHeapStart(),
-                                           D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+        m_impl->TransformDescriptor = transformDescriptor;
+        m_impl->BoundMaterial = nullptr;
     }
 
-    void D3D12Resources::GetGlobalTexturesAndSamplers(D3D12_CPU_DESCRIPTOR_HANDLE destTextureDescriptors,
-                                                      D3D12_CPU_DESCRIPTOR_HANDLE destSamplerDescriptors)
+    D3D12_GPU_DESCRIPTOR_HANDLE D3D12Resources::GetOrCreateSamplerTable(const D3D12Material& material)
     {
-        GetDevice()->CopyDescriptorsSimple((int)ShaderSlots::NumTextures - (int)ShaderSlots::NumMaterialSlots, destTextureDescriptors,
-                                           m_impl->Resources.TextureHeap->GetCPUDescriptorHandleForHeapStart(),
-                                           D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-        GetDevice()->CopyDescriptorsSimple((int)ShaderSlots::NumSamplers - (int)ShaderSlots::NumMaterialSlots, destSamplerDescriptors,
+        const auto& samplerDescs = material.GetSamplerDescs();
+        std::string key(sizeof(samplerDescs), '\0');
+        memcpy(&key[0], samplerDescs.data(), sizeof(samplerDescs));
+
+        auto it = m_impl->Resources.SamplerTables.find(key);
+        if (it != m_impl->Resources.SamplerTables.end()) {
+            return it->second;
+        }
+
+        const UINT tableIndex = (UINT)m_impl->Resources.SamplerTables.size();
+        XRC_CHECK_THROW_MSG(tableIndex < Impl::MaxSamplerTables, "Too many distinct combinations of material samplers");
+
+        ID3D12DescriptorHeap* heap = m_impl->Resources.SamplerTableHeap.Get();
+        const UINT samplerDescriptorSize = GetDevice()->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER);
+        CD3DX12_CPU_DESCRIPTOR_HANDLE cpuHandle(heap->GetCPUDescriptorHandleForHeapStart(), tableIndex * ShaderSlots::NumSamplers,
+                                                samplerDescriptorSize);
+        const CD3DX12_GPU_DESCRIPTOR_HANDLE gpuHandle(heap->GetGPUDescriptorHandleForHeapStart(), tableIndex * ShaderSlots::NumSamplers,
+                                                      samplerDescriptorSize);
+
+        for (const D3D12_SAMPLER_DESC& samplerDesc : samplerDescs) {
+            GetDevice()->CreateSampler(&samplerDesc, cpuHandle);
+            cpuHandle.Offset(1, samplerDescriptorSize);
+        }
+        GetDevice()->CopyDescriptorsSimple((int)ShaderSlots::NumSamplers - (int)ShaderSlots::NumMaterialSlots, cpuHandle,
                                            m_impl->Resources.SamplerHeap->GetCPUDescriptorHandleForHeapStart(),
                                            D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER);
+
+        m_impl->Resources.SamplerTables.emplace(std::move(key), gpuHandle);
+        return gpuHandle;
     }
 
     Microsoft::WRL::ComPtr<ID3D12PipelineState> D3D12Resources::GetOrCreatePipelineState(DXGI_FORMAT colorRenderTargetFormat,
@@ -474,7 +517,12 @@ namespace Pbr
                                                                                        StagingResources stagingResources, RGBAColor color,
                                                                                        bool sRGB)
     {
-        return m_impl->Resources.SolidColorTextureCache.CreateTypedSolidColorTexture(*this, copyCommandList, stagingResources, color, sRGB);
+        return m_impl->Resources.TextureCache.CreateTypedSolidColorTexture(*this, copyCommandList, stagingResources, color, sRGB);
+    }
+
+    void D3D12Resources::SetTextureCacheBudget(uint64_t budgetBytes)
+    {
+        m_impl->Resources.TextureCache.SetBudget(budgetBytes);
     }
 
     span<const Conformance::Image::FormatParams> D3D12Resources::GetSupportedFormats() const
@@ -489,6 +537,11 @@ namespace Pbr
     {
         directCommandList->SetGraphicsRootSignature(m_impl->Resources.RootSignature.Get());
 
+        // Setting the root signature resets the descriptor tables.
+        ID3D12DescriptorHeap* descriptorHeaps[] = {m_impl->Resources.DescriptorRing.GetHeap(), m_impl->Resources.SamplerTableHeap.Get()};
+        directCommandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
+        m_impl->BoundMaterial = nullptr;
+
         m_impl->Resources.SceneConstantBuffer.AsyncUpload(directCommandList, &m_impl->SceneBuffer);
         D3D12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(
             m_impl->Resources.SceneConstantBuffer.GetResource(), D3D12_RESOURCE_STATE_COPY_DEST,
@@ -504,27 +557,42 @@ namespace Pbr
         directCommandList->SetGraphicsRootConstantBufferView(ShaderSlots::ConstantBuffers::Model, modelConstantBufferAddress);
     }
 
-    void D3D12Resources::BindDescriptorHeaps(_In_ ID3D12GraphicsCommandList* directCommandList, ID3D12DescriptorHeap* srvDescriptorHeap,
-                                             ID3D12DescriptorHeap* samplerDescriptorHeap) const
+    void D3D12Resources::BindDescriptorTables(_In_ ID3D12GraphicsCommandList* directCommandList, const D3D12Material& material)
     {
         using RootSig::RootParamIndex;
 
         static_assert(ShaderSlots::DiffuseTexture == ShaderSlots::SpecularTexture + 1, "Diffuse must follow Specular slot");
         static_assert(ShaderSlots::SpecularTexture == ShaderSlots::Brdf + 1, "Specular must follow BRDF slot");
 
-        ID3D12DescriptorHeap* descriptorHeaps[] = {srvDescriptorHeap, samplerDescriptorHeap};
-        directCommandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
-
-        auto srvDescriptorSize = GetDevice()->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+        // Consecutive primitives of a model instance often share a material, and can share its tables too.
+        if (m_impl->BoundMaterial == &material) {
+            return;
+        }
+        m_impl->BoundMaterial = &material;
+
+        ID3D12Device* device = GetDevice().Get();
+        Conformance::D3D12DescriptorRing& ring = m_impl->Resources.DescriptorRing;
+        const Conformance::D3D12DescriptorRing::Allocation table =
+            ring.Allocate(ShaderSlots::NumVSResourceViews + ShaderSlots::NumTextures);
+
+        // vertex shader resource views, then material textures, then global textures
+        CD3DX12_CPU_DESCRIPTOR_HANDLE srvHandle(table.cpuHandle);
+        device->CopyDescriptorsSimple(ShaderSlots::NumVSResourceViews, srvHandle, m_impl->TransformDescriptor,
+                                      D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+        srvHandle.Offset(ShaderSlots::NumVSResourceViews, ring.GetDescriptorSize());
+        device->CopyDescriptorsSimple(ShaderSlots::NumMaterialSlots, srvHandle, material.GetTextureDescriptors(),
+                                      D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+        srvHandle.Offset(ShaderSlots::NumMaterialSlots, ring.GetDescriptorSize());
+        device->CopyDescriptorsSimple((int)ShaderSlots::NumTextures - (int)ShaderSlots::NumMaterialSlots, srvHandle,
+                                      m_impl->Resources.TextureHeap->GetCPUDescriptorHandleForHeapStart(),
+                                      D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 
         // count is defined by InitAsDescriptorTable
-        directCommandList->SetGraphicsRootDescriptorTable(RootParamIndex::TransformsBuffer,
-                                                          srvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
+        directCommandList->SetGraphicsRootDescriptorTable(RootParamIndex::TransformsBuffer, table.gpuHandle);
         directCommandList->SetGraphicsRootDescriptorTable(
-            RootParamIndex::TextureSRVs, CD3DX12_GPU_DESCRIPTOR_HANDLE(srvDescriptorHeap->GetGPUDescriptorHandleForHeapStart(),
-                                                                       ShaderSlots::NumVSResourceViews, srvDescriptorSize));
-        directCommandList->SetGraphicsRootDescriptorTable(RootParamIndex::TextureSamplers,
-                                                          samplerDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
+            RootParamIndex::TextureSRVs,
+            CD3DX12_GPU_DESCRIPTOR_HANDLE(table.gpuHandle, ShaderSlots::NumVSResourceViews, ring.GetDescriptorSize()));
+        directCommandList->SetGraphicsRootDescriptorTable(RootParamIndex::TextureSamplers, GetOrCreateSamplerTable(material));
     }
 
     PrimitiveHandle D3D12Resources::MakePrimitive(ID3D12GraphicsCommandList* copyCommandList, const Pbr::PrimitiveBuilder& primitiveBuilder,
@@ -597,7 +665,7 @@ namespace Pbr
     }
 
     void D3D12GltfBuilder::LoadTexture(const std::shared_ptr<Material>& pbrMaterial, Pbr::ShaderSlots::PSMaterial slot,
-                                       const tinygltf::Image* image, const tinygltf::Sampler* sampler, bool sRGB,
+                                       const GltfHelper::DecodedImage* image, const tinygltf::Sampler* sampler, bool sRGB,
                                        Pbr::RGBAColor defaultRGBA)
     {
         return m_pbrResources.LoadTexture(m_copyCmdList, std::back_inserter(m_stagingResources), pbrMaterial, slot, image, sampler, sRGB,
@@ -608,6 +676,10 @@ namespace Pbr
     {
         return m_pbrResources.MakePrimitive(m_copyCmdList, primitiveBuilder, material);
     }
+    span<const Conformance::Image::FormatParams> D3D12GltfBuilder::GetSupportedFormats() const
+    {
+        return m_pbrResources.GetSupportedFormats();
+    }
     void D3D12GltfBuilder::DropLoaderCaches()
     {
         return m_pbrResources.DropLoaderCaches();
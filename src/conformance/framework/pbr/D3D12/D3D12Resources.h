@@ -52,7 +52,11 @@ namespace Pbr
     /// Global PBR resources required for rendering a scene.
     struct D3D12Resources final
     {
-        D3D12Resources(_In_ ID3D12Device* device, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& basePipelineStateDesc);
+        /// @param queueWrapper Queue that rendering is submitted to, used to recycle the descriptor tables of draws.
+        /// @param pipelineLibrary Library to load and store pipeline states in, may be null: must outlive this object.
+        D3D12Resources(_In_ ID3D12Device* device, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& basePipelineStateDesc,
+                       std::shared_ptr<Conformance::D3D12QueueWrapper> queueWrapper,
+                       Conformance::D3D12PipelineLibrary* pipelineLibrary = nullptr);
         D3D12Resources(D3D12Resources&&);
 
         ~D3D12Resources();
@@ -67,8 +71,8 @@ namespace Pbr
         std::shared_ptr<Material> CreateMaterial();
 
         void LoadTexture(ID3D12GraphicsCommandList* copyCommandList, StagingResources stagingResources,
-                         const std::shared_ptr<Material>& pbrMaterial, Pbr::ShaderSlots::PSMaterial slot, const tinygltf::Image* image,
-                         const tinygltf::Sampler* sampler, bool sRGB, Pbr::RGBAColor defaultRGBA);
+                         const std::shared_ptr<Material>& pbrMaterial, Pbr::ShaderSlots::PSMaterial slot,
+                         const GltfHelper::DecodedImage* image, const tinygltf::Sampler* sampler, bool sRGB, Pbr::RGBAColor defaultRGBA);
         PrimitiveHandle MakePrimitive(ID3D12GraphicsCommandList* copyCommandList, const Pbr::PrimitiveBuilder& primitiveBuilder,
                                       const std::shared_ptr<Pbr::Material>& material);
         void DropLoaderCaches();
@@ -106,12 +110,19 @@ namespace Pbr
         Conformance::D3D12ResourceWithSRVDesc CreateTypedSolidColorTexture(ID3D12GraphicsCommandList* copyCommandList,
                                                                            StagingResources stagingResources, RGBAColor color, bool sRGB);
 
+        /// Set the bytes of textures kept cached once no model uses them. See Pbr::TextureCache.
+        void SetTextureCacheBudget(uint64_t budgetBytes);
+
         /// Get the cached list of texture formats supported by the device
         span<const Conformance::Image::FormatParams> GetSupportedFormats() const;
 
         /// Bind the the PBR resources to the current context.
         void Bind(_In_ ID3D12GraphicsCommandList* directCommandList) const;
 
+        /// Mark the descriptor tables written while rendering since the last call as used by the submission that signals
+        /// @p fenceValue, so they are recycled once it completes.
+        void Submitted(uint64_t fenceValue);
+
         /// Get the D3D12Primitive from a primitive handle.
         D3D12Primitive& GetPrimitive(PrimitiveHandle p);
 
@@ -127,15 +138,14 @@ namespace Pbr
 
     private:
         void SetTransforms(D3D12_CPU_DESCRIPTOR_HANDLE transformDescriptor);
-        void GetTransforms(D3D12_CPU_DESCRIPTOR_HANDLE destTransformDescriptor);
-        void GetGlobalTexturesAndSamplers(D3D12_CPU_DESCRIPTOR_HANDLE destTextureDescriptors,
-                                          D3D12_CPU_DESCRIPTOR_HANDLE destSamplerDescriptors);
+        /// Get the shader-visible sampler table of a material's samplers followed by the global samplers, created on first use.
+        D3D12_GPU_DESCRIPTOR_HANDLE GetOrCreateSamplerTable(const D3D12Material& material);
         // Bind the scene constant buffer as well as a provided model constant buffer.
         void BindConstantBufferViews(_In_ ID3D12GraphicsCommandList* directCommandList,
                                      D3D12_GPU_VIRTUAL_ADDRESS modelConstantBufferAddress) const;
-        /// Bind a material's descriptors according to the root signature.
-        void BindDescriptorHeaps(_In_ ID3D12GraphicsCommandList* directCommandList, ID3D12DescriptorHeap* srvDescriptorHeap,
-                                 ID3D12DescriptorHeap* samplerDescriptorHeap) const;
+        /// Bind the transforms and a material's textures and samplers according to the root signature, writing the resource
+        /// views to tables in the descriptor ring.
+        void BindDescriptorTables(_In_ ID3D12GraphicsCommandList* directCommandList, const D3D12Material& material);
 
         friend struct D3D12Material;
         friend class D3D12ModelInstance;
@@ -156,8 +166,10 @@ namespace Pbr
                                                      RGBColor emissiveFactor = RGB::Black) override;
         std::shared_ptr<Material> CreateMaterial() override;
 
-        void LoadTexture(const std::shared_ptr<Material>& pbrMaterial, Pbr::ShaderSlots::PSMaterial slot, const tinygltf::Image* image,
-                         const tinygltf::Sampler* sampler, bool sRGB, Pbr::RGBAColor defaultRGBA) override;
+        void LoadTexture(const std::shared_ptr<Material>& pbrMaterial, Pbr::ShaderSlots::PSMaterial slot,
+                         const GltfHelper::DecodedImage* image, const tinygltf::Sampler* sampler, bool sRGB,
+                         Pbr::RGBAColor defaultRGBA) override;
+        span<const Conformance::Image::FormatParams> GetSupportedFormats() const override;
         PrimitiveHandle MakePrimitive(const Pbr::PrimitiveBuilder& primitiveBuilder,
                                       const std::shared_ptr<Pbr::Material>& material) override;
         void DropLoaderCaches() override;
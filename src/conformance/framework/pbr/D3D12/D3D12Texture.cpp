@@ -148,9 +148,9 @@ namespace Pbr
             srvDesc.Format = ToDXGIFormat(image.format);
             srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
             srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-            srvDesc.TextureCube.MipLevels = 1;
-            srvDesc.TextureCube.MostDetailedMip = 0;
-            srvDesc.TextureCube.ResourceMinLODClamp = 0.0f;
+            srvDesc.Texture2D.MipLevels = (UINT)image.levels.size();
+            srvDesc.Texture2D.MostDetailedMip = 0;
+            srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
 
             return Conformance::D3D12ResourceWithSRVDesc{std::move(texture), srvDesc};
         }
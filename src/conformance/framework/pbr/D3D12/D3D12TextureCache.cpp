@@ -21,14 +21,9 @@
 
 #include <array>
 #include <memory>
-#include <mutex>
 
 namespace Pbr
 {
-    D3D12TextureCache::D3D12TextureCache() : m_cacheMutex(std::make_unique<std::mutex>())
-    {
-    }
-
     Conformance::D3D12ResourceWithSRVDesc D3D12TextureCache::CreateTypedSolidColorTexture(Pbr::D3D12Resources& pbrResources,
                                                                                           ID3D12GraphicsCommandList* copyCommandList,
                                                                                           StagingResources stagingResources,
@@ -36,25 +31,12 @@ namespace Pbr
     {
         const std::array<uint8_t, 4> rgba = LoadRGBAUI4(color);
 
-        // Check cache to see if this flat texture already exists.
-        const uint32_t colorKey = *reinterpret_cast<const uint32_t*>(rgba.data());
-        {
-            std::lock_guard<std::mutex> guard(*m_cacheMutex);
-            auto textureIt = m_solidColorTextureCache.find(colorKey);
-            if (textureIt != m_solidColorTextureCache.end()) {
-                return textureIt->second;
-            }
-        }
-
         auto formatParams = Conformance::Image::FormatParams::R8G8B8A8(sRGB);
         auto metadata = Conformance::Image::ImageLevelMetadata::MakeUncompressed(1, 1);
         auto image = Conformance::Image::Image{formatParams, {{metadata, rgba}}};
 
-        Conformance::D3D12ResourceWithSRVDesc texture = D3D12Texture::CreateTexture(pbrResources, copyCommandList, stagingResources, image);
-
-        std::lock_guard<std::mutex> guard(*m_cacheMutex);
-        // If the key already exists then the existing texture will be returned.
-        return m_solidColorTextureCache.emplace(colorKey, texture).first->second;
+        return m_textures.FindOrCreate(
+            image, [&] { return D3D12Texture::CreateTexture(pbrResources, copyCommandList, stagingResources, image); });
     }
 }  // namespace Pbr
 
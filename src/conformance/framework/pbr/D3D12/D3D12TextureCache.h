@@ -11,28 +11,39 @@
 
 #include "D3D12Resources.h"
 
+#include "../PbrTextureCache.h"
+
 #include "utilities/d3d12_utils.h"
 
 #include <d3d12.h>
 #include <openxr/openxr.h>
 #include <wrl/client.h>  // For Microsoft::WRL::ComPtr
 
-#include <map>
 #include <memory>
-#include <mutex>
+#include <utility>
 
 namespace Pbr
 {
     template <typename T>
     using ComPtr = Microsoft::WRL::ComPtr<T>;
 
-    /// Cache of single-color textures.
+    template <>
+    struct TextureReferences<Conformance::D3D12ResourceWithSRVDesc>
+    {
+        static bool HeldOnlyByCache(const Conformance::D3D12ResourceWithSRVDesc& texture)
+        {
+            texture.resource->AddRef();
+            return texture.resource->Release() == 1;
+        }
+    };
+
+    /// Cache of textures by content, including single-color textures. See Pbr::TextureCache.
     ///
     /// Device-dependent, drop when device is lost or destroyed.
     class D3D12TextureCache
     {
     public:
-        D3D12TextureCache();
+        D3D12TextureCache() = default;
 
         D3D12TextureCache(D3D12TextureCache&&) = default;
         D3D12TextureCache& operator=(D3D12TextureCache&&) = default;
@@ -42,10 +53,20 @@ namespace Pbr
                                                                            ID3D12GraphicsCommandList* copyCommandList,
                                                                            StagingResources stagingResources, XrColor4f color, bool sRGB);
 
+        /// Find the texture with the content of @p image, or create it by calling @p create.
+        template <typename Create>
+        Conformance::D3D12ResourceWithSRVDesc FindOrCreate(const Conformance::Image::Image& image, Create&& create)
+        {
+            return m_textures.FindOrCreate(image, std::forward<Create>(create));
+        }
+
+        void SetBudget(uint64_t budgetBytes)
+        {
+            m_textures.SetBudget(budgetBytes);
+        }
+
     private:
-        // in unique_ptr to make it moveable
-        std::unique_ptr<std::mutex> m_cacheMutex;
-        std::map<uint32_t, Conformance::D3D12ResourceWithSRVDesc> m_solidColorTextureCache;
+        TextureCache<Conformance::D3D12ResourceWithSRVDesc> m_textures;
     };
 
 }  // namespace Pbr
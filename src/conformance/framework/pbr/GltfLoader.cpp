@@ -21,6 +21,7 @@
 #include <openxr/openxr.h>
 #include <tinygltf/tiny_gltf.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <limits>
 #include <map>
@@ -32,6 +33,20 @@
 
 namespace
 {
+    // Collect the primitives of the meshes of a glTF node and its children, so that they can be read in advance.
+    void CollectPrimitives(const tinygltf::Model& gltfModel, int nodeId, std::vector<const tinygltf::Primitive*>& gltfPrimitives)
+    {
+        const tinygltf::Node& gltfNode = gltfModel.nodes.at(nodeId);
+        if (gltfNode.mesh != -1) {
+            for (const tinygltf::Primitive& gltfPrimitive : gltfModel.meshes.at(gltfNode.mesh).primitives) {
+                gltfPrimitives.push_back(&gltfPrimitive);
+            }
+        }
+        for (const int childNodeId : gltfNode.children) {
+            CollectPrimitives(gltfModel, childNodeId, gltfPrimitives);
+        }
+    }
+
     // Load a glTF node from the tinygltf object model. This will process the node's mesh (if specified) and then recursively load the child
     // nodes too.
     void LoadNode(Pbr::NodeIndex_t parentNodeIndex, const tinygltf::Model& gltfModel, int nodeId,
@@ -92,28 +107,53 @@ namespace
             LoadNode(transformIndex, gltfModel, childNodeId, primitiveCache, primitiveBuilderMap, model);
         }
     }
+
+    // Call f(slot, texture, sRGB, defaultRGBA) for each of the textures of a material.
+    template <typename F>
+    void ForEachMaterialTexture(const GltfHelper::Material& material, F&& f)
+    {
+        f(Pbr::ShaderSlots::BaseColor, material.BaseColorTexture, true /* sRGB */, Pbr::RGBA::White);
+        f(Pbr::ShaderSlots::MetallicRoughness, material.MetallicRoughnessTexture, false /* sRGB */, Pbr::RGBA::White);
+        f(Pbr::ShaderSlots::Emissive, material.EmissiveTexture, true /* sRGB */, Pbr::RGBA::White);
+        f(Pbr::ShaderSlots::Normal, material.NormalTexture, false /* sRGB */, Pbr::RGBA::FlatNormal);
+        f(Pbr::ShaderSlots::Occlusion, material.OcclusionTexture, false /* sRGB */, Pbr::RGBA::White);
+    }
 }  // namespace
 
 namespace Gltf
 {
-    void ModelBuilder::SharedInit()
+    std::shared_ptr<const DecodedScene> DecodeScene(const tinygltf::Model& gltfModel, bool optimizePrimitives)
     {
-        m_pbrModel = std::make_shared<Pbr::Model>();
+        auto scene = std::make_shared<DecodedScene>();
 
-        GltfHelper::PrimitiveCache primitiveCache{*m_gltfModel};
+        GltfHelper::PrimitiveCache primitiveCache{gltfModel, optimizePrimitives};
 
-        const int defaultSceneId = (m_gltfModel->defaultScene == -1) ? 0 : m_gltfModel->defaultScene;
-        const tinygltf::Scene& defaultScene = m_gltfModel->scenes.at(defaultSceneId);
+        const int defaultSceneId = (gltfModel.defaultScene == -1) ? 0 : gltfModel.defaultScene;
+        const tinygltf::Scene& defaultScene = gltfModel.scenes.at(defaultSceneId);
+
+        // Read the vertices and indices, and generate tangents, of all the primitives at once, in parallel.
+        std::vector<const tinygltf::Primitive*> gltfPrimitives;
+        for (const int rootNodeId : defaultScene.nodes) {
+            CollectPrimitives(gltfModel, rootNodeId, gltfPrimitives);
+        }
+        primitiveCache.ReadPrimitives(gltfPrimitives);
 
         // Process the root scene nodes. The children will be processed recursively.
         for (const int rootNodeId : defaultScene.nodes) {
-            LoadNode(Pbr::RootNodeIndex, *m_gltfModel, rootNodeId, primitiveCache, m_primitiveBuilderMap, *m_pbrModel);
+            LoadNode(Pbr::RootNodeIndex, gltfModel, rootNodeId, primitiveCache, scene->PrimitiveBuilders, scene->NodeModel);
         }
+        scene->VertexCacheStats = primitiveCache.GetVertexCacheStats();
+        return scene;
     }
 
-    ModelBuilder::ModelBuilder(std::shared_ptr<const tinygltf::Model> gltfModel) : m_gltfModel(std::move(gltfModel))
+    ModelBuilder::ModelBuilder(std::shared_ptr<const tinygltf::Model> gltfModel)
+        : m_gltfModel(std::move(gltfModel)), m_scene(DecodeScene(*m_gltfModel))
+    {
+    }
+
+    ModelBuilder::ModelBuilder(std::shared_ptr<const tinygltf::Model> gltfModel, std::shared_ptr<const DecodedScene> scene)
+        : m_gltfModel(std::move(gltfModel)), m_scene(std::move(scene))
     {
-        SharedInit();
     }
     ModelBuilder::ModelBuilder(const uint8_t* buffer, uint32_t bufferBytes)
     {
@@ -129,21 +169,57 @@ namespace Gltf
         }
 
         m_gltfModel = std::move(gltfModel);
-        SharedInit();
+        m_scene = DecodeScene(*m_gltfModel);
+    }
+
+    void ModelBuilder::DecodeImages(nonstd::span<const Conformance::Image::FormatParams> supportedFormats)
+    {
+        if (m_gltfModel == nullptr) {
+            throw std::logic_error("ModelBuilder::DecodeImages has no model - must not be called after Build");
+        }
+
+        if (m_decodedFormats.size() != supportedFormats.size() ||
+            !std::equal(supportedFormats.begin(), supportedFormats.end(), m_decodedFormats.begin())) {
+            // Anything decoded earlier may be in a format this backend cannot use.
+            m_decodedImages.clear();
+            m_decodedFormats.assign(supportedFormats.begin(), supportedFormats.end());
+        }
+
+        // Only the materials used by the active scene are loaded by Build, so only decode their images.
+        for (const auto& primitiveBuilderPair : m_scene->PrimitiveBuilders) {
+            const int materialIndex = primitiveBuilderPair.first;
+            if (materialIndex == -1) {
+                continue;
+            }
+            const GltfHelper::Material material = GltfHelper::ReadMaterial(*m_gltfModel, m_gltfModel->materials.at(materialIndex));
+            ForEachMaterialTexture(material, [&](Pbr::ShaderSlots::PSMaterial /* slot */, const GltfHelper::Material::Texture& texture,
+                                                 bool sRGB, Pbr::RGBAColor /* defaultRGBA */) {
+                if (texture.Image == nullptr) {
+                    return;
+                }
+                std::unique_ptr<GltfHelper::DecodedImage>& decodedImage = m_decodedImages[std::make_tuple(texture.Image, sRGB)];
+                if (!decodedImage) {
+                    decodedImage = std::make_unique<GltfHelper::DecodedImage>(*texture.Image, sRGB, supportedFormats);
+                }
+            });
+        }
     }
 
     std::shared_ptr<Pbr::Model> ModelBuilder::Build(Pbr::IGltfBuilder& gltfBuilder)
     {
-        if (m_pbrModel == nullptr) {
+        if (m_scene == nullptr) {
             throw std::logic_error("ModelBuilder::Build has no model - must not be called more than once");
         }
 
+        // Usually a no-op, if DecodeImages was called in advance.
+        DecodeImages(gltfBuilder.GetSupportedFormats());
+
         // Load the materials referenced by the primitives
         std::map<int, std::shared_ptr<Pbr::Material>> materialMap;
         {
             // primitiveBuilderMap is grouped by material. Loop through the referenced materials and load their resources. This will only
             // load materials which are used by the active scene.
-            for (const auto& primitiveBuilderPair : m_primitiveBuilderMap) {
+            for (const auto& primitiveBuilderPair : m_scene->PrimitiveBuilders) {
                 std::shared_ptr<Pbr::Material> pbrMaterial;
 
                 const int materialIndex = primitiveBuilderPair.first;
@@ -160,15 +236,12 @@ namespace Gltf
 
                     pbrMaterial->Name = gltfMaterial.name;
 
-                    auto loadTexture = [&](Pbr::ShaderSlots::PSMaterial slot, const GltfHelper::Material::Texture& texture, bool sRGB,
-                                           Pbr::RGBAColor defaultRGBA) {
-                        gltfBuilder.LoadTexture(pbrMaterial, slot, texture.Image, texture.Sampler, sRGB, defaultRGBA);
-                    };
-                    loadTexture(Pbr::ShaderSlots::BaseColor, material.BaseColorTexture, true /* sRGB */, Pbr::RGBA::White);
-                    loadTexture(Pbr::ShaderSlots::MetallicRoughness, material.MetallicRoughnessTexture, false /* sRGB */, Pbr::RGBA::White);
-                    loadTexture(Pbr::ShaderSlots::Emissive, material.EmissiveTexture, true /* sRGB */, Pbr::RGBA::White);
-                    loadTexture(Pbr::ShaderSlots::Normal, material.NormalTexture, false /* sRGB */, Pbr::RGBA::FlatNormal);
-                    loadTexture(Pbr::ShaderSlots::Occlusion, material.OcclusionTexture, false /* sRGB */, Pbr::RGBA::White);
+                    ForEachMaterialTexture(material, [&](Pbr::ShaderSlots::PSMaterial slot, const GltfHelper::Material::Texture& texture,
+                                                         bool sRGB, Pbr::RGBAColor defaultRGBA) {
+                        const GltfHelper::DecodedImage* decodedImage =
+                            texture.Image != nullptr ? m_decodedImages.at(std::make_tuple(texture.Image, sRGB)).get() : nullptr;
+                        gltfBuilder.LoadTexture(pbrMaterial, slot, decodedImage, texture.Sampler, sRGB, defaultRGBA);
+                    });
 
                     pbrMaterial->SetDoubleSided(material.DoubleSided ? Pbr::DoubleSided::DoubleSided : Pbr::DoubleSided::NotDoubleSided);
                     pbrMaterial->SetAlphaBlended(material.AlphaMode == GltfHelper::AlphaModeType::Blend ? Pbr::BlendState::AlphaBlended
@@ -189,19 +262,23 @@ namespace Gltf
             }
         }
 
-        // Convert the primitive builders into primitives with their respective material and add it into the Pbr Model.
-        for (const auto& primitiveBuilderPair : m_primitiveBuilderMap) {
+        // Convert the primitive builders into primitives with their respective material and add it into a copy of the node model.
+        auto pbrModel = std::make_shared<Pbr::Model>(m_scene->NodeModel);
+        for (const auto& primitiveBuilderPair : m_scene->PrimitiveBuilders) {
             const Pbr::PrimitiveBuilder& primitiveBuilder = primitiveBuilderPair.second;
             const std::shared_ptr<Pbr::Material>& material = materialMap.find(primitiveBuilderPair.first)->second;
             auto handle = gltfBuilder.MakePrimitive(primitiveBuilder, material);
-            m_pbrModel->AddPrimitive(handle);
+            pbrModel->AddPrimitive(handle, primitiveBuilder.ComputeNodeBounds());
         }
 
         gltfBuilder.DropLoaderCaches();
 
+        // The decoded images may refer to the tinygltf model's data, so release them first.
+        m_decodedImages.clear();
+        m_decodedFormats.clear();
         m_gltfModel = nullptr;
-        m_primitiveBuilderMap = {};
+        m_scene = nullptr;
 
-        return std::move(m_pbrModel);
+        return pbrModel;
     }
 }  // namespace Gltf
@@ -15,10 +15,18 @@
 #include "IGltfBuilder.h"
 #include "PbrModel.h"
 
+#include "../gltf/GltfHelper.h"
+
+#include <utilities/image.h>
+
+#include <nonstd/span.hpp>
+
 #include <map>
 #include <memory>
 #include <stdint.h>
+#include <tuple>
 #include <type_traits>
+#include <vector>
 
 namespace Pbr
 {
@@ -37,6 +45,22 @@ namespace Gltf
     // the same material into a single primitive for reduced draw calls. Each primitive's vertex specifies
     // which node it corresponds to any appropriate node transformation be happen in the shader.
     using PrimitiveBuilderMap = std::map<int, Pbr::PrimitiveBuilder>;
+
+    /// The nodes and primitives of the default scene of a glTF model, read from its buffers.
+    /// Never modified once decoded, so every ModelBuilder of the same glTF model can share one.
+    struct DecodedScene
+    {
+        /// A model with the nodes of the scene and no primitives yet
+        Pbr::Model NodeModel;
+        PrimitiveBuilderMap PrimitiveBuilders;
+        /// How well the primitives use the post-transform vertex cache, before and after optimizing them
+        GltfHelper::VertexCacheStats VertexCacheStats;
+    };
+
+    /// Read the nodes and primitives of the default scene of @p gltfModel, generating tangents where needed.
+    /// With @p optimizePrimitives, primitives are passed through GltfHelper::OptimizePrimitive as they are read.
+    std::shared_ptr<const DecodedScene> DecodeScene(const tinygltf::Model& gltfModel, bool optimizePrimitives = true);
+
     class ModelBuilder
     {
     public:
@@ -47,6 +71,8 @@ namespace Gltf
         ~ModelBuilder() = default;
 
         ModelBuilder(std::shared_ptr<const tinygltf::Model> gltfModel);
+        /// Build from a scene already decoded from @p gltfModel by DecodeScene, e.g. for an earlier ModelBuilder.
+        ModelBuilder(std::shared_ptr<const tinygltf::Model> gltfModel, std::shared_ptr<const DecodedScene> scene);
         ModelBuilder(const uint8_t* buffer, uint32_t bufferBytes);
 
         template <typename Container>
@@ -55,14 +81,26 @@ namespace Gltf
         {
         }
 
+        /// Decode (and transcode, for KTX2) the images used by the model's materials, for a backend supporting @p supportedFormats.
+        /// This makes no graphics API calls, so it may be done on a worker thread to keep decoding out of Build, which then only
+        /// has to upload the images. Build decodes anything not already decoded for its builder's formats.
+        void DecodeImages(nonstd::span<const Conformance::Image::FormatParams> supportedFormats);
+
         std::shared_ptr<Pbr::Model> Build(Pbr::IGltfBuilder& gltfBuilder);
 
-    private:
-        void SharedInit();
+        /// The scene this builds a model of. Null after Build.
+        const std::shared_ptr<const DecodedScene>& GetDecodedScene() const noexcept
+        {
+            return m_scene;
+        }
 
     private:
-        std::shared_ptr<Pbr::Model> m_pbrModel;
+        using DecodedImageKey = std::tuple<const tinygltf::Image*, bool>;  // Item1 is a pointer to the image, Item2 is sRGB.
+
         std::shared_ptr<const tinygltf::Model> m_gltfModel;
-        PrimitiveBuilderMap m_primitiveBuilderMap;
+        std::shared_ptr<const DecodedScene> m_scene;
+        /// The formats that m_decodedImages were decoded for
+        std::vector<Conformance::Image::FormatParams> m_decodedFormats;
+        std::map<DecodedImageKey, std::unique_ptr<GltfHelper::DecodedImage>> m_decodedImages;
     };
 }  // namespace Gltf
@@ -12,14 +12,22 @@
 #include "PbrHandles.h"
 #include "PbrSharedState.h"
 
+#include <utilities/image.h>
+
+#include <nonstd/span.hpp>
+
 #include <memory>
 
 namespace tinygltf
 {
-    struct Image;
     struct Sampler;
 }  // namespace tinygltf
 
+namespace GltfHelper
+{
+    struct DecodedImage;
+}  // namespace GltfHelper
+
 namespace Pbr
 {
 
@@ -41,8 +49,14 @@ namespace Pbr
 
         virtual std::shared_ptr<Material> CreateMaterial() = 0;
 
-        virtual void LoadTexture(const std::shared_ptr<Material>& material, Pbr::ShaderSlots::PSMaterial slot, const tinygltf::Image* image,
-                                 const tinygltf::Sampler* sampler, bool sRGB, Pbr::RGBAColor defaultRGBA) = 0;
+        /// Texture formats that images passed to LoadTexture may be decoded to.
+        /// Must be safe to call from any thread, so that images can be decoded ahead of time.
+        virtual nonstd::span<const Conformance::Image::FormatParams> GetSupportedFormats() const = 0;
+
+        /// @p image is null if the material has no texture in @p slot, in which case @p defaultRGBA is used.
+        virtual void LoadTexture(const std::shared_ptr<Material>& material, Pbr::ShaderSlots::PSMaterial slot,
+                                 const GltfHelper::DecodedImage* image, const tinygltf::Sampler* sampler, bool sRGB,
+                                 Pbr::RGBAColor defaultRGBA) = 0;
 
         virtual PrimitiveHandle MakePrimitive(const Pbr::PrimitiveBuilder& primitiveBuilder,
                                               const std::shared_ptr<Pbr::Material>& material) = 0;
@@ -44,10 +44,10 @@ namespace Pbr
         : MetalPrimitive((uint32_t)primitiveBuilder.Indices.size(), nullptr, nullptr, std::move(material),
                          primitiveBuilder.NodeIndicesVector())
     {
-        m_indexBuffer = NS::TransferPtr(pbrResources.GetDevice()->newBuffer(
-            primitiveBuilder.Indices.data(), GetPbrIndexByteSize(primitiveBuilder.Indices.size()), MTL::ResourceStorageModeManaged));
-        m_vertexBuffer = NS::TransferPtr(pbrResources.GetDevice()->newBuffer(
-            primitiveBuilder.Vertices.data(), GetPbrVertexByteSize(primitiveBuilder.Vertices.size()), MTL::ResourceStorageModeManaged));
+        // The buffers are never written again, so they are placed in private storage.
+        Conformance::MetalStaticResourceHeaps& heaps = pbrResources.GetStaticResourceHeaps();
+        m_indexBuffer = heaps.NewBuffer(primitiveBuilder.Indices.data(), GetPbrIndexByteSize(primitiveBuilder.Indices.size()));
+        m_vertexBuffer = heaps.NewBuffer(primitiveBuilder.Vertices.data(), GetPbrVertexByteSize(primitiveBuilder.Vertices.size()));
     }
 
     MetalPrimitive MetalPrimitive::Clone(const MetalResources& pbrResources) const
@@ -55,34 +55,13 @@ namespace Pbr
         return MetalPrimitive(m_indexCount, m_indexBuffer.get(), m_vertexBuffer.get(), m_material->Clone(pbrResources), m_nodeIndices);
     }
 
-    void MetalPrimitive::UpdateBuffers(MTL::Device* device, const Pbr::PrimitiveBuilder& primitiveBuilder)
+    void MetalPrimitive::UpdateBuffers(const MetalResources& pbrResources, const Pbr::PrimitiveBuilder& primitiveBuilder)
     {
-        // Update vertex buffer.
-        {
-            uint32_t required_vb_size = GetPbrVertexByteSize(primitiveBuilder.Vertices.size());
-            if (required_vb_size <= m_vertexBuffer->length()) {
-                memcpy(m_vertexBuffer->contents(), primitiveBuilder.Vertices.data(), required_vb_size);
-                m_vertexBuffer->didModifyRange(NS::Range(0, required_vb_size));
-            }
-            else {
-                m_vertexBuffer =
-                    NS::TransferPtr(device->newBuffer(primitiveBuilder.Vertices.data(), required_vb_size, MTL::ResourceStorageModeManaged));
-            }
-        }
-
-        // Update index buffer.
-        {
-            uint32_t required_ib_size = GetPbrIndexByteSize(primitiveBuilder.Indices.size());
-            if (required_ib_size <= m_indexBuffer->length()) {
-                memcpy(m_indexBuffer->contents(), primitiveBuilder.Indices.data(), required_ib_size);
-                m_indexBuffer->didModifyRange(NS::Range(0, required_ib_size));
-            }
-            else {
-                m_indexBuffer =
-                    NS::TransferPtr(device->newBuffer(primitiveBuilder.Indices.data(), required_ib_size, MTL::ResourceStorageModeManaged));
-            }
-        }
-
+        // The buffers are in private storage, so new ones are uploaded rather than writing to them. Primitives sharing the
+        // old buffers through Clone keep them.
+        Conformance::MetalStaticResourceHeaps& heaps = pbrResources.GetStaticResourceHeaps();
+        m_vertexBuffer = heaps.NewBuffer(primitiveBuilder.Vertices.data(), GetPbrVertexByteSize(primitiveBuilder.Vertices.size()));
+        m_indexBuffer = heaps.NewBuffer(primitiveBuilder.Indices.data(), GetPbrIndexByteSize(primitiveBuilder.Indices.size()));
         m_indexCount = (uint32_t)primitiveBuilder.Indices.size();
     }
 
@@ -35,7 +35,8 @@ namespace Pbr
         MetalPrimitive(const MetalResources& pbrResources, const Pbr::PrimitiveBuilder& primitiveBuilder,
                        const std::shared_ptr<MetalMaterial>& material, bool updatableBuffers = false);
 
-        void UpdateBuffers(MTL::Device* device, const Pbr::PrimitiveBuilder& primitiveBuilder);
+        /// Replace the buffers with ones holding the contents of @p primitiveBuilder.
+        void UpdateBuffers(const MetalResources& pbrResources, const Pbr::PrimitiveBuilder& primitiveBuilder);
 
         /// Get the material for the primitive.
         const std::shared_ptr<MetalMaterial>& GetMaterial() const
@@ -67,21 +67,15 @@ namespace Pbr
         return ret;
     }
 
-    // Create a Metal texture from a tinygltf Image.
-    static NS::SharedPtr<MTL::Texture> MetalLoadGLTFImage(MetalResources& pbrResources, const tinygltf::Image& image, bool sRGB)
+    // Create a Metal texture from a decoded tinygltf Image.
+    static NS::SharedPtr<MTL::Texture> MetalLoadGLTFImage(MetalResources& pbrResources, const GltfHelper::DecodedImage& image)
     {
-        NS::SharedPtr<MTL::Texture> result;
-
         NS::String* label = MTLSTR("<unknown>");
-        if (!image.name.empty()) {
-            label = NS::String::string(image.name.c_str(), NS::UTF8StringEncoding);  // autorelease
+        if (!image.source->name.empty()) {
+            label = NS::String::string(image.source->name.c_str(), NS::UTF8StringEncoding);  // autorelease
         }
 
-        // First convert the image to RGBA if it isn't already.
-        std::vector<uint8_t> tempBuffer;
-        Conformance::Image::Image decodedImage = GltfHelper::DecodeImage(image, sRGB, pbrResources.GetSupportedFormats(), tempBuffer);
-
-        return Pbr::MetalTexture::CreateTexture(pbrResources, decodedImage, label);
+        return Pbr::MetalTexture::CreateTexture(pbrResources, image.image, label, true);
     }
 
     static MTL::SamplerMinMagFilter MetalConvertFilter(int glMinMagFilter)
@@ -133,7 +127,8 @@ namespace Pbr
     }
 
     void MetalResources::LoadTexture(const std::shared_ptr<Material>& material, Pbr::ShaderSlots::PSMaterial slot,
-                                     const tinygltf::Image* image, const tinygltf::Sampler* sampler, bool sRGB, Pbr::RGBAColor defaultRGBA)
+                                     const GltfHelper::DecodedImage* image, const tinygltf::Sampler* sampler, bool sRGB,
+                                     Pbr::RGBAColor defaultRGBA)
     {
         auto pbrMaterial = std::dynamic_pointer_cast<MetalMaterial>(material);
         if (!pbrMaterial) {
@@ -143,12 +138,13 @@ namespace Pbr
         const ImageKey imageKey = std::make_tuple(image, sRGB);
         NS::SharedPtr<MTL::Texture> texture =
             image != nullptr ? m_LoaderResources.imageMap[imageKey] : CreateTypedSolidColorTexture(defaultRGBA, sRGB);
-        if (!texture)  // If not cached, load the image and store it in the texture cache.
+        if (!texture)  // If not cached, load the image, or find one with the same content, and store it in the texture cache.
         {
-            // TODO: Generate mipmaps if sampler's minification filter (minFilter) uses mipmapping.
+            // Mipmaps are generated whether or not this sampler's minification filter (minFilter) uses them, since the
+            // image may be shared with another sampler that does.
             // TODO: If texture is not power-of-two and (sampler has wrapping=repeat/mirrored_repeat OR minFilter uses
             // mipmapping), resize to power-of-two.
-            texture = MetalLoadGLTFImage(*this, *image, sRGB);
+            texture = m_Resources.TextureCache.FindOrCreate(image->image, [&] { return MetalLoadGLTFImage(*this, *image); });
             m_LoaderResources.imageMap[imageKey] = texture;
         }
 
@@ -236,13 +232,22 @@ namespace Pbr
         m_Resources.PipelineStates = std::make_unique<MetalPipelineStates>(
             m_Resources.PbrVertexShader.get(), m_Resources.PbrPixelShader.get(), m_Resources.VertexDescriptor.get());
 
-        m_Resources.SolidColorTextureCache = MetalTextureCache(device);
+        m_Resources.TextureCache = MetalTextureCache(device);
+
+        m_Resources.UploadCommandQueue = NS::TransferPtr(device->newCommandQueue());
+        m_Resources.UploadCommandQueue->setLabel(MTLSTR("PbrUploadCommandQueue"));
+        m_Resources.StaticResourceHeaps =
+            std::make_unique<Conformance::MetalStaticResourceHeaps>(device, m_Resources.UploadCommandQueue.get());
 
         m_Resources.SupportedTextureFormats = MakeSupportedFormatsList(device);
     }
 
     void MetalResources::ReleaseDeviceDependentResources()
     {
+        if (m_Resources.StaticResourceHeaps) {
+            // Finish any recorded uploads before their command buffer is released.
+            m_Resources.StaticResourceHeaps->Flush();
+        }
         m_Resources = {};
         m_LoaderResources = {};
         m_Primitives.clear();
@@ -253,6 +258,16 @@ namespace Pbr
         return m_device;
     }
 
+    MTL::CommandQueue* MetalResources::GetUploadCommandQueue() const
+    {
+        return m_Resources.UploadCommandQueue.get();
+    }
+
+    Conformance::MetalStaticResourceHeaps& MetalResources::GetStaticResourceHeaps() const
+    {
+        return *m_Resources.StaticResourceHeaps;
+    }
+
     MetalPipelineStateBundle MetalResources::GetOrCreatePipelineState(MTL::PixelFormat colorRenderTargetFormat,
                                                                       MTL::PixelFormat depthRenderTargetFormat, BlendState blendState) const
     {
@@ -301,7 +316,12 @@ namespace Pbr
 
     NS::SharedPtr<MTL::Texture> MetalResources::CreateTypedSolidColorTexture(RGBAColor color, bool sRGB) const
     {
-        return m_Resources.SolidColorTextureCache.CreateTypedSolidColorTexture(*this, color, sRGB);
+        return m_Resources.TextureCache.CreateTypedSolidColorTexture(*this, color, sRGB);
+    }
+
+    void MetalResources::SetTextureCacheBudget(uint64_t budgetBytes)
+    {
+        m_Resources.TextureCache.SetBudget(budgetBytes);
     }
 
     span<const Conformance::Image::FormatParams> MetalResources::GetSupportedFormats() const
@@ -90,8 +90,9 @@ namespace Pbr
         std::shared_ptr<Material> CreateMaterial() override;
         std::shared_ptr<ITexture> CreateSolidColorTexture(RGBAColor color, bool sRGB);
 
-        void LoadTexture(const std::shared_ptr<Material>& pbrMaterial, Pbr::ShaderSlots::PSMaterial slot, const tinygltf::Image* image,
-                         const tinygltf::Sampler* sampler, bool sRGB, Pbr::RGBAColor defaultRGBA) override;
+        void LoadTexture(const std::shared_ptr<Material>& pbrMaterial, Pbr::ShaderSlots::PSMaterial slot,
+                         const GltfHelper::DecodedImage* image, const tinygltf::Sampler* sampler, bool sRGB,
+                         Pbr::RGBAColor defaultRGBA) override;
         PrimitiveHandle MakePrimitive(const Pbr::PrimitiveBuilder& primitiveBuilder,
                                       const std::shared_ptr<Pbr::Material>& material) override;
         void DropLoaderCaches() override;
@@ -109,6 +110,13 @@ namespace Pbr
         /// Get the MTLDevice that the PBR resources are associated with.
         NS::SharedPtr<MTL::Device> GetDevice() const;
 
+        /// Get the command queue that the GPU work of loading resources, such as generating mip levels, is submitted to.
+        MTL::CommandQueue* GetUploadCommandQueue() const;
+
+        /// Get the heaps that static buffers and textures are placed in, whose uploads are submitted to the upload command queue.
+        /// They must be flushed before rendering with resources created since the last flush.
+        Conformance::MetalStaticResourceHeaps& GetStaticResourceHeaps() const;
+
         /// Get a pipeline state matching some parameters as well as the current settings inside MetalResources.
         MetalPipelineStateBundle GetOrCreatePipelineState(MTL::PixelFormat colorRenderTargetFormat,
                                                           MTL::PixelFormat depthRenderTargetFormat, BlendState blendState) const;
@@ -126,9 +134,12 @@ namespace Pbr
         /// number of textures created.
         NS::SharedPtr<MTL::Texture> CreateTypedSolidColorTexture(RGBAColor color, bool sRGB) const;
 
+        /// Set the bytes of textures kept cached once no model uses them. See Pbr::TextureCache.
+        void SetTextureCacheBudget(uint64_t budgetBytes);
+
         /// Get the cached list of texture formats supported by the device
         /// Note: these formats are not guaranteed to support cubemap
-        span<const Conformance::Image::FormatParams> GetSupportedFormats() const;
+        span<const Conformance::Image::FormatParams> GetSupportedFormats() const override;
 
         /// Bind the the PBR resources to the current RenderCommandEncoder.
         void Bind(MTL::RenderCommandEncoder* renderCommandEncoder) const;
@@ -167,7 +178,9 @@ namespace Pbr
             NS::SharedPtr<MTL::Texture> SpecularEnvironmentMap;
             NS::SharedPtr<MTL::Texture> DiffuseEnvironmentMap;
             std::unique_ptr<MetalPipelineStates> PipelineStates;
-            mutable MetalTextureCache SolidColorTextureCache;
+            mutable MetalTextureCache TextureCache;
+            NS::SharedPtr<MTL::CommandQueue> UploadCommandQueue;
+            std::unique_ptr<Conformance::MetalStaticResourceHeaps> StaticResourceHeaps;
 
             std::vector<Conformance::Image::FormatParams> SupportedTextureFormats;
         };
@@ -177,7 +190,7 @@ namespace Pbr
         mutable SceneConstantBuffer m_SceneBuffer;
         mutable ModelConstantBuffer m_ModelBuffer;
 
-        using ImageKey = std::tuple<const tinygltf::Image*, bool>;
+        using ImageKey = std::tuple<const GltfHelper::DecodedImage*, bool>;
         struct LoaderResources
         {
             /// Create cache for reuse of texture views and samplers when possible.
@@ -38,14 +38,15 @@ namespace Pbr
         {
             NS::SharedPtr<MTL::TextureDescriptor> desc = NS::RetainPtr(MTL::TextureDescriptor::textureCubeDescriptor(format, 1, false));
 
-            NS::SharedPtr<MTL::Texture> texture = NS::TransferPtr(pbrResources.GetDevice()->newTexture(desc.get()));
+            Conformance::MetalStaticResourceHeaps& heaps = pbrResources.GetStaticResourceHeaps();
+            NS::SharedPtr<MTL::Texture> texture = heaps.NewTexture(desc.get());
 
             // Each side is a 1x1 pixel (RGBA) image.
             const std::array<uint8_t, 4> rgbaColor = LoadRGBAUI4(color);
 
             for (uint32_t faceIndex = 0; faceIndex < 6; ++faceIndex) {
                 MTL::Region region(0, 0, 1, 1);
-                texture->replaceRegion(region, 0, faceIndex, rgbaColor.data(), 4 /*bytesPerRow*/, 0 /*bytesPerImage*/);
+                heaps.UploadTextureRegion(texture.get(), faceIndex, 0, region, rgbaColor.data(), 4 /*bytesPerRow*/, rgbaColor.size());
             }
 
             texture->setLabel(label);
@@ -54,28 +55,33 @@ namespace Pbr
         }
 
         NS::SharedPtr<MTL::Texture> CreateTexture(const MetalResources& pbrResources, const Conformance::Image::Image& image,
-                                                  const NS::String* label)
-        {
-            return CreateTexture(pbrResources.GetDevice().get(), image, label);
-        }
-
-        NS::SharedPtr<MTL::Texture> CreateTexture(MTL::Device* device, const Conformance::Image::Image& image, const NS::String* label)
+                                                  const NS::String* label, bool generateMips)
         {
+            // When generating, only the base level is uploaded and the rest of the chain is generated from it.
+            generateMips = generateMips && CanGenerateMips(image);
             auto metalFormat = ToMetalFormat(image.format);
             auto baseMipWidth = image.levels[0].metadata.physicalDimensions.width;
             auto baseMipHeight = image.levels[0].metadata.physicalDimensions.height;
             auto mipLevels = image.levels.size();
-            NS::SharedPtr<MTL::TextureDescriptor> desc =
-                NS::RetainPtr(MTL::TextureDescriptor::texture2DDescriptor(metalFormat, baseMipWidth, baseMipHeight, mipLevels > 1));
-            desc->setMipmapLevelCount(mipLevels);
+            NS::SharedPtr<MTL::TextureDescriptor> desc = NS::RetainPtr(
+                MTL::TextureDescriptor::texture2DDescriptor(metalFormat, baseMipWidth, baseMipHeight, generateMips || mipLevels > 1));
+            if (!generateMips) {
+                desc->setMipmapLevelCount(mipLevels);
+            }
 
-            NS::SharedPtr<MTL::Texture> texture = NS::TransferPtr(device->newTexture(desc.get()));
+            Conformance::MetalStaticResourceHeaps& heaps = pbrResources.GetStaticResourceHeaps();
+            NS::SharedPtr<MTL::Texture> texture = heaps.NewTexture(desc.get());
 
-            for (auto& level : image.levels) {
+            for (NS::UInteger mipLevel = 0; mipLevel < mipLevels; ++mipLevel) {
+                const Image::ImageLevel& level = image.levels[mipLevel];
                 MTL::Region region(0, 0, level.metadata.physicalDimensions.width, level.metadata.physicalDimensions.height);
                 NS::UInteger bytesPerRow =
                     (level.metadata.physicalDimensions.width / level.metadata.blockSize.width) * image.format.BytesPerBlockOrPixel();
-                texture->replaceRegion(region, 0, level.data.data(), bytesPerRow);
+                heaps.UploadTextureRegion(texture.get(), 0, mipLevel, region, level.data.data(), bytesPerRow, level.data.size());
+            }
+
+            if (generateMips) {
+                heaps.GenerateMipmaps(texture.get());
             }
 
             texture->setLabel(label);
@@ -31,10 +31,10 @@ namespace Pbr
         NS::SharedPtr<MTL::Texture> CreateFlatCubeTexture(const MetalResources& pbrResources, RGBAColor color, MTL::PixelFormat format,
                                                           const NS::String* label);
 
+        /// The texture is placed in the static resource heaps of @p pbrResources, which must be flushed before it is sampled.
+        /// @param generateMips Generate the rest of the mip chain on the GPU if @p image only has its base level and is uncompressed.
         NS::SharedPtr<MTL::Texture> CreateTexture(const MetalResources& pbrResources, const Conformance::Image::Image& image,
-                                                  const NS::String* label);
-
-        NS::SharedPtr<MTL::Texture> CreateTexture(MTL::Device* device, const Conformance::Image::Image& image, const NS::String* label);
+                                                  const NS::String* label, bool generateMips = false);
 
         NS::SharedPtr<MTL::SamplerDescriptor> DefaultSamplerDesc();
         NS::SharedPtr<MTL::SamplerState> CreateSampler(MTL::Device* device,
@@ -9,6 +9,8 @@
 
 #pragma once
 
+#include "../PbrTextureCache.h"
+
 #include "utilities/metal_utils.h"
 
 #include <openxr/openxr.h>
@@ -17,16 +19,24 @@
 #include <Metal/Metal.hpp>
 #include <QuartzCore/QuartzCore.hpp>
 
-#include <map>
 #include <memory>
-#include <mutex>
+#include <utility>
 
 namespace Pbr
 {
 
     struct MetalResources;
 
-    /// Cache of single-color textures.
+    template <typename T>
+    struct TextureReferences<NS::SharedPtr<T>>
+    {
+        static bool HeldOnlyByCache(const NS::SharedPtr<T>& texture)
+        {
+            return texture->retainCount() == 1;
+        }
+    };
+
+    /// Cache of textures by content, including single-color textures. See Pbr::TextureCache.
     ///
     /// Device-dependent, drop when device is lost or destroyed.
     class MetalTextureCache
@@ -48,11 +58,21 @@ namespace Pbr
         /// Find or create a single pixel texture of the given color
         NS::SharedPtr<MTL::Texture> CreateTypedSolidColorTexture(const MetalResources& pbrResources, XrColor4f color, bool sRGB);
 
+        /// Find the texture with the content of @p image, or create it by calling @p create.
+        template <typename Create>
+        NS::SharedPtr<MTL::Texture> FindOrCreate(const Conformance::Image::Image& image, Create&& create)
+        {
+            return m_textures.FindOrCreate(image, std::forward<Create>(create));
+        }
+
+        void SetBudget(uint64_t budgetBytes)
+        {
+            m_textures.SetBudget(budgetBytes);
+        }
+
     private:
         NS::SharedPtr<MTL::Device> m_device;
-        /// in unique_ptr to make it moveable
-        std::unique_ptr<std::mutex> m_cacheMutex;
-        std::map<uint32_t, NS::SharedPtr<MTL::Texture>> m_solidColorTextureCache;
+        TextureCache<NS::SharedPtr<MTL::Texture>> m_textures;
     };
 
 }  // namespace Pbr
@@ -77,6 +77,13 @@ namespace Pbr
         }
     }
 
+    void GLMaterial::BindPipelineState(const GLResources& pbrResources) const
+    {
+        pbrResources.SetBlendState(m_alphaBlended == BlendState::AlphaBlended);
+        pbrResources.SetDepthStencilState(m_alphaBlended == BlendState::AlphaBlended);
+        pbrResources.SetRasterizerState(m_doubleSided == DoubleSided::DoubleSided);
+    }
+
     void GLMaterial::Bind(const GLResources& pbrResources) const
     {
         // If the parameters of the constant buffer have changed, update the constant buffer.
@@ -86,20 +93,16 @@ namespace Pbr
             XRC_CHECK_THROW_GLCMD(glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(ConstantBufferData), &m_parameters));
         }
 
-        pbrResources.SetBlendState(m_alphaBlended == BlendState::AlphaBlended);
-        pbrResources.SetDepthStencilState(m_alphaBlended == BlendState::AlphaBlended);
-        pbrResources.SetRasterizerState(m_doubleSided == DoubleSided::DoubleSided);
-
         XRC_CHECK_THROW_GLCMD(glBindBufferBase(GL_UNIFORM_BUFFER, Pbr::ShaderSlots::ConstantBuffers::Material, m_constantBuffer.get()));
 
         static_assert(Pbr::ShaderSlots::BaseColor == 0, "BaseColor must be the first slot");
 
-        std::array<std::shared_ptr<ScopedGLTexture>, TextureCount> textures;
+        // Materials often share textures, such as the solid color defaults, and samplers, so many of these binds are skipped.
+        Conformance::GLStateCache& state = pbrResources.GetStateCache();
         for (uint32_t texIndex = 0; texIndex < ShaderSlots::NumMaterialSlots; ++texIndex) {
             GLuint unit = ShaderSlots::GLSL::MaterialTexturesOffset + texIndex;
-            XRC_CHECK_THROW_GLCMD(glActiveTexture(GL_TEXTURE0 + unit));
-            XRC_CHECK_THROW_GLCMD(glBindTexture(GL_TEXTURE_2D, m_textures[texIndex]->get()));
-            XRC_CHECK_THROW_GLCMD(glBindSampler(unit, m_samplers[texIndex]->get()));
+            state.BindTexture(unit, GL_TEXTURE_2D, m_textures[texIndex]->get());
+            state.BindSampler(unit, m_samplers[texIndex]->get());
         }
     }
 }  // namespace Pbr
@@ -44,7 +44,10 @@ namespace Pbr
         void SetTexture(ShaderSlots::PSMaterial slot, std::shared_ptr<ScopedGLTexture> textureView,
                         std::shared_ptr<ScopedGLSampler> sampler = nullptr);
 
-        /// Bind this material to current context.
+        /// Set the blend, depth and rasterizer state this material needs on the current context.
+        void BindPipelineState(const GLResources& pbrResources) const;
+
+        /// Bind the constants and textures of this material to current context.
         void Bind(const GLResources& pbrResources) const;
 
         std::string Name;
@@ -16,6 +16,7 @@
 #include "GLResources.h"
 
 #include "../GlslBuffers.h"
+#include "../PbrDrawQueue.h"
 #include "../PbrHandles.h"
 #include "../PbrModel.h"
 #include "../PbrSharedState.h"
@@ -29,31 +30,48 @@ namespace Pbr
 {
 
     void GLModelInstance::Render(Pbr::GLResources const& pbrResources, XrMatrix4x4f modelToWorld)
+    {
+        Prepare(pbrResources, modelToWorld);
+
+        // Draw in model order, skipping only the state that repeats from one primitive to the next.
+        m_drawQueue.Clear();
+        AppendDraws(pbrResources, pbrResources.GetFillMode(), 0, m_drawQueue);
+        DrawBindState bindState;
+        for (const DrawItem& item : m_drawQueue.Items()) {
+            DrawPrimitive(pbrResources, item, bindState);
+        }
+    }
+
+    void GLModelInstance::Prepare(Pbr::GLResources const& pbrResources, XrMatrix4x4f modelToWorld)
     {
         // Update model buffer
-        m_modelBuffer.ModelToWorld = modelToWorld;
-        XRC_CHECK_THROW_GLCMD(glBindBuffer(GL_UNIFORM_BUFFER, m_modelConstantBuffer.get()));
-        XRC_CHECK_THROW_GLCMD(glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Glsl::ModelConstantBuffer), &m_modelBuffer));
-        // Bind model buffer
-        XRC_CHECK_THROW_GLCMD(glBindBufferBase(GL_UNIFORM_BUFFER, ShaderSlots::ConstantBuffers::Model, m_modelConstantBuffer.get()));
+        if (UpdateModelConstants(m_modelBuffer, Glsl::ModelConstantBuffer{modelToWorld})) {
+            XRC_CHECK_THROW_GLCMD(glBindBuffer(GL_UNIFORM_BUFFER, m_modelConstantBuffer.get()));
+            XRC_CHECK_THROW_GLCMD(glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Glsl::ModelConstantBuffer), &m_modelBuffer));
+        }
 
         UpdateTransforms(pbrResources);
+    }
 
-        XRC_CHECK_THROW_GLCMD(glBindBufferBase(GL_SHADER_STORAGE_BUFFER,
-                                               (int)ShaderSlots::GLSL::VSResourceViewsOffset + (int)ShaderSlots::Transforms,
-                                               m_modelTransformsStructuredBuffer.get()));
-
-        for (PrimitiveHandle primitiveHandle : GetModel().GetPrimitiveHandles()) {
-            const Pbr::GLPrimitive& primitive = pbrResources.GetPrimitive(primitiveHandle);
-            if (primitive.GetMaterial()->Hidden)
-                continue;
-
-            if (!IsAnyNodeVisible(primitive.GetNodes()))
-                continue;
+    void GLModelInstance::DrawPrimitive(Pbr::GLResources const& pbrResources, const DrawItem& item, DrawBindState& bindState) const
+    {
+        if (bindState.BindModelInstance(this)) {
+            // Bind model buffer
+            XRC_CHECK_THROW_GLCMD(glBindBufferBase(GL_UNIFORM_BUFFER, ShaderSlots::ConstantBuffers::Model, m_modelConstantBuffer.get()));
+            XRC_CHECK_THROW_GLCMD(glBindBufferBase(GL_SHADER_STORAGE_BUFFER,
+                                                   (int)ShaderSlots::GLSL::VSResourceViewsOffset + (int)ShaderSlots::Transforms,
+                                                   m_modelTransformsStructuredBuffer.get()));
+        }
 
+        const Pbr::GLPrimitive& primitive = pbrResources.GetPrimitive(GetModel().GetPrimitiveHandles()[item.primitive]);
+        if (bindState.BindPipeline(item.pipelineKey)) {
+            primitive.GetMaterial()->BindPipelineState(pbrResources);
+        }
+        if (bindState.BindMaterial(item.material)) {
             primitive.GetMaterial()->Bind(pbrResources);
-            primitive.Render(pbrResources.GetFillMode());
         }
+        primitive.Render(pbrResources, item.fillMode);
+        bindState.stats.draws++;
     }
 
     GLModelInstance::GLModelInstance(Pbr::GLResources& /* pbrResources */, std::shared_ptr<const Model> model)
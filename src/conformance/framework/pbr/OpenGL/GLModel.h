@@ -28,6 +28,12 @@ namespace Pbr
         /// Render the model.
         void Render(Pbr::GLResources const& pbrResources, XrMatrix4x4f modelToWorld);
 
+        /// Upload the model constants and node transforms, before drawing the primitives added to a DrawQueue by AppendDraws.
+        void Prepare(Pbr::GLResources const& pbrResources, XrMatrix4x4f modelToWorld);
+
+        /// Draw one primitive of this model, binding only the state that differs from what @p bindState last bound.
+        void DrawPrimitive(Pbr::GLResources const& pbrResources, const DrawItem& item, DrawBindState& bindState) const;
+
     private:
         /// Update the transforms used to render the model. This needs to be called any time a node transform is changed.
         void UpdateTransforms(Pbr::GLResources const& pbrResources);
@@ -36,5 +42,7 @@ namespace Pbr
         ScopedGLBuffer m_modelConstantBuffer;
 
         ScopedGLBuffer m_modelTransformsStructuredBuffer;
+
+        DrawQueue m_drawQueue;
     };
 }  // namespace Pbr
@@ -11,6 +11,7 @@
 #include "GLPrimitive.h"
 
 #include "GLCommon.h"
+#include "GLResources.h"
 
 #include "../PbrCommon.h"
 
@@ -18,6 +19,7 @@
 #include "utilities/opengl_utils.h"
 
 #include <stddef.h>
+#include <vector>
 
 namespace Pbr
 {
@@ -45,23 +47,51 @@ namespace
         {5, 1, GL_UNSIGNED_SHORT, false, GL_FALSE, offsetof(Pbr::Vertex, ModelTransformIndex)},
     };
 
-    GLsizei GetPbrVertexByteSize(size_t size)
+    // The same attributes in Pbr::CompactVertex, normalized or converted from half floats by vertex fetch.
+    static constexpr VertexInputAttributeDescription c_compactAttrDesc[6] = {
+        {0, 3, GL_FLOAT, true, GL_FALSE, offsetof(Pbr::CompactVertex, Position)},
+        {1, 3, GL_SHORT, true, GL_TRUE, offsetof(Pbr::CompactVertex, Normal)},
+        {2, 4, GL_SHORT, true, GL_TRUE, offsetof(Pbr::CompactVertex, Tangent)},
+        {3, 4, GL_UNSIGNED_BYTE, true, GL_TRUE, offsetof(Pbr::CompactVertex, Color0)},
+        {4, 2, GL_HALF_FLOAT, true, GL_FALSE, offsetof(Pbr::CompactVertex, TexCoord0)},
+        {5, 1, GL_UNSIGNED_SHORT, false, GL_FALSE, offsetof(Pbr::CompactVertex, ModelTransformIndex)},
+    };
+
+    GLsizei GetPbrVertexByteSize(size_t size, bool compactVertices)
     {
-        return (GLsizei)(sizeof(decltype(Pbr::PrimitiveBuilder::Vertices)::value_type) * size);
+        return (GLsizei)((compactVertices ? sizeof(Pbr::CompactVertex) : sizeof(decltype(Pbr::PrimitiveBuilder::Vertices)::value_type)) *
+                         size);
+    }
+
+    // Upload the vertices of @p primitiveBuilder to the buffer bound to GL_ARRAY_BUFFER, converting them if needed.
+    void UploadVertices(const Pbr::PrimitiveBuilder& primitiveBuilder, bool compactVertices, bool replaceContents)
+    {
+        const GLsizei size = GetPbrVertexByteSize(primitiveBuilder.Vertices.size(), compactVertices);
+        std::vector<Pbr::CompactVertex> compactVertexData;
+        const void* data = primitiveBuilder.Vertices.data();
+        if (compactVertices) {
+            compactVertexData = Pbr::PackCompactVertices(primitiveBuilder.Vertices);
+            data = compactVertexData.data();
+        }
+        if (replaceContents) {
+            XRC_CHECK_THROW_GLCMD(glBufferSubData(GL_ARRAY_BUFFER, 0, size, data));
+        }
+        else {
+            XRC_CHECK_THROW_GLCMD(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
+        }
     }
     GLsizei GetPbrIndexByteSize(size_t size)
     {
         return (GLsizei)(sizeof(decltype(Pbr::PrimitiveBuilder::Indices)::value_type) * size);
     }
 
-    Pbr::ScopedGLBuffer CreateVertexBuffer(const Pbr::PrimitiveBuilder& primitiveBuilder)
+    Pbr::ScopedGLBuffer CreateVertexBuffer(const Pbr::PrimitiveBuilder& primitiveBuilder, bool compactVertices)
     {
         // Create Vertex Buffer
         auto buffer = Pbr::ScopedGLBuffer{};
         XRC_CHECK_THROW_GLCMD(glGenBuffers(1, buffer.resetAndPut()));
         XRC_CHECK_THROW_GLCMD(glBindBuffer(GL_ARRAY_BUFFER, buffer.get()));
-        XRC_CHECK_THROW_GLCMD(glBufferData(GL_ARRAY_BUFFER, GetPbrVertexByteSize(primitiveBuilder.Vertices.size()),
-                                           primitiveBuilder.Vertices.data(), GL_STATIC_DRAW));
+        UploadVertices(primitiveBuilder, compactVertices, false);
         return buffer;
     }
 
@@ -76,26 +106,29 @@ namespace
         return buffer;
     }
 
-    Pbr::ScopedGLVertexArray CreateVAO(Pbr::ScopedGLBuffer& vertexBuffer, Pbr::ScopedGLBuffer& indexBuffer)
+    Pbr::ScopedGLVertexArray CreateVAO(Pbr::ScopedGLBuffer& vertexBuffer, Pbr::ScopedGLBuffer& indexBuffer, bool compactVertices)
     {
+        const auto& attrDesc = compactVertices ? c_compactAttrDesc : c_attrDesc;
+        const GLsizei stride = GetPbrVertexByteSize(1, compactVertices);
+
         // Create Vertex Array Object
         auto vao = Pbr::ScopedGLVertexArray{};
         XRC_CHECK_THROW_GLCMD(glGenVertexArrays(1, vao.resetAndPut()));
         XRC_CHECK_THROW_GLCMD(glBindVertexArray(vao.get()));
-        for (auto attr : c_attrDesc) {
+        for (auto attr : attrDesc) {
             XRC_CHECK_THROW_GLCMD(glEnableVertexAttribArray(attr.index));
         }
         XRC_CHECK_THROW_GLCMD(glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer.get()));
         XRC_CHECK_THROW_GLCMD(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer.get()));
 
-        for (auto attr : c_attrDesc) {
+        for (auto attr : attrDesc) {
             if (attr.asFloat) {
-                XRC_CHECK_THROW_GLCMD(glVertexAttribPointer(attr.index, attr.size, attr.type, attr.normalized, GetPbrVertexByteSize(1),
+                XRC_CHECK_THROW_GLCMD(glVertexAttribPointer(attr.index, attr.size, attr.type, attr.normalized, stride,
                                                             reinterpret_cast<const void*>(attr.offset)));
             }
             else {
-                XRC_CHECK_THROW_GLCMD(glVertexAttribIPointer(attr.index, attr.size, attr.type, GetPbrVertexByteSize(1),
-                                                             reinterpret_cast<const void*>(attr.offset)));
+                XRC_CHECK_THROW_GLCMD(
+                    glVertexAttribIPointer(attr.index, attr.size, attr.type, stride, reinterpret_cast<const void*>(attr.offset)));
             }
         }
         return vao;
@@ -115,11 +148,39 @@ namespace Pbr
     {
     }
 
-    GLPrimitive::GLPrimitive(const Pbr::PrimitiveBuilder& primitiveBuilder, const std::shared_ptr<Pbr::GLMaterial>& material)
-        : GLPrimitive((GLsizei)primitiveBuilder.Indices.size(), CreateIndexBuffer(primitiveBuilder), CreateVertexBuffer(primitiveBuilder),
-                      ScopedGLVertexArray{}, std::move(material), primitiveBuilder.NodeIndicesVector())
+    GLPrimitive::GLPrimitive(const Pbr::PrimitiveBuilder& primitiveBuilder, const std::shared_ptr<Pbr::GLMaterial>& material,
+                             bool compactVertices, Conformance::GLUploadWorker* uploadWorker)
+        : GLPrimitive((GLsizei)primitiveBuilder.Indices.size(), ScopedGLBuffer{}, ScopedGLBuffer{}, ScopedGLVertexArray{},
+                      std::move(material), primitiveBuilder.NodeIndicesVector())
+    {
+        m_compactVertices = compactVertices;
+        if (uploadWorker == nullptr) {
+            m_indexBuffer = CreateIndexBuffer(primitiveBuilder);
+            m_vertexBuffer = CreateVertexBuffer(primitiveBuilder, compactVertices);
+            CreateVertexArray();
+            return;
+        }
+
+        // The names are generated here, so that the primitive owns them; the worker creates the buffers by binding them.
+        XRC_CHECK_THROW_GLCMD(glGenBuffers(1, m_indexBuffer.resetAndPut()));
+        XRC_CHECK_THROW_GLCMD(glGenBuffers(1, m_vertexBuffer.resetAndPut()));
+        const GLuint indexBuffer = m_indexBuffer.get();
+        const GLuint vertexBuffer = m_vertexBuffer.get();
+        const Pbr::PrimitiveBuilder* builder = &primitiveBuilder;
+        uploadWorker->Submit([=] {
+            // No vertex array is bound in the worker's context, so the indices go through GL_ARRAY_BUFFER as well.
+            XRC_CHECK_THROW_GLCMD(glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer));
+            UploadVertices(*builder, compactVertices, false);
+            XRC_CHECK_THROW_GLCMD(glBindBuffer(GL_ARRAY_BUFFER, indexBuffer));
+            XRC_CHECK_THROW_GLCMD(glBufferData(GL_ARRAY_BUFFER, GetPbrIndexByteSize(builder->Indices.size()), builder->Indices.data(),
+                                               GL_STATIC_DRAW));
+            XRC_CHECK_THROW_GLCMD(glBindBuffer(GL_ARRAY_BUFFER, 0));
+        });
+    }
+
+    void GLPrimitive::CreateVertexArray()
     {
-        m_vao = CreateVAO(m_vertexBuffer, m_indexBuffer);
+        m_vao = CreateVAO(m_vertexBuffer, m_indexBuffer, m_compactVertices);
     }
 
     void GLPrimitive::UpdateBuffers(const Pbr::PrimitiveBuilder& primitiveBuilder)
@@ -128,13 +189,13 @@ namespace Pbr
 
         // Update vertex buffer.
         {
-            GLsizei requiredSize = GetPbrVertexByteSize(primitiveBuilder.Vertices.size());
+            GLsizei requiredSize = GetPbrVertexByteSize(primitiveBuilder.Vertices.size(), m_compactVertices);
             if (m_vertexCount >= requiredSize) {
                 XRC_CHECK_THROW_GLCMD(glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer.get()));
-                XRC_CHECK_THROW_GLCMD(glBufferSubData(GL_ARRAY_BUFFER, 0, requiredSize, primitiveBuilder.Vertices.data()));
+                UploadVertices(primitiveBuilder, m_compactVertices, true);
             }
             else {
-                m_vertexBuffer = CreateVertexBuffer(primitiveBuilder);
+                m_vertexBuffer = CreateVertexBuffer(primitiveBuilder, m_compactVertices);
                 vaoNeedsUpdate = true;
             }
         }
@@ -155,11 +216,11 @@ namespace Pbr
         }
 
         if (vaoNeedsUpdate) {
-            m_vao = CreateVAO(m_vertexBuffer, m_indexBuffer);
+            m_vao = CreateVAO(m_vertexBuffer, m_indexBuffer, m_compactVertices);
         }
     }
 
-    void GLPrimitive::Render(FillMode fillMode) const
+    void GLPrimitive::Render(const GLResources& pbrResources, FillMode fillMode) const
     {
         (void)fillMode;  // suppress unused warning under GL
         GLenum drawMode =
@@ -170,9 +231,8 @@ namespace Pbr
 #endif
             ;
 
-        XRC_CHECK_THROW_GLCMD(glBindVertexArray(m_vao.get()));
-        XRC_CHECK_THROW_GLCMD(glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer.get()));
-        XRC_CHECK_THROW_GLCMD(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer.get()));
+        // The index buffer is part of the vertex array state, and the vertex buffer is only read through the attribute pointers.
+        pbrResources.GetStateCache().BindVertexArray(m_vao.get());
         XRC_CHECK_THROW_GLCMD(glDrawElements(drawMode, m_indexCount, GL_UNSIGNED_INT, nullptr));
     }
 }  // namespace Pbr
@@ -18,9 +18,15 @@
 #include <utility>
 #include <vector>
 
+namespace Conformance
+{
+    class GLUploadWorker;
+}  // namespace Conformance
+
 namespace Pbr
 {
     struct GLMaterial;
+    struct GLResources;
     struct PrimitiveBuilder;
 
     /// A primitive holds a vertex buffer, index buffer, and a pointer to a PBR material.
@@ -31,10 +37,18 @@ namespace Pbr
         GLPrimitive() = delete;
         GLPrimitive(GLsizei indexCount, ScopedGLBuffer indexBuffer, ScopedGLBuffer vertexBuffer, ScopedGLVertexArray vao,
                     std::shared_ptr<GLMaterial> material, std::vector<NodeIndex_t> nodeIndices);
-        GLPrimitive(const Pbr::PrimitiveBuilder& primitiveBuilder, const std::shared_ptr<GLMaterial>& material);
+        /// With @p compactVertices, the vertices are stored as Pbr::CompactVertex.
+        /// With @p uploadWorker, the buffers are filled on its thread, reading @p primitiveBuilder, which must outlive the
+        /// upload, and CreateVertexArray must be called once the upload has been waited for.
+        GLPrimitive(const Pbr::PrimitiveBuilder& primitiveBuilder, const std::shared_ptr<GLMaterial>& material,
+                    bool compactVertices = false, Conformance::GLUploadWorker* uploadWorker = nullptr);
 
         void UpdateBuffers(const Pbr::PrimitiveBuilder& primitiveBuilder);
 
+        /// Create the vertex array of the buffers, binding them in the current context, which makes the contents an upload
+        /// worker gave them visible there.
+        void CreateVertexArray();
+
         /// Get the material for the primitive.
         const std::shared_ptr<GLMaterial>& GetMaterial() const
         {
@@ -55,7 +69,7 @@ namespace Pbr
 
     protected:
         friend class GLModelInstance;
-        void Render(FillMode fillMode) const;
+        void Render(const GLResources& pbrResources, FillMode fillMode) const;
 
     private:
         GLsizei m_indexCount;
@@ -63,6 +77,7 @@ namespace Pbr
         GLsizei m_vertexCount;
         ScopedGLBuffer m_vertexBuffer;
         ScopedGLVertexArray m_vao;
+        bool m_compactVertices{false};
         std::shared_ptr<GLMaterial> m_material;
         std::vector<NodeIndex_t> m_nodeIndices;
     };
@@ -95,7 +95,7 @@ namespace
 
 namespace Pbr
 {
-    using ImageKey = std::tuple<const tinygltf::Image*, bool>;  // Item1 is a pointer to the image, Item2 is sRGB.
+    using ImageKey = std::tuple<const GltfHelper::DecodedImage*, bool>;  // Item1 is a pointer to the image, Item2 is sRGB.
 
     class Program
     {
@@ -103,31 +103,15 @@ namespace Pbr
         Program() = default;
         Program(const char** vertexShader, const char** fragmentShader)
         {
-            m_vertexShader.adopt(glCreateShader(GL_VERTEX_SHADER));
-            XRC_CHECK_THROW_GLCMD(glShaderSource(m_vertexShader.get(), 1, vertexShader, nullptr));
-            XRC_CHECK_THROW_GLCMD(glCompileShader(m_vertexShader.get()));
-            Conformance::CheckGLShader(m_vertexShader.get());
-
-            m_fragmentShader.adopt(glCreateShader(GL_FRAGMENT_SHADER));
-            XRC_CHECK_THROW_GLCMD(glShaderSource(m_fragmentShader.get(), 1, fragmentShader, nullptr));
-            XRC_CHECK_THROW_GLCMD(glCompileShader(m_fragmentShader.get()));
-            Conformance::CheckGLShader(m_fragmentShader.get());
-
-            m_program.adopt(glCreateProgram());
-            XRC_CHECK_THROW_GLCMD(glAttachShader(m_program.get(), m_vertexShader.get()));
-            XRC_CHECK_THROW_GLCMD(glAttachShader(m_program.get(), m_fragmentShader.get()));
-            XRC_CHECK_THROW_GLCMD(glLinkProgram(m_program.get()));
-            Conformance::CheckGLProgram(m_program.get());
+            m_program.adopt(Conformance::LinkGLProgram(*vertexShader, *fragmentShader));
         }
 
-        void Bind()
+        void Bind(Conformance::GLStateCache& state)
         {
-            XRC_CHECK_THROW_GLCMD(glUseProgram(m_program.get()));
+            state.UseProgram(m_program.get());
         }
 
     private:
-        ScopedGLShader m_vertexShader{};
-        ScopedGLShader m_fragmentShader{};
         ScopedGLProgram m_program{};
     };
 
@@ -159,9 +143,13 @@ namespace Pbr
             std::shared_ptr<ScopedGLTexture> SpecularEnvironmentMap;
             std::shared_ptr<ScopedGLTexture> DiffuseEnvironmentMap;
             std::vector<Conformance::Image::FormatParams> SupportedTextureFormats;
-            mutable GLTextureCache SolidColorTextureCache{};
+            mutable GLTextureCache TextureCache{};
         };
         PrimitiveCollection<GLPrimitive> Primitives;
+        bool CompactVertices{false};
+        Conformance::GLStateCache StateCache;
+        /// Not owned, see GLResources::SetUploadWorker
+        Conformance::GLUploadWorker* UploadWorker{nullptr};
 
         DeviceResources Resources;
         Glsl::SceneConstantBuffer SceneBuffer;
@@ -171,12 +159,15 @@ namespace Pbr
             // Create D3D cache for reuse of texture views and samplers when possible.
             std::map<ImageKey, std::shared_ptr<ScopedGLTexture>> imageMap;
             std::map<const tinygltf::Sampler*, std::shared_ptr<ScopedGLSampler>> samplerMap;
+            // Primitives whose buffers are being filled by the upload worker, still without a vertex array.
+            std::vector<PrimitiveHandle> pendingPrimitives;
         };
         LoaderResources loaderResources;
     };
 
-    GLResources::GLResources() : m_impl(std::make_unique<Impl>())
+    GLResources::GLResources(bool compactVertices) : m_impl(std::make_unique<Impl>())
     {
+        m_impl->CompactVertices = compactVertices;
         m_impl->Initialize();
     }
 
@@ -184,14 +175,10 @@ namespace Pbr
 
     GLResources::~GLResources() = default;
 
-    // Create a GL texture from a tinygltf Image.
-    static ScopedGLTexture LoadGLTFImage(const GLResources& pbrResources, const tinygltf::Image& image, bool sRGB)
+    // Create a GL texture from a decoded tinygltf Image.
+    static ScopedGLTexture LoadGLTFImage(const GltfHelper::DecodedImage& image)
     {
-        // First convert the image to RGBA if it isn't already.
-        std::vector<uint8_t> tempBuffer;
-        Conformance::Image::Image decodedImage = GltfHelper::DecodeImage(image, sRGB, pbrResources.GetSupportedFormats(), tempBuffer);
-
-        return Pbr::GLTexture::CreateTexture(decodedImage);
+        return Pbr::GLTexture::CreateTexture(image.image, true);
     }
 
     static GLenum ConvertMinFilter(int glMinFilter)
@@ -249,7 +236,8 @@ namespace Pbr
         return std::make_shared<GLMaterial>(*this);
     }
     void GLResources::LoadTexture(const std::shared_ptr<Material>& material, Pbr::ShaderSlots::PSMaterial slot,
-                                  const tinygltf::Image* image, const tinygltf::Sampler* sampler, bool sRGB, Pbr::RGBAColor defaultRGBA)
+                                  const GltfHelper::DecodedImage* image, const tinygltf::Sampler* sampler, bool sRGB,
+                                  Pbr::RGBAColor defaultRGBA)
     {
         auto pbrMaterial = std::dynamic_pointer_cast<GLMaterial>(material);
         if (!pbrMaterial) {
@@ -259,12 +247,21 @@ namespace Pbr
         const ImageKey imageKey = std::make_tuple(image, sRGB);
         std::shared_ptr<ScopedGLTexture> textureView =
             image != nullptr ? m_impl->loaderResources.imageMap[imageKey] : CreateTypedSolidColorTexture(defaultRGBA, sRGB);
-        if (!textureView)  // If not cached, load the image and store it in the texture cache.
+        if (!textureView)  // If not cached, load the image, or find one with the same content, and store it in the texture cache.
         {
-            // TODO: Generate mipmaps if sampler's minification filter (minFilter) uses mipmapping.
+            // Mipmaps are generated whether or not this sampler's minification filter (minFilter) uses them, since the
+            // image may be shared with another sampler that does.
             // TODO: If texture is not power-of-two and (sampler has wrapping=repeat/mirrored_repeat OR minFilter uses
             // mipmapping), resize to power-of-two.
-            textureView = std::make_shared<ScopedGLTexture>(LoadGLTFImage(*this, *image, sRGB));
+            textureView = m_impl->Resources.TextureCache.FindOrCreate(image->image, [&] {
+                if (m_impl->UploadWorker == nullptr) {
+                    return std::make_shared<ScopedGLTexture>(LoadGLTFImage(*image));
+                }
+                // The texture is filled in on the worker thread, which is waited for before anything renders with it.
+                auto texture = std::make_shared<ScopedGLTexture>();
+                m_impl->UploadWorker->Submit([texture, image] { *texture = LoadGLTFImage(*image); });
+                return texture;
+            });
             m_impl->loaderResources.imageMap[imageKey] = textureView;
         }
 
@@ -281,6 +278,12 @@ namespace Pbr
     }
     void GLResources::DropLoaderCaches()
     {
+        if (m_impl->UploadWorker != nullptr) {
+            m_impl->UploadWorker->WaitAll();
+            for (PrimitiveHandle handle : m_impl->loaderResources.pendingPrimitives) {
+                m_impl->Primitives[handle].CreateVertexArray();
+            }
+        }
         m_impl->loaderResources = {};
     }
 
@@ -315,7 +318,17 @@ namespace Pbr
 
     std::shared_ptr<ScopedGLTexture> GLResources::CreateTypedSolidColorTexture(RGBAColor color, bool sRGB) const
     {
-        return m_impl->Resources.SolidColorTextureCache.CreateTypedSolidColorTexture(color, sRGB);
+        return m_impl->Resources.TextureCache.CreateTypedSolidColorTexture(color, sRGB);
+    }
+
+    void GLResources::SetTextureCacheBudget(uint64_t budgetBytes)
+    {
+        m_impl->Resources.TextureCache.SetBudget(budgetBytes);
+    }
+
+    void GLResources::SetUploadWorker(Conformance::GLUploadWorker* uploadWorker)
+    {
+        m_impl->UploadWorker = uploadWorker;
     }
 
     span<const Conformance::Image::FormatParams> GLResources::GetSupportedFormats() const
@@ -331,26 +344,28 @@ namespace Pbr
         XRC_CHECK_THROW_GLCMD(glBindBuffer(GL_UNIFORM_BUFFER, m_impl->Resources.SceneConstantBuffer.get()));
         XRC_CHECK_THROW_GLCMD(glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Glsl::SceneConstantBuffer), &m_impl->SceneBuffer));
 
-        m_impl->Resources.PbrProgram.Bind();
+        Conformance::GLStateCache& state = m_impl->StateCache;
+        m_impl->Resources.PbrProgram.Bind(state);
 
         XRC_CHECK_THROW_GLCMD(
             glBindBufferBase(GL_UNIFORM_BUFFER, ShaderSlots::ConstantBuffers::Scene, m_impl->Resources.SceneConstantBuffer.get()));
-        // ModelConstantBuffer is bound in GLModelInstance::Render
-
-        XRC_CHECK_THROW_GLCMD(  //
-            glActiveTexture(GL_TEXTURE0 + ShaderSlots::GLSL::MaterialTexturesOffset + ShaderSlots::Brdf));
-        XRC_CHECK_THROW_GLCMD(glBindTexture(GL_TEXTURE_2D, m_impl->Resources.BrdfLut->get()));
-        XRC_CHECK_THROW_GLCMD(glBindSampler(ShaderSlots::Pbr::Brdf, m_impl->Resources.BrdfSampler.get()));
-
-        XRC_CHECK_THROW_GLCMD(  //
-            glActiveTexture(GL_TEXTURE0 + ShaderSlots::GLSL::MaterialTexturesOffset + ShaderSlots::EnvironmentMap::DiffuseTexture));
-        XRC_CHECK_THROW_GLCMD(glBindTexture(GL_TEXTURE_CUBE_MAP, m_impl->Resources.DiffuseEnvironmentMap->get()));
-        XRC_CHECK_THROW_GLCMD(glBindSampler(ShaderSlots::EnvironmentMap::DiffuseTexture, m_impl->Resources.EnvironmentMapSampler.get()));
-
-        XRC_CHECK_THROW_GLCMD(  //
-            glActiveTexture(GL_TEXTURE0 + ShaderSlots::GLSL::MaterialTexturesOffset + ShaderSlots::EnvironmentMap::SpecularTexture));
-        XRC_CHECK_THROW_GLCMD(glBindTexture(GL_TEXTURE_CUBE_MAP, m_impl->Resources.SpecularEnvironmentMap->get()));
-        XRC_CHECK_THROW_GLCMD(glBindSampler(ShaderSlots::EnvironmentMap::SpecularTexture, m_impl->Resources.EnvironmentMapSampler.get()));
+        // ModelConstantBuffer is bound in GLModelInstance::DrawPrimitive
+
+        state.BindTexture(ShaderSlots::GLSL::MaterialTexturesOffset + ShaderSlots::Brdf, GL_TEXTURE_2D, m_impl->Resources.BrdfLut->get());
+        state.BindSampler(ShaderSlots::Pbr::Brdf, m_impl->Resources.BrdfSampler.get());
+
+        state.BindTexture(ShaderSlots::GLSL::MaterialTexturesOffset + ShaderSlots::EnvironmentMap::DiffuseTexture, GL_TEXTURE_CUBE_MAP,
+                          m_impl->Resources.DiffuseEnvironmentMap->get());
+        state.BindSampler(ShaderSlots::EnvironmentMap::DiffuseTexture, m_impl->Resources.EnvironmentMapSampler.get());
+
+        state.BindTexture(ShaderSlots::GLSL::MaterialTexturesOffset + ShaderSlots::EnvironmentMap::SpecularTexture, GL_TEXTURE_CUBE_MAP,
+                          m_impl->Resources.SpecularEnvironmentMap->get());
+        state.BindSampler(ShaderSlots::EnvironmentMap::SpecularTexture, m_impl->Resources.EnvironmentMapSampler.get());
+    }
+
+    Conformance::GLStateCache& GLResources::GetStateCache() const
+    {
+        return m_impl->StateCache;
     }
 
     PrimitiveHandle GLResources::MakePrimitive(const Pbr::PrimitiveBuilder& primitiveBuilder,
@@ -360,7 +375,12 @@ namespace Pbr
         if (!typedMaterial) {
             throw std::logic_error("Got the wrong type of material");
         }
-        return m_impl->Primitives.emplace_back(primitiveBuilder, typedMaterial);
+        PrimitiveHandle handle =
+            m_impl->Primitives.emplace_back(primitiveBuilder, typedMaterial, m_impl->CompactVertices, m_impl->UploadWorker);
+        if (m_impl->UploadWorker != nullptr) {
+            m_impl->loaderResources.pendingPrimitives.push_back(handle);
+        }
+        return handle;
     }
 
     GLPrimitive& GLResources::GetPrimitive(PrimitiveHandle p)
@@ -400,26 +420,17 @@ namespace Pbr
 
     void GLResources::SetBlendState(bool enabled) const
     {
+        Conformance::GLStateCache& state = m_impl->StateCache;
+        state.SetEnabled(GL_BLEND, enabled);
         if (enabled) {
-            XRC_CHECK_THROW_GLCMD(glEnable(GL_BLEND));
-            XRC_CHECK_THROW_GLCMD(glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ZERO, GL_ONE));
-            XRC_CHECK_THROW_GLCMD(glBlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD));
-        }
-        else {
-
-            XRC_CHECK_THROW_GLCMD(glDisable(GL_BLEND));
+            state.BlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ZERO, GL_ONE);
+            state.BlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
         }
     }
 
     void GLResources::SetRasterizerState(bool doubleSided) const
     {
-        if (doubleSided) {
-            XRC_CHECK_THROW_GLCMD(glDisable(GL_CULL_FACE));
-        }
-        else {
-
-            XRC_CHECK_THROW_GLCMD(glEnable(GL_CULL_FACE));
-        }
+        m_impl->StateCache.SetEnabled(GL_CULL_FACE, !doubleSided);
 #ifdef XR_USE_GRAPHICS_API_OPENGL
         // This does not set double-sided rendering, it says we control both front and back
         XRC_CHECK_THROW_GLCMD(glPolygonMode(GL_FRONT_AND_BACK, m_sharedState.GetFillMode() == FillMode::Wireframe ? GL_LINE : GL_FILL));
@@ -430,8 +441,9 @@ namespace Pbr
 
     void GLResources::SetDepthStencilState(bool disableDepthWrite) const
     {
-        XRC_CHECK_THROW_GLCMD(glDepthFunc(m_sharedState.GetDepthDirection() == DepthDirection::Reversed ? GL_GREATER : GL_LESS));
-        XRC_CHECK_THROW_GLCMD(glDepthMask(disableDepthWrite ? GL_FALSE : GL_TRUE));
+        Conformance::GLStateCache& state = m_impl->StateCache;
+        state.DepthFunc(m_sharedState.GetDepthDirection() == DepthDirection::Reversed ? GL_GREATER : GL_LESS);
+        state.DepthMask(disableDepthWrite ? GL_FALSE : GL_TRUE);
     }
 }  // namespace Pbr
 
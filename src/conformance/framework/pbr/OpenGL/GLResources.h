@@ -30,6 +30,12 @@ namespace tinygltf
     struct Sampler;
 }  // namespace tinygltf
 
+namespace Conformance
+{
+    class GLStateCache;
+    class GLUploadWorker;
+}  // namespace Conformance
+
 namespace Pbr
 {
     using nonstd::span;
@@ -54,7 +60,8 @@ namespace Pbr
     /// Global PBR resources required for rendering a scene.
     struct GLResources final : public IGltfBuilder
     {
-        explicit GLResources();
+        /// With @p compactVertices, primitives store their vertices as Pbr::CompactVertex, reducing vertex bandwidth.
+        explicit GLResources(bool compactVertices = false);
         GLResources(GLResources&&) noexcept;
 
         ~GLResources() override;
@@ -63,8 +70,9 @@ namespace Pbr
                                                      RGBColor emissiveFactor = RGB::Black) override;
         std::shared_ptr<Material> CreateMaterial() override;
 
-        void LoadTexture(const std::shared_ptr<Material>& pbrMaterial, Pbr::ShaderSlots::PSMaterial slot, const tinygltf::Image* image,
-                         const tinygltf::Sampler* sampler, bool sRGB, Pbr::RGBAColor defaultRGBA) override;
+        void LoadTexture(const std::shared_ptr<Material>& pbrMaterial, Pbr::ShaderSlots::PSMaterial slot,
+                         const GltfHelper::DecodedImage* image, const tinygltf::Sampler* sampler, bool sRGB,
+                         Pbr::RGBAColor defaultRGBA) override;
         PrimitiveHandle MakePrimitive(const Pbr::PrimitiveBuilder& primitiveBuilder,
                                       const std::shared_ptr<Pbr::Material>& material) override;
         void DropLoaderCaches() override;
@@ -87,12 +95,22 @@ namespace Pbr
         /// number of textures created.
         std::shared_ptr<ScopedGLTexture> CreateTypedSolidColorTexture(RGBAColor color, bool sRGB) const;
 
+        /// Set the bytes of textures kept cached once no model uses them. See Pbr::TextureCache.
+        void SetTextureCacheBudget(uint64_t budgetBytes);
+
+        /// Upload the textures and buffers of models being built on @p uploadWorker, which must outlive these resources or be
+        /// unset first, waiting for them in DropLoaderCaches. Null, the default, uploads them on the calling thread.
+        void SetUploadWorker(Conformance::GLUploadWorker* uploadWorker);
+
         /// Get the cached list of texture formats supported by the device
-        span<const Conformance::Image::FormatParams> GetSupportedFormats() const;
+        span<const Conformance::Image::FormatParams> GetSupportedFormats() const override;
 
         /// Bind the the PBR resources to the current context.
         void Bind() const;
 
+        /// The state cache that PBR rendering binds through, which the simple-mesh renderer shares to skip redundant binds.
+        Conformance::GLStateCache& GetStateCache() const;
+
         /// Get the GLPrimitive from a primitive handle.
         GLPrimitive& GetPrimitive(PrimitiveHandle p);
 
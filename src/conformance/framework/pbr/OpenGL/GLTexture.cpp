@@ -41,7 +41,7 @@ namespace Pbr
         }
 
         /// Creates a texture and fills all array members with the data in rgba
-        ScopedGLTexture CreateTextureOrCubemapRepeat(const Image::Image& image, bool isCubemap)
+        ScopedGLTexture CreateTextureOrCubemapRepeat(const Image::Image& image, bool isCubemap, bool generateMips)
         {
             assert(image.format.codec == Image::Codec::Raw8bpc);     // only 8bpc is implemented
             assert(image.format.channels == Image::Channels::RGBA);  // non-RGBA isn't implemented
@@ -60,6 +60,10 @@ namespace Pbr
             uint16_t baseMipWidth = image.levels[0].metadata.physicalDimensions.width;
             uint16_t baseMipHeight = image.levels[0].metadata.physicalDimensions.height;
 
+            // Only the base level is uploaded, the rest of the chain is generated from it.
+            generateMips = generateMips && !isCubemap && CanGenerateMips(image);
+            const int mipLevels = generateMips ? GetFullMipChainLevelCount(baseMipWidth, baseMipHeight) : (int)image.levels.size();
+
             ScopedGLTexture texture{};
 
             const GLenum target = isCubemap ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
@@ -70,50 +74,35 @@ namespace Pbr
             XRC_CHECK_THROW_GLCMD(glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
             XRC_CHECK_THROW_GLCMD(glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
             XRC_CHECK_THROW_GLCMD(glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, 0));
-            XRC_CHECK_THROW_GLCMD(glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, 0));  // if we add mipmaps we need to change this
-            if (isCompressed) {
-                assert(!isCubemap);  // compressed cubemaps aren't implemented
-                XRC_CHECK_THROW_GLCMD(
-                    glCompressedTexImage2D(target, 0, glFormat.InternalFormat, baseMipWidth, baseMipHeight, 0, 0, nullptr));
-            }
-            else {
-                assert(uncompressedFormat != GLFormatData::Unpopulated);
-                assert(uncompressedType != GLFormatData::Unpopulated);
-                if (isCubemap) {
-                    for (unsigned int i = 0; i < 6; i++)
-                        XRC_CHECK_THROW_GLCMD(glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, glFormat.InternalFormat, baseMipWidth,
-                                                           baseMipHeight, 0, uncompressedFormat, uncompressedType, nullptr));
-                }
-                else {
-                    XRC_CHECK_THROW_GLCMD(glTexImage2D(target, 0, glFormat.InternalFormat, baseMipWidth, baseMipHeight, 0,
-                                                       uncompressedFormat, uncompressedType, nullptr));
-                }
-            }
-            XRC_CHECK_THROW_GLCMD(glBindTexture(target, texture.get()));
+            XRC_CHECK_THROW_GLCMD(glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, mipLevels - 1));
 
             for (int mipLevel = 0; mipLevel < (int)image.levels.size(); mipLevel++) {
                 auto levelData = image.levels[mipLevel];
                 auto width = levelData.metadata.physicalDimensions.width;
                 auto height = levelData.metadata.physicalDimensions.height;
                 if (isCompressed) {
-                    XRC_CHECK_THROW_GLCMD(glCompressedTexSubImage2D(target, mipLevel, 0, 0, width, height, glFormat.InternalFormat,
-                                                                    levelData.data.size(), levelData.data.data()));
+                    assert(!isCubemap);  // compressed cubemaps aren't implemented
+                    XRC_CHECK_THROW_GLCMD(glCompressedTexImage2D(target, mipLevel, glFormat.InternalFormat, width, height, 0,
+                                                                 levelData.data.size(), levelData.data.data()));
                 }
                 else {
                     assert(uncompressedFormat != GLFormatData::Unpopulated);
                     assert(uncompressedType != GLFormatData::Unpopulated);
                     if (isCubemap) {
                         for (unsigned int i = 0; i < 6; i++) {
-                            XRC_CHECK_THROW_GLCMD(glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, 0, 0, width, height,
-                                                                  uncompressedFormat, uncompressedType, levelData.data.data()));
+                            XRC_CHECK_THROW_GLCMD(glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, mipLevel, glFormat.InternalFormat, width,
+                                                               height, 0, uncompressedFormat, uncompressedType, levelData.data.data()));
                         }
                     }
                     else {
-                        XRC_CHECK_THROW_GLCMD(
-                            glTexSubImage2D(target, 0, 0, 0, width, height, uncompressedFormat, uncompressedType, levelData.data.data()));
+                        XRC_CHECK_THROW_GLCMD(glTexImage2D(target, mipLevel, glFormat.InternalFormat, width, height, 0, uncompressedFormat,
+                                                           uncompressedType, levelData.data.data()));
                     }
                 }
             }
+            if (generateMips) {
+                XRC_CHECK_THROW_GLCMD(glGenerateMipmap(target));
+            }
             XRC_CHECK_THROW_GLCMD(glBindTexture(target, 0));
 
             return texture;
@@ -127,12 +116,12 @@ namespace Pbr
             auto metadata = Image::ImageLevelMetadata::MakeUncompressed(1, 1);
             auto face = Image::Image{formatParams, {{metadata, rgbaColor}}};
 
-            return CreateTextureOrCubemapRepeat(face, true);
+            return CreateTextureOrCubemapRepeat(face, true, false);
         }
 
-        ScopedGLTexture CreateTexture(const Image::Image& image)
+        ScopedGLTexture CreateTexture(const Image::Image& image, bool generateMips)
         {
-            return CreateTextureOrCubemapRepeat(image, false);
+            return CreateTextureOrCubemapRepeat(image, false, generateMips);
         }
 
         ScopedGLSampler CreateSampler(GLenum edgeSamplingMode)
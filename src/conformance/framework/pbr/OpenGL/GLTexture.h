@@ -29,7 +29,8 @@ namespace Pbr
     {
         ScopedGLTexture LoadTextureImage(const GLResources& pbrResources, bool sRGB, const uint8_t* fileData, uint32_t fileSize);
         ScopedGLTexture CreateFlatCubeTexture(RGBAColor color, bool sRGB);
-        ScopedGLTexture CreateTexture(const Conformance::Image::Image& image);
+        /// @param generateMips Generate the rest of the mip chain on the GPU if @p image only has its base level and is uncompressed.
+        ScopedGLTexture CreateTexture(const Conformance::Image::Image& image, bool generateMips = false);
         ScopedGLSampler CreateSampler(GLenum edgeSamplingMode = GL_CLAMP_TO_EDGE);
     }  // namespace GLTexture
 }  // namespace Pbr
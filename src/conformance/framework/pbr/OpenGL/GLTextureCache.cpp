@@ -23,15 +23,10 @@
 #include <array>
 #include <cstdint>
 #include <memory>
-#include <mutex>
 #include <stdexcept>
 
 namespace Pbr
 {
-    GLTextureCache::GLTextureCache() : m_cacheMutex(std::make_unique<std::mutex>())
-    {
-    }
-
     std::shared_ptr<ScopedGLTexture> GLTextureCache::CreateTypedSolidColorTexture(XrColor4f color, bool sRGB)
     {
         if (!IsValid()) {
@@ -39,25 +34,11 @@ namespace Pbr
         }
         const std::array<uint8_t, 4> rgba = LoadRGBAUI4(color);
 
-        // Check cache to see if this flat texture already exists.
-        const uint32_t colorKey = *reinterpret_cast<const uint32_t*>(rgba.data());
-        {
-            std::lock_guard<std::mutex> guard(*m_cacheMutex);
-            auto textureIt = m_solidColorTextureCache.find(colorKey);
-            if (textureIt != m_solidColorTextureCache.end()) {
-                return textureIt->second;
-            }
-        }
-
         auto formatParams = Conformance::Image::FormatParams::R8G8B8A8(sRGB);
         auto metadata = Conformance::Image::ImageLevelMetadata::MakeUncompressed(1, 1);
         auto image = Conformance::Image::Image{formatParams, {{metadata, rgba}}};
 
-        auto texture = std::make_shared<ScopedGLTexture>(GLTexture::CreateTexture(image));
-
-        std::lock_guard<std::mutex> guard(*m_cacheMutex);
-        // If the key already exists then the existing texture will be returned.
-        return m_solidColorTextureCache.emplace(colorKey, texture).first->second;
+        return m_textures.FindOrCreate(image, [&] { return std::make_shared<ScopedGLTexture>(GLTexture::CreateTexture(image)); });
     }
 }  // namespace Pbr
 
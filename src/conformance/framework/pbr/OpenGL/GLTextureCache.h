@@ -9,41 +9,52 @@
 
 #include "GLCommon.h"
 
+#include "../PbrTextureCache.h"
+
 #include "common/gfxwrapper_opengl.h"
 
 #include <openxr/openxr.h>
 
-#include <map>
 #include <memory>
-#include <mutex>
 #include <stdint.h>
+#include <utility>
 
 namespace Pbr
 {
 
-    /// Cache of single-color textures.
+    /// Cache of textures by content, including single-color textures. See Pbr::TextureCache.
     ///
     /// Device-dependent, drop when device is lost or destroyed.
     class GLTextureCache
     {
     public:
-        GLTextureCache();
+        GLTextureCache() = default;
 
         GLTextureCache(GLTextureCache&&) = default;
         GLTextureCache& operator=(GLTextureCache&&) = default;
 
         bool IsValid() const noexcept
         {
-            return m_cacheMutex != nullptr;
+            return m_textures.IsValid();
         }
 
         /// Find or create a single pixel texture of the given color
         std::shared_ptr<ScopedGLTexture> CreateTypedSolidColorTexture(XrColor4f color, bool sRGB);
 
+        /// Find the texture with the content of @p image, or create it by calling @p create.
+        template <typename Create>
+        std::shared_ptr<ScopedGLTexture> FindOrCreate(const Conformance::Image::Image& image, Create&& create)
+        {
+            return m_textures.FindOrCreate(image, std::forward<Create>(create));
+        }
+
+        void SetBudget(uint64_t budgetBytes)
+        {
+            m_textures.SetBudget(budgetBytes);
+        }
+
     private:
-        // in unique_ptr to make it moveable
-        std::unique_ptr<std::mutex> m_cacheMutex;
-        std::map<uint32_t, std::shared_ptr<ScopedGLTexture>> m_solidColorTextureCache;
+        TextureCache<std::shared_ptr<ScopedGLTexture>> m_textures;
     };
 
 }  // namespace Pbr
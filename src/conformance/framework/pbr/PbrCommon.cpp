@@ -13,9 +13,11 @@
 
 #include <openxr/openxr.h>
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <sstream>
 #include <stddef.h>
 #include <stdexcept>
@@ -260,8 +262,88 @@ namespace Pbr
         return *this;
     }
 
+    namespace
+    {
+        int16_t PackSnorm16(float value)
+        {
+            return (int16_t)std::lround(std::min(std::max(value, -1.0f), 1.0f) * 32767.0f);
+        }
+
+        uint8_t PackUnorm8(float value)
+        {
+            return (uint8_t)std::lround(std::min(std::max(value, 0.0f), 1.0f) * 255.0f);
+        }
+
+        // IEEE 754 binary16, rounded to nearest even.
+        uint16_t PackHalf(float value)
+        {
+            uint32_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            const uint32_t sign = (bits >> 16) & 0x8000;
+            const uint32_t magnitude = bits & 0x7fffffff;
+            if (magnitude >= 0x7f800000) {
+                // Infinity, or NaN, keeping it a NaN.
+                return (uint16_t)(sign | 0x7c00 | (magnitude > 0x7f800000 ? 0x200 : 0));
+            }
+            if (magnitude < 0x38800000) {
+                // Below the smallest normal half, 2^-14: a denormal in units of 2^-24, rounding to 0x400 is the smallest normal.
+                return (uint16_t)(sign | (uint32_t)std::lrint(std::fabs(value) * 16777216.0f));
+            }
+            // Rebias the exponent from 127 to 15 and round off 13 bits of mantissa. Rounding up may carry into the exponent,
+            // which also turns values too large for a half into infinity.
+            const uint32_t rebiased = magnitude - 0x38000000;
+            const uint32_t rounded = (rebiased + 0xfff + ((rebiased >> 13) & 1)) >> 13;
+            return (uint16_t)(sign | std::min<uint32_t>(rounded, 0x7c00));
+        }
+    }  // namespace
+
+    std::vector<CompactVertex> PackCompactVertices(const std::vector<Vertex>& vertices)
+    {
+        std::vector<CompactVertex> compactVertices(vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++) {
+            const Vertex& vertex = vertices[i];
+            CompactVertex& compactVertex = compactVertices[i];
+            compactVertex.Position = vertex.Position;
+            compactVertex.Normal[0] = PackSnorm16(vertex.Normal.x);
+            compactVertex.Normal[1] = PackSnorm16(vertex.Normal.y);
+            compactVertex.Normal[2] = PackSnorm16(vertex.Normal.z);
+            compactVertex.Normal[3] = 0;
+            compactVertex.Tangent[0] = PackSnorm16(vertex.Tangent.x);
+            compactVertex.Tangent[1] = PackSnorm16(vertex.Tangent.y);
+            compactVertex.Tangent[2] = PackSnorm16(vertex.Tangent.z);
+            compactVertex.Tangent[3] = PackSnorm16(vertex.Tangent.w);
+            compactVertex.Color0[0] = PackUnorm8(vertex.Color0.r);
+            compactVertex.Color0[1] = PackUnorm8(vertex.Color0.g);
+            compactVertex.Color0[2] = PackUnorm8(vertex.Color0.b);
+            compactVertex.Color0[3] = PackUnorm8(vertex.Color0.a);
+            compactVertex.TexCoord0[0] = PackHalf(vertex.TexCoord0.x);
+            compactVertex.TexCoord0[1] = PackHalf(vertex.TexCoord0.y);
+            compactVertex.ModelTransformIndex = vertex.ModelTransformIndex;
+        }
+        return compactVertices;
+    }
+
     std::vector<NodeIndex_t> PrimitiveBuilder::NodeIndicesVector() const
     {
         return std::vector<NodeIndex_t>(NodeIndices.begin(), NodeIndices.end());
     }
+
+    std::vector<NodeBounds> PrimitiveBuilder::ComputeNodeBounds() const
+    {
+        std::vector<NodeBounds> bounds;
+        for (const Pbr::Vertex& vertex : Vertices) {
+            // Vertices of the same node are usually contiguous, so the last bounds are almost always the right ones.
+            auto it = !bounds.empty() && bounds.back().Node == vertex.ModelTransformIndex
+                          ? bounds.end() - 1
+                          : std::find_if(bounds.begin(), bounds.end(),
+                                         [&](const NodeBounds& nodeBounds) { return nodeBounds.Node == vertex.ModelTransformIndex; });
+            if (it == bounds.end()) {
+                bounds.push_back(NodeBounds{vertex.ModelTransformIndex, vertex.Position, vertex.Position});
+                continue;
+            }
+            XrVector3f_Min(&it->Min, &it->Min, &vertex.Position);
+            XrVector3f_Max(&it->Max, &it->Max, &vertex.Position);
+        }
+        return bounds;
+    }
 }  // namespace Pbr
@@ -35,9 +35,9 @@
 
 #endif
 
-namespace tinygltf
+namespace GltfHelper
 {
-    struct Image;
+    struct DecodedImage;
 }
 namespace Pbr
 {
@@ -59,7 +59,7 @@ namespace Pbr
     using RGBAColor = XrColor4f;
     using RGBColor = XrVector3f;
 
-    using ImageKey = std::tuple<const tinygltf::Image*, bool>;  // Item1 is a pointer to the image, Item2 is sRGB.
+    using ImageKey = std::tuple<const GltfHelper::DecodedImage*, bool>;  // Item1 is a pointer to the image, Item2 is sRGB.
 
     // // DirectX::Colors are in sRGB color space.
     // RGBAColor FromSRGB(DirectX::XMVECTOR color);
@@ -89,6 +89,32 @@ namespace Pbr
         NodeIndex_t ModelTransformIndex;  // Index into the node transforms
     };
 
+    /// Smaller layout of Vertex, for backends that support it, with the same attributes in formats that vertex fetch converts
+    /// to floats, so the PBR shaders read it unchanged: normals and tangents are 16-bit signed normalized, colors 8-bit unsigned
+    /// normalized and texture coordinates half floats. Positions stay full floats, since models may span any range.
+    struct CompactVertex
+    {
+        XrVector3f Position;
+        int16_t Normal[4];   // The fourth component is unused
+        int16_t Tangent[4];
+        uint8_t Color0[4];
+        uint16_t TexCoord0[2];
+        NodeIndex_t ModelTransformIndex;  // Index into the node transforms
+    };
+
+    static_assert(sizeof(CompactVertex) == 40, "CompactVertex is expected to be tightly packed");
+
+    /// Convert @p vertices to CompactVertex. Values out of range of the normalized formats are clamped.
+    std::vector<CompactVertex> PackCompactVertices(const std::vector<Vertex>& vertices);
+
+    /// Bounds of the vertices of a primitive that one node transforms, in the space of that node.
+    struct NodeBounds
+    {
+        NodeIndex_t Node;
+        XrVector3f Min;
+        XrVector3f Max;
+    };
+
     struct PrimitiveBuilder
     {
         std::vector<Pbr::Vertex> Vertices;
@@ -107,5 +133,8 @@ namespace Pbr
                                   Pbr::NodeIndex_t transformIndex = Pbr::RootNodeIndex, RGBAColor vertexColor = RGBA::White);
 
         std::vector<NodeIndex_t> NodeIndicesVector() const;
+
+        /// Compute the bounds of the vertices transformed by each node, for culling the primitive.
+        std::vector<NodeBounds> ComputeNodeBounds() const;
     };
 }  // namespace Pbr
@@ -0,0 +1,173 @@
+// Copyright 2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include "PbrSharedState.h"
+
+#include <algorithm>
+#include <functional>
+#include <stdint.h>
+#include <vector>
+
+namespace Pbr
+{
+    /// Numbers of draws and state changes made drawing glTF models, to check how well DrawQueue avoids rebinding.
+    struct DrawStats
+    {
+        /// Views (or single model renders) drawn
+        uint64_t views{0};
+        uint64_t draws{0};
+        /// Primitives not drawn because they were out of view
+        uint64_t culled{0};
+        /// Pipeline state changes: pipeline objects, or blend, depth and rasterizer states where there are none.
+        uint64_t pipelineBinds{0};
+        /// Material changes: material constants, textures and samplers.
+        uint64_t materialBinds{0};
+        /// Bind and render state calls made over whole views, by backends that shadow that state (OpenGL and OpenGL ES)
+        uint64_t stateCalls{0};
+        /// State calls those backends skipped because they would have set what was already set
+        uint64_t stateCallsSkipped{0};
+
+        DrawStats& operator+=(const DrawStats& other)
+        {
+            views += other.views;
+            draws += other.draws;
+            culled += other.culled;
+            pipelineBinds += other.pipelineBinds;
+            materialBinds += other.materialBinds;
+            stateCalls += other.stateCalls;
+            stateCallsSkipped += other.stateCallsSkipped;
+            return *this;
+        }
+    };
+
+    /// State bound by the previous draw, so that a backend can skip binding it again.
+    struct DrawBindState
+    {
+        /// Returns true, and counts a bind, if @p pipeline is not the one bound.
+        bool BindPipeline(uint64_t pipeline)
+        {
+            if (m_hasPipeline && m_pipeline == pipeline) {
+                return false;
+            }
+            m_hasPipeline = true;
+            m_pipeline = pipeline;
+            stats.pipelineBinds++;
+            return true;
+        }
+
+        /// Returns true, and counts a bind, if @p material is not the one bound.
+        /// Binding a pipeline invalidates the material, as some backends set pipeline state when binding a material.
+        bool BindMaterial(const void* material)
+        {
+            if (m_materialPipeline == m_pipeline && m_material == material) {
+                return false;
+            }
+            m_material = material;
+            m_materialPipeline = m_pipeline;
+            stats.materialBinds++;
+            return true;
+        }
+
+        /// Returns true if the constant buffer and transforms of @p modelInstance are not the ones bound.
+        bool BindModelInstance(const void* modelInstance)
+        {
+            if (m_modelInstance == modelInstance) {
+                return false;
+            }
+            m_modelInstance = modelInstance;
+            return true;
+        }
+
+        DrawStats stats;
+
+    private:
+        bool m_hasPipeline{false};
+        uint64_t m_pipeline{0};
+        uint64_t m_materialPipeline{0};
+        const void* m_material{nullptr};
+        const void* m_modelInstance{nullptr};
+    };
+
+    /// Identifies the pipeline state a primitive needs, for backends without pipeline objects.
+    inline uint64_t MakePipelineKey(FillMode fillMode, BlendState blendState, DoubleSided doubleSided)
+    {
+        return (uint64_t(blendState) << 2) | (uint64_t(fillMode) << 1) | uint64_t(doubleSided);
+    }
+
+    /// One primitive of one of the glTF models drawn in a view.
+    struct DrawItem
+    {
+        /// Index of the model in the list of models drawn, e.g. RenderParams::glTFs
+        uint32_t drawable;
+        /// Index of the primitive in the model
+        uint32_t primitive;
+        /// Fill mode of the model, which the backend resources need set before binding the pipeline state
+        FillMode fillMode;
+        uint64_t pipelineKey;
+        const void* material;
+    };
+
+    /// Orders the primitives of all the glTF models drawn in a view to minimize pipeline and material changes.
+    ///
+    /// Opaque primitives come first, grouped by pipeline state, then material. Blended primitives come last, in the order
+    /// they were added, since what they blend with depends on it.
+    class DrawQueue
+    {
+    public:
+        void Clear()
+        {
+            m_items.clear();
+            m_culledCount = 0;
+        }
+
+        /// Count a primitive left out because it was out of view.
+        void CountCulled()
+        {
+            m_culledCount++;
+        }
+
+        uint32_t GetCulledCount() const
+        {
+            return m_culledCount;
+        }
+
+        void Add(uint32_t drawable, uint32_t primitive, FillMode fillMode, BlendState blendState, DoubleSided doubleSided,
+                 const void* material)
+        {
+            m_items.push_back(DrawItem{drawable, primitive, fillMode, MakePipelineKey(fillMode, blendState, doubleSided), material});
+        }
+
+        void Sort()
+        {
+            const uint64_t blendedKeys = MakePipelineKey(FillMode::Solid, BlendState::AlphaBlended, DoubleSided::DoubleSided);
+            std::stable_sort(m_items.begin(), m_items.end(), [=](const DrawItem& a, const DrawItem& b) {
+                const bool aBlended = a.pipelineKey >= blendedKeys;
+                const bool bBlended = b.pipelineKey >= blendedKeys;
+                if (aBlended || bBlended) {
+                    return !aBlended;
+                }
+                if (a.pipelineKey != b.pipelineKey) {
+                    return a.pipelineKey < b.pipelineKey;
+                }
+                if (a.material != b.material) {
+                    return std::less<const void*>()(a.material, b.material);
+                }
+                if (a.drawable != b.drawable) {
+                    return a.drawable < b.drawable;
+                }
+                return a.primitive < b.primitive;
+            });
+        }
+
+        const std::vector<DrawItem>& Items() const
+        {
+            return m_items;
+        }
+
+    private:
+        std::vector<DrawItem> m_items;
+        uint32_t m_culledCount{0};
+    };
+}  // namespace Pbr
@@ -0,0 +1,51 @@
+// Copyright 2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include "common/xr_linear.h"
+#include "utilities/xr_math_operators.h"
+
+#include <openxr/openxr.h>
+
+namespace Pbr
+{
+    /// The view frustum a model is rendered with, for culling the primitives of the model that are out of view.
+    ///
+    /// Only the side planes are tested: the depth range of clip space differs between graphics APIs and the side planes
+    /// already exclude everything behind the viewer.
+    class Frustum
+    {
+    public:
+        /// @p modelToClip is the projection * view * model-to-world transform the model is rendered with.
+        explicit Frustum(const XrMatrix4x4f& modelToClip) : m_modelToClip(modelToClip)
+        {
+        }
+
+        /// Returns true if no part of the box from @p min to @p max, in a node transformed by @p nodeToModel, is in view.
+        bool IsBoxOutside(const XrMatrix4x4f& nodeToModel, const XrVector3f& min, const XrVector3f& max) const
+        {
+            using namespace openxr::math_operators;
+            const XrMatrix4x4f nodeToClip = m_modelToClip * nodeToModel;
+            const float* m = nodeToClip.m;
+            for (int axis = 0; axis < 2; ++axis) {
+                for (float sign : {1.0f, -1.0f}) {
+                    // The plane w + sign * x (or y) = 0 of clip space, from the rows of the column-major matrix.
+                    const float a = m[3] + sign * m[axis];
+                    const float b = m[7] + sign * m[4 + axis];
+                    const float c = m[11] + sign * m[8 + axis];
+                    const float d = m[15] + sign * m[12 + axis];
+                    // If even the corner furthest along the plane normal is outside the plane, the whole box is.
+                    const float distance = a * (a >= 0 ? max.x : min.x) + b * (b >= 0 ? max.y : min.y) + c * (c >= 0 ? max.z : min.z) + d;
+                    if (distance < 0) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+    private:
+        XrMatrix4x4f m_modelToClip;
+    };
+}  // namespace Pbr
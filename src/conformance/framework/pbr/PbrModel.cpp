@@ -28,27 +28,36 @@ namespace Pbr
             throw std::runtime_error("Only the first node can be the root");
         }
 
+        // Only the first node of each name is kept, so emplace leaves an existing entry alone.
+        m_firstNodeByName.emplace(name, newNodeIndex);
+        m_firstChildByName.emplace(ChildNameKey{parentIndex, name}, newNodeIndex);
+
         m_nodes.emplace_back(transform, std::move(name), newNodeIndex, parentIndex);
         return m_nodes.back().GetNodeIndex();
     }
 
     bool Model::FindFirstNode(NodeIndex_t* outNodeIndex, const char* name, const NodeIndex_t* parentNodeIndex) const
     {
-        // Children are guaranteed to come after their parents, so start looking after the parent index if one is provided.
-        const NodeIndex_t startIndex = parentNodeIndex ? *parentNodeIndex + 1 : Pbr::RootNodeIndex;
-        for (NodeIndex_t i = startIndex; i < m_nodes.size(); ++i) {
-            const Pbr::Node& node = m_nodes[i];
-            if ((!parentNodeIndex || node.GetParentNodeIndex() == *parentNodeIndex) && (node.CompareName(name) == 0)) {
-                *outNodeIndex = node.GetNodeIndex();
-                return true;
+        if (parentNodeIndex) {
+            auto it = m_firstChildByName.find(ChildNameKey{*parentNodeIndex, name});
+            if (it == m_firstChildByName.end()) {
+                return false;
             }
+            *outNodeIndex = it->second;
+            return true;
+        }
+        auto it = m_firstNodeByName.find(name);
+        if (it == m_firstNodeByName.end()) {
+            return false;
         }
-        return false;
+        *outNodeIndex = it->second;
+        return true;
     }
 
-    void Model::AddPrimitive(PrimitiveHandle primitive)
+    void Model::AddPrimitive(PrimitiveHandle primitive, std::vector<NodeBounds> bounds)
     {
         m_primitiveHandles.push_back(primitive);
+        m_primitiveBounds.push_back(std::move(bounds));
     }
 
     Node::Node(Node&& other) noexcept
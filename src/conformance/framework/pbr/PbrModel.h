@@ -8,6 +8,8 @@
 #pragma once
 
 #include "PbrCommon.h"
+#include "PbrDrawQueue.h"
+#include "PbrFrustum.h"
 #include "PbrHandles.h"
 
 #include "common/xr_linear.h"
@@ -15,9 +17,12 @@
 
 #include <nonstd/span.hpp>
 
+#include <algorithm>
 #include <memory>
 #include <stdint.h>
+#include <string.h>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -42,6 +47,8 @@ namespace Pbr
         {
         }
 
+        Node(const Node& other) = default;
+        Node& operator=(const Node& other) = default;
         Node(Node&& other) noexcept;
         Node& operator=(Node&& other) noexcept;
 
@@ -86,8 +93,8 @@ namespace Pbr
         /// Add a node to the model.
         NodeIndex_t AddNode(const XrMatrix4x4f& transform, NodeIndex_t parentIndex, std::string name = "");
 
-        /// Add a primitive to the model.
-        void AddPrimitive(PrimitiveHandle primitive);
+        /// Add a primitive to the model, with the bounds of its vertices for culling it. Primitives without bounds are never culled.
+        void AddPrimitive(PrimitiveHandle primitive, std::vector<NodeBounds> bounds = {});
 
         NodeIndex_t GetNodeCount() const
         {
@@ -114,7 +121,8 @@ namespace Pbr
             return m_primitiveHandles[index];
         }
 
-        /// Find the first node (after an optional parent node) which matches a given name.
+        /// Find the first node (or the first child of an optional parent node) which matches a given name.
+        /// Looked up in indices kept by AddNode, so this takes constant time however many nodes the model has.
         bool FindFirstNode(NodeIndex_t* outNodeIndex, const char* name, const NodeIndex_t* parentNodeIndex = nullptr) const;
 
         const std::vector<PrimitiveHandle>& GetPrimitiveHandles() const
@@ -122,6 +130,12 @@ namespace Pbr
             return m_primitiveHandles;
         }
 
+        /// Get the bounds of a primitive by index of primitives used in this model.
+        const std::vector<NodeBounds>& GetPrimitiveBounds(uint32_t index) const
+        {
+            return m_primitiveBounds[index];
+        }
+
         const Node::Collection& GetNodes() const
         {
             return m_nodes;
@@ -132,15 +146,40 @@ namespace Pbr
         // A model is made up of one or more Primitives. Each Primitive has a unique material.
         // Ideally primitives with the same material should be merged to reduce draw calls.
         std::vector<PrimitiveHandle> m_primitiveHandles;
+        std::vector<std::vector<NodeBounds>> m_primitiveBounds;
 
         // A model contains one or more nodes. Each vertex of a primitive references a node to have the
         // node's transform applied.
         Node::Collection m_nodes;
+
+        struct ChildNameKey
+        {
+            NodeIndex_t parentNodeIndex;
+            std::string name;
+
+            bool operator==(const ChildNameKey& other) const
+            {
+                return parentNodeIndex == other.parentNodeIndex && name == other.name;
+            }
+        };
+        struct ChildNameKeyHash
+        {
+            size_t operator()(const ChildNameKey& key) const
+            {
+                return std::hash<std::string>()(key.name) ^ (std::hash<NodeIndex_t>()(key.parentNodeIndex) * 31);
+            }
+        };
+
+        // The first node with each name, and the first child of each node with each name, for FindFirstNode.
+        std::unordered_map<std::string, NodeIndex_t> m_firstNodeByName;
+        std::unordered_map<ChildNameKey, NodeIndex_t, ChildNameKeyHash> m_firstChildByName;
     };
 
     /// A model instance is a collection of node transforms for an instance of a model.
     /// A model instance can only have its transforms updated once per command queue.
     /// A model instance holds a strong shared reference to its corresponding model.
+    ///
+    /// Changed nodes are tracked so that only they and their descendants are re-resolved.
     class ModelInstance
     {
     protected:
@@ -156,23 +195,32 @@ namespace Pbr
                 m_nodeLocalTransforms.push_back(node.GetLocalTransform());
             }
             constexpr XrMatrix4x4f identityMatrix = Matrix::Identity;  // or better yet poison it
+            m_hierarchyTransforms.resize(nodeCount, identityMatrix);
             m_resolvedTransforms.resize(nodeCount, identityMatrix);
+            m_nodeNeedsResolve.resize(nodeCount, true);
         }
 
     public:
         /// Sets the visibility of a node. Nodes otherwise inherit
         void SetNodeVisibility(NodeIndex_t nodeIndex, NodeVisibility visibility)
         {
+            if (m_nodeLocalVisibilities[nodeIndex] == visibility) {
+                return;
+            }
             m_nodeLocalVisibilities[nodeIndex] = visibility;
             // Visibility is implemented by scaling to 0
-            m_resolvedTransformsNeedUpdate = true;
+            MarkNodeNeedsResolve(nodeIndex);
         }
 
         /// Overrides the local transform of a node
         void SetNodeTransform(NodeIndex_t nodeIndex, const XrMatrix4x4f& transform)
         {
+            // Animated nodes are typically set every frame, but mostly to the transform they already have.
+            if (memcmp(&m_nodeLocalTransforms[nodeIndex], &transform, sizeof(XrMatrix4x4f)) == 0) {
+                return;
+            }
             m_nodeLocalTransforms[nodeIndex] = transform;
-            m_resolvedTransformsNeedUpdate = true;
+            MarkNodeNeedsResolve(nodeIndex);
         }
 
         /// Combine a transform with the original transform from the asset
@@ -193,43 +241,70 @@ namespace Pbr
         {
             m_resolvedTransformsNeedUpdate = false;
         }
+        /// Make the next ResolveTransformsAndVisibilities re-resolve every node, not just the changed ones.
+        void MarkAllNodesNeedResolve()
+        {
+            std::fill(m_nodeNeedsResolve.begin(), m_nodeNeedsResolve.end(), true);
+            m_resolvedTransformsNeedUpdate = true;
+        }
         void ResolveTransformsAndVisibilities(bool transpose)
         {
             const auto& nodes = m_model->GetNodes();
 
+            if (transpose != m_resolvedTransposed) {
+                // Everything resolved so far is in the other layout.
+                std::fill(m_nodeNeedsResolve.begin(), m_nodeNeedsResolve.end(), true);
+                m_resolvedTransposed = transpose;
+            }
+
             // Nodes are guaranteed to come after their parents, so each node transform can be multiplied by its parent transform in a single pass.
+            // The same pass carries the need to re-resolve from a changed node down to all of its descendants.
             assert(nodes.size() == m_nodeLocalTransforms.size());
             assert(nodes.size() == m_resolvedTransforms.size());
             constexpr XrMatrix4x4f identityMatrix = Matrix::Identity;
             for (const auto& node : nodes) {
-                bool parentIsRoot = node.GetParentNodeIndex() == Model::RootParentNodeIndex;
-                assert(parentIsRoot || node.GetParentNodeIndex() < node.GetNodeIndex());
+                const NodeIndex_t nodeIndex = node.GetNodeIndex();
+                const NodeIndex_t parentIndex = node.GetParentNodeIndex();
+                bool parentIsRoot = parentIndex == Model::RootParentNodeIndex;
+                assert(parentIsRoot || parentIndex < nodeIndex);
 
-                bool parentVisibility = (parentIsRoot) ? true : m_resolvedVisibilities[node.GetParentNodeIndex()];
-                NodeVisibility nodeVisibility = m_nodeLocalVisibilities[node.GetNodeIndex()];
+                if (!parentIsRoot && m_nodeNeedsResolve[parentIndex]) {
+                    m_nodeNeedsResolve[nodeIndex] = true;
+                }
+                if (!m_nodeNeedsResolve[nodeIndex]) {
+                    continue;
+                }
+
+                bool parentVisibility = (parentIsRoot) ? true : m_resolvedVisibilities[parentIndex];
+                NodeVisibility nodeVisibility = m_nodeLocalVisibilities[nodeIndex];
 
-                m_resolvedVisibilities[node.GetNodeIndex()] =
-                    nodeVisibility == NodeVisibility::Inherit ? parentVisibility : nodeVisibility == NodeVisibility::Visible;
+                const bool visible = nodeVisibility == NodeVisibility::Inherit ? parentVisibility : nodeVisibility == NodeVisibility::Visible;
+                m_resolvedVisibilities[nodeIndex] = visible;
 
-                const XrMatrix4x4f& parentTransform = (parentIsRoot) ? identityMatrix : m_resolvedTransforms[node.GetParentNodeIndex()];
-                const XrMatrix4x4f& nodeTransform = m_nodeLocalTransforms[node.GetNodeIndex()];
+                // Children are resolved against the hierarchy transform of their parent rather than the resolved one,
+                // so a visible child of an invisible parent still ends up in the right place.
+                const XrMatrix4x4f& parentTransform = (parentIsRoot) ? identityMatrix : m_hierarchyTransforms[parentIndex];
+                const XrMatrix4x4f& nodeTransform = m_nodeLocalTransforms[nodeIndex];
 
+                XrMatrix4x4f& hierarchyTransform = m_hierarchyTransforms[nodeIndex];
                 if (transpose) {
                     XrMatrix4x4f nodeTransformTranspose = Matrix::Transposed(nodeTransform);
-                    m_resolvedTransforms[node.GetNodeIndex()] = nodeTransformTranspose * parentTransform;
+                    hierarchyTransform = nodeTransformTranspose * parentTransform;
                 }
                 else {
-                    m_resolvedTransforms[node.GetNodeIndex()] = parentTransform * nodeTransform;
+                    hierarchyTransform = parentTransform * nodeTransform;
                 }
-            }
 
-            // After all node transforms and visibilities have been propagated,
-            // zero the transforms of invisible nodes.
-            for (const auto& node : nodes) {
-                if (!m_resolvedVisibilities[node.GetNodeIndex()]) {
-                    XrMatrix4x4f_CreateScale(&m_resolvedTransforms[node.GetNodeIndex()], 0, 0, 0);
+                // Zero the transforms of invisible nodes.
+                if (visible) {
+                    m_resolvedTransforms[nodeIndex] = hierarchyTransform;
+                }
+                else {
+                    XrMatrix4x4f_CreateScale(&m_resolvedTransforms[nodeIndex], 0, 0, 0);
                 }
             }
+
+            std::fill(m_nodeNeedsResolve.begin(), m_nodeNeedsResolve.end(), false);
         }
 
         const Model& GetModel() const
@@ -252,8 +327,78 @@ namespace Pbr
             return false;
         }
 
+        /// Returns true unless every node bounds of primitive @p primitiveIndex of the model is out of view of @p frustum.
+        bool IsPrimitiveInFrustum(uint32_t primitiveIndex, const Frustum& frustum) const
+        {
+            const std::vector<NodeBounds>& bounds = m_model->GetPrimitiveBounds(primitiveIndex);
+            if (bounds.empty()) {
+                return true;
+            }
+            for (const NodeBounds& nodeBounds : bounds) {
+                if (!m_resolvedVisibilities[nodeBounds.Node]) {
+                    continue;
+                }
+                const XrMatrix4x4f& resolvedTransform = m_resolvedTransforms[nodeBounds.Node];
+                const XrMatrix4x4f nodeToModel = m_resolvedTransposed ? Matrix::Transposed(resolvedTransform) : resolvedTransform;
+                if (!frustum.IsBoxOutside(nodeToModel, nodeBounds.Min, nodeBounds.Max)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /// Store @p next in @p current, the copy of the model constant buffer last uploaded, and return true if it changed
+        /// so that it needs uploading again. Every view of a frame renders the model with the same model-to-world
+        /// transform, so only the first view uploads it, like the node transforms, and a model that does not move does not
+        /// upload it at all.
+        template <typename ModelConstantBuffer>
+        bool UpdateModelConstants(ModelConstantBuffer& current, const ModelConstantBuffer& next)
+        {
+            if (m_modelConstantsUploaded && memcmp(&current, &next, sizeof(ModelConstantBuffer)) == 0) {
+                return false;
+            }
+            current = next;
+            m_modelConstantsUploaded = true;
+            return true;
+        }
+
+    public:
+        /// Add the primitives of this model that are visible and not hidden to @p queue, as model @p drawable.
+        /// With a @p frustum, primitives entirely out of view are culled too.
+        /// Call after the node transforms and visibilities have been resolved for the frame.
+        template <typename Resources>
+        void AppendDraws(const Resources& pbrResources, FillMode fillMode, uint32_t drawable, DrawQueue& queue,
+                         const Frustum* frustum = nullptr) const
+        {
+            const auto& primitiveHandles = m_model->GetPrimitiveHandles();
+            for (uint32_t i = 0; i < (uint32_t)primitiveHandles.size(); i++) {
+                const auto& primitive = pbrResources.GetPrimitive(primitiveHandles[i]);
+                const auto& material = primitive.GetMaterial();
+                if (material->Hidden)
+                    continue;
+
+                if (!IsAnyNodeVisible(primitive.GetNodes()))
+                    continue;
+
+                if (frustum != nullptr && !IsPrimitiveInFrustum(i, *frustum)) {
+                    queue.CountCulled();
+                    continue;
+                }
+
+                queue.Add(drawable, i, fillMode, material->GetAlphaBlended(), material->GetDoubleSided(), material.get());
+            }
+        }
+
     private:
+        void MarkNodeNeedsResolve(NodeIndex_t nodeIndex)
+        {
+            m_nodeNeedsResolve[nodeIndex] = true;
+            m_resolvedTransformsNeedUpdate = true;
+        }
+
         bool m_resolvedTransformsNeedUpdate{true};
+        bool m_resolvedTransposed{false};
+        bool m_modelConstantsUploaded{false};
 
         // Derived classes may depend on this being immutable.
         std::shared_ptr<const Model> m_model;
@@ -262,6 +407,11 @@ namespace Pbr
         // This is initialized to the local transform of every node,
         // but can be updated for this instance.
         std::vector<XrMatrix4x4f> m_nodeLocalTransforms;
+        // Node transforms combined with those of their ancestors, ignoring visibility.
+        std::vector<XrMatrix4x4f> m_hierarchyTransforms;
+        // Hierarchy transforms, zeroed for invisible nodes.
         std::vector<XrMatrix4x4f> m_resolvedTransforms;
+        // Nodes changed since the last resolve. Their descendants are re-resolved too.
+        std::vector<bool> m_nodeNeedsResolve;
     };
 }  // namespace Pbr
@@ -14,6 +14,7 @@
 
 #include "stb_image.h"
 
+#include <algorithm>
 #include <cassert>
 #include <memory>
 #include <string>
@@ -26,6 +27,24 @@ namespace Pbr
                                       (uint8_t)(color.a * 255.)};
     }
 
+    uint16_t GetFullMipChainLevelCount(int32_t width, int32_t height)
+    {
+        uint16_t levels = 1;
+        for (int32_t size = std::max(width, height); size > 1; size /= 2) {
+            levels++;
+        }
+        return levels;
+    }
+
+    bool CanGenerateMips(const Conformance::Image::Image& image)
+    {
+        if (image.levels.size() != 1 || Conformance::Image::IsCompressed(image.format.codec)) {
+            return false;
+        }
+        const XrExtent2Di& dimensions = image.levels[0].metadata.physicalDimensions;
+        return GetFullMipChainLevelCount(dimensions.width, dimensions.height) > 1;
+    }
+
     namespace StbiLoader
     {
         void StbiDeleter::operator()(unsigned char* pointer) const
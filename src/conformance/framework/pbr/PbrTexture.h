@@ -20,6 +20,13 @@ namespace Pbr
 
     std::array<uint8_t, 4> LoadRGBAUI4(RGBAColor color);
 
+    /// The number of levels in a full mip chain for a texture of the given size, down to 1x1.
+    uint16_t GetFullMipChainLevelCount(int32_t width, int32_t height);
+
+    /// True if the rest of the mip chain of @p image can be generated on the GPU after uploading it: it only has its
+    /// base level, which is larger than 1x1, and is uncompressed, since block-compressed formats cannot be rendered or blitted to.
+    bool CanGenerateMips(const Conformance::Image::Image& image);
+
     namespace StbiLoader
     {
         template <typename T>
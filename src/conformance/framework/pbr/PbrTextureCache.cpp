@@ -0,0 +1,47 @@
+// Copyright 2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PbrTextureCache.h"
+
+#include "PbrTexture.h"
+
+namespace Pbr
+{
+    TextureContentKey MakeTextureContentKey(const Conformance::Image::Image& image)
+    {
+        TextureContentKey key;
+        key.format = image.format;
+        key.levelCount = image.levels.size();
+        if (!image.levels.empty()) {
+            key.dimensions = image.levels[0].metadata.physicalDimensions;
+        }
+
+        // 64-bit FNV-1a, over the size of each level as well as its data.
+        uint64_t hash = 14695981039346656037ull;
+        auto hashBytes = [&](const uint8_t* data, size_t size) {
+            for (size_t i = 0; i < size; ++i) {
+                hash = (hash ^ data[i]) * 1099511628211ull;
+            }
+        };
+        for (const Conformance::Image::ImageLevel& level : image.levels) {
+            hashBytes(reinterpret_cast<const uint8_t*>(&level.metadata.physicalDimensions), sizeof(level.metadata.physicalDimensions));
+            hashBytes(level.data.data(), level.data.size());
+            key.byteCount += level.data.size();
+        }
+        key.hash = hash;
+        return key;
+    }
+
+    uint64_t EstimateTextureBytes(const Conformance::Image::Image& image)
+    {
+        uint64_t bytes = 0;
+        for (const Conformance::Image::ImageLevel& level : image.levels) {
+            bytes += level.data.size();
+        }
+        if (CanGenerateMips(image)) {
+            bytes += bytes / 3;
+        }
+        return bytes;
+    }
+}  // namespace Pbr
@@ -0,0 +1,166 @@
+// Copyright 2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <utilities/image.h>
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <utility>
+
+namespace Pbr
+{
+    /// The content of a texture image: images with the same key upload to identical textures.
+    struct TextureContentKey
+    {
+        Conformance::Image::FormatParams format{};
+        XrExtent2Di dimensions{};
+        size_t levelCount{0};
+        size_t byteCount{0};
+        /// FNV-1a of the data of every level
+        uint64_t hash{0};
+
+        bool operator<(const TextureContentKey& other) const
+        {
+            auto tie = [](const TextureContentKey& k) {
+                return std::make_tuple((uint8_t)k.format.codec, (uint8_t)k.format.channels, (uint8_t)k.format.colorSpaceType,
+                                       k.dimensions.width, k.dimensions.height, k.levelCount, k.byteCount, k.hash);
+            };
+            return tie(*this) < tie(other);
+        }
+    };
+
+    /// Hash the format, size and data of @p image.
+    TextureContentKey MakeTextureContentKey(const Conformance::Image::Image& image);
+
+    /// The GPU memory a texture made from @p image takes, roughly: its levels, plus a third of the base level if the rest of
+    /// the mip chain will be generated.
+    uint64_t EstimateTextureBytes(const Conformance::Image::Image& image);
+
+    /// How a TextureCache tells whether a texture it holds is still held by anything else, specialized for each backend's
+    /// texture handle type.
+    template <typename Texture>
+    struct TextureReferences;
+
+    template <typename T>
+    struct TextureReferences<std::shared_ptr<T>>
+    {
+        static bool HeldOnlyByCache(const std::shared_ptr<T>& texture)
+        {
+            return texture.use_count() == 1;
+        }
+    };
+
+    /// Per-device cache of textures by content, shared by every model loaded on the device, so that the same image bytes
+    /// (including the single pixel textures of materials that lack a map) are uploaded once.
+    ///
+    /// Once the cached textures exceed the budget, those nothing else holds any more are dropped, least recently used first,
+    /// so that loading many models over a long run keeps to a fixed amount of GPU memory beyond what the live models use.
+    ///
+    /// Device-dependent, drop when device is lost or destroyed. Thread-safe.
+    template <typename Texture>
+    class TextureCache
+    {
+    public:
+        static constexpr uint64_t DefaultBudgetBytes = 256ull << 20;
+
+        TextureCache() : m_mutex(std::make_unique<std::mutex>())
+        {
+        }
+
+        TextureCache(TextureCache&&) = default;
+        TextureCache& operator=(TextureCache&&) = default;
+
+        /// False once moved from.
+        bool IsValid() const noexcept
+        {
+            return m_mutex != nullptr;
+        }
+
+        /// Set the number of bytes of textures kept once unused, see EstimateTextureBytes.
+        void SetBudget(uint64_t budgetBytes)
+        {
+            std::lock_guard<std::mutex> guard(*m_mutex);
+            m_budgetBytes = budgetBytes;
+            Trim();
+        }
+
+        /// Return the texture cached for the content of @p image, or make one by calling @p create and cache it.
+        /// @p create is called without holding the lock, so several threads may create the same texture: the first one
+        /// cached is returned to all of them.
+        template <typename Create>
+        Texture FindOrCreate(const Conformance::Image::Image& image, Create&& create)
+        {
+            const TextureContentKey key = MakeTextureContentKey(image);
+            {
+                std::lock_guard<std::mutex> guard(*m_mutex);
+                auto it = m_entries.find(key);
+                if (it != m_entries.end()) {
+                    m_lru.splice(m_lru.begin(), m_lru, it->second.lruPosition);
+                    return it->second.texture;
+                }
+            }
+
+            Texture texture = create();
+
+            std::lock_guard<std::mutex> guard(*m_mutex);
+            auto inserted = m_entries.emplace(key, Entry{texture, EstimateTextureBytes(image), {}});
+            Entry& entry = inserted.first->second;
+            if (inserted.second) {
+                m_lru.push_front(key);
+                entry.lruPosition = m_lru.begin();
+                m_cachedBytes += entry.byteCount;
+                Trim();
+            }
+            return entry.texture;
+        }
+
+        /// Bytes of all the textures cached, in use or not.
+        uint64_t GetCachedBytes() const
+        {
+            std::lock_guard<std::mutex> guard(*m_mutex);
+            return m_cachedBytes;
+        }
+
+        size_t GetCount() const
+        {
+            std::lock_guard<std::mutex> guard(*m_mutex);
+            return m_entries.size();
+        }
+
+    private:
+        struct Entry
+        {
+            Texture texture;
+            uint64_t byteCount;
+            typename std::list<TextureContentKey>::iterator lruPosition;
+        };
+
+        /// Drop unused textures, least recently used first, until within budget or none are left to drop.
+        void Trim()
+        {
+            for (auto it = m_lru.end(); m_cachedBytes > m_budgetBytes && it != m_lru.begin();) {
+                --it;
+                auto entry = m_entries.find(*it);
+                if (TextureReferences<Texture>::HeldOnlyByCache(entry->second.texture)) {
+                    m_cachedBytes -= entry->second.byteCount;
+                    m_entries.erase(entry);
+                    it = m_lru.erase(it);
+                }
+            }
+        }
+
+        // in unique_ptr to make it moveable
+        std::unique_ptr<std::mutex> m_mutex;
+        std::map<TextureContentKey, Entry> m_entries;
+        /// Keys of m_entries, most recently used first
+        std::list<TextureContentKey> m_lru;
+        uint64_t m_cachedBytes{0};
+        uint64_t m_budgetBytes{DefaultBudgetBytes};
+    };
+}  // namespace Pbr
@@ -29,9 +29,11 @@ namespace Pbr
     void VulkanModelInstance::Render(Pbr::VulkanResources& pbrResources, Conformance::CmdBuffer& directCommandBuffer,
                                      VkRenderPass renderPass, VkSampleCountFlagBits sampleCount, XrMatrix4x4f modelToWorld)
     {
+        // The scene buffer holds the view and projection, so it changes with every view.
         pbrResources.UpdateBuffer();
-        m_modelBuffer.ModelToWorld = modelToWorld;
-        m_modelConstantBuffer.Update({&m_modelBuffer, 1});
+        if (UpdateModelConstants(m_modelBuffer, Glsl::ModelConstantBuffer{modelToWorld})) {
+            m_modelConstantBuffer.Update({&m_modelBuffer, 1});
+        }
         UpdateTransforms(pbrResources);
 
         auto& primitiveHandles = GetModel().GetPrimitiveHandles();
@@ -41,7 +43,7 @@ namespace Pbr
 
         for (size_t i = 0; i < primitiveHandles.size(); i++) {
             PrimitiveHandle primitiveHandle = primitiveHandles[i];
-            VkDescriptorSet descriptorSet = m_descriptorSets[i];
+            VulkanCachedDescriptorSet& descriptorSet = m_descriptorSets[i];
             const Pbr::VulkanPrimitive& primitive = pbrResources.GetPrimitive(primitiveHandle);
             if (primitive.GetMaterial()->Hidden)
                 continue;
@@ -67,8 +69,9 @@ namespace Pbr
         allocInfo.descriptorSetCount = numSets;
         allocInfo.pSetLayouts = layouts.data();
 
-        m_descriptorSets.resize(numSets);
-        XRC_CHECK_THROW_VKCMD(vkAllocateDescriptorSets(pbrResources.GetDevice(), &allocInfo, m_descriptorSets.data()));
+        std::vector<VkDescriptorSet> descriptorSets(numSets);
+        XRC_CHECK_THROW_VKCMD(vkAllocateDescriptorSets(pbrResources.GetDevice(), &allocInfo, descriptorSets.data()));
+        m_descriptorSets.assign(descriptorSets.begin(), descriptorSets.end());
     }
     VulkanModelInstance::VulkanModelInstance(Pbr::VulkanResources& pbrResources, std::shared_ptr<const Model> model)
         : ModelInstance(std::move(model))
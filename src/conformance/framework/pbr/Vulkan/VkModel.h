@@ -46,6 +46,7 @@ namespace Pbr
 
         Conformance::StructuredBuffer<XrMatrix4x4f> m_modelTransformsStructuredBuffer;
         Conformance::ScopedVkDescriptorPool m_descriptorPool;
-        std::vector<VkDescriptorSet> m_descriptorSets;
+        /// One per primitive, each only rewritten when the descriptors of that primitive change
+        std::vector<VulkanCachedDescriptorSet> m_descriptorSets;
     };
 }  // namespace Pbr
@@ -19,9 +19,16 @@
 
 #include <nonstd/span.hpp>
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <exception>
+#include <future>
+#include <thread>
+#include <tuple>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace Pbr
 {
@@ -31,10 +38,90 @@ namespace Pbr
                                                                 DepthDirection depthDirection)
     {
         const PipelineStateKey state{renderPass, sampleCount, fillMode, frontFaceWindingOrder, blendState, doubleSided, depthDirection};
-        auto iter = m_pipelines.find(state);
-        if (iter != m_pipelines.end()) {
-            return iter->second;
+        Conformance::Pipeline& pipeline = m_pipelines[state];
+        // A pipeline whose precompilation failed is left empty, to be tried again here.
+        if (pipeline.pipe == VK_NULL_HANDLE) {
+            CreatePipeline(state, pipeline);
         }
+        return pipeline;
+    }
+
+    void VulkanPipelines::PrecompilePipelines(span<const VkRenderPass> renderPasses, VkSampleCountFlagBits sampleCount,
+                                              FillMode fillMode, FrontFaceWindingOrder frontFaceWindingOrder,
+                                              DepthDirection depthDirection)
+    {
+        // Add the missing entries here, so that the workers only fill in pipelines the map already holds.
+        std::vector<std::pair<const PipelineStateKey*, Conformance::Pipeline*>> toCreate;
+        for (VkRenderPass renderPass : renderPasses) {
+            for (BlendState blendState : {BlendState::NotAlphaBlended, BlendState::AlphaBlended}) {
+                for (DoubleSided doubleSided : {DoubleSided::NotDoubleSided, DoubleSided::DoubleSided}) {
+                    auto iter = m_pipelines
+                                    .emplace(std::piecewise_construct,
+                                             std::forward_as_tuple(renderPass, sampleCount, fillMode, frontFaceWindingOrder, blendState,
+                                                                   doubleSided, depthDirection),
+                                             std::forward_as_tuple())
+                                    .first;
+                    if (iter->second.pipe == VK_NULL_HANDLE) {
+                        toCreate.emplace_back(&iter->first, &iter->second);
+                    }
+                }
+            }
+        }
+        if (toCreate.empty()) {
+            return;
+        }
+
+        // Each worker, including this thread, takes the next pipeline not taken yet until there are none left.
+        std::atomic<size_t> next{0};
+        auto createPipelines = [&] {
+            try {
+                for (size_t i = next++; i < toCreate.size(); i = next++) {
+                    CreatePipeline(*toCreate[i].first, *toCreate[i].second);
+                }
+            }
+            catch (...) {
+                // Stop the other workers early: GetOrCreatePipeline retries whatever is left empty.
+                next = toCreate.size();
+                throw;
+            }
+        };
+        const size_t workerCount = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), toCreate.size());
+        std::vector<std::future<void>> workers;
+        for (size_t i = 1; i < workerCount; i++) {
+            workers.push_back(std::async(std::launch::async, createPipelines));
+        }
+        std::exception_ptr error;
+        try {
+            createPipelines();
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+        for (std::future<void>& worker : workers) {
+            try {
+                worker.get();
+            }
+            catch (...) {
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    void VulkanPipelines::CreatePipeline(const PipelineStateKey& state, Conformance::Pipeline& pipeline) const
+    {
+        VkRenderPass renderPass;
+        VkSampleCountFlagBits sampleCount;
+        FillMode fillMode;
+        FrontFaceWindingOrder frontFaceWindingOrder;
+        BlendState blendState;
+        DoubleSided doubleSided;
+        DepthDirection depthDirection;
+        std::tie(renderPass, sampleCount, fillMode, frontFaceWindingOrder, blendState, doubleSided, depthDirection) = state;
 
         static_assert(std::is_same<PipelineStateKey, std::tuple<VkRenderPass, VkSampleCountFlagBits, FillMode, FrontFaceWindingOrder,
                                                                 BlendState, DoubleSided, DepthDirection>>::value,
@@ -146,10 +233,7 @@ namespace Pbr
         pipeInfo.renderPass = renderPass;
         pipeInfo.subpass = 0;
 
-        Conformance::Pipeline& pipeline = m_pipelines.emplace(state, Conformance::Pipeline()).first->second;
-        pipeline.Create(m_device, pipeInfo);
-
-        return pipeline;
+        pipeline.Create(m_device, pipeInfo, m_pipelineCache);
     }
 }  // namespace Pbr
 
@@ -31,11 +31,16 @@ namespace Pbr
     {
     public:
         /// Note: Make sure your shaders are global/static!
-        VulkanPipelines(VkDevice device, std::shared_ptr<Conformance::ScopedVkPipelineLayout> layout,
+        /// @param pipelineCache Cache to create pipelines with, may be VK_NULL_HANDLE: must outlive this object.
+        VulkanPipelines(VkDevice device, VkPipelineCache pipelineCache, std::shared_ptr<Conformance::ScopedVkPipelineLayout> layout,
                         span<const VkVertexInputAttributeDescription> vertexAttrDesc,
                         span<const VkVertexInputBindingDescription> vertexInputBindDesc, span<const uint32_t> pbrVS,
                         span<const uint32_t> pbrPS)
-            : m_device(device), m_layout(layout), m_vertexAttrDesc(vertexAttrDesc), m_vertexInputBindDesc(vertexInputBindDesc)
+            : m_device(device)
+            , m_pipelineCache(pipelineCache)
+            , m_layout(layout)
+            , m_vertexAttrDesc(vertexAttrDesc)
+            , m_vertexInputBindDesc(vertexInputBindDesc)
         {
             m_pbrShader.Init(m_device);
             m_pbrShader.LoadVertexShader(pbrVS);
@@ -46,6 +51,12 @@ namespace Pbr
                                                    FrontFaceWindingOrder frontFaceWindingOrder, BlendState blendState,
                                                    DoubleSided doubleSided, DepthDirection depthDirection);
 
+        /// Create, in parallel on worker threads, the pipelines GetOrCreatePipeline would create for each of @p renderPasses
+        /// with every blend state and sidedness a material can have, so that the first frames drawing them do not stall on
+        /// pipeline compilation. Pipelines already created are skipped.
+        void PrecompilePipelines(span<const VkRenderPass> renderPasses, VkSampleCountFlagBits sampleCount, FillMode fillMode,
+                                 FrontFaceWindingOrder frontFaceWindingOrder, DepthDirection depthDirection);
+
         void DropStates()
         {
             m_pipelines.clear();
@@ -53,6 +64,7 @@ namespace Pbr
 
     private:
         VkDevice m_device;
+        VkPipelineCache m_pipelineCache;
         using PipelineStateKey =
             std::tuple<VkRenderPass, VkSampleCountFlagBits, FillMode, FrontFaceWindingOrder, BlendState, DoubleSided, DepthDirection>;
         std::shared_ptr<Conformance::ScopedVkPipelineLayout> m_layout;
@@ -60,6 +72,9 @@ namespace Pbr
         span<const VkVertexInputBindingDescription> m_vertexInputBindDesc;
         Conformance::ShaderProgram m_pbrShader;
 
+        /// Create the pipeline for @p state into @p pipeline. Touches nothing else, so may run on several threads at once.
+        void CreatePipeline(const PipelineStateKey& state, Conformance::Pipeline& pipeline) const;
+
         std::map<PipelineStateKey, Conformance::Pipeline> m_pipelines;
     };
 }  // namespace Pbr
@@ -26,7 +26,7 @@
 namespace
 {
     Conformance::VertexBuffer<Pbr::Vertex, uint32_t> CreateVertexBuffer(VkDevice device,
-                                                                        const Conformance::MemoryAllocator& memoryAllocator,
+                                                                        Conformance::MemoryAllocator& memoryAllocator,
                                                                         const Pbr::PrimitiveBuilder& primitiveBuilder)
     {
         // Create Vertex Buffer
@@ -55,27 +55,26 @@ namespace Pbr
     {
     }
 
-    void VulkanPrimitive::Render(Conformance::CmdBuffer& directCommandBuffer, VulkanResources& pbrResources, VkDescriptorSet descriptorSet,
-                                 VkRenderPass renderPass, VkSampleCountFlagBits sampleCount, VkDescriptorBufferInfo modelConstantBuffer,
-                                 VkDescriptorBufferInfo transformBuffer) const
+    void VulkanPrimitive::Render(Conformance::CmdBuffer& directCommandBuffer, VulkanResources& pbrResources,
+                                 VulkanCachedDescriptorSet& descriptorSet, VkRenderPass renderPass, VkSampleCountFlagBits sampleCount,
+                                 VkDescriptorBufferInfo modelConstantBuffer, VkDescriptorBufferInfo transformBuffer) const
     {
         GetMaterial()->UpdateBuffer();
 
         auto materialConstantBuffer = GetMaterial()->GetMaterialConstantBuffer();
         auto materialTextures = GetMaterial()->GetTextureDescriptors();
-        std::unique_ptr<VulkanWriteDescriptorSets> wds = pbrResources.BuildWriteDescriptorSets(
-            modelConstantBuffer, materialConstantBuffer, transformBuffer, materialTextures, descriptorSet);
-
-        vkUpdateDescriptorSets(pbrResources.GetDevice(), static_cast<uint32_t>(wds->writeDescriptorSets.size()),
-                               wds->writeDescriptorSets.data(), 0, NULL);
+        descriptorSet.Update(pbrResources.GetDevice(),
+                             pbrResources.BuildWriteDescriptorSets(modelConstantBuffer, materialConstantBuffer, transformBuffer,
+                                                                   materialTextures, descriptorSet.Get()));
 
         BlendState blendState = GetMaterial()->GetAlphaBlended();
         DoubleSided doubleSided = GetMaterial()->GetDoubleSided();
 
         Conformance::Pipeline& pipeline = pbrResources.GetOrCreatePipeline(renderPass, sampleCount, blendState, doubleSided);
 
-        vkCmdBindDescriptorSets(directCommandBuffer.buf, VK_PIPELINE_BIND_POINT_GRAPHICS, pbrResources.GetPipelineLayout(), 0, 1,
-                                &descriptorSet, 0, nullptr);
+        const VkDescriptorSet set = descriptorSet.Get();
+        vkCmdBindDescriptorSets(directCommandBuffer.buf, VK_PIPELINE_BIND_POINT_GRAPHICS, pbrResources.GetPipelineLayout(), 0, 1, &set, 0,
+                                nullptr);
         vkCmdBindPipeline(directCommandBuffer.buf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.pipe);
 
         const VkDeviceSize vertexOffset = 0;
@@ -60,7 +60,7 @@ namespace Pbr
 
     protected:
         friend class VulkanModelInstance;
-        void Render(Conformance::CmdBuffer& directCommandBuffer, VulkanResources& pbrResources, VkDescriptorSet descriptorSet,
+        void Render(Conformance::CmdBuffer& directCommandBuffer, VulkanResources& pbrResources, VulkanCachedDescriptorSet& descriptorSet,
                     VkRenderPass renderPass, VkSampleCountFlagBits sampleCount, VkDescriptorBufferInfo modelConstantBuffer,
                     VkDescriptorBufferInfo transformBuffer) const;
 
@@ -26,6 +26,7 @@
 #include "../PbrSharedState.h"
 
 #include "common/vulkan_debug_object_namer.hpp"
+#include "utilities/destruction_queue.h"
 #include "utilities/vulkan_scoped_handle.h"
 #include "utilities/vulkan_utils.h"
 #include "utilities/xr_math_operators.h"
@@ -99,7 +100,7 @@ namespace
 
 namespace Pbr
 {
-    using ImageKey = std::tuple<const tinygltf::Image*, bool>;  // Item1 is a pointer to the image, Item2 is sRGB.
+    using ImageKey = std::tuple<const GltfHelper::DecodedImage*, bool>;  // Item1 is a pointer to the image, Item2 is sRGB.
 
     namespace PipelineLayout
     {
@@ -312,12 +313,15 @@ namespace Pbr
     struct VulkanResources::Impl
     {
         void Initialize(const VulkanDebugObjectNamer& objnamer, VkPhysicalDevice physicalDevice_, VkDevice device_,
-                        uint32_t queueFamilyIndex)
+                        uint32_t queueFamilyIndex_, Conformance::StagingBufferPool& stagingPool_, VkPipelineCache pipelineCache)
         {
+            physicalDevice = physicalDevice_;
             device = device_;
+            queueFamilyIndex = queueFamilyIndex_;
+            stagingPool = &stagingPool_;
             allocator.Init(physicalDevice_, device);
 
-            Internal::ThrowIf(!copyCmdBuffer.Init(objnamer, device_, queueFamilyIndex), "Failed to create command buffer");
+            Internal::ThrowIf(!copyCmdBuffer.Init(objnamer, device_, queueFamilyIndex_), "Failed to create command buffer");
             copyCmdBuffer.Begin();
 
             PipelineLayout::SetupBindings(VulkanLayout);
@@ -327,8 +331,8 @@ namespace Pbr
             Resources.PipelineLayout = std::make_shared<Conformance::ScopedVkPipelineLayout>(
                 PipelineLayout::CreatePipelineLayout(device, Resources.DescriptorSetLayout->get()), device);
 
-            Resources.Pipelines = std::make_unique<VulkanPipelines>(device, Resources.PipelineLayout, c_attrDesc, c_bindingDesc,
-                                                                    g_PbrVertexShader, g_PbrPixelShader);
+            Resources.Pipelines = std::make_unique<VulkanPipelines>(device, pipelineCache, Resources.PipelineLayout, c_attrDesc,
+                                                                    c_bindingDesc, g_PbrVertexShader, g_PbrPixelShader);
 
             // Set up the scene constant buffer.
             Resources.SceneBuffer.Init(device, allocator);
@@ -341,6 +345,20 @@ namespace Pbr
             Resources.SupportedTextureFormats = MakeSupportedFormatsList(physicalDevice_);
         }
 
+        /// Submit the uploads recorded on the transfer queue, for the next copy command buffer submission to wait for.
+        void FlushTransfers()
+        {
+            if (transferCmdBuffer == nullptr) {
+                return;
+            }
+            const uint64_t completedCopySubmitCount = copyCmdBuffer.IsComplete() ? copySubmitCount : copySubmitCount - 1;
+            Conformance::SubmitSemaphores semaphores;
+            semaphores.signal = {transferSemaphores.Get(completedCopySubmitCount)};
+            transferQueue.Submit(semaphores);
+            transferWaits.push_back(semaphores.signal[0]);
+            transferCmdBuffer = nullptr;
+        }
+
         void Reset()
         {
             allocator.Reset();
@@ -358,7 +376,7 @@ namespace Pbr
             std::shared_ptr<VulkanTextureBundle> BrdfLut;
             std::shared_ptr<VulkanTextureBundle> SpecularEnvironmentMap;
             std::shared_ptr<VulkanTextureBundle> DiffuseEnvironmentMap;
-            mutable VulkanTextureCache SolidColorTextureCache;
+            mutable VulkanTextureCache TextureCache;
 
             Conformance::StructuredBuffer<Glsl::SceneConstantBuffer> SceneBuffer;
             Conformance::ScopedVkSampler BrdfSampler;
@@ -369,13 +387,26 @@ namespace Pbr
 
             std::vector<Conformance::Image::FormatParams> SupportedTextureFormats;
 
-            std::vector<Conformance::BufferAndMemory> StagingBuffers;
+            /// Staging regions used by the copy command buffer, keyed on copySubmitCount at the time of submission
+            Conformance::DestructionQueue<Conformance::StagingAllocation> StagingAllocations;
         };
 
         VulkanDebugObjectNamer namer;
+        VkPhysicalDevice physicalDevice{VK_NULL_HANDLE};
         VkDevice device{VK_NULL_HANDLE};
         Conformance::MemoryAllocator allocator{};
+        uint32_t queueFamilyIndex{0};
         Conformance::CmdBuffer copyCmdBuffer{};
+        uint64_t copySubmitCount{0};
+        /// Not valid unless UseTransferQueue was called
+        Conformance::TransferQueue transferQueue;
+        /// The transfer command buffer being recorded, if any
+        Conformance::CmdBuffer* transferCmdBuffer{nullptr};
+        /// Semaphores signaled by transfer submissions, following copySubmitCount
+        Conformance::SemaphorePool transferSemaphores;
+        /// Semaphores of the transfer submissions the next copy command buffer submission must wait for
+        std::vector<VkSemaphore> transferWaits;
+        Conformance::StagingBufferPool* stagingPool{nullptr};
 
         PrimitiveCollection<VulkanPrimitive> Primitives;
 
@@ -393,22 +424,15 @@ namespace Pbr
     };
 
     VulkanResources::VulkanResources(const VulkanDebugObjectNamer& namer, VkPhysicalDevice physicalDevice, VkDevice device,
-                                     uint32_t queueFamilyIndex)
+                                     uint32_t queueFamilyIndex, Conformance::StagingBufferPool& stagingPool, VkPipelineCache pipelineCache)
         : m_impl(std::make_unique<Impl>())
     {
-        m_impl->Initialize(namer, physicalDevice, device, queueFamilyIndex);
+        m_impl->Initialize(namer, physicalDevice, device, queueFamilyIndex, stagingPool, pipelineCache);
     }
 
     VulkanResources::VulkanResources(VulkanResources&& resources) noexcept = default;
 
-    VulkanResources::~VulkanResources()
-    {
-        // stagingBuffers are queued to be cleared in Wait(). If Wait() has not been called, clear them here.
-        for (auto stagingBuffer : m_impl->Resources.StagingBuffers) {
-            stagingBuffer.Reset(GetDevice());
-        }
-        m_impl->Resources.StagingBuffers.clear();
-    }
+    VulkanResources::~VulkanResources() = default;
 
     /* IGltfBuilder implementations */
     std::shared_ptr<Material> VulkanResources::CreateFlatMaterial(RGBAColor baseColorFactor, float roughnessFactor, float metallicFactor,
@@ -421,14 +445,10 @@ namespace Pbr
         return std::make_shared<VulkanMaterial>(*this);
     }
 
-    // Create a Vulkan texture from a tinygltf Image.
-    static VulkanTextureBundle LoadGLTFImage(VulkanResources& pbrResources, const tinygltf::Image& image, bool sRGB)
+    // Create a Vulkan texture from a decoded tinygltf Image.
+    static VulkanTextureBundle LoadGLTFImage(VulkanResources& pbrResources, const GltfHelper::DecodedImage& image)
     {
-        // First convert the image to RGBA if it isn't already.
-        std::vector<uint8_t> tempBuffer;
-        Conformance::Image::Image decodedImage = GltfHelper::DecodeImage(image, sRGB, pbrResources.GetSupportedFormats(), tempBuffer);
-
-        return VulkanTexture::CreateTexture(pbrResources, decodedImage);
+        return VulkanTexture::CreateTexture(pbrResources, image.image, true);
     }
 
     static VkFilter ConvertMinFilter(int glMinFilter)
@@ -486,7 +506,8 @@ namespace Pbr
     }
 
     void VulkanResources::LoadTexture(const std::shared_ptr<Material>& material, Pbr::ShaderSlots::PSMaterial slot,
-                                      const tinygltf::Image* image, const tinygltf::Sampler* sampler, bool sRGB, Pbr::RGBAColor defaultRGBA)
+                                      const GltfHelper::DecodedImage* image, const tinygltf::Sampler* sampler, bool sRGB,
+                                      Pbr::RGBAColor defaultRGBA)
     {
         auto pbrMaterial = std::dynamic_pointer_cast<VulkanMaterial>(material);
         if (!pbrMaterial) {
@@ -496,12 +517,14 @@ namespace Pbr
         const ImageKey imageKey = std::make_tuple(image, sRGB);
         std::shared_ptr<VulkanTextureBundle> textureView =
             image != nullptr ? m_impl->loaderResources.imageMap[imageKey] : CreateTypedSolidColorTexture(defaultRGBA, sRGB);
-        if (!textureView)  // If not cached, load the image and store it in the texture cache.
+        if (!textureView)  // If not cached, load the image, or find one with the same content, and store it in the texture cache.
         {
-            // TODO: Generate mipmaps if sampler's minification filter (minFilter) uses mipmapping.
+            // Mipmaps are generated whether or not this sampler's minification filter (minFilter) uses them, since the
+            // image may be shared with another sampler that does.
             // TODO: If texture is not power-of-two and (sampler has wrapping=repeat/mirrored_repeat OR minFilter uses
             // mipmapping), resize to power-of-two.
-            textureView = std::make_shared<VulkanTextureBundle>(LoadGLTFImage(*this, *image, sRGB));
+            textureView = m_impl->Resources.TextureCache.FindOrCreate(
+                image->image, [&] { return std::make_shared<VulkanTextureBundle>(LoadGLTFImage(*this, *image)); });
             m_impl->loaderResources.imageMap[imageKey] = textureView;
         }
 
@@ -520,6 +543,8 @@ namespace Pbr
 
     void VulkanResources::DropLoaderCaches()
     {
+        // Start the uploads of the model now, so that they run alongside the frames rendered until it is first drawn.
+        m_impl->FlushTransfers();
         m_impl->loaderResources = {};
     }
 
@@ -574,6 +599,12 @@ namespace Pbr
                                                                 m_sharedState.GetDepthDirection());
     }
 
+    void VulkanResources::PrecompilePipelines(span<const VkRenderPass> renderPasses, VkSampleCountFlagBits sampleCount)
+    {
+        m_impl->Resources.Pipelines->PrecompilePipelines(renderPasses, sampleCount, m_sharedState.GetFillMode(),
+                                                         m_sharedState.GetFrontFaceWindingOrder(), m_sharedState.GetDepthDirection());
+    }
+
     void VulkanResources::SetLight(XrVector3f direction, RGBColor diffuseColor)
     {
         m_impl->SceneBuffer.LightDirection = direction;
@@ -598,7 +629,20 @@ namespace Pbr
 
     std::shared_ptr<VulkanTextureBundle> VulkanResources::CreateTypedSolidColorTexture(RGBAColor color, bool sRGB)
     {
-        return m_impl->Resources.SolidColorTextureCache.CreateTypedSolidColorTexture(*this, color, sRGB);
+        return m_impl->Resources.TextureCache.CreateTypedSolidColorTexture(*this, color, sRGB);
+    }
+
+    void VulkanResources::SetTextureCacheBudget(uint64_t budgetBytes)
+    {
+        m_impl->Resources.TextureCache.SetBudget(budgetBytes);
+    }
+
+    void VulkanResources::UseTransferQueue(uint32_t transferFamilyIndex)
+    {
+        // Two command buffers, so that the uploads of one model can be recorded while those of the previous one execute.
+        Internal::ThrowIf(!m_impl->transferQueue.Init(m_impl->namer, m_impl->device, transferFamilyIndex, 2),
+                          "Failed to create transfer command buffer");
+        m_impl->transferSemaphores.Init(m_impl->namer, m_impl->device);
     }
 
     span<const Conformance::Image::FormatParams> VulkanResources::GetSupportedFormats() const
@@ -659,12 +703,17 @@ namespace Pbr
         m_sharedState.SetDepthDirection(depthDirection);
     }
 
+    VkPhysicalDevice VulkanResources::GetPhysicalDevice() const
+    {
+        return m_impl->physicalDevice;
+    }
+
     VkDevice VulkanResources::GetDevice() const
     {
         return m_impl->device;
     }
 
-    const Conformance::MemoryAllocator& VulkanResources::GetMemoryAllocator() const
+    Conformance::MemoryAllocator& VulkanResources::GetMemoryAllocator() const
     {
         return m_impl->allocator;
     }
@@ -674,6 +723,32 @@ namespace Pbr
         return m_impl->copyCmdBuffer;
     }
 
+    const Conformance::CmdBuffer* VulkanResources::GetTransferCommandBuffer() const
+    {
+        if (!m_impl->transferQueue.IsValid()) {
+            return nullptr;
+        }
+        if (m_impl->transferCmdBuffer == nullptr) {
+            m_impl->transferCmdBuffer = &m_impl->transferQueue.Begin();
+        }
+        return m_impl->transferCmdBuffer;
+    }
+
+    uint32_t VulkanResources::GetQueueFamilyIndex() const
+    {
+        return m_impl->queueFamilyIndex;
+    }
+
+    uint32_t VulkanResources::GetTransferFamilyIndex() const
+    {
+        return m_impl->transferQueue.FamilyIndex();
+    }
+
+    Conformance::StagingBufferPool& VulkanResources::GetStagingBufferPool() const
+    {
+        return *m_impl->stagingPool;
+    }
+
     VkPipelineLayout VulkanResources::GetPipelineLayout() const
     {
         return m_impl->Resources.PipelineLayout->get();
@@ -681,8 +756,17 @@ namespace Pbr
 
     void VulkanResources::SubmitFrameResources(VkQueue queue) const
     {
+        // The acquire barriers of the textures uploaded on the transfer queue are recorded into the copy command buffer.
+        m_impl->FlushTransfers();
+        Conformance::SubmitSemaphores semaphores;
+        semaphores.wait = std::move(m_impl->transferWaits);
+        semaphores.waitStages.assign(semaphores.wait.size(), VK_PIPELINE_STAGE_TRANSFER_BIT);
+        m_impl->transferWaits.clear();
+
         m_impl->copyCmdBuffer.End();
-        m_impl->copyCmdBuffer.Exec(queue);
+        m_impl->copyCmdBuffer.Exec(queue, &semaphores);
+        m_impl->copySubmitCount++;
+        m_impl->transferSemaphores.Submitted(m_impl->copySubmitCount);
     }
 
     void VulkanResources::Wait() const
@@ -691,10 +775,7 @@ namespace Pbr
         m_impl->copyCmdBuffer.Clear();
         m_impl->copyCmdBuffer.Begin();
 
-        for (auto stagingBuffer : m_impl->Resources.StagingBuffers) {
-            stagingBuffer.Reset(GetDevice());
-        }
-        m_impl->Resources.StagingBuffers.clear();
+        m_impl->Resources.StagingAllocations.ReleaseForFenceValue(m_impl->copySubmitCount);
     }
 
     const VulkanDebugObjectNamer& VulkanResources::GetDebugNamer() const
@@ -712,9 +793,10 @@ namespace Pbr
         return m_impl->VulkanLayout.CreateDescriptorPool(GetDevice(), maxSets);
     }
 
-    void VulkanResources::DestroyAfterRender(Conformance::BufferAndMemory buffer) const
+    void VulkanResources::DestroyAfterRender(Conformance::StagingAllocation&& staging) const
     {
-        m_impl->Resources.StagingBuffers.push_back(buffer);
+        // Recorded into the copy command buffer now, so in use until the next submission completes
+        m_impl->Resources.StagingAllocations.PushResource(m_impl->copySubmitCount + 1, std::move(staging));
     }
 
 }  // namespace Pbr
@@ -34,10 +34,11 @@ class VulkanDebugObjectNamer;
 
 namespace Conformance
 {
-    struct BufferAndMemory;
     struct CmdBuffer;
     struct MemoryAllocator;
     struct Pipeline;
+    class StagingAllocation;
+    class StagingBufferPool;
 }  // namespace Conformance
 namespace tinygltf
 {
@@ -89,6 +90,25 @@ namespace Pbr
             writeDescriptorSets[bindingIndex].pImageInfo = &m_imageInfos[bindingIndex];
         }
 
+        /// True if every binding refers to the same buffer range or image and sampler as in @p other.
+        bool HasSameDescriptors(const VulkanWriteDescriptorSets& other) const
+        {
+            for (size_t i = 0; i < BindingCount; ++i) {
+                const VkDescriptorBufferInfo& buffer = m_bufferInfos[i];
+                const VkDescriptorBufferInfo& otherBuffer = other.m_bufferInfos[i];
+                if (buffer.buffer != otherBuffer.buffer || buffer.offset != otherBuffer.offset || buffer.range != otherBuffer.range) {
+                    return false;
+                }
+                const VkDescriptorImageInfo& image = m_imageInfos[i];
+                const VkDescriptorImageInfo& otherImage = other.m_imageInfos[i];
+                if (image.sampler != otherImage.sampler || image.imageView != otherImage.imageView ||
+                    image.imageLayout != otherImage.imageLayout) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
         // self-referential
         VulkanWriteDescriptorSets(VulkanWriteDescriptorSets const&) = delete;
         VulkanWriteDescriptorSets(VulkanWriteDescriptorSets&&) = delete;
@@ -96,10 +116,45 @@ namespace Pbr
         VulkanWriteDescriptorSets& operator=(VulkanWriteDescriptorSets&&) = delete;
     };
 
+    /// A descriptor set together with the descriptors last written to it, so that a draw whose material, model buffer, transform
+    /// buffer and global textures are unchanged does not write the set again.
+    class VulkanCachedDescriptorSet
+    {
+    public:
+        VulkanCachedDescriptorSet() = default;
+        explicit VulkanCachedDescriptorSet(VkDescriptorSet set) : m_set(set)
+        {
+        }
+
+        VkDescriptorSet Get() const
+        {
+            return m_set;
+        }
+
+        /// Write @p wds, which must target this set, unless the set already holds the same descriptors.
+        /// The set must not be in use by a pending command buffer when it is written.
+        void Update(VkDevice device, std::unique_ptr<VulkanWriteDescriptorSets> wds)
+        {
+            if (m_written && m_written->HasSameDescriptors(*wds)) {
+                return;
+            }
+            vkUpdateDescriptorSets(device, static_cast<uint32_t>(wds->writeDescriptorSets.size()), wds->writeDescriptorSets.data(), 0,
+                                   nullptr);
+            m_written = std::move(wds);
+        }
+
+    private:
+        VkDescriptorSet m_set{VK_NULL_HANDLE};
+        std::unique_ptr<VulkanWriteDescriptorSets> m_written;
+    };
+
     /// Global PBR resources required for rendering a scene.
     struct VulkanResources final : public IGltfBuilder
     {
-        VulkanResources(const VulkanDebugObjectNamer& namer, VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamilyIndex);
+        /// @param stagingPool Pool to sub-allocate upload staging memory from: must outlive this object.
+        /// @param pipelineCache Cache to create pipelines with, may be VK_NULL_HANDLE: must outlive this object.
+        VulkanResources(const VulkanDebugObjectNamer& namer, VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamilyIndex,
+                        Conformance::StagingBufferPool& stagingPool, VkPipelineCache pipelineCache = VK_NULL_HANDLE);
         VulkanResources(VulkanResources&&) noexcept;
 
         ~VulkanResources() override;
@@ -108,8 +163,9 @@ namespace Pbr
                                                      RGBColor emissiveFactor = RGB::Black) override;
         std::shared_ptr<Material> CreateMaterial() override;
 
-        void LoadTexture(const std::shared_ptr<Material>& pbrMaterial, Pbr::ShaderSlots::PSMaterial slot, const tinygltf::Image* image,
-                         const tinygltf::Sampler* sampler, bool sRGB, Pbr::RGBAColor defaultRGBA) override;
+        void LoadTexture(const std::shared_ptr<Material>& pbrMaterial, Pbr::ShaderSlots::PSMaterial slot,
+                         const GltfHelper::DecodedImage* image, const tinygltf::Sampler* sampler, bool sRGB,
+                         Pbr::RGBAColor defaultRGBA) override;
         PrimitiveHandle MakePrimitive(const Pbr::PrimitiveBuilder& primitiveBuilder,
                                       const std::shared_ptr<Pbr::Material>& material) override;
         void DropLoaderCaches() override;
@@ -122,6 +178,10 @@ namespace Pbr
         Conformance::Pipeline& GetOrCreatePipeline(VkRenderPass renderPass, VkSampleCountFlagBits sampleCount, BlendState blendState,
                                                    DoubleSided doubleSided);
 
+        /// Create the pipelines GetOrCreatePipeline would return for each of @p renderPasses with the current settings, for
+        /// every material, in parallel ahead of the first draw. See VulkanPipelines::PrecompilePipelines.
+        void PrecompilePipelines(span<const VkRenderPass> renderPasses, VkSampleCountFlagBits sampleCount);
+
         /// Set the directional light.
         void SetLight(XrVector3f direction, RGBColor diffuseColor);
 
@@ -136,9 +196,17 @@ namespace Pbr
         /// number of textures created.
         std::shared_ptr<VulkanTextureBundle> CreateTypedSolidColorTexture(RGBAColor color, bool sRGB);
 
+        /// Set the bytes of textures kept cached once no model uses them. See Pbr::TextureCache.
+        void SetTextureCacheBudget(uint64_t budgetBytes);
+
+        /// Upload textures on queue 0 of @p transferFamilyIndex, a dedicated transfer family requested when the device was
+        /// created, see Conformance::TransferQueue. The uploads of a model are submitted once it is built, and handed to the
+        /// graphics family by the next copy command buffer submission.
+        void UseTransferQueue(uint32_t transferFamilyIndex);
+
         /// Get the cached list of texture formats supported by the device
         /// Note: these formats are not guaranteed to support cubemap
-        span<const Conformance::Image::FormatParams> GetSupportedFormats() const;
+        span<const Conformance::Image::FormatParams> GetSupportedFormats() const override;
 
         /// Update the scene buffer in GPU memory.
         void UpdateBuffer() const;
@@ -156,16 +224,25 @@ namespace Pbr
         FrontFaceWindingOrder GetFrontFaceWindingOrder() const;
         void SetDepthDirection(DepthDirection depthDirection);
 
+        VkPhysicalDevice GetPhysicalDevice() const;
         VkDevice GetDevice() const;
-        const Conformance::MemoryAllocator& GetMemoryAllocator() const;
+        Conformance::MemoryAllocator& GetMemoryAllocator() const;
         const Conformance::CmdBuffer& GetCopyCommandBuffer() const;
+        /// The command buffer to record texture uploads into on the transfer queue, begun if need be, or null without one.
+        /// Textures written there must be released to GetQueueFamilyIndex(), with the matching acquire barrier recorded into
+        /// the copy command buffer.
+        const Conformance::CmdBuffer* GetTransferCommandBuffer() const;
+        uint32_t GetQueueFamilyIndex() const;
+        uint32_t GetTransferFamilyIndex() const;
+        Conformance::StagingBufferPool& GetStagingBufferPool() const;
         VkPipelineLayout GetPipelineLayout() const;
         void SubmitFrameResources(VkQueue queue) const;
         void Wait() const;
         const VulkanDebugObjectNamer& GetDebugNamer() const;
         VkDescriptorSetLayout GetDescriptorSetLayout() const;
         VkDescriptorPool MakeDescriptorPool(uint32_t maxSets) const;
-        void DestroyAfterRender(Conformance::BufferAndMemory buffer) const;
+        /// Keep a staging region alive until the copy command buffer contents recorded so far have been executed.
+        void DestroyAfterRender(Conformance::StagingAllocation&& staging) const;
 
     private:
         std::unique_ptr<VulkanWriteDescriptorSets> BuildWriteDescriptorSets(VkDescriptorBufferInfo modelConstantBuffer,
@@ -24,12 +24,15 @@
 #include "utilities/vulkan_scoped_handle.h"
 #include "utilities/vulkan_utils.h"
 
+#include <algorithm>
 #include <assert.h>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <stdexcept>
 #include <stdlib.h>
+#include <string.h>
+#include <utility>
 
 namespace Pbr
 {
@@ -44,28 +47,94 @@ namespace Pbr
             return CreateTexture(pbrResources, owningImage.image);
         }
 
+        /// True if mip levels of @p format can be blitted from one another with linear filtering.
+        static bool SupportsLinearBlit(VkPhysicalDevice physicalDevice, VkFormat format)
+        {
+            VkFormatProperties properties{};
+            vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &properties);
+            const VkFormatFeatureFlags required =
+                VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+            return (properties.optimalTilingFeatures & required) == required;
+        }
+
+        /// Records blits generating every mip level of @p image after the first from the previous one.
+        /// All levels must be in TRANSFER_DST_OPTIMAL, and are left in SHADER_READ_ONLY_OPTIMAL.
+        static void GenerateMips(VkCommandBuffer cmdBuffer, VkImage image, int32_t baseMipWidth, int32_t baseMipHeight, uint16_t mipLevels)
+        {
+            VkImageMemoryBarrier imgBarrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+            imgBarrier.image = image;
+            imgBarrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+
+            int32_t width = baseMipWidth;
+            int32_t height = baseMipHeight;
+            for (uint16_t mipLevel = 1; mipLevel < mipLevels; mipLevel++) {
+                // Switch the previous level, just written, to TRANSFER_SRC_OPTIMAL
+                imgBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                imgBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+                imgBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+                imgBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+                imgBarrier.subresourceRange.baseMipLevel = mipLevel - 1;
+                vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr,
+                                     1, &imgBarrier);
+
+                const int32_t nextWidth = std::max(width / 2, 1);
+                const int32_t nextHeight = std::max(height / 2, 1);
+                VkImageBlit blit{};
+                blit.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, (uint32_t)mipLevel - 1, 0, 1};
+                blit.srcOffsets[1] = {width, height, 1};
+                blit.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, mipLevel, 0, 1};
+                blit.dstOffsets[1] = {nextWidth, nextHeight, 1};
+                vkCmdBlitImage(cmdBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit,
+                               VK_FILTER_LINEAR);
+
+                width = nextWidth;
+                height = nextHeight;
+            }
+
+            // Switch the levels that were blitted from, then the last level, to SHADER_READ_ONLY_OPTIMAL
+            VkImageMemoryBarrier readBarriers[2] = {imgBarrier, imgBarrier};
+            readBarriers[0].srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            readBarriers[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            readBarriers[0].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            readBarriers[0].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            readBarriers[0].subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, (uint32_t)mipLevels - 1, 0, 1};
+            readBarriers[1].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            readBarriers[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            readBarriers[1].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            readBarriers[1].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            readBarriers[1].subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, (uint32_t)mipLevels - 1, 1, 0, 1};
+            vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr,
+                                 2, readBarriers);
+        }
+
         /// Creates a texture and fills all array members with the data in rgba
         VulkanTextureBundle CreateTextureArray(VulkanResources& pbrResources, const VulkanDebugObjectNamer& namer, const char* name,
-                                               span<const Image::Image*> imageArray, bool cubemap)
+                                               span<const Image::Image*> imageArray, bool cubemap, bool generateMips)
         {
             VkDevice device = pbrResources.GetDevice();
-            const Conformance::MemoryAllocator& memAllocator = pbrResources.GetMemoryAllocator();
+            Conformance::MemoryAllocator& memAllocator = pbrResources.GetMemoryAllocator();
             const Conformance::CmdBuffer& copyCmdBuffer = pbrResources.GetCopyCommandBuffer();
+            Conformance::StagingBufferPool& stagingPool = pbrResources.GetStagingBufferPool();
 
             uint16_t arraySize = imageArray.size();
             assert(arraySize > 0);
 
-            uint16_t mipLevels = imageArray[0]->levels.size();
-            assert(mipLevels > 0);
+            uint16_t imageMipLevels = imageArray[0]->levels.size();
+            assert(imageMipLevels > 0);
 
             uint16_t baseMipWidth = imageArray[0]->levels[0].metadata.physicalDimensions.width;
             uint16_t baseMipHeight = imageArray[0]->levels[0].metadata.physicalDimensions.height;
             Image::FormatParams formatParams = imageArray[0]->format;
             VkFormat format = ToVkFormat(formatParams);
 
+            // Only the base level is uploaded, the rest of the chain is blitted from it.
+            generateMips = generateMips && arraySize == 1 && CanGenerateMips(*imageArray[0]) &&
+                           SupportsLinearBlit(pbrResources.GetPhysicalDevice(), format);
+            uint16_t mipLevels = generateMips ? GetFullMipChainLevelCount(baseMipWidth, baseMipHeight) : imageMipLevels;
+
             // consistency check
             for (auto arrayLayer : imageArray) {
-                assert(arrayLayer->levels.size() == mipLevels);
+                assert(arrayLayer->levels.size() == imageMipLevels);
                 assert(arrayLayer->levels[0].metadata.physicalDimensions.width == baseMipWidth);
                 assert(arrayLayer->levels[0].metadata.physicalDimensions.height == baseMipHeight);
                 (void)arrayLayer;
@@ -78,12 +147,15 @@ namespace Pbr
             bundle.mipLevels = mipLevels;
             bundle.layerCount = arraySize;
 
+            // Offsets are relative to the start of the staging allocation, and kept aligned so that every
+            // region satisfies the texel block size requirements of any (compressed) format.
             std::vector<VkBufferImageCopy> regions;
-            regions.reserve(arraySize * mipLevels);
-            size_t bufferOffset = 0;
+            regions.reserve(arraySize * imageMipLevels);
+            const VkDeviceSize stagingAlignment = Conformance::StagingBufferPool::defaultAlignment;
+            VkDeviceSize bufferOffset = 0;
             for (int arrayIndex = 0; arrayIndex < arraySize; arrayIndex++) {
                 Image::Image const& arrayLayer = *imageArray[arrayIndex];
-                for (int mipLevel = 0; mipLevel < mipLevels; mipLevel++) {
+                for (int mipLevel = 0; mipLevel < imageMipLevels; mipLevel++) {
                     VkBufferImageCopy region{};
                     region.bufferOffset = bufferOffset;
                     region.bufferRowLength = 0;
@@ -98,23 +170,20 @@ namespace Pbr
 
                     regions.push_back(region);
                     bufferOffset += arrayLayer.levels[mipLevel].data.size();
+                    bufferOffset = (bufferOffset + stagingAlignment - 1) & ~(stagingAlignment - 1);
                 }
             }
 
-            // Create a staging buffer
-            VkBufferCreateInfo bufferCreateInfo{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
-            bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-            bufferCreateInfo.size = static_cast<VkDeviceSize>(bufferOffset);
-
-            Conformance::BufferAndMemory stagingBuffer;
-            stagingBuffer.Create(device, memAllocator, bufferCreateInfo);
-            XRC_CHECK_THROW_VKCMD(namer.SetName(VK_OBJECT_TYPE_BUFFER, (uint64_t)stagingBuffer.buf, "CTS texture array staging buffer"));
+            // Sub-allocate from the shared staging pool
+            Conformance::StagingAllocation staging = stagingPool.Allocate(bufferOffset);
 
             for (int arrayIndex = 0; arrayIndex < arraySize; arrayIndex++) {
                 Image::Image const& arrayLayer = *imageArray[arrayIndex];
-                for (int mipLevel = 0; mipLevel < mipLevels; mipLevel++) {
-                    stagingBuffer.Update<uint8_t>(device, arrayLayer.levels[mipLevel].data,
-                                                  regions[mipLevel + arrayIndex * mipLevels].bufferOffset);
+                for (int mipLevel = 0; mipLevel < imageMipLevels; mipLevel++) {
+                    VkBufferImageCopy& region = regions[mipLevel + arrayIndex * imageMipLevels];
+                    auto levelData = arrayLayer.levels[mipLevel].data;
+                    memcpy(staging.GetData() + region.bufferOffset, levelData.data(), levelData.size());
+                    region.bufferOffset += staging.GetOffset();
                 }
             }
 
@@ -132,6 +201,9 @@ namespace Pbr
             imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
             imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
             imageInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+            if (generateMips) {
+                imageInfo.usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+            }
             imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
             imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
             XRC_CHECK_THROW_VKCMD(vkCreateImage(device, &imageInfo, nullptr, &image));
@@ -148,6 +220,11 @@ namespace Pbr
 
             bundle.deviceMemory = Conformance::ScopedVkDeviceMemory(imageMemory, device);
 
+            // With a transfer queue, the copy runs there, and the image is then handed to the graphics family, where the mips
+            // are generated, as blits need a graphics queue.
+            const Conformance::CmdBuffer* transferCmdBuffer = pbrResources.GetTransferCommandBuffer();
+            VkCommandBuffer uploadCmdBuffer = transferCmdBuffer != nullptr ? transferCmdBuffer->buf : copyCmdBuffer.buf;
+
             // Switch the destination image to TRANSFER_DST_OPTIMAL
             VkImageMemoryBarrier imgBarrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
             imgBarrier.srcAccessMask = 0;
@@ -156,23 +233,50 @@ namespace Pbr
             imgBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
             imgBarrier.image = bundle.image.get();
             imgBarrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, mipLevels, 0, arraySize};
-            vkCmdPipelineBarrier(copyCmdBuffer.buf, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0,
+            vkCmdPipelineBarrier(uploadCmdBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0,
                                  nullptr, 1, &imgBarrier);
 
-            vkCmdCopyBufferToImage(copyCmdBuffer.buf, stagingBuffer.buf, bundle.image.get(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            vkCmdCopyBufferToImage(uploadCmdBuffer, staging.GetBuffer(), bundle.image.get(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
                                    regions.size(), regions.data());
 
-            // Switch the destination image to SHADER_READ_ONLY_OPTIMAL
-            imgBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-            imgBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-            imgBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-            imgBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            imgBarrier.image = bundle.image.get();
-            imgBarrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, mipLevels, 0, arraySize};
-            vkCmdPipelineBarrier(copyCmdBuffer.buf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0,
-                                 nullptr, 1, &imgBarrier);
+            if (transferCmdBuffer != nullptr) {
+                // Release the image to the graphics family, and record the matching acquire into the copy command buffer,
+                // which waits for the transfer submission. It stays in TRANSFER_DST_OPTIMAL if the mips are generated from it.
+                imgBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                imgBarrier.dstAccessMask = 0;
+                imgBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+                imgBarrier.newLayout = generateMips ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                imgBarrier.srcQueueFamilyIndex = pbrResources.GetTransferFamilyIndex();
+                imgBarrier.dstQueueFamilyIndex = pbrResources.GetQueueFamilyIndex();
+                vkCmdPipelineBarrier(uploadCmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr,
+                                     0, nullptr, 1, &imgBarrier);
+
+                imgBarrier.srcAccessMask = 0;
+                imgBarrier.dstAccessMask =
+                    generateMips ? VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT : VK_ACCESS_SHADER_READ_BIT;
+                const VkPipelineStageFlags dstStage = generateMips ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+                vkCmdPipelineBarrier(copyCmdBuffer.buf, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStage, 0, 0, nullptr, 0, nullptr, 1,
+                                     &imgBarrier);
+                if (generateMips) {
+                    GenerateMips(copyCmdBuffer.buf, bundle.image.get(), baseMipWidth, baseMipHeight, mipLevels);
+                }
+            }
+            else if (generateMips) {
+                GenerateMips(copyCmdBuffer.buf, bundle.image.get(), baseMipWidth, baseMipHeight, mipLevels);
+            }
+            else {
+                // Switch the destination image to SHADER_READ_ONLY_OPTIMAL
+                imgBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                imgBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+                imgBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+                imgBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                imgBarrier.image = bundle.image.get();
+                imgBarrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, mipLevels, 0, arraySize};
+                vkCmdPipelineBarrier(copyCmdBuffer.buf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0,
+                                     nullptr, 0, nullptr, 1, &imgBarrier);
+            }
 
-            pbrResources.DestroyAfterRender(stagingBuffer);
+            pbrResources.DestroyAfterRender(std::move(staging));
 
             return bundle;
         }
@@ -190,7 +294,7 @@ namespace Pbr
             std::array<Image::Image const*, 6> faces;
             faces.fill(&face);
 
-            VulkanTextureBundle textureBundle = CreateTextureArray(pbrResources, namer, "CTS PBR 2D color image", faces, true);
+            VulkanTextureBundle textureBundle = CreateTextureArray(pbrResources, namer, "CTS PBR 2D color image", faces, true, false);
             assert(textureBundle.image != VK_NULL_HANDLE);
 
             VkImageViewCreateInfo viewInfo{VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
@@ -203,7 +307,7 @@ namespace Pbr
             viewInfo.components.a = VK_COMPONENT_SWIZZLE_A;
             viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
             viewInfo.subresourceRange.baseMipLevel = 0;
-            viewInfo.subresourceRange.levelCount = 1;
+            viewInfo.subresourceRange.levelCount = textureBundle.mipLevels;
             viewInfo.subresourceRange.baseArrayLayer = 0;
             viewInfo.subresourceRange.layerCount = 6;
             VkImageView view;
@@ -215,13 +319,14 @@ namespace Pbr
             return textureBundle;
         }
 
-        VulkanTextureBundle CreateTexture(VulkanResources& pbrResources, const Image::Image& image)
+        VulkanTextureBundle CreateTexture(VulkanResources& pbrResources, const Image::Image& image, bool generateMips)
         {
             const VulkanDebugObjectNamer& namer = pbrResources.GetDebugNamer();
 
             Image::Image const* imageArray[] = {&image};
 
-            VulkanTextureBundle textureBundle = CreateTextureArray(pbrResources, namer, "CTS PBR 2D color image", imageArray, false);
+            VulkanTextureBundle textureBundle =
+                CreateTextureArray(pbrResources, namer, "CTS PBR 2D color image", imageArray, false, generateMips);
             assert(textureBundle.image != VK_NULL_HANDLE);
 
             VkImageViewCreateInfo viewInfo{VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
@@ -234,7 +339,7 @@ namespace Pbr
             viewInfo.components.a = VK_COMPONENT_SWIZZLE_A;
             viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
             viewInfo.subresourceRange.baseMipLevel = 0;
-            viewInfo.subresourceRange.levelCount = 1;
+            viewInfo.subresourceRange.levelCount = textureBundle.mipLevels;
             viewInfo.subresourceRange.baseArrayLayer = 0;
             viewInfo.subresourceRange.layerCount = 1;
             VkImageView view;
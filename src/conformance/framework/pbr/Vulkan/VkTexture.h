@@ -32,7 +32,9 @@ namespace Pbr
 
         VulkanTextureBundle CreateFlatCubeTexture(VulkanResources& pbrResources, RGBAColor color, bool sRGB);
 
-        VulkanTextureBundle CreateTexture(VulkanResources& pbrResources, const Conformance::Image::Image& image);
+        /// @param generateMips Generate the rest of the mip chain on the GPU if @p image only has its base level and is uncompressed,
+        /// and the device can blit its format with linear filtering.
+        VulkanTextureBundle CreateTexture(VulkanResources& pbrResources, const Conformance::Image::Image& image, bool generateMips = false);
 
         VkSamplerCreateInfo DefaultSamplerCreateInfo();
         VkSampler CreateSampler(VkDevice device, VkSamplerAddressMode addressMode = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE);
@@ -22,42 +22,20 @@
 #include <array>
 #include <cstdint>
 #include <memory>
-#include <mutex>
-#include <stdexcept>
-#include <utility>
 
 namespace Pbr
 {
-    struct VulkanResources;
-
-    VulkanTextureCache::VulkanTextureCache() : m_cacheMutex(std::make_unique<std::mutex>())
-    {
-    }
-
     std::shared_ptr<VulkanTextureBundle> VulkanTextureCache::CreateTypedSolidColorTexture(Pbr::VulkanResources& pbrResources,
                                                                                           XrColor4f color, bool sRGB)
     {
         const std::array<uint8_t, 4> rgba = LoadRGBAUI4(color);
 
-        // Check cache to see if this flat texture already exists.
-        const uint32_t colorKey = *reinterpret_cast<const uint32_t*>(rgba.data());
-        {
-            std::lock_guard<std::mutex> guard(*m_cacheMutex);
-            auto textureIt = m_solidColorTextureCache.find(colorKey);
-            if (textureIt != m_solidColorTextureCache.end()) {
-                return textureIt->second;
-            }
-        }
-
         auto formatParams = Conformance::Image::FormatParams::R8G8B8A8(sRGB);
         auto metadata = Conformance::Image::ImageLevelMetadata::MakeUncompressed(1, 1);
         auto image = Conformance::Image::Image{formatParams, {{metadata, rgba}}};
 
-        auto texture = std::make_shared<VulkanTextureBundle>(VulkanTexture::CreateTexture(pbrResources, image));
-
-        std::lock_guard<std::mutex> guard(*m_cacheMutex);
-        // If the key already exists then the existing texture will be returned.
-        return m_solidColorTextureCache.emplace(colorKey, texture).first->second;
+        return m_textures.FindOrCreate(
+            image, [&] { return std::make_shared<VulkanTextureBundle>(VulkanTexture::CreateTexture(pbrResources, image)); });
     }
 }  // namespace Pbr
 
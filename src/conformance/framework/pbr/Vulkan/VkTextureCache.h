@@ -12,26 +12,27 @@
 
 #include "utilities/vulkan_utils.h"
 
+#include "../PbrTextureCache.h"
+
 #include <openxr/openxr.h>
 #include <vulkan/vulkan_core.h>
 
-#include <map>
 #include <memory>
-#include <mutex>
 #include <stdint.h>
+#include <utility>
 
 namespace Pbr
 {
     struct VulkanResources;
     struct VulkanTextureBundle;
 
-    /// Cache of single-color textures.
+    /// Cache of textures by content, including single-color textures. See Pbr::TextureCache.
     ///
     /// Device-dependent, drop when device is lost or destroyed.
     class VulkanTextureCache
     {
     public:
-        VulkanTextureCache();
+        VulkanTextureCache() = default;
 
         VulkanTextureCache(VulkanTextureCache&&) = default;
         VulkanTextureCache& operator=(VulkanTextureCache&&) = default;
@@ -39,10 +40,20 @@ namespace Pbr
         /// Find or create a single pixel texture of the given color
         std::shared_ptr<VulkanTextureBundle> CreateTypedSolidColorTexture(Pbr::VulkanResources& pbrResources, XrColor4f color, bool sRGB);
 
+        /// Find the texture with the content of @p image, or create it by calling @p create.
+        template <typename Create>
+        std::shared_ptr<VulkanTextureBundle> FindOrCreate(const Conformance::Image::Image& image, Create&& create)
+        {
+            return m_textures.FindOrCreate(image, std::forward<Create>(create));
+        }
+
+        void SetBudget(uint64_t budgetBytes)
+        {
+            m_textures.SetBudget(budgetBytes);
+        }
+
     private:
-        // in unique_ptr to make it moveable
-        std::unique_ptr<std::mutex> m_cacheMutex;
-        std::map<uint32_t, std::shared_ptr<VulkanTextureBundle>> m_solidColorTextureCache;
+        TextureCache<std::shared_ptr<VulkanTextureBundle>> m_textures;
     };
 
 }  // namespace Pbr
@@ -0,0 +1,179 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "perf_metrics_sampler.h"
+
+#include "conformance_utils.h"
+#include "report.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace Conformance
+{
+    namespace
+    {
+        template <typename FunctionType>
+        FunctionType TryGetInstanceFunction(XrInstance instance, const char* functionName)
+        {
+            PFN_xrVoidFunction function = nullptr;
+            if (XR_FAILED(xrGetInstanceProcAddr(instance, functionName, &function))) {
+                return nullptr;
+            }
+            return reinterpret_cast<FunctionType>(function);
+        }
+    }  // namespace
+
+    PerformanceMetricsSampler::PerformanceMetricsSampler(XrInstance instance, XrSession session, uint32_t sampleRate)
+        : m_session(session), m_period(std::chrono::nanoseconds(std::chrono::seconds(1)) / std::max(sampleRate, 1u))
+    {
+        // Either extension may not be enabled on this instance, in which case its functions are unavailable.
+        auto enumerateCounterPaths = TryGetInstanceFunction<PFN_xrEnumeratePerformanceMetricsCounterPathsMETA>(
+            instance, "xrEnumeratePerformanceMetricsCounterPathsMETA");
+        auto setPerformanceMetricsState =
+            TryGetInstanceFunction<PFN_xrSetPerformanceMetricsStateMETA>(instance, "xrSetPerformanceMetricsStateMETA");
+        m_queryCounter = TryGetInstanceFunction<PFN_xrQueryPerformanceMetricsCounterMETA>(instance, "xrQueryPerformanceMetricsCounterMETA");
+        if (enumerateCounterPaths != nullptr && setPerformanceMetricsState != nullptr && m_queryCounter != nullptr) {
+            uint32_t countOutput = 0;
+            std::vector<XrPath> paths;
+            if (XR_SUCCEEDED(enumerateCounterPaths(instance, 0, &countOutput, nullptr)) && countOutput != 0) {
+                paths.resize(countOutput);
+                if (XR_FAILED(enumerateCounterPaths(instance, countOutput, &countOutput, paths.data()))) {
+                    paths.clear();
+                }
+            }
+
+            XrPerformanceMetricsStateMETA state{XR_TYPE_PERFORMANCE_METRICS_STATE_META};
+            state.enabled = XR_TRUE;
+            if (!paths.empty() && XR_SUCCEEDED(setPerformanceMetricsState(session, &state))) {
+                for (XrPath path : paths) {
+                    m_counters.push_back(Counter{path, Series{PathToString(instance, path), {}, {}, {}}});
+                }
+            }
+        }
+
+        m_thermalGetTemperatureTrend =
+            TryGetInstanceFunction<PFN_xrThermalGetTemperatureTrendEXT>(instance, "xrThermalGetTemperatureTrendEXT");
+        if (m_thermalGetTemperatureTrend != nullptr) {
+            m_thermalDomains.push_back(ThermalDomain{
+                XR_PERF_SETTINGS_DOMAIN_CPU_EXT, {"thermal/cpu/level", "level", {}, {}}, {"thermal/cpu/headroom", "C", {}, {}}});
+            m_thermalDomains.push_back(ThermalDomain{
+                XR_PERF_SETTINGS_DOMAIN_GPU_EXT, {"thermal/gpu/level", "level", {}, {}}, {"thermal/gpu/headroom", "C", {}, {}}});
+        }
+
+        if (!m_counters.empty() || !m_thermalDomains.empty()) {
+            m_thread = std::thread([this] { Run(); });
+        }
+    }
+
+    PerformanceMetricsSampler::~PerformanceMetricsSampler()
+    {
+        Stop();
+    }
+
+    void PerformanceMetricsSampler::Stop()
+    {
+        if (!m_thread.joinable()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+        m_thread.join();
+
+        for (const Counter& counter : m_counters) {
+            counter.series.Report();
+        }
+        for (const ThermalDomain& thermal : m_thermalDomains) {
+            thermal.level.Report();
+            thermal.headroom.Report();
+        }
+    }
+
+    void PerformanceMetricsSampler::Run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto next = std::chrono::steady_clock::now();
+        while (!m_stopping) {
+            lock.unlock();
+            Sample();
+            lock.lock();
+
+            // Keep to the fixed rate, rather than drifting by however long each sample takes.
+            next += m_period;
+            m_wake.wait_until(lock, next, [&] { return m_stopping; });
+        }
+    }
+
+    void PerformanceMetricsSampler::Sample()
+    {
+        // Counters are only meaningful once a frame has been submitted, and the samples have no time to line up with before.
+        const XrTime time = m_lastDisplayTime.load(std::memory_order_relaxed);
+        if (time == 0) {
+            return;
+        }
+
+        for (Counter& counter : m_counters) {
+            XrPerformanceMetricsCounterMETA value{XR_TYPE_PERFORMANCE_METRICS_COUNTER_META};
+            if (XR_FAILED(m_queryCounter(m_session, counter.path, &value))) {
+                continue;
+            }
+            counter.series.unit = PerformanceMetricsCounterUnitName(value.counterUnit);
+            if ((value.counterFlags & XR_PERFORMANCE_METRICS_COUNTER_FLOAT_VALUE_VALID_BIT_META) != 0) {
+                counter.series.Add(time, value.floatValue);
+            }
+            else if ((value.counterFlags & XR_PERFORMANCE_METRICS_COUNTER_UINT_VALUE_VALID_BIT_META) != 0) {
+                counter.series.Add(time, value.uintValue);
+            }
+        }
+
+        for (ThermalDomain& thermal : m_thermalDomains) {
+            XrPerfSettingsNotificationLevelEXT level{};
+            float headroom = 0.0f;
+            float slope = 0.0f;
+            if (XR_SUCCEEDED(m_thermalGetTemperatureTrend(m_session, thermal.domain, &level, &headroom, &slope))) {
+                thermal.level.Add(time, static_cast<double>(level));
+                thermal.headroom.Add(time, headroom);
+            }
+        }
+    }
+
+    void PerformanceMetricsSampler::Series::Add(XrTime time, double value)
+    {
+        times.push_back(time);
+        values.push_back(value);
+    }
+
+    void PerformanceMetricsSampler::Series::Report() const
+    {
+        if (values.empty()) {
+            return;
+        }
+
+        // Each sample carries the display time it was taken at, to correlate with the test's own frame timing metrics.
+        for (size_t i = 0; i < values.size(); ++i) {
+            ReportMetric("perfMetrics.sample", values[i], unit, {{"counter", name}, {"xrTime", std::to_string(times[i])}});
+        }
+
+        const std::vector<MetricTag> tags{
+            {"counter", name}, {"firstXrTime", std::to_string(times.front())}, {"lastXrTime", std::to_string(times.back())}};
+        ReportMetric("perfMetrics.mean", std::accumulate(values.begin(), values.end(), 0.0) / values.size(), unit, tags);
+        ReportMetric("perfMetrics.max", *std::max_element(values.begin(), values.end()), unit, tags);
+        ReportMetric("perfMetrics.sampleCount", static_cast<double>(values.size()), "count", tags);
+    }
+}  // namespace Conformance
@@ -0,0 +1,107 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <openxr/openxr.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Conformance
+{
+    /// Polls the XR_META_performance_metrics counters, and the XR_EXT_thermal_query levels, of a running session on a
+    /// background thread, see Options::perfMetricsSampleRate.
+    ///
+    /// Each sample is timestamped with the display time of the most recent frame passed to @ref OnFrameEnded, so that the
+    /// load the runtime reports can be lined up with the frame timing a test measures. The samples are summarized with
+    /// ReportMetric when sampling stops.
+    class PerformanceMetricsSampler
+    {
+    public:
+        /// Start sampling @p session at @p sampleRate samples per second, using whichever of the two extensions is enabled
+        /// on @p instance. Samples nothing if neither is.
+        PerformanceMetricsSampler(XrInstance instance, XrSession session, uint32_t sampleRate);
+
+        /// Stops sampling, see @ref Stop.
+        ~PerformanceMetricsSampler();
+
+        PerformanceMetricsSampler(const PerformanceMetricsSampler&) = delete;
+        PerformanceMetricsSampler& operator=(const PerformanceMetricsSampler&) = delete;
+
+        /// Record the display time of the frame the session just ended, to timestamp the samples that follow.
+        void OnFrameEnded(XrTime displayTime)
+        {
+            m_lastDisplayTime.store(displayTime, std::memory_order_relaxed);
+        }
+
+        /// Stop the sampling thread and report a summary of the samples taken, if any. Must be called before the session
+        /// is destroyed. Later calls do nothing.
+        void Stop();
+
+    private:
+        /// Values sampled from one counter, with the display time each was sampled at.
+        struct Series
+        {
+            /// Reported as the "counter" tag, e.g. "/perfmetrics_meta/app/cpu_frametime" or "thermal/gpu/level"
+            std::string name;
+            /// Unit of the values, e.g. "ms"
+            std::string unit;
+            std::vector<double> values;
+            std::vector<XrTime> times;
+
+            void Add(XrTime time, double value);
+            void Report() const;
+        };
+
+        struct Counter
+        {
+            XrPath path;
+            Series series;
+        };
+
+        struct ThermalDomain
+        {
+            XrPerfSettingsDomainEXT domain;
+            Series level;
+            Series headroom;
+        };
+
+        void Run();
+        void Sample();
+
+        XrSession m_session;
+        std::chrono::nanoseconds m_period;
+
+        PFN_xrQueryPerformanceMetricsCounterMETA m_queryCounter{nullptr};
+        PFN_xrThermalGetTemperatureTrendEXT m_thermalGetTemperatureTrend{nullptr};
+        // Only the sampling thread touches these between construction and Stop.
+        std::vector<Counter> m_counters;
+        std::vector<ThermalDomain> m_thermalDomains;
+
+        std::atomic<XrTime> m_lastDisplayTime{0};
+
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        bool m_stopping{false};
+        std::thread m_thread;
+    };
+}  // namespace Conformance
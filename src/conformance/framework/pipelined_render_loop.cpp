@@ -0,0 +1,105 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pipelined_render_loop.h"
+
+#include "composition_utils.h"
+#include "conformance_framework.h"
+#include "conformance_utils.h"
+#include "utilities/spsc_queue.h"
+#include "utilities/throw_helpers.h"
+
+#include <atomic>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace Conformance
+{
+    PipelinedRenderLoop::PipelinedRenderLoop(CompositionHelper& compositionHelper, SimulateFrame simulate, RenderFrame render,
+                                             uint32_t pipelineDepth /* = 2 */)
+        : m_compositionHelper(compositionHelper), m_simulate(std::move(simulate)), m_render(std::move(render)), m_pipelineDepth(pipelineDepth)
+    {
+        if (m_pipelineDepth == 0) {
+            throw std::invalid_argument("pipelineDepth must be at least 1");
+        }
+    }
+
+    void PipelinedRenderLoop::Loop()
+    {
+        const XrSession session = m_compositionHelper.GetSession();
+
+        // Closed by the simulation thread when it finishes, and by the render thread if it fails.
+        SpscQueue<PipelinedFrame> queuedFramesForRender(m_pipelineDepth);
+        std::atomic<bool> renderFailed{false};
+        std::exception_ptr simulationError;
+
+        std::thread simulationThread([&]() {
+            ATTACH_THREAD;
+            try {
+                bool keepRunning = true;
+                for (uint64_t frameIndex = 0; keepRunning && !renderFailed; ++frameIndex) {
+                    PipelinedFrame frame;
+                    frame.frameIndex = frameIndex;
+
+                    Stopwatch waitTimer(true);
+                    XRC_CHECK_THROW_XRCMD(xrWaitFrame(session, nullptr, &frame.frameState));
+                    frame.waitTime = waitTimer.Elapsed();
+
+                    keepRunning = m_simulate(frame);
+
+                    // Only blocks when the render thread is a whole pipeline depth behind.
+                    if (!queuedFramesForRender.Push(frame)) {
+                        break;
+                    }
+                }
+            }
+            catch (...) {
+                simulationError = std::current_exception();
+            }
+            // The render thread still renders the frames queued before this.
+            queuedFramesForRender.Close();
+            DETACH_THREAD;
+        });
+
+        try {
+            std::vector<XrCompositionLayerBaseHeader*> layers;
+            PipelinedFrame frame;
+            while (queuedFramesForRender.Pop(frame)) {
+                Stopwatch beginTimer(true);
+                XRC_CHECK_THROW_XRCMD(xrBeginFrame(session, nullptr));
+                frame.beginTime = beginTimer.Elapsed();
+
+                layers.clear();
+                m_render(frame, layers);
+
+                m_compositionHelper.EndFrame(frame.frameState.predictedDisplayTime, layers);
+            }
+        }
+        catch (...) {
+            renderFailed = true;
+            queuedFramesForRender.Close();
+            simulationThread.join();
+            throw;
+        }
+
+        simulationThread.join();
+        if (simulationError) {
+            std::rethrow_exception(simulationError);
+        }
+    }
+}  // namespace Conformance
@@ -0,0 +1,73 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <openxr/openxr.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace Conformance
+{
+    struct CompositionHelper;
+
+    /// A frame passed from the simulation thread to the render thread of a @ref PipelinedRenderLoop.
+    struct PipelinedFrame
+    {
+        /// Counts up from 0 for each frame of the loop.
+        uint64_t frameIndex{0};
+        /// Returned by xrWaitFrame.
+        XrFrameState frameState{XR_TYPE_FRAME_STATE};
+        /// Time spent blocked in xrWaitFrame.
+        std::chrono::nanoseconds waitTime{0};
+        /// Time spent blocked in xrBeginFrame: only set by the time the render hook is called.
+        std::chrono::nanoseconds beginTime{0};
+    };
+
+    /// Frame loop split across two threads like a typical pipelined engine: xrWaitFrame and the simulation hook on one
+    /// thread, xrBeginFrame, the render hook and xrEndFrame on the other. Frames are handed over through a lock-free
+    /// queue holding at most the pipeline depth; a thread with nothing to do sleeps rather than spins, so that it does not
+    /// take CPU time from the other thread or the runtime.
+    ///
+    /// The simulation hook runs on a thread of its own, so it must not use Catch2 assertions, which are not thread-safe:
+    /// throw instead, and the exception is rethrown from @ref Loop.
+    class PipelinedRenderLoop
+    {
+    public:
+        /// Called on the simulation thread after xrWaitFrame. Return false to stop the loop after this frame.
+        using SimulateFrame = std::function<bool(PipelinedFrame& frame)>;
+
+        /// Called on the render thread between xrBeginFrame and xrEndFrame: append the layers to submit to @p layers.
+        using RenderFrame = std::function<void(const PipelinedFrame& frame, std::vector<XrCompositionLayerBaseHeader*>& layers)>;
+
+        /// @param pipelineDepth How many frames the simulation thread may run ahead of the render thread, at least 1.
+        PipelinedRenderLoop(CompositionHelper& compositionHelper, SimulateFrame simulate, RenderFrame render, uint32_t pipelineDepth = 2);
+
+        /// Run the loop until the simulation hook returns false, using the calling thread as the render thread.
+        ///
+        /// @throws if a frame call fails or a hook throws, once both threads have stopped.
+        void Loop();
+
+    private:
+        CompositionHelper& m_compositionHelper;
+        SimulateFrame m_simulate;
+        RenderFrame m_render;
+        uint32_t m_pipelineDepth;
+    };
+}  // namespace Conformance
@@ -0,0 +1,188 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "procedural_fill.h"
+
+#include "graphics_plugin.h"
+#include "utilities/colors.h"
+#include "utilities/Geometry.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace Conformance
+{
+    namespace
+    {
+        // Perceptual gradients are approximated by this many linearly interpolated steps at most.
+        constexpr int32_t MaxGradientSteps = 256;
+
+        XrVector3f ToVertexColor(const XrColor4f& color)
+        {
+            return {color.r, color.g, color.b};
+        }
+
+        XrColor4f Lerp(const XrColor4f& a, const XrColor4f& b, float t)
+        {
+            return {a.r + (b.r - a.r) * t, a.g + (b.g - a.g) * t, a.b + (b.b - a.b) * t, a.a + (b.a - a.a) * t};
+        }
+
+        /// Quads on the plane z = -1, which a 90 degree field of view maps to the whole image.
+        class FillMeshBuilder
+        {
+        public:
+            FillMeshBuilder(uint32_t width, uint32_t height) : m_width((float)width), m_height((float)height)
+            {
+            }
+
+            /// Add the quad covering pixels [x0, x1) by [y0, y1), interpolating from @p color0 at its left or top edge to
+            /// @p color1 at its right or bottom edge.
+            void AddQuad(float x0, float y0, float x1, float y1, const XrColor4f& color0, const XrColor4f& color1, bool vertical)
+            {
+                if (m_vertices.size() + 4 > std::numeric_limits<uint16_t>::max()) {
+                    throw std::invalid_argument("ProceduralFill has too many quads to draw");
+                }
+
+                const XrVector3f c0 = ToVertexColor(color0);
+                const XrVector3f c1 = ToVertexColor(color1);
+
+                // 0-2
+                // |/|
+                // 1-3
+                const uint16_t first = (uint16_t)m_vertices.size();
+                m_vertices.push_back({ToView(x0, y0), c0});
+                m_vertices.push_back({ToView(x0, y1), vertical ? c1 : c0});
+                m_vertices.push_back({ToView(x1, y0), vertical ? c0 : c1});
+                m_vertices.push_back({ToView(x1, y1), c1});
+                for (uint16_t index : {1, 0, 2, 2, 3, 1}) {
+                    m_indices.push_back((uint16_t)(first + index));
+                }
+            }
+
+            bool Empty() const
+            {
+                return m_indices.empty();
+            }
+
+            MeshHandle Make(IGraphicsPlugin& graphicsPlugin) const
+            {
+                return graphicsPlugin.MakeSimpleMesh(m_indices, m_vertices);
+            }
+
+        private:
+            XrVector3f ToView(float x, float y) const
+            {
+                return {-1.0f + 2.0f * x / m_width, 1.0f - 2.0f * y / m_height, -1.0f};
+            }
+
+            float m_width;
+            float m_height;
+            std::vector<uint16_t> m_indices;
+            std::vector<Geometry::Vertex> m_vertices;
+        };
+
+        void AddGradient(FillMeshBuilder& mesh, const ProceduralFill& fill, float x0, float y0, float x1, float y1)
+        {
+            const bool vertical = fill.pattern == ProceduralFill::Pattern::VerticalGradient;
+            const float length = vertical ? y1 - y0 : x1 - x0;
+            const int32_t steps = fill.perceptualGradient ? std::min((int32_t)length, MaxGradientSteps) : 1;
+
+            const XrColor4f from = fill.perceptualGradient ? ColorUtils::ToSRGB(fill.background) : fill.background;
+            const XrColor4f to = fill.perceptualGradient ? ColorUtils::ToSRGB(fill.second) : fill.second;
+            auto colorAt = [&](float t) {
+                const XrColor4f color = Lerp(from, to, t);
+                return fill.perceptualGradient ? ColorUtils::FromSRGB(color) : color;
+            };
+
+            for (int32_t step = 0; step < steps; ++step) {
+                const float t0 = step / (float)steps;
+                const float t1 = (step + 1) / (float)steps;
+                if (vertical) {
+                    mesh.AddQuad(x0, y0 + length * t0, x1, y0 + length * t1, colorAt(t0), colorAt(t1), true);
+                }
+                else {
+                    mesh.AddQuad(x0 + length * t0, y0, x0 + length * t1, y1, colorAt(t0), colorAt(t1), false);
+                }
+            }
+        }
+
+        void AddCheckerboard(FillMeshBuilder& mesh, const ProceduralFill& fill, float x0, float y0, float x1, float y1)
+        {
+            if (fill.cellSize <= 0) {
+                throw std::invalid_argument("ProceduralFill checkerboard cell size must be positive");
+            }
+            const float cellSize = (float)fill.cellSize;
+            int32_t row = 0;
+            for (float y = y0; y < y1; y += cellSize, ++row) {
+                // The background already shows through the cells of the first color.
+                int32_t column = 0;
+                for (float x = x0; x < x1; x += cellSize, ++column) {
+                    if ((row + column) % 2 == 1) {
+                        mesh.AddQuad(x, y, std::min(x + cellSize, x1), std::min(y + cellSize, y1), fill.second, fill.second, false);
+                    }
+                }
+            }
+        }
+    }  // namespace
+
+    void IGraphicsPlugin::FillImageSlice(const XrSwapchainImageBaseHeader* colorSwapchainImage, uint32_t imageArrayIndex, uint32_t width,
+                                         uint32_t height, const ProceduralFill& fill)
+    {
+        ClearImageSlice(colorSwapchainImage, imageArrayIndex, fill.background);
+
+        FillMeshBuilder mesh(width, height);
+        const float border = (float)std::max(std::min({fill.borderThickness, (int32_t)width / 2, (int32_t)height / 2}), 0);
+        const float x0 = border;
+        const float y0 = border;
+        const float x1 = width - border;
+        const float y1 = height - border;
+
+        switch (fill.pattern) {
+        case ProceduralFill::Pattern::Solid:
+            break;
+        case ProceduralFill::Pattern::HorizontalGradient:
+        case ProceduralFill::Pattern::VerticalGradient:
+            AddGradient(mesh, fill, x0, y0, x1, y1);
+            break;
+        case ProceduralFill::Pattern::Checkerboard:
+            AddCheckerboard(mesh, fill, x0, y0, x1, y1);
+            break;
+        }
+
+        // The border surrounds the pattern rather than overlapping it, since every quad is at the same depth.
+        if (border > 0) {
+            mesh.AddQuad(0, 0, (float)width, y0, fill.borderColor, fill.borderColor, false);
+            mesh.AddQuad(0, y1, (float)width, (float)height, fill.borderColor, fill.borderColor, false);
+            mesh.AddQuad(0, y0, x0, y1, fill.borderColor, fill.borderColor, false);
+            mesh.AddQuad(x1, y0, (float)width, y1, fill.borderColor, fill.borderColor, false);
+        }
+
+        if (mesh.Empty()) {
+            return;
+        }
+
+        XrCompositionLayerProjectionView view{XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW};
+        view.pose = Pose::Identity;
+        view.fov = {-MATH_PI / 4, MATH_PI / 4, MATH_PI / 4, -MATH_PI / 4};
+        view.subImage.imageRect = {{0, 0}, {(int32_t)width, (int32_t)height}};
+        view.subImage.imageArrayIndex = imageArrayIndex;
+
+        const MeshDrawable drawables[] = {MeshDrawable{mesh.Make(*this)}};
+        RenderView(view, colorSwapchainImage, RenderParams().Draw(drawables));
+    }
+}  // namespace Conformance
@@ -0,0 +1,88 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <openxr/openxr.h>
+
+#include <cstdint>
+
+namespace Conformance
+{
+    /// Test content drawn on the GPU by IGraphicsPlugin::FillImageSlice, straight into a swapchain image of any format the
+    /// plugin can render to, instead of being rasterized into an RGBAImage and copied.
+    ///
+    /// Colors are in a *linear* color space, as for IGraphicsPlugin::ClearImageSlice. Only the background is written with
+    /// its alpha: the gradient, checkerboard and border are drawn opaque. The pattern covers the image inside the border.
+    struct ProceduralFill
+    {
+        enum class Pattern
+        {
+            /// Only the background color.
+            Solid,
+            /// From the background color at the left edge to the second color at the right edge.
+            HorizontalGradient,
+            /// From the background color at the top edge to the second color at the bottom edge.
+            VerticalGradient,
+            /// Square cells of the background and second colors in turn, the background color at the top left.
+            Checkerboard,
+        };
+
+        static ProceduralFill Solid(XrColor4f color)
+        {
+            ProceduralFill fill;
+            fill.background = color;
+            return fill;
+        }
+
+        static ProceduralFill Gradient(XrColor4f from, XrColor4f to, bool vertical = false)
+        {
+            ProceduralFill fill;
+            fill.pattern = vertical ? Pattern::VerticalGradient : Pattern::HorizontalGradient;
+            fill.background = from;
+            fill.second = to;
+            return fill;
+        }
+
+        static ProceduralFill Checkerboard(XrColor4f first, XrColor4f second, int32_t cellSize)
+        {
+            ProceduralFill fill;
+            fill.pattern = Pattern::Checkerboard;
+            fill.background = first;
+            fill.second = second;
+            fill.cellSize = cellSize;
+            return fill;
+        }
+
+        /// Add a border of @p thickness pixels around the edges of the image.
+        ProceduralFill& WithBorder(XrColor4f color, int32_t thickness)
+        {
+            borderColor = color;
+            borderThickness = thickness;
+            return *this;
+        }
+
+        Pattern pattern{Pattern::Solid};
+        XrColor4f background{0, 0, 0, 1};
+        XrColor4f second{0, 0, 0, 1};
+        /// Interpolate gradients evenly in SRGB rather than in linear space, so that they appear perceptually even.
+        bool perceptualGradient{true};
+        /// Width and height of a checkerboard cell in pixels.
+        int32_t cellSize{16};
+        XrColor4f borderColor{0, 0, 0, 1};
+        int32_t borderThickness{0};
+    };
+}  // namespace Conformance
@@ -15,8 +15,16 @@
 // limitations under the License.
 
 #include "report.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <stdint.h>
 #include <string>
 #include <cstdio>
+#include <mutex>
+#include <thread>
+#include <utility>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -30,6 +38,9 @@ namespace Conformance
 {
     std::function<void(const char*)> g_reportCallback;
 
+    static std::mutex g_metricsMutex;
+    static std::vector<Metric> g_pendingMetrics;
+
     static void ReportStr(const char* str)
     {
 #if defined(_WIN32)
@@ -43,6 +54,144 @@ namespace Conformance
         }
     }
 
+    namespace
+    {
+        /// Bounded lock-free queue of messages, with any number of producers and a single consumer.
+        ///
+        /// Each cell has a sequence number telling whose turn it is: a producer claims the cell at the enqueue position when
+        /// its sequence equals that position, and the consumer takes it when it is one more (D. Vyukov's bounded queue).
+        class MessageQueue
+        {
+        public:
+            /// Must be a power of two.
+            static constexpr size_t kCapacity = 1024;
+
+            MessageQueue()
+            {
+                for (size_t i = 0; i < kCapacity; ++i) {
+                    m_cells[i].sequence.store(i, std::memory_order_relaxed);
+                }
+            }
+
+            /// Returns false if the queue is full.
+            bool TryPush(std::string& message)
+            {
+                size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+                for (;;) {
+                    Cell& cell = m_cells[pos & (kCapacity - 1)];
+                    const intptr_t diff = static_cast<intptr_t>(cell.sequence.load(std::memory_order_acquire)) - static_cast<intptr_t>(pos);
+                    if (diff == 0) {
+                        if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                            cell.message = std::move(message);
+                            cell.sequence.store(pos + 1, std::memory_order_release);
+                            return true;
+                        }
+                    }
+                    else if (diff < 0) {
+                        return false;
+                    }
+                    else {
+                        pos = m_enqueuePos.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            /// Consumer only. Returns false if the queue is empty, or the next message is still being pushed.
+            bool TryPop(std::string& message)
+            {
+                Cell& cell = m_cells[m_dequeuePos & (kCapacity - 1)];
+                if (cell.sequence.load(std::memory_order_acquire) != m_dequeuePos + 1) {
+                    return false;
+                }
+                message = std::move(cell.message);
+                cell.message.clear();
+                cell.sequence.store(m_dequeuePos + kCapacity, std::memory_order_release);
+                m_dequeuePos++;
+                return true;
+            }
+
+            /// Number of messages pushed so far (or being pushed).
+            size_t PushedCount() const
+            {
+                return m_enqueuePos.load(std::memory_order_acquire);
+            }
+
+        private:
+            struct Cell
+            {
+                std::atomic<size_t> sequence;
+                std::string message;
+            };
+
+            std::array<Cell, kCapacity> m_cells;
+            std::atomic<size_t> m_enqueuePos{0};
+            size_t m_dequeuePos{0};
+        };
+
+        /// Background thread writing the messages of ReportF and ReportConsoleOnlyF.
+        struct AsyncReportSink
+        {
+            MessageQueue queue;
+            std::thread thread;
+            std::atomic<bool> running{false};
+            /// Number of messages written by the thread so far.
+            std::atomic<size_t> writtenCount{0};
+
+            /// Only used to sleep on while the queue is empty: producers never take it.
+            std::mutex wakeMutex;
+            std::condition_variable wake;
+
+            ~AsyncReportSink()
+            {
+                if (thread.joinable()) {
+                    running.store(false, std::memory_order_release);
+                    wake.notify_one();
+                    thread.join();
+                }
+            }
+
+            void Run()
+            {
+                std::string message;
+                for (;;) {
+                    if (queue.TryPop(message)) {
+                        ReportStr(message.c_str());
+                        writtenCount.fetch_add(1, std::memory_order_release);
+                        continue;
+                    }
+                    if (!running.load(std::memory_order_acquire)) {
+                        return;
+                    }
+                    // The timeout covers a notification sent just before waiting.
+                    std::unique_lock<std::mutex> lock(wakeMutex);
+                    wake.wait_for(lock, std::chrono::milliseconds(1));
+                }
+            }
+
+            void Push(std::string message)
+            {
+                while (!queue.TryPush(message)) {
+                    // Full: the console cannot keep up, so this thread has to wait for it after all.
+                    wake.notify_one();
+                    std::this_thread::yield();
+                }
+                wake.notify_one();
+            }
+        };
+
+        AsyncReportSink g_asyncReportSink;
+    }  // namespace
+
+    static void ReportOrQueueStr(std::string message)
+    {
+        if (g_asyncReportSink.running.load(std::memory_order_acquire)) {
+            g_asyncReportSink.Push(std::move(message));
+        }
+        else {
+            ReportStr(message.c_str());
+        }
+    }
+
     static void ReportV(const char* format, va_list args)
     {
         // We first try writing into this buffer. If it's not enough then use a string.
@@ -56,12 +205,13 @@ namespace Conformance
 
         if (requiredStrlen >= 0) {
             if (requiredStrlen < (int)sizeof(buffer)) {  // If the entire result fits into the buffer.
-                ReportStr(buffer);
+                ReportOrQueueStr(std::string(buffer, requiredStrlen));
             }
             else {
-                std::string result(requiredStrlen, '\0');
+                std::string result(requiredStrlen + 1, '\0');
                 std::vsnprintf(&result[0], result.size(), format, args);
-                ReportStr(result.c_str());
+                result.resize(requiredStrlen);
+                ReportOrQueueStr(std::move(result));
             }
         }
         else {
@@ -84,4 +234,64 @@ namespace Conformance
         ReportV(format, args);
         va_end(args);
     }
+
+    void StartAsyncReportSink()
+    {
+        if (g_asyncReportSink.running.exchange(true)) {
+            return;
+        }
+        g_asyncReportSink.thread = std::thread([] { g_asyncReportSink.Run(); });
+    }
+
+    void FlushAsyncReportSink()
+    {
+        if (!g_asyncReportSink.running.load(std::memory_order_acquire) ||
+            std::this_thread::get_id() == g_asyncReportSink.thread.get_id()) {
+            return;
+        }
+        const size_t pushedCount = g_asyncReportSink.queue.PushedCount();
+        while (g_asyncReportSink.writtenCount.load(std::memory_order_acquire) < pushedCount) {
+            g_asyncReportSink.wake.notify_one();
+            std::this_thread::yield();
+        }
+    }
+
+    void StopAsyncReportSink()
+    {
+        if (!g_asyncReportSink.running.exchange(false)) {
+            return;
+        }
+        g_asyncReportSink.wake.notify_one();
+        g_asyncReportSink.thread.join();
+
+        // This thread is the consumer now: write anything pushed while the sink was stopping.
+        std::string message;
+        while (g_asyncReportSink.queue.TryPop(message)) {
+            ReportStr(message.c_str());
+            g_asyncReportSink.writtenCount.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    void ReportMetric(std::string name, double value, std::string unit, std::vector<MetricTag> tags)
+    {
+        std::string tagString;
+        for (const MetricTag& tag : tags) {
+            tagString += (tagString.empty() ? " [" : ", ") + tag.name + "=" + tag.value;
+        }
+        if (!tagString.empty()) {
+            tagString += "]";
+        }
+        ReportConsoleOnlyF("Metric %s%s: %g %s", name.c_str(), tagString.c_str(), value, unit.c_str());
+
+        std::lock_guard<std::mutex> lock(g_metricsMutex);
+        g_pendingMetrics.push_back(Metric{std::move(name), value, std::move(unit), std::move(tags)});
+    }
+
+    std::vector<Metric> TakeReportedMetrics()
+    {
+        std::lock_guard<std::mutex> lock(g_metricsMutex);
+        std::vector<Metric> metrics;
+        metrics.swap(g_pendingMetrics);
+        return metrics;
+    }
 }  // namespace Conformance
@@ -20,6 +20,8 @@
 #include <iostream>
 #include <streambuf>
 #include <functional>
+#include <string>
+#include <vector>
 
 namespace Conformance
 {
@@ -43,6 +45,46 @@ namespace Conformance
     /// Formatted report function, like ReportF, but for console output only (when XML report output has another way of including this data)
     void ReportConsoleOnlyF(const char* format, ...);
 
+    /// Make ReportF and ReportConsoleOnlyF queue their messages for a background thread to pass on to g_reportCallback,
+    /// so that tests reporting every frame do not block on console output. See Options::asyncReport.
+    void StartAsyncReportSink();
+
+    /// Write all queued messages, and wait until they are written. Called at test boundaries and before any other console
+    /// output, so that messages stay in order. Does nothing if the sink is not running.
+    void FlushAsyncReportSink();
+
+    /// Write all queued messages and stop the background thread: messages are written synchronously again.
+    /// Must not be called while other threads may still be reporting.
+    void StopAsyncReportSink();
+
+    /// A name/value pair qualifying a Metric, e.g. {"load", "90:70"}.
+    struct MetricTag
+    {
+        std::string name;
+        std::string value;
+    };
+
+    /// A single machine-readable measurement reported by a test.
+    struct Metric
+    {
+        /// Identifies the measurement, e.g. "xrWaitFrame.averageWaitTime"
+        std::string name;
+        double value;
+        /// Unit of the value, e.g. "ms", "percent", "bytes", "count"
+        std::string unit;
+        std::vector<MetricTag> tags;
+    };
+
+    /// Report a measurement, such as a timing, for inclusion in the CTS XML report.
+    ///
+    /// The metric is attached to the section that is running when that section ends, and is also written to the console.
+    /// Use this rather than ReportF for numbers that should be tracked across runs.
+    /// May be called from any thread.
+    void ReportMetric(std::string name, double value, std::string unit, std::vector<MetricTag> tags = {});
+
+    /// Removes and returns all metrics reported since the last call. Used by the CTS reporter.
+    std::vector<Metric> TakeReportedMetrics();
+
     /// @}
 
 }  // namespace Conformance
@@ -0,0 +1,239 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime_capabilities.h"
+
+#include "two_call_util.h"
+
+#include <stdio.h>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace Conformance
+{
+    namespace
+    {
+        constexpr uint32_t kCacheVersion = 1;
+
+        uint64_t HashString(const std::string& str, uint64_t hash = 14695981039346656037ull)
+        {
+            for (char c : str) {
+                hash = (hash ^ (uint8_t)c) * 1099511628211ull;
+            }
+            return hash;
+        }
+
+        template <typename T>
+        void WriteList(std::ostream& out, const char* key, const std::vector<T>& values)
+        {
+            out << key;
+            for (const T& value : values) {
+                out << ' ' << (int64_t)value;
+            }
+            out << '\n';
+        }
+
+        template <typename T>
+        void ReadList(std::istream& in, std::vector<T>& values)
+        {
+            values.clear();
+            int64_t value;
+            while (in >> value) {
+                values.push_back((T)value);
+            }
+        }
+    }  // namespace
+
+    XrResult RuntimeCapabilities::Gather(XrInstance instance, XrSystemId systemId, XrFormFactor formFactor_,
+                                         XrViewConfigurationType viewConfigurationType_, const std::string& graphicsPlugin_,
+                                         const std::string& cacheDirectory)
+    {
+        *this = RuntimeCapabilities{};
+
+        XrInstanceProperties instanceProperties{XR_TYPE_INSTANCE_PROPERTIES};
+        XrResult result = xrGetInstanceProperties(instance, &instanceProperties);
+        if (XR_FAILED(result)) {
+            return result;
+        }
+        XrSystemProperties systemProperties{XR_TYPE_SYSTEM_PROPERTIES};
+        result = xrGetSystemProperties(instance, systemId, &systemProperties);
+        if (XR_FAILED(result)) {
+            return result;
+        }
+
+        runtimeName = instanceProperties.runtimeName;
+        runtimeVersion = instanceProperties.runtimeVersion;
+        systemName = systemProperties.systemName;
+        vendorId = systemProperties.vendorId;
+        formFactor = formFactor_;
+        viewConfigurationType = viewConfigurationType_;
+        graphicsPlugin = graphicsPlugin_;
+
+        if (!cacheDirectory.empty() && Load(GetCachePath(cacheDirectory))) {
+            fromCache = true;
+            return XR_SUCCESS;
+        }
+
+        result = doTwoCallInPlace(viewConfigurationTypes, xrEnumerateViewConfigurations, instance, systemId);
+        if (XR_FAILED(result)) {
+            return result;
+        }
+        result = doTwoCallInPlaceWithEmptyElement(viewConfigurationViews, {XR_TYPE_VIEW_CONFIGURATION_VIEW},
+                                                  xrEnumerateViewConfigurationViews, instance, systemId, viewConfigurationType);
+        if (XR_FAILED(result)) {
+            return result;
+        }
+        result = doTwoCallInPlace(environmentBlendModes, xrEnumerateEnvironmentBlendModes, instance, systemId, viewConfigurationType);
+        if (XR_FAILED(result)) {
+            return result;
+        }
+
+        Save(cacheDirectory);
+        return XR_SUCCESS;
+    }
+
+    std::string RuntimeCapabilities::GetCachePath(const std::string& cacheDirectory) const
+    {
+        uint64_t hash = HashString(runtimeName);
+        hash = HashString(std::to_string(runtimeVersion), hash);
+        hash = HashString(systemName, hash);
+        hash = HashString(std::to_string(vendorId), hash);
+        hash = HashString(std::to_string((int)formFactor), hash);
+        hash = HashString(std::to_string((int)viewConfigurationType), hash);
+        hash = HashString(graphicsPlugin, hash);
+
+        char name[64];
+        snprintf(name, sizeof(name), "cts_capabilities_%016llx_v%u.txt", (unsigned long long)hash, kCacheVersion);
+        return cacheDirectory + "/" + name;
+    }
+
+    bool RuntimeCapabilities::Load(const std::string& path)
+    {
+        std::ifstream file(path);
+        if (!file) {
+            return false;
+        }
+
+        // The hash in the file name may collide, so the identity is checked as well.
+        bool identityMatches[7]{};
+        bool complete = false;
+        std::string line;
+        while (std::getline(file, line)) {
+            const size_t space = line.find(' ');
+            const std::string key = line.substr(0, space);
+            const std::string value = (space == std::string::npos) ? std::string() : line.substr(space + 1);
+            std::istringstream values(value);
+            if (key == "runtimeName") {
+                identityMatches[0] = (value == runtimeName);
+            }
+            else if (key == "runtimeVersion") {
+                identityMatches[1] = (value == std::to_string(runtimeVersion));
+            }
+            else if (key == "systemName") {
+                identityMatches[2] = (value == systemName);
+            }
+            else if (key == "vendorId") {
+                identityMatches[3] = (value == std::to_string(vendorId));
+            }
+            else if (key == "formFactor") {
+                identityMatches[4] = (value == std::to_string((int)formFactor));
+            }
+            else if (key == "viewConfigurationType") {
+                identityMatches[5] = (value == std::to_string((int)viewConfigurationType));
+            }
+            else if (key == "graphicsPlugin") {
+                identityMatches[6] = (value == graphicsPlugin);
+            }
+            else if (key == "viewConfigurationTypes") {
+                ReadList(values, viewConfigurationTypes);
+            }
+            else if (key == "viewConfigurationView") {
+                XrViewConfigurationView view{XR_TYPE_VIEW_CONFIGURATION_VIEW};
+                values >> view.recommendedImageRectWidth >> view.maxImageRectWidth >> view.recommendedImageRectHeight >>
+                    view.maxImageRectHeight >> view.recommendedSwapchainSampleCount >> view.maxSwapchainSampleCount;
+                if (!values) {
+                    return false;
+                }
+                viewConfigurationViews.push_back(view);
+            }
+            else if (key == "environmentBlendModes") {
+                ReadList(values, environmentBlendModes);
+            }
+            else if (key == "swapchainFormats") {
+                ReadList(values, swapchainFormats);
+            }
+            else if (key == "end") {
+                // Written last, so a torn file is never used.
+                complete = true;
+            }
+        }
+
+        for (bool matches : identityMatches) {
+            if (!matches) {
+                complete = false;
+            }
+        }
+        if (!complete || viewConfigurationViews.empty() || environmentBlendModes.empty()) {
+            viewConfigurationTypes.clear();
+            viewConfigurationViews.clear();
+            environmentBlendModes.clear();
+            swapchainFormats.clear();
+            return false;
+        }
+        return true;
+    }
+
+    void RuntimeCapabilities::Save(const std::string& cacheDirectory) const
+    {
+        if (cacheDirectory.empty()) {
+            return;
+        }
+        const std::string path = GetCachePath(cacheDirectory);
+
+        // Write to a temporary file first, so that concurrent shards never see a partially written snapshot.
+        std::ostringstream tempPath;
+        tempPath << path << "." << std::this_thread::get_id() << ".tmp";
+        {
+            std::ofstream file(tempPath.str(), std::ios::trunc);
+            file << "runtimeName " << runtimeName << '\n';
+            file << "runtimeVersion " << runtimeVersion << '\n';
+            file << "systemName " << systemName << '\n';
+            file << "vendorId " << vendorId << '\n';
+            file << "formFactor " << (int)formFactor << '\n';
+            file << "viewConfigurationType " << (int)viewConfigurationType << '\n';
+            file << "graphicsPlugin " << graphicsPlugin << '\n';
+            WriteList(file, "viewConfigurationTypes", viewConfigurationTypes);
+            for (const XrViewConfigurationView& view : viewConfigurationViews) {
+                file << "viewConfigurationView " << view.recommendedImageRectWidth << ' ' << view.maxImageRectWidth << ' '
+                     << view.recommendedImageRectHeight << ' ' << view.maxImageRectHeight << ' ' << view.recommendedSwapchainSampleCount
+                     << ' ' << view.maxSwapchainSampleCount << '\n';
+            }
+            WriteList(file, "environmentBlendModes", environmentBlendModes);
+            WriteList(file, "swapchainFormats", swapchainFormats);
+            file << "end\n";
+            if (!file) {
+                file.close();
+                remove(tempPath.str().c_str());
+                return;
+            }
+        }
+        remove(path.c_str());
+        if (rename(tempPath.str().c_str(), path.c_str()) != 0) {
+            remove(tempPath.str().c_str());
+        }
+    }
+}  // namespace Conformance
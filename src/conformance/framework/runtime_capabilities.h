@@ -0,0 +1,71 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <openxr/openxr.h>
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace Conformance
+{
+    /// What the runtime reports about itself and the system under test, probed once per run by GlobalData::Initialize so that
+    /// test setup can use it rather than asking the runtime again for every session.
+    ///
+    /// Tests of the functions that report these must still call them: the snapshot is only for setting up, such as picking a
+    /// swapchain format or sizing the views.
+    ///
+    /// With a cache directory, the snapshot is also kept in a text file there, and read back instead of probing by later runs,
+    /// or other shards of the same run, whose runtime, system, form factor, view configuration and graphics plugin all match.
+    struct RuntimeCapabilities
+    {
+        /// Identify the snapshot: a cached one is only used if all of these match.
+        std::string runtimeName;
+        XrVersion runtimeVersion{0};
+        std::string systemName;
+        uint32_t vendorId{0};
+        XrFormFactor formFactor{XR_FORM_FACTOR_MAX_ENUM};
+        XrViewConfigurationType viewConfigurationType{XR_VIEW_CONFIGURATION_TYPE_MAX_ENUM};
+        std::string graphicsPlugin;
+
+        std::vector<XrViewConfigurationType> viewConfigurationTypes;
+        /// The views of viewConfigurationType.
+        std::vector<XrViewConfigurationView> viewConfigurationViews;
+        /// The blend modes of viewConfigurationType.
+        std::vector<XrEnvironmentBlendMode> environmentBlendModes;
+        /// Empty until the first session with the graphics plugin has enumerated them.
+        std::vector<int64_t> swapchainFormats;
+
+        /// True if read from the cache rather than probed by this run.
+        bool fromCache{false};
+
+        /// Query the runtime and system properties, then either read the rest from a matching snapshot in @p cacheDirectory or
+        /// probe it and write it there. An empty @p cacheDirectory always probes. Returns the first failed result, if any.
+        XrResult Gather(XrInstance instance, XrSystemId systemId, XrFormFactor formFactor_,
+                        XrViewConfigurationType viewConfigurationType_, const std::string& graphicsPlugin_,
+                        const std::string& cacheDirectory);
+
+        /// Write the snapshot to @p cacheDirectory, if not empty. Best effort: a snapshot that cannot be written is probed again
+        /// next time.
+        void Save(const std::string& cacheDirectory) const;
+
+    private:
+        std::string GetCachePath(const std::string& cacheDirectory) const;
+        bool Load(const std::string& path);
+    };
+}  // namespace Conformance
@@ -0,0 +1,71 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "startup_timing.h"
+
+namespace Conformance
+{
+    static thread_local StartupTimingCollector* s_currentCollector = nullptr;
+
+    const char* StartupPhaseName(StartupPhase phase)
+    {
+        switch (phase) {
+        case StartupPhase::CreateInstance:
+            return "CreateInstance";
+        case StartupPhase::GetSystem:
+            return "GetSystem";
+        case StartupPhase::GraphicsRequirements:
+            return "GraphicsRequirements";
+        case StartupPhase::InitializeDevice:
+            return "InitializeDevice";
+        case StartupPhase::CreateSession:
+            return "CreateSession";
+        case StartupPhase::WaitSessionReady:
+            return "WaitSessionReady";
+        case StartupPhase::BeginSession:
+            return "BeginSession";
+        case StartupPhase::FirstFrame:
+            return "FirstFrame";
+        case StartupPhase::Count:
+            break;
+        }
+        return "Unknown";
+    }
+
+    StartupTimingCollector::StartupTimingCollector() : m_previous(s_currentCollector)
+    {
+        s_currentCollector = this;
+    }
+
+    StartupTimingCollector::~StartupTimingCollector()
+    {
+        s_currentCollector = m_previous;
+    }
+
+    ScopedStartupPhase::ScopedStartupPhase(StartupPhase phase) : m_collector(s_currentCollector), m_phase(phase)
+    {
+        if (m_collector != nullptr) {
+            m_start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ScopedStartupPhase::~ScopedStartupPhase()
+    {
+        if (m_collector != nullptr) {
+            m_collector->m_timings[m_phase] += std::chrono::steady_clock::now() - m_start;
+        }
+    }
+}  // namespace Conformance
@@ -0,0 +1,105 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+namespace Conformance
+{
+    /// Phases of bringing up a session that the framework times for the session startup benchmark.
+    enum class StartupPhase
+    {
+        /// xrCreateInstance
+        CreateInstance,
+        /// xrGetSystem
+        GetSystem,
+        /// xrGet*GraphicsRequirementsKHR, called by the graphics plugin
+        GraphicsRequirements,
+        /// IGraphicsPlugin::InitializeDevice (or reuse of a kept device), including GraphicsRequirements
+        InitializeDevice,
+        /// xrCreateSession
+        CreateSession,
+        /// Waiting for XR_SESSION_STATE_READY after session creation
+        WaitSessionReady,
+        /// xrBeginSession
+        BeginSession,
+        /// xrWaitFrame, xrBeginFrame and xrEndFrame of the first frame
+        FirstFrame,
+
+        Count
+    };
+
+    constexpr size_t kStartupPhaseCount = static_cast<size_t>(StartupPhase::Count);
+
+    /// Name of @p phase for reports, e.g. "CreateInstance".
+    const char* StartupPhaseName(StartupPhase phase);
+
+    /// Total time spent in each @ref StartupPhase.
+    struct StartupTimings
+    {
+        std::array<std::chrono::nanoseconds, kStartupPhaseCount> durations{};
+
+        std::chrono::nanoseconds& operator[](StartupPhase phase)
+        {
+            return durations[static_cast<size_t>(phase)];
+        }
+        std::chrono::nanoseconds operator[](StartupPhase phase) const
+        {
+            return durations[static_cast<size_t>(phase)];
+        }
+    };
+
+    /// While alive, collects the time of every @ref ScopedStartupPhase on the constructing thread.
+    /// Collectors nest: the innermost one collects, and the outer one resumes when it is destroyed.
+    class StartupTimingCollector
+    {
+    public:
+        StartupTimingCollector();
+        ~StartupTimingCollector();
+        StartupTimingCollector(const StartupTimingCollector&) = delete;
+        StartupTimingCollector& operator=(const StartupTimingCollector&) = delete;
+
+        const StartupTimings& GetTimings() const
+        {
+            return m_timings;
+        }
+
+    private:
+        friend class ScopedStartupPhase;
+
+        StartupTimings m_timings;
+        StartupTimingCollector* m_previous;
+    };
+
+    /// Adds the lifetime of this object to @p phase of the current thread's @ref StartupTimingCollector.
+    /// Does not read the clock when no collector is active, so it can stay in the framework's startup path.
+    class ScopedStartupPhase
+    {
+    public:
+        explicit ScopedStartupPhase(StartupPhase phase);
+        ~ScopedStartupPhase();
+        ScopedStartupPhase(const ScopedStartupPhase&) = delete;
+        ScopedStartupPhase& operator=(const ScopedStartupPhase&) = delete;
+
+    private:
+        StartupTimingCollector* m_collector;
+        StartupPhase m_phase;
+        std::chrono::steady_clock::time_point m_start;
+    };
+}  // namespace Conformance
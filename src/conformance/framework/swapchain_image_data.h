@@ -52,6 +52,10 @@ namespace Conformance
         /// to the derived/specialized type to get the data.
         virtual XrSwapchainImageBaseHeader* GetGenericColorImage(uint32_t colorImageIndex) = 0;
 
+        /// Get image number @p depthImageIndex enumerated from the depth swapchain, as a base pointer. Only meaningful if
+        /// there is a depth swapchain.
+        virtual XrSwapchainImageBaseHeader* GetGenericDepthImage(uint32_t depthImageIndex) = 0;
+
         /// Get the number of swapchain image structs that are currently allocated.
         virtual uint32_t GetCapacity() const noexcept = 0;
 
@@ -151,6 +155,11 @@ namespace Conformance
         /// Implementation of base interface
         XrSwapchainImageBaseHeader* GetGenericColorImage(uint32_t i) override;
 
+        /// Access the generic `XrSwapchainImageBaseHeader` pointer for depth swapchain image index @p depthImageIndex
+        ///
+        /// Implementation of base interface
+        XrSwapchainImageBaseHeader* GetGenericDepthImage(uint32_t depthImageIndex) override;
+
         /// If depth is being provided by an XrSwapchain, acquire and wait it, and associate it with
         /// the colorImageIndex specified.
         ///
@@ -233,6 +242,19 @@ namespace Conformance
             return m_colorInfo.arraySize;
         }
 
+        /// Get the number of layers of the color swapchain image: its array size times its face count. ClearImageSlice and
+        /// RenderView address face `f` of array slice `s` of a cube swapchain as image array index `s * 6 + f`.
+        uint32_t LayerCount() const noexcept
+        {
+            return m_colorInfo.arraySize * m_colorInfo.faceCount;
+        }
+
+        /// True if `faceCount` in the color create info was 6.
+        bool IsCube() const noexcept
+        {
+            return m_colorInfo.faceCount == 6;
+        }
+
         /// Get the sample count requested for the color swapchain image
         uint32_t SampleCount() const noexcept
         {
@@ -322,6 +344,12 @@ namespace Conformance
         return reinterpret_cast<XrSwapchainImageBaseHeader*>(&m_colorSwapchainImages.at(colorImageIndex));
     }
 
+    template <typename SwapchainImageDerivedType>
+    inline XrSwapchainImageBaseHeader* SwapchainImageDataBase<SwapchainImageDerivedType>::GetGenericDepthImage(uint32_t depthImageIndex)
+    {
+        return reinterpret_cast<XrSwapchainImageBaseHeader*>(&m_depthSwapchainImages.at(depthImageIndex));
+    }
+
     /// A collection of @ref ISwapchainImageData derived objects, in their fully-specialized type.
     /// Generic `XrSwapchainImageBaseHeader` pointers map to an ISwapchainImageData-based type and an image index.
     ///
@@ -333,29 +361,47 @@ namespace Conformance
         static_assert(std::is_base_of<ISwapchainImageData, SwapchainImageData>::value,
                       "Your swapchain image data type must implement the interface");
 
-        /// Take ownership of @p data, and add every swapchain image in @p data
-        /// to our internal map of base pointers to image data and index.
+        /// Take ownership of @p data, and record the address range of the swapchain images in @p data
+        /// so that their base pointers can be mapped back to the image data and index.
         void Adopt(std::unique_ptr<SwapchainImageData>&& data)
         {
-            const auto size = data->GetCapacity();
-            for (uint32_t colorImageIndex = 0; colorImageIndex < size; ++colorImageIndex) {
-                // Map every swapchainImage base pointer to this typed pointer
-                m_swapchainImageDataMap[data->GetGenericColorImage(colorImageIndex)] = std::make_pair(data.get(), colorImageIndex);
+            const uint32_t size = data->GetCapacity();
+            if (size > 0) {
+                // The typed images are in a single array, so a base pointer maps to an index by its offset from the first one.
+                ImageRange range{};
+                range.first = reinterpret_cast<uintptr_t>(data->GetGenericColorImage(0));
+                range.stride = size > 1 ? reinterpret_cast<uintptr_t>(data->GetGenericColorImage(1)) - range.first : 1;
+                range.count = size;
+                range.data = data.get();
+                m_imageRanges.push_back(range);
             }
             m_imageDatas.emplace_back(std::move(data));
         }
 
         /// Given a base pointer for a color swapchain image, look up the image data object and swapchain image index associated with it.
         /// If not found for some reason, the pointer will be null.
+        ///
+        /// Takes constant time in the number of images: just a range check per live swapchain, most recently adopted first.
         std::pair<SwapchainImageData*, uint32_t> GetDataAndIndexFromBasePointer(const XrSwapchainImageBaseHeader* basePointer) const
         {
-            std::pair<SwapchainImageData*, uint32_t> ret{};
+            const uintptr_t address = reinterpret_cast<uintptr_t>(basePointer);
+            for (auto it = m_imageRanges.rbegin(); it != m_imageRanges.rend(); ++it) {
+                // Unsigned, so addresses before the first image wrap around to out of range.
+                const uintptr_t offset = address - it->first;
+                if (offset < it->stride * it->count && offset % it->stride == 0) {
+                    return {it->data, static_cast<uint32_t>(offset / it->stride)};
+                }
+            }
+            return {};
+        }
 
-            auto it = m_swapchainImageDataMap.find(basePointer);
-            if (it != m_swapchainImageDataMap.end()) {
-                ret = it->second;
+        /// Call @p f with each SwapchainImageData adopted, in order of adoption.
+        template <typename F>
+        void ForEach(F&& f) const
+        {
+            for (const auto& imageData : m_imageDatas) {
+                f(*imageData);
             }
-            return ret;
         }
 
         /// Call Reset on all known SwapchainImageData, then clear internal storage.
@@ -370,7 +416,7 @@ namespace Conformance
         /// Empty internal containers, without first calling reset on their contents.
         void Clear()
         {
-            m_swapchainImageDataMap.clear();
+            m_imageRanges.clear();
             m_imageDatas.clear();
         }
 
@@ -378,8 +424,19 @@ namespace Conformance
         /// Owns the image data, placed in order of adoption.
         std::vector<std::unique_ptr<SwapchainImageData>> m_imageDatas;
 
-        /// Associates base pointers for color swapchain images with the corresponding image data and index.
-        std::map<const XrSwapchainImageBaseHeader*, std::pair<SwapchainImageData*, uint32_t>> m_swapchainImageDataMap;
+        /// The color swapchain images of one image data object, as an address range.
+        struct ImageRange
+        {
+            /// Address of the first image
+            uintptr_t first;
+            /// Distance in bytes between consecutive images
+            uintptr_t stride;
+            uint32_t count;
+            SwapchainImageData* data;
+        };
+
+        /// Address ranges of the color swapchain images, in order of adoption.
+        std::vector<ImageRange> m_imageRanges;
     };
 
 }  // namespace Conformance
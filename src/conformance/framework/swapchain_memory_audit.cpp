@@ -0,0 +1,78 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "swapchain_memory_audit.h"
+
+#include "report.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace Conformance
+{
+    void SwapchainMemoryAudit::SwapchainCreated(XrSwapchain swapchain, bool isStatic, uint64_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_liveSwapchains.emplace(swapchain, LiveSwapchain{isStatic, bytes}).second) {
+            return;
+        }
+        for (Tally* tally : {isStatic ? &m_static : &m_dynamic, &m_total}) {
+            tally->liveBytes += bytes;
+            tally->peakBytes = std::max(tally->peakBytes, tally->liveBytes);
+            tally->createdBytes += bytes;
+            tally->createdCount++;
+        }
+    }
+
+    void SwapchainMemoryAudit::SwapchainDestroyed(XrSwapchain swapchain)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_liveSwapchains.find(swapchain);
+        if (it == m_liveSwapchains.end()) {
+            return;
+        }
+        for (Tally* tally : {it->second.isStatic ? &m_static : &m_dynamic, &m_total}) {
+            tally->liveBytes -= it->second.bytes;
+        }
+        m_liveSwapchains.erase(it);
+    }
+
+    void SwapchainMemoryAudit::Report()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_total.peakBytes == 0) {
+            return;
+        }
+
+        const struct
+        {
+            const char* kind;
+            Tally* tally;
+        } kinds[] = {{"dynamic", &m_dynamic}, {"static", &m_static}, {"all", &m_total}};
+        for (const auto& kind : kinds) {
+            const std::vector<MetricTag> tags{{"kind", kind.kind}};
+            ReportMetric("swapchainMemory.peakBytes", static_cast<double>(kind.tally->peakBytes), "bytes", tags);
+            ReportMetric("swapchainMemory.createdBytes", static_cast<double>(kind.tally->createdBytes), "bytes", tags);
+            ReportMetric("swapchainMemory.createdCount", kind.tally->createdCount, "count", tags);
+
+            // Swapchains still alive count towards the next peak from the start.
+            kind.tally->peakBytes = kind.tally->liveBytes;
+            kind.tally->createdBytes = 0;
+            kind.tally->createdCount = 0;
+        }
+    }
+}  // namespace Conformance
@@ -0,0 +1,72 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <openxr/openxr.h>
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+namespace Conformance
+{
+    /// Tallies the GPU memory behind the swapchains a test creates, see Options::swapchainMemoryAudit.
+    ///
+    /// Swapchains created with XR_SWAPCHAIN_CREATE_STATIC_IMAGE_BIT are counted apart from dynamic ones, since apps choose
+    /// between them. The sizes come from IGraphicsPlugin::GetSwapchainImageMemorySize, so swapchains on graphics APIs that
+    /// cannot report them are not counted at all.
+    class SwapchainMemoryAudit
+    {
+    public:
+        /// Record that @p swapchain was created, with @p bytes of GPU memory allocated for its images.
+        /// May be called from any thread.
+        void SwapchainCreated(XrSwapchain swapchain, bool isStatic, uint64_t bytes);
+
+        /// Record that @p swapchain was destroyed. Does nothing if it was not recorded as created.
+        /// May be called from any thread.
+        void SwapchainDestroyed(XrSwapchain swapchain);
+
+        /// Report the memory of the swapchains created since the last call, and the peak memory of the swapchains alive
+        /// since then, as metrics of the running test. Reports nothing if no swapchain was alive.
+        void Report();
+
+    private:
+        struct Tally
+        {
+            /// Memory of the swapchains alive now
+            uint64_t liveBytes{0};
+            /// Most memory alive at once since the last report
+            uint64_t peakBytes{0};
+            /// Memory of the swapchains created since the last report
+            uint64_t createdBytes{0};
+            uint32_t createdCount{0};
+        };
+
+        struct LiveSwapchain
+        {
+            bool isStatic;
+            uint64_t bytes;
+        };
+
+        std::mutex m_mutex;
+        std::unordered_map<XrSwapchain, LiveSwapchain> m_liveSwapchains;
+        Tally m_dynamic;
+        Tally m_static;
+        /// Both kinds together, whose peak is not the sum of the two peaks.
+        Tally m_total;
+    };
+}  // namespace Conformance
@@ -0,0 +1,99 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "test_checkpoint.h"
+
+#include <fstream>
+
+namespace Conformance
+{
+    namespace
+    {
+        constexpr const char* kStartedEvent = "started";
+        constexpr const char* kCrashedEvent = "crashed";
+    }  // namespace
+
+    TestCheckpoint::~TestCheckpoint()
+    {
+        if (m_file != nullptr) {
+            fclose(m_file);
+        }
+    }
+
+    bool TestCheckpoint::Open(const std::string& path)
+    {
+        m_completed.clear();
+        m_newlyCrashed.clear();
+
+        // The last test case that started and has not ended, if any.
+        std::string unfinished;
+        {
+            std::ifstream file(path);
+            std::string line;
+            while (std::getline(file, line)) {
+                const size_t space = line.find(' ');
+                if (space == std::string::npos) {
+                    continue;  // Torn write
+                }
+                std::string name = line.substr(space + 1);
+                if (line.compare(0, space, kStartedEvent) == 0) {
+                    unfinished = std::move(name);
+                }
+                else {
+                    if (name == unfinished) {
+                        unfinished.clear();
+                    }
+                    m_completed.insert(std::move(name));
+                }
+            }
+        }
+
+        if (m_file != nullptr) {
+            fclose(m_file);
+        }
+        m_file = fopen(path.c_str(), "a");
+        if (m_file == nullptr) {
+            return false;
+        }
+
+        if (!unfinished.empty()) {
+            m_newlyCrashed.push_back(unfinished);
+            m_completed.insert(unfinished);
+            Append(kCrashedEvent, unfinished);
+        }
+        return true;
+    }
+
+    void TestCheckpoint::TestCaseStarting(const std::string& testCaseName)
+    {
+        Append(kStartedEvent, testCaseName);
+    }
+
+    void TestCheckpoint::TestCaseEnded(const std::string& testCaseName, const char* result)
+    {
+        Append(result, testCaseName);
+    }
+
+    void TestCheckpoint::Append(const char* event, const std::string& testCaseName)
+    {
+        if (m_file == nullptr) {
+            return;
+        }
+        fprintf(m_file, "%s %s\n", event, testCaseName.c_str());
+        // Only the C library buffers the line: once flushed, it survives the process crashing.
+        fflush(m_file);
+    }
+}  // namespace Conformance
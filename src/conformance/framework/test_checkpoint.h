@@ -0,0 +1,79 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdio.h>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace Conformance
+{
+    /// Records which test cases of a run have finished, so that a run stopped by a runtime crash can be resumed.
+    ///
+    /// The checkpoint is a text file with one line per event: `started <name>` when a test case starts, then
+    /// `passed <name>`, `failed <name>` or `skipped <name>` when it ends. Each line is flushed as it is written, so the file
+    /// survives the process dying. A test case that started but never ended took the process down with it: it is recorded
+    /// as `crashed <name>` when the checkpoint is next opened.
+    class TestCheckpoint
+    {
+    public:
+        TestCheckpoint() = default;
+        ~TestCheckpoint();
+
+        TestCheckpoint(const TestCheckpoint&) = delete;
+        TestCheckpoint& operator=(const TestCheckpoint&) = delete;
+
+        /// Load the test cases an earlier run recorded in @p path, if it exists, then open it for appending.
+        /// Returns false if the file cannot be written.
+        bool Open(const std::string& path);
+
+        bool IsOpen() const
+        {
+            return m_file != nullptr;
+        }
+
+        /// True if an earlier run finished (or crashed in) the test case, so it should not run again.
+        bool IsCompleted(const std::string& testCaseName) const
+        {
+            return m_completed.count(testCaseName) != 0;
+        }
+
+        size_t GetCompletedCount() const
+        {
+            return m_completed.size();
+        }
+
+        /// Test cases that crashed the previous run, found when opening the checkpoint.
+        const std::vector<std::string>& GetNewlyCrashedTestCases() const
+        {
+            return m_newlyCrashed;
+        }
+
+        void TestCaseStarting(const std::string& testCaseName);
+
+        /// @p result is "passed", "failed" or "skipped".
+        void TestCaseEnded(const std::string& testCaseName, const char* result);
+
+    private:
+        void Append(const char* event, const std::string& testCaseName);
+
+        FILE* m_file{nullptr};
+        std::unordered_set<std::string> m_completed;
+        std::vector<std::string> m_newlyCrashed;
+    };
+}  // namespace Conformance
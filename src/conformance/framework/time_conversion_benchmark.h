@@ -0,0 +1,155 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include "conformance_framework.h"
+#include "report.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <openxr/openxr.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Conformance
+{
+    /// Shared by the benchmarks of XR_KHR_convert_timespec_time and XR_KHR_win32_convert_performance_counter_time, whose
+    /// conversions engines call every frame and for every input event. Measures:
+    ///
+    /// - the throughput of each direction of the conversion from one thread and from several at once, which exposes
+    ///   conversions that make a system call or take a lock;
+    /// - over a ten second run, the round-trip error and how far the offset between XrTime and the platform clock drifts,
+    ///   which exposes conversions whose rate does not match the platform clock.
+    ///
+    /// @p now reads the platform clock into a Value, @p toTime and @p fromTime are the extension's conversions, bound to
+    /// an instance, and @p toNanoseconds converts a Value to nanoseconds of the platform clock.
+    /// Metrics are named `TimeConversion.*` and tagged with @p clockName.
+    template <typename Value, typename Now, typename ToTime, typename FromTime, typename ToNanoseconds>
+    void RunTimeConversionBenchmark(const char* clockName, Now&& now, ToTime&& toTime, FromTime&& fromTime, ToNanoseconds&& toNanoseconds)
+    {
+        using Clock = std::chrono::steady_clock;
+        using ns = std::chrono::duration<double, std::nano>;
+        constexpr uint32_t callsPerThread = 100000;
+        constexpr std::chrono::seconds driftDuration{10};
+        constexpr std::chrono::milliseconds driftInterval{1};
+
+        const Value platformNow = now();
+        XrTime timeNow = 0;
+        REQUIRE(XR_SUCCEEDED(toTime(&platformNow, &timeNow)));
+
+        std::vector<uint32_t> threadCounts{1};
+        const uint32_t maxThreadCount = std::min(std::max(std::thread::hardware_concurrency(), 1u), 8u);
+        while (threadCounts.back() * 2 <= maxThreadCount) {
+            threadCounts.push_back(threadCounts.back() * 2);
+        }
+
+        // Catch2 assertions are not thread-safe, so the threads only record the first failure.
+        auto measure = [&](const char* direction, uint32_t threadCount, auto&& convert) {
+            std::atomic<uint32_t> readyCount{0};
+            std::atomic<bool> go{false};
+            std::atomic<int32_t> firstFailure{XR_SUCCESS};
+            std::vector<std::thread> threads;
+            for (uint32_t i = 0; i < threadCount; ++i) {
+                threads.emplace_back([&] {
+                    ATTACH_THREAD;
+                    ++readyCount;
+                    while (!go) {
+                        std::this_thread::yield();
+                    }
+                    for (uint32_t call = 0; call < callsPerThread; ++call) {
+                        const XrResult result = convert();
+                        if (XR_FAILED(result)) {
+                            int32_t expected = XR_SUCCESS;
+                            firstFailure.compare_exchange_strong(expected, result);
+                            break;
+                        }
+                    }
+                    DETACH_THREAD;
+                });
+            }
+            while (readyCount != threadCount) {
+                std::this_thread::yield();
+            }
+            const Clock::time_point start = Clock::now();
+            go = true;
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+            const ns wallTime = Clock::now() - start;
+            REQUIRE(static_cast<XrResult>(firstFailure.load()) == XR_SUCCESS);
+
+            // Each thread made callsPerThread calls in at most the wall time, so this is the time of one call as each thread saw it.
+            const double nsPerCall = wallTime.count() / callsPerThread;
+            const double callsPerSecond = threadCount * callsPerThread / (wallTime.count() / 1e9);
+            const std::vector<MetricTag> tags{{"clock", clockName}, {"direction", direction}, {"threads", std::to_string(threadCount)}};
+            ReportMetric("TimeConversion.callTime", nsPerCall, "ns", tags);
+            ReportMetric("TimeConversion.throughput", callsPerSecond, "calls/s", tags);
+            ReportConsoleOnlyF("%s %s, %u thread(s): %.1fns per call, %.0f calls/s", clockName, direction, threadCount, nsPerCall,
+                               callsPerSecond);
+        };
+
+        for (uint32_t threadCount : threadCounts) {
+            measure("toXrTime", threadCount, [&] {
+                XrTime time;
+                return toTime(&platformNow, &time);
+            });
+            measure("fromXrTime", threadCount, [&] {
+                Value value;
+                return fromTime(timeNow, &value);
+            });
+        }
+
+        // Round trip the current time every millisecond, and follow the offset between XrTime and the platform clock.
+        int64_t maxRoundTripError = 0;
+        int64_t firstOffset = 0;
+        int64_t minOffset = INT64_MAX;
+        int64_t maxOffset = INT64_MIN;
+        uint32_t sampleCount = 0;
+        const Clock::time_point driftStart = Clock::now();
+        while (Clock::now() - driftStart < driftDuration) {
+            const Value before = now();
+            XrTime time = 0;
+            REQUIRE(XR_SUCCEEDED(toTime(&before, &time)));
+            Value after;
+            REQUIRE(XR_SUCCEEDED(fromTime(time, &after)));
+
+            const int64_t beforeNs = toNanoseconds(before);
+            maxRoundTripError = std::max<int64_t>(maxRoundTripError, std::llabs(toNanoseconds(after) - beforeNs));
+            const int64_t offset = time - beforeNs;
+            if (sampleCount++ == 0) {
+                firstOffset = offset;
+            }
+            minOffset = std::min(minOffset, offset);
+            maxOffset = std::max(maxOffset, offset);
+            std::this_thread::sleep_for(driftInterval);
+        }
+
+        const std::vector<MetricTag> tags{{"clock", clockName}};
+        ReportMetric("TimeConversion.roundTripErrorMax", (double)maxRoundTripError, "ns", tags);
+        ReportMetric("TimeConversion.offsetDrift", (double)(maxOffset - minOffset), "ns", tags);
+        ReportConsoleOnlyF("%s: %u round trips over %llds, error at most %lldns, offset %lldns with drift %lldns", clockName, sampleCount,
+                           (long long)driftDuration.count(), (long long)maxRoundTripError, (long long)firstOffset,
+                           (long long)(maxOffset - minOffset));
+    }
+}  // namespace Conformance
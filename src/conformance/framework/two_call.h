@@ -23,6 +23,7 @@
 #include <catch2/internal/catch_preprocessor.hpp>
 
 #include "conformance_framework.h"
+#include "two_call_util.h"
 
 #include <string>
 #include <vector>
@@ -64,12 +65,13 @@ namespace Conformance
             std::string callStart;
         };
 
-        /// Main workings of the two-call checker.
+        /// Main workings of the two-call checker, filling @p ret, whose capacity is reused.
         template <typename T, typename F, typename... Args>
-        inline std::vector<T> test(Catch::StringRef const& macroName, Strings const& strings, const Catch::SourceLineInfo& lineinfo,
-                                   Catch::ResultDisposition::Flags resultDisposition, T const& empty, F&& wrappedCall, Args&&... a)
+        inline std::vector<T>& testInto(std::vector<T>& ret, Catch::StringRef const& macroName, Strings const& strings,
+                                        const Catch::SourceLineInfo& lineinfo, Catch::ResultDisposition::Flags resultDisposition,
+                                        T const& empty, F&& wrappedCall, Args&&... a)
         {
-            std::vector<T> ret;
+            ret.clear();
             uint32_t count = 0;
             {
                 std::string name = (Catch::ReusableStringStream() << strings.expressionString << " ) // count request call: "
@@ -114,6 +116,16 @@ namespace Conformance
             }
             return ret;
         }
+
+        /// Main workings of the two-call checker, returning a new container.
+        template <typename T, typename F, typename... Args>
+        inline std::vector<T> test(Catch::StringRef const& macroName, Strings const& strings, const Catch::SourceLineInfo& lineinfo,
+                                   Catch::ResultDisposition::Flags resultDisposition, T const& empty, F&& wrappedCall, Args&&... a)
+        {
+            std::vector<T> ret;
+            testInto(ret, macroName, strings, lineinfo, resultDisposition, empty, std::forward<F>(wrappedCall), std::forward<Args>(a)...);
+            return ret;
+        }
     }  // namespace twocallimpl
 }  // namespace Conformance
 
@@ -131,6 +143,13 @@ namespace Conformance
                                                       __VA_ARGS__);                                                              \
     }()
 
+// Internal macro providing shared implementation between CHECK_TWO_CALL_INTO and REQUIRE_TWO_CALL_INTO
+#define INTERNAL_TEST_TWO_CALL_INTO(macroName, resultDisposition, STRINGS, CONTAINER, TYPE, ...)                             \
+    [&]() -> std::vector<TYPE>& {                                                                                            \
+        return ::Conformance::twocallimpl::testInto<TYPE>(CONTAINER, macroName##_catch_sr, STRINGS, CATCH_INTERNAL_LINEINFO, \
+                                                          resultDisposition, __VA_ARGS__);                                   \
+    }()
+
 /*!
  * @defgroup cts_twocall Checkers for Two Call Idiom
  * @ingroup cts_framework
@@ -141,6 +160,9 @@ namespace Conformance
  * - An initializer for an empty single buffer element
  * - The name of the call
  * - Any additional arguments that should be passed **before**  the capacityInput, countOutput, and array parameters
+ *
+ * The `_INTO` variants take a `std::vector<T>` to fill first, and return a reference to it: its capacity is reused, so calling
+ * them in a loop with the same container, or one from a @ref Conformance::TwoCallScratch, does not allocate on every iteration.
  */
     /// @{
 
@@ -153,6 +175,14 @@ namespace Conformance
 #define REQUIRE_TWO_CALL(TYPE, ...)                                                                                                      \
     INTERNAL_TEST_TWO_CALL("REQUIRE_TWO_CALL", Catch::ResultDisposition::Normal, (INTERNAL_TWO_CALL_STRINGIFY(TYPE, __VA_ARGS__)), TYPE, \
                            __VA_ARGS__)
+/// Like CHECK_TWO_CALL, filling and returning an existing container.
+#define CHECK_TWO_CALL_INTO(CONTAINER, TYPE, ...)                                                   \
+    INTERNAL_TEST_TWO_CALL_INTO("CHECK_TWO_CALL_INTO", Catch::ResultDisposition::ContinueOnFailure, \
+                                (INTERNAL_TWO_CALL_STRINGIFY(TYPE, __VA_ARGS__)), CONTAINER, TYPE, __VA_ARGS__)
+/// Like REQUIRE_TWO_CALL, filling and returning an existing container.
+#define REQUIRE_TWO_CALL_INTO(CONTAINER, TYPE, ...)                                        \
+    INTERNAL_TEST_TWO_CALL_INTO("REQUIRE_TWO_CALL_INTO", Catch::ResultDisposition::Normal, \
+                                (INTERNAL_TWO_CALL_STRINGIFY(TYPE, __VA_ARGS__)), CONTAINER, TYPE, __VA_ARGS__)
 #else
 /// Try a two-call idiom in "check" mode: failures are recorded but return an empty container.
 #define CHECK_TWO_CALL(TYPE, ...)                                                         \
@@ -162,5 +192,13 @@ namespace Conformance
 #define REQUIRE_TWO_CALL(TYPE, ...)                                              \
     INTERNAL_TEST_TWO_CALL("REQUIRE_TWO_CALL", Catch::ResultDisposition::Normal, \
                            INTERNAL_CATCH_EXPAND_VARGS(INTERNAL_TWO_CALL_STRINGIFY(TYPE, __VA_ARGS__)), TYPE, __VA_ARGS__)
+/// Like CHECK_TWO_CALL, filling and returning an existing container.
+#define CHECK_TWO_CALL_INTO(CONTAINER, TYPE, ...)                                                   \
+    INTERNAL_TEST_TWO_CALL_INTO("CHECK_TWO_CALL_INTO", Catch::ResultDisposition::ContinueOnFailure, \
+                                INTERNAL_CATCH_EXPAND_VARGS(INTERNAL_TWO_CALL_STRINGIFY(TYPE, __VA_ARGS__)), CONTAINER, TYPE, __VA_ARGS__)
+/// Like REQUIRE_TWO_CALL, filling and returning an existing container.
+#define REQUIRE_TWO_CALL_INTO(CONTAINER, TYPE, ...)                                        \
+    INTERNAL_TEST_TWO_CALL_INTO("REQUIRE_TWO_CALL_INTO", Catch::ResultDisposition::Normal, \
+                                INTERNAL_CATCH_EXPAND_VARGS(INTERNAL_TWO_CALL_STRINGIFY(TYPE, __VA_ARGS__)), CONTAINER, TYPE, __VA_ARGS__)
 #endif
 /// @}
@@ -212,28 +212,21 @@ namespace Conformance
     }  // namespace detail
 
     /**
-     * Automatically check for conformant behavior of a function that uses the two-call idiom with a struct
-     *
-     * @param twoCallData The data describing the two-call-struct: typically placed in an overload of `getTwoCallStructData()` for modularity and reusability.
-     * @param emptyStruct The empty struct you want to start with when creating copies of the struct for tests. Must be at least zeroed with the type and next set appropriately.
-     * @param functionName A string literal for the function name you call in @p doCall
-     * @param emptyIsError If we should error out in case we receive an empty enumeration
-     * @param doCall A functor that takes a pointer to your two-call-struct type and returns XrResult.
+     * Like the overload taking the two-call-struct data below, but with caller-owned storage for the arrays.
      *
-     * @tparam StructType Automatically deduced
-     * @tparam ArraySetsTypeList Automatically deduced from your metadata::TwoCallStructData
-     * @tparam F Automatically deduced from your functor you provide
+     * @param twoCallStorage Made with @ref MakeTwoCallStructStorage. Keep it for a whole test, or loop, and pass it to every check,
+     * so that its arrays are only allocated until they are as large as they need to be.
      */
     template <typename StructType, typename ArraySetsTypeList, typename F>
-    static inline void CheckTwoCallStructConformance(const metadata::TwoCallStructData<StructType, ArraySetsTypeList>& twoCallData,
+    static inline void CheckTwoCallStructConformance(storage::TwoCallStructStorage<StructType, ArraySetsTypeList>& twoCallStorage,
                                                      const StructType& emptyStruct, const char* functionName, bool emptyIsError, F&& doCall)
     {
         INFO("Two-call idiom checking, structure-style");
 
         using Subtests = detail::TwoCallStructSubtests<StructType, ArraySetsTypeList>;
+        const metadata::TwoCallStructData<StructType, ArraySetsTypeList>& twoCallData = twoCallStorage.data;
 
         StructType structWithCounts = emptyStruct;
-        auto twoCallStorage = MakeTwoCallStructStorage(twoCallData);
 
         // Condition 1 - normal first call
         {
@@ -284,4 +277,25 @@ namespace Conformance
         Subtests::CheckSingleZero(twoCallStorage, emptyStruct, structWithCounts, functionName, std::forward<F>(doCall));
     }
 
+    /**
+     * Automatically check for conformant behavior of a function that uses the two-call idiom with a struct
+     *
+     * @param twoCallData The data describing the two-call-struct: typically placed in an overload of `getTwoCallStructData()` for modularity and reusability.
+     * @param emptyStruct The empty struct you want to start with when creating copies of the struct for tests. Must be at least zeroed with the type and next set appropriately.
+     * @param functionName A string literal for the function name you call in @p doCall
+     * @param emptyIsError If we should error out in case we receive an empty enumeration
+     * @param doCall A functor that takes a pointer to your two-call-struct type and returns XrResult.
+     *
+     * @tparam StructType Automatically deduced
+     * @tparam ArraySetsTypeList Automatically deduced from your metadata::TwoCallStructData
+     * @tparam F Automatically deduced from your functor you provide
+     */
+    template <typename StructType, typename ArraySetsTypeList, typename F>
+    static inline void CheckTwoCallStructConformance(const metadata::TwoCallStructData<StructType, ArraySetsTypeList>& twoCallData,
+                                                     const StructType& emptyStruct, const char* functionName, bool emptyIsError, F&& doCall)
+    {
+        auto twoCallStorage = MakeTwoCallStructStorage(twoCallData);
+        CheckTwoCallStructConformance(twoCallStorage, emptyStruct, functionName, emptyIsError, std::forward<F>(doCall));
+    }
+
 }  // namespace Conformance
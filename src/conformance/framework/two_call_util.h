@@ -30,8 +30,13 @@
 #pragma once
 
 #include <openxr/openxr.h>
-#include <vector>
+
+#include <map>
+#include <memory>
+#include <typeindex>
+#include <typeinfo>
 #include <utility>
+#include <vector>
 
 namespace Conformance
 {
@@ -153,4 +158,42 @@ namespace Conformance
                                    std::forward<Args>(a)...);
     }
 
+    /*!
+     * Scratch containers for two-call results, to be kept for the length of a test and reused by each enumeration in it, so that
+     * enumerating in a loop only allocates until the containers are as large as they need to be.
+     *
+     * Pass the containers to @ref doTwoCallInPlace or @ref CHECK_TWO_CALL_INTO and friends. A container stays valid, and keeps its
+     * contents, until the next call to Get for the same element type and slot.
+     */
+    class TwoCallScratch
+    {
+    public:
+        /// Get the container for element type @p T in @p slot, emptied but keeping its capacity.
+        /// Use distinct slots for results of the same type that are needed at the same time.
+        template <typename T>
+        std::vector<T>& Get(size_t slot = 0)
+        {
+            std::unique_ptr<ContainerBase>& container = m_containers[std::make_pair(std::type_index(typeid(T)), slot)];
+            if (!container) {
+                container.reset(new Container<T>());
+            }
+            std::vector<T>& vec = static_cast<Container<T>*>(container.get())->vec;
+            vec.clear();
+            return vec;
+        }
+
+    private:
+        struct ContainerBase
+        {
+            virtual ~ContainerBase() = default;
+        };
+        template <typename T>
+        struct Container : ContainerBase
+        {
+            std::vector<T> vec;
+        };
+
+        std::map<std::pair<std::type_index, size_t>, std::unique_ptr<ContainerBase>> m_containers;
+    };
+
 }  // namespace Conformance
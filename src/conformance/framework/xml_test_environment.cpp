@@ -47,6 +47,43 @@ namespace Conformance
                 .writeAttribute("ms", std::chrono::duration_cast<ms>(timing.GetAverageBeginWaitTime()).count());
             xml.scopedElement(CTS_XML_NS_PREFIX_QUALIFIER "overhead").writeAttribute("percent", timing.GetOverheadFactor() * 100.f);
         }
+        if (!cr.framePacing.empty()) {
+            using ms = std::chrono::duration<float, std::milli>;
+            auto writePercentiles = [&](const char* name, const DurationPercentiles& percentiles) {
+                xml.scopedElement(name)
+                    .writeAttribute("meanMs", std::chrono::duration_cast<ms>(percentiles.mean).count())
+                    .writeAttribute("p50Ms", std::chrono::duration_cast<ms>(percentiles.p50).count())
+                    .writeAttribute("p90Ms", std::chrono::duration_cast<ms>(percentiles.p90).count())
+                    .writeAttribute("p99Ms", std::chrono::duration_cast<ms>(percentiles.p99).count())
+                    .writeAttribute("maxMs", std::chrono::duration_cast<ms>(percentiles.max).count());
+            };
+            auto e2 = xml.scopedElement(CTS_XML_NS_PREFIX_QUALIFIER "framePacing");
+            for (const auto& pacing : cr.framePacing) {
+                auto e3 = xml.scopedElement(CTS_XML_NS_PREFIX_QUALIFIER "load");
+                xml.writeAttribute("cpuPercent", pacing.load.cpu * 100)
+                    .writeAttribute("gpuPercent", pacing.load.gpu * 100)
+                    .writeAttribute("frameCount", pacing.frameCount)
+                    .writeAttribute("missedFrameCount", pacing.missedFrameCount)
+                    .writeAttribute("shouldRenderFalseCount", pacing.shouldRenderFalseCount);
+                xml.scopedElement(CTS_XML_NS_PREFIX_QUALIFIER "averageDisplayPeriod")
+                    .writeAttribute("ms", std::chrono::duration_cast<ms>(pacing.averageDisplayPeriod).count());
+                writePercentiles(CTS_XML_NS_PREFIX_QUALIFIER "frameTime", pacing.frameTime);
+                writePercentiles(CTS_XML_NS_PREFIX_QUALIFIER "waitTime", pacing.waitTime);
+                writePercentiles(CTS_XML_NS_PREFIX_QUALIFIER "beginTime", pacing.beginTime);
+                {
+                    auto e4 = xml.scopedElement(CTS_XML_NS_PREFIX_QUALIFIER "frameTimeHistogram");
+                    xml.writeAttribute("bucketWidthDisplayPeriods", FramePacingResults::HistogramBucketWidth);
+                    for (size_t i = 0; i < pacing.frameTimeHistogram.size(); ++i) {
+                        auto bucket = xml.scopedElement(CTS_XML_NS_PREFIX_QUALIFIER "bucket");
+                        // The last bucket is open-ended.
+                        if (i + 1 < pacing.frameTimeHistogram.size()) {
+                            bucket.writeAttribute("upperBoundDisplayPeriods", (i + 1) * FramePacingResults::HistogramBucketWidth);
+                        }
+                        bucket.writeAttribute("count", pacing.frameTimeHistogram[i]);
+                    }
+                }
+            }
+        }
         if (!cr.swapchainFormats.empty()) {
             auto e2 = xml.scopedElement(CTS_XML_NS_PREFIX_QUALIFIER "swapchainFormats");
             for (const auto& formatAndName : cr.swapchainFormats) {
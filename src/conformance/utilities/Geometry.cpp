@@ -6,6 +6,9 @@
 
 #include <openxr/openxr.h>
 
+#include <cmath>
+#include <stdexcept>
+
 namespace Geometry
 {
 
@@ -63,4 +66,96 @@ namespace Geometry
             vertices[i] = vertex;
         }
     }
+
+    namespace
+    {
+        constexpr float Pi = 3.14159265358979323846f;
+
+        /// Reserve a mesh of (uSegments + 1) * (vSegments + 1) vertices, checking that 16-bit indices can address them.
+        Mesh StartParametricMesh(uint32_t uSegments, uint32_t vSegments)
+        {
+            if (uSegments == 0 || vSegments == 0) {
+                throw std::invalid_argument("A generated mesh needs at least one segment in each direction");
+            }
+            const uint64_t vertexCount = uint64_t(uSegments + 1) * (vSegments + 1);
+            if (vertexCount > MaxMeshVertices) {
+                throw std::invalid_argument("A generated mesh cannot have more vertices than 16-bit indices can address");
+            }
+            Mesh mesh;
+            mesh.vertices.reserve((size_t)vertexCount);
+            mesh.indices.reserve(size_t(uSegments) * vSegments * 6);
+            return mesh;
+        }
+
+        /// Color a normal, mapping each component from [-1, 1] to [0, 1].
+        XrVector3f NormalColor(XrVector3f normal)
+        {
+            return {0.5f + 0.5f * normal.x, 0.5f + 0.5f * normal.y, 0.5f + 0.5f * normal.z};
+        }
+
+        /// Add two triangles per cell of a grid of vertices laid out v-major, (uSegments + 1) to a row. The cross product
+        /// of the u and v directions must point out of the surface, which the clockwise winding then faces.
+        void AddGridIndices(Mesh& mesh, uint32_t uSegments, uint32_t vSegments)
+        {
+            const uint32_t rowLength = uSegments + 1;
+            for (uint32_t v = 0; v < vSegments; ++v) {
+                for (uint32_t u = 0; u < uSegments; ++u) {
+                    const uint16_t a = (uint16_t)(v * rowLength + u);
+                    const uint16_t b = (uint16_t)(a + 1);
+                    const uint16_t c = (uint16_t)(a + rowLength);
+                    const uint16_t d = (uint16_t)(c + 1);
+                    mesh.indices.insert(mesh.indices.end(), {a, c, b, b, c, d});
+                }
+            }
+        }
+    }  // namespace
+
+    Mesh MakeSphere(uint32_t slices, uint32_t stacks, float radius)
+    {
+        Mesh mesh = StartParametricMesh(slices, stacks);
+        for (uint32_t stack = 0; stack <= stacks; ++stack) {
+            const float theta = Pi * stack / stacks;
+            for (uint32_t slice = 0; slice <= slices; ++slice) {
+                const float phi = 2 * Pi * slice / slices;
+                const XrVector3f normal{std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)};
+                mesh.vertices.push_back({{normal.x * radius, normal.y * radius, normal.z * radius}, NormalColor(normal)});
+            }
+        }
+        AddGridIndices(mesh, slices, stacks);
+        return mesh;
+    }
+
+    Mesh MakeGrid(uint32_t columns, uint32_t rows, float size)
+    {
+        Mesh mesh = StartParametricMesh(columns, rows);
+        for (uint32_t row = 0; row <= rows; ++row) {
+            const float y = size * ((float)row / rows - 0.5f);
+            for (uint32_t column = 0; column <= columns; ++column) {
+                const float x = size * ((float)column / columns - 0.5f);
+                // Checkered, so that the triangle density shows.
+                const XrVector3f color = ((row + column) % 2) ? DarkBlue : Blue;
+                mesh.vertices.push_back({{x, y, 0}, color});
+            }
+        }
+        AddGridIndices(mesh, columns, rows);
+        return mesh;
+    }
+
+    Mesh MakeTorus(uint32_t ringSegments, uint32_t tubeSegments, float ringRadius, float tubeRadius)
+    {
+        // Around the tube is u and around the ring is v, so that their cross product points outwards.
+        Mesh mesh = StartParametricMesh(tubeSegments, ringSegments);
+        for (uint32_t ring = 0; ring <= ringSegments; ++ring) {
+            const float phi = 2 * Pi * ring / ringSegments;
+            for (uint32_t tube = 0; tube <= tubeSegments; ++tube) {
+                const float psi = 2 * Pi * tube / tubeSegments;
+                const XrVector3f normal{std::cos(psi) * std::cos(phi), std::sin(psi), std::cos(psi) * std::sin(phi)};
+                const float distance = ringRadius + tubeRadius * std::cos(psi);
+                mesh.vertices.push_back(
+                    {{distance * std::cos(phi), tubeRadius * std::sin(psi), distance * std::sin(phi)}, NormalColor(normal)});
+            }
+        }
+        AddGridIndices(mesh, tubeSegments, ringSegments);
+        return mesh;
+    }
 }  // namespace Geometry
@@ -6,6 +6,8 @@
 
 #include <array>
 #include <openxr/openxr.h>
+#include <stdint.h>
+#include <vector>
 
 namespace Geometry
 {
@@ -67,4 +69,33 @@ namespace Geometry
         std::array<Vertex, 30 * 3> vertices;
     };
 
+    /// A mesh generated at run time, to pass to IGraphicsPlugin::MakeSimpleMesh. Wound clockwise like the cube, seen from
+    /// outside, and colored by its normals.
+    struct Mesh
+    {
+        std::vector<uint16_t> indices;
+        std::vector<Vertex> vertices;
+
+        uint32_t TriangleCount() const
+        {
+            return (uint32_t)(indices.size() / 3);
+        }
+    };
+
+    /// MakeSimpleMesh takes 16-bit indices, so a generated mesh has at most this many vertices. For more triangles than
+    /// one mesh holds, draw several instances of it.
+    constexpr uint32_t MaxMeshVertices = 65536;
+
+    /// A sphere of @p radius around the origin, with 2 * slices * stacks triangles (those touching the poles are degenerate).
+    /// Throws std::invalid_argument if it would need more than MaxMeshVertices vertices.
+    Mesh MakeSphere(uint32_t slices, uint32_t stacks, float radius = 0.5f);
+
+    /// A square grid of @p size meters in the XY plane, facing +Z, with 2 * columns * rows triangles.
+    /// Throws std::invalid_argument if it would need more than MaxMeshVertices vertices.
+    Mesh MakeGrid(uint32_t columns, uint32_t rows, float size = 1.0f);
+
+    /// A torus around the Y axis, with 2 * ringSegments * tubeSegments triangles.
+    /// Throws std::invalid_argument if it would need more than MaxMeshVertices vertices.
+    Mesh MakeTorus(uint32_t ringSegments, uint32_t tubeSegments, float ringRadius = 0.35f, float tubeRadius = 0.15f);
+
 }  // namespace Geometry
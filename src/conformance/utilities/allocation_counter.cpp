@@ -0,0 +1,115 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "allocation_counter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace Conformance
+{
+#if defined(XRC_ENABLE_ALLOCATION_COUNTING)
+    static thread_local uint64_t s_threadAllocationCount = 0;
+    static thread_local uint64_t s_threadAllocatedBytes = 0;
+#endif
+
+    uint64_t GetThreadAllocationCount()
+    {
+#if defined(XRC_ENABLE_ALLOCATION_COUNTING)
+        return s_threadAllocationCount;
+#else
+        return 0;
+#endif
+    }
+
+    uint64_t GetThreadAllocatedBytes()
+    {
+#if defined(XRC_ENABLE_ALLOCATION_COUNTING)
+        return s_threadAllocatedBytes;
+#else
+        return 0;
+#endif
+    }
+}  // namespace Conformance
+
+#if defined(XRC_ENABLE_ALLOCATION_COUNTING)
+
+// Replacements of the global allocation functions, which only differ from the default ones in counting.
+// The aligned (C++17) overloads are not replaced, so over-aligned allocations are not counted.
+
+static void* CountedAllocate(std::size_t size)
+{
+    ++Conformance::s_threadAllocationCount;
+    Conformance::s_threadAllocatedBytes += size;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new(std::size_t size)
+{
+    void* p = CountedAllocate(size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return CountedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return CountedAllocate(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
+
+#endif  // defined(XRC_ENABLE_ALLOCATION_COUNTING)
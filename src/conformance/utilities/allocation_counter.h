@@ -0,0 +1,47 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+
+#if !defined(NDEBUG) && !defined(XRC_ENABLE_ALLOCATION_COUNTING)
+#define XRC_ENABLE_ALLOCATION_COUNTING
+#endif
+
+namespace Conformance
+{
+    /// Number of times the current thread has called the global operator new (including array new) so far.
+    ///
+    /// Only counted in builds where operator new is replaced to do so: debug builds, and builds with
+    /// BUILD_CONFORMANCE_ALLOCATION_COUNTING. Always 0 otherwise.
+    /// Subtract two readings to count the allocations made by some code, such as a frame of a render loop.
+    uint64_t GetThreadAllocationCount();
+
+    /// Number of bytes the current thread has asked the global operator new for so far, counted like
+    /// @ref GetThreadAllocationCount. Freeing memory does not subtract from it.
+    uint64_t GetThreadAllocatedBytes();
+
+    /// Whether @ref GetThreadAllocationCount counts allocations in this build.
+    constexpr bool IsAllocationCountingEnabled()
+    {
+#if defined(XRC_ENABLE_ALLOCATION_COUNTING)
+        return true;
+#else
+        return false;
+#endif
+    }
+}  // namespace Conformance
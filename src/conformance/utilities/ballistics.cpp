@@ -8,12 +8,52 @@
 #include "utilities/xr_math_operators.h"
 
 #include <openxr/openxr.h>
+
+// The linear integration uses SSE2 or NEON when the target has it.
+#if !defined(XR_BALLISTICS_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define XR_BALLISTICS_SIMD_SSE2 1
+#include <emmintrin.h>
+#elif !defined(XR_BALLISTICS_NO_SIMD) && (defined(__ARM_NEON) || defined(_M_ARM64))
+#define XR_BALLISTICS_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
 #include <stdexcept>
 
 namespace Conformance
 {
     using namespace openxr::math_operators;
 
+    namespace
+    {
+        // One axis of v += a * dt; p += v * dt for @p count bodies, in the same order of operations as BodyInMotion.
+        void IntegrateAxis(float* position, float* velocity, const float* stepSeconds, float acceleration, size_t count)
+        {
+            size_t i = 0;
+#if defined(XR_BALLISTICS_SIMD_SSE2)
+            const __m128 acceleration4 = _mm_set1_ps(acceleration);
+            for (; i + 4 <= count; i += 4) {
+                const __m128 dt = _mm_loadu_ps(stepSeconds + i);
+                const __m128 v = _mm_add_ps(_mm_loadu_ps(velocity + i), _mm_mul_ps(acceleration4, dt));
+                _mm_storeu_ps(velocity + i, v);
+                _mm_storeu_ps(position + i, _mm_add_ps(_mm_loadu_ps(position + i), _mm_mul_ps(v, dt)));
+            }
+#elif defined(XR_BALLISTICS_SIMD_NEON)
+            const float32x4_t acceleration4 = vdupq_n_f32(acceleration);
+            for (; i + 4 <= count; i += 4) {
+                const float32x4_t dt = vld1q_f32(stepSeconds + i);
+                const float32x4_t v = vaddq_f32(vld1q_f32(velocity + i), vmulq_f32(acceleration4, dt));
+                vst1q_f32(velocity + i, v);
+                vst1q_f32(position + i, vaddq_f32(vld1q_f32(position + i), vmulq_f32(v, dt)));
+            }
+#endif
+            for (; i < count; ++i) {
+                velocity[i] += acceleration * stepSeconds[i];
+                position[i] += velocity[i] * stepSeconds[i];
+            }
+        }
+    }  // namespace
+
     void BodyInMotion::doSimulationStep(XrVector3f acceleration, XrTime predictedDisplayTime)
     {
         if (~this->velocity.velocityFlags & XR_SPACE_VELOCITY_LINEAR_VALID_BIT) {
@@ -51,4 +91,103 @@ namespace Conformance
             this->pose.orientation = newOrientation;
         }
     };
+
+    void BodiesInMotion::Add(const XrSpaceVelocity& velocity, const XrPosef& pose, XrTime time)
+    {
+        if (~velocity.velocityFlags & XR_SPACE_VELOCITY_LINEAR_VALID_BIT) {
+            throw std::logic_error("BodiesInMotion::Add called without valid linear velocity");
+        }
+
+        m_positionX.push_back(pose.position.x);
+        m_positionY.push_back(pose.position.y);
+        m_positionZ.push_back(pose.position.z);
+        m_velocityX.push_back(velocity.linearVelocity.x);
+        m_velocityY.push_back(velocity.linearVelocity.y);
+        m_velocityZ.push_back(velocity.linearVelocity.z);
+        m_orientations.push_back(pose.orientation);
+
+        XrVector3f angularAxis{0, 1, 0};
+        float radiansPerSecond = 0;
+        if (velocity.velocityFlags & XR_SPACE_VELOCITY_ANGULAR_VALID_BIT) {
+            radiansPerSecond = Vector::Length(velocity.angularVelocity);
+            angularAxis = velocity.angularVelocity;
+            Vector::Normalize(angularAxis);
+        }
+        m_angularAxes.push_back(angularAxis);
+        m_angularSpeeds.push_back(radiansPerSecond);
+
+        m_updateTimes.push_back(time);
+        m_createTimes.push_back(time);
+        m_stepSeconds.push_back(0);
+    }
+
+    void BodiesInMotion::RemoveOlderThan(XrTime time, XrDuration maxAge)
+    {
+        size_t kept = 0;
+        for (size_t i = 0; i < Size(); ++i) {
+            if (time - m_createTimes[i] > maxAge) {
+                continue;
+            }
+            if (kept != i) {
+                m_positionX[kept] = m_positionX[i];
+                m_positionY[kept] = m_positionY[i];
+                m_positionZ[kept] = m_positionZ[i];
+                m_velocityX[kept] = m_velocityX[i];
+                m_velocityY[kept] = m_velocityY[i];
+                m_velocityZ[kept] = m_velocityZ[i];
+                m_orientations[kept] = m_orientations[i];
+                m_angularAxes[kept] = m_angularAxes[i];
+                m_angularSpeeds[kept] = m_angularSpeeds[i];
+                m_updateTimes[kept] = m_updateTimes[i];
+                m_createTimes[kept] = m_createTimes[i];
+            }
+            ++kept;
+        }
+
+        for (auto* floats : {&m_positionX, &m_positionY, &m_positionZ, &m_velocityX, &m_velocityY, &m_velocityZ, &m_angularSpeeds,
+                             &m_stepSeconds}) {
+            floats->resize(kept);
+        }
+        m_orientations.resize(kept);
+        m_angularAxes.resize(kept);
+        m_updateTimes.resize(kept);
+        m_createTimes.resize(kept);
+    }
+
+    void BodiesInMotion::doSimulationStep(XrVector3f acceleration, XrTime predictedDisplayTime)
+    {
+        const size_t count = Size();
+        for (size_t i = 0; i < count; ++i) {
+            const XrDuration timeSinceLastTick = predictedDisplayTime - m_updateTimes[i];
+            if (timeSinceLastTick <= 0) {
+                throw std::logic_error("Unexpected old frame state predictedDisplayTime or future action state lastChangeTime");
+            }
+            m_updateTimes[i] = predictedDisplayTime;
+            m_stepSeconds[i] = timeSinceLastTick / (float)1'000'000'000;
+        }
+
+        IntegrateAxis(m_positionX.data(), m_velocityX.data(), m_stepSeconds.data(), acceleration.x, count);
+        IntegrateAxis(m_positionY.data(), m_velocityY.data(), m_stepSeconds.data(), acceleration.y, count);
+        IntegrateAxis(m_positionZ.data(), m_velocityZ.data(), m_stepSeconds.data(), acceleration.z, count);
+
+        for (size_t i = 0; i < count; ++i) {
+            if (m_angularSpeeds[i] != 0) {
+                m_orientations[i] = m_orientations[i] * Quat::FromAxisAngle(m_angularAxes[i], m_angularSpeeds[i] * m_stepSeconds[i]);
+            }
+        }
+    }
+
+    bool BodiesInMotion::AnyWithin(XrVector3f point, float distance) const
+    {
+        const float distanceSquared = distance * distance;
+        for (size_t i = 0; i < Size(); ++i) {
+            const float dx = m_positionX[i] - point.x;
+            const float dy = m_positionY[i] - point.y;
+            const float dz = m_positionZ[i] - point.z;
+            if (dx * dx + dy * dy + dz * dz < distanceSquared) {
+                return true;
+            }
+        }
+        return false;
+    }
 }  // namespace Conformance
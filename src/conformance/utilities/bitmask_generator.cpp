@@ -27,6 +27,7 @@
 #include <vector>
 #include <memory>
 #include <cstdint>
+#include <random>
 
 namespace Conformance
 {
@@ -105,15 +106,208 @@ namespace Conformance
             uint64_t current_ = 0;
         };
 
+        /*!
+         * GeneratorBase implementation for a covering subset of the BitmaskGenerator combinations - implementation details.
+         *
+         * @see bitmaskGenerator for the factory function to create one of these.
+         *
+         * Builds a covering array of strength t greedily up front: each "tuple" is a choice of t of the supplied bitmasks
+         * together with whether each of them is set, and rows (selections of bitmasks, as in BitmaskGenerator) are added
+         * until every tuple appears in some row, each time picking the candidate row that covers the most uncovered tuples.
+         */
+        class BitmaskCoveringGenerator : public GeneratorBase<uint64_t const&>
+        {
+        public:
+            ~BitmaskCoveringGenerator() override = default;
+
+            BitmaskCoveringGenerator(const BitmaskCoveringGenerator&) = delete;
+            BitmaskCoveringGenerator& operator=(const BitmaskCoveringGenerator&) = delete;
+            BitmaskCoveringGenerator(BitmaskCoveringGenerator&&) = delete;
+            BitmaskCoveringGenerator& operator=(BitmaskCoveringGenerator&&) = delete;
+
+            static std::unique_ptr<GeneratorBase<uint64_t const&>> create(bool zeroOk, uint32_t strength,
+                                                                        std::initializer_list<uint64_t> const& bits)
+            {
+                std::unique_ptr<BitmaskCoveringGenerator> generator(new BitmaskCoveringGenerator(zeroOk, strength, bits));
+                return generator;
+            }
+
+            BitmaskCoveringGenerator(bool zeroOk, uint32_t strength, std::initializer_list<uint64_t> const& bits) : bits_(bits)
+            {
+                BuildRows(zeroOk, strength);
+            }
+
+            uint64_t const& get() override
+            {
+                return current_;
+            }
+
+            bool next() override
+            {
+                if (nextRow_ >= rows_.size()) {
+                    return false;
+                }
+
+                // Each row selects bitmasks the same way as the index of BitmaskGenerator
+                uint64_t accumulate = 0;
+                for (size_t i = 0; i < bits_.size(); ++i) {
+                    if ((rows_[nextRow_] & (uint64_t(0x1) << i)) != 0) {
+                        accumulate |= bits_[i];
+                    }
+                }
+                current_ = accumulate;
+                nextRow_++;
+                return true;
+            }
+
+        private:
+            /// Past this many bitmasks, candidate rows are sampled rather than all tried.
+            static constexpr size_t kMaxExhaustiveCandidateBits = 12;
+            static constexpr size_t kSampledCandidateCount = 1024;
+
+            /// Index of the tuple that @p row covers for the columns of @p combination
+            size_t TupleIndex(size_t combination, uint64_t row) const
+            {
+                const std::vector<size_t>& columns = combinations_[combination];
+                size_t pattern = 0;
+                for (size_t j = 0; j < columns.size(); ++j) {
+                    if ((row & (uint64_t(0x1) << columns[j])) != 0) {
+                        pattern |= size_t(1) << j;
+                    }
+                }
+                return (combination << columns.size()) | pattern;
+            }
+
+            size_t CountNewlyCovered(uint64_t row) const
+            {
+                size_t count = 0;
+                for (size_t c = 0; c < combinations_.size(); ++c) {
+                    if (!covered_[TupleIndex(c, row)]) {
+                        count++;
+                    }
+                }
+                return count;
+            }
+
+            size_t AddRow(uint64_t row)
+            {
+                size_t newlyCovered = 0;
+                for (size_t c = 0; c < combinations_.size(); ++c) {
+                    size_t tuple = TupleIndex(c, row);
+                    if (!covered_[tuple]) {
+                        covered_[tuple] = true;
+                        newlyCovered++;
+                    }
+                }
+                rows_.push_back(row);
+                return newlyCovered;
+            }
+
+            void BuildRows(bool zeroOk, uint32_t strength)
+            {
+                const size_t n = bits_.size();
+                const uint64_t rowMask = n >= 64 ? ~uint64_t(0) : (uint64_t(0x1) << n) - 1;
+
+                // Every choice of `strength` columns, in lexicographic order
+                std::vector<size_t> columns(strength);
+                for (size_t j = 0; j < strength; ++j) {
+                    columns[j] = j;
+                }
+                while (true) {
+                    combinations_.push_back(columns);
+                    size_t j = strength;
+                    while (j > 0 && columns[j - 1] == n - strength + j - 1) {
+                        j--;
+                    }
+                    if (j == 0) {
+                        break;
+                    }
+                    columns[j - 1]++;
+                    for (size_t k = j; k < strength; ++k) {
+                        columns[k] = columns[k - 1] + 1;
+                    }
+                }
+                covered_.assign(combinations_.size() << strength, false);
+                size_t uncovered = covered_.size();
+
+                if (zeroOk) {
+                    uncovered -= AddRow(0);
+                }
+
+                const bool sampleCandidates = n > kMaxExhaustiveCandidateBits;
+                std::vector<uint64_t> candidates;
+                if (!sampleCandidates) {
+                    for (uint64_t row = zeroOk ? 0 : 1; row <= rowMask; ++row) {
+                        candidates.push_back(row);
+                    }
+                }
+
+                // A fixed seed keeps the generated values, and so the test sections, the same from run to run.
+                std::mt19937_64 random(n);
+                while (uncovered > 0) {
+                    if (sampleCandidates) {
+                        candidates.clear();
+                        for (size_t i = 0; i < kSampledCandidateCount; ++i) {
+                            candidates.push_back(random() & rowMask);
+                        }
+                    }
+
+                    uint64_t bestRow = 0;
+                    size_t bestCount = 0;
+                    for (uint64_t row : candidates) {
+                        size_t count = (row != 0 || zeroOk) ? CountNewlyCovered(row) : 0;
+                        if (count > bestCount) {
+                            bestRow = row;
+                            bestCount = count;
+                        }
+                    }
+
+                    if (bestCount == 0) {
+                        // No sampled candidate helps: build a row for the first uncovered tuple, with all other bitmasks set
+                        // so that it is not the 0 combination.
+                        size_t tuple = 0;
+                        while (covered_[tuple]) {
+                            tuple++;
+                        }
+                        bestRow = rowMask;
+                        const std::vector<size_t>& tupleColumns = combinations_[tuple >> strength];
+                        for (size_t j = 0; j < tupleColumns.size(); ++j) {
+                            if ((tuple & (size_t(1) << j)) == 0) {
+                                bestRow &= ~(uint64_t(0x1) << tupleColumns[j]);
+                            }
+                        }
+                    }
+                    uncovered -= AddRow(bestRow);
+                }
+            }
+
+            std::vector<uint64_t> bits_;
+            std::vector<std::vector<size_t>> combinations_;
+            std::vector<bool> covered_;
+            std::vector<uint64_t> rows_;
+            size_t nextRow_ = 0;
+            uint64_t current_ = 0;
+        };
+
+        std::unique_ptr<GeneratorBase<uint64_t const&>> createBitmaskGenerator(bool zeroOk, uint32_t strength,
+                                                                               std::initializer_list<uint64_t> const& bits)
+        {
+            // Covering every combination of all the bitmasks is the same as generating all combinations.
+            if (strength == 0 || strength >= bits.size()) {
+                return BitmaskGenerator::create(zeroOk, bits);
+            }
+            return BitmaskCoveringGenerator::create(zeroOk, strength, bits);
+        }
+
     }  // namespace
 
-    GeneratorWrapper<uint64_t const&> bitmaskGeneratorIncluding0(std::initializer_list<uint64_t> const& bits)
+    GeneratorWrapper<uint64_t const&> bitmaskGeneratorIncluding0(std::initializer_list<uint64_t> const& bits, uint32_t strength)
     {
-        return GeneratorWrapper<uint64_t const&>(BitmaskGenerator::create(true, bits));
+        return GeneratorWrapper<uint64_t const&>(createBitmaskGenerator(true, strength, bits));
     }
 
-    GeneratorWrapper<uint64_t const&> bitmaskGenerator(std::initializer_list<uint64_t> const& bits)
+    GeneratorWrapper<uint64_t const&> bitmaskGenerator(std::initializer_list<uint64_t> const& bits, uint32_t strength)
     {
-        return GeneratorWrapper<uint64_t const&>(BitmaskGenerator::create(false, bits));
+        return GeneratorWrapper<uint64_t const&>(createBitmaskGenerator(false, strength, bits));
     }
 }  // namespace Conformance
@@ -18,7 +18,8 @@
  * @file
  * @brief  Header providing a way to name bitmask bits,
  * combine names and descriptions,
- * and generate all combinations of bitmask bits.
+ * and generate all combinations of bitmask bits,
+ * or a covering subset of them.
  *
  * See the xrCreateSwapchain test for examples of usage.
  *
@@ -38,21 +39,27 @@ namespace Conformance
      * Generate all combinations of the supplied list of bitmasks,
      * including the 0 combination with none of the element (and thus bits).
      *
+     * If @p strength is nonzero and less than the number of bitmasks, only a covering subset of the combinations is generated
+     * instead: for any @p strength of the bitmasks, every combination of them being set or not appears in at least one
+     * generated value. Strength 2 (pairwise) covers every interaction between two flags in far fewer values than all of them.
+     * The 0 combination is still generated first.
+     *
      * @see bitmaskGenerator
      *
      * @ingroup cts_generators
      */
-    GeneratorWrapper<uint64_t const&> bitmaskGeneratorIncluding0(std::initializer_list<uint64_t> const& bits);
+    GeneratorWrapper<uint64_t const&> bitmaskGeneratorIncluding0(std::initializer_list<uint64_t> const& bits, uint32_t strength = 0);
 
     /*!
      * Generate all combinations of the supplied list of bitmasks that include at least one set element.
      *
      * This excludes the 0 combination.
+     * If @p strength is nonzero, only a covering subset is generated, as for bitmaskGeneratorIncluding0.
      *
      * @see bitmaskGeneratorIncluding0
      *
      * @ingroup cts_generators
      */
-    GeneratorWrapper<uint64_t const&> bitmaskGenerator(std::initializer_list<uint64_t> const& bits);
+    GeneratorWrapper<uint64_t const&> bitmaskGenerator(std::initializer_list<uint64_t> const& bits, uint32_t strength = 0);
 
 }  // namespace Conformance
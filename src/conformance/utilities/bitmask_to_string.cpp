@@ -9,20 +9,53 @@
 #include <openxr/openxr_reflection.h>
 
 #include <cstdint>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 
 namespace Conformance
 {
     namespace detail
     {
+        namespace
+        {
+            /// Remembers the formatted string of each value of one bitmask type, since tests capture the same few
+            /// values over and over (often inside loops, whether or not the assertion fails). Thread safe.
+            class BitmaskStringCache
+            {
+            public:
+                template <typename Formatter>
+                std::string Get(uint64_t value, Formatter &&format)
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    auto it = m_strings.find(value);
+                    if (it != m_strings.end()) {
+                        return it->second;
+                    }
+                    std::string str = format();
+                    if (m_strings.size() < kMaxEntries) {
+                        m_strings.emplace(value, str);
+                    }
+                    return str;
+                }
+
+            private:
+                /// Bounds the memory used if a test sweeps through arbitrary values.
+                static constexpr size_t kMaxEntries = 1024;
+
+                std::mutex m_mutex;
+                std::unordered_map<uint64_t, std::string> m_strings;
+            };
+        }  // namespace
 
 #define XRC_STRINGIFY_FLAG_BITS(FLAG, VAL) {FLAG, #FLAG},
 
-#define XRC_DEFINE_BIT_NAME_PAIR(FLAG)                                                   \
-    std::string BitmaskToString(XrFlags64 val, const FLAG##Tag &)                        \
-    {                                                                                    \
-        return BitmaskToStringImpl(val, {XR_LIST_BITS_##FLAG(XRC_STRINGIFY_FLAG_BITS)}); \
+#define XRC_DEFINE_BIT_NAME_PAIR(FLAG)                                                                                     \
+    std::string BitmaskToString(XrFlags64 val, const FLAG##Tag &)                                                          \
+    {                                                                                                                      \
+        static BitmaskStringCache cache;                                                                                   \
+        return cache.Get(val, [val] { return BitmaskToStringImpl(val, {XR_LIST_BITS_##FLAG(XRC_STRINGIFY_FLAG_BITS)}); }); \
     }
 
         XRC_FOR_EACH_WRAPPED_BITMASK_TYPE(XRC_DEFINE_BIT_NAME_PAIR)  // NOLINT(cert-err58-cpp)
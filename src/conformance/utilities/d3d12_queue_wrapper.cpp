@@ -25,7 +25,7 @@
 namespace Conformance
 {
     D3D12QueueWrapper::D3D12QueueWrapper(Microsoft::WRL::ComPtr<ID3D12Device> d3d12Device, D3D12_COMMAND_LIST_TYPE type)
-        : m_device(d3d12Device)
+        : m_device(d3d12Device), m_type(type)
     {
 
         D3D12_COMMAND_QUEUE_DESC queueDesc = {};
@@ -43,6 +43,7 @@ namespace Conformance
     D3D12QueueWrapper::~D3D12QueueWrapper()
     {
         CPUWaitOnFence();
+        m_recycledAllocators.clear();
         m_cmdQueue.Reset();
         m_fence.Reset();
         if (m_fenceEvent != INVALID_HANDLE_VALUE) {
@@ -77,14 +78,50 @@ namespace Conformance
         if (m_cpuWaited) {
             return;
         }
-        if (m_fence->GetCompletedValue() < m_fenceValue) {
-            if (m_fenceEvent == INVALID_HANDLE_VALUE) {
-                m_fenceEvent = CreateEventEx(nullptr, nullptr, 0, EVENT_ALL_ACCESS);
-            }
-            m_fence->SetEventOnCompletion(m_fenceValue, m_fenceEvent);
+        CPUWaitOnFenceValue(m_fenceValue);
+        m_cpuWaited = true;
+    }
+
+    void D3D12QueueWrapper::CPUWaitOnFenceValue(uint64_t fenceValue) const
+    {
+        if (m_fence->GetCompletedValue() < fenceValue) {
+            XRC_CHECK_THROW(m_fenceEvent != INVALID_HANDLE_VALUE);
+            XRC_CHECK_THROW_HRCMD(m_fence->SetEventOnCompletion(fenceValue, m_fenceEvent));
             WaitForSingleObject(m_fenceEvent, INFINITE);
         }
-        m_cpuWaited = true;
+    }
+
+    void D3D12QueueWrapper::SetMaxSubmissionsInFlight(uint32_t count)
+    {
+        XRC_CHECK_THROW(count >= 1);
+        m_maxSubmissionsInFlight = count;
+    }
+
+    void D3D12QueueWrapper::CPUWaitForSubmissionsInFlight() const
+    {
+        // Submission N signaled fence value N, so this leaves at most m_maxSubmissionsInFlight - 1 executing.
+        if (m_fenceValue >= m_maxSubmissionsInFlight) {
+            CPUWaitOnFenceValue(m_fenceValue - m_maxSubmissionsInFlight + 1);
+        }
+    }
+
+    Microsoft::WRL::ComPtr<ID3D12CommandAllocator> D3D12QueueWrapper::AcquireCommandAllocator()
+    {
+        Microsoft::WRL::ComPtr<ID3D12CommandAllocator> commandAllocator;
+        if (m_recycledAllocators.TryReuse(GetCompletedFenceValue(), commandAllocator)) {
+            XRC_CHECK_THROW_HRCMD(commandAllocator->Reset());
+            return commandAllocator;
+        }
+
+        XRC_CHECK_THROW_HRCMD(m_device->CreateCommandAllocator(m_type, __uuidof(ID3D12CommandAllocator),
+                                                               reinterpret_cast<void**>(commandAllocator.ReleaseAndGetAddressOf())));
+        XRC_CHECK_THROW_HRCMD(commandAllocator->SetName(L"CTS pooled command allocator"));
+        return commandAllocator;
+    }
+
+    void D3D12QueueWrapper::RecycleCommandAllocator(Microsoft::WRL::ComPtr<ID3D12CommandAllocator> commandAllocator)
+    {
+        m_recycledAllocators.PushResource(m_fenceValue, std::move(commandAllocator));
     }
 
     void D3D12QueueWrapper::GPUWaitOnOtherFence(ID3D12Fence* otherFence, uint64_t otherFenceValue)
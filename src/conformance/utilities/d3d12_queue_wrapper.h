@@ -16,6 +16,8 @@
 
 #if defined(XR_USE_GRAPHICS_API_D3D12)
 
+#include "destruction_queue.h"
+
 #include <d3d12.h>
 #include <wrl/client.h>  // For Microsoft::WRL::ComPtr
 
@@ -24,7 +26,10 @@
 
 namespace Conformance
 {
-    /// Wraps a command queue, a fence, and the value last signaled for the fence
+    /// Wraps a command queue, a fence, and the value last signaled for the fence.
+    ///
+    /// Also pools command allocators by the fence value of their last submission, so that callers that do not CPU wait
+    /// after each submission can still reuse allocators safely.
     class D3D12QueueWrapper
     {
     public:
@@ -38,6 +43,27 @@ namespace Conformance
         /// CPU wait on the most recently-signaled fence value
         void CPUWaitOnFence();
 
+        /// CPU wait until the fence has reached @p fenceValue
+        void CPUWaitOnFenceValue(uint64_t fenceValue) const;
+
+        /// Set how many submissions @ref CPUWaitForSubmissionsInFlight lets execute at once. Must be at least 1.
+        void SetMaxSubmissionsInFlight(uint32_t count);
+
+        uint32_t GetMaxSubmissionsInFlight() const
+        {
+            return m_maxSubmissionsInFlight;
+        }
+
+        /// CPU wait until fewer than the maximum number of submissions are still executing, so another may be recorded.
+        void CPUWaitForSubmissionsInFlight() const;
+
+        /// Get a reset command allocator, reusing a recycled one whose last submission has completed if there is one.
+        Microsoft::WRL::ComPtr<ID3D12CommandAllocator> AcquireCommandAllocator();
+
+        /// Hand back an allocator from @ref AcquireCommandAllocator after executing the command lists recorded with it.
+        /// It is reused once the most recently signaled fence value completes.
+        void RecycleCommandAllocator(Microsoft::WRL::ComPtr<ID3D12CommandAllocator> commandAllocator);
+
         /// GPU wait in this queue on some other fence
         void GPUWaitOnOtherFence(ID3D12Fence* otherFence, uint64_t otherFenceValue);
 
@@ -72,11 +98,15 @@ namespace Conformance
 
     private:
         Microsoft::WRL::ComPtr<ID3D12Device> m_device;
+        D3D12_COMMAND_LIST_TYPE m_type;
         Microsoft::WRL::ComPtr<ID3D12CommandQueue> m_cmdQueue;
         Microsoft::WRL::ComPtr<ID3D12Fence> m_fence;
         mutable uint64_t m_fenceValue = 0;
         mutable bool m_cpuWaited = true;
         HANDLE m_fenceEvent = INVALID_HANDLE_VALUE;
+        uint32_t m_maxSubmissionsInFlight = 1;
+        /// Recycled allocators, keyed by the fence value after which each is free
+        DestructionQueue<Microsoft::WRL::ComPtr<ID3D12CommandAllocator>> m_recycledAllocators;
     };
 }  // namespace Conformance
 
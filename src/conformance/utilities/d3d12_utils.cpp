@@ -7,11 +7,17 @@
 #include "d3d12_utils.h"
 
 #include "align_to.h"
+#include "d3d12_queue_wrapper.h"
+#include "file_utils.h"
 #include "throw_helpers.h"
 
 #include <d3d12.h>
+#include <dxgi.h>
 #include <wrl/client.h>  // For Microsoft::WRL::ComPtr
 
+#include <algorithm>
+#include <stdio.h>
+
 using Microsoft::WRL::ComPtr;
 
 namespace Conformance
@@ -25,6 +31,9 @@ namespace Conformance
             d3d12ResourceState = D3D12_RESOURCE_STATE_GENERIC_READ;
             width = AlignTo<D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT>(width);
         }
+        else if (heapType == D3D12_HEAP_TYPE_READBACK) {
+            d3d12ResourceState = D3D12_RESOURCE_STATE_COPY_DEST;
+        }
         else {
             d3d12ResourceState = D3D12_RESOURCE_STATE_COMMON;
         }
@@ -66,5 +75,279 @@ namespace Conformance
         return D3D12CreateResource(d3d12Device, width, height, arraySize, mipLevels, D3D12_RESOURCE_DIMENSION_TEXTURE2D, format,
                                    D3D12_TEXTURE_LAYOUT_UNKNOWN, heapType);
     }
+
+    namespace
+    {
+        uint64_t AlignUp(uint64_t n, uint64_t alignment)
+        {
+            return (n + alignment - 1) / alignment * alignment;
+        }
+    }  // namespace
+
+    ComPtr<ID3D12Resource> D3D12PlacedBufferAllocator::CreateBuffer(uint64_t size)
+    {
+        D3D12_RESOURCE_DESC buffDesc{};
+        buffDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+        buffDesc.Alignment = 0;
+        buffDesc.Width = size;
+        buffDesc.Height = 1;
+        buffDesc.DepthOrArraySize = 1;
+        buffDesc.MipLevels = 1;
+        buffDesc.Format = DXGI_FORMAT_UNKNOWN;
+        buffDesc.SampleDesc.Count = 1;
+        buffDesc.SampleDesc.Quality = 0;
+        buffDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+        buffDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+        const D3D12_RESOURCE_ALLOCATION_INFO allocationInfo = m_device->GetResourceAllocationInfo(0, 1, &buffDesc);
+        uint64_t offset = AlignUp(m_offset, allocationInfo.Alignment);
+        if (m_heaps.empty() || offset + allocationInfo.SizeInBytes > m_heaps.back()->GetDesc().SizeInBytes) {
+            D3D12_HEAP_DESC heapDesc{};
+            heapDesc.SizeInBytes = std::max(DefaultHeapSize, AlignUp(allocationInfo.SizeInBytes, allocationInfo.Alignment));
+            heapDesc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
+            heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+            heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+            ComPtr<ID3D12Heap> heap;
+            XRC_CHECK_THROW_HRCMD(
+                m_device->CreateHeap(&heapDesc, __uuidof(ID3D12Heap), reinterpret_cast<void**>(heap.ReleaseAndGetAddressOf())));
+            XRC_CHECK_THROW_HRCMD(heap->SetName(L"CTS placed buffer heap"));
+            m_heaps.push_back(std::move(heap));
+            offset = 0;
+        }
+
+        ComPtr<ID3D12Resource> buffer;
+        XRC_CHECK_THROW_HRCMD(m_device->CreatePlacedResource(m_heaps.back().Get(), offset, &buffDesc, D3D12_RESOURCE_STATE_COMMON, nullptr,
+                                                             __uuidof(ID3D12Resource),
+                                                             reinterpret_cast<void**>(buffer.ReleaseAndGetAddressOf())));
+        m_offset = offset + allocationInfo.SizeInBytes;
+        return buffer;
+    }
+
+    D3D12FencedRing::D3D12FencedRing(std::shared_ptr<D3D12QueueWrapper> queueWrapper, uint64_t capacity)
+        : m_queueWrapper(std::move(queueWrapper)), m_capacity(capacity)
+    {
+    }
+
+    void D3D12FencedRing::Reclaim(uint64_t size)
+    {
+        while (!m_inFlight.empty() && m_inFlight.front().first <= m_queueWrapper->GetCompletedFenceValue()) {
+            m_used -= m_inFlight.front().second;
+            m_inFlight.pop_front();
+        }
+        while (m_used > 0 && m_capacity - m_used < size) {
+            // Allocations not yet submitted cannot be waited for.
+            XRC_CHECK_THROW_MSG(!m_inFlight.empty(), "Ring is full of allocations that have not been submitted");
+            m_queueWrapper->CPUWaitOnFenceValue(m_inFlight.front().first);
+            m_used -= m_inFlight.front().second;
+            m_inFlight.pop_front();
+        }
+    }
+
+    uint64_t D3D12FencedRing::Allocate(uint64_t size, uint64_t alignment)
+    {
+        XRC_CHECK_THROW_MSG(size <= m_capacity, "Allocation is larger than the ring");
+
+        // Units taken from m_head onwards, including alignment padding, or the end of the ring when wrapping around.
+        auto place = [&](uint64_t& offset) {
+            offset = AlignUp(m_head, alignment);
+            if (offset + size > m_capacity) {
+                offset = 0;
+                return m_capacity - m_head + size;
+            }
+            return offset + size - m_head;
+        };
+
+        Reclaim(0);
+        uint64_t offset;
+        uint64_t used = place(offset);
+        Reclaim(used);
+        if (m_used == 0) {
+            // Everything was released, so start again from the beginning of the ring.
+            m_head = 0;
+            used = place(offset);
+        }
+        m_used += used;
+        m_pending += used;
+        m_head = offset + size;
+        return offset;
+    }
+
+    void D3D12FencedRing::Submitted(uint64_t fenceValue)
+    {
+        if (m_pending == 0) {
+            return;
+        }
+        m_inFlight.emplace_back(fenceValue, m_pending);
+        m_pending = 0;
+    }
+
+    void D3D12FencedRing::WaitIdleAndResize(uint64_t capacity)
+    {
+        XRC_CHECK_THROW_MSG(m_pending == 0, "Ring cannot be resized while it has allocations that have not been submitted");
+        m_queueWrapper->CPUWaitOnFence();
+        m_inFlight.clear();
+        m_capacity = capacity;
+        m_head = 0;
+        m_used = 0;
+    }
+
+    D3D12UploadRing::D3D12UploadRing(ID3D12Device* device, std::shared_ptr<D3D12QueueWrapper> queueWrapper, uint64_t capacity)
+        : m_device(device)
+    {
+        CreateBuffer(capacity);
+        m_ring = D3D12FencedRing(std::move(queueWrapper), m_buffer->GetDesc().Width);
+    }
+
+    void D3D12UploadRing::CreateBuffer(uint64_t capacity)
+    {
+        m_buffer = D3D12CreateBuffer(m_device.Get(), (uint32_t)capacity, D3D12_HEAP_TYPE_UPLOAD);
+        XRC_CHECK_THROW_HRCMD(m_buffer->SetName(L"CTS upload ring"));
+        // Upload heaps may stay mapped for as long as the resource lives; the CPU never reads them.
+        const D3D12_RANGE readRange{0, 0};
+        XRC_CHECK_THROW_HRCMD(m_buffer->Map(0, &readRange, reinterpret_cast<void**>(&m_cpuAddress)));
+    }
+
+    D3D12UploadRing::Allocation D3D12UploadRing::Allocate(uint64_t size, uint64_t alignment)
+    {
+        if (size > m_ring.GetCapacity()) {
+            // Replace the buffer with one large enough, once nothing in flight reads the old one.
+            const uint64_t capacity = std::max(size, 2 * m_ring.GetCapacity());
+            m_ring.WaitIdleAndResize(capacity);
+            CreateBuffer(capacity);
+        }
+
+        const uint64_t offset = m_ring.Allocate(size, alignment);
+        return Allocation{m_buffer.Get(), offset, m_cpuAddress + offset, m_buffer->GetGPUVirtualAddress() + offset};
+    }
+
+    D3D12DescriptorRing::D3D12DescriptorRing(ID3D12Device* device, std::shared_ptr<D3D12QueueWrapper> queueWrapper,
+                                             D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t capacity)
+        : m_ring(std::move(queueWrapper), capacity)
+    {
+        D3D12_DESCRIPTOR_HEAP_DESC heapDesc{};
+        heapDesc.Type = type;
+        heapDesc.NumDescriptors = capacity;
+        heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+        XRC_CHECK_THROW_HRCMD(device->CreateDescriptorHeap(&heapDesc, __uuidof(ID3D12DescriptorHeap),
+                                                           reinterpret_cast<void**>(m_heap.ReleaseAndGetAddressOf())));
+        XRC_CHECK_THROW_HRCMD(m_heap->SetName(L"CTS descriptor ring"));
+        m_descriptorSize = device->GetDescriptorHandleIncrementSize(type);
+    }
+
+    D3D12DescriptorRing::Allocation D3D12DescriptorRing::Allocate(uint32_t count)
+    {
+        const uint64_t offset = m_ring.Allocate(count);
+        D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle = m_heap->GetCPUDescriptorHandleForHeapStart();
+        cpuHandle.ptr += (SIZE_T)(offset * m_descriptorSize);
+        D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle = m_heap->GetGPUDescriptorHandleForHeapStart();
+        gpuHandle.ptr += offset * m_descriptorSize;
+        return Allocation{cpuHandle, gpuHandle};
+    }
+
+    namespace
+    {
+        /// Unique per adapter and driver version, since a driver update invalidates the library anyway.
+        std::string PipelineLibraryFileName(IDXGIAdapter1* adapter)
+        {
+            DXGI_ADAPTER_DESC1 desc{};
+            XRC_CHECK_THROW_HRCMD(adapter->GetDesc1(&desc));
+            LARGE_INTEGER driverVersion{};
+            // This is the documented way of getting the user mode driver version, despite the name.
+            if (FAILED(adapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &driverVersion))) {
+                driverVersion.QuadPart = 0;
+            }
+            char name[128];
+            snprintf(name, sizeof(name), "cts_d3d12_pipeline_library_%08x_%08x_%08x_%08x_%016llx.bin", desc.VendorId, desc.DeviceId,
+                     desc.SubSysId, desc.Revision, (unsigned long long)driverVersion.QuadPart);
+            return name;
+        }
+    }  // namespace
+
+    D3D12PipelineLibrary::~D3D12PipelineLibrary()
+    {
+        Reset();
+    }
+
+    void D3D12PipelineLibrary::Init(ID3D12Device* device, IDXGIAdapter1* adapter, const std::string& directory)
+    {
+        Reset();
+        m_device = device;
+
+        ComPtr<ID3D12Device1> device1;
+        if (FAILED(device->QueryInterface(__uuidof(ID3D12Device1), reinterpret_cast<void**>(device1.ReleaseAndGetAddressOf())))) {
+            return;
+        }
+
+        const std::string fileName = PipelineLibraryFileName(adapter);
+        if (fileName != m_fileName || directory != m_directory) {
+            m_fileName = fileName;
+            m_directory = directory;
+            m_data.clear();
+            if (!m_directory.empty()) {
+                ReadFileBytes(GetPath(), &m_data);
+            }
+        }
+
+        HRESULT hr = E_FAIL;
+        if (!m_data.empty()) {
+            // Fails with e.g. D3D12_ERROR_DRIVER_VERSION_MISMATCH if the data is stale, in which case we start over.
+            hr = device1->CreatePipelineLibrary(m_data.data(), m_data.size(), __uuidof(ID3D12PipelineLibrary),
+                                                reinterpret_cast<void**>(m_library.ReleaseAndGetAddressOf()));
+        }
+        if (FAILED(hr)) {
+            m_data.clear();
+            hr = device1->CreatePipelineLibrary(nullptr, 0, __uuidof(ID3D12PipelineLibrary),
+                                                reinterpret_cast<void**>(m_library.ReleaseAndGetAddressOf()));
+        }
+        if (FAILED(hr)) {
+            // e.g. DXGI_ERROR_UNSUPPORTED: fall back to creating pipeline states directly.
+            m_library.Reset();
+            return;
+        }
+        XRC_CHECK_THROW_HRCMD(m_library->SetName(L"CTS pipeline library"));
+    }
+
+    ComPtr<ID3D12PipelineState> D3D12PipelineLibrary::GetOrCreateGraphicsPipelineState(const std::wstring& name,
+                                                                                      const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc)
+    {
+        ComPtr<ID3D12PipelineState> pipelineState;
+        if (m_library &&
+            SUCCEEDED(m_library->LoadGraphicsPipeline(name.c_str(), &desc, __uuidof(ID3D12PipelineState),
+                                                      reinterpret_cast<void**>(pipelineState.ReleaseAndGetAddressOf())))) {
+            return pipelineState;
+        }
+
+        XRC_CHECK_THROW_HRCMD(m_device->CreateGraphicsPipelineState(&desc, __uuidof(ID3D12PipelineState),
+                                                                    reinterpret_cast<void**>(pipelineState.ReleaseAndGetAddressOf())));
+        // Fails if the name is already taken by a different desc (e.g. after a shader change); that one just stays uncached.
+        if (m_library && SUCCEEDED(m_library->StorePipeline(name.c_str(), pipelineState.Get()))) {
+            m_modified = true;
+        }
+        return pipelineState;
+    }
+
+    void D3D12PipelineLibrary::Reset()
+    {
+        if (m_library && m_modified) {
+            std::vector<uint8_t> data(m_library->GetSerializedSize());
+            if (!data.empty() && SUCCEEDED(m_library->Serialize(data.data(), data.size()))) {
+                // Only now that it has been serialized may the library's initial data go away.
+                m_library.Reset();
+                m_data.swap(data);
+                // Best effort: a library that cannot be written just means the next run starts cold.
+                if (!m_directory.empty()) {
+                    WriteFileAtomically(GetPath(), m_data);
+                }
+            }
+        }
+        m_library.Reset();
+        m_modified = false;
+        m_device.Reset();
+    }
+
+    std::string D3D12PipelineLibrary::GetPath() const
+    {
+        return m_directory + "/" + m_fileName;
+    }
 }  // namespace Conformance
 #endif
@@ -9,12 +9,20 @@
 #include "utilities/throw_helpers.h"
 
 #include <d3d12.h>
+#include <dxgi.h>
 #include <wrl/client.h>  // For Microsoft::WRL::ComPtr
 
 #include <cassert>
+#include <deque>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
 
 namespace Conformance
 {
+    class D3D12QueueWrapper;
+
     Microsoft::WRL::ComPtr<ID3D12Resource> D3D12CreateResource(ID3D12Device* d3d12Device, uint32_t width, uint32_t height, uint16_t depth,
                                                                D3D12_RESOURCE_DIMENSION dimension, DXGI_FORMAT format,
                                                                D3D12_TEXTURE_LAYOUT layout, D3D12_HEAP_TYPE heapType);
@@ -102,6 +110,200 @@ namespace Conformance
             return count * sizeof(T);
         }
     };
+
+    /// Places buffers in default heaps that are allocated in large blocks, instead of creating a committed resource for each.
+    ///
+    /// Allocation only moves forward through the current heap, so the memory of a buffer is only reclaimed when the whole
+    /// allocator is released: it is meant for buffers that live as long as the device, such as those of meshes.
+    class D3D12PlacedBufferAllocator
+    {
+    public:
+        /// Size of each heap, unless a buffer needs a larger one
+        static constexpr uint64_t DefaultHeapSize = 16 * 1024 * 1024;
+
+        D3D12PlacedBufferAllocator() = default;
+        explicit D3D12PlacedBufferAllocator(ID3D12Device* device) : m_device(device)
+        {
+        }
+
+        /// Create a buffer of @p size bytes in the common state, which can be written with copies and read as any kind of buffer.
+        Microsoft::WRL::ComPtr<ID3D12Resource> CreateBuffer(uint64_t size);
+
+    private:
+        Microsoft::WRL::ComPtr<ID3D12Device> m_device;
+        std::vector<Microsoft::WRL::ComPtr<ID3D12Heap>> m_heaps;
+        /// Offset of the free space in the last heap in m_heaps
+        uint64_t m_offset{0};
+    };
+
+    /// The bookkeeping of a ring of some number of units (bytes or descriptors) that is sub-allocated in order, where each
+    /// allocation is released once the submission reading it completes on a D3D12QueueWrapper.
+    class D3D12FencedRing
+    {
+    public:
+        D3D12FencedRing() = default;
+        D3D12FencedRing(std::shared_ptr<D3D12QueueWrapper> queueWrapper, uint64_t capacity);
+
+        uint64_t GetCapacity() const
+        {
+            return m_capacity;
+        }
+
+        /// Allocate @p size units aligned to @p alignment, CPU waiting on the queue for earlier allocations to be released
+        /// if the ring is full.
+        /// @return the offset of the allocation
+        uint64_t Allocate(uint64_t size, uint64_t alignment = 1);
+
+        /// Mark the allocations made since the last call as read by the submission that signals @p fenceValue.
+        void Submitted(uint64_t fenceValue);
+
+        /// CPU wait for every allocation to be released, then change the capacity. Nothing may be allocated but not submitted.
+        void WaitIdleAndResize(uint64_t capacity);
+
+    private:
+        /// Release the allocations of completed submissions, and CPU wait on more until @p size units are free.
+        void Reclaim(uint64_t size);
+
+        std::shared_ptr<D3D12QueueWrapper> m_queueWrapper;
+        uint64_t m_capacity{0};
+        /// Offset of the next allocation
+        uint64_t m_head{0};
+        /// Units in use, including padding, from the oldest allocation up to m_head
+        uint64_t m_used{0};
+        /// Units used since the last call to Submitted
+        uint64_t m_pending{0};
+        /// Units used by each submission still in flight, with the fence value it signals, in submission order
+        std::deque<std::pair<uint64_t, uint64_t>> m_inFlight;
+    };
+
+    /// A persistently mapped upload buffer, sub-allocated in order for transient uploads and recycled as the submissions
+    /// reading each allocation complete on a D3D12QueueWrapper.
+    class D3D12UploadRing
+    {
+    public:
+        /// Default capacity, grown when a single allocation needs more
+        static constexpr uint64_t DefaultCapacity = 32 * 1024 * 1024;
+
+        struct Allocation
+        {
+            ID3D12Resource* resource;
+            uint64_t offset;
+            uint8_t* cpuAddress;
+            D3D12_GPU_VIRTUAL_ADDRESS gpuAddress;
+        };
+
+        D3D12UploadRing() = default;
+        D3D12UploadRing(ID3D12Device* device, std::shared_ptr<D3D12QueueWrapper> queueWrapper, uint64_t capacity = DefaultCapacity);
+        D3D12UploadRing(const D3D12UploadRing&) = delete;
+        D3D12UploadRing& operator=(const D3D12UploadRing&) = delete;
+        D3D12UploadRing(D3D12UploadRing&&) = default;
+        D3D12UploadRing& operator=(D3D12UploadRing&&) = default;
+
+        /// Allocate @p size bytes aligned to @p alignment, CPU waiting on the queue for earlier allocations to be released
+        /// if the ring is full. The allocation may be written until the next call to @ref Submitted.
+        Allocation Allocate(uint64_t size, uint64_t alignment = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+
+        /// Mark the allocations made since the last call as read by the submission that signals @p fenceValue.
+        void Submitted(uint64_t fenceValue)
+        {
+            m_ring.Submitted(fenceValue);
+        }
+
+    private:
+        void CreateBuffer(uint64_t capacity);
+
+        Microsoft::WRL::ComPtr<ID3D12Device> m_device;
+        Microsoft::WRL::ComPtr<ID3D12Resource> m_buffer;
+        uint8_t* m_cpuAddress{nullptr};
+        D3D12FencedRing m_ring;
+    };
+
+    /// A shader-visible descriptor heap, sub-allocated in order for the descriptor tables of draws and recycled as the
+    /// submissions using each table complete on a D3D12QueueWrapper.
+    ///
+    /// The heap never changes, so that it only needs to be set on a command list once. Allocations that are not yet
+    /// submitted cannot be recycled, so a single command list may use at most the capacity of the ring.
+    class D3D12DescriptorRing
+    {
+    public:
+        struct Allocation
+        {
+            D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle;
+            D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle;
+        };
+
+        D3D12DescriptorRing() = default;
+        D3D12DescriptorRing(ID3D12Device* device, std::shared_ptr<D3D12QueueWrapper> queueWrapper, D3D12_DESCRIPTOR_HEAP_TYPE type,
+                            uint32_t capacity);
+
+        ID3D12DescriptorHeap* GetHeap() const
+        {
+            return m_heap.Get();
+        }
+
+        /// Get the offset between consecutive descriptors in the heap.
+        UINT GetDescriptorSize() const
+        {
+            return m_descriptorSize;
+        }
+
+        /// Allocate @p count consecutive descriptors, CPU waiting on the queue for earlier allocations to be released if the
+        /// ring is full. The descriptors may be written until the next call to @ref Submitted.
+        Allocation Allocate(uint32_t count);
+
+        /// Mark the allocations made since the last call as used by the submission that signals @p fenceValue.
+        void Submitted(uint64_t fenceValue)
+        {
+            m_ring.Submitted(fenceValue);
+        }
+
+    private:
+        Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_heap;
+        UINT m_descriptorSize{0};
+        D3D12FencedRing m_ring;
+    };
+
+    /// An ID3D12PipelineLibrary whose contents outlive the device it was created on.
+    ///
+    /// The D3D12 plugin creates a new device for every session, so the serialized library is kept here between devices,
+    /// and if a directory is given also loaded from and saved to a file there (one per adapter and driver version), so
+    /// that later runs start with warm pipeline states too. If the device does not support pipeline libraries, pipeline
+    /// states are simply created directly.
+    class D3D12PipelineLibrary
+    {
+    public:
+        D3D12PipelineLibrary() = default;
+        D3D12PipelineLibrary(const D3D12PipelineLibrary&) = delete;
+        D3D12PipelineLibrary& operator=(const D3D12PipelineLibrary&) = delete;
+
+        ~D3D12PipelineLibrary();
+
+        /// Create the library on @p device, seeded with the contents saved by the last device on the same adapter and driver,
+        /// or failing that from the library file in @p directory (may be empty for no file).
+        void Init(ID3D12Device* device, IDXGIAdapter1* adapter, const std::string& directory);
+
+        /// Load the pipeline state stored under @p name, or create it from @p desc and store it.
+        ///
+        /// @p name must uniquely identify @p desc (apart from the root signature, which is not stored in the library)
+        /// within this process, e.g. by encoding the permutation of state that the caller varies.
+        Microsoft::WRL::ComPtr<ID3D12PipelineState> GetOrCreateGraphicsPipelineState(const std::wstring& name,
+                                                                                     const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc);
+
+        /// Save the contents of the library for the next @ref Init (and to the library file, if any), then release it.
+        void Reset();
+
+    private:
+        std::string GetPath() const;
+
+        Microsoft::WRL::ComPtr<ID3D12Device> m_device;
+        Microsoft::WRL::ComPtr<ID3D12PipelineLibrary> m_library;
+        /// Whether anything was stored in m_library since it was created, i.e. whether it needs to be saved.
+        bool m_modified{false};
+        std::string m_directory;
+        std::string m_fileName;
+        /// The serialized library: must stay alive and unchanged for as long as m_library, which refers to it.
+        std::vector<uint8_t> m_data;
+    };
 }  // namespace Conformance
 
 #endif
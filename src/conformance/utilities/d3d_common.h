@@ -21,7 +21,8 @@
 
 namespace Conformance
 {
-    struct ModelConstantBuffer
+    /// Per-instance vertex data of ShaderHlsl. Model is stored untransposed, as the shader reads it a row at a time.
+    struct MeshInstance
     {
         DirectX::XMFLOAT4X4 Model;
         DirectX::XMFLOAT4 TintColor;
@@ -40,10 +41,12 @@ namespace Conformance
     struct Vertex {
         float3 Pos : POSITION;
         float3 Color : COLOR0;
-    };
-    cbuffer ModelConstantBuffer : register(b0) {
-        float4x4 Model;
-        float4 TintColor;
+        // Per instance
+        float4 Model0 : MODEL0;
+        float4 Model1 : MODEL1;
+        float4 Model2 : MODEL2;
+        float4 Model3 : MODEL3;
+        float4 TintColor : TINTCOLOR;
     };
     cbuffer ViewProjectionConstantBuffer : register(b1) {
         float4x4 ViewProjection;
@@ -51,8 +54,9 @@ namespace Conformance
 
     PSVertex MainVS(Vertex input) {
        PSVertex output;
-       output.Pos = mul(mul(float4(input.Pos, 1), Model), ViewProjection);
-       output.Color = lerp(input.Color, TintColor.rgb, TintColor.a);
+       float4x4 model = float4x4(input.Model0, input.Model1, input.Model2, input.Model3);
+       output.Pos = mul(mul(float4(input.Pos, 1), model), ViewProjection);
+       output.Color = lerp(input.Color, input.TintColor.rgb, input.TintColor.a);
        return output;
     }
 
@@ -15,49 +15,49 @@
 // limitations under the License.
 #pragma once
 
-#include <queue>
+#include <algorithm>
+#include <deque>
 #include <stdint.h>
+#include <utility>
+#include <vector>
 
 namespace Conformance
 {
-    /// Tracks some kind of owned resource and the corresponding fence value at which it can be released.
+    /// Tracks some kind of owned resource and the corresponding fence value at which it can be released or reused.
+    ///
+    /// One queue follows one fence timeline: a D3D12 fence, or the submission count of a Vulkan queue. The GPU completes
+    /// fence values in order, so the resources are kept in a ring in fence value order, and releasing or reusing them only
+    /// ever looks at the front.
     template <typename OwnedResource>
     class DestructionQueue
     {
     public:
         /// Push some thing you can de-allocate following a fence value.
         ///
-        /// Move your ownership into this method, and the container will release it at some future @ref ReleaseForFenceValue call
+        /// Move your ownership into this method, and the container will release it at some future @ref ReleaseForFenceValue call,
+        /// or hand it back from @ref TryReuse.
         ///
         /// @param fenceValue the fence value you signaled after finishing use of the resources
         /// @param resource a resource owner
         void PushResource(uint64_t fenceValue, OwnedResource&& resource)
         {
-            resourcesAwaitingDestruction.emplace(fenceValue, std::move(resource));
+            if (m_entries.empty() || m_entries.back().fenceValue <= fenceValue) {
+                m_entries.emplace_back(fenceValue, std::move(resource));
+                return;
+            }
+            // Out of order, which callers following one timeline should not need: keep the ring sorted anyway.
+            auto it = std::upper_bound(m_entries.begin(), m_entries.end(), fenceValue,
+                                       [](uint64_t value, const QueueEntry& entry) { return value < entry.fenceValue; });
+            m_entries.emplace(it, fenceValue, std::move(resource));
         }
 
-        // /// Push more than one thing to de-allocate after a fence value.
-        // ///
-        // /// @param fenceValue the fence value you signaled after finishing use of the resources
-        // /// @param begin the begin iterator
-        // /// @param end the past-the-end iterator
-        // ///
-        // /// The iterator arguments match the conventional usage of std::begin/std::end, std::vector::begin/std::vector::end, etc.
-        // template <typename It>
-        // void PushResources(uint64_t fenceValue, It begin, It end)
-        // {
-        //     for (; begin != end; ++begin) {
-        //         PushResource(fenceValue, std::move(*begin));
-        //     }
-        // }
-
         /// Push more than one thing to de-allocate after a fence value.
         ///
         /// @param fenceValue the fence value you signaled after finishing use of the resources
         /// @param resources the resources in a vector you move in
         void PushResources(uint64_t fenceValue, std::vector<OwnedResource>&& resources)
         {
-            for (auto res : resources) {
+            for (auto& res : resources) {
                 PushResource(fenceValue, std::move(res));
             }
         }
@@ -67,9 +67,29 @@ namespace Conformance
         /// @param completedFenceValue the completed fence value from the fence.
         void ReleaseForFenceValue(uint64_t completedFenceValue)
         {
-            while (!resourcesAwaitingDestruction.empty() && resourcesAwaitingDestruction.top().fenceValue <= completedFenceValue) {
-                resourcesAwaitingDestruction.pop();
+            while (!m_entries.empty() && m_entries.front().fenceValue <= completedFenceValue) {
+                m_entries.pop_front();
+            }
+        }
+
+        /// Take back the oldest resource whose fence value has completed, to recycle it instead of creating another.
+        ///
+        /// @param completedFenceValue the completed fence value from the fence.
+        /// @param resource receives the resource if there is one
+        /// @return false, leaving @p resource alone, if no resource is free yet
+        bool TryReuse(uint64_t completedFenceValue, OwnedResource& resource)
+        {
+            if (m_entries.empty() || m_entries.front().fenceValue > completedFenceValue) {
+                return false;
             }
+            resource = std::move(m_entries.front().resource);
+            m_entries.pop_front();
+            return true;
+        }
+
+        bool Empty() const
+        {
+            return m_entries.empty();
         }
 
     private:
@@ -83,17 +103,7 @@ namespace Conformance
             }
         };
 
-        struct QueueLater
-        {
-            /// true if lhs will be ready later than rhs
-            bool operator()(const QueueEntry& lhs, const QueueEntry& rhs) const noexcept
-            {
-                return lhs.fenceValue > rhs.fenceValue;
-            }
-        };
-
-        // Priority queue is a "max queue" that uses std::less by default: the comparison functor returns true if LHS is "lower priority" (later in array, etc) than RHS
-        // todo: consider wrapping deque here instead of vector
-        std::priority_queue<QueueEntry, std::vector<QueueEntry>, QueueLater /* std::greater<QueueEntry> */> resourcesAwaitingDestruction;
+        /// In increasing fence value order
+        std::deque<QueueEntry> m_entries;
     };
 }  // namespace Conformance
@@ -17,47 +17,227 @@
 #include "event_reader.h"
 
 #include "throw_helpers.h"
+#include "trace.h"
 
 #include <openxr/openxr.h>
 
+#include <algorithm>
+#include <stdexcept>
+
 namespace Conformance
 {
+    namespace
+    {
+        /// How often a waiting reader polls for itself when there is no background polling thread.
+        constexpr std::chrono::milliseconds kSelfPollInterval{1};
+    }  // namespace
+
+    constexpr size_t EventQueue::DefaultCapacity;
+
+    EventQueue::EventQueue(XrInstance instance, size_t capacity) : m_instance(instance), m_capacity(std::max<size_t>(capacity, 1))
+    {
+    }
+
+    EventQueue::~EventQueue()
+    {
+        StopBackgroundPolling();
+    }
+
+    void EventQueue::StartBackgroundPolling(std::chrono::milliseconds interval)
+    {
+        if (m_pollingThread.joinable()) {
+            throw std::logic_error("EventQueue background polling already started");
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_stopPolling = false;
+            m_backgroundPolling = true;
+        }
+        m_pollingThread = std::thread(&EventQueue::BackgroundPollingThread, this, interval);
+    }
 
-    EventQueue::EventQueue(XrInstance instance) : m_instance(instance)
+    void EventQueue::StopBackgroundPolling()
     {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_stopPolling = true;
+        }
+        m_stopPollingCv.notify_all();
+        if (m_pollingThread.joinable()) {
+            m_pollingThread.join();
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_backgroundPolling = false;
+    }
+
+    void EventQueue::BackgroundPollingThread(std::chrono::milliseconds interval)
+    {
+        try {
+            for (;;) {
+                ReadEvents();
+
+                std::unique_lock<std::mutex> lock(m_mutex);
+                if (m_stopPollingCv.wait_for(lock, interval, [&] { return m_stopPolling; })) {
+                    return;
+                }
+            }
+        }
+        catch (...) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_pollingError = std::current_exception();
+            m_backgroundPolling = false;
+            m_eventAdded.notify_all();
+        }
+    }
+
+    void EventQueue::ReadEventsIfNotPolling() const
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_pollingError) {
+                std::exception_ptr error = m_pollingError;
+                m_pollingError = nullptr;
+                std::rethrow_exception(error);
+            }
+            if (m_backgroundPolling) {
+                return;
+            }
+        }
+        ReadEvents();
     }
 
     void EventQueue::ReadEvents() const
     {
+        XRC_TRACE_SCOPE("EventQueue::ReadEvents");
+        std::unique_lock<std::mutex> pollLock(m_pollMutex);
+
         XrResult pollRes;
+        bool added = false;
         XrEventDataBuffer eventDataBuffer{XR_TYPE_EVENT_DATA_BUFFER};
         while ((pollRes = xrPollEvent(m_instance, &eventDataBuffer)) == XR_SUCCESS) {
-            std::unique_lock<std::mutex> lock(m_mutex);
-            m_events.push_back(eventDataBuffer);
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                if (m_events.size() >= m_capacity) {
+                    // Some reader has fallen too far behind: it will find out through its dropped event count.
+                    m_events.pop_front();
+                    m_firstSequence++;
+                }
+                m_events.push_back(eventDataBuffer);
+                m_changeCount++;
+                Trim();
+            }
+            added = true;
             eventDataBuffer.type = XR_TYPE_EVENT_DATA_BUFFER;
             eventDataBuffer.next = nullptr;
         }
 
+        if (added) {
+            m_eventAdded.notify_all();
+        }
+
         XRC_CHECK_THROW_XRRESULT(pollRes, "xrPollEvent");
     }
 
-    EventReader::EventReader(const EventQueue& eventQueue) : m_eventQueue(eventQueue), m_nextEventIndex(eventQueue.m_events.size())
+    uint64_t EventQueue::GetChangeCount() const
     {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_changeCount;
     }
 
-    bool EventReader::TryReadNext(XrEventDataBuffer& dataBuffer)
+    void EventQueue::Notify() const
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_changeCount++;
+        }
+        m_eventAdded.notify_all();
+    }
+
+    bool EventQueue::WaitForChange(uint64_t changeCount, std::chrono::nanoseconds timeout) const
+    {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        for (;;) {
+            ReadEventsIfNotPolling();
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_changeCount != changeCount) {
+                return true;
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) {
+                return false;
+            }
+
+            using TimePoint = std::chrono::steady_clock::time_point;
+            const TimePoint wakeup = m_backgroundPolling ? deadline : std::min<TimePoint>(deadline, now + kSelfPollInterval);
+            m_eventAdded.wait_until(lock, wakeup);
+        }
+    }
+
+    void EventQueue::Trim() const
+    {
+        uint64_t oldestUnread = EndSequence();
+        for (const EventReader* reader : m_readers) {
+            oldestUnread = std::min(oldestUnread, reader->m_nextSequence);
+        }
+        while (!m_events.empty() && m_firstSequence < oldestUnread) {
+            m_events.pop_front();
+            m_firstSequence++;
+        }
+    }
+
+    EventReader::EventReader(const EventQueue& eventQueue) : m_eventQueue(eventQueue)
+    {
+        std::unique_lock<std::mutex> lock(m_eventQueue.m_mutex);
+        m_nextSequence = m_eventQueue.EndSequence();
+        m_eventQueue.m_readers.push_back(this);
+    }
+
+    EventReader::EventReader(const EventReader& other) : m_eventQueue(other.m_eventQueue)
     {
-        m_eventQueue.ReadEvents();
+        std::unique_lock<std::mutex> lock(m_eventQueue.m_mutex);
+        m_nextSequence = other.m_nextSequence;
+        m_droppedEventCount = other.m_droppedEventCount;
+        m_eventQueue.m_readers.push_back(this);
+    }
 
+    EventReader::~EventReader()
+    {
         std::unique_lock<std::mutex> lock(m_eventQueue.m_mutex);
-        if (m_nextEventIndex >= m_eventQueue.m_events.size()) {
+        auto& readers = m_eventQueue.m_readers;
+        readers.erase(std::remove(readers.begin(), readers.end(), this), readers.end());
+        m_eventQueue.Trim();
+    }
+
+    bool EventReader::TryReadNextLocked(XrEventDataBuffer& dataBuffer)
+    {
+        if (m_nextSequence < m_eventQueue.m_firstSequence) {
+            m_droppedEventCount += m_eventQueue.m_firstSequence - m_nextSequence;
+            m_nextSequence = m_eventQueue.m_firstSequence;
+        }
+        if (m_nextSequence >= m_eventQueue.EndSequence()) {
             return false;
         }
 
-        dataBuffer = m_eventQueue.m_events[m_nextEventIndex++];
+        dataBuffer = m_eventQueue.m_events[static_cast<size_t>(m_nextSequence - m_eventQueue.m_firstSequence)];
+        if (m_nextSequence++ == m_eventQueue.m_firstSequence) {
+            // This reader may have been the last one holding on to the oldest event.
+            m_eventQueue.Trim();
+        }
         return true;
     }
 
+    bool EventReader::TryReadNext(XrEventDataBuffer& dataBuffer)
+    {
+        m_eventQueue.ReadEventsIfNotPolling();
+
+        std::unique_lock<std::mutex> lock(m_eventQueue.m_mutex);
+        return TryReadNextLocked(dataBuffer);
+    }
+
     bool EventReader::TryReadUntilEvent(XrEventDataBuffer& dataBuffer, XrStructureType eventType)
     {
         while (TryReadNext(dataBuffer)) {
@@ -69,11 +249,55 @@ namespace Conformance
         return false;
     }
 
+    bool EventReader::WaitForNext(XrEventDataBuffer& dataBuffer, std::chrono::nanoseconds timeout)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        for (;;) {
+            m_eventQueue.ReadEventsIfNotPolling();
+
+            std::unique_lock<std::mutex> lock(m_eventQueue.m_mutex);
+            if (TryReadNextLocked(dataBuffer)) {
+                return true;
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) {
+                return false;
+            }
+
+            // Without a polling thread nobody else may call xrPollEvent, so wake up periodically to do so.
+            using TimePoint = std::chrono::steady_clock::time_point;
+            const TimePoint wakeup = m_eventQueue.m_backgroundPolling ? deadline : std::min<TimePoint>(deadline, now + kSelfPollInterval);
+            m_eventQueue.m_eventAdded.wait_until(lock, wakeup);
+        }
+    }
+
+    bool EventReader::WaitForEvent(XrEventDataBuffer& dataBuffer, XrStructureType eventType, std::chrono::nanoseconds timeout)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        for (;;) {
+            const auto remaining = deadline - std::chrono::steady_clock::now();
+            if (!WaitForNext(dataBuffer, std::max<std::chrono::nanoseconds>(remaining, std::chrono::nanoseconds::zero()))) {
+                return false;
+            }
+            if (dataBuffer.type == eventType) {
+                return true;
+            }
+        }
+    }
+
     void EventReader::ReadUntilEmpty()
     {
-        m_eventQueue.ReadEvents();
+        m_eventQueue.ReadEventsIfNotPolling();
+
+        std::unique_lock<std::mutex> lock(m_eventQueue.m_mutex);
+        m_nextSequence = m_eventQueue.EndSequence();
+        m_eventQueue.Trim();
+    }
 
+    uint64_t EventReader::GetDroppedEventCount() const
+    {
         std::unique_lock<std::mutex> lock(m_eventQueue.m_mutex);
-        m_nextEventIndex = m_eventQueue.m_events.size();
+        return m_droppedEventCount;
     }
 }  // namespace Conformance
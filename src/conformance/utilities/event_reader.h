@@ -18,8 +18,14 @@
 
 #include <openxr/openxr.h>
 #include <stddef.h>
-#include <vector>
+#include <stdint.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 namespace Conformance
 {
@@ -29,20 +35,82 @@ namespace Conformance
      */
     /// @{
 
-    /// Buffered collection of all events read. Only accessible through an @ref EventReader.
+    class EventReader;
+
+    /// Buffered collection of events read. Only accessible through an @ref EventReader.
+    ///
+    /// Each event is stored once, however many readers there are, and is discarded as soon as every reader has moved past it.
+    /// At most @p capacity events are kept: if a reader falls that far behind, the oldest events are dropped and counted
+    /// in @ref EventReader::GetDroppedEventCount.
+    ///
+    /// By default events are polled on the thread of whichever reader asks for one. Call @ref StartBackgroundPolling to
+    /// poll on a dedicated thread instead.
     class EventQueue
     {
     public:
-        explicit EventQueue(XrInstance instance);
+        static constexpr size_t DefaultCapacity = 256;
+
+        explicit EventQueue(XrInstance instance, size_t capacity = DefaultCapacity);
+        ~EventQueue();
+
+        EventQueue(const EventQueue&) = delete;
+        EventQueue& operator=(const EventQueue&) = delete;
+
+        /// Poll xrPollEvent every @p interval on a background thread until @ref StopBackgroundPolling or destruction.
+        /// Readers then never call xrPollEvent themselves.
+        /// An error from xrPollEvent stops polling and is rethrown to the next reader.
+        void StartBackgroundPolling(std::chrono::milliseconds interval = std::chrono::milliseconds(1));
+
+        void StopBackgroundPolling();
+
+        /// Counter that advances whenever an event is queued or @ref Notify is called.
+        uint64_t GetChangeCount() const;
+
+        /// Advance the change count and wake everyone blocked in @ref WaitForChange, e.g. because a frame was submitted.
+        void Notify() const;
+
+        /// Block until the change count differs from @p changeCount or @p timeout expires, returning false on timeout.
+        /// Like @ref EventReader::WaitForNext, this polls for events itself if there is no background polling thread.
+        bool WaitForChange(uint64_t changeCount, std::chrono::nanoseconds timeout) const;
 
     private:
         friend class EventReader;  // ;-)
 
+        /// Poll all pending events into the queue, unless a background thread is doing so.
+        void ReadEventsIfNotPolling() const;
         void ReadEvents() const;
+        void BackgroundPollingThread(std::chrono::milliseconds interval);
+
+        /// Drop events that every reader has already read. Requires m_mutex.
+        void Trim() const;
+
+        /// Sequence number that will be given to the next event added.
+        uint64_t EndSequence() const
+        {
+            return m_firstSequence + m_events.size();
+        }
 
         const XrInstance m_instance;
+        const size_t m_capacity;
+
+        /// Serializes xrPollEvent calls, so that events are queued in the order they were polled.
+        mutable std::mutex m_pollMutex;
+
         mutable std::mutex m_mutex;
-        mutable std::vector<XrEventDataBuffer> m_events;
+        /// Signalled whenever events are added or @ref Notify is called.
+        mutable std::condition_variable m_eventAdded;
+        mutable uint64_t m_changeCount{0};
+        mutable std::deque<XrEventDataBuffer> m_events;
+        /// Sequence number of m_events.front()
+        mutable uint64_t m_firstSequence{0};
+        mutable std::vector<EventReader*> m_readers;
+
+        std::thread m_pollingThread;
+        std::condition_variable m_stopPollingCv;
+        bool m_stopPolling{false};
+        bool m_backgroundPolling{false};
+        /// Error from the background thread, to be rethrown to a reader.
+        mutable std::exception_ptr m_pollingError;
     };
 
     /// Reads all events added to the @ref EventQueue after this object was created.
@@ -52,16 +120,36 @@ namespace Conformance
     {
     public:
         explicit EventReader(const EventQueue& eventQueue);
+        EventReader(const EventReader& other);
+        ~EventReader();
+
+        EventReader& operator=(const EventReader&) = delete;
 
         bool TryReadNext(XrEventDataBuffer& dataBuffer);
 
         bool TryReadUntilEvent(XrEventDataBuffer& dataBuffer, XrStructureType eventType);
 
+        /// Block until an event is available or @p timeout expires, returning false on timeout.
+        bool WaitForNext(XrEventDataBuffer& dataBuffer, std::chrono::nanoseconds timeout);
+
+        /// Like @ref TryReadUntilEvent, but blocks until an event of @p eventType arrives or @p timeout expires.
+        bool WaitForEvent(XrEventDataBuffer& dataBuffer, XrStructureType eventType, std::chrono::nanoseconds timeout);
+
         void ReadUntilEmpty();
 
+        /// Number of events that were dropped before this reader read them, because the queue was full.
+        uint64_t GetDroppedEventCount() const;
+
     private:
+        friend class EventQueue;
+
+        /// Read the next event if there is one. Requires the queue's mutex.
+        bool TryReadNextLocked(XrEventDataBuffer& dataBuffer);
+
         const EventQueue& m_eventQueue;
-        size_t m_nextEventIndex;
+        /// Sequence number of the next event to read. Guarded by the queue's mutex.
+        uint64_t m_nextSequence;
+        uint64_t m_droppedEventCount{0};
     };
     /// @}
 
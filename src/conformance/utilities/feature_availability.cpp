@@ -5,6 +5,7 @@
 #include "feature_availability.h"
 #include <cstdint>
 #include <sstream>
+#include <unordered_map>
 #include "utilities/utils.h"
 #include <openxr/openxr.h>
 #include <openxr/openxr_reflection.h>
@@ -76,15 +77,33 @@ namespace Conformance
     FeatureBitIndex FeatureNameToBitIndex(const std::string& extNameString)
     {
 
-#define CHECK_BIT_NAME(EXT_NAME, NUM)           \
-    if (#EXT_NAME == extNameString) {           \
-        return FeatureBitIndex::BIT_##EXT_NAME; \
+#define MAKE_BIT_NAME_ENTRY(EXT_NAME, NUM) {#EXT_NAME, FeatureBitIndex::BIT_##EXT_NAME},
+        static const std::unordered_map<std::string, FeatureBitIndex> nameToBit = {
+            XRC_ENUM_FEATURES(MAKE_BIT_NAME_ENTRY) XR_LIST_EXTENSIONS(MAKE_BIT_NAME_ENTRY)};
+#undef MAKE_BIT_NAME_ENTRY
+
+        auto it = nameToBit.find(extNameString);
+        if (it == nameToBit.end()) {
+            // No matching name found
+            return FeatureBitIndex::FEATURE_COUNT;
+        }
+        return it->second;
     }
-        XRC_ENUM_FEATURES(CHECK_BIT_NAME)
-        XR_LIST_EXTENSIONS(CHECK_BIT_NAME)
 
-        // No matching name found
-        return FeatureBitIndex::FEATURE_COUNT;
+    FeatureBitIndex ExtensionNumberToBitIndex(uint64_t extensionNumber)
+    {
+
+#define RETURN_BIT_FOR_NUMBER(EXT_NAME, NUM) \
+    case NUM:                                \
+        return FeatureBitIndex::BIT_##EXT_NAME;
+
+        switch (extensionNumber) {
+            XR_LIST_EXTENSIONS(RETURN_BIT_FOR_NUMBER)
+        default:
+            return FeatureBitIndex::FEATURE_COUNT;
+        }
+
+#undef RETURN_BIT_FOR_NUMBER
     }
 
     static void FeatureSetToString(const FeatureSet& featureSet, TermJoiner& joiner)
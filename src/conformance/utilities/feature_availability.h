@@ -46,11 +46,17 @@ namespace Conformance
     /// Return a feature bit for the given extension name, if known,
     /// otherwise returns @ref FeatureBitIndex::FEATURE_COUNT
     ///
-    /// Fairly slow because it is doing a lot of naive string comparisons.
+    /// Case sensitive. Looks the name up in a hash table built on first use.
     ///
     /// @relates FeatureBitIndex
     FeatureBitIndex FeatureNameToBitIndex(const std::string& extNameString);
 
+    /// Return the feature bit for the given extension number, if known,
+    /// otherwise returns @ref FeatureBitIndex::FEATURE_COUNT
+    ///
+    /// @relates FeatureBitIndex
+    FeatureBitIndex ExtensionNumberToBitIndex(uint64_t extensionNumber);
+
     /// A set of features (core versions and extensions).
     ///
     /// Can be used to reflect a set of enabled extensions, or one way to
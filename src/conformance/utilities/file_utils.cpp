@@ -0,0 +1,82 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "file_utils.h"
+
+#include <atomic>
+#include <fstream>
+#include <iterator>
+#include <stdio.h>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace Conformance
+{
+    namespace
+    {
+        unsigned long CurrentProcessId()
+        {
+#if defined(_WIN32)
+            return static_cast<unsigned long>(_getpid());
+#else
+            return static_cast<unsigned long>(getpid());
+#endif
+        }
+
+        /// Unique among the processes and threads that might write @p path at the same time.
+        std::string MakeTempPath(const std::string& path)
+        {
+            static std::atomic<uint64_t> counter{0};
+            return path + "." + std::to_string(CurrentProcessId()) + "." + std::to_string(counter++) + ".tmp";
+        }
+    }  // namespace
+
+    void ReadFileBytes(const std::string& path, std::vector<uint8_t>* data)
+    {
+        data->clear();
+        std::ifstream file(path, std::ios::binary);
+        if (file) {
+            data->assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+    }
+
+    bool WriteFileAtomically(const std::string& path, const void* data, size_t size)
+    {
+        const std::string tempPath = MakeTempPath(path);
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+            file.close();
+            if (!file) {
+                remove(tempPath.c_str());
+                return false;
+            }
+        }
+        // rename replaces an existing file on POSIX, but not on Windows.
+        if (rename(tempPath.c_str(), path.c_str()) != 0) {
+            remove(path.c_str());
+            if (rename(tempPath.c_str(), path.c_str()) != 0) {
+                remove(tempPath.c_str());
+                return false;
+            }
+        }
+        return true;
+    }
+}  // namespace Conformance
@@ -0,0 +1,40 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Conformance
+{
+    /// Read the whole of the file at @p path into @p data, leaving @p data empty if the file cannot be read.
+    void ReadFileBytes(const std::string& path, std::vector<uint8_t>* data);
+
+    /// Replace the file at @p path with the @p size bytes at @p data, or leave it as it was if that fails.
+    ///
+    /// The bytes are written to a temporary file named after the process and a per-process counter, then renamed over
+    /// @p path, so that readers and other processes writing the same file never see a partially written file.
+    /// Meant for best-effort caches, so failure is only reported by the return value.
+    bool WriteFileAtomically(const std::string& path, const void* data, size_t size);
+
+    inline bool WriteFileAtomically(const std::string& path, const std::vector<uint8_t>& data)
+    {
+        return WriteFileAtomically(path, data.data(), data.size());
+    }
+}  // namespace Conformance
@@ -0,0 +1,51 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "frame_arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace Conformance
+{
+    void FrameArena::Reset()
+    {
+        m_currentBlock = 0;
+        m_offset = 0;
+        m_bytesUsed = 0;
+    }
+
+    void* FrameArena::Allocate(size_t size, size_t alignment)
+    {
+        for (; m_currentBlock < m_blocks.size(); ++m_currentBlock, m_offset = 0) {
+            Block& block = m_blocks[m_currentBlock];
+            const uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+            const size_t alignedOffset = static_cast<size_t>(((base + m_offset + alignment - 1) & ~uintptr_t(alignment - 1)) - base);
+            if (alignedOffset + size <= block.size) {
+                m_offset = alignedOffset + size;
+                m_bytesUsed += size;
+                return block.data.get() + alignedOffset;
+            }
+        }
+
+        // No room left in any block: add one, big enough for this allocation even if it is larger than usual.
+        const size_t blockSize = std::max(m_blockSize, size + alignment);
+        m_blocks.push_back({std::unique_ptr<unsigned char[]>(new unsigned char[blockSize]), blockSize});
+        m_currentBlock = m_blocks.size() - 1;
+        m_offset = 0;
+        return Allocate(size, alignment);
+    }
+}  // namespace Conformance
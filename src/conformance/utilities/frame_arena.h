@@ -0,0 +1,82 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace Conformance
+{
+    /// Bump allocator for structures that only live for one frame, such as composition layers, their projection views
+    /// and chained extension structures.
+    ///
+    /// @ref Reset releases everything at once but keeps the memory, so once the arena has grown to fit a frame, later
+    /// frames do not allocate. Only trivially destructible types can be allocated, as nothing is destroyed.
+    class FrameArena
+    {
+    public:
+        explicit FrameArena(size_t blockSize = 16 * 1024) : m_blockSize(blockSize)
+        {
+        }
+
+        /// Allocate a copy of @p value, valid until the next @ref Reset.
+        template <typename T>
+        T* New(const T& value)
+        {
+            return NewArray<T>(1, value);
+        }
+
+        /// Allocate @p count copies of @p value, valid until the next @ref Reset.
+        template <typename T>
+        T* NewArray(size_t count, const T& value)
+        {
+            static_assert(std::is_trivially_destructible<T>::value, "FrameArena never runs destructors");
+            T* items = static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+            for (size_t i = 0; i < count; ++i) {
+                new (items + i) T(value);
+            }
+            return items;
+        }
+
+        /// Release everything allocated since the last reset, keeping the memory for reuse.
+        void Reset();
+
+        /// Bytes handed out since the last reset.
+        size_t BytesUsed() const
+        {
+            return m_bytesUsed;
+        }
+
+    private:
+        void* Allocate(size_t size, size_t alignment);
+
+        struct Block
+        {
+            std::unique_ptr<unsigned char[]> data;
+            size_t size;
+        };
+
+        size_t m_blockSize;
+        std::vector<Block> m_blocks;
+        size_t m_currentBlock{0};
+        size_t m_offset{0};
+        size_t m_bytesUsed{0};
+    };
+}  // namespace Conformance
@@ -0,0 +1,55 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace Conformance
+{
+    template <typename Signature>
+    class FunctionRef;
+
+    /// Non-owning reference to a callable, for callbacks that are only called during the call they are passed to.
+    ///
+    /// Unlike std::function, binding a lambda never allocates and calling it is a single indirect call.
+    /// The callable must outlive the FunctionRef, so do not store one beyond the call it was passed to.
+    template <typename Ret, typename... Args>
+    class FunctionRef<Ret(Args...)>
+    {
+    public:
+        template <typename Callable, typename = typename std::enable_if<
+                                         !std::is_same<typename std::decay<Callable>::type, FunctionRef>::value>::type>
+        FunctionRef(Callable&& callable) noexcept
+            : m_callable(const_cast<void*>(static_cast<const void*>(std::addressof(callable))))
+            , m_invoke([](void* callable, Args... args) -> Ret {
+                return (*static_cast<typename std::add_pointer<Callable>::type>(callable))(std::forward<Args>(args)...);
+            })
+        {
+        }
+
+        Ret operator()(Args... args) const
+        {
+            return m_invoke(m_callable, std::forward<Args>(args)...);
+        }
+
+    private:
+        void* m_callable;
+        Ret (*m_invoke)(void*, Args...);
+    };
+}  // namespace Conformance
@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include <stdint.h>
 #include <memory>
 #include <utility>
 
@@ -64,7 +65,37 @@
  * if only a single generated value should be used per test case execution.
  * Alternately, if you don't need to re-start the test case for each generated value,
  * you can record the appropriate data about this iteration with an `INFO` or a `CAPTURE`.
+ *
+ * The values of a generator may be split between processes that each run the same test case:
+ * see GeneratorShard.
+ */
+
+/*!
+ * The share of the values of every generator that this process produces.
+ *
+ * The i-th value of a generator, counting from 0, is only produced if `i % count == index`,
+ * so that processes which each run the same test case with a different index only run their share of its generated subtests.
+ * The default of a single shard produces every value.
+ *
+ * @ingroup cts_generators
+ */
+struct GeneratorShard
+{
+    uint32_t index{0};
+    uint32_t count{1};
+};
+
+/*!
+ * The shard that generators created from now on produce their values for.
+ * Set by the test framework as each test case starts; changing it does not affect generators that already exist.
+ *
+ * @ingroup cts_generators
  */
+inline GeneratorShard& CurrentGeneratorShard()
+{
+    static GeneratorShard shard;
+    return shard;
+}
 
 /*!
  * @defgroup cts_generators_details Implementation details of generators
@@ -86,6 +117,7 @@ public:
     /// Advance to the next element, if any, returning false if we have run out.
     ///
     /// Call at the top of your loop, not the bottom.
+    /// Must allow advancing again without get() having been called, which is how values of other shards are skipped.
     virtual bool next() = 0;
 
     /// Retrieve the current element - only call once per loop iteration!
@@ -103,18 +135,25 @@ template <typename T>
 class GeneratorWrapper
 {
     std::unique_ptr<GeneratorBase<T>> inner_;
+    GeneratorShard shard_;
+    uint64_t valueIndex_{0};
 
 public:
-    explicit GeneratorWrapper(std::unique_ptr<GeneratorBase<T>>&& inner) : inner_(std::move(inner))
+    explicit GeneratorWrapper(std::unique_ptr<GeneratorBase<T>>&& inner) : inner_(std::move(inner)), shard_(CurrentGeneratorShard())
     {
     }
 
-    /// Advance to the next element, if any, returning false if we have run out.
+    /// Advance to the next element of this process's shard, if any, returning false if we have run out.
     ///
     /// Call at the top of your loop, not the bottom.
     bool next()
     {
-        return inner_->next();
+        while (inner_->next()) {
+            if (shard_.count <= 1 || valueIndex_++ % shard_.count == shard_.index) {
+                return true;
+            }
+        }
+        return false;
     }
 
     /// Retrieve the current element - only call once per loop iteration!
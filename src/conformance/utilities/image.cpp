@@ -4,6 +4,8 @@
 
 #include "image.h"
 
+#include "file_utils.h"
+
 // These are required to cleanly use basis_universal
 #if defined(__GNUC__) || defined(__clang__)
 #pragma GCC diagnostic push
@@ -22,9 +24,17 @@
 #pragma GCC diagnostic pop
 #endif
 
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <future>
 #include <iostream>
 #include <sstream>
-#include <numeric>
+#include <string>
+#include <thread>
 #include <unordered_map>
 #include <mutex>
 
@@ -73,8 +83,8 @@ namespace Conformance
             return DivRoundingUp(physicalDimensions.width, blockSize.width);
         }
 
-        // BasisU is not thread safe unless you pass a state pointer around,
-        // so until we make everything else thread safe too, we can use a mutex
+        // BasisU is only thread safe once its tables are initialized, and when each thread passes its own state pointer around,
+        // so this mutex guards the initialization.
         std::mutex BasisUMutex;
 
         static void InitKTX2Impl(std::unique_lock<std::mutex>& lock, bool implicitInit)
@@ -100,6 +110,149 @@ namespace Conformance
             InitKTX2Impl(lock, false);
         }
 
+        namespace
+        {
+            std::mutex TranscodeCacheMutex;
+            std::string TranscodeCacheDirectory;
+
+            // Bump this whenever the transcoded output may change for the same input, e.g. with different decode flags.
+            constexpr uint32_t TranscodeCacheVersion = 1;
+            constexpr char TranscodeCacheMagic[8] = {'C', 'T', 'S', 'K', 'T', 'X', '2', 'T'};
+
+            struct TranscodeCacheHeader
+            {
+                char magic[8];
+                uint32_t version;
+                uint32_t levelCount;
+            };
+
+            struct TranscodeCacheLevel
+            {
+                int32_t width;
+                int32_t height;
+                int32_t blockWidth;
+                int32_t blockHeight;
+                uint64_t size;
+            };
+
+            // 64-bit FNV-1a
+            uint64_t HashBytes(span<const uint8_t> data)
+            {
+                uint64_t hash = 14695981039346656037ull;
+                for (uint8_t byte : data) {
+                    hash = (hash ^ byte) * 1099511628211ull;
+                }
+                return hash;
+            }
+
+            /// Returns the file a KTX2 image transcoded to @p format is cached in, or an empty string if there is no cache.
+            std::string GetTranscodeCachePath(span<const uint8_t> encodedData, FormatParams format)
+            {
+                std::string directory;
+                {
+                    std::lock_guard<std::mutex> lock(TranscodeCacheMutex);
+                    directory = TranscodeCacheDirectory;
+                }
+                if (directory.empty()) {
+                    return {};
+                }
+                char name[96];
+                snprintf(name, sizeof(name), "cts_ktx2_%016llx_%u_%u_%u_v%u.bin", (unsigned long long)HashBytes(encodedData),
+                         (unsigned)format.codec, (unsigned)format.channels, (unsigned)format.colorSpaceType, TranscodeCacheVersion);
+                return directory + "/" + name;
+            }
+
+            /// Reads the cached levels of an image into @p scratchBuffer, and points @p levels into it.
+            /// Returns false, so that the image is transcoded instead, if there is no usable cache entry.
+            bool ReadTranscodeCache(const std::string& path, uint32_t levelCount, XrExtent2Di expectedDimensions,
+                                    std::vector<uint8_t>& scratchBuffer, std::vector<ImageLevel>& levels)
+            {
+                std::ifstream file(path, std::ios::binary | std::ios::ate);
+                if (!file) {
+                    return false;
+                }
+                const std::streamoff fileSize = file.tellg();
+                const size_t recordsSize = sizeof(TranscodeCacheHeader) + levelCount * sizeof(TranscodeCacheLevel);
+                if (fileSize < (std::streamoff)recordsSize) {
+                    return false;
+                }
+                scratchBuffer.resize((size_t)fileSize);
+                file.seekg(0);
+                if (!file.read(reinterpret_cast<char*>(scratchBuffer.data()), fileSize)) {
+                    return false;
+                }
+
+                TranscodeCacheHeader header;
+                memcpy(&header, scratchBuffer.data(), sizeof(header));
+                if (memcmp(header.magic, TranscodeCacheMagic, sizeof(header.magic)) != 0 || header.version != TranscodeCacheVersion ||
+                    header.levelCount != levelCount) {
+                    return false;
+                }
+
+                std::vector<ImageLevel> cachedLevels;
+                cachedLevels.reserve(levelCount);
+                size_t offset = recordsSize;
+                for (uint32_t level = 0; level < levelCount; ++level) {
+                    TranscodeCacheLevel record;
+                    memcpy(&record, scratchBuffer.data() + sizeof(header) + level * sizeof(record), sizeof(record));
+                    if (record.width < 1 || record.height < 1 || record.blockWidth < 1 || record.blockHeight < 1 ||
+                        record.size > scratchBuffer.size() - offset) {
+                        return false;
+                    }
+                    if (level == 0 && ((expectedDimensions.width > 0 && expectedDimensions.width != record.width) ||
+                                       (expectedDimensions.height > 0 && expectedDimensions.height != record.height))) {
+                        return false;
+                    }
+                    ImageLevelMetadata metadata{{record.width, record.height}, {record.blockWidth, record.blockHeight}};
+                    cachedLevels.push_back(ImageLevel{metadata, {scratchBuffer.data() + offset, (size_t)record.size}});
+                    offset += (size_t)record.size;
+                }
+                if (offset != scratchBuffer.size()) {
+                    return false;
+                }
+
+                levels = std::move(cachedLevels);
+                return true;
+            }
+
+            /// Best effort: an image that cannot be cached is just transcoded again next time.
+            void WriteTranscodeCache(const std::string& path, const std::vector<ImageLevel>& levels)
+            {
+                TranscodeCacheHeader header{};
+                memcpy(header.magic, TranscodeCacheMagic, sizeof(header.magic));
+                header.version = TranscodeCacheVersion;
+                header.levelCount = (uint32_t)levels.size();
+
+                size_t size = sizeof(header) + levels.size() * sizeof(TranscodeCacheLevel);
+                for (const ImageLevel& level : levels) {
+                    size += level.data.size();
+                }
+                std::vector<uint8_t> bytes;
+                bytes.reserve(size);
+                auto append = [&](const void* data, size_t dataSize) {
+                    const uint8_t* const begin = static_cast<const uint8_t*>(data);
+                    bytes.insert(bytes.end(), begin, begin + dataSize);
+                };
+                append(&header, sizeof(header));
+                for (const ImageLevel& level : levels) {
+                    TranscodeCacheLevel record{level.metadata.physicalDimensions.width, level.metadata.physicalDimensions.height,
+                                               level.metadata.blockSize.width, level.metadata.blockSize.height,
+                                               (uint64_t)level.data.size()};
+                    append(&record, sizeof(record));
+                }
+                for (const ImageLevel& level : levels) {
+                    append(level.data.data(), level.data.size());
+                }
+                WriteFileAtomically(path, bytes);
+            }
+        }  // namespace
+
+        void SetTranscodeCacheDirectory(const std::string& directory)
+        {
+            std::lock_guard<std::mutex> lock(TranscodeCacheMutex);
+            TranscodeCacheDirectory = directory;
+        }
+
         namespace FormatStrategies
         {
             enum MatchFidelity : uint8_t
@@ -121,9 +274,10 @@ namespace Conformance
                 virtual size_t RequiredScratchSpaceForLevel(FormatParams destFormatParams, basist::ktx2_transcoder& transcoder,
                                                             const basist::ktx2_image_level_info& imageLevelInfo) const = 0;
 
+                /// @p state must be used by one thread at a time, but levels may be transcoded in parallel with a state each.
                 virtual ImageLevel TranscodeLevel(FormatParams destFormatParams, basist::ktx2_transcoder& transcoder,
-                                                  const basist::ktx2_image_level_info& imageLevelInfo,
-                                                  span<uint8_t> scratchBuffer) const = 0;
+                                                  const basist::ktx2_image_level_info& imageLevelInfo, span<uint8_t> scratchBuffer,
+                                                  basist::ktx2_transcoder_state* state) const = 0;
             };
 
             class DecodeToRaw : public FormatStrategy
@@ -165,7 +319,8 @@ namespace Conformance
                 }
 
                 ImageLevel TranscodeLevel(FormatParams destFormatParams, basist::ktx2_transcoder& transcoder,
-                                          const basist::ktx2_image_level_info& imageLevelInfo, span<uint8_t> scratchBuffer) const override
+                                          const basist::ktx2_image_level_info& imageLevelInfo, span<uint8_t> scratchBuffer,
+                                          basist::ktx2_transcoder_state* state) const override
                 {
 
                     if (TranscodeFidelity(transcoder.get_format(), destFormatParams) == MatchFidelity::NotPossible) {
@@ -198,7 +353,7 @@ namespace Conformance
                         origHeight,  // uint32_t output_rows_in_pixels = 0,
                         -1,          // int channel0 = -1,
                         -1,          // int channel1 = -1,
-                        nullptr      // ktx2_transcoder_state *pState = nullptr,
+                        state        // ktx2_transcoder_state *pState = nullptr,
                     );
                     if (!success) {
                         throw std::logic_error("CTS KTX2: Failed to transcode KTX2 image data.");
@@ -262,7 +417,8 @@ namespace Conformance
                 }
 
                 ImageLevel TranscodeLevel(FormatParams destFormatParams, basist::ktx2_transcoder& transcoder,
-                                          const basist::ktx2_image_level_info& imageLevelInfo, span<uint8_t> scratchBuffer) const override
+                                          const basist::ktx2_image_level_info& imageLevelInfo, span<uint8_t> scratchBuffer,
+                                          basist::ktx2_transcoder_state* state) const override
                 {
 
                     if (TranscodeFidelity(transcoder.get_format(), destFormatParams) == MatchFidelity::NotPossible) {
@@ -308,9 +464,9 @@ namespace Conformance
                         dstBlocksY,  // uint32_t output_rows_in_pixels = 0,
                         // source channel overrides for R and RG textures.
                         // -1 (default) results in channel0 = 0 (R) and channel1 = 3 (A).
-                        -1,      // int channel0 = -1,
-                        -1,      // int channel1 = -1,
-                        nullptr  // ktx2_transcoder_state *pState = nullptr,
+                        -1,     // int channel0 = -1,
+                        -1,     // int channel1 = -1,
+                        state   // ktx2_transcoder_state *pState = nullptr,
                     );
                     if (!success) {
                         throw std::logic_error("CTS KTX2: Failed to transcode KTX2 image data.");
@@ -393,18 +549,19 @@ namespace Conformance
                                           std::vector<uint8_t>& scratchBuffer, const char* imageDesc, XrExtent2Di expectedDimensions)
         {
 
-            std::unique_lock<std::mutex> lock(BasisUMutex);
+            {
+                std::unique_lock<std::mutex> lock(BasisUMutex);
 
-            // Initializing the tables required for KTX2 decoding can take (~9) milliseconds,
-            // so this should ideally be done at startup to avoid adding to the hitch on model load.
-            InitKTX2Impl(lock, true);
+                // Initializing the tables required for KTX2 decoding can take (~9) milliseconds,
+                // so this should ideally be done at startup to avoid adding to the hitch on model load.
+                InitKTX2Impl(lock, true);
+            }
 
             basist::ktx2_transcoder transcoder{};
 
             // Load a little metadata.
-            transcoder.init(encodedData.data(), encodedData.size());
-            if (!transcoder.start_transcoding()) {
-                throw std::logic_error(std::string("CTS KTX2: Transcoding of KTX2 file failed at start for ") + imageDesc);
+            if (!transcoder.init(encodedData.data(), (uint32_t)encodedData.size())) {
+                throw std::logic_error(std::string("CTS KTX2: Failed to read KTX2 header for ") + imageDesc);
             }
 
             if (transcoder.get_faces() > 1) {
@@ -537,25 +694,82 @@ namespace Conformance
                 imageLevelInfos.push_back(imageLevelInfo);
             }
 
+            Image ret{targetFormat};
+
+            // Everything above only needed the header, so a cache hit skips the costly part of the transcoder setup too.
+            const std::string cachePath = GetTranscodeCachePath(encodedData, targetFormat);
+            if (!cachePath.empty() && ReadTranscodeCache(cachePath, mipLevels, expectedDimensions, scratchBuffer, ret.levels)) {
+                return ret;
+            }
+
+            if (!transcoder.start_transcoding()) {
+                throw std::logic_error(std::string("CTS KTX2: Transcoding of KTX2 file failed at start for ") + imageDesc);
+            }
+
             std::vector<size_t> scratchBufferSizes;
+            std::vector<size_t> scratchBufferOffsets;
             scratchBufferSizes.reserve(mipLevels);
+            scratchBufferOffsets.reserve(mipLevels);
 
+            size_t scratchBufferSize = 0;
             for (uint32_t mipLevel = 0; mipLevel < mipLevels; ++mipLevel) {
                 scratchBufferSizes.push_back(
                     formatStrategy->RequiredScratchSpaceForLevel(targetFormat, transcoder, imageLevelInfos[mipLevel]));
+                scratchBufferOffsets.push_back(scratchBufferSize);
+                scratchBufferSize += scratchBufferSizes.back();
             }
-
-            size_t scratchBufferSize = std::accumulate(scratchBufferSizes.begin(), scratchBufferSizes.end(), size_t(0));
             scratchBuffer.resize(scratchBufferSize);
 
-            Image ret{targetFormat};
-            auto it = scratchBuffer.begin();
-            for (uint32_t mipLevel = 0; mipLevel < mipLevels; ++mipLevel) {
-                size_t size = scratchBufferSizes[mipLevel];
-                assert(it + size <= scratchBuffer.end());
-                ret.levels.emplace_back(
-                    formatStrategy->TranscodeLevel(targetFormat, transcoder, imageLevelInfos[mipLevel], {it, it + size}));
-                it += size;
+            // Levels are transcoded in parallel, largest first, each thread with its own transcoder state.
+            ret.levels.resize(mipLevels);
+            std::atomic<uint32_t> nextLevel{0};
+            auto transcodeLevels = [&] {
+                basist::ktx2_transcoder_state state;
+                try {
+                    for (uint32_t mipLevel = nextLevel++; mipLevel < mipLevels; mipLevel = nextLevel++) {
+                        span<uint8_t> levelBuffer{scratchBuffer.data() + scratchBufferOffsets[mipLevel], scratchBufferSizes[mipLevel]};
+                        ret.levels[mipLevel] =
+                            formatStrategy->TranscodeLevel(targetFormat, transcoder, imageLevelInfos[mipLevel], levelBuffer, &state);
+                    }
+                }
+                catch (...) {
+                    // Stop the other workers early, the transcode has failed anyway.
+                    nextLevel = mipLevels;
+                    throw;
+                }
+            };
+            // Small images are not worth starting threads for.
+            constexpr size_t MinParallelScratchBufferSize = 256 * 1024;
+            const size_t workerCount = scratchBufferSize < MinParallelScratchBufferSize
+                                           ? 1
+                                           : std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), mipLevels);
+            std::vector<std::future<void>> workers;
+            for (size_t i = 1; i < workerCount; i++) {
+                workers.push_back(std::async(std::launch::async, transcodeLevels));
+            }
+            std::exception_ptr error;
+            try {
+                transcodeLevels();
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+            for (std::future<void>& worker : workers) {
+                try {
+                    worker.get();
+                }
+                catch (...) {
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                }
+            }
+            if (error) {
+                std::rethrow_exception(error);
+            }
+
+            if (!cachePath.empty()) {
+                WriteTranscodeCache(cachePath, ret.levels);
             }
 
             return ret;
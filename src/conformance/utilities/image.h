@@ -9,6 +9,7 @@
 
 #include <cstddef>
 #include <stdint.h>
+#include <string>
 #include <vector>
 
 namespace Conformance
@@ -127,6 +128,11 @@ namespace Conformance
         // (According to libktx, "Requires ~9 milliseconds when compiled and executed natively on a Core i7 2.2 GHz.")
         void InitKTX2();
 
+        /// Keep KTX2 images transcoded by @ref Image::LoadAndTranscodeKTX2 in @p directory, keyed by their contents and the
+        /// format they were transcoded to, so that later runs on the same device can skip transcoding them.
+        /// An empty directory, the default, disables the cache.
+        void SetTranscodeCacheDirectory(const std::string& directory);
+
         /// An image, possibly with multiple mip levels.
         struct Image
         {
@@ -139,7 +145,7 @@ namespace Conformance
             std::vector<ImageLevel> levels;
 
             /// Parse KTX2 binary data into an image that can be loaded.
-            /// Will perform transcoding if required.
+            /// Will perform transcoding if required, of all mip levels in parallel, unless the result is in the transcode cache.
             ///
             /// @note that the returned image may contain a reference to the supplied @p encodedData and/or @p scratchBuffer
             /// so its lifetime should be considered to be tied to that.
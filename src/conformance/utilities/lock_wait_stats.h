@@ -0,0 +1,51 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+namespace Conformance
+{
+    /// How often a lock was taken, and how often and how long callers had to wait for it, to find contention between threads.
+    struct LockWaitStats
+    {
+        std::atomic<uint64_t> lockCount{0};
+        std::atomic<uint64_t> contendedCount{0};
+        std::atomic<uint64_t> waitNanoseconds{0};
+    };
+
+    /// Lock @p mutex with a @p Lock (std::unique_lock, std::shared_lock, ...), counting the wait in @p stats.
+    ///
+    /// An uncontended lock costs one try-lock and an increment: the clock is only read when the lock is already held.
+    template <typename Lock>
+    Lock LockAndCountWait(typename Lock::mutex_type& mutex, LockWaitStats& stats)
+    {
+        Lock lock(mutex, std::try_to_lock);
+        stats.lockCount.fetch_add(1, std::memory_order_relaxed);
+        if (!lock.owns_lock()) {
+            stats.contendedCount.fetch_add(1, std::memory_order_relaxed);
+            const auto start = std::chrono::steady_clock::now();
+            lock.lock();
+            const auto wait = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+            stats.waitNanoseconds.fetch_add(static_cast<uint64_t>(wait.count()), std::memory_order_relaxed);
+        }
+        return lock;
+    }
+}  // namespace Conformance
@@ -13,6 +13,10 @@
 
 #include "metal_utils.h"
 
+#include "utilities/throw_helpers.h"
+
+#include <algorithm>
+
 namespace Conformance
 {
 
@@ -22,6 +26,95 @@ namespace Conformance
         return (simd::float4x4&)matrix;
     }
 
+    MetalStaticResourceHeaps::MetalStaticResourceHeaps(MTL::Device* device, MTL::CommandQueue* uploadQueue)
+        : m_device(NS::RetainPtr(device)), m_uploadQueue(NS::RetainPtr(uploadQueue))
+    {
+    }
+
+    MTL::Heap* MetalStaticResourceHeaps::GetHeap(std::vector<NS::SharedPtr<MTL::Heap>>& heaps, const MTL::SizeAndAlign& sizeAndAlign)
+    {
+        // Earlier heaps are usually full, so look at the most recent first.
+        for (auto it = heaps.rbegin(); it != heaps.rend(); ++it) {
+            if ((*it)->maxAvailableSize(sizeAndAlign.align) >= sizeAndAlign.size) {
+                return it->get();
+            }
+        }
+
+        NS::SharedPtr<MTL::HeapDescriptor> desc = NS::TransferPtr(MTL::HeapDescriptor::alloc()->init());
+        desc->setSize(std::max<NS::UInteger>(DefaultHeapSize, sizeAndAlign.size));
+        desc->setStorageMode(MTL::StorageModePrivate);
+        // Resources are only written by the blits that upload them, which Metal orders before their use when tracking hazards.
+        desc->setHazardTrackingMode(MTL::HazardTrackingModeTracked);
+        NS::SharedPtr<MTL::Heap> heap = NS::TransferPtr(m_device->newHeap(desc.get()));
+        XRC_CHECK_THROW(heap);
+        heaps.push_back(heap);
+        return heap.get();
+    }
+
+    MTL::BlitCommandEncoder* MetalStaticResourceHeaps::GetBlitEncoder()
+    {
+        if (!m_blitEncoder) {
+            m_commandBuffer = NS::RetainPtr(m_uploadQueue->commandBuffer());
+            m_commandBuffer->setLabel(MTLSTR("StaticResourceUploads"));
+            m_blitEncoder = NS::RetainPtr(m_commandBuffer->blitCommandEncoder());
+        }
+        return m_blitEncoder.get();
+    }
+
+    NS::SharedPtr<MTL::Buffer> MetalStaticResourceHeaps::NewBuffer(const void* data, size_t size)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const MTL::ResourceOptions options = MTL::ResourceStorageModePrivate | MTL::ResourceHazardTrackingModeTracked;
+        MTL::Heap* heap = GetHeap(m_bufferHeaps, m_device->heapBufferSizeAndAlign(size, options));
+        NS::SharedPtr<MTL::Buffer> buffer = NS::TransferPtr(heap->newBuffer(size, options));
+        XRC_CHECK_THROW(buffer);
+
+        // The command buffer keeps the staging buffer alive until the copy is done.
+        NS::SharedPtr<MTL::Buffer> staging = NS::TransferPtr(m_device->newBuffer(data, size, MTL::ResourceStorageModeShared));
+        GetBlitEncoder()->copyFromBuffer(staging.get(), 0, buffer.get(), 0, size);
+        return buffer;
+    }
+
+    NS::SharedPtr<MTL::Texture> MetalStaticResourceHeaps::NewTexture(MTL::TextureDescriptor* desc)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        desc->setStorageMode(MTL::StorageModePrivate);
+        desc->setHazardTrackingMode(MTL::HazardTrackingModeTracked);
+        MTL::Heap* heap = GetHeap(m_textureHeaps, m_device->heapTextureSizeAndAlign(desc));
+        NS::SharedPtr<MTL::Texture> texture = NS::TransferPtr(heap->newTexture(desc));
+        XRC_CHECK_THROW(texture);
+        return texture;
+    }
+
+    void MetalStaticResourceHeaps::UploadTextureRegion(MTL::Texture* texture, NS::UInteger slice, NS::UInteger level,
+                                                       const MTL::Region& region, const void* data, size_t bytesPerRow, size_t size)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        NS::SharedPtr<MTL::Buffer> staging = NS::TransferPtr(m_device->newBuffer(data, size, MTL::ResourceStorageModeShared));
+        // The bytes per image are only needed for 3D textures, which are not used.
+        GetBlitEncoder()->copyFromBuffer(staging.get(), 0, bytesPerRow, 0, region.size, texture, slice, level, region.origin);
+    }
+
+    void MetalStaticResourceHeaps::GenerateMipmaps(MTL::Texture* texture)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        GetBlitEncoder()->generateMipmaps(texture);
+    }
+
+    void MetalStaticResourceHeaps::Flush()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_blitEncoder) {
+            return;
+        }
+        m_blitEncoder->endEncoding();
+        m_commandBuffer->commit();
+        // Rendering is submitted to another queue, so make sure the contents are there before it reads them.
+        m_commandBuffer->waitUntilCompleted();
+        m_blitEncoder.reset();
+        m_commandBuffer.reset();
+    }
+
 }  // namespace Conformance
 
 #endif
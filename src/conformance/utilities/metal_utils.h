@@ -2,17 +2,68 @@
 //
 // SPDX-License-Identifier: Apache-2.0
 
+#pragma once
+
 #if defined(XR_USE_GRAPHICS_API_METAL)
 
 #include <openxr/openxr.h>
 #include <simd/simd.h>
 #include "common/xr_linear.h"
 
+#include <Foundation/Foundation.hpp>
+#include <Metal/Metal.hpp>
+
+#include <mutex>
+#include <stddef.h>
+#include <vector>
+
 namespace Conformance
 {
 
     simd::float4x4 LoadXrMatrixToMetal(const XrMatrix4x4f& matrix);
 
+    /// Places static resources, whose contents are written once when they are created, in heaps with private storage:
+    /// one set of heaps for buffers and one for textures. Their contents are uploaded with blit copies from staging buffers.
+    ///
+    /// Uploads are recorded into one command buffer on the upload queue until Flush(), which must be called before the
+    /// resources are used by command buffers on other queues. May be used from several threads.
+    class MetalStaticResourceHeaps
+    {
+    public:
+        /// Size of each heap, unless a resource needs a larger one
+        static constexpr size_t DefaultHeapSize = 32 * 1024 * 1024;
+
+        MetalStaticResourceHeaps(MTL::Device* device, MTL::CommandQueue* uploadQueue);
+
+        /// Create a buffer holding a copy of @p size bytes at @p data.
+        NS::SharedPtr<MTL::Buffer> NewBuffer(const void* data, size_t size);
+
+        /// Create a texture with private storage from @p desc, to be written with UploadTextureRegion.
+        NS::SharedPtr<MTL::Texture> NewTexture(MTL::TextureDescriptor* desc);
+
+        /// Copy @p data, laid out with @p bytesPerRow, to @p region of @p level of @p slice of @p texture.
+        void UploadTextureRegion(MTL::Texture* texture, NS::UInteger slice, NS::UInteger level, const MTL::Region& region, const void* data,
+                                 size_t bytesPerRow, size_t size);
+
+        /// Generate the levels after the first of @p texture, after the uploads recorded so far.
+        void GenerateMipmaps(MTL::Texture* texture);
+
+        /// Commit the uploads recorded so far and wait for them to complete.
+        void Flush();
+
+    private:
+        MTL::Heap* GetHeap(std::vector<NS::SharedPtr<MTL::Heap>>& heaps, const MTL::SizeAndAlign& sizeAndAlign);
+        MTL::BlitCommandEncoder* GetBlitEncoder();
+
+        std::mutex m_mutex;
+        NS::SharedPtr<MTL::Device> m_device;
+        NS::SharedPtr<MTL::CommandQueue> m_uploadQueue;
+        std::vector<NS::SharedPtr<MTL::Heap>> m_bufferHeaps;
+        std::vector<NS::SharedPtr<MTL::Heap>> m_textureHeaps;
+        NS::SharedPtr<MTL::CommandBuffer> m_commandBuffer;
+        NS::SharedPtr<MTL::BlitCommandEncoder> m_blitEncoder;
+    };
+
 }  // namespace Conformance
 
 #endif
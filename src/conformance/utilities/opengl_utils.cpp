@@ -6,8 +6,20 @@
 #include "opengl_utils.h"
 
 #include "common/gfxwrapper_opengl.h"
+#include "file_utils.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace Conformance
 {
@@ -57,6 +69,706 @@ namespace Conformance
             XRC_CHECK_THROW_MSG(r, msg);
         }
     }
+
+    namespace
+    {
+        struct ProgramBinary
+        {
+            GLenum format{0};
+            std::vector<uint8_t> data;
+        };
+
+        constexpr char ProgramCacheMagic[4] = {'C', 'T', 'S', 'P'};
+        constexpr uint32_t ProgramCacheVersion = 1;
+
+        // Guards the directory and binaries, since sessions may be created from several threads.
+        std::mutex ProgramCacheMutex;
+        std::string ProgramCacheDirectory;
+        std::unordered_map<uint64_t, ProgramBinary> ProgramBinaries;
+
+        // 64-bit FNV-1a, over the string and its terminator so that concatenations differ.
+        void HashString(uint64_t& hash, const char* string)
+        {
+            const char* end = string + strlen(string) + 1;
+            for (const char* c = string; c != end; ++c) {
+                hash = (hash ^ (uint8_t)*c) * 1099511628211ull;
+            }
+        }
+
+        void HashGLString(uint64_t& hash, GLenum name)
+        {
+            const GLubyte* string = glGetString(name);
+            HashString(hash, string != nullptr ? reinterpret_cast<const char*>(string) : "");
+        }
+
+        uint64_t ProgramKey(const char* vertexSource, const char* fragmentSource,
+                            const std::vector<std::pair<GLuint, const char*>>& attribLocations)
+        {
+            uint64_t hash = 14695981039346656037ull;
+            HashGLString(hash, GL_VENDOR);
+            HashGLString(hash, GL_RENDERER);
+            HashGLString(hash, GL_VERSION);
+            HashString(hash, vertexSource);
+            HashString(hash, fragmentSource);
+            for (const auto& attribLocation : attribLocations) {
+                HashString(hash, std::to_string(attribLocation.first).c_str());
+                HashString(hash, attribLocation.second);
+            }
+            return hash;
+        }
+
+        bool ProgramBinariesSupported()
+        {
+#if defined(OS_WINDOWS) || defined(OS_LINUX)
+            // Loaded at run time, so missing before GL 4.1 without ARB_get_program_binary.
+            if (glGetProgramBinary == nullptr || glProgramBinary == nullptr || glProgramParameteri == nullptr) {
+                return false;
+            }
+#endif
+            GLint formatCount = 0;
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+            return glGetError() == GL_NO_ERROR && formatCount > 0;
+        }
+
+        GLuint CompileGLShader(GLenum type, const char* source)
+        {
+            GLuint shader = glCreateShader(type);
+            XRC_CHECK_THROW_GLCMD(glShaderSource(shader, 1, &source, nullptr));
+            XRC_CHECK_THROW_GLCMD(glCompileShader(shader));
+            CheckGLShader(shader);
+            return shader;
+        }
+
+        /// Returns the program, or 0 if the driver rejects @p binary.
+        GLuint LoadProgramBinary(const ProgramBinary& binary)
+        {
+            GLuint program = glCreateProgram();
+            glProgramBinary(program, binary.format, binary.data.data(), (GLsizei)binary.data.size());
+            GLint linked = GL_FALSE;
+            glGetProgramiv(program, GL_LINK_STATUS, &linked);
+            // An unsupported format is an error rather than a failed link.
+            if (glGetError() != GL_NO_ERROR || linked != GL_TRUE) {
+                glDeleteProgram(program);
+                return 0;
+            }
+            return program;
+        }
+
+        bool ReadProgramBinaryFile(const std::string& path, ProgramBinary* binary)
+        {
+            std::ifstream file(path, std::ios::binary);
+            char magic[sizeof(ProgramCacheMagic)];
+            uint32_t version = 0;
+            uint32_t format = 0;
+            if (!file.read(magic, sizeof(magic)) || memcmp(magic, ProgramCacheMagic, sizeof(magic)) != 0 ||
+                !file.read(reinterpret_cast<char*>(&version), sizeof(version)) || version != ProgramCacheVersion ||
+                !file.read(reinterpret_cast<char*>(&format), sizeof(format))) {
+                return false;
+            }
+            binary->format = (GLenum)format;
+            binary->data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            return !binary->data.empty();
+        }
+
+        /// Best effort: a binary that cannot be written just means the next run compiles the program again.
+        void WriteProgramBinaryFile(const std::string& path, const ProgramBinary& binary)
+        {
+            const uint32_t format = binary.format;
+            std::vector<uint8_t> bytes(sizeof(ProgramCacheMagic) + sizeof(ProgramCacheVersion) + sizeof(format) + binary.data.size());
+            uint8_t* dest = bytes.data();
+            memcpy(dest, ProgramCacheMagic, sizeof(ProgramCacheMagic));
+            dest += sizeof(ProgramCacheMagic);
+            memcpy(dest, &ProgramCacheVersion, sizeof(ProgramCacheVersion));
+            dest += sizeof(ProgramCacheVersion);
+            memcpy(dest, &format, sizeof(format));
+            dest += sizeof(format);
+            if (!binary.data.empty()) {
+                memcpy(dest, binary.data.data(), binary.data.size());
+            }
+            WriteFileAtomically(path, bytes);
+        }
+    }  // namespace
+
+    void SetGLProgramCacheDirectory(const std::string& directory)
+    {
+        std::lock_guard<std::mutex> lock(ProgramCacheMutex);
+        ProgramCacheDirectory = directory;
+    }
+
+    GLuint LinkGLProgram(const char* vertexSource, const char* fragmentSource,
+                         const std::vector<std::pair<GLuint, const char*>>& attribLocations)
+    {
+        const bool binariesSupported = ProgramBinariesSupported();
+        uint64_t key = 0;
+        std::string path;
+        if (binariesSupported) {
+            key = ProgramKey(vertexSource, fragmentSource, attribLocations);
+            ProgramBinary binary;
+            bool found = false;
+            {
+                std::lock_guard<std::mutex> lock(ProgramCacheMutex);
+                auto it = ProgramBinaries.find(key);
+                if (it != ProgramBinaries.end()) {
+                    binary = it->second;
+                    found = true;
+                }
+                if (!ProgramCacheDirectory.empty()) {
+                    char name[64];
+                    snprintf(name, sizeof(name), "cts_gl_program_%016llx.bin", (unsigned long long)key);
+                    path = ProgramCacheDirectory + "/" + name;
+                }
+            }
+            const bool fromFile = !found && !path.empty() && ReadProgramBinaryFile(path, &binary);
+            if (found || fromFile) {
+                GLuint program = LoadProgramBinary(binary);
+                if (program != 0) {
+                    if (fromFile) {
+                        std::lock_guard<std::mutex> lock(ProgramCacheMutex);
+                        ProgramBinaries[key] = std::move(binary);
+                    }
+                    return program;
+                }
+            }
+        }
+
+        GLuint vertexShader = CompileGLShader(GL_VERTEX_SHADER, vertexSource);
+        GLuint fragmentShader = CompileGLShader(GL_FRAGMENT_SHADER, fragmentSource);
+        GLuint program = glCreateProgram();
+        XRC_CHECK_THROW_GLCMD(glAttachShader(program, vertexShader));
+        XRC_CHECK_THROW_GLCMD(glAttachShader(program, fragmentShader));
+        for (const auto& attribLocation : attribLocations) {
+            XRC_CHECK_THROW_GLCMD(glBindAttribLocation(program, attribLocation.first, attribLocation.second));
+        }
+        if (binariesSupported) {
+            XRC_CHECK_THROW_GLCMD(glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+        }
+        XRC_CHECK_THROW_GLCMD(glLinkProgram(program));
+        CheckGLProgram(program);
+        XRC_CHECK_THROW_GLCMD(glDeleteShader(vertexShader));
+        XRC_CHECK_THROW_GLCMD(glDeleteShader(fragmentShader));
+
+        if (binariesSupported) {
+            GLint length = 0;
+            XRC_CHECK_THROW_GLCMD(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length));
+            if (length > 0) {
+                ProgramBinary binary;
+                binary.data.resize((size_t)length);
+                GLsizei written = 0;
+                XRC_CHECK_THROW_GLCMD(glGetProgramBinary(program, length, &written, &binary.format, binary.data.data()));
+                binary.data.resize((size_t)written);
+                if (!path.empty()) {
+                    WriteProgramBinaryFile(path, binary);
+                }
+                std::lock_guard<std::mutex> lock(ProgramCacheMutex);
+                ProgramBinaries[key] = std::move(binary);
+            }
+        }
+        return program;
+    }
+// OpenGL ES only has these through EXT_buffer_storage.
+#if !defined(GL_MAP_PERSISTENT_BIT) && defined(GL_MAP_PERSISTENT_BIT_EXT)
+#define GL_MAP_PERSISTENT_BIT GL_MAP_PERSISTENT_BIT_EXT
+#define GL_MAP_COHERENT_BIT GL_MAP_COHERENT_BIT_EXT
+#endif
+
+    void GLImageUploader::Allocate(Slot& slot, size_t size)
+    {
+        if (slot.buffer != 0) {
+            // Storage of persistently mapped buffers is immutable, so grow them by replacing them.
+            XRC_CHECK_THROW_GLCMD(glDeleteBuffers(1, &slot.buffer));
+            slot = {};
+        }
+        XRC_CHECK_THROW_GLCMD(glGenBuffers(1, &slot.buffer));
+        XRC_CHECK_THROW_GLCMD(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer));
+        if (m_persistentMapping) {
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            XRC_CHECK_THROW_GLCMD(glBufferStorage(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)size, nullptr, flags));
+            slot.mapping = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)size, flags);
+            XRC_CHECK_THROW_GLRESULT(glGetError(), "glMapBufferRange");
+        }
+        else {
+            XRC_CHECK_THROW_GLCMD(glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)size, nullptr, GL_STREAM_DRAW));
+        }
+        slot.size = size;
+    }
+
+    void GLImageUploader::Upload(GLenum target, GLint arraySlice, GLsizei width, GLsizei height, const void* topDownPixels)
+    {
+        const uint8_t* src = static_cast<const uint8_t*>(topDownPixels);
+        UploadRows(target, arraySlice, width, height, [&](uint32_t firstRow, uint32_t rowCount, uint8_t* dest, uint32_t rowPitch) {
+            const size_t rowSize = (size_t)width * 4;
+            for (uint32_t row = 0; row < rowCount; ++row) {
+                memcpy(dest + row * rowPitch, src + (firstRow + row) * rowSize, rowSize);
+            }
+        });
+    }
+
+    void GLImageUploader::UploadRows(GLenum target, GLint arraySlice, GLsizei width, GLsizei height, const RowWriter& writeRows)
+    {
+        const size_t rowSize = (size_t)width * 4;
+        const GLsizei bandRows = (GLsizei)std::max<size_t>(MaxBandSize / rowSize, 1);
+
+        for (GLsizei bandStart = 0; bandStart < height; bandStart += bandRows) {
+            const GLsizei rows = std::min(bandRows, height - bandStart);
+            const size_t size = rowSize * rows;
+
+            Slot& slot = m_slots[m_nextSlot];
+            m_nextSlot = (m_nextSlot + 1) % SlotCount;
+
+            if (slot.fence != nullptr) {
+                // Only block if the upload last reading from this buffer has not been executed yet.
+                const GLenum waitResult = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 10000000000 /* 10s */);
+                glDeleteSync(slot.fence);
+                slot.fence = nullptr;
+                if (waitResult == GL_WAIT_FAILED || waitResult == GL_TIMEOUT_EXPIRED) {
+                    XRC_THROW("GLImageUploader: waiting for a previous upload failed");
+                }
+            }
+
+            if (slot.size < size) {
+                Allocate(slot, size);
+            }
+            else {
+                XRC_CHECK_THROW_GLCMD(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer));
+            }
+
+            // The fence wait above already synchronized, so a non-persistent mapping does not need to wait too.
+            uint8_t* dest = static_cast<uint8_t*>(
+                m_persistentMapping ? slot.mapping
+                                    : glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)size,
+                                                       GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+            if (dest == nullptr) {
+                XRC_CHECK_THROW_GLRESULT(glGetError(), "glMapBufferRange");
+                XRC_THROW("GLImageUploader: glMapBufferRange returned null");
+            }
+            for (GLsizei y = 0; y < rows; ++y) {
+                writeRows((uint32_t)(bandStart + y), 1, dest + (rows - 1 - y) * rowSize, (uint32_t)rowSize);
+            }
+            if (!m_persistentMapping) {
+                if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_FALSE) {
+                    // The contents were lost, e.g. by a display mode change, so this upload would be garbage.
+                    XRC_THROW("GLImageUploader: glUnmapBuffer failed");
+                }
+            }
+
+            // With a pixel unpack buffer bound, the pixels pointer is an offset into it. The band's top row is its last in GL.
+            const GLint yOffset = height - bandStart - rows;
+            if (target == GL_TEXTURE_2D_ARRAY) {
+                XRC_CHECK_THROW_GLCMD(
+                    glTexSubImage3D(target, 0, 0, yOffset, arraySlice, width, rows, 1, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+            }
+            else {
+                XRC_CHECK_THROW_GLCMD(glTexSubImage2D(target, 0, 0, yOffset, width, rows, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+            }
+            XRC_CHECK_THROW_GLCMD(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+
+            slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            XRC_CHECK_THROW_GLRESULT(glGetError(), "glFenceSync");
+        }
+    }
+
+    void GLImageUploader::Reset()
+    {
+        for (Slot& slot : m_slots) {
+            if (slot.fence != nullptr) {
+                glDeleteSync(slot.fence);
+            }
+            if (slot.buffer != 0) {
+                // Deleting a buffer unmaps it.
+                glDeleteBuffers(1, &slot.buffer);
+            }
+            slot = {};
+        }
+        m_nextSlot = 0;
+    }
+
+    GLUploadWorker::GLUploadWorker(const ksGpuContext& shareContext)
+    {
+        if (!ksGpuContext_CreateShared(&m_context, &shareContext, 0)) {
+            XRC_THROW("Unable to create GL upload context");
+        }
+        m_thread = std::thread([this] { Run(); });
+    }
+
+    GLUploadWorker::~GLUploadWorker()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_submitted.notify_one();
+        m_thread.join();
+    }
+
+    GLUploadWorker::Ticket GLUploadWorker::Submit(std::function<void()> upload)
+    {
+        Ticket ticket;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ticket = ++m_lastSubmitted;
+            m_queue.emplace_back(ticket, std::move(upload));
+        }
+        m_submitted.notify_one();
+        return ticket;
+    }
+
+    void GLUploadWorker::Upload(GLenum target, GLuint texture, GLint arraySlice, GLsizei width, GLsizei height,
+                                const void* topDownPixels)
+    {
+        Wait(Submit([&] {
+            XRC_CHECK_THROW_GLCMD(glBindTexture(target, texture));
+            m_imageUploader->Upload(target, arraySlice, width, height, topDownPixels);
+            XRC_CHECK_THROW_GLCMD(glBindTexture(target, 0));
+        }));
+    }
+
+    void GLUploadWorker::UploadRows(GLenum target, GLuint texture, GLint arraySlice, GLsizei width, GLsizei height,
+                                    const GLImageUploader::RowWriter& writeRows)
+    {
+        Wait(Submit([&] {
+            XRC_CHECK_THROW_GLCMD(glBindTexture(target, texture));
+            m_imageUploader->UploadRows(target, arraySlice, width, height, writeRows);
+            XRC_CHECK_THROW_GLCMD(glBindTexture(target, 0));
+        }));
+    }
+
+    void GLUploadWorker::WaitIssued(std::unique_lock<std::mutex>& lock, Ticket ticket)
+    {
+        m_issued.wait(lock, [&] { return m_lastIssued >= ticket; });
+    }
+
+    void GLUploadWorker::Wait(Ticket ticket)
+    {
+        std::vector<GLsync> fences;
+        std::exception_ptr error;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            WaitIssued(lock, ticket);
+            while (!m_fences.empty() && m_fences.front().first <= ticket) {
+                fences.push_back(m_fences.front().second);
+                m_fences.pop_front();
+            }
+            error = std::exchange(m_error, nullptr);
+        }
+
+        if (!fences.empty()) {
+            // A fence only signals once every command before it in its context is done, so the last covers the others.
+            XRC_CHECK_THROW_GLCMD(glWaitSync(fences.back(), 0, GL_TIMEOUT_IGNORED));
+        }
+        for (GLsync fence : fences) {
+            glDeleteSync(fence);
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    void GLUploadWorker::WaitAll()
+    {
+        Ticket ticket;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ticket = m_lastSubmitted;
+        }
+        Wait(ticket);
+    }
+
+    void GLUploadWorker::Drain()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        WaitIssued(lock, m_lastSubmitted);
+        m_error = nullptr;
+    }
+
+    void GLUploadWorker::Run()
+    {
+        ksGpuContext_SetCurrent(&m_context);
+        m_imageUploader = std::make_unique<GLImageUploader>();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_submitted.wait(lock, [&] { return m_stop || !m_queue.empty(); });
+            if (m_queue.empty()) {
+                // Stopping, with everything queued done.
+                break;
+            }
+            std::pair<Ticket, std::function<void()>> upload = std::move(m_queue.front());
+            m_queue.pop_front();
+            lock.unlock();
+
+            std::exception_ptr error;
+            try {
+                upload.second();
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+            GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            // Without a flush, a context waiting for the fence could wait for ever.
+            glFlush();
+
+            lock.lock();
+            if (error && !m_error) {
+                m_error = error;
+            }
+            m_fences.emplace_back(upload.first, fence);
+            m_lastIssued = upload.first;
+            m_issued.notify_all();
+        }
+
+        for (const auto& fence : m_fences) {
+            glDeleteSync(fence.second);
+        }
+        m_fences.clear();
+        lock.unlock();
+
+        m_imageUploader->Reset();
+        m_imageUploader.reset();
+        ksGpuContext_UnsetCurrent(&m_context);
+        ksGpuContext_Destroy(&m_context);
+    }
+
+    constexpr size_t GLStreamingBuffer::RegionCount;
+    constexpr size_t GLStreamingBuffer::MinRegionSize;
+
+    void GLStreamingBuffer::Allocate(size_t regionSize)
+    {
+        // Any draws still reading the old buffer keep its storage alive until they are done.
+        Reset();
+        XRC_CHECK_THROW_GLCMD(glGenBuffers(1, &m_buffer));
+        XRC_CHECK_THROW_GLCMD(glBindBuffer(m_target, m_buffer));
+        XRC_CHECK_THROW_GLCMD(glBufferData(m_target, (GLsizeiptr)(regionSize * RegionCount), nullptr, GL_STREAM_DRAW));
+        m_regionSize = regionSize;
+    }
+
+    void GLStreamingBuffer::WaitForRegion(size_t region)
+    {
+        GLsync& fence = m_fences[region];
+        if (fence == nullptr) {
+            return;
+        }
+        GLenum waitResult = glClientWaitSync(fence, 0, 0);
+        if (waitResult == GL_TIMEOUT_EXPIRED) {
+            ++m_waitCount;
+            waitResult = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 10000000000 /* 10s */);
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+        if (waitResult == GL_WAIT_FAILED || waitResult == GL_TIMEOUT_EXPIRED) {
+            XRC_THROW("GLStreamingBuffer: waiting for the draws reading a region failed");
+        }
+    }
+
+    size_t GLStreamingBuffer::Write(const void* data, size_t size, size_t alignment)
+    {
+        size_t offset = (m_offset + alignment - 1) / alignment * alignment;
+        if (size > m_regionSize) {
+            Allocate(std::max(std::max(size, m_regionSize * 2), MinRegionSize));
+            offset = 0;
+        }
+        else if (offset + size > m_regionSize) {
+            // Everything reading the region being left has been issued by now.
+            m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            XRC_CHECK_THROW_GLRESULT(glGetError(), "glFenceSync");
+            m_region = (m_region + 1) % RegionCount;
+            WaitForRegion(m_region);
+            offset = 0;
+        }
+        XRC_CHECK_THROW_GLCMD(glBindBuffer(m_target, m_buffer));
+
+        // The fences already keep this range from being written while it is read, so the mapping does not need to wait.
+        const size_t bufferOffset = m_region * m_regionSize + offset;
+        void* dest = glMapBufferRange(m_target, (GLintptr)bufferOffset, (GLsizeiptr)size,
+                                      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (dest == nullptr) {
+            XRC_CHECK_THROW_GLRESULT(glGetError(), "glMapBufferRange");
+            XRC_THROW("GLStreamingBuffer: glMapBufferRange returned null");
+        }
+        memcpy(dest, data, size);
+        if (glUnmapBuffer(m_target) == GL_FALSE) {
+            // The contents were lost, e.g. by a display mode change, so the draws would read garbage.
+            XRC_THROW("GLStreamingBuffer: glUnmapBuffer failed");
+        }
+
+        m_offset = offset + size;
+        return bufferOffset;
+    }
+
+    void GLStreamingBuffer::Reset()
+    {
+        for (GLsync& fence : m_fences) {
+            if (fence != nullptr) {
+                glDeleteSync(fence);
+                fence = nullptr;
+            }
+        }
+        if (m_buffer != 0) {
+            glDeleteBuffers(1, &m_buffer);
+            m_buffer = 0;
+        }
+        m_regionSize = 0;
+        m_region = 0;
+        m_offset = 0;
+    }
+
+    void GLStateCache::Invalidate()
+    {
+        m_program = Unknown;
+        m_vertexArray = Unknown;
+        m_framebuffer = Unknown;
+        m_activeTextureUnit = Unknown;
+        for (GLuint unit = 0; unit < MaxTextureUnits; ++unit) {
+            m_textures[unit] = {Unknown, Unknown};
+            m_samplers[unit] = Unknown;
+        }
+        for (GLuint& enabled : m_enabled) {
+            enabled = Unknown;
+        }
+        for (GLenum& factor : m_blendFunc) {
+            factor = Unknown;
+        }
+        for (GLenum& mode : m_blendEquation) {
+            mode = Unknown;
+        }
+        m_depthFunc = Unknown;
+        m_depthMask = Unknown;
+    }
+
+    void GLStateCache::UseProgram(GLuint program)
+    {
+        if (Update(m_program, program)) {
+            XRC_CHECK_THROW_GLCMD(glUseProgram(program));
+        }
+    }
+
+    void GLStateCache::BindVertexArray(GLuint vertexArray)
+    {
+        if (Update(m_vertexArray, vertexArray)) {
+            XRC_CHECK_THROW_GLCMD(glBindVertexArray(vertexArray));
+        }
+    }
+
+    void GLStateCache::BindFramebuffer(GLuint framebuffer)
+    {
+        if (Update(m_framebuffer, framebuffer)) {
+            XRC_CHECK_THROW_GLCMD(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+        }
+    }
+
+    void GLStateCache::BindTexture(GLuint unit, GLenum target, GLuint texture)
+    {
+        if (unit >= MaxTextureUnits) {
+            m_activeTextureUnit = unit;
+            m_counts.calls += 2;
+            XRC_CHECK_THROW_GLCMD(glActiveTexture(GL_TEXTURE0 + unit));
+            XRC_CHECK_THROW_GLCMD(glBindTexture(target, texture));
+            return;
+        }
+        // Only compare the unit after the binding, since a binding already in place needs no active unit.
+        if (m_textures[unit] == TextureBinding{target, texture}) {
+            m_counts.skipped++;
+            return;
+        }
+        if (Update(m_activeTextureUnit, unit)) {
+            XRC_CHECK_THROW_GLCMD(glActiveTexture(GL_TEXTURE0 + unit));
+        }
+        m_textures[unit] = {target, texture};
+        m_counts.calls++;
+        XRC_CHECK_THROW_GLCMD(glBindTexture(target, texture));
+    }
+
+    void GLStateCache::BindSampler(GLuint unit, GLuint sampler)
+    {
+        if (unit >= MaxTextureUnits) {
+            m_counts.calls++;
+            XRC_CHECK_THROW_GLCMD(glBindSampler(unit, sampler));
+            return;
+        }
+        if (Update(m_samplers[unit], sampler)) {
+            XRC_CHECK_THROW_GLCMD(glBindSampler(unit, sampler));
+        }
+    }
+
+    void GLStateCache::SetEnabled(GLenum capability, bool enabled)
+    {
+        GLuint* cached = nullptr;
+        switch (capability) {
+        case GL_BLEND:
+            cached = &m_enabled[(size_t)Capability::Blend];
+            break;
+        case GL_CULL_FACE:
+            cached = &m_enabled[(size_t)Capability::CullFace];
+            break;
+        case GL_DEPTH_TEST:
+            cached = &m_enabled[(size_t)Capability::DepthTest];
+            break;
+        case GL_SCISSOR_TEST:
+            cached = &m_enabled[(size_t)Capability::ScissorTest];
+            break;
+        default:
+            break;
+        }
+        if (cached != nullptr && !Update(*cached, (GLuint)enabled)) {
+            return;
+        }
+        if (cached == nullptr) {
+            m_counts.calls++;
+        }
+        if (enabled) {
+            XRC_CHECK_THROW_GLCMD(glEnable(capability));
+        }
+        else {
+            XRC_CHECK_THROW_GLCMD(glDisable(capability));
+        }
+    }
+
+    void GLStateCache::BlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha)
+    {
+        if (m_blendFunc[0] == srcRGB && m_blendFunc[1] == dstRGB && m_blendFunc[2] == srcAlpha && m_blendFunc[3] == dstAlpha) {
+            m_counts.skipped++;
+            return;
+        }
+        m_blendFunc[0] = srcRGB;
+        m_blendFunc[1] = dstRGB;
+        m_blendFunc[2] = srcAlpha;
+        m_blendFunc[3] = dstAlpha;
+        m_counts.calls++;
+        XRC_CHECK_THROW_GLCMD(glBlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha));
+    }
+
+    void GLStateCache::BlendEquationSeparate(GLenum modeRGB, GLenum modeAlpha)
+    {
+        if (m_blendEquation[0] == modeRGB && m_blendEquation[1] == modeAlpha) {
+            m_counts.skipped++;
+            return;
+        }
+        m_blendEquation[0] = modeRGB;
+        m_blendEquation[1] = modeAlpha;
+        m_counts.calls++;
+        XRC_CHECK_THROW_GLCMD(glBlendEquationSeparate(modeRGB, modeAlpha));
+    }
+
+    void GLStateCache::DepthFunc(GLenum func)
+    {
+        if (Update(m_depthFunc, func)) {
+            XRC_CHECK_THROW_GLCMD(glDepthFunc(func));
+        }
+    }
+
+    void GLStateCache::DepthMask(GLboolean mask)
+    {
+        if (Update(m_depthMask, (GLuint)mask)) {
+            XRC_CHECK_THROW_GLCMD(glDepthMask(mask));
+        }
+    }
+
+    GLStateCache::Counts GLStateCache::TakeCounts()
+    {
+        Counts counts = m_counts;
+        m_counts = {};
+        return counts;
+    }
+
 }  // namespace Conformance
 
 #endif  // defined(XR_USE_GRAPHICS_API_OPENGL) || defined(XR_USE_GRAPHICS_API_OPENGL_ES)
@@ -11,7 +11,17 @@
 #include "utilities/stringification.h"
 #include "utilities/throw_helpers.h"
 
+#include <stdint.h>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace Conformance
 {
@@ -54,6 +64,275 @@ namespace Conformance
     void CheckGLShader(GLuint shader);
     void CheckGLProgram(GLuint prog);
 
+    /// Set the directory in which @ref LinkGLProgram keeps program binaries between runs. Empty, the default, keeps them in
+    /// memory only, for the later sessions of the run.
+    void SetGLProgramCacheDirectory(const std::string& directory);
+
+    /// Compile and link a program from the given shader sources, binding the given attribute locations before linking.
+    /// Throws if compiling or linking fails.
+    ///
+    /// Where program binaries are supported (GL 4.1 or ARB_get_program_binary, GLES 3.0), the linked binary is kept,
+    /// keyed by the sources, the attribute locations and the vendor, renderer and version strings of the context, and
+    /// loaded with glProgramBinary the next time the same program is asked for instead of compiling it again. A binary the
+    /// driver rejects, as it may after an update that did not change those strings, is just compiled again.
+    GLuint LinkGLProgram(const char* vertexSource, const char* fragmentSource,
+                         const std::vector<std::pair<GLuint, const char*>>& attribLocations = {});
+
+    /// Uploads top-down 8-bit RGBA images to the bottom-up level 0 of textures with a glTexSubImage call per band of rows,
+    /// rather than one per row: the rows are flipped while copying them into a pixel unpack buffer.
+    ///
+    /// A few buffers are used in turn, each fenced after use so that it is only written again once the upload reading it is done.
+    /// Bands are at most MaxBandSize bytes, so large images never need more than SlotCount bands of buffer memory.
+    /// Must only be used, and reset, with the context it was first used with current.
+    class GLImageUploader
+    {
+    public:
+        /// @param persistentMapping Map each buffer once for its lifetime, which needs GL 4.4 or EXT_buffer_storage.
+        explicit GLImageUploader(bool persistentMapping = false) : m_persistentMapping(persistentMapping)
+        {
+        }
+        GLImageUploader(const GLImageUploader&) = delete;
+        GLImageUploader& operator=(const GLImageUploader&) = delete;
+
+        /// Upload to the texture bound to @p target, which is GL_TEXTURE_2D or GL_TEXTURE_2D_ARRAY, in which case
+        /// @p arraySlice is the slice to upload to.
+        void Upload(GLenum target, GLint arraySlice, GLsizei width, GLsizei height, const void* topDownPixels);
+
+        /// Writes @p rowCount top-down rows, from row @p firstRow on, to @p dest, @p rowPitch bytes apart.
+        using RowWriter = std::function<void(uint32_t firstRow, uint32_t rowCount, uint8_t* dest, uint32_t rowPitch)>;
+
+        /// Like Upload, with the pixels written by @p writeRows straight into the pixel unpack buffers, a row at a time.
+        void UploadRows(GLenum target, GLint arraySlice, GLsizei width, GLsizei height, const RowWriter& writeRows);
+
+        /// Delete the buffers and fences.
+        void Reset();
+
+    private:
+        struct Slot
+        {
+            GLuint buffer{0};
+            GLsync fence{nullptr};
+            size_t size{0};
+            void* mapping{nullptr};
+        };
+
+        void Allocate(Slot& slot, size_t size);
+
+        static constexpr size_t SlotCount = 3;
+        static constexpr size_t MaxBandSize = 8 * 1024 * 1024;
+        bool m_persistentMapping;
+        Slot m_slots[SlotCount];
+        size_t m_nextSlot{0};
+    };
+
+    /// Runs texture and buffer uploads on a thread of its own, with a context sharing objects with the rendering context, so
+    /// that they overlap with the work of the rendering thread instead of being queued behind it.
+    ///
+    /// Each upload is fenced with glFenceSync and flushed once issued. Wait makes the commands the calling thread's context
+    /// issues afterwards wait for an upload on the GPU with glWaitSync, only blocking the CPU until the worker has issued it.
+    /// Objects an upload modifies must be bound again in the rendering context after waiting for it before their new contents
+    /// are guaranteed to be seen there.
+    class GLUploadWorker
+    {
+    public:
+        using Ticket = uint64_t;
+
+        /// Create a context sharing objects with @p shareContext, which must be current on the calling thread, and start the
+        /// thread that makes it current. With GLX, the context is made current through the Display of @p shareContext, which
+        /// must have been opened after XInitThreads.
+        explicit GLUploadWorker(const ksGpuContext& shareContext);
+        /// Finish the uploads already queued, then stop the thread and destroy its context.
+        ~GLUploadWorker();
+        GLUploadWorker(const GLUploadWorker&) = delete;
+        GLUploadWorker& operator=(const GLUploadWorker&) = delete;
+
+        /// Queue @p upload to run on the worker thread, with its context current.
+        Ticket Submit(std::function<void()> upload);
+
+        /// Upload to @p texture, bound to @p target, on the worker thread with a GLImageUploader of its own, see
+        /// GLImageUploader::Upload. Returns once the pixels have been read, and makes the calling context wait for the upload.
+        void Upload(GLenum target, GLuint texture, GLint arraySlice, GLsizei width, GLsizei height, const void* topDownPixels);
+
+        /// Like Upload, see GLImageUploader::UploadRows. Returns once @p writeRows has been called for every row.
+        void UploadRows(GLenum target, GLuint texture, GLint arraySlice, GLsizei width, GLsizei height,
+                        const GLImageUploader::RowWriter& writeRows);
+
+        /// Block until the upload of @p ticket, and every one queued before it, has been issued, then make the calling
+        /// thread's context wait for them on the GPU. Rethrows the first exception an upload threw since the last call.
+        void Wait(Ticket ticket);
+
+        /// Wait for every upload queued so far.
+        void WaitAll();
+
+        /// Block until every upload queued so far has run, without making the calling context wait for them or rethrowing
+        /// what they threw: for when the data they read is about to go away after an error.
+        void Drain();
+
+    private:
+        void Run();
+        void WaitIssued(std::unique_lock<std::mutex>& lock, Ticket ticket);
+
+        ksGpuContext m_context{};
+        std::thread m_thread;
+        std::mutex m_mutex;
+        std::condition_variable m_submitted;
+        std::condition_variable m_issued;
+        std::deque<std::pair<Ticket, std::function<void()>>> m_queue;
+        /// Fences of the uploads issued and not yet waited for, oldest first
+        std::deque<std::pair<Ticket, GLsync>> m_fences;
+        std::exception_ptr m_error;
+        Ticket m_lastSubmitted{0};
+        Ticket m_lastIssued{0};
+        bool m_stop{false};
+        /// Used on the worker thread only
+        std::unique_ptr<GLImageUploader> m_imageUploader;
+    };
+
+    /// Streams per-draw data, such as instance attributes, into one buffer through unsynchronized mappings, rather than
+    /// orphaning the buffer with glBufferData for every upload and leaving the driver to track the orphaned storage.
+    ///
+    /// The buffer is a ring of RegionCount regions, which bounds the frames that may still be reading from it. Writing moves on
+    /// to the next region once the current one is full, fencing the one it leaves, and only blocks on that fence when it comes
+    /// back around to it. Must only be used, and reset, with the context it was first used with current.
+    class GLStreamingBuffer
+    {
+    public:
+        explicit GLStreamingBuffer(GLenum target) : m_target(target)
+        {
+        }
+        GLStreamingBuffer(const GLStreamingBuffer&) = delete;
+        GLStreamingBuffer& operator=(const GLStreamingBuffer&) = delete;
+
+        /// Copy @p size bytes into the buffer at an offset aligned to @p alignment, and return that offset.
+        /// Leaves the buffer bound to the target.
+        size_t Write(const void* data, size_t size, size_t alignment);
+
+        /// The buffer written to last, or 0 if nothing has been written yet.
+        GLuint GetBuffer() const
+        {
+            return m_buffer;
+        }
+
+        /// How many writes had to wait for the GPU to finish reading a region, which means more frames are in flight than
+        /// there are regions.
+        uint64_t GetWaitCount() const
+        {
+            return m_waitCount;
+        }
+
+        /// Delete the buffer and fences.
+        void Reset();
+
+    private:
+        void Allocate(size_t regionSize);
+        void WaitForRegion(size_t region);
+
+        static constexpr size_t RegionCount = 3;
+        static constexpr size_t MinRegionSize = 64 * 1024;
+        GLenum m_target;
+        GLuint m_buffer{0};
+        GLsync m_fences[RegionCount]{};
+        size_t m_regionSize{0};
+        size_t m_region{0};
+        size_t m_offset{0};
+        uint64_t m_waitCount{0};
+    };
+
+    /// Shadows the bindings and fixed-function state set while rendering a view, so that setting what is already set can be
+    /// skipped, and counts the calls made and skipped.
+    ///
+    /// Only state set through the cache is known to it: call Invalidate() whenever other code may have changed it, such as at the
+    /// start of each view. Capabilities other than GL_BLEND, GL_CULL_FACE, GL_DEPTH_TEST and GL_SCISSOR_TEST, and texture units
+    /// past MaxTextureUnits, are always set.
+    class GLStateCache
+    {
+    public:
+        static constexpr GLuint MaxTextureUnits = 16;
+
+        struct Counts
+        {
+            /// State calls made to GL
+            uint64_t calls{0};
+            /// State calls skipped because they would have set what was already set
+            uint64_t skipped{0};
+        };
+
+        GLStateCache()
+        {
+            Invalidate();
+        }
+
+        /// Forget all the state, so that each state is set the next time it is asked for.
+        void Invalidate();
+
+        void UseProgram(GLuint program);
+        void BindVertexArray(GLuint vertexArray);
+        /// Binds to GL_FRAMEBUFFER.
+        void BindFramebuffer(GLuint framebuffer);
+        /// Binds @p texture to @p target of texture unit @p unit, making it the active texture unit if it is bound.
+        void BindTexture(GLuint unit, GLenum target, GLuint texture);
+        void BindSampler(GLuint unit, GLuint sampler);
+
+        void SetEnabled(GLenum capability, bool enabled);
+        void BlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha);
+        void BlendEquationSeparate(GLenum modeRGB, GLenum modeAlpha);
+        void DepthFunc(GLenum func);
+        void DepthMask(GLboolean mask);
+
+        /// Return the calls made and skipped since the last call, and reset them.
+        Counts TakeCounts();
+
+    private:
+        // Compare a cached value with the one asked for, updating it and counting the call. Returns true if it must be set.
+        template <typename T>
+        bool Update(T& cached, const T& value)
+        {
+            if (cached == value) {
+                m_counts.skipped++;
+                return false;
+            }
+            cached = value;
+            m_counts.calls++;
+            return true;
+        }
+
+        enum class Capability
+        {
+            Blend,
+            CullFace,
+            DepthTest,
+            ScissorTest,
+            Count,
+        };
+
+        struct TextureBinding
+        {
+            GLenum target;
+            GLuint texture;
+            bool operator==(const TextureBinding& other) const
+            {
+                return target == other.target && texture == other.texture;
+            }
+        };
+
+        // Used for state whose value is not known, since no GL object name or enum has this value.
+        static constexpr GLuint Unknown = ~GLuint(0);
+
+        GLuint m_program;
+        GLuint m_vertexArray;
+        GLuint m_framebuffer;
+        GLuint m_activeTextureUnit;
+        TextureBinding m_textures[MaxTextureUnits];
+        GLuint m_samplers[MaxTextureUnits];
+        // 0 or 1 when known
+        GLuint m_enabled[(size_t)Capability::Count];
+        GLenum m_blendFunc[4];
+        GLenum m_blendEquation[2];
+        GLenum m_depthFunc;
+        GLuint m_depthMask;
+        Counts m_counts;
+    };
+
 }  // namespace Conformance
 
 #endif  // defined(XR_USE_GRAPHICS_API_OPENGL) || defined(XR_USE_GRAPHICS_API_OPENGL_ES)
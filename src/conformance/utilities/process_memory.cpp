@@ -0,0 +1,83 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "process_memory.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#elif defined(__linux__)
+#include <cstdio>
+#include <unistd.h>
+#endif
+
+namespace Conformance
+{
+    uint64_t GetProcessResidentMemoryBytes()
+    {
+#if defined(_WIN32)
+        PROCESS_MEMORY_COUNTERS counters{};
+        counters.cb = sizeof(counters);
+        // The K32 prefixed entry point lives in kernel32, so psapi.lib need not be linked.
+        if (!K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+            return 0;
+        }
+        return counters.WorkingSetSize;
+#elif defined(__APPLE__)
+        mach_task_basic_info info{};
+        mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+        if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS) {
+            return 0;
+        }
+        return info.resident_size;
+#elif defined(__linux__)
+        // Covers Android too: the second field of statm is the resident page count.
+        FILE* statm = fopen("/proc/self/statm", "r");
+        if (statm == nullptr) {
+            return 0;
+        }
+        unsigned long long totalPages = 0;
+        unsigned long long residentPages = 0;
+        const int fieldCount = fscanf(statm, "%llu %llu", &totalPages, &residentPages);
+        fclose(statm);
+        if (fieldCount != 2) {
+            return 0;
+        }
+        return residentPages * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#else
+        return 0;
+#endif
+    }
+
+    ResidentGrowth AnalyzeResidentGrowth(const std::vector<uint64_t>& samples, uint64_t minGrowthBytes)
+    {
+        ResidentGrowth growth;
+        if (samples.size() < 2) {
+            return growth;
+        }
+        growth.totalBytes = static_cast<int64_t>(samples.back()) - static_cast<int64_t>(samples.front());
+        growth.steps = static_cast<uint32_t>(samples.size() - 1);
+        for (size_t i = 1; i < samples.size(); ++i) {
+            if (samples[i] > samples[i - 1]) {
+                growth.growingSteps++;
+            }
+        }
+        growth.steady = growth.totalBytes > static_cast<int64_t>(minGrowthBytes) && growth.growingSteps * 5 >= growth.steps * 4;
+        return growth;
+    }
+}  // namespace Conformance
@@ -0,0 +1,45 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Conformance
+{
+    /// Resident set size of the current process in bytes, including any in-process runtime.
+    ///
+    /// Returns 0 on platforms where it cannot be queried, so callers reporting memory growth should skip the report then.
+    uint64_t GetProcessResidentMemoryBytes();
+
+    /// How the resident set changed over samples taken after each of a series of equal rounds of work.
+    struct ResidentGrowth
+    {
+        /// From the first sample to the last, negative if the resident set shrank
+        int64_t totalBytes{0};
+        /// Steps between consecutive samples, and how many of them grew the resident set
+        uint32_t steps{0};
+        uint32_t growingSteps{0};
+        /// Grew by more than the threshold overall, and at most one step in five did not grow. Work that leaks grows the
+        /// resident set round after round, whereas allocator caches and page reuse level off or shrink it now and then.
+        bool steady{false};
+    };
+
+    /// Analyze @p samples, as returned by GetProcessResidentMemoryBytes, flagging steady growth of more than @p minGrowthBytes.
+    /// Take the first sample after a warm-up round, so that one-time allocations are not counted.
+    ResidentGrowth AnalyzeResidentGrowth(const std::vector<uint64_t>& samples, uint64_t minGrowthBytes);
+}  // namespace Conformance
@@ -0,0 +1,48 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "process_time.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__APPLE__) || defined(__linux__)
+#include <time.h>
+#endif
+
+namespace Conformance
+{
+    double GetProcessCpuSeconds()
+    {
+#if defined(_WIN32)
+        FILETIME creationTime, exitTime, kernelTime, userTime;
+        if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime)) {
+            return 0;
+        }
+        auto toTicks = [](const FILETIME& t) { return (static_cast<unsigned long long>(t.dwHighDateTime) << 32) | t.dwLowDateTime; };
+        // FILETIME counts 100ns ticks.
+        return static_cast<double>(toTicks(kernelTime) + toTicks(userTime)) * 1e-7;
+#elif defined(__APPLE__) || defined(__linux__)
+        // Covers Android too.
+        timespec ts{};
+        if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) != 0) {
+            return 0;
+        }
+        return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+#else
+        return 0;
+#endif
+    }
+}  // namespace Conformance
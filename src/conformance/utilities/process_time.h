@@ -0,0 +1,26 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+namespace Conformance
+{
+    /// CPU time (user and kernel) consumed so far by all threads of the current process, including any in-process
+    /// runtime, in seconds.
+    ///
+    /// Returns 0 on platforms where it cannot be queried, so callers reporting CPU time should skip the report then.
+    double GetProcessCpuSeconds();
+}  // namespace Conformance
@@ -0,0 +1,140 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace Conformance
+{
+    /// Bounded single-producer, single-consumer queue that hands values from one thread to another without locking.
+    ///
+    /// Exactly one thread may push, with @ref TryPush or @ref Push, and exactly one (other) thread may pop, with @ref TryPop
+    /// or @ref Pop. The blocking @ref Push and @ref Pop only lock to sleep while the queue is full or empty, and to wake the
+    /// other side, so neither side spins.
+    template <typename T>
+    class SpscQueue
+    {
+    public:
+        /// @param capacity The most values that can be queued at once: must be at least 1.
+        explicit SpscQueue(size_t capacity) : m_slots(capacity + 1)
+        {
+        }
+
+        /// Producer side: queue @p value, or return false if the queue is full.
+        bool TryPush(const T& value)
+        {
+            const size_t tail = m_tail.load(std::memory_order_relaxed);
+            const size_t next = Next(tail);
+            if (next == m_head.load(std::memory_order_acquire)) {
+                return false;
+            }
+            m_slots[tail] = value;
+            m_tail.store(next, std::memory_order_release);
+            return true;
+        }
+
+        /// Consumer side: dequeue the oldest value into @p value, or return false if the queue is empty.
+        bool TryPop(T& value)
+        {
+            const size_t head = m_head.load(std::memory_order_relaxed);
+            if (head == m_tail.load(std::memory_order_acquire)) {
+                return false;
+            }
+            value = m_slots[head];
+            m_head.store(Next(head), std::memory_order_release);
+            return true;
+        }
+
+        /// Producer side: queue @p value, sleeping while the queue is full.
+        /// Returns false without queuing @p value once the queue has been closed.
+        bool Push(const T& value)
+        {
+            for (;;) {
+                if (m_closed.load(std::memory_order_acquire)) {
+                    return false;
+                }
+                if (TryPush(value)) {
+                    Notify();
+                    return true;
+                }
+                std::unique_lock<std::mutex> lock(m_waitMutex);
+                m_waitCondition.wait(lock, [&] {
+                    return m_closed.load(std::memory_order_acquire) ||
+                           Next(m_tail.load(std::memory_order_relaxed)) != m_head.load(std::memory_order_acquire);
+                });
+            }
+        }
+
+        /// Consumer side: dequeue the oldest value into @p value, sleeping while the queue is empty.
+        /// Returns false once the queue has been closed and every value queued before has been popped.
+        bool Pop(T& value)
+        {
+            for (;;) {
+                if (TryPop(value)) {
+                    Notify();
+                    return true;
+                }
+                std::unique_lock<std::mutex> lock(m_waitMutex);
+                if (m_closed.load(std::memory_order_acquire) && IsEmpty()) {
+                    return false;
+                }
+                m_waitCondition.wait(lock, [&] { return m_closed.load(std::memory_order_acquire) || !IsEmpty(); });
+            }
+        }
+
+        /// Stop the queue: @ref Push fails from now on, and @ref Pop fails once the queue is empty. Wakes a sleeping
+        /// @ref Push or @ref Pop. May be called from either side.
+        void Close()
+        {
+            m_closed.store(true, std::memory_order_release);
+            Notify();
+        }
+
+    private:
+        bool IsEmpty() const
+        {
+            return m_head.load(std::memory_order_relaxed) == m_tail.load(std::memory_order_acquire);
+        }
+
+        void Notify()
+        {
+            // Taking the lock orders this with a waiter checking its condition, so the wake-up cannot be missed.
+            {
+                std::lock_guard<std::mutex> lock(m_waitMutex);
+            }
+            m_waitCondition.notify_all();
+        }
+
+        size_t Next(size_t index) const
+        {
+            return (index + 1 == m_slots.size()) ? 0 : index + 1;
+        }
+
+        // One slot is always left empty, to tell a full queue from an empty one.
+        std::vector<T> m_slots;
+        std::atomic<size_t> m_head{0};
+        std::atomic<size_t> m_tail{0};
+
+        std::atomic<bool> m_closed{false};
+        std::mutex m_waitMutex;
+        std::condition_variable m_waitCondition;
+    };
+}  // namespace Conformance
@@ -18,6 +18,7 @@
 
 #include "utils.h"
 #include "stringification.h"
+#include "trace.h"
 
 #include <string>
 #include <stdexcept>
@@ -107,8 +108,9 @@ namespace Conformance
                                                      const char* sourceLocation = nullptr) noexcept(false);
 
 #define XRC_THROW_XRRESULT(xr, cmd) ::Conformance::ThrowXrResult(xr, #cmd, XRC_FILE_AND_LINE);
-#define XRC_CHECK_THROW_XRCMD(cmd) ::Conformance::CheckThrowXrResult(cmd, #cmd, XRC_FILE_AND_LINE);
-#define XRC_CHECK_THROW_XRCMD_UNQUALIFIED_SUCCESS(cmd) ::Conformance::CheckThrowXrResultUnqualifiedSuccess(cmd, #cmd, XRC_FILE_AND_LINE);
+#define XRC_CHECK_THROW_XRCMD(cmd) ::Conformance::CheckThrowXrResult((XRC_TRACE_CALL(#cmd), cmd), #cmd, XRC_FILE_AND_LINE);
+#define XRC_CHECK_THROW_XRCMD_UNQUALIFIED_SUCCESS(cmd) \
+    ::Conformance::CheckThrowXrResultUnqualifiedSuccess((XRC_TRACE_CALL(#cmd), cmd), #cmd, XRC_FILE_AND_LINE);
 #define XRC_CHECK_THROW_XRRESULT(res, cmdStr) ::Conformance::CheckThrowXrResult(res, cmdStr, XRC_FILE_AND_LINE);
 #define XRC_CHECK_THROW_XRRESULT_SUCCESS_OR_LIMIT_REACHED(res, cmdStr) \
     ::Conformance::CheckThrowXrResultSuccessOrLimitReached(res, cmdStr, XRC_FILE_AND_LINE);
@@ -0,0 +1,172 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "trace.h"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+#include <unordered_set>
+#include <vector>
+
+#if defined(_WIN32)
+#include <process.h>
+#define XRC_GETPID _getpid
+#else
+#include <unistd.h>
+#define XRC_GETPID getpid
+#endif
+
+namespace Conformance
+{
+    namespace detail
+    {
+        std::atomic<bool> g_tracing{false};
+
+        int64_t TraceNow()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+    }  // namespace detail
+
+    namespace
+    {
+        struct TraceEvent
+        {
+            const char* name;
+            int64_t start;
+            int64_t end;
+            bool isCall;
+        };
+
+        /// Events of one thread. Threads only lock their own buffer, so recording does not contend unless the trace is
+        /// being written at the same time.
+        struct ThreadTraceBuffer
+        {
+            std::mutex mutex;
+            std::vector<TraceEvent> events;
+            uint32_t threadIndex;
+        };
+
+        struct TraceState
+        {
+            std::mutex mutex;
+            std::string path;
+            std::vector<std::shared_ptr<ThreadTraceBuffer>> buffers;
+            std::unordered_set<std::string> names;
+        };
+
+        TraceState& GetTraceState()
+        {
+            // Leaked, so that threads still running at exit can record safely.
+            static TraceState* state = new TraceState();
+            return *state;
+        }
+
+        ThreadTraceBuffer& GetThreadTraceBuffer()
+        {
+            // The state shares ownership, so events outlive a thread that ends before the trace is written.
+            thread_local std::shared_ptr<ThreadTraceBuffer> buffer = [] {
+                TraceState& state = GetTraceState();
+                std::lock_guard<std::mutex> lock(state.mutex);
+                auto newBuffer = std::make_shared<ThreadTraceBuffer>();
+                newBuffer->threadIndex = static_cast<uint32_t>(state.buffers.size()) + 1;
+                state.buffers.push_back(newBuffer);
+                return newBuffer;
+            }();
+            return *buffer;
+        }
+
+        /// JSON escaped event name: only the function name of a traced call such as `xrEndFrame(session, &frameEndInfo)`.
+        std::string TraceEventName(const TraceEvent& event)
+        {
+            std::string result;
+            for (const char* c = event.name; *c != '\0' && !(event.isCall && *c == '('); ++c) {
+                if (*c == '"' || *c == '\\') {
+                    result += '\\';
+                }
+                if (static_cast<unsigned char>(*c) >= 0x20) {
+                    result += *c;
+                }
+            }
+            return result;
+        }
+    }  // namespace
+
+    namespace detail
+    {
+        void RecordTraceEvent(const char* name, int64_t start, int64_t end, bool isCall)
+        {
+            ThreadTraceBuffer& buffer = GetThreadTraceBuffer();
+            std::lock_guard<std::mutex> lock(buffer.mutex);
+            buffer.events.push_back({name, start, end, isCall});
+        }
+    }  // namespace detail
+
+    bool StartTracing(const std::string& path)
+    {
+#if defined(XRC_ENABLE_TRACING)
+        TraceState& state = GetTraceState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.path = path;
+        detail::g_tracing = true;
+        return true;
+#else
+        (void)path;
+        return false;
+#endif
+    }
+
+    bool StopTracing()
+    {
+        if (!detail::g_tracing.exchange(false)) {
+            return true;
+        }
+        TraceState& state = GetTraceState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        FILE* file = fopen(state.path.c_str(), "w");
+        if (file == nullptr) {
+            return false;
+        }
+        const int pid = static_cast<int>(XRC_GETPID());
+        fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        bool first = true;
+        for (const std::shared_ptr<ThreadTraceBuffer>& buffer : state.buffers) {
+            std::vector<TraceEvent> events;
+            {
+                std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+                events.swap(buffer->events);
+            }
+            for (const TraceEvent& event : events) {
+                fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", first ? "" : ",\n",
+                        TraceEventName(event).c_str(), pid, buffer->threadIndex, static_cast<double>(event.start) * 1e-3,
+                        static_cast<double>(event.end - event.start) * 1e-3);
+                first = false;
+            }
+        }
+        fprintf(file, "\n]}\n");
+        return fclose(file) == 0;
+    }
+
+    const char* InternTraceName(const std::string& name)
+    {
+        TraceState& state = GetTraceState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        // Set nodes do not move, so the pointer stays valid.
+        return state.names.insert(name).first->c_str();
+    }
+}  // namespace Conformance
@@ -0,0 +1,90 @@
+// Copyright (c) 2019-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+
+/// Build with XRC_ENABLE_TRACING defined (the BUILD_CONFORMANCE_TRACING CMake option) to compile in the trace markers.
+/// Without it, XRC_TRACE_SCOPE and XRC_TRACE_CALL expand to nothing and tracing cannot be started.
+#if defined(XRC_ENABLE_TRACING)
+#define XRC_TRACE_CONCAT_IMPL(a, b) a##b
+#define XRC_TRACE_CONCAT(a, b) XRC_TRACE_CONCAT_IMPL(a, b)
+/// Record the time from here to the end of the enclosing scope as a trace event. @p name must be a string literal.
+#define XRC_TRACE_SCOPE(name) ::Conformance::TraceScope XRC_TRACE_CONCAT(xrcTraceScope, __LINE__)(name)
+/// Record the rest of the full expression this appears in, through a comma operator, as a trace event. @p name is the
+/// text of a call, such as `xrEndFrame(session, &frameEndInfo)`, and the event is named after the function called.
+#define XRC_TRACE_CALL(name) ::Conformance::TraceScope(name, true)
+#else
+#define XRC_TRACE_SCOPE(name) (void)0
+#define XRC_TRACE_CALL(name) (void)0
+#endif
+
+namespace Conformance
+{
+    /// Start recording trace events from all threads, to be written to @p path by StopTracing. Returns false if tracing is
+    /// compiled out.
+    ///
+    /// The file is in the Chrome trace event JSON format, which chrome://tracing and Perfetto open. Timestamps are the
+    /// steady clock in microseconds, which is the clock XrTime is based on with XR_KHR_convert_timespec_time and
+    /// XR_KHR_win32_convert_performance_counter_time, so a runtime trace on the same clock lines up with it.
+    bool StartTracing(const std::string& path);
+
+    /// Write the events recorded since StartTracing and stop recording. Returns false if the file could not be written.
+    bool StopTracing();
+
+    namespace detail
+    {
+        extern std::atomic<bool> g_tracing;
+        int64_t TraceNow();
+        void RecordTraceEvent(const char* name, int64_t start, int64_t end, bool isCall);
+    }  // namespace detail
+
+    inline bool IsTracing()
+    {
+        return detail::g_tracing.load(std::memory_order_relaxed);
+    }
+
+    /// Return a copy of @p name that lives until the process exits, for naming trace events after runtime strings such as
+    /// test sections. Meant for names that repeat, since each distinct name is kept.
+    const char* InternTraceName(const std::string& name);
+
+    /// Records its lifetime as a trace event, if tracing was started. Use through XRC_TRACE_SCOPE.
+    class TraceScope
+    {
+    public:
+        explicit TraceScope(const char* name, bool isCall = false) noexcept
+            : m_name(name), m_start(IsTracing() ? detail::TraceNow() : -1), m_isCall(isCall)
+        {
+        }
+        ~TraceScope()
+        {
+            if (m_start >= 0) {
+                detail::RecordTraceEvent(m_name, m_start, detail::TraceNow(), m_isCall);
+            }
+        }
+
+        TraceScope(const TraceScope&) = delete;
+        TraceScope& operator=(const TraceScope&) = delete;
+
+    private:
+        const char* m_name;
+        int64_t m_start;
+        bool m_isCall;
+    };
+}  // namespace Conformance
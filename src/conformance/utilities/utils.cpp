@@ -32,6 +32,11 @@
 
 #ifdef _WIN32
 #include <windows.h>
+#elif !defined(XR_USE_PLATFORM_ANDROID)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 
 #ifdef XR_USE_PLATFORM_ANDROID
@@ -132,6 +137,84 @@ namespace Conformance
         return data;
     }
 
+    MappedFile::MappedFile(const char* path, const char* description)
+    {
+        auto space = (description[0] == '\0') ? "" : " ";
+#ifdef XR_USE_PLATFORM_ANDROID
+        AAssetManager* assetManager = (AAssetManager*)Conformance_Android_Get_Asset_Manager();
+        std::shared_ptr<AAsset> asset(AAssetManager_open(assetManager, path, AASSET_MODE_BUFFER), deleters::AAssetDeleter{});
+        if (!asset) {
+            throw std::runtime_error((std::string("Unable to load ") + description + space + "asset " + path).c_str());
+        }
+
+        // The buffer stays valid, and is mapped rather than copied for uncompressed assets, until the asset is closed.
+        m_data = (const uint8_t*)AAsset_getBuffer(asset.get());
+        if (!m_data) {
+            throw std::runtime_error((std::string("Unable to load ") + description + space + "asset " + path).c_str());
+        }
+        m_size = AAsset_getLength(asset.get());
+        m_mapping = std::move(asset);
+#elif defined(_WIN32)
+        HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error((std::string("Unable to open ") + description + space + "file " + path).c_str());
+        }
+
+        LARGE_INTEGER fileSize{};
+        if (!GetFileSizeEx(file, &fileSize)) {
+            CloseHandle(file);
+            throw std::runtime_error((std::string("Unable to open ") + description + space + "file " + path).c_str());
+        }
+        m_size = (size_t)fileSize.QuadPart;
+        if (m_size == 0) {
+            // Empty files cannot be mapped.
+            CloseHandle(file);
+            return;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        // The view keeps the file open.
+        CloseHandle(file);
+        if (mapping == nullptr) {
+            throw std::runtime_error((std::string("Unable to map ") + description + space + "file " + path).c_str());
+        }
+        const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (view == nullptr) {
+            throw std::runtime_error((std::string("Unable to map ") + description + space + "file " + path).c_str());
+        }
+        m_data = (const uint8_t*)view;
+        m_mapping = std::shared_ptr<const void>(view, [](const void* v) { UnmapViewOfFile(v); });
+#else
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error((std::string("Unable to open ") + description + space + "file " + path).c_str());
+        }
+
+        struct stat fileStat = {};
+        if (fstat(fd, &fileStat) != 0) {
+            close(fd);
+            throw std::runtime_error((std::string("Unable to open ") + description + space + "file " + path).c_str());
+        }
+        m_size = (size_t)fileStat.st_size;
+        if (m_size == 0) {
+            // Empty files cannot be mapped.
+            close(fd);
+            return;
+        }
+
+        void* view = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        // The mapping keeps the file open.
+        close(fd);
+        if (view == MAP_FAILED) {
+            throw std::runtime_error((std::string("Unable to map ") + description + space + "file " + path).c_str());
+        }
+        m_data = (const uint8_t*)view;
+        const size_t size = m_size;
+        m_mapping = std::shared_ptr<const void>(view, [size](const void* v) { munmap(const_cast<void*>(v), size); });
+#endif
+    }
+
     // Provides a managed set of random number generators. Currently the usage of these generators
     // is imperfect because modulus (%) operations are done against their results, which introduces
     // a slight skew in the distribution for most ranges. C++ random number generation requires
@@ -249,6 +249,31 @@ namespace Conformance
     /// errors in case this fails, e.g. "texture".
     std::vector<uint8_t> ReadFileBytes(const char* path, const char* description = "");
 
+    /// A read-only view of the file at path @p path, memory-mapped (or, on Android, the buffer of the asset) so that
+    /// its content is paged in on demand rather than copied. Throws in the same cases as ReadFileBytes.
+    /// Copies share the mapping, which is released with the last of them.
+    class MappedFile
+    {
+    public:
+        explicit MappedFile(const char* path, const char* description = "");
+
+        const uint8_t* data() const
+        {
+            return m_data;
+        }
+
+        size_t size() const
+        {
+            return m_size;
+        }
+
+    private:
+        /// Releases the mapping when the last copy is destroyed.
+        std::shared_ptr<const void> m_mapping;
+        const uint8_t* m_data{nullptr};
+        size_t m_size{0};
+    };
+
     /// SleepMs
     ///
     /// Sleeps the current thread for at least the given milliseconds. Attempt is made to return
@@ -6,7 +6,10 @@
 
 #ifdef XR_USE_GRAPHICS_API_VULKAN
 
+#include "destruction_queue.h"
+#include "file_utils.h"
 #include "throw_helpers.h"
+#include "vulkan_scoped_handle.h"
 #include "common/xr_linear.h"
 #include "common/xr_dependencies.h"
 #include "common/vulkan_debug_object_namer.hpp"
@@ -15,9 +18,16 @@
 
 #include <nonstd/span.hpp>
 
+#include <algorithm>
+#include <assert.h>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <stdio.h>
+#include <string.h>
 #include <string>
 #include <vector>
-#include <cstdint>
 
 //#define USE_ONLINE_VULKAN_SHADERC
 #ifdef USE_ONLINE_VULKAN_SHADERC
@@ -167,44 +177,331 @@ namespace Conformance
 #define XRC_CHECK_THROW_VKCMD(cmd) ::Conformance::CheckThrowVkResult(cmd, #cmd, XRC_FILE_AND_LINE);
 #define XRC_CHECK_THROW_VKRESULT(res, cmdStr) ::Conformance::CheckThrowVkResult(res, cmdStr, XRC_FILE_AND_LINE);
 
+    struct MemoryAllocator;
+    class MemoryPage;
+
+    /// The kind of resource bound to a sub-allocation.
+    ///
+    /// Linear (buffer) and optimal-tiling (image) resources never share a page,
+    /// so bufferImageGranularity never has to be considered when placing them.
+    enum class MemoryResourceKind
+    {
+        Buffer,
+        Image,
+    };
+
+    /// A range of device memory handed out by @ref MemoryAllocator::SubAllocate.
+    /// Bind your resource to @p memory at @p offset, and give it back with @ref MemoryAllocator::Free.
+    struct MemoryAllocation
+    {
+        VkDeviceMemory memory{VK_NULL_HANDLE};
+        VkDeviceSize offset{0};
+        VkDeviceSize size{0};
+        /// Host pointer to the start of this range if the memory is host visible (pages are persistently mapped), otherwise nullptr.
+        uint8_t* mapped{nullptr};
+
+        MemoryAllocator* allocator{nullptr};
+        MemoryPage* page{nullptr};
+    };
+
+    /// Bytes held by a @ref MemoryAllocator compared to bytes actually handed out.
+    struct MemoryAllocatorStats
+    {
+        /// Total size of all pages (VkDeviceMemory objects) currently held
+        VkDeviceSize bytesReserved{0};
+        /// Total size of all live sub-allocations
+        VkDeviceSize bytesUsed{0};
+        uint32_t pageCount{0};
+        uint32_t allocationCount{0};
+    };
+
+    /// One VkDeviceMemory object, sub-allocated first-fit from a free list of ranges that are coalesced when freed.
+    class MemoryPage
+    {
+    public:
+        MemoryPage(VkDevice device, uint32_t memoryTypeIndex, MemoryResourceKind kind, VkDeviceSize size, bool hostVisible,
+                   bool dedicated)
+            : m_vkDevice(device), m_memoryTypeIndex(memoryTypeIndex), m_kind(kind), m_size(size), m_dedicated(dedicated)
+        {
+            VkMemoryAllocateInfo memAlloc{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+            memAlloc.allocationSize = size;
+            memAlloc.memoryTypeIndex = memoryTypeIndex;
+            XRC_CHECK_THROW_VKCMD(vkAllocateMemory(device, &memAlloc, nullptr, &m_memory));
+            if (hostVisible) {
+                XRC_CHECK_THROW_VKCMD(vkMapMemory(device, m_memory, 0, VK_WHOLE_SIZE, 0, (void**)&m_mapped));
+            }
+            m_freeRanges.emplace(VkDeviceSize{0}, size);
+        }
+
+        ~MemoryPage()
+        {
+            if (m_memory != VK_NULL_HANDLE) {
+                // Freeing implicitly unmaps
+                vkFreeMemory(m_vkDevice, m_memory, nullptr);
+            }
+        }
+
+        MemoryPage(const MemoryPage&) = delete;
+        MemoryPage& operator=(const MemoryPage&) = delete;
+        MemoryPage(MemoryPage&&) = delete;
+        MemoryPage& operator=(MemoryPage&&) = delete;
+
+        /// True if allocations of this memory type and kind may be placed in this page
+        bool IsCompatible(uint32_t memoryTypeIndex, MemoryResourceKind kind) const
+        {
+            return !m_dedicated && m_memoryTypeIndex == memoryTypeIndex && m_kind == kind;
+        }
+
+        bool IsDedicated() const
+        {
+            return m_dedicated;
+        }
+
+        uint32_t GetMemoryTypeIndex() const
+        {
+            return m_memoryTypeIndex;
+        }
+
+        MemoryResourceKind GetKind() const
+        {
+            return m_kind;
+        }
+
+        bool Empty() const
+        {
+            return m_allocationCount == 0;
+        }
+
+        VkDeviceSize GetSize() const
+        {
+            return m_size;
+        }
+
+        VkDeviceSize GetUsedBytes() const
+        {
+            return m_usedBytes;
+        }
+
+        uint32_t GetAllocationCount() const
+        {
+            return m_allocationCount;
+        }
+
+        /// Try to carve out @p size bytes aligned to @p alignment, populating @p alloc on success.
+        bool TryAllocate(VkDeviceSize size, VkDeviceSize alignment, MemoryAllocation* alloc)
+        {
+            for (auto it = m_freeRanges.begin(); it != m_freeRanges.end(); ++it) {
+                const VkDeviceSize rangeStart = it->first;
+                const VkDeviceSize rangeEnd = it->first + it->second;
+                const VkDeviceSize start = (rangeStart + alignment - 1) / alignment * alignment;
+                if (start + size > rangeEnd) {
+                    continue;
+                }
+                m_freeRanges.erase(it);
+                if (start > rangeStart) {
+                    m_freeRanges.emplace(rangeStart, start - rangeStart);
+                }
+                if (start + size < rangeEnd) {
+                    m_freeRanges.emplace(start + size, rangeEnd - (start + size));
+                }
+                m_usedBytes += size;
+                m_allocationCount++;
+
+                alloc->memory = m_memory;
+                alloc->offset = start;
+                alloc->size = size;
+                alloc->mapped = m_mapped != nullptr ? m_mapped + start : nullptr;
+                alloc->page = this;
+                return true;
+            }
+            return false;
+        }
+
+        /// Return a range previously populated by @ref TryAllocate
+        void Free(const MemoryAllocation& alloc)
+        {
+            assert(alloc.page == this);
+            VkDeviceSize start = alloc.offset;
+            VkDeviceSize end = alloc.offset + alloc.size;
+
+            // Merge with the adjacent free ranges, if any
+            auto next = m_freeRanges.lower_bound(start);
+            if (next != m_freeRanges.begin()) {
+                auto prev = std::prev(next);
+                if (prev->first + prev->second == start) {
+                    start = prev->first;
+                    m_freeRanges.erase(prev);
+                }
+            }
+            if (next != m_freeRanges.end() && next->first == end) {
+                end = next->first + next->second;
+                m_freeRanges.erase(next);
+            }
+            m_freeRanges.emplace(start, end - start);
+
+            m_usedBytes -= alloc.size;
+            m_allocationCount--;
+        }
+
+    private:
+        VkDevice m_vkDevice{VK_NULL_HANDLE};
+        VkDeviceMemory m_memory{VK_NULL_HANDLE};
+        uint8_t* m_mapped{nullptr};
+        uint32_t m_memoryTypeIndex;
+        MemoryResourceKind m_kind;
+        VkDeviceSize m_size;
+        bool m_dedicated;
+        /// Free ranges: offset to size
+        std::map<VkDeviceSize, VkDeviceSize> m_freeRanges;
+        VkDeviceSize m_usedBytes{0};
+        uint32_t m_allocationCount{0};
+    };
+
+    /// Hands out device memory, sub-allocated from larger pages.
+    ///
+    /// Not thread-safe: only allocate and free from the thread rendering through the graphics plugin.
+    /// Worker threads, such as those recording secondary command buffers, must not create or destroy buffers.
     struct MemoryAllocator
     {
-        void Init(VkPhysicalDevice physicalDevice, VkDevice device)
+        /// Upper bound on the size of each page we sub-allocate from. Requests over half of the page size get a page of their own.
+        static constexpr VkDeviceSize defaultPageSize = 64 * 1024 * 1024;
+
+        MemoryAllocator() = default;
+
+        ~MemoryAllocator()
+        {
+            Reset();
+        }
+
+        MemoryAllocator(const MemoryAllocator&) = delete;
+        MemoryAllocator& operator=(const MemoryAllocator&) = delete;
+        MemoryAllocator(MemoryAllocator&&) = delete;
+        MemoryAllocator& operator=(MemoryAllocator&&) = delete;
+
+        void Init(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize pageSize = defaultPageSize)
         {
             m_vkDevice = device;
+            m_pageSize = pageSize;
             vkGetPhysicalDeviceMemoryProperties(physicalDevice, &m_memProps);
         }
 
+        /// Free all pages.
+        /// @pre All resources bound to sub-allocations have been destroyed.
         void Reset()
         {
+            m_pages.clear();
             m_memProps = {};
             m_vkDevice = VK_NULL_HANDLE;
         }
 
         static const VkFlags defaultFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
 
+        /// Allocate a VkDeviceMemory of your own: free it with vkFreeMemory.
+        ///
+        /// Prefer @ref SubAllocate unless you need extension structs in @p pNext, or need to own the memory.
         void Allocate(VkMemoryRequirements const& memReqs, VkDeviceMemory* mem, VkFlags flags = defaultFlags,
                       const void* pNext = nullptr) const
         {
-            // Search memtypes to find first index with those properties
+            VkMemoryAllocateInfo memAlloc{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, pNext};
+            memAlloc.allocationSize = memReqs.size;
+            memAlloc.memoryTypeIndex = FindMemoryType(memReqs, flags);
+            XRC_CHECK_THROW_VKCMD(vkAllocateMemory(m_vkDevice, &memAlloc, nullptr, mem))
+        }
+
+        /// Get a range of a shared, larger VkDeviceMemory: return it with @ref Free.
+        ///
+        /// Host visible memory is mapped for its whole lifetime: use @ref MemoryAllocation::mapped rather than vkMapMemory.
+        void SubAllocate(VkMemoryRequirements const& memReqs, MemoryAllocation* alloc, MemoryResourceKind kind,
+                         VkFlags flags = defaultFlags)
+        {
+            XRC_CHECK_THROW_MSG(m_vkDevice != VK_NULL_HANDLE, "MemoryAllocator used before Init");
+            const uint32_t memoryTypeIndex = FindMemoryType(memReqs, flags);
+            const VkMemoryType& memoryType = m_memProps.memoryTypes[memoryTypeIndex];
+            const bool hostVisible = (memoryType.propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+
+            // Don't let a page take too much of a small heap
+            const VkDeviceSize pageSize = std::min(m_pageSize, m_memProps.memoryHeaps[memoryType.heapIndex].size / 8);
+            const VkDeviceSize alignment = std::max<VkDeviceSize>(memReqs.alignment, 1);
+            const bool dedicated = memReqs.size > pageSize / 2;
+
+            if (!dedicated) {
+                for (auto& page : m_pages) {
+                    if (page->IsCompatible(memoryTypeIndex, kind) && page->TryAllocate(memReqs.size, alignment, alloc)) {
+                        alloc->allocator = this;
+                        return;
+                    }
+                }
+            }
+
+            m_pages.push_back(std::make_unique<MemoryPage>(m_vkDevice, memoryTypeIndex, kind, dedicated ? memReqs.size : pageSize,
+                                                           hostVisible, dedicated));
+            XRC_CHECK_THROW(m_pages.back()->TryAllocate(memReqs.size, alignment, alloc));
+            alloc->allocator = this;
+        }
+
+        /// Return a range from @ref SubAllocate and clear @p alloc. Does nothing if @p alloc is empty.
+        void Free(MemoryAllocation& alloc)
+        {
+            MemoryPage* page = alloc.page;
+            if (page == nullptr) {
+                return;
+            }
+            assert(alloc.allocator == this);
+            page->Free(alloc);
+            alloc = {};
+
+            if (!page->Empty()) {
+                return;
+            }
+            // Keep a single empty shared page of each memory type and kind around for reuse, release the rest.
+            const bool haveOtherEmptyPage = std::any_of(m_pages.begin(), m_pages.end(), [&](const std::unique_ptr<MemoryPage>& p) {
+                return p.get() != page && p->Empty() && p->IsCompatible(page->GetMemoryTypeIndex(), page->GetKind());
+            });
+            if (page->IsDedicated() || haveOtherEmptyPage) {
+                m_pages.erase(std::find_if(m_pages.begin(), m_pages.end(),
+                                           [&](const std::unique_ptr<MemoryPage>& p) { return p.get() == page; }));
+            }
+        }
+
+        MemoryAllocatorStats GetStats() const
+        {
+            MemoryAllocatorStats stats{};
+            for (const auto& page : m_pages) {
+                stats.bytesReserved += page->GetSize();
+                stats.bytesUsed += page->GetUsedBytes();
+                stats.pageCount++;
+                stats.allocationCount += page->GetAllocationCount();
+            }
+            return stats;
+        }
+
+    private:
+        /// Search memtypes to find first index with those properties
+        uint32_t FindMemoryType(VkMemoryRequirements const& memReqs, VkFlags flags) const
+        {
             for (uint32_t i = 0; i < m_memProps.memoryTypeCount; ++i) {
                 if ((memReqs.memoryTypeBits & (1 << i)) != 0u) {
                     // Type is available, does it match user properties?
                     if ((m_memProps.memoryTypes[i].propertyFlags & flags) == flags) {
-                        VkMemoryAllocateInfo memAlloc{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, pNext};
-                        memAlloc.allocationSize = memReqs.size;
-                        memAlloc.memoryTypeIndex = i;
-                        XRC_CHECK_THROW_VKCMD(vkAllocateMemory(m_vkDevice, &memAlloc, nullptr, mem))
-                        return;
+                        return i;
                     }
                 }
             }
             XRC_THROW("Memory format not supported")
         }
 
-    private:
         VkDevice m_vkDevice{VK_NULL_HANDLE};
         VkPhysicalDeviceMemoryProperties m_memProps{};
+        VkDeviceSize m_pageSize{defaultPageSize};
+        std::vector<std::unique_ptr<MemoryPage>> m_pages;
+    };
+
+    /// Semaphores for a submission to wait for, each at the matching stages, and to signal once it completes.
+    struct SubmitSemaphores
+    {
+        std::vector<VkSemaphore> wait;
+        std::vector<VkPipelineStageFlags> waitStages;
+        std::vector<VkSemaphore> signal;
     };
 
     /// CmdBuffer - manage VkCommandBuffer state
@@ -302,13 +599,21 @@ namespace Conformance
             return true;
         }
 
-        bool Exec(VkQueue queue)
+        bool Exec(VkQueue queue, const SubmitSemaphores* semaphores = nullptr)
         {
             XRC_CHECK_THROW(state == CmdBufferState::Executable);
 
             VkSubmitInfo submitInfo{VK_STRUCTURE_TYPE_SUBMIT_INFO};
             submitInfo.commandBufferCount = 1;
             submitInfo.pCommandBuffers = &buf;
+            if (semaphores != nullptr) {
+                XRC_CHECK_THROW(semaphores->wait.size() == semaphores->waitStages.size());
+                submitInfo.waitSemaphoreCount = (uint32_t)semaphores->wait.size();
+                submitInfo.pWaitSemaphores = semaphores->wait.data();
+                submitInfo.pWaitDstStageMask = semaphores->waitStages.data();
+                submitInfo.signalSemaphoreCount = (uint32_t)semaphores->signal.size();
+                submitInfo.pSignalSemaphores = semaphores->signal.data();
+            }
             XRC_CHECK_THROW_VKCMD(vkQueueSubmit(queue, 1, &submitInfo, execFence));
 
             SetState(CmdBufferState::Executing);
@@ -352,6 +657,15 @@ namespace Conformance
             return true;
         }
 
+        /// Returns true unless the command buffer has been submitted and is still executing. Does not wait.
+        bool IsComplete() const
+        {
+            if (state != CmdBufferState::Executing) {
+                return true;
+            }
+            return vkGetFenceStatus(m_vkDevice, execFence) == VK_SUCCESS;
+        }
+
     private:
         VkDevice m_vkDevice{VK_NULL_HANDLE};
 
@@ -361,6 +675,343 @@ namespace Conformance
         }
     };
 
+    /// CmdBufferRing - a fixed number of CmdBuffers used in turn, so that recording a submission can overlap with the GPU
+    /// executing the previous ones. With a single buffer every submission is waited on, like a plain CmdBuffer.
+    struct CmdBufferRing
+    {
+        CmdBufferRing() = default;
+
+        CmdBufferRing(const CmdBufferRing&) = delete;
+        CmdBufferRing& operator=(const CmdBufferRing&) = delete;
+        CmdBufferRing(CmdBufferRing&&) = delete;
+        CmdBufferRing& operator=(CmdBufferRing&&) = delete;
+
+        void Reset()
+        {
+            m_buffers.clear();
+            m_submitCounts.clear();
+            m_current = 0;
+            m_submitCount = 0;
+        }
+
+        ~CmdBufferRing()
+        {
+            Reset();
+        }
+
+        bool Init(const VulkanDebugObjectNamer& namer, VkDevice device, uint32_t queueFamilyIndex, uint32_t count)
+        {
+            XRC_CHECK_THROW(count > 0);
+            Reset();
+            for (uint32_t i = 0; i < count; ++i) {
+                m_buffers.push_back(std::make_unique<CmdBuffer>());
+                if (!m_buffers.back()->Init(namer, device, queueFamilyIndex)) {
+                    return false;
+                }
+            }
+            m_submitCounts.assign(count, 0);
+            return true;
+        }
+
+        /// The command buffer being recorded, or the one most recently submitted.
+        CmdBuffer& Current()
+        {
+            return *m_buffers[m_current];
+        }
+
+        /// The position of Current() in the ring, for resources that are used in turn alongside the command buffers.
+        /// Begin() waits for everything previously submitted from that position.
+        size_t CurrentIndex() const
+        {
+            return m_current;
+        }
+
+        size_t Size() const
+        {
+            return m_buffers.size();
+        }
+
+        /// Move on to the next command buffer, waiting for its previous submission to complete, and begin recording it.
+        CmdBuffer& Begin()
+        {
+            m_current = (m_current + 1) % m_buffers.size();
+            CmdBuffer& cmdBuffer = Current();
+            WaitFor(cmdBuffer);
+            cmdBuffer.Clear();
+            cmdBuffer.Begin();
+            return cmdBuffer;
+        }
+
+        /// End and submit the current command buffer, with @p semaphores if any. It is waited on if @p wait is set or the
+        /// ring only has one buffer. Returns the number of this submission, for comparison with CompletedSubmitCount().
+        uint64_t Submit(VkQueue queue, bool wait = false, const SubmitSemaphores* semaphores = nullptr)
+        {
+            CmdBuffer& cmdBuffer = Current();
+            cmdBuffer.End();
+            cmdBuffer.Exec(queue, semaphores);
+            m_submitCounts[m_current] = ++m_submitCount;
+            if (wait || m_buffers.size() == 1) {
+                WaitFor(cmdBuffer);
+            }
+            return m_submitCount;
+        }
+
+        /// Wait for every submitted command buffer to complete.
+        void WaitAll()
+        {
+            for (auto& cmdBuffer : m_buffers) {
+                WaitFor(*cmdBuffer);
+            }
+        }
+
+        /// All submissions numbered up to and including the returned value have completed. Does not wait.
+        uint64_t CompletedSubmitCount() const
+        {
+            uint64_t completed = m_submitCount;
+            for (size_t i = 0; i < m_buffers.size(); ++i) {
+                if (!m_buffers[i]->IsComplete()) {
+                    completed = std::min(completed, m_submitCounts[i] - 1);
+                }
+            }
+            return completed;
+        }
+
+    private:
+        static void WaitFor(CmdBuffer& cmdBuffer)
+        {
+            if (cmdBuffer.state == CmdBuffer::CmdBufferState::Executing) {
+                XRC_CHECK_THROW_MSG(cmdBuffer.Wait(), "Timed out waiting for a command buffer to complete");
+            }
+        }
+
+        std::vector<std::unique_ptr<CmdBuffer>> m_buffers;
+        /// The submission number of the last submission of each buffer
+        std::vector<uint64_t> m_submitCounts;
+        size_t m_current{0};
+        uint64_t m_submitCount{0};
+    };
+
+    using ScopedVkSemaphore = ScopedVkWithDefaultDestroy<VkSemaphore, VkDevice, &vkDestroySemaphore>;
+
+    /// SemaphorePool - binary semaphores handing work from one queue to another, recycled once the submission that waited
+    /// for them has completed. Follows the submission count of one queue, which every semaphore got is (eventually)
+    /// waited for by a submission to.
+    struct SemaphorePool
+    {
+        void Init(const VulkanDebugObjectNamer& namer, VkDevice device)
+        {
+            m_namer = namer;
+            m_vkDevice = device;
+        }
+
+        void Reset()
+        {
+            m_pending.clear();
+            m_free.ReleaseForFenceValue(UINT64_MAX);
+            m_vkDevice = VK_NULL_HANDLE;
+        }
+
+        /// An unsignaled semaphore, reusing one whose wait completed with submission @p completedSubmitCount or before.
+        VkSemaphore Get(uint64_t completedSubmitCount)
+        {
+            ScopedVkSemaphore semaphore;
+            if (!m_free.TryReuse(completedSubmitCount, semaphore)) {
+                VkSemaphore handle{VK_NULL_HANDLE};
+                VkSemaphoreCreateInfo semaphoreInfo{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+                XRC_CHECK_THROW_VKCMD(vkCreateSemaphore(m_vkDevice, &semaphoreInfo, nullptr, &handle));
+                XRC_CHECK_THROW_VKCMD(m_namer.SetName(VK_OBJECT_TYPE_SEMAPHORE, (uint64_t)handle, "CTS queue handoff semaphore"));
+                semaphore.adopt(handle, m_vkDevice);
+            }
+            m_pending.push_back(std::move(semaphore));
+            return m_pending.back().get();
+        }
+
+        /// Every semaphore got since the last call is waited for by submission @p submitCount.
+        void Submitted(uint64_t submitCount)
+        {
+            m_free.PushResources(submitCount, std::move(m_pending));
+            m_pending.clear();
+        }
+
+    private:
+        VulkanDebugObjectNamer m_namer;
+        VkDevice m_vkDevice{VK_NULL_HANDLE};
+        std::vector<ScopedVkSemaphore> m_pending;
+        DestructionQueue<ScopedVkSemaphore> m_free;
+    };
+
+    /// TransferQueue - a queue of a family that supports transfers but neither graphics nor compute, usually backed by the
+    /// copy engines of discrete GPUs, so that uploads run alongside the rendering on the graphics queue.
+    ///
+    /// Images written on it change queue family: the queue giving them up records a release barrier, and a submission to
+    /// the other queue that waits for a semaphore the first signals records the matching acquire barrier, with the same
+    /// families and layouts. Swapchain images must be handed back, as XR_KHR_vulkan_enable requires them to be owned by
+    /// the queue of the graphics binding when released.
+    struct TransferQueue
+    {
+        TransferQueue() = default;
+
+        TransferQueue(const TransferQueue&) = delete;
+        TransferQueue& operator=(const TransferQueue&) = delete;
+
+        /// Find a dedicated transfer family, returning false if there is none. Only families that can copy to any part of an
+        /// image, with a minImageTransferGranularity of one texel, are considered.
+        static bool FindFamily(VkPhysicalDevice physicalDevice, uint32_t* familyIndex)
+        {
+            uint32_t queueFamilyCount = 0;
+            vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+            std::vector<VkQueueFamilyProperties> queueFamilyProps(queueFamilyCount);
+            vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilyProps.data());
+
+            for (uint32_t i = 0; i < queueFamilyCount; ++i) {
+                const VkQueueFamilyProperties& props = queueFamilyProps[i];
+                const VkExtent3D& granularity = props.minImageTransferGranularity;
+                const bool dedicated = (props.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) == 0;
+                if ((props.queueFlags & VK_QUEUE_TRANSFER_BIT) != 0 && dedicated && granularity.width == 1 && granularity.height == 1 &&
+                    granularity.depth == 1) {
+                    *familyIndex = i;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /// Use queue 0 of @p familyIndex, which must have been requested when creating @p device.
+        bool Init(const VulkanDebugObjectNamer& namer, VkDevice device, uint32_t familyIndex, uint32_t cmdBufferCount)
+        {
+            m_familyIndex = familyIndex;
+            vkGetDeviceQueue(device, familyIndex, 0, &m_queue);
+            return m_cmdBuffers.Init(namer, device, familyIndex, cmdBufferCount);
+        }
+
+        void Reset()
+        {
+            m_cmdBuffers.Reset();
+            m_queue = VK_NULL_HANDLE;
+        }
+
+        bool IsValid() const
+        {
+            return m_queue != VK_NULL_HANDLE;
+        }
+
+        uint32_t FamilyIndex() const
+        {
+            return m_familyIndex;
+        }
+
+        /// Begin recording a submission, waiting for the oldest one still executing if every command buffer is in use.
+        CmdBuffer& Begin()
+        {
+            return m_cmdBuffers.Begin();
+        }
+
+        /// End and submit what has been recorded since Begin.
+        void Submit(const SubmitSemaphores& semaphores)
+        {
+            m_cmdBuffers.Submit(m_queue, false, &semaphores);
+        }
+
+        /// Wait for every submission to complete.
+        void WaitAll()
+        {
+            m_cmdBuffers.WaitAll();
+        }
+
+    private:
+        VkQueue m_queue{VK_NULL_HANDLE};
+        uint32_t m_familyIndex{0};
+        CmdBufferRing m_cmdBuffers;
+    };
+
+    /// SecondaryCmdBufferPool - a command pool for one thread to record secondary command buffers from.
+    /// Its command buffers are reset together by Recycle, once the primary command buffer that executed them has completed.
+    struct SecondaryCmdBufferPool
+    {
+        SecondaryCmdBufferPool() = default;
+
+        SecondaryCmdBufferPool(const SecondaryCmdBufferPool&) = delete;
+        SecondaryCmdBufferPool& operator=(const SecondaryCmdBufferPool&) = delete;
+        SecondaryCmdBufferPool(SecondaryCmdBufferPool&&) = delete;
+        SecondaryCmdBufferPool& operator=(SecondaryCmdBufferPool&&) = delete;
+
+        void Reset()
+        {
+            if (m_vkDevice != nullptr) {
+                if (!m_buffers.empty()) {
+                    vkFreeCommandBuffers(m_vkDevice, m_pool, (uint32_t)m_buffers.size(), m_buffers.data());
+                }
+                if (m_pool != VK_NULL_HANDLE) {
+                    vkDestroyCommandPool(m_vkDevice, m_pool, nullptr);
+                }
+            }
+            m_buffers.clear();
+            m_used = 0;
+            m_pool = VK_NULL_HANDLE;
+            m_vkDevice = nullptr;
+        }
+
+        ~SecondaryCmdBufferPool()
+        {
+            Reset();
+        }
+
+        void Init(const VulkanDebugObjectNamer& namer, VkDevice device, uint32_t queueFamilyIndex)
+        {
+            Reset();
+            m_vkDevice = device;
+            m_namer = namer;
+
+            // Buffers are only ever reset together, through the pool.
+            VkCommandPoolCreateInfo cmdPoolInfo{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+            cmdPoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+            cmdPoolInfo.queueFamilyIndex = queueFamilyIndex;
+            XRC_CHECK_THROW_VKCMD(vkCreateCommandPool(m_vkDevice, &cmdPoolInfo, nullptr, &m_pool));
+            XRC_CHECK_THROW_VKCMD(namer.SetName(VK_OBJECT_TYPE_COMMAND_POOL, (uint64_t)m_pool, "CTS secondary command pool"));
+        }
+
+        /// Reset every command buffer allocated from the pool, so they can be begun again.
+        /// None of them may still be pending execution.
+        void Recycle()
+        {
+            if (m_used > 0) {
+                XRC_CHECK_THROW_VKCMD(vkResetCommandPool(m_vkDevice, m_pool, 0));
+                m_used = 0;
+            }
+        }
+
+        /// Begin recording a secondary command buffer that continues the render pass in @p inheritance.
+        /// Only the thread that owns this pool may call this, or record into the returned buffer.
+        VkCommandBuffer BeginRenderPassContinue(const VkCommandBufferInheritanceInfo& inheritance)
+        {
+            if (m_used == m_buffers.size()) {
+                VkCommandBufferAllocateInfo cmd{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+                cmd.commandPool = m_pool;
+                cmd.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+                cmd.commandBufferCount = 1;
+                VkCommandBuffer buf{VK_NULL_HANDLE};
+                XRC_CHECK_THROW_VKCMD(vkAllocateCommandBuffers(m_vkDevice, &cmd, &buf));
+                XRC_CHECK_THROW_VKCMD(m_namer.SetName(VK_OBJECT_TYPE_COMMAND_BUFFER, (uint64_t)buf, "CTS secondary command buffer"));
+                m_buffers.push_back(buf);
+            }
+            VkCommandBuffer buf = m_buffers[m_used++];
+
+            VkCommandBufferBeginInfo cmdBeginInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+            cmdBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+            cmdBeginInfo.pInheritanceInfo = &inheritance;
+            XRC_CHECK_THROW_VKCMD(vkBeginCommandBuffer(buf, &cmdBeginInfo));
+            return buf;
+        }
+
+    private:
+        VkDevice m_vkDevice{VK_NULL_HANDLE};
+        VulkanDebugObjectNamer m_namer{};
+        VkCommandPool m_pool{VK_NULL_HANDLE};
+        std::vector<VkCommandBuffer> m_buffers;
+        /// The number of m_buffers begun since the pool was last recycled
+        size_t m_used{0};
+    };
+
     /// ShaderProgram to hold a pair of vertex & fragment shaders
     struct ShaderProgram
     {
@@ -448,7 +1099,8 @@ namespace Conformance
     struct BufferAndMemory
     {
         VkBuffer buf{VK_NULL_HANDLE};
-        VkDeviceMemory mem{VK_NULL_HANDLE};
+        /// Host visible range of a @ref MemoryAllocator page that @ref buf is bound to
+        MemoryAllocation memory{};
 
         /// Destroy the buffer and free the memory, if applicable.
         void Reset(VkDevice device)
@@ -457,12 +1109,12 @@ namespace Conformance
                 if (buf != VK_NULL_HANDLE) {
                     vkDestroyBuffer(device, buf, nullptr);
                 }
-                if (mem != VK_NULL_HANDLE) {
-                    vkFreeMemory(device, mem, nullptr);
-                }
+            }
+            if (memory.allocator != nullptr) {
+                memory.allocator->Free(memory);
             }
             buf = VK_NULL_HANDLE;
-            mem = VK_NULL_HANDLE;
+            memory = {};
         }
 
         /// Swap the internals with another object.
@@ -471,25 +1123,25 @@ namespace Conformance
         {
             using std::swap;
             swap(buf, other.buf);
-            swap(mem, other.mem);
+            swap(memory, other.memory);
         }
 
         /// Create the buffer handle (using the specified VkBufferCreateInfo),
-        /// allocate the memory, and bind the buffer to the memory.
-        void Create(VkDevice device, const MemoryAllocator& memAllocator, const VkBufferCreateInfo& bufInfo)
+        /// sub-allocate the memory, and bind the buffer to the memory.
+        void Create(VkDevice device, MemoryAllocator& memAllocator, const VkBufferCreateInfo& bufInfo)
         {
             XRC_CHECK_THROW_VKCMD(vkCreateBuffer(device, &bufInfo, nullptr, &this->buf));
             VkMemoryRequirements memReq = {};
             vkGetBufferMemoryRequirements(device, buf, &memReq);
-            memAllocator.Allocate(memReq, &mem);
-            XRC_CHECK_THROW_VKCMD(vkBindBufferMemory(device, this->buf, this->mem, 0));
+            memAllocator.SubAllocate(memReq, &memory, MemoryResourceKind::Buffer);
+            XRC_CHECK_THROW_VKCMD(vkBindBufferMemory(device, this->buf, memory.memory, memory.offset));
         }
 
         /// Create the buffer handle (using the specified array count, usage, and element type `T`),
         /// allocate the memory, and bind the buffer to the memory.
         /// Function template to allow easy, generic access: caller must make sure the type used here matches the type used elsewhere!
         template <typename T>
-        void Create(VkDevice device, const MemoryAllocator& memAllocator, uint32_t count, VkBufferUsageFlags usage)
+        void Create(VkDevice device, MemoryAllocator& memAllocator, uint32_t count, VkBufferUsageFlags usage)
         {
 
             VkBufferCreateInfo bufInfo{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
@@ -498,26 +1150,350 @@ namespace Conformance
             Create(device, memAllocator, bufInfo);
         }
 
-        /// Update the elements of the buffer using vkMapMemory.
+        /// Update the elements of the buffer through the persistent mapping of its memory.
         ///
         /// Function template to allow easy, generic access: caller must make sure the type used here matches the type used elsewhere!
         ///
         /// @param device The VkDevice associated with this buffer
         /// @param data Your data span (contiguous - pointer and size)
-        /// @param offsetElements A zero-based **element** offset from the beginning of the memory object.
+        /// @param offsetElements A zero-based **element** offset from the beginning of the buffer.
         template <typename T>
         void Update(VkDevice device, span<const T> data, uint32_t offsetElements = 0)
         {
+            (void)device;
+            XRC_CHECK_THROW_MSG(memory.mapped != nullptr, "Buffer memory is not host visible");
             const size_t elements = data.size();
-            T* map = nullptr;
-            XRC_CHECK_THROW_VKCMD(vkMapMemory(device, this->mem, sizeof(T) * offsetElements, sizeof(T) * elements, 0, (void**)&map));
+            assert(sizeof(T) * (offsetElements + elements) <= memory.size);
+            T* map = reinterpret_cast<T*>(memory.mapped + sizeof(T) * offsetElements);
             for (size_t i = 0; i < elements; ++i) {
                 map[i] = data[i];
             }
-            vkUnmapMemory(device, this->mem);
         }
     };
 
+    class StagingBufferPool;
+
+    /// One persistently-mapped, host-visible buffer that a @ref StagingBufferPool sub-allocates from, as a ring.
+    ///
+    /// Regions are handed out in order and may be freed in any order: space is reclaimed from the oldest end of the ring
+    /// as soon as the oldest outstanding regions have all been freed.
+    class StagingBlock
+    {
+    public:
+        StagingBlock(const VulkanDebugObjectNamer& namer, VkDevice device, MemoryAllocator& memAllocator, VkDeviceSize capacity)
+            : m_vkDevice(device), m_capacity(capacity)
+        {
+            VkBufferCreateInfo bufInfo{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+            // Also usable as a vertex buffer, for per-frame data read directly by draws.
+            bufInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+            bufInfo.size = capacity;
+            m_buffer.Create(device, memAllocator, bufInfo);
+            XRC_CHECK_THROW_VKCMD(namer.SetName(VK_OBJECT_TYPE_BUFFER, (uint64_t)m_buffer.buf, "CTS staging pool buffer"));
+            m_mapped = m_buffer.memory.mapped;
+            XRC_CHECK_THROW(m_mapped != nullptr);
+        }
+
+        ~StagingBlock()
+        {
+            m_mapped = nullptr;
+            m_buffer.Reset(m_vkDevice);
+        }
+
+        StagingBlock(const StagingBlock&) = delete;
+        StagingBlock& operator=(const StagingBlock&) = delete;
+        StagingBlock(StagingBlock&&) = delete;
+        StagingBlock& operator=(StagingBlock&&) = delete;
+
+        VkBuffer GetBuffer() const
+        {
+            return m_buffer.buf;
+        }
+
+        VkDeviceSize GetCapacity() const
+        {
+            return m_capacity;
+        }
+
+        uint8_t* GetMappedData() const
+        {
+            return m_mapped;
+        }
+
+        /// True if there are no outstanding regions in this block.
+        bool Empty() const
+        {
+            return m_regions.empty();
+        }
+
+        /// Try to reserve a region of @p size bytes aligned to @p alignment (must be power of two).
+        /// On success, populates @p offset and @p sequence (used to free the region later) and returns true.
+        bool TryAllocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize* offset, uint64_t* sequence)
+        {
+            auto alignUp = [alignment](VkDeviceSize n) { return (n + alignment - 1) & ~(alignment - 1); };
+
+            VkDeviceSize start = 0;
+            if (m_regions.empty()) {
+                if (size > m_capacity) {
+                    return false;
+                }
+            }
+            else {
+                const Region& oldest = m_regions.front();
+                const Region& newest = m_regions.back();
+                const VkDeviceSize afterNewest = alignUp(newest.end);
+                const bool wrapped = newest.start < oldest.start;
+                if (!wrapped && afterNewest + size <= m_capacity) {
+                    // Fits between the newest region and the end of the buffer.
+                    start = afterNewest;
+                }
+                else if (!wrapped && size <= oldest.start) {
+                    // Wrap around: fits before the oldest region.
+                    start = 0;
+                }
+                else if (wrapped && afterNewest + size <= oldest.start) {
+                    // Already wrapped: fits between the newest and oldest regions.
+                    start = afterNewest;
+                }
+                else {
+                    return false;
+                }
+            }
+
+            m_regions.push_back(Region{start, start + size, false});
+            *offset = start;
+            *sequence = m_frontSequence + m_regions.size() - 1;
+            return true;
+        }
+
+        /// Free a region previously returned by @ref TryAllocate
+        void Free(uint64_t sequence)
+        {
+            assert(sequence >= m_frontSequence && sequence - m_frontSequence < m_regions.size());
+            m_regions[size_t(sequence - m_frontSequence)].freed = true;
+            while (!m_regions.empty() && m_regions.front().freed) {
+                m_regions.pop_front();
+                ++m_frontSequence;
+            }
+        }
+
+    private:
+        struct Region
+        {
+            VkDeviceSize start;
+            VkDeviceSize end;
+            bool freed;
+        };
+
+        VkDevice m_vkDevice{VK_NULL_HANDLE};
+        BufferAndMemory m_buffer;
+        uint8_t* m_mapped{nullptr};
+        VkDeviceSize m_capacity{0};
+        std::deque<Region> m_regions;
+        uint64_t m_frontSequence{0};
+    };
+
+    /// A region of staging memory from a @ref StagingBufferPool.
+    ///
+    /// Move-only: the region goes back to the pool when this is destroyed or @ref Release is called,
+    /// so move it into a @ref DestructionQueue keyed on the fence value of the submission that uses it.
+    /// Must not outlive the pool it came from.
+    class StagingAllocation
+    {
+    public:
+        StagingAllocation() = default;
+
+        StagingAllocation(StagingAllocation&& other) noexcept
+        {
+            Swap(other);
+        }
+
+        StagingAllocation& operator=(StagingAllocation&& other) noexcept
+        {
+            if (this == &other) {
+                return *this;
+            }
+            Release();
+            Swap(other);
+            return *this;
+        }
+
+        StagingAllocation(const StagingAllocation&) = delete;
+        StagingAllocation& operator=(const StagingAllocation&) = delete;
+
+        ~StagingAllocation()
+        {
+            Release();
+        }
+
+        /// Return the region to the pool, if we hold one.
+        void Release()
+        {
+            if (m_block != nullptr) {
+                m_block->Free(m_sequence);
+            }
+            m_block = nullptr;
+            m_sequence = 0;
+            m_offset = 0;
+            m_size = 0;
+        }
+
+        /// The buffer to use as a copy source or destination
+        VkBuffer GetBuffer() const
+        {
+            return m_block != nullptr ? m_block->GetBuffer() : VK_NULL_HANDLE;
+        }
+
+        /// Offset of this region within @ref GetBuffer
+        VkDeviceSize GetOffset() const
+        {
+            return m_offset;
+        }
+
+        VkDeviceSize GetSize() const
+        {
+            return m_size;
+        }
+
+        /// Host pointer to the start of this region
+        uint8_t* GetData() const
+        {
+            return m_block != nullptr ? m_block->GetMappedData() + m_offset : nullptr;
+        }
+
+    private:
+        friend class StagingBufferPool;
+
+        StagingAllocation(StagingBlock* block, uint64_t sequence, VkDeviceSize offset, VkDeviceSize size)
+            : m_block(block), m_sequence(sequence), m_offset(offset), m_size(size)
+        {
+        }
+
+        void Swap(StagingAllocation& other) noexcept
+        {
+            using std::swap;
+            swap(m_block, other.m_block);
+            swap(m_sequence, other.m_sequence);
+            swap(m_offset, other.m_offset);
+            swap(m_size, other.m_size);
+        }
+
+        StagingBlock* m_block{nullptr};
+        uint64_t m_sequence{0};
+        VkDeviceSize m_offset{0};
+        VkDeviceSize m_size{0};
+    };
+
+    /// A reusable, persistently-mapped, host-visible staging memory pool for uploads to (and readbacks from) device-local resources.
+    ///
+    /// Replaces creating, allocating, mapping, and freeing a buffer per copy. Allocations come out of a ring buffer. When the
+    /// ring is full of regions still in use, another buffer of the same capacity takes over: one retired earlier that has room
+    /// again, or a new one. Only a request larger than the initial capacity gets a larger buffer, which is dropped again once
+    /// it is empty and a request of the usual size comes. Retired buffers are destroyed once empty, except for one spare.
+    class StagingBufferPool
+    {
+    public:
+        static constexpr VkDeviceSize defaultCapacity = 8 * 1024 * 1024;
+        static constexpr VkDeviceSize defaultAlignment = 16;
+
+        StagingBufferPool() = default;
+
+        ~StagingBufferPool()
+        {
+            Reset();
+        }
+
+        StagingBufferPool(const StagingBufferPool&) = delete;
+        StagingBufferPool& operator=(const StagingBufferPool&) = delete;
+        StagingBufferPool(StagingBufferPool&&) = delete;
+        StagingBufferPool& operator=(StagingBufferPool&&) = delete;
+
+        void Init(const VulkanDebugObjectNamer& namer, VkDevice device, MemoryAllocator& memAllocator,
+                  VkDeviceSize initialCapacity = defaultCapacity)
+        {
+            m_namer = namer;
+            m_vkDevice = device;
+            m_memAllocator = &memAllocator;
+            m_initialCapacity = initialCapacity;
+        }
+
+        /// Destroy all buffers.
+        /// @pre The device is idle and all allocations from this pool have been released.
+        void Reset()
+        {
+            m_current.reset();
+            m_retired.clear();
+            m_memAllocator = nullptr;
+            m_vkDevice = VK_NULL_HANDLE;
+        }
+
+        /// Get a region of at least @p size bytes, aligned to @p alignment (a power of two).
+        /// The default alignment satisfies the buffer offset requirements of vkCmdCopyBufferToImage for all formats we use.
+        StagingAllocation Allocate(VkDeviceSize size, VkDeviceSize alignment = defaultAlignment)
+        {
+            XRC_CHECK_THROW_MSG(m_vkDevice != VK_NULL_HANDLE, "StagingBufferPool used before Init");
+            XRC_CHECK_THROW((alignment & (alignment - 1)) == 0);
+            size = std::max<VkDeviceSize>(size, 1);
+            const VkDeviceSize alignedSize = (size + alignment - 1) & ~(alignment - 1);
+
+            // Blocks larger than usual are only for requests that need them.
+            const bool largeRequest = alignedSize > m_initialCapacity;
+            auto suitable = [&](const StagingBlock& block) { return largeRequest || block.GetCapacity() <= m_initialCapacity; };
+
+            VkDeviceSize offset = 0;
+            uint64_t sequence = 0;
+            if (m_current != nullptr && m_current->Empty() && !suitable(*m_current)) {
+                m_current.reset();
+            }
+            if (m_current == nullptr || !m_current->TryAllocate(size, alignment, &offset, &sequence)) {
+                // Regions still in use fill the current block, or it is too small.
+                if (m_current != nullptr) {
+                    m_retired.push_back(std::move(m_current));
+                }
+                for (auto it = m_retired.begin(); it != m_retired.end(); ++it) {
+                    if (suitable(**it) && (*it)->TryAllocate(size, alignment, &offset, &sequence)) {
+                        m_current = std::move(*it);
+                        m_retired.erase(it);
+                        break;
+                    }
+                }
+                if (m_current == nullptr) {
+                    m_current = std::make_unique<StagingBlock>(m_namer, m_vkDevice, *m_memAllocator,
+                                                               std::max(m_initialCapacity, alignedSize));
+                    XRC_CHECK_THROW(m_current->TryAllocate(size, alignment, &offset, &sequence));
+                }
+            }
+            ReleaseEmptyRetiredBlocks();
+            return StagingAllocation{m_current.get(), sequence, offset, size};
+        }
+
+    private:
+        /// Destroy the retired blocks that have been fully released, but one of the usual capacity, kept for the next time
+        /// the current block fills up.
+        void ReleaseEmptyRetiredBlocks()
+        {
+            bool keptSpare = false;
+            for (auto it = m_retired.begin(); it != m_retired.end();) {
+                if (!(*it)->Empty()) {
+                    ++it;
+                }
+                else if (!keptSpare && (*it)->GetCapacity() == m_initialCapacity) {
+                    keptSpare = true;
+                    ++it;
+                }
+                else {
+                    it = m_retired.erase(it);
+                }
+            }
+        }
+
+        VulkanDebugObjectNamer m_namer{};
+        VkDevice m_vkDevice{VK_NULL_HANDLE};
+        MemoryAllocator* m_memAllocator{nullptr};
+        VkDeviceSize m_initialCapacity{defaultCapacity};
+        std::unique_ptr<StagingBlock> m_current;
+        std::vector<std::unique_ptr<StagingBlock>> m_retired;
+    };
+
     /// Type-generic base class for what d3d12 calls a "structured buffer" - an array of arbitrary things.
     /// Unlike @ref UntypedBuffer this *does* carry the VkDevice
     struct StructuredBufferBase : BufferAndMemory
@@ -546,7 +1522,7 @@ namespace Conformance
         StructuredBufferBase& operator=(const StructuredBufferBase&) = delete;
 
         /// Initialize with a device and a memory allocator
-        void Init(VkDevice device, const MemoryAllocator& memAllocator)
+        void Init(VkDevice device, MemoryAllocator& memAllocator)
         {
             m_vkDevice = device;
             m_memAllocator = &memAllocator;
@@ -565,7 +1541,7 @@ namespace Conformance
         }
         VkDevice m_vkDevice{VK_NULL_HANDLE};
         uint32_t m_count{};
-        const MemoryAllocator* m_memAllocator{nullptr};
+        MemoryAllocator* m_memAllocator{nullptr};
     };
 
     /// Class template for a "Structured Buffer" - an array of some arbitrary type.
@@ -660,14 +1636,14 @@ namespace Conformance
         VertexBufferBase& operator=(const VertexBufferBase&) = delete;
         VertexBufferBase(VertexBufferBase&&) = delete;
         VertexBufferBase& operator=(VertexBufferBase&&) = delete;
-        void Init(VkDevice device, const MemoryAllocator* memAllocator, std::vector<VkVertexInputAttributeDescription>&& attr)
+        void Init(VkDevice device, MemoryAllocator* memAllocator, std::vector<VkVertexInputAttributeDescription>&& attr)
         {
             m_vkDevice = device;
             m_memAllocator = memAllocator;
             attrDesc = std::move(attr);
         }
 
-        void Init(VkDevice device, const MemoryAllocator* memAllocator, const std::vector<VkVertexInputAttributeDescription>& attr)
+        void Init(VkDevice device, MemoryAllocator* memAllocator, const std::vector<VkVertexInputAttributeDescription>& attr)
         {
             m_vkDevice = device;
             m_memAllocator = memAllocator;
@@ -705,7 +1681,7 @@ namespace Conformance
         }
 
     private:
-        const MemoryAllocator* m_memAllocator{nullptr};
+        MemoryAllocator* m_memAllocator{nullptr};
     };
 
     // VertexBuffer template to wrap the indices and vertices
@@ -1001,13 +1977,14 @@ namespace Conformance
         VkDevice m_vkDevice{VK_NULL_HANDLE};
     };
 
-    struct VulkanUniformBuffer
+    /// Per-instance vertex data of the simple vertex shader
+    struct VulkanMeshInstance
     {
         XrMatrix4x4f mvp;
         XrColor4f tintColor;
     };
 
-    // Simple vertex MVP xform, tint color & color fragment shader layout
+    // Simple vertex & color fragment shader layout: the MVP xform and tint color are per-instance vertex attributes
     struct PipelineLayout
     {
         VkPipelineLayout layout{VK_NULL_HANDLE};
@@ -1034,15 +2011,7 @@ namespace Conformance
         {
             m_vkDevice = device;
 
-            // MVP matrix is a push_constant
-            VkPushConstantRange pcr = {};
-            pcr.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-            pcr.offset = 0;
-            pcr.size = sizeof(VulkanUniformBuffer);
-
             VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
-            pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
-            pipelineLayoutCreateInfo.pPushConstantRanges = &pcr;
             XRC_CHECK_THROW_VKCMD(vkCreatePipelineLayout(m_vkDevice, &pipelineLayoutCreateInfo, nullptr, &layout));
         }
 
@@ -1055,6 +2024,121 @@ namespace Conformance
         VkDevice m_vkDevice{VK_NULL_HANDLE};
     };
 
+    /// A VkPipelineCache whose contents outlive the VkDevice it was created on.
+    ///
+    /// The Vulkan plugin creates a new device for every session, so the cache data is kept here between devices on the same
+    /// physical device and driver. If a directory is given, it is also loaded from and saved to a file there, so that
+    /// later runs start with a warm cache too.
+    class PipelineCache
+    {
+    public:
+        PipelineCache() = default;
+        PipelineCache(const PipelineCache&) = delete;
+        PipelineCache& operator=(const PipelineCache&) = delete;
+        PipelineCache(PipelineCache&&) = delete;
+        PipelineCache& operator=(PipelineCache&&) = delete;
+
+        ~PipelineCache()
+        {
+            Reset();
+        }
+
+        /// Create the cache on @p device, seeded with the contents saved by the last device on the same physical device and
+        /// driver, or failing that from the cache file in @p directory (may be empty for no file).
+        void Init(const VulkanDebugObjectNamer& namer, VkPhysicalDevice physicalDevice, VkDevice device, const std::string& directory)
+        {
+            Reset();
+
+            VkPhysicalDeviceProperties properties{};
+            vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+            const std::string fileName = FileName(properties);
+            if (fileName != m_fileName || directory != m_directory) {
+                m_fileName = fileName;
+                m_directory = directory;
+                m_data.clear();
+                if (!m_directory.empty()) {
+                    ReadFileBytes(GetPath(), &m_data);
+                }
+            }
+            // Implementations must ignore data from an incompatible device, but there is no need to trust that.
+            if (!IsCompatible(m_data, properties)) {
+                m_data.clear();
+            }
+
+            VkPipelineCacheCreateInfo createInfo{VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+            createInfo.initialDataSize = m_data.size();
+            createInfo.pInitialData = m_data.empty() ? nullptr : m_data.data();
+            XRC_CHECK_THROW_VKCMD(vkCreatePipelineCache(device, &createInfo, nullptr, &cache));
+            m_vkDevice = device;
+            XRC_CHECK_THROW_VKCMD(namer.SetName(VK_OBJECT_TYPE_PIPELINE_CACHE, (uint64_t)cache, "CTS pipeline cache"));
+        }
+
+        /// Save the contents of the cache for the next @ref Init (and to the cache file, if any), then destroy it.
+        void Reset()
+        {
+            if (cache != VK_NULL_HANDLE) {
+                size_t size = 0;
+                if (vkGetPipelineCacheData(m_vkDevice, cache, &size, nullptr) == VK_SUCCESS && size > 0) {
+                    std::vector<uint8_t> data(size);
+                    if (vkGetPipelineCacheData(m_vkDevice, cache, &size, data.data()) == VK_SUCCESS) {
+                        data.resize(size);
+                        if (data != m_data) {
+                            m_data.swap(data);
+                            // Best effort: a cache that cannot be written just means the next run starts cold.
+                            if (!m_directory.empty()) {
+                                WriteFileAtomically(GetPath(), m_data);
+                            }
+                        }
+                    }
+                }
+                vkDestroyPipelineCache(m_vkDevice, cache, nullptr);
+            }
+            cache = VK_NULL_HANDLE;
+            m_vkDevice = VK_NULL_HANDLE;
+        }
+
+        VkPipelineCache cache{VK_NULL_HANDLE};
+
+    private:
+        /// Unique per device and driver version, since a driver update may invalidate the cached pipelines.
+        static std::string FileName(const VkPhysicalDeviceProperties& properties)
+        {
+            char name[128];
+            snprintf(name, sizeof(name), "cts_vk_pipeline_cache_%08x_%08x_%08x_", properties.vendorID, properties.deviceID,
+                     properties.driverVersion);
+            std::string fileName = name;
+            for (uint8_t byte : properties.pipelineCacheUUID) {
+                snprintf(name, sizeof(name), "%02x", byte);
+                fileName += name;
+            }
+            return fileName + ".bin";
+        }
+
+        /// Check the VkPipelineCacheHeaderVersionOne header at the start of @p data.
+        static bool IsCompatible(const std::vector<uint8_t>& data, const VkPhysicalDeviceProperties& properties)
+        {
+            constexpr size_t headerSize = 4 * sizeof(uint32_t) + VK_UUID_SIZE;
+            if (data.size() < headerSize) {
+                return false;
+            }
+            uint32_t header[4];
+            memcpy(header, data.data(), sizeof(header));
+            return header[0] >= headerSize && header[1] == (uint32_t)VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+                   header[2] == properties.vendorID && header[3] == properties.deviceID &&
+                   memcmp(data.data() + sizeof(header), properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+        }
+
+        std::string GetPath() const
+        {
+            return m_directory + "/" + m_fileName;
+        }
+
+        VkDevice m_vkDevice{VK_NULL_HANDLE};
+        std::string m_directory;
+        std::string m_fileName;
+        std::vector<uint8_t> m_data;
+    };
+
     // Pipeline wrapper for rendering pipeline state
     struct Pipeline
     {
@@ -1067,8 +2151,8 @@ namespace Conformance
         }
 
         void Create(VkDevice device, VkExtent2D /*size*/, const PipelineLayout& layout, const RenderPass& rp, const ShaderProgram& sp,
-                    const VkVertexInputBindingDescription& bindDesc, span<const VkVertexInputAttributeDescription> attrDesc,
-                    span<VkDynamicState> dynamicStates)
+                    span<const VkVertexInputBindingDescription> bindDesc, span<const VkVertexInputAttributeDescription> attrDesc,
+                    span<VkDynamicState> dynamicStates, VkPipelineCache pipelineCache = VK_NULL_HANDLE)
         {
             m_vkDevice = device;
 
@@ -1077,8 +2161,8 @@ namespace Conformance
             dynamicState.pDynamicStates = dynamicStates.data();
 
             VkPipelineVertexInputStateCreateInfo vi{VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO};
-            vi.vertexBindingDescriptionCount = 1;
-            vi.pVertexBindingDescriptions = &bindDesc;
+            vi.vertexBindingDescriptionCount = (uint32_t)bindDesc.size();
+            vi.pVertexBindingDescriptions = bindDesc.data();
             vi.vertexAttributeDescriptionCount = (uint32_t)attrDesc.size();
             vi.pVertexAttributeDescriptions = attrDesc.data();
 
@@ -1159,14 +2243,14 @@ namespace Conformance
             pipeInfo.renderPass = rp.pass;
             pipeInfo.subpass = 0;
 
-            Create(device, pipeInfo);
+            Create(device, pipeInfo, pipelineCache);
         }
 
-        void Create(VkDevice device, const VkGraphicsPipelineCreateInfo& info)
+        void Create(VkDevice device, const VkGraphicsPipelineCreateInfo& info, VkPipelineCache pipelineCache = VK_NULL_HANDLE)
         {
             m_vkDevice = device;
 
-            XRC_CHECK_THROW_VKCMD(vkCreateGraphicsPipelines(m_vkDevice, VK_NULL_HANDLE, 1, &info, nullptr, &pipe));
+            XRC_CHECK_THROW_VKCMD(vkCreateGraphicsPipelines(m_vkDevice, pipelineCache, 1, &info, nullptr, &pipe));
         }
 
         void Reset()
@@ -1186,7 +2270,7 @@ namespace Conformance
 
     struct DepthBuffer
     {
-        VkDeviceMemory depthMemory{VK_NULL_HANDLE};
+        MemoryAllocation depthMemory{};
         VkImage depthImage{VK_NULL_HANDLE};
 
         DepthBuffer() = default;
@@ -1201,12 +2285,12 @@ namespace Conformance
                 if (depthImage != VK_NULL_HANDLE) {
                     vkDestroyImage(m_vkDevice, depthImage, nullptr);
                 }
-                if (depthMemory != VK_NULL_HANDLE) {
-                    vkFreeMemory(m_vkDevice, depthMemory, nullptr);
-                }
+            }
+            if (depthMemory.allocator != nullptr) {
+                depthMemory.allocator->Free(depthMemory);
             }
             depthImage = VK_NULL_HANDLE;
-            depthMemory = VK_NULL_HANDLE;
+            depthMemory = {};
             m_vkDevice = nullptr;
             m_initialized = false;
         }
@@ -1269,9 +2353,8 @@ namespace Conformance
 
             VkMemoryRequirements memRequirements{};
             vkGetImageMemoryRequirements(device, depthImage, &memRequirements);
-            memAllocator->Allocate(memRequirements, &depthMemory, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-            XRC_CHECK_THROW_VKCMD(namer.SetName(VK_OBJECT_TYPE_DEVICE_MEMORY, (uint64_t)depthMemory, "CTS fallback depth image memory"));
-            XRC_CHECK_THROW_VKCMD(vkBindImageMemory(device, depthImage, depthMemory, 0));
+            memAllocator->SubAllocate(memRequirements, &depthMemory, MemoryResourceKind::Image, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+            XRC_CHECK_THROW_VKCMD(vkBindImageMemory(device, depthImage, depthMemory.memory, depthMemory.offset));
 
             m_initialized = true;
         }
@@ -4,8 +4,13 @@
 
 #pragma once
 
+#include <algorithm>
+#include <assert.h>
 #include <cmath>
+#include <stddef.h>
+#include <vector>
 
+#include <nonstd/span.hpp>
 #include <openxr/openxr.h>
 #include "common/xr_linear.h"
 
@@ -143,6 +148,88 @@ namespace openxr
             {
                 return Length(a - b) < tolerance;
             }
+
+            /// Many vectors in structure-of-arrays form, so that the batch operations on them vectorize.
+            struct Batch
+            {
+                std::vector<float> x;
+                std::vector<float> y;
+                std::vector<float> z;
+
+                Batch() = default;
+                explicit Batch(nonstd::span<const XrVector3f> vectors)
+                {
+                    Assign(vectors);
+                }
+
+                size_t Size() const
+                {
+                    return x.size();
+                }
+                void Resize(size_t size)
+                {
+                    x.resize(size);
+                    y.resize(size);
+                    z.resize(size);
+                }
+
+                XrVector3f Get(size_t i) const
+                {
+                    return {x[i], y[i], z[i]};
+                }
+                void Set(size_t i, const XrVector3f& v)
+                {
+                    x[i] = v.x;
+                    y[i] = v.y;
+                    z[i] = v.z;
+                }
+
+                void Assign(nonstd::span<const XrVector3f> vectors)
+                {
+                    Assign(vectors, [](const XrVector3f& v) { return v; });
+                }
+                /// Gather a vector from each of @p items, e.g. with `[](const XrHandJointLocationEXT& j) { return j.pose.position; }`
+                template <typename T, typename GetVector>
+                void Assign(nonstd::span<const T> items, GetVector&& getVector)
+                {
+                    Resize(items.size());
+                    for (size_t i = 0; i < items.size(); ++i) {
+                        Set(i, getVector(items[i]));
+                    }
+                }
+            };
+
+            /// Returns the index of the first pair of vectors in @p a and @p b that are not approximately equal, with the same
+            /// tolerance as ApproxEqual, or a.Size() if they all are.
+            xr_math_operators_nodiscard inline size_t FindFirstNotApproxEqual(const Batch& a, const Batch& b, float tolerance = 0.001f)
+            {
+                assert(a.Size() == b.Size());
+                const size_t count = std::min(a.Size(), b.Size());
+                const float toleranceSquared = tolerance * tolerance;
+                const auto isApproxEqual = [&](size_t i) {
+                    const float dx = a.x[i] - b.x[i];
+                    const float dy = a.y[i] - b.y[i];
+                    const float dz = a.z[i] - b.z[i];
+                    return int(dx * dx + dy * dy + dz * dz < toleranceSquared);
+                };
+                // Compare a block at a time without branching, and only look for the culprit in a block that failed.
+                constexpr size_t blockSize = 16;
+                for (size_t start = 0; start < count; start += blockSize) {
+                    const size_t end = std::min(count, start + blockSize);
+                    int allEqual = 1;
+                    for (size_t i = start; i < end; ++i) {
+                        allEqual &= isApproxEqual(i);
+                    }
+                    if (!allEqual) {
+                        for (size_t i = start; i < end; ++i) {
+                            if (!isApproxEqual(i)) {
+                                return i;
+                            }
+                        }
+                    }
+                }
+                return count;
+            }
         }  // namespace Vector
 
         namespace Pose
@@ -155,6 +242,208 @@ namespace openxr
                 return Vector::ApproxEqual(a.position, b.position, positionTolerance) &&
                        Quat::ApproxEqual(a.orientation, b.orientation, angularTolerance);
             }
+
+            /// Many poses in structure-of-arrays form, so that the batch operations on them vectorize.
+            /// The batch operations expect normalized orientations, as valid poses have.
+            struct Batch
+            {
+                Vector::Batch position;
+                std::vector<float> qx;
+                std::vector<float> qy;
+                std::vector<float> qz;
+                std::vector<float> qw;
+
+                Batch() = default;
+                explicit Batch(nonstd::span<const XrPosef> poses)
+                {
+                    Assign(poses);
+                }
+
+                size_t Size() const
+                {
+                    return qw.size();
+                }
+                void Resize(size_t size)
+                {
+                    position.Resize(size);
+                    qx.resize(size);
+                    qy.resize(size);
+                    qz.resize(size);
+                    qw.resize(size);
+                }
+
+                XrPosef Get(size_t i) const
+                {
+                    return {{qx[i], qy[i], qz[i], qw[i]}, position.Get(i)};
+                }
+                void Set(size_t i, const XrPosef& pose)
+                {
+                    position.Set(i, pose.position);
+                    qx[i] = pose.orientation.x;
+                    qy[i] = pose.orientation.y;
+                    qz[i] = pose.orientation.z;
+                    qw[i] = pose.orientation.w;
+                }
+
+                void Assign(nonstd::span<const XrPosef> poses)
+                {
+                    Assign(poses, [](const XrPosef& pose) { return pose; });
+                }
+                /// Gather a pose from each of @p items, e.g. with `[](const XrSpaceLocationData& l) { return l.pose; }`
+                template <typename T, typename GetPose>
+                void Assign(nonstd::span<const T> items, GetPose&& getPose)
+                {
+                    Resize(items.size());
+                    for (size_t i = 0; i < items.size(); ++i) {
+                        Set(i, getPose(items[i]));
+                    }
+                }
+                void CopyTo(nonstd::span<XrPosef> poses) const
+                {
+                    assert(poses.size() == Size());
+                    for (size_t i = 0; i < poses.size(); ++i) {
+                        poses[i] = Get(i);
+                    }
+                }
+            };
+
+            namespace detail
+            {
+                /// Rotate (vx, vy, vz) by a unit quaternion, as v + w * t + u x t with t = 2 * (u x v), where u is its vector part.
+                inline void RotateVector(float qx, float qy, float qz, float qw, float vx, float vy, float vz, float& rx, float& ry,
+                                         float& rz)
+                {
+                    const float tx = 2.0f * (qy * vz - qz * vy);
+                    const float ty = 2.0f * (qz * vx - qx * vz);
+                    const float tz = 2.0f * (qx * vy - qy * vx);
+                    rx = vx + qw * tx + (qy * tz - qz * ty);
+                    ry = vy + qw * ty + (qz * tx - qx * tz);
+                    rz = vz + qw * tz + (qx * ty - qy * tx);
+                }
+
+                /// a * b, with a given by its components, into element @p i of @p result.
+                inline void Multiply(const float (&a)[7], const Batch& b, size_t i, float& px, float& py, float& pz, float& qx, float& qy,
+                                     float& qz, float& qw)
+                {
+                    const float bx = b.qx[i], by = b.qy[i], bz = b.qz[i], bw = b.qw[i];
+                    qx = a[6] * bx + a[3] * bw + a[4] * bz - a[5] * by;
+                    qy = a[6] * by - a[3] * bz + a[4] * bw + a[5] * bx;
+                    qz = a[6] * bz + a[3] * by - a[4] * bx + a[5] * bw;
+                    qw = a[6] * bw - a[3] * bx - a[4] * by - a[5] * bz;
+                    RotateVector(a[3], a[4], a[5], a[6], b.position.x[i], b.position.y[i], b.position.z[i], px, py, pz);
+                    px += a[0];
+                    py += a[1];
+                    pz += a[2];
+                }
+            }  // namespace detail
+
+            /// result[i] = a * b[i], like operator*(XrPosef, XrPosef): e.g. bring many poses located in one space into another.
+            /// @p result may be @p b.
+            inline void Multiply(Batch& result, const XrPosef& a, const Batch& b)
+            {
+                const float aComponents[7] = {a.position.x,    a.position.y,    a.position.z,   a.orientation.x,
+                                              a.orientation.y, a.orientation.z, a.orientation.w};
+                result.Resize(b.Size());
+                for (size_t i = 0; i < b.Size(); ++i) {
+                    float px, py, pz, qx, qy, qz, qw;
+                    detail::Multiply(aComponents, b, i, px, py, pz, qx, qy, qz, qw);
+                    result.position.x[i] = px;
+                    result.position.y[i] = py;
+                    result.position.z[i] = pz;
+                    result.qx[i] = qx;
+                    result.qy[i] = qy;
+                    result.qz[i] = qz;
+                    result.qw[i] = qw;
+                }
+            }
+
+            /// result[i] = a[i] * b[i]. @p result may be @p a or @p b.
+            inline void Multiply(Batch& result, const Batch& a, const Batch& b)
+            {
+                assert(a.Size() == b.Size());
+                result.Resize(a.Size());
+                for (size_t i = 0; i < a.Size(); ++i) {
+                    const float aComponents[7] = {a.position.x[i], a.position.y[i], a.position.z[i], a.qx[i], a.qy[i], a.qz[i], a.qw[i]};
+                    float px, py, pz, qx, qy, qz, qw;
+                    detail::Multiply(aComponents, b, i, px, py, pz, qx, qy, qz, qw);
+                    result.position.x[i] = px;
+                    result.position.y[i] = py;
+                    result.position.z[i] = pz;
+                    result.qx[i] = qx;
+                    result.qy[i] = qy;
+                    result.qz[i] = qz;
+                    result.qw[i] = qw;
+                }
+            }
+
+            /// result[i] = inverse of a[i]. @p result may be @p a.
+            inline void Invert(Batch& result, const Batch& a)
+            {
+                result.Resize(a.Size());
+                for (size_t i = 0; i < a.Size(); ++i) {
+                    const float qx = -a.qx[i], qy = -a.qy[i], qz = -a.qz[i], qw = a.qw[i];
+                    float px, py, pz;
+                    detail::RotateVector(qx, qy, qz, qw, -a.position.x[i], -a.position.y[i], -a.position.z[i], px, py, pz);
+                    result.position.x[i] = px;
+                    result.position.y[i] = py;
+                    result.position.z[i] = pz;
+                    result.qx[i] = qx;
+                    result.qy[i] = qy;
+                    result.qz[i] = qz;
+                    result.qw[i] = qw;
+                }
+            }
+
+            /// result[i] = pose applied to points[i], e.g. bring the vertices of a plane polygon into its base space.
+            /// @p result may be @p points.
+            inline void TransformPoints(Vector::Batch& result, const XrPosef& pose, const Vector::Batch& points)
+            {
+                const XrQuaternionf& q = pose.orientation;
+                result.Resize(points.Size());
+                for (size_t i = 0; i < points.Size(); ++i) {
+                    float rx, ry, rz;
+                    detail::RotateVector(q.x, q.y, q.z, q.w, points.x[i], points.y[i], points.z[i], rx, ry, rz);
+                    result.x[i] = rx + pose.position.x;
+                    result.y[i] = ry + pose.position.y;
+                    result.z[i] = rz + pose.position.z;
+                }
+            }
+
+            /// Returns the index of the first pair of poses in @p a and @p b that are not approximately equal, with the same
+            /// tolerances as ApproxEqual, or a.Size() if they all are.
+            xr_math_operators_nodiscard inline size_t FindFirstNotApproxEqual(const Batch& a, const Batch& b,
+                                                                              float positionTolerance = 0.001f,
+                                                                              float angularTolerance = DegToRad(0.5f))
+            {
+                assert(a.Size() == b.Size());
+                const size_t count = std::min(a.Size(), b.Size());
+                const float positionToleranceSquared = positionTolerance * positionTolerance;
+                const float cosAngularTolerance = cos(angularTolerance);
+                const auto isApproxEqual = [&](size_t i) {
+                    const float dx = a.position.x[i] - b.position.x[i];
+                    const float dy = a.position.y[i] - b.position.y[i];
+                    const float dz = a.position.z[i] - b.position.z[i];
+                    const float dot = a.qx[i] * b.qx[i] + a.qy[i] * b.qy[i] + a.qz[i] * b.qz[i] + a.qw[i] * b.qw[i];
+                    return int(dx * dx + dy * dy + dz * dz < positionToleranceSquared) & int(std::fabs(dot) > cosAngularTolerance);
+                };
+                // Compare a block at a time without branching, and only look for the culprit in a block that failed.
+                constexpr size_t blockSize = 16;
+                for (size_t start = 0; start < count; start += blockSize) {
+                    const size_t end = std::min(count, start + blockSize);
+                    int allEqual = 1;
+                    for (size_t i = start; i < end; ++i) {
+                        allEqual &= isApproxEqual(i);
+                    }
+                    if (!allEqual) {
+                        for (size_t i = start; i < end; ++i) {
+                            if (!isApproxEqual(i)) {
+                                return i;
+                            }
+                        }
+                    }
+                }
+                return count;
+            }
         }  // namespace Pose
 
         namespace Matrix
@@ -12,6 +12,7 @@
 #include "loader_init_data.hpp"
 #include "loader_logger.hpp"
 #include "loader_platform.hpp"
+#include "loader_startup_timing.hpp"
 #include "manifest_file.hpp"
 #include "platform_utils.hpp"
 
@@ -19,6 +20,7 @@
 #include <openxr/openxr_loader_negotiation.h>
 
 #include <cstring>
+#include <future>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -26,6 +28,54 @@
 #include <vector>
 
 #define OPENXR_ENABLE_LAYERS_ENV_VAR "XR_ENABLE_API_LAYERS"
+#define OPENXR_PARALLEL_LAYER_LOADING_ENV_VAR "XR_LOADER_PARALLEL_API_LAYER_LOADING"
+
+// Anonymous namespace to keep these types private
+namespace {
+// An API layer library, opened ahead of negotiation, and the reason it could not be opened if it failed.
+struct OpenedApiLayerLibrary {
+    LoaderPlatformLibraryHandle handle = nullptr;
+    std::string error;
+};
+
+OpenedApiLayerLibrary OpenApiLayerLibrary(const std::string& library_path) {
+    ScopedLoaderStartupPhase phase(XR_LOADER_STARTUP_PHASE_LIBRARY_LOAD);
+    OpenedApiLayerLibrary library;
+    library.handle = LoaderPlatformLibraryOpen(library_path);
+    if (nullptr == library.handle) {
+        // The platform error is per-thread, so fetch it on the thread that tried to open the library.
+        library.error = LoaderPlatformLibraryOpenError(library_path);
+    }
+    return library;
+}
+
+// Holds the libraries of the layers being loaded, closing any that were not handed over to an ApiLayerInterface.
+class ApiLayerLibraries {
+   public:
+    explicit ApiLayerLibraries(size_t count) : _libraries(count) {}
+    ~ApiLayerLibraries() {
+        for (const OpenedApiLayerLibrary& library : _libraries) {
+            if (nullptr != library.handle) {
+                LoaderPlatformLibraryClose(library.handle);
+            }
+        }
+    }
+    ApiLayerLibraries(const ApiLayerLibraries&) = delete;
+    ApiLayerLibraries& operator=(const ApiLayerLibraries&) = delete;
+
+    OpenedApiLayerLibrary& operator[](size_t index) { return _libraries[index]; }
+
+   private:
+    std::vector<OpenedApiLayerLibrary> _libraries;
+};
+}  // namespace
+
+// Whether to find manifests and open layer libraries on several threads, set through the loader parallel loading environment
+// variable.  Negotiation and layer order are the same either way.
+static bool ParallelApiLayerLoadingEnabled() {
+    std::string value = PlatformUtilsGetEnv(OPENXR_PARALLEL_LAYER_LOADING_ENV_VAR);
+    return !value.empty() && value != "0";
+}
 
 // Add any layers defined in the loader layer environment variable.
 static void AddEnvironmentApiLayers(std::vector<std::string>& enabled_layers) {
@@ -196,23 +246,38 @@ XrResult ApiLayerInterface::LoadApiLayers(const std::string& openxr_command, uin
 
     bool any_loaded = false;
     std::vector<std::unique_ptr<ApiLayerManifestFile>> enabled_layer_manifest_files_in_init_order = {};
+    std::vector<std::unique_ptr<ApiLayerManifestFile>> explicit_layer_manifest_files = {};
+    const bool parallel_loading = ParallelApiLayerLoadingEnabled();
+
+    XrResult result;
+    if (parallel_loading) {
+        // Find the explicit layers on another thread while finding the implicit ones.
+        std::future<XrResult> explicit_result = std::async([&openxr_command, &explicit_layer_manifest_files]() {
+            return ApiLayerManifestFile::FindManifestFiles(openxr_command, MANIFEST_TYPE_EXPLICIT_API_LAYER,
+                                                           explicit_layer_manifest_files);
+        });
+        result = ApiLayerManifestFile::FindManifestFiles(openxr_command, MANIFEST_TYPE_IMPLICIT_API_LAYER,
+                                                         enabled_layer_manifest_files_in_init_order);
+        XrResult explicit_find_result = explicit_result.get();
+        if (XR_SUCCEEDED(result)) {
+            result = explicit_find_result;
+        }
+    } else {
+        // Find any implicit layers.
+        result = ApiLayerManifestFile::FindManifestFiles(openxr_command, MANIFEST_TYPE_IMPLICIT_API_LAYER,
+                                                         enabled_layer_manifest_files_in_init_order);
 
-    // Find any implicit layers.
-    XrResult result = ApiLayerManifestFile::FindManifestFiles(openxr_command, MANIFEST_TYPE_IMPLICIT_API_LAYER,
-                                                              enabled_layer_manifest_files_in_init_order);
+        // Find any explicit layers.
+        if (XR_SUCCEEDED(result)) {
+            result = ApiLayerManifestFile::FindManifestFiles(openxr_command, MANIFEST_TYPE_EXPLICIT_API_LAYER,
+                                                             explicit_layer_manifest_files);
+        }
+    }
 
     for (const auto& enabled_layer_manifest_file : enabled_layer_manifest_files_in_init_order) {
         layers_already_found.insert(enabled_layer_manifest_file->LayerName());
     }
 
-    // Find any explicit layers.
-    std::vector<std::unique_ptr<ApiLayerManifestFile>> explicit_layer_manifest_files = {};
-
-    if (XR_SUCCEEDED(result)) {
-        result = ApiLayerManifestFile::FindManifestFiles(openxr_command, MANIFEST_TYPE_EXPLICIT_API_LAYER,
-                                                         explicit_layer_manifest_files);
-    }
-
     bool found_all_layers = true;
 
     if (XR_SUCCEEDED(result)) {
@@ -270,17 +335,36 @@ XrResult ApiLayerInterface::LoadApiLayers(const std::string& openxr_command, uin
         }
     }
 
-    for (std::unique_ptr<ApiLayerManifestFile>& manifest_file : enabled_layer_manifest_files_in_init_order) {
-        LoaderPlatformLibraryHandle layer_library = LoaderPlatformLibraryOpen(manifest_file->LibraryPath());
+    const size_t layer_count = enabled_layer_manifest_files_in_init_order.size();
+    ApiLayerLibraries layer_libraries(layer_count);
+    if (parallel_loading && layer_count > 1) {
+        // Open all the libraries at once, then negotiate with them one at a time below in the usual order.
+        std::vector<std::future<OpenedApiLayerLibrary>> opening_libraries;
+        opening_libraries.reserve(layer_count);
+        for (const std::unique_ptr<ApiLayerManifestFile>& manifest_file : enabled_layer_manifest_files_in_init_order) {
+            opening_libraries.push_back(std::async(OpenApiLayerLibrary, manifest_file->LibraryPath()));
+        }
+        for (size_t layer = 0; layer < layer_count; ++layer) {
+            layer_libraries[layer] = opening_libraries[layer].get();
+        }
+    }
+
+    for (size_t layer = 0; layer < layer_count; ++layer) {
+        std::unique_ptr<ApiLayerManifestFile>& manifest_file = enabled_layer_manifest_files_in_init_order[layer];
+        if (nullptr == layer_libraries[layer].handle && layer_libraries[layer].error.empty()) {
+            layer_libraries[layer] = OpenApiLayerLibrary(manifest_file->LibraryPath());
+        }
+        // Take ownership of the library: from here on it is closed on each failure path or handed to the ApiLayerInterface.
+        LoaderPlatformLibraryHandle layer_library = layer_libraries[layer].handle;
+        layer_libraries[layer].handle = nullptr;
         if (nullptr == layer_library) {
             if (!any_loaded) {
                 last_error = XR_ERROR_FILE_ACCESS_ERROR;
             }
-            std::string library_message = LoaderPlatformLibraryOpenError(manifest_file->LibraryPath());
             std::string warning_message = "ApiLayerInterface::LoadApiLayers skipping layer ";
             warning_message += manifest_file->LayerName();
             warning_message += ", failed to load with message \"";
-            warning_message += library_message;
+            warning_message += layer_libraries[layer].error;
             warning_message += "\"";
             LoaderLogger::LogWarningMessage(openxr_command, warning_message);
             continue;
@@ -349,7 +433,11 @@ XrResult ApiLayerInterface::LoadApiLayers(const std::string& openxr_command, uin
         api_layer_info.structVersion = XR_API_LAYER_INFO_STRUCT_VERSION;
         api_layer_info.structSize = sizeof(XrNegotiateApiLayerRequest);
 
-        XrResult res = negotiate(&loader_info, manifest_file->LayerName().c_str(), &api_layer_info);
+        XrResult res;
+        {
+            ScopedLoaderStartupPhase phase(XR_LOADER_STARTUP_PHASE_LAYER_NEGOTIATION);
+            res = negotiate(&loader_info, manifest_file->LayerName().c_str(), &api_layer_info);
+        }
         // If we supposedly succeeded, but got a nullptr for getInstanceProcAddr
         // then something still went wrong, so return with an error.
         if (XR_SUCCEEDED(res) && nullptr == api_layer_info.getInstanceProcAddr) {
@@ -403,7 +491,7 @@ XrResult ApiLayerInterface::LoadApiLayers(const std::string& openxr_command, uin
             continue;
         }
 
-        {
+        if (LoaderLogger::IsEnabled(XR_LOADER_LOG_MESSAGE_SEVERITY_INFO_BIT)) {
             std::ostringstream oss;
             oss << "ApiLayerInterface::LoadApiLayers succeeded loading layer " << manifest_file->LayerName()
                 << " using interface version " << api_layer_info.layerInterfaceVersion << " and OpenXR API version "
@@ -455,9 +543,9 @@ ApiLayerInterface::ApiLayerInterface(const std::string& layer_name, LoaderPlatfo
       _supported_extensions(supported_extensions) {}
 
 ApiLayerInterface::~ApiLayerInterface() {
-    std::string info_message = "ApiLayerInterface being destroyed for layer ";
-    info_message += _layer_name;
-    LoaderLogger::LogInfoMessage("", info_message);
+    if (LoaderLogger::IsEnabled(XR_LOADER_LOG_MESSAGE_SEVERITY_INFO_BIT)) {
+        LoaderLogger::LogInfoMessage("", "ApiLayerInterface being destroyed for layer " + _layer_name);
+    }
     LoaderPlatformLibraryClose(_layer_library);
 }
 
@@ -19,6 +19,8 @@
 #include "loader_logger_recorders.hpp"
 #include "loader_logger.hpp"
 #include "loader_platform.hpp"
+#include "loader_startup_timing.hpp"
+#include "platform_utils.hpp"
 #include "runtime_interface.hpp"
 #include "xr_generated_dispatch_table_core.h"
 #include "xr_generated_loader.hpp"
@@ -26,10 +28,12 @@
 #include <openxr/openxr.h>
 
 #include <cstring>
+#include <future>
 #include <memory>
 #include <mutex>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -41,6 +45,68 @@ static std::mutex &GetGlobalLoaderMutex() {
     return loader_mutex;
 }
 
+// The merged instance extension properties of the implicit and environment-enabled API layers, the runtime and the loader,
+// as returned by xrEnumerateInstanceExtensionProperties with no layer name, keyed by the value of the layer enable environment
+// variable.  Applications call it at least twice, to size and then to fill their array, and each call would otherwise parse
+// every layer manifest and query the runtime again.  Only valid while the runtime they were queried from is loaded, so
+// cleared whenever it is unloaded.  Must only be used with the global loader lock held.
+static std::unordered_map<std::string, std::vector<XrExtensionProperties>> &GetInstanceExtensionPropertiesCache() {
+    static std::unordered_map<std::string, std::vector<XrExtensionProperties>> extension_properties_cache;
+    return extension_properties_cache;
+}
+
+// Unload the runtime, along with anything cached from it.  Must only be called with the global loader lock held.
+static void UnloadRuntimeAndCaches(const std::string &openxr_command) {
+    GetInstanceExtensionPropertiesCache().clear();
+    RuntimeInterface::UnloadRuntime(openxr_command);
+}
+
+#ifdef XR_KHR_LOADER_INIT_SUPPORT
+// Environment variable that, when set to something other than "0", makes xrInitializeLoaderKHR start finding and loading the
+// runtime on a background thread, so that it is ready by the time it is first needed.
+#define OPENXR_PRELOAD_RUNTIME_ENV_VAR "XR_LOADER_PRELOAD_RUNTIME"
+
+// The background runtime load started by xrInitializeLoaderKHR, if any.  Only set with the global loader lock held.
+static std::shared_future<void> &GetRuntimePreload() {
+    static std::shared_future<void> runtime_preload;
+    return runtime_preload;
+}
+
+static void PreloadRuntime() {
+    std::unique_lock<std::mutex> loader_lock(GetGlobalLoaderMutex());
+    if (XR_FAILED(RuntimeInterface::LoadRuntime("xrInitializeLoaderKHR"))) {
+        // The command that needs the runtime tries again, and reports the error itself.
+        LoaderLogger::LogWarningMessage("xrInitializeLoaderKHR", "Background runtime load failed");
+    }
+}
+
+static void StartRuntimePreload() {
+    std::string value = PlatformUtilsGetEnv(OPENXR_PRELOAD_RUNTIME_ENV_VAR);
+    if (value.empty() || value == "0") {
+        return;
+    }
+    std::unique_lock<std::mutex> loader_lock(GetGlobalLoaderMutex());
+    if (!GetRuntimePreload().valid()) {
+        GetRuntimePreload() = std::async(std::launch::async, PreloadRuntime).share();
+    }
+}
+
+// Wait for the background runtime load, if one was started, so that commands see the runtime it loaded rather than
+// racing it for the global loader lock.  Must be called without the global loader lock held.
+static void WaitForRuntimePreload() {
+    std::shared_future<void> runtime_preload;
+    {
+        std::unique_lock<std::mutex> loader_lock(GetGlobalLoaderMutex());
+        runtime_preload = GetRuntimePreload();
+    }
+    if (runtime_preload.valid()) {
+        runtime_preload.wait();
+    }
+}
+#else
+static void WaitForRuntimePreload() {}
+#endif  // XR_KHR_LOADER_INIT_SUPPORT
+
 // Prototypes for the debug utils calls used internally.
 static XRAPI_ATTR XrResult XRAPI_CALL LoaderTrampolineCreateDebugUtilsMessengerEXT(
     XrInstance instance, const XrDebugUtilsMessengerCreateInfoEXT *createInfo, XrDebugUtilsMessengerEXT *messenger);
@@ -78,7 +144,11 @@ inline bool IsMissingNullTerminator(const char (&str)[max_length]) {
 #ifdef XR_KHR_LOADER_INIT_SUPPORT  // platforms that support XR_KHR_loader_init.
 XRAPI_ATTR XrResult XRAPI_CALL LoaderXrInitializeLoaderKHR(const XrLoaderInitInfoBaseHeaderKHR *loaderInitInfo) XRLOADER_ABI_TRY {
     LoaderLogger::LogVerboseMessage("xrInitializeLoaderKHR", "Entering loader trampoline");
-    return InitializeLoaderInitData(loaderInitInfo);
+    XrResult result = InitializeLoaderInitData(loaderInitInfo);
+    if (XR_SUCCEEDED(result)) {
+        StartRuntimePreload();
+    }
+    return result;
 }
 XRLOADER_ABI_CATCH_FALLBACK
 #endif
@@ -118,55 +188,75 @@ LoaderXrEnumerateInstanceExtensionProperties(const char *layerName, uint32_t pro
         just_layer_properties = true;
     }
 
+    if (!just_layer_properties) {
+        WaitForRuntimePreload();
+    }
+
     std::vector<XrExtensionProperties> extension_properties = {};
-    XrResult result;
+    XrResult result = XR_SUCCESS;
 
     {
         // Make sure the runtime isn't unloaded while this call is in progress.
         std::unique_lock<std::mutex> loader_lock(GetGlobalLoaderMutex());
 
-        // Get the layer extension properties
-        result = ApiLayerInterface::GetInstanceExtensionProperties("xrEnumerateInstanceExtensionProperties", layerName,
-                                                                   extension_properties);
-        if (XR_SUCCEEDED(result) && !just_layer_properties) {
-            // If not specific to a layer, get the runtime extension properties
-            result = RuntimeInterface::LoadRuntime("xrEnumerateInstanceExtensionProperties");
-            if (XR_SUCCEEDED(result)) {
-                RuntimeInterface::GetRuntime().GetInstanceExtensionProperties(extension_properties);
-            } else {
-                LoaderLogger::LogErrorMessage("xrEnumerateInstanceExtensionProperties",
-                                              "Failed to find default runtime with RuntimeInterface::LoadRuntime()");
-            }
+        // The layers reported with no layer name depend on the layer enable environment variable, which may change between calls.
+        std::string cache_key;
+        auto &cache = GetInstanceExtensionPropertiesCache();
+        auto cached = cache.end();
+        if (!just_layer_properties) {
+            cache_key = PlatformUtilsGetEnv("XR_ENABLE_API_LAYERS");
+            cached = cache.find(cache_key);
         }
-    }
 
-    if (XR_FAILED(result)) {
-        LoaderLogger::LogErrorMessage("xrEnumerateInstanceExtensionProperties", "Failed querying extension properties");
-        return result;
-    }
+        if (cached != cache.end()) {
+            extension_properties = cached->second;
+        } else {
+            // Get the layer extension properties
+            result = ApiLayerInterface::GetInstanceExtensionProperties("xrEnumerateInstanceExtensionProperties", layerName,
+                                                                       extension_properties);
+            if (XR_SUCCEEDED(result) && !just_layer_properties) {
+                // If not specific to a layer, get the runtime extension properties
+                result = RuntimeInterface::LoadRuntime("xrEnumerateInstanceExtensionProperties");
+                if (XR_SUCCEEDED(result)) {
+                    RuntimeInterface::GetRuntime().GetInstanceExtensionProperties(extension_properties);
+                } else {
+                    LoaderLogger::LogErrorMessage("xrEnumerateInstanceExtensionProperties",
+                                                  "Failed to find default runtime with RuntimeInterface::LoadRuntime()");
+                }
+            }
 
-    // If this is not in reference to a specific layer, then add the loader-specific extension properties as well.
-    // These are extensions that the loader directly supports.
-    if (!just_layer_properties) {
-        for (const XrExtensionProperties &loader_prop : LoaderInstance::LoaderSpecificExtensions()) {
-            bool found_prop = false;
-            for (XrExtensionProperties &existing_prop : extension_properties) {
-                if (0 == strcmp(existing_prop.extensionName, loader_prop.extensionName)) {
-                    found_prop = true;
-                    // Use the loader version if it is newer
-                    if (existing_prop.extensionVersion < loader_prop.extensionVersion) {
-                        existing_prop.extensionVersion = loader_prop.extensionVersion;
+            // If this is not in reference to a specific layer, then add the loader-specific extension properties as well.
+            // These are extensions that the loader directly supports.
+            if (XR_SUCCEEDED(result) && !just_layer_properties) {
+                std::unordered_map<std::string, size_t> prop_index;
+                prop_index.reserve(extension_properties.size());
+                for (size_t prop = 0; prop < extension_properties.size(); ++prop) {
+                    prop_index.emplace(extension_properties[prop].extensionName, prop);
+                }
+                for (const XrExtensionProperties &loader_prop : LoaderInstance::LoaderSpecificExtensions()) {
+                    auto found_prop = prop_index.find(loader_prop.extensionName);
+                    if (found_prop != prop_index.end()) {
+                        // Use the loader version if it is newer
+                        XrExtensionProperties &existing_prop = extension_properties[found_prop->second];
+                        if (existing_prop.extensionVersion < loader_prop.extensionVersion) {
+                            existing_prop.extensionVersion = loader_prop.extensionVersion;
+                        }
+                    } else {
+                        // Only add extensions not supported by the loader
+                        prop_index.emplace(loader_prop.extensionName, extension_properties.size());
+                        extension_properties.push_back(loader_prop);
                     }
-                    break;
                 }
-            }
-            // Only add extensions not supported by the loader
-            if (!found_prop) {
-                extension_properties.push_back(loader_prop);
+                cache[cache_key] = extension_properties;
             }
         }
     }
 
+    if (XR_FAILED(result)) {
+        LoaderLogger::LogErrorMessage("xrEnumerateInstanceExtensionProperties", "Failed querying extension properties");
+        return result;
+    }
+
     auto num_extension_properties = static_cast<uint32_t>(extension_properties.size());
     if (propertyCapacityInput == 0) {
         *propertyCountOutput = num_extension_properties;
@@ -237,6 +327,8 @@ static XRAPI_ATTR XrResult XRAPI_CALL LoaderXrCreateInstance(const XrInstanceCre
         return XR_ERROR_VALIDATION_FAILURE;
     }
 
+    WaitForRuntimePreload();
+
     // Make sure the ActiveLoaderInstance::IsAvailable check is done atomically with RuntimeInterface::LoadRuntime.
     std::unique_lock<std::mutex> instance_lock(GetGlobalLoaderMutex());
 
@@ -253,6 +345,11 @@ static XRAPI_ATTR XrResult XRAPI_CALL LoaderXrCreateInstance(const XrInstanceCre
     std::vector<std::unique_ptr<ApiLayerInterface>> api_layer_interfaces;
     XrResult result;
 
+    const bool report_startup_timing = LoaderStartupTiming::IsEnabled();
+    if (report_startup_timing) {
+        LoaderStartupTiming::Begin();
+    }
+
     // Make sure only one thread is attempting to read the JSON files and use the instance.
     {
         // Load the available runtime
@@ -306,13 +403,17 @@ static XRAPI_ATTR XrResult XRAPI_CALL LoaderXrCreateInstance(const XrInstanceCre
     if (XR_FAILED(result)) {
         // Ensure the global loader instance and runtime are destroyed if something went wrong.
         ActiveLoaderInstance::Remove();
-        RuntimeInterface::UnloadRuntime("xrCreateInstance");
+        UnloadRuntimeAndCaches("xrCreateInstance");
         LoaderLogger::LogErrorMessage("xrCreateInstance", "xrCreateInstance failed");
     } else {
         *instance = loader_instance->GetInstanceHandle();
         LoaderLogger::LogVerboseMessage("xrCreateInstance", "Completed loader trampoline");
     }
 
+    if (report_startup_timing) {
+        LoaderStartupTiming::Report("xrCreateInstance");
+    }
+
     return result;
 }
 XRLOADER_ABI_CATCH_FALLBACK
@@ -354,7 +455,7 @@ static XRAPI_ATTR XrResult XRAPI_CALL LoaderXrDestroyInstance(XrInstance instanc
     LoaderLogger::LogVerboseMessage("xrDestroyInstance", "Completed loader trampoline");
 
     // Finally, unload the runtime if necessary
-    RuntimeInterface::UnloadRuntime("xrDestroyInstance");
+    UnloadRuntimeAndCaches("xrDestroyInstance");
 
     return XR_SUCCESS;
 }
@@ -475,6 +576,15 @@ static XRAPI_ATTR XrResult XRAPI_CALL LoaderXrTermGetInstanceProcAddr(XrInstance
         return XR_SUCCESS;
     }
 
+    // Core commands were already resolved from the runtime when the instance was created.
+    const XrGeneratedDispatchTableCore *dispatch_table = RuntimeInterface::GetDispatchTable(instance);
+    if (nullptr != dispatch_table) {
+        *function = GeneratedLoaderLookupDispatchTableCore(dispatch_table, name);
+        if (nullptr != *function) {
+            return XR_SUCCESS;
+        }
+    }
+
     return RuntimeInterface::GetInstanceProcAddr(instance, name, function);
 }
 XRLOADER_ABI_CATCH_FALLBACK
@@ -497,7 +607,7 @@ LoaderTrampolineCreateDebugUtilsMessengerEXT(XrInstance instance, const XrDebugU
         return result;
     }
 
-    result = loader_instance->DispatchTable()->CreateDebugUtilsMessengerEXT(instance, createInfo, messenger);
+    result = loader_instance->ExtensionDispatchTable()->CreateDebugUtilsMessengerEXT(instance, createInfo, messenger);
     LoaderLogger::LogVerboseMessage("xrCreateDebugUtilsMessengerEXT", "Completed loader trampoline");
     return result;
 }
@@ -520,7 +630,7 @@ XRLOADER_ABI_CATCH_BAD_ALLOC_OOM XRLOADER_ABI_CATCH_FALLBACK
         return result;
     }
 
-    result = loader_instance->DispatchTable()->DestroyDebugUtilsMessengerEXT(messenger);
+    result = loader_instance->ExtensionDispatchTable()->DestroyDebugUtilsMessengerEXT(messenger);
     LoaderLogger::LogVerboseMessage("xrDestroyDebugUtilsMessengerEXT", "Completed loader trampoline");
     return result;
 }
@@ -546,7 +656,7 @@ LoaderTrampolineSessionBeginDebugUtilsLabelRegionEXT(XrSession session, const Xr
         return result;
     }
     LoaderLogger::GetInstance().BeginLabelRegion(session, labelInfo);
-    const std::unique_ptr<XrGeneratedDispatchTableCore> &dispatch_table = loader_instance->DispatchTable();
+    const std::unique_ptr<XrGeneratedDispatchTableCore> &dispatch_table = loader_instance->ExtensionDispatchTable();
     if (nullptr != dispatch_table->SessionBeginDebugUtilsLabelRegionEXT) {
         return dispatch_table->SessionBeginDebugUtilsLabelRegionEXT(session, labelInfo);
     }
@@ -567,7 +677,7 @@ static XRAPI_ATTR XrResult XRAPI_CALL LoaderTrampolineSessionEndDebugUtilsLabelR
     }
 
     LoaderLogger::GetInstance().EndLabelRegion(session);
-    const std::unique_ptr<XrGeneratedDispatchTableCore> &dispatch_table = loader_instance->DispatchTable();
+    const std::unique_ptr<XrGeneratedDispatchTableCore> &dispatch_table = loader_instance->ExtensionDispatchTable();
     if (nullptr != dispatch_table->SessionEndDebugUtilsLabelRegionEXT) {
         return dispatch_table->SessionEndDebugUtilsLabelRegionEXT(session);
     }
@@ -597,7 +707,7 @@ LoaderTrampolineSessionInsertDebugUtilsLabelEXT(XrSession session, const XrDebug
 
     LoaderLogger::GetInstance().InsertLabel(session, labelInfo);
 
-    const std::unique_ptr<XrGeneratedDispatchTableCore> &dispatch_table = loader_instance->DispatchTable();
+    const std::unique_ptr<XrGeneratedDispatchTableCore> &dispatch_table = loader_instance->ExtensionDispatchTable();
     if (nullptr != dispatch_table->SessionInsertDebugUtilsLabelEXT) {
         return dispatch_table->SessionInsertDebugUtilsLabelEXT(session, labelInfo);
     }
@@ -612,7 +722,7 @@ LoaderTrampolineSetDebugUtilsObjectNameEXT(XrInstance instance, const XrDebugUti
     LoaderInstance *loader_instance;
     XrResult result = ActiveLoaderInstance::Get(&loader_instance, "xrSetDebugUtilsObjectNameEXT");
     if (XR_SUCCEEDED(result)) {
-        result = loader_instance->DispatchTable()->SetDebugUtilsObjectNameEXT(instance, nameInfo);
+        result = loader_instance->ExtensionDispatchTable()->SetDebugUtilsObjectNameEXT(instance, nameInfo);
     }
     return result;
 }
@@ -625,8 +735,8 @@ static XRAPI_ATTR XrResult XRAPI_CALL LoaderTrampolineSubmitDebugUtilsMessageEXT
     LoaderInstance *loader_instance;
     XrResult result = ActiveLoaderInstance::Get(&loader_instance, "xrSubmitDebugUtilsMessageEXT");
     if (XR_SUCCEEDED(result)) {
-        result =
-            loader_instance->DispatchTable()->SubmitDebugUtilsMessageEXT(instance, messageSeverity, messageTypes, callbackData);
+        result = loader_instance->ExtensionDispatchTable()->SubmitDebugUtilsMessageEXT(instance, messageSeverity, messageTypes,
+                                                                                        callbackData);
     }
     return result;
 }
@@ -809,6 +919,13 @@ XRAPI_ATTR XrResult XRAPI_CALL LoaderXrGetInstanceProcAddr(XrInstance instance,
         return XR_SUCCESS;
     }
 
+    // Core commands were already resolved through the layers when the instance was created, so answer from the dispatch table
+    // rather than asking every layer and the runtime again.  Commands they do not implement fall through to report the error.
+    *function = GeneratedLoaderLookupDispatchTableCore(loader_instance->DispatchTable().get(), name);
+    if (*function != nullptr) {
+        return XR_SUCCESS;
+    }
+
     // If the function is not supported by the loader, call down to the next layer.
     return loader_instance->GetInstanceProcAddr(name, function);
 }
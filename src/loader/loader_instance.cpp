@@ -16,6 +16,7 @@
 #include "api_layer_interface.hpp"
 #include "hex_and_handles.h"
 #include "loader_logger.hpp"
+#include "loader_startup_timing.hpp"
 #include "runtime_interface.hpp"
 #include "xr_generated_dispatch_table_core.h"
 #include "xr_generated_loader.hpp"
@@ -23,6 +24,7 @@
 #include <openxr/openxr.h>
 #include <openxr/openxr_loader_negotiation.h>
 
+#include <atomic>
 #include <cstring>
 #include <memory>
 #include <sstream>
@@ -35,6 +37,13 @@ std::unique_ptr<LoaderInstance>& GetSetCurrentLoaderInstance() {
     static std::unique_ptr<LoaderInstance> current_loader_instance;
     return current_loader_instance;
 }
+
+// The instance owned by GetSetCurrentLoaderInstance(), published for the trampolines of every command, which read it without
+// taking any lock.  Set and Remove are only called with the global loader lock held, so only the readers race with them.
+std::atomic<LoaderInstance*>& GetPublishedLoaderInstance() {
+    static std::atomic<LoaderInstance*> published_loader_instance{nullptr};
+    return published_loader_instance;
+}
 }  // namespace
 
 namespace ActiveLoaderInstance {
@@ -45,11 +54,12 @@ XrResult Set(std::unique_ptr<LoaderInstance> loader_instance, const char* log_fu
     }
 
     GetSetCurrentLoaderInstance() = std::move(loader_instance);
+    GetPublishedLoaderInstance().store(GetSetCurrentLoaderInstance().get(), std::memory_order_release);
     return XR_SUCCESS;
 }
 
 XrResult Get(LoaderInstance** loader_instance, const char* log_function_name) {
-    *loader_instance = GetSetCurrentLoaderInstance().get();
+    *loader_instance = GetPublishedLoaderInstance().load(std::memory_order_acquire);
     if (*loader_instance == nullptr) {
         LoaderLogger::LogErrorMessage(log_function_name, "No active XrInstance handle.");
         return XR_ERROR_HANDLE_INVALID;
@@ -58,9 +68,12 @@ XrResult Get(LoaderInstance** loader_instance, const char* log_function_name) {
     return XR_SUCCESS;
 }
 
-bool IsAvailable() { return GetSetCurrentLoaderInstance() != nullptr; }
+bool IsAvailable() { return GetPublishedLoaderInstance().load(std::memory_order_acquire) != nullptr; }
 
-void Remove() { GetSetCurrentLoaderInstance().reset(nullptr); }
+void Remove() {
+    GetPublishedLoaderInstance().store(nullptr, std::memory_order_release);
+    GetSetCurrentLoaderInstance().reset(nullptr);
+}
 }  // namespace ActiveLoaderInstance
 
 // Extensions that are supported by the loader, but may not be supported
@@ -243,10 +256,12 @@ XrResult LoaderInstance::CreateInstance(PFN_xrGetInstanceProcAddr get_instance_p
             api_layer_ci.nextInfo = next_info_list.get();
             //! @todo do we filter our create info extension list here?
             //! Think that actually each layer might need to filter...
+            ScopedLoaderStartupPhase phase(XR_LOADER_STARTUP_PHASE_CREATE_INSTANCE);
             last_error = topmost_cali_fp(modified_create_info, &api_layer_ci, &instance);
 
         } else {
             // The loader's terminator is the topmost CreateInstance if there are no layers.
+            ScopedLoaderStartupPhase phase(XR_LOADER_STARTUP_PHASE_CREATE_INSTANCE);
             last_error = create_instance_term(modified_create_info, &instance);
         }
 
@@ -258,12 +273,14 @@ XrResult LoaderInstance::CreateInstance(PFN_xrGetInstanceProcAddr get_instance_p
     if (XR_SUCCEEDED(last_error)) {
         loader_instance->reset(new LoaderInstance(instance, info, topmost_gipa, std::move(api_layer_interfaces)));
 
-        std::ostringstream oss;
-        oss << "LoaderInstance::CreateInstance succeeded with ";
-        oss << (*loader_instance)->LayerInterfaces().size();
-        oss << " layers enabled and runtime interface - created instance = ";
-        oss << HandleToHexString((*loader_instance)->GetInstanceHandle());
-        LoaderLogger::LogInfoMessage("xrCreateInstance", oss.str());
+        if (LoaderLogger::IsEnabled(XR_LOADER_LOG_MESSAGE_SEVERITY_INFO_BIT)) {
+            std::ostringstream oss;
+            oss << "LoaderInstance::CreateInstance succeeded with ";
+            oss << (*loader_instance)->LayerInterfaces().size();
+            oss << " layers enabled and runtime interface - created instance = ";
+            oss << HandleToHexString((*loader_instance)->GetInstanceHandle());
+            LoaderLogger::LogInfoMessage("xrCreateInstance", oss.str());
+        }
     }
 
     return last_error;
@@ -283,14 +300,24 @@ LoaderInstance::LoaderInstance(XrInstance instance, const XrInstanceCreateInfo*
         _enabled_extensions.push_back(create_info->enabledExtensionNames[ext]);
     }
 
-    GeneratedXrPopulateDispatchTableCore(_dispatch_table.get(), instance, topmost_gipa);
+    ScopedLoaderStartupPhase phase(XR_LOADER_STARTUP_PHASE_DISPATCH_TABLE);
+    GeneratedXrPopulateDispatchTableCoreCommands(_dispatch_table.get(), instance, topmost_gipa);
+}
+
+const std::unique_ptr<XrGeneratedDispatchTableCore>& LoaderInstance::ExtensionDispatchTable() {
+    std::call_once(_extension_commands_resolved, [this]() {
+        GeneratedXrPopulateDispatchTableCoreExtensionCommands(_dispatch_table.get(), _runtime_instance, _topmost_gipa);
+    });
+    return _dispatch_table;
 }
 
 LoaderInstance::~LoaderInstance() {
-    std::ostringstream oss;
-    oss << "Destroying LoaderInstance = ";
-    oss << PointerToHexString(this);
-    LoaderLogger::LogInfoMessage("xrDestroyInstance", oss.str());
+    if (LoaderLogger::IsEnabled(XR_LOADER_LOG_MESSAGE_SEVERITY_INFO_BIT)) {
+        std::ostringstream oss;
+        oss << "Destroying LoaderInstance = ";
+        oss << PointerToHexString(this);
+        LoaderLogger::LogInfoMessage("xrDestroyInstance", oss.str());
+    }
 }
 
 bool LoaderInstance::ExtensionIsEnabled(const std::string& extension) {
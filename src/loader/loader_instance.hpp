@@ -55,6 +55,8 @@ class LoaderInstance {
 
     XrInstance GetInstanceHandle() { return _runtime_instance; }
     const std::unique_ptr<XrGeneratedDispatchTableCore>& DispatchTable() { return _dispatch_table; }
+    // The dispatch table, after resolving its extension commands through the layer chain if this is the first use of one.
+    const std::unique_ptr<XrGeneratedDispatchTableCore>& ExtensionDispatchTable();
     std::vector<std::unique_ptr<ApiLayerInterface>>& LayerInterfaces() { return _api_layer_interfaces; }
     bool ExtensionIsEnabled(const std::string& extension);
     XrDebugUtilsMessengerEXT DefaultDebugUtilsMessenger() { return _messenger; }
@@ -72,6 +74,8 @@ class LoaderInstance {
     std::vector<std::unique_ptr<ApiLayerInterface>> _api_layer_interfaces;
 
     std::unique_ptr<XrGeneratedDispatchTableCore> _dispatch_table;
+    // Extension commands in the dispatch table are only resolved when one is first called.
+    std::once_flag _extension_commands_resolved;
     // Internal debug messenger created during xrCreateInstance
     XrDebugUtilsMessengerEXT _messenger{XR_NULL_HANDLE};
 };
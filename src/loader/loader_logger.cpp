@@ -110,8 +110,13 @@ LoaderLogger::LoaderLogger() {
     if (debug_string != "none") {
         AddLogRecorder(MakeStdErrLoaderLogRecorder(nullptr));
 #ifdef __ANDROID__
-        // Add a logcat logger by default.
-        AddLogRecorder(MakeLogcatLoaderLogRecorder());
+        // Add a logcat logger by default.  While debugging, write from a background thread so the flood of verbose
+        // messages does not stall the threads calling OpenXR.
+        if (debug_string.empty()) {
+            AddLogRecorder(MakeLogcatLoaderLogRecorder());
+        } else {
+            AddLogRecorder(MakeAsyncLogcatLoaderLogRecorder());
+        }
 #endif  // __ANDROID__
     }
 
@@ -135,19 +140,42 @@ LoaderLogger::LoaderLogger() {
             debug_flags = XR_LOADER_LOG_MESSAGE_SEVERITY_ERROR_BIT | XR_LOADER_LOG_MESSAGE_SEVERITY_WARNING_BIT |
                           XR_LOADER_LOG_MESSAGE_SEVERITY_INFO_BIT | XR_LOADER_LOG_MESSAGE_SEVERITY_VERBOSE_BIT;
         }
-        AddLogRecorder(MakeStdOutLoaderLogRecorder(nullptr, debug_flags));
+
+        // If XR_LOADER_DEBUG_FILE is also set, write to that file from a background thread instead of to std::cout.
+        std::unique_ptr<LoaderLogRecorder> debug_recorder;
+        std::string debug_file = PlatformUtilsGetSecureEnv("XR_LOADER_DEBUG_FILE");
+        if (!debug_file.empty()) {
+            debug_recorder = MakeAsyncFileLoaderLogRecorder(debug_file, debug_flags);
+        }
+        if (!debug_recorder) {
+            debug_recorder = MakeStdOutLoaderLogRecorder(nullptr, debug_flags);
+        }
+        AddLogRecorder(std::move(debug_recorder));
     }
 }
 
+void LoaderLogger::UpdateEnabledMessages() {
+    XrLoaderLogMessageSeverityFlags severities = 0;
+    XrLoaderLogMessageTypeFlags types = 0;
+    for (const std::unique_ptr<LoaderLogRecorder>& recorder : _recorders) {
+        severities |= recorder->MessageSeverities();
+        types |= recorder->MessageTypes();
+    }
+    _enabled_severities.store(severities, std::memory_order_relaxed);
+    _enabled_types.store(types, std::memory_order_relaxed);
+}
+
 void LoaderLogger::AddLogRecorder(std::unique_ptr<LoaderLogRecorder>&& recorder) {
     std::unique_lock<std::shared_timed_mutex> lock(_mutex);
     _recorders.push_back(std::move(recorder));
+    UpdateEnabledMessages();
 }
 
 void LoaderLogger::AddLogRecorderForXrInstance(XrInstance instance, std::unique_ptr<LoaderLogRecorder>&& recorder) {
     std::unique_lock<std::shared_timed_mutex> lock(_mutex);
     _recordersByInstance[instance].insert(recorder->UniqueId());
     _recorders.emplace_back(std::move(recorder));
+    UpdateEnabledMessages();
 }
 
 void LoaderLogger::RemoveLogRecorder(uint64_t unique_id) {
@@ -160,6 +188,7 @@ void LoaderLogger::RemoveLogRecorder(uint64_t unique_id) {
             messengersForInstance.erase(unique_id);
         }
     }
+    UpdateEnabledMessages();
 }
 
 void LoaderLogger::RemoveLogRecordersForXrInstance(XrInstance instance) {
@@ -170,12 +199,17 @@ void LoaderLogger::RemoveLogRecordersForXrInstance(XrInstance instance) {
             return recorders.find(recorder->UniqueId()) != recorders.end();
         });
         _recordersByInstance.erase(instance);
+        UpdateEnabledMessages();
     }
 }
 
 bool LoaderLogger::LogMessage(XrLoaderLogMessageSeverityFlagBits message_severity, XrLoaderLogMessageTypeFlags message_type,
                               const std::string& message_id, const std::string& command_name, const std::string& message,
                               const std::vector<XrSdkLogObjectInfo>& objects) {
+    if (!IsEnabled(message_severity, message_type)) {
+        return false;
+    }
+
     XrLoaderLogMessengerCallbackData callback_data = {};
     callback_data.message_id = message_id.c_str();
     callback_data.command_name = command_name.c_str();
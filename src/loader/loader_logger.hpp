@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -59,6 +60,7 @@ enum XrLoaderLogType {
     XR_LOADER_LOG_DEBUG_UTILS,
     XR_LOADER_LOG_DEBUGGER,
     XR_LOADER_LOG_LOGCAT,
+    XR_LOADER_LOG_ASYNC,
 };
 
 class LoaderLogRecorder {
@@ -132,6 +134,15 @@ class LoaderLogger {
     bool LogMessage(XrLoaderLogMessageSeverityFlagBits message_severity, XrLoaderLogMessageTypeFlags message_type,
                     const std::string& message_id, const std::string& command_name, const std::string& message,
                     const std::vector<XrSdkLogObjectInfo>& objects = {});
+
+    //! Whether any recorder may want a message of this severity and type.  Check this before building a message that is
+    //! expensive to format, since verbose and info messages are usually discarded.
+    static bool IsEnabled(XrLoaderLogMessageSeverityFlagBits message_severity,
+                          XrLoaderLogMessageTypeFlags message_type = XR_LOADER_LOG_MESSAGE_TYPE_GENERAL_BIT) {
+        const LoaderLogger& logger = GetInstance();
+        return (logger._enabled_severities.load(std::memory_order_relaxed) & message_severity) != 0 &&
+               (logger._enabled_types.load(std::memory_order_relaxed) & message_type) != 0;
+    }
     static bool LogErrorMessage(const std::string& command_name, const std::string& message,
                                 const std::vector<XrSdkLogObjectInfo>& objects = {}) {
         return GetInstance().LogMessage(XR_LOADER_LOG_MESSAGE_SEVERITY_ERROR_BIT, XR_LOADER_LOG_MESSAGE_TYPE_GENERAL_BIT,
@@ -142,13 +153,23 @@ class LoaderLogger {
         return GetInstance().LogMessage(XR_LOADER_LOG_MESSAGE_SEVERITY_WARNING_BIT, XR_LOADER_LOG_MESSAGE_TYPE_GENERAL_BIT,
                                         "OpenXR-Loader", command_name, message, objects);
     }
-    static bool LogInfoMessage(const std::string& command_name, const std::string& message,
+    // Info and verbose messages are mostly string literals: these take them as-is so no std::string is built when the
+    // message would be discarded.
+    template <typename CommandName, typename Message>
+    static bool LogInfoMessage(const CommandName& command_name, const Message& message,
                                const std::vector<XrSdkLogObjectInfo>& objects = {}) {
+        if (!IsEnabled(XR_LOADER_LOG_MESSAGE_SEVERITY_INFO_BIT)) {
+            return false;
+        }
         return GetInstance().LogMessage(XR_LOADER_LOG_MESSAGE_SEVERITY_INFO_BIT, XR_LOADER_LOG_MESSAGE_TYPE_GENERAL_BIT,
                                         "OpenXR-Loader", command_name, message, objects);
     }
-    static bool LogVerboseMessage(const std::string& command_name, const std::string& message,
+    template <typename CommandName, typename Message>
+    static bool LogVerboseMessage(const CommandName& command_name, const Message& message,
                                   const std::vector<XrSdkLogObjectInfo>& objects = {}) {
+        if (!IsEnabled(XR_LOADER_LOG_MESSAGE_SEVERITY_VERBOSE_BIT)) {
+            return false;
+        }
         return GetInstance().LogMessage(XR_LOADER_LOG_MESSAGE_SEVERITY_VERBOSE_BIT, XR_LOADER_LOG_MESSAGE_TYPE_GENERAL_BIT,
                                         "OpenXR-Loader", command_name, message, objects);
     }
@@ -174,8 +195,15 @@ class LoaderLogger {
    private:
     LoaderLogger();
 
+    // Must be called with _mutex held for writing.
+    void UpdateEnabledMessages();
+
     std::shared_timed_mutex _mutex;
 
+    // Union of the severities and types wanted by all recorders, readable without the mutex.
+    std::atomic<XrLoaderLogMessageSeverityFlags> _enabled_severities{0};
+    std::atomic<XrLoaderLogMessageTypeFlags> _enabled_types{0};
+
     // List of *all* available recorder objects (including created specifically for an Instance)
     std::vector<std::unique_ptr<LoaderLogRecorder>> _recorders;
 
@@ -14,8 +14,15 @@
 
 #include <openxr/openxr.h>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 #include <iostream>
 #include <sstream>
@@ -234,6 +241,167 @@ bool LogcatLoaderLogRecorder::LogMessage(XrLoaderLogMessageSeverityFlagBits mess
 }
 #endif  // __ANDROID__
 
+// Bounded multi-producer, multi-consumer queue of log records, after Dmitry Vyukov's array-based queue.  The sequence number
+// of each cell says whether it is free for the producer of this lap or holds a record for the consumer.
+class LogRecordQueue {
+   public:
+    struct Record {
+        XrLoaderLogMessageSeverityFlagBits severity;
+        std::string message;
+    };
+
+    explicit LogRecordQueue(size_t capacity) : _cells(new Cell[capacity]), _mask(capacity - 1) {
+        for (size_t i = 0; i < capacity; ++i) {
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool TryPush(Record&& record) {
+        size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = _cells[pos & _mask];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (difference == 0) {
+                if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.record = std::move(record);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                return false;  // Full
+            } else {
+                pos = _enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool TryPop(Record& record) {
+        size_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = _cells[pos & _mask];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+            if (difference == 0) {
+                if (_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    record = std::move(cell.record);
+                    cell.record.message.clear();
+                    cell.sequence.store(pos + _mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                return false;  // Empty
+            } else {
+                pos = _dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+   private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        Record record;
+    };
+
+    std::unique_ptr<Cell[]> _cells;
+    const size_t _mask;
+    std::atomic<size_t> _enqueue_pos{0};
+    std::atomic<size_t> _dequeue_pos{0};
+};
+
+// Formats messages on the logging thread and hands them to a background thread that writes them out, so that slow output does
+// not stall the application.  Memory is bounded by the queue capacity and the message length limit: messages that do not fit
+// are dropped and counted, and the count is written out once there is room again.
+class AsyncLoaderLogRecorder : public LoaderLogRecorder {
+   public:
+    using WriteFunction = std::function<void(XrLoaderLogMessageSeverityFlagBits severity, const std::string& message)>;
+    using FlushFunction = std::function<void()>;
+
+    AsyncLoaderLogRecorder(XrLoaderLogMessageSeverityFlags flags, WriteFunction write, FlushFunction flush)
+        : LoaderLogRecorder(XR_LOADER_LOG_ASYNC, nullptr, flags, 0xFFFFFFFFUL),
+          _write(std::move(write)),
+          _flush(std::move(flush)),
+          _queue(kQueueCapacity) {
+        Start();
+        _thread = std::thread(&AsyncLoaderLogRecorder::WriteQueuedMessages, this);
+    }
+
+    ~AsyncLoaderLogRecorder() override {
+        {
+            std::unique_lock<std::mutex> lock(_wake_mutex);
+            _stopping = true;
+        }
+        _wake.notify_one();
+        _thread.join();
+    }
+
+    bool LogMessage(XrLoaderLogMessageSeverityFlagBits message_severity, XrLoaderLogMessageTypeFlags message_type,
+                    const XrLoaderLogMessengerCallbackData* callback_data) override {
+        if (_active && 0 != (_message_severities & message_severity) && 0 != (_message_types & message_type)) {
+            std::ostringstream oss;
+            OutputMessageToStream(oss, message_severity, message_type, callback_data);
+            std::string message = oss.str();
+            if (message.size() > kMaxMessageLength) {
+                message.resize(kMaxMessageLength);
+                message += "...\n";
+            }
+            if (!_queue.TryPush({message_severity, std::move(message)})) {
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        // Return of "true" means that we should exit the application after the logged message.  We
+        // don't want to do that for our internal logging.  Only let a user return true.
+        return false;
+    }
+
+   private:
+    static constexpr size_t kQueueCapacity = 1024;  // Must be a power of two
+    static constexpr size_t kMaxMessageLength = 4096;
+    static constexpr std::chrono::milliseconds kWriteInterval{10};
+
+    void WriteQueuedMessages() {
+        LogRecordQueue::Record record;
+        bool stopping = false;
+        while (!stopping) {
+            {
+                std::unique_lock<std::mutex> lock(_wake_mutex);
+                _wake.wait_for(lock, kWriteInterval, [this] { return _stopping; });
+                stopping = _stopping;
+            }
+
+            bool wrote = false;
+            while (_queue.TryPop(record)) {
+                _write(record.severity, record.message);
+                wrote = true;
+            }
+            const uint64_t dropped = _dropped.exchange(0, std::memory_order_relaxed);
+            if (dropped != 0) {
+                _write(XR_LOADER_LOG_MESSAGE_SEVERITY_WARNING_BIT,
+                       "Warning [GENERAL | OpenXR-Loader] : " + std::to_string(dropped) + " log messages dropped, queue full\n");
+                wrote = true;
+            }
+            if (wrote && _flush) {
+                _flush();
+            }
+        }
+    }
+
+    WriteFunction _write;
+    FlushFunction _flush;
+    LogRecordQueue _queue;
+    std::atomic<uint64_t> _dropped{0};
+
+    std::mutex _wake_mutex;
+    std::condition_variable _wake;
+    bool _stopping{false};
+    std::thread _thread;
+};
+
+constexpr size_t AsyncLoaderLogRecorder::kQueueCapacity;
+constexpr size_t AsyncLoaderLogRecorder::kMaxMessageLength;
+constexpr std::chrono::milliseconds AsyncLoaderLogRecorder::kWriteInterval;
+
 #ifdef _WIN32
 // Unified stdout/stderr logger
 DebuggerLoaderLogRecorder::DebuggerLoaderLogRecorder(void* user_data, XrLoaderLogMessageSeverityFlags flags)
@@ -270,6 +438,17 @@ std::unique_ptr<LoaderLogRecorder> MakeStdErrLoaderLogRecorder(void* user_data)
     return recorder;
 }
 
+std::unique_ptr<LoaderLogRecorder> MakeAsyncFileLoaderLogRecorder(const std::string& filename, XrLoaderLogMessageSeverityFlags flags) {
+    auto file = std::make_shared<std::ofstream>(filename, std::ios::out | std::ios::app);
+    if (!file->is_open()) {
+        return nullptr;
+    }
+    std::unique_ptr<LoaderLogRecorder> recorder(new AsyncLoaderLogRecorder(
+        flags, [file](XrLoaderLogMessageSeverityFlagBits, const std::string& message) { *file << message; },
+        [file] { file->flush(); }));
+    return recorder;
+}
+
 std::unique_ptr<LoaderLogRecorder> MakeDebugUtilsLoaderLogRecorder(const XrDebugUtilsMessengerCreateInfoEXT* create_info,
                                                                    XrDebugUtilsMessengerEXT debug_messenger) {
     std::unique_ptr<LoaderLogRecorder> recorder(new DebugUtilsLogRecorder(create_info, debug_messenger));
@@ -281,6 +460,17 @@ std::unique_ptr<LoaderLogRecorder> MakeLogcatLoaderLogRecorder() {
     std::unique_ptr<LoaderLogRecorder> recorder(new LogcatLoaderLogRecorder());
     return recorder;
 }
+
+std::unique_ptr<LoaderLogRecorder> MakeAsyncLogcatLoaderLogRecorder() {
+    std::unique_ptr<LoaderLogRecorder> recorder(new AsyncLoaderLogRecorder(
+        XR_LOADER_LOG_MESSAGE_SEVERITY_VERBOSE_BIT | XR_LOADER_LOG_MESSAGE_SEVERITY_INFO_BIT |
+            XR_LOADER_LOG_MESSAGE_SEVERITY_WARNING_BIT | XR_LOADER_LOG_MESSAGE_SEVERITY_ERROR_BIT,
+        [](XrLoaderLogMessageSeverityFlagBits severity, const std::string& message) {
+            __android_log_write(LoaderToAndroidLogPriority(severity), "OpenXR-Loader", message.c_str());
+        },
+        nullptr));
+    return recorder;
+}
 #endif
 
 #ifdef _WIN32
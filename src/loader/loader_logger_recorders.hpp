@@ -14,6 +14,7 @@
 #include <openxr/openxr.h>
 
 #include <memory>
+#include <string>
 
 //! Standard Error logger, on by default. Disabled with environment variable XR_LOADER_DEBUG = "none".
 std::unique_ptr<LoaderLogRecorder> MakeStdErrLoaderLogRecorder(void* user_data);
@@ -26,6 +27,15 @@ std::unique_ptr<LoaderLogRecorder> MakeStdOutLoaderLogRecorder(void* user_data,
 std::unique_ptr<LoaderLogRecorder> MakeLogcatLoaderLogRecorder();
 #endif
 
+//! Logger that writes to a file from a background thread, used with XR_LOADER_DEBUG_FILE.  Returns nullptr if the file cannot
+//! be opened.
+std::unique_ptr<LoaderLogRecorder> MakeAsyncFileLoaderLogRecorder(const std::string& filename, XrLoaderLogMessageSeverityFlags flags);
+
+#ifdef __ANDROID__
+//! Android liblog ("logcat") logger that writes from a background thread
+std::unique_ptr<LoaderLogRecorder> MakeAsyncLogcatLoaderLogRecorder();
+#endif
+
 // Debug Utils logger used with XR_EXT_debug_utils
 std::unique_ptr<LoaderLogRecorder> MakeDebugUtilsLoaderLogRecorder(const XrDebugUtilsMessengerCreateInfoEXT* create_info,
                                                                    XrDebugUtilsMessengerEXT debug_messenger);
@@ -36,5 +46,4 @@ std::unique_ptr<LoaderLogRecorder> MakeDebuggerLoaderLogRecorder(void* user_data
 #endif
 
 // TODO: Add other Derived classes:
-//  - FileLoaderLogRecorder     - During/after xrCreateInstance
 //  - PipeLoaderLogRecorder?    - During/after xrCreateInstance
@@ -0,0 +1,78 @@
+// Copyright (c) 2017-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+
+#include "loader_startup_timing.hpp"
+
+#include "loader_logger.hpp"
+#include "platform_utils.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+// Anonymous namespace to keep these types private
+namespace {
+const char* const kPhaseNames[XR_LOADER_STARTUP_PHASE_COUNT] = {
+    "manifest search", "manifest parse", "library load", "layer negotiation", "runtime negotiation", "create instance",
+    "dispatch table"};
+
+std::atomic<uint64_t> g_phase_microseconds[XR_LOADER_STARTUP_PHASE_COUNT];
+std::chrono::steady_clock::time_point g_begin_time;
+
+// The innermost phase being timed on this thread.
+thread_local ScopedLoaderStartupPhase* g_current_phase = nullptr;
+}  // namespace
+
+bool LoaderStartupTiming::IsEnabled() {
+    static const bool enabled = []() {
+        std::string value = PlatformUtilsGetEnv(OPENXR_STARTUP_TIMING_ENV_VAR);
+        return !value.empty() && value != "0";
+    }();
+    return enabled;
+}
+
+void LoaderStartupTiming::Begin() {
+    for (std::atomic<uint64_t>& phase_microseconds : g_phase_microseconds) {
+        phase_microseconds.store(0, std::memory_order_relaxed);
+    }
+    g_begin_time = std::chrono::steady_clock::now();
+}
+
+void LoaderStartupTiming::Report(const std::string& openxr_command) {
+    const auto total =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - g_begin_time).count();
+    std::ostringstream oss;
+    oss << "Startup timing (us): total " << total;
+    for (uint32_t phase = 0; phase < XR_LOADER_STARTUP_PHASE_COUNT; ++phase) {
+        oss << ", " << kPhaseNames[phase] << " " << g_phase_microseconds[phase].load(std::memory_order_relaxed);
+    }
+    LoaderLogger::LogInfoMessage(openxr_command, oss.str());
+}
+
+void LoaderStartupTiming::AddPhaseTime(XrLoaderStartupPhase phase, std::chrono::microseconds duration) {
+    g_phase_microseconds[phase].fetch_add(static_cast<uint64_t>(duration.count()), std::memory_order_relaxed);
+}
+
+ScopedLoaderStartupPhase::ScopedLoaderStartupPhase(XrLoaderStartupPhase phase)
+    : _phase(phase), _enabled(LoaderStartupTiming::IsEnabled()) {
+    if (_enabled) {
+        _outer = g_current_phase;
+        g_current_phase = this;
+        _start = std::chrono::steady_clock::now();
+    }
+}
+
+ScopedLoaderStartupPhase::~ScopedLoaderStartupPhase() {
+    if (_enabled) {
+        const std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - _start;
+        LoaderStartupTiming::AddPhaseTime(_phase, std::chrono::duration_cast<std::chrono::microseconds>(elapsed - _nested_time));
+        if (nullptr != _outer) {
+            _outer->_nested_time += elapsed;
+        }
+        g_current_phase = _outer;
+    }
+}
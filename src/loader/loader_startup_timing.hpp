@@ -0,0 +1,58 @@
+// Copyright (c) 2017-2024, The Khronos Group Inc.
+//
+// SPDX-License-Identifier: Apache-2.0 OR MIT
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Environment variable that turns on the xrCreateInstance phase timing report.
+#define OPENXR_STARTUP_TIMING_ENV_VAR "XR_LOADER_STARTUP_TIMING"
+
+// The phases of xrCreateInstance that are timed when the startup timing report is enabled.
+enum XrLoaderStartupPhase {
+    XR_LOADER_STARTUP_PHASE_MANIFEST_SEARCH = 0,  // Finding manifest files, excluding parsing them
+    XR_LOADER_STARTUP_PHASE_MANIFEST_PARSE,       // Reading and parsing manifest JSON
+    XR_LOADER_STARTUP_PHASE_LIBRARY_LOAD,         // Opening runtime and API layer libraries
+    XR_LOADER_STARTUP_PHASE_LAYER_NEGOTIATION,    // xrNegotiateLoaderApiLayerInterface
+    XR_LOADER_STARTUP_PHASE_RUNTIME_NEGOTIATION,  // xrNegotiateLoaderRuntimeInterface
+    XR_LOADER_STARTUP_PHASE_CREATE_INSTANCE,      // The xrCreateInstance call down the layer chain to the runtime
+    XR_LOADER_STARTUP_PHASE_DISPATCH_TABLE,       // Populating the loader dispatch table
+    XR_LOADER_STARTUP_PHASE_COUNT,
+};
+
+// Accumulates the time spent in each startup phase of xrCreateInstance, and reports it through the LoaderLogger.
+// Phases nest: time spent in an inner phase is not counted in the outer one.  Time spent on other threads (see
+// XR_LOADER_PARALLEL_API_LAYER_LOADING) is counted too, so the phases may add up to more than the elapsed time.
+class LoaderStartupTiming {
+   public:
+    // True if the startup timing environment variable is set to something other than "0".
+    static bool IsEnabled();
+
+    // Clear the accumulated phase times and start timing a new xrCreateInstance call.
+    static void Begin();
+
+    // Log the time spent in each phase since Begin, as an info message.
+    static void Report(const std::string& openxr_command);
+
+    static void AddPhaseTime(XrLoaderStartupPhase phase, std::chrono::microseconds duration);
+};
+
+// Times the enclosing scope as one startup phase, if the startup timing report is enabled.
+class ScopedLoaderStartupPhase {
+   public:
+    explicit ScopedLoaderStartupPhase(XrLoaderStartupPhase phase);
+    ~ScopedLoaderStartupPhase();
+    ScopedLoaderStartupPhase(const ScopedLoaderStartupPhase&) = delete;
+    ScopedLoaderStartupPhase& operator=(const ScopedLoaderStartupPhase&) = delete;
+
+   private:
+    XrLoaderStartupPhase _phase;
+    bool _enabled;
+    std::chrono::steady_clock::time_point _start;
+    std::chrono::steady_clock::duration _nested_time{};
+    ScopedLoaderStartupPhase* _outer{nullptr};
+};
@@ -22,6 +22,7 @@
 #include "loader_platform.hpp"
 #include "platform_utils.hpp"
 #include "loader_logger.hpp"
+#include "loader_startup_timing.hpp"
 #include "unique_asset.h"
 
 #include <json/json.h>
@@ -32,7 +33,9 @@
 #include <cstdio>
 #include <cstring>
 #include <fstream>
+#include <iterator>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -65,6 +68,437 @@
 
 #include "runtime_interface.hpp"
 
+// Reads the parts of a manifest the loader uses straight out of the file contents, without building a document of the rest.
+//
+// Only "file_format_version" and the "runtime" and "api_layer" objects are kept from the root, and only the members of those
+// that the loader reads; everything else is skipped over without being stored.  Anything other than plain JSON, such as the
+// comments and trailing commas jsoncpp accepts, fractional numbers or nesting deeper than the manifests need, makes Parse fail,
+// and the caller is expected to parse the contents again with jsoncpp, which accepts them or reports what is wrong.
+class ManifestJsonReader {
+   public:
+    static bool Parse(const char *begin, const char *end, Json::Value &root_node) {
+        ManifestJsonReader reader(begin, end);
+        // Skip a UTF-8 byte order mark, as jsoncpp does.
+        if (end - begin >= 3 && memcmp(begin, "\xEF\xBB\xBF", 3) == 0) {
+            reader._cur += 3;
+        }
+        Json::Value parsed{Json::objectValue};
+        if (!reader.ParseObject(0, &parsed)) {
+            return false;
+        }
+        reader.SkipWhitespace();
+        if (reader._cur != reader._end) {
+            return false;
+        }
+        root_node.swap(parsed);
+        return true;
+    }
+
+   private:
+    ManifestJsonReader(const char *begin, const char *end) : _cur(begin), _end(end) {}
+
+    static constexpr int kMaxDepth = 32;
+
+    // Whether a member of an object at the given depth is kept.  Depth 0 is the root, depth 1 the "runtime" or "api_layer"
+    // object, and everything below the members kept from those is kept whole.
+    static bool KeepMember(int depth, const std::string &key) {
+        static const char *const root_keys[] = {"file_format_version", "runtime", "api_layer"};
+        static const char *const section_keys[] = {"library_path",       "name",
+                                                   "api_version",        "implementation_version",
+                                                   "description",        "disable_environment",
+                                                   "enable_environment", "instance_extensions",
+                                                   "functions"};
+        if (depth == 0) {
+            return std::find(std::begin(root_keys), std::end(root_keys), key) != std::end(root_keys);
+        }
+        if (depth == 1) {
+            return std::find(std::begin(section_keys), std::end(section_keys), key) != std::end(section_keys);
+        }
+        return true;
+    }
+
+    void SkipWhitespace() {
+        while (_cur != _end && (*_cur == ' ' || *_cur == '\t' || *_cur == '\n' || *_cur == '\r')) {
+            ++_cur;
+        }
+    }
+
+    bool Consume(char c) {
+        SkipWhitespace();
+        if (_cur == _end || *_cur != c) {
+            return false;
+        }
+        ++_cur;
+        return true;
+    }
+
+    bool ConsumeLiteral(const char *literal) {
+        size_t length = strlen(literal);
+        if (static_cast<size_t>(_end - _cur) < length || memcmp(_cur, literal, length) != 0) {
+            return false;
+        }
+        _cur += length;
+        return true;
+    }
+
+    // Parse a value, storing it in value unless it is null, in which case the value is only checked and skipped.
+    bool ParseValue(int depth, Json::Value *value) {
+        if (depth > kMaxDepth) {
+            return false;
+        }
+        SkipWhitespace();
+        if (_cur == _end) {
+            return false;
+        }
+        switch (*_cur) {
+            case '{':
+                if (value != nullptr) {
+                    *value = Json::Value{Json::objectValue};
+                }
+                return ParseObject(depth, value);
+            case '[':
+                if (value != nullptr) {
+                    *value = Json::Value{Json::arrayValue};
+                }
+                return ParseArray(depth, value);
+            case '"': {
+                std::string str;
+                if (!ParseString(value != nullptr ? &str : nullptr)) {
+                    return false;
+                }
+                if (value != nullptr) {
+                    *value = Json::Value{str};
+                }
+                return true;
+            }
+            case 't':
+                if (value != nullptr) {
+                    *value = Json::Value{true};
+                }
+                return ConsumeLiteral("true");
+            case 'f':
+                if (value != nullptr) {
+                    *value = Json::Value{false};
+                }
+                return ConsumeLiteral("false");
+            case 'n':
+                if (value != nullptr) {
+                    *value = Json::Value{Json::nullValue};
+                }
+                return ConsumeLiteral("null");
+            default:
+                return ParseInteger(value);
+        }
+    }
+
+    bool ParseObject(int depth, Json::Value *value) {
+        if (!Consume('{')) {
+            return false;
+        }
+        if (Consume('}')) {
+            return true;
+        }
+        std::string key;
+        do {
+            SkipWhitespace();
+            if (!ParseString(&key) || !Consume(':')) {
+                return false;
+            }
+            const bool keep = value != nullptr && KeepMember(depth, key);
+            if (!ParseValue(depth + 1, keep ? &(*value)[key] : nullptr)) {
+                return false;
+            }
+        } while (Consume(','));
+        return Consume('}');
+    }
+
+    bool ParseArray(int depth, Json::Value *value) {
+        if (!Consume('[')) {
+            return false;
+        }
+        if (Consume(']')) {
+            return true;
+        }
+        do {
+            Json::Value element;
+            if (!ParseValue(depth + 1, value != nullptr ? &element : nullptr)) {
+                return false;
+            }
+            if (value != nullptr) {
+                value->append(std::move(element));
+            }
+        } while (Consume(','));
+        return Consume(']');
+    }
+
+    // Parse a string, storing it in str unless that is null.  Expects _cur to be at the opening quote.
+    bool ParseString(std::string *str) {
+        if (_cur == _end || *_cur != '"') {
+            return false;
+        }
+        ++_cur;
+        if (str != nullptr) {
+            str->clear();
+        }
+        while (_cur != _end) {
+            const char c = *_cur++;
+            if (c == '"') {
+                return true;
+            }
+            if (static_cast<unsigned char>(c) < 0x20) {
+                return false;
+            }
+            if (c != '\\') {
+                if (str != nullptr) {
+                    str->push_back(c);
+                }
+                continue;
+            }
+            if (_cur == _end) {
+                return false;
+            }
+            const char escape = *_cur++;
+            char decoded;
+            switch (escape) {
+                case '"':
+                case '\\':
+                case '/':
+                    decoded = escape;
+                    break;
+                case 'b':
+                    decoded = '\b';
+                    break;
+                case 'f':
+                    decoded = '\f';
+                    break;
+                case 'n':
+                    decoded = '\n';
+                    break;
+                case 'r':
+                    decoded = '\r';
+                    break;
+                case 't':
+                    decoded = '\t';
+                    break;
+                case 'u': {
+                    uint32_t code_point = 0;
+                    if (!ParseCodePoint(code_point)) {
+                        return false;
+                    }
+                    if (str != nullptr) {
+                        AppendUtf8(code_point, *str);
+                    }
+                    continue;
+                }
+                default:
+                    return false;
+            }
+            if (str != nullptr) {
+                str->push_back(decoded);
+            }
+        }
+        return false;
+    }
+
+    bool ParseHex4(uint32_t &unit) {
+        if (_end - _cur < 4) {
+            return false;
+        }
+        unit = 0;
+        for (int i = 0; i < 4; ++i) {
+            const char c = *_cur++;
+            unit <<= 4;
+            if (c >= '0' && c <= '9') {
+                unit |= static_cast<uint32_t>(c - '0');
+            } else if (c >= 'a' && c <= 'f') {
+                unit |= static_cast<uint32_t>(c - 'a' + 10);
+            } else if (c >= 'A' && c <= 'F') {
+                unit |= static_cast<uint32_t>(c - 'A' + 10);
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Parse the digits of a \u escape, and of the low surrogate escape following it if it is a high surrogate.
+    bool ParseCodePoint(uint32_t &code_point) {
+        if (!ParseHex4(code_point)) {
+            return false;
+        }
+        if (code_point >= 0xDC00 && code_point <= 0xDFFF) {
+            return false;
+        }
+        if (code_point >= 0xD800 && code_point <= 0xDBFF) {
+            uint32_t low = 0;
+            if (!ConsumeLiteral("\\u") || !ParseHex4(low) || low < 0xDC00 || low > 0xDFFF) {
+                return false;
+            }
+            code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+        }
+        return true;
+    }
+
+    static void AppendUtf8(uint32_t code_point, std::string &str) {
+        if (code_point < 0x80) {
+            str.push_back(static_cast<char>(code_point));
+        } else if (code_point < 0x800) {
+            str.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+            str.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+        } else if (code_point < 0x10000) {
+            str.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+            str.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+            str.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+        } else {
+            str.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+            str.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+            str.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+            str.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+        }
+    }
+
+    // Only integers are used in manifests; anything else is left to jsoncpp.  Stored the way jsoncpp stores them.
+    bool ParseInteger(Json::Value *value) {
+        const bool negative = _cur != _end && *_cur == '-';
+        if (negative) {
+            ++_cur;
+        }
+        if (_cur == _end || *_cur < '0' || *_cur > '9') {
+            return false;
+        }
+        uint64_t magnitude = 0;
+        while (_cur != _end && *_cur >= '0' && *_cur <= '9') {
+            const uint64_t digit = static_cast<uint64_t>(*_cur++ - '0');
+            if (magnitude > (UINT64_MAX - digit) / 10) {
+                return false;
+            }
+            magnitude = magnitude * 10 + digit;
+        }
+        if (_cur != _end && (*_cur == '.' || *_cur == 'e' || *_cur == 'E')) {
+            return false;
+        }
+        const uint64_t max_int = static_cast<uint64_t>(Json::Value::maxLargestInt);
+        if (magnitude > max_int) {
+            return false;
+        }
+        if (value != nullptr) {
+            const Json::LargestInt signed_value = static_cast<Json::LargestInt>(magnitude);
+            *value = Json::Value{negative ? -signed_value : signed_value};
+        }
+        return true;
+    }
+
+    const char *_cur;
+    const char *_end;
+};
+
+// Parse manifest contents, with jsoncpp if ManifestJsonReader does not take them, which also gives the errors if they are not
+// valid JSON.  Fails if they are not a JSON object.
+static bool ParseManifestJson(const std::string &contents, Json::Value &root_node, std::string &errors) {
+    const char *begin = contents.data();
+    const char *end = begin + contents.size();
+    if (ManifestJsonReader::Parse(begin, end, root_node)) {
+        return true;
+    }
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    return reader->parse(begin, end, &root_node, &errors) && root_node.isObject();
+}
+
+// Cache of manifest directory listings and parsed manifest files.
+//
+// Every xrEnumerateApiLayerProperties, xrEnumerateInstanceExtensionProperties and xrCreateInstance call searches for and parses
+// the manifest files again.  Listings and parse results are kept for the life of the process and reused as long as the last
+// write time of the directory or file is unchanged, so manifests that are added, removed or edited are still picked up.  Everything
+// that depends on the environment (the search paths themselves, layer enable/disable variables, library locations) is still
+// evaluated by the caller on every use.
+class ManifestCache {
+   public:
+    enum class ReadResult { Success, OpenFailed, ParseFailed };
+
+    static ManifestCache &Instance() {
+        static ManifestCache cache;
+        return cache;
+    }
+
+    bool FindFilesInPath(const std::string &directory, std::vector<std::string> &files) {
+        uint64_t write_time = 0;
+        const bool have_write_time = FileSysUtilsGetLastWriteTime(directory, write_time);
+        if (have_write_time) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            auto it = _directories.find(directory);
+            if (it != _directories.end() && it->second.write_time == write_time) {
+                files.insert(files.end(), it->second.files.begin(), it->second.files.end());
+                return true;
+            }
+        }
+
+        std::vector<std::string> found_files;
+        if (!FileSysUtilsFindFilesInPath(directory, found_files)) {
+            return false;
+        }
+        files.insert(files.end(), found_files.begin(), found_files.end());
+        if (have_write_time) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _directories[directory] = DirectoryEntry{write_time, std::move(found_files)};
+        }
+        return true;
+    }
+
+    // Only successful parses are cached, so a broken manifest keeps reporting its errors.
+    ReadResult ReadJsonFile(const std::string &filename, std::shared_ptr<const Json::Value> &root_node, std::string &errors) {
+        ScopedLoaderStartupPhase phase(XR_LOADER_STARTUP_PHASE_MANIFEST_PARSE);
+        uint64_t write_time = 0;
+        const bool have_write_time = FileSysUtilsGetLastWriteTime(filename, write_time);
+        if (have_write_time) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            auto it = _files.find(filename);
+            if (it != _files.end() && it->second.write_time == write_time) {
+                root_node = it->second.root_node;
+                return ReadResult::Success;
+            }
+        }
+
+        // Read the whole file with one read, rather than through the stream a character at a time.
+        std::ifstream json_stream(filename, std::ifstream::in | std::ifstream::binary | std::ifstream::ate);
+        if (!json_stream.is_open()) {
+            return ReadResult::OpenFailed;
+        }
+        std::string contents;
+        const std::streamoff size = json_stream.tellg();
+        if (size > 0) {
+            contents.resize(static_cast<size_t>(size));
+            json_stream.seekg(0);
+            json_stream.read(&contents[0], size);
+            contents.resize(static_cast<size_t>(json_stream.gcount()));
+        }
+        std::shared_ptr<Json::Value> parsed = std::make_shared<Json::Value>(Json::nullValue);
+        if (!ParseManifestJson(contents, *parsed, errors)) {
+            return ReadResult::ParseFailed;
+        }
+        root_node = parsed;
+        if (have_write_time) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _files[filename] = FileEntry{write_time, root_node};
+        }
+        return ReadResult::Success;
+    }
+
+   private:
+    struct DirectoryEntry {
+        uint64_t write_time;
+        std::vector<std::string> files;
+    };
+    struct FileEntry {
+        uint64_t write_time;
+        std::shared_ptr<const Json::Value> root_node;
+    };
+
+    std::mutex _mutex;
+    std::unordered_map<std::string, DirectoryEntry> _directories;
+    std::unordered_map<std::string, FileEntry> _files;
+};
+
 // Utility functions for finding files in the appropriate paths
 
 static inline bool StringEndsWith(const std::string &value, const std::string &ending) {
@@ -98,7 +532,7 @@ static void CheckAllFilesInThePath(const std::string &search_path, bool is_direc
             }
         } else {
             std::vector<std::string> files;
-            if (FileSysUtilsFindFilesInPath(search_path, files)) {
+            if (ManifestCache::Instance().FindFilesInPath(search_path, files)) {
                 for (std::string &cur_file : files) {
                     std::string relative_path;
                     FileSysUtilsCombinePaths(search_path, cur_file, relative_path);
@@ -279,7 +713,7 @@ static std::string GetXDGEnvAbsolute(const char *name, const char *fallback_path
 /// @param rt_dir_prefix Directory prefix with a trailing slash
 static bool FindEitherActiveRuntimeFilename(const char *prefix_desc, const std::string &rt_dir_prefix, uint16_t major_version,
                                             std::string &out) {
-    {
+    if (LoaderLogger::IsEnabled(XR_LOADER_LOG_MESSAGE_SEVERITY_INFO_BIT)) {
         std::ostringstream oss;
         oss << "Looking for active_runtime." XR_ARCH_ABI ".json or active_runtime.json in ";
         oss << prefix_desc;
@@ -490,17 +924,23 @@ bool ManifestFile::IsValidJson(const Json::Value &root_node, JsonVersion &versio
 }
 
 static void GetExtensionProperties(const std::vector<ExtensionListing> &extensions, std::vector<XrExtensionProperties> &props) {
+    std::unordered_map<std::string, size_t> prop_index;
+    prop_index.reserve(props.size() + extensions.size());
+    for (size_t prop = 0; prop < props.size(); ++prop) {
+        prop_index.emplace(props[prop].extensionName, prop);
+    }
     for (const auto &ext : extensions) {
-        auto it =
-            std::find_if(props.begin(), props.end(), [&](XrExtensionProperties &prop) { return prop.extensionName == ext.name; });
-        if (it != props.end()) {
-            it->extensionVersion = std::max(it->extensionVersion, ext.extension_version);
+        auto it = prop_index.find(ext.name);
+        if (it != prop_index.end()) {
+            XrExtensionProperties &prop = props[it->second];
+            prop.extensionVersion = std::max(prop.extensionVersion, ext.extension_version);
         } else {
             XrExtensionProperties prop{};
             prop.type = XR_TYPE_EXTENSION_PROPERTIES;
             strncpy(prop.extensionName, ext.name.c_str(), XR_MAX_EXTENSION_NAME_SIZE - 1);
             prop.extensionName[XR_MAX_EXTENSION_NAME_SIZE - 1] = '\0';
             prop.extensionVersion = ext.extension_version;
+            prop_index.emplace(prop.extensionName, props.size());
             props.push_back(prop);
         }
     }
@@ -568,29 +1008,30 @@ void ManifestFile::ParseCommon(Json::Value const &root_node) {
 
 void RuntimeManifestFile::CreateIfValid(std::string const &filename,
                                         std::vector<std::unique_ptr<RuntimeManifestFile>> &manifest_files) {
-    std::ifstream json_stream(filename, std::ifstream::in);
-
-    LoaderLogger::LogInfoMessage("", "RuntimeManifestFile::CreateIfValid - attempting to load " + filename);
-    std::ostringstream error_ss("RuntimeManifestFile::CreateIfValid ");
-    if (!json_stream.is_open()) {
-        error_ss << "failed to open " << filename << ".  Does it exist?";
-        LoaderLogger::LogErrorMessage("", error_ss.str());
-        return;
+    if (LoaderLogger::IsEnabled(XR_LOADER_LOG_MESSAGE_SEVERITY_INFO_BIT)) {
+        LoaderLogger::LogInfoMessage("", "RuntimeManifestFile::CreateIfValid - attempting to load " + filename);
     }
-    Json::CharReaderBuilder builder;
+    std::ostringstream error_ss("RuntimeManifestFile::CreateIfValid ");
     std::string errors;
-    Json::Value root_node = Json::nullValue;
-    if (!Json::parseFromStream(builder, json_stream, &root_node, &errors) || !root_node.isObject()) {
-        error_ss << "failed to parse " << filename << ".";
-        if (!errors.empty()) {
-            error_ss << " (Error message: " << errors << ")";
-        }
-        error_ss << " Is it a valid runtime manifest file?";
-        LoaderLogger::LogErrorMessage("", error_ss.str());
-        return;
+    std::shared_ptr<const Json::Value> root_node;
+    switch (ManifestCache::Instance().ReadJsonFile(filename, root_node, errors)) {
+        case ManifestCache::ReadResult::OpenFailed:
+            error_ss << "failed to open " << filename << ".  Does it exist?";
+            LoaderLogger::LogErrorMessage("", error_ss.str());
+            return;
+        case ManifestCache::ReadResult::ParseFailed:
+            error_ss << "failed to parse " << filename << ".";
+            if (!errors.empty()) {
+                error_ss << " (Error message: " << errors << ")";
+            }
+            error_ss << " Is it a valid runtime manifest file?";
+            LoaderLogger::LogErrorMessage("", error_ss.str());
+            return;
+        case ManifestCache::ReadResult::Success:
+            break;
     }
 
-    CreateIfValid(root_node, filename, manifest_files);
+    CreateIfValid(*root_node, filename, manifest_files);
 }
 
 void RuntimeManifestFile::CreateIfValid(const Json::Value &root_node, const std::string &filename,
@@ -648,6 +1089,7 @@ void RuntimeManifestFile::CreateIfValid(const Json::Value &root_node, const std:
 // Find all manifest files in the appropriate search paths/registries for the given type.
 XrResult RuntimeManifestFile::FindManifestFiles(const std::string &openxr_command,
                                                 std::vector<std::unique_ptr<RuntimeManifestFile>> &manifest_files) {
+    ScopedLoaderStartupPhase phase(XR_LOADER_STARTUP_PHASE_MANIFEST_SEARCH);
     XrResult result = XR_SUCCESS;
     std::string filename = PlatformUtilsGetSecureEnv(OPENXR_RUNTIME_JSON_ENV_VAR);
     if (!filename.empty()) {
@@ -781,19 +1223,30 @@ void ApiLayerManifestFile::AddManifestFilesAndroid(const std::string &openxr_com
 void ApiLayerManifestFile::CreateIfValid(ManifestFileType type, const std::string &filename, std::istream &json_stream,
                                          LibraryLocator locate_library,
                                          std::vector<std::unique_ptr<ApiLayerManifestFile>> &manifest_files) {
-    std::ostringstream error_ss("ApiLayerManifestFile::CreateIfValid ");
-    Json::CharReaderBuilder builder;
+    const std::string contents{std::istreambuf_iterator<char>(json_stream), std::istreambuf_iterator<char>()};
     std::string errors;
     Json::Value root_node = Json::nullValue;
-    if (!Json::parseFromStream(builder, json_stream, &root_node, &errors) || !root_node.isObject()) {
-        error_ss << "failed to parse " << filename << ".";
-        if (!errors.empty()) {
-            error_ss << " (Error message: " << errors << ")";
-        }
-        error_ss << " Is it a valid layer manifest file?";
-        LoaderLogger::LogErrorMessage("", error_ss.str());
+    if (!ParseManifestJson(contents, root_node, errors)) {
+        LogLayerParseError(filename, errors);
         return;
     }
+    CreateIfValid(type, filename, root_node, locate_library, manifest_files);
+}
+
+void ApiLayerManifestFile::LogLayerParseError(const std::string &filename, const std::string &errors) {
+    std::ostringstream error_ss("ApiLayerManifestFile::CreateIfValid ");
+    error_ss << "failed to parse " << filename << ".";
+    if (!errors.empty()) {
+        error_ss << " (Error message: " << errors << ")";
+    }
+    error_ss << " Is it a valid layer manifest file?";
+    LoaderLogger::LogErrorMessage("", error_ss.str());
+}
+
+void ApiLayerManifestFile::CreateIfValid(ManifestFileType type, const std::string &filename, const Json::Value &root_node,
+                                         LibraryLocator locate_library,
+                                         std::vector<std::unique_ptr<ApiLayerManifestFile>> &manifest_files) {
+    std::ostringstream error_ss("ApiLayerManifestFile::CreateIfValid ");
     JsonVersion file_version = {};
     if (!ManifestFile::IsValidJson(root_node, file_version)) {
         error_ss << "isValidJson indicates " << filename << " is not a valid manifest file.";
@@ -801,7 +1254,7 @@ void ApiLayerManifestFile::CreateIfValid(ManifestFileType type, const std::strin
         return;
     }
 
-    Json::Value layer_root_node = root_node["api_layer"];
+    const Json::Value &layer_root_node = root_node["api_layer"];
 
     // The API Layer manifest file needs the "api_layer" root as well as other sub-nodes.
     // If any of those aren't there, fail.
@@ -838,8 +1291,10 @@ void ApiLayerManifestFile::CreateIfValid(ManifestFileType type, const std::strin
 
         // Not enabled, so pretend like it isn't even there.
         if (!enabled) {
-            error_ss << "Implicit layer " << filename << " is disabled";
-            LoaderLogger::LogInfoMessage("", error_ss.str());
+            if (LoaderLogger::IsEnabled(XR_LOADER_LOG_MESSAGE_SEVERITY_INFO_BIT)) {
+                error_ss << "Implicit layer " << filename << " is disabled";
+                LoaderLogger::LogInfoMessage("", error_ss.str());
+            }
             return;
         }
     }
@@ -896,14 +1351,22 @@ void ApiLayerManifestFile::CreateIfValid(ManifestFileType type, const std::strin
 
 void ApiLayerManifestFile::CreateIfValid(ManifestFileType type, const std::string &filename,
                                          std::vector<std::unique_ptr<ApiLayerManifestFile>> &manifest_files) {
-    std::ifstream json_stream(filename, std::ifstream::in);
-    if (!json_stream.is_open()) {
-        std::ostringstream error_ss("ApiLayerManifestFile::CreateIfValid ");
-        error_ss << "failed to open " << filename << ".  Does it exist?";
-        LoaderLogger::LogErrorMessage("", error_ss.str());
-        return;
+    std::string errors;
+    std::shared_ptr<const Json::Value> root_node;
+    switch (ManifestCache::Instance().ReadJsonFile(filename, root_node, errors)) {
+        case ManifestCache::ReadResult::OpenFailed: {
+            std::ostringstream error_ss("ApiLayerManifestFile::CreateIfValid ");
+            error_ss << "failed to open " << filename << ".  Does it exist?";
+            LoaderLogger::LogErrorMessage("", error_ss.str());
+            return;
+        }
+        case ManifestCache::ReadResult::ParseFailed:
+            LogLayerParseError(filename, errors);
+            return;
+        case ManifestCache::ReadResult::Success:
+            break;
     }
-    CreateIfValid(type, filename, json_stream, &ApiLayerManifestFile::LocateLibraryRelativeToJson, manifest_files);
+    CreateIfValid(type, filename, *root_node, &ApiLayerManifestFile::LocateLibraryRelativeToJson, manifest_files);
 }
 
 bool ApiLayerManifestFile::LocateLibraryRelativeToJson(
@@ -950,6 +1413,7 @@ void ApiLayerManifestFile::PopulateApiLayerProperties(XrApiLayerProperties &prop
 // Find all layer manifest files in the appropriate search paths/registries for the given type.
 XrResult ApiLayerManifestFile::FindManifestFiles(const std::string &openxr_command, ManifestFileType type,
                                                  std::vector<std::unique_ptr<ApiLayerManifestFile>> &manifest_files) {
+    ScopedLoaderStartupPhase phase(XR_LOADER_STARTUP_PHASE_MANIFEST_SEARCH);
     std::string relative_path;
     std::string override_env_var;
     std::string registry_location;
@@ -101,8 +101,11 @@ class ApiLayerManifestFile : public ManifestFile {
 
     static void CreateIfValid(ManifestFileType type, const std::string &filename, std::istream &json_stream,
                               LibraryLocator locate_library, std::vector<std::unique_ptr<ApiLayerManifestFile>> &manifest_files);
+    static void CreateIfValid(ManifestFileType type, const std::string &filename, const Json::Value &root_node,
+                              LibraryLocator locate_library, std::vector<std::unique_ptr<ApiLayerManifestFile>> &manifest_files);
     static void CreateIfValid(ManifestFileType type, const std::string &filename,
                               std::vector<std::unique_ptr<ApiLayerManifestFile>> &manifest_files);
+    static void LogLayerParseError(const std::string &filename, const std::string &errors);
     /// @return false if we could not find the library.
     static bool LocateLibraryRelativeToJson(const std::string &json_filename, const std::string &library_path,
                                             std::string &out_combined_path);
@@ -16,6 +16,7 @@
 #include "loader_init_data.hpp"
 #include "loader_logger.hpp"
 #include "loader_platform.hpp"
+#include "loader_startup_timing.hpp"
 #include "xr_generated_dispatch_table_core.h"
 
 #include <cstring>
@@ -56,9 +57,16 @@ XrResult GetPlatformRuntimeVirtualManifest(Json::Value& out_manifest) {
 
 XrResult RuntimeInterface::TryLoadingSingleRuntime(const std::string& openxr_command,
                                                    std::unique_ptr<RuntimeManifestFile>& manifest_file) {
-    LoaderPlatformLibraryHandle runtime_library = LoaderPlatformLibraryOpen(manifest_file->LibraryPath());
+    LoaderPlatformLibraryHandle runtime_library;
+    std::string library_message;
+    {
+        ScopedLoaderStartupPhase phase(XR_LOADER_STARTUP_PHASE_LIBRARY_LOAD);
+        runtime_library = LoaderPlatformLibraryOpen(manifest_file->LibraryPath());
+        if (nullptr == runtime_library) {
+            library_message = LoaderPlatformLibraryOpenError(manifest_file->LibraryPath());
+        }
+    }
     if (nullptr == runtime_library) {
-        std::string library_message = LoaderPlatformLibraryOpenError(manifest_file->LibraryPath());
         std::string warning_message = "RuntimeInterface::LoadRuntime skipping manifest file ";
         warning_message += manifest_file->Filename();
         warning_message += ", failed to load with message \"";
@@ -125,6 +133,7 @@ XrResult RuntimeInterface::TryLoadingSingleRuntime(const std::string& openxr_com
     // could not get loaded
     XrResult res = XR_ERROR_RUNTIME_FAILURE;
     if (nullptr != negotiate) {
+        ScopedLoaderStartupPhase phase(XR_LOADER_STARTUP_PHASE_RUNTIME_NEGOTIATION);
         res = negotiate(&loader_info, &runtime_info);
     } else {
         std::string error_message = "RuntimeInterface::LoadRuntime failed to find negotiate function ";
@@ -275,6 +284,14 @@ XrResult RuntimeInterface::GetInstanceProcAddr(XrInstance instance, const char*
 }
 
 const XrGeneratedDispatchTableCore* RuntimeInterface::GetDispatchTable(XrInstance instance) {
+    RuntimeInterface& runtime = *GetInstance();
+    if (instance != XR_NULL_HANDLE && runtime._last_instance.load(std::memory_order_acquire) == instance) {
+        XrGeneratedDispatchTableCore* table = runtime._last_dispatch_table.load(std::memory_order_acquire);
+        if (table != nullptr) {
+            return table;
+        }
+    }
+
     XrGeneratedDispatchTableCore* table = nullptr;
     std::lock_guard<std::mutex> mlock(GetInstance()->_dispatch_table_mutex);
     auto it = GetInstance()->_dispatch_table_map.find(instance);
@@ -325,22 +342,19 @@ void RuntimeInterface::GetInstanceExtensionProperties(std::vector<XrExtensionPro
         count = count_output;
         rt_xrEnumerateInstanceExtensionProperties(nullptr, count, &count_output, runtime_extension_properties.data());
     }
-    size_t ext_count = runtime_extension_properties.size();
-    size_t props_count = extension_properties.size();
-    for (size_t ext = 0; ext < ext_count; ++ext) {
-        bool found = false;
-        for (size_t prop = 0; prop < props_count; ++prop) {
-            // If we find it, then make sure the spec version matches that of the runtime instead of the
-            // layer.
-            if (strcmp(extension_properties[prop].extensionName, runtime_extension_properties[ext].extensionName) == 0) {
-                // Make sure the spec version used is the runtime's
-                extension_properties[prop].extensionVersion = runtime_extension_properties[ext].extensionVersion;
-                found = true;
-                break;
-            }
-        }
-        if (!found) {
-            extension_properties.push_back(runtime_extension_properties[ext]);
+    std::unordered_map<std::string, size_t> prop_index;
+    prop_index.reserve(extension_properties.size() + runtime_extension_properties.size());
+    for (size_t prop = 0; prop < extension_properties.size(); ++prop) {
+        prop_index.emplace(extension_properties[prop].extensionName, prop);
+    }
+    for (const XrExtensionProperties& runtime_prop : runtime_extension_properties) {
+        auto found = prop_index.find(runtime_prop.extensionName);
+        if (found != prop_index.end()) {
+            // If we find it, then make sure the spec version used is the runtime's instead of the layer's.
+            extension_properties[found->second].extensionVersion = runtime_prop.extensionVersion;
+        } else {
+            prop_index.emplace(runtime_prop.extensionName, extension_properties.size());
+            extension_properties.push_back(runtime_prop);
         }
     }
 }
@@ -356,6 +370,9 @@ XrResult RuntimeInterface::CreateInstance(const XrInstanceCreateInfo* info, XrIn
         std::unique_ptr<XrGeneratedDispatchTableCore> dispatch_table(new XrGeneratedDispatchTableCore());
         GeneratedXrPopulateDispatchTableCore(dispatch_table.get(), *instance, _get_instance_proc_addr);
         std::lock_guard<std::mutex> mlock(_dispatch_table_mutex);
+        // Publish the table before the handle, so that a reader matching the handle finds the table.
+        _last_dispatch_table.store(dispatch_table.get(), std::memory_order_release);
+        _last_instance.store(*instance, std::memory_order_release);
         _dispatch_table_map[*instance] = std::move(dispatch_table);
     }
 
@@ -375,6 +392,10 @@ XrResult RuntimeInterface::DestroyInstance(XrInstance instance) {
         // Destroy the dispatch table for this instance first
         {
             std::lock_guard<std::mutex> mlock(_dispatch_table_mutex);
+            if (_last_instance.load(std::memory_order_relaxed) == instance) {
+                _last_instance.store(XR_NULL_HANDLE, std::memory_order_release);
+                _last_dispatch_table.store(nullptr, std::memory_order_release);
+            }
             auto map_iter = _dispatch_table_map.find(instance);
             if (map_iter != _dispatch_table_map.end()) {
                 _dispatch_table_map.erase(map_iter);
@@ -13,6 +13,7 @@
 
 #include <openxr/openxr.h>
 
+#include <atomic>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -68,6 +69,10 @@ class RuntimeInterface {
     PFN_xrGetInstanceProcAddr _get_instance_proc_addr;
     std::unordered_map<XrInstance, std::unique_ptr<XrGeneratedDispatchTableCore>> _dispatch_table_map;
     std::mutex _dispatch_table_mutex;
+    // The last instance created and its dispatch table, which GetDispatchTable returns without taking _dispatch_table_mutex.
+    // The loader only has one instance at a time, so this is the only entry of _dispatch_table_map whenever it is set.
+    std::atomic<XrInstance> _last_instance{XR_NULL_HANDLE};
+    std::atomic<XrGeneratedDispatchTableCore*> _last_dispatch_table{nullptr};
     std::unordered_map<XrDebugUtilsMessengerEXT, XrInstance> _messenger_to_instance_map;
     std::mutex _messenger_to_instance_mutex;
     std::vector<std::string> _supported_extensions;
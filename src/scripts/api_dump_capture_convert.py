@@ -0,0 +1,351 @@
+#!/usr/bin/python3
+#
+# Copyright (c) 2017-2024, The Khronos Group Inc.
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Convert a binary capture of the api_dump layer into text or Chrome trace JSON.
+
+The api_dump layer writes a capture when the XR_API_DUMP_BINARY_FILE_NAME
+environment variable is set. The file layout and the value tags are described
+with ApiDumpBinaryTag in the generated xr_generated_api_dump.cpp."""
+
+import argparse
+import json
+import struct
+import sys
+from dataclasses import dataclass
+from typing import List, Optional, Tuple
+
+CAPTURE_MAGIC = b'XRDUMPB2'
+BYTE_ORDER_MARK = 0x01020304
+
+TAG_NULL = 0
+TAG_INT32 = 1
+TAG_UINT32 = 2
+TAG_INT64 = 3
+TAG_UINT64 = 4
+TAG_FLOAT = 5
+TAG_DOUBLE = 6
+TAG_ENUM = 7
+TAG_FLAGS = 8
+TAG_HANDLE = 9
+TAG_STRING = 10
+TAG_POINTER = 11
+TAG_STRUCT = 12
+TAG_ARRAY = 13
+TAG_BYTES = 14
+TAG_UNKNOWN_STRUCT = 15
+
+# Tags of plain numbers, and their struct formats
+NUMBER_FORMATS = {
+    TAG_INT32: 'i',
+    TAG_UINT32: 'I',
+    TAG_INT64: 'q',
+    TAG_UINT64: 'Q',
+    TAG_FLOAT: 'f',
+    TAG_DOUBLE: 'd',
+}
+
+
+@dataclass
+class EnumValue:
+    enum: str
+    value: int
+    name: Optional[str]
+
+    def __str__(self):
+        if self.name is None:
+            return f'{self.value} ({self.enum})'
+        return f'{self.name} ({self.value})'
+
+
+@dataclass
+class Flags:
+    value: int
+
+    def __str__(self):
+        return f'0x{self.value:x}'
+
+
+@dataclass
+class Handle:
+    value: int
+
+    def __str__(self):
+        return f'0x{self.value:016x}'
+
+
+@dataclass
+class Pointer:
+    address: int
+
+    def __str__(self):
+        return f'0x{self.address:x} (not copied)'
+
+
+@dataclass
+class StructValue:
+    name: str
+    members: List[Tuple[str, object]]
+
+
+@dataclass
+class ArrayValue:
+    count: int
+    elements: list
+
+
+@dataclass
+class BytesValue:
+    size: int
+    data: bytes
+
+
+@dataclass
+class UnknownStruct:
+    type: EnumValue
+    next: object
+
+
+@dataclass
+class Record:
+    command: str
+    thread: int
+    begin: int
+    end: int
+    result: EnumValue
+    params: List[Tuple[str, object]]
+
+
+class CaptureReader:
+    """Reads the header and records of a capture."""
+
+    def __init__(self, data):
+        self.data = data
+        self.offset = 0
+        try:
+            self.readHeader()
+        except EOFError:
+            raise ValueError('capture ends inside its header') from None
+
+    def readHeader(self):
+        if self.read(len(CAPTURE_MAGIC)) != CAPTURE_MAGIC:
+            raise ValueError('not an api_dump binary capture')
+        self.order = '<'
+        (mark,) = self.unpack('I')
+        if mark != BYTE_ORDER_MARK:
+            self.order = '>'
+        self.commands = self.readNameGroups()
+        self.structs = self.readNameGroups()
+        self.enums = []
+        for _ in range(self.unpack('I')[0]):
+            enum_name = self.readName()
+            values = {}
+            for _ in range(self.unpack('I')[0]):
+                (value,) = self.unpack('i')
+                values[value] = self.readName()
+            self.enums.append((enum_name, values))
+        self.result_enum = next((index for index, (name, _) in enumerate(self.enums) if name == 'XrResult'), None)
+        self.structure_type_enum = next((index for index, (name, _) in enumerate(self.enums)
+                                         if name == 'XrStructureType'), None)
+
+    def read(self, size):
+        if self.offset + size > len(self.data):
+            raise EOFError
+        value = self.data[self.offset:self.offset + size]
+        self.offset += size
+        return value
+
+    def unpack(self, fmt):
+        layout = struct.Struct(self.order + fmt)
+        return layout.unpack(self.read(layout.size))
+
+    def readName(self):
+        end = self.data.find(b'\0', self.offset)
+        if end < 0:
+            raise EOFError
+        name = self.data[self.offset:end].decode('utf-8', 'replace')
+        self.offset = end + 1
+        return name
+
+    def readNameGroups(self):
+        groups = []
+        for _ in range(self.unpack('I')[0]):
+            name = self.readName()
+            groups.append((name, [self.readName() for _ in range(self.unpack('I')[0])]))
+        return groups
+
+    def enumValue(self, enum_index, value):
+        if enum_index is None or enum_index >= len(self.enums):
+            return EnumValue(f'enum {enum_index}', value, None)
+        enum_name, values = self.enums[enum_index]
+        return EnumValue(enum_name, value, values.get(value))
+
+    def readValue(self):
+        (tag,) = self.unpack('B')
+        if tag == TAG_NULL:
+            return None
+        if tag in NUMBER_FORMATS:
+            return self.unpack(NUMBER_FORMATS[tag])[0]
+        if tag == TAG_ENUM:
+            enum_index, value = self.unpack('Hi')
+            return self.enumValue(enum_index, value)
+        if tag == TAG_FLAGS:
+            return Flags(self.unpack('Q')[0])
+        if tag == TAG_HANDLE:
+            return Handle(self.unpack('Q')[0])
+        if tag == TAG_STRING:
+            (size,) = self.unpack('I')
+            return self.read(size).decode('utf-8', 'replace')
+        if tag == TAG_POINTER:
+            return Pointer(self.unpack('Q')[0])
+        if tag == TAG_STRUCT:
+            (struct_index,) = self.unpack('H')
+            name, members = self.structs[struct_index]
+            return StructValue(name, [(member, self.readValue()) for member in members])
+        if tag == TAG_ARRAY:
+            count, recorded = self.unpack('II')
+            return ArrayValue(count, [self.readValue() for _ in range(recorded)])
+        if tag == TAG_BYTES:
+            size, recorded = self.unpack('II')
+            return BytesValue(size, self.read(recorded))
+        if tag == TAG_UNKNOWN_STRUCT:
+            (type_value,) = self.unpack('i')
+            return UnknownStruct(self.enumValue(self.structure_type_enum, type_value), self.readValue())
+        raise ValueError(f'unknown value tag {tag} at offset {self.offset - 1}')
+
+    def readRecords(self):
+        while self.offset < len(self.data):
+            start = self.offset
+            try:
+                command, thread, begin, end, result, size = self.unpack('IIqqiI')
+                params_end = self.offset + size
+                if params_end > len(self.data):
+                    raise EOFError
+                if command < len(self.commands):
+                    name, param_names = self.commands[command]
+                    params = [(param_name, self.readValue()) for param_name in param_names]
+                else:
+                    name, params = f'<unknown command {command}>', []
+                self.offset = params_end
+            except EOFError:
+                sys.stderr.write(f'warning: capture ends in a partial record at offset {start}\n')
+                return
+            yield Record(name, thread, begin, end, self.enumValue(self.result_enum, result), params)
+
+    def records(self):
+        """Each thread's records are written in batches, so sort them back into the order the calls began."""
+        return sorted(self.readRecords(), key=lambda record: record.begin)
+
+
+def writeTextValue(out, name, value, indent):
+    prefix = '    ' * indent + f'{name} = '
+    if isinstance(value, StructValue):
+        out.write(f'{prefix}{value.name}\n')
+        for member_name, member_value in value.members:
+            writeTextValue(out, member_name, member_value, indent + 1)
+    elif isinstance(value, UnknownStruct):
+        out.write(f'{prefix}unknown structure {value.type}\n')
+        writeTextValue(out, 'next', value.next, indent + 1)
+    elif isinstance(value, ArrayValue):
+        omitted = value.count - len(value.elements)
+        out.write(prefix + f'array of {value.count}' + (f', last {omitted} not copied\n' if omitted else '\n'))
+        for index, element in enumerate(value.elements):
+            writeTextValue(out, f'[{index}]', element, indent + 1)
+    elif isinstance(value, BytesValue):
+        omitted = f', last {value.size - len(value.data)} not copied' if value.size > len(value.data) else ''
+        out.write(f'{prefix}{value.size} bytes{omitted}: {value.data.hex()}\n')
+    elif value is None:
+        out.write(f'{prefix}nullptr\n')
+    elif isinstance(value, str):
+        out.write(f'{prefix}"{value}"\n')
+    else:
+        out.write(f'{prefix}{value}\n')
+
+
+def writeText(reader, out):
+    for record in reader.records():
+        out.write(f'Thread {record.thread}, {record.begin / 1e6:.6f} ms, took {(record.end - record.begin) / 1e3:.3f} us: '
+                  f'{record.command} returned {record.result}\n')
+        for name, value in record.params:
+            writeTextValue(out, name, value, 1)
+        out.write('\n')
+
+
+def toJson(value):
+    if isinstance(value, StructValue):
+        return {'$type': value.name, **{name: toJson(member) for name, member in value.members}}
+    if isinstance(value, UnknownStruct):
+        return {'$type': str(value.type), 'next': toJson(value.next)}
+    if isinstance(value, ArrayValue):
+        return [toJson(element) for element in value.elements]
+    if isinstance(value, BytesValue):
+        return value.data.hex()
+    if isinstance(value, EnumValue):
+        return value.name if value.name is not None else value.value
+    if isinstance(value, (Flags, Handle, Pointer)):
+        return str(value)
+    return value
+
+
+def writeChromeTrace(reader, out, with_args):
+    events = []
+    for record in reader.records():
+        event = {
+            'name': record.command,
+            'cat': 'openxr',
+            'ph': 'X',
+            'ts': record.begin / 1000.0,
+            'dur': (record.end - record.begin) / 1000.0,
+            'pid': 0,
+            'tid': record.thread,
+            'args': {'result': toJson(record.result)},
+        }
+        if with_args:
+            event['args'].update({name: toJson(value) for name, value in record.params})
+        events.append(event)
+    json.dump({'traceEvents': events, 'displayTimeUnit': 'ns'}, out)
+    out.write('\n')
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('capture', help='binary capture written by the api_dump layer')
+    parser.add_argument('-o', '--output', help='output file (default: stdout)')
+    parser.add_argument('--chrome-trace', action='store_true',
+                        help='write Chrome trace JSON (chrome://tracing, Perfetto) instead of text')
+    parser.add_argument('--no-args', action='store_true',
+                        help='leave the parameters out of the Chrome trace, keeping only each call\'s result')
+    args = parser.parse_args(argv)
+
+    with open(args.capture, 'rb') as capture_file:
+        try:
+            reader = CaptureReader(capture_file.read())
+        except ValueError as error:
+            sys.exit(f'{args.capture}: {error}')
+
+    out = open(args.output, 'w', encoding='utf-8') if args.output else sys.stdout
+    try:
+        if args.chrome_trace:
+            writeChromeTrace(reader, out, not args.no_args)
+        else:
+            writeText(reader, out)
+    finally:
+        if out is not sys.stdout:
+            out.close()
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
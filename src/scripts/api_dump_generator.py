@@ -48,6 +48,455 @@ LOADER_STRUCTS = [
     'XrNegotiateApiLayerRequest',
 ]
 
+# Standard C types that binary capture records through ApiDumpBinaryWriter::Scalar
+BINARY_CAPTURE_SCALAR_TYPES = set((
+    'char', 'wchar_t', 'float', 'double', 'size_t',
+    'int8_t', 'uint8_t', 'int16_t', 'uint16_t', 'int32_t', 'uint32_t', 'int64_t', 'uint64_t',
+))
+
+# Plain data types from other APIs that binary capture copies as bytes when it is given a pointer to one
+BINARY_CAPTURE_COPYABLE_EXTERNAL_TYPES = set((
+    'LARGE_INTEGER',
+    'LUID',
+    'timespec',
+))
+
+# Enums declared by openxr_loader_negotiation.h, which the api_dump layer does not include
+LOADER_ENUMS = [
+    'XrLoaderInterfaceStructs',
+]
+
+# The part of the binary capture code used by the generated serializers.  The tags and the capture file layout are
+# read back by scripts/api_dump_capture_convert.py, so keep the two in sync.
+BINARY_CAPTURE_WRITER = '''
+// ---- Api Dump binary capture
+//
+// When the XR_API_DUMP_BINARY_FILE_NAME environment variable is set, the generated commands skip the text output.
+// Once the call returns, they copy its parameters, following pointers, arrays and next chains, into a record in a
+// buffer of the calling thread.  A background thread writes the buffers to the file, so that the application's
+// timing is disturbed as little as possible.  scripts/api_dump_capture_convert.py turns a capture into text or
+// Chrome trace JSON.
+//
+// A capture starts with the 8 bytes "XRDUMPB2", the uint32_t 0x01020304 to show the byte order of the capturing
+// machine, and three tables naming what the records refer to by index:
+//   - uint32_t command count, then for each command its name, uint32_t parameter count and parameter names
+//   - uint32_t structure count, then for each structure its name, uint32_t member count and member names
+//   - uint32_t enum count, then for each enum its name, uint32_t value count and for each value an int32_t and its name
+// Names are terminated by a 0 byte.  Records follow, each an ApiDumpBinaryRecordHeader and one tagged value per
+// parameter.  Outputs are copied when the call returned XR_SUCCESS, and recorded as addresses otherwise, since
+// qualified successes such as XR_EVENT_UNAVAILABLE leave them unwritten.
+
+namespace {
+
+// Each recorded value starts with one of these tags.
+enum class ApiDumpBinaryTag : uint8_t {
+    Null = 0,            // A null pointer
+    Int32 = 1,           // int32_t
+    UInt32 = 2,          // uint32_t
+    Int64 = 3,           // int64_t
+    UInt64 = 4,          // uint64_t
+    Float = 5,           // float
+    Double = 6,          // double
+    Enum = 7,            // uint16_t index into the enum table, int32_t value
+    Flags = 8,           // uint64_t
+    Handle = 9,          // uint64_t
+    String = 10,         // uint32_t byte count, then the characters without a terminator
+    Pointer = 11,        // uint64_t address of memory that was not copied
+    Struct = 12,         // uint16_t index into the structure table, then one value per member
+    Array = 13,          // uint32_t element count, uint32_t recorded count, then the recorded elements
+    Bytes = 14,          // uint32_t byte count, uint32_t recorded count, then the recorded bytes
+    UnknownStruct = 15,  // int32_t XrStructureType the layer does not know, then the value of its next member
+};
+
+// Pointers are followed this many levels deep, and arrays and byte buffers are cut off after this many elements, to
+// bound the cost of recording a single call.
+constexpr uint32_t kApiDumpBinaryMaxDepth = 16;
+constexpr uint32_t kApiDumpBinaryMaxElements = 4096;
+
+// A thread hands its records to the flush thread once this many bytes have built up, or once a record ends this many
+// nanoseconds after the previous hand off, so that little is lost when the application does not exit cleanly.
+constexpr size_t kApiDumpBinaryHandOffSize = 64 * 1024;
+constexpr int64_t kApiDumpBinaryHandOffInterval = 100 * 1000 * 1000;
+
+struct ApiDumpBinaryRecordHeader {
+    uint32_t command;   // ApiDumpCommandId
+    uint32_t threadId;  // Numbered in the order threads first made a call
+    int64_t beginTime;  // Nanoseconds since the capture started
+    int64_t endTime;
+    int32_t result;  // XrResult
+    uint32_t size;   // Bytes of parameter values following the header
+};
+static_assert(sizeof(ApiDumpBinaryRecordHeader) == 32, "Binary capture record header must stay packed");
+
+struct ApiDumpBinaryEnumValue {
+    int32_t value;
+    const char* name;
+};
+
+struct ApiDumpBinaryEnumSchema {
+    const char* name;
+    const ApiDumpBinaryEnumValue* values;
+    size_t valueCount;
+};
+
+inline uint32_t ApiDumpBinaryClampCount(uint64_t count) {
+    return count > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(count);
+}
+
+// Appends tagged values to a record.
+class ApiDumpBinaryWriter {
+   public:
+    explicit ApiDumpBinaryWriter(std::vector<uint8_t>& data) : data_(data) {}
+
+    void Null() { Append(ApiDumpBinaryTag::Null); }
+
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value>::type Scalar(T value) {
+        if (sizeof(T) <= sizeof(uint32_t)) {
+            if (std::is_signed<T>::value) {
+                Append(ApiDumpBinaryTag::Int32);
+                Append(static_cast<int32_t>(value));
+            } else {
+                Append(ApiDumpBinaryTag::UInt32);
+                Append(static_cast<uint32_t>(value));
+            }
+        } else if (std::is_signed<T>::value) {
+            Append(ApiDumpBinaryTag::Int64);
+            Append(static_cast<int64_t>(value));
+        } else {
+            Append(ApiDumpBinaryTag::UInt64);
+            Append(static_cast<uint64_t>(value));
+        }
+    }
+
+    void Scalar(float value) {
+        Append(ApiDumpBinaryTag::Float);
+        Append(value);
+    }
+
+    void Scalar(double value) {
+        Append(ApiDumpBinaryTag::Double);
+        Append(value);
+    }
+
+    void Enum(uint16_t index, int32_t value) {
+        Append(ApiDumpBinaryTag::Enum);
+        Append(index);
+        Append(value);
+    }
+
+    void Flags(uint64_t value) {
+        Append(ApiDumpBinaryTag::Flags);
+        Append(value);
+    }
+
+    void Handle(uint64_t value) {
+        Append(ApiDumpBinaryTag::Handle);
+        Append(value);
+    }
+
+    // A null-terminated string.
+    void String(const char* value) {
+        if (value == nullptr) {
+            Null();
+            return;
+        }
+        WriteString(value, strlen(value));
+    }
+
+    // A string in a buffer of capacity characters, which is not terminated if it fills the buffer.
+    void BoundedString(const char* value, uint64_t capacity) {
+        if (value == nullptr) {
+            Null();
+            return;
+        }
+        WriteString(value, static_cast<size_t>(std::find(value, value + capacity, '\\0') - value));
+    }
+
+    void Pointer(const void* value) {
+        Append(ApiDumpBinaryTag::Pointer);
+        Append(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value)));
+    }
+
+    void Struct(uint16_t index) {
+        Append(ApiDumpBinaryTag::Struct);
+        Append(index);
+    }
+
+    // Starts an array of count elements, and returns how many of them the caller is to write.
+    uint32_t Array(uint64_t count) {
+        const uint32_t total = ApiDumpBinaryClampCount(count);
+        const uint32_t recorded = std::min(total, kApiDumpBinaryMaxElements);
+        Append(ApiDumpBinaryTag::Array);
+        Append(total);
+        Append(recorded);
+        return recorded;
+    }
+
+    void Bytes(const void* value, uint64_t size) {
+        if (value == nullptr) {
+            Null();
+            return;
+        }
+        const uint32_t total = ApiDumpBinaryClampCount(size);
+        const uint32_t recorded = std::min(total, kApiDumpBinaryMaxElements);
+        Append(ApiDumpBinaryTag::Bytes);
+        Append(total);
+        Append(recorded);
+        AppendBytes(value, recorded);
+    }
+
+    void UnknownStruct(int32_t type) {
+        Append(ApiDumpBinaryTag::UnknownStruct);
+        Append(type);
+    }
+
+   private:
+    void WriteString(const char* value, size_t length) {
+        const uint32_t size = ApiDumpBinaryClampCount(length);
+        Append(ApiDumpBinaryTag::String);
+        Append(size);
+        AppendBytes(value, size);
+    }
+
+    template <typename T>
+    void Append(const T& value) {
+        AppendBytes(&value, sizeof(value));
+    }
+
+    void AppendBytes(const void* value, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(value);
+        data_.insert(data_.end(), bytes, bytes + size);
+    }
+
+    std::vector<uint8_t>& data_;
+};
+
+}  // namespace
+'''
+
+# The part of the binary capture code that owns the file, the per-thread buffers and the flush thread.  It follows
+# the generated tables it writes into the capture header.
+BINARY_CAPTURE_RUNTIME = '''
+namespace {
+
+// The capture file, and the background thread writing the records handed off by the calling threads.
+class ApiDumpBinaryCapture {
+   public:
+    // The capture is never destroyed, so that threads still running during static destruction can hand off their
+    // records safely.  They are dropped once Close has stopped the flush thread at exit.
+    static ApiDumpBinaryCapture& Get() {
+        static ApiDumpBinaryCapture* const capture = new ApiDumpBinaryCapture();
+        static const Closer closer{capture};
+        return *capture;
+    }
+
+    bool Enabled() const { return enabled_; }
+
+    int64_t Now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count();
+    }
+
+    uint32_t NewThreadId() { return next_thread_id_++; }
+
+    void HandOff(std::vector<uint8_t>&& records) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (closed_) {
+                return;
+            }
+            pending_.push_back(std::move(records));
+        }
+        condition_.notify_one();
+    }
+
+   private:
+    struct Closer {
+        ApiDumpBinaryCapture* capture;
+        ~Closer() { capture->Close(); }
+    };
+
+    ApiDumpBinaryCapture() : start_(std::chrono::steady_clock::now()) {
+        const std::string file_name = PlatformUtilsGetEnv("XR_API_DUMP_BINARY_FILE_NAME");
+        if (file_name.empty()) {
+            return;
+        }
+        file_.open(file_name, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file_) {
+            return;
+        }
+        enabled_ = true;
+        flush_thread_ = std::thread(&ApiDumpBinaryCapture::Flush, this);
+    }
+
+    void Close() {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        condition_.notify_one();
+        if (flush_thread_.joinable()) {
+            flush_thread_.join();
+        }
+    }
+
+    void WriteBytes(const void* value, size_t size) {
+        file_.write(static_cast<const char*>(value), static_cast<std::streamsize>(size));
+    }
+
+    void WriteCount(size_t count) {
+        const uint32_t value = ApiDumpBinaryClampCount(count);
+        WriteBytes(&value, sizeof(value));
+    }
+
+    void WriteName(const char* name) { WriteBytes(name, strlen(name) + 1); }
+
+    // Writes groups of names from a table holding each group's names followed by nullptr.
+    void WriteNameGroups(const char* const* table, size_t group_count) {
+        WriteCount(group_count);
+        for (size_t group = 0; group < group_count; ++group) {
+            WriteName(*table++);
+            size_t name_count = 0;
+            while (table[name_count] != nullptr) {
+                ++name_count;
+            }
+            WriteCount(name_count);
+            for (; *table != nullptr; ++table) {
+                WriteName(*table);
+            }
+            ++table;
+        }
+    }
+
+    void WriteHeader() {
+        const uint32_t byte_order = 0x01020304;
+        WriteBytes("XRDUMPB2", 8);
+        WriteBytes(&byte_order, sizeof(byte_order));
+        WriteNameGroups(kApiDumpBinaryCommandSchema, kApiDumpCommandCount);
+        WriteNameGroups(kApiDumpBinaryStructSchema, kApiDumpBinaryStructCount);
+        WriteCount(kApiDumpBinaryEnumCount);
+        for (const ApiDumpBinaryEnumSchema& enum_schema : kApiDumpBinaryEnumSchema) {
+            WriteName(enum_schema.name);
+            WriteCount(enum_schema.valueCount);
+            for (size_t value = 0; value < enum_schema.valueCount; ++value) {
+                WriteBytes(&enum_schema.values[value].value, sizeof(int32_t));
+                WriteName(enum_schema.values[value].name);
+            }
+        }
+    }
+
+    void Flush() {
+        WriteHeader();
+        std::vector<std::vector<uint8_t>> writing;
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            condition_.wait(lock, [this] { return closed_ || !pending_.empty(); });
+            writing.swap(pending_);
+            const bool closing = closed_;
+            lock.unlock();
+            for (const std::vector<uint8_t>& records : writing) {
+                WriteBytes(records.data(), records.size());
+            }
+            writing.clear();
+            file_.flush();
+            if (closing) {
+                break;
+            }
+            lock.lock();
+        }
+        file_.close();
+    }
+
+    const std::chrono::steady_clock::time_point start_;
+    bool enabled_ = false;
+    std::atomic<uint32_t> next_thread_id_{0};
+    std::ofstream file_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::vector<std::vector<uint8_t>> pending_;
+    bool closed_ = false;
+    std::thread flush_thread_;
+};
+
+// The records of one thread, handed to the flush thread in batches so that recording a call only appends to memory.
+class ApiDumpBinaryThreadRecords {
+   public:
+    static ApiDumpBinaryThreadRecords& Get() {
+        static thread_local ApiDumpBinaryThreadRecords records;
+        return records;
+    }
+
+    ~ApiDumpBinaryThreadRecords() { HandOff(); }
+
+    uint32_t ThreadId() const { return thread_id_; }
+
+    std::vector<uint8_t>& Data() { return data_; }
+
+    void RecordEnded(int64_t end_time) {
+        if (data_.size() >= kApiDumpBinaryHandOffSize || end_time - last_hand_off_time_ >= kApiDumpBinaryHandOffInterval) {
+            HandOff();
+            data_.reserve(kApiDumpBinaryHandOffSize);
+            last_hand_off_time_ = end_time;
+        }
+    }
+
+   private:
+    ApiDumpBinaryThreadRecords() : thread_id_(ApiDumpBinaryCapture::Get().NewThreadId()) {
+        data_.reserve(kApiDumpBinaryHandOffSize);
+    }
+
+    void HandOff() {
+        if (!data_.empty()) {
+            ApiDumpBinaryCapture::Get().HandOff(std::move(data_));
+            data_ = std::vector<uint8_t>();
+        }
+    }
+
+    const uint32_t thread_id_;
+    std::vector<uint8_t> data_;
+    int64_t last_hand_off_time_ = 0;
+};
+
+// One call's record in the calling thread's buffer.  Construct it as soon as the call returns, so that the end time
+// does not include copying the parameters.
+class ApiDumpBinaryRecord {
+   public:
+    ApiDumpBinaryRecord(ApiDumpCommandId command, int64_t begin_time, XrResult result)
+        : records_(ApiDumpBinaryThreadRecords::Get()), writer_(records_.Data()), header_offset_(records_.Data().size()) {
+        ApiDumpBinaryRecordHeader header{};
+        header.command = static_cast<uint32_t>(command);
+        header.threadId = records_.ThreadId();
+        header.beginTime = begin_time;
+        header.endTime = ApiDumpBinaryCapture::Get().Now();
+        header.result = static_cast<int32_t>(result);
+        end_time_ = header.endTime;
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&header);
+        records_.Data().insert(records_.Data().end(), bytes, bytes + sizeof(header));
+    }
+
+    ~ApiDumpBinaryRecord() {
+        std::vector<uint8_t>& data = records_.Data();
+        const uint32_t size = ApiDumpBinaryClampCount(data.size() - header_offset_ - sizeof(ApiDumpBinaryRecordHeader));
+        memcpy(data.data() + header_offset_ + offsetof(ApiDumpBinaryRecordHeader, size), &size, sizeof(size));
+        records_.RecordEnded(end_time_);
+    }
+
+    ApiDumpBinaryWriter& Writer() { return writer_; }
+
+   private:
+    ApiDumpBinaryThreadRecords& records_;
+    ApiDumpBinaryWriter writer_;
+    const size_t header_offset_;
+    int64_t end_time_ = 0;
+};
+
+int64_t ApiDumpBinaryCaptureTime() { return ApiDumpBinaryCapture::Get().Now(); }
+
+}  // namespace
+
+bool ApiDumpLayerBinaryCaptureEnabled() { return ApiDumpBinaryCapture::Get().Enabled(); }
+'''
+
 # ApiDumpOutputGenerator - subclass of AutomaticSourceOutputGenerator.
 
 
@@ -75,6 +524,7 @@ class ApiDumpOutputGenerator(AutomaticSourceOutputGenerator):
             preamble += '#include "api_layer_platform_defines.h"\n'
             preamble += '#include <openxr/openxr.h>\n'
             preamble += '#include <openxr/openxr_platform.h>\n\n'
+            preamble += '#include <cstdint>\n'
             preamble += '#include <mutex>\n'
             preamble += '#include <string>\n'
             preamble += '#include <tuple>\n'
@@ -84,11 +534,20 @@ class ApiDumpOutputGenerator(AutomaticSourceOutputGenerator):
         elif self.genOpts.filename == 'xr_generated_api_dump.cpp':
             preamble += '#include "xr_generated_api_dump.hpp"\n'
             preamble += '#include "xr_generated_dispatch_table.h"\n'
-            preamble += '#include "hex_and_handles.h"\n\n'
+            preamble += '#include "hex_and_handles.h"\n'
+            preamble += '#include "platform_utils.hpp"\n\n'
+            preamble += '#include <algorithm>\n'
+            preamble += '#include <atomic>\n'
+            preamble += '#include <chrono>\n'
+            preamble += '#include <condition_variable>\n'
+            preamble += '#include <cstddef>\n'
             preamble += '#include <cstring>\n'
+            preamble += '#include <fstream>\n'
             preamble += '#include <mutex>\n'
             preamble += '#include <sstream>\n'
             preamble += '#include <iomanip>\n'
+            preamble += '#include <thread>\n'
+            preamble += '#include <type_traits>\n'
             preamble += '#include <unordered_map>\n\n'
         write(preamble, file=self.outFile)
 
@@ -98,12 +557,17 @@ class ApiDumpOutputGenerator(AutomaticSourceOutputGenerator):
     def endFile(self):
         file_data = ''
         if self.genOpts.filename == 'xr_generated_api_dump.hpp':
+            file_data += self.outputBinaryCaptureDeclarations()
             file_data += self.outputLayerHeaderPrototypes()
             file_data += self.outputApiDumpExterns()
 
         elif self.genOpts.filename == 'xr_generated_api_dump.cpp':
             file_data += self.outputApiDumpMapMutexItems()
             file_data += self.writeApiDumpUnionStructFuncs()
+            file_data += BINARY_CAPTURE_WRITER
+            file_data += self.outputBinaryCaptureTables()
+            file_data += BINARY_CAPTURE_RUNTIME
+            file_data += self.outputBinaryCaptureSerializers()
             file_data += self.outputLayerCommands()
 
         write(file_data, file=self.outFile)
@@ -1026,6 +1490,435 @@ class ApiDumpOutputGenerator(AutomaticSourceOutputGenerator):
         struct_union_check += '}\n\n'
         return struct_union_check
 
+    # Is a layer command generated for this command?
+    #   self            the ApiDumpOutputGenerator object
+    #   cur_cmd         the command from automatic_source_generator
+    def isDumpedCommand(self, cur_cmd):
+        if cur_cmd.name in self.no_trampoline_or_terminator or cur_cmd.name in MANUALLY_DEFINED_IN_LAYER:
+            return False
+
+        # We fill in the GetInstanceProcAddr manually at the end
+        if cur_cmd.name in ('xrGetInstanceProcAddr', 'xrCreateApiLayerInstance'):
+            return False
+
+        # functions implemented by or for the loader are different
+        LOADER_FUNCTIONS = [
+            'xrInitializeLoaderKHR',
+            'xrNegotiateLoaderRuntimeInterface',
+            'xrNegotiateLoaderApiLayerInterface',
+        ]
+        return cur_cmd.name not in LOADER_FUNCTIONS
+
+    # The commands recorded by binary capture, in the order of their ApiDumpCommandId values.
+    #   self            the ApiDumpOutputGenerator object
+    def getBinaryCaptureCommands(self):
+        return [cur_cmd for cur_cmd in self.core_commands + self.ext_commands if self.isDumpedCommand(cur_cmd)]
+
+    # The structures binary capture can record, in the order of the indices recorded with them.
+    #   self            the ApiDumpOutputGenerator object
+    def getBinaryCaptureStructs(self):
+        return [xr_struct for xr_struct in self.api_structures if xr_struct.name not in LOADER_STRUCTS]
+
+    # Output the binary capture declarations shared with the layer's manual code.
+    #   self            the ApiDumpOutputGenerator object
+    def outputBinaryCaptureDeclarations(self):
+        declarations = '// Api Dump binary capture, see xr_generated_api_dump.cpp for the capture file layout\n'
+        declarations += 'enum class ApiDumpCommandId : uint32_t {\n'
+        for cur_cmd in self.getBinaryCaptureCommands():
+            declarations += f'    {cur_cmd.name},\n'
+        declarations += '};\n\n'
+        declarations += f'constexpr uint32_t kApiDumpCommandCount = {len(self.getBinaryCaptureCommands())};\n\n'
+        declarations += '// True when calls are recorded to the XR_API_DUMP_BINARY_FILE_NAME file instead of the text output.\n'
+        declarations += 'bool ApiDumpLayerBinaryCaptureEnabled();\n\n'
+        return declarations
+
+    # Output the tables naming the commands, structures and enums in the capture file header.
+    #   self            the ApiDumpOutputGenerator object
+    def outputBinaryCaptureTables(self):
+        tables = '\nnamespace {\n\n'
+        tables += '// The name of each command followed by the names of its parameters, in ApiDumpCommandId order.\n'
+        tables += 'const char* const kApiDumpBinaryCommandSchema[] = {\n'
+        for cur_cmd in self.getBinaryCaptureCommands():
+            names = [cur_cmd.name] + [param.name for param in cur_cmd.params]
+            tables += '    ' + ', '.join(f'"{name}"' for name in names) + ', nullptr,\n'
+        tables += '};\n\n'
+
+        binary_structs = self.getBinaryCaptureStructs()
+        tables += f'constexpr size_t kApiDumpBinaryStructCount = {len(binary_structs)};\n\n'
+        tables += '// The name of each structure followed by the names of its members, in the order of their indices.\n'
+        tables += 'const char* const kApiDumpBinaryStructSchema[] = {\n'
+        for xr_struct in binary_structs:
+            names = [xr_struct.name] + [member.name for member in xr_struct.members]
+            tables += '    ' + ', '.join(f'"{name}"' for name in names) + ', nullptr,\n'
+        tables += '};\n\n'
+
+        enum_entries = []
+        for xr_enum in self.api_enums:
+            values = [value for value in xr_enum.values if not value.alias]
+            values_name = f'kApiDumpBinary{xr_enum.name}Values'
+            entry = '    {"%s", nullptr, 0},\n' % xr_enum.name
+            if values and xr_enum.name not in LOADER_ENUMS:
+                if xr_enum.protect_value:
+                    tables += f'#if {xr_enum.protect_string}\n'
+                tables += f'const ApiDumpBinaryEnumValue {values_name}[] = {{\n'
+                for value in values:
+                    if value.protect_value:
+                        tables += f'#if {value.protect_string}\n'
+                    tables += f'    {{{value.name}, "{value.name}"}},\n'
+                    if value.protect_value:
+                        tables += f'#endif // {value.protect_string}\n'
+                tables += '};\n'
+                if xr_enum.protect_value:
+                    tables += f'#endif // {xr_enum.protect_string}\n'
+                entry = '    {"%s", %s, sizeof(%s) / sizeof(%s[0])},\n' % (xr_enum.name, values_name, values_name, values_name)
+                if xr_enum.protect_value:
+                    entry = f'#if {xr_enum.protect_string}\n{entry}#else\n'
+                    entry += '    {"%s", nullptr, 0},\n' % xr_enum.name
+                    entry += f'#endif // {xr_enum.protect_string}\n'
+            enum_entries.append(entry)
+        tables += f'\nconstexpr size_t kApiDumpBinaryEnumCount = {len(self.api_enums)};\n\n'
+        tables += 'const ApiDumpBinaryEnumSchema kApiDumpBinaryEnumSchema[kApiDumpBinaryEnumCount] = {\n'
+        tables += ''.join(enum_entries)
+        tables += '};\n\n'
+        tables += '}  // namespace\n'
+        return tables
+
+    # Get the XrStructureType values of every structure a next chain or base header may point to, as tuples of the
+    # value, the structure and the guard (or None) needed to keep an aliased value from duplicating a case.
+    #   self            the ApiDumpOutputGenerator object
+    def getBinaryCaptureTypedStructs(self):
+        typed_structs = []
+        enum_tuple = [x for x in self.api_enums if x.name == 'XrStructureType'][0]
+        for cur_value in enum_tuple.values:
+            struct_define_name = self.genXrStructureName(cur_value.name)
+            if not struct_define_name or struct_define_name in LOADER_STRUCTS:
+                continue
+            avoid_dupe = None
+            if cur_value.alias:
+                aliased_value = [x for x in enum_tuple.values if x.name == cur_value.alias][0]
+                if (aliased_value.protect_value and aliased_value.protect_value != cur_value.protect_value and
+                        aliased_value.protect_value != enum_tuple.protect_value):
+                    avoid_dupe = aliased_value.protect_string
+                else:
+                    # This would unconditionally cause a duplicate case
+                    continue
+            typed_structs.append((cur_value.name, self.getStruct(struct_define_name), avoid_dupe))
+        return typed_structs
+
+    # Is this a structure whose actual type must be read from its type member before it can be recorded?
+    #   self            the ApiDumpOutputGenerator object
+    #   type_name       the name of the type to check
+    def isBinaryCaptureTypedBase(self, type_name):
+        return self.getRelationGroupForBaseStruct(type_name) is not None or type_name == 'XrEventDataBuffer'
+
+    # Classify a type by how binary capture records a value of it.
+    #   self            the ApiDumpOutputGenerator object
+    #   type_name       the name of the type to classify
+    def getBinaryCaptureKind(self, type_name):
+        type_name = self.resolve_type_name_alias(type_name)
+        if type_name.startswith('PFN_'):
+            return 'function'
+        if type_name == 'void':
+            return 'void'
+        if self.isStruct(type_name):
+            return 'struct'
+        if self.isUnion(type_name) or type_name in BINARY_CAPTURE_COPYABLE_EXTERNAL_TYPES:
+            return 'bytes'
+        if self.isEnumType(type_name):
+            return 'enum'
+        if self.isFlagType(type_name):
+            return 'flags'
+        if self.isHandle(type_name):
+            return 'handle'
+        base_type = self.getBaseType(type_name)
+        if base_type is not None:
+            return 'handle' if self.isOpaque64(base_type.type) else 'scalar'
+        if type_name in BINARY_CAPTURE_SCALAR_TYPES:
+            return 'scalar'
+        return 'external'
+
+    # Write the code recording a value that is not a pointer.
+    #   self            the ApiDumpOutputGenerator object
+    #   kind            the getBinaryCaptureKind of the value's type
+    #   type_name       the name of the value's type
+    #   value           the C++ expression for the value
+    #   depth           the C++ expression for the depth of any structure recorded
+    #   indent          the number of "tabs" to space in for the resulting C++ code
+    def writeBinaryCaptureValue(self, kind, type_name, value, depth, indent):
+        if kind == 'function':
+            line = f'writer.Pointer(reinterpret_cast<const void*>({value}));'
+        elif kind == 'struct':
+            line = f'ApiDumpBinaryWrite(writer, {value}, {depth});'
+        elif kind == 'enum':
+            enum_index = [x.name for x in self.api_enums].index(self.resolve_type_name_alias(type_name))
+            line = f'writer.Enum({enum_index}, static_cast<int32_t>({value}));'
+        elif kind == 'flags':
+            line = f'writer.Flags({value});'
+        elif kind == 'handle':
+            line = f'writer.Handle(MakeHandleGeneric({value}));'
+        elif kind == 'scalar':
+            line = f'writer.Scalar({value});'
+        else:
+            line = f'writer.Bytes(&{value}, sizeof({value}));'
+        return self.writeIndent(indent) + line + '\n'
+
+    # Write the code recording what a pointer points to.
+    #   self            the ApiDumpOutputGenerator object
+    #   kind            the getBinaryCaptureKind of the pointed to type
+    #   type_name       the name of the pointed to type
+    #   pointer         the C++ expression for the pointer
+    #   depth           the C++ expression for the depth of any structure recorded
+    #   indent          the number of "tabs" to space in for the resulting C++ code
+    def writeBinaryCapturePointee(self, kind, type_name, pointer, depth, indent):
+        if type_name == 'char':
+            return self.writeIndent(indent) + f'writer.String({pointer});\n'
+        if kind in ('void', 'function', 'external'):
+            return self.writeIndent(indent) + f'writer.Pointer({pointer});\n'
+        if kind == 'bytes':
+            return self.writeIndent(indent) + f'writer.Bytes({pointer}, sizeof(*{pointer}));\n'
+        if kind == 'struct' and self.isBinaryCaptureTypedBase(type_name):
+            return self.writeIndent(indent) + f'ApiDumpBinaryWriteTyped(writer, {pointer}, {depth});\n'
+        pointee = self.writeIndent(indent) + f'if ({pointer} == nullptr) {{\n'
+        pointee += self.writeIndent(indent + 1) + 'writer.Null();\n'
+        pointee += self.writeIndent(indent) + '} else {\n'
+        pointee += self.writeBinaryCaptureValue(kind, type_name, f'*{pointer}', depth, indent + 1)
+        pointee += self.writeIndent(indent) + '}\n'
+        return pointee
+
+    # Get the C++ expression for the number of elements of an array member or parameter, or None if it is unknown.
+    # Arrays filled by the two call idiom count only the elements written, when the matching count output is found.
+    #   self            the ApiDumpOutputGenerator object
+    #   member_param    the structure from automatic_source_generator for the member or parameter
+    #   siblings        the other members of the structure, or parameters of the command
+    #   prefix          the C++ prefix to access a sibling
+    def getBinaryCaptureCount(self, member_param, siblings, prefix):
+        def siblingValue(name):
+            sibling = next((x for x in siblings if x.name == name), None)
+            if sibling is None:
+                return None
+            if sibling.pointer_count > 0:
+                return f'({prefix}{name} != nullptr ? *{prefix}{name} : 0)'
+            return prefix + name
+
+        count_var = member_param.pointer_count_var
+        count = siblingValue(count_var)
+        if count is not None and count_var.endswith('CapacityInput'):
+            count_output = siblingValue(count_var[:-len('CapacityInput')] + 'CountOutput')
+            if count_output is not None:
+                count = f'std::min<uint64_t>({count}, {count_output})'
+        return count
+
+    # Write the code recording a statically sized array member.
+    #   self            the ApiDumpOutputGenerator object
+    #   member          the structure from automatic_source_generator for the member
+    #   kind            the getBinaryCaptureKind of the member's type
+    #   value           the C++ expression for the member
+    #   depth           the C++ expression for the depth of any structure recorded
+    #   indent          the number of "tabs" to space in for the resulting C++ code
+    def writeBinaryCaptureStaticArray(self, member, kind, value, depth, indent):
+        # Character and byte arrays are recorded as a whole, as a string or as bytes
+        sizes = member.static_array_sizes
+        if member.type in ('char', 'uint8_t'):
+            sizes = sizes[:-1]
+            length = member.static_array_sizes[-1]
+        array = ''
+        for level, size in enumerate(sizes):
+            array += self.writeIndent(indent + level)
+            array += f'for (uint32_t i{level} = 0, count{level} = writer.Array({size}); i{level} < count{level}; ++i{level}) {{\n'
+            value += f'[i{level}]'
+        element_indent = indent + len(sizes)
+        if member.type == 'char':
+            array += self.writeIndent(element_indent) + f'writer.BoundedString({value}, {length});\n'
+        elif member.type == 'uint8_t':
+            array += self.writeIndent(element_indent) + f'writer.Bytes({value}, {length});\n'
+        else:
+            array += self.writeBinaryCaptureValue(kind, member.type, value, depth, element_indent)
+        for level in reversed(range(len(sizes))):
+            array += self.writeIndent(indent + level) + '}\n'
+        return array
+
+    # Write the code recording a structure member or command parameter, following pointers and arrays.
+    #   self            the ApiDumpOutputGenerator object
+    #   member_param    the structure from automatic_source_generator for the member or parameter
+    #   siblings        the other members of the structure, or parameters of the command
+    #   prefix          the C++ prefix to access the member or parameter
+    #   depth           the C++ expression for the depth of any structure recorded
+    #   indent          the number of "tabs" to space in for the resulting C++ code
+    def writeBinaryCaptureMember(self, member_param, siblings, prefix, depth, indent):
+        value = prefix + member_param.name
+        kind = self.getBinaryCaptureKind(member_param.type)
+        if member_param.name == 'next':
+            return self.writeIndent(indent) + f'ApiDumpBinaryWriteTyped(writer, {value}, {depth});\n'
+        if member_param.is_static_array:
+            return self.writeBinaryCaptureStaticArray(member_param, kind, value, depth, indent)
+
+        # The pointer count of a function pointer includes the function pointer itself
+        pointer_count = member_param.pointer_count
+        if kind == 'function':
+            pointer_count -= 1
+        if pointer_count == 0:
+            return self.writeBinaryCaptureValue(kind, member_param.type, value, depth, indent)
+
+        if not member_param.pointer_count_var:
+            if pointer_count == 1:
+                return self.writeBinaryCapturePointee(kind, member_param.type, value, depth, indent)
+            return self.writeIndent(indent) + f'writer.Pointer({value});\n'
+        count = self.getBinaryCaptureCount(member_param, siblings, prefix)
+        if count is None or pointer_count > 2:
+            return self.writeIndent(indent) + f'writer.Pointer({value});\n'
+        if pointer_count == 1:
+            if member_param.type == 'char':
+                return self.writeIndent(indent) + f'writer.BoundedString({value}, {count});\n'
+            if kind == 'void' or member_param.type == 'uint8_t':
+                return self.writeIndent(indent) + f'writer.Bytes({value}, {count});\n'
+            if kind == 'struct' and self.isBinaryCaptureTypedBase(member_param.type):
+                # The elements are structures derived from the base, so their size is that of the first one's type
+                return self.writeIndent(indent) + f'ApiDumpBinaryWriteTypedArray(writer, {value}, {count}, {depth});\n'
+
+        array = self.writeIndent(indent) + f'if ({value} == nullptr) {{\n'
+        array += self.writeIndent(indent + 1) + 'writer.Null();\n'
+        array += self.writeIndent(indent) + '} else {\n'
+        array += self.writeIndent(indent + 1)
+        array += f'for (uint32_t i = 0, count = writer.Array({count}); i < count; ++i) {{\n'
+        if pointer_count == 1:
+            array += self.writeBinaryCaptureValue(kind, member_param.type, f'{value}[i]', depth, indent + 2)
+        else:
+            array += self.writeBinaryCapturePointee(kind, member_param.type, f'{value}[i]', depth, indent + 2)
+        array += self.writeIndent(indent + 1) + '}\n'
+        array += self.writeIndent(indent) + '}\n'
+        return array
+
+    # Get the names of the structures binary capture needs a serializer for: those a next chain or base header may
+    # point to, those of command parameters, and those their members lead to.  Base headers themselves are recorded
+    # through ApiDumpBinaryWriteTyped.
+    #   self            the ApiDumpOutputGenerator object
+    #   typed_structs   the getBinaryCaptureTypedStructs tuples
+    def getBinaryCaptureSerializedStructs(self, typed_structs):
+        serialized = set()
+        pending = [xr_struct.name for _, xr_struct, _ in typed_structs]
+        reached = set(pending)
+        for cur_cmd in self.getBinaryCaptureCommands():
+            pending += [param.type for param in cur_cmd.params if not self.isBinaryCaptureTypedBase(param.type)]
+        while pending:
+            type_name = self.resolve_type_name_alias(pending.pop())
+            if type_name in serialized or type_name in LOADER_STRUCTS or not self.isStruct(type_name):
+                continue
+            serialized.add(type_name)
+            for member in self.getStruct(type_name).members:
+                if member.name != 'next' and member.type not in reached and not self.isBinaryCaptureTypedBase(member.type):
+                    pending.append(member.type)
+        return serialized
+
+    # Write the binary capture serializer of every structure recorded, and of next chains and base headers.
+    #   self            the ApiDumpOutputGenerator object
+    def outputBinaryCaptureSerializers(self):
+        typed_structs = self.getBinaryCaptureTypedStructs()
+        serialized_structs = self.getBinaryCaptureSerializedStructs(typed_structs)
+        serializers = '\n// Binary capture structure serializers\n'
+        serializers += 'static void ApiDumpBinaryWriteTyped(ApiDumpBinaryWriter& writer, const void* value, uint32_t depth);\n'
+        serializers += 'static void ApiDumpBinaryWriteTypedArray(ApiDumpBinaryWriter& writer, const void* values, uint64_t count,\n'
+        serializers += '                                         uint32_t depth);\n'
+        binary_structs = self.getBinaryCaptureStructs()
+        for xr_struct in binary_structs:
+            if xr_struct.name not in serialized_structs:
+                continue
+            if xr_struct.protect_value:
+                serializers += f'#if {xr_struct.protect_string}\n'
+            serializers += f'static void ApiDumpBinaryWrite(ApiDumpBinaryWriter& writer, const {xr_struct.name}& value, uint32_t depth);\n'
+            if xr_struct.protect_value:
+                serializers += f'#endif // {xr_struct.protect_string}\n'
+
+        for struct_index, xr_struct in enumerate(binary_structs):
+            if xr_struct.name not in serialized_structs:
+                continue
+            serializers += '\n'
+            if xr_struct.protect_value:
+                serializers += f'#if {xr_struct.protect_string}\n'
+            serializers += f'static void ApiDumpBinaryWrite(ApiDumpBinaryWriter& writer, const {xr_struct.name}& value, '
+            serializers += 'uint32_t depth) {\n'
+            serializers += '    if (depth > kApiDumpBinaryMaxDepth) {\n'
+            serializers += '        writer.Pointer(&value);\n'
+            serializers += '        return;\n'
+            serializers += '    }\n'
+            serializers += f'    writer.Struct({struct_index});\n'
+            for member in xr_struct.members:
+                serializers += self.writeBinaryCaptureMember(member, xr_struct.members, 'value.', 'depth + 1', 1)
+            serializers += '}\n'
+            if xr_struct.protect_value:
+                serializers += f'#endif // {xr_struct.protect_string}\n'
+
+        serializers += '\n// Record a structure identified by its type member, as found in next chains and behind base headers.\n'
+        serializers += 'static void ApiDumpBinaryWriteTyped(ApiDumpBinaryWriter& writer, const void* value, uint32_t depth) {\n'
+        serializers += '    if (value == nullptr) {\n'
+        serializers += '        writer.Null();\n'
+        serializers += '        return;\n'
+        serializers += '    }\n'
+        serializers += '    if (depth > kApiDumpBinaryMaxDepth) {\n'
+        serializers += '        writer.Pointer(value);\n'
+        serializers += '        return;\n'
+        serializers += '    }\n'
+        serializers += '    const XrBaseInStructure* header = reinterpret_cast<const XrBaseInStructure*>(value);\n'
+        serializers += '    switch (header->type) {\n'
+        for value_name, xr_struct, avoid_dupe in typed_structs:
+            if avoid_dupe:
+                serializers += f'#if !({avoid_dupe})\n'
+            if xr_struct.protect_value:
+                serializers += f'#if {xr_struct.protect_string}\n'
+            serializers += f'        case {value_name}:\n'
+            serializers += f'            ApiDumpBinaryWrite(writer, *reinterpret_cast<const {xr_struct.name}*>(value), depth);\n'
+            serializers += '            return;\n'
+            if xr_struct.protect_value:
+                serializers += f'#endif // {xr_struct.protect_string}\n'
+            if avoid_dupe:
+                serializers += f'#endif // !({avoid_dupe})\n'
+        serializers += '        default:\n'
+        serializers += '            writer.UnknownStruct(static_cast<int32_t>(header->type));\n'
+        serializers += '            ApiDumpBinaryWriteTyped(writer, header->next, depth + 1);\n'
+        serializers += '            return;\n'
+        serializers += '    }\n'
+        serializers += '}\n\n'
+
+        serializers += 'static size_t ApiDumpBinaryTypedStructSize(XrStructureType type) {\n'
+        serializers += '    switch (type) {\n'
+        for value_name, xr_struct, avoid_dupe in typed_structs:
+            if avoid_dupe:
+                serializers += f'#if !({avoid_dupe})\n'
+            if xr_struct.protect_value:
+                serializers += f'#if {xr_struct.protect_string}\n'
+            serializers += f'        case {value_name}:\n'
+            serializers += f'            return sizeof({xr_struct.name});\n'
+            if xr_struct.protect_value:
+                serializers += f'#endif // {xr_struct.protect_string}\n'
+            if avoid_dupe:
+                serializers += f'#endif // !({avoid_dupe})\n'
+        serializers += '        default:\n'
+        serializers += '            return 0;\n'
+        serializers += '    }\n'
+        serializers += '}\n\n'
+
+        serializers += '// Record an array of structures derived from a base header, all of the type of the first one.\n'
+        serializers += 'static void ApiDumpBinaryWriteTypedArray(ApiDumpBinaryWriter& writer, const void* values, uint64_t count,\n'
+        serializers += '                                         uint32_t depth) {\n'
+        serializers += '    if (values == nullptr) {\n'
+        serializers += '        writer.Null();\n'
+        serializers += '        return;\n'
+        serializers += '    }\n'
+        serializers += '    if (count == 0) {\n'
+        serializers += '        writer.Array(0);\n'
+        serializers += '        return;\n'
+        serializers += '    }\n'
+        serializers += '    const size_t stride = ApiDumpBinaryTypedStructSize(reinterpret_cast<const XrBaseInStructure*>(values)->type);\n'
+        serializers += '    if (stride == 0) {\n'
+        serializers += '        writer.Pointer(values);\n'
+        serializers += '        return;\n'
+        serializers += '    }\n'
+        serializers += '    const uint8_t* element = static_cast<const uint8_t*>(values);\n'
+        serializers += '    for (uint32_t i = 0, recorded = writer.Array(count); i < recorded; ++i, element += stride) {\n'
+        serializers += '        ApiDumpBinaryWriteTyped(writer, element, depth);\n'
+        serializers += '    }\n'
+        serializers += '}\n'
+        return serializers
+
     # Write the C++ Api Dump function for every command we know about
     #   self            the ApiDumpOutputGenerator object
     def outputLayerCommands(self):
@@ -1041,24 +1934,7 @@ class ApiDumpOutputGenerator(AutomaticSourceOutputGenerator):
                 assert cur_cmd.ext_name
                 generated_commands += cur_extension.format_if_extension_changed(cur_cmd.ext_name, "\n// ---- {} commands\n")
 
-                if cur_cmd.name in self.no_trampoline_or_terminator or cur_cmd.name in MANUALLY_DEFINED_IN_LAYER:
-                    continue
-
-                # We fill in the GetInstanceProcAddr manually at the end
-                if cur_cmd.name == 'xrGetInstanceProcAddr':
-                    continue
-
-                if cur_cmd.name == 'xrCreateApiLayerInstance':
-                    continue
-
-                LOADER_FUNCTIONS = [
-                    'xrInitializeLoaderKHR',
-                    'xrNegotiateLoaderRuntimeInterface',
-                    'xrNegotiateLoaderApiLayerInterface',
-                ]
-
-                # functions implemented by or for the loader are different
-                if cur_cmd.name in LOADER_FUNCTIONS:
+                if not self.isDumpedCommand(cur_cmd):
                     continue
 
                 is_create = False
@@ -1118,12 +1994,19 @@ class ApiDumpOutputGenerator(AutomaticSourceOutputGenerator):
                     generated_commands += self.printCodeGenErrorMessage(
                         f'Command {cur_cmd.name} does not have an OpenXR Object handle as the first parameter.')
 
+                # Binary capture records the call once it returns, instead of the text output
+                generated_commands += '        const bool binary_capture = ApiDumpLayerBinaryCaptureEnabled();\n'
+                generated_commands += '        int64_t binary_begin_time = 0;\n'
+                generated_commands += '        if (binary_capture) {\n'
+                generated_commands += '            binary_begin_time = ApiDumpBinaryCaptureTime();\n'
+                generated_commands += '        } else {\n'
+
                 # Print out a tuple for the header
                 if has_return:
-                    generated_commands += '        contents.emplace_back("%s", "%s", "");\n' % (
+                    generated_commands += '            contents.emplace_back("%s", "%s", "");\n' % (
                         cur_cmd.return_type.text, cur_cmd.name)
                 else:
-                    generated_commands += f'        contents.emplace_back("void", "{cur_cmd.name}", "");\n'
+                    generated_commands += f'            contents.emplace_back("void", "{cur_cmd.name}", "");\n'
                 # Print out information for each parameter
                 for param in cur_cmd.params:
                     can_expand = False
@@ -1132,10 +2015,11 @@ class ApiDumpOutputGenerator(AutomaticSourceOutputGenerator):
                             (param.is_const or param.pointer_count == 0)):
                         can_expand = True
                     generated_commands += self.writeParamMember(
-                        param, False, can_expand, 2)
+                        param, False, can_expand, 3)
 
                 # Now record the information
-                generated_commands += '        ApiDumpLayerRecordContent(contents);\n\n'
+                generated_commands += '            ApiDumpLayerRecordContent(contents);\n'
+                generated_commands += '        }\n\n'
 
                 # Call down, looking for the returned result if required.
                 generated_commands += '        '
@@ -1151,6 +2035,24 @@ class ApiDumpOutputGenerator(AutomaticSourceOutputGenerator):
                     count = count + 1
                 generated_commands += ');\n'
 
+                binary_result = 'result' if has_return and cur_cmd.return_type.text == 'XrResult' else 'XR_SUCCESS'
+                generated_commands += '        if (binary_capture) {\n'
+                generated_commands += f'            ApiDumpBinaryRecord record(ApiDumpCommandId::{cur_cmd.name}, '
+                generated_commands += f'binary_begin_time, {binary_result});\n'
+                generated_commands += '            ApiDumpBinaryWriter& writer = record.Writer();\n'
+                for param in cur_cmd.params:
+                    is_output = ((param.pointer_count > 0 or param.is_static_array) and not param.is_const and
+                                 not param.type.startswith('PFN_'))
+                    if is_output:
+                        generated_commands += f'            if ({binary_result} == XR_SUCCESS) {{\n'
+                        generated_commands += self.writeBinaryCaptureMember(param, cur_cmd.params, '', '0', 4)
+                        generated_commands += '            } else {\n'
+                        generated_commands += f'                writer.Pointer({param.name});\n'
+                        generated_commands += '            }\n'
+                    else:
+                        generated_commands += self.writeBinaryCaptureMember(param, cur_cmd.params, '', '0', 3)
+                generated_commands += '        }\n'
+
                 # If this is a create command, we have to create an entry in the appropriate
                 # unordered_map pointing to the correct dispatch table for the newly created
                 # object.  Likewise, if it's a delete command, we have to remove the entry
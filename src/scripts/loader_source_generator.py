@@ -45,6 +45,34 @@ MANUAL_LOADER_FUNCS = set((
     'xrInitializeLoaderKHR',
 ))
 
+# FNV-1a parameters for the command name perfect hash. The offset basis is replaced by a seed
+# searched for at generation time.
+FNV1A_32_OFFSET_BASIS = 0x811c9dc5
+FNV1A_32_PRIME = 0x01000193
+
+
+def fnv1a32(seed, name):
+    value = seed
+    for byte in name.encode('ascii'):
+        value = ((value ^ byte) * FNV1A_32_PRIME) & 0xffffffff
+    return value
+
+
+def findPerfectHash(names):
+    """Return (seed, table_bits) such that the top table_bits of fnv1a32(seed, name) are unique for every name.
+
+    The top bits are used because the low bits of FNV-1a depend only on the low bits of the seed."""
+    table_bits = 1
+    while (1 << table_bits) < 4 * len(names):
+        table_bits += 1
+    while True:
+        for seed in range(FNV1A_32_OFFSET_BASIS, FNV1A_32_OFFSET_BASIS + 10000):
+            slots = set(fnv1a32(seed, name) >> (32 - table_bits) for name in names)
+            if len(slots) == len(names):
+                return seed, table_bits
+        table_bits += 1
+
+
 # This is a list of extensions that the loader implements.  This means that
 # the runtime underneath may not support these extensions and the terminators
 # need to check before they call
@@ -135,6 +163,8 @@ class LoaderSourceOutputGenerator(AutomaticSourceOutputGenerator):
             preamble += '#include <openxr/openxr.h>\n'
             preamble += '#include <openxr/openxr_platform.h>\n\n'
 
+            preamble += '#include <cstddef>\n'
+            preamble += '#include <cstdint>\n'
             preamble += '#include <cstring>\n'
             preamble += '#include <memory>\n'
             preamble += '#include <new>\n'
@@ -157,9 +187,15 @@ class LoaderSourceOutputGenerator(AutomaticSourceOutputGenerator):
             file_data += '#ifdef __cplusplus\n'
             file_data += '} // extern "C"\n'
             file_data += '#endif\n'
+            file_data += '\n'
+            file_data += 'struct XrGeneratedDispatchTableCore;\n\n'
+            file_data += '// Look up a core command in a dispatch table by name, in constant time.\n'
+            file_data += '// Returns nullptr if the name is not a core command with a generated trampoline.\n'
+            file_data += 'PFN_xrVoidFunction GeneratedLoaderLookupDispatchTableCore(const XrGeneratedDispatchTableCore *table, const char *name);\n'
 
         elif self.genOpts.filename == 'xr_generated_loader.cpp':
             file_data += self.outputLoaderGeneratedFuncs()
+            file_data += self.outputDispatchTableCoreLookup()
 
         write(file_data, file=self.outFile)
 
@@ -292,3 +328,49 @@ class LoaderSourceOutputGenerator(AutomaticSourceOutputGenerator):
                 generated_funcs += f'#endif // {cur_cmd.protect_string}\n'
             generated_funcs += '\n'
         return generated_funcs
+
+    # Output a perfect hash table from core command names to their offset in the loader dispatch
+    # table, and the function to look commands up in it.  Only commands with a generated trampoline
+    # are included, since exactly those are dispatch table members with no special handling in the loader.
+    #   self            the LoaderSourceOutputGenerator object
+    def outputDispatchTableCoreLookup(self):
+        names = [cur_cmd.name for cur_cmd in self.core_commands
+                 if cur_cmd.name not in MANUAL_LOADER_FUNCS and not cur_cmd.protect_value]
+        seed, table_bits = findPerfectHash(names)
+        table_size = 1 << table_bits
+        slots = [None] * table_size
+        for name in names:
+            slots[fnv1a32(seed, name) >> (32 - table_bits)] = name
+
+        lookup = '// Perfect hash of core command names to their offset in XrGeneratedDispatchTableCore\n'
+        lookup += 'namespace {\n'
+        lookup += 'struct DispatchTableCoreEntry {\n'
+        lookup += '    const char *name;\n'
+        lookup += '    size_t offset;\n'
+        lookup += '};\n\n'
+        lookup += 'inline uint32_t DispatchTableCoreHash(const char *name) {\n'
+        lookup += f'    uint32_t hash = 0x{seed:08x};\n'
+        lookup += "    for (; *name != '\\0'; ++name) {\n"
+        lookup += '        hash ^= static_cast<uint8_t>(*name);\n'
+        lookup += f'        hash *= 0x{FNV1A_32_PRIME:08x};\n'
+        lookup += '    }\n'
+        lookup += '    return hash;\n'
+        lookup += '}\n\n'
+        lookup += f'const DispatchTableCoreEntry kDispatchTableCoreEntries[{table_size}] = {{\n'
+        for name in slots:
+            if name is None:
+                lookup += '    {nullptr, 0},\n'
+            else:
+                lookup += f'    {{"{name}", offsetof(XrGeneratedDispatchTableCore, {name[2:]})}},\n'
+        lookup += '};\n'
+        lookup += '}  // namespace\n\n'
+        lookup += 'PFN_xrVoidFunction GeneratedLoaderLookupDispatchTableCore(const XrGeneratedDispatchTableCore *table, const char *name) {\n'
+        lookup += f'    const DispatchTableCoreEntry &entry = kDispatchTableCoreEntries[DispatchTableCoreHash(name) >> {32 - table_bits}];\n'
+        lookup += '    if (entry.name == nullptr || strcmp(entry.name, name) != 0) {\n'
+        lookup += '        return nullptr;\n'
+        lookup += '    }\n'
+        lookup += '    PFN_xrVoidFunction function;\n'
+        lookup += '    memcpy(&function, reinterpret_cast<const char *>(table) + entry.offset, sizeof(function));\n'
+        lookup += '    return function;\n'
+        lookup += '}\n'
+        return lookup
@@ -5,6 +5,9 @@
 // Used in conformance layer.
 
 #include "gen_dispatch.h"
+#include "CallStats.h"
+#include "FlightRecorder.h"
+#include "ValidationSampling.h"
 
 #if defined(ANDROID)
 #include <android/log.h>
@@ -49,10 +52,20 @@
 /*{ cur_cmd.cdecl | collapse_whitespace | replace(" xr", " ConformanceLayer_xr") | replace(";", "")
 }*/ {
 //#         set first_param_object_type = gen.genXrObjectType(handle_type)
+    static CallStats::FunctionStats* const callStats = CallStats::GetFunctionStats(/*{cur_cmd.name | quote_string}*/);
+    CallStats::ScopedCall scopedCall(callStats);
+    FlightRecorder::ScopedCall flightRecord(/*{cur_cmd.name | quote_string}*/, HandleToInt(/*{first_handle_name}*/));
     try {
         HandleState* const handleState = GetHandleState({HandleToInt(/*{first_handle_name}*/), /*{first_param_object_type}*/});
 
-        return handleState->conformanceHooks->/*{cur_cmd.name}*/(/*{ cur_cmd.params | map(attribute="name") | join(", ") }*/);
+//#         if cur_cmd.name == "xrDestroyInstance"
+        const XrResult result = flightRecord.Returned(handleState->conformanceHooks->/*{cur_cmd.name}*/(/*{ cur_cmd.params | map(attribute="name") | join(", ") }*/));
+        CallStats::DumpSummary();
+        ValidationSampling::DumpSummary();
+        return result;
+//#         else
+        return flightRecord.Returned(handleState->conformanceHooks->/*{cur_cmd.name}*/(/*{ cur_cmd.params | map(attribute="name") | join(", ") }*/));
+//#         endif
     }
     ABI_CATCH
 }
@@ -68,7 +81,11 @@
         return XR_ERROR_VALIDATION_FAILURE;
     }
 
-    const /*{cur_cmd.return_type.text}*/ result =  this->dispatchTable./*{ cur_cmd.name | base_name }*/(/*{ cur_cmd.params | map(attribute="name") | join(", ") }*/);
+    static CallStats::FunctionStats* const callStats = CallStats::GetFunctionStats(/*{cur_cmd.name | quote_string}*/);
+    const /*{cur_cmd.return_type.text}*/ result = [&] {
+        CallStats::ScopedDownstreamCall scopedDownstreamCall(callStats);
+        return this->dispatchTable./*{ cur_cmd.name | base_name }*/(/*{ cur_cmd.params | map(attribute="name") | join(", ") }*/);
+    }();
 
 //## TODO: Inspect out structs
 //## Check if the return code is a valid return code.
@@ -165,6 +182,23 @@
 //# endfor
 
 
+// Not an OpenXR command: the conformance tests look this up by name to check that a handle they reuse between
+// test cases has no child handles left alive. Must match the signature expected by GetSharedAutoBasicInstance.
+static const char* const c_getChildHandleCountName = "xrConformanceLayerGetChildHandleCount";
+
+static XRAPI_ATTR XrResult XRAPI_CALL ConformanceLayer_GetChildHandleCount(
+    uint64_t                                    handle,
+    XrObjectType                                objectType,
+    uint32_t*                                   childCount) try {
+
+    HandleState* const handleState = GetHandleState({ handle, objectType });
+
+    std::unique_lock<std::recursive_mutex> lock(handleState->childrenMutex);
+    *childCount = static_cast<uint32_t>(handleState->children.size());
+    return XR_SUCCESS;
+}
+ABI_CATCH
+
 static PFN_xrVoidFunction ConformanceLayer_InnerGetInstanceProcAddr(
     const char*                                 name,
     HandleState*                                handleState) {
@@ -172,6 +206,9 @@ static PFN_xrVoidFunction ConformanceLayer_InnerGetInstanceProcAddr(
     if (strcmp(name, "xrGetInstanceProcAddr") == 0) {
         return reinterpret_cast<PFN_xrVoidFunction>(ConformanceLayer_xrGetInstanceProcAddr);
     }
+    if (strcmp(name, c_getChildHandleCountName) == 0) {
+        return reinterpret_cast<PFN_xrVoidFunction>(ConformanceLayer_GetChildHandleCount);
+    }
 //# for cur_cmd in sorted_cmds
 //#     set is_core = "XR_VERSION_" in cur_cmd.ext_name
 //#     if cur_cmd.name not in skip_hooks and cur_cmd.name != "xrGetInstanceProcAddr"
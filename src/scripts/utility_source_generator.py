@@ -96,6 +96,10 @@ class UtilitySourceOutputGenerator(AutomaticSourceOutputGenerator):
 
         elif self.genOpts.filename.endswith('.c'):
             file_data += self.outputDispatchTableHelper()
+            if self.genOpts.filename == 'xr_generated_dispatch_table_core.c':
+                # The loader populates its instance dispatch table in two steps, leaving extension commands until first use.
+                file_data += self.outputDispatchTableHelper('GeneratedXrPopulateDispatchTableCoreCommands', include_extensions=False)
+                file_data += self.outputDispatchTableHelper('GeneratedXrPopulateDispatchTableCoreExtensionCommands', include_core=False)
 
         else:
             raise RuntimeError(f"Unknown filename extension! {self.genOpts.filename}")
@@ -123,6 +127,16 @@ class UtilitySourceOutputGenerator(AutomaticSourceOutputGenerator):
 
         table_helper += '                                      XrInstance instance,\n'
         table_helper += '                                      PFN_xrGetInstanceProcAddr get_inst_proc_addr);\n'
+
+        if self.genOpts.filename == 'xr_generated_dispatch_table_core.h':
+            table_helper += '\n'
+            table_helper += '// Populate only the commands of core API versions, or only the extension commands, so that the\n'
+            table_helper += '// extension commands can be resolved when first used.\n'
+            for function_name in ('GeneratedXrPopulateDispatchTableCoreCommands',
+                                  'GeneratedXrPopulateDispatchTableCoreExtensionCommands'):
+                table_helper += f'void {function_name}(struct XrGeneratedDispatchTableCore *table,\n'
+                table_helper += '                                      XrInstance instance,\n'
+                table_helper += '                                      PFN_xrGetInstanceProcAddr get_inst_proc_addr);\n'
         return table_helper
 
     def _feature_name_to_core_version(self, ext_name: str):
@@ -194,8 +208,11 @@ class UtilitySourceOutputGenerator(AutomaticSourceOutputGenerator):
 
     # Write out the helper function that will populate a dispatch table using
     # an instance handle and a corresponding xrGetInstanceProcAddr command.
-    #   self            the ApiDumpOutputGenerator object
-    def outputDispatchTableHelper(self):
+    #   self                the ApiDumpOutputGenerator object
+    #   function_name       name of the helper, if not the default for the file
+    #   include_core        whether to populate the commands of core API versions
+    #   include_extensions  whether to populate extension commands
+    def outputDispatchTableHelper(self, function_name=None, include_core=True, include_extensions=True):
         assert self.genOpts
         commands = []
         table_helper = ''
@@ -203,7 +220,9 @@ class UtilitySourceOutputGenerator(AutomaticSourceOutputGenerator):
 
         table_helper += '// Helper function to populate an instance dispatch table\n'
         if self.genOpts.filename == 'xr_generated_dispatch_table_core.c':
-            table_helper += 'void GeneratedXrPopulateDispatchTableCore(struct XrGeneratedDispatchTableCore *table,\n'
+            if function_name is None:
+                function_name = 'GeneratedXrPopulateDispatchTableCore'
+            table_helper += f'void {function_name}(struct XrGeneratedDispatchTableCore *table,\n'
         else:
             table_helper += 'void GeneratedXrPopulateDispatchTable(struct XrGeneratedDispatchTable *table,\n'
         table_helper += '                                      XrInstance instance,\n'
@@ -223,6 +242,10 @@ class UtilitySourceOutputGenerator(AutomaticSourceOutputGenerator):
                 if cur_cmd.name in self.no_trampoline_or_terminator:
                     continue
 
+                is_core_command = self.isCoreExtensionName(cur_cmd.ext_name)
+                if (is_core_command and not include_core) or (not is_core_command and not include_extensions):
+                    continue
+
                 if self.genOpts.filename == 'xr_generated_dispatch_table_core.c':
                     if self.isCoreExtensionName(cur_cmd.ext_name):
                         pass